@@ -83,6 +83,32 @@ namespace ignition
     void IGNITION_GAZEBO_VISIBLE
     set(msgs::Time *_msg, const std::chrono::steady_clock::duration &_in);
 
+    /// \brief Helper function that sets a mutable msgs::Geometry object
+    /// to the values contained in a sdf::Geometry object. This gives the
+    /// same fields as convert<msgs::Geometry>, but reuses the submessages
+    /// and strings of the message, so refilling a message doesn't allocate.
+    /// Fields which the conversion doesn't set keep their values.
+    /// \param[out] _msg Geometry message to set.
+    /// \param[in] _in SDF geometry.
+    void IGNITION_GAZEBO_VISIBLE
+    set(msgs::Geometry *_msg, const sdf::Geometry &_in);
+
+    /// \brief Helper function that sets a mutable msgs::Material object
+    /// to the values contained in a sdf::Material object, reusing its
+    /// allocations, see set(msgs::Geometry *, const sdf::Geometry &).
+    /// \param[out] _msg Material message to set.
+    /// \param[in] _in SDF material.
+    void IGNITION_GAZEBO_VISIBLE
+    set(msgs::Material *_msg, const sdf::Material &_in);
+
+    /// \brief Helper function that sets a mutable msgs::Light object
+    /// to the values contained in a sdf::Light object, reusing its
+    /// allocations, see set(msgs::Geometry *, const sdf::Geometry &).
+    /// \param[out] _msg Light message to set.
+    /// \param[in] _in SDF light.
+    void IGNITION_GAZEBO_VISIBLE
+    set(msgs::Light *_msg, const sdf::Light &_in);
+
     /// \brief Generic conversion from an SDF geometry to another type.
     /// \param[in] _in SDF geometry.
     /// \return Conversion result.
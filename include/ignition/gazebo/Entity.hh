@@ -60,6 +60,32 @@ namespace ignition
 
     /// \brief Indicates a non-existant or invalid Entity.
     const Entity kNullEntity{0};
+
+    /// \brief Number of low bits of an Entity which hold its slot when
+    /// entity recycling is enabled, see
+    /// EntityComponentManager::SetEntityRecycling. The high bits hold the
+    /// generation of the slot, which is incremented every time the slot is
+    /// reused.
+    const uint64_t kEntitySlotBits{32};
+
+    /// \brief Get the slot of an entity. Slots of live entities are unique,
+    /// and with entity recycling enabled, they stay below the largest number
+    /// of entities alive at once, so they can index dense arrays.
+    /// \param[in] _entity Entity.
+    /// \return Slot of the entity.
+    inline constexpr uint64_t entitySlot(const Entity _entity)
+    {
+      return _entity & ((uint64_t{1} << kEntitySlotBits) - 1);
+    }
+
+    /// \brief Get the generation of an entity's slot. It's 0 for entities
+    /// which don't reuse the slot of a removed entity.
+    /// \param[in] _entity Entity.
+    /// \return Generation of the entity.
+    inline constexpr uint32_t entityGeneration(const Entity _entity)
+    {
+      return static_cast<uint32_t>(_entity >> kEntitySlotBits);
+    }
     }
   }
 }
@@ -20,8 +20,10 @@
 #include <ignition/msgs/serialized.pb.h>
 #include <ignition/msgs/serialized_map.pb.h>
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <optional>
 #include <set>
 #include <string>
@@ -32,13 +34,17 @@
 #include <vector>
 
 #include <ignition/common/Console.hh>
+#include <ignition/math/Pose3.hh>
 #include <ignition/math/graph/Graph.hh>
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/Export.hh"
+#include "ignition/gazebo/LinkState.hh"
+#include "ignition/gazebo/SpatialIndex.hh"
 #include "ignition/gazebo/Types.hh"
 
 #include "ignition/gazebo/components/Component.hh"
 #include "ignition/gazebo/detail/View.hh"
+#include "ignition/gazebo/detail/ViewRange.hh"
 
 namespace ignition
 {
@@ -48,6 +54,7 @@ namespace ignition
     inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     // Forward declarations.
     class IGNITION_GAZEBO_HIDDEN EntityComponentManagerPrivate;
+    class TaskPool;
 
     /// \brief Type alias for the graph that holds entities.
     /// Each vertex is an entity, and the direction points from the parent to
@@ -55,6 +62,73 @@ namespace ignition
     /// All edges are positive booleans.
     using EntityGraph = math::graph::DirectedGraph<Entity, bool>;
 
+    /// \brief Memory used by the components of one type, see
+    /// EntityComponentManager::MemoryUsage.
+    struct ComponentMemoryUsage
+    {
+      /// \brief Component type id.
+      ComponentTypeId typeId{0};
+
+      /// \brief Name the component type was registered with.
+      std::string name;
+
+      /// \brief Number of components.
+      std::size_t count{0};
+
+      /// \brief Bytes taken by the components.
+      std::size_t bytes{0};
+
+      /// \brief Bytes taken by unused capacity and bookkeeping.
+      std::size_t overhead{0};
+    };
+
+    /// \brief Memory used by a view, see EntityComponentManager::MemoryUsage.
+    struct ViewMemoryUsage
+    {
+      /// \brief Component types of the view, sorted.
+      std::vector<ComponentTypeId> types;
+
+      /// \brief Number of entities in the view.
+      std::size_t entityCount{0};
+
+      /// \brief Bytes taken by the view.
+      std::size_t bytes{0};
+
+      /// \brief Change generation during which the view was last used, see
+      /// EntityComponentManager::ChangeGeneration.
+      uint64_t lastUsed{0};
+    };
+
+    /// \brief A state whose components were deserialized ahead of time,
+    /// for example on another thread, see
+    /// EntityComponentManager::DeserializeState, or copied, see
+    /// EntityComponentManager::CopyState.
+    struct DeserializedState
+    {
+      /// \brief Changes of one entity.
+      struct EntityChanges
+      {
+        /// \brief Entity id.
+        Entity id{kNullEntity};
+
+        /// \brief True if the entity is removed.
+        bool remove{false};
+
+        /// \brief New or updated components.
+        std::vector<std::unique_ptr<components::BaseComponent>> components;
+
+        /// \brief Types of removed components.
+        std::vector<ComponentTypeId> removedComponents;
+      };
+
+      /// \brief Entities, in the order of the serialized state.
+      std::vector<EntityChanges> entities;
+
+      /// \brief True if the changes are one time changes, false if they're
+      /// periodic.
+      bool oneTimeChanges{false};
+    };
+
     /** \class EntityComponentManager EntityComponentManager.hh \
      * ignition/gazebo/EntityComponentManager.hh
     **/
@@ -74,6 +148,28 @@ namespace ignition
       /// \return An id for the Entity, or kNullEntity on failure.
       public: Entity CreateEntity();
 
+      /// \brief Create many entities with the same component types at once.
+      /// This is much faster than creating each entity and component on its
+      /// own, because storages are filled one type at a time and views and
+      /// indices are updated once for the whole batch. The entities have no
+      /// parent, see SetParentEntity.
+      ///
+      /// Each vector holds either _count components, one per entity, or a
+      /// single component which all entities get a copy of. For example:
+      ///
+      ///     auto drones = ecm.CreateEntities(2000,
+      ///         std::vector<components::Model>{components::Model()},
+      ///         poses);
+      ///
+      /// \param[in] _count Number of entities to create.
+      /// \param[in] _components Components of the entities, one vector per
+      /// component type.
+      /// \return The created entities, in the order of the components. It
+      /// is empty if the vectors have the wrong size or a type is repeated.
+      public: template<typename ...ComponentTypeTs>
+              std::vector<Entity> CreateEntities(const std::size_t _count,
+                  const std::vector<ComponentTypeTs> &..._components);
+
       /// \brief Get the number of entities on the server.
       /// \return Entity count.
       public: size_t EntityCount() const;
@@ -117,7 +213,8 @@ namespace ignition
       /// create entities that have the correct parent-child relationship.
       ///
       /// \param[in] _entity Entity or kNullEntity to remove current parent.
-      /// \return True if successful. Will fail if entities don't exist.
+      /// \return True if successful. Will fail if entities don't exist, or
+      /// if the parent is the child itself or one of its descendants.
       public: bool SetParentEntity(const Entity _child, const Entity _parent);
 
       /// \brief Get whether a component type has ever been created.
@@ -185,6 +282,20 @@ namespace ignition
               ComponentKey CreateComponent(const Entity _entity,
                   const ComponentTypeT &_data);
 
+      /// \brief Create a component of a particular type, moving _data into
+      /// it instead of copying it. This avoids copying components with large
+      /// data, such as meshes or sensor data.
+      /// \param[in] _entity The entity that will be associated with
+      /// the component.
+      /// \param[in] _data Component to move from.
+      /// \return Key that uniquely identifies the component.
+      public: template<typename ComponentTypeT,
+                       typename std::enable_if<
+                         !std::is_reference<ComponentTypeT>::value &&
+                         !std::is_const<ComponentTypeT>::value, int>::type = 0>
+              ComponentKey CreateComponent(const Entity _entity,
+                  ComponentTypeT &&_data);
+
       /// \brief Get a component assigned to an entity based on a
       /// component type.
       /// \param[in] _entity The entity.
@@ -254,6 +365,17 @@ namespace ignition
               bool SetComponentData(const Entity _entity,
               const typename ComponentTypeT::Type &_data);
 
+      /// \brief Set the data from a component, moving _data into the
+      /// component instead of copying it. Otherwise the same as the
+      /// overload taking a const reference.
+      /// \param[in] _entity The entity.
+      /// \param[in] _data New component data, which is moved from.
+      /// \tparam ComponentTypeT Component type
+      /// \return True if data has changed.
+      public: template<typename ComponentTypeT>
+              bool SetComponentData(const Entity _entity,
+                  typename ComponentTypeT::Type &&_data);
+
       /// \brief Get the type IDs of all components attached to an entity.
       /// \param[in] _entity Entity to check.
       /// \return All the component type IDs.
@@ -303,6 +425,67 @@ namespace ignition
               std::vector<Entity> EntitiesByComponents(
                    const ComponentTypeTs &..._desiredComponents) const;
 
+      /// \brief Keep an index of the entities which have components of all
+      /// the given types, keyed by the data of those components. Calls to
+      /// EntityByComponents and EntitiesByComponents which are given at
+      /// least these component types then only compare the entities whose
+      /// data hashes match, instead of every entity with those types. For
+      /// example, the following speeds up looking up entities by name and
+      /// parent:
+      ///
+      ///  ecm.EnableComponentIndex<components::Name,
+      ///    components::ParentEntity>();
+      ///
+      /// The index follows components as they're created and removed, and
+      /// as they're modified through SetComponentData or SetState.
+      /// Components modified through the pointer returned by Component()
+      /// must be marked with SetChanged to be indexed again.
+      /// \detail The data type of each component must be hashable with
+      /// std::hash. Enabling an index which already exists has no effect.
+      /// Indices should be enabled before systems start running, since this
+      /// must not be called while other threads use the manager.
+      /// \tparam ComponentTypeTs Component types to index.
+      public: template<typename ...ComponentTypeTs>
+              void EnableComponentIndex();
+
+      /// \brief Keep the entities which have a component of the given type
+      /// sorted by a numeric field of its data, so EntitiesInRange can find
+      /// the entities whose field lies within a range without visiting all
+      /// of them. For example, the following finds the entities below the
+      /// ground plane:
+      ///
+      ///  ecm.EnableRangeIndex<components::Pose>("z",
+      ///    [](const math::Pose3d &_pose) {return _pose.Pos().Z();});
+      ///  auto below = ecm.EntitiesInRange<components::Pose>("z",
+      ///    -std::numeric_limits<double>::infinity(), 0.0);
+      ///
+      /// The index is maintained like the ones of EnableComponentIndex.
+      /// Entities whose field is NaN aren't indexed.
+      /// \detail Enabling an index which already exists for the same type
+      /// and field has no effect. Indices should be enabled before systems
+      /// start running, since this must not be called while other threads
+      /// use the manager.
+      /// \param[in] _field Name of the field, used to query the index.
+      /// \param[in] _key Function returning the field from the component
+      /// data.
+      /// \tparam ComponentTypeT Component type to index.
+      public: template<typename ComponentTypeT>
+              void EnableRangeIndex(const std::string &_field,
+                  std::function<double(const typename ComponentTypeT::Type &)>
+                  _key);
+
+      /// \brief Get the entities whose field of a component, indexed with
+      /// EnableRangeIndex, lies in [_min, _max).
+      /// \param[in] _field Name of the field, as given to EnableRangeIndex.
+      /// \param[in] _min Smallest value of the field.
+      /// \param[in] _max Value of the field above the range.
+      /// \return Matching entities, sorted by increasing field. Empty if
+      /// there are none or the field isn't indexed.
+      /// \tparam ComponentTypeT Indexed component type.
+      public: template<typename ComponentTypeT>
+              std::vector<Entity> EntitiesInRange(const std::string &_field,
+                  double _min, double _max) const;
+
       /// \brief Get all entities which match the value of all the given
       /// components and are immediate children of a given parent entity.
       /// For example, the following will return a child of entity `parent`
@@ -326,6 +509,58 @@ namespace ignition
       private: template <typename T>
                struct identity;  // NOLINT
 
+      /// \brief Trait to detect std::function, so that the templated Each()
+      /// doesn't compete with the overloads which take a std::function.
+      private: template <typename T>
+               struct IsStdFunction : std::false_type {};  // NOLINT
+
+      /// \brief Specialization for std::function.
+      private: template <typename R, typename ...Args>
+               struct IsStdFunction<std::function<R(Args...)>>  // NOLINT
+                 : std::true_type {};
+
+      /// \brief Trait to detect components whose data can be hashed with
+      /// std::hash, so they can be used by component indices.
+      private: template <typename ComponentTypeT, typename = void>
+               struct HasHashableData : std::false_type {};  // NOLINT
+
+      /// \brief Specialization for components with hashable data.
+      private: template <typename ComponentTypeT>
+               struct HasHashableData<ComponentTypeT,  // NOLINT
+                 std::void_t<decltype(
+                     std::hash<typename ComponentTypeT::Type>{}(std::declval<
+                         const typename ComponentTypeT::Type &>()))>>
+                 : std::true_type {};
+
+      /// \brief Function which hashes the data of a component.
+      private: using ComponentHasher = std::function<
+                   std::size_t(const components::BaseComponent &)>;
+
+      /// \brief Function which returns a numeric field of a component.
+      private: using ComponentKey = std::function<
+                   double(const components::BaseComponent &)>;
+
+      /// \brief Check that an entity has components equal to all the given
+      /// ones.
+      /// \param[in] _entity Entity to check.
+      /// \param[in] _desiredComponents All the components which must match.
+      /// \return True if the entity has all the components and they match.
+      private: template<typename ...ComponentTypeTs>
+               bool EntityMatchesComponents(const Entity _entity,
+                   const ComponentTypeTs &..._desiredComponents) const;
+
+      /// \brief Get the candidate entities for an EntityByComponents lookup
+      /// from a component index.
+      /// \param[in] _desiredComponents All the components which must match.
+      /// \param[out] _entities Sorted entities whose indexed components hash
+      /// like the desired ones. They still need to be compared to the
+      /// desired components.
+      /// \return True if an index covers some of the desired component
+      /// types, false if all entities with those types need to be checked.
+      private: template<typename ...ComponentTypeTs>
+               bool IndexedEntities(std::vector<Entity> &_entities,
+                   const ComponentTypeTs &..._desiredComponents) const;
+
       /// \brief A version of Each() that doesn't use a cache. The cached
       /// version, Each(), is preferred.
       /// Get all entities which contain given component types, as well
@@ -394,6 +629,130 @@ namespace ignition
                   bool(const Entity &_entity,
                        ComponentTypeTs *...)>>::type _f);
 
+      /// \brief Same as the Each() which takes a std::function, but accepts
+      /// any callable, such as a lambda. The callable isn't type-erased, so
+      /// it can be inlined into the loop over the entities.
+      /// \param[in] _f Callable invoked for each matching entity with the
+      /// entity and const pointers to the components, in the order they're
+      /// listed on the template. It returns false to stop subsequent calls.
+      /// \tparam ComponentTypeTs All the desired component types.
+      /// \tparam FunctionT Type of the callable.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs, typename FunctionT,
+                       typename std::enable_if<!IsStdFunction<
+                           std::decay_t<FunctionT>>::value, int>::type = 0>
+              void Each(FunctionT &&_f) const;
+
+      /// \brief Same as the Each() which takes a std::function, but accepts
+      /// any callable, such as a lambda. The callable isn't type-erased, so
+      /// it can be inlined into the loop over the entities.
+      /// \param[in] _f Callable invoked for each matching entity with the
+      /// entity and mutable pointers to the components, in the order they're
+      /// listed on the template. It returns false to stop subsequent calls.
+      /// \tparam ComponentTypeTs All the desired mutable component types.
+      /// \tparam FunctionT Type of the callable.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs, typename FunctionT,
+                       typename std::enable_if<!IsStdFunction<
+                           std::decay_t<FunctionT>>::value, int>::type = 0>
+              void Each(FunctionT &&_f);
+
+      /// \brief Get a range over all entities which contain given component
+      /// types, to be used in a range-based for loop:
+      ///
+      /// for (auto [entity, pose, link] : ecm.View<Pose, Link>())
+      ///
+      /// Like Each(), this includes entities marked for removal.
+      /// \tparam ComponentTypeTs All the desired component types.
+      /// \return Range whose elements are tuples of the entity and const
+      /// pointers to its components.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs>
+              detail::ViewRange<true, ComponentTypeTs...> View() const;
+
+      /// \brief Get a range over all entities which contain given component
+      /// types, with mutable components. See the const version.
+      /// \tparam ComponentTypeTs All the desired mutable component types.
+      /// \return Range whose elements are tuples of the entity and mutable
+      /// pointers to its components.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs>
+              detail::ViewRange<false, ComponentTypeTs...> View();
+
+      /// \brief Same as Each(), but the entities are split into chunks which
+      /// are processed in parallel on a task pool. Inside a simulation, this
+      /// is the pool owned by the server, see
+      /// ServerConfig::SetWorkerThreadCount. This call blocks until all
+      /// entities have been visited. The order in which entities are
+      /// visited is unspecified. In deterministic mode, see
+      /// SetDeterministic, chunks don't depend on the number of threads.
+      ///
+      /// The callback runs concurrently on multiple threads, so it must
+      /// follow these rules:
+      /// * It may read and modify the components it receives, which belong
+      ///   to the entity it's called for.
+      /// * It may read any other component, as long as no other call of the
+      ///   same ParallelEach modifies it.
+      /// * It must not call non-const functions of the entity component
+      ///   manager. That includes creating or removing entities or
+      ///   components, and SetChanged(). Record changes in per-entity
+      ///   storage and apply them after ParallelEach returns.
+      /// * Any state it shares with other calls, like accumulators, must be
+      ///   synchronized by the callback.
+      /// \param[in] _f Callable invoked for each matching entity with the
+      /// entity and const pointers to the components, in the order they're
+      /// listed on the template. Its return value is ignored.
+      /// \param[in] _minChunkSize Minimum number of entities processed by
+      /// each task. Views with fewer entities run on the calling thread.
+      /// \tparam ComponentTypeTs All the desired component types.
+      /// \tparam FunctionT Type of the callable.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs, typename FunctionT>
+              void ParallelEach(FunctionT &&_f,
+                  std::size_t _minChunkSize = 256) const;
+
+      /// \brief Same as the const version of ParallelEach(), but passes
+      /// mutable components to the callback. The same rules apply.
+      /// \param[in] _f Callable invoked for each matching entity with the
+      /// entity and mutable pointers to the components, in the order they're
+      /// listed on the template. Its return value is ignored.
+      /// \param[in] _minChunkSize Minimum number of entities processed by
+      /// each task. Views with fewer entities run on the calling thread.
+      /// \tparam ComponentTypeTs All the desired mutable component types.
+      /// \tparam FunctionT Type of the callable.
+      /// \warning This function should not be called outside of System's
+      /// PreUpdate, Update, or PostUpdate callbacks.
+      public: template<typename ...ComponentTypeTs, typename FunctionT>
+              void ParallelEach(FunctionT &&_f,
+                  std::size_t _minChunkSize = 256);
+
+      /// \brief Split the range [0, _count) into chunks, and process them on
+      /// the same task pool as ParallelEach(). This is meant for work on
+      /// data the caller gathered from the entity component manager, such
+      /// as component pointers. This call blocks until all chunks have been
+      /// processed. The callback must follow the same rules as for
+      /// ParallelEach().
+      ///
+      /// Chunks are sized by the number of threads, unless in deterministic
+      /// mode, see SetDeterministic, where each chunk except the last has
+      /// exactly _minChunkSize elements. Work which depends on the chunks,
+      /// such as per-chunk random streams, see RandomStream, or partial
+      /// sums, then gives the same results with any number of threads.
+      /// \param[in] _count Size of the range.
+      /// \param[in] _minChunkSize Minimum size of each chunk. Ranges which
+      /// aren't larger are processed on the calling thread.
+      /// \param[in] _f Function called with the beginning and end of each
+      /// chunk.
+      public: void ParallelFor(std::size_t _count,
+                  std::size_t _minChunkSize,
+                  const std::function<void(std::size_t, std::size_t)> &_f)
+                  const;
+
       /// \brief Call a function for each parameter in a pack.
       /// \param[in] _f Function to be called.
       /// \param[in] _components Parameters which should be passed to the
@@ -448,6 +807,38 @@ namespace ignition
                   bool(const Entity &_entity,
                        const ComponentTypeTs *...)>>::type _f) const;
 
+      /// \brief Get all entities whose component of the first given type
+      /// was created or marked as changed since the last call with the same
+      /// token, as well as their components. This only visits the changed
+      /// components, so the cost follows the number of changes instead of
+      /// the number of entities. Entities which don't have all the given
+      /// component types are skipped. For example:
+      ///
+      ///  // Member of the system, starts at 0 to visit all components.
+      ///  uint64_t poseToken{0};
+      ///
+      ///  _ecm.EachChanged<components::Pose, components::Name>(poseToken,
+      ///    [&](const Entity &_entity, const components::Pose *_pose,
+      ///        const components::Name *_name) -> bool {...});
+      ///
+      /// \detail Components modified through a pointer are only visited if
+      /// they're marked with SetChanged.
+      /// \param[in, out] _token Change token held by the caller. Use 0 to
+      /// visit all components. It's updated so that the next call only
+      /// visits components that changed after this one.
+      /// \param[in] _f Callback function to be called for each matching entity.
+      /// The function parameter are all the desired component types, in the
+      /// order they're listed on the template. The callback function can
+      /// return false to stop subsequent calls to the callback, otherwise
+      /// a true value should be returned.
+      /// \tparam ComponentTypeTs All the desired component types. Only
+      /// changes of the first type are considered.
+      public: template<typename ...ComponentTypeTs>
+              void EachChanged(uint64_t &_token,
+                  typename identity<std::function<
+                  bool(const Entity &_entity,
+                       const ComponentTypeTs *...)>>::type _f) const;
+
       /// \brief Get a graph with all the entities. Entities are vertices and
       /// edges point from parent to children.
       /// \return Entity graph.
@@ -460,6 +851,88 @@ namespace ignition
       /// empty if the entity doesn't exist.
       public: std::unordered_set<Entity> Descendants(Entity _entity) const;
 
+      /// \brief Get a scoped name cached by scopedName, see Util.hh. The
+      /// cache is cleared when a Name or ParentEntity component is created,
+      /// removed, set or marked as changed, and when entities are created or
+      /// removed. Names modified through a component pointer are only seen
+      /// once they're marked with SetChanged. Intended for internal use.
+      /// \param[in] _entity Entity.
+      /// \param[in] _delim Delimiter the name was built with.
+      /// \param[in] _includePrefix Whether the name includes entity types.
+      /// \return The cached name, or std::nullopt if it isn't cached.
+      public: std::optional<std::string> CachedScopedName(const Entity _entity,
+                  const std::string &_delim, bool _includePrefix) const;
+
+      /// \brief Cache a scoped name, see CachedScopedName. Intended for
+      /// internal use.
+      /// \param[in] _entity Entity.
+      /// \param[in] _delim Delimiter the name was built with.
+      /// \param[in] _includePrefix Whether the name includes entity types.
+      /// \param[in] _name Scoped name.
+      public: void CacheScopedName(const Entity _entity,
+                  const std::string &_delim, bool _includePrefix,
+                  const std::string &_name) const;
+
+      /// \brief Get a top level model cached by topLevelModel, see Util.hh.
+      /// It's cleared like the cache of CachedScopedName. Intended for
+      /// internal use.
+      /// \param[in] _entity Entity.
+      /// \return The cached model, which may be kNullEntity, or std::nullopt
+      /// if it isn't cached.
+      public: std::optional<Entity> CachedTopLevelModel(
+                  const Entity _entity) const;
+
+      /// \brief Cache a top level model, see CachedTopLevelModel. Intended
+      /// for internal use.
+      /// \param[in] _entity Entity.
+      /// \param[in] _model Top level model of the entity.
+      public: void CacheTopLevelModel(const Entity _entity,
+                  const Entity _model) const;
+
+      /// \brief Get the immediate children of an entity.
+      /// \param[in] _entity Parent entity.
+      /// \return Children in the order they were parented, or an empty
+      /// vector if the entity doesn't exist.
+      public: std::vector<Entity> ChildEntities(const Entity _entity) const;
+
+      /// \brief Visit an entity and all its descendants depth-first, each
+      /// entity before its children. This is cheaper than Descendants()
+      /// when the entities don't need to be stored.
+      /// \param[in] _entity Entity where the traversal starts.
+      /// \param[in] _f Callback function called for each entity. It can
+      /// return false to stop the traversal, otherwise a true value should
+      /// be returned.
+      public: void EachDescendantDepthFirst(const Entity _entity,
+                  const std::function<bool(const Entity &)> &_f) const;
+
+      /// \brief Visit an entity and all its descendants breadth-first, that
+      /// is ordered by their depth below the entity.
+      /// \param[in] _entity Entity where the traversal starts.
+      /// \param[in] _f Callback function called for each entity. It can
+      /// return false to stop the traversal, otherwise a true value should
+      /// be returned.
+      public: void EachDescendantBreadthFirst(const Entity _entity,
+                  const std::function<bool(const Entity &)> &_f) const;
+
+      /// \brief Create a copy of an entity and all its descendants by
+      /// copying their components, which is much faster than creating the
+      /// entities again from SDF. The copies keep the hierarchy of the
+      /// originals: components which hold entities, that is ParentEntity,
+      /// ModelCanonicalLink, PerformerLevels and the links of
+      /// DetachableJoint, are remapped to the copies of the entities in the
+      /// subtree. Other components are copied as they are, so joints still
+      /// find their links by name. Components which can't be copied, see
+      /// components::BaseComponent::Clone, are left out.
+      /// \param[in] _root Root of the subtree to copy.
+      /// \param[in] _newParent Parent of the copy of the root, kNullEntity
+      /// for none.
+      /// \param[in] _nameSuffix Appended to the name of the copy of the
+      /// root. Names of its descendants are scoped, so they stay the same.
+      /// \return The copy of the root, or kNullEntity if the root doesn't
+      /// exist, or the new parent doesn't exist or is in the subtree.
+      public: Entity CloneSubtree(const Entity _root, const Entity _newParent,
+                  const std::string &_nameSuffix);
+
       /// \brief Get a message with the serialized state of the given entities
       /// and components.
       /// \detail The header of the message will not be populated, it is the
@@ -533,6 +1006,36 @@ namespace ignition
                   const std::unordered_set<ComponentTypeId> &_types = {},
                   bool _full = false) const;
 
+      /// \brief Same as State(), but reuses a message filled by a previous
+      /// call instead of adding to it. Entries which are still part of the
+      /// state are overwritten in place, and the others are removed, so
+      /// publishing a similar state every iteration, for example the poses
+      /// of all models, doesn't allocate once the message has grown.
+      /// \param[out] _state Message to rebuild. Any entities and components
+      /// it holds which aren't part of the new state are removed.
+      /// \param[in] _entities Entities to be serialized. Leave empty to get
+      /// all entities.
+      /// \param[in] _types Type ID of components to be serialized. Leave empty
+      /// to get all components.
+      /// \param[in] _full True to get all the entities and components.
+      /// False will get only components and entities that have changed.
+      /// \param[in] _sinceGeneration If not sending the full state, get the
+      /// components that changed since this change generation instead of
+      /// only during the current one, see ChangeGeneration. This is used to
+      /// send deltas which cover several iterations. Zero for the current
+      /// iteration.
+      /// \param[in] _includeStatic False to skip static entities, see
+      /// IsStatic, unless they're being removed. This is meant for states
+      /// sent every iteration, since static entities aren't expected to
+      /// change.
+      public: void RebuildState(
+                  msgs::SerializedStateMap &_state,
+                  const std::unordered_set<Entity> &_entities = {},
+                  const std::unordered_set<ComponentTypeId> &_types = {},
+                  bool _full = false,
+                  uint64_t _sinceGeneration = 0,
+                  bool _includeStatic = true) const;
+
       /// \brief Get a message with the serialized state of all entities and
       /// components that are changing in the current iteration
       ///
@@ -560,6 +1063,64 @@ namespace ignition
       /// \param[in] _stateMsg Message containing state to be set.
       public: void SetState(const msgs::SerializedStateMap &_stateMsg);
 
+      /// \brief Deserialize the components of a state, so SetState only
+      /// has to move them into the ECM. This doesn't access any ECM, so it
+      /// can run on another thread while the ECM is updated.
+      /// Components whose type isn't registered are skipped.
+      /// \param[in] _stateMsg Message containing the state.
+      /// \return Deserialized state.
+      public: static DeserializedState DeserializeState(
+                  const msgs::SerializedStateMap &_stateMsg);
+
+      /// \brief Deserialize the components of a state which pass filters.
+      /// Components which are filtered out are never deserialized, so
+      /// playing back a subset of a large state only pays for that subset.
+      /// \param[in] _stateMsg Message containing the state.
+      /// \param[in] _entityFilter Returns true for the entities to keep,
+      /// including their removal. Empty to keep all entities.
+      /// \param[in] _componentFilter Returns true for the components to
+      /// keep, given their entity and type. Empty to keep all components.
+      /// \return Deserialized state.
+      public: static DeserializedState DeserializeState(
+                  const msgs::SerializedStateMap &_stateMsg,
+                  const std::function<bool(Entity)> &_entityFilter,
+                  const std::function<bool(Entity, ComponentTypeId)>
+                  &_componentFilter);
+
+      /// \brief Copy all entities and components, without serializing them,
+      /// so the copy can be set back with SetState. Unlike State, this keeps
+      /// components which can't be serialized. Components which can't be
+      /// copied, see components::BaseComponent::Clone, are left out.
+      /// \return The full state, whose changes are one time changes.
+      public: DeserializedState CopyState() const;
+
+      /// \brief Set the state of the ECM from a deserialized state. This has
+      /// the same effect as setting the serialized state it came from, but
+      /// moves the components instead of deserializing them.
+      /// \param[in] _state State from DeserializeState, whose components
+      /// are moved from.
+      public: void SetState(DeserializedState &&_state);
+
+      /// \brief Replace all entities and components of this manager with
+      /// those of another one, for example to run what-if rollouts from the
+      /// current state of a world. Forking doesn't copy components: both
+      /// managers share the storage of each component type, which is only
+      /// copied once either of them is about to modify a component of that
+      /// type. Each manager can then be used from its own thread.
+      ///
+      /// Mutable accessors, such as the non-const Component, First, Each,
+      /// View, ParallelEach and EachNew, copy the storages of their
+      /// component types if they're shared, since components may be
+      /// modified through the pointers they give. Read components through a
+      /// const manager to keep sharing their storages.
+      ///
+      /// All entities of the fork are newly created, so that its systems
+      /// create them too. Pointers to components and views of this manager,
+      /// and the change tokens of EachChanged, are invalidated. The source
+      /// must not be modified during the call.
+      /// \param[in] _source Manager to fork.
+      public: void Fork(const EntityComponentManager &_source);
+
       /// \brief Set the changed state of a component.
       /// \param[in] _entity The entity.
       /// \param[in] _type Type of the component.
@@ -575,9 +1136,185 @@ namespace ignition
       public: gazebo::ComponentState ComponentState(const Entity _entity,
           const ComponentTypeId _typeId) const;
 
+      /// \brief Get an estimate of the memory used by each component type
+      /// and each view. Only memory allocated by the manager is counted, not
+      /// memory allocated by the components themselves, such as the
+      /// contents of strings or vectors they hold.
+      /// \param[out] _components Memory used per component type.
+      /// \param[out] _views Memory used per view.
+      public: void MemoryUsage(std::vector<ComponentMemoryUsage> &_components,
+                  std::vector<ViewMemoryUsage> &_views) const;
+
+      /// \brief Set when views which systems stopped using are removed.
+      /// Every view is kept up to date as entities and components are created
+      /// and removed, so views used once, for example by a system looking
+      /// for an entity at startup, keep costing memory and time. Views are
+      /// checked every time all components are marked as unchanged, which
+      /// the server does once per iteration, and a removed view is built
+      /// again the next time it's used.
+      /// \param[in] _unusedGenerations Views which weren't used during that
+      /// many change generations are removed, see ChangeGeneration. Zero to
+      /// keep them, the default. Generations count iterations, so systems
+      /// with an update period only use their views every few generations,
+      /// and the age must be longer than their longest period so their views
+      /// aren't removed and built again on every call.
+      /// \param[in] _maxViews Maximum number of views. Beyond that, the
+      /// least recently used views are removed, except the ones used during
+      /// the current generation. Zero for no maximum, the default.
+      public: void SetViewEviction(const uint64_t _unusedGenerations,
+                  const std::size_t _maxViews);
+
+      /// \brief Get the number of views removed so far because they
+      /// weren't used, see SetViewEviction.
+      /// \return Number of removed views.
+      public: uint64_t EvictedViewCount() const;
+
+      /// \brief Get the current change generation. Generations start at 1,
+      /// and a new one starts every time all components are marked as
+      /// unchanged, which the server does once per iteration. Keep this
+      /// value to later check which components changed since then, see
+      /// ComponentChangedSince.
+      /// \return Current change generation.
+      public: uint64_t ChangeGeneration() const;
+
+      /// \brief Get the current component layout generation. It changes
+      /// whenever components are created or removed, or may have moved to
+      /// another address, for example when a storage shared with a fork is
+      /// copied. Component pointers, including null pointers for missing
+      /// components, remain valid while it doesn't change, so they can be
+      /// kept across calls instead of being looked up every time.
+      /// \return Current component layout generation.
+      public: uint64_t ComponentLayoutGeneration() const;
+
+      /// \brief Get a memory resource for temporaries which are only needed
+      /// during the current iteration, such as containers filled and read
+      /// within one update. Its memory is reused every iteration instead of
+      /// coming from the global allocator, and all of it is released when
+      /// the server starts the next iteration, so nothing allocated from it
+      /// may be kept past that. Each thread gets its own resource, which
+      /// must only be used from that thread.
+      /// \return Memory resource of the calling thread.
+      public: std::pmr::memory_resource *StepMemory() const;
+
+      /// \brief Check whether a component was created or marked as changed
+      /// during or after a given change generation.
+      /// \param[in] _entity Entity that contains the component.
+      /// \param[in] _typeId Component type ID.
+      /// \param[in] _generation Change generation, see ChangeGeneration.
+      /// \return True if the component changed since the given generation,
+      /// false if it didn't or it doesn't exist.
+      public: bool ComponentChangedSince(const Entity _entity,
+          const ComponentTypeId _typeId, const uint64_t _generation) const;
+
+      /// \brief Get whether an entity is part of a static subtree, that is,
+      /// it or one of its ancestors has a Static component which is true,
+      /// like the links, collisions and visuals of a static model. This is
+      /// computed by the server once per iteration, after the Update
+      /// systems, so it doesn't reflect changes made since then.
+      /// \param[in] _entity Entity to check.
+      /// \return True if the entity is static.
+      public: bool IsStatic(const Entity _entity) const;
+
+      /// \brief Get the world pose of an entity computed by the last world
+      /// pose pass, see UpdateWorldPoses. The server runs the pass after the
+      /// Update systems, so cached poses are available to PostUpdate
+      /// systems. In other phases, and on managers which don't run the
+      /// pass, nothing is returned and the pose must be computed from the
+      /// Pose components of the entity and its ancestors, which is what
+      /// gazebo::worldPose does.
+      /// \param[in] _entity Entity with a Pose component.
+      /// \return World pose, or std::nullopt if it isn't cached.
+      public: std::optional<math::Pose3d> CachedWorldPose(
+          const Entity _entity) const;
+
+      /// \brief Keep a spatial index of the world boxes of all entities with
+      /// a Pose component, for range queries such as "which entities are
+      /// within 10m of this point". The box of an entity is its
+      /// AxisAlignedBox component if it has one, otherwise its world
+      /// position. The index is refreshed by the world pose pass, see
+      /// CachedWorldPose, so only entities which moved are updated. Calling
+      /// this again changes the cell size.
+      /// \param[in] _cellSize Size of the grid cells in meters, see
+      /// SpatialIndex.
+      public: void EnableSpatialIndex(double _cellSize = 1.0);
+
+      /// \brief Get the spatial index of world boxes, see
+      /// EnableSpatialIndex. It's empty unless it was enabled, and reflects
+      /// the poses of the last world pose pass.
+      /// \return The spatial index.
+      public: const SpatialIndex &WorldSpatialIndex() const;
+
+      /// \brief Compute the derived world state of a link, such as its
+      /// world inertia and kinetic energy, once per step for all systems
+      /// which need it, see CachedLinkState. Tracking the same link more
+      /// than once has no effect, and removed links stop being tracked.
+      /// The link's components aren't created, systems still need to
+      /// create the WorldPose, WorldLinearVelocity and WorldAngularVelocity
+      /// components they want physics to fill.
+      /// \param[in] _link Link entity.
+      public: void TrackLinkState(const Entity _link);
+
+      /// \brief Get the derived world state of a tracked link computed by
+      /// the last link state pass, see TrackLinkState. The server runs the
+      /// pass after the Update systems, so the state reflects the last
+      /// physics step and is available from PostUpdate until the next
+      /// Update systems run. Otherwise, and for links which aren't tracked,
+      /// nothing is returned and the state must be computed with the Link
+      /// class.
+      /// \param[in] _link Link entity.
+      /// \return Link state, or std::nullopt if it isn't cached.
+      public: std::optional<LinkState> CachedLinkState(
+          const Entity _link) const;
+
+      /// \brief Get an object shared by all systems using this manager, such
+      /// as a batch through which the first instance of a system computes
+      /// the step for all instances. The first call for a key creates the
+      /// object, later calls return it for as long as a caller keeps a
+      /// reference to it. The manager only keeps a weak reference, which is
+      /// dropped with the manager, so a new manager never gets the objects
+      /// of a destroyed one. Objects aren't shared with forked managers,
+      /// see Fork.
+      ///
+      /// The object is created and destroyed by code compiled into the caller
+      /// of the first call, so the object must not outlive the plugin which
+      /// created it: a key must only be used by the systems of one plugin,
+      /// which must release their references before the plugin is unloaded,
+      /// for example by holding them as members. Objects shared by systems
+      /// of several plugins must be created by a library they all link to.
+      /// \param[in] _key Key of the object, which must always be used with
+      /// the same type, for example the type's qualified name.
+      /// \param[in] _args Arguments of the constructor of the object, only
+      /// used if it's created.
+      /// \tparam T Type of the object.
+      /// \return Shared object.
+      public: template<typename T, typename ...ArgTs>
+              std::shared_ptr<T> SharedObject(const std::string &_key,
+                  ArgTs &&..._args) const;
+
+      /// \brief Set whether CreateEntity reuses the slots of removed
+      /// entities. Entity ids then hold a slot and a generation, see
+      /// entitySlot and entityGeneration. When a slot is reused, its
+      /// generation is incremented, so the new entity has a different id and
+      /// stale ids of the removed entity are not found by HasEntity. This
+      /// keeps ids and the containers keyed by them bounded when entities
+      /// are often created and removed. Recycling is disabled by default, and
+      /// can't be enabled once ids reach past the slot range, for example
+      /// after SetEntityCreateOffset.
+      /// \param[in] _enabled True to reuse the slots of removed entities.
+      public: void SetEntityRecycling(const bool _enabled);
+
+      /// \brief Get whether the slots of removed entities are reused, see
+      /// SetEntityRecycling.
+      /// \return True if entity recycling is enabled.
+      public: bool EntityRecycling() const;
+
       /// \brief All future entities will have an id that starts at _offset.
       /// This can be used to avoid entity id collisions, such as during log
-      /// playback.
+      /// playback. While entity recycling is enabled, see
+      /// SetEntityRecycling, offsets must be below 2^kEntitySlotBits, since
+      /// the bits above hold the generations of recycled ids. Other offsets
+      /// are ignored. Recycled ids keep the slot of the removed entity, so
+      /// they stay within the range the offset started.
       /// \param[in] _offset Offset value.
       public: void SetEntityCreateOffset(uint64_t _offset);
 
@@ -591,13 +1328,125 @@ namespace ignition
       protected: void ClearRemovedComponents();
 
       /// \brief Process all entity remove requests. This will remove
-      /// entities and their components. This function is protected to
-      /// facilitate testing.
+      /// entities and their components. The components are tombstoned
+      /// rather than compacted right away, so that removing many entities
+      /// doesn't move the remaining components, see CompactComponentStorage.
+      /// This function is protected to facilitate testing.
       protected: void ProcessRemoveEntityRequests();
 
+      /// \brief Reclaim the storage left by components of removed entities,
+      /// by moving up to a given number of the remaining components into
+      /// it, and pointing views at their new addresses. Called once per
+      /// step, so the cost of removing many entities is spread over steps.
+      /// This function is protected to facilitate testing.
+      /// \param[in] _maxMoves Maximum number of components to move.
+      /// \return True if there's nothing left to reclaim.
+      protected: bool CompactComponentStorage(
+                     const std::size_t _maxMoves = 4096);
+
       /// \brief Mark all components as not changed.
       protected: void SetAllComponentsUnchanged();
 
+      /// \brief Release all the memory handed out by StepMemory. This
+      /// function is protected to facilitate testing.
+      protected: void ResetStepMemory();
+
+      /// \brief Compute the world pose of every entity with a Pose
+      /// component, following ParentEntity components up to the world, and
+      /// make them available through CachedWorldPose. Only entities whose
+      /// Pose or parent changed since the previous pass, or whose ancestors
+      /// moved, are recomputed. This function is protected to facilitate
+      /// testing.
+      protected: void UpdateWorldPoses();
+
+      /// \brief Find the entities of static subtrees, see IsStatic. They're
+      /// only searched again if components were created or removed, parents
+      /// were set or Static components changed since the previous call.
+      /// This function is protected to facilitate testing.
+      protected: void UpdateStaticEntities();
+
+      /// \brief Stop returning cached world poses until the next call to
+      /// UpdateWorldPoses, because Pose components are about to change. This
+      /// function is protected to facilitate testing.
+      protected: void InvalidateWorldPoses();
+
+      /// \brief Compute the state of all links tracked with TrackLinkState
+      /// and make it available through CachedLinkState. Uses the world
+      /// poses of the last world pose pass for links without a WorldPose
+      /// component. This function is protected to facilitate testing.
+      protected: void UpdateLinkStates();
+
+      /// \brief Stop returning cached link states until the next call to
+      /// UpdateLinkStates, because link components are about to change.
+      /// This function is protected to facilitate testing.
+      protected: void InvalidateLinkStates();
+
+      /// \brief Refresh the spatial index with the entities which moved in
+      /// a world pose pass, see EnableSpatialIndex.
+      /// \param[in] _pass World pose pass.
+      private: void UpdateSpatialIndex(const uint64_t _pass);
+
+      /// \brief Set whether the manager is only read, like while the server
+      /// runs PostUpdate systems concurrently on a const manager. While
+      /// read-only, component lookups, views which already exist and other
+      /// queries don't lock any mutex, so concurrent readers don't wait for
+      /// each other. Views created while read-only are kept aside and only
+      /// added to the other views once the manager becomes writable again.
+      /// Nothing may create, remove or change the state of components,
+      /// entities or their parenting while read-only. This function is
+      /// protected to facilitate testing.
+      /// \param[in] _readOnly True before reading concurrently, false
+      /// afterwards.
+      protected: void SetReadOnly(const bool _readOnly);
+
+      /// \brief Set whether several systems use the manager at the same
+      /// time, like while the server runs the systems of a PreUpdate or
+      /// Update stage in parallel. Views are updated once when this is
+      /// called, and accessors don't update them meanwhile, so concurrent
+      /// systems don't update the same views from several threads. Entities
+      /// whose components change while concurrent only show in views once
+      /// the manager isn't concurrent anymore. Views created meanwhile are
+      /// kept aside like while read-only. This function is protected to
+      /// facilitate testing.
+      /// \param[in] _concurrent True before dispatching the systems, false
+      /// once they're all done.
+      protected: void SetConcurrent(const bool _concurrent);
+
+      /// \brief Set the task pool used to run parallel work, such as
+      /// ParallelEach() and State(). The simulation runner sets the pool it
+      /// owns. When no pool is set, a pool shared by all entity component
+      /// managers is used. This function is protected to facilitate testing.
+      /// \param[in] _pool Task pool, which must outlive this manager's
+      /// parallel work, or nullptr to use the shared pool.
+      protected: void SetTaskPool(TaskPool *_pool);
+
+      /// \brief Set whether parallel work is split and merged the same way
+      /// whatever the number of threads, see ServerConfig::SetDeterministic
+      /// and ParallelFor(). The simulation runner sets it from its
+      /// configuration. This function is protected to facilitate testing.
+      /// \param[in] _deterministic True for fixed chunks.
+      protected: void SetDeterministic(bool _deterministic);
+
+      /// \brief Make sure the storage of a component type isn't shared with
+      /// forked managers, see Fork, copying it if needed. Mutable accessors
+      /// call this before giving access to components. The simulation runner
+      /// calls it for the types accessed by systems running at the same
+      /// time, since storages must not be copied concurrently.
+      /// \param[in] _typeId Type of the components.
+      private: void UnshareComponents(const ComponentTypeId _typeId);
+
+      /// \brief Implementation of SharedObject. Objects are deleted through
+      /// a function pointer compiled into the caller, since their type may
+      /// only be known by a plugin.
+      /// \param[in] _key Key of the object.
+      /// \param[in] _create Function which allocates a new object.
+      /// \param[in] _destroy Function which deletes an object.
+      /// \return Shared object.
+      private: std::shared_ptr<void> SharedObjectImplementation(
+                   const std::string &_key,
+                   const std::function<void *()> &_create,
+                   void (*_destroy)(void *)) const;
+
       /// \brief Get whether an Entity exists and is new.
       ///
       /// Entities are considered new in the time between their creation and a
@@ -622,6 +1471,17 @@ namespace ignition
       private: components::BaseComponent *First(
                    const ComponentTypeId _componentTypeId);
 
+      /// \brief Implementation of CreateEntities.
+      /// \param[in] _count Number of entities to create.
+      /// \param[in] _columns For each component type, a function which gets
+      /// the data of the component of the entity at an index.
+      /// \return The created entities.
+      private: std::vector<Entity> CreateEntitiesImplementation(
+                   const std::size_t _count,
+                   const std::vector<std::pair<ComponentTypeId,
+                       std::function<const components::BaseComponent *(
+                           std::size_t)>>> &_columns);
+
       /// \brief Implementation of CreateComponent.
       /// \param[in] _entity The entity that will be associated with
       /// the component.
@@ -633,6 +1493,28 @@ namespace ignition
                    const ComponentTypeId _componentTypeId,
                    const components::BaseComponent *_data);
 
+      /// \brief Implementation of CreateComponent which moves the data.
+      /// \param[in] _entity The entity that will be associated with
+      /// the component.
+      /// \param[in] _componentTypeId Id of the component type.
+      /// \param[in] _data Component to move into the storage.
+      /// \return Key that uniquely identifies the component.
+      private: ComponentKey CreateComponentImplementation(
+                   const Entity _entity,
+                   const ComponentTypeId _componentTypeId,
+                   components::BaseComponent &&_data);
+
+      /// \brief Create a component in its storage and add it to an entity.
+      /// \param[in] _entity The entity that will be associated with
+      /// the component.
+      /// \param[in] _componentTypeId Id of the component type.
+      /// \param[in] _create Function creating the component in its storage,
+      /// which exists when it's called, and returning its id.
+      /// \return Key that uniquely identifies the component.
+      private: ComponentKey InsertComponent(const Entity _entity,
+                   const ComponentTypeId _componentTypeId,
+                   const std::function<ComponentId()> &_create);
+
       /// \brief Get a component based on a component type.
       /// \param[in] _entity The entity.
       /// \param[in] _type Id of the component type.
@@ -706,6 +1588,23 @@ namespace ignition
           std::map<detail::ComponentTypeKey,
           detail::View>::iterator &_iter) const;  // NOLINT
 
+      /// \brief Get a new view slot. Each instantiation of FindView gets one
+      /// the first time it runs, and managers cache the view it found in that
+      /// slot, so later calls don't search the map of views.
+      /// \return Slot, unique in the process.
+      private: static std::size_t NewViewSlot();
+
+      /// \brief Get the view cached in a slot, see NewViewSlot.
+      /// \param[in] _slot View slot.
+      /// \return The view, or nullptr if the slot is empty.
+      private: detail::View *CachedView(const std::size_t _slot) const;
+
+      /// \brief Cache a view in a slot, see NewViewSlot.
+      /// \param[in] _slot View slot.
+      /// \param[in] _view View found for the slot.
+      private: void CacheView(const std::size_t _slot, detail::View *_view)
+                   const;
+
       /// \brief Add a new view to the set of stored views.
       /// \param[in] _types The set of component type ids that is the key
       /// for the view.
@@ -715,9 +1614,69 @@ namespace ignition
           AddView(const std::set<ComponentTypeId> &_types,
               detail::View &&_view) const;
 
-      /// \brief Update views that contain the provided entity.
+      /// \brief Get all entities which have at least all the given component
+      /// types. Entities are grouped by archetype, that is, by their exact
+      /// set of component types, so only matching archetypes are visited.
+      /// \param[in] _types Component types that the entities must have.
+      /// \return All matching entities, in no particular order.
+      private: std::vector<Entity> ArchetypeEntities(
+          const detail::ComponentTypeKey &_types) const;
+
+      /// \brief Update the views with the entities whose components changed,
+      /// or which were requested to be removed, since the last update.
+      /// Entities are queued instead of updating all views every time one of
+      /// their components is created or removed, and views are updated in
+      /// one batch before they're used, matching each archetype against
+      /// each view once with bitmasks of their component types.
+      private: void UpdateViews() const;
+
+      /// \brief Implementation of EnableComponentIndex.
+      /// \param[in] _hashers Function that hashes the data of each indexed
+      /// component type, keyed by type.
+      private: void EnableComponentIndexImplementation(
+                   const std::map<ComponentTypeId, ComponentHasher> &_hashers);
+
+      /// \brief Implementation of IndexedEntities.
+      /// \param[in] _hashes Hash of the data of each desired component which
+      /// can be hashed, keyed by type.
+      /// \param[out] _entities Sorted candidate entities.
+      /// \return True if an index covers some of the given types.
+      private: bool IndexedEntitiesImplementation(
+                   const std::map<ComponentTypeId, std::size_t> &_hashes,
+                   std::vector<Entity> &_entities) const;
+
+      /// \brief Implementation of EnableRangeIndex.
+      /// \param[in] _typeId Indexed component type.
+      /// \param[in] _field Name of the field.
+      /// \param[in] _key Function returning the field of a component.
+      private: void EnableRangeIndexImplementation(
+                   const ComponentTypeId _typeId, const std::string &_field,
+                   const ComponentKey &_key);
+
+      /// \brief Implementation of EntitiesInRange.
+      /// \param[in] _typeId Indexed component type.
+      /// \param[in] _field Name of the field.
+      /// \param[in] _min Smallest value of the field.
+      /// \param[in] _max Value of the field above the range.
+      /// \return Matching entities, sorted by increasing field.
+      private: std::vector<Entity> EntitiesInRangeImplementation(
+                   const ComponentTypeId _typeId, const std::string &_field,
+                   double _min, double _max) const;
+
+      /// \brief Implementation of EachChanged.
+      /// \param[in] _typeId Type of the changed components.
+      /// \param[in, out] _token Change token, see EachChanged.
+      /// \return Entities whose component changed since the token was set.
+      private: std::vector<Entity> ChangedEntities(
+                   const ComponentTypeId _typeId, uint64_t &_token) const;
+
+      /// \brief Index an entity again in the component and range indices
+      /// which contain a given component type, after that component was
+      /// created, removed or modified.
       /// \param[in] _entity The entity.
-      private: void UpdateViews(const Entity _entity);
+      /// \param[in] _typeId Type of the component.
+      private: void UpdateComponentIndices(const Entity _entity,
+                   const ComponentTypeId _typeId);
 
       /// \brief Get a component ID based on an entity and the component's type.
       /// \param[in] _entity The entity.
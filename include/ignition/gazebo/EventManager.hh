@@ -17,8 +17,15 @@
 #ifndef IGNITION_GAZEBO_EVENTMANAGER_HH_
 #define IGNITION_GAZEBO_EVENTMANAGER_HH_
 
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <typeinfo>
 #include <unordered_map>
 #include <utility>
@@ -39,6 +46,104 @@ namespace ignition
     // Forward declarations.
     class IGNITION_GAZEBO_HIDDEN EventManagerPrivate;
 
+    /// \brief A typed channel which systems of the same simulation use to
+    /// pass messages to each other, without serializing them, see
+    /// EventManager::Channel.
+    ///
+    /// Subscribers are called by the publishing thread, one publication at
+    /// a time, with a reference to the published message, which is only
+    /// valid during the call. Publishers and subscribers may be on any
+    /// thread.
+    /// \tparam T Type of the messages.
+    template <typename T>
+    class InProcessChannel
+    {
+      /// \brief Get the name of the channel.
+      /// \return Name of the channel.
+      public: const std::string &Name() const
+              {
+                return this->name;
+              }
+
+      /// \brief Add a subscriber to the channel. Once the returned
+      /// connection is released, the subscriber isn't called anymore, and a
+      /// call which is running on another thread is waited for.
+      /// \param[in] _subscriber Callback for each published message.
+      /// \return A Connection pointer, which will automatically call
+      /// Disconnect when it goes out of scope.
+      public: ignition::common::ConnectionPtr Connect(
+                  const std::function<void(const T &)> &_subscriber)
+              {
+                std::lock_guard<std::recursive_mutex> lock(this->mutex);
+                auto connection = this->event.Connect(_subscriber);
+                if (!connection)
+                  return nullptr;
+                ++this->connectionCount;
+
+                // Releasing the connection waits for running publications,
+                // and the channel outlives its connections.
+                auto *raw = connection.get();
+                auto self = this->weakSelf.lock();
+                return ignition::common::ConnectionPtr(raw,
+                    [connection, self](ignition::common::Connection *) mutable
+                    {
+                      std::lock_guard<std::recursive_mutex> selfLock(
+                          self->mutex);
+                      connection.reset();
+                      --self->connectionCount;
+                    });
+              }
+
+      /// \brief Publish a message to all subscribers of the channel.
+      /// \param[in] _msg Message to publish.
+      /// \return True if the channel has subscribers.
+      public: bool Publish(const T &_msg)
+              {
+                std::lock_guard<std::recursive_mutex> lock(this->mutex);
+                if (this->connectionCount == 0)
+                  return false;
+                this->event.Signal(_msg);
+                return true;
+              }
+
+      /// \brief Check whether the channel has subscribers, so publishers
+      /// can skip preparing messages nobody receives.
+      /// \return True if the channel has subscribers.
+      public: bool HasConnections() const
+              {
+                std::lock_guard<std::recursive_mutex> lock(this->mutex);
+                return this->connectionCount > 0;
+              }
+
+      /// \brief Constructor, channels are created by EventManager::Channel.
+      /// \param[in] _name Name of the channel.
+      private: explicit InProcessChannel(const std::string &_name)
+               : name(_name)
+               {
+               }
+
+      /// \brief Name of the channel.
+      private: std::string name;
+
+      /// \brief Protects the event, held while publishing. Recursive, so
+      /// subscribers can disconnect and publish from their callbacks.
+      private: mutable std::recursive_mutex mutex;
+
+      /// \brief Subscribers of the channel.
+      private: ignition::common::EventT<void(const T &)> event;
+
+      /// \brief Number of connections which weren't released yet. The
+      /// event only forgets released connections when it's signaled.
+      private: std::size_t connectionCount{0};
+
+      /// \brief The channel itself, so connections can keep it alive. Set
+      /// by EventManager::Channel.
+      private: std::weak_ptr<InProcessChannel<T>> weakSelf;
+
+      /// \brief The event manager owns the channels.
+      friend class EventManager;
+    };
+
     /// \brief The EventManager is used to send/receive notifications of
     /// simulator events.
     ///
@@ -47,6 +152,16 @@ namespace ignition
     /// occur.
     ///
     /// See \ref ignition::gazebo::events for a complete list of events.
+    ///
+    /// Subscribers connected with Connect are called by the thread which
+    /// emits the event. Subscribers which do heavy work can instead be
+    /// connected with ConnectDeferred, so they're called on a worker thread
+    /// of the manager and don't block the emitter.
+    ///
+    /// Systems can also pass messages to each other through named, typed
+    /// channels, see Channel. Unlike transport topics, messages on channels
+    /// aren't serialized, and can't be received outside the simulation, so
+    /// systems keep publishing on transport for external clients.
 
     /// TODO: if visibility is added here the MSVC is unable to compile it.
     /// The use of smart pointer inside the unordered_map (events method) is
@@ -56,8 +171,13 @@ namespace ignition
       /// \brief Constructor
       public: EventManager() = default;
 
-      /// \brief Destructor
-      public: ~EventManager() = default;
+      /// \brief Destructor. Stops the deferred worker thread, dropping
+      /// calls which are still queued.
+      public: ~EventManager()
+              {
+                if (this->deferred)
+                  this->deferred->Stop();
+              }
 
       /// \brief Add a connection to an event.
       /// \param[in] _subscriber A std::function callback function. The function
@@ -68,23 +188,42 @@ namespace ignition
               ignition::common::ConnectionPtr
               Connect(const typename E::CallbackT &_subscriber)
               {
-                if (this->events.find(typeid(E)) == this->events.end()) {
-                  this->events[typeid(E)] = std::make_unique<E>();
-                }
+                return this->Event<E>().Connect(_subscriber);
+              }
 
-                E *eventPtr = dynamic_cast<E *>(this->events[typeid(E)].get());
-                // All values in the map should be derived from Event,
-                // so this shouldn't be an issue, but it doesn't hurt to check.
-                if (eventPtr != nullptr)
-                {
-                  return eventPtr->Connect(_subscriber);
-                }
-                else
-                {
-                  ignerr << "Failed to connect event: "
-                    << typeid(E).name() << std::endl;
-                  return nullptr;
-                }
+      /// \brief Add a connection to an event, which is called on a worker
+      /// thread instead of on the thread which emits the event. Emitting
+      /// only copies the arguments into a queue, so heavy subscribers don't
+      /// block the emitter. Calls are made in the order the events were
+      /// emitted, one at a time, by a single worker thread shared by all
+      /// deferred connections of this manager.
+      ///
+      /// Arguments are copied, so events passing references which are only
+      /// valid during the emission, or arguments which can't be copied,
+      /// can't be deferred. Once the returned connection is released, queued
+      /// calls are skipped, and a call which is running is waited for.
+      /// \param[in] _subscriber A std::function callback function. The
+      /// function signature must match that of the event (template parameter
+      /// E).
+      /// \return A Connection pointer, which will automatically call
+      /// Disconnect when it goes out of scope.
+      public: template <typename E>
+              ignition::common::ConnectionPtr
+              ConnectDeferred(const typename E::CallbackT &_subscriber)
+              {
+                if (!this->deferred)
+                  this->deferred = std::make_shared<DeferredQueue>();
+
+                return DeferredConnector<typename E::CallbackT>::Connect(
+                    this->Event<E>(), this->deferred, _subscriber);
+              }
+
+      /// \brief Wait until all deferred calls queued so far have run, see
+      /// ConnectDeferred.
+      public: void FlushDeferred()
+              {
+                if (this->deferred)
+                  this->deferred->Flush();
               }
 
       /// \brief Emit an event signal to connected subscribers.
@@ -93,31 +232,242 @@ namespace ignition
       public: template <typename E, typename ... Args>
               void Emit(Args && ... _args)
               {
-                if (this->events.find(typeid(E)) == this->events.end())
+                auto iter = this->events.find(typeid(E));
+                if (iter == this->events.end())
                 {
                   // If there are no events of type E in the map, create it.
                   // But it also means there is nothing to signal.
                   //
                   // This is also needed to suppress unused function warnings
                   // for Events that are purely emitted, with no connections.
-                  this->events[typeid(E)] = std::make_unique<E>();
+                  this->events.emplace(typeid(E), std::make_unique<E>());
                   return;
                 }
 
-                E *eventPtr = dynamic_cast<E *>(this->events[typeid(E)].get());
-                // All values in the map should be derived from Event,
-                // so this shouldn't be an issue, but it doesn't hurt to check.
-                if (eventPtr != nullptr)
+                // Events are only ever created as their own type, see Event.
+                static_cast<E *>(iter->second.get())->Signal(
+                    std::forward<Args>(_args) ...);
+              }
+
+      /// \brief Get an in-process channel, creating it if needed. All
+      /// publishers and subscribers of a channel must use the same message
+      /// type.
+      ///
+      /// The channel is held by shared pointer, so it can be kept to publish
+      /// without looking it up again, also after the manager is gone.
+      /// \param[in] _name Name of the channel, such as the name of the
+      /// transport topic the same messages are published on.
+      /// \tparam T Type of the messages.
+      /// \return The channel, null if the channel exists with another
+      /// message type.
+      public: template <typename T>
+              std::shared_ptr<InProcessChannel<T>> Channel(
+                  const std::string &_name)
+              {
+                std::lock_guard<std::mutex> lock(this->channelsMutex);
+                auto iter = this->channels.find(_name);
+                if (iter == this->channels.end())
                 {
-                  eventPtr->Signal(std::forward<Args>(_args) ...);
+                  std::shared_ptr<InProcessChannel<T>> channel(
+                      new InProcessChannel<T>(_name));
+                  channel->weakSelf = channel;
+                  this->channels.emplace(_name,
+                      ChannelEntry{typeid(T), channel});
+                  return channel;
                 }
-                else
+
+                if (iter->second.type.get() != typeid(T))
                 {
-                  ignerr << "Failed to signal event: "
-                    << typeid(E).name() << std::endl;
+                  ignerr << "Channel [" << _name << "] carries ["
+                         << iter->second.type.get().name()
+                         << "] messages, not [" << typeid(T).name() << "]"
+                         << std::endl;
+                  return nullptr;
                 }
+                return std::static_pointer_cast<InProcessChannel<T>>(
+                    iter->second.channel);
               }
 
+      /// \brief Get an event, creating it if needed.
+      /// \return The event.
+      private: template <typename E>
+               E &Event()
+               {
+                 auto iter = this->events.find(typeid(E));
+                 if (iter == this->events.end())
+                 {
+                   iter = this->events.emplace(
+                       typeid(E), std::make_unique<E>()).first;
+                 }
+                 return *static_cast<E *>(iter->second.get());
+               }
+
+      /// \brief Queue of deferred calls, run one at a time by a worker thread.
+      private: class DeferredQueue
+               {
+                 /// \brief Queue a call, starting the worker if needed.
+                 /// \param[in] _call Call to make on the worker thread.
+                 public: void Push(std::function<void()> _call)
+                 {
+                   std::lock_guard<std::mutex> lock(this->mutex);
+                   if (this->stop)
+                     return;
+                   if (!this->worker.joinable())
+                     this->worker = std::thread(&DeferredQueue::Run, this);
+                   this->calls.push_back(std::move(_call));
+                   this->cv.notify_all();
+                 }
+
+                 /// \brief Wait until the queue is empty and no call runs.
+                 public: void Flush()
+                 {
+                   std::unique_lock<std::mutex> lock(this->mutex);
+                   if (std::this_thread::get_id() == this->worker.get_id())
+                     return;
+                   this->cv.wait(lock, [this]
+                       {
+                         return this->stop ||
+                             (this->calls.empty() && !this->running);
+                       });
+                 }
+
+                 /// \brief Drop queued calls and join the worker.
+                 public: void Stop()
+                 {
+                   {
+                     std::lock_guard<std::mutex> lock(this->mutex);
+                     this->stop = true;
+                     this->calls.clear();
+                     this->cv.notify_all();
+                   }
+                   if (this->worker.joinable())
+                     this->worker.join();
+                 }
+
+                 /// \brief Worker loop.
+                 private: void Run()
+                 {
+                   std::unique_lock<std::mutex> lock(this->mutex);
+                   while (true)
+                   {
+                     this->cv.wait(lock, [this]
+                         {
+                           return this->stop || !this->calls.empty();
+                         });
+                     if (this->stop)
+                       return;
+
+                     auto call = std::move(this->calls.front());
+                     this->calls.pop_front();
+                     this->running = true;
+                     lock.unlock();
+                     call();
+                     lock.lock();
+                     this->running = false;
+                     this->cv.notify_all();
+                   }
+                 }
+
+                 /// \brief Protects the members below.
+                 private: std::mutex mutex;
+
+                 /// \brief Signaled when calls are queued or have run.
+                 private: std::condition_variable cv;
+
+                 /// \brief Queued calls.
+                 private: std::deque<std::function<void()>> calls;
+
+                 /// \brief Whether the worker is running a call.
+                 private: bool running{false};
+
+                 /// \brief Whether the queue was stopped.
+                 private: bool stop{false};
+
+                 /// \brief Worker thread, started by the first call.
+                 private: std::thread worker;
+               };
+
+      /// \brief Connects deferred subscribers, specialized on the callback
+      /// type of events to get their arguments.
+      /// \tparam CallbackT Callback type of the event.
+      private: template <typename CallbackT>
+               struct DeferredConnector;
+
+      /// \brief Specialization of DeferredConnector.
+      /// \tparam Args Arguments of the event.
+      private: template <typename ... Args>
+               struct DeferredConnector<std::function<void(Args...)>>
+               {
+                 /// \brief Subscriber which can be disconnected while calls
+                 /// to it are queued.
+                 struct Subscriber
+                 {
+                   /// \brief The subscriber's callback.
+                   std::function<void(Args...)> callback;
+
+                   /// \brief Held while calling and while disconnecting, so a
+                   /// running call finishes before disconnection returns.
+                   /// Recursive, so the subscriber can disconnect itself.
+                   std::recursive_mutex mutex;
+
+                   /// \brief Whether the subscriber is still connected.
+                   bool connected{true};
+                 };
+
+                 /// \brief Connect a deferred subscriber.
+                 /// \param[in] _event Event to connect to.
+                 /// \param[in] _queue Queue of deferred calls.
+                 /// \param[in] _callback Subscriber's callback.
+                 /// \return Connection, which disconnects when released.
+                 template <typename E>
+                 static ignition::common::ConnectionPtr Connect(E &_event,
+                     const std::shared_ptr<DeferredQueue> &_queue,
+                     const std::function<void(Args...)> &_callback)
+                 {
+                   auto subscriber = std::make_shared<Subscriber>();
+                   subscriber->callback = _callback;
+
+                   std::weak_ptr<DeferredQueue> weakQueue = _queue;
+                   auto connection = _event.Connect(
+                       [weakQueue, subscriber](Args ... _args)
+                       {
+                         auto queue = weakQueue.lock();
+                         if (!queue)
+                           return;
+                         queue->Push(
+                             [subscriber,
+                              args = std::make_tuple(std::decay_t<Args>(
+                                  _args)...)]() mutable
+                             {
+                               std::lock_guard<std::recursive_mutex> lock(
+                                   subscriber->mutex);
+                               if (subscriber->connected)
+                                 std::apply(subscriber->callback, args);
+                             });
+                       });
+                   if (!connection)
+                     return nullptr;
+
+                   // Releasing the returned connection marks the subscriber
+                   // as disconnected before releasing the event connection.
+                   auto *raw = connection.get();
+                   return ignition::common::ConnectionPtr(raw,
+                       [connection, subscriber](
+                           ignition::common::Connection *) mutable
+                       {
+                         {
+                           std::lock_guard<std::recursive_mutex> lock(
+                               subscriber->mutex);
+                           subscriber->connected = false;
+                         }
+                         connection.reset();
+                       });
+                 }
+               };
+
+      /// \brief Deferred calls, created by the first deferred connection.
+      private: std::shared_ptr<DeferredQueue> deferred;
+
 
       /// \brief Convenience type for storing typeinfo references.
       private: using TypeInfoRef = std::reference_wrapper<const std::type_info>;
@@ -144,6 +494,22 @@ namespace ignition
       private: std::unordered_map<TypeInfoRef,
                                   std::unique_ptr<ignition::common::Event>,
                                   Hasher, EqualTo> events;
+
+      /// \brief An in-process channel and the type of its messages.
+      private: struct ChannelEntry
+               {
+                 /// \brief Type of the messages.
+                 TypeInfoRef type;
+
+                 /// \brief The channel, an InProcessChannel of the type.
+                 std::shared_ptr<void> channel;
+               };
+
+      /// \brief In-process channels by name, see Channel.
+      private: std::unordered_map<std::string, ChannelEntry> channels;
+
+      /// \brief Protects the channels.
+      private: std::mutex channelsMutex;
     };
     }
   }
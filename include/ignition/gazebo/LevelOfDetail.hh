@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_LEVELOFDETAIL_HH_
+#define IGNITION_GAZEBO_LEVELOFDETAIL_HH_
+
+#include <chrono>
+#include <memory>
+#include <optional>
+
+#include <sdf/Element.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN LevelOfDetailPrivate;
+
+    /// \class LevelOfDetail LevelOfDetail.hh ignition/gazebo/LevelOfDetail.hh
+    /// \brief Lets systems spend less time on entities which are far from
+    /// all performers.
+    ///
+    /// An entity is near a performer if its top level model is within a
+    /// distance of a performer's model, or if its top level model belongs
+    /// to a level which a performer is in, see the PerformerLevels and
+    /// LevelEntityNames components. Systems which opt in update near
+    /// entities every iteration, and the others once per period, or not at
+    /// all. Far entities are spread over the iterations of a period, so
+    /// they don't all update in the same iteration.
+    ///
+    /// Systems call Update once per iteration, and then Near or Due for
+    /// each entity they handle. It's configured with these elements:
+    ///
+    /// - `<distance>`: Distance in meters within which entities are near a
+    /// performer. Defaults to 0, which disables the level of detail, so all
+    /// entities are near.
+    /// - `<period>`: Seconds of sim time between updates of far entities,
+    /// defaults to 1.
+    class IGNITION_GAZEBO_VISIBLE LevelOfDetail
+    {
+      /// \brief Constructor
+      public: LevelOfDetail();
+
+      /// \brief Destructor
+      public: ~LevelOfDetail();
+
+      /// \brief Load the configuration from an SDF element, such as the
+      /// `<level_of_detail>` element of a system.
+      /// \param[in] _sdf Element holding `<distance>` and `<period>`.
+      public: void Load(const sdf::ElementPtr &_sdf);
+
+      /// \brief Set the distance within which entities are near a
+      /// performer.
+      /// \param[in] _distance Distance in meters, zero or less to disable.
+      public: void SetDistance(double _distance);
+
+      /// \brief Get the distance within which entities are near a
+      /// performer.
+      /// \return Distance in meters.
+      public: double Distance() const;
+
+      /// \brief Set the sim time between updates of far entities.
+      /// \param[in] _period Period, zero to update far entities every
+      /// iteration too.
+      public: void SetPeriod(
+                  const std::chrono::steady_clock::duration &_period);
+
+      /// \brief Get the sim time between updates of far entities.
+      /// \return Period.
+      public: std::chrono::steady_clock::duration Period() const;
+
+      /// \brief Get whether far entities are treated differently.
+      /// \return True if the distance is positive.
+      public: bool Enabled() const;
+
+      /// \brief Find the performers and the levels they're in. Call this
+      /// once per iteration, before Near or Due.
+      /// \param[in] _info Current simulation information.
+      /// \param[in] _ecm Entity component manager.
+      public: void Update(const UpdateInfo &_info,
+                  const EntityComponentManager &_ecm);
+
+      /// \brief Get whether an entity is near a performer. All entities are
+      /// near if the level of detail isn't enabled.
+      /// \param[in] _ecm Entity component manager.
+      /// \param[in] _entity Entity, or any of its descendants.
+      /// \return True if the entity is near a performer.
+      public: bool Near(const EntityComponentManager &_ecm,
+                  const Entity _entity) const;
+
+      /// \brief Get whether an entity should be updated in this iteration,
+      /// which is always the case for near entities, and once per period
+      /// for far ones.
+      /// \param[in] _ecm Entity component manager.
+      /// \param[in] _entity Entity.
+      /// \return Sim time since the entity was last due, to be handled by
+      /// the update, or nullopt if it isn't due.
+      public: std::optional<std::chrono::steady_clock::duration> Due(
+                  const EntityComponentManager &_ecm, const Entity _entity);
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<LevelOfDetailPrivate> dataPtr;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_LEVELOFDETAIL_HH_
@@ -91,6 +91,23 @@ namespace ignition
       /// \return Link entity.
       public: gazebo::Entity Entity() const;
 
+      /// \brief Keep pointers to the link's components looked up through
+      /// _ecm, so that repeated calls with that manager, for example several
+      /// per step, don't look them up again. The pointers are looked up
+      /// again whenever components are created or removed, see
+      /// EntityComponentManager::ComponentLayoutGeneration. Calls with other
+      /// managers aren't affected. A bound Link must not be used from
+      /// multiple threads at once, and _ecm must outlive the binding.
+      /// \param[in] _ecm Entity-component manager.
+      public: void Bind(const EntityComponentManager &_ecm);
+
+      /// \brief Stop keeping component pointers, see Bind.
+      public: void Unbind();
+
+      /// \brief Check whether the link keeps component pointers, see Bind.
+      /// \return True if bound to a manager.
+      public: bool Bound() const;
+
       /// \brief Reset Entity to a new one
       /// \param[in] _newEntity New link entity.
       public: void ResetEntity(gazebo::Entity _newEntity);
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_LINKSTATE_HH_
+#define IGNITION_GAZEBO_LINKSTATE_HH_
+
+#include <optional>
+
+#include <ignition/math/Matrix3.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <ignition/gazebo/config.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief World frame quantities of a link, derived from its
+    /// components. See EntityComponentManager::TrackLinkState.
+    ///
+    /// The quantities match the ones returned by the Link class.
+    /// Quantities which need a component that the link doesn't have are
+    /// std::nullopt.
+    struct LinkState
+    {
+      /// \brief World pose of the link frame.
+      math::Pose3d worldPose;
+
+      /// \brief World pose of the center of mass. Needs an Inertial
+      /// component.
+      std::optional<math::Pose3d> worldInertialPose;
+
+      /// \brief World linear velocity of the link frame origin. Needs a
+      /// WorldLinearVelocity component.
+      std::optional<math::Vector3d> worldLinearVelocity;
+
+      /// \brief World angular velocity. Needs a WorldAngularVelocity
+      /// component.
+      std::optional<math::Vector3d> worldAngularVelocity;
+
+      /// \brief Moment of inertia about the center of mass, expressed in
+      /// the world frame. Needs an Inertial component.
+      std::optional<math::Matrix3d> worldInertiaMatrix;
+
+      /// \brief Kinetic energy in the world frame. Needs Inertial,
+      /// WorldLinearVelocity and WorldAngularVelocity components.
+      std::optional<double> worldKineticEnergy;
+    };
+    }
+  }
+}
+#endif
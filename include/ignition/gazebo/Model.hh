@@ -87,6 +87,23 @@ namespace ignition
       /// \return Model entity.
       public: gazebo::Entity Entity() const;
 
+      /// \brief Keep pointers to the model's components looked up through
+      /// _ecm, so that repeated calls with that manager, for example several
+      /// per step, don't look them up again. The pointers are looked up
+      /// again whenever components are created or removed, see
+      /// EntityComponentManager::ComponentLayoutGeneration. Calls with other
+      /// managers aren't affected. A bound Model must not be used from
+      /// multiple threads at once, and _ecm must outlive the binding.
+      /// \param[in] _ecm Entity-component manager.
+      public: void Bind(const EntityComponentManager &_ecm);
+
+      /// \brief Stop keeping component pointers, see Bind.
+      public: void Unbind();
+
+      /// \brief Check whether the model keeps component pointers, see Bind.
+      /// \return True if bound to a manager.
+      public: bool Bound() const;
+
       /// \brief Check whether this model correctly refers to an entity that
       /// has a components::Model.
       /// \param[in] _ecm Entity-component manager.
@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_PACKEDPOSES_HH_
+#define IGNITION_GAZEBO_PACKEDPOSES_HH_
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ignition/math/Pose3.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class PackedPoses PackedPoses.hh ignition/gazebo/PackedPoses.hh
+    /// \brief Packs entity poses into a contiguous binary buffer, for pose
+    /// streams to remote viewers of large worlds, see
+    /// systems::SceneBroadcaster.
+    ///
+    /// A buffer starts with a header holding a version byte, the position
+    /// resolution as a float, the simulation time in nanoseconds as a 64
+    /// bit integer and the number of poses as a 32 bit integer. Each pose
+    /// then takes 24 bytes instead of about 80 in a msgs::Pose_V:
+    ///
+    /// * The entity, as a 64 bit integer.
+    /// * The position, as three 32 bit multiples of the resolution.
+    /// * The rotation, as 32 bits holding the index of the largest quaternion
+    ///   element in the top 2 bits, followed by the other three elements in
+    ///   10 bits each. This is accurate to about 0.1 degrees.
+    ///
+    /// Numbers are stored in the byte order of the host.
+    class PackedPoses
+    {
+      /// \brief Version of the layout, which is the first byte of buffers.
+      public: static constexpr char kVersion{'\1'};
+
+      /// \brief Number of bytes taken by the header.
+      public: static constexpr std::size_t kHeaderSize{
+          1 + sizeof(float) + sizeof(int64_t) + sizeof(uint32_t)};
+
+      /// \brief Number of bytes taken by each pose.
+      public: static constexpr std::size_t kPoseSize{
+          sizeof(uint64_t) + 3 * sizeof(int32_t) + sizeof(uint32_t)};
+
+      /// \brief Start a buffer, replacing its contents but keeping its
+      /// memory.
+      /// \param[in] _resolution Position resolution in meters, must be
+      /// positive. Positions beyond what 32 bits of it can hold are clamped.
+      /// \param[in] _simTime Simulation time of the poses.
+      /// \param[out] _buffer Buffer to start.
+      public: static void Begin(const double _resolution,
+          const std::chrono::steady_clock::duration &_simTime,
+          std::string &_buffer)
+      {
+        const float resolution = static_cast<float>(_resolution);
+        const int64_t simTime =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+            _simTime).count();
+        const uint32_t count{0};
+
+        _buffer.resize(kHeaderSize);
+        char *out = &_buffer[0];
+        *out++ = kVersion;
+        std::memcpy(out, &resolution, sizeof(resolution));
+        out += sizeof(resolution);
+        std::memcpy(out, &simTime, sizeof(simTime));
+        out += sizeof(simTime);
+        std::memcpy(out, &count, sizeof(count));
+      }
+
+      /// \brief Append a pose to a buffer started with Begin.
+      /// \param[in] _entity Entity whose pose it is.
+      /// \param[in] _pose Pose to append.
+      /// \param[in,out] _buffer Buffer to append to.
+      public: static void Append(const Entity _entity,
+          const math::Pose3d &_pose, std::string &_buffer)
+      {
+        if (_buffer.size() < kHeaderSize)
+          return;
+
+        float resolution;
+        std::memcpy(&resolution, _buffer.data() + 1, sizeof(resolution));
+        uint32_t count;
+        char *countPtr = &_buffer[kHeaderSize - sizeof(count)];
+        std::memcpy(&count, countPtr, sizeof(count));
+        ++count;
+        std::memcpy(countPtr, &count, sizeof(count));
+
+        const uint64_t entity{_entity};
+        const double pos[3]{_pose.Pos().X(), _pose.Pos().Y(), _pose.Pos().Z()};
+        int32_t quantizedPos[3];
+        for (int i = 0; i < 3; ++i)
+        {
+          quantizedPos[i] = static_cast<int32_t>(std::clamp(
+              std::round(pos[i] / resolution), double(INT32_MIN),
+              double(INT32_MAX)));
+        }
+        const uint32_t rot = PackRotation(_pose.Rot());
+
+        const std::size_t offset = _buffer.size();
+        _buffer.resize(offset + kPoseSize);
+        char *out = &_buffer[offset];
+        std::memcpy(out, &entity, sizeof(entity));
+        out += sizeof(entity);
+        std::memcpy(out, quantizedPos, sizeof(quantizedPos));
+        out += sizeof(quantizedPos);
+        std::memcpy(out, &rot, sizeof(rot));
+      }
+
+      /// \brief Read the poses of a buffer.
+      /// \param[in] _buffer Buffer filled by Begin and Append.
+      /// \param[out] _poses Entities and their poses, in the order they were
+      /// appended. The vector's memory is reused.
+      /// \param[out] _simTime Simulation time of the poses.
+      /// \return False if the buffer doesn't hold packed poses.
+      public: static bool Read(const std::string &_buffer,
+          std::vector<std::pair<Entity, math::Pose3d>> &_poses,
+          std::chrono::steady_clock::duration &_simTime)
+      {
+        _poses.clear();
+        if (_buffer.size() < kHeaderSize || _buffer[0] != kVersion)
+          return false;
+
+        float resolution;
+        int64_t simTime;
+        uint32_t count;
+        const char *in = _buffer.data() + 1;
+        std::memcpy(&resolution, in, sizeof(resolution));
+        in += sizeof(resolution);
+        std::memcpy(&simTime, in, sizeof(simTime));
+        in += sizeof(simTime);
+        std::memcpy(&count, in, sizeof(count));
+        in += sizeof(count);
+
+        if (_buffer.size() != kHeaderSize + count * kPoseSize)
+          return false;
+
+        _simTime = std::chrono::duration_cast<
+            std::chrono::steady_clock::duration>(
+            std::chrono::nanoseconds(simTime));
+
+        _poses.reserve(count);
+        for (uint32_t p = 0; p < count; ++p)
+        {
+          uint64_t entity;
+          int32_t quantizedPos[3];
+          uint32_t rot;
+          std::memcpy(&entity, in, sizeof(entity));
+          in += sizeof(entity);
+          std::memcpy(quantizedPos, in, sizeof(quantizedPos));
+          in += sizeof(quantizedPos);
+          std::memcpy(&rot, in, sizeof(rot));
+          in += sizeof(rot);
+
+          _poses.emplace_back(static_cast<Entity>(entity), math::Pose3d(
+              math::Vector3d(quantizedPos[0] * resolution,
+                             quantizedPos[1] * resolution,
+                             quantizedPos[2] * resolution),
+              UnpackRotation(rot)));
+        }
+        return true;
+      }
+
+      /// \brief Largest magnitude of the three smallest elements of a unit
+      /// quaternion.
+      private: static constexpr double kMaxSmallest{0.70710678118654757};
+
+      /// \brief Largest value of 10 bits.
+      private: static constexpr uint32_t kElementMax{(1u << 10) - 1};
+
+      /// \brief Pack a rotation into 32 bits, dropping its largest element,
+      /// which is recovered from the unit norm.
+      /// \param[in] _rot Rotation to pack.
+      /// \return Packed rotation.
+      private: static uint32_t PackRotation(const math::Quaterniond &_rot)
+      {
+        double q[4]{_rot.W(), _rot.X(), _rot.Y(), _rot.Z()};
+        const double norm =
+            std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        if (norm <= 0.0)
+        {
+          q[0] = 1.0;
+          q[1] = q[2] = q[3] = 0.0;
+        }
+
+        uint32_t largest{0};
+        for (uint32_t i = 1; i < 4; ++i)
+        {
+          if (std::abs(q[i]) > std::abs(q[largest]))
+            largest = i;
+        }
+
+        // q and -q are the same rotation, so the largest element is made
+        // positive and doesn't need a sign
+        const double sign = (q[largest] < 0.0 ? -1.0 : 1.0) /
+            (norm > 0.0 ? norm : 1.0);
+
+        uint32_t packed = largest << 30;
+        int shift = 20;
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+          if (i == largest)
+            continue;
+          const double unit = std::clamp(
+              (q[i] * sign / kMaxSmallest + 1.0) * 0.5, 0.0, 1.0);
+          packed |= static_cast<uint32_t>(std::round(unit * kElementMax))
+              << shift;
+          shift -= 10;
+        }
+        return packed;
+      }
+
+      /// \brief Unpack a rotation packed by PackRotation.
+      /// \param[in] _packed Packed rotation.
+      /// \return Unit quaternion.
+      private: static math::Quaterniond UnpackRotation(const uint32_t _packed)
+      {
+        const uint32_t largest = _packed >> 30;
+        double q[4];
+        double sumSquares{0.0};
+        int shift = 20;
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+          if (i == largest)
+            continue;
+          const double unit =
+              static_cast<double>((_packed >> shift) & kElementMax) /
+              kElementMax;
+          q[i] = (unit * 2.0 - 1.0) * kMaxSmallest;
+          sumSquares += q[i] * q[i];
+          shift -= 10;
+        }
+        q[largest] = std::sqrt(std::max(0.0, 1.0 - sumSquares));
+
+        math::Quaterniond rot(q[0], q[1], q[2], q[3]);
+        rot.Normalize();
+        return rot;
+      }
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_RANDOMSTREAM_HH_
+#define IGNITION_GAZEBO_RANDOMSTREAM_HH_
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include <ignition/gazebo/config.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class RandomStream RandomStream.hh ignition/gazebo/RandomStream.hh
+    /// \brief A random number generator whose sequence only depends on a
+    /// seed and the keys it's created with, such as an entity and an
+    /// iteration, so work split across threads draws the same numbers
+    /// whatever the number of threads and the order they run in. Unlike
+    /// math::Rand, streams aren't shared, so systems and tasks running at
+    /// the same time don't interleave their draws.
+    ///
+    /// Streams are cheap to create, so the intended use is one stream per
+    /// entity, or per chunk of a deterministic ParallelFor, see
+    /// ServerConfig::SetDeterministic:
+    ///
+    /// \code
+    /// RandomStream random(math::Rand::Seed(), _entity, _info.iterations);
+    /// double noise = random.Normal(0.0, 0.1);
+    /// \endcode
+    ///
+    /// Uniform and Normal don't use the standard distributions, whose
+    /// algorithms differ between standard libraries. The class meets the
+    /// requirements of a uniform random bit generator, so it can also be
+    /// used with standard distributions.
+    class RandomStream
+    {
+      /// \brief Type of the generated numbers.
+      public: using result_type = uint64_t;
+
+      /// \brief Constructor.
+      /// \param[in] _seed Seed shared by all streams of a simulation, such
+      /// as math::Rand::Seed().
+      /// \param[in] _key Key of the stream, such as an entity.
+      /// \param[in] _counter Counter distinguishing the streams of the same
+      /// key, such as the iteration or the first index of a chunk.
+      public: RandomStream(uint64_t _seed, uint64_t _key,
+                  uint64_t _counter = 0)
+        : state(Mix(Mix(Mix(_seed) ^ _key) ^ _counter))
+      {
+      }
+
+      /// \brief Smallest generated number.
+      /// \return 0
+      public: static constexpr result_type min()
+      {
+        return 0;
+      }
+
+      /// \brief Largest generated number.
+      /// \return Largest 64 bit integer.
+      public: static constexpr result_type max()
+      {
+        return std::numeric_limits<result_type>::max();
+      }
+
+      /// \brief Generate the next number of the stream, with SplitMix64.
+      /// \return Number between min() and max().
+      public: result_type operator()()
+      {
+        this->state += 0x9e3779b97f4a7c15ull;
+        return Mix(this->state);
+      }
+
+      /// \brief Generate a uniformly distributed number.
+      /// \return Number in [0, 1).
+      public: double Uniform()
+      {
+        return static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+      }
+
+      /// \brief Generate a uniformly distributed number.
+      /// \param[in] _min Smallest number.
+      /// \param[in] _max Largest number, excluded.
+      /// \return Number in [_min, _max).
+      public: double Uniform(double _min, double _max)
+      {
+        return _min + (_max - _min) * this->Uniform();
+      }
+
+      /// \brief Generate a normally distributed number, with the
+      /// Box-Muller transform.
+      /// \param[in] _mean Mean.
+      /// \param[in] _stdDev Standard deviation.
+      /// \return Number.
+      public: double Normal(double _mean, double _stdDev)
+      {
+        if (this->hasSpare)
+        {
+          this->hasSpare = false;
+          return _mean + _stdDev * this->spare;
+        }
+
+        // 1 - Uniform() is in (0, 1], so the logarithm is finite
+        const double radius = std::sqrt(-2.0 * std::log(1.0 - this->Uniform()));
+        const double angle = 2.0 * 3.14159265358979323846 * this->Uniform();
+        this->spare = radius * std::sin(angle);
+        this->hasSpare = true;
+        return _mean + _stdDev * radius * std::cos(angle);
+      }
+
+      /// \brief Scramble the bits of a number, the output function of
+      /// SplitMix64.
+      /// \param[in] _value Number.
+      /// \return Scrambled number.
+      private: static uint64_t Mix(uint64_t _value)
+      {
+        _value = (_value ^ (_value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        _value = (_value ^ (_value >> 27)) * 0x94d049bb133111ebull;
+        return _value ^ (_value >> 31);
+      }
+
+      /// \brief State of the generator.
+      private: uint64_t state;
+
+      /// \brief Second number of the last Box-Muller transform.
+      private: double spare{0.0};
+
+      /// \brief Whether spare wasn't returned yet.
+      private: bool hasSpare{false};
+    };
+    }
+  }
+}
+#endif
@@ -18,6 +18,7 @@
 #define IGNITION_GAZEBO_CREATEREMOVE_HH_
 
 #include <memory>
+#include <vector>
 
 #include <sdf/Actor.hh>
 #include <sdf/Collision.hh>
@@ -97,6 +98,17 @@ namespace ignition
       /// \return Model entity.
       public: Entity CreateEntities(const sdf::Model *_model);
 
+      /// \brief Create all entities that exist in many sdf::Model objects
+      /// and load their plugins. The models are converted from SDF in
+      /// parallel, and their entities are then created one model at a time,
+      /// so the result is the same as calling
+      /// CreateEntities(const sdf::Model *) for each of them in order.
+      /// \param[in] _models SDF model objects.
+      /// \return Model entities, in the same order as _models. Null models
+      /// get kNullEntity.
+      public: std::vector<Entity> CreateEntities(
+          const std::vector<const sdf::Model *> &_models);
+
       /// \brief Create all entities that exist in the sdf::Actor object and
       /// load their plugins.
       /// \param[in] _actor SDF actor object.
@@ -17,15 +17,19 @@
 #ifndef IGNITION_GAZEBO_SERVER_HH_
 #define IGNITION_GAZEBO_SERVER_HH_
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/EntityComponentManager.hh>
 #include <ignition/gazebo/Export.hh>
 #include <ignition/gazebo/ServerConfig.hh>
 #include <ignition/gazebo/SystemPluginPtr.hh>
+#include <ignition/gazebo/TensorView.hh>
 
 namespace ignition
 {
@@ -197,6 +201,14 @@ namespace ignition
       public: std::optional<uint64_t> IterationCount(
                   const unsigned int _worldIndex = 0) const;
 
+      /// \brief Get the number of iterations a world runs per wall clock
+      /// second, see ServerConfig::SetMaxThroughput.
+      /// \param[in] _worldIndex Index of the world to query.
+      /// \return Latest steps per second, 0 until measured, or
+      /// std::nullopt if _worldIndex is invalid.
+      public: std::optional<double> StepsPerSecond(
+                  const unsigned int _worldIndex = 0) const;
+
       /// \brief Get the number of entities on the server.
       /// \param[in] _worldIndex Index of the world to query.
       /// \return Entity count, or std::nullopt if _worldIndex is invalid.
@@ -271,6 +283,123 @@ namespace ignition
                                       bool _recursive = true,
                                       const unsigned int _worldIndex = 0);
 
+      /// \brief Save a snapshot of a world in memory, which can be restored
+      /// to reset the world much faster than loading it again, or to branch
+      /// off simulations from a common state. The snapshot holds all
+      /// entities and components, sim time and iterations. If the server is
+      /// running, the snapshot is taken between two iterations, before the
+      /// next one.
+      /// \param[in] _worldIndex Index of the world.
+      /// \return Id of the snapshot, or std::nullopt if _worldIndex is
+      /// invalid or the simulation is distributed.
+      public: std::optional<uint64_t> SaveSnapshot(
+                  const unsigned int _worldIndex = 0);
+
+      /// \brief Restore a snapshot saved with SaveSnapshot. Entities created
+      /// since are removed, entities removed since are created again, and
+      /// components are set back. Because physics engines keep their own
+      /// state, it's reset through commands: top level models are moved back
+      /// with components::WorldPoseCmd and stopped for one iteration with
+      /// zero velocity commands, and joints are moved back with
+      /// components::JointPositionReset and components::JointVelocityReset.
+      /// If the server is running, the snapshot is restored before the next
+      /// iteration. A snapshot can be restored any number of times.
+      /// \param[in] _id Id returned by SaveSnapshot.
+      /// \param[in] _worldIndex Index of the world.
+      /// \return True if the snapshot exists and will be restored.
+      public: bool RestoreSnapshot(uint64_t _id,
+                  const unsigned int _worldIndex = 0);
+
+      /// \brief Remove a snapshot saved with SaveSnapshot, freeing its
+      /// memory.
+      /// \param[in] _id Id returned by SaveSnapshot.
+      /// \param[in] _worldIndex Index of the world.
+      /// \return True if the snapshot existed.
+      public: bool RemoveSnapshot(uint64_t _id,
+                  const unsigned int _worldIndex = 0);
+
+      /// \brief Fork a world into a new world, which continues
+      /// independently from the current state of the source, for example to
+      /// run what-if rollouts. Components are shared copy-on-write, see
+      /// EntityComponentManager::Fork, so forking doesn't copy them. The
+      /// plugins loaded by the source are loaded again for the fork, except
+      /// for logging plugins, while systems added with AddSystem aren't.
+      ///
+      /// The fork gets the next world index. With more than one world, Run
+      /// runs each world on a thread of its own. The world controls of the
+      /// fork are served on `/world/<world_name>/fork_<n>`, and its systems
+      /// use the same topics as the ones of the source.
+      /// \param[in] _worldIndex Index of the world to fork.
+      /// \return Index of the fork, or nullopt if the server is running or
+      /// the world doesn't exist.
+      public: std::optional<unsigned int> ForkWorld(
+                  const unsigned int _worldIndex = 0);
+
+      /// \brief Function which applies the actions of a world to its
+      /// entities, for example by setting command components.
+      /// \param[in] _worldIndex Index of the world.
+      /// \param[in] _actions The world's row of BatchActions.
+      /// \param[in] _ecm The world's entity component manager.
+      public: using BatchActionCallback = std::function<void(
+                  unsigned int _worldIndex, const double *_actions,
+                  EntityComponentManager &_ecm)>;
+
+      /// \brief Function which fills the observations of a world.
+      /// \param[in] _worldIndex Index of the world.
+      /// \param[in] _ecm The world's entity component manager.
+      /// \param[out] _observations The world's row of BatchObservations.
+      public: using BatchObservationCallback = std::function<void(
+                  unsigned int _worldIndex, const EntityComponentManager &_ecm,
+                  double *_observations)>;
+
+      /// \brief Set how StepAll exchanges actions and observations with the
+      /// worlds. Each world gets a row of the action and observation
+      /// buffers, which hold the rows of all worlds next to each other, so
+      /// they can be handed to a learning framework without copies.
+      /// \param[in] _actionSize Number of actions per world.
+      /// \param[in] _onActions Called for each world before every
+      /// iteration, may be empty.
+      /// \param[in] _observationSize Number of observations per world.
+      /// \param[in] _onObservations Called for each world after the last
+      /// iteration, may be empty.
+      public: void SetBatchCallbacks(std::size_t _actionSize,
+                  BatchActionCallback _onActions,
+                  std::size_t _observationSize,
+                  BatchObservationCallback _onObservations);
+
+      /// \brief Set StepAll to exchange actions and observations through
+      /// views, instead of callbacks. Each world's row of BatchActions is
+      /// applied with the action view before every iteration, and its row of
+      /// BatchObservations is filled with the observation view after the
+      /// last one. This replaces the callbacks set with SetBatchCallbacks.
+      /// \param[in] _actions View of the fields written by actions.
+      /// \param[in] _observations View of the fields read as observations.
+      public: void SetBatchViews(const TensorView &_actions,
+                  const TensorView &_observations);
+
+      /// \brief Get the actions of all worlds, to be filled before StepAll.
+      /// \return Buffer of world count by action size values, row-major.
+      public: std::vector<double> &BatchActions();
+
+      /// \brief Get the observations of all worlds, filled by StepAll.
+      /// \return Buffer of world count by observation size values,
+      /// row-major.
+      public: const std::vector<double> &BatchObservations() const;
+
+      /// \brief Step all worlds in lockstep, as fast as possible, for
+      /// example to train on many copies of a small environment created
+      /// with ForkWorld. Every iteration steps each world once, spreading
+      /// the worlds across a thread pool, and waits for all of them before
+      /// the next one. The actions of each world are applied before every
+      /// iteration, and its observations are filled after the last one, see
+      /// SetBatchCallbacks. Worlds are unpaused first, and the update period
+      /// is ignored. Callbacks run on the pool's threads, one world at a
+      /// time per thread.
+      /// \param[in] _iterations Number of iterations.
+      /// \return False if the server is already running or the simulation
+      /// is distributed.
+      public: bool StepAll(const uint64_t _iterations = 1);
+
       /// \brief Private data
       private: std::unique_ptr<ServerPrivate> dataPtr;
     };
@@ -43,6 +43,20 @@ namespace ignition
     class IGNITION_GAZEBO_VISIBLE ServerConfig
     {
       class PluginInfoPrivate;
+
+      /// \brief How iterations wait to match the update period.
+      public: enum class PacingStrategy
+      {
+        /// \brief Sleep until the next iteration is due. The OS timer slack
+        /// delays some iterations.
+        Sleep = 0,
+
+        /// \brief Sleep until shortly before the next iteration is due,
+        /// then spin for the last PacingSpinTime, which wakes up on time
+        /// at the cost of keeping a core busy.
+        Hybrid = 1
+      };
+
       /// \brief Information about a plugin that should be loaded by the
       /// server.
       /// \detail Currently supports attaching a plugin to an entity given its
@@ -299,6 +313,169 @@ namespace ignition
       /// \param[in] _seed The seed.
       public: void SetSeed(unsigned int _seed);
 
+      /// \brief Get the number of worker threads the server uses for
+      /// parallel work, such as running PostUpdate systems,
+      /// EntityComponentManager::ParallelEach and state serialization.
+      /// \return Number of worker threads, or 0 if one less than the number
+      /// of hardware threads should be used.
+      public: unsigned int WorkerThreadCount() const;
+
+      /// \brief Set the number of worker threads the server uses for
+      /// parallel work. The thread that runs the simulation also takes part
+      /// in that work, so 1 worker keeps 2 threads busy.
+      /// \param[in] _count Number of worker threads, or 0 to use one less
+      /// than the number of hardware threads.
+      public: void SetWorkerThreadCount(unsigned int _count);
+
+      /// \brief Get whether parallel work gives the same results whatever
+      /// the number of worker threads, see SetDeterministic.
+      /// \return True if deterministic.
+      public: bool Deterministic() const;
+
+      /// \brief Set whether parallel work gives the same results whatever
+      /// the number of worker threads, so parallelism can be used in
+      /// regression tests. Work split by
+      /// EntityComponentManager::ParallelFor and ParallelEach is then split
+      /// into chunks which only depend on the number of entities, so
+      /// per-chunk results, such as partial sums, don't change. Systems and
+      /// tasks running at the same time must not draw from the shared
+      /// math::Rand generator, whose draws would interleave, but from a
+      /// RandomStream per entity or chunk. Defaults to false.
+      /// \param[in] _deterministic True to be deterministic.
+      public: void SetDeterministic(bool _deterministic);
+
+      /// \brief Get the CPUs the simulation thread is pinned to, see
+      /// SetSimulationCpus.
+      /// \return CPU list, empty if the thread isn't pinned.
+      public: std::string SimulationCpus() const;
+
+      /// \brief Pin the thread running the simulation loop to a set of
+      /// CPUs. Entities are also created on those CPUs, so on NUMA machines
+      /// component storage is allocated on their memory node. Worker threads
+      /// whose CPUs aren't set with SetWorkerCpus share these CPUs.
+      /// \param[in] _cpus CPU list in the `taskset -c` format, such as
+      /// "0-3,8". Empty to not pin the thread.
+      /// \return False if the list is malformed, in which case it's ignored.
+      public: bool SetSimulationCpus(const std::string &_cpus);
+
+      /// \brief Get the CPUs the worker threads are pinned to, see
+      /// SetWorkerCpus.
+      /// \return CPU list, empty if the threads aren't pinned.
+      public: std::string WorkerCpus() const;
+
+      /// \brief Pin the worker threads used for parallel work, see
+      /// SetWorkerThreadCount, to a set of CPUs.
+      /// \param[in] _cpus CPU list in the `taskset -c` format. Empty to use
+      /// the simulation CPUs.
+      /// \return False if the list is malformed, in which case it's ignored.
+      public: bool SetWorkerCpus(const std::string &_cpus);
+
+      /// \brief Get the CPUs the sensor render thread is pinned to, see
+      /// SetRenderCpus.
+      /// \return CPU list, empty if the thread isn't pinned.
+      public: std::string RenderCpus() const;
+
+      /// \brief Pin the render thread of the Sensors system to a set of
+      /// CPUs.
+      /// \param[in] _cpus CPU list in the `taskset -c` format. Empty to not
+      /// pin the thread.
+      /// \return False if the list is malformed, in which case it's ignored.
+      public: bool SetRenderCpus(const std::string &_cpus);
+
+      /// \brief Get whether entity slots are recycled, see
+      /// EntityComponentManager::SetEntityRecycling.
+      /// \return True if the slots of removed entities are reused.
+      public: bool EntityRecycling() const;
+
+      /// \brief Set whether the slots of removed entities are reused by new
+      /// entities, which keeps entity ids bounded in simulations that keep
+      /// spawning and removing entities. Disabled by default.
+      /// \param[in] _enabled True to reuse the slots of removed entities.
+      public: void SetEntityRecycling(const bool _enabled);
+
+      /// \brief Get whether the server runs in max throughput mode.
+      /// \return True if max throughput mode is enabled.
+      public: bool MaxThroughput() const;
+
+      /// \brief Set whether the server runs in max throughput mode, for
+      /// headless batch jobs which should run as fast as physics allows.
+      /// Iterations don't wait for the update period, statistics and the
+      /// clock are only published every ThroughputStatsPeriod, and the scene
+      /// broadcaster isn't loaded, since there is no GUI to serve. World
+      /// control requests are still handled. Disabled by default.
+      /// \param[in] _enabled True to enable max throughput mode.
+      public: void SetMaxThroughput(const bool _enabled);
+
+      /// \brief Get the wall time between statistics in max throughput
+      /// mode.
+      /// \return Wall time between statistics.
+      public: std::chrono::steady_clock::duration ThroughputStatsPeriod()
+              const;
+
+      /// \brief Set the wall time between statistics in max throughput mode.
+      /// The achieved steps per second are also printed then. Defaults to
+      /// 10 seconds.
+      /// \param[in] _period Wall time between statistics.
+      public: void SetThroughputStatsPeriod(
+                  const std::chrono::steady_clock::duration &_period);
+
+      /// \brief Get how iterations wait to match the update period.
+      /// \return The pacing strategy.
+      public: PacingStrategy Pacing() const;
+
+      /// \brief Set how iterations wait to match the update period. Hybrid
+      /// pacing is meant for high update rates, such as hardware in the loop
+      /// rigs running at 1 kHz. Defaults to PacingStrategy::Sleep.
+      /// \param[in] _pacing The pacing strategy.
+      public: void SetPacing(const PacingStrategy _pacing);
+
+      /// \brief Get how long hybrid pacing spins before each iteration.
+      /// \return Spin time.
+      public: std::chrono::steady_clock::duration PacingSpinTime() const;
+
+      /// \brief Set how long hybrid pacing spins before each iteration. It
+      /// should be longer than the usual oversleep of the OS. Defaults to
+      /// 300 microseconds.
+      /// \param[in] _spinTime Spin time.
+      public: void SetPacingSpinTime(
+                  const std::chrono::steady_clock::duration &_spinTime);
+
+      /// \brief Get the number of scopes kept by the trace recorder.
+      /// \return Number of scopes, 0 if tracing is disabled.
+      public: std::size_t TraceBufferSize() const;
+
+      /// \brief Set the number of scopes kept by the trace recorder. When
+      /// enabled, the simulation runner records each iteration, phase and
+      /// system call into a ring buffer, which is written as a Chrome trace
+      /// on request of the `trace` service, or when an iteration is slower
+      /// than TraceSlowStepThreshold. Disabled by default.
+      /// \param[in] _size Number of scopes, 0 to disable tracing.
+      public: void SetTraceBufferSize(std::size_t _size);
+
+      /// \brief Get the wall time budget of an iteration.
+      /// \return Wall time, zero if slow iterations aren't reported.
+      public: std::chrono::steady_clock::duration TraceSlowStepThreshold()
+              const;
+
+      /// \brief Set the wall time budget of an iteration. Slower iterations
+      /// log which phase and system call overran, along with the entity
+      /// component manager counters, and, if tracing is enabled, write a
+      /// trace holding the same report to TracePath. At most one iteration
+      /// is reported per second. Zero, the default, disables the budget.
+      /// \param[in] _threshold Wall time.
+      public: void SetTraceSlowStepThreshold(
+                  const std::chrono::steady_clock::duration &_threshold);
+
+      /// \brief Get the directory where slow iteration traces are written.
+      /// \return Path of the directory, empty for the current directory.
+      public: const std::string &TracePath() const;
+
+      /// \brief Set the directory where slow iteration traces are written,
+      /// as `slow_step_<iteration>.json`.
+      /// \param[in] _path Path of the directory, empty for the current
+      /// directory.
+      public: void SetTracePath(const std::string &_path);
+
       /// \brief Get the update period duration.
       /// \return The desired update period, or nullopt if
       /// an UpdateRate has not been set.
@@ -319,6 +496,34 @@ namespace ignition
       /// ~/.ignition/fuel.
       public: void SetResourceCache(const std::string &_path);
 
+      /// \brief Get the directory where worlds are cached after their
+      /// includes have been resolved, see SetWorldCachePath.
+      /// \return Path to a directory on disk. Empty if worlds aren't
+      /// cached, which is the default.
+      public: const std::string &WorldCachePath() const;
+
+      /// \brief Set the directory where worlds are cached after their
+      /// includes have been resolved. Loading a world which is in the cache
+      /// skips finding, fetching and parsing the files it includes. An entry
+      /// is ignored, and replaced, if any of the files the world was loaded
+      /// from changed.
+      /// \param[in] _path Path to a directory on disk. An empty string
+      /// disables the cache.
+      public: void SetWorldCachePath(const std::string &_path);
+
+      /// \brief Get the number of Fuel resources downloaded at once when a
+      /// world is loaded, see SetResourcePrefetchThreads.
+      /// \return Number of downloads. Defaults to 4.
+      public: unsigned int ResourcePrefetchThreads() const;
+
+      /// \brief Set the number of Fuel resources downloaded at once before
+      /// a world is parsed. The world's resources, and those of the models
+      /// they include, are downloaded in parallel so parsing finds them in
+      /// the local cache.
+      /// \param[in] _threads Number of downloads. Zero disables the
+      /// prefetch, so resources are downloaded one at a time while parsing.
+      public: void SetResourcePrefetchThreads(unsigned int _threads);
+
       /// \brief Physics engine plugin library to load.
       /// \return File containing physics engine library.
       public: const std::string &PhysicsEngine() const;
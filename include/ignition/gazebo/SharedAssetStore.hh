@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SHAREDASSETSTORE_HH_
+#define IGNITION_GAZEBO_SHAREDASSETSTORE_HH_
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN SharedAssetStorePrivate;
+
+    /// \class SharedAssetStore SharedAssetStore.hh
+    /// ignition/gazebo/SharedAssetStore.hh
+    /// \brief Read-only asset data, such as preprocessed meshes, shared by
+    /// all the server processes on a host.
+    ///
+    /// Assets are files in a directory, keyed by the hash of the content
+    /// they were made from. They're memory mapped read-only, so all the
+    /// processes which find the same asset share the same pages of the page
+    /// cache instead of each holding its own copy. Assets are written to a
+    /// temporary file which is then renamed, so readers never see partial
+    /// assets, and assets are never modified once written.
+    ///
+    /// Each asset is mapped once per process, and unmapped once the last
+    /// view of it is released.
+    ///
+    /// On Windows assets are read into memory instead of being mapped.
+    class IGNITION_GAZEBO_VISIBLE SharedAssetStore
+    {
+      /// \brief View of the data of an asset, mapped while it's held.
+      public: using Asset = std::shared_ptr<const std::string_view>;
+
+      /// \brief Constructor, which creates the directory if needed.
+      /// \param[in] _directory Directory of the assets, see
+      /// DefaultDirectory.
+      public: explicit SharedAssetStore(const std::string &_directory);
+
+      /// \brief Destructor
+      public: ~SharedAssetStore();
+
+      /// \brief Whether the directory exists.
+      /// \return True if assets can be stored.
+      public: bool Valid() const;
+
+      /// \brief Get the directory of the assets.
+      /// \return Directory.
+      public: const std::string &Directory() const;
+
+      /// \brief Find an asset stored by this or another process.
+      /// \param[in] _key Asset key, see ContentKey.
+      /// \return The asset, or nullptr if it isn't stored.
+      public: Asset Find(const std::string &_key) const;
+
+      /// \brief Store an asset, replacing any asset with the same key.
+      /// \param[in] _key Asset key, see ContentKey. Only letters, digits,
+      /// dashes and underscores are allowed.
+      /// \param[in] _data Asset data.
+      /// \return The stored asset, or nullptr if it couldn't be written.
+      public: Asset Insert(const std::string &_key,
+                  const std::string &_data) const;
+
+      /// \brief Get a key for the asset made from some content, which is
+      /// the same in all processes and across runs.
+      /// \param[in] _content Content, such as the contents of a mesh file.
+      /// \return Key made of the hash and the size of the content.
+      public: static std::string ContentKey(const std::string &_content);
+
+      /// \brief Get the default directory of the assets.
+      /// \return `~/.ignition/gazebo/assets`
+      public: static std::string DefaultDirectory();
+
+      /// \brief Private data pointer
+      private: std::unique_ptr<SharedAssetStorePrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SHAREDMEMORYCHANNEL_HH_
+#define IGNITION_GAZEBO_SHAREDMEMORYCHANNEL_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN SharedMemoryWriterPrivate;
+    class IGNITION_GAZEBO_HIDDEN SharedMemoryReaderPrivate;
+
+    /// \brief Get the name of the shared memory channel which carries the
+    /// state of a world, see systems::SceneBroadcaster.
+    /// \param[in] _worldName World name.
+    /// \return Channel name.
+    std::string IGNITION_GAZEBO_VISIBLE stateChannelName(
+        const std::string &_worldName);
+
+    /// \brief Get the name of the shared memory channel which carries the
+    /// same messages as a transport topic, such as the images of a camera,
+    /// see systems::Sensors.
+    /// \param[in] _topic Topic name.
+    /// \return Channel name.
+    std::string IGNITION_GAZEBO_VISIBLE topicChannelName(
+        const std::string &_topic);
+
+    /// \class SharedMemoryWriter SharedMemoryChannel.hh
+    /// ignition/gazebo/SharedMemoryChannel.hh
+    /// \brief Writes messages into a ring buffer in shared memory, so that
+    /// processes on the same host can read them without going through
+    /// sockets.
+    ///
+    /// The ring has a fixed number of slots of a fixed size. There's a
+    /// single writer, which never waits for readers: slots are overwritten
+    /// once the ring wraps around, and readers which fall behind detect it
+    /// and skip to the newest message. Each slot is guarded by a sequence
+    /// counter, so readers never see partly written messages.
+    ///
+    /// Only available on POSIX systems. The channel is removed when the
+    /// writer is destroyed.
+    class IGNITION_GAZEBO_VISIBLE SharedMemoryWriter
+    {
+      /// \brief Constructor, which creates the channel, replacing any
+      /// channel left over with the same name.
+      /// \param[in] _name Channel name, without slashes.
+      /// \param[in] _slotCount Number of messages kept in the ring.
+      /// \param[in] _slotSize Largest message size in bytes.
+      public: SharedMemoryWriter(const std::string &_name,
+                  std::size_t _slotCount, std::size_t _slotSize);
+
+      /// \brief Destructor
+      public: ~SharedMemoryWriter();
+
+      /// \brief Whether the channel was created.
+      /// \return True if messages can be written.
+      public: bool Valid() const;
+
+      /// \brief Get the largest message size.
+      /// \return Size in bytes.
+      public: std::size_t SlotSize() const;
+
+      /// \brief Get a slot to write the next message into, which avoids
+      /// copying messages which can be serialized in place. Readers don't
+      /// see the message until Commit is called.
+      /// \param[in] _size Message size in bytes.
+      /// \return Pointer to _size writable bytes, or nullptr if the channel
+      /// isn't valid or the message doesn't fit in a slot.
+      public: void *Reserve(std::size_t _size);
+
+      /// \brief Publish the message written into the last reserved slot.
+      /// Has no effect if no slot is reserved.
+      public: void Commit();
+
+      /// \brief Copy a message into the ring and publish it.
+      /// \param[in] _data Message bytes.
+      /// \param[in] _size Message size in bytes.
+      /// \return True if the message was written.
+      public: bool Write(const void *_data, std::size_t _size);
+
+      /// \brief Get the number of messages written so far.
+      /// \return Sequence number of the last message, starting at 1.
+      public: uint64_t Sequence() const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<SharedMemoryWriterPrivate> dataPtr;
+    };
+
+    /// \class SharedMemoryReader SharedMemoryChannel.hh
+    /// ignition/gazebo/SharedMemoryChannel.hh
+    /// \brief Reads messages from a SharedMemoryWriter's ring, which is
+    /// mapped read-only.
+    ///
+    /// Messages are read in order, starting with the newest message when
+    /// the reader was created. Readers never block the writer.
+    class IGNITION_GAZEBO_VISIBLE SharedMemoryReader
+    {
+      /// \brief Constructor, which maps an existing channel.
+      /// \param[in] _name Channel name, as given to the writer.
+      public: explicit SharedMemoryReader(const std::string &_name);
+
+      /// \brief Destructor
+      public: ~SharedMemoryReader();
+
+      /// \brief Whether the channel was mapped.
+      /// \return True if messages can be read.
+      public: bool Valid() const;
+
+      /// \brief Read the next message, if there's one.
+      /// \param[out] _data Message bytes. The string's memory is reused.
+      /// \return True if a message was read, false if there are no new
+      /// messages.
+      public: bool Read(std::string &_data);
+
+      /// \brief Get the number of messages which were overwritten before
+      /// they could be read.
+      /// \return Number of missed messages.
+      public: uint64_t Missed() const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<SharedMemoryReaderPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SPATIALINDEX_HH_
+#define IGNITION_GAZEBO_SPATIALINDEX_HH_
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Frustum.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN SpatialIndexPrivate;
+
+    /// \class SpatialIndex SpatialIndex.hh ignition/gazebo/SpatialIndex.hh
+    /// \brief Index of entity boxes for range queries.
+    ///
+    /// Boxes are stored in a uniform grid of cubic cells, so queries only
+    /// look at the entities in the cells they overlap instead of at all
+    /// entities. Moving an entity only touches the cells it leaves and
+    /// enters. Boxes spanning many cells, such as ground planes, are kept
+    /// aside and checked by every query.
+    ///
+    /// The entity component manager keeps an index of world boxes, see
+    /// EntityComponentManager::EnableSpatialIndex.
+    class IGNITION_GAZEBO_VISIBLE SpatialIndex
+    {
+      /// \brief Constructor
+      /// \param[in] _cellSize Size of the grid cells in meters. Cells
+      /// around the typical entity size work best.
+      public: explicit SpatialIndex(double _cellSize = 1.0);
+
+      /// \brief Destructor
+      public: ~SpatialIndex();
+
+      /// \brief Get the size of the grid cells.
+      /// \return Cell size in meters.
+      public: double CellSize() const;
+
+      /// \brief Set the size of the grid cells, which rebuilds the grid.
+      /// \param[in] _cellSize Size in meters, must be positive.
+      public: void SetCellSize(double _cellSize);
+
+      /// \brief Add an entity, or move it if it was already added.
+      /// \param[in] _entity Entity.
+      /// \param[in] _box Box of the entity. Use a box with equal corners for
+      /// entities without volume.
+      public: void Update(const Entity _entity,
+                  const math::AxisAlignedBox &_box);
+
+      /// \brief Remove an entity. Has no effect if it wasn't added.
+      /// \param[in] _entity Entity.
+      public: void Remove(const Entity _entity);
+
+      /// \brief Remove all entities.
+      public: void Clear();
+
+      /// \brief Get the number of entities.
+      /// \return Number of entities in the index.
+      public: std::size_t Size() const;
+
+      /// \brief Get the box of an entity.
+      /// \param[in] _entity Entity.
+      /// \return Box, or nullopt if the entity wasn't added.
+      public: std::optional<math::AxisAlignedBox> Box(
+                  const Entity _entity) const;
+
+      /// \brief Get the entities whose box intersects a box.
+      /// \param[in] _box Box to query.
+      /// \return Entities, in no particular order.
+      public: std::vector<Entity> QueryBox(
+                  const math::AxisAlignedBox &_box) const;
+
+      /// \brief Get the entities whose box intersects a sphere.
+      /// \param[in] _center Center of the sphere.
+      /// \param[in] _radius Radius of the sphere.
+      /// \return Entities, in no particular order.
+      public: std::vector<Entity> QuerySphere(const math::Vector3d &_center,
+                  double _radius) const;
+
+      /// \brief Get the entities whose box is at least partly inside a
+      /// frustum.
+      /// \param[in] _frustum Frustum to query.
+      /// \return Entities, in no particular order.
+      public: std::vector<Entity> QueryFrustum(
+                  const math::Frustum &_frustum) const;
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<SpatialIndexPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
@@ -18,6 +18,7 @@
 #define IGNITION_GAZEBO_SYSTEM_HH_
 
 #include <memory>
+#include <set>
 
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/EntityComponentManager.hh>
@@ -114,6 +115,52 @@ namespace ignition
                                   EntityComponentManager &_ecm) = 0;
     };
 
+    /// \brief Component types, and optionally entities, that a system
+    /// accesses during PreUpdate and Update. See ISystemComponentAccess.
+    struct ComponentAccess
+    {
+      /// \brief Types of the components which are only read.
+      std::set<ComponentTypeId> reads;
+
+      /// \brief Types of the components which are modified.
+      std::set<ComponentTypeId> writes;
+
+      /// \brief If not empty, the system only accesses components of these
+      /// entities and their descendants, for example its model. If empty,
+      /// components of any entity may be accessed.
+      std::set<Entity> entities;
+    };
+
+    /// \class ISystemComponentAccess ISystem.hh ignition/gazebo/System.hh
+    /// \brief Optional interface for a system that declares which
+    /// components it accesses during PreUpdate and Update.
+    ///
+    /// Systems which don't implement this interface run one at a time, in
+    /// the order they were added. Consecutive systems which implement it,
+    /// and whose declared accesses don't conflict, may have their PreUpdate
+    /// or Update called at the same time from different threads. Two
+    /// accesses conflict if one writes a component type that the other
+    /// reads or writes, and their entities overlap.
+    ///
+    /// By implementing this interface, a system promises that in PreUpdate
+    /// and Update it:
+    ///  * Only reads components of the types in `reads` or `writes`, and
+    ///    only modifies components of the types in `writes`.
+    ///  * Only accesses components of `entities` and their descendants, if
+    ///    any entities are given.
+    ///  * Doesn't create or remove entities or components. Calling
+    ///    SetChanged() is allowed.
+    ///  * Doesn't share unsynchronized state with other systems.
+    class ISystemComponentAccess {
+      /// \brief Get the components accessed by this system. This is called
+      /// after Configure, when the system is added to simulation.
+      /// \param[in] _ecm The EntityComponentManager of the given simulation
+      /// instance.
+      /// \return The accessed components.
+      public: virtual ComponentAccess Access(
+                  const EntityComponentManager &_ecm) = 0;
+    };
+
     /// \class ISystemPostUpdate ISystem.hh ignition/gazebo/System.hh
     /// \brief Interface for a system that uses the PostUpdate phase
     class ISystemPostUpdate{
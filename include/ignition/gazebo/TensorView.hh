@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_TENSORVIEW_HH_
+#define IGNITION_GAZEBO_TENSORVIEW_HH_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/components/Component.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class IGNITION_GAZEBO_HIDDEN TensorViewPrivate;
+
+    /// \class TensorView TensorView.hh ignition/gazebo/TensorView.hh
+    /// \brief Maps fields of components to a contiguous buffer of values,
+    /// for example to exchange observations and actions with a learning
+    /// framework. Fields are bound once, each to one value of the buffer,
+    /// and then the whole buffer is filled from, or applied to, an entity
+    /// component manager in a single pass.
+    ///
+    /// The components are looked up once and their pointers are kept until
+    /// the manager's component layout changes, see
+    /// EntityComponentManager::ComponentLayoutGeneration. Pointers are kept
+    /// for each manager the view is used with, so the same view can be used
+    /// for several worlds at the same time, as long as each world is only
+    /// used from one thread at a time.
+    ///
+    /// The buffer is owned by the caller, so it can be memory shared with
+    /// a framework, such as a numpy array, without copies. See also
+    /// Server::SetBatchViews.
+    ///
+    /// Example binding the height of a model and the force command of a
+    /// joint:
+    ///
+    /// \code
+    /// TensorView observations;
+    /// observations.Bind<components::Pose>(model,
+    ///     [](const math::Pose3d &_pose) {return _pose.Pos().Z();});
+    ///
+    /// TensorView actions;
+    /// actions.Bind<components::JointForceCmd>(joint,
+    ///     [](std::vector<double> &_force, double _value)
+    ///     {
+    ///       _force.resize(1);
+    ///       _force[0] = _value;
+    ///     });
+    /// \endcode
+    class IGNITION_GAZEBO_VISIBLE TensorView
+    {
+      /// \brief Function reading a value from a component.
+      public: using Getter =
+          std::function<double(const components::BaseComponent &)>;
+
+      /// \brief Function writing a value to a component.
+      public: using Setter =
+          std::function<void(components::BaseComponent &, double)>;
+
+      /// \brief Function looking up a component of an entity.
+      public: using Lookup = std::function<const components::BaseComponent *(
+          const EntityComponentManager &)>;
+
+      /// \brief Function looking up a mutable component of an entity, which
+      /// creates a missing one when it can.
+      public: using MutableLookup = std::function<components::BaseComponent *(
+          EntityComponentManager &)>;
+
+      /// \brief Constructor
+      public: TensorView();
+
+      /// \brief Copy constructor. The copy has the same bindings, and looks
+      /// up its components again.
+      /// \param[in] _view View to copy.
+      public: TensorView(const TensorView &_view);
+
+      /// \brief Move constructor
+      /// \param[in] _view View to move.
+      public: TensorView(TensorView &&_view) noexcept;
+
+      /// \brief Destructor
+      public: ~TensorView();
+
+      /// \brief Copy assignment operator.
+      /// \param[in] _view View to copy.
+      /// \return Reference to this view.
+      public: TensorView &operator=(const TensorView &_view);
+
+      /// \brief Move assignment operator.
+      /// \param[in] _view View to move.
+      /// \return Reference to this view.
+      public: TensorView &operator=(TensorView &&_view) noexcept;
+
+      /// \brief Bind a field of a component, so it can be read with Fill.
+      /// \param[in] _entity Entity with the component.
+      /// \param[in] _get Function reading the field from the component's
+      /// data.
+      /// \return Index of the field's value in the buffer.
+      /// \tparam ComponentTypeT Component type.
+      public: template <typename ComponentTypeT>
+              std::size_t Bind(const Entity _entity,
+                  std::function<double(const typename ComponentTypeT::Type &)>
+                  _get)
+              {
+                return this->AddBinding(_entity, ComponentTypeT::typeId,
+                    Lookup(LookupComponent<ComponentTypeT>(_entity)),
+                    MutableLookup(),
+                    [_get](const components::BaseComponent &_comp)
+                    {
+                      return _get(
+                          static_cast<const ComponentTypeT &>(_comp).Data());
+                    },
+                    Setter());
+              }
+
+      /// \brief Bind a field of a component, so it can be written with
+      /// Apply. Components which are missing when the view is applied are
+      /// created, if their type can be default constructed.
+      /// \param[in] _entity Entity with the component.
+      /// \param[in] _set Function writing a value to the field of the
+      /// component's data.
+      /// \return Index of the field's value in the buffer.
+      /// \tparam ComponentTypeT Component type.
+      public: template <typename ComponentTypeT>
+              std::size_t Bind(const Entity _entity,
+                  std::function<void(typename ComponentTypeT::Type &, double)>
+                  _set)
+              {
+                return this->AddBinding(_entity, ComponentTypeT::typeId,
+                    Lookup(LookupComponent<ComponentTypeT>(_entity)),
+                    [_entity](EntityComponentManager &_ecm)
+                        -> components::BaseComponent *
+                    {
+                      auto comp = _ecm.Component<ComponentTypeT>(_entity);
+                      if constexpr (
+                          std::is_default_constructible_v<ComponentTypeT>)
+                      {
+                        if (nullptr == comp && _ecm.HasEntity(_entity))
+                        {
+                          _ecm.CreateComponent(_entity, ComponentTypeT());
+                          comp = _ecm.Component<ComponentTypeT>(_entity);
+                        }
+                      }
+                      return comp;
+                    },
+                    Getter(),
+                    [_set](components::BaseComponent &_comp, double _value)
+                    {
+                      _set(static_cast<ComponentTypeT &>(_comp).Data(),
+                          _value);
+                    });
+              }
+
+      /// \brief Bind a field of a component given type-erased functions,
+      /// such as the ones the Bind templates create.
+      /// \param[in] _entity Entity with the component.
+      /// \param[in] _type Type of the component.
+      /// \param[in] _lookup Looks up the component for Fill.
+      /// \param[in] _mutableLookup Looks up the component for Apply, may be
+      /// empty if the field isn't written.
+      /// \param[in] _get Reads the field, may be empty if it isn't read.
+      /// \param[in] _set Writes the field, may be empty if it isn't
+      /// written.
+      /// \return Index of the field's value in the buffer.
+      public: std::size_t AddBinding(const Entity _entity,
+                  const ComponentTypeId _type, Lookup _lookup,
+                  MutableLookup _mutableLookup, Getter _get, Setter _set);
+
+      /// \brief Get the number of values in the buffer.
+      /// \return Number of bound fields.
+      public: std::size_t Size() const;
+
+      /// \brief Fill a buffer with the bound fields. Values of fields which
+      /// can't be read, because their component is missing or they were
+      /// bound for writing, are set to quiet NaN.
+      /// \param[in] _ecm Entity component manager to read from.
+      /// \param[out] _buffer Buffer of at least Size() values.
+      public: void Fill(const EntityComponentManager &_ecm,
+                  double *_buffer) const;
+
+      /// \brief Write the values of a buffer to the bound fields, and mark
+      /// their components as changed. Fields bound for reading, and NaN
+      /// values, are skipped.
+      /// \param[in] _buffer Buffer of at least Size() values.
+      /// \param[in] _ecm Entity component manager to write to.
+      public: void Apply(const double *_buffer,
+                  EntityComponentManager &_ecm) const;
+
+      /// \brief Forget the components looked up for all managers, for
+      /// example before a manager the view was used with is destroyed and
+      /// another one may reuse its address.
+      public: void Reset();
+
+      /// \brief Create a function looking up a component.
+      /// \param[in] _entity Entity with the component.
+      /// \return The function.
+      /// \tparam ComponentTypeT Component type.
+      private: template <typename ComponentTypeT>
+               static auto LookupComponent(const Entity _entity)
+               {
+                 return [_entity](const EntityComponentManager &_ecm)
+                     -> const components::BaseComponent *
+                 {
+                   return _ecm.Component<ComponentTypeT>(_entity);
+                 };
+               }
+
+      /// \brief Private data pointer.
+      private: std::unique_ptr<TensorViewPrivate> dataPtr;
+    };
+    }
+  }
+}
+#endif
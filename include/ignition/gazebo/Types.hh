@@ -76,7 +76,8 @@ namespace ignition
     };
 
     /// \brief A unique identifier for a component instance. The uniqueness
-    /// of a ComponentId is scoped to the component's type.
+    /// of a ComponentId is scoped to the component's type, and the id of a
+    /// removed component may be given to a new one.
     /// \sa ComponentKey.
     using ComponentId = int;
 
@@ -17,6 +17,7 @@
 #ifndef IGNITION_GAZEBO_UTIL_HH_
 #define IGNITION_GAZEBO_UTIL_HH_
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -34,7 +35,10 @@ namespace ignition
     // Inline bracket to help doxygen filtering.
     inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     //
-    /// \brief Helper function to compute world pose of an entity
+    /// \brief Helper function to compute world pose of an entity. The pose
+    /// cached by EntityComponentManager::CachedWorldPose is returned when
+    /// there's one, otherwise the poses of the entity's ancestors are
+    /// composed.
     /// \param[in] _entity Entity to get the world pose for
     /// \param[in] _ecm Immutable reference to ECM.
     /// \return World pose of entity
@@ -42,6 +46,8 @@ namespace ignition
         const EntityComponentManager &_ecm);
 
     /// \brief Helper function to generate scoped name for an entity.
+    /// Names are cached by the ECM until names or parents change, see
+    /// EntityComponentManager::CachedScopedName.
     /// \param[in] _entity Entity to get the name for.
     /// \param[in] _ecm Immutable reference to ECM.
     /// \param[in] _delim Delimiter to put between names, defaults to "/".
@@ -120,6 +126,21 @@ namespace ignition
     std::string IGNITION_GAZEBO_VISIBLE asFullPath(const std::string &_uri,
         const std::string &_filePath);
 
+    /// \brief Find a resource, such as a mesh or a texture, from its URI
+    /// as written in SDF. Found resources are cached for the whole process,
+    /// so each URI is only searched for once no matter how many entities
+    /// use it. The cache is cleared by addResourcePaths. Resources which
+    /// aren't found aren't cached, so they can still be found once they're
+    /// downloaded or their paths are added.
+    /// \param[in] _uri URI, which can have a scheme, or be full or relative
+    /// paths.
+    /// \param[in] _filePath The path to the file the URI was loaded from,
+    /// see asFullPath.
+    /// \return Full path to the resource, or an empty string if it wasn't
+    /// found.
+    std::string IGNITION_GAZEBO_VISIBLE findResource(const std::string &_uri,
+        const std::string &_filePath);
+
     /// \brief Get resource paths based on latest environment variables.
     /// \return All paths in the IGN_GAZEBO_RESOURCE_PATH variable.
     std::vector<std::string> IGNITION_GAZEBO_VISIBLE resourcePaths();
@@ -131,7 +152,8 @@ namespace ignition
     void IGNITION_GAZEBO_VISIBLE addResourcePaths(
         const std::vector<std::string> &_paths = {});
 
-    /// \brief Get the top level model of an entity
+    /// \brief Get the top level model of an entity. Results are cached by
+    /// the ECM, see EntityComponentManager::CachedTopLevelModel.
     /// \param[in] _entity Input entity
     /// \param[in] _ecm Constant reference to ECM.
     /// \return Entity of top level model. If _entity has no top level model,
@@ -155,6 +177,26 @@ namespace ignition
     std::string IGNITION_GAZEBO_VISIBLE validTopic(
         const std::vector<std::string> &_topics);
 
+    /// \brief Parse a CPU list in the format used by `taskset -c` and
+    /// `/sys/devices/system/cpu`, such as "0-3,8,10-11".
+    /// \param[in] _cpus CPU list. An empty list holds no CPUs.
+    /// \return Sorted CPU indices without duplicates, or nullopt if the
+    /// list is malformed.
+    std::optional<std::vector<unsigned int>> IGNITION_GAZEBO_VISIBLE
+        parseCpuList(const std::string &_cpus);
+
+    /// \brief Restrict the calling thread to a set of CPUs. Threads created
+    /// afterwards by the calling thread inherit the set. This is only
+    /// supported on Linux.
+    /// \param[in] _cpus CPU indices. Empty to leave the thread unchanged.
+    /// \return True if the thread was pinned, or if _cpus is empty.
+    bool IGNITION_GAZEBO_VISIBLE setThreadAffinity(
+        const std::vector<unsigned int> &_cpus);
+
+    /// \brief Get the CPUs the calling thread may run on.
+    /// \return CPU indices, empty if the platform doesn't support affinity.
+    std::vector<unsigned int> IGNITION_GAZEBO_VISIBLE threadAffinity();
+
     /// \brief Environment variable holding resource paths.
     const std::string kResourcePathEnv{"IGN_GAZEBO_RESOURCE_PATH"};
 
@@ -22,6 +22,7 @@
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/Export.hh>
 
+#include <ignition/gazebo/components/BinarySerializer.hh>
 #include <ignition/gazebo/components/Factory.hh>
 #include "ignition/gazebo/components/Component.hh"
 
@@ -36,14 +37,16 @@ namespace components
   /// \brief A component type that contains angular velocity of an entity
   /// represented by ignition::math::Vector3d.
   using AngularVelocity =
-    Component<math::Vector3d, class AngularVelocityTag>;
+    Component<math::Vector3d, class AngularVelocityTag,
+      serializers::BinarySerializer<math::Vector3d>>;
   IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.AngularVelocity",
       AngularVelocity)
 
   /// \brief A component type that contains angular velocity of an entity in the
   /// world frame represented by ignition::math::Vector3d.
   using WorldAngularVelocity =
-      Component<math::Vector3d, class WorldAngularVelocityTag>;
+      Component<math::Vector3d, class WorldAngularVelocityTag,
+      serializers::BinarySerializer<math::Vector3d>>;
   IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.WorldAngularVelocity",
       WorldAngularVelocity)
 }
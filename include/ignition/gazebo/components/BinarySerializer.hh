@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GAZEBO_COMPONENTS_BINARYSERIALIZER_HH_
+#define IGNITION_GAZEBO_COMPONENTS_BINARYSERIALIZER_HH_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include <ignition/gazebo/components/Component.hh>
+#include <ignition/gazebo/config.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace serializers
+{
+  /// \brief Fixed size binary layout of a data type, used by
+  /// BinarySerializer. Trivially copyable types are copied as they are,
+  /// other types need a specialization.
+  /// \tparam DataType Type to lay out.
+  template <typename DataType>
+  class BinaryLayout
+  {
+    static_assert(std::is_trivially_copyable<DataType>::value,
+        "BinaryLayout needs a specialization for this type");
+
+    /// \brief Number of bytes taken by the data.
+    public: static constexpr std::size_t kSize{sizeof(DataType)};
+
+    /// \brief Write the data.
+    /// \param[in] _data Data to write.
+    /// \param[out] _out Start of kSize bytes to write into.
+    public: static void Write(const DataType &_data, char *_out)
+    {
+      std::memcpy(_out, &_data, kSize);
+    }
+
+    /// \brief Read the data.
+    /// \param[in] _in Start of kSize bytes to read from.
+    /// \param[out] _data Data to populate.
+    public: static void Read(const char *_in, DataType &_data)
+    {
+      std::memcpy(&_data, _in, kSize);
+    }
+  };
+
+  /// \brief Binary layout of a math::Vector3d, as X, Y and Z.
+  template <>
+  class BinaryLayout<math::Vector3d>
+  {
+    /// \brief Number of bytes taken by the data.
+    public: static constexpr std::size_t kSize{3 * sizeof(double)};
+
+    /// \brief Write the data.
+    /// \param[in] _data Data to write.
+    /// \param[out] _out Start of kSize bytes to write into.
+    public: static void Write(const math::Vector3d &_data, char *_out)
+    {
+      const double values[3]{_data.X(), _data.Y(), _data.Z()};
+      std::memcpy(_out, values, kSize);
+    }
+
+    /// \brief Read the data.
+    /// \param[in] _in Start of kSize bytes to read from.
+    /// \param[out] _data Data to populate.
+    public: static void Read(const char *_in, math::Vector3d &_data)
+    {
+      double values[3];
+      std::memcpy(values, _in, kSize);
+      _data.Set(values[0], values[1], values[2]);
+    }
+  };
+
+  /// \brief Binary layout of a math::Pose3d, as the X, Y and Z position
+  /// followed by the W, X, Y and Z of the rotation. Unlike the text format,
+  /// the quaternion is kept exactly.
+  template <>
+  class BinaryLayout<math::Pose3d>
+  {
+    /// \brief Number of bytes taken by the data.
+    public: static constexpr std::size_t kSize{7 * sizeof(double)};
+
+    /// \brief Write the data.
+    /// \param[in] _data Data to write.
+    /// \param[out] _out Start of kSize bytes to write into.
+    public: static void Write(const math::Pose3d &_data, char *_out)
+    {
+      const double values[7]{_data.Pos().X(), _data.Pos().Y(),
+          _data.Pos().Z(), _data.Rot().W(), _data.Rot().X(), _data.Rot().Y(),
+          _data.Rot().Z()};
+      std::memcpy(_out, values, kSize);
+    }
+
+    /// \brief Read the data.
+    /// \param[in] _in Start of kSize bytes to read from.
+    /// \param[out] _data Data to populate.
+    public: static void Read(const char *_in, math::Pose3d &_data)
+    {
+      double values[7];
+      std::memcpy(values, _in, kSize);
+      _data.Pos().Set(values[0], values[1], values[2]);
+      _data.Rot().Set(values[3], values[4], values[5], values[6]);
+    }
+  };
+
+  /// \brief Compact binary layout of a math::Pose3d, for state streams on
+  /// constrained links. The position is stored as 32 bit multiples of a
+  /// resolution, which is stored too, and each quaternion element as a
+  /// 16 bit fraction. Buffers are 25 bytes, instead of 57 for BinaryLayout.
+  /// Poses of BinarySerializer components can be read from either layout.
+  class QuantizedPoseLayout
+  {
+    /// \brief First byte of quantized buffers.
+    public: static constexpr char kMarker{'\1'};
+
+    /// \brief Number of bytes taken by a quantized pose, with its marker.
+    public: static constexpr std::size_t kSize{
+        1 + sizeof(float) + 3 * sizeof(int32_t) + 4 * sizeof(int16_t)};
+
+    /// \brief Write a quantized pose, replacing the contents of a buffer.
+    /// Positions beyond what 32 bits of the resolution can hold are
+    /// clamped.
+    /// \param[in] _pose Pose to write.
+    /// \param[in] _resolution Position resolution in meters, must be
+    /// positive.
+    /// \param[out] _buffer Buffer to fill.
+    public: static void Write(const math::Pose3d &_pose,
+        const double _resolution, std::string &_buffer)
+    {
+      const float resolution = static_cast<float>(_resolution);
+      const double pos[3]{_pose.Pos().X(), _pose.Pos().Y(), _pose.Pos().Z()};
+      int32_t quantizedPos[3];
+      for (int i = 0; i < 3; ++i)
+      {
+        quantizedPos[i] = static_cast<int32_t>(std::clamp(
+            std::round(pos[i] / resolution), double(INT32_MIN),
+            double(INT32_MAX)));
+      }
+
+      const double rot[4]{_pose.Rot().W(), _pose.Rot().X(), _pose.Rot().Y(),
+          _pose.Rot().Z()};
+      int16_t quantizedRot[4];
+      for (int i = 0; i < 4; ++i)
+      {
+        quantizedRot[i] = static_cast<int16_t>(std::round(
+            std::clamp(rot[i], -1.0, 1.0) * INT16_MAX));
+      }
+
+      _buffer.resize(kSize);
+      char *out = &_buffer[0];
+      *out++ = kMarker;
+      std::memcpy(out, &resolution, sizeof(resolution));
+      out += sizeof(resolution);
+      std::memcpy(out, quantizedPos, sizeof(quantizedPos));
+      out += sizeof(quantizedPos);
+      std::memcpy(out, quantizedRot, sizeof(quantizedRot));
+    }
+
+    /// \brief Read a quantized pose.
+    /// \param[in] _buffer Buffer filled by Write.
+    /// \param[out] _pose Pose to populate. The rotation is normalized.
+    /// \return False if the buffer doesn't hold a quantized pose.
+    public: static bool Read(const std::string &_buffer, math::Pose3d &_pose)
+    {
+      if (_buffer.size() != kSize || _buffer[0] != kMarker)
+        return false;
+
+      float resolution;
+      int32_t quantizedPos[3];
+      int16_t quantizedRot[4];
+      const char *in = _buffer.data() + 1;
+      std::memcpy(&resolution, in, sizeof(resolution));
+      in += sizeof(resolution);
+      std::memcpy(quantizedPos, in, sizeof(quantizedPos));
+      in += sizeof(quantizedPos);
+      std::memcpy(quantizedRot, in, sizeof(quantizedRot));
+
+      _pose.Pos().Set(quantizedPos[0] * double(resolution),
+          quantizedPos[1] * double(resolution),
+          quantizedPos[2] * double(resolution));
+
+      double rot[4];
+      double norm{0.0};
+      for (int i = 0; i < 4; ++i)
+      {
+        rot[i] = quantizedRot[i] / double(INT16_MAX);
+        norm += rot[i] * rot[i];
+      }
+      norm = std::sqrt(norm);
+      if (norm > 0.0)
+      {
+        _pose.Rot().Set(rot[0] / norm, rot[1] / norm, rot[2] / norm,
+            rot[3] / norm);
+      }
+      else
+      {
+        _pose.Rot().Set(1, 0, 0, 0);
+      }
+      return true;
+    }
+  };
+
+  /// \brief Serializer for small fixed size data which is updated every
+  /// step, such as poses and velocities. Streams still use the text format
+  /// of `TextSerializer`, so printing components doesn't change, but buffers,
+  /// which are used for state messages, hold a copy of the bytes laid out by
+  /// BinaryLayout behind a marker byte. Buffers without the marker, such as
+  /// those in older logs, are read as text. Poses can also be read from
+  /// QuantizedPoseLayout buffers.
+  /// \tparam DataType Type of the component data.
+  /// \tparam TextSerializer Serializer used for streams.
+  template <typename DataType,
+            typename TextSerializer = DefaultSerializer<DataType>>
+  class BinarySerializer
+  {
+    /// \brief Layout of the data in buffers.
+    private: using Layout = BinaryLayout<DataType>;
+
+    /// \brief First byte of binary buffers. Text never starts with it.
+    private: static constexpr char kMarker{'\0'};
+
+    /// \brief Serialization
+    /// \param[in] _out Output stream.
+    /// \param[in] _data Data to stream.
+    /// \return The stream.
+    public: static std::ostream &Serialize(std::ostream &_out,
+        const DataType &_data)
+    {
+      return TextSerializer::Serialize(_out, _data);
+    }
+
+    /// \brief Deserialization
+    /// \param[in] _in Input stream.
+    /// \param[out] _data Data to populate.
+    /// \return The stream.
+    public: static std::istream &Deserialize(std::istream &_in,
+        DataType &_data)
+    {
+      return TextSerializer::Deserialize(_in, _data);
+    }
+
+    /// \brief Serialization into a buffer. Resizing to the same size every
+    /// step doesn't allocate.
+    /// \param[out] _buffer Buffer to fill.
+    /// \param[in] _data Data to serialize.
+    public: static void Serialize(std::string &_buffer, const DataType &_data)
+    {
+      _buffer.resize(1 + Layout::kSize);
+      _buffer[0] = kMarker;
+      Layout::Write(_data, &_buffer[1]);
+    }
+
+    /// \brief Deserialization from a buffer
+    /// \param[in] _buffer Buffer with serialized data.
+    /// \param[out] _data Data to populate.
+    public: static void Deserialize(const std::string &_buffer,
+        DataType &_data)
+    {
+      if (_buffer.size() == 1 + Layout::kSize && _buffer[0] == kMarker)
+      {
+        Layout::Read(_buffer.data() + 1, _data);
+        return;
+      }
+
+      if constexpr (std::is_same<DataType, math::Pose3d>::value)
+      {
+        if (QuantizedPoseLayout::Read(_buffer, _data))
+          return;
+      }
+
+      std::istringstream istr(_buffer);
+      TextSerializer::Deserialize(istr, _data);
+    }
+  };
+}
+}
+}
+}
+
+#endif
@@ -21,6 +21,7 @@
 #include <memory>
 #include <string>
 #include <sstream>
+#include <type_traits>
 #include <utility>
 
 #include <ignition/common/Console.hh>
@@ -96,6 +97,26 @@ namespace traits
     public: static constexpr bool value =  // NOLINT
                 decltype(Test<Stream, DataType>(0))::value;
   };
+
+  /// \brief Type trait that determines if a serializer can write `DataType`
+  /// straight into a byte buffer, i.e, it checks if the function
+  /// `Serializer::Serialize(std::string &, const DataType &)` exists.
+  /// Such serializers must also implement
+  /// `Serializer::Deserialize(const std::string &, DataType &)`.
+  template <typename Serializer, typename DataType>
+  class IsBufferSerializer
+  {
+    private: template <typename SerializerArg, typename DataTypeArg>
+    static auto Test(int _test)
+        -> decltype(SerializerArg::Serialize(std::declval<std::string &>(),
+                    std::declval<const DataTypeArg &>()), std::true_type());
+
+    private: template <typename, typename>
+    static auto Test(...) -> std::false_type;
+
+    public: static constexpr bool value =  // NOLINT
+                decltype(Test<Serializer, DataType>(0))::value;
+  };
 }
 
 namespace serializers
@@ -222,6 +243,42 @@ namespace serializers
       return _in;
     }
   };
+
+  /// \brief Serializer for components holding a shared, immutable payload,
+  /// see components::SharedPayloadComponent. The payload is serialized with
+  /// PayloadSerializer. Deserializing creates a new payload, so other
+  /// holders of the previous one are not affected.
+  /// \tparam PayloadType Type of the payload.
+  /// \tparam PayloadSerializer Serializer of the payload.
+  template <typename PayloadType,
+            typename PayloadSerializer = DefaultSerializer<PayloadType>>
+  class SharedPayloadSerializer
+  {
+    /// \brief Serialization
+    /// \param[in] _out Output stream.
+    /// \param[in] _data Payload to stream, nothing is written if it's null.
+    /// \return The stream.
+    public: static std::ostream &Serialize(std::ostream &_out,
+                const std::shared_ptr<const PayloadType> &_data)
+    {
+      if (_data)
+        PayloadSerializer::Serialize(_out, *_data);
+      return _out;
+    }
+
+    /// \brief Deserialization
+    /// \param[in] _in Input stream.
+    /// \param[out] _data New payload resulting from deserialization.
+    /// \return The stream.
+    public: static std::istream &Deserialize(std::istream &_in,
+                std::shared_ptr<const PayloadType> &_data)
+    {
+      auto payload = std::make_shared<PayloadType>();
+      PayloadSerializer::Deserialize(_in, *payload);
+      _data = std::move(payload);
+      return _in;
+    }
+  };
 }
 
 namespace components
@@ -270,6 +327,39 @@ namespace components
       }
     };
 
+    /// \brief Fills a byte buffer with a serialized version of the
+    /// component, replacing its contents. This is used to build state
+    /// messages, and reuses the memory the buffer already holds. By default,
+    /// it goes through Serialize.
+    ///
+    /// \param[out] _buffer Buffer to fill.
+    public: virtual void SerializeToBuffer(std::string &_buffer) const
+    {
+      std::ostringstream ostr;
+      this->Serialize(ostr);
+      _buffer = ostr.str();
+    }
+
+    /// \brief Fills a component based on a buffer filled by
+    /// SerializeToBuffer. By default, it goes through Deserialize.
+    ///
+    /// \param[in] _buffer Buffer with serialized data.
+    public: virtual void DeserializeFromBuffer(const std::string &_buffer)
+    {
+      std::istringstream istr(_buffer);
+      this->Deserialize(istr);
+    }
+
+    /// \brief Create a copy of the component, for example to keep the
+    /// state of an entity in memory without serializing it. By default, it
+    /// returns nullptr, for components which can't be copied.
+    ///
+    /// \return The copy.
+    public: virtual std::unique_ptr<BaseComponent> Clone() const
+    {
+      return nullptr;
+    }
+
     /// \brief Returns the unique ID for the component's type.
     /// The ID is derived from the name that is manually chosen during the
     /// Factory registration and is guaranteed to be the same across compilers
@@ -347,6 +437,21 @@ namespace components
     // Documentation inherited
     public: void Deserialize(std::istream &_in) override;
 
+    /// \brief Fills a byte buffer with a serialized version of the
+    /// component. If the serializer can write into buffers, such as
+    /// serializers::BinarySerializer, it's used directly instead of going
+    /// through a stream.
+    /// \param[out] _buffer Buffer to fill.
+    public: void SerializeToBuffer(std::string &_buffer) const override;
+
+    // Documentation inherited
+    public: void DeserializeFromBuffer(const std::string &_buffer) override;
+
+    /// \brief Create a copy of the component, or nullptr if DataType can't
+    /// be copied.
+    /// \return The copy.
+    public: std::unique_ptr<BaseComponent> Clone() const override;
+
     /// \brief Get the mutable component data. This function will be
     /// deprecated in Gazebo 3, replaced by const DataType &Data() const.
     /// Use void SetData(const DataType &) to modify data.
@@ -364,6 +469,16 @@ namespace components
                 const std::function<
                   bool(const DataType &, const DataType &)> &_eql);
 
+    /// \brief Set the data of this component, moving it instead of copying
+    /// it.
+    /// \param[in] _data New data for this component, which is moved from.
+    /// \param[in] _eql Equality comparison function. This function should
+    /// return true if two instances of DataType are equal.
+    /// \return True if the _eql function returns false.
+    public: bool SetData(DataType &&_data,
+                const std::function<
+                  bool(const DataType &, const DataType &)> &_eql);
+
     /// \brief Get the immutable component data.
     /// \return Immutable reference to the actual component information.
     public: const DataType &Data() const;
@@ -414,6 +529,9 @@ namespace components
     // Documentation inherited
     public: void Deserialize(std::istream &_in) override;
 
+    // Documentation inherited
+    public: std::unique_ptr<BaseComponent> Clone() const override;
+
     /// \brief Unique ID for this component type. This is set through the
     /// Factory registration.
     public: inline static ComponentTypeId typeId{0};
@@ -448,6 +566,17 @@ namespace components
     return result;
   }
 
+  //////////////////////////////////////////////////
+  template <typename DataType, typename Identifier, typename Serializer>
+  bool Component<DataType, Identifier, Serializer>::SetData(
+      DataType &&_data,
+      const std::function<bool(const DataType &, const DataType &)> &_eql)
+  {
+    bool result = !_eql(_data, this->data);
+    this->data = std::move(_data);
+    return result;
+  }
+
   //////////////////////////////////////////////////
   template <typename DataType, typename Identifier, typename Serializer>
   const DataType &Component<DataType, Identifier, Serializer>::Data() const
@@ -487,6 +616,28 @@ namespace components
     Serializer::Deserialize(_in, this->Data());
   }
 
+  //////////////////////////////////////////////////
+  template <typename DataType, typename Identifier, typename Serializer>
+  void Component<DataType, Identifier, Serializer>::SerializeToBuffer(
+      std::string &_buffer) const
+  {
+    if constexpr (traits::IsBufferSerializer<Serializer, DataType>::value)
+      Serializer::Serialize(_buffer, this->Data());
+    else
+      BaseComponent::SerializeToBuffer(_buffer);
+  }
+
+  //////////////////////////////////////////////////
+  template <typename DataType, typename Identifier, typename Serializer>
+  void Component<DataType, Identifier, Serializer>::DeserializeFromBuffer(
+      const std::string &_buffer)
+  {
+    if constexpr (traits::IsBufferSerializer<Serializer, DataType>::value)
+      Serializer::Deserialize(_buffer, this->Data());
+    else
+      BaseComponent::DeserializeFromBuffer(_buffer);
+  }
+
   //////////////////////////////////////////////////
   template <typename DataType, typename Identifier, typename Serializer>
   ComponentTypeId Component<DataType, Identifier, Serializer>::TypeId() const
@@ -494,6 +645,17 @@ namespace components
     return typeId;
   }
 
+  //////////////////////////////////////////////////
+  template <typename DataType, typename Identifier, typename Serializer>
+  std::unique_ptr<BaseComponent>
+      Component<DataType, Identifier, Serializer>::Clone() const
+  {
+    if constexpr (std::is_copy_constructible_v<DataType>)
+      return std::make_unique<Component>(*this);
+    else
+      return nullptr;
+  }
+
   //////////////////////////////////////////////////
   template <typename Identifier, typename Serializer>
   bool Component<NoData, Identifier, Serializer>::operator==(
@@ -517,6 +679,14 @@ namespace components
     return typeId;
   }
 
+  //////////////////////////////////////////////////
+  template <typename Identifier, typename Serializer>
+  std::unique_ptr<BaseComponent>
+      Component<NoData, Identifier, Serializer>::Clone() const
+  {
+    return std::make_unique<Component>();
+  }
+
   //////////////////////////////////////////////////
   template <typename Identifier, typename Serializer>
   void Component<NoData, Identifier, Serializer>::Serialize(
@@ -532,6 +702,28 @@ namespace components
   {
     Serializer::Deserialize(_in);
   }
+
+  /// \brief Component holding a large payload which is shared instead of
+  /// copied. The data is a pointer to an immutable payload, so copying the
+  /// component, for example when creating it or getting its data, only
+  /// copies the pointer, and the same payload can be kept by the ECM,
+  /// serializers and renderers. To change the payload, set a new one:
+  ///
+  ///     using HeightmapSamples = components::SharedPayloadComponent<
+  ///         std::vector<float>, class HeightmapSamplesTag>;
+  ///
+  ///     auto samples = std::make_shared<const std::vector<float>>(...);
+  ///     ecm.CreateComponent(entity, HeightmapSamples(samples));
+  ///
+  /// \tparam PayloadType Type of the payload.
+  /// \tparam Identifier Unique identifier for the component class.
+  /// \tparam PayloadSerializer Serializer of the payload.
+  template <typename PayloadType, typename Identifier,
+            typename PayloadSerializer =
+                serializers::DefaultSerializer<PayloadType>>
+  using SharedPayloadComponent = Component<
+      std::shared_ptr<const PayloadType>, Identifier,
+      serializers::SharedPayloadSerializer<PayloadType, PayloadSerializer>>;
 }
 }
 }
@@ -18,6 +18,7 @@
 #define IGNITION_GAZEBO_COMPONENTS_LINEARVELOCITY_HH_
 
 #include <ignition/math/Vector3.hh>
+#include <ignition/gazebo/components/BinarySerializer.hh>
 #include <ignition/gazebo/components/Factory.hh>
 #include <ignition/gazebo/components/Component.hh>
 #include <ignition/gazebo/config.hh>
@@ -32,14 +33,16 @@ namespace components
 {
   /// \brief A component type that contains linear velocity of an entity
   /// represented by ignition::math::Vector3d.
-  using LinearVelocity = Component<math::Vector3d, class LinearVelocityTag>;
+  using LinearVelocity = Component<math::Vector3d, class LinearVelocityTag,
+      serializers::BinarySerializer<math::Vector3d>>;
   IGN_GAZEBO_REGISTER_COMPONENT(
       "ign_gazebo_components.LinearVelocity", LinearVelocity)
 
   /// \brief A component type that contains linear velocity of an entity in the
   /// world frame represented by ignition::math::Vector3d.
   using WorldLinearVelocity =
-      Component<math::Vector3d, class WorldLinearVelocityTag>;
+      Component<math::Vector3d, class WorldLinearVelocityTag,
+      serializers::BinarySerializer<math::Vector3d>>;
   IGN_GAZEBO_REGISTER_COMPONENT(
       "ign_gazebo_components.WorldLinearVelocity", WorldLinearVelocity)
 }
@@ -18,6 +18,7 @@
 #define IGNITION_GAZEBO_COMPONENTS_POSE_HH_
 
 #include <ignition/math/Pose3.hh>
+#include <ignition/gazebo/components/BinarySerializer.hh>
 #include <ignition/gazebo/components/Factory.hh>
 #include <ignition/gazebo/components/Component.hh>
 #include <ignition/gazebo/config.hh>
@@ -32,12 +33,14 @@ namespace components
 {
   /// \brief A component type that contains pose, ignition::math::Pose3d,
   /// information.
-  using Pose = Component<ignition::math::Pose3d, class PoseTag>;
+  using Pose = Component<ignition::math::Pose3d, class PoseTag,
+      serializers::BinarySerializer<ignition::math::Pose3d>>;
   IGN_GAZEBO_REGISTER_COMPONENT("ign_gazebo_components.Pose", Pose)
 
   /// \brief A component type that contains pose, ignition::math::Pose3d,
   /// information in world frame.
-  using WorldPose = Component<ignition::math::Pose3d, class WorldPoseTag>;
+  using WorldPose = Component<ignition::math::Pose3d, class WorldPoseTag,
+      serializers::BinarySerializer<ignition::math::Pose3d>>;
   IGN_GAZEBO_REGISTER_COMPONENT(
       "ign_gazebo_components.WorldPose", WorldPose)
 
@@ -53,6 +53,16 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
 ///                                                DataType &_data)
 ///     };
 /// \endcode
+///
+/// Serializers may also implement the following functions, which are used to
+/// build state messages without going through a stream. See
+/// traits::IsBufferSerializer.
+/// \code
+///       public: static void Serialize(std::string &_buffer,
+///                                     const DataType &_data);
+///       public: static void Deserialize(const std::string &_buffer,
+///                                       DataType &_data);
+/// \endcode
 
 namespace serializers
 {
@@ -96,6 +106,28 @@ namespace serializers
       _data = ignition::gazebo::convert<DataType>(msg);
       return _in;
     }
+
+    /// \brief Serialization into a buffer
+    /// \param[out] _buffer Buffer to fill.
+    /// \param[in] _data Data to serialize.
+    public: static void Serialize(std::string &_buffer,
+                                  const DataType &_data)
+    {
+      auto msg = ignition::gazebo::convert<MsgType>(_data);
+      msg.SerializeToString(&_buffer);
+    }
+
+    /// \brief Deserialization from a buffer
+    /// \param[in] _buffer Buffer with serialized data.
+    /// \param[out] _data Data to populate.
+    public: static void Deserialize(const std::string &_buffer,
+                                    DataType &_data)
+    {
+      MsgType msg;
+      msg.ParseFromString(_buffer);
+
+      _data = ignition::gazebo::convert<DataType>(msg);
+    }
   };
 
   /// \brief Common serializer for sensors
@@ -130,6 +162,29 @@ namespace serializers
       _vec = {msg.data().begin(), msg.data().end()};
       return _in;
     }
+
+    /// \brief Serialization into a buffer
+    /// \param[out] _buffer Buffer to fill.
+    /// \param[in] _vec Vector to serialize.
+    public: static void Serialize(std::string &_buffer,
+                                  const std::vector<double> &_vec)
+    {
+      ignition::msgs::Double_V msg;
+      *msg.mutable_data() = {_vec.begin(), _vec.end()};
+      msg.SerializeToString(&_buffer);
+    }
+
+    /// \brief Deserialization from a buffer
+    /// \param[in] _buffer Buffer with serialized data.
+    /// \param[out] _vec Vector to populate.
+    public: static void Deserialize(const std::string &_buffer,
+                                    std::vector<double> &_vec)
+    {
+      ignition::msgs::Double_V msg;
+      msg.ParseFromString(_buffer);
+
+      _vec = {msg.data().begin(), msg.data().end()};
+    }
   };
 
   /// \brief Serializer for components that hold protobuf messages.
@@ -156,6 +211,24 @@ namespace serializers
       _msg.ParseFromIstream(&_in);
       return _in;
     }
+
+    /// \brief Serialization into a buffer
+    /// \param[out] _buffer Buffer to fill.
+    /// \param[in] _msg Message to serialize.
+    public: static void Serialize(std::string &_buffer,
+        const google::protobuf::Message &_msg)
+    {
+      _msg.SerializeToString(&_buffer);
+    }
+
+    /// \brief Deserialization from a buffer
+    /// \param[in] _buffer Buffer with serialized data.
+    /// \param[out] _msg Message to populate.
+    public: static void Deserialize(const std::string &_buffer,
+        google::protobuf::Message &_msg)
+    {
+      _msg.ParseFromString(_buffer);
+    }
   };
 
   /// \brief Serializer for components that hold std::string.
@@ -182,7 +255,26 @@ namespace serializers
       _data = std::string(std::istreambuf_iterator<char>(_in), {});
       return _in;
     }
+
+    /// \brief Serialization into a buffer
+    /// \param[out] _buffer Buffer to fill.
+    /// \param[in] _data Data to serialize.
+    public: static void Serialize(std::string &_buffer,
+        const std::string &_data)
+    {
+      _buffer = _data;
+    }
+
+    /// \brief Deserialization from a buffer
+    /// \param[in] _buffer Buffer with serialized data.
+    /// \param[out] _data Data to populate.
+    public: static void Deserialize(const std::string &_buffer,
+        std::string &_data)
+    {
+      _data = _buffer;
+    }
   };
+
 }
 }
 }
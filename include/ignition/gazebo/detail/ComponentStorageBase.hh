@@ -17,10 +17,17 @@
 #ifndef IGNITION_GAZEBO_DETAIL_COMPONENTSTORAGEBASE_HH_
 #define IGNITION_GAZEBO_DETAIL_COMPONENTSTORAGEBASE_HH_
 
-#include <map>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include "ignition/gazebo/components/Component.hh"
+#include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/Export.hh"
 #include "ignition/gazebo/Types.hh"
 
@@ -32,7 +39,9 @@ namespace ignition
     inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     //
     /// \brief All component instances of the same type are stored
-    /// squentially in memory. This is a base class for storing components
+    /// squentially in memory, in fixed size pages. Pages never grow past
+    /// their capacity, so a component's address doesn't change when other
+    /// components are created. This is a base class for storing components
     /// of a particular type.
     class IGNITION_GAZEBO_HIDDEN ComponentStorageBase
     {
@@ -42,19 +51,76 @@ namespace ignition
       /// \brief Destructor
       public: virtual ~ComponentStorageBase() = default;
 
+      /// \brief Copy the storage, including the change information of its
+      /// components, for example when a storage shared by forked entity
+      /// component managers is about to be modified.
+      /// \return The copy, or nullptr if the components can't be copied.
+      public: virtual std::unique_ptr<ComponentStorageBase> Clone() const = 0;
+
       /// \brief Create a new component using the provided data.
+      /// \param[in] _entity Entity which owns the component.
       /// \param[in] _data Data used to construct the component.
-      /// \return Id of the new component, and whether the components array
-      /// was expanded. kComponentIdInvalid is returned
+      /// \return Id of the new component. kComponentIdInvalid is returned
       /// if the component could not be created.
-      public: virtual std::pair<ComponentId, bool> Create(
+      public: virtual ComponentId Create(const Entity _entity,
                   const components::BaseComponent *_data) = 0;
 
+      /// \brief Create a new component, moving the provided data into it
+      /// instead of copying it.
+      /// \param[in] _entity Entity which owns the component.
+      /// \param[in] _data Component to move from. It must be of the stored
+      /// type, and is left in a valid but unspecified state.
+      /// \return Id of the new component.
+      public: virtual ComponentId Create(const Entity _entity,
+                  components::BaseComponent &&_data) = 0;
+
+      /// \brief Replace an existing component, moving the provided data into
+      /// it instead of deserializing or copying it.
+      /// \param[in] _id Id of the component to replace.
+      /// \param[in] _data Component to move from. It must be of the stored
+      /// type, and is left in a valid but unspecified state.
+      /// \return True if the component exists.
+      public: virtual bool Assign(const ComponentId _id,
+                  components::BaseComponent &&_data) = 0;
+
       /// \brief Remove a component based on an id.
       /// \param[in] _id Id of the component to remove.
       /// \return True if the component was removed.
       public: virtual bool Remove(const ComponentId _id) = 0;
 
+      /// \brief Remove multiple components based on their ids. This is
+      /// equivalent to calling Remove for each id, but only locks the storage
+      /// once.
+      /// \param[in] _ids Ids of the components to remove.
+      /// \return Number of components that were removed.
+      public: virtual std::size_t RemoveMany(
+                  const std::vector<ComponentId> &_ids) = 0;
+
+      /// \brief Remove multiple components based on their ids, leaving a
+      /// tombstone in their slots instead of moving other components into
+      /// them, so no component is relocated. The components can't be found
+      /// anymore, but their slots are only reclaimed, and their data
+      /// destroyed, by Compact.
+      /// \param[in] _ids Ids of the components to remove.
+      /// \return Number of components that were removed.
+      public: virtual std::size_t RemoveDeferred(
+                  const std::vector<ComponentId> &_ids) = 0;
+
+      /// \brief Reclaim the slots of components removed by RemoveDeferred,
+      /// by moving the last components into them. Each reclaimed slot moves
+      /// at most one component.
+      /// \param[in] _maxMoves Maximum number of components to move.
+      /// \param[out] _moved The owners of the moved components are appended
+      /// to this vector.
+      /// \return Number of tombstones left.
+      public: virtual std::size_t Compact(const std::size_t _maxMoves,
+                  std::vector<Entity> &_moved) = 0;
+
+      /// \brief Get the number of slots left by RemoveDeferred which weren't
+      /// reclaimed by Compact yet.
+      /// \return Number of tombstones.
+      public: virtual std::size_t TombstoneCount() const = 0;
+
       /// \brief Remove all components
       public: virtual void RemoveAll() = 0;
 
@@ -76,103 +142,558 @@ namespace ignition
       /// \return First component or nullptr if there are no components.
       public: virtual components::BaseComponent *First() = 0;
 
+      /// \brief Get the number of components in the storage.
+      /// \return Number of components.
+      public: virtual std::size_t Count() const = 0;
+
+      /// \brief Get an estimate of the memory used by the storage. Only
+      /// allocations made by the storage are counted, not those made by the
+      /// components themselves, such as the contents of strings or vectors
+      /// they hold.
+      /// \param[out] _bytes Bytes taken by the components.
+      /// \param[out] _overhead Bytes taken by unused capacity and by
+      /// bookkeeping, such as id maps and change tracking.
+      public: virtual void MemoryUsage(std::size_t &_bytes,
+                  std::size_t &_overhead) const = 0;
+
+      /// \brief Set whether the storage is read-only. While it is, nothing
+      /// may create or remove components, so lookups don't lock the mutex
+      /// and concurrent readers don't wait for each other.
+      /// \param[in] _readOnly True while the storage is only read.
+      public: void SetReadOnly(const bool _readOnly)
+      {
+        this->readOnly.store(_readOnly, std::memory_order_relaxed);
+      }
+
+      /// \brief Get the number of times a component was moved to another
+      /// address because another component was removed. Pointers to
+      /// components of this storage must be looked up again whenever this
+      /// value changes.
+      /// \return Number of relocations since the storage was created.
+      public: std::size_t Relocations() const
+      {
+        return this->relocations;
+      }
+
+      /// \brief Set whether a component has changed.
+      /// \param[in] _id Id of the component.
+      /// \param[in] _state New change state of the component.
+      /// \param[in] _generation Change generation to record if the
+      /// component changed, see ChangeGeneration.
+      public: void SetChangeState(const ComponentId _id,
+                  const ComponentState _state, const uint64_t _generation)
+      {
+        if (_id < 0)
+          return;
+
+        const auto index = static_cast<std::size_t>(_id);
+        const bool periodic = TestBit(this->periodicChanges, index);
+        const bool oneTime = TestBit(this->oneTimeChanges, index);
+
+        if (periodic && _state != ComponentState::PeriodicChange)
+        {
+          ResetBit(this->periodicChanges, index);
+          --this->periodicChangeCount;
+        }
+        else if (!periodic && _state == ComponentState::PeriodicChange)
+        {
+          SetBit(this->periodicChanges, index);
+          ++this->periodicChangeCount;
+        }
+
+        if (oneTime && _state != ComponentState::OneTimeChange)
+        {
+          ResetBit(this->oneTimeChanges, index);
+          --this->oneTimeChangeCount;
+        }
+        else if (!oneTime && _state == ComponentState::OneTimeChange)
+        {
+          SetBit(this->oneTimeChanges, index);
+          ++this->oneTimeChangeCount;
+        }
+
+        if (_state == ComponentState::NoChange)
+          return;
+
+        // Remember changed components, so clearing changes only visits them.
+        if (!TestBit(this->listedChanges, index))
+        {
+          SetBit(this->listedChanges, index);
+          this->changedIds.push_back(_id);
+        }
+
+        if (this->changeGenerations.size() <= index)
+          this->changeGenerations.resize(index + 1, 0);
+        this->changeGenerations[index] = _generation;
+      }
+
+      /// \brief Get whether a component has changed.
+      /// \param[in] _id Id of the component.
+      /// \return Change state of the component.
+      public: ComponentState ChangeState(const ComponentId _id) const
+      {
+        if (_id < 0)
+          return ComponentState::NoChange;
+
+        const auto index = static_cast<std::size_t>(_id);
+        if (TestBit(this->oneTimeChanges, index))
+          return ComponentState::OneTimeChange;
+        if (TestBit(this->periodicChanges, index))
+          return ComponentState::PeriodicChange;
+        return ComponentState::NoChange;
+      }
+
+      /// \brief Get the change generation during which a component last
+      /// changed. Unlike the change state, this is kept when changes are
+      /// cleared.
+      /// \param[in] _id Id of the component.
+      /// \return Change generation, or 0 if the component never changed.
+      public: uint64_t ChangeGeneration(const ComponentId _id) const
+      {
+        if (_id < 0 ||
+            static_cast<std::size_t>(_id) >= this->changeGenerations.size())
+        {
+          return 0;
+        }
+        return this->changeGenerations[static_cast<std::size_t>(_id)];
+      }
+
+      /// \brief Record that a component changed, so it's visited by
+      /// ChangedSince.
+      /// \param[in] _id Id of the component.
+      /// \param[in] _entity Entity which owns the component.
+      /// \param[in] _sequence Change sequence number, which must be larger
+      /// than the one of all previous calls.
+      public: void LogChange(const ComponentId _id, const Entity _entity,
+                  const uint64_t _sequence)
+      {
+        if (_id < 0)
+          return;
+
+        const auto index = static_cast<std::size_t>(_id);
+        if (this->changeSequences.size() <= index)
+          this->changeSequences.resize(index + 1, 0);
+        if (this->changeSequences[index] == 0)
+          ++this->loggedCount;
+        this->changeSequences[index] = _sequence;
+        this->changeLog.push_back({_sequence, _id, _entity});
+
+        // Drop entries superseded by later changes once they dominate the
+        // log. The log stays sorted by sequence.
+        if (this->changeLog.size() > 2 * this->loggedCount + 1024)
+        {
+          this->changeLog.erase(std::remove_if(this->changeLog.begin(),
+              this->changeLog.end(), [this](const ChangeLogEntry &_entry)
+              {
+                return !this->IsLatest(_entry);
+              }), this->changeLog.end());
+        }
+      }
+
+      /// \brief Get the entities whose component changed after a given
+      /// change sequence number, in the order of their last change.
+      /// \param[in] _sequence Change sequence number.
+      /// \param[out] _entities Entities are appended to this vector.
+      public: void ChangedSince(const uint64_t _sequence,
+                  std::vector<Entity> &_entities) const
+      {
+        auto iter = std::upper_bound(this->changeLog.begin(),
+            this->changeLog.end(), _sequence,
+            [](const uint64_t _value, const ChangeLogEntry &_entry)
+            {
+              return _value < _entry.sequence;
+            });
+        for (; iter != this->changeLog.end(); ++iter)
+        {
+          if (this->IsLatest(*iter))
+            _entities.push_back(iter->entity);
+        }
+      }
+
+      /// \brief Get the number of components with a periodic change.
+      /// \return Number of components.
+      public: std::size_t PeriodicChangeCount() const
+      {
+        return this->periodicChangeCount;
+      }
+
+      /// \brief Get the number of components with a one-time change.
+      /// \return Number of components.
+      public: std::size_t OneTimeChangeCount() const
+      {
+        return this->oneTimeChangeCount;
+      }
+
+      /// \brief Get whether any component changed since changes were last
+      /// cleared, i.e. whether ClearChanges has anything to do.
+      /// \return True if there are changes to clear.
+      public: bool HasChanges() const
+      {
+        return !this->changedIds.empty();
+      }
+
+      /// \brief Mark all components as unchanged. This only visits the
+      /// components which changed since the last call.
+      public: void ClearChanges()
+      {
+        for (const ComponentId id : this->changedIds)
+        {
+          const auto index = static_cast<std::size_t>(id);
+          ResetBit(this->periodicChanges, index);
+          ResetBit(this->oneTimeChanges, index);
+          ResetBit(this->listedChanges, index);
+        }
+        this->changedIds.clear();
+        this->periodicChangeCount = 0;
+        this->oneTimeChangeCount = 0;
+      }
+
+      /// \brief Copy constructor, used by Clone. Copies everything but the
+      /// mutex and the read-only state. A copy counts as a relocation, since
+      /// its components live at other addresses.
+      /// \param[in] _other Storage to copy, which must be locked by the
+      /// caller.
+      protected: ComponentStorageBase(const ComponentStorageBase &_other)
+          : relocations(_other.relocations + 1),
+            periodicChanges(_other.periodicChanges),
+            oneTimeChanges(_other.oneTimeChanges),
+            listedChanges(_other.listedChanges),
+            changedIds(_other.changedIds),
+            changeGenerations(_other.changeGenerations),
+            changeSequences(_other.changeSequences),
+            changeLog(_other.changeLog),
+            loggedCount(_other.loggedCount),
+            periodicChangeCount(_other.periodicChangeCount),
+            oneTimeChangeCount(_other.oneTimeChangeCount)
+      {
+      }
+
+      /// \brief Forget all change information of a component which is being
+      /// removed.
+      /// \param[in] _id Id of the component.
+      protected: void ForgetChanges(const ComponentId _id)
+      {
+        this->SetChangeState(_id, ComponentState::NoChange, 0);
+        if (_id < 0)
+          return;
+
+        const auto index = static_cast<std::size_t>(_id);
+        if (index < this->changeGenerations.size())
+          this->changeGenerations[index] = 0;
+
+        // Entries of the change log are skipped once they're not the latest.
+        if (index < this->changeSequences.size() &&
+            this->changeSequences[index] != 0)
+        {
+          this->changeSequences[index] = 0;
+          --this->loggedCount;
+        }
+      }
+
+      /// \brief Forget the change information of all components.
+      protected: void ForgetAllChanges()
+      {
+        this->periodicChanges.clear();
+        this->oneTimeChanges.clear();
+        this->listedChanges.clear();
+        this->changedIds.clear();
+        this->changeGenerations.clear();
+        this->changeSequences.clear();
+        this->changeLog.clear();
+        this->loggedCount = 0;
+        this->periodicChangeCount = 0;
+        this->oneTimeChangeCount = 0;
+      }
+
+      /// \brief A change recorded by LogChange.
+      private: struct ChangeLogEntry
+      {
+        /// \brief Change sequence number.
+        uint64_t sequence;
+
+        /// \brief Id of the component.
+        ComponentId id;
+
+        /// \brief Entity which owns the component.
+        Entity entity;
+      };
+
+      /// \brief Check whether a change log entry is the last change of its
+      /// component.
+      /// \param[in] _entry Change log entry.
+      /// \return True if the component didn't change again since.
+      private: bool IsLatest(const ChangeLogEntry &_entry) const
+      {
+        const auto index = static_cast<std::size_t>(_entry.id);
+        return index < this->changeSequences.size() &&
+            this->changeSequences[index] == _entry.sequence;
+      }
+
+      /// \brief Check a bit of a bitset.
+      /// \param[in] _bits Bitset.
+      /// \param[in] _index Index of the bit.
+      /// \return True if the bit is set.
+      private: static bool TestBit(const std::vector<uint64_t> &_bits,
+                   const std::size_t _index)
+      {
+        const std::size_t word = _index / 64;
+        return word < _bits.size() && (_bits[word] >> (_index % 64)) & 1u;
+      }
+
+      /// \brief Set a bit of a bitset, growing it if needed.
+      /// \param[in, out] _bits Bitset.
+      /// \param[in] _index Index of the bit.
+      private: static void SetBit(std::vector<uint64_t> &_bits,
+                   const std::size_t _index)
+      {
+        const std::size_t word = _index / 64;
+        if (word >= _bits.size())
+          _bits.resize(word + 1, 0);
+        _bits[word] |= uint64_t{1} << (_index % 64);
+      }
+
+      /// \brief Clear a bit of a bitset.
+      /// \param[in, out] _bits Bitset.
+      /// \param[in] _index Index of the bit.
+      private: static void ResetBit(std::vector<uint64_t> &_bits,
+                   const std::size_t _index)
+      {
+        const std::size_t word = _index / 64;
+        if (word < _bits.size())
+          _bits[word] &= ~(uint64_t{1} << (_index % 64));
+      }
+
+      /// \brief Get the memory allocated to track changes.
+      /// \return Bytes allocated by the change bitsets and change log.
+      protected: std::size_t ChangeTrackingBytes() const
+      {
+        return (this->periodicChanges.capacity() +
+            this->oneTimeChanges.capacity() + this->listedChanges.capacity() +
+            this->changeGenerations.capacity() +
+            this->changeSequences.capacity()) * sizeof(uint64_t) +
+            this->changedIds.capacity() * sizeof(ComponentId) +
+            this->changeLog.capacity() * sizeof(ChangeLogEntry);
+      }
+
+      /// \brief Lock the mutex for a lookup, unless the storage is
+      /// read-only.
+      /// \return Lock, which doesn't own the mutex if the storage is
+      /// read-only.
+      protected: std::unique_lock<std::mutex> ReadLock() const
+      {
+        if (this->readOnly.load(std::memory_order_relaxed))
+          return std::unique_lock<std::mutex>(this->mutex, std::defer_lock);
+        return std::unique_lock<std::mutex>(this->mutex);
+      }
+
       /// \brief Mutex used to prevent data corruption.
       protected: mutable std::mutex mutex;
+
+      /// \brief True while components are only read, see SetReadOnly.
+      /// Atomic because storages shared by forked managers are set read-only
+      /// by each of them, possibly from different threads.
+      protected: std::atomic<bool> readOnly{false};
+
+      /// \brief Number of components moved by removals.
+      protected: std::size_t relocations{0};
+
+      /// \brief Components with a periodic change, one bit per id.
+      private: std::vector<uint64_t> periodicChanges;
+
+      /// \brief Components with a one-time change, one bit per id.
+      private: std::vector<uint64_t> oneTimeChanges;
+
+      /// \brief Components listed in changedIds, one bit per id.
+      private: std::vector<uint64_t> listedChanges;
+
+      /// \brief Ids of the components that changed since changes were last
+      /// cleared. Some may have been set as unchanged since.
+      private: std::vector<ComponentId> changedIds;
+
+      /// \brief Change generation during which each component last changed.
+      private: std::vector<uint64_t> changeGenerations;
+
+      /// \brief Sequence number of the last logged change of each component,
+      /// or 0 if it wasn't changed.
+      private: std::vector<uint64_t> changeSequences;
+
+      /// \brief Logged changes, sorted by sequence number. Entries which
+      /// aren't the latest change of their component are skipped.
+      private: std::vector<ChangeLogEntry> changeLog;
+
+      /// \brief Number of components with a logged change.
+      private: std::size_t loggedCount{0};
+
+      /// \brief Number of bits set in periodicChanges.
+      private: std::size_t periodicChangeCount{0};
+
+      /// \brief Number of bits set in oneTimeChanges.
+      private: std::size_t oneTimeChangeCount{0};
     };
 
     /// \brief Templated implementation of component storage.
     template<typename ComponentTypeT>
     class IGNITION_GAZEBO_HIDDEN ComponentStorage : public ComponentStorageBase
     {
+      /// \brief Number of components held by each page. A new page is
+      /// allocated once the last one is full, instead of reallocating the
+      /// existing components.
+      public: static constexpr std::size_t kPageSize{1024};
+
       /// \brief Constructor
       public: explicit ComponentStorage()
               : ComponentStorageBase()
       {
-        // Reserve a chunk of memory for the components. The size here will
-        // effect how often Views are rebuilt when
-        // EntityComponentManager::CreateComponent() is called.
-        //
-        // Views would be rebuilt if the components vector capacity is
-        // exceeded after an EntityComponentManager::Each call has already
-        // been executed.
-        //
-        // See also this class's Create() function, which expands the value
-        // of components vector whenever the capacity is reached.
-        this->components.reserve(100);
+      }
+
+      // Documentation inherited.
+      public: std::unique_ptr<ComponentStorageBase> Clone() const final
+      {
+        if constexpr (std::is_copy_constructible_v<ComponentTypeT>)
+        {
+          auto lock = this->ReadLock();
+          return std::unique_ptr<ComponentStorageBase>(
+              new ComponentStorage(*this));
+        }
+        else
+        {
+          return nullptr;
+        }
       }
 
       // Documentation inherited.
       public: bool Remove(const ComponentId _id) final
       {
         std::lock_guard<std::mutex> lock(this->mutex);
+        return this->RemoveImplementation(_id);
+      }
 
-        // Get an iterator to the component that should be removed.
-        auto iter = this->idMap.find(_id);
+      // Documentation inherited.
+      public: std::size_t RemoveMany(
+                  const std::vector<ComponentId> &_ids) final
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        std::size_t removed{0};
+        for (const ComponentId id : _ids)
+        {
+          if (this->RemoveImplementation(id))
+            ++removed;
+        }
+        return removed;
+      }
 
-        // Make sure the component exists.
-        if (iter != this->idMap.end())
+      // Documentation inherited.
+      public: std::size_t RemoveDeferred(
+                  const std::vector<ComponentId> &_ids) final
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        std::size_t removed{0};
+        for (const ComponentId id : _ids)
         {
-          // Handle the case where there are more components than the
-          // component to be removed
-          if (this->components.size() > 1)
+          auto iter = this->idMap.find(id);
+          if (iter == this->idMap.end())
+            continue;
+
+          this->ids[iter->second] = kComponentIdInvalid;
+          this->tombstones.push_back(iter->second);
+          ++this->tombstoneCount;
+          this->idMap.erase(iter);
+          this->ForgetChanges(id);
+          this->freeIds.push_back(id);
+          ++removed;
+        }
+        this->TrimTombstones();
+        return removed;
+      }
+
+      // Documentation inherited.
+      public: std::size_t Compact(const std::size_t _maxMoves,
+                  std::vector<Entity> &_moved) final
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        std::size_t moves{0};
+        while (this->tombstoneCount > 0 && moves < _maxMoves &&
+            !this->tombstones.empty())
+        {
+          const int index = this->tombstones.back();
+          this->tombstones.pop_back();
+
+          // Slots trimmed from the end, or reused since, were already
+          // reclaimed.
+          if (index >= static_cast<int>(this->ids.size()) ||
+              this->ids[index] != kComponentIdInvalid)
           {
-            // Swap the component to be removed with the component at the
-            // back of the vector.
-            std::swap(this->components[iter->second],
-                      this->components.back());
-
-            // After the swap, we have to fix all the id mappings.
-            for (auto idIter =this->idMap.begin();
-                idIter != this->idMap.end(); ++idIter)
-            {
-              if (static_cast<unsigned int>(idIter->second) ==
-                  this->components.size()-1)
-              {
-                idIter->second = iter->second;
-              }
-            }
+            continue;
           }
 
-          // Remove the component.
-          this->components.pop_back();
-
-          // Remove the id mapping.
-          this->idMap.erase(iter);
-          return true;
+          // The last slot holds a component, since trailing tombstones are
+          // always trimmed.
+          const int lastIndex = static_cast<int>(this->ids.size()) - 1;
+          this->At(index) = std::move(this->At(lastIndex));
+          this->ids[index] = this->ids.back();
+          this->owners[index] = this->owners.back();
+          this->idMap[this->ids[index]] = index;
+          _moved.push_back(this->owners[index]);
+          ++this->relocations;
+          ++moves;
+          --this->tombstoneCount;
+          this->PopBack();
+          this->TrimTombstones();
         }
-        return false;
+
+        if (this->tombstoneCount == 0)
+          this->tombstones.clear();
+        return this->tombstoneCount;
+      }
+
+      // Documentation inherited.
+      public: std::size_t TombstoneCount() const final
+      {
+        auto lock = this->ReadLock();
+        return this->tombstoneCount;
       }
 
       // Documentation inherited.
       public: void RemoveAll() final
       {
+        this->ForgetAllChanges();
         this->idCounter = 0;
+        this->freeIds.clear();
         this->idMap.clear();
-        this->components.clear();
+        this->ids.clear();
+        this->owners.clear();
+        this->pages.clear();
+        this->tombstones.clear();
+        this->tombstoneCount = 0;
       }
 
       // Documentation inherited.
-      public: std::pair<ComponentId, bool> Create(
+      public: ComponentId Create(const Entity _entity,
                   const components::BaseComponent *_data) final
       {
-        ComponentId result;  // = kComponentIdInvalid;
-        bool expanded = false;
-        if (this->components.size() == this->components.capacity())
-        {
-          this->components.reserve(this->components.capacity() + 100);
-          expanded = true;
-        }
-
-        std::lock_guard<std::mutex> lock(this->mutex);
-        // cppcheck-suppress unmatchedSuppression
-        // cppcheck-suppress postfixOperator
-        result = this->idCounter++;
-        this->idMap[result] = this->components.size();
         // Copy the component
-        this->components.push_back(std::move(
-              ComponentTypeT(*static_cast<const ComponentTypeT *>(_data))));
+        return this->Emplace(_entity,
+            *static_cast<const ComponentTypeT *>(_data));
+      }
+
+      // Documentation inherited.
+      public: ComponentId Create(const Entity _entity,
+                  components::BaseComponent &&_data) final
+      {
+        return this->Emplace(_entity,
+            std::move(static_cast<ComponentTypeT &>(_data)));
+      }
+
+      // Documentation inherited.
+      public: bool Assign(const ComponentId _id,
+                  components::BaseComponent &&_data) final
+      {
+        auto comp = static_cast<ComponentTypeT *>(this->Component(_id));
+        if (nullptr == comp)
+          return false;
 
-        return {result, expanded};
+        *comp = std::move(static_cast<ComponentTypeT &>(_data));
+        return true;
       }
 
       // Documentation inherited.
@@ -186,14 +707,14 @@ namespace ignition
 
       public: components::BaseComponent *Component(const ComponentId _id) final
       {
-        std::lock_guard<std::mutex> lock(this->mutex);
+        auto lock = this->ReadLock();
 
         auto iter = this->idMap.find(_id);
 
         if (iter != this->idMap.end())
         {
           return static_cast<components::BaseComponent *>(
-              &this->components.at(iter->second));
+              &this->At(iter->second));
         }
         return nullptr;
       }
@@ -201,21 +722,216 @@ namespace ignition
       // Documentation inherited.
       public: components::BaseComponent *First() final
       {
-        std::lock_guard<std::mutex> lock(this->mutex);
-        if (!this->components.empty())
-          return static_cast<components::BaseComponent *>(&this->components[0]);
+        auto lock = this->ReadLock();
+        for (std::size_t i = 0; i < this->ids.size(); ++i)
+        {
+          if (this->ids[i] != kComponentIdInvalid)
+          {
+            return static_cast<components::BaseComponent *>(
+                &this->At(static_cast<int>(i)));
+          }
+        }
         return nullptr;
       }
 
+      // Documentation inherited.
+      public: std::size_t Count() const final
+      {
+        auto lock = this->ReadLock();
+        return this->ids.size() - this->tombstoneCount;
+      }
+
+      // Documentation inherited.
+      public: void MemoryUsage(std::size_t &_bytes,
+                  std::size_t &_overhead) const final
+      {
+        auto lock = this->ReadLock();
+        _bytes = (this->ids.size() - this->tombstoneCount) *
+            sizeof(ComponentTypeT);
+
+        std::size_t allocated{0};
+        for (const auto &page : this->pages)
+          allocated += page.capacity() * sizeof(ComponentTypeT);
+
+        // Hash map nodes hold a value and a pointer to the next node.
+        _overhead = allocated - _bytes +
+            this->pages.capacity() * sizeof(std::vector<ComponentTypeT>) +
+            this->ids.capacity() * sizeof(ComponentId) +
+            this->owners.capacity() * sizeof(Entity) +
+            this->idMap.bucket_count() * sizeof(void *) +
+            this->idMap.size() * (sizeof(std::pair<const ComponentId, int>) +
+                sizeof(void *)) +
+            this->tombstones.capacity() * sizeof(int) +
+            this->freeIds.capacity() * sizeof(ComponentId) +
+            this->ChangeTrackingBytes();
+      }
+
+      /// \brief Copy constructor, used by Clone. The copied pages are given
+      /// their full capacity, so they're never reallocated either.
+      /// \param[in] _other Storage to copy, which must be locked by the
+      /// caller.
+      private: ComponentStorage(const ComponentStorage &_other)
+              : ComponentStorageBase(_other), idCounter(_other.idCounter),
+                freeIds(_other.freeIds), idMap(_other.idMap), ids(_other.ids),
+                owners(_other.owners), tombstones(_other.tombstones),
+                tombstoneCount(_other.tombstoneCount)
+      {
+        this->pages.reserve(_other.pages.size());
+        for (const auto &page : _other.pages)
+        {
+          this->pages.emplace_back();
+          this->pages.back().reserve(kPageSize);
+          this->pages.back().insert(this->pages.back().end(), page.begin(),
+              page.end());
+        }
+      }
+
+      /// \brief Add a component at the end of the last page.
+      /// \param[in] _entity Entity which owns the component.
+      /// \param[in] _component Component to copy or move.
+      /// \return Id of the new component.
+      private: template<typename ArgT>
+               ComponentId Emplace(const Entity _entity, ArgT &&_component)
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        // Start a new page when the last one is full. Existing pages are
+        // never reallocated, so pointers to components remain valid.
+        if (this->pages.empty() || this->pages.back().size() == kPageSize)
+        {
+          this->pages.emplace_back();
+          this->pages.back().reserve(kPageSize);
+        }
+
+        // Reuse the id of a removed component, so the change tracking,
+        // which is indexed by id, only grows with the number of components
+        // alive at once.
+        ComponentId result;
+        if (!this->freeIds.empty())
+        {
+          result = this->freeIds.back();
+          this->freeIds.pop_back();
+        }
+        else
+        {
+          // cppcheck-suppress unmatchedSuppression
+          // cppcheck-suppress postfixOperator
+          result = this->idCounter++;
+        }
+        this->idMap[result] = static_cast<int>(this->ids.size());
+        this->ids.push_back(result);
+        this->owners.push_back(_entity);
+        this->pages.back().emplace_back(std::forward<ArgT>(_component));
+
+        return result;
+      }
+
+      /// \brief Get the component at a given index across all pages.
+      /// \param[in] _index Index of the component, must be valid.
+      /// \return Reference to the component.
+      private: ComponentTypeT &At(const int _index)
+      {
+        return this->pages[_index / kPageSize][_index % kPageSize];
+      }
+
+      /// \brief Remove a component based on an id. The component is swapped
+      /// with the last one in the vector, whose index is then fixed through
+      /// the reverse index, so removal is constant time. The mutex must be
+      /// locked by the caller.
+      /// \param[in] _id Id of the component to remove.
+      /// \return True if the component was removed.
+      private: bool RemoveImplementation(const ComponentId _id)
+      {
+        // Get an iterator to the component that should be removed.
+        auto iter = this->idMap.find(_id);
+
+        // Make sure the component exists.
+        if (iter == this->idMap.end())
+          return false;
+
+        // The last slot must hold a component to be moved into the removed
+        // one.
+        this->TrimTombstones();
+        const int index = iter->second;
+        const int lastIndex = static_cast<int>(this->ids.size()) - 1;
+
+        // Move the last component to the slot being removed, and point its
+        // id to the new slot.
+        if (index != lastIndex)
+        {
+          std::swap(this->At(index), this->At(lastIndex));
+          this->ids[index] = this->ids.back();
+          this->owners[index] = this->owners.back();
+          this->idMap[this->ids[index]] = index;
+          ++this->relocations;
+        }
+
+        // Remove the component, and its page if it became empty.
+        this->PopBack();
+
+        // Remove the id mapping.
+        this->idMap.erase(iter);
+        this->ForgetChanges(_id);
+        this->freeIds.push_back(_id);
+        this->TrimTombstones();
+        return true;
+      }
+
+      /// \brief Destroy the last slot, and its page if it became empty. The
+      /// mutex must be locked by the caller.
+      private: void PopBack()
+      {
+        this->pages.back().pop_back();
+        if (this->pages.back().empty())
+          this->pages.pop_back();
+        this->ids.pop_back();
+        this->owners.pop_back();
+      }
+
+      /// \brief Destroy the tombstones at the end of the slots, which don't
+      /// need any component to be moved. The mutex must be locked by the
+      /// caller.
+      private: void TrimTombstones()
+      {
+        while (!this->ids.empty() && this->ids.back() == kComponentIdInvalid)
+        {
+          this->PopBack();
+          --this->tombstoneCount;
+        }
+      }
+
       /// \brief The id counter is used to get unique ids within this
       /// storage class.
       private: ComponentId idCounter = 0;
 
+      /// \brief Ids of removed components, handed out again by Emplace
+      /// before new ones are taken from idCounter. Their change information
+      /// was forgotten on removal.
+      private: std::vector<ComponentId> freeIds;
+
       /// \brief Map of ComponentId to Components (see the components vector).
-      private: std::map<ComponentId, int> idMap;
+      private: std::unordered_map<ComponentId, int> idMap;
+
+      /// \brief Reverse of idMap: the id of the component at each index
+      /// across all pages.
+      private: std::vector<ComponentId> ids;
+
+      /// \brief Entity which owns the component at each index, so the
+      /// owners of the components moved by Compact are known.
+      private: std::vector<Entity> owners;
+
+      /// \brief Sequential storage of components. Each page holds up to
+      /// kPageSize components and is never reallocated. Moving the outer
+      /// vector moves the page buffers without touching the components.
+      private: std::vector<std::vector<ComponentTypeT>> pages;
+
+      /// \brief Slots left by RemoveDeferred, to be reclaimed by Compact.
+      /// Slots which were already reclaimed may remain in the list.
+      private: std::vector<int> tombstones;
 
-      /// \brief Sequential storage of components.
-      public: std::vector<ComponentTypeT> components;
+      /// \brief Number of slots holding a tombstone, whose id in ids is
+      /// kComponentIdInvalid.
+      private: std::size_t tombstoneCount{0};
     };
     }
   }
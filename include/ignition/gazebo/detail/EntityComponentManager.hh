@@ -17,10 +17,15 @@
 #ifndef IGNITION_GAZEBO_DETAIL_ENTITYCOMPONENTMANAGER_HH_
 #define IGNITION_GAZEBO_DETAIL_ENTITYCOMPONENTMANAGER_HH_
 
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
+#include <functional>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -88,6 +93,45 @@ ComponentKey EntityComponentManager::CreateComponent(const Entity _entity,
       &_data);
 }
 
+//////////////////////////////////////////////////
+template<typename ComponentTypeT,
+         typename std::enable_if<
+           !std::is_reference<ComponentTypeT>::value &&
+           !std::is_const<ComponentTypeT>::value, int>::type>
+ComponentKey EntityComponentManager::CreateComponent(const Entity _entity,
+            ComponentTypeT &&_data)
+{
+  return this->CreateComponentImplementation(_entity, ComponentTypeT::typeId,
+      static_cast<components::BaseComponent &&>(_data));
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+std::vector<Entity> EntityComponentManager::CreateEntities(
+    const std::size_t _count,
+    const std::vector<ComponentTypeTs> &..._components)
+{
+  const bool sizesMatch = ((_components.size() == _count ||
+      _components.size() == 1u) && ...);
+  if (!sizesMatch)
+  {
+    ignerr << "Failed to create [" << _count << "] entities, each vector "
+           << "of components must have one or [" << _count << "] elements."
+           << std::endl;
+    return {};
+  }
+
+  const std::vector<std::pair<ComponentTypeId,
+      std::function<const components::BaseComponent *(std::size_t)>>>
+      columns{{ComponentTypeTs::typeId,
+          [&_components](std::size_t _index)
+              -> const components::BaseComponent *
+          {
+            return &_components[_components.size() == 1u ? 0u : _index];
+          }}...};
+  return this->CreateEntitiesImplementation(_count, columns);
+}
+
 //////////////////////////////////////////////////
 template<typename ComponentTypeT>
 const ComponentTypeT *EntityComponentManager::Component(
@@ -167,7 +211,34 @@ bool EntityComponentManager::SetComponentData(const Entity _entity,
     return true;
   }
 
-  return comp->SetData(_data, CompareData<typename ComponentTypeT::Type>);
+  if (!comp->SetData(_data, CompareData<typename ComponentTypeT::Type>))
+    return false;
+
+  this->UpdateComponentIndices(_entity, ComponentTypeT::typeId);
+  return true;
+}
+
+//////////////////////////////////////////////////
+template<typename ComponentTypeT>
+bool EntityComponentManager::SetComponentData(const Entity _entity,
+    typename ComponentTypeT::Type &&_data)
+{
+  auto comp = this->Component<ComponentTypeT>(_entity);
+
+  if (nullptr == comp)
+  {
+    this->CreateComponent(_entity, ComponentTypeT(std::move(_data)));
+    return true;
+  }
+
+  if (!comp->SetData(std::move(_data),
+        CompareData<typename ComponentTypeT::Type>))
+  {
+    return false;
+  }
+
+  this->UpdateComponentIndices(_entity, ComponentTypeT::typeId);
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -191,37 +262,29 @@ template<typename ...ComponentTypeTs>
 Entity EntityComponentManager::EntityByComponents(
     const ComponentTypeTs &..._desiredComponents) const
 {
+  // Only compare entities whose indexed data hashes match, if possible.
+  std::vector<Entity> candidates;
+  if (this->IndexedEntities(candidates, _desiredComponents...))
+  {
+    for (const Entity entity : candidates)
+    {
+      if (this->EntityMatchesComponents(entity, _desiredComponents...))
+        return entity;
+    }
+    return kNullEntity;
+  }
+
   // Get all entities which have components of the desired types
   const auto &view = this->FindView<ComponentTypeTs...>();
 
   // Iterate over entities
-  Entity result{kNullEntity};
   for (const Entity entity : view.entities)
   {
-    bool different{false};
-
-    // Iterate over desired components, comparing each of them to the
-    // equivalent component in the entity.
-    ForEach([&](const auto &_desiredComponent)
-    {
-      auto entityComponent = this->Component<
-          std::remove_cv_t<std::remove_reference_t<
-              decltype(_desiredComponent)>>>(entity);
-
-      if (*entityComponent != _desiredComponent)
-      {
-        different = true;
-      }
-    }, _desiredComponents...);
-
-    if (!different)
-    {
-      result = entity;
-      break;
-    }
+    if (this->EntityMatchesComponents(entity, _desiredComponents...))
+      return entity;
   }
 
-  return result;
+  return kNullEntity;
 }
 
 //////////////////////////////////////////////////
@@ -229,79 +292,144 @@ template<typename ...ComponentTypeTs>
 std::vector<Entity> EntityComponentManager::EntitiesByComponents(
     const ComponentTypeTs &..._desiredComponents) const
 {
+  std::vector<Entity> result;
+
+  // Only compare entities whose indexed data hashes match, if possible.
+  std::vector<Entity> candidates;
+  if (this->IndexedEntities(candidates, _desiredComponents...))
+  {
+    for (const Entity entity : candidates)
+    {
+      if (this->EntityMatchesComponents(entity, _desiredComponents...))
+        result.push_back(entity);
+    }
+    return result;
+  }
+
   // Get all entities which have components of the desired types
   const auto &view = this->FindView<ComponentTypeTs...>();
 
   // Iterate over entities
-  std::vector<Entity> result;
   for (const Entity entity : view.entities)
   {
-    bool different{false};
+    if (this->EntityMatchesComponents(entity, _desiredComponents...))
+      result.push_back(entity);
+  }
+
+  return result;
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::EnableComponentIndex()
+{
+  static_assert(sizeof...(ComponentTypeTs) > 0,
+      "A component index needs at least one component type.");
+  static_assert((HasHashableData<ComponentTypeTs>::value && ...),
+      "The data of indexed components must be hashable with std::hash.");
 
-    // Iterate over desired components, comparing each of them to the
-    // equivalent component in the entity.
-    ForEach([&](const auto &_desiredComponent)
+  std::map<ComponentTypeId, ComponentHasher> hashers;
+  ForEach([&](const auto &_component)
+  {
+    using ComponentT = std::remove_cv_t<std::remove_reference_t<
+        decltype(_component)>>;
+    hashers[ComponentT::typeId] = [](const components::BaseComponent &_base)
     {
-      auto entityComponent = this->Component<
-          std::remove_cv_t<std::remove_reference_t<
-              decltype(_desiredComponent)>>>(entity);
+      return std::hash<typename ComponentT::Type>{}(
+          static_cast<const ComponentT &>(_base).Data());
+    };
+  }, ComponentTypeTs()...);
+
+  this->EnableComponentIndexImplementation(hashers);
+}
 
-      if (*entityComponent != _desiredComponent)
+//////////////////////////////////////////////////
+template<typename ComponentTypeT>
+void EntityComponentManager::EnableRangeIndex(const std::string &_field,
+    std::function<double(const typename ComponentTypeT::Type &)> _key)
+{
+  this->EnableRangeIndexImplementation(ComponentTypeT::typeId, _field,
+      [_key](const components::BaseComponent &_base)
       {
-        different = true;
-      }
-    }, _desiredComponents...);
+        return _key(static_cast<const ComponentTypeT &>(_base).Data());
+      });
+}
 
-    if (!different)
+//////////////////////////////////////////////////
+template<typename ComponentTypeT>
+std::vector<Entity> EntityComponentManager::EntitiesInRange(
+    const std::string &_field, double _min, double _max) const
+{
+  return this->EntitiesInRangeImplementation(ComponentTypeT::typeId, _field,
+      _min, _max);
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+bool EntityComponentManager::EntityMatchesComponents(const Entity _entity,
+    const ComponentTypeTs &..._desiredComponents) const
+{
+  bool match{true};
+
+  // Iterate over desired components, comparing each of them to the
+  // equivalent component in the entity.
+  ForEach([&](const auto &_desiredComponent)
+  {
+    if (!match)
+      return;
+
+    auto entityComponent = this->Component<
+        std::remove_cv_t<std::remove_reference_t<
+            decltype(_desiredComponent)>>>(_entity);
+
+    if (nullptr == entityComponent || *entityComponent != _desiredComponent)
     {
-      result.push_back(entity);
+      match = false;
     }
-  }
+  }, _desiredComponents...);
 
-  return result;
+  return match;
 }
 
 //////////////////////////////////////////////////
 template<typename ...ComponentTypeTs>
-std::vector<Entity> EntityComponentManager::ChildrenByComponents(Entity _parent,
-     const ComponentTypeTs &..._desiredComponents) const
+bool EntityComponentManager::IndexedEntities(std::vector<Entity> &_entities,
+    const ComponentTypeTs &..._desiredComponents) const
 {
-  // Get all entities which have components of the desired types
-  const auto &view = this->FindView<ComponentTypeTs...>();
-
-  // Get all entities which are immediate children of the given parent
-  auto children = this->Entities().AdjacentsFrom(_parent);
-
-  // Iterate over entities
-  std::vector<Entity> result;
-  for (const Entity entity : view.entities)
+  std::map<ComponentTypeId, std::size_t> hashes;
+  ForEach([&](const auto &_desiredComponent)
   {
-    if (children.find(entity) == children.end())
+    using ComponentT = std::remove_cv_t<std::remove_reference_t<
+        decltype(_desiredComponent)>>;
+    if constexpr (HasHashableData<ComponentT>::value)
     {
-      continue;
+      hashes[ComponentT::typeId] = std::hash<typename ComponentT::Type>{}(
+          _desiredComponent.Data());
     }
+  }, _desiredComponents...);
 
-    // Iterate over desired components, comparing each of them to the
-    // equivalent component in the entity.
-    bool different{false};
-    ForEach([&](const auto &_desiredComponent)
-    {
-      auto entityComponent = this->Component<
-          std::remove_cv_t<std::remove_reference_t<
-              decltype(_desiredComponent)>>>(entity);
+  if (hashes.empty())
+    return false;
 
-      if (*entityComponent != _desiredComponent)
-      {
-        different = true;
-      }
-    }, _desiredComponents...);
+  return this->IndexedEntitiesImplementation(hashes, _entities);
+}
 
-    if (!different)
-    {
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+std::vector<Entity> EntityComponentManager::ChildrenByComponents(Entity _parent,
+     const ComponentTypeTs &..._desiredComponents) const
+{
+  // Only the immediate children of the given parent need to be compared.
+  std::vector<Entity> result;
+  for (const Entity entity : this->ChildEntities(_parent))
+  {
+    if (this->EntityMatchesComponents(entity, _desiredComponents...))
       result.push_back(entity);
-    }
   }
 
+  // Match the order in which views visit entities.
+  std::sort(result.begin(), result.end());
+
   return result;
 }
 
@@ -317,11 +445,10 @@ template<typename ...ComponentTypeTs>
 void EntityComponentManager::EachNoCache(typename identity<std::function<
     bool(const Entity &_entity, const ComponentTypeTs *...)>>::type _f) const
 {
+  const auto types = std::set<ComponentTypeId>{ComponentTypeTs::typeId...};
   for (const auto &vertex : this->Entities().Vertices())
   {
     Entity entity = vertex.first;
-    auto types = std::set<ComponentTypeId>{ComponentTypeTs::typeId...};
-
     if (this->EntityMatches(entity, types))
     {
       if (!_f(entity,
@@ -338,11 +465,10 @@ template<typename ...ComponentTypeTs>
 void EntityComponentManager::EachNoCache(typename identity<std::function<
     bool(const Entity &_entity, ComponentTypeTs *...)>>::type _f)
 {
+  const auto types = std::set<ComponentTypeId>{ComponentTypeTs::typeId...};
   for (const auto &vertex : this->Entities().Vertices())
   {
     Entity entity = vertex.first;
-    auto types = std::set<ComponentTypeId>{ComponentTypeTs::typeId...};
-
     if (this->EntityMatches(entity, types))
     {
       if (!_f(entity,
@@ -364,13 +490,17 @@ void EntityComponentManager::Each(typename identity<std::function<
   detail::View &view = this->FindView<ComponentTypeTs...>();
 
   // Iterate over the entities in the view, and invoke the callback
-  // function.
-  for (const Entity entity : view.entities)
+  // function. The callback may add entities to or remove entities from the
+  // view, so the index of the next entity is looked up after each call.
+  std::size_t slot = 0;
+  while (slot < view.entities.size())
   {
-    if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
+    const Entity entity = view.entities[slot];
+    if (!_f(entity, view.ComponentAt<ComponentTypeTs>(slot)...))
     {
       break;
     }
+    slot = detail::View::NextIndex(view.entities, slot, entity);
   }
 }
 
@@ -379,21 +509,152 @@ template<typename ...ComponentTypeTs>
 void EntityComponentManager::Each(typename identity<std::function<
     bool(const Entity &_entity, ComponentTypeTs *...)>>::type _f)
 {
+  // Components may be modified, so they can't be shared with forks.
+  (this->UnshareComponents(ComponentTypeTs::typeId), ...);
+
   // Get the view. This will create a new view if one does not already
   // exist.
   detail::View &view = this->FindView<ComponentTypeTs...>();
 
   // Iterate over the entities in the view, and invoke the callback
-  // function.
-  for (const Entity entity : view.entities)
+  // function. The callback may add entities to or remove entities from the
+  // view, so the index of the next entity is looked up after each call.
+  std::size_t slot = 0;
+  while (slot < view.entities.size())
   {
-    if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
+    const Entity entity = view.entities[slot];
+    if (!_f(entity, view.ComponentAt<ComponentTypeTs>(slot)...))
+    {
+      break;
+    }
+    slot = detail::View::NextIndex(view.entities, slot, entity);
+  }
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs, typename FunctionT,
+         typename std::enable_if<!EntityComponentManager::IsStdFunction<
+             std::decay_t<FunctionT>>::value, int>::type>
+void EntityComponentManager::Each(FunctionT &&_f) const
+{
+  // Get the view. This will create a new view if one does not already
+  // exist.
+  const detail::View &view = this->FindView<ComponentTypeTs...>();
+
+  // Iterate over the entities in the view, and invoke the callback
+  // function. The callback may add entities to or remove entities from the
+  // view, so the index of the next entity is looked up after each call.
+  std::size_t slot = 0;
+  while (slot < view.entities.size())
+  {
+    const Entity entity = view.entities[slot];
+    if (!_f(entity, view.ComponentAt<ComponentTypeTs>(slot)...))
     {
       break;
     }
+    slot = detail::View::NextIndex(view.entities, slot, entity);
   }
 }
 
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs, typename FunctionT,
+         typename std::enable_if<!EntityComponentManager::IsStdFunction<
+             std::decay_t<FunctionT>>::value, int>::type>
+void EntityComponentManager::Each(FunctionT &&_f)
+{
+  // Components may be modified, so they can't be shared with forks.
+  (this->UnshareComponents(ComponentTypeTs::typeId), ...);
+
+  // Get the view. This will create a new view if one does not already
+  // exist.
+  detail::View &view = this->FindView<ComponentTypeTs...>();
+
+  // Iterate over the entities in the view, and invoke the callback
+  // function. The callback may add entities to or remove entities from the
+  // view, so the index of the next entity is looked up after each call.
+  std::size_t slot = 0;
+  while (slot < view.entities.size())
+  {
+    const Entity entity = view.entities[slot];
+    if (!_f(entity, view.ComponentAt<ComponentTypeTs>(slot)...))
+    {
+      break;
+    }
+    slot = detail::View::NextIndex(view.entities, slot, entity);
+  }
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+detail::ViewRange<true, ComponentTypeTs...> EntityComponentManager::View()
+    const
+{
+  // Get the view. This will create a new view if one does not already
+  // exist.
+  const detail::View &view = this->FindView<ComponentTypeTs...>();
+  return detail::ViewRange<true, ComponentTypeTs...>(view);
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+detail::ViewRange<false, ComponentTypeTs...> EntityComponentManager::View()
+{
+  // Components may be modified, so they can't be shared with forks.
+  (this->UnshareComponents(ComponentTypeTs::typeId), ...);
+
+  // Get the view. This will create a new view if one does not already
+  // exist.
+  detail::View &view = this->FindView<ComponentTypeTs...>();
+  return detail::ViewRange<false, ComponentTypeTs...>(view);
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs, typename FunctionT>
+void EntityComponentManager::ParallelEach(FunctionT &&_f,
+    std::size_t _minChunkSize) const
+{
+  // Get the view. This will create a new view if one does not already
+  // exist.
+  const detail::View &view = this->FindView<ComponentTypeTs...>();
+
+  // The view can't change while the chunks run, since the callback isn't
+  // allowed to create or remove components.
+  this->ParallelFor(view.entities.size(), _minChunkSize,
+      [&](std::size_t _begin, std::size_t _end)
+      {
+        for (std::size_t slot = _begin; slot < _end; ++slot)
+        {
+          _f(view.entities[slot], view.ComponentAt<ComponentTypeTs>(slot)...);
+        }
+      });
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs, typename FunctionT>
+void EntityComponentManager::ParallelEach(FunctionT &&_f,
+    std::size_t _minChunkSize)
+{
+  // Components may be modified, so they can't be shared with forks. This
+  // happens before the chunks run, since storages can't be copied
+  // concurrently.
+  (this->UnshareComponents(ComponentTypeTs::typeId), ...);
+
+  // Get the view. This will create a new view if one does not already
+  // exist.
+  detail::View &view = this->FindView<ComponentTypeTs...>();
+
+  // The view can't change while the chunks run, since the callback isn't
+  // allowed to create or remove components.
+  this->ParallelFor(view.entities.size(), _minChunkSize,
+      [&](std::size_t _begin, std::size_t _end)
+      {
+        for (std::size_t slot = _begin; slot < _end; ++slot)
+        {
+          _f(view.entities[slot], view.ComponentAt<ComponentTypeTs>(slot)...);
+        }
+      });
+}
+
 //////////////////////////////////////////////////
 template <class Function, class... ComponentTypeTs>
 void EntityComponentManager::ForEach(Function _f,
@@ -407,6 +668,9 @@ template <typename... ComponentTypeTs>
 void EntityComponentManager::EachNew(typename identity<std::function<
     bool(const Entity &_entity, ComponentTypeTs *...)>>::type _f)
 {
+  // Components may be modified, so they can't be shared with forks.
+  (this->UnshareComponents(ComponentTypeTs::typeId), ...);
+
   // Get the view. This will create a new view if one does not already
   // exist.
   detail::View &view = this->FindView<ComponentTypeTs...>();
@@ -414,12 +678,15 @@ void EntityComponentManager::EachNew(typename identity<std::function<
   // Iterate over the entities in the view and in the newly created
   // entities list, and invoke the callback
   // function.
-  for (const Entity entity : view.newEntities)
+  std::size_t index = 0;
+  while (index < view.newEntities.size())
   {
+    const Entity entity = view.newEntities[index];
     if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
     {
       break;
     }
+    index = detail::View::NextIndex(view.newEntities, index, entity);
   }
 }
 
@@ -435,12 +702,15 @@ void EntityComponentManager::EachNew(typename identity<std::function<
   // Iterate over the entities in the view and in the newly created
   // entities list, and invoke the callback
   // function.
-  for (const Entity entity : view.newEntities)
+  std::size_t index = 0;
+  while (index < view.newEntities.size())
   {
+    const Entity entity = view.newEntities[index];
     if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
     {
       break;
     }
+    index = detail::View::NextIndex(view.newEntities, index, entity);
   }
 }
 
@@ -456,12 +726,48 @@ void EntityComponentManager::EachRemoved(typename identity<std::function<
   // Iterate over the entities in the view and in the newly created
   // entities list, and invoke the callback
   // function.
-  for (const Entity entity : view.toRemoveEntities)
+  std::size_t index = 0;
+  while (index < view.toRemoveEntities.size())
   {
+    const Entity entity = view.toRemoveEntities[index];
     if (!_f(entity, view.Component<ComponentTypeTs>(entity, this)...))
     {
       break;
     }
+    index = detail::View::NextIndex(view.toRemoveEntities, index, entity);
+  }
+}
+
+//////////////////////////////////////////////////
+template<typename ...ComponentTypeTs>
+void EntityComponentManager::EachChanged(uint64_t &_token,
+    typename identity<std::function<
+    bool(const Entity &_entity, const ComponentTypeTs *...)>>::type _f) const
+{
+  static_assert(sizeof...(ComponentTypeTs) > 0,
+      "EachChanged needs at least one component type.");
+  using ChangedComponentT =
+      std::tuple_element_t<0, std::tuple<ComponentTypeTs...>>;
+
+  for (const Entity entity :
+      this->ChangedEntities(ChangedComponentT::typeId, _token))
+  {
+    auto components = std::make_tuple(
+        this->Component<ComponentTypeTs>(entity)...);
+
+    const bool complete = std::apply([](const auto *..._components)
+    {
+      return ((nullptr != _components) && ...);
+    }, components);
+    if (!complete)
+      continue;
+
+    const bool next = std::apply([&](const auto *..._components)
+    {
+      return _f(entity, _components...);
+    }, components);
+    if (!next)
+      break;
   }
 }
 
@@ -475,12 +781,12 @@ void EntityComponentManager::AddComponentsToView(detail::View &_view,
 {
   const ComponentTypeId typeId = FirstComponent::typeId;
 
-  const ComponentId compId =
-      this->EntityComponentIdFromType(_entity, typeId);
-  if (compId >= 0)
+  const components::BaseComponent *comp =
+      this->ComponentImplementation(_entity, typeId);
+  if (nullptr != comp)
   {
     // Add the component to the view.
-    _view.AddComponent(_entity, typeId, compId);
+    _view.AddComponent(_entity, typeId, comp);
   }
   else
   {
@@ -498,12 +804,12 @@ void EntityComponentManager::AddComponentsToView(detail::View &_view,
     const Entity _entity) const
 {
   const ComponentTypeId typeId = FirstComponent::typeId;
-  const ComponentId compId =
-      this->EntityComponentIdFromType(_entity, typeId);
-  if (compId >= 0)
+  const components::BaseComponent *comp =
+      this->ComponentImplementation(_entity, typeId);
+  if (nullptr != comp)
   {
     // Add the component to the view.
-    _view.AddComponent(_entity, typeId, compId);
+    _view.AddComponent(_entity, typeId, comp);
   }
   else
   {
@@ -519,6 +825,12 @@ void EntityComponentManager::AddComponentsToView(detail::View &_view,
 template<typename ...ComponentTypeTs>
 detail::View &EntityComponentManager::FindView() const
 {
+  // Repeated calls get the view from their slot, without building the key or
+  // searching the map.
+  static const std::size_t slot = EntityComponentManager::NewViewSlot();
+  if (detail::View *cached = this->CachedView(slot))
+    return *cached;
+
   auto types = std::set<ComponentTypeId>{ComponentTypeTs::typeId...};
 
   std::map<detail::ComponentTypeKey, detail::View>::iterator viewIter;
@@ -526,32 +838,32 @@ detail::View &EntityComponentManager::FindView() const
   // Find the view. If the view doesn't exist, then create a new view.
   if (!this->FindView(types, viewIter))
   {
-    detail::View view;
+    detail::View view(types);
     // Add all the entities that match the component types to the
-    // view.
-    for (const auto &vertex : this->Entities().Vertices())
+    // view. Only the archetypes which contain all the types are visited.
+    // Entities are sorted first so they're appended to the view in order.
+    std::vector<Entity> entities = this->ArchetypeEntities(types);
+    std::sort(entities.begin(), entities.end());
+    for (const Entity entity : entities)
     {
-      Entity entity = vertex.first;
-      if (this->EntityMatches(entity, types))
+      view.AddEntity(entity, this->IsNewEntity(entity));
+      // If there is a request to delete this entity, update the view as
+      // well
+      if (this->IsMarkedForRemoval(entity))
       {
-        view.AddEntity(entity, this->IsNewEntity(entity));
-        // If there is a request to delete this entity, update the view as
-        // well
-        if (this->IsMarkedForRemoval(entity))
-        {
-          view.AddEntityToRemoved(entity);
-        }
-
-        // Store pointers to all the components. This recursively adds
-        // all the ComponentTypeTs that belong to the entity to the view.
-        this->AddComponentsToView<ComponentTypeTs...>(view, entity);
+        view.AddEntityToRemoved(entity);
       }
+
+      // Store pointers to all the components. This recursively adds
+      // all the ComponentTypeTs that belong to the entity to the view.
+      this->AddComponentsToView<ComponentTypeTs...>(view, entity);
     }
 
     // Store the view.
-    return this->AddView(types, std::move(view))->second;
+    viewIter = this->AddView(types, std::move(view));
   }
 
+  this->CacheView(slot, &viewIter->second);
   return viewIter->second;
 }
 
@@ -562,6 +874,16 @@ bool EntityComponentManager::RemoveComponent(Entity _entity)
   const auto typeId = ComponentTypeT::typeId;
   return this->RemoveComponent(_entity, typeId);
 }
+
+//////////////////////////////////////////////////
+template<typename T, typename ...ArgTs>
+std::shared_ptr<T> EntityComponentManager::SharedObject(
+    const std::string &_key, ArgTs &&..._args) const
+{
+  return std::static_pointer_cast<T>(this->SharedObjectImplementation(_key,
+      [&]() -> void * { return new T(std::forward<ArgTs>(_args)...); },
+      [](void *_object) { delete static_cast<T *>(_object); }));
+}
 }
 }
 }
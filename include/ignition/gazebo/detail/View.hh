@@ -17,10 +17,14 @@
 #ifndef IGNITION_GAZEBO_DETAIL_VIEW_HH_
 #define IGNITION_GAZEBO_DETAIL_VIEW_HH_
 
-#include <map>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 #include "ignition/gazebo/components/Component.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/Export.hh"
@@ -37,6 +41,51 @@ namespace detail
 /// \brief A key into the map of views
 using ComponentTypeKey = std::set<ComponentTypeId>;
 
+/// \brief Change generation during which a view was last used, see
+/// EntityComponentManager::SetViewEviction. Systems running at the same time
+/// may use the same view, so it's atomic, but unlike std::atomic it can be
+/// copied and moved along with its view.
+class ViewUsage
+{
+  /// \brief Constructor
+  public: ViewUsage() = default;
+
+  /// \brief Copy constructor
+  /// \param[in] _other Usage to copy.
+  public: ViewUsage(const ViewUsage &_other)
+      : generation(_other.Generation())
+  {
+  }
+
+  /// \brief Copy assignment
+  /// \param[in] _other Usage to copy.
+  /// \return Reference to this.
+  public: ViewUsage &operator=(const ViewUsage &_other)
+  {
+    this->generation.store(_other.Generation(), std::memory_order_relaxed);
+    return *this;
+  }
+
+  /// \brief Mark the view as used. The generation is only written when it
+  /// changes, so views used every iteration aren't written on every use.
+  /// \param[in] _generation Current change generation.
+  public: void Mark(const uint64_t _generation)
+  {
+    if (this->generation.load(std::memory_order_relaxed) != _generation)
+      this->generation.store(_generation, std::memory_order_relaxed);
+  }
+
+  /// \brief Get the change generation during which the view was last used.
+  /// \return Change generation, or zero if the view was never used.
+  public: uint64_t Generation() const
+  {
+    return this->generation.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Change generation during which the view was last used.
+  private: std::atomic<uint64_t> generation{0};
+};
+
 /// \brief A view is a cache to entities, and their components, that
 /// match a set of component types. A cache is used because systems will
 /// frequently, potentially every iteration, query the
@@ -45,19 +94,28 @@ using ComponentTypeKey = std::set<ComponentTypeId>;
 /// use a cache to improve performance. The assumption is that entities
 /// and the types of components assigned to entities change infrequently
 /// compared to the frequency of queries performed by systems.
+///
+/// Entities are kept in a sorted vector, and the components of the entity at
+/// each slot of that vector are kept as a dense row of pointers, one per
+/// component type, so iterating over a view is a linear scan.
 class IGNITION_GAZEBO_VISIBLE View
 {
+  /// \brief Constructor
+  /// \param[in] _types Component types of the entities in this view.
+  public: explicit View(const ComponentTypeKey &_types = {});
+
   /// Get a pointer to a component for an entity based on a component type.
   /// \param[in] _entity The entity.
   /// \param[in] _ecm Pointer to the entity component manager.
   /// \return Pointer to the component.
   public: template<typename ComponentTypeT>
           const ComponentTypeT *Component(const Entity _entity,
-              const EntityComponentManager *_ecm) const
+              const EntityComponentManager * /*_ecm*/) const
   {
-    ComponentTypeId typeId = ComponentTypeT::typeId;
-    return static_cast<const ComponentTypeT *>(
-        this->ComponentImplementation(_entity, typeId, _ecm));
+    const std::size_t slot = this->Slot(_entity);
+    if (slot >= this->entities.size())
+      return nullptr;
+    return this->ComponentAt<ComponentTypeT>(slot);
   }
 
   /// Get a pointer to a component for an entity based on a component type.
@@ -66,12 +124,36 @@ class IGNITION_GAZEBO_VISIBLE View
   /// \return Pointer to the component.
   public: template<typename ComponentTypeT>
           ComponentTypeT *Component(const Entity _entity,
-              const EntityComponentManager *_ecm)
+              const EntityComponentManager * /*_ecm*/)
+  {
+    const std::size_t slot = this->Slot(_entity);
+    if (slot >= this->entities.size())
+      return nullptr;
+    return this->ComponentAt<ComponentTypeT>(slot);
+  }
+
+  /// \brief Get a pointer to a component of the entity at a given slot.
+  /// \param[in] _slot Index of the entity in `entities`.
+  /// \return Pointer to the component.
+  public: template<typename ComponentTypeT>
+          const ComponentTypeT *ComponentAt(const std::size_t _slot) const
+  {
+    return static_cast<const ComponentTypeT *>(
+        this->components[_slot * this->types.size() +
+        this->TypeIndex(ComponentTypeT::typeId)]);
+  }
+
+  /// \brief Get a mutable pointer to a component of the entity at a given
+  /// slot.
+  /// \param[in] _slot Index of the entity in `entities`.
+  /// \return Pointer to the component.
+  public: template<typename ComponentTypeT>
+          ComponentTypeT *ComponentAt(const std::size_t _slot)
   {
-    ComponentTypeId typeId = ComponentTypeT::typeId;
     return static_cast<ComponentTypeT *>(
         const_cast<components::BaseComponent *>(
-          this->ComponentImplementation(_entity, typeId, _ecm)));
+        this->components[_slot * this->types.size() +
+        this->TypeIndex(ComponentTypeT::typeId)]));
   }
 
   /// \brief Add an entity to the view.
@@ -90,6 +172,12 @@ class IGNITION_GAZEBO_VISIBLE View
   public: bool RemoveEntity(const Entity _entity,
                            const ComponentTypeKey &_key);
 
+  /// \brief Remove several entities from the view, compacting the lists
+  /// and component rows once instead of once per entity.
+  /// \param[in] _entities Entities to remove, sorted and without
+  /// duplicates. Entities which aren't in the view are ignored.
+  public: void RemoveEntities(const std::vector<Entity> &_entities);
+
   /// \brief Add the entity to the list of entities to be removed
   /// \param[in] _entity The entity to add.
   /// \return True if the entity was added to the list, false if the entity
@@ -97,38 +185,88 @@ class IGNITION_GAZEBO_VISIBLE View
   public: bool AddEntityToRemoved(const Entity _entity);
 
   /// \brief Add a component to an entity.
-  /// \param[in] _entity The entity.
+  /// \param[in] _entity The entity, which must already be in the view.
   /// \param[in] _compTypeId Component type id.
-  /// \param[in] _compId Component id.
+  /// \param[in] _comp Pointer to the component.
   public: void AddComponent(const Entity _entity,
                             const ComponentTypeId _compTypeId,
-                            const ComponentId _compId);
+                            const components::BaseComponent *_comp);
 
-  /// \brief Implementation of the Component accessor.
-  /// \param[in] _entity The entity.
-  /// \param[in] _typeId Type id of the component.
+  /// \brief Look up again the pointers to all components of a given type.
+  /// This must be called after components of that type were moved within
+  /// their storage.
+  /// \param[in] _compTypeId Component type id.
   /// \param[in] _ecm Pointer to the EntityComponentManager.
-  /// \return Pointer to the component, or nullptr if not found.
-  private: const components::BaseComponent *ComponentImplementation(
-               const Entity _entity,
-               ComponentTypeId _typeId,
-               const EntityComponentManager *_ecm) const;
+  public: void RefreshComponents(const ComponentTypeId _compTypeId,
+                                 const EntityComponentManager *_ecm);
+
+  /// \brief Get the slot of an entity.
+  /// \param[in] _entity The entity.
+  /// \return Index of the entity in `entities`, or the size of `entities`
+  /// if the entity is not in the view.
+  public: std::size_t Slot(const Entity _entity) const;
+
+  /// \brief Get the index in a sorted list of entities from which to
+  /// resume an iteration. This accounts for entities that were added to or
+  /// removed from the list while the entity at `_index` was being visited.
+  /// \param[in] _list Sorted list of entities.
+  /// \param[in] _index Index that was being visited.
+  /// \param[in] _entity Entity that was at `_index` when it was visited.
+  /// \return Index of the first entity that comes after `_entity`.
+  public: static std::size_t NextIndex(const std::vector<Entity> &_list,
+              const std::size_t _index, const Entity _entity)
+  {
+    if (_index < _list.size() && _list[_index] == _entity)
+      return _index + 1;
+    return static_cast<std::size_t>(std::upper_bound(_list.begin(),
+        _list.end(), _entity) - _list.begin());
+  }
 
   /// \brief Clear the list of new entities
   public: void ClearNewEntities();
 
-  /// \brief All the entities that belong to this view.
-  public: std::set<Entity> entities;
+  /// \brief Get the memory allocated by the view.
+  /// \return Bytes taken by the view and its lists.
+  public: std::size_t MemoryUsage() const;
+
+  /// \brief Remove all entities and components from the view. The lists of
+  /// new entities and entities to be removed are kept.
+  public: void Clear();
+
+  /// \brief Get the column of a component type in each row of `components`.
+  /// \param[in] _typeId Component type id.
+  /// \return Index of the type, or the number of types if the type is not
+  /// part of the view.
+  private: std::size_t TypeIndex(const ComponentTypeId _typeId) const
+  {
+    // Views have few component types, so a linear search is fastest.
+    for (std::size_t i = 0; i < this->types.size(); ++i)
+    {
+      if (this->types[i] == _typeId)
+        return i;
+    }
+    return this->types.size();
+  }
+
+  /// \brief All the entities that belong to this view, sorted.
+  public: std::vector<Entity> entities;
+
+  /// \brief List of newly created entities, sorted.
+  public: std::vector<Entity> newEntities;
+
+  /// \brief List of entities about to be removed, sorted.
+  public: std::vector<Entity> toRemoveEntities;
 
-  /// \brief List of newly created entities
-  public: std::set<Entity> newEntities;
+  /// \brief Component types of this view, sorted.
+  public: std::vector<ComponentTypeId> types;
 
-  /// \brief List of entities about to be removed
-  public: std::set<Entity> toRemoveEntities;
+  /// \brief Pointers to the components of each entity. The row for the
+  /// entity at slot `i` starts at `i * types.size()`, and columns follow the
+  /// order of `types`.
+  public: std::vector<const components::BaseComponent *> components;
 
-  /// \brief All of the components for each entity.
-  public: std::map<std::pair<Entity, ComponentTypeId>,
-          ComponentId> components;
+  /// \brief When the view was last used.
+  public: mutable ViewUsage usage;
 };
 /// \endcond
 }
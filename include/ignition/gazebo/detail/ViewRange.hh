@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GAZEBO_DETAIL_VIEWRANGE_HH_
+#define IGNITION_GAZEBO_DETAIL_VIEWRANGE_HH_
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+#include "ignition/gazebo/config.hh"
+#include "ignition/gazebo/detail/View.hh"
+#include "ignition/gazebo/Entity.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace detail
+{
+/// \brief A range over the entities of a view and their components, which
+/// can be used in a range-based for loop. Each element is a tuple holding
+/// the entity followed by pointers to its components, in the order of
+/// ComponentTypeTs.
+///
+/// Entities can be added to or removed from the view while iterating, the
+/// iteration resumes after the last visited entity.
+/// \tparam IsConst True to iterate over const components.
+/// \tparam ComponentTypeTs Component types of the view.
+template<bool IsConst, typename ...ComponentTypeTs>
+class ViewRange
+{
+  /// \brief Type of the view being iterated.
+  public: using ViewType = std::conditional_t<IsConst, const View, View>;
+
+  /// \brief Type of each element of the range.
+  public: using value_type = std::tuple<Entity,
+          std::conditional_t<IsConst, const ComponentTypeTs,
+                             ComponentTypeTs> *...>;
+
+  /// \brief Marks the end of the range.
+  public: class Sentinel
+  {
+  };
+
+  /// \brief Iterator over the entities of a view.
+  public: class Iterator
+  {
+    /// \brief Constructor
+    /// \param[in] _view View to iterate over.
+    public: explicit Iterator(ViewType *_view)
+            : view(_view)
+    {
+      this->UpdateEntity();
+    }
+
+    /// \brief Get the current entity and its components.
+    /// \return Tuple with the entity and pointers to its components.
+    public: value_type operator*() const
+    {
+      return value_type(this->entity,
+          this->view->template ComponentAt<ComponentTypeTs>(this->slot)...);
+    }
+
+    /// \brief Advance to the next entity.
+    /// \return Reference to this iterator.
+    public: Iterator &operator++()
+    {
+      this->slot = View::NextIndex(this->view->entities, this->slot,
+          this->entity);
+      this->UpdateEntity();
+      return *this;
+    }
+
+    /// \brief Check whether there are entities left to visit.
+    /// \return True if the end of the range wasn't reached.
+    public: bool operator!=(const Sentinel &) const
+    {
+      return this->slot < this->view->entities.size();
+    }
+
+    /// \brief Check whether the end of the range was reached.
+    /// \return True if there are no entities left to visit.
+    public: bool operator==(const Sentinel &_end) const
+    {
+      return !(*this != _end);
+    }
+
+    /// \brief Store the entity at the current slot, so the iteration can
+    /// resume after it if the view changes.
+    private: void UpdateEntity()
+    {
+      if (this->slot < this->view->entities.size())
+        this->entity = this->view->entities[this->slot];
+    }
+
+    /// \brief View being iterated.
+    private: ViewType *view;
+
+    /// \brief Index of the current entity in the view.
+    private: std::size_t slot{0};
+
+    /// \brief Current entity.
+    private: Entity entity{kNullEntity};
+  };
+
+  /// \brief Constructor
+  /// \param[in] _view View to iterate over. It must outlive the range.
+  public: explicit ViewRange(ViewType &_view)
+          : view(&_view)
+  {
+  }
+
+  /// \brief Get an iterator to the first entity.
+  /// \return Iterator to the first entity.
+  public: Iterator begin() const
+  {
+    return Iterator(this->view);
+  }
+
+  /// \brief Get the end of the range.
+  /// \return Sentinel marking the end of the range.
+  public: Sentinel end() const
+  {
+    return Sentinel();
+  }
+
+  /// \brief Get the number of entities in the range.
+  /// \return Number of entities.
+  public: std::size_t size() const
+  {
+    return this->view->entities.size();
+  }
+
+  /// \brief Check whether the range is empty.
+  /// \return True if there are no entities.
+  public: bool empty() const
+  {
+    return this->view->entities.empty();
+  }
+
+  /// \brief View being iterated.
+  private: ViewType *view;
+};
+}
+}
+}
+}
+#endif
@@ -61,10 +61,22 @@ class IGNITION_GAZEBO_GUI_VISIBLE GuiRunner : public QObject
   /// \param[in] _res Response containing new state.
   private: void OnStateAsyncService(const msgs::SerializedStepMap &_res);
 
-  /// \brief Callback when a new state is received from the server.
+  /// \brief Callback when a new state is received from the server. The
+  /// state is queued for the state thread, see ProcessStates.
   /// \param[in] _msg New state message.
   private: void OnState(const msgs::SerializedStepMap &_msg);
 
+  /// \brief Apply the queued states to the ECM and update the plugins
+  /// until the runner is destroyed. All the states queued since the
+  /// previous update are applied before the plugins are updated once, so
+  /// they see the changes of all of them together.
+  private: void ProcessStates();
+
+  /// \brief Read states from the world's shared memory channel until the
+  /// runner is destroyed. Falls back to subscribing to states if the server
+  /// doesn't write them to shared memory.
+  private: void ReadSharedMemory();
+
   /// \brief Pointer to private data.
   IGN_UTILS_UNIQUE_IMPL_PTR(dataPtr)
 };
@@ -19,6 +19,8 @@
 
 #include <QtCore>
 
+#include <set>
+
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/EntityComponentManager.hh>
 #include <ignition/gazebo/gui/Export.hh>
@@ -53,6 +55,17 @@ namespace gazebo
     /// and write entities and their components.
     public: virtual void Update(const UpdateInfo &/*_info*/,
                                 EntityComponentManager &/*_ecm*/){}
+
+    /// \brief Get the component types the system reads from the ECM. When
+    /// all the loaded GUI systems list their types, the GUI only
+    /// replicates those types from the server, which saves memory and
+    /// deserialization time on big worlds.
+    /// \return Component types, or an empty set, the default, if the
+    /// system needs all of them.
+    public: virtual std::set<ComponentTypeId> ComponentTypes() const
+    {
+      return {};
+    }
   };
 }
 }
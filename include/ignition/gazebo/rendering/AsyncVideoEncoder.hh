@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef IGNITION_GAZEBO_ASYNCVIDEOENCODER_HH_
+#define IGNITION_GAZEBO_ASYNCVIDEOENCODER_HH_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/rendering/Export.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+// Forward declare private data class.
+class AsyncVideoEncoderPrivate;
+
+/// \brief Encodes video frames on a background thread, so the thread which
+/// renders them only copies them into a bounded queue.
+///
+/// When the queue is full, new frames are dropped, or, if frame dropping is
+/// disabled, AddFrame waits for the encoder to catch up. The latter is
+/// meant for lockstep recording where every frame must be kept.
+///
+/// Frames are encoded by common::VideoEncoder. Hardware encoders are enabled
+/// through the IGN_VIDEO_ALLOWED_ENCODERS environment variable, which
+/// ign-common versions that support them read when encoding starts, see
+/// SetHardwareEncoders.
+class IGNITION_GAZEBO_RENDERING_VISIBLE AsyncVideoEncoder
+{
+  /// \brief Constructor
+  public: AsyncVideoEncoder();
+
+  /// \brief Destructor, stops encoding.
+  public: ~AsyncVideoEncoder();
+
+  /// \brief Set how many frames can wait to be encoded. Only takes effect
+  /// when encoding starts.
+  /// \param[in] _size Queue size, at least 1. Defaults to 4.
+  public: void SetQueueSize(std::size_t _size);
+
+  /// \brief Set whether frames added while the queue is full are dropped.
+  /// \param[in] _drop False to wait for room instead. Defaults to true.
+  public: void SetDropFrames(bool _drop);
+
+  /// \brief Set the hardware encoders which may be used, such as "NVENC" or
+  /// "VAAPI", separated by ":". It's passed to ign-common through the
+  /// IGN_VIDEO_ALLOWED_ENCODERS environment variable when encoding starts,
+  /// unless the variable is already set. Empty, the default, to leave it
+  /// untouched.
+  /// \param[in] _encoders Allowed encoders.
+  public: void SetHardwareEncoders(const std::string &_encoders);
+
+  /// \brief Set a callback invoked on the encoding thread for every frame
+  /// which the encoder kept, with the frame's timestamp.
+  /// \param[in] _cb Callback, empty to remove it.
+  public: void SetFrameCallback(
+      std::function<void(const std::chrono::steady_clock::time_point &)>
+      _cb);
+
+  /// \brief Start encoding.
+  /// \param[in] _format Video format, such as "mp4"
+  /// \param[in] _filename File to encode into
+  /// \param[in] _width Frame width in pixels
+  /// \param[in] _height Frame height in pixels
+  /// \param[in] _fps Frames per second of the video
+  /// \param[in] _bitRate Bit rate of the video
+  /// \return True if encoding started.
+  public: bool Start(const std::string &_format, const std::string &_filename,
+      unsigned int _width, unsigned int _height, unsigned int _fps = 25,
+      unsigned int _bitRate = 2070000);
+
+  /// \brief Whether encoding has started and hasn't been stopped.
+  /// \return True if encoding.
+  public: bool IsEncoding() const;
+
+  /// \brief Queue an RGB frame to be encoded. The data is copied.
+  /// \param[in] _frame Frame data
+  /// \param[in] _width Frame width in pixels
+  /// \param[in] _height Frame height in pixels
+  /// \param[in] _timestamp Time of the frame, which the encoder uses to
+  /// keep the video's frame rate
+  /// \return True if the frame was queued, false if it was dropped or
+  /// encoding hasn't started.
+  public: bool AddFrame(const unsigned char *_frame, unsigned int _width,
+      unsigned int _height,
+      const std::chrono::steady_clock::time_point &_timestamp);
+
+  /// \brief Encode the queued frames and stop encoding. Blocks until the
+  /// video is written.
+  public: void Stop();
+
+  /// \brief Number of frames dropped since encoding started.
+  /// \return Dropped frames.
+  public: uint64_t DroppedFrames() const;
+
+  /// \brief Private data pointer.
+  private: std::unique_ptr<AsyncVideoEncoderPrivate> dataPtr;
+};
+}
+}
+}
+#endif
@@ -60,6 +60,9 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     public: int PendingSensors() const;
 
     /// \brief Main update function. Must be called in the rendering thread.
+    /// Applies the updates prepared by the last calls to UpdateFromECM. It
+    /// doesn't wait for UpdateFromECM to finish visiting the ECM, updates
+    /// are handed over once they're complete.
     public: void Update();
 
     /// \brief Get a pointer to the scene
@@ -107,6 +110,13 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \brief Show grid view in the scene
     public: void ShowGrid();
 
+    /// \brief Set whether to animate the skeletons of actors. When disabled,
+    /// actors only follow their trajectories, which is enough for uses that
+    /// don't depend on their limbs. Skeletons of actors culled by the scene
+    /// manager aren't animated either way. Defaults to true.
+    /// \param[in] _enabled False to only animate trajectories
+    public: void SetActorSkinningEnabled(bool _enabled);
+
     /// \brief Set whether to use the current GL context
     /// \param[in] _enable True to use the current GL context
     public: void SetUseCurrentGLContext(bool _enable);
@@ -21,6 +21,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <sdf/Geometry.hh>
 #include <sdf/Actor.hh>
@@ -34,6 +35,8 @@
 #include <ignition/common/Animation.hh>
 #include <ignition/common/graphics/Types.hh>
 
+#include <ignition/math/Vector3.hh>
+
 #include <ignition/msgs/particle_emitter.pb.h>
 
 #include <ignition/rendering/RenderTypes.hh>
@@ -110,6 +113,21 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \return World ID
     public: Entity WorldId() const;
 
+    /// \brief Set whether visuals with the same material share a single
+    /// rendering material instead of each having a copy. Engines that batch
+    /// objects which share a mesh and a material, such as ogre2, then draw
+    /// repeated objects, like rows of identical shelves, with instanced
+    /// draw calls. Materials of shared visuals must not be modified, since
+    /// that would change all of them, so this is off by default. It's
+    /// applied to visuals created after the call.
+    /// \param[in] _share True to share materials.
+    public: void SetShareMaterials(bool _share);
+
+    /// \brief Get whether visuals share materials.
+    /// \return True if materials are shared.
+    /// \sa SetShareMaterials
+    public: bool ShareMaterials() const;
+
     /// \brief Create a model
     /// \param[in] _id Unique model id
     /// \param[in] _model Model sdf dom
@@ -250,6 +268,37 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \param[in] _id Entity's unique id
     public: void RemoveEntity(Entity _id);
 
+    /// \brief Set the size under which visuals are culled, as the ratio of
+    /// the radius of their bounding sphere to their distance from the
+    /// viewpoints given to UpdateCulling. For example, with 0.01 a visual
+    /// with a 1 m radius is culled beyond 100 m. Culled visuals get their
+    /// visibility flags cleared, so they aren't drawn by any camera, and
+    /// get them back once they're large enough. Planes and heightmaps are
+    /// never culled. Defaults to 0, which disables culling.
+    /// \param[in] _size Culling size, 0 to disable culling.
+    public: void SetCullingSize(double _size);
+
+    /// \brief Get the size under which visuals are culled.
+    /// \return Culling size, 0 if culling is disabled.
+    /// \sa SetCullingSize
+    public: double CullingSize() const;
+
+    /// \brief Cull visuals which are too small from all the given
+    /// viewpoints, and restore the ones which aren't anymore. Call it
+    /// before rendering, with the positions of the cameras being rendered.
+    /// \param[in] _viewpoints World positions of the cameras.
+    public: void UpdateCulling(const std::vector<math::Vector3d> &_viewpoints);
+
+    /// \brief Same as UpdateCulling, using the world positions of all the
+    /// sensors added with AddSensor as viewpoints.
+    public: void UpdateCulling();
+
+    /// \brief Get whether a visual or actor is currently culled, see
+    /// UpdateCulling. Culled actors don't need their skeletons animated.
+    /// \param[in] _id Entity's unique id
+    /// \return True if culled.
+    public: bool Culled(Entity _id) const;
+
     /// \brief Get the entity for a given node.
     /// \param[in] _node Node to get the entity for.
     /// \return The entity for that node, or `kNullEntity` for no entity.
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_COMMANDMAILBOX_HH_
+#define IGNITION_GAZEBO_COMMANDMAILBOX_HH_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include <ignition/gazebo/config.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class CommandMailbox CommandMailbox.hh
+    /// \brief Lock-free mailbox holding the latest value posted by any
+    /// number of producers, for a single consumer.
+    ///
+    /// Posting swaps the new value in with a single exchange and destroys
+    /// the value it replaced if the consumer didn't take it, so producers
+    /// never wait for the consumer or for each other. The consumer takes
+    /// the newest value with another exchange and keeps it until a newer one
+    /// arrives. This suits commands which are received on transport threads
+    /// and where only the most recent one matters to the next iteration.
+    /// \tparam T Type of the values.
+    template <typename T>
+    class CommandMailbox
+    {
+      /// \brief Constructor
+      /// \param[in] _initial Value returned by Latest until one is taken.
+      public: explicit CommandMailbox(T _initial = T())
+        : latest(std::make_unique<T>(std::move(_initial)))
+      {
+      }
+
+      /// \brief Destructor, destroys the value which wasn't taken.
+      public: ~CommandMailbox()
+      {
+        delete this->pending.load(std::memory_order_acquire);
+      }
+
+      /// \brief No copy, values are owned by a single mailbox.
+      public: CommandMailbox(const CommandMailbox &) = delete;
+
+      /// \brief No copy assignment.
+      public: CommandMailbox &operator=(const CommandMailbox &) = delete;
+
+      /// \brief Post a value, replacing any value which wasn't taken yet.
+      /// May be called from any thread.
+      /// \param[in] _value Value to post.
+      public: void Post(T _value)
+      {
+        T *value = new T(std::move(_value));
+        delete this->pending.exchange(value, std::memory_order_acq_rel);
+      }
+
+      /// \brief Take the newest posted value, if there's one which wasn't
+      /// taken yet. Must only be called by the consumer.
+      /// \return True if Latest changed.
+      public: bool Receive()
+      {
+        // Cheap check first, so idle mailboxes don't write the shared line
+        if (nullptr == this->pending.load(std::memory_order_relaxed))
+          return false;
+
+        T *value = this->pending.exchange(nullptr, std::memory_order_acq_rel);
+        if (nullptr == value)
+          return false;
+
+        this->latest.reset(value);
+        return true;
+      }
+
+      /// \brief Get the last value taken by Receive, without copying it.
+      /// Must only be called by the consumer.
+      /// \return The latest value, or the initial value if none was taken.
+      public: const T &Latest() const
+      {
+        return *this->latest;
+      }
+
+      /// \brief Value posted and not taken yet, null if there's none.
+      private: std::atomic<T *> pending{nullptr};
+
+      /// \brief Value owned by the consumer.
+      private: std::unique_ptr<T> latest;
+    };
+    }
+  }
+}
+#endif
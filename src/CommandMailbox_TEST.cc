@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CommandMailbox.hh"
+
+using namespace ignition::gazebo;
+
+/////////////////////////////////////////////////
+TEST(CommandMailboxTest, Latest)
+{
+  CommandMailbox<int> mailbox(7);
+  EXPECT_FALSE(mailbox.Receive());
+  EXPECT_EQ(7, mailbox.Latest());
+
+  // Only the newest value is kept
+  mailbox.Post(1);
+  mailbox.Post(2);
+  mailbox.Post(3);
+  EXPECT_EQ(7, mailbox.Latest());
+  EXPECT_TRUE(mailbox.Receive());
+  EXPECT_EQ(3, mailbox.Latest());
+
+  // The value is kept until a newer one is posted
+  EXPECT_FALSE(mailbox.Receive());
+  EXPECT_EQ(3, mailbox.Latest());
+
+  // Values which weren't taken are destroyed with the mailbox
+  CommandMailbox<std::string> strings;
+  EXPECT_TRUE(strings.Latest().empty());
+  strings.Post("not taken");
+}
+
+/////////////////////////////////////////////////
+TEST(CommandMailboxTest, Producers)
+{
+  // Each producer posts an increasing sequence, tagged with its index
+  struct Command
+  {
+    int producer{-1};
+    int sequence{-1};
+  };
+  CommandMailbox<Command> mailbox;
+
+  const int producerCount = 4;
+  const int postCount = 10000;
+  std::atomic<int> done{0};
+  std::vector<std::thread> producers;
+  for (int p = 0; p < producerCount; ++p)
+  {
+    producers.emplace_back([&, p]
+    {
+      for (int i = 0; i < postCount; ++i)
+        mailbox.Post({p, i});
+      ++done;
+    });
+  }
+
+  // Values taken from each producer are never older than earlier ones
+  std::vector<int> last(producerCount, -1);
+  while (done < producerCount)
+  {
+    if (!mailbox.Receive())
+      continue;
+    const auto &command = mailbox.Latest();
+    ASSERT_GE(command.producer, 0);
+    ASSERT_LT(command.producer, producerCount);
+    EXPECT_GT(command.sequence, last[command.producer]);
+    last[command.producer] = command.sequence;
+  }
+  for (auto &producer : producers)
+    producer.join();
+
+  // The last post of some producer is the final value
+  mailbox.Receive();
+  EXPECT_EQ(postCount - 1, mailbox.Latest().sequence);
+}
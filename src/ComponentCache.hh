@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_COMPONENTCACHE_HH_
+#define IGNITION_GAZEBO_COMPONENTCACHE_HH_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class ComponentCache ComponentCache.hh
+    /// \brief Pointers to components of a single entity, kept while the
+    /// component layout of an entity component manager doesn't change, see
+    /// EntityComponentManager::ComponentLayoutGeneration.
+    ///
+    /// Each component type used with the cache is given a fixed slot by the
+    /// caller, so a cached lookup is an array access. The cache is only
+    /// used with the manager it's bound to, other managers are looked up
+    /// directly.
+    /// \tparam N Number of slots.
+    template <std::size_t N>
+    class ComponentCache
+    {
+      /// \brief Bind the cache to a manager and forget cached pointers.
+      /// \param[in] _ecm Manager, or nullptr to unbind.
+      public: void Bind(const EntityComponentManager *_ecm)
+      {
+        this->ecm = _ecm;
+        this->generation = 0;
+      }
+
+      /// \brief Get the manager the cache is bound to.
+      /// \return Manager, or nullptr if not bound.
+      public: const EntityComponentManager *Bound() const
+      {
+        return this->ecm;
+      }
+
+      /// \brief Get a component, through the cache if bound to _ecm.
+      /// \param[in] _ecm Manager.
+      /// \param[in] _entity Entity owning the component.
+      /// \param[in] _slot Slot of the component type.
+      /// \return Component, or nullptr if the entity doesn't have it.
+      public: template <typename ComponentTypeT>
+              const ComponentTypeT *Component(
+                  const EntityComponentManager &_ecm, const Entity _entity,
+                  const std::size_t _slot)
+      {
+        if (&_ecm != this->ecm)
+          return _ecm.Component<ComponentTypeT>(_entity);
+
+        auto &slot = this->Slot(_slot);
+        if (!slot.resolved)
+        {
+          slot.component = _ecm.Component<ComponentTypeT>(_entity);
+          slot.resolved = true;
+        }
+        return static_cast<const ComponentTypeT *>(slot.component);
+      }
+
+      /// \brief Get a mutable component, through the cache if bound to
+      /// _ecm. Use different slots for mutable and const lookups of the same
+      /// type, since const lookups don't give mutable pointers.
+      /// \param[in] _ecm Manager.
+      /// \param[in] _entity Entity owning the component.
+      /// \param[in] _slot Slot of the component type.
+      /// \return Component, or nullptr if the entity doesn't have it.
+      public: template <typename ComponentTypeT>
+              ComponentTypeT *MutableComponent(EntityComponentManager &_ecm,
+                  const Entity _entity, const std::size_t _slot)
+      {
+        if (&_ecm != this->ecm)
+          return _ecm.Component<ComponentTypeT>(_entity);
+
+        auto &slot = this->Slot(_slot);
+        if (!slot.resolved)
+        {
+          slot.mutableComponent = _ecm.Component<ComponentTypeT>(_entity);
+          slot.component = slot.mutableComponent;
+          slot.resolved = true;
+        }
+        return static_cast<ComponentTypeT *>(slot.mutableComponent);
+      }
+
+      /// \brief A cached pointer.
+      private: struct CachedComponent
+      {
+        /// \brief Component, or nullptr if the entity doesn't have it.
+        const components::BaseComponent *component{nullptr};
+
+        /// \brief Component from a mutable lookup.
+        components::BaseComponent *mutableComponent{nullptr};
+
+        /// \brief Whether the component was looked up.
+        bool resolved{false};
+      };
+
+      /// \brief Get a slot, forgetting all cached pointers first if the
+      /// component layout changed.
+      /// \param[in] _slot Slot index.
+      /// \return The slot.
+      private: CachedComponent &Slot(const std::size_t _slot)
+      {
+        const uint64_t current = this->ecm->ComponentLayoutGeneration();
+        if (current != this->generation)
+        {
+          this->slots.fill(CachedComponent());
+          this->generation = current;
+        }
+        return this->slots[_slot];
+      }
+
+      /// \brief Manager the cache is bound to.
+      private: const EntityComponentManager *ecm{nullptr};
+
+      /// \brief Component layout generation of the cached pointers.
+      private: uint64_t generation{0};
+
+      /// \brief Cached pointers.
+      private: std::array<CachedComponent, N> slots;
+    };
+    }
+  }
+}
+#endif
@@ -19,14 +19,18 @@
 #include <ignition/msgs/int32.pb.h>
 
 #include <memory>
+#include <sstream>
+#include <string>
 
 #include <sdf/Element.hh>
 #include <ignition/common/Console.hh>
 #include <ignition/math/Inertial.hh>
 
+#include "ignition/gazebo/components/BinarySerializer.hh"
 #include "ignition/gazebo/components/Component.hh"
 #include "ignition/gazebo/components/Serialization.hh"
 #include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 
 using namespace ignition;
@@ -84,6 +88,158 @@ TEST_F(ComponentTest, DataByMove)
   EXPECT_EQ(2u, dataCopy.use_count());
 }
 
+//////////////////////////////////////////////////
+TEST_F(ComponentTest, MoveIntoEcm)
+{
+  auto factory = components::Factory::Instance();
+
+  using CustomComponent =
+      components::Component<std::shared_ptr<int>, class MovedComponentTag>;
+  factory->Register<CustomComponent>("ign_gazebo_components.MyMoved",
+     new components::ComponentDescriptor<CustomComponent>(),
+     new components::StorageDescriptor<CustomComponent>());
+
+  EntityComponentManager ecm;
+  Entity entity = ecm.CreateEntity();
+
+  auto data = std::make_shared<int>(1);
+  CustomComponent comp(data);
+  EXPECT_EQ(2u, data.use_count());
+
+  // The component is moved into the storage, not copied
+  ecm.CreateComponent(entity, std::move(comp));
+  EXPECT_EQ(2u, data.use_count());
+  ASSERT_NE(nullptr, ecm.Component<CustomComponent>(entity));
+  EXPECT_EQ(data, ecm.Component<CustomComponent>(entity)->Data());
+
+  // Setting data by move
+  auto newData = std::make_shared<int>(2);
+  auto newDataMoved = newData;
+  EXPECT_TRUE(ecm.SetComponentData<CustomComponent>(entity,
+      std::move(newDataMoved)));
+  EXPECT_EQ(nullptr, newDataMoved);
+  EXPECT_EQ(1u, data.use_count());
+  EXPECT_EQ(2u, newData.use_count());
+  EXPECT_EQ(newData, ecm.Component<CustomComponent>(entity)->Data());
+
+  // Lvalues are still copied
+  CustomComponent copied(data);
+  Entity other = ecm.CreateEntity();
+  ecm.CreateComponent(other, copied);
+  EXPECT_EQ(3u, data.use_count());
+}
+
+//////////////////////////////////////////////////
+TEST_F(ComponentTest, SharedPayload)
+{
+  using SharedString =
+      components::SharedPayloadComponent<std::string, class SharedStringTag>;
+
+  auto payload = std::make_shared<const std::string>("large payload");
+  SharedString comp(payload);
+
+  // Copies share the payload
+  SharedString copy(comp);
+  EXPECT_EQ(payload, copy.Data());
+  EXPECT_EQ(3u, payload.use_count());
+
+  std::ostringstream ostr;
+  comp.Serialize(ostr);
+  EXPECT_EQ("large payload", ostr.str());
+
+  // Deserializing creates a new payload, leaving the shared one untouched
+  std::istringstream istr("other");
+  copy.Deserialize(istr);
+  ASSERT_NE(nullptr, copy.Data());
+  EXPECT_EQ("other", *copy.Data());
+  EXPECT_EQ("large payload", *payload);
+  EXPECT_EQ(2u, payload.use_count());
+
+  // Null payloads aren't serialized
+  SharedString empty;
+  std::ostringstream emptyStr;
+  empty.Serialize(emptyStr);
+  EXPECT_TRUE(emptyStr.str().empty());
+}
+
+//////////////////////////////////////////////////
+TEST_F(ComponentTest, SerializeToBuffer)
+{
+  // Binary serializer
+  components::Pose pose(math::Pose3d(1, 2, 3, 0.1, 0.2, 0.3));
+  std::string buffer;
+  pose.SerializeToBuffer(buffer);
+  EXPECT_EQ(1u + 7u * sizeof(double), buffer.size());
+
+  components::Pose pose2;
+  pose2.DeserializeFromBuffer(buffer);
+  EXPECT_EQ(pose.Data(), pose2.Data());
+
+  // Streams still use text
+  std::ostringstream ostr;
+  pose.Serialize(ostr);
+  EXPECT_EQ("1 2 3 0.1 0.2 0.3", ostr.str());
+
+  // Text buffers, as in older logs, are still read
+  pose2.DeserializeFromBuffer("3 2 1 0 0 0");
+  EXPECT_EQ(math::Pose3d(3, 2, 1, 0, 0, 0), pose2.Data());
+
+  // Serializers without buffer support go through streams
+  using Custom = components::Component<int, class BufferCustomTag>;
+  Custom custom(123);
+  custom.SerializeToBuffer(buffer);
+  EXPECT_EQ("123", buffer);
+
+  Custom custom2;
+  custom2.DeserializeFromBuffer("456");
+  EXPECT_EQ(456, custom2.Data());
+}
+
+//////////////////////////////////////////////////
+TEST_F(ComponentTest, Clone)
+{
+  components::Pose pose(math::Pose3d(1, 2, 3, 0, 0, 0));
+  auto copy = pose.Clone();
+  ASSERT_NE(nullptr, copy);
+  EXPECT_EQ(components::Pose::typeId, copy->TypeId());
+
+  auto poseCopy = static_cast<components::Pose *>(copy.get());
+  EXPECT_EQ(pose.Data(), poseCopy->Data());
+
+  // The copy doesn't share data
+  poseCopy->Data().Pos().X(10);
+  EXPECT_DOUBLE_EQ(1.0, pose.Data().Pos().X());
+
+  using Tag = components::Component<components::NoData, class CloneTag>;
+  Tag tag;
+  EXPECT_NE(nullptr, tag.Clone());
+}
+
+//////////////////////////////////////////////////
+TEST_F(ComponentTest, QuantizedPose)
+{
+  std::string buffer;
+  serializers::QuantizedPoseLayout::Write(
+      math::Pose3d(1.23456, -2, 3, IGN_PI_2, 0, 0), 1e-3, buffer);
+  EXPECT_EQ(serializers::QuantizedPoseLayout::kSize, buffer.size());
+
+  // Pose components read either layout
+  components::Pose pose;
+  pose.DeserializeFromBuffer(buffer);
+  EXPECT_NEAR(1.235, pose.Data().Pos().X(), 1e-6);
+  EXPECT_NEAR(-2.0, pose.Data().Pos().Y(), 1e-6);
+  EXPECT_NEAR(3.0, pose.Data().Pos().Z(), 1e-6);
+  EXPECT_NEAR(IGN_PI_2, pose.Data().Rot().Roll(), 1e-4);
+
+  // The rotation is normalized
+  const auto &rot = pose.Data().Rot();
+  EXPECT_NEAR(1.0, rot.W() * rot.W() + rot.X() * rot.X() + rot.Y() * rot.Y() +
+      rot.Z() * rot.Z(), 1e-9);
+
+  math::Pose3d other;
+  EXPECT_FALSE(serializers::QuantizedPoseLayout::Read("1 2 3 0 0 0", other));
+}
+
 // Class with externally defined stream operator
 struct SimpleOperator
 {
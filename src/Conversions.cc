@@ -136,7 +136,7 @@ msgs::Collision ignition::gazebo::convert(const sdf::Collision &_in)
   msgs::Collision out;
   out.set_name(_in.Name());
   msgs::Set(out.mutable_pose(), _in.RawPose());
-  out.mutable_geometry()->CopyFrom(convert<msgs::Geometry>(*_in.Geom()));
+  set(out.mutable_geometry(), *_in.Geom());
 
   return out;
 }
@@ -159,32 +159,68 @@ IGNITION_GAZEBO_VISIBLE
 msgs::Geometry ignition::gazebo::convert(const sdf::Geometry &_in)
 {
   msgs::Geometry out;
+  set(&out, _in);
+  return out;
+}
+
+//////////////////////////////////////////////////
+void ignition::gazebo::set(msgs::Geometry *_msg, const sdf::Geometry &_in)
+{
+  auto &out = *_msg;
+
+  // Drop the shape of a previous conversion if it was of another type, the
+  // submessage of the current type is reused.
+  const auto clearShapesExcept = [&](msgs::Geometry::Type _type)
+  {
+    if (_type != msgs::Geometry::BOX && out.has_box())
+      out.clear_box();
+    if (_type != msgs::Geometry::CAPSULE && out.has_capsule())
+      out.clear_capsule();
+    if (_type != msgs::Geometry::CYLINDER && out.has_cylinder())
+      out.clear_cylinder();
+    if (_type != msgs::Geometry::ELLIPSOID && out.has_ellipsoid())
+      out.clear_ellipsoid();
+    if (_type != msgs::Geometry::PLANE && out.has_plane())
+      out.clear_plane();
+    if (_type != msgs::Geometry::SPHERE && out.has_sphere())
+      out.clear_sphere();
+    if (_type != msgs::Geometry::MESH && out.has_mesh())
+      out.clear_mesh();
+    if (_type != msgs::Geometry::HEIGHTMAP && out.has_heightmap())
+      out.clear_heightmap();
+  };
+
   if (_in.Type() == sdf::GeometryType::BOX && _in.BoxShape())
   {
     out.set_type(msgs::Geometry::BOX);
+    clearShapesExcept(msgs::Geometry::BOX);
     msgs::Set(out.mutable_box()->mutable_size(), _in.BoxShape()->Size());
   }
   else if (_in.Type() == sdf::GeometryType::CAPSULE && _in.CapsuleShape())
   {
     out.set_type(msgs::Geometry::CAPSULE);
+    clearShapesExcept(msgs::Geometry::CAPSULE);
     out.mutable_capsule()->set_radius(_in.CapsuleShape()->Radius());
     out.mutable_capsule()->set_length(_in.CapsuleShape()->Length());
   }
   else if (_in.Type() == sdf::GeometryType::CYLINDER && _in.CylinderShape())
   {
     out.set_type(msgs::Geometry::CYLINDER);
+    clearShapesExcept(msgs::Geometry::CYLINDER);
     out.mutable_cylinder()->set_radius(_in.CylinderShape()->Radius());
     out.mutable_cylinder()->set_length(_in.CylinderShape()->Length());
   }
   else if (_in.Type() == sdf::GeometryType::ELLIPSOID && _in.EllipsoidShape())
   {
     out.set_type(msgs::Geometry::ELLIPSOID);
+    clearShapesExcept(msgs::Geometry::ELLIPSOID);
     msgs::Set(out.mutable_ellipsoid()->mutable_radii(),
              _in.EllipsoidShape()->Radii());
   }
   else if (_in.Type() == sdf::GeometryType::PLANE && _in.PlaneShape())
   {
     out.set_type(msgs::Geometry::PLANE);
+    clearShapesExcept(msgs::Geometry::PLANE);
     msgs::Set(out.mutable_plane()->mutable_normal(),
               _in.PlaneShape()->Normal());
     msgs::Set(out.mutable_plane()->mutable_size(),
@@ -193,6 +229,7 @@ msgs::Geometry ignition::gazebo::convert(const sdf::Geometry &_in)
   else if (_in.Type() == sdf::GeometryType::SPHERE && _in.SphereShape())
   {
     out.set_type(msgs::Geometry::SPHERE);
+    clearShapesExcept(msgs::Geometry::SPHERE);
     out.mutable_sphere()->set_radius(_in.SphereShape()->Radius());
   }
   else if (_in.Type() == sdf::GeometryType::MESH && _in.MeshShape())
@@ -200,6 +237,7 @@ msgs::Geometry ignition::gazebo::convert(const sdf::Geometry &_in)
     auto meshSdf = _in.MeshShape();
 
     out.set_type(msgs::Geometry::MESH);
+    clearShapesExcept(msgs::Geometry::MESH);
     auto meshMsg = out.mutable_mesh();
 
     msgs::Set(meshMsg->mutable_scale(), meshSdf->Scale());
@@ -212,6 +250,7 @@ msgs::Geometry ignition::gazebo::convert(const sdf::Geometry &_in)
     auto heightmapSdf = _in.HeightmapShape();
 
     out.set_type(msgs::Geometry::HEIGHTMAP);
+    clearShapesExcept(msgs::Geometry::HEIGHTMAP);
     auto heightmapMsg = out.mutable_heightmap();
 
     heightmapMsg->set_filename(asFullPath(heightmapSdf->Uri(),
@@ -221,10 +260,14 @@ msgs::Geometry ignition::gazebo::convert(const sdf::Geometry &_in)
     heightmapMsg->set_use_terrain_paging(heightmapSdf->UseTerrainPaging());
     heightmapMsg->set_sampling(heightmapSdf->Sampling());
 
-    for (auto i = 0u; i < heightmapSdf->TextureCount(); ++i)
+    const int textureCount = static_cast<int>(heightmapSdf->TextureCount());
+    while (heightmapMsg->texture_size() > textureCount)
+      heightmapMsg->mutable_texture()->RemoveLast();
+    for (auto i = 0; i < textureCount; ++i)
     {
       auto textureSdf = heightmapSdf->TextureByIndex(i);
-      auto textureMsg = heightmapMsg->add_texture();
+      auto textureMsg = i < heightmapMsg->texture_size() ?
+          heightmapMsg->mutable_texture(i) : heightmapMsg->add_texture();
       textureMsg->set_size(textureSdf->Size());
       textureMsg->set_diffuse(asFullPath(textureSdf->Diffuse(),
           heightmapSdf->FilePath()));
@@ -232,10 +275,14 @@ msgs::Geometry ignition::gazebo::convert(const sdf::Geometry &_in)
           heightmapSdf->FilePath()));
     }
 
-    for (auto i = 0u; i < heightmapSdf->BlendCount(); ++i)
+    const int blendCount = static_cast<int>(heightmapSdf->BlendCount());
+    while (heightmapMsg->blend_size() > blendCount)
+      heightmapMsg->mutable_blend()->RemoveLast();
+    for (auto i = 0; i < blendCount; ++i)
     {
       auto blendSdf = heightmapSdf->BlendByIndex(i);
-      auto blendMsg = heightmapMsg->add_blend();
+      auto blendMsg = i < heightmapMsg->blend_size() ?
+          heightmapMsg->mutable_blend(i) : heightmapMsg->add_blend();
       blendMsg->set_min_height(blendSdf->MinHeight());
       blendMsg->set_fade_dist(blendSdf->FadeDistance());
     }
@@ -245,7 +292,6 @@ msgs::Geometry ignition::gazebo::convert(const sdf::Geometry &_in)
     ignerr << "Geometry type [" << static_cast<int>(_in.Type())
            << "] not supported" << std::endl;
   }
-  return out;
 }
 
 //////////////////////////////////////////////////
@@ -369,6 +415,14 @@ IGNITION_GAZEBO_VISIBLE
 msgs::Material ignition::gazebo::convert(const sdf::Material &_in)
 {
   msgs::Material out;
+  set(&out, _in);
+  return out;
+}
+
+//////////////////////////////////////////////////
+void ignition::gazebo::set(msgs::Material *_msg, const sdf::Material &_in)
+{
+  auto &out = *_msg;
   msgs::Set(out.mutable_ambient(), _in.Ambient());
   msgs::Set(out.mutable_diffuse(), _in.Diffuse());
   msgs::Set(out.mutable_specular(), _in.Specular());
@@ -419,7 +473,10 @@ msgs::Material ignition::gazebo::convert(const sdf::Material &_in)
       pbrMsg->set_light_map_texcoord_set(workflow->LightMapTexCoordSet());
     }
   }
-  return out;
+  else if (out.has_pbr())
+  {
+    out.clear_pbr();
+  }
 }
 
 //////////////////////////////////////////////////
@@ -554,6 +611,14 @@ IGNITION_GAZEBO_VISIBLE
 msgs::Light ignition::gazebo::convert(const sdf::Light &_in)
 {
   msgs::Light out;
+  set(&out, _in);
+  return out;
+}
+
+//////////////////////////////////////////////////
+void ignition::gazebo::set(msgs::Light *_msg, const sdf::Light &_in)
+{
+  auto &out = *_msg;
   out.set_name(_in.Name());
   msgs::Set(out.mutable_pose(), _in.RawPose());
   msgs::Set(out.mutable_diffuse(), _in.Diffuse());
@@ -574,7 +639,6 @@ msgs::Light ignition::gazebo::convert(const sdf::Light &_in)
     out.set_type(msgs::Light_LightType_SPOT);
   else if (_in.Type() == sdf::LightType::DIRECTIONAL)
     out.set_type(msgs::Light_LightType_DIRECTIONAL);
-  return out;
 }
 
 //////////////////////////////////////////////////
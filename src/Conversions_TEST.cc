@@ -941,3 +941,75 @@ TEST(Conversions, Actor)
   EXPECT_EQ(math::Pose3d(6, 5, 4, 0, 0, 0),
       newActor.TrajectoryByIndex(0)->WaypointByIndex(0)->Pose());
 }
+
+/////////////////////////////////////////////////
+TEST(Conversions, SetGeometryInPlace)
+{
+  sdf::Geometry box;
+  box.SetType(sdf::GeometryType::BOX);
+  sdf::Box boxShape;
+  boxShape.SetSize(math::Vector3d(1, 2, 3));
+  box.SetBoxShape(boxShape);
+
+  sdf::Geometry sphere;
+  sphere.SetType(sdf::GeometryType::SPHERE);
+  sdf::Sphere sphereShape;
+  sphereShape.SetRadius(1.5);
+  sphere.SetSphereShape(sphereShape);
+
+  // Refilling a message gives the same result as converting anew, also when
+  // the geometry type changes
+  msgs::Geometry msg;
+  set(&msg, box);
+  EXPECT_EQ(convert<msgs::Geometry>(box).SerializeAsString(),
+      msg.SerializeAsString());
+
+  set(&msg, sphere);
+  EXPECT_FALSE(msg.has_box());
+  EXPECT_EQ(convert<msgs::Geometry>(sphere).SerializeAsString(),
+      msg.SerializeAsString());
+
+  set(&msg, box);
+  EXPECT_FALSE(msg.has_sphere());
+  EXPECT_EQ(convert<msgs::Geometry>(box).SerializeAsString(),
+      msg.SerializeAsString());
+}
+
+/////////////////////////////////////////////////
+TEST(Conversions, SetMaterialAndLightInPlace)
+{
+  sdf::Material material;
+  material.SetAmbient(math::Color(0.1f, 0.2f, 0.3f, 0.4f));
+  material.SetRenderOrder(2.5f);
+  sdf::Pbr pbr;
+  sdf::PbrWorkflow workflow;
+  workflow.SetType(sdf::PbrWorkflowType::METAL);
+  workflow.SetMetalness(0.5);
+  pbr.SetWorkflow(workflow.Type(), workflow);
+  material.SetPbrMaterial(pbr);
+
+  msgs::Material materialMsg;
+  set(&materialMsg, material);
+  EXPECT_TRUE(materialMsg.has_pbr());
+  EXPECT_EQ(convert<msgs::Material>(material).SerializeAsString(),
+      materialMsg.SerializeAsString());
+
+  // A material without PBR drops the previous PBR fields
+  sdf::Material plain;
+  plain.SetDiffuse(math::Color(0.5f, 0.6f, 0.7f, 0.8f));
+  set(&materialMsg, plain);
+  EXPECT_FALSE(materialMsg.has_pbr());
+  EXPECT_EQ(convert<msgs::Material>(plain).SerializeAsString(),
+      materialMsg.SerializeAsString());
+
+  sdf::Light light;
+  light.SetName("test_light");
+  light.SetType(sdf::LightType::SPOT);
+  light.SetRawPose(math::Pose3d(1, 2, 3, 0, 0, 0));
+  light.SetIntensity(2.0);
+
+  msgs::Light lightMsg;
+  set(&lightMsg, light);
+  EXPECT_EQ(convert<msgs::Light>(light).SerializeAsString(),
+      lightMsg.SerializeAsString());
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "DurationHistogram.hh"
+
+using namespace ignition::gazebo;
+
+//////////////////////////////////////////////////
+void DurationHistogram::Add(
+    const std::chrono::steady_clock::duration &_duration)
+{
+  const uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(0,
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+      _duration).count()));
+  ++this->bins[Bin(ns)];
+  ++this->count;
+  this->totalNs += ns;
+  this->maxNs = std::max(this->maxNs, ns);
+}
+
+//////////////////////////////////////////////////
+uint64_t DurationHistogram::Count() const
+{
+  return this->count;
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration DurationHistogram::Percentile(
+    double _fraction) const
+{
+  if (this->count == 0)
+    return std::chrono::steady_clock::duration::zero();
+
+  const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(
+      std::ceil(std::clamp(_fraction, 0.0, 1.0) * this->count)));
+  uint64_t seen{0};
+  for (std::size_t bin = 0; bin < kBinCount; ++bin)
+  {
+    seen += this->bins[bin];
+    if (seen >= rank)
+    {
+      return std::chrono::nanoseconds(
+          std::min(UpperBound(bin), this->maxNs));
+    }
+  }
+  return this->Max();
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration DurationHistogram::Max() const
+{
+  return std::chrono::nanoseconds(this->maxNs);
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration DurationHistogram::Mean() const
+{
+  if (this->count == 0)
+    return std::chrono::steady_clock::duration::zero();
+  return std::chrono::nanoseconds(this->totalNs / this->count);
+}
+
+//////////////////////////////////////////////////
+void DurationHistogram::Reset()
+{
+  this->bins.fill(0);
+  this->count = 0;
+  this->totalNs = 0;
+  this->maxNs = 0;
+}
+
+//////////////////////////////////////////////////
+std::size_t DurationHistogram::Bin(uint64_t _ns)
+{
+  // Durations below 4 ns get a bin each
+  if (_ns < 4)
+    return static_cast<std::size_t>(_ns);
+
+  // Otherwise the bin is given by the highest bit and the two bits after it
+  unsigned int highBit{2};
+  while ((_ns >> (highBit + 1)) != 0)
+    ++highBit;
+  const uint64_t sub = (_ns >> (highBit - 2)) & 3;
+  return static_cast<std::size_t>(4 + (highBit - 2) * 4 + sub);
+}
+
+//////////////////////////////////////////////////
+uint64_t DurationHistogram::UpperBound(std::size_t _bin)
+{
+  if (_bin < 4)
+    return _bin;
+
+  const unsigned int shift = static_cast<unsigned int>((_bin - 4) / 4);
+  const uint64_t sub = (_bin - 4) % 4;
+  const uint64_t lower = (4 + sub) << shift;
+  return lower + ((uint64_t{1} << shift) - 1);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GAZEBO_DURATIONHISTOGRAM_HH_
+#define IGNITION_GAZEBO_DURATIONHISTOGRAM_HH_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class DurationHistogram DurationHistogram.hh
+    /// \brief A histogram of durations with a fixed size, cheap enough to
+    /// record every call of a function.
+    ///
+    /// Each power of two of nanoseconds is split into 4 bins, so
+    /// percentiles are within 25% of the recorded durations, from
+    /// nanoseconds to centuries.
+    class IGNITION_GAZEBO_VISIBLE DurationHistogram
+    {
+      /// \brief Record a duration.
+      /// \param[in] _duration Duration, negative durations count as zero.
+      public: void Add(const std::chrono::steady_clock::duration &_duration);
+
+      /// \brief Get the number of recorded durations.
+      /// \return Number of durations.
+      public: uint64_t Count() const;
+
+      /// \brief Get a percentile of the recorded durations.
+      /// \param[in] _fraction Fraction of durations which are shorter or
+      /// equal to the result, for example 0.99 for the 99th percentile.
+      /// \return Upper bound of the bin holding the percentile, at most the
+      /// longest duration. Zero if nothing was recorded.
+      public: std::chrono::steady_clock::duration Percentile(
+                  double _fraction) const;
+
+      /// \brief Get the longest recorded duration.
+      /// \return Longest duration, zero if nothing was recorded.
+      public: std::chrono::steady_clock::duration Max() const;
+
+      /// \brief Get the mean of the recorded durations.
+      /// \return Mean duration, zero if nothing was recorded.
+      public: std::chrono::steady_clock::duration Mean() const;
+
+      /// \brief Forget all recorded durations.
+      public: void Reset();
+
+      /// \brief Number of bins.
+      private: static constexpr std::size_t kBinCount{252};
+
+      /// \brief Get the bin of a duration.
+      /// \param[in] _ns Duration in nanoseconds.
+      /// \return Bin index.
+      private: static std::size_t Bin(uint64_t _ns);
+
+      /// \brief Get the longest duration of a bin.
+      /// \param[in] _bin Bin index.
+      /// \return Duration in nanoseconds.
+      private: static uint64_t UpperBound(std::size_t _bin);
+
+      /// \brief Number of durations in each bin.
+      private: std::array<uint64_t, kBinCount> bins{};
+
+      /// \brief Number of durations.
+      private: uint64_t count{0};
+
+      /// \brief Sum of the durations in nanoseconds.
+      private: uint64_t totalNs{0};
+
+      /// \brief Longest duration in nanoseconds.
+      private: uint64_t maxNs{0};
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_DURATIONHISTOGRAM_HH_
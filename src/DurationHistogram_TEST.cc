@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "DurationHistogram.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+//////////////////////////////////////////////////
+TEST(DurationHistogram, Empty)
+{
+  DurationHistogram histogram;
+  EXPECT_EQ(0u, histogram.Count());
+  EXPECT_EQ(0ns, histogram.Percentile(0.5));
+  EXPECT_EQ(0ns, histogram.Max());
+  EXPECT_EQ(0ns, histogram.Mean());
+}
+
+//////////////////////////////////////////////////
+TEST(DurationHistogram, Percentiles)
+{
+  DurationHistogram histogram;
+  for (int i = 1; i <= 100; ++i)
+    histogram.Add(std::chrono::microseconds(i));
+  histogram.Add(-1ms);
+
+  EXPECT_EQ(101u, histogram.Count());
+  EXPECT_EQ(100us, histogram.Max());
+  EXPECT_EQ(std::chrono::nanoseconds(5050000 / 101), histogram.Mean());
+
+  // Percentiles are within a bin of the exact value
+  auto p50 = histogram.Percentile(0.5);
+  EXPECT_GE(p50, 50us);
+  EXPECT_LE(p50, 63us);
+  auto p99 = histogram.Percentile(0.99);
+  EXPECT_GE(p99, 99us);
+  EXPECT_LE(p99, 100us);
+  EXPECT_EQ(0ns, histogram.Percentile(0.0));
+  EXPECT_EQ(100us, histogram.Percentile(1.0));
+
+  histogram.Reset();
+  EXPECT_EQ(0u, histogram.Count());
+  EXPECT_EQ(0ns, histogram.Max());
+}
+
+//////////////////////////////////////////////////
+TEST(DurationHistogram, Extremes)
+{
+  DurationHistogram histogram;
+  histogram.Add(3ns);
+  EXPECT_EQ(3ns, histogram.Percentile(1.0));
+
+  histogram.Add(std::chrono::hours(24 * 365 * 100));
+  EXPECT_EQ(std::chrono::hours(24 * 365 * 100), histogram.Max());
+  EXPECT_EQ(3ns, histogram.Percentile(0.5));
+}
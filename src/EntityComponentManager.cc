@@ -15,45 +15,326 @@
  *
 */
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <ignition/common/Profiler.hh>
-#include <ignition/math/graph/GraphAlgorithms.hh>
+#include "ignition/gazebo/components/AngularVelocity.hh"
+#include "ignition/gazebo/components/AxisAlignedBox.hh"
+#include "ignition/gazebo/components/CanonicalLink.hh"
 #include "ignition/gazebo/components/Component.hh"
+#include "ignition/gazebo/components/DetachableJoint.hh"
 #include "ignition/gazebo/components/Factory.hh"
+#include "ignition/gazebo/components/Inertial.hh"
+#include "ignition/gazebo/components/LinearVelocity.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/PerformerLevels.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/Static.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SpatialIndex.hh"
+
+#include "EntityHierarchy.hh"
+#include "StepArena.hh"
+#include "TaskPool.hh"
 
 using namespace ignition;
 using namespace gazebo;
 
+namespace
+{
+//////////////////////////////////////////////////
+/// \brief Get the task pool shared by all entity component managers. It's
+/// created the first time it's needed.
+/// \return The shared task pool.
+TaskPool &SharedTaskPool()
+{
+  static TaskPool pool;
+  return pool;
+}
+
+//////////////////////////////////////////////////
+/// \brief Combine the hash of a value with a running hash.
+/// \param[in] _seed Running hash.
+/// \param[in] _hash Hash of the value to combine.
+/// \return Combined hash.
+std::size_t CombineHash(std::size_t _seed, std::size_t _hash)
+{
+  return _seed ^ (_hash + 0x9e3779b9 + (_seed << 6) + (_seed >> 2));
+}
+
+/// \brief Set of component types as a bitmask, one bit per type, see
+/// EntityComponentManagerPrivate::Signature.
+using ComponentSignature = std::vector<uint64_t>;
+
+//////////////////////////////////////////////////
+/// \brief Add a type to a signature.
+/// \param[in, out] _signature Signature to modify.
+/// \param[in] _bit Bit of the type.
+void SetSignatureBit(ComponentSignature &_signature, const std::size_t _bit)
+{
+  if (_signature.size() <= _bit / 64)
+    _signature.resize(_bit / 64 + 1, 0u);
+  _signature[_bit / 64] |= uint64_t{1} << (_bit % 64);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check if a signature has a type.
+/// \param[in] _signature Signature to check.
+/// \param[in] _bit Bit of the type.
+/// \return True if the type is in the signature.
+bool HasSignatureBit(const ComponentSignature &_signature,
+    const std::size_t _bit)
+{
+  return _bit / 64 < _signature.size() &&
+      (_signature[_bit / 64] & (uint64_t{1} << (_bit % 64))) != 0u;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check if a signature has all the types of another one.
+/// \param[in] _super Signature which should have all the types.
+/// \param[in] _sub Signature whose types are checked.
+/// \return True if every type of _sub is in _super.
+bool SignatureIncludes(const ComponentSignature &_super,
+    const ComponentSignature &_sub)
+{
+  for (std::size_t i = 0; i < _sub.size(); ++i)
+  {
+    const uint64_t word = i < _super.size() ? _super[i] : 0u;
+    if ((word & _sub[i]) != _sub[i])
+      return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check if two signatures have any type in common.
+/// \param[in] _a First signature.
+/// \param[in] _b Second signature.
+/// \return True if at least one type is in both.
+bool SignaturesIntersect(const ComponentSignature &_a,
+    const ComponentSignature &_b)
+{
+  const std::size_t size = std::min(_a.size(), _b.size());
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    if ((_a[i] & _b[i]) != 0u)
+      return true;
+  }
+  return false;
+}
+
+/// \brief Entities which have exactly the same set of component types.
+struct Archetype
+{
+  /// \brief Entities of the archetype.
+  std::unordered_set<Entity> entities;
+
+  /// \brief Signature of the archetype's component types, so sets of types
+  /// are matched against it with bitwise operations.
+  ComponentSignature signature;
+};
+
+/// \brief Archetypes keyed by their component types.
+using ArchetypeMap = std::map<detail::ComponentTypeKey, Archetype>;
+
+/// \brief Entities indexed by the data of some of their components.
+struct ComponentIndex
+{
+  /// \brief Indexed component types, sorted.
+  std::vector<ComponentTypeId> types;
+
+  /// \brief Function hashing the data of each type, in the order of types.
+  std::vector<std::function<std::size_t(const components::BaseComponent &)>>
+      hashers;
+
+  /// \brief Indexed entities, keyed by the combined hash of their
+  /// components.
+  std::unordered_multimap<std::size_t, Entity> entities;
+
+  /// \brief Hash each indexed entity is currently stored under.
+  std::unordered_map<Entity, std::size_t> hashes;
+};
+
+/// \brief Entities sorted by a numeric field of one of their components.
+struct RangeIndex
+{
+  /// \brief Indexed component type.
+  ComponentTypeId type{0};
+
+  /// \brief Name of the indexed field.
+  std::string field;
+
+  /// \brief Function returning the field of a component.
+  std::function<double(const components::BaseComponent &)> key;
+
+  /// \brief Indexed entities, keyed by their field.
+  std::multimap<double, Entity> entities;
+
+  /// \brief Field each indexed entity is currently stored under.
+  std::unordered_map<Entity, double> keys;
+};
+
+/// \brief World pose of an entity cached by the world pose pass.
+struct WorldPoseEntry
+{
+  /// \brief Pose relative to the parent used to compute the world pose.
+  math::Pose3d local;
+
+  /// \brief Pose in the world frame.
+  math::Pose3d world;
+
+  /// \brief Parent used to compute the world pose, or kNullEntity if the
+  /// entity has no parent with a pose.
+  Entity parent{kNullEntity};
+
+  /// \brief Last pass which visited the entity.
+  uint64_t visitedPass{0};
+
+  /// \brief Last pass which changed the world pose, 0 if it was never
+  /// computed.
+  uint64_t movedPass{0};
+};
+
+//////////////////////////////////////////////////
+/// \brief Check whether two poses are exactly the same. Unlike
+/// math::Pose3d::operator==, there's no tolerance, so that slow motions
+/// aren't missed.
+/// \param[in] _a First pose.
+/// \param[in] _b Second pose.
+/// \return True if all coordinates are equal.
+bool IdenticalPoses(const math::Pose3d &_a, const math::Pose3d &_b)
+{
+  return _a.Pos().X() == _b.Pos().X() && _a.Pos().Y() == _b.Pos().Y() &&
+      _a.Pos().Z() == _b.Pos().Z() && _a.Rot().W() == _b.Rot().W() &&
+      _a.Rot().X() == _b.Rot().X() && _a.Rot().Y() == _b.Rot().Y() &&
+      _a.Rot().Z() == _b.Rot().Z();
+}
+}
+
 class ignition::gazebo::EntityComponentManagerPrivate
 {
+  /// \brief Get the id of the next entity to create, reusing the slot of a
+  /// removed entity if entity recycling is enabled.
+  /// \return Entity id, or kNullEntity if there are no ids left.
+  public: Entity NextEntity();
+
+  /// \brief Lock a mutex protecting data which is only read while the
+  /// manager is read-only.
+  /// \param[in] _mutex Mutex to lock.
+  /// \return Lock, which doesn't own the mutex if the manager is read-only.
+  public: std::unique_lock<std::mutex> ReadLock(std::mutex &_mutex) const
+  {
+    if (this->readOnly)
+      return std::unique_lock<std::mutex>(_mutex, std::defer_lock);
+    return std::unique_lock<std::mutex>(_mutex);
+  }
+
+  /// \brief Make the slot of a removed entity available to new entities, if
+  /// entity recycling is enabled.
+  /// \param[in] _entity Removed entity.
+  public: void RecycleEntity(const Entity _entity);
+
   /// \brief Implementation of the CreateEntity function, which takes a specific
   /// entity as input.
   /// \param[in] _entity Entity to be created.
   /// \return Created entity, which should match the input.
   public: Entity CreateEntityImplementation(Entity _entity);
 
-  /// \brief Recursively insert an entity and all its descendants into a given
-  /// set.
-  /// \param[in] _entity Entity to be inserted.
-  /// \param[in, out] _set Set to be filled.
-  public: void InsertEntityRecursive(Entity _entity,
-      std::unordered_set<Entity> &_set);
-
   /// \brief Register a new component type.
   /// \param[in] _typeId Type if of the new component.
   /// \return True if created successfully.
   public: bool CreateComponentStorage(const ComponentTypeId _typeId);
 
-  /// \brief Allots the work for multiple threads prior to running
-  /// `AddEntityToMessage`.
+  /// \brief Rebuild `stateEntities` if the entities with components
+  /// changed since it was last built.
   public: void CalculateStateThreadLoad();
 
+  /// \brief Move an entity to the archetype that matches its current set of
+  /// component types. This must be called whenever a component is added to
+  /// or removed from the entity.
+  /// \param[in] _entity Entity whose archetype should be updated.
+  public: void UpdateArchetype(const Entity _entity);
+
+  /// \brief Get the archetype of a set of component types, it's created if
+  /// needed.
+  /// \param[in] _types Component types of the archetype.
+  /// \return Iterator to the archetype.
+  public: ArchetypeMap::iterator FindArchetype(
+              detail::ComponentTypeKey &&_types);
+
+  /// \brief Check if an entity has all the given component types, using
+  /// the signature of its archetype.
+  /// \param[in] _entity Entity to check.
+  /// \param[in] _types Component types.
+  /// \param[out] _match True if the entity has all the types.
+  /// \return False if the entity has no archetype, for example because it
+  /// isn't in the graph, true if _match was set.
+  public: bool ArchetypeMatches(const Entity _entity,
+              const std::set<ComponentTypeId> &_types, bool &_match) const;
+
+  /// \brief Remove an entity from the archetype it currently belongs to.
+  /// Empty archetypes are discarded.
+  /// \param[in] _entity Entity to be removed.
+  public: void RemoveFromArchetype(const Entity _entity);
+
+  /// \brief Look up again the pointers held by views to components of a
+  /// given type. Views cache component pointers, which become stale when a
+  /// removal moves components within their storage.
+  /// \param[in] _typeId Type of the components that were moved.
+  /// \param[in] _ecm Entity component manager that owns the components.
+  public: void RefreshViews(const ComponentTypeId _typeId,
+              const EntityComponentManager *_ecm);
+
+  /// \brief Look up again the pointers held by views to the components of
+  /// a given type of some entities, whose components were moved.
+  /// \param[in] _typeId Type of the components that were moved.
+  /// \param[in] _entities Entities which own the moved components.
+  /// \param[in] _ecm Entity component manager that owns the components.
+  public: void RefreshViews(const ComponentTypeId _typeId,
+              const std::vector<Entity> &_entities,
+              const EntityComponentManager *_ecm);
+
+  /// \brief Store an entity in a component index under the current hash of
+  /// its components. The entity is left out of the index if it's missing
+  /// any of the indexed types.
+  /// \param[in] _index Index to update.
+  /// \param[in] _entity Entity to index.
+  public: void IndexEntity(ComponentIndex &_index, const Entity _entity);
+
+  /// \brief Remove an entity from a component index.
+  /// \param[in] _index Index to update.
+  /// \param[in] _entity Entity to remove.
+  public: static void UnindexEntity(ComponentIndex &_index,
+              const Entity _entity);
+
+  /// \brief Store an entity in a range index under the current field of
+  /// its component. The entity is left out of the index if it doesn't have
+  /// the component or the field is NaN.
+  /// \param[in] _index Index to update.
+  /// \param[in] _entity Entity to index.
+  public: void IndexEntity(RangeIndex &_index, const Entity _entity);
+
+  /// \brief Remove an entity from a range index.
+  /// \param[in] _index Index to update.
+  /// \param[in] _entity Entity to remove.
+  public: static void UnindexEntity(RangeIndex &_index,
+              const Entity _entity);
+
   /// \brief Create a message for the removed components
   /// \param[in] _entity Entity with the removed components
   /// \param[in, out] _msg Entity message
@@ -72,20 +353,52 @@ class ignition::gazebo::EntityComponentManagerPrivate
       msgs::SerializedStateMap &_msg,
       const std::unordered_set<ComponentTypeId> &_types = {});
 
+  /// \brief Get the storage of a component type in order to modify it. A
+  /// storage shared with forked managers, see EntityComponentManager::Fork,
+  /// is copied first, and views are pointed to the copy.
+  /// \param[in] _typeId Type of the components, whose storage must exist.
+  /// \param[in] _ecm Entity component manager that owns the components.
+  /// \return The storage, which only belongs to this manager.
+  public: ComponentStorageBase &MutableStorage(const ComponentTypeId _typeId,
+              const EntityComponentManager *_ecm);
+
   /// \brief Map of component storage classes. The key is a component
-  /// type id, and the value is a pointer to the component storage.
+  /// type id, and the value is a pointer to the component storage. Storages
+  /// are shared by forked managers until one of them modifies them, see
+  /// MutableStorage.
   public: std::unordered_map<ComponentTypeId,
-          std::unique_ptr<ComponentStorageBase>> components;
+          std::shared_ptr<ComponentStorageBase>> components;
+
+  /// \brief Types whose storage has tombstones left by entity removals, see
+  /// EntityComponentManager::CompactComponentStorage.
+  public: std::set<ComponentTypeId> pendingCompactions;
+
+  /// \brief Shared component types which couldn't be copied, so that the
+  /// error is only printed once.
+  public: std::unordered_set<ComponentTypeId> uncopyableTypes;
 
   /// \brief A graph holding all entities, arranged according to their
   /// parenting.
   public: EntityGraph entities;
 
-  /// \brief Components that have been changed through a peridic change.
-  public: std::set<ComponentKey> periodicChangedComponents;
+  /// \brief The same parenting as the entity graph, in flat arrays which are
+  /// faster to traverse.
+  public: EntityHierarchy hierarchy;
 
-  /// \brief Components that have been changed through a one-time change.
-  public: std::set<ComponentKey> oneTimeChangedComponents;
+  /// \brief Current change generation, incremented every time all
+  /// components are marked as unchanged. Component storages record the
+  /// generation during which each of their components last changed, while
+  /// their change bitsets only hold the changes of the current generation.
+  public: uint64_t changeGeneration{1};
+
+  /// \brief Incremented whenever components are created or removed, or
+  /// storages are replaced, see
+  /// EntityComponentManager::ComponentLayoutGeneration.
+  public: std::atomic<uint64_t> layoutGeneration{1};
+
+  /// \brief Sequence number of the last change logged by a component
+  /// storage, see EntityComponentManager::EachChanged.
+  public: uint64_t changeSequence{0};
 
   /// \brief Entities that have just been created
   public: std::unordered_set<Entity> newlyCreatedEntities;
@@ -96,9 +409,8 @@ class ignition::gazebo::EntityComponentManagerPrivate
   /// \brief Flag that indicates if all entities should be removed.
   public: bool removeAllEntities{false};
 
-  /// \brief True if the entityComponents map was changed.  Primarily used
-  /// by the multithreading functionality in `State()` to allocate work to
-  /// each thread.
+  /// \brief True if the entityComponents map was changed. Used by
+  /// `State()` to know when `stateEntities` must be rebuilt.
   public: bool entityComponentsDirty{true};
 
   /// \brief The set of components that each entity has.
@@ -107,14 +419,22 @@ class ignition::gazebo::EntityComponentManagerPrivate
   public: std::unordered_map<Entity,
           std::unordered_map<ComponentTypeId, ComponentKey>> entityComponents;
 
-  /// \brief A vector of iterators to evenly distributed spots in the
-  /// `entityComponents` map.  Threads in the `State` function use this
-  /// vector for easy access of their pre-allocated work.  This vector
-  /// is recalculated if `entityComponents` is changed (when
+  /// \brief Entities grouped by archetype, i.e. by the exact set of
+  /// component types they have. Views are populated by visiting only the
+  /// archetypes that contain all of the view's component types, instead of
+  /// testing every entity in the graph.
+  public: ArchetypeMap archetypes;
+
+  /// \brief The archetype that each entity with components belongs to.
+  public: std::unordered_map<Entity, ArchetypeMap::iterator>
+          entityArchetypes;
+
+  /// \brief Entities of the `entityComponents` map, sorted. `State()`
+  /// splits this into ranges of entities serialized by each task, so the
+  /// split doesn't depend on the map's iteration order. This vector is
+  /// rebuilt if `entityComponents` is changed (when
   /// `entityComponentsDirty` == true).
-  public: std::vector<std::unordered_map<Entity,
-          std::unordered_map<ComponentTypeId, ComponentKey>>::iterator>
-            entityComponentIterators;
+  public: std::vector<Entity> stateEntities;
 
   /// \brief A mutex to protect newly created entities.
   public: std::mutex entityCreatedMutex;
@@ -128,9 +448,207 @@ class ignition::gazebo::EntityComponentManagerPrivate
   /// \brief A mutex to protect removed components
   public: mutable std::mutex removedComponentsMutex;
 
+  /// \brief A mutex to protect the change state of components from
+  /// concurrent calls to SetChanged and EachChanged.
+  public: mutable std::mutex changedComponentsMutex;
+
+  /// \brief A mutex to protect the descendant cache.
+  public: mutable std::mutex descendantCacheMutex;
+
+  /// \brief Clear the scoped names and top level models cached for
+  /// scopedName and topLevelModel.
+  public: void ClearNameCache()
+  {
+    std::lock_guard<std::mutex> lock(this->nameCacheMutex);
+    this->scopedNames.clear();
+    this->topLevelModels.clear();
+  }
+
+  /// \brief Scoped names cached for scopedName, by entity. The key of each
+  /// name is its delimiter followed by '1' if it includes entity types, or
+  /// '0' otherwise.
+  public: mutable std::unordered_map<Entity,
+          std::vector<std::pair<std::string, std::string>>> scopedNames;
+
+  /// \brief Top level models cached for topLevelModel, by entity.
+  public: mutable std::unordered_map<Entity, Entity> topLevelModels;
+
+  /// \brief Protects scopedNames and topLevelModels, which are filled by
+  /// const calls from multiple threads.
+  public: mutable std::mutex nameCacheMutex;
+
   /// \brief The set of all views.
   public: mutable std::map<detail::ComponentTypeKey, detail::View> views;
 
+  /// \brief Number of view slots, see EntityComponentManager::NewViewSlot.
+  /// Views of FindView instantiations beyond that are searched in the map.
+  public: static constexpr std::size_t kViewSlotCount{1024};
+
+  /// \brief View cached in each view slot. Views are never moved, so the
+  /// pointers stay valid until views are removed.
+  public: mutable std::array<std::atomic<detail::View *>, kViewSlotCount>
+          viewSlots{};
+
+  /// \brief Views created while the manager is read-only. They're
+  /// protected by viewsMutex, and moved to views once the manager is
+  /// writable again, so that views can be searched without locking.
+  public: mutable std::map<detail::ComponentTypeKey, detail::View>
+          pendingViews;
+
+  /// \brief Remove the views which weren't used recently, see
+  /// EntityComponentManager::SetViewEviction.
+  public: void EvictViews();
+
+  /// \brief Queue an entity whose set of components changed, or which was
+  /// requested to be removed, for the next view update, see
+  /// EntityComponentManager::UpdateViews.
+  /// \param[in] _entity Entity to queue.
+  public: void QueueViewUpdate(const Entity _entity)
+  {
+    std::unique_lock<std::mutex> lock(this->viewsMutex, std::defer_lock);
+    if (this->concurrent)
+      lock.lock();
+    // Components are usually created one entity at a time, so skipping
+    // repeats of the last entity leaves few duplicates.
+    if (this->viewUpdates.empty() || this->viewUpdates.back() != _entity)
+      this->viewUpdates.push_back(_entity);
+  }
+
+  /// \brief Get the signature of a set of component types, giving a bit
+  /// to the types which don't have one yet.
+  /// \param[in] _types Component types.
+  /// \return Bitmask with the bit of each type set.
+  public: ComponentSignature NewSignature(
+              const detail::ComponentTypeKey &_types);
+
+  /// \brief Get the signature of a set of component types without giving
+  /// bits to new types, so it can be used while read-only.
+  /// \param[in] _types Component types.
+  /// \param[out] _signature Bitmask with the bit of each type set.
+  /// \return False if a type has no bit, in which case no archetype has
+  /// all the types.
+  public: bool Signature(const detail::ComponentTypeKey &_types,
+              ComponentSignature &_signature) const;
+
+  /// \brief Entities queued for the next view update, may hold duplicates.
+  public: mutable std::vector<Entity> viewUpdates;
+
+  /// \brief Bit of each component type in signatures, assigned the first
+  /// time the type is part of an archetype or a view, see NewSignature.
+  public: std::unordered_map<ComponentTypeId, std::size_t> typeBits;
+
+  /// \brief Number of change generations after which unused views are
+  /// removed, zero to keep them.
+  public: uint64_t viewEvictionAge{0};
+
+  /// \brief Maximum number of views, zero for no maximum.
+  public: std::size_t maxViews{0};
+
+  /// \brief Number of views removed by EvictViews.
+  public: uint64_t evictedViews{0};
+
+  /// \brief True while the manager is only read, see
+  /// EntityComponentManager::SetReadOnly.
+  public: bool readOnly{false};
+
+  /// \brief True while several systems use the manager at the same time,
+  /// see EntityComponentManager::SetConcurrent.
+  public: bool concurrent{false};
+
+  /// \brief Indices of entities by component data, see
+  /// EntityComponentManager::EnableComponentIndex.
+  public: std::vector<ComponentIndex> componentIndices;
+
+  /// \brief Indices of entities by a numeric component field, see
+  /// EntityComponentManager::EnableRangeIndex. Protected by
+  /// componentIndicesMutex.
+  public: std::vector<RangeIndex> rangeIndices;
+
+  /// \brief A mutex to protect the contents of component indices from
+  /// concurrent updates and lookups.
+  public: mutable std::mutex componentIndicesMutex;
+
+  /// \brief World poses computed by the last world pose pass.
+  public: std::unordered_map<Entity, WorldPoseEntry> worldPoses;
+
+  /// \brief Number of world pose passes run so far.
+  public: uint64_t worldPosePass{0};
+
+  /// \brief True if the cached world poses match the Pose components, i.e.
+  /// between a call to UpdateWorldPoses and one to InvalidateWorldPoses.
+  public: bool worldPosesValid{false};
+
+  /// \brief Index of world boxes, see
+  /// EntityComponentManager::EnableSpatialIndex.
+  public: SpatialIndex spatialIndex;
+
+  /// \brief True if the spatial index is refreshed by the world pose pass.
+  public: bool spatialIndexEnabled{false};
+
+  /// \brief True if all entities must be put in the spatial index on the
+  /// next world pose pass, instead of only the ones which moved.
+  public: bool spatialIndexDirty{false};
+
+  /// \brief Change token of AxisAlignedBox components for the spatial
+  /// index.
+  public: uint64_t spatialBoxToken{0};
+
+  /// \brief Entities of static subtrees, see
+  /// EntityComponentManager::IsStatic.
+  public: std::unordered_set<Entity> staticEntities;
+
+  /// \brief Component layout generation when staticEntities was computed.
+  public: uint64_t staticLayoutGeneration{0};
+
+  /// \brief Change token of Static components for staticEntities.
+  public: uint64_t staticToken{0};
+
+  /// \brief Incremented every time an entity's parent is set.
+  public: uint64_t hierarchyGeneration{0};
+
+  /// \brief Hierarchy generation when staticEntities was computed.
+  public: uint64_t staticHierarchyGeneration{0};
+
+  /// \brief Links tracked by EntityComponentManager::TrackLinkState.
+  public: std::unordered_set<Entity> trackedLinks;
+
+  /// \brief Link states computed by the last link state pass.
+  public: std::unordered_map<Entity, LinkState> linkStates;
+
+  /// \brief True if the cached link states match the link components,
+  /// i.e. between a call to UpdateLinkStates and one to
+  /// InvalidateLinkStates.
+  public: bool linkStatesValid{false};
+
+  /// \brief Protects sharedObjects.
+  public: std::mutex sharedObjectsMutex;
+
+  /// \brief Objects handed out by SharedObject, by key.
+  public: std::unordered_map<std::string, std::weak_ptr<void>> sharedObjects;
+
+  /// \brief Task pool used for parallel work. If null, the pool shared by
+  /// all entity component managers is used.
+  public: TaskPool *taskPool{nullptr};
+
+  /// \brief True to split parallel work into chunks which don't depend on
+  /// the number of threads.
+  public: bool deterministic{false};
+
+  /// \brief Get the task pool used for parallel work.
+  /// \return The task pool.
+  public: TaskPool &Pool() const
+  {
+    return nullptr != this->taskPool ? *this->taskPool : SharedTaskPool();
+  }
+
+  /// \brief Protects stepArenas.
+  public: std::mutex stepArenasMutex;
+
+  /// \brief Arenas handed out by StepMemory, one per thread which asked
+  /// for one. They are kept across iterations to reuse their buffers.
+  public: std::unordered_map<std::thread::id, std::unique_ptr<StepArena>>
+          stepArenas;
+
   /// \brief Cache of previously queried descendants. The key is the parent
   /// entity for which descendants were queried, and the value are all its
   /// descendants.
@@ -140,10 +658,31 @@ class ignition::gazebo::EntityComponentManagerPrivate
   /// \brief Keep track of entities already used to ensure uniqueness.
   public: uint64_t entityCount{0};
 
+  /// \brief True if the slots of removed entities are reused.
+  public: bool entityRecycling{false};
+
+  /// \brief Ids to give to new entities which reuse the slots of removed
+  /// entities, i.e. the removed ids with their generation incremented.
+  public: std::vector<Entity> recycledEntities;
+
   /// \brief Unordered multimap of removed components. The key is the entity to
   /// which belongs the component, and the value is the component being
   /// removed.
   std::unordered_multimap<Entity, ComponentKey> removedComponents;
+
+  /// \brief Protects the RebuildState scratch vectors below.
+  public: std::mutex rebuildStateMutex;
+
+  /// \brief Components to serialize in RebuildState, and the message
+  /// buffers they're serialized into. Kept to reuse its memory.
+  public: std::vector<std::pair<const components::BaseComponent *,
+          std::string *>> rebuildStateJobs;
+
+  /// \brief Entities kept in the message by RebuildState.
+  public: std::vector<Entity> rebuildStateEntities;
+
+  /// \brief Component types kept for the current entity by RebuildState.
+  public: std::vector<ComponentTypeId> rebuildStateTypes;
 };
 
 //////////////////////////////////////////////////
@@ -164,7 +703,9 @@ size_t EntityComponentManager::EntityCount() const
 /////////////////////////////////////////////////
 Entity EntityComponentManager::CreateEntity()
 {
-  Entity entity = ++this->dataPtr->entityCount;
+  Entity entity = this->dataPtr->NextEntity();
+  if (entity == kNullEntity)
+    return kNullEntity;
 
   if (entity == std::numeric_limits<uint64_t>::max())
   {
@@ -176,11 +717,35 @@ Entity EntityComponentManager::CreateEntity()
   return this->dataPtr->CreateEntityImplementation(entity);
 }
 
+/////////////////////////////////////////////////
+Entity EntityComponentManagerPrivate::NextEntity()
+{
+  if (this->entityRecycling)
+  {
+    if (!this->recycledEntities.empty())
+    {
+      const Entity entity = this->recycledEntities.back();
+      this->recycledEntities.pop_back();
+      return entity;
+    }
+
+    if (entitySlot(this->entityCount + 1) == 0)
+    {
+      ignerr << "Reached maximum number of entity slots ["
+             << this->entityCount << "]" << std::endl;
+      return kNullEntity;
+    }
+  }
+
+  return ++this->entityCount;
+}
+
 /////////////////////////////////////////////////
 Entity EntityComponentManagerPrivate::CreateEntityImplementation(Entity _entity)
 {
   IGN_PROFILE("EntityComponentManager::CreateEntityImplementation");
   this->entities.AddVertex(std::to_string(_entity), _entity, _entity);
+  this->hierarchy.AddEntity(_entity);
 
   // Add entity to the list of newly created entities
   {
@@ -190,13 +755,55 @@ Entity EntityComponentManagerPrivate::CreateEntityImplementation(Entity _entity)
 
   // Reset descendants cache
   this->descendantCache.clear();
+  this->ClearNameCache();
 
   return _entity;
 }
 
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::RecycleEntity(const Entity _entity)
+{
+  // Slots whose generation can't be incremented anymore are retired.
+  if (!this->entityRecycling ||
+      entityGeneration(_entity) == std::numeric_limits<uint32_t>::max())
+  {
+    return;
+  }
+
+  this->recycledEntities.push_back(_entity + (uint64_t{1} << kEntitySlotBits));
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::SetEntityRecycling(const bool _enabled)
+{
+  // Ids past the slot range, such as those after a large entity create
+  // offset, would be taken for generations of other slots.
+  if (_enabled && entitySlot(this->dataPtr->entityCount) !=
+      this->dataPtr->entityCount)
+  {
+    ignerr << "Can't enable entity recycling, entity ids already reach ["
+           << this->dataPtr->entityCount << "], past the range of entity "
+           << "slots." << std::endl;
+    return;
+  }
+
+  this->dataPtr->entityRecycling = _enabled;
+  if (!_enabled)
+    this->dataPtr->recycledEntities.clear();
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::EntityRecycling() const
+{
+  return this->dataPtr->entityRecycling;
+}
+
 /////////////////////////////////////////////////
 void EntityComponentManager::ClearNewlyCreatedEntities()
 {
+  // Queued entities are still new to the views they're added to.
+  this->UpdateViews();
+
   std::lock_guard<std::mutex> lock(this->dataPtr->entityCreatedMutex);
   this->dataPtr->newlyCreatedEntities.clear();
 
@@ -213,23 +820,12 @@ void EntityComponentManager::ClearRemovedComponents()
   this->dataPtr->removedComponents.clear();
 }
 
-/////////////////////////////////////////////////
-void EntityComponentManagerPrivate::InsertEntityRecursive(Entity _entity,
-    std::unordered_set<Entity> &_set)
-{
-  for (const auto &vertex : this->entities.AdjacentsFrom(_entity))
-  {
-    this->InsertEntityRecursive(vertex.first, _set);
-  }
-  _set.insert(_entity);
-}
-
 /////////////////////////////////////////////////
 void EntityComponentManager::RequestRemoveEntity(Entity _entity,
     bool _recursive)
 {
-  // Store the to-be-removed entities in a temporary set so we can call
-  // UpdateViews on each of them
+  // Store the to-be-removed entities in a temporary set so we can queue
+  // each of them for the next view update
   std::unordered_set<Entity> tmpToRemoveEntities;
   if (!_recursive)
   {
@@ -237,7 +833,13 @@ void EntityComponentManager::RequestRemoveEntity(Entity _entity,
   }
   else
   {
-    this->dataPtr->InsertEntityRecursive(_entity, tmpToRemoveEntities);
+    this->dataPtr->hierarchy.DepthFirst(_entity,
+        [&](const Entity &_descendant)
+        {
+          tmpToRemoveEntities.insert(_descendant);
+          return true;
+        });
+    tmpToRemoveEntities.insert(_entity);
   }
 
   {
@@ -248,7 +850,7 @@ void EntityComponentManager::RequestRemoveEntity(Entity _entity,
 
   for (const auto &removedEntity : tmpToRemoveEntities)
   {
-    this->UpdateViews(removedEntity);
+    this->dataPtr->QueueViewUpdate(removedEntity);
   }
 }
 
@@ -266,38 +868,92 @@ void EntityComponentManager::RequestRemoveEntities()
 void EntityComponentManager::ProcessRemoveEntityRequests()
 {
   IGN_PROFILE("EntityComponentManager::ProcessRemoveEntityRequests");
+  this->UpdateViews();
   std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
+  const bool removing = this->dataPtr->removeAllEntities ||
+      !this->dataPtr->toRemoveEntities.empty();
+
   // Short-cut if erasing all entities
   if (this->dataPtr->removeAllEntities)
   {
     IGN_PROFILE("RemoveAll");
     this->dataPtr->removeAllEntities = false;
+    if (this->dataPtr->entityRecycling)
+    {
+      for (const auto &vertex : this->dataPtr->entities.Vertices())
+        this->dataPtr->RecycleEntity(vertex.first);
+    }
     this->dataPtr->entities = EntityGraph();
+    this->dataPtr->hierarchy.Clear();
     this->dataPtr->entityComponents.clear();
+    this->dataPtr->archetypes.clear();
+    this->dataPtr->entityArchetypes.clear();
     this->dataPtr->toRemoveEntities.clear();
     this->dataPtr->entityComponentsDirty = true;
+    ++this->dataPtr->layoutGeneration;
 
     for (std::pair<const ComponentTypeId,
-        std::unique_ptr<ComponentStorageBase>> &comp: this->dataPtr->components)
+        std::shared_ptr<ComponentStorageBase>> &comp: this->dataPtr->components)
     {
-      comp.second->RemoveAll();
+      // Storages shared with forks are replaced by empty ones instead of
+      // being copied only to be cleared.
+      std::shared_ptr<ComponentStorageBase> empty;
+      if (comp.second.use_count() > 1)
+        empty = components::Factory::Instance()->NewStorage(comp.first);
+
+      if (nullptr != empty)
+      {
+        empty->SetReadOnly(this->dataPtr->readOnly);
+        comp.second = std::move(empty);
+      }
+      else
+      {
+        this->dataPtr->MutableStorage(comp.first, this).RemoveAll();
+      }
     }
 
+    this->dataPtr->pendingCompactions.clear();
+
     // All views are now invalid.
     this->dataPtr->views.clear();
+    this->dataPtr->viewUpdates.clear();
+    for (auto &viewSlot : this->dataPtr->viewSlots)
+      viewSlot.store(nullptr, std::memory_order_relaxed);
+
+    for (auto &index : this->dataPtr->componentIndices)
+    {
+      index.entities.clear();
+      index.hashes.clear();
+    }
+    for (auto &index : this->dataPtr->rangeIndices)
+    {
+      index.entities.clear();
+      index.keys.clear();
+    }
   }
   else
   {
     IGN_PROFILE("Remove");
+    // Components to remove, grouped by type, so that each storage is only
+    // visited once.
+    std::unordered_map<ComponentTypeId, std::vector<ComponentId>> toRemoveIds;
+
+    // Removed entities are taken out of each view at once afterwards.
+    std::vector<Entity> removedEntities;
+    removedEntities.reserve(this->dataPtr->toRemoveEntities.size());
+
     // Otherwise iterate through the list of entities to remove.
     for (const Entity entity : this->dataPtr->toRemoveEntities)
     {
       // Make sure the entity exists and is not removed.
       if (!this->HasEntity(entity))
         continue;
+      removedEntities.push_back(entity);
 
       // Remove from graph
       this->dataPtr->entities.RemoveVertex(entity);
+      this->dataPtr->hierarchy.RemoveEntity(entity);
+      this->dataPtr->RecycleEntity(entity);
 
       auto entityIter = this->dataPtr->entityComponents.find(entity);
       // Remove the components, if any.
@@ -305,27 +961,84 @@ void EntityComponentManager::ProcessRemoveEntityRequests()
       {
         for (const auto &key : entityIter->second)
         {
-          this->dataPtr->components.at(key.second.first)->Remove(
-              key.second.second);
+          toRemoveIds[key.second.first].push_back(key.second.second);
         }
 
         // Remove the entry in the entityComponent map
         this->dataPtr->entityComponents.erase(entity);
         this->dataPtr->entityComponentsDirty = true;
+        ++this->dataPtr->layoutGeneration;
       }
+      this->dataPtr->RemoveFromArchetype(entity);
 
-      // Remove the entity from views.
-      for (auto &view : this->dataPtr->views)
+      for (auto &index : this->dataPtr->componentIndices)
+      {
+        EntityComponentManagerPrivate::UnindexEntity(index, entity);
+      }
+      for (auto &index : this->dataPtr->rangeIndices)
       {
-        view.second.RemoveEntity(entity, view.first);
+        EntityComponentManagerPrivate::UnindexEntity(index, entity);
       }
     }
+
+    // Remove the entities from views.
+    std::sort(removedEntities.begin(), removedEntities.end());
+    for (auto &view : this->dataPtr->views)
+      view.second.RemoveEntities(removedEntities);
+
+    // Components are only tombstoned, so no other component is moved and
+    // no view needs to be refreshed. Their slots are reclaimed over the
+    // following steps by CompactComponentStorage.
+    for (const auto &typeIds : toRemoveIds)
+    {
+      auto &storage = this->dataPtr->MutableStorage(typeIds.first, this);
+      storage.RemoveDeferred(typeIds.second);
+      if (storage.TombstoneCount() > 0)
+        this->dataPtr->pendingCompactions.insert(typeIds.first);
+    }
+
     // Clear the set of entities to remove.
     this->dataPtr->toRemoveEntities.clear();
   }
 
   // Reset descendants cache
   this->dataPtr->descendantCache.clear();
+
+  // Removed entities may be recycled
+  if (removing)
+    this->dataPtr->ClearNameCache();
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::CompactComponentStorage(
+    const std::size_t _maxMoves)
+{
+  if (this->dataPtr->pendingCompactions.empty())
+    return true;
+
+  IGN_PROFILE("EntityComponentManager::CompactComponentStorage");
+  std::size_t budget = _maxMoves;
+  std::vector<Entity> moved;
+  auto iter = this->dataPtr->pendingCompactions.begin();
+  while (iter != this->dataPtr->pendingCompactions.end() && budget > 0)
+  {
+    auto &storage = this->dataPtr->MutableStorage(*iter, this);
+    moved.clear();
+    const std::size_t left = storage.Compact(budget, moved);
+    budget -= std::min(budget, moved.size());
+
+    // Only the rows of the moved components are refreshed, so each step is
+    // bounded by the number of moves.
+    if (!moved.empty())
+      this->dataPtr->RefreshViews(*iter, moved, this);
+
+    if (left == 0)
+      iter = this->dataPtr->pendingCompactions.erase(iter);
+    else
+      ++iter;
+  }
+
+  return this->dataPtr->pendingCompactions.empty();
 }
 
 /////////////////////////////////////////////////
@@ -346,13 +1059,22 @@ bool EntityComponentManager::RemoveComponent(
   if (!this->EntityHasComponent(_entity, _key))
     return false;
 
-  this->dataPtr->components.at(_key.first)->Remove(_key.second);
+  auto &storage = this->dataPtr->MutableStorage(_key.first, this);
+  const std::size_t relocations = storage.Relocations();
+  storage.Remove(_key.second);
   this->dataPtr->entityComponents[_entity].erase(_key.first);
-  this->dataPtr->oneTimeChangedComponents.erase(_key);
-  this->dataPtr->periodicChangedComponents.erase(_key);
   this->dataPtr->entityComponentsDirty = true;
+  ++this->dataPtr->layoutGeneration;
+  this->dataPtr->UpdateArchetype(_entity);
+
+  this->dataPtr->QueueViewUpdate(_entity);
 
-  this->UpdateViews(_entity);
+  // Another component of the same type may have been moved into the
+  // removed component's place.
+  if (storage.Relocations() != relocations)
+    this->dataPtr->RefreshViews(_key.first, this);
+
+  this->UpdateComponentIndices(_entity, _key.first);
 
   // Add component to map of removed components
   {
@@ -392,7 +1114,7 @@ bool EntityComponentManager::EntityHasComponentType(const Entity _entity,
 /////////////////////////////////////////////////
 bool EntityComponentManager::IsNewEntity(const Entity _entity) const
 {
-  std::lock_guard<std::mutex> lock(this->dataPtr->entityCreatedMutex);
+  auto lock = this->dataPtr->ReadLock(this->dataPtr->entityCreatedMutex);
   return this->dataPtr->newlyCreatedEntities.find(_entity) !=
          this->dataPtr->newlyCreatedEntities.end();
 }
@@ -400,7 +1122,7 @@ bool EntityComponentManager::IsNewEntity(const Entity _entity) const
 /////////////////////////////////////////////////
 bool EntityComponentManager::IsMarkedForRemoval(const Entity _entity) const
 {
-  std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
+  auto lock = this->dataPtr->ReadLock(this->dataPtr->entityRemoveMutex);
   if (this->dataPtr->removeAllEntities)
   {
     return true;
@@ -424,265 +1146,1463 @@ ComponentState EntityComponentManager::ComponentState(const Entity _entity,
   if (typeKey == ecIter->second.end())
     return result;
 
-  if (this->dataPtr->oneTimeChangedComponents.find(typeKey->second) !=
-      this->dataPtr->oneTimeChangedComponents.end())
-  {
-    result = ComponentState::OneTimeChange;
-  }
-  else if (this->dataPtr->periodicChangedComponents.find(typeKey->second) !=
-      this->dataPtr->periodicChangedComponents.end())
-  {
-    result = ComponentState::PeriodicChange;
-  }
-
-  return result;
-}
-
-/////////////////////////////////////////////////
-bool EntityComponentManager::HasNewEntities() const
-{
-  std::lock_guard<std::mutex> lock(this->dataPtr->entityCreatedMutex);
-  return !this->dataPtr->newlyCreatedEntities.empty();
+  return this->dataPtr->components.at(_typeId)->ChangeState(
+      typeKey->second.second);
 }
 
 /////////////////////////////////////////////////
-bool EntityComponentManager::HasEntitiesMarkedForRemoval() const
+void EntityComponentManager::MemoryUsage(
+    std::vector<ComponentMemoryUsage> &_components,
+    std::vector<ViewMemoryUsage> &_views) const
 {
-  std::lock_guard<std::mutex> lock(this->dataPtr->entityRemoveMutex);
-  return this->dataPtr->removeAllEntities ||
-      !this->dataPtr->toRemoveEntities.empty();
-}
+  IGN_PROFILE("EntityComponentManager::MemoryUsage");
+  _components.clear();
+  _views.clear();
 
-/////////////////////////////////////////////////
-bool EntityComponentManager::HasOneTimeComponentChanges() const
-{
-  return !this->dataPtr->oneTimeChangedComponents.empty();
-}
+  for (const auto &storage : this->dataPtr->components)
+  {
+    ComponentMemoryUsage usage;
+    usage.typeId = storage.first;
+    usage.name = components::Factory::Instance()->Name(storage.first);
+    usage.count = storage.second->Count();
+    storage.second->MemoryUsage(usage.bytes, usage.overhead);
+    _components.push_back(std::move(usage));
+  }
 
-/////////////////////////////////////////////////
-std::unordered_set<ComponentTypeId>
-    EntityComponentManager::ComponentTypesWithPeriodicChanges() const
-{
-  std::unordered_set<ComponentTypeId> periodicComponents;
-  for (const auto& compPair : this->dataPtr->periodicChangedComponents)
+  auto lock = this->dataPtr->ReadLock(this->dataPtr->viewsMutex);
+  for (const auto &view : this->dataPtr->views)
   {
-    periodicComponents.insert(compPair.first);
+    ViewMemoryUsage usage;
+    usage.types = view.second.types;
+    usage.entityCount = view.second.entities.size();
+    usage.bytes = view.second.MemoryUsage();
+    usage.lastUsed = view.second.usage.Generation();
+    _views.push_back(std::move(usage));
   }
-  return periodicComponents;
 }
 
 /////////////////////////////////////////////////
-bool EntityComponentManager::HasEntity(const Entity _entity) const
+void EntityComponentManager::SetViewEviction(const uint64_t _unusedGenerations,
+    const std::size_t _maxViews)
 {
-  auto vertex = this->dataPtr->entities.VertexFromId(_entity);
-  return vertex.Id() != math::graph::kNullId;
+  this->dataPtr->viewEvictionAge = _unusedGenerations;
+  this->dataPtr->maxViews = _maxViews;
 }
 
 /////////////////////////////////////////////////
-Entity EntityComponentManager::ParentEntity(const Entity _entity) const
+uint64_t EntityComponentManager::EvictedViewCount() const
 {
-  auto parents = this->Entities().AdjacentsTo(_entity);
-  if (parents.empty())
-    return kNullEntity;
-
-  // TODO(louise) Do we want to support multiple parents?
-  return parents.begin()->first;
+  return this->dataPtr->evictedViews;
 }
 
 /////////////////////////////////////////////////
-bool EntityComponentManager::SetParentEntity(const Entity _child,
-    const Entity _parent)
+void EntityComponentManagerPrivate::EvictViews()
 {
-  // Remove current parent(s)
-  auto parents = this->Entities().AdjacentsTo(_child);
-  for (const auto &parent : parents)
+  // Views created while read-only are still pending, and may be in use.
+  if (this->readOnly || this->concurrent || this->views.empty() ||
+      (this->viewEvictionAge == 0 && this->maxViews == 0))
   {
-    auto edge = this->dataPtr->entities.EdgeFromVertices(parent.first, _child);
-    this->dataPtr->entities.RemoveEdge(edge);
+    return;
   }
 
-  // Leave parent-less
+  IGN_PROFILE("EntityComponentManagerPrivate::EvictViews");
+  std::lock_guard<std::mutex> lockViews(this->viewsMutex);
+  const std::size_t viewCount = this->views.size();
+
+  if (this->viewEvictionAge > 0)
+  {
+    for (auto iter = this->views.begin(); iter != this->views.end();)
+    {
+      if (this->changeGeneration - iter->second.usage.Generation() >=
+          this->viewEvictionAge)
+      {
+        iter = this->views.erase(iter);
+      }
+      else
+      {
+        ++iter;
+      }
+    }
+  }
+
+  if (this->maxViews > 0 && this->views.size() > this->maxViews)
+  {
+    using ViewIter = std::map<detail::ComponentTypeKey,
+        detail::View>::iterator;
+    std::vector<std::pair<uint64_t, ViewIter>> byUsage;
+    byUsage.reserve(this->views.size());
+    for (auto iter = this->views.begin(); iter != this->views.end(); ++iter)
+      byUsage.emplace_back(iter->second.usage.Generation(), iter);
+    std::sort(byUsage.begin(), byUsage.end(),
+        [](const auto &_a, const auto &_b) {return _a.first < _b.first;});
+
+    const std::size_t excess = this->views.size() - this->maxViews;
+    for (std::size_t i = 0; i < excess &&
+        byUsage[i].first < this->changeGeneration; ++i)
+    {
+      this->views.erase(byUsage[i].second);
+    }
+  }
+
+  if (this->views.size() == viewCount)
+    return;
+
+  this->evictedViews += viewCount - this->views.size();
+
+  // Slots may point to removed views, they're cached again when used.
+  for (auto &viewSlot : this->viewSlots)
+    viewSlot.store(nullptr, std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+ComponentSignature EntityComponentManagerPrivate::NewSignature(
+    const detail::ComponentTypeKey &_types)
+{
+  for (const ComponentTypeId type : _types)
+    this->typeBits.emplace(type, this->typeBits.size());
+
+  ComponentSignature signature;
+  this->Signature(_types, signature);
+  return signature;
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManagerPrivate::Signature(
+    const detail::ComponentTypeKey &_types,
+    ComponentSignature &_signature) const
+{
+  _signature.clear();
+  for (const ComponentTypeId type : _types)
+  {
+    auto iter = this->typeBits.find(type);
+    if (iter == this->typeBits.end())
+      return false;
+
+    SetSignatureBit(_signature, iter->second);
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+uint64_t EntityComponentManager::ChangeGeneration() const
+{
+  return this->dataPtr->changeGeneration;
+}
+
+/////////////////////////////////////////////////
+uint64_t EntityComponentManager::ComponentLayoutGeneration() const
+{
+  return this->dataPtr->layoutGeneration.load(std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////
+std::pmr::memory_resource *EntityComponentManager::StepMemory() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->stepArenasMutex);
+  auto &arena = this->dataPtr->stepArenas[std::this_thread::get_id()];
+  if (!arena)
+    arena = std::make_unique<StepArena>();
+  return arena.get();
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::ResetStepMemory()
+{
+  IGN_PROFILE("EntityComponentManager::ResetStepMemory");
+  std::lock_guard<std::mutex> lock(this->dataPtr->stepArenasMutex);
+  for (auto &arena : this->dataPtr->stepArenas)
+    arena.second->Reset();
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::ComponentChangedSince(const Entity _entity,
+    const ComponentTypeId _typeId, const uint64_t _generation) const
+{
+  auto ecIter = this->dataPtr->entityComponents.find(_entity);
+  if (ecIter == this->dataPtr->entityComponents.end())
+    return false;
+
+  auto typeKey = ecIter->second.find(_typeId);
+  if (typeKey == ecIter->second.end())
+    return false;
+
+  return this->dataPtr->components.at(_typeId)->ChangeGeneration(
+      typeKey->second.second) >= _generation;
+}
+
+/////////////////////////////////////////////////
+std::optional<math::Pose3d> EntityComponentManager::CachedWorldPose(
+    const Entity _entity) const
+{
+  if (!this->dataPtr->worldPosesValid)
+    return std::nullopt;
+
+  auto iter = this->dataPtr->worldPoses.find(_entity);
+  if (iter == this->dataPtr->worldPoses.end())
+    return std::nullopt;
+
+  return iter->second.world;
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::IsStatic(const Entity _entity) const
+{
+  return this->dataPtr->staticEntities.find(_entity) !=
+      this->dataPtr->staticEntities.end();
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::UpdateStaticEntities()
+{
+  IGN_PROFILE("EntityComponentManager::UpdateStaticEntities");
+  auto &data = *this->dataPtr;
+
+  // Components are only read, so storages shared with forks aren't copied.
+  const EntityComponentManager &constThis = *this;
+
+  // Entities only become static or dynamic when the layout or the tree
+  // changes, or when a Static component changes. The token is always moved
+  // forward, so changes aren't seen twice.
+  const bool staticChanged = !constThis.ChangedEntities(
+      components::Static::typeId, data.staticToken).empty();
+  if (!staticChanged &&
+      data.staticLayoutGeneration == this->ComponentLayoutGeneration() &&
+      data.staticHierarchyGeneration == data.hierarchyGeneration)
+  {
+    return;
+  }
+  data.staticLayoutGeneration = this->ComponentLayoutGeneration();
+  data.staticHierarchyGeneration = data.hierarchyGeneration;
+
+  data.staticEntities.clear();
+  constThis.Each<components::Static>(
+      [&](const Entity &_entity, const components::Static *_static) -> bool
+      {
+        // Nested static models are already part of their parent's subtree
+        if (!_static->Data() || this->IsStatic(_entity))
+          return true;
+
+        constThis.EachDescendantDepthFirst(_entity,
+            [&](const Entity &_descendant)
+            {
+              data.staticEntities.insert(_descendant);
+              return true;
+            });
+        return true;
+      });
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::UpdateWorldPoses()
+{
+  IGN_PROFILE("EntityComponentManager::UpdateWorldPoses");
+  auto &poses = this->dataPtr->worldPoses;
+  const uint64_t pass = ++this->dataPtr->worldPosePass;
+
+  // Components are only read, so storages shared with forks aren't copied.
+  const EntityComponentManager &constThis = *this;
+
+  // Get the parent of an entity if the parent has a pose.
+  auto parentWithPose = [&constThis](const Entity _entity)
+  {
+    auto parent = constThis.Component<components::ParentEntity>(_entity);
+    if (!parent || !constThis.Component<components::Pose>(parent->Data()))
+      return kNullEntity;
+    return parent->Data();
+  };
+
+  std::vector<Entity> stack;
+  constThis.Each<components::Pose>(
+      [&](const Entity &_entity, const components::Pose *) -> bool
+      {
+        // Visit the ancestors which weren't visited yet, so they're resolved
+        // before their descendants. Marking entities as visited on the way
+        // up also keeps parenting cycles from looping forever.
+        for (Entity entity = _entity; entity != kNullEntity;
+            entity = parentWithPose(entity))
+        {
+          auto &entry = poses[entity];
+          if (entry.visitedPass == pass)
+            break;
+          entry.visitedPass = pass;
+          stack.push_back(entity);
+        }
+
+        while (!stack.empty())
+        {
+          const Entity entity = stack.back();
+          stack.pop_back();
+
+          // References to unordered_map elements survive rehashing.
+          auto &entry = poses[entity];
+          const auto &local =
+              constThis.Component<components::Pose>(entity)->Data();
+          const Entity parent = parentWithPose(entity);
+          const WorldPoseEntry *parentEntry =
+              parent == kNullEntity ? nullptr : &poses[parent];
+
+          const bool moved = entry.movedPass == 0 ||
+              entry.parent != parent || !IdenticalPoses(entry.local, local) ||
+              (parentEntry && parentEntry->movedPass == pass);
+          if (!moved)
+            continue;
+
+          entry.local = local;
+          entry.parent = parent;
+          entry.world = parentEntry ? local + parentEntry->world : local;
+          entry.movedPass = pass;
+        }
+        return true;
+      });
+
+  // Forget entities which don't have a pose anymore.
+  for (auto iter = poses.begin(); iter != poses.end();)
+  {
+    if (iter->second.visitedPass != pass)
+    {
+      this->dataPtr->spatialIndex.Remove(iter->first);
+      iter = poses.erase(iter);
+    }
+    else
+      ++iter;
+  }
+
+  if (this->dataPtr->spatialIndexEnabled)
+    this->UpdateSpatialIndex(pass);
+
+  this->dataPtr->worldPosesValid = true;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::UpdateSpatialIndex(const uint64_t _pass)
+{
+  IGN_PROFILE("EntityComponentManager::UpdateSpatialIndex");
+  auto &index = this->dataPtr->spatialIndex;
+
+  // Box of an entity, in the world frame
+  const EntityComponentManager &constThis = *this;
+  auto worldBox = [&constThis](const Entity _entity,
+      const math::Pose3d &_world)
+  {
+    auto box = constThis.Component<components::AxisAlignedBox>(_entity);
+    if (box)
+      return box->Data();
+    return math::AxisAlignedBox(_world.Pos(), _world.Pos());
+  };
+
+  const bool all = this->dataPtr->spatialIndexDirty;
+  for (const auto &[entity, entry] : this->dataPtr->worldPoses)
+  {
+    if (all || entry.movedPass == _pass)
+      index.Update(entity, worldBox(entity, entry.world));
+  }
+
+  // Boxes which changed without the entity moving
+  this->EachChanged<components::AxisAlignedBox, components::Pose>(
+      this->dataPtr->spatialBoxToken,
+      [&](const Entity &_entity, const components::AxisAlignedBox *_box,
+          const components::Pose *) -> bool
+      {
+        if (this->dataPtr->worldPoses.find(_entity) !=
+            this->dataPtr->worldPoses.end())
+        {
+          index.Update(_entity, _box->Data());
+        }
+        return true;
+      });
+
+  this->dataPtr->spatialIndexDirty = false;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::EnableSpatialIndex(double _cellSize)
+{
+  this->dataPtr->spatialIndex.SetCellSize(_cellSize);
+  if (!this->dataPtr->spatialIndexEnabled)
+  {
+    this->dataPtr->spatialIndexEnabled = true;
+    this->dataPtr->spatialIndexDirty = true;
+  }
+}
+
+/////////////////////////////////////////////////
+const SpatialIndex &EntityComponentManager::WorldSpatialIndex() const
+{
+  return this->dataPtr->spatialIndex;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::InvalidateWorldPoses()
+{
+  this->dataPtr->worldPosesValid = false;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::TrackLinkState(const Entity _link)
+{
+  this->dataPtr->trackedLinks.insert(_link);
+}
+
+/////////////////////////////////////////////////
+std::optional<LinkState> EntityComponentManager::CachedLinkState(
+    const Entity _link) const
+{
+  if (!this->dataPtr->linkStatesValid)
+    return std::nullopt;
+
+  auto iter = this->dataPtr->linkStates.find(_link);
+  if (iter == this->dataPtr->linkStates.end())
+    return std::nullopt;
+
+  return iter->second;
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<void> EntityComponentManager::SharedObjectImplementation(
+    const std::string &_key, const std::function<void *()> &_create,
+    void (*_destroy)(void *)) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->sharedObjectsMutex);
+  auto &objects = this->dataPtr->sharedObjects;
+
+  auto iter = objects.find(_key);
+  if (iter != objects.end())
+  {
+    if (auto object = iter->second.lock())
+      return object;
+  }
+
+  // Drop the objects which were released, so keys used once don't pile up
+  for (auto it = objects.begin(); it != objects.end();)
+  {
+    if (it->second.expired())
+      it = objects.erase(it);
+    else
+      ++it;
+  }
+
+  std::shared_ptr<void> object(_create(), _destroy);
+  objects[_key] = object;
+  return object;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::UpdateLinkStates()
+{
+  IGN_PROFILE("EntityComponentManager::UpdateLinkStates");
+  auto &states = this->dataPtr->linkStates;
+  states.clear();
+
+  const EntityComponentManager &constThis = *this;
+  for (auto iter = this->dataPtr->trackedLinks.begin();
+       iter != this->dataPtr->trackedLinks.end();)
+  {
+    const Entity link = *iter;
+    if (!this->HasEntity(link))
+    {
+      iter = this->dataPtr->trackedLinks.erase(iter);
+      continue;
+    }
+    ++iter;
+
+    LinkState state;
+    auto worldPose = constThis.Component<components::WorldPose>(link);
+    if (worldPose)
+    {
+      state.worldPose = worldPose->Data();
+    }
+    else
+    {
+      auto cached = this->CachedWorldPose(link);
+      if (!cached)
+        continue;
+      state.worldPose = *cached;
+    }
+
+    auto linVel = constThis.Component<components::WorldLinearVelocity>(link);
+    if (linVel)
+      state.worldLinearVelocity = linVel->Data();
+
+    auto angVel = constThis.Component<components::WorldAngularVelocity>(link);
+    if (angVel)
+      state.worldAngularVelocity = angVel->Data();
+
+    auto inertial = constThis.Component<components::Inertial>(link);
+    if (inertial)
+    {
+      state.worldInertialPose = state.worldPose * inertial->Data().Pose();
+      state.worldInertiaMatrix = math::Inertiald(
+          inertial->Data().MassMatrix(), *state.worldInertialPose).Moi();
+
+      if (linVel && angVel)
+      {
+        // Linear velocity at the center of mass
+        const math::Vector3d comLinVel = linVel->Data() +
+            angVel->Data().Cross(state.worldPose.Rot().RotateVector(
+            inertial->Data().Pose().Pos()));
+        state.worldKineticEnergy = 0.5 * (
+            inertial->Data().MassMatrix().Mass() * comLinVel.SquaredLength() +
+            angVel->Data().Dot(*state.worldInertiaMatrix * angVel->Data()));
+      }
+    }
+
+    states.emplace(link, state);
+  }
+
+  this->dataPtr->linkStatesValid = true;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManager::InvalidateLinkStates()
+{
+  this->dataPtr->linkStatesValid = false;
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::HasNewEntities() const
+{
+  auto lock = this->dataPtr->ReadLock(this->dataPtr->entityCreatedMutex);
+  return !this->dataPtr->newlyCreatedEntities.empty();
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::HasEntitiesMarkedForRemoval() const
+{
+  auto lock = this->dataPtr->ReadLock(this->dataPtr->entityRemoveMutex);
+  return this->dataPtr->removeAllEntities ||
+      !this->dataPtr->toRemoveEntities.empty();
+}
+
+/////////////////////////////////////////////////
+std::vector<Entity> EntityComponentManager::ChangedEntities(
+    const ComponentTypeId _typeId, uint64_t &_token) const
+{
+  IGN_PROFILE("EntityComponentManager::ChangedEntities");
+  std::vector<Entity> result;
+
+  // Changes may be logged by systems running at the same time.
+  auto lock = this->dataPtr->ReadLock(this->dataPtr->changedComponentsMutex);
+  auto storageIter = this->dataPtr->components.find(_typeId);
+  if (storageIter != this->dataPtr->components.end())
+    storageIter->second->ChangedSince(_token, result);
+
+  _token = this->dataPtr->changeSequence;
+  return result;
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::HasOneTimeComponentChanges() const
+{
+  for (const auto &storage : this->dataPtr->components)
+  {
+    if (storage.second->OneTimeChangeCount() > 0)
+      return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////
+std::unordered_set<ComponentTypeId>
+    EntityComponentManager::ComponentTypesWithPeriodicChanges() const
+{
+  std::unordered_set<ComponentTypeId> periodicComponents;
+  for (const auto &storage : this->dataPtr->components)
+  {
+    if (storage.second->PeriodicChangeCount() > 0)
+      periodicComponents.insert(storage.first);
+  }
+  return periodicComponents;
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::HasEntity(const Entity _entity) const
+{
+  auto vertex = this->dataPtr->entities.VertexFromId(_entity);
+  return vertex.Id() != math::graph::kNullId;
+}
+
+/////////////////////////////////////////////////
+Entity EntityComponentManager::ParentEntity(const Entity _entity) const
+{
+  return this->dataPtr->hierarchy.Parent(_entity);
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::SetParentEntity(const Entity _child,
+    const Entity _parent)
+{
+  // An entity can't be its own ancestor
+  for (Entity ancestor = _parent; ancestor != kNullEntity;
+      ancestor = this->dataPtr->hierarchy.Parent(ancestor))
+  {
+    if (ancestor == _child)
+    {
+      ignerr << "Can't set entity [" << _parent << "] as parent of entity ["
+             << _child << "], because it's a descendant of it." << std::endl;
+      return false;
+    }
+  }
+
+  ++this->dataPtr->hierarchyGeneration;
+
+  // Remove current parent(s)
+  auto parents = this->Entities().AdjacentsTo(_child);
+  for (const auto &parent : parents)
+  {
+    auto edge = this->dataPtr->entities.EdgeFromVertices(parent.first, _child);
+    this->dataPtr->entities.RemoveEdge(edge);
+  }
+
+  this->dataPtr->hierarchy.SetParent(_child, kNullEntity);
+
+  // Leave parent-less
   if (_parent == kNullEntity)
   {
-    return true;
+    return true;
+  }
+
+  // Add edge
+  auto edge = this->dataPtr->entities.AddEdge({_parent, _child}, true);
+  if (math::graph::kNullId == edge.Id())
+    return false;
+
+  return this->dataPtr->hierarchy.SetParent(_child, _parent);
+}
+
+/////////////////////////////////////////////////
+ComponentKey EntityComponentManager::CreateComponentImplementation(
+    const Entity _entity, const ComponentTypeId _componentTypeId,
+    const components::BaseComponent *_data)
+{
+  return this->InsertComponent(_entity, _componentTypeId, [&]()
+  {
+    return this->dataPtr->MutableStorage(_componentTypeId, this).Create(
+        _entity, _data);
+  });
+}
+
+/////////////////////////////////////////////////
+ComponentKey EntityComponentManager::CreateComponentImplementation(
+    const Entity _entity, const ComponentTypeId _componentTypeId,
+    components::BaseComponent &&_data)
+{
+  return this->InsertComponent(_entity, _componentTypeId, [&]()
+  {
+    return this->dataPtr->MutableStorage(_componentTypeId, this).Create(
+        _entity, std::move(_data));
+  });
+}
+
+/////////////////////////////////////////////////
+ComponentKey EntityComponentManager::InsertComponent(const Entity _entity,
+    const ComponentTypeId _componentTypeId,
+    const std::function<ComponentId()> &_create)
+{
+  // If type hasn't been instantiated yet, create a storage for it
+  if (!this->HasComponentType(_componentTypeId))
+  {
+    if (!this->dataPtr->CreateComponentStorage(_componentTypeId))
+    {
+      ignerr << "Failed to create component of type [" << _componentTypeId
+             << "] for entity [" << _entity
+             << "]. Type has not been properly registered." << std::endl;
+      return ComponentKey();
+    }
+  }
+
+  // Instantiate the new component.
+  ComponentId componentId = _create();
+
+  ComponentKey componentKey{_componentTypeId, componentId};
+
+  this->dataPtr->entityComponents[_entity].insert(
+      {_componentTypeId, componentKey});
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->changedComponentsMutex);
+    auto &storage = this->dataPtr->MutableStorage(_componentTypeId, this);
+    storage.SetChangeState(componentId, ComponentState::OneTimeChange,
+        this->dataPtr->changeGeneration);
+    storage.LogChange(componentId, _entity, ++this->dataPtr->changeSequence);
+  }
+  this->dataPtr->entityComponentsDirty = true;
+  ++this->dataPtr->layoutGeneration;
+  this->dataPtr->UpdateArchetype(_entity);
+
+  // Component storages never move existing components when new ones are
+  // created, so only the views containing this entity need to be updated.
+  this->dataPtr->QueueViewUpdate(_entity);
+  this->UpdateComponentIndices(_entity, _componentTypeId);
+
+  return componentKey;
+}
+
+/////////////////////////////////////////////////
+std::vector<Entity> EntityComponentManager::CreateEntitiesImplementation(
+    const std::size_t _count,
+    const std::vector<std::pair<ComponentTypeId, std::function<
+        const components::BaseComponent *(std::size_t)>>> &_columns)
+{
+  IGN_PROFILE("EntityComponentManager::CreateEntitiesImplementation");
+  std::vector<Entity> result;
+
+  detail::ComponentTypeKey key;
+  for (const auto &column : _columns)
+  {
+    if (!key.insert(column.first).second)
+    {
+      ignerr << "Failed to create entities, component type ["
+             << column.first << "] was given more than once." << std::endl;
+      return result;
+    }
+
+    if (!this->HasComponentType(column.first) &&
+        !this->dataPtr->CreateComponentStorage(column.first))
+    {
+      ignerr << "Failed to create entities with component of type ["
+             << column.first << "]. Type has not been properly registered."
+             << std::endl;
+      return result;
+    }
+  }
+
+  result.reserve(_count);
+  for (std::size_t i = 0; i < _count; ++i)
+  {
+    const Entity entity = this->dataPtr->NextEntity();
+    if (entity == kNullEntity ||
+        entity == std::numeric_limits<uint64_t>::max())
+    {
+      ignerr << "Only created [" << result.size() << "] of [" << _count
+             << "] entities." << std::endl;
+      break;
+    }
+
+    this->dataPtr->entities.AddVertex(std::to_string(entity), entity, entity);
+    this->dataPtr->hierarchy.AddEntity(entity);
+    result.push_back(entity);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->entityCreatedMutex);
+    this->dataPtr->newlyCreatedEntities.insert(result.begin(), result.end());
+  }
+  this->dataPtr->descendantCache.clear();
+  this->dataPtr->ClearNameCache();
+
+  if (key.empty() || result.empty())
+    return result;
+
+  // Fill one storage at a time.
+  for (const auto &column : _columns)
+  {
+    auto &storage = this->dataPtr->MutableStorage(column.first, this);
+    std::lock_guard<std::mutex> lock(this->dataPtr->changedComponentsMutex);
+    for (std::size_t i = 0; i < result.size(); ++i)
+    {
+      const ComponentId componentId =
+          storage.Create(result[i], column.second(i));
+      this->dataPtr->entityComponents[result[i]].insert(
+          {column.first, {column.first, componentId}});
+      storage.SetChangeState(componentId, ComponentState::OneTimeChange,
+          this->dataPtr->changeGeneration);
+      storage.LogChange(componentId, result[i],
+          ++this->dataPtr->changeSequence);
+    }
+  }
+  this->dataPtr->entityComponentsDirty = true;
+  ++this->dataPtr->layoutGeneration;
+
+  // All the entities share the same archetype.
+  auto archIter = this->dataPtr->FindArchetype(
+      detail::ComponentTypeKey(key));
+  archIter->second.entities.insert(result.begin(), result.end());
+  for (const Entity entity : result)
+    this->dataPtr->entityArchetypes[entity] = archIter;
+
+  // Only views whose types are all in the batch get the new entities.
+  // Views hold const pointers, looked up without copying shared storages.
+  const EntityComponentManager &constThis = *this;
+  for (auto &view : this->dataPtr->views)
+  {
+    if (!std::includes(key.begin(), key.end(), view.first.begin(),
+          view.first.end()))
+    {
+      continue;
+    }
+
+    for (const Entity entity : result)
+    {
+      view.second.AddEntity(entity, true);
+      for (const ComponentTypeId &compTypeId : view.first)
+      {
+        view.second.AddComponent(entity, compTypeId,
+            constThis.ComponentImplementation(entity, compTypeId));
+      }
+    }
+  }
+
+  for (auto &index : this->dataPtr->componentIndices)
+  {
+    if (!std::includes(key.begin(), key.end(), index.types.begin(),
+          index.types.end()))
+    {
+      continue;
+    }
+
+    std::lock_guard<std::mutex> lock(this->dataPtr->componentIndicesMutex);
+    for (const Entity entity : result)
+      this->dataPtr->IndexEntity(index, entity);
   }
 
-  // Add edge
-  auto edge = this->dataPtr->entities.AddEdge({_parent, _child}, true);
-  return (math::graph::kNullId != edge.Id());
+  for (auto &index : this->dataPtr->rangeIndices)
+  {
+    if (!std::binary_search(key.begin(), key.end(), index.type))
+      continue;
+
+    std::lock_guard<std::mutex> lock(this->dataPtr->componentIndicesMutex);
+    for (const Entity entity : result)
+      this->dataPtr->IndexEntity(index, entity);
+  }
+
+  return result;
 }
 
 /////////////////////////////////////////////////
-ComponentKey EntityComponentManager::CreateComponentImplementation(
-    const Entity _entity, const ComponentTypeId _componentTypeId,
-    const components::BaseComponent *_data)
+bool EntityComponentManager::EntityMatches(Entity _entity,
+    const std::set<ComponentTypeId> &_types) const
 {
-  // If type hasn't been instantiated yet, create a storage for it
-  if (!this->HasComponentType(_componentTypeId))
+  bool match{false};
+  if (this->dataPtr->ArchetypeMatches(_entity, _types, match))
+    return match;
+
+  // Entities which aren't in the graph have no archetype.
+  auto iter = this->dataPtr->entityComponents.find(_entity);
+  if (iter == this->dataPtr->entityComponents.end())
+    return false;
+
+  for (const ComponentTypeId &type : _types)
   {
-    if (!this->dataPtr->CreateComponentStorage(_componentTypeId))
+    auto typeIter = iter->second.find(type);
+    if (typeIter == iter->second.end())
+      return false;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+ComponentId EntityComponentManager::EntityComponentIdFromType(
+    const Entity _entity, const ComponentTypeId _type) const
+{
+  auto ecIter = this->dataPtr->entityComponents.find(_entity);
+
+  if (ecIter == this->dataPtr->entityComponents.end())
+    return -1;
+
+  auto typeIter = ecIter->second.find(_type);
+  if (typeIter != ecIter->second.end())
+    return typeIter->second.second;
+
+  return -1;
+}
+
+/////////////////////////////////////////////////
+const components::BaseComponent
+    *EntityComponentManager::ComponentImplementation(
+    const Entity _entity, const ComponentTypeId _type) const
+{
+  IGN_PROFILE("EntityComponentManager::ComponentImplementation");
+  auto ecIter = this->dataPtr->entityComponents.find(_entity);
+
+  if (ecIter == this->dataPtr->entityComponents.end())
+    return nullptr;
+
+  auto typeIter = ecIter->second.find(_type);
+  if (typeIter != ecIter->second.end())
+    return this->dataPtr->components.at(typeIter->second.first)->Component(
+        typeIter->second.second);
+
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+components::BaseComponent *EntityComponentManager::ComponentImplementation(
+    const Entity _entity, const ComponentTypeId _type)
+{
+  auto ecIter = this->dataPtr->entityComponents.find(_entity);
+
+  if (ecIter == this->dataPtr->entityComponents.end())
+    return nullptr;
+
+  // The component may be modified through the pointer.
+  auto typeIter = ecIter->second.find(_type);
+  if (typeIter != ecIter->second.end())
+  {
+    return this->dataPtr->MutableStorage(typeIter->second.first,
+        this).Component(typeIter->second.second);
+  }
+
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+const components::BaseComponent
+    *EntityComponentManager::ComponentImplementation(
+    const ComponentKey &_key) const
+{
+  if (this->dataPtr->components.find(_key.first) !=
+      this->dataPtr->components.end())
+  {
+    return this->dataPtr->components.at(_key.first)->Component(_key.second);
+  }
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+components::BaseComponent *EntityComponentManager::ComponentImplementation(
+    const ComponentKey &_key)
+{
+  if (this->dataPtr->components.find(_key.first) !=
+      this->dataPtr->components.end())
+  {
+    return this->dataPtr->MutableStorage(_key.first, this).Component(
+        _key.second);
+  }
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManager::HasComponentType(
+    const ComponentTypeId _typeId) const
+{
+  return this->dataPtr->components.find(_typeId) !=
+    this->dataPtr->components.end();
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManagerPrivate::CreateComponentStorage(
+    const ComponentTypeId _typeId)
+{
+  auto storage = components::Factory::Instance()->NewStorage(_typeId);
+
+  if (nullptr == storage)
+  {
+    ignerr << "Internal errror: failed to create storage for type [" << _typeId
+           << "]" << std::endl;
+    return false;
+  }
+
+  this->components[_typeId] = std::move(storage);
+  igndbg << "Using components of type [" << _typeId << "] / ["
+         << components::Factory::Instance()->Name(_typeId) << "].\n";
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::UpdateArchetype(const Entity _entity)
+{
+  this->RemoveFromArchetype(_entity);
+
+  // Components may be created for entities which are not in the graph, those
+  // are never part of views.
+  if (this->entities.VertexFromId(_entity).Id() == math::graph::kNullId)
+    return;
+
+  auto ecIter = this->entityComponents.find(_entity);
+  if (ecIter == this->entityComponents.end() || ecIter->second.empty())
+    return;
+
+  detail::ComponentTypeKey key;
+  for (const auto &comp : ecIter->second)
+    key.insert(comp.first);
+
+  auto archIter = this->FindArchetype(std::move(key));
+  archIter->second.entities.insert(_entity);
+  this->entityArchetypes[_entity] = archIter;
+}
+
+/////////////////////////////////////////////////
+ArchetypeMap::iterator EntityComponentManagerPrivate::FindArchetype(
+    detail::ComponentTypeKey &&_types)
+{
+  auto inserted = this->archetypes.emplace(std::move(_types), Archetype());
+  if (inserted.second)
+  {
+    inserted.first->second.signature =
+        this->NewSignature(inserted.first->first);
+  }
+  return inserted.first;
+}
+
+/////////////////////////////////////////////////
+bool EntityComponentManagerPrivate::ArchetypeMatches(const Entity _entity,
+    const std::set<ComponentTypeId> &_types, bool &_match) const
+{
+  auto iter = this->entityArchetypes.find(_entity);
+  if (iter == this->entityArchetypes.end())
+    return false;
+
+  // Types without a bit aren't part of any archetype.
+  const ComponentSignature &signature = iter->second->second.signature;
+  _match = true;
+  for (const ComponentTypeId type : _types)
+  {
+    auto bitIter = this->typeBits.find(type);
+    if (bitIter == this->typeBits.end() ||
+        !HasSignatureBit(signature, bitIter->second))
     {
-      ignerr << "Failed to create component of type [" << _componentTypeId
-             << "] for entity [" << _entity
-             << "]. Type has not been properly registered." << std::endl;
-      return ComponentKey();
+      _match = false;
+      break;
+    }
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::RemoveFromArchetype(const Entity _entity)
+{
+  auto iter = this->entityArchetypes.find(_entity);
+  if (iter == this->entityArchetypes.end())
+    return;
+
+  iter->second->second.entities.erase(_entity);
+  if (iter->second->second.entities.empty())
+    this->archetypes.erase(iter->second);
+
+  this->entityArchetypes.erase(iter);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::RefreshViews(const ComponentTypeId _typeId,
+    const EntityComponentManager *_ecm)
+{
+  IGN_PROFILE("EntityComponentManager::RefreshViews");
+  for (auto &view : this->views)
+  {
+    if (view.first.find(_typeId) != view.first.end())
+      view.second.RefreshComponents(_typeId, _ecm);
+  }
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::RefreshViews(const ComponentTypeId _typeId,
+    const std::vector<Entity> &_entities, const EntityComponentManager *_ecm)
+{
+  IGN_PROFILE("EntityComponentManager::RefreshViews");
+  for (auto &view : this->views)
+  {
+    if (view.first.find(_typeId) == view.first.end())
+      continue;
+
+    for (const Entity entity : _entities)
+    {
+      view.second.AddComponent(entity, _typeId,
+          _ecm->ComponentImplementation(entity, _typeId));
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+ComponentStorageBase &EntityComponentManagerPrivate::MutableStorage(
+    const ComponentTypeId _typeId, const EntityComponentManager *_ecm)
+{
+  auto &storage = this->components.at(_typeId);
+  if (storage.use_count() == 1)
+  {
+    // Forks which shared the storage released it after their last read.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return *storage;
+  }
+
+  IGN_PROFILE("EntityComponentManager::MutableStorage Copy");
+  std::shared_ptr<ComponentStorageBase> copy = storage->Clone();
+  if (nullptr == copy)
+  {
+    if (this->uncopyableTypes.insert(_typeId).second)
+    {
+      ignerr << "Components of type [" << _typeId << "] / ["
+             << components::Factory::Instance()->Name(_typeId)
+             << "] can't be copied, so changes to them are seen by all "
+             << "forked entity component managers." << std::endl;
+    }
+    return *storage;
+  }
+
+  copy->SetReadOnly(this->readOnly);
+  storage = std::move(copy);
+  ++this->layoutGeneration;
+  this->RefreshViews(_typeId, _ecm);
+  return *storage;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::IndexEntity(ComponentIndex &_index,
+    const Entity _entity)
+{
+  UnindexEntity(_index, _entity);
+
+  auto ecIter = this->entityComponents.find(_entity);
+  if (ecIter == this->entityComponents.end())
+    return;
+
+  std::size_t hash{0};
+  for (std::size_t i = 0; i < _index.types.size(); ++i)
+  {
+    auto typeIter = ecIter->second.find(_index.types[i]);
+    if (typeIter == ecIter->second.end())
+      return;
+
+    const components::BaseComponent *comp =
+        this->components.at(typeIter->second.first)->Component(
+        typeIter->second.second);
+    if (nullptr == comp)
+      return;
+
+    hash = CombineHash(hash, _index.hashers[i](*comp));
+  }
+
+  _index.entities.emplace(hash, _entity);
+  _index.hashes[_entity] = hash;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::UnindexEntity(ComponentIndex &_index,
+    const Entity _entity)
+{
+  auto hashIter = _index.hashes.find(_entity);
+  if (hashIter == _index.hashes.end())
+    return;
+
+  auto range = _index.entities.equal_range(hashIter->second);
+  for (auto iter = range.first; iter != range.second; ++iter)
+  {
+    if (iter->second == _entity)
+    {
+      _index.entities.erase(iter);
+      break;
+    }
+  }
+  _index.hashes.erase(hashIter);
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::IndexEntity(RangeIndex &_index,
+    const Entity _entity)
+{
+  UnindexEntity(_index, _entity);
+
+  auto ecIter = this->entityComponents.find(_entity);
+  if (ecIter == this->entityComponents.end())
+    return;
+
+  auto typeIter = ecIter->second.find(_index.type);
+  if (typeIter == ecIter->second.end())
+    return;
+
+  const components::BaseComponent *comp =
+      this->components.at(typeIter->second.first)->Component(
+      typeIter->second.second);
+  if (nullptr == comp)
+    return;
+
+  const double key = _index.key(*comp);
+  if (std::isnan(key))
+    return;
+
+  _index.entities.emplace(key, _entity);
+  _index.keys[_entity] = key;
+}
+
+/////////////////////////////////////////////////
+void EntityComponentManagerPrivate::UnindexEntity(RangeIndex &_index,
+    const Entity _entity)
+{
+  auto keyIter = _index.keys.find(_entity);
+  if (keyIter == _index.keys.end())
+    return;
+
+  auto range = _index.entities.equal_range(keyIter->second);
+  for (auto iter = range.first; iter != range.second; ++iter)
+  {
+    if (iter->second == _entity)
+    {
+      _index.entities.erase(iter);
+      break;
     }
   }
+  _index.keys.erase(keyIter);
+}
 
-  // Instantiate the new component.
-  std::pair<ComponentId, bool> componentIdPair =
-    this->dataPtr->components[_componentTypeId]->Create(_data);
-
-  ComponentKey componentKey{_componentTypeId, componentIdPair.first};
+/////////////////////////////////////////////////
+void EntityComponentManager::EnableComponentIndexImplementation(
+    const std::map<ComponentTypeId, ComponentHasher> &_hashers)
+{
+  IGN_PROFILE("EntityComponentManager::EnableComponentIndex");
+  ComponentIndex index;
+  for (const auto &hasher : _hashers)
+  {
+    index.types.push_back(hasher.first);
+    index.hashers.push_back(hasher.second);
+  }
 
-  this->dataPtr->entityComponents[_entity].insert(
-      {_componentTypeId, componentKey});
-  this->dataPtr->oneTimeChangedComponents.insert(componentKey);
-  this->dataPtr->entityComponentsDirty = true;
+  std::lock_guard<std::mutex> lock(this->dataPtr->componentIndicesMutex);
+  for (const auto &existing : this->dataPtr->componentIndices)
+  {
+    if (existing.types == index.types)
+      return;
+  }
 
-  if (componentIdPair.second)
-    this->RebuildViews();
-  else
-    this->UpdateViews(_entity);
+  // Index the entities which already have all the types.
+  const detail::ComponentTypeKey types(index.types.begin(),
+      index.types.end());
+  for (const Entity entity : this->ArchetypeEntities(types))
+    this->dataPtr->IndexEntity(index, entity);
 
-  return componentKey;
+  this->dataPtr->componentIndices.push_back(std::move(index));
 }
 
 /////////////////////////////////////////////////
-bool EntityComponentManager::EntityMatches(Entity _entity,
-    const std::set<ComponentTypeId> &_types) const
+bool EntityComponentManager::IndexedEntitiesImplementation(
+    const std::map<ComponentTypeId, std::size_t> &_hashes,
+    std::vector<Entity> &_entities) const
 {
-  auto iter = this->dataPtr->entityComponents.find(_entity);
-  if (iter == this->dataPtr->entityComponents.end())
-    return false;
+  auto lock = this->dataPtr->ReadLock(this->dataPtr->componentIndicesMutex);
 
-  // \todo(nkoenig) The performance of this could be improved.
-  // It might be possible to create bitmask for component sets.
-  // Fixing this might not be high priority, unless we expect frequent
-  // creation of entities and/or queries.
-  for (const ComponentTypeId &type : _types)
+  // Use the index covering the most of the given types.
+  const ComponentIndex *best{nullptr};
+  for (const auto &index : this->dataPtr->componentIndices)
   {
-    auto typeIter = iter->second.find(type);
-    if (typeIter == iter->second.end())
-      return false;
+    if (nullptr != best && best->types.size() >= index.types.size())
+      continue;
+
+    bool covered = std::all_of(index.types.begin(), index.types.end(),
+        [&](const ComponentTypeId _type)
+        {
+          return _hashes.find(_type) != _hashes.end();
+        });
+    if (covered)
+      best = &index;
   }
 
+  if (nullptr == best)
+    return false;
+
+  std::size_t hash{0};
+  for (const ComponentTypeId type : best->types)
+    hash = CombineHash(hash, _hashes.at(type));
+
+  auto range = best->entities.equal_range(hash);
+  for (auto iter = range.first; iter != range.second; ++iter)
+    _entities.push_back(iter->second);
+
+  // Match the order in which views visit entities.
+  std::sort(_entities.begin(), _entities.end());
   return true;
 }
 
 /////////////////////////////////////////////////
-ComponentId EntityComponentManager::EntityComponentIdFromType(
-    const Entity _entity, const ComponentTypeId _type) const
+void EntityComponentManager::EnableRangeIndexImplementation(
+    const ComponentTypeId _typeId, const std::string &_field,
+    const ComponentKey &_key)
 {
-  auto ecIter = this->dataPtr->entityComponents.find(_entity);
+  IGN_PROFILE("EntityComponentManager::EnableRangeIndex");
+  std::lock_guard<std::mutex> lock(this->dataPtr->componentIndicesMutex);
+  for (const auto &existing : this->dataPtr->rangeIndices)
+  {
+    if (existing.type == _typeId && existing.field == _field)
+      return;
+  }
 
-  if (ecIter == this->dataPtr->entityComponents.end())
-    return -1;
+  RangeIndex index;
+  index.type = _typeId;
+  index.field = _field;
+  index.key = _key;
 
-  auto typeIter = ecIter->second.find(_type);
-  if (typeIter != ecIter->second.end())
-    return typeIter->second.second;
+  // Index the entities which already have the type.
+  for (const Entity entity : this->ArchetypeEntities({_typeId}))
+    this->dataPtr->IndexEntity(index, entity);
 
-  return -1;
+  this->dataPtr->rangeIndices.push_back(std::move(index));
 }
 
 /////////////////////////////////////////////////
-const components::BaseComponent
-    *EntityComponentManager::ComponentImplementation(
-    const Entity _entity, const ComponentTypeId _type) const
+std::vector<Entity> EntityComponentManager::EntitiesInRangeImplementation(
+    const ComponentTypeId _typeId, const std::string &_field,
+    double _min, double _max) const
 {
-  IGN_PROFILE("EntityComponentManager::ComponentImplementation");
-  auto ecIter = this->dataPtr->entityComponents.find(_entity);
+  IGN_PROFILE("EntityComponentManager::EntitiesInRange");
+  std::vector<Entity> result;
+  auto lock = this->dataPtr->ReadLock(this->dataPtr->componentIndicesMutex);
+  for (const auto &index : this->dataPtr->rangeIndices)
+  {
+    if (index.type != _typeId || index.field != _field)
+      continue;
 
-  if (ecIter == this->dataPtr->entityComponents.end())
-    return nullptr;
+    if (!(_min < _max))
+      return result;
 
-  auto typeIter = ecIter->second.find(_type);
-  if (typeIter != ecIter->second.end())
-    return this->dataPtr->components.at(typeIter->second.first)->Component(
-        typeIter->second.second);
+    auto end = index.entities.lower_bound(_max);
+    for (auto iter = index.entities.lower_bound(_min); iter != end; ++iter)
+      result.push_back(iter->second);
+    return result;
+  }
 
-  return nullptr;
+  ignerr << "No range index of field [" << _field << "] of component type ["
+         << _typeId << "], see EnableRangeIndex." << std::endl;
+  return result;
 }
 
 /////////////////////////////////////////////////
-components::BaseComponent *EntityComponentManager::ComponentImplementation(
-    const Entity _entity, const ComponentTypeId _type)
+void EntityComponentManager::UpdateComponentIndices(const Entity _entity,
+    const ComponentTypeId _typeId)
 {
-  auto ecIter = this->dataPtr->entityComponents.find(_entity);
+  // Scoped names and top level models are found through these
+  if (_typeId == components::Name::typeId ||
+      _typeId == components::ParentEntity::typeId)
+  {
+    this->dataPtr->ClearNameCache();
+  }
 
-  if (ecIter == this->dataPtr->entityComponents.end())
-    return nullptr;
+  // Indices are only added while setting up, so their types can be checked
+  // without locking.
+  for (auto &index : this->dataPtr->componentIndices)
+  {
+    if (!std::binary_search(index.types.begin(), index.types.end(),
+          _typeId))
+    {
+      continue;
+    }
 
-  auto typeIter = ecIter->second.find(_type);
-  if (typeIter != ecIter->second.end())
-    return this->dataPtr->components.at(typeIter->second.first)->Component(
-        typeIter->second.second);
+    std::lock_guard<std::mutex> lock(this->dataPtr->componentIndicesMutex);
+    this->dataPtr->IndexEntity(index, _entity);
+  }
 
-  return nullptr;
+  for (auto &index : this->dataPtr->rangeIndices)
+  {
+    if (index.type != _typeId)
+      continue;
+
+    std::lock_guard<std::mutex> lock(this->dataPtr->componentIndicesMutex);
+    this->dataPtr->IndexEntity(index, _entity);
+  }
 }
 
 /////////////////////////////////////////////////
-const components::BaseComponent
-    *EntityComponentManager::ComponentImplementation(
-    const ComponentKey &_key) const
+void EntityComponentManager::SetReadOnly(const bool _readOnly)
 {
-  if (this->dataPtr->components.find(_key.first) !=
-      this->dataPtr->components.end())
+  // Views may be used in parallel while read-only, so they must be up to
+  // date before.
+  if (_readOnly)
+    this->UpdateViews();
+
+  this->dataPtr->readOnly = _readOnly;
+  for (auto &storage : this->dataPtr->components)
+    storage.second->SetReadOnly(_readOnly);
+
+  if (!_readOnly)
   {
-    return this->dataPtr->components.at(_key.first)->Component(_key.second);
+    // Moving the nodes keeps references to the views valid.
+    std::lock_guard<std::mutex> lockViews(this->dataPtr->viewsMutex);
+    this->dataPtr->views.merge(this->dataPtr->pendingViews);
+    this->dataPtr->pendingViews.clear();
   }
-  return nullptr;
 }
 
 /////////////////////////////////////////////////
-components::BaseComponent *EntityComponentManager::ComponentImplementation(
-    const ComponentKey &_key)
+void EntityComponentManager::SetConcurrent(const bool _concurrent)
 {
-  if (this->dataPtr->components.find(_key.first) !=
-      this->dataPtr->components.end())
+  // Views are updated once here instead of by the first accessor of each
+  // system, which would update them from several threads.
+  this->UpdateViews();
+  this->dataPtr->concurrent = _concurrent;
+
+  if (!_concurrent)
   {
-    return this->dataPtr->components.at(_key.first)->Component(_key.second);
+    std::lock_guard<std::mutex> lockViews(this->dataPtr->viewsMutex);
+    this->dataPtr->views.merge(this->dataPtr->pendingViews);
+    this->dataPtr->pendingViews.clear();
   }
-  return nullptr;
 }
 
 /////////////////////////////////////////////////
-bool EntityComponentManager::HasComponentType(
-    const ComponentTypeId _typeId) const
+void EntityComponentManager::SetTaskPool(TaskPool *_pool)
 {
-  return this->dataPtr->components.find(_typeId) !=
-    this->dataPtr->components.end();
+  this->dataPtr->taskPool = _pool;
 }
 
 /////////////////////////////////////////////////
-bool EntityComponentManagerPrivate::CreateComponentStorage(
-    const ComponentTypeId _typeId)
+void EntityComponentManager::SetDeterministic(bool _deterministic)
 {
-  auto storage = components::Factory::Instance()->NewStorage(_typeId);
+  this->dataPtr->deterministic = _deterministic;
+}
 
-  if (nullptr == storage)
+/////////////////////////////////////////////////
+void EntityComponentManager::ParallelFor(std::size_t _count,
+    std::size_t _minChunkSize,
+    const std::function<void(std::size_t, std::size_t)> &_f) const
+{
+  IGN_PROFILE("EntityComponentManager::ParallelFor");
+  _minChunkSize = std::max<std::size_t>(_minChunkSize, 1);
+
+  // Not worth waking up other threads.
+  if (_count <= _minChunkSize)
   {
-    ignerr << "Internal errror: failed to create storage for type [" << _typeId
-           << "]" << std::endl;
-    return false;
+    _f(0, _count);
+    return;
   }
 
-  this->components[_typeId] = std::move(storage);
-  igndbg << "Using components of type [" << _typeId << "] / ["
-         << components::Factory::Instance()->Name(_typeId) << "].\n";
+  // A few chunks per thread, so threads which finish early can pick up the
+  // remaining work. Deterministic chunks only depend on the minimum size.
+  TaskPool &pool = this->dataPtr->Pool();
+  std::size_t chunkSize = _minChunkSize;
+  std::size_t chunkCount = (_count + chunkSize - 1) / chunkSize;
+  if (!this->dataPtr->deterministic)
+  {
+    const std::size_t maxChunks = 4 * (pool.ThreadCount() + 1);
+    chunkCount = std::min(maxChunks, chunkCount);
+    chunkSize = (_count + chunkCount - 1) / chunkCount;
+  }
 
-  return true;
+  pool.ParallelFor(chunkCount, [&](std::size_t _chunk)
+  {
+    const std::size_t begin = _chunk * chunkSize;
+    const std::size_t end = std::min(_count, begin + chunkSize);
+    if (begin < end)
+      _f(begin, end);
+  });
+}
+
+/////////////////////////////////////////////////
+std::vector<Entity> EntityComponentManager::ArchetypeEntities(
+    const detail::ComponentTypeKey &_types) const
+{
+  IGN_PROFILE("EntityComponentManager::ArchetypeEntities");
+  std::vector<Entity> result;
+  // Views may be built while read-only, so no bits are given to new types.
+  ComponentSignature signature;
+  if (!this->dataPtr->Signature(_types, signature))
+    return result;
+
+  for (const auto &archetype : this->dataPtr->archetypes)
+  {
+    if (SignatureIncludes(archetype.second.signature, signature))
+    {
+      result.insert(result.end(), archetype.second.entities.begin(),
+          archetype.second.entities.end());
+    }
+  }
+  return result;
 }
 
 /////////////////////////////////////////////////
 components::BaseComponent *EntityComponentManager::First(
     const ComponentTypeId _componentTypeId)
 {
-  auto iter = this->dataPtr->components.find(_componentTypeId);
-  if (iter != this->dataPtr->components.end())
+  if (this->dataPtr->components.find(_componentTypeId) !=
+      this->dataPtr->components.end())
   {
-    return iter->second->First();
+    return this->dataPtr->MutableStorage(_componentTypeId, this).First();
   }
   return nullptr;
 }
@@ -697,11 +2617,69 @@ const EntityGraph &EntityComponentManager::Entities() const
 bool EntityComponentManager::FindView(const std::set<ComponentTypeId> &_types,
     std::map<detail::ComponentTypeKey, detail::View>::iterator &_iter) const
 {
+  // No view is added to the main map while read-only or concurrent, so only
+  // the views created meanwhile need locking.
+  if (this->dataPtr->readOnly || this->dataPtr->concurrent)
+  {
+    // Views were updated before, see SetReadOnly and SetConcurrent.
+    _iter = this->dataPtr->views.find(_types);
+    if (_iter != this->dataPtr->views.end())
+      return true;
+
+    std::lock_guard<std::mutex> lockViews(this->dataPtr->viewsMutex);
+    _iter = this->dataPtr->pendingViews.find(_types);
+    return _iter != this->dataPtr->pendingViews.end();
+  }
+
+  // New views are built from the current components, so the existing ones
+  // must be up to date too.
+  this->UpdateViews();
+
   std::lock_guard<std::mutex> lockViews(this->dataPtr->viewsMutex);
   _iter = this->dataPtr->views.find(_types);
   return _iter != this->dataPtr->views.end();
 }
 
+//////////////////////////////////////////////////
+std::size_t EntityComponentManager::NewViewSlot()
+{
+  static std::atomic<std::size_t> slotCount{0};
+  return slotCount++;
+}
+
+//////////////////////////////////////////////////
+detail::View *EntityComponentManager::CachedView(const std::size_t _slot)
+    const
+{
+  if (_slot >= EntityComponentManagerPrivate::kViewSlotCount)
+    return nullptr;
+  detail::View *view =
+      this->dataPtr->viewSlots[_slot].load(std::memory_order_acquire);
+  if (nullptr == view)
+    return nullptr;
+
+  // Nothing is queued while read-only, see SetReadOnly, and views aren't
+  // updated while concurrent, see SetConcurrent.
+  if (!this->dataPtr->readOnly && !this->dataPtr->concurrent &&
+      !this->dataPtr->viewUpdates.empty())
+  {
+    this->UpdateViews();
+  }
+  view->usage.Mark(this->dataPtr->changeGeneration);
+  return view;
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::CacheView(const std::size_t _slot,
+    detail::View *_view) const
+{
+  // Views beyond the slots are searched every time, and cached right after.
+  _view->usage.Mark(this->dataPtr->changeGeneration);
+  if (_slot >= EntityComponentManagerPrivate::kViewSlotCount)
+    return;
+  this->dataPtr->viewSlots[_slot].store(_view, std::memory_order_release);
+}
+
 //////////////////////////////////////////////////
 std::map<detail::ComponentTypeKey, detail::View>::iterator
     EntityComponentManager::AddView(const std::set<ComponentTypeId> &_types,
@@ -710,69 +2688,116 @@ std::map<detail::ComponentTypeKey, detail::View>::iterator
   // If the view already exists, then the map will return the iterator to
   // the location that prevented the insertion.
   std::lock_guard<std::mutex> lockViews(this->dataPtr->viewsMutex);
-  return this->dataPtr->views.insert(
-      std::make_pair(_types, std::move(_view))).first;
+  auto &views = this->dataPtr->readOnly || this->dataPtr->concurrent ?
+      this->dataPtr->pendingViews : this->dataPtr->views;
+  return views.insert(std::make_pair(_types, std::move(_view))).first;
 }
 
 //////////////////////////////////////////////////
-void EntityComponentManager::UpdateViews(const Entity _entity)
+void EntityComponentManager::UpdateViews() const
 {
+  auto &queued = this->dataPtr->viewUpdates;
+  if (queued.empty())
+    return;
+
   IGN_PROFILE("EntityComponentManager::UpdateViews");
+  std::sort(queued.begin(), queued.end());
+  queued.erase(std::unique(queued.begin(), queued.end()), queued.end());
+
+  struct ViewSignature
+  {
+    detail::View *view;
+    ComponentSignature signature;
+  };
+  std::vector<ViewSignature> views;
+  views.reserve(this->dataPtr->views.size());
   for (auto &view : this->dataPtr->views)
   {
-    // Add/update the entity if it matches the view.
-    if (this->EntityMatches(_entity, view.first))
+    views.push_back({&view.second, this->dataPtr->NewSignature(view.first)});
+  }
+
+  // Entities are matched against views once per archetype, and visited in
+  // order so they're appended to the views.
+  const Archetype *archetype{nullptr};
+  std::vector<char> matches(views.size(), 0);
+
+  // Entities which don't match a view anymore are removed from it at once,
+  // in the sorted order they're visited.
+  std::vector<std::vector<Entity>> removals(views.size());
+  for (const Entity entity : queued)
+  {
+    auto archIter = this->dataPtr->entityArchetypes.find(entity);
+    const Archetype *entityArchetype =
+        archIter == this->dataPtr->entityArchetypes.end() ?
+        nullptr : &archIter->second->second;
+    if (entityArchetype != archetype || archetype == nullptr)
     {
-      view.second.AddEntity(_entity, this->IsNewEntity(_entity));
-      // If there is a request to delete this entity, update the view as
-      // well
-      if (this->IsMarkedForRemoval(_entity))
-      {
-        view.second.AddEntityToRemoved(_entity);
-      }
-      for (const ComponentTypeId &compTypeId : view.first)
+      archetype = entityArchetype;
+      for (std::size_t i = 0; i < views.size(); ++i)
       {
-        view.second.AddComponent(_entity, compTypeId,
-            this->EntityComponentIdFromType(_entity, compTypeId));
+        matches[i] = nullptr != archetype &&
+            SignatureIncludes(archetype->signature, views[i].signature);
       }
     }
-    else
+
+    const bool isNew = this->IsNewEntity(entity);
+    const bool toRemove = this->IsMarkedForRemoval(entity);
+    for (std::size_t i = 0; i < views.size(); ++i)
     {
-      view.second.RemoveEntity(_entity, view.first);
+      detail::View &view = *views[i].view;
+      if (!matches[i])
+      {
+        removals[i].push_back(entity);
+        continue;
+      }
+
+      view.AddEntity(entity, isNew);
+      // If there is a request to delete this entity, update the view as
+      // well
+      if (toRemove)
+        view.AddEntityToRemoved(entity);
+      for (const ComponentTypeId &compTypeId : view.types)
+      {
+        view.AddComponent(entity, compTypeId,
+            this->ComponentImplementation(entity, compTypeId));
+      }
     }
   }
+
+  for (std::size_t i = 0; i < views.size(); ++i)
+    views[i].view->RemoveEntities(removals[i]);
+  queued.clear();
 }
 
 //////////////////////////////////////////////////
 void EntityComponentManager::RebuildViews()
 {
   IGN_PROFILE("EntityComponentManager::RebuildViews");
+  this->dataPtr->viewUpdates.clear();
+  // Views hold const pointers, looked up without copying shared storages.
+  const EntityComponentManager &constThis = *this;
   for (auto &view : this->dataPtr->views)
   {
-    view.second.entities.clear();
-    view.second.components.clear();
+    view.second.Clear();
     // Add all the entities that match the component types to the
-    // view.
-    for (const auto &vertex : this->dataPtr->entities.Vertices())
+    // view. Entities are sorted first so they're appended in order.
+    std::vector<Entity> entities = this->ArchetypeEntities(view.first);
+    std::sort(entities.begin(), entities.end());
+    for (const Entity entity : entities)
     {
-      Entity entity = vertex.first;
-      if (this->EntityMatches(entity, view.first))
+      view.second.AddEntity(entity, this->IsNewEntity(entity));
+      // If there is a request to delete this entity, update the view as
+      // well
+      if (this->IsMarkedForRemoval(entity))
       {
-        view.second.AddEntity(entity, this->IsNewEntity(entity));
-        // If there is a request to delete this entity, update the view as
-        // well
-        if (this->IsMarkedForRemoval(entity))
-        {
-          view.second.AddEntityToRemoved(entity);
-        }
-        // Store pointers to all the components. This recursively adds
-        // all the ComponentTypeTs that belong to the entity to the view.
-        for (const ComponentTypeId &compTypeId : view.first)
-        {
-          view.second.AddComponent(entity, compTypeId,
-              this->EntityComponentIdFromType(
-                entity, compTypeId));
-        }
+        view.second.AddEntityToRemoved(entity);
+      }
+      // Store pointers to all the components. This recursively adds
+      // all the ComponentTypeTs that belong to the entity to the view.
+      for (const ComponentTypeId &compTypeId : view.first)
+      {
+        view.second.AddComponent(entity, compTypeId,
+            constThis.ComponentImplementation(entity, compTypeId));
       }
     }
   }
@@ -891,10 +2916,7 @@ void EntityComponentManager::AddEntityToMessage(msgs::SerializedState &_msg,
     auto compBase = this->ComponentImplementation(_entity, comp.first);
     compMsg->set_type(compBase->TypeId());
 
-    std::ostringstream ostr;
-    compBase->Serialize(ostr);
-
-    compMsg->set_component(ostr.str());
+    compBase->SerializeToBuffer(*compMsg->mutable_component());
   }
 
   // Add a component to the message and set it to be removed if the component
@@ -959,10 +2981,8 @@ void EntityComponentManager::AddEntityToMessage(msgs::SerializedStateMap &_msg,
 
     // If not sending full state, skip unchanged components
     if (!_full &&
-        this->dataPtr->oneTimeChangedComponents.find(comp) ==
-        this->dataPtr->oneTimeChangedComponents.end() &&
-        this->dataPtr->periodicChangedComponents.find(comp) ==
-        this->dataPtr->periodicChangedComponents.end())
+        this->dataPtr->components.at(comp.first)->ChangeState(comp.second) ==
+        ComponentState::NoChange)
     {
       continue;
     }
@@ -993,10 +3013,8 @@ void EntityComponentManager::AddEntityToMessage(msgs::SerializedStateMap &_msg,
       compIter = entIter->second.mutable_components()->find(comp.first);
     }
 
-    // Serialize and store the message
-    std::ostringstream ostr;
-    compBase->Serialize(ostr);
-    compIter->second.set_component(ostr.str());
+    // Serialize straight into the message, reusing its buffer
+    compBase->SerializeToBuffer(*compIter->second.mutable_component());
   }
 
   // Add a component to the message and set it to be removed if the component
@@ -1048,47 +3066,15 @@ void EntityComponentManager::ChangedState(
 //////////////////////////////////////////////////
 void EntityComponentManagerPrivate::CalculateStateThreadLoad()
 {
-  // If the entity component vector is dirty, we need to recalculate the
-  // threads and each threads work load
   if (!this->entityComponentsDirty)
     return;
 
   this->entityComponentsDirty = false;
-  this->entityComponentIterators.clear();
-  auto startIt = this->entityComponents.begin();
-  int numComponents = this->entityComponents.size();
-
-  // Set the number of threads to spawn to the min of the calculated thread
-  // count or max threads that the hardware supports
-  int maxThreads = std::thread::hardware_concurrency();
-  uint64_t numThreads = std::min(numComponents, maxThreads);
-
-  int componentsPerThread = std::ceil(static_cast<double>(numComponents) /
-    numThreads);
-
-  igndbg << "Updated state thread iterators: " << numThreads
-         << " threads processing around " << componentsPerThread
-         << " components each." << std::endl;
-
-  // Push back the starting iterator
-  this->entityComponentIterators.push_back(startIt);
-  for (uint64_t i = 0; i < numThreads; ++i)
-  {
-    // If we have added all of the components to the iterator vector, we are
-    // done so push back the end iterator
-    numComponents -= componentsPerThread;
-    if (numComponents <= 0)
-    {
-      this->entityComponentIterators.push_back(
-          this->entityComponents.end());
-      break;
-    }
-
-    // Get the iterator to the next starting group of components
-    auto nextIt = std::next(startIt, componentsPerThread);
-    this->entityComponentIterators.push_back(nextIt);
-    startIt = nextIt;
-  }
+  this->stateEntities.clear();
+  this->stateEntities.reserve(this->entityComponents.size());
+  for (const auto &entityComponent : this->entityComponents)
+    this->stateEntities.push_back(entityComponent.first);
+  std::sort(this->stateEntities.begin(), this->stateEntities.end());
 }
 
 //////////////////////////////////////////////////
@@ -1118,45 +3104,232 @@ void EntityComponentManager::State(
     const std::unordered_set<ComponentTypeId> &_types,
     bool _full) const
 {
+  IGN_PROFILE("EntityComponentManager::State");
+
+  // Below this many entities per task, serializing is cheaper than waking
+  // up other threads
+  constexpr std::size_t kMinEntitiesPerTask{64};
+
+  this->dataPtr->CalculateStateThreadLoad();
+  const std::vector<Entity> *entities = &this->dataPtr->stateEntities;
+
+  // Only visit the requested entities if there are fewer of them
+  std::vector<Entity> requested;
+  if (!_entities.empty() && _entities.size() < entities->size())
+  {
+    for (const Entity entity : _entities)
+    {
+      if (this->dataPtr->entityComponents.find(entity) !=
+          this->dataPtr->entityComponents.end())
+      {
+        requested.push_back(entity);
+      }
+    }
+    std::sort(requested.begin(), requested.end());
+    entities = &requested;
+  }
+
+  auto included = [&](const Entity _entity)
+  {
+    return _entities.empty() || _entities.find(_entity) != _entities.end();
+  };
+
+  // Small states are serialized straight into the message
+  if (entities->size() <= kMinEntitiesPerTask)
+  {
+    for (const Entity entity : *entities)
+    {
+      if (included(entity))
+        this->AddEntityToMessage(_state, entity, _types, _full);
+    }
+    return;
+  }
+
+  // Otherwise each task serializes a range of entities into its own
+  // message, which is then merged
   std::mutex stateMapMutex;
-  std::vector<std::thread> workers;
+  this->ParallelFor(entities->size(), kMinEntitiesPerTask,
+      [&](std::size_t _begin, std::size_t _end)
+  {
+    msgs::SerializedStateMap threadMap;
+    for (std::size_t i = _begin; i < _end; ++i)
+    {
+      if (included((*entities)[i]))
+        this->AddEntityToMessage(threadMap, (*entities)[i], _types, _full);
+    }
+
+    std::lock_guard<std::mutex> lock(stateMapMutex);
+    for (auto &entity : *threadMap.mutable_entities())
+    {
+      (*_state.mutable_entities())[entity.first].Swap(&entity.second);
+    }
+  });
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::RebuildState(
+    msgs::SerializedStateMap &_state,
+    const std::unordered_set<Entity> &_entities,
+    const std::unordered_set<ComponentTypeId> &_types,
+    bool _full, uint64_t _sinceGeneration, bool _includeStatic) const
+{
+  IGN_PROFILE("EntityComponentManager::RebuildState");
+  std::lock_guard<std::mutex> scratchLock(this->dataPtr->rebuildStateMutex);
+  auto &jobs = this->dataPtr->rebuildStateJobs;
+  auto &keptEntities = this->dataPtr->rebuildStateEntities;
+  auto &keptTypes = this->dataPtr->rebuildStateTypes;
+  jobs.clear();
+  keptEntities.clear();
+
+  // Entities whose archetype has none of the types are skipped, and the
+  // components of those whose types are all included aren't checked one by
+  // one. Types without a bit aren't in any archetype.
+  ComponentSignature typesSignature;
+  for (const ComponentTypeId type : _types)
+  {
+    auto bitIter = this->dataPtr->typeBits.find(type);
+    if (bitIter != this->dataPtr->typeBits.end())
+      SetSignatureBit(typesSignature, bitIter->second);
+  }
+
+  auto &entitiesMsg = *_state.mutable_entities();
+  for (const auto &entityIter : this->dataPtr->entityComponents)
+  {
+    const Entity entity = entityIter.first;
+    if (!_entities.empty() && _entities.find(entity) == _entities.end())
+      continue;
+
+    bool filterTypes = !_types.empty();
+    bool anyType = true;
+    if (filterTypes)
+    {
+      auto archIter = this->dataPtr->entityArchetypes.find(entity);
+      if (archIter != this->dataPtr->entityArchetypes.end())
+      {
+        const auto &signature = archIter->second->second.signature;
+        anyType = SignaturesIntersect(signature, typesSignature);
+        filterTypes = !SignatureIncludes(typesSignature, signature);
+      }
+    }
+
+    // Entries left from the previous state are overwritten in place, so
+    // their memory is reused. New entries are only added when needed.
+    auto msgIter = entitiesMsg.find(entity);
+    msgs::SerializedEntityMap *entityMsg =
+        msgIter == entitiesMsg.end() ? nullptr : &msgIter->second;
+    auto entityEntry = [&]() -> msgs::SerializedEntityMap &
+    {
+      if (nullptr == entityMsg)
+      {
+        entityMsg = &entitiesMsg[static_cast<uint64_t>(entity)];
+        entityMsg->set_id(entity);
+      }
+      return *entityMsg;
+    };
+
+    const bool removed = this->dataPtr->toRemoveEntities.find(entity) !=
+        this->dataPtr->toRemoveEntities.end();
+    if (!_includeStatic && !removed && this->IsStatic(entity))
+      continue;
+
+    if (removed)
+      entityEntry().set_remove(true);
+    else if (nullptr != entityMsg)
+      entityMsg->set_remove(false);
 
-  this->dataPtr->CalculateStateThreadLoad();
+    keptTypes.clear();
+    for (const auto &typeIter : entityIter.second)
+    {
+      if (!anyType)
+        break;
+
+      const ComponentTypeId type = typeIter.first;
+      if (filterTypes && _types.find(type) == _types.end())
+        continue;
+
+      // If not sending full state, skip unchanged components
+      const ComponentKey &key = typeIter.second;
+      if (!_full)
+      {
+        const auto &storage = this->dataPtr->components.at(key.first);
+        if (_sinceGeneration > 0 ?
+            storage->ChangeGeneration(key.second) < _sinceGeneration :
+            storage->ChangeState(key.second) == ComponentState::NoChange)
+        {
+          continue;
+        }
+      }
+
+      auto &compMsg = (*entityEntry().mutable_components())[
+          static_cast<int64_t>(type)];
+      compMsg.set_type(type);
+      compMsg.set_remove(false);
+      jobs.emplace_back(this->ComponentImplementation(entity, type),
+          compMsg.mutable_component());
+      keptTypes.push_back(type);
+    }
 
-  auto functor = [&](auto itStart, auto itEnd)
-  {
-    msgs::SerializedStateMap threadMap;
-    while (itStart != itEnd)
     {
-      auto entity = (*itStart).first;
-      if (_entities.empty() || _entities.find(entity) != _entities.end())
+      std::lock_guard<std::mutex> lock(this->dataPtr->removedComponentsMutex);
+      auto removedComps = this->dataPtr->removedComponents.equal_range(entity);
+      for (auto it = removedComps.first; it != removedComps.second; ++it)
       {
-        this->AddEntityToMessage(threadMap, entity, _types, _full);
+        const ComponentTypeId type = it->second.first;
+        if (!_types.empty() && _types.find(type) == _types.end())
+          continue;
+
+        auto &compMsg = (*entityEntry().mutable_components())[
+            static_cast<int64_t>(type)];
+
+        // Empty data is needed for the component to be processed afterwards
+        compMsg.set_component(" ");
+        compMsg.set_type(type);
+        compMsg.set_remove(true);
+        keptTypes.push_back(type);
       }
-      itStart++;
     }
-    std::lock_guard<std::mutex> lock(stateMapMutex);
 
-    for (const auto &entity : threadMap.entities())
+    if (!removed && keptTypes.empty())
+      continue;
+
+    // Drop components left from the previous state
+    auto &compsMsg = *entityMsg->mutable_components();
+    for (auto it = compsMsg.begin(); it != compsMsg.end();)
     {
-      (*_state.mutable_entities())[static_cast<uint64_t>(entity.first)] =
-          entity.second;
+      if (std::find(keptTypes.begin(), keptTypes.end(),
+          static_cast<ComponentTypeId>(it->first)) == keptTypes.end())
+      {
+        it = compsMsg.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
     }
-  };
+    keptEntities.push_back(entity);
+  }
 
-  // Spawn workers
-  uint64_t numThreads = this->dataPtr->entityComponentIterators.size() - 1;
-  for (uint64_t i = 0; i < numThreads; i++)
+  // Drop entities left from the previous state
+  std::sort(keptEntities.begin(), keptEntities.end());
+  for (auto it = entitiesMsg.begin(); it != entitiesMsg.end();)
   {
-    workers.push_back(std::thread(functor,
-        this->dataPtr->entityComponentIterators[i],
-        this->dataPtr->entityComponentIterators[i+1]));
+    if (!std::binary_search(keptEntities.begin(), keptEntities.end(),
+        static_cast<Entity>(it->first)))
+    {
+      it = entitiesMsg.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
   }
 
-  // Wait for each thread to finish processing its components
-  std::for_each(workers.begin(), workers.end(), [](std::thread &_t)
+  // Map entries don't move, so the buffers can be filled in parallel
+  this->ParallelFor(jobs.size(), 64,
+      [&](std::size_t _begin, std::size_t _end)
   {
-    _t.join();
+    for (std::size_t i = _begin; i < _end; ++i)
+      jobs[i].first->SerializeToBuffer(*jobs[i].second);
   });
 }
 
@@ -1165,6 +3338,9 @@ void EntityComponentManager::SetState(
     const ignition::msgs::SerializedState &_stateMsg)
 {
   IGN_PROFILE("EntityComponentManager::SetState Non-map");
+  // Names and parents may be set without going through CreateComponent
+  this->dataPtr->ClearNameCache();
+
   // Create / remove / update entities
   for (int e = 0; e < _stateMsg.entities_size(); ++e)
   {
@@ -1224,8 +3400,7 @@ void EntityComponentManager::SetState(
         continue;
       }
 
-      std::istringstream istr(compMsg.component());
-      newComp->Deserialize(istr);
+      newComp->DeserializeFromBuffer(compMsg.component());
 
       // Get type id
       auto typeId = newComp->TypeId();
@@ -1267,7 +3442,31 @@ void EntityComponentManager::SetState(
     const ignition::msgs::SerializedStateMap &_stateMsg)
 {
   IGN_PROFILE("EntityComponentManager::SetState Map");
-  // Create / remove / update entities
+  // Names and parents may be set without going through CreateComponent
+  this->dataPtr->ClearNameCache();
+
+  /// \brief A component whose value is set from the message.
+  struct ComponentUpdate
+  {
+    /// \brief Entity which owns the component.
+    Entity entity;
+
+    /// \brief Component type.
+    ComponentTypeId type;
+
+    /// \brief Serialized value.
+    const std::string *buffer;
+
+    /// \brief Existing component, null if it's new.
+    components::BaseComponent *existing;
+
+    /// \brief New component, created if the entity doesn't have one yet.
+    std::unique_ptr<components::BaseComponent> created;
+  };
+  std::vector<ComponentUpdate> updates;
+
+  // Create / remove entities and remove components first, since these
+  // change the layout of the storages, and collect the components to update.
   for (const auto &iter : _stateMsg.entities())
   {
     const auto &entityMsg = iter.second;
@@ -1287,7 +3486,6 @@ void EntityComponentManager::SetState(
       this->dataPtr->CreateEntityImplementation(entity);
     }
 
-    // Create / remove / update components
     for (const auto &compIter : iter.second.components())
     {
       const auto &compMsg = compIter.second;
@@ -1323,52 +3521,322 @@ void EntityComponentManager::SetState(
         continue;
       }
 
-      // Get Component
-      components::BaseComponent *comp =
-        this->ComponentImplementation(entity, compIter.first);
+      updates.push_back({entity, compIter.first, &compMsg.component(),
+          nullptr, nullptr});
+    }
+  }
 
-      // Create if new
-      if (nullptr == comp)
+  // Handle each component type in one batch
+  std::stable_sort(updates.begin(), updates.end(),
+      [](const ComponentUpdate &_a, const ComponentUpdate &_b)
       {
-        // Create component
-        auto newComp = components::Factory::Instance()->New(compMsg.type());
+        return _a.type < _b.type;
+      });
 
-        if (nullptr == newComp)
-        {
-          ignerr << "Failed to create component of type [" << compMsg.type()
-            << "]" << std::endl;
-          continue;
-        }
+  // Look up existing components, which also copies storages shared with a
+  // fork, and create the missing ones. New components aren't added to the
+  // storages yet, so the existing pointers stay valid.
+  for (auto &update : updates)
+  {
+    update.existing = this->ComponentImplementation(update.entity,
+        update.type);
+    if (nullptr != update.existing)
+      continue;
+
+    update.created = components::Factory::Instance()->New(update.type);
+    if (nullptr == update.created)
+    {
+      ignerr << "Failed to create component of type [" << update.type
+        << "]" << std::endl;
+    }
+  }
+
+  // Every update writes a different component, so they can be decoded in
+  // parallel
+  this->ParallelFor(updates.size(), 64,
+      [&](std::size_t _begin, std::size_t _end)
+  {
+    for (std::size_t i = _begin; i < _end; ++i)
+    {
+      auto &update = updates[i];
+      if (nullptr != update.existing)
+        update.existing->DeserializeFromBuffer(*update.buffer);
+      else if (nullptr != update.created)
+        update.created->DeserializeFromBuffer(*update.buffer);
+    }
+  });
+
+  auto changeState = _stateMsg.has_one_time_component_changes() ?
+      ComponentState::OneTimeChange : ComponentState::PeriodicChange;
+  for (auto &update : updates)
+  {
+    if (nullptr != update.existing)
+    {
+      this->SetChanged(update.entity, update.type, changeState);
+    }
+    else if (nullptr != update.created)
+    {
+      this->CreateComponentImplementation(update.entity, update.type,
+          std::move(*update.created));
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+DeserializedState EntityComponentManager::DeserializeState(
+    const msgs::SerializedStateMap &_stateMsg)
+{
+  return DeserializeState(_stateMsg, {}, {});
+}
+
+//////////////////////////////////////////////////
+DeserializedState EntityComponentManager::DeserializeState(
+    const msgs::SerializedStateMap &_stateMsg,
+    const std::function<bool(Entity)> &_entityFilter,
+    const std::function<bool(Entity, ComponentTypeId)> &_componentFilter)
+{
+  IGN_PROFILE("EntityComponentManager::DeserializeState");
+
+  DeserializedState state;
+  state.oneTimeChanges = _stateMsg.has_one_time_component_changes();
+  state.entities.reserve(_stateMsg.entities().size());
+  for (const auto &iter : _stateMsg.entities())
+  {
+    const auto &entityMsg = iter.second;
+    if (_entityFilter && !_entityFilter(entityMsg.id()))
+      continue;
+
+    state.entities.emplace_back();
+    auto &entity = state.entities.back();
+    entity.id = entityMsg.id();
+    entity.remove = entityMsg.remove();
+    if (entity.remove)
+      continue;
+
+    for (const auto &compIter : entityMsg.components())
+    {
+      const auto &compMsg = compIter.second;
+      if (_componentFilter && !_componentFilter(entity.id, compIter.first))
+        continue;
 
-        std::istringstream istr(compMsg.component());
-        newComp->Deserialize(istr);
+      // Same as SetState, except that unregistered types aren't reported,
+      // since this may be called from many threads.
+      if (compMsg.component().empty() ||
+          !components::Factory::Instance()->HasType(compMsg.type()))
+      {
+        continue;
+      }
 
-        this->CreateComponentImplementation(entity,
-            newComp->TypeId(), newComp.get());
+      if (compMsg.remove())
+      {
+        entity.removedComponents.push_back(compIter.first);
+        continue;
       }
-      // Update component value
-      else
+
+      auto comp = components::Factory::Instance()->New(compMsg.type());
+      if (nullptr == comp)
+        continue;
+
+      comp->DeserializeFromBuffer(compMsg.component());
+      entity.components.push_back(std::move(comp));
+    }
+  }
+  return state;
+}
+
+//////////////////////////////////////////////////
+DeserializedState EntityComponentManager::CopyState() const
+{
+  IGN_PROFILE("EntityComponentManager::CopyState");
+
+  DeserializedState state;
+  state.oneTimeChanges = true;
+  state.entities.reserve(this->dataPtr->entities.Vertices().size());
+  for (const auto &vertex : this->dataPtr->entities.Vertices())
+  {
+    const Entity entity = vertex.first;
+
+    state.entities.emplace_back();
+    auto &entityState = state.entities.back();
+    entityState.id = entity;
+    entityState.remove = this->dataPtr->toRemoveEntities.find(entity) !=
+        this->dataPtr->toRemoveEntities.end();
+
+    auto ecIter = this->dataPtr->entityComponents.find(entity);
+    if (ecIter == this->dataPtr->entityComponents.end())
+      continue;
+
+    entityState.components.reserve(ecIter->second.size());
+    for (const auto &typeIter : ecIter->second)
+    {
+      const components::BaseComponent *comp =
+          this->ComponentImplementation(entity, typeIter.first);
+      if (nullptr == comp)
+        continue;
+
+      auto copy = comp->Clone();
+      if (nullptr != copy)
+        entityState.components.push_back(std::move(copy));
+    }
+  }
+  return state;
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::SetState(DeserializedState &&_state)
+{
+  IGN_PROFILE("EntityComponentManager::SetState Deserialized");
+  // Names and parents may be set without going through CreateComponent
+  this->dataPtr->ClearNameCache();
+
+
+  auto changeState = _state.oneTimeChanges ?
+      ComponentState::OneTimeChange : ComponentState::PeriodicChange;
+  for (auto &entityChanges : _state.entities)
+  {
+    Entity entity{entityChanges.id};
+
+    if (entityChanges.remove)
+    {
+      this->RequestRemoveEntity(entity);
+      continue;
+    }
+
+    if (!this->HasEntity(entity))
+      this->dataPtr->CreateEntityImplementation(entity);
+
+    for (auto type : entityChanges.removedComponents)
+      this->RemoveComponent(entity, type);
+
+    for (auto &comp : entityChanges.components)
+    {
+      auto type = comp->TypeId();
+      auto ecIter = this->dataPtr->entityComponents.find(entity);
+      if (ecIter != this->dataPtr->entityComponents.end())
       {
-        std::istringstream istr(compMsg.component());
-        comp->Deserialize(istr);
-        this->SetChanged(entity, compIter.first,
-            _stateMsg.has_one_time_component_changes() ?
-            ComponentState::OneTimeChange :
-            ComponentState::PeriodicChange);
+        auto typeIter = ecIter->second.find(type);
+        if (typeIter != ecIter->second.end())
+        {
+          this->dataPtr->MutableStorage(type, this).Assign(
+              typeIter->second.second, std::move(*comp));
+          this->SetChanged(entity, type, changeState);
+          continue;
+        }
       }
+
+      this->CreateComponentImplementation(entity, type, std::move(*comp));
     }
   }
 }
 
+//////////////////////////////////////////////////
+void EntityComponentManager::Fork(const EntityComponentManager &_source)
+{
+  IGN_PROFILE("EntityComponentManager::Fork");
+  if (&_source == this)
+    return;
+
+  const auto &source = *_source.dataPtr;
+  auto &data = *this->dataPtr;
+
+  // Component storages are shared until either side modifies them.
+  data.components = source.components;
+  for (auto &storage : data.components)
+    storage.second->SetReadOnly(data.readOnly);
+  data.uncopyableTypes.clear();
+
+  data.entities = source.entities;
+  data.hierarchy = source.hierarchy;
+  data.entityComponents = source.entityComponents;
+  data.entityComponentsDirty = true;
+  ++data.layoutGeneration;
+  data.stateEntities.clear();
+
+  // Entities point to their archetype in the copied map.
+  // Signatures are copied with the bits they were built with.
+  data.typeBits = source.typeBits;
+  data.archetypes = source.archetypes;
+  data.entityArchetypes.clear();
+  for (auto iter = data.archetypes.begin(); iter != data.archetypes.end();
+      ++iter)
+  {
+    for (const Entity entity : iter->second.entities)
+      data.entityArchetypes[entity] = iter;
+  }
+
+  data.changeGeneration = source.changeGeneration;
+  data.changeSequence = source.changeSequence;
+  data.removeAllEntities = source.removeAllEntities;
+  data.toRemoveEntities = source.toRemoveEntities;
+  data.removedComponents = source.removedComponents;
+
+  // Everything is new to the systems of the fork.
+  data.newlyCreatedEntities.clear();
+  for (const auto &vertex : data.entities.Vertices())
+    data.newlyCreatedEntities.insert(vertex.first);
+
+  // Views point to components of the source, they're created again when
+  // needed.
+  data.views.clear();
+  data.pendingViews.clear();
+  data.viewUpdates.clear();
+  data.viewEvictionAge = source.viewEvictionAge;
+  data.maxViews = source.maxViews;
+  for (auto &viewSlot : data.viewSlots)
+    viewSlot.store(nullptr, std::memory_order_relaxed);
+  data.descendantCache.clear();
+  data.ClearNameCache();
+
+  data.pendingCompactions = source.pendingCompactions;
+  data.componentIndices = source.componentIndices;
+  data.rangeIndices = source.rangeIndices;
+
+  data.worldPoses = source.worldPoses;
+  data.worldPosePass = source.worldPosePass;
+  data.worldPosesValid = source.worldPosesValid;
+  data.spatialIndex.SetCellSize(source.spatialIndex.CellSize());
+  data.spatialIndex.Clear();
+  data.spatialIndexEnabled = source.spatialIndexEnabled;
+  data.spatialIndexDirty = true;
+  data.spatialBoxToken = source.spatialBoxToken;
+
+  data.staticEntities = source.staticEntities;
+  data.staticLayoutGeneration = 0;
+  data.staticToken = source.staticToken;
+  data.hierarchyGeneration = source.hierarchyGeneration;
+  data.staticHierarchyGeneration = source.staticHierarchyGeneration;
+
+  data.trackedLinks = source.trackedLinks;
+  data.linkStates = source.linkStates;
+  data.linkStatesValid = source.linkStatesValid;
+
+  data.entityCount = source.entityCount;
+  data.entityRecycling = source.entityRecycling;
+  data.recycledEntities = source.recycledEntities;
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::UnshareComponents(const ComponentTypeId _typeId)
+{
+  if (this->dataPtr->components.find(_typeId) !=
+      this->dataPtr->components.end())
+  {
+    this->dataPtr->MutableStorage(_typeId, this);
+  }
+}
+
 //////////////////////////////////////////////////
 std::unordered_set<Entity> EntityComponentManager::Descendants(Entity _entity)
     const
 {
+  // Systems may query descendants from multiple threads.
+  std::lock_guard<std::mutex> lock(this->dataPtr->descendantCacheMutex);
+
   // Check cache
-  if (this->dataPtr->descendantCache.find(_entity) !=
-      this->dataPtr->descendantCache.end())
+  auto cacheIter = this->dataPtr->descendantCache.find(_entity);
+  if (cacheIter != this->dataPtr->descendantCache.end())
   {
-    return this->dataPtr->descendantCache[_entity];
+    return cacheIter->second;
   }
 
   std::unordered_set<Entity> descendants;
@@ -1376,20 +3844,222 @@ std::unordered_set<Entity> EntityComponentManager::Descendants(Entity _entity)
   if (!this->HasEntity(_entity))
     return descendants;
 
-  auto descVector = math::graph::BreadthFirstSort(this->dataPtr->entities,
-      _entity);
-  std::move(descVector.begin(), descVector.end(), std::inserter(descendants,
-      descendants.end()));
+  this->dataPtr->hierarchy.BreadthFirst(_entity,
+      [&](const Entity &_descendant)
+      {
+        descendants.insert(_descendant);
+        return true;
+      });
 
   this->dataPtr->descendantCache[_entity] = descendants;
   return descendants;
 }
 
+//////////////////////////////////////////////////
+std::optional<std::string> EntityComponentManager::CachedScopedName(
+    const Entity _entity, const std::string &_delim,
+    bool _includePrefix) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->nameCacheMutex);
+  auto iter = this->dataPtr->scopedNames.find(_entity);
+  if (iter == this->dataPtr->scopedNames.end())
+    return std::nullopt;
+
+  for (const auto &name : iter->second)
+  {
+    if (name.first.size() == _delim.size() + 1 &&
+        name.first.back() == (_includePrefix ? '1' : '0') &&
+        name.first.compare(0, _delim.size(), _delim) == 0)
+    {
+      return name.second;
+    }
+  }
+  return std::nullopt;
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::CacheScopedName(const Entity _entity,
+    const std::string &_delim, bool _includePrefix,
+    const std::string &_name) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->nameCacheMutex);
+  this->dataPtr->scopedNames[_entity].emplace_back(
+      _delim + (_includePrefix ? '1' : '0'), _name);
+}
+
+//////////////////////////////////////////////////
+std::optional<Entity> EntityComponentManager::CachedTopLevelModel(
+    const Entity _entity) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->nameCacheMutex);
+  auto iter = this->dataPtr->topLevelModels.find(_entity);
+  if (iter == this->dataPtr->topLevelModels.end())
+    return std::nullopt;
+  return iter->second;
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::CacheTopLevelModel(const Entity _entity,
+    const Entity _model) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->nameCacheMutex);
+  this->dataPtr->topLevelModels[_entity] = _model;
+}
+
+//////////////////////////////////////////////////
+std::vector<Entity> EntityComponentManager::ChildEntities(
+    const Entity _entity) const
+{
+  return this->dataPtr->hierarchy.Children(_entity);
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::EachDescendantDepthFirst(const Entity _entity,
+    const std::function<bool(const Entity &)> &_f) const
+{
+  this->dataPtr->hierarchy.DepthFirst(_entity, _f);
+}
+
+//////////////////////////////////////////////////
+void EntityComponentManager::EachDescendantBreadthFirst(const Entity _entity,
+    const std::function<bool(const Entity &)> &_f) const
+{
+  this->dataPtr->hierarchy.BreadthFirst(_entity, _f);
+}
+
+//////////////////////////////////////////////////
+Entity EntityComponentManager::CloneSubtree(const Entity _root,
+    const Entity _newParent, const std::string &_nameSuffix)
+{
+  IGN_PROFILE("EntityComponentManager::CloneSubtree");
+  if (!this->HasEntity(_root))
+  {
+    ignerr << "Can't clone entity [" << _root << "], it doesn't exist."
+           << std::endl;
+    return kNullEntity;
+  }
+
+  if (_newParent != kNullEntity && !this->HasEntity(_newParent))
+  {
+    ignerr << "Can't clone entity [" << _root << "] into parent ["
+           << _newParent << "], which doesn't exist." << std::endl;
+    return kNullEntity;
+  }
+
+  // Parents are visited before their children, so they're cloned first
+  std::vector<Entity> sources;
+  bool parentInSubtree{false};
+  this->EachDescendantDepthFirst(_root, [&](const Entity &_entity)
+  {
+    parentInSubtree = parentInSubtree || _entity == _newParent;
+    sources.push_back(_entity);
+    return true;
+  });
+
+  if (parentInSubtree)
+  {
+    ignerr << "Can't clone entity [" << _root << "] into its own subtree."
+           << std::endl;
+    return kNullEntity;
+  }
+
+  std::unordered_map<Entity, Entity> clones;
+  clones.reserve(sources.size());
+  for (const Entity source : sources)
+    clones[source] = this->CreateEntity();
+
+  auto cloneOf = [&clones](const Entity _entity)
+  {
+    auto iter = clones.find(_entity);
+    return iter == clones.end() ? _entity : iter->second;
+  };
+
+  const EntityComponentManager &self = *this;
+  std::vector<std::unique_ptr<components::BaseComponent>> copies;
+  for (const Entity source : sources)
+  {
+    const Entity clone = clones[source];
+    const Entity parent = source == _root ? _newParent :
+        cloneOf(this->ParentEntity(source));
+
+    // Copy all components before creating any, since creating them
+    // invalidates iterators of the entity's components
+    copies.clear();
+    for (const auto type : this->ComponentTypes(source))
+    {
+      auto comp = self.ComponentImplementation(source, type);
+      if (nullptr == comp)
+        continue;
+
+      auto copy = comp->Clone();
+      if (nullptr != copy)
+        copies.push_back(std::move(copy));
+    }
+
+    bool hasParentComp{false};
+    for (auto &copy : copies)
+    {
+      const auto type = copy->TypeId();
+      if (type == components::ParentEntity::typeId)
+      {
+        if (parent == kNullEntity)
+          continue;
+        hasParentComp = true;
+        static_cast<components::ParentEntity *>(copy.get())->Data() = parent;
+      }
+      else if (type == components::Name::typeId && source == _root)
+      {
+        static_cast<components::Name *>(copy.get())->Data() += _nameSuffix;
+      }
+      else if (type == components::DetachableJoint::typeId)
+      {
+        auto &info =
+            static_cast<components::DetachableJoint *>(copy.get())->Data();
+        info.parentLink = cloneOf(info.parentLink);
+        info.childLink = cloneOf(info.childLink);
+      }
+      else if (type == components::ModelCanonicalLink::typeId)
+      {
+        auto &link =
+            static_cast<components::ModelCanonicalLink *>(copy.get())->Data();
+        link = cloneOf(link);
+      }
+      else if (type == components::PerformerLevels::typeId)
+      {
+        auto &levels =
+            static_cast<components::PerformerLevels *>(copy.get())->Data();
+        std::set<Entity> clonedLevels;
+        for (const Entity level : levels)
+          clonedLevels.insert(cloneOf(level));
+        levels = std::move(clonedLevels);
+      }
+      this->CreateComponentImplementation(clone, type, std::move(*copy));
+    }
+
+    if (parent != kNullEntity)
+    {
+      if (!hasParentComp)
+        this->CreateComponent(clone, components::ParentEntity(parent));
+      this->SetParentEntity(clone, parent);
+    }
+  }
+
+  return clones[_root];
+}
+
 //////////////////////////////////////////////////
 void EntityComponentManager::SetAllComponentsUnchanged()
 {
-  this->dataPtr->periodicChangedComponents.clear();
-  this->dataPtr->oneTimeChangedComponents.clear();
+  IGN_PROFILE("EntityComponentManager::SetAllComponentsUnchanged");
+  for (auto &storage : this->dataPtr->components)
+  {
+    // Storages without changes are left alone, so the ones shared with
+    // forks aren't copied.
+    if (storage.second->HasChanges())
+      this->dataPtr->MutableStorage(storage.first, this).ClearChanges();
+  }
+  this->dataPtr->EvictViews();
+  ++this->dataPtr->changeGeneration;
 }
 
 /////////////////////////////////////////////////
@@ -1406,21 +4076,21 @@ void EntityComponentManager::SetChanged(
   if (typeIter == ecIter->second.end())
     return;
 
-  if (_c == ComponentState::PeriodicChange)
-  {
-    this->dataPtr->periodicChangedComponents.insert(typeIter->second);
-    this->dataPtr->oneTimeChangedComponents.erase(typeIter->second);
-  }
-  else if (_c == ComponentState::OneTimeChange)
-  {
-    this->dataPtr->periodicChangedComponents.erase(typeIter->second);
-    this->dataPtr->oneTimeChangedComponents.insert(typeIter->second);
-  }
-  else
+  // Systems running at the same time may mark their components as changed.
   {
-    this->dataPtr->periodicChangedComponents.erase(typeIter->second);
-    this->dataPtr->oneTimeChangedComponents.erase(typeIter->second);
+    std::lock_guard<std::mutex> lock(this->dataPtr->changedComponentsMutex);
+    auto &storage = this->dataPtr->MutableStorage(_type, this);
+    storage.SetChangeState(typeIter->second.second, _c,
+        this->dataPtr->changeGeneration);
+    if (_c != ComponentState::NoChange)
+    {
+      storage.LogChange(typeIter->second.second, _entity,
+          ++this->dataPtr->changeSequence);
+    }
   }
+
+  // The component may have been modified through a pointer.
+  this->UpdateComponentIndices(_entity, _type);
 }
 
 /////////////////////////////////////////////////
@@ -1444,6 +4114,16 @@ std::unordered_set<ComponentTypeId> EntityComponentManager::ComponentTypes(
 /////////////////////////////////////////////////
 void EntityComponentManager::SetEntityCreateOffset(uint64_t _offset)
 {
+  // Recycled ids carry a generation above the slot bits, so offsets can't
+  // reach into them.
+  if (this->dataPtr->entityRecycling && entitySlot(_offset) != _offset)
+  {
+    ignerr << "Can't set an entity offset of [" << _offset << "] while "
+           << "entity recycling is enabled, it must be less than ["
+           << (uint64_t{1} << kEntitySlotBits) << "]." << std::endl;
+    return;
+  }
+
   if (_offset < this->dataPtr->entityCount)
   {
     ignwarn << "Setting an entity offset of [" << _offset << "] is less than "
@@ -17,15 +17,35 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Rand.hh>
 
+#include "ignition/gazebo/components/AngularVelocity.hh"
+#include "ignition/gazebo/components/AxisAlignedBox.hh"
+#include "ignition/gazebo/components/CanonicalLink.hh"
+#include "ignition/gazebo/components/DetachableJoint.hh"
 #include "ignition/gazebo/components/Factory.hh"
+#include "ignition/gazebo/components/Inertial.hh"
+#include "ignition/gazebo/components/LinearVelocity.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/Static.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/Link.hh"
 #include "ignition/gazebo/config.hh"
 
+#include "TaskPool.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace components;
@@ -87,6 +107,10 @@ class EntityCompMgrTest : public EntityComponentManager
   {
     this->ProcessRemoveEntityRequests();
   }
+  public: bool RunCompactComponentStorage(std::size_t _maxMoves)
+  {
+    return this->CompactComponentStorage(_maxMoves);
+  }
   public: void RunSetAllComponentsUnchanged()
   {
     this->SetAllComponentsUnchanged();
@@ -95,6 +119,42 @@ class EntityCompMgrTest : public EntityComponentManager
   {
     this->ClearRemovedComponents();
   }
+  public: void RunSetTaskPool(TaskPool *_pool)
+  {
+    this->SetTaskPool(_pool);
+  }
+  public: void RunSetDeterministic(bool _deterministic)
+  {
+    this->SetDeterministic(_deterministic);
+  }
+  public: void RunUpdateWorldPoses()
+  {
+    this->UpdateWorldPoses();
+  }
+  public: void RunInvalidateWorldPoses()
+  {
+    this->InvalidateWorldPoses();
+  }
+  public: void RunUpdateLinkStates()
+  {
+    this->UpdateLinkStates();
+  }
+  public: void RunInvalidateLinkStates()
+  {
+    this->InvalidateLinkStates();
+  }
+  public: void RunSetReadOnly(bool _readOnly)
+  {
+    this->SetReadOnly(_readOnly);
+  }
+  public: void RunResetStepMemory()
+  {
+    this->ResetStepMemory();
+  }
+  public: void RunUpdateStaticEntities()
+  {
+    this->UpdateStaticEntities();
+  }
 };
 
 class EntityComponentManagerFixture : public ::testing::TestWithParam<int>
@@ -209,11 +269,21 @@ TEST_P(EntityComponentManagerFixture, AdjacentMemoryTwoComponentTypes)
   const components::Pose *pose = nullptr, *prevPose = nullptr;
   const IntComponent *it = nullptr, *prevIt = nullptr;
 
-  // Check that each component is adjacent in memory
+  // Check that each component is adjacent in memory within its page
+  const int pageSize =
+      static_cast<int>(ComponentStorage<components::Pose>::kPageSize);
   for (int i = 0; i < count; ++i)
   {
     pose = manager.Component<components::Pose>(poseKeys[i]);
     it = manager.Component<IntComponent>(intKeys[i]);
+
+    // First component of a new page
+    if (i % pageSize == 0)
+    {
+      prevPose = nullptr;
+      prevIt = nullptr;
+    }
+
     if (prevPose != nullptr)
     {
       EXPECT_EQ(poseSize, reinterpret_cast<uintptr_t>(pose) -
@@ -361,6 +431,132 @@ TEST_P(EntityComponentManagerFixture, RemoveAdjacent)
       reinterpret_cast<uintptr_t>(pose3) - reinterpret_cast<uintptr_t>(pose1));
 }
 
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, RemoveManyEntities)
+{
+  const int count = 100;
+  std::vector<Entity> entities;
+  for (int i = 0; i < count; ++i)
+  {
+    entities.push_back(manager.CreateEntity());
+    manager.CreateComponent<IntComponent>(entities.back(), IntComponent(i));
+    manager.CreateComponent<DoubleComponent>(entities.back(),
+        DoubleComponent(i * 0.5));
+  }
+
+  // Remove every other entity in a single request batch
+  for (int i = 0; i < count; i += 2)
+  {
+    manager.RequestRemoveEntity(entities[i]);
+  }
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(static_cast<size_t>(count / 2), manager.EntityCount());
+
+  // Components of the remaining entities are intact
+  for (int i = 0; i < count; ++i)
+  {
+    auto intComp = manager.Component<IntComponent>(entities[i]);
+    auto doubleComp = manager.Component<DoubleComponent>(entities[i]);
+    if (i % 2 == 0)
+    {
+      EXPECT_EQ(nullptr, intComp);
+      EXPECT_EQ(nullptr, doubleComp);
+    }
+    else
+    {
+      ASSERT_NE(nullptr, intComp);
+      ASSERT_NE(nullptr, doubleComp);
+      EXPECT_EQ(i, intComp->Data());
+      EXPECT_DOUBLE_EQ(i * 0.5, doubleComp->Data());
+    }
+  }
+
+  // New components can still be created and accessed after mass removal
+  Entity newEntity = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(newEntity, IntComponent(1234));
+  ASSERT_NE(nullptr, manager.Component<IntComponent>(newEntity));
+  EXPECT_EQ(1234, manager.Component<IntComponent>(newEntity)->Data());
+  EXPECT_EQ(count - 1,
+      manager.Component<IntComponent>(entities[count - 1])->Data());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, DeferredCompaction)
+{
+  const int count = 100;
+  std::vector<Entity> entities;
+  for (int i = 0; i < count; ++i)
+  {
+    entities.push_back(manager.CreateEntity());
+    manager.CreateComponent<IntComponent>(entities.back(), IntComponent(i));
+  }
+  EXPECT_TRUE(manager.RunCompactComponentStorage(10));
+
+  // Populate a view before removing
+  int visited{0};
+  manager.Each<IntComponent>([&](const Entity &, const IntComponent *)
+      {
+        ++visited;
+        return true;
+      });
+  EXPECT_EQ(count, visited);
+
+  // Removing entities doesn't move the remaining components
+  const IntComponent *last =
+      manager.Component<IntComponent>(entities[count - 1]);
+  for (int i = 0; i < count / 2; ++i)
+    manager.RequestRemoveEntity(entities[i * 2]);
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(last, manager.Component<IntComponent>(entities[count - 1]));
+
+  // Tombstones are skipped
+  auto checkRemaining = [&]()
+  {
+    std::set<int> values;
+    manager.Each<IntComponent>(
+        [&](const Entity &_entity, const IntComponent *_int)
+        {
+          // Views point to the components where compaction moved them
+          EXPECT_EQ(manager.Component<IntComponent>(_entity), _int);
+          EXPECT_EQ(_entity, entities[_int->Data()]);
+          values.insert(_int->Data());
+          return true;
+        });
+    EXPECT_EQ(static_cast<std::size_t>(count / 2), values.size());
+    for (int i = 0; i < count; ++i)
+    {
+      auto comp = manager.Component<IntComponent>(entities[i]);
+      if (i % 2 == 0)
+      {
+        EXPECT_EQ(nullptr, comp);
+      }
+      else
+      {
+        ASSERT_NE(nullptr, comp);
+        EXPECT_EQ(i, comp->Data());
+      }
+    }
+  };
+  checkRemaining();
+
+  // Compaction is spread over calls
+  EXPECT_FALSE(manager.RunCompactComponentStorage(10));
+  checkRemaining();
+
+  // Components removed one at a time are still removed right away
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(entities[1]));
+  EXPECT_EQ(nullptr, manager.Component<IntComponent>(entities[1]));
+  entities[1] = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(entities[1], IntComponent(1));
+  checkRemaining();
+
+  int calls{1};
+  while (!manager.RunCompactComponentStorage(10))
+    ++calls;
+  EXPECT_LE(calls, 5);
+  checkRemaining();
+}
+
 /////////////////////////////////////////////////
 // Removing a component should guarantee that existing components remain
 // adjacent to each other, and addition of a new component is adjacent to
@@ -1415,6 +1611,420 @@ TEST_P(EntityComponentManagerFixture, EachGetsNewOldRemove)
   EXPECT_EQ(0, removedCount<IntComponent>(manager));
 }
 
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, StableComponentPointers)
+{
+  Entity first = manager.CreateEntity();
+  manager.CreateComponent(first, IntComponent(-1));
+  const IntComponent *firstComp = manager.Component<IntComponent>(first);
+  ASSERT_NE(nullptr, firstComp);
+
+  // Create a view before creating lots of other components
+  EXPECT_EQ(1, eachCount<IntComponent>(manager));
+
+  // Create enough components to fill several pages
+  const int count =
+      3 * static_cast<int>(ComponentStorage<IntComponent>::kPageSize);
+  std::vector<Entity> entities;
+  for (int i = 0; i < count; ++i)
+  {
+    entities.push_back(manager.CreateEntity());
+    manager.CreateComponent(entities.back(), IntComponent(i));
+  }
+
+  // The first component didn't move
+  EXPECT_EQ(firstComp, manager.Component<IntComponent>(first));
+  EXPECT_EQ(-1, firstComp->Data());
+
+  // The view is kept up to date without being rebuilt
+  EXPECT_EQ(count + 1, eachCount<IntComponent>(manager));
+  manager.Each<IntComponent>(
+      [&](const Entity &_entity, const IntComponent *_comp) -> bool
+      {
+        EXPECT_EQ(manager.Component<IntComponent>(_entity), _comp);
+        return true;
+      });
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ViewComponentsAfterRemoval)
+{
+  std::vector<Entity> entities;
+  for (int i = 0; i < 10; ++i)
+  {
+    entities.push_back(manager.CreateEntity());
+    manager.CreateComponent(entities.back(), IntComponent(i));
+    manager.CreateComponent(entities.back(), DoubleComponent(i * 0.5));
+  }
+
+  // Create the views before removing anything
+  EXPECT_EQ(10, (eachCount<IntComponent, DoubleComponent>(manager)));
+  EXPECT_EQ(10, eachCount<IntComponent>(manager));
+
+  auto checkComponents = [&]()
+  {
+    manager.Each<IntComponent, DoubleComponent>(
+        [&](const Entity &_entity, const IntComponent *_int,
+            const DoubleComponent *_double) -> bool
+        {
+          EXPECT_EQ(manager.Component<IntComponent>(_entity), _int);
+          EXPECT_EQ(manager.Component<DoubleComponent>(_entity), _double);
+          EXPECT_DOUBLE_EQ(_int->Data() * 0.5, _double->Data());
+          return true;
+        });
+  };
+
+  // Removing components from the front moves the last ones in their place
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(entities[0]));
+  EXPECT_TRUE(manager.RemoveComponent<DoubleComponent>(entities[1]));
+  EXPECT_EQ(8, (eachCount<IntComponent, DoubleComponent>(manager)));
+  EXPECT_EQ(9, eachCount<IntComponent>(manager));
+  checkComponents();
+
+  // Same for entity removals, which remove components in bulk
+  manager.RequestRemoveEntity(entities[2]);
+  manager.RequestRemoveEntity(entities[4]);
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(6, (eachCount<IntComponent, DoubleComponent>(manager)));
+  EXPECT_EQ(7, eachCount<IntComponent>(manager));
+  checkComponents();
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EachAddsEntitiesToView)
+{
+  Entity e1 = manager.CreateEntity();
+  manager.CreateComponent(e1, IntComponent(1));
+  Entity e2 = manager.CreateEntity();
+  Entity e3 = manager.CreateEntity();
+  manager.CreateComponent(e3, IntComponent(3));
+
+  // Adding an entity to the view being iterated neither skips nor repeats
+  // the entities that come after it.
+  std::vector<Entity> visited;
+  manager.Each<IntComponent>(
+      [&](const Entity &_entity, const IntComponent *_comp) -> bool
+      {
+        EXPECT_NE(nullptr, _comp);
+        visited.push_back(_entity);
+        if (_entity == e1)
+          manager.CreateComponent(e2, IntComponent(2));
+        return true;
+      });
+  EXPECT_EQ((std::vector<Entity>{e1, e2, e3}), visited);
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EachCallable)
+{
+  Entity e1 = manager.CreateEntity();
+  manager.CreateComponent(e1, IntComponent(1));
+  manager.CreateComponent(e1, DoubleComponent(1.5));
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent(e2, IntComponent(2));
+
+  // Generic lambdas can't be converted to a std::function, so they're only
+  // accepted by the templated overload
+  int sum = 0;
+  manager.Each<IntComponent>([&](const Entity &, auto *_int)
+      {
+        _int->Data() *= 10;
+        sum += _int->Data();
+        return true;
+      });
+  EXPECT_EQ(30, sum);
+
+  // Const manager
+  const EntityComponentManager &constManager = manager;
+  int count = 0;
+  constManager.Each<DoubleComponent, IntComponent>(
+      [&](const Entity &_entity, auto *_double, auto *_int)
+      {
+        static_assert(std::is_const_v<std::remove_pointer_t<
+            decltype(_double)>>, "Expected const component");
+        EXPECT_EQ(e1, _entity);
+        EXPECT_DOUBLE_EQ(1.5, _double->Data());
+        EXPECT_EQ(10, _int->Data());
+        ++count;
+        return true;
+      });
+  EXPECT_EQ(1, count);
+
+  // Returning false stops the iteration
+  count = 0;
+  manager.Each<IntComponent>([&](const Entity &, const IntComponent *)
+      {
+        ++count;
+        return false;
+      });
+  EXPECT_EQ(1, count);
+
+  // std::function still works
+  std::function<bool(const Entity &, IntComponent *)> f =
+      [&](const Entity &, IntComponent *)
+      {
+        ++count;
+        return true;
+      };
+  manager.Each<IntComponent>(f);
+  EXPECT_EQ(3, count);
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ViewRange)
+{
+  Entity e1 = manager.CreateEntity();
+  manager.CreateComponent(e1, IntComponent(1));
+  manager.CreateComponent(e1, DoubleComponent(1.5));
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent(e2, IntComponent(2));
+  Entity e3 = manager.CreateEntity();
+  manager.CreateComponent(e3, IntComponent(3));
+  manager.CreateComponent(e3, DoubleComponent(3.5));
+
+  EXPECT_EQ(3u, manager.View<IntComponent>().size());
+  EXPECT_TRUE(manager.View<StringComponent>().empty());
+
+  std::vector<Entity> visited;
+  for (auto [entity, doubleComp, intComp] :
+      manager.View<DoubleComponent, IntComponent>())
+  {
+    ASSERT_NE(nullptr, doubleComp);
+    ASSERT_NE(nullptr, intComp);
+    EXPECT_EQ(manager.Component<IntComponent>(entity), intComp);
+    intComp->Data() += 10;
+    visited.push_back(entity);
+  }
+  EXPECT_EQ((std::vector<Entity>{e1, e3}), visited);
+  EXPECT_EQ(11, manager.Component<IntComponent>(e1)->Data());
+  EXPECT_EQ(2, manager.Component<IntComponent>(e2)->Data());
+  EXPECT_EQ(13, manager.Component<IntComponent>(e3)->Data());
+
+  // Const manager, removing the entity being visited
+  const EntityComponentManager &constManager = manager;
+  visited.clear();
+  for (auto [entity, intComp] : constManager.View<IntComponent>())
+  {
+    static_assert(std::is_same_v<const IntComponent *, decltype(intComp)>,
+        "Expected const component");
+    visited.push_back(entity);
+    if (entity == e1)
+      manager.RemoveComponent<IntComponent>(e1);
+  }
+  EXPECT_EQ((std::vector<Entity>{e1, e2, e3}), visited);
+  EXPECT_EQ(2u, constManager.View<IntComponent>().size());
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ParallelEach)
+{
+  const int count = 5000;
+  for (int i = 0; i < count; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent(entity, IntComponent(i));
+    if (i % 2 == 0)
+      manager.CreateComponent(entity, DoubleComponent(0.0));
+  }
+
+  // Each entity is visited once, and can write to its own components
+  std::atomic<int> visited{0};
+  manager.ParallelEach<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *_int, DoubleComponent *_double)
+      {
+        _double->Data() = _int->Data() * 2.0;
+        ++visited;
+      }, 64);
+  EXPECT_EQ(count / 2, visited);
+
+  manager.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *_int,
+          const DoubleComponent *_double) -> bool
+      {
+        EXPECT_DOUBLE_EQ(_int->Data() * 2.0, _double->Data());
+        return true;
+      });
+
+  // Const version, and views smaller than a chunk
+  const EntityComponentManager &constManager = manager;
+  std::atomic<int64_t> sum{0};
+  constManager.ParallelEach<IntComponent>(
+      [&](const Entity &, const IntComponent *_int)
+      {
+        sum += _int->Data();
+      });
+  EXPECT_EQ(int64_t{count} * (count - 1) / 2, sum);
+
+  visited = 0;
+  constManager.ParallelEach<StringComponent>(
+      [&](const Entity &, const StringComponent *)
+      {
+        ++visited;
+      });
+  EXPECT_EQ(0, visited);
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ParallelFor)
+{
+  // Every index is covered once, by chunks of at least the minimum size,
+  // except for the last one
+  std::vector<int> covered(1000, 0);
+  std::atomic<int> smallChunks{0};
+  manager.ParallelFor(covered.size(), 64,
+      [&](std::size_t _begin, std::size_t _end)
+      {
+        if (_end - _begin < 64)
+          ++smallChunks;
+        for (std::size_t i = _begin; i < _end; ++i)
+          ++covered[i];
+      });
+  EXPECT_EQ(std::vector<int>(covered.size(), 1), covered);
+  EXPECT_GE(1, smallChunks);
+
+  // Small ranges are a single chunk, and empty ranges are fine
+  int calls{0};
+  manager.ParallelFor(10, 64, [&](std::size_t _begin, std::size_t _end)
+      {
+        EXPECT_EQ(0u, _begin);
+        EXPECT_EQ(10u, _end);
+        ++calls;
+      });
+  EXPECT_EQ(1, calls);
+
+  manager.ParallelFor(0, 64, [&](std::size_t _begin, std::size_t _end)
+      {
+        EXPECT_EQ(_begin, _end);
+      });
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, CustomTaskPool)
+{
+  TaskPool pool(2);
+  manager.RunSetTaskPool(&pool);
+
+  const int count = 1000;
+  for (int i = 0; i < count; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent(entity, IntComponent(i));
+  }
+
+  std::atomic<int> visited{0};
+  manager.ParallelEach<IntComponent>(
+      [&](const Entity &, IntComponent *_int)
+      {
+        _int->Data() += 1;
+        ++visited;
+      }, 10);
+  EXPECT_EQ(count, visited);
+
+  // State is serialized on the pool too
+  msgs::SerializedStateMap state;
+  manager.State(state, {}, {}, true);
+  EXPECT_EQ(count, state.entities_size());
+
+  manager.RunSetTaskPool(nullptr);
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, DeterministicParallelFor)
+{
+  manager.RunSetDeterministic(true);
+
+  // Chunks only depend on the minimum chunk size, whatever the pool
+  auto chunks = [&]()
+  {
+    std::mutex mutex;
+    std::set<std::pair<std::size_t, std::size_t>> result;
+    manager.ParallelFor(1000, 64, [&](std::size_t _begin, std::size_t _end)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          result.insert({_begin, _end});
+        });
+    return result;
+  };
+
+  TaskPool onePool(1);
+  manager.RunSetTaskPool(&onePool);
+  const auto oneThread = chunks();
+  TaskPool manyPool(7);
+  manager.RunSetTaskPool(&manyPool);
+  const auto manyThreads = chunks();
+  EXPECT_EQ(oneThread, manyThreads);
+
+  ASSERT_EQ(16u, oneThread.size());
+  std::size_t begin{0};
+  for (const auto &chunk : oneThread)
+  {
+    EXPECT_EQ(begin, chunk.first);
+    EXPECT_EQ(std::min<std::size_t>(begin + 64, 1000), chunk.second);
+    begin = chunk.second;
+  }
+
+  manager.RunSetTaskPool(nullptr);
+  manager.RunSetDeterministic(false);
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ArchetypeViews)
+{
+  // Entities with different sets of components
+  Entity e1 = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(e1, IntComponent(1));
+
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(e2, IntComponent(2));
+  manager.CreateComponent<DoubleComponent>(e2, DoubleComponent(2.0));
+
+  Entity e3 = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(e3, IntComponent(3));
+  manager.CreateComponent<DoubleComponent>(e3, DoubleComponent(3.0));
+  manager.CreateComponent<BoolComponent>(e3, BoolComponent(true));
+
+  Entity e4 = manager.CreateEntity();
+  manager.CreateComponent<BoolComponent>(e4, BoolComponent(false));
+
+  // Entity without components
+  manager.CreateEntity();
+  EXPECT_EQ(5u, manager.EntityCount());
+
+  // Views created after the entities are populated from the archetypes
+  EXPECT_EQ(3, eachCount<IntComponent>(manager));
+  EXPECT_EQ(2, (eachCount<IntComponent, DoubleComponent>(manager)));
+  EXPECT_EQ(2, eachCount<BoolComponent>(manager));
+  EXPECT_EQ(1, (eachCount<IntComponent, BoolComponent>(manager)));
+  EXPECT_EQ(0, eachCount<StringComponent>(manager));
+
+  // Moving an entity to another archetype
+  EXPECT_TRUE(manager.RemoveComponent<DoubleComponent>(e2));
+  manager.CreateComponent<BoolComponent>(e4, BoolComponent(true));
+  manager.CreateComponent<IntComponent>(e4, IntComponent(4));
+  manager.RebuildViews();
+
+  EXPECT_EQ(4, eachCount<IntComponent>(manager));
+  EXPECT_EQ(1, (eachCount<IntComponent, DoubleComponent>(manager)));
+  EXPECT_EQ(2, (eachCount<IntComponent, BoolComponent>(manager)));
+  EXPECT_EQ(1, (eachCount<DoubleComponent, BoolComponent>(manager)));
+
+  // Removed entities leave their archetype
+  manager.RequestRemoveEntity(e3);
+  manager.ProcessEntityRemovals();
+  manager.RebuildViews();
+
+  EXPECT_EQ(3, eachCount<IntComponent>(manager));
+  EXPECT_EQ(0, (eachCount<IntComponent, DoubleComponent>(manager)));
+  EXPECT_EQ(0, (eachCount<DoubleComponent, BoolComponent>(manager)));
+  EXPECT_EQ(1, eachCount<BoolComponent>(manager));
+
+  // Removing all entities clears all archetypes
+  manager.RequestRemoveEntities();
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(0, eachCount<IntComponent>(manager));
+  EXPECT_EQ(0, eachCount<BoolComponent>(manager));
+}
+
 //////////////////////////////////////////////////
 TEST_P(EntityComponentManagerFixture, EntityByComponents)
 {
@@ -1481,34 +2091,184 @@ TEST_P(EntityComponentManagerFixture, EntityByComponents)
 }
 
 /////////////////////////////////////////////////
-TEST_P(EntityComponentManagerFixture, EntityGraph)
+TEST_P(EntityComponentManagerFixture, ComponentIndex)
 {
-  EXPECT_EQ(0u, manager.EntityCount());
+  Entity e1 = manager.CreateEntity();
+  manager.CreateComponent(e1, IntComponent(1));
+  manager.CreateComponent(e1, StringComponent("a"));
+  manager.CreateComponent(e1, Even());
 
-  /*
-   *        1
-   *      /   \
-   *     2     3
-   *  / / \ \
-   * 4 5   6 7
-   */
+  // Entities which already exist are indexed.
+  manager.EnableComponentIndex<StringComponent, IntComponent>();
+  manager.EnableComponentIndex<StringComponent, IntComponent>();
 
-  // Create a few entities
-  auto e1 = manager.CreateEntity();
-  auto e2 = manager.CreateEntity();
-  auto e3 = manager.CreateEntity();
-  auto e4 = manager.CreateEntity();
-  auto e5 = manager.CreateEntity();
-  auto e6 = manager.CreateEntity();
-  auto e7 = manager.CreateEntity();
-  EXPECT_EQ(7u, manager.EntityCount());
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent(e2, StringComponent("a"));
+  manager.CreateComponent(e2, IntComponent(2));
 
-  // Set parents
-  EXPECT_TRUE(manager.SetParentEntity(e2, e1));
-  EXPECT_TRUE(manager.SetParentEntity(e3, e1));
-  EXPECT_TRUE(manager.SetParentEntity(e4, e2));
-  EXPECT_TRUE(manager.SetParentEntity(e5, e2));
-  EXPECT_TRUE(manager.SetParentEntity(e6, e2));
+  Entity e3 = manager.CreateEntity();
+  manager.CreateComponent(e3, IntComponent(1));
+  manager.CreateComponent(e3, StringComponent("a"));
+
+  EXPECT_EQ(e1, manager.EntityByComponents(StringComponent("a"),
+      IntComponent(1)));
+  EXPECT_EQ(e2, manager.EntityByComponents(IntComponent(2),
+      StringComponent("a")));
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(StringComponent("b"),
+      IntComponent(1)));
+  EXPECT_EQ(std::vector<Entity>({e1, e3}), manager.EntitiesByComponents(
+      StringComponent("a"), IntComponent(1)));
+
+  // Components without data are compared after the indexed ones.
+  EXPECT_EQ(std::vector<Entity>({e1}), manager.EntitiesByComponents(
+      StringComponent("a"), IntComponent(1), Even()));
+
+  // Lookups which aren't covered by an index still work.
+  EXPECT_EQ(std::vector<Entity>({e1, e2, e3}), manager.EntitiesByComponents(
+      StringComponent("a")));
+
+  // Set data
+  EXPECT_TRUE(manager.SetComponentData<IntComponent>(e3, 2));
+  EXPECT_EQ(std::vector<Entity>({e1}), manager.EntitiesByComponents(
+      StringComponent("a"), IntComponent(1)));
+  EXPECT_EQ(std::vector<Entity>({e2, e3}), manager.EntitiesByComponents(
+      StringComponent("a"), IntComponent(2)));
+
+  // Modify through a pointer and mark as changed
+  manager.Component<StringComponent>(e2)->Data() = "b";
+  manager.SetChanged(e2, StringComponent::typeId,
+      ComponentState::OneTimeChange);
+  EXPECT_EQ(e2, manager.EntityByComponents(StringComponent("b"),
+      IntComponent(2)));
+  EXPECT_EQ(e3, manager.EntityByComponents(StringComponent("a"),
+      IntComponent(2)));
+
+  // Remove component
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(e1));
+  EXPECT_EQ(e1, manager.EntityByComponents(StringComponent("a")));
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(StringComponent("a"),
+      IntComponent(1)));
+
+  // Remove entity
+  manager.RequestRemoveEntity(e3);
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(StringComponent("a"),
+      IntComponent(2)));
+  EXPECT_EQ(e2, manager.EntityByComponents(StringComponent("b"),
+      IntComponent(2)));
+
+  // Remove all entities
+  manager.RequestRemoveEntities();
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(kNullEntity, manager.EntityByComponents(StringComponent("b"),
+      IntComponent(2)));
+
+  Entity e4 = manager.CreateEntity();
+  manager.CreateComponent(e4, IntComponent(2));
+  manager.CreateComponent(e4, StringComponent("b"));
+  EXPECT_EQ(e4, manager.EntityByComponents(StringComponent("b"),
+      IntComponent(2)));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, RangeIndex)
+{
+  const double inf = std::numeric_limits<double>::infinity();
+
+  Entity e1 = manager.CreateEntity();
+  manager.CreateComponent(e1, components::Pose(math::Pose3d(0, 0, -2, 0, 0,
+      0)));
+
+  // Entities which already exist are indexed.
+  auto z = [](const math::Pose3d &_pose) {return _pose.Pos().Z();};
+  manager.EnableRangeIndex<components::Pose>("z", z);
+  manager.EnableRangeIndex<components::Pose>("z", z);
+
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent(e2, components::Pose(math::Pose3d(0, 0, 1, 0, 0,
+      0)));
+
+  Entity e3 = manager.CreateEntity();
+  manager.CreateComponent(e3, components::Pose(math::Pose3d(0, 0, -1, 0, 0,
+      0)));
+
+  // Entities are sorted by field, ranges exclude their upper end.
+  EXPECT_EQ(std::vector<Entity>({e1, e3}),
+      manager.EntitiesInRange<components::Pose>("z", -inf, 0.0));
+  EXPECT_EQ(std::vector<Entity>({e1, e3, e2}),
+      manager.EntitiesInRange<components::Pose>("z", -inf, inf));
+  EXPECT_EQ(std::vector<Entity>({e3}),
+      manager.EntitiesInRange<components::Pose>("z", -1.0, 1.0));
+  EXPECT_TRUE(manager.EntitiesInRange<components::Pose>("z", 1.0,
+      -1.0).empty());
+
+  // Fields which aren't indexed
+  EXPECT_TRUE(manager.EntitiesInRange<components::Pose>("x", -inf,
+      inf).empty());
+  EXPECT_TRUE(manager.EntitiesInRange<DoubleComponent>("z", -inf,
+      inf).empty());
+
+  // Set data
+  EXPECT_TRUE(manager.SetComponentData<components::Pose>(e2,
+      math::Pose3d(0, 0, -3, 0, 0, 0)));
+  EXPECT_EQ(std::vector<Entity>({e2, e1, e3}),
+      manager.EntitiesInRange<components::Pose>("z", -inf, 0.0));
+
+  // Modify through a pointer and mark as changed
+  manager.Component<components::Pose>(e1)->Data().Pos().Z(5);
+  manager.SetChanged(e1, components::Pose::typeId,
+      ComponentState::OneTimeChange);
+  EXPECT_EQ(std::vector<Entity>({e2, e3}),
+      manager.EntitiesInRange<components::Pose>("z", -inf, 0.0));
+
+  // NaN isn't indexed
+  EXPECT_TRUE(manager.SetComponentData<components::Pose>(e3,
+      math::Pose3d(0, 0, std::numeric_limits<double>::quiet_NaN(), 0, 0,
+      0)));
+  EXPECT_EQ(std::vector<Entity>({e2, e1}),
+      manager.EntitiesInRange<components::Pose>("z", -inf, inf));
+
+  // Remove component
+  EXPECT_TRUE(manager.RemoveComponent<components::Pose>(e2));
+  EXPECT_EQ(std::vector<Entity>({e1}),
+      manager.EntitiesInRange<components::Pose>("z", -inf, inf));
+
+  // Remove entity
+  manager.RequestRemoveEntity(e1);
+  manager.ProcessEntityRemovals();
+  EXPECT_TRUE(manager.EntitiesInRange<components::Pose>("z", -inf,
+      inf).empty());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EntityGraph)
+{
+  EXPECT_EQ(0u, manager.EntityCount());
+
+  /*
+   *        1
+   *      /   \
+   *     2     3
+   *  / / \ \
+   * 4 5   6 7
+   */
+
+  // Create a few entities
+  auto e1 = manager.CreateEntity();
+  auto e2 = manager.CreateEntity();
+  auto e3 = manager.CreateEntity();
+  auto e4 = manager.CreateEntity();
+  auto e5 = manager.CreateEntity();
+  auto e6 = manager.CreateEntity();
+  auto e7 = manager.CreateEntity();
+  EXPECT_EQ(7u, manager.EntityCount());
+
+  // Set parents
+  EXPECT_TRUE(manager.SetParentEntity(e2, e1));
+  EXPECT_TRUE(manager.SetParentEntity(e3, e1));
+  EXPECT_TRUE(manager.SetParentEntity(e4, e2));
+  EXPECT_TRUE(manager.SetParentEntity(e5, e2));
+  EXPECT_TRUE(manager.SetParentEntity(e6, e2));
   EXPECT_TRUE(manager.SetParentEntity(e7, e2));
 
   EXPECT_FALSE(manager.SetParentEntity(e1, gazebo::Entity(1000)));
@@ -1612,6 +2372,793 @@ TEST_P(EntityComponentManagerFixture, EntityGraph)
   EXPECT_FALSE(manager.HasEntity(e6));
 }
 
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, HierarchyTraversal)
+{
+  /*
+   *        1
+   *      /   \
+   *     2     3
+   *    / \
+   *   4   5
+   */
+  auto e1 = manager.CreateEntity();
+  auto e2 = manager.CreateEntity();
+  auto e3 = manager.CreateEntity();
+  auto e4 = manager.CreateEntity();
+  auto e5 = manager.CreateEntity();
+  EXPECT_TRUE(manager.SetParentEntity(e2, e1));
+  EXPECT_TRUE(manager.SetParentEntity(e3, e1));
+  EXPECT_TRUE(manager.SetParentEntity(e4, e2));
+  EXPECT_TRUE(manager.SetParentEntity(e5, e2));
+
+  EXPECT_EQ(std::vector<Entity>({e2, e3}), manager.ChildEntities(e1));
+  EXPECT_TRUE(manager.ChildEntities(e4).empty());
+
+  std::vector<Entity> visited;
+  auto visit = [&](const Entity &_entity)
+  {
+    visited.push_back(_entity);
+    return true;
+  };
+
+  manager.EachDescendantDepthFirst(e1, visit);
+  EXPECT_EQ(std::vector<Entity>({e1, e2, e4, e5, e3}), visited);
+
+  visited.clear();
+  manager.EachDescendantBreadthFirst(e1, visit);
+  EXPECT_EQ(std::vector<Entity>({e1, e2, e3, e4, e5}), visited);
+
+  // Cycles are rejected
+  EXPECT_FALSE(manager.SetParentEntity(e1, e4));
+  EXPECT_FALSE(manager.SetParentEntity(e2, e2));
+  EXPECT_EQ(kNullEntity, manager.ParentEntity(e1));
+  EXPECT_EQ(e1, manager.ParentEntity(e2));
+
+  // Removed entities leave the hierarchy
+  manager.RequestRemoveEntity(e4, false);
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(std::vector<Entity>({e5}), manager.ChildEntities(e2));
+  EXPECT_EQ(4u, manager.Descendants(e1).size());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, CachedWorldPose)
+{
+  // world -> model -> link -> sensor, and an entity without a pose
+  auto world = manager.CreateEntity();
+  auto model = manager.CreateEntity();
+  auto link = manager.CreateEntity();
+  auto sensor = manager.CreateEntity();
+  auto noPose = manager.CreateEntity();
+
+  manager.CreateComponent(model, components::Pose({1, 0, 0, 0, 0, 0}));
+  manager.CreateComponent(model, components::ParentEntity(world));
+  manager.CreateComponent(link, components::Pose({0, 2, 0, 0, 0, IGN_PI_2}));
+  manager.CreateComponent(link, components::ParentEntity(model));
+  manager.CreateComponent(sensor, components::Pose({1, 0, 0, 0, 0, 0}));
+  manager.CreateComponent(sensor, components::ParentEntity(link));
+  manager.CreateComponent(noPose, components::ParentEntity(link));
+
+  // Nothing is cached before the first pass
+  EXPECT_FALSE(manager.CachedWorldPose(sensor).has_value());
+
+  manager.RunUpdateWorldPoses();
+  ASSERT_TRUE(manager.CachedWorldPose(model).has_value());
+  EXPECT_EQ(math::Pose3d(1, 0, 0, 0, 0, 0), *manager.CachedWorldPose(model));
+  EXPECT_EQ(math::Pose3d(1, 2, 0, 0, 0, IGN_PI_2),
+      *manager.CachedWorldPose(link));
+  ASSERT_TRUE(manager.CachedWorldPose(sensor).has_value());
+  EXPECT_EQ(math::Pose3d(1, 3, 0, 0, 0, IGN_PI_2),
+      *manager.CachedWorldPose(sensor));
+  EXPECT_FALSE(manager.CachedWorldPose(world).has_value());
+  EXPECT_FALSE(manager.CachedWorldPose(noPose).has_value());
+
+  // Moving an ancestor moves its descendants, including when the pose is
+  // written without marking it as changed
+  *manager.Component<components::Pose>(model) =
+      components::Pose({0, 0, 5, 0, 0, 0});
+  manager.RunInvalidateWorldPoses();
+  EXPECT_FALSE(manager.CachedWorldPose(sensor).has_value());
+  manager.RunUpdateWorldPoses();
+  EXPECT_EQ(math::Pose3d(0, 2, 5, 0, 0, IGN_PI_2),
+      *manager.CachedWorldPose(link));
+  EXPECT_EQ(math::Pose3d(0, 3, 5, 0, 0, IGN_PI_2),
+      *manager.CachedWorldPose(sensor));
+
+  // Reparenting
+  manager.Component<components::ParentEntity>(sensor)->Data() = model;
+  manager.RunUpdateWorldPoses();
+  EXPECT_EQ(math::Pose3d(1, 0, 5, 0, 0, 0),
+      *manager.CachedWorldPose(sensor));
+
+  // Entities which lose their pose are forgotten
+  manager.RemoveComponent<components::Pose>(sensor);
+  manager.RunUpdateWorldPoses();
+  EXPECT_FALSE(manager.CachedWorldPose(sensor).has_value());
+  EXPECT_TRUE(manager.CachedWorldPose(link).has_value());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ComponentLayoutGeneration)
+{
+  auto entity = manager.CreateEntity();
+  auto generation = manager.ComponentLayoutGeneration();
+
+  // Creating components changes the layout
+  manager.CreateComponent(entity, components::Pose());
+  EXPECT_NE(generation, manager.ComponentLayoutGeneration());
+  generation = manager.ComponentLayoutGeneration();
+
+  // Changing their values doesn't
+  manager.SetComponentData<components::Pose>(entity,
+      math::Pose3d(1, 0, 0, 0, 0, 0));
+  manager.SetChanged(entity, components::Pose::typeId,
+      ComponentState::OneTimeChange);
+  EXPECT_EQ(generation, manager.ComponentLayoutGeneration());
+
+  // Removing components and entities does
+  manager.RemoveComponent<components::Pose>(entity);
+  EXPECT_NE(generation, manager.ComponentLayoutGeneration());
+
+  manager.CreateComponent(entity, components::Pose());
+  generation = manager.ComponentLayoutGeneration();
+  manager.RequestRemoveEntity(entity);
+  manager.ProcessEntityRemovals();
+  EXPECT_NE(generation, manager.ComponentLayoutGeneration());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, CachedLinkState)
+{
+  // A moving link with inertia, and a link with only a pose
+  auto model = manager.CreateEntity();
+  auto link = manager.CreateEntity();
+  auto poseOnly = manager.CreateEntity();
+  auto untracked = manager.CreateEntity();
+
+  manager.CreateComponent(model, components::Pose({1, 0, 0, 0, 0, 0}));
+  manager.CreateComponent(link, components::WorldPose(
+      {1, 2, 3, 0, 0, IGN_PI_2}));
+  manager.CreateComponent(link, components::WorldLinearVelocity({1, 0, 0}));
+  manager.CreateComponent(link, components::WorldAngularVelocity(
+      {0, 0, 2}));
+  math::MassMatrix3d massMatrix(2.0, {1, 2, 3}, {0, 0, 0});
+  manager.CreateComponent(link, components::Inertial(
+      math::Inertiald(massMatrix, {0.5, 0, 0, 0, 0, 0})));
+  manager.CreateComponent(poseOnly, components::Pose({0, 1, 0, 0, 0, 0}));
+  manager.CreateComponent(poseOnly, components::ParentEntity(model));
+  manager.CreateComponent(untracked, components::WorldPose());
+
+  manager.TrackLinkState(link);
+  manager.TrackLinkState(poseOnly);
+  manager.TrackLinkState(poseOnly);
+
+  // Nothing is cached before the first pass
+  EXPECT_FALSE(manager.CachedLinkState(link).has_value());
+
+  manager.RunUpdateWorldPoses();
+  manager.RunUpdateLinkStates();
+
+  // The state matches the Link helper
+  auto state = manager.CachedLinkState(link);
+  ASSERT_TRUE(state.has_value());
+  Link linkHelper(link);
+  EXPECT_EQ(*linkHelper.WorldPose(manager), state->worldPose);
+  EXPECT_EQ(*linkHelper.WorldInertialPose(manager),
+      *state->worldInertialPose);
+  EXPECT_EQ(*linkHelper.WorldLinearVelocity(manager),
+      *state->worldLinearVelocity);
+  EXPECT_EQ(*linkHelper.WorldAngularVelocity(manager),
+      *state->worldAngularVelocity);
+  EXPECT_EQ(*linkHelper.WorldInertiaMatrix(manager),
+      *state->worldInertiaMatrix);
+  ASSERT_TRUE(state->worldKineticEnergy.has_value());
+  EXPECT_DOUBLE_EQ(*linkHelper.WorldKineticEnergy(manager),
+      *state->worldKineticEnergy);
+
+  // The pose of links without a WorldPose component comes from the world
+  // pose pass, and quantities needing missing components are unset
+  state = manager.CachedLinkState(poseOnly);
+  ASSERT_TRUE(state.has_value());
+  EXPECT_EQ(math::Pose3d(1, 1, 0, 0, 0, 0), state->worldPose);
+  EXPECT_FALSE(state->worldLinearVelocity.has_value());
+  EXPECT_FALSE(state->worldInertiaMatrix.has_value());
+  EXPECT_FALSE(state->worldKineticEnergy.has_value());
+
+  EXPECT_FALSE(manager.CachedLinkState(untracked).has_value());
+
+  // Nothing is returned until the next pass once invalidated
+  manager.Component<components::WorldLinearVelocity>(link)->Data() =
+      math::Vector3d(0, 0, 0);
+  manager.RunInvalidateLinkStates();
+  EXPECT_FALSE(manager.CachedLinkState(link).has_value());
+  manager.RunUpdateLinkStates();
+  EXPECT_EQ(math::Vector3d::Zero,
+      *manager.CachedLinkState(link)->worldLinearVelocity);
+
+  // Removed links are forgotten
+  manager.RequestRemoveEntity(link);
+  manager.ProcessEntityRemovals();
+  manager.RunUpdateLinkStates();
+  EXPECT_FALSE(manager.CachedLinkState(link).has_value());
+  EXPECT_TRUE(manager.CachedLinkState(poseOnly).has_value());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, SharedObject)
+{
+  auto counter = manager.SharedObject<int>("counter", 3);
+  ASSERT_NE(nullptr, counter);
+  EXPECT_EQ(3, *counter);
+
+  // Later calls get the same object, constructor arguments are ignored
+  *counter = 5;
+  auto same = manager.SharedObject<int>("counter", 7);
+  EXPECT_EQ(counter, same);
+  EXPECT_EQ(5, *same);
+
+  // Other keys and other managers get their own object
+  EXPECT_NE(counter, manager.SharedObject<int>("other"));
+  EntityCompMgrTest otherManager;
+  EXPECT_NE(counter, otherManager.SharedObject<int>("counter"));
+
+  // The manager doesn't keep the object alive
+  std::weak_ptr<int> weak = counter;
+  counter.reset();
+  same.reset();
+  EXPECT_TRUE(weak.expired());
+  EXPECT_EQ(0, *manager.SharedObject<int>("counter"));
+
+  // Objects outlive their manager while they're used
+  std::shared_ptr<std::string> name;
+  {
+    EntityCompMgrTest shortLived;
+    name = shortLived.SharedObject<std::string>("name", "kept");
+  }
+  EXPECT_EQ("kept", *name);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, WorldSpatialIndex)
+{
+  auto model = manager.CreateEntity();
+  auto link = manager.CreateEntity();
+  auto box = manager.CreateEntity();
+  manager.CreateComponent(model, components::Pose({10, 0, 0, 0, 0, 0}));
+  manager.CreateComponent(link, components::Pose({0, 1, 0, 0, 0, 0}));
+  manager.CreateComponent(link, components::ParentEntity(model));
+  manager.CreateComponent(box, components::Pose({0, 0, 0, 0, 0, 0}));
+  manager.CreateComponent(box, components::AxisAlignedBox(
+      math::AxisAlignedBox({-1, -1, -1}, {1, 1, 1})));
+
+  // Empty until enabled
+  manager.RunUpdateWorldPoses();
+  EXPECT_EQ(0u, manager.WorldSpatialIndex().Size());
+
+  manager.EnableSpatialIndex(2.0);
+  manager.RunUpdateWorldPoses();
+  EXPECT_EQ(3u, manager.WorldSpatialIndex().Size());
+  EXPECT_DOUBLE_EQ(2.0, manager.WorldSpatialIndex().CellSize());
+
+  auto near = [&](const math::Vector3d &_center, double _radius)
+  {
+    auto result = manager.WorldSpatialIndex().QuerySphere(_center, _radius);
+    return std::set<Entity>(result.begin(), result.end());
+  };
+  EXPECT_EQ(std::set<Entity>({model, link}), near({10, 0, 0}, 1.5));
+  EXPECT_EQ(std::set<Entity>({box}), near({0, 0, 2}, 1.5));
+
+  // Moving a parent moves its children
+  manager.Component<components::Pose>(model)->Data().Pos().Set(-10, 0, 0);
+  manager.RunUpdateWorldPoses();
+  EXPECT_TRUE(near({10, 0, 0}, 1.5).empty());
+  EXPECT_EQ(std::set<Entity>({model, link}), near({-10, 0, 0}, 1.5));
+
+  // Box changes are picked up
+  manager.SetComponentData<components::AxisAlignedBox>(box,
+      math::AxisAlignedBox({4, 4, 4}, {5, 5, 5}));
+  manager.SetChanged(box, components::AxisAlignedBox::typeId,
+      ComponentState::OneTimeChange);
+  manager.RunUpdateWorldPoses();
+  EXPECT_TRUE(near({0, 0, 2}, 1.5).empty());
+  EXPECT_EQ(std::set<Entity>({box}), near({4, 4, 4}, 0.5));
+
+  // Entities which lose their pose are removed
+  manager.RemoveComponent<components::Pose>(link);
+  manager.RunUpdateWorldPoses();
+  EXPECT_EQ(std::set<Entity>({model}), near({-10, 0, 0}, 1.5));
+  EXPECT_FALSE(manager.WorldSpatialIndex().Box(link).has_value());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EntityRecycling)
+{
+  EXPECT_FALSE(manager.EntityRecycling());
+
+  // Without recycling, ids keep growing
+  auto e1 = manager.CreateEntity();
+  manager.RequestRemoveEntity(e1);
+  manager.ProcessEntityRemovals();
+  auto e2 = manager.CreateEntity();
+  EXPECT_EQ(e1 + 1, e2);
+
+  manager.SetEntityRecycling(true);
+  EXPECT_TRUE(manager.EntityRecycling());
+
+  // Slots are reused with a new generation
+  auto e3 = manager.CreateEntity();
+  EXPECT_EQ(e2 + 1, e3);
+  EXPECT_EQ(0u, entityGeneration(e3));
+
+  manager.CreateComponent(e3, IntComponent(3));
+  manager.RequestRemoveEntity(e3);
+  manager.ProcessEntityRemovals();
+
+  auto e4 = manager.CreateEntity();
+  EXPECT_NE(e3, e4);
+  EXPECT_EQ(entitySlot(e3), entitySlot(e4));
+  EXPECT_EQ(1u, entityGeneration(e4));
+
+  // The stale id isn't found
+  EXPECT_FALSE(manager.HasEntity(e3));
+  EXPECT_TRUE(manager.HasEntity(e4));
+  EXPECT_EQ(nullptr, manager.Component<IntComponent>(e3));
+  EXPECT_EQ(nullptr, manager.Component<IntComponent>(e4));
+
+  // Slots are only reused once the removal was processed
+  manager.RequestRemoveEntity(e4);
+  auto e5 = manager.CreateEntity();
+  EXPECT_EQ(e3 + 1, entitySlot(e5));
+  manager.ProcessEntityRemovals();
+
+  // Slots freed by removing all entities are reused too
+  manager.RequestRemoveEntities();
+  manager.ProcessEntityRemovals();
+  std::set<uint64_t> slots;
+  for (int i = 0; i < 3; ++i)
+  {
+    auto entity = manager.CreateEntity();
+    EXPECT_LT(0u, entityGeneration(entity));
+    slots.insert(entitySlot(entity));
+  }
+  EXPECT_EQ(std::set<uint64_t>({entitySlot(e2), entitySlot(e4),
+      entitySlot(e5)}), slots);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, CreateEntities)
+{
+  // Create a view before the batch, it should pick up the new entities
+  int viewCount{0};
+  manager.Each<IntComponent>([&](const Entity &, const IntComponent *)
+  {
+    ++viewCount;
+    return true;
+  });
+  EXPECT_EQ(0, viewCount);
+
+  auto existing = manager.CreateEntity();
+  manager.CreateComponent(existing, IntComponent(-1));
+
+  std::vector<IntComponent> ints;
+  for (int i = 0; i < 100; ++i)
+    ints.push_back(IntComponent(i));
+
+  auto entities = manager.CreateEntities(100, ints,
+      std::vector<DoubleComponent>{DoubleComponent(0.5)});
+  ASSERT_EQ(100u, entities.size());
+  EXPECT_EQ(101u, manager.EntityCount());
+  EXPECT_TRUE(manager.HasNewEntities());
+
+  for (std::size_t i = 0; i < entities.size(); ++i)
+  {
+    EXPECT_TRUE(manager.HasEntity(entities[i]));
+    ASSERT_NE(nullptr, manager.Component<IntComponent>(entities[i]));
+    EXPECT_EQ(static_cast<int>(i),
+        manager.Component<IntComponent>(entities[i])->Data());
+    ASSERT_NE(nullptr, manager.Component<DoubleComponent>(entities[i]));
+    EXPECT_DOUBLE_EQ(0.5,
+        manager.Component<DoubleComponent>(entities[i])->Data());
+    EXPECT_EQ(ComponentState::OneTimeChange,
+        manager.ComponentState(entities[i], IntComponent::typeId));
+  }
+
+  viewCount = 0;
+  manager.Each<IntComponent>([&](const Entity &, const IntComponent *)
+  {
+    ++viewCount;
+    return true;
+  });
+  EXPECT_EQ(101, viewCount);
+
+  int newCount{0};
+  manager.EachNew<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *, const DoubleComponent *)
+  {
+    ++newCount;
+    return true;
+  });
+  EXPECT_EQ(100, newCount);
+
+  EXPECT_EQ(entities[42],
+      manager.EntityByComponents(IntComponent(42), DoubleComponent(0.5)));
+
+  // Entities without components
+  auto bare = manager.CreateEntities(3);
+  EXPECT_EQ(3u, bare.size());
+  EXPECT_EQ(104u, manager.EntityCount());
+
+  // Wrong sizes and repeated types are rejected
+  EXPECT_TRUE(manager.CreateEntities(3, ints).empty());
+  EXPECT_TRUE(manager.CreateEntities(2,
+      std::vector<IntComponent>{IntComponent(1)},
+      std::vector<IntComponent>{IntComponent(2)}).empty());
+  EXPECT_EQ(104u, manager.EntityCount());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ReadOnly)
+{
+  for (int i = 0; i < 10; ++i)
+  {
+    auto entity = manager.CreateEntity();
+    manager.CreateComponent(entity, IntComponent(i));
+    manager.CreateComponent(entity, DoubleComponent(i * 0.5));
+  }
+
+  // Existing view
+  manager.Each<IntComponent>([&](const Entity &, const IntComponent *)
+  {
+    return true;
+  });
+
+  manager.RunSetReadOnly(true);
+  const EntityComponentManager &constManager = manager;
+
+  // Read concurrently, including views which don't exist yet
+  std::atomic<int> total{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&]()
+    {
+      constManager.Each<IntComponent>(
+          [&](const Entity &, const IntComponent *_int)
+      {
+        total += _int->Data();
+        return true;
+      });
+      constManager.Each<IntComponent, DoubleComponent>(
+          [&](const Entity &_entity, const IntComponent *,
+              const DoubleComponent *_double)
+      {
+        EXPECT_EQ(_double, constManager.Component<DoubleComponent>(_entity));
+        return true;
+      });
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  EXPECT_EQ(4 * 45, total);
+
+  manager.RunSetReadOnly(false);
+
+  // The view created while read-only is kept up to date afterwards
+  auto entity = manager.CreateEntity();
+  manager.CreateComponent(entity, IntComponent(10));
+  manager.CreateComponent(entity, DoubleComponent(5.0));
+  int count{0};
+  manager.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *, const DoubleComponent *)
+  {
+    ++count;
+    return true;
+  });
+  EXPECT_EQ(11, count);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, CachedViews)
+{
+  auto countIntDouble = [this]()
+  {
+    int count{0};
+    manager.Each<IntComponent, DoubleComponent>(
+        [&](const Entity &, const IntComponent *, const DoubleComponent *)
+    {
+      ++count;
+      return true;
+    });
+    return count;
+  };
+  auto countDoubleInt = [this]()
+  {
+    int count{0};
+    manager.Each<DoubleComponent, IntComponent>(
+        [&](const Entity &, const DoubleComponent *, const IntComponent *)
+    {
+      ++count;
+      return true;
+    });
+    return count;
+  };
+
+  auto e1 = manager.CreateEntity();
+  manager.CreateComponent(e1, IntComponent(1));
+  manager.CreateComponent(e1, DoubleComponent(1.0));
+  EXPECT_EQ(1, countIntDouble());
+
+  // Cached views are kept up to date, and types in a different order share
+  // the same view
+  auto e2 = manager.CreateEntity();
+  manager.CreateComponent(e2, IntComponent(2));
+  manager.CreateComponent(e2, DoubleComponent(2.0));
+  EXPECT_EQ(2, countIntDouble());
+  EXPECT_EQ(2, countDoubleInt());
+
+  // Removing all entities removes the views, cached ones are dropped too
+  manager.RequestRemoveEntities();
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(0, countIntDouble());
+
+  auto e3 = manager.CreateEntity();
+  manager.CreateComponent(e3, IntComponent(3));
+  manager.CreateComponent(e3, DoubleComponent(3.0));
+  EXPECT_EQ(1, countIntDouble());
+  EXPECT_EQ(1, countDoubleInt());
+
+  // A second manager doesn't see the first one's views
+  EntityComponentManager other;
+  int otherCount{0};
+  other.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *, const DoubleComponent *)
+  {
+    ++otherCount;
+    return true;
+  });
+  EXPECT_EQ(0, otherCount);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, BatchedViewUpdates)
+{
+  // Views exist before the entities are created
+  EXPECT_EQ(0, newCount<IntComponent, DoubleComponent>(manager));
+  EXPECT_EQ(0, newCount<IntComponent>(manager));
+
+  std::vector<Entity> entities;
+  for (int i = 0; i < 20; ++i)
+  {
+    auto entity = manager.CreateEntity();
+    manager.CreateComponent(entity, IntComponent(i));
+    if (i % 2 == 0)
+      manager.CreateComponent(entity, DoubleComponent(i));
+    entities.push_back(entity);
+  }
+
+  // Changes queued for the same entity end up in the views in one update
+  manager.RemoveComponent<DoubleComponent>(entities[0]);
+  manager.CreateComponent(entities[0], DoubleComponent(0.0));
+  manager.RemoveComponent<DoubleComponent>(entities[2]);
+  manager.CreateComponent(entities[1], DoubleComponent(1.0));
+
+  // Views are updated before they're used, and entities are still new
+  EXPECT_EQ(10, newCount<IntComponent, DoubleComponent>(manager));
+  EXPECT_EQ(20, newCount<IntComponent>(manager));
+
+  int sum{0};
+  manager.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *_int,
+          const DoubleComponent *_double)
+  {
+    EXPECT_DOUBLE_EQ(_int->Data(), _double->Data());
+    sum += _int->Data();
+    return true;
+  });
+  EXPECT_EQ(0 + 1 + 4 + 6 + 8 + 10 + 12 + 14 + 16 + 18, sum);
+
+  // Entities created meanwhile aren't new anymore once cleared
+  auto late = manager.CreateEntity();
+  manager.CreateComponent(late, IntComponent(20));
+  manager.RunClearNewlyCreatedEntities();
+  EXPECT_EQ(0, newCount<IntComponent>(manager));
+  EXPECT_EQ(21, eachCount<IntComponent>(manager));
+
+  // Removal requests are queued as well
+  manager.RequestRemoveEntity(entities[4]);
+  manager.RequestRemoveEntity(late);
+  EXPECT_EQ(2, removedCount<IntComponent>(manager));
+  EXPECT_EQ(1, removedCount<IntComponent, DoubleComponent>(manager));
+
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(19, eachCount<IntComponent>(manager));
+  EXPECT_EQ(9, eachCount<IntComponent, DoubleComponent>(manager));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, MemoryUsage)
+{
+  std::vector<ComponentMemoryUsage> componentUsages;
+  std::vector<ViewMemoryUsage> viewUsages;
+  manager.MemoryUsage(componentUsages, viewUsages);
+  EXPECT_TRUE(componentUsages.empty());
+  EXPECT_TRUE(viewUsages.empty());
+
+  for (int i = 0; i < 10; ++i)
+  {
+    auto entity = manager.CreateEntity();
+    manager.CreateComponent(entity, IntComponent(i));
+    if (i % 2 == 0)
+      manager.CreateComponent(entity, DoubleComponent(i));
+  }
+  manager.Each<IntComponent, DoubleComponent>(
+      [&](const Entity &, const IntComponent *, const DoubleComponent *)
+  {
+    return true;
+  });
+
+  manager.MemoryUsage(componentUsages, viewUsages);
+  ASSERT_EQ(2u, componentUsages.size());
+  for (const auto &usage : componentUsages)
+  {
+    if (usage.typeId == IntComponent::typeId)
+    {
+      EXPECT_EQ(10u, usage.count);
+      EXPECT_EQ(10u * sizeof(IntComponent), usage.bytes);
+    }
+    else
+    {
+      EXPECT_EQ(DoubleComponent::typeId, usage.typeId);
+      EXPECT_EQ(5u, usage.count);
+      EXPECT_EQ(5u * sizeof(DoubleComponent), usage.bytes);
+    }
+    EXPECT_FALSE(usage.name.empty());
+    // The rest of the first page is unused
+    EXPECT_LT(usage.bytes, usage.overhead);
+  }
+
+  ASSERT_EQ(1u, viewUsages.size());
+  EXPECT_EQ(2u, viewUsages[0].types.size());
+  EXPECT_EQ(5u, viewUsages[0].entityCount);
+  EXPECT_LT(5u * sizeof(Entity), viewUsages[0].bytes);
+  EXPECT_EQ(manager.ChangeGeneration(), viewUsages[0].lastUsed);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ChangeTrackingStaysBounded)
+{
+  // One entity is kept so the storages are never emptied
+  auto kept = manager.CreateEntity();
+  manager.CreateComponent(kept, IntComponent(-1));
+  manager.CreateComponent(kept, DoubleComponent(-1.0));
+
+  // Spawn and remove a few entities per step, like a world which keeps
+  // spawning short-lived models
+  auto step = [&](int _iteration)
+  {
+    std::vector<Entity> spawned;
+    for (int i = 0; i < 4; ++i)
+    {
+      auto entity = manager.CreateEntity();
+      manager.CreateComponent(entity, IntComponent(_iteration));
+      manager.CreateComponent(entity, DoubleComponent(_iteration));
+      spawned.push_back(entity);
+    }
+
+    // Components are removed both on their own and with their entity
+    manager.RemoveComponent<DoubleComponent>(spawned[0]);
+    for (auto entity : spawned)
+      manager.RequestRemoveEntity(entity);
+
+    manager.ProcessEntityRemovals();
+    manager.RunCompactComponentStorage(1000);
+    manager.RunSetAllComponentsUnchanged();
+    manager.RunClearRemovedComponents();
+    manager.RunClearNewlyCreatedEntities();
+  };
+
+  auto overhead = [&]()
+  {
+    std::vector<ComponentMemoryUsage> componentUsages;
+    std::vector<ViewMemoryUsage> viewUsages;
+    manager.MemoryUsage(componentUsages, viewUsages);
+    std::size_t total{0};
+    for (const auto &usage : componentUsages)
+      total += usage.overhead;
+    return total;
+  };
+
+  // Let the change log reach its pruning size
+  for (int i = 0; i < 2000; ++i)
+    step(i);
+  const std::size_t warm = overhead();
+
+  for (int i = 0; i < 20000; ++i)
+    step(i);
+  EXPECT_EQ(warm, overhead());
+
+  EXPECT_EQ(1u, manager.EntityCount());
+  EXPECT_EQ(-1, manager.Component<IntComponent>(kept)->Data());
+  EXPECT_DOUBLE_EQ(-1.0, manager.Component<DoubleComponent>(kept)->Data());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ViewEviction)
+{
+  auto countInt = [this]()
+  {
+    int count{0};
+    manager.Each<IntComponent>([&](const Entity &, const IntComponent *)
+    {
+      ++count;
+      return true;
+    });
+    return count;
+  };
+  auto countDouble = [this]()
+  {
+    int count{0};
+    manager.Each<DoubleComponent>([&](const Entity &, const DoubleComponent *)
+    {
+      ++count;
+      return true;
+    });
+    return count;
+  };
+  auto viewCount = [this]()
+  {
+    std::vector<ComponentMemoryUsage> componentUsages;
+    std::vector<ViewMemoryUsage> viewUsages;
+    manager.MemoryUsage(componentUsages, viewUsages);
+    return viewUsages.size();
+  };
+
+  auto e1 = manager.CreateEntity();
+  manager.CreateComponent(e1, IntComponent(1));
+  manager.CreateComponent(e1, DoubleComponent(1.0));
+
+  // Views unused for 3 generations are removed
+  manager.SetViewEviction(3, 0);
+  EXPECT_EQ(1, countInt());
+  EXPECT_EQ(1, countDouble());
+  EXPECT_EQ(2u, viewCount());
+
+  for (int i = 0; i < 5; ++i)
+  {
+    EXPECT_EQ(1, countInt());
+    manager.RunSetAllComponentsUnchanged();
+  }
+  EXPECT_EQ(1u, viewCount());
+  EXPECT_EQ(1u, manager.EvictedViewCount());
+
+  // A removed view is built again, with the entities created meanwhile
+  auto e2 = manager.CreateEntity();
+  manager.CreateComponent(e2, DoubleComponent(2.0));
+  EXPECT_EQ(2, countDouble());
+  EXPECT_EQ(2u, viewCount());
+
+  // Beyond the maximum, the least recently used views are removed, but not
+  // the ones used during the current generation
+  manager.SetViewEviction(0, 1);
+  EXPECT_EQ(1, countInt());
+  manager.RunSetAllComponentsUnchanged();
+  EXPECT_EQ(2u, viewCount());
+
+  EXPECT_EQ(2, countDouble());
+  manager.RunSetAllComponentsUnchanged();
+  EXPECT_EQ(1u, viewCount());
+  EXPECT_EQ(2u, manager.EvictedViewCount());
+  EXPECT_EQ(1, countInt());
+  EXPECT_EQ(2, countDouble());
+
+  // Views are kept when eviction is disabled
+  manager.SetViewEviction(0, 0);
+  for (int i = 0; i < 5; ++i)
+    manager.RunSetAllComponentsUnchanged();
+  EXPECT_EQ(2u, viewCount());
+}
+
 /////////////////////////////////////////////////
 TEST_P(EntityComponentManagerFixture, State)
 {
@@ -1887,6 +3434,540 @@ TEST_P(EntityComponentManagerFixture, State)
   }
 }
 
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, RebuildState)
+{
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent(e1, IntComponent(1));
+  manager.CreateComponent(e1, DoubleComponent(0.5));
+  manager.CreateComponent(e2, IntComponent(2));
+
+  msgs::SerializedStateMap stateMsg;
+  manager.RebuildState(stateMsg, {}, {}, true);
+  ASSERT_EQ(2u, stateMsg.entities().size());
+  EXPECT_EQ(2u, stateMsg.entities().at(e1).components().size());
+  EXPECT_EQ(1u, stateMsg.entities().at(e2).components().size());
+
+  // Rebuilding the same state reuses the entries
+  const std::string *e1Int =
+      &stateMsg.entities().at(e1).components().at(IntComponent::typeId)
+      .component();
+  manager.RebuildState(stateMsg, {}, {}, true);
+  EXPECT_EQ(e1Int,
+      &stateMsg.entities().at(e1).components().at(IntComponent::typeId)
+      .component());
+
+  // Entries which aren't part of the new state are removed
+  manager.RunSetAllComponentsUnchanged();
+  manager.SetComponentData<IntComponent>(e1, 10);
+  manager.SetChanged(e1, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  manager.RebuildState(stateMsg);
+  ASSERT_EQ(1u, stateMsg.entities().size());
+  ASSERT_EQ(1u, stateMsg.entities().at(e1).components().size());
+  EXPECT_EQ(e1Int,
+      &stateMsg.entities().at(e1).components().at(IntComponent::typeId)
+      .component());
+
+  // The result matches State()
+  msgs::SerializedStateMap expected;
+  manager.State(expected);
+  EXPECT_EQ(expected.SerializeAsString(), stateMsg.SerializeAsString());
+
+  EntityComponentManager other;
+  other.SetState(stateMsg);
+  ASSERT_NE(nullptr, other.Component<IntComponent>(e1));
+  EXPECT_EQ(10, other.Component<IntComponent>(e1)->Data());
+
+  // Removal flags are set and cleared
+  manager.RequestRemoveEntity(e2);
+  manager.RebuildState(stateMsg, {}, {}, true);
+  EXPECT_FALSE(stateMsg.entities().at(e1).remove());
+  EXPECT_TRUE(stateMsg.entities().at(e2).remove());
+
+  // Entity filter
+  manager.RebuildState(stateMsg, {e1}, {}, true);
+  ASSERT_EQ(1u, stateMsg.entities().size());
+  EXPECT_EQ(1u, stateMsg.entities().count(e1));
+
+  // Type filters with some or all of the entity's types
+  manager.RebuildState(stateMsg, {e1}, {DoubleComponent::typeId}, true);
+  ASSERT_EQ(1u, stateMsg.entities().at(e1).components().size());
+  EXPECT_EQ(1u, stateMsg.entities().at(e1).components().count(
+      DoubleComponent::typeId));
+
+  manager.RebuildState(stateMsg, {e1},
+      {IntComponent::typeId, DoubleComponent::typeId, BoolComponent::typeId},
+      true);
+  EXPECT_EQ(2u, stateMsg.entities().at(e1).components().size());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EntityMatchesSignatures)
+{
+  Entity e1 = manager.CreateEntity();
+  manager.CreateComponent(e1, IntComponent(1));
+  manager.CreateComponent(e1, DoubleComponent(0.5));
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent(e2, IntComponent(2));
+
+  EXPECT_TRUE(manager.EntityMatches(e1, {}));
+  EXPECT_TRUE(manager.EntityMatches(e1, {IntComponent::typeId}));
+  EXPECT_TRUE(manager.EntityMatches(e1,
+      {IntComponent::typeId, DoubleComponent::typeId}));
+  EXPECT_FALSE(manager.EntityMatches(e2,
+      {IntComponent::typeId, DoubleComponent::typeId}));
+
+  // Types which no entity has
+  EXPECT_FALSE(manager.EntityMatches(e1,
+      {IntComponent::typeId, StringComponent::typeId}));
+
+  // Signatures follow component changes
+  manager.RemoveComponent<DoubleComponent>(e1);
+  manager.CreateComponent(e2, DoubleComponent(1.5));
+  EXPECT_FALSE(manager.EntityMatches(e1,
+      {IntComponent::typeId, DoubleComponent::typeId}));
+  EXPECT_TRUE(manager.EntityMatches(e2,
+      {IntComponent::typeId, DoubleComponent::typeId}));
+
+  // Entities which aren't in the graph still match their components
+  const Entity orphan = 12345;
+  manager.CreateComponent(orphan, BoolComponent(true));
+  EXPECT_TRUE(manager.EntityMatches(orphan, {BoolComponent::typeId}));
+  EXPECT_FALSE(manager.EntityMatches(orphan, {IntComponent::typeId}));
+
+  // Forks keep the signatures of the source
+  EntityComponentManager fork;
+  fork.Fork(manager);
+  EXPECT_TRUE(fork.EntityMatches(e2,
+      {IntComponent::typeId, DoubleComponent::typeId}));
+  EXPECT_FALSE(fork.EntityMatches(e1, {DoubleComponent::typeId}));
+  EXPECT_EQ(2, eachCount<IntComponent>(manager));
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, RebuildStateSinceGeneration)
+{
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent(e1, IntComponent(1));
+  manager.CreateComponent(e2, IntComponent(2));
+  manager.RunSetAllComponentsUnchanged();
+
+  const uint64_t since = manager.ChangeGeneration();
+  manager.SetComponentData<IntComponent>(e1, 10);
+  manager.SetChanged(e1, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  manager.RunSetAllComponentsUnchanged();
+
+  // Changes from previous iterations aren't in the current one
+  msgs::SerializedStateMap stateMsg;
+  manager.RebuildState(stateMsg);
+  EXPECT_TRUE(stateMsg.entities().empty());
+
+  // But are found since the generation they happened in
+  manager.RebuildState(stateMsg, {}, {}, false, since);
+  ASSERT_EQ(1u, stateMsg.entities().size());
+  EXPECT_EQ(1u, stateMsg.entities().count(e1));
+
+  manager.RebuildState(stateMsg, {}, {}, false, manager.ChangeGeneration());
+  EXPECT_TRUE(stateMsg.entities().empty());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, DeserializedState)
+{
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent(e1, IntComponent(1));
+  manager.CreateComponent(e1, DoubleComponent(0.5));
+  manager.CreateComponent(e2, StringComponent("two"));
+
+  msgs::SerializedStateMap stateMsg;
+  manager.State(stateMsg);
+
+  auto state = EntityComponentManager::DeserializeState(stateMsg);
+  ASSERT_EQ(2u, state.entities.size());
+
+  // New entities and components are created
+  EntityComponentManager other;
+  other.SetState(std::move(state));
+  EXPECT_TRUE(other.HasEntity(e1));
+  EXPECT_TRUE(other.HasEntity(e2));
+  ASSERT_NE(nullptr, other.Component<IntComponent>(e1));
+  EXPECT_EQ(1, other.Component<IntComponent>(e1)->Data());
+  ASSERT_NE(nullptr, other.Component<DoubleComponent>(e1));
+  EXPECT_DOUBLE_EQ(0.5, other.Component<DoubleComponent>(e1)->Data());
+  ASSERT_NE(nullptr, other.Component<StringComponent>(e2));
+  EXPECT_EQ("two", other.Component<StringComponent>(e2)->Data());
+
+  // Existing components are updated and marked as changed
+  other.RunSetAllComponentsUnchanged();
+  manager.SetComponentData<IntComponent>(e1, 10);
+  manager.State(stateMsg);
+  other.SetState(EntityComponentManager::DeserializeState(stateMsg));
+  EXPECT_EQ(10, other.Component<IntComponent>(e1)->Data());
+  EXPECT_EQ(ComponentState::PeriodicChange,
+      other.ComponentState(e1, IntComponent::typeId));
+
+  // Same result as setting the serialized state
+  EntityComponentManager expected;
+  expected.SetState(stateMsg);
+  msgs::SerializedStateMap expectedMsg;
+  msgs::SerializedStateMap otherMsg;
+  expected.State(expectedMsg);
+  other.State(otherMsg);
+  EXPECT_EQ(expectedMsg.entities().size(), otherMsg.entities().size());
+  EXPECT_EQ(
+      expectedMsg.entities().at(e1).components().at(IntComponent::typeId)
+      .component(),
+      otherMsg.entities().at(e1).components().at(IntComponent::typeId)
+      .component());
+
+  // Removals
+  manager.RequestRemoveEntity(e2);
+  manager.State(stateMsg);
+  other.SetState(EntityComponentManager::DeserializeState(stateMsg));
+  EXPECT_TRUE(other.HasEntitiesMarkedForRemoval());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, StaticEntities)
+{
+  // A static model with a link and a nested model, and a dynamic model
+  Entity staticModel = manager.CreateEntity();
+  manager.CreateComponent(staticModel, components::Static(true));
+  manager.CreateComponent(staticModel, IntComponent(1));
+  Entity staticLink = manager.CreateEntity();
+  manager.SetParentEntity(staticLink, staticModel);
+  manager.CreateComponent(staticLink, IntComponent(2));
+  Entity nestedModel = manager.CreateEntity();
+  manager.SetParentEntity(nestedModel, staticModel);
+  manager.CreateComponent(nestedModel, components::Static(false));
+  Entity dynamicModel = manager.CreateEntity();
+  manager.CreateComponent(dynamicModel, components::Static(false));
+  manager.CreateComponent(dynamicModel, IntComponent(3));
+
+  // Not computed yet
+  EXPECT_FALSE(manager.IsStatic(staticModel));
+
+  manager.RunUpdateStaticEntities();
+  EXPECT_TRUE(manager.IsStatic(staticModel));
+  EXPECT_TRUE(manager.IsStatic(staticLink));
+  EXPECT_TRUE(manager.IsStatic(nestedModel));
+  EXPECT_FALSE(manager.IsStatic(dynamicModel));
+
+  // Periodic states may skip them
+  msgs::SerializedStateMap stateMsg;
+  manager.RebuildState(stateMsg, {}, {}, true, 0, false);
+  EXPECT_EQ(1u, stateMsg.entities().size());
+  EXPECT_EQ(1u, stateMsg.entities().count(dynamicModel));
+  manager.RebuildState(stateMsg, {}, {}, true);
+  EXPECT_EQ(4u, stateMsg.entities().size());
+
+  // Changing the flags or the tree is picked up
+  manager.SetComponentData<components::Static>(staticModel, false);
+  manager.SetComponentData<components::Static>(dynamicModel, true);
+  manager.RunUpdateStaticEntities();
+  EXPECT_FALSE(manager.IsStatic(staticModel));
+  EXPECT_FALSE(manager.IsStatic(staticLink));
+  EXPECT_TRUE(manager.IsStatic(dynamicModel));
+
+  manager.SetParentEntity(staticLink, dynamicModel);
+  manager.RunUpdateStaticEntities();
+  EXPECT_TRUE(manager.IsStatic(staticLink));
+
+  // Static entities being removed are still sent
+  manager.RequestRemoveEntity(dynamicModel);
+  manager.RebuildState(stateMsg, {}, {}, false, 0, false);
+  ASSERT_EQ(1u, stateMsg.entities().count(dynamicModel));
+  EXPECT_TRUE(stateMsg.entities().at(dynamicModel).remove());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, CloneSubtree)
+{
+  // A model with two links and a detachable joint between them
+  Entity world = manager.CreateEntity();
+  Entity model = manager.CreateEntity();
+  manager.SetParentEntity(model, world);
+  manager.CreateComponent(model, components::ParentEntity(world));
+  manager.CreateComponent(model, components::Name("model"));
+  Entity link1 = manager.CreateEntity();
+  manager.SetParentEntity(link1, model);
+  manager.CreateComponent(link1, components::ParentEntity(model));
+  manager.CreateComponent(link1, components::Name("link1"));
+  manager.CreateComponent(link1, IntComponent(1));
+  Entity link2 = manager.CreateEntity();
+  manager.SetParentEntity(link2, model);
+  manager.CreateComponent(link2, components::ParentEntity(model));
+  manager.CreateComponent(link2, IntComponent(2));
+  manager.CreateComponent(model, components::ModelCanonicalLink(link1));
+  Entity joint = manager.CreateEntity();
+  manager.SetParentEntity(joint, model);
+  manager.CreateComponent(joint, components::ParentEntity(model));
+  manager.CreateComponent(joint,
+      components::DetachableJoint({link1, link2, "fixed"}));
+
+  const auto entityCount = manager.EntityCount();
+  Entity clone = manager.CloneSubtree(model, world, "_copy");
+  ASSERT_NE(kNullEntity, clone);
+  EXPECT_EQ(entityCount + 4, manager.EntityCount());
+
+  EXPECT_EQ(world, manager.ParentEntity(clone));
+  EXPECT_EQ(world, manager.ComponentData<components::ParentEntity>(clone));
+  EXPECT_EQ("model_copy", manager.ComponentData<components::Name>(clone));
+
+  auto children = manager.Descendants(clone);
+  EXPECT_EQ(4u, children.size());
+  Entity cloneLink1 = manager.EntityByComponents(components::Name("link1"),
+      components::ParentEntity(clone));
+  ASSERT_NE(kNullEntity, cloneLink1);
+  EXPECT_NE(link1, cloneLink1);
+  EXPECT_EQ(clone, manager.ParentEntity(cloneLink1));
+  EXPECT_EQ(1, manager.ComponentData<IntComponent>(cloneLink1));
+
+  // The copy's canonical link is its own
+  EXPECT_EQ(cloneLink1,
+      manager.ComponentData<components::ModelCanonicalLink>(clone));
+
+  // The joint points to the copied links
+  Entity cloneJoint{kNullEntity};
+  for (const Entity child : children)
+  {
+    if (manager.EntityHasComponentType(child,
+        components::DetachableJoint::typeId))
+    {
+      cloneJoint = child;
+    }
+  }
+  ASSERT_NE(kNullEntity, cloneJoint);
+  auto info = manager.ComponentData<components::DetachableJoint>(cloneJoint);
+  ASSERT_TRUE(info.has_value());
+  EXPECT_EQ(cloneLink1, info->parentLink);
+  EXPECT_EQ(clone, manager.ParentEntity(info->childLink));
+  EXPECT_NE(link2, info->childLink);
+
+  // The original is untouched
+  EXPECT_EQ("model", manager.ComponentData<components::Name>(model));
+  EXPECT_EQ(link1,
+      manager.ComponentData<components::ModelCanonicalLink>(model));
+  EXPECT_EQ(link1,
+      manager.Component<components::DetachableJoint>(joint)->Data()
+      .parentLink);
+
+  // Invalid requests
+  EXPECT_EQ(kNullEntity, manager.CloneSubtree(kNullEntity, world, ""));
+  EXPECT_EQ(kNullEntity, manager.CloneSubtree(model, link1, ""));
+  EXPECT_EQ(entityCount + 4, manager.EntityCount());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, LargeState)
+{
+  TaskPool pool(3);
+  manager.RunSetTaskPool(&pool);
+
+  // Enough entities to be serialized by several tasks
+  const int count = 1000;
+  std::vector<Entity> entities;
+  for (int i = 0; i < count; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent(entity, IntComponent(i));
+    entities.push_back(entity);
+  }
+
+  msgs::SerializedStateMap stateMsg;
+  manager.State(stateMsg);
+  ASSERT_EQ(static_cast<std::size_t>(count), stateMsg.entities().size());
+  for (int i = 0; i < count; ++i)
+  {
+    const auto &entityMsg = stateMsg.entities().at(entities[i]);
+    EXPECT_EQ(entities[i], entityMsg.id());
+    EXPECT_EQ(1, entityMsg.components().size());
+  }
+
+  // Only the requested entities are serialized
+  msgs::SerializedStateMap filteredMsg;
+  manager.State(filteredMsg, {entities[1], entities[500]});
+  EXPECT_EQ(2u, filteredMsg.entities().size());
+  EXPECT_EQ(1u, filteredMsg.entities().count(entities[1]));
+  EXPECT_EQ(1u, filteredMsg.entities().count(entities[500]));
+
+  // The cached split follows new entities
+  Entity extra = manager.CreateEntity();
+  manager.CreateComponent(extra, IntComponent(-1));
+  msgs::SerializedStateMap extraMsg;
+  manager.State(extraMsg);
+  EXPECT_EQ(static_cast<std::size_t>(count + 1), extraMsg.entities().size());
+  EXPECT_EQ(1u, extraMsg.entities().count(extra));
+
+  manager.RunSetTaskPool(nullptr);
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, SetLargeState)
+{
+  // Enough components to be decoded by several threads
+  const int count = 1000;
+  std::vector<Entity> entities;
+  for (int i = 0; i < count; ++i)
+  {
+    Entity entity = manager.CreateEntity();
+    manager.CreateComponent(entity, IntComponent(i));
+    manager.CreateComponent(entity, StringComponent(std::to_string(i)));
+    entities.push_back(entity);
+  }
+
+  msgs::SerializedStateMap stateMsg;
+  manager.State(stateMsg);
+
+  EntityCompMgrTest other;
+  other.SetState(stateMsg);
+  for (int i = 0; i < count; ++i)
+  {
+    ASSERT_NE(nullptr, other.Component<IntComponent>(entities[i]));
+    EXPECT_EQ(i, other.Component<IntComponent>(entities[i])->Data());
+    ASSERT_NE(nullptr, other.Component<StringComponent>(entities[i]));
+    EXPECT_EQ(std::to_string(i),
+        other.Component<StringComponent>(entities[i])->Data());
+  }
+
+  // Update some components, add and remove others, in one message
+  other.RunSetAllComponentsUnchanged();
+  for (int i = 0; i < count; i += 2)
+    manager.SetComponentData<IntComponent>(entities[i], -i);
+  manager.RemoveComponent<StringComponent>(entities[1]);
+  manager.CreateComponent(entities[3], DoubleComponent(0.5));
+  manager.State(stateMsg);
+  other.SetState(stateMsg);
+
+  for (int i = 0; i < count; ++i)
+  {
+    EXPECT_EQ(i % 2 ? i : -i,
+        other.Component<IntComponent>(entities[i])->Data());
+  }
+  EXPECT_EQ(ComponentState::PeriodicChange,
+      other.ComponentState(entities[0], IntComponent::typeId));
+  EXPECT_EQ(nullptr, other.Component<StringComponent>(entities[1]));
+  ASSERT_NE(nullptr, other.Component<DoubleComponent>(entities[3]));
+  EXPECT_DOUBLE_EQ(0.5, other.Component<DoubleComponent>(entities[3])->Data());
+  EXPECT_EQ("3", other.Component<StringComponent>(entities[3])->Data());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, CopyState)
+{
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent(e1, IntComponent(1));
+  manager.CreateComponent(e2, StringComponent("two"));
+
+  auto state = manager.CopyState();
+  ASSERT_EQ(2u, state.entities.size());
+  EXPECT_TRUE(state.oneTimeChanges);
+
+  // The copy doesn't change with the manager
+  manager.SetComponentData<IntComponent>(e1, 10);
+  manager.RequestRemoveEntity(e2);
+  manager.ProcessEntityRemovals();
+  EXPECT_FALSE(manager.HasEntity(e2));
+
+  manager.RunSetAllComponentsUnchanged();
+  manager.SetState(std::move(state));
+  EXPECT_TRUE(manager.HasEntity(e2));
+  EXPECT_EQ(1, manager.Component<IntComponent>(e1)->Data());
+  EXPECT_EQ(ComponentState::OneTimeChange,
+      manager.ComponentState(e1, IntComponent::typeId));
+  ASSERT_NE(nullptr, manager.Component<StringComponent>(e2));
+  EXPECT_EQ("two", manager.Component<StringComponent>(e2)->Data());
+}
+
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, Fork)
+{
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  manager.SetParentEntity(e2, e1);
+  manager.CreateComponent(e1, IntComponent(1));
+  manager.CreateComponent(e1, StringComponent("one"));
+  manager.CreateComponent(e2, IntComponent(2));
+  manager.RunClearNewlyCreatedEntities();
+  manager.RunSetAllComponentsUnchanged();
+
+  // Create a view on the source, which must survive its storage being copied
+  int sum = 0;
+  manager.Each<IntComponent>([&](const Entity &, const IntComponent *_int)
+      {
+        sum += _int->Data();
+        return true;
+      });
+  EXPECT_EQ(3, sum);
+
+  EntityCompMgrTest fork;
+  fork.Fork(manager);
+  EXPECT_EQ(2u, fork.EntityCount());
+  EXPECT_EQ(e1, fork.ParentEntity(e2));
+  EXPECT_TRUE(fork.HasNewEntities());
+
+  // Components are shared while they're only read
+  const EntityComponentManager &constManager = manager;
+  const EntityComponentManager &constFork = fork;
+  EXPECT_EQ(constManager.Component<IntComponent>(e1),
+      constFork.Component<IntComponent>(e1));
+  EXPECT_EQ(constManager.Component<StringComponent>(e1),
+      constFork.Component<StringComponent>(e1));
+
+  // Modifying the fork copies the storage of that type only
+  fork.Component<IntComponent>(e1)->Data() = 10;
+  EXPECT_NE(constManager.Component<IntComponent>(e1),
+      constFork.Component<IntComponent>(e1));
+  EXPECT_EQ(constManager.Component<StringComponent>(e1),
+      constFork.Component<StringComponent>(e1));
+  EXPECT_EQ(1, manager.Component<IntComponent>(e1)->Data());
+  EXPECT_EQ(10, fork.Component<IntComponent>(e1)->Data());
+
+  // Modifying the source doesn't affect the fork, and the source's views
+  // point to its own copy
+  manager.SetComponentData<StringComponent>(e1, "uno");
+  EXPECT_EQ("one", fork.Component<StringComponent>(e1)->Data());
+  manager.Each<IntComponent>([&](const Entity &, IntComponent *_int)
+      {
+        _int->Data() *= 2;
+        return true;
+      });
+  EXPECT_EQ(2, manager.Component<IntComponent>(e1)->Data());
+  EXPECT_EQ(10, fork.Component<IntComponent>(e1)->Data());
+  EXPECT_EQ(2, fork.Component<IntComponent>(e2)->Data());
+
+  // Entities and components are created and removed independently
+  Entity e3 = fork.CreateEntity();
+  fork.CreateComponent(e3, IntComponent(3));
+  fork.RequestRemoveEntity(e2);
+  fork.ProcessEntityRemovals();
+  EXPECT_FALSE(manager.HasEntity(e3));
+  EXPECT_TRUE(manager.HasEntity(e2));
+  EXPECT_EQ(4, manager.Component<IntComponent>(e2)->Data());
+  EXPECT_FALSE(fork.HasEntity(e2));
+
+  sum = 0;
+  fork.Each<IntComponent>([&](const Entity &, const IntComponent *_int)
+      {
+        sum += _int->Data();
+        return true;
+      });
+  EXPECT_EQ(13, sum);
+
+  // Removing all entities of the source leaves the fork alone
+  manager.RequestRemoveEntities();
+  manager.ProcessEntityRemovals();
+  EXPECT_EQ(0u, manager.EntityCount());
+  EXPECT_EQ(2u, fork.EntityCount());
+  EXPECT_EQ("one", fork.Component<StringComponent>(e1)->Data());
+}
+
 /////////////////////////////////////////////////
 TEST_P(EntityComponentManagerFixture, Descendants)
 {
@@ -2176,6 +4257,145 @@ TEST_P(EntityComponentManagerFixture, SetChanged)
       manager.ComponentState(e2, c2.first));
 }
 
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, ChangeGeneration)
+{
+  EXPECT_EQ(1u, manager.ChangeGeneration());
+
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(e1, IntComponent(123));
+  manager.CreateComponent<IntComponent>(e2, IntComponent(456));
+
+  // Creation counts as a change
+  EXPECT_TRUE(manager.ComponentChangedSince(e1, IntComponent::typeId, 1u));
+  EXPECT_TRUE(manager.ComponentChangedSince(e2, IntComponent::typeId, 1u));
+  EXPECT_FALSE(manager.ComponentChangedSince(e1, DoubleComponent::typeId,
+      1u));
+  EXPECT_FALSE(manager.ComponentChangedSince(999, IntComponent::typeId, 1u));
+
+  manager.RunSetAllComponentsUnchanged();
+  const uint64_t generation = manager.ChangeGeneration();
+  EXPECT_EQ(2u, generation);
+  EXPECT_FALSE(manager.ComponentChangedSince(e1, IntComponent::typeId,
+      generation));
+  EXPECT_FALSE(manager.ComponentChangedSince(e2, IntComponent::typeId,
+      generation));
+
+  manager.SetChanged(e2, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  EXPECT_FALSE(manager.ComponentChangedSince(e1, IntComponent::typeId,
+      generation));
+  EXPECT_TRUE(manager.ComponentChangedSince(e2, IntComponent::typeId,
+      generation));
+
+  // The generation of the last change is kept after the change state is
+  // cleared
+  manager.RunSetAllComponentsUnchanged();
+  manager.RunSetAllComponentsUnchanged();
+  EXPECT_EQ(4u, manager.ChangeGeneration());
+  EXPECT_EQ(ComponentState::NoChange,
+      manager.ComponentState(e2, IntComponent::typeId));
+  EXPECT_TRUE(manager.ComponentChangedSince(e2, IntComponent::typeId,
+      generation));
+  EXPECT_FALSE(manager.ComponentChangedSince(e2, IntComponent::typeId,
+      manager.ChangeGeneration()));
+
+  // Changes are cleared repeatedly without leaving stale state
+  for (int i = 0; i < 3; ++i)
+  {
+    manager.SetChanged(e1, IntComponent::typeId,
+        ComponentState::OneTimeChange);
+    manager.SetChanged(e1, IntComponent::typeId,
+        ComponentState::NoChange);
+    manager.SetChanged(e1, IntComponent::typeId,
+        ComponentState::PeriodicChange);
+    EXPECT_FALSE(manager.HasOneTimeComponentChanges());
+    EXPECT_EQ(1u, manager.ComponentTypesWithPeriodicChanges().size());
+    manager.RunSetAllComponentsUnchanged();
+    EXPECT_EQ(0u, manager.ComponentTypesWithPeriodicChanges().size());
+  }
+}
+
+//////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, EachChanged)
+{
+  Entity e1 = manager.CreateEntity();
+  Entity e2 = manager.CreateEntity();
+  Entity e3 = manager.CreateEntity();
+  manager.CreateComponent<IntComponent>(e1, IntComponent(1));
+  manager.CreateComponent<IntComponent>(e2, IntComponent(2));
+  manager.CreateComponent<IntComponent>(e3, IntComponent(3));
+  manager.CreateComponent<StringComponent>(e1, StringComponent("e1"));
+  manager.CreateComponent<StringComponent>(e3, StringComponent("e3"));
+
+  auto changed = [&](uint64_t &_token)
+  {
+    std::vector<Entity> entities;
+    manager.EachChanged<IntComponent>(_token,
+        [&](const Entity &_entity, const IntComponent *_int) -> bool
+        {
+          EXPECT_NE(nullptr, _int);
+          entities.push_back(_entity);
+          return true;
+        });
+    return entities;
+  };
+
+  // A new token visits all components
+  uint64_t token{0};
+  EXPECT_EQ(std::vector<Entity>({e1, e2, e3}), changed(token));
+  EXPECT_TRUE(changed(token).empty());
+
+  // Only changed components are visited, in the order of their last change
+  manager.RunSetAllComponentsUnchanged();
+  manager.SetChanged(e3, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  manager.SetChanged(e1, IntComponent::typeId,
+      ComponentState::OneTimeChange);
+  manager.SetChanged(e3, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  manager.SetChanged(e2, StringComponent::typeId,
+      ComponentState::PeriodicChange);
+  EXPECT_EQ(std::vector<Entity>({e1, e3}), changed(token));
+  EXPECT_TRUE(changed(token).empty());
+
+  // Changes are kept across iterations until the token catches up
+  uint64_t otherToken{token};
+  manager.SetChanged(e2, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  manager.RunSetAllComponentsUnchanged();
+  manager.SetChanged(e1, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  EXPECT_EQ(std::vector<Entity>({e2, e1}), changed(otherToken));
+
+  // Entities without all components are skipped
+  std::vector<Entity> entities;
+  manager.EachChanged<IntComponent, StringComponent>(token,
+      [&](const Entity &_entity, const IntComponent *,
+          const StringComponent *_string) -> bool
+      {
+        EXPECT_NE(nullptr, _string);
+        entities.push_back(_entity);
+        return true;
+      });
+  EXPECT_EQ(std::vector<Entity>({e1}), entities);
+
+  // Removed components aren't visited
+  manager.SetChanged(e2, IntComponent::typeId,
+      ComponentState::PeriodicChange);
+  EXPECT_TRUE(manager.RemoveComponent<IntComponent>(e2));
+  EXPECT_TRUE(changed(token).empty());
+
+  // Repeated changes don't make the log grow unbounded
+  for (int i = 0; i < 10000; ++i)
+  {
+    manager.SetChanged(e1, IntComponent::typeId,
+        ComponentState::PeriodicChange);
+  }
+  EXPECT_EQ(std::vector<Entity>({e1}), changed(token));
+}
+
 //////////////////////////////////////////////////
 TEST_P(EntityComponentManagerFixture, SetEntityCreateOffset)
 {
@@ -2187,6 +4407,26 @@ TEST_P(EntityComponentManagerFixture, SetEntityCreateOffset)
   manager.SetEntityCreateOffset(1000);
   Entity entity2 = manager.CreateEntity();
   EXPECT_EQ(1001u, entity2);
+
+  // Offsets can't reach the generation bits of recycled ids
+  manager.SetEntityRecycling(true);
+  const uint64_t slotCount = uint64_t{1} << kEntitySlotBits;
+  manager.SetEntityCreateOffset(slotCount);
+  EXPECT_EQ(1002u, manager.CreateEntity());
+
+  // Recycled ids keep their slot within the offset range
+  manager.RequestRemoveEntity(entity2);
+  manager.ProcessEntityRemovals();
+  Entity recycled = manager.CreateEntity();
+  EXPECT_EQ(1001u, entitySlot(recycled));
+  EXPECT_EQ(1u, entityGeneration(recycled));
+
+  // And recycling can't start once ids are past the slots
+  manager.SetEntityRecycling(false);
+  manager.SetEntityCreateOffset(slotCount);
+  EXPECT_EQ(slotCount + 1, manager.CreateEntity());
+  manager.SetEntityRecycling(true);
+  EXPECT_FALSE(manager.EntityRecycling());
 }
 
 //////////////////////////////////////////////////
@@ -2490,6 +4730,37 @@ TEST_P(EntityComponentManagerFixture, RemovedComponentsSyncBetweenServerAndGUI)
   }
 }
 
+/////////////////////////////////////////////////
+TEST_P(EntityComponentManagerFixture, StepMemory)
+{
+  auto *memory = manager.StepMemory();
+  ASSERT_NE(nullptr, memory);
+  EXPECT_EQ(memory, manager.StepMemory());
+
+  // Each thread gets its own resource
+  std::pmr::memory_resource *otherMemory{nullptr};
+  std::thread([&]
+  {
+    otherMemory = manager.StepMemory();
+  }).join();
+  EXPECT_NE(nullptr, otherMemory);
+  EXPECT_NE(memory, otherMemory);
+
+  // Memory is reused once the iteration is over
+  void *first{nullptr};
+  for (int i = 0; i < 4; ++i)
+  {
+    std::pmr::vector<Entity> entities(manager.StepMemory());
+    entities.resize(100);
+    // The first iteration grows the buffer
+    if (1 == i)
+      first = entities.data();
+    else if (i > 1)
+      EXPECT_EQ(first, entities.data());
+    manager.RunResetStepMemory();
+  }
+}
+
 // Run multiple times. We want to make sure that static globals don't cause
 // problems.
 INSTANTIATE_TEST_SUITE_P(EntityComponentManagerRepeat,
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <vector>
+
+#include "EntityHierarchy.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+//////////////////////////////////////////////////
+void EntityHierarchy::AddEntity(const Entity _entity)
+{
+  if (this->slots.find(_entity) != this->slots.end())
+    return;
+
+  uint32_t slot;
+  if (!this->freeSlots.empty())
+  {
+    slot = this->freeSlots.back();
+    this->freeSlots.pop_back();
+  }
+  else
+  {
+    slot = static_cast<uint32_t>(this->nodes.size());
+    this->nodes.emplace_back();
+  }
+
+  this->nodes[slot] = Node();
+  this->nodes[slot].entity = _entity;
+  this->slots[_entity] = slot;
+}
+
+//////////////////////////////////////////////////
+void EntityHierarchy::RemoveEntity(const Entity _entity)
+{
+  const uint32_t slot = this->Slot(_entity);
+  if (slot == kNoSlot)
+    return;
+
+  this->Detach(slot);
+
+  // Orphan the children.
+  uint32_t child = this->nodes[slot].firstChild;
+  while (child != kNoSlot)
+  {
+    const uint32_t next = this->nodes[child].nextSibling;
+    this->nodes[child].parent = kNoSlot;
+    this->nodes[child].prevSibling = kNoSlot;
+    this->nodes[child].nextSibling = kNoSlot;
+    child = next;
+  }
+
+  this->nodes[slot] = Node();
+  this->slots.erase(_entity);
+  this->freeSlots.push_back(slot);
+}
+
+//////////////////////////////////////////////////
+void EntityHierarchy::Clear()
+{
+  this->slots.clear();
+  this->nodes.clear();
+  this->freeSlots.clear();
+}
+
+//////////////////////////////////////////////////
+bool EntityHierarchy::HasEntity(const Entity _entity) const
+{
+  return this->Slot(_entity) != kNoSlot;
+}
+
+//////////////////////////////////////////////////
+bool EntityHierarchy::SetParent(const Entity _child, const Entity _parent)
+{
+  const uint32_t childSlot = this->Slot(_child);
+  if (childSlot == kNoSlot)
+    return false;
+
+  uint32_t parentSlot{kNoSlot};
+  if (_parent != kNullEntity)
+  {
+    parentSlot = this->Slot(_parent);
+    if (parentSlot == kNoSlot)
+      return false;
+
+    // Don't create cycles.
+    for (uint32_t slot = parentSlot; slot != kNoSlot;
+        slot = this->nodes[slot].parent)
+    {
+      if (slot == childSlot)
+        return false;
+    }
+  }
+
+  this->Detach(childSlot);
+  if (parentSlot == kNoSlot)
+    return true;
+
+  Node &parent = this->nodes[parentSlot];
+  Node &child = this->nodes[childSlot];
+  child.parent = parentSlot;
+  child.prevSibling = parent.lastChild;
+  if (parent.lastChild != kNoSlot)
+    this->nodes[parent.lastChild].nextSibling = childSlot;
+  else
+    parent.firstChild = childSlot;
+  parent.lastChild = childSlot;
+  return true;
+}
+
+//////////////////////////////////////////////////
+Entity EntityHierarchy::Parent(const Entity _entity) const
+{
+  const uint32_t slot = this->Slot(_entity);
+  if (slot == kNoSlot || this->nodes[slot].parent == kNoSlot)
+    return kNullEntity;
+  return this->nodes[this->nodes[slot].parent].entity;
+}
+
+//////////////////////////////////////////////////
+std::vector<Entity> EntityHierarchy::Children(const Entity _entity) const
+{
+  std::vector<Entity> result;
+  const uint32_t slot = this->Slot(_entity);
+  if (slot == kNoSlot)
+    return result;
+
+  for (uint32_t child = this->nodes[slot].firstChild; child != kNoSlot;
+      child = this->nodes[child].nextSibling)
+  {
+    result.push_back(this->nodes[child].entity);
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+void EntityHierarchy::DepthFirst(const Entity _entity,
+    const std::function<bool(const Entity &)> &_f) const
+{
+  const uint32_t root = this->Slot(_entity);
+  if (root == kNoSlot)
+    return;
+
+  // Walk the links instead of keeping a stack: go down to the first child,
+  // otherwise to the next sibling of the closest ancestor which has one.
+  uint32_t slot = root;
+  while (slot != kNoSlot)
+  {
+    const Node &node = this->nodes[slot];
+    if (!_f(node.entity))
+      return;
+
+    if (node.firstChild != kNoSlot)
+    {
+      slot = node.firstChild;
+      continue;
+    }
+
+    while (slot != root && this->nodes[slot].nextSibling == kNoSlot)
+      slot = this->nodes[slot].parent;
+
+    slot = slot == root ? kNoSlot : this->nodes[slot].nextSibling;
+  }
+}
+
+//////////////////////////////////////////////////
+void EntityHierarchy::BreadthFirst(const Entity _entity,
+    const std::function<bool(const Entity &)> &_f) const
+{
+  const uint32_t root = this->Slot(_entity);
+  if (root == kNoSlot)
+    return;
+
+  std::vector<uint32_t> queue{root};
+  for (std::size_t i = 0; i < queue.size(); ++i)
+  {
+    const Node &node = this->nodes[queue[i]];
+    if (!_f(node.entity))
+      return;
+
+    for (uint32_t child = node.firstChild; child != kNoSlot;
+        child = this->nodes[child].nextSibling)
+    {
+      queue.push_back(child);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+uint32_t EntityHierarchy::Slot(const Entity _entity) const
+{
+  auto iter = this->slots.find(_entity);
+  return iter == this->slots.end() ? kNoSlot : iter->second;
+}
+
+//////////////////////////////////////////////////
+void EntityHierarchy::Detach(const uint32_t _slot)
+{
+  Node &node = this->nodes[_slot];
+  if (node.parent == kNoSlot)
+    return;
+
+  Node &parent = this->nodes[node.parent];
+  if (node.prevSibling != kNoSlot)
+    this->nodes[node.prevSibling].nextSibling = node.nextSibling;
+  else
+    parent.firstChild = node.nextSibling;
+
+  if (node.nextSibling != kNoSlot)
+    this->nodes[node.nextSibling].prevSibling = node.prevSibling;
+  else
+    parent.lastChild = node.prevSibling;
+
+  node.parent = kNoSlot;
+  node.prevSibling = kNoSlot;
+  node.nextSibling = kNoSlot;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_ENTITYHIERARCHY_HH_
+#define IGNITION_GAZEBO_ENTITYHIERARCHY_HH_
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class EntityHierarchy EntityHierarchy.hh
+    /// \brief Parent and children of every entity, stored in flat arrays.
+    ///
+    /// Each entity is given a slot in the arrays. A slot holds the parent
+    /// and the first and last child of its entity, and links to the
+    /// previous and next sibling. Walking up or down the hierarchy only
+    /// follows slot indices, and changing a parent doesn't allocate.
+    /// Children are visited in the order they were added to their parent.
+    class IGNITION_GAZEBO_VISIBLE EntityHierarchy
+    {
+      /// \brief Add an entity without a parent. Has no effect if the entity
+      /// was already added.
+      /// \param[in] _entity Entity to add.
+      public: void AddEntity(const Entity _entity);
+
+      /// \brief Remove an entity. Its children are left without a parent.
+      /// \param[in] _entity Entity to remove.
+      public: void RemoveEntity(const Entity _entity);
+
+      /// \brief Remove all entities.
+      public: void Clear();
+
+      /// \brief Check whether an entity was added.
+      /// \param[in] _entity Entity to check.
+      /// \return True if the entity is in the hierarchy.
+      public: bool HasEntity(const Entity _entity) const;
+
+      /// \brief Set the parent of an entity, removing it from the children
+      /// of its current parent.
+      /// \param[in] _child Entity whose parent is set.
+      /// \param[in] _parent New parent, or kNullEntity to leave the entity
+      /// without a parent.
+      /// \return False if either entity wasn't added, or if the parent is
+      /// the child itself or one of its descendants.
+      public: bool SetParent(const Entity _child, const Entity _parent);
+
+      /// \brief Get the parent of an entity.
+      /// \param[in] _entity Entity.
+      /// \return Parent entity, or kNullEntity if it has no parent or wasn't
+      /// added.
+      public: Entity Parent(const Entity _entity) const;
+
+      /// \brief Get the immediate children of an entity.
+      /// \param[in] _entity Entity.
+      /// \return Children in the order they were added.
+      public: std::vector<Entity> Children(const Entity _entity) const;
+
+      /// \brief Visit an entity and all its descendants depth-first. Each
+      /// entity is visited before its children.
+      /// \param[in] _entity Entity where the traversal starts.
+      /// \param[in] _f Function called for each entity. Return false to stop
+      /// the traversal.
+      public: void DepthFirst(const Entity _entity,
+                  const std::function<bool(const Entity &)> &_f) const;
+
+      /// \brief Visit an entity and all its descendants breadth-first, that
+      /// is ordered by their depth below the entity.
+      /// \param[in] _entity Entity where the traversal starts.
+      /// \param[in] _f Function called for each entity. Return false to stop
+      /// the traversal.
+      public: void BreadthFirst(const Entity _entity,
+                  const std::function<bool(const Entity &)> &_f) const;
+
+      /// \brief Index used for missing slots.
+      private: static constexpr uint32_t kNoSlot{UINT32_MAX};
+
+      /// \brief Position of an entity in the hierarchy.
+      private: struct Node
+      {
+        /// \brief Entity stored in this slot, kNullEntity if it's free.
+        Entity entity{kNullEntity};
+
+        /// \brief Slot of the parent.
+        uint32_t parent{kNoSlot};
+
+        /// \brief Slot of the first child.
+        uint32_t firstChild{kNoSlot};
+
+        /// \brief Slot of the last child.
+        uint32_t lastChild{kNoSlot};
+
+        /// \brief Slot of the previous sibling.
+        uint32_t prevSibling{kNoSlot};
+
+        /// \brief Slot of the next sibling.
+        uint32_t nextSibling{kNoSlot};
+      };
+
+      /// \brief Get the slot of an entity.
+      /// \param[in] _entity Entity.
+      /// \return Slot, or kNoSlot if the entity wasn't added.
+      private: uint32_t Slot(const Entity _entity) const;
+
+      /// \brief Remove a slot from the children of its parent.
+      /// \param[in] _slot Slot to detach.
+      private: void Detach(const uint32_t _slot);
+
+      /// \brief Slot of each entity.
+      private: std::unordered_map<Entity, uint32_t> slots;
+
+      /// \brief Nodes, indexed by slot.
+      private: std::vector<Node> nodes;
+
+      /// \brief Slots of removed entities, which are reused first.
+      private: std::vector<uint32_t> freeSlots;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_ENTITYHIERARCHY_HH_
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "EntityHierarchy.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+/// \brief Collect the entities visited by a traversal.
+/// \param[in] _hierarchy Hierarchy to traverse.
+/// \param[in] _entity Entity where the traversal starts.
+/// \param[in] _depthFirst True for depth-first, false for breadth-first.
+/// \return Visited entities, in order.
+std::vector<Entity> Visit(const EntityHierarchy &_hierarchy, Entity _entity,
+    bool _depthFirst)
+{
+  std::vector<Entity> result;
+  auto collect = [&](const Entity &_visited)
+  {
+    result.push_back(_visited);
+    return true;
+  };
+
+  if (_depthFirst)
+    _hierarchy.DepthFirst(_entity, collect);
+  else
+    _hierarchy.BreadthFirst(_entity, collect);
+  return result;
+}
+
+/////////////////////////////////////////////////
+TEST(EntityHierarchy, Parenting)
+{
+  EntityHierarchy hierarchy;
+  for (Entity e = 1; e <= 4; ++e)
+    hierarchy.AddEntity(e);
+
+  EXPECT_TRUE(hierarchy.HasEntity(1));
+  EXPECT_FALSE(hierarchy.HasEntity(5));
+  EXPECT_EQ(kNullEntity, hierarchy.Parent(1));
+
+  EXPECT_TRUE(hierarchy.SetParent(2, 1));
+  EXPECT_TRUE(hierarchy.SetParent(3, 1));
+  EXPECT_TRUE(hierarchy.SetParent(4, 2));
+  EXPECT_EQ(1u, hierarchy.Parent(2));
+  EXPECT_EQ(2u, hierarchy.Parent(4));
+  EXPECT_EQ(std::vector<Entity>({2, 3}), hierarchy.Children(1));
+
+  // Missing entities and cycles are rejected
+  EXPECT_FALSE(hierarchy.SetParent(5, 1));
+  EXPECT_FALSE(hierarchy.SetParent(1, 5));
+  EXPECT_FALSE(hierarchy.SetParent(1, 4));
+  EXPECT_FALSE(hierarchy.SetParent(1, 1));
+  EXPECT_EQ(kNullEntity, hierarchy.Parent(1));
+
+  // Reparent
+  EXPECT_TRUE(hierarchy.SetParent(2, 3));
+  EXPECT_EQ(std::vector<Entity>({3}), hierarchy.Children(1));
+  EXPECT_EQ(std::vector<Entity>({2}), hierarchy.Children(3));
+
+  // Remove parent
+  EXPECT_TRUE(hierarchy.SetParent(3, kNullEntity));
+  EXPECT_EQ(kNullEntity, hierarchy.Parent(3));
+  EXPECT_TRUE(hierarchy.Children(1).empty());
+
+  // Removing an entity orphans its children
+  hierarchy.RemoveEntity(2);
+  EXPECT_FALSE(hierarchy.HasEntity(2));
+  EXPECT_EQ(kNullEntity, hierarchy.Parent(4));
+  EXPECT_TRUE(hierarchy.Children(3).empty());
+
+  // Slots are reused
+  hierarchy.AddEntity(10);
+  EXPECT_TRUE(hierarchy.SetParent(4, 10));
+  EXPECT_EQ(std::vector<Entity>({4}), hierarchy.Children(10));
+
+  hierarchy.Clear();
+  EXPECT_FALSE(hierarchy.HasEntity(1));
+  EXPECT_FALSE(hierarchy.HasEntity(10));
+}
+
+/////////////////////////////////////////////////
+TEST(EntityHierarchy, Traversal)
+{
+  /*
+   *        1
+   *      /   \
+   *     2     3
+   *    / \     \
+   *   4   5     6
+   *   |
+   *   7
+   */
+  EntityHierarchy hierarchy;
+  for (Entity e = 1; e <= 7; ++e)
+    hierarchy.AddEntity(e);
+  EXPECT_TRUE(hierarchy.SetParent(2, 1));
+  EXPECT_TRUE(hierarchy.SetParent(3, 1));
+  EXPECT_TRUE(hierarchy.SetParent(4, 2));
+  EXPECT_TRUE(hierarchy.SetParent(5, 2));
+  EXPECT_TRUE(hierarchy.SetParent(6, 3));
+  EXPECT_TRUE(hierarchy.SetParent(7, 4));
+
+  EXPECT_EQ(std::vector<Entity>({1, 2, 4, 7, 5, 3, 6}),
+      Visit(hierarchy, 1, true));
+  EXPECT_EQ(std::vector<Entity>({1, 2, 3, 4, 5, 6, 7}),
+      Visit(hierarchy, 1, false));
+
+  // Subtrees don't leave their root
+  EXPECT_EQ(std::vector<Entity>({2, 4, 7, 5}), Visit(hierarchy, 2, true));
+  EXPECT_EQ(std::vector<Entity>({2, 4, 5, 7}), Visit(hierarchy, 2, false));
+  EXPECT_EQ(std::vector<Entity>({7}), Visit(hierarchy, 7, true));
+  EXPECT_TRUE(Visit(hierarchy, 100, true).empty());
+
+  // Stop early
+  std::vector<Entity> visited;
+  hierarchy.DepthFirst(1, [&](const Entity &_entity)
+  {
+    visited.push_back(_entity);
+    return _entity != 4;
+  });
+  EXPECT_EQ(std::vector<Entity>({1, 2, 4}), visited);
+}
@@ -18,6 +18,9 @@
 #include <gtest/gtest.h>
 
 #include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
 
 #include "ignition/gazebo/Events.hh"
 #include "ignition/gazebo/EventManager.hh"
@@ -119,3 +122,110 @@ TEST(EventManager, Disambiguate)
   EXPECT_EQ(1, calls);
 }
 
+
+/////////////////////////////////////////////////
+TEST(EventManager, Deferred)
+{
+  EventManager eventManager;
+  using TestEvent = ignition::common::EventT<void(const std::string &, int),
+      struct DeferredTestEventTag>;
+
+  const auto emitter = std::this_thread::get_id();
+  std::string last;
+  int sum = 0;
+  bool otherThread = true;
+  auto connection = eventManager.ConnectDeferred<TestEvent>(
+      [&](const std::string &_name, int _value)
+      {
+        otherThread = otherThread && std::this_thread::get_id() != emitter;
+        last = _name;
+        sum += _value;
+      });
+  ASSERT_NE(nullptr, connection);
+
+  // Arguments are copied, so they may go away after emitting
+  for (int i = 1; i <= 10; ++i)
+  {
+    std::string name = "event" + std::to_string(i);
+    eventManager.Emit<TestEvent>(name, i);
+  }
+  eventManager.FlushDeferred();
+  EXPECT_TRUE(otherThread);
+  EXPECT_EQ("event10", last);
+  EXPECT_EQ(55, sum);
+
+  // Released connections aren't called anymore
+  connection.reset();
+  eventManager.Emit<TestEvent>("after", 1);
+  eventManager.FlushDeferred();
+  EXPECT_EQ("event10", last);
+  EXPECT_EQ(55, sum);
+}
+
+/////////////////////////////////////////////////
+TEST(EventManager, Channel)
+{
+  EventManager eventManager;
+
+  auto channel = eventManager.Channel<std::string>("/chatter");
+  ASSERT_NE(nullptr, channel);
+  EXPECT_EQ("/chatter", channel->Name());
+  EXPECT_FALSE(channel->HasConnections());
+  EXPECT_FALSE(channel->Publish("nobody"));
+
+  // Subscribers get the published message itself
+  const std::string *received{nullptr};
+  std::string last;
+  auto connection = eventManager.Channel<std::string>("/chatter")->Connect(
+      [&](const std::string &_msg)
+      {
+        received = &_msg;
+        last = _msg;
+      });
+  ASSERT_NE(nullptr, connection);
+  EXPECT_TRUE(channel->HasConnections());
+
+  const std::string msg{"hello"};
+  EXPECT_TRUE(channel->Publish(msg));
+  EXPECT_EQ(&msg, received);
+  EXPECT_EQ("hello", last);
+
+  // Channels are separate by name, and typed
+  EXPECT_FALSE(eventManager.Channel<std::string>("/other")->Publish("other"));
+  EXPECT_EQ("hello", last);
+  EXPECT_EQ(nullptr, eventManager.Channel<int>("/chatter"));
+
+  // Released connections aren't called anymore
+  connection.reset();
+  channel->Publish("after");
+  EXPECT_EQ("hello", last);
+}
+
+/////////////////////////////////////////////////
+TEST(EventManager, ChannelOutlivesManager)
+{
+  std::shared_ptr<InProcessChannel<int>> channel;
+  ignition::common::ConnectionPtr connection;
+  int sum{0};
+  {
+    EventManager eventManager;
+    channel = eventManager.Channel<int>("/numbers");
+    connection = channel->Connect([&](const int &_value)
+        {
+          sum += _value;
+        });
+  }
+
+  // Publishers on other threads can keep the channel
+  std::thread publisher([&]
+      {
+        for (int i = 1; i <= 10; ++i)
+          channel->Publish(i);
+      });
+  publisher.join();
+  EXPECT_EQ(55, sum);
+
+  connection.reset();
+  EXPECT_FALSE(channel->Publish(1));
+  EXPECT_EQ(55, sum);
+}
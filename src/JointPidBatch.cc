@@ -0,0 +1,436 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "JointPidBatch.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+
+#include "ignition/gazebo/components/JointForceCmd.hh"
+#include "ignition/gazebo/components/JointPosition.hh"
+#include "ignition/gazebo/components/JointVelocity.hh"
+#include "ignition/gazebo/Model.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+namespace
+{
+/// \brief What to do with a controller in the current iteration.
+enum class SlotState : uint8_t
+{
+  /// \brief Nothing, for example because its joint wasn't found yet.
+  SKIP,
+
+  /// \brief Command zero, like math::PID does for invalid errors or a
+  /// zero time step, without updating the PID.
+  ZERO,
+
+  /// \brief Update the PID and command its output.
+  ACTIVE
+};
+}
+
+class ignition::gazebo::JointPidBatchPrivate
+{
+  /// \brief Read the state of every joint and compute the errors.
+  /// \param[in] _info Update info.
+  /// \param[in] _ecm Entity component manager.
+  public: void Gather(const UpdateInfo &_info, EntityComponentManager &_ecm);
+
+  /// \brief Update the PIDs of the active controllers.
+  /// \param[in] _dt Time step in seconds.
+  public: void Compute(const double _dt);
+
+  /// \brief Write the force commands.
+  /// \param[in] _ecm Entity component manager.
+  public: void Scatter(EntityComponentManager &_ecm);
+
+  /// \brief Remove the controller at an index of the arrays, moving the
+  /// last one into its place.
+  /// \param[in] _index Index of the controller.
+  public: void RemoveAt(const std::size_t _index);
+
+  /// \brief Controllers, in the order of all the arrays below.
+  public: std::vector<JointPidBatch::Controller> controllers;
+
+  /// \brief Id of each controller.
+  public: std::vector<uint64_t> ids;
+
+  /// \brief Index of each controller in the arrays, by id.
+  public: std::unordered_map<uint64_t, std::size_t> indices;
+
+  /// \brief Joint of each controller, null until it's found.
+  public: std::vector<Entity> joints;
+
+  /// \brief Whether an invalid axis was reported for each controller.
+  public: std::vector<char> invalidAxisReported;
+
+  /// \brief Target position or velocity of each controller.
+  public: std::vector<double> targets;
+
+  /// \brief Proportional gains.
+  public: std::vector<double> p;
+
+  /// \brief Integral gains.
+  public: std::vector<double> i;
+
+  /// \brief Derivative gains.
+  public: std::vector<double> d;
+
+  /// \brief Integral lower limits, negative infinity when disabled.
+  public: std::vector<double> iLow;
+
+  /// \brief Integral upper limits, infinity when disabled.
+  public: std::vector<double> iHigh;
+
+  /// \brief Command lower limits, negative infinity when disabled.
+  public: std::vector<double> cmdLow;
+
+  /// \brief Command upper limits, infinity when disabled.
+  public: std::vector<double> cmdHigh;
+
+  /// \brief Command offsets.
+  public: std::vector<double> cmdOffset;
+
+  /// \brief Integral errors.
+  public: std::vector<double> iErr;
+
+  /// \brief Errors of the last update.
+  public: std::vector<double> pErrLast;
+
+  /// \brief Errors of the current iteration.
+  public: std::vector<double> err;
+
+  /// \brief Last commands.
+  public: std::vector<double> cmd;
+
+  /// \brief State of each controller in the current iteration.
+  public: std::vector<SlotState> states;
+
+  /// \brief Id of the next controller.
+  public: uint64_t nextId{1};
+
+  /// \brief Last iteration that was evaluated.
+  public: uint64_t lastIteration{0};
+
+  /// \brief Protects all of the above from concurrent target changes.
+  public: mutable std::mutex mutex;
+};
+
+//////////////////////////////////////////////////
+JointPidBatch::JointPidBatch()
+  : dataPtr(std::make_unique<JointPidBatchPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+JointPidBatch::~JointPidBatch() = default;
+
+//////////////////////////////////////////////////
+std::shared_ptr<JointPidBatch> JointPidBatch::Get(
+    const EntityComponentManager &_ecm)
+{
+  return _ecm.SharedObject<JointPidBatch>(
+      "ignition::gazebo::JointPidBatch");
+}
+
+//////////////////////////////////////////////////
+uint64_t JointPidBatch::Add(const Controller &_controller)
+{
+  constexpr double inf = std::numeric_limits<double>::infinity();
+  const Gains &gains = _controller.gains;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  const uint64_t id = this->dataPtr->nextId++;
+  this->dataPtr->indices[id] = this->dataPtr->ids.size();
+  this->dataPtr->ids.push_back(id);
+  this->dataPtr->controllers.push_back(_controller);
+  this->dataPtr->joints.push_back(kNullEntity);
+  this->dataPtr->invalidAxisReported.push_back(false);
+  this->dataPtr->targets.push_back(0.0);
+  this->dataPtr->p.push_back(gains.p);
+  this->dataPtr->i.push_back(gains.i);
+  this->dataPtr->d.push_back(gains.d);
+
+  // Limits are only enforced if the upper one isn't less than the lower
+  // one, like math::PID does.
+  const bool iLimited = gains.iMax >= gains.iMin;
+  this->dataPtr->iLow.push_back(iLimited ? gains.iMin : -inf);
+  this->dataPtr->iHigh.push_back(iLimited ? gains.iMax : inf);
+  const bool cmdLimited = gains.cmdMax >= gains.cmdMin;
+  this->dataPtr->cmdLow.push_back(cmdLimited ? gains.cmdMin : -inf);
+  this->dataPtr->cmdHigh.push_back(cmdLimited ? gains.cmdMax : inf);
+  this->dataPtr->cmdOffset.push_back(gains.cmdOffset);
+
+  this->dataPtr->iErr.push_back(0.0);
+  this->dataPtr->pErrLast.push_back(0.0);
+  this->dataPtr->err.push_back(0.0);
+  this->dataPtr->cmd.push_back(0.0);
+  this->dataPtr->states.push_back(SlotState::SKIP);
+  return id;
+}
+
+//////////////////////////////////////////////////
+void JointPidBatch::Remove(const uint64_t _id)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto iter = this->dataPtr->indices.find(_id);
+  if (iter == this->dataPtr->indices.end())
+    return;
+
+  const std::size_t index = iter->second;
+  this->dataPtr->indices.erase(iter);
+  this->dataPtr->RemoveAt(index);
+}
+
+//////////////////////////////////////////////////
+void JointPidBatch::SetTarget(const uint64_t _id, const double _target)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto iter = this->dataPtr->indices.find(_id);
+  if (iter != this->dataPtr->indices.end())
+    this->dataPtr->targets[iter->second] = _target;
+}
+
+//////////////////////////////////////////////////
+double JointPidBatch::Command(const uint64_t _id) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto iter = this->dataPtr->indices.find(_id);
+  if (iter == this->dataPtr->indices.end())
+    return 0.0;
+  return this->dataPtr->cmd[iter->second];
+}
+
+//////////////////////////////////////////////////
+std::size_t JointPidBatch::Count() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->ids.size();
+}
+
+//////////////////////////////////////////////////
+void JointPidBatch::Update(const UpdateInfo &_info,
+    EntityComponentManager &_ecm)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (this->dataPtr->lastIteration == _info.iterations)
+    return;
+  this->dataPtr->lastIteration = _info.iterations;
+
+  IGN_PROFILE("JointPidBatch::Update");
+  this->dataPtr->Gather(_info, _ecm);
+  this->dataPtr->Compute(std::chrono::duration<double>(_info.dt).count());
+  this->dataPtr->Scatter(_ecm);
+}
+
+//////////////////////////////////////////////////
+void JointPidBatchPrivate::Gather(const UpdateInfo &_info,
+    EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("JointPidBatch::Gather");
+  const bool zeroStep = _info.dt == std::chrono::steady_clock::duration::zero();
+  for (std::size_t k = 0; k < this->controllers.size(); ++k)
+  {
+    const auto &controller = this->controllers[k];
+    this->states[k] = SlotState::SKIP;
+    this->err[k] = 0.0;
+
+    // If the joint hasn't been identified yet, look for it
+    if (this->joints[k] == kNullEntity)
+    {
+      this->joints[k] = Model(controller.model).JointByName(_ecm,
+          controller.jointName);
+      if (this->joints[k] == kNullEntity)
+        continue;
+    }
+
+    // Create the joint state component if it doesn't exist, physics fills
+    // it from the next iteration on
+    const std::vector<double> *state{nullptr};
+    if (controller.input == JointPidBatch::Input::POSITION)
+    {
+      auto comp = _ecm.Component<components::JointPosition>(this->joints[k]);
+      if (nullptr == comp)
+      {
+        _ecm.CreateComponent(this->joints[k], components::JointPosition());
+        continue;
+      }
+      state = &comp->Data();
+    }
+    else
+    {
+      auto comp = _ecm.Component<components::JointVelocity>(this->joints[k]);
+      if (nullptr == comp)
+      {
+        _ecm.CreateComponent(this->joints[k], components::JointVelocity());
+        continue;
+      }
+      state = &comp->Data();
+    }
+
+    if (controller.axis >= state->size())
+    {
+      // Physics may not have filled the component yet
+      if (!state->empty() && !this->invalidAxisReported[k])
+      {
+        ignerr << "[" << controller.owner << "]: Detected an invalid "
+               << "<joint_index> parameter. The index specified is ["
+               << controller.axis << "] but the joint only has ["
+               << state->size() << "] index[es]. "
+               << "This controller will be ignored" << std::endl;
+        this->invalidAxisReported[k] = true;
+      }
+      continue;
+    }
+
+    const double error = (*state)[controller.axis] - this->targets[k];
+    if (zeroStep || !std::isfinite(error))
+    {
+      this->states[k] = SlotState::ZERO;
+      continue;
+    }
+
+    this->err[k] = error;
+    this->states[k] = SlotState::ACTIVE;
+  }
+}
+
+//////////////////////////////////////////////////
+void JointPidBatchPrivate::Compute(const double _dt)
+{
+  IGN_PROFILE("JointPidBatch::Compute");
+  const std::size_t count = this->controllers.size();
+
+  const double *pGain = this->p.data();
+  const double *iGain = this->i.data();
+  const double *dGain = this->d.data();
+  const double *iLo = this->iLow.data();
+  const double *iHi = this->iHigh.data();
+  const double *cmdLo = this->cmdLow.data();
+  const double *cmdHi = this->cmdHigh.data();
+  const double *offset = this->cmdOffset.data();
+  const double *error = this->err.data();
+  const SlotState *state = this->states.data();
+  double *integral = this->iErr.data();
+  double *last = this->pErrLast.data();
+  double *out = this->cmd.data();
+
+  // Inactive controllers have a zero error, so every lane stays finite and
+  // the results are only selected for the active ones. A zero time step
+  // makes every controller inactive, so any divisor works then.
+  const double dt = _dt == 0.0 ? 1.0 : _dt;
+  for (std::size_t k = 0; k < count; ++k)
+  {
+    const double e = error[k];
+    const double iNew = std::max(std::min(
+        integral[k] + iGain[k] * dt * e, iHi[k]), iLo[k]);
+    const double dErr = (e - last[k]) / dt;
+    const double c = std::max(std::min(
+        offset[k] - pGain[k] * e - iNew - dGain[k] * dErr, cmdHi[k]),
+        cmdLo[k]);
+
+    const bool active = state[k] == SlotState::ACTIVE;
+    integral[k] = active ? iNew : integral[k];
+    last[k] = active ? e : last[k];
+    out[k] = active ? c : 0.0;
+  }
+}
+
+//////////////////////////////////////////////////
+void JointPidBatchPrivate::Scatter(EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("JointPidBatch::Scatter");
+  for (std::size_t k = 0; k < this->controllers.size(); ++k)
+  {
+    if (this->states[k] == SlotState::SKIP)
+      continue;
+
+    const double force = this->cmd[k];
+    auto forceComp = _ecm.Component<components::JointForceCmd>(
+        this->joints[k]);
+    if (forceComp == nullptr)
+    {
+      _ecm.CreateComponent(this->joints[k],
+          components::JointForceCmd({force}));
+    }
+    else
+    {
+      // Axes beyond the command are left to whoever sized it
+      auto &forces = forceComp->Data();
+      const unsigned int axis = this->controllers[k].axis;
+      if (axis < forces.size())
+        forces[axis] = force;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void JointPidBatchPrivate::RemoveAt(const std::size_t _index)
+{
+  const std::size_t last = this->ids.size() - 1;
+  if (_index != last)
+  {
+    this->indices[this->ids[last]] = _index;
+    this->ids[_index] = this->ids[last];
+    this->controllers[_index] = std::move(this->controllers[last]);
+    this->joints[_index] = this->joints[last];
+    this->invalidAxisReported[_index] = this->invalidAxisReported[last];
+    this->targets[_index] = this->targets[last];
+    this->p[_index] = this->p[last];
+    this->i[_index] = this->i[last];
+    this->d[_index] = this->d[last];
+    this->iLow[_index] = this->iLow[last];
+    this->iHigh[_index] = this->iHigh[last];
+    this->cmdLow[_index] = this->cmdLow[last];
+    this->cmdHigh[_index] = this->cmdHigh[last];
+    this->cmdOffset[_index] = this->cmdOffset[last];
+    this->iErr[_index] = this->iErr[last];
+    this->pErrLast[_index] = this->pErrLast[last];
+    this->err[_index] = this->err[last];
+    this->cmd[_index] = this->cmd[last];
+    this->states[_index] = this->states[last];
+  }
+
+  this->ids.pop_back();
+  this->controllers.pop_back();
+  this->joints.pop_back();
+  this->invalidAxisReported.pop_back();
+  this->targets.pop_back();
+  this->p.pop_back();
+  this->i.pop_back();
+  this->d.pop_back();
+  this->iLow.pop_back();
+  this->iHigh.pop_back();
+  this->cmdLow.pop_back();
+  this->cmdHigh.pop_back();
+  this->cmdOffset.pop_back();
+  this->iErr.pop_back();
+  this->pErrLast.pop_back();
+  this->err.pop_back();
+  this->cmd.pop_back();
+  this->states.pop_back();
+}
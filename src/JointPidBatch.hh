@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_JOINTPIDBATCH_HH_
+#define IGNITION_GAZEBO_JOINTPIDBATCH_HH_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class JointPidBatchPrivate;
+
+    /// \class JointPidBatch JointPidBatch.hh
+    /// \brief Evaluates the PIDs of all joint controllers of a world in a
+    /// single pass.
+    ///
+    /// Joint controller systems add their PID to the batch of their entity
+    /// component manager, and call Update from their PreUpdate. The first
+    /// call of each iteration reads the position or velocity of every
+    /// controlled joint, updates all PIDs over contiguous arrays in one loop
+    /// the compiler can vectorize, and writes the force commands. The PIDs
+    /// behave like ignition::math::PID.
+    class IGNITION_GAZEBO_VISIBLE JointPidBatch
+    {
+      /// \brief Joint state a PID controls.
+      public: enum class Input
+      {
+        /// \brief Joint position, from components::JointPosition.
+        POSITION,
+
+        /// \brief Joint velocity, from components::JointVelocity.
+        VELOCITY
+      };
+
+      /// \brief Parameters of a PID, see ignition::math::PID::Init.
+      public: struct Gains
+      {
+        /// \brief Proportional gain.
+        double p{1.0};
+
+        /// \brief Integral gain.
+        double i{0.0};
+
+        /// \brief Derivative gain.
+        double d{0.0};
+
+        /// \brief Integral upper limit, ignored if lower than iMin.
+        double iMax{1.0};
+
+        /// \brief Integral lower limit.
+        double iMin{-1.0};
+
+        /// \brief Command upper limit, ignored if lower than cmdMin.
+        double cmdMax{1000.0};
+
+        /// \brief Command lower limit.
+        double cmdMin{-1000.0};
+
+        /// \brief Command offset, i.e. feed-forward.
+        double cmdOffset{0.0};
+      };
+
+      /// \brief A joint controller.
+      public: struct Controller
+      {
+        /// \brief Model which has the joint.
+        Entity model{kNullEntity};
+
+        /// \brief Name of the joint within the model.
+        std::string jointName;
+
+        /// \brief Axis of the joint.
+        unsigned int axis{0u};
+
+        /// \brief Joint state controlled.
+        Input input{Input::POSITION};
+
+        /// \brief PID parameters.
+        Gains gains;
+
+        /// \brief Name used in messages, such as the system's name.
+        std::string owner;
+      };
+
+      /// \brief Constructor
+      public: JointPidBatch();
+
+      /// \brief Destructor
+      public: ~JointPidBatch();
+
+      /// \brief Get the batch of an entity component manager, creating it
+      /// if needed. The batch is kept while any controller holds it.
+      /// \param[in] _ecm Entity component manager of the joints.
+      /// \return The shared batch.
+      public: static std::shared_ptr<JointPidBatch> Get(
+                  const EntityComponentManager &_ecm);
+
+      /// \brief Add a controller. Its target starts at zero.
+      /// \param[in] _controller Controller to add.
+      /// \return Id of the controller.
+      public: uint64_t Add(const Controller &_controller);
+
+      /// \brief Remove a controller.
+      /// \param[in] _id Id returned by Add.
+      public: void Remove(const uint64_t _id);
+
+      /// \brief Set the target position or velocity of a controller. This
+      /// can be called from any thread, for example from a transport
+      /// callback. Unknown ids are ignored.
+      /// \param[in] _id Id returned by Add.
+      /// \param[in] _target Target of the joint state.
+      public: void SetTarget(const uint64_t _id, const double _target);
+
+      /// \brief Get the force last commanded by a controller.
+      /// \param[in] _id Id returned by Add.
+      /// \return Force, or zero if the id is unknown.
+      public: double Command(const uint64_t _id) const;
+
+      /// \brief Get the number of controllers.
+      /// \return Number of controllers.
+      public: std::size_t Count() const;
+
+      /// \brief Update all the controllers and write their force commands.
+      /// Only the first call of each iteration does any work. Not to be
+      /// called while paused.
+      /// \param[in] _info Update info.
+      /// \param[in] _ecm Entity component manager of the joints.
+      public: void Update(const UpdateInfo &_info,
+                  EntityComponentManager &_ecm);
+
+      /// \brief Pointer to private data.
+      private: std::unique_ptr<JointPidBatchPrivate> dataPtr;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_JOINTPIDBATCH_HH_
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <ignition/math/PID.hh>
+
+#include "ignition/gazebo/components/Joint.hh"
+#include "ignition/gazebo/components/JointForceCmd.hh"
+#include "ignition/gazebo/components/JointPosition.hh"
+#include "ignition/gazebo/components/JointVelocity.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+
+#include "JointPidBatch.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+class JointPidBatchTest : public ::testing::Test
+{
+  /// \brief Create a model with a joint.
+  /// \param[in] _name Name of the joint.
+  /// \return The joint.
+  protected: Entity CreateJoint(const std::string &_name)
+  {
+    const Entity joint = this->ecm.CreateEntity();
+    this->ecm.CreateComponent(joint, components::Joint());
+    this->ecm.CreateComponent(joint, components::Name(_name));
+    this->ecm.CreateComponent(joint, components::ParentEntity(this->model));
+    return joint;
+  }
+
+  /// \brief Get the next update info.
+  /// \return Update info of the next iteration.
+  protected: UpdateInfo Next()
+  {
+    UpdateInfo info;
+    info.dt = std::chrono::milliseconds(1);
+    info.iterations = ++this->iterations;
+    info.simTime = info.dt * static_cast<int>(this->iterations);
+    info.paused = false;
+    return info;
+  }
+
+  // Documentation inherited
+  protected: void SetUp() override
+  {
+    this->model = this->ecm.CreateEntity();
+    this->ecm.CreateComponent(this->model, components::Model());
+    this->ecm.CreateComponent(this->model, components::Name("model"));
+  }
+
+  /// \brief Entity component manager
+  protected: EntityComponentManager ecm;
+
+  /// \brief Model of the joints
+  protected: Entity model{kNullEntity};
+
+  /// \brief Iterations so far
+  protected: uint64_t iterations{0};
+};
+
+/////////////////////////////////////////////////
+TEST_F(JointPidBatchTest, Shared)
+{
+  auto batch = JointPidBatch::Get(this->ecm);
+  EXPECT_EQ(batch, JointPidBatch::Get(this->ecm));
+
+  EntityComponentManager other;
+  EXPECT_NE(batch, JointPidBatch::Get(other));
+
+  const uint64_t id = batch->Add({});
+  EXPECT_EQ(1u, batch->Count());
+  batch->Remove(id);
+  EXPECT_EQ(0u, batch->Count());
+
+  // Unknown ids are ignored
+  batch->Remove(id);
+  batch->SetTarget(id, 1.0);
+  EXPECT_DOUBLE_EQ(0.0, batch->Command(id));
+}
+
+/////////////////////////////////////////////////
+TEST_F(JointPidBatchTest, MatchesPid)
+{
+  const Entity posJoint = this->CreateJoint("pos");
+  const Entity velJoint = this->CreateJoint("vel");
+
+  JointPidBatch::Controller posController;
+  posController.model = this->model;
+  posController.jointName = "pos";
+  posController.axis = 1;
+  posController.gains.p = 2.0;
+  posController.gains.i = 0.5;
+  posController.gains.d = 0.1;
+  posController.gains.iMax = 0.2;
+  posController.gains.iMin = -0.2;
+  posController.gains.cmdMax = 3.0;
+  posController.gains.cmdMin = -3.0;
+  posController.gains.cmdOffset = 0.25;
+
+  // Limits which are disabled
+  JointPidBatch::Controller velController;
+  velController.model = this->model;
+  velController.jointName = "vel";
+  velController.input = JointPidBatch::Input::VELOCITY;
+  velController.gains.p = 5.0;
+  velController.gains.i = 1.0;
+  velController.gains.iMax = -1.0;
+  velController.gains.iMin = 1.0;
+  velController.gains.cmdMax = -1.0;
+  velController.gains.cmdMin = 1.0;
+
+  auto batch = JointPidBatch::Get(this->ecm);
+  const uint64_t posId = batch->Add(posController);
+  const uint64_t velId = batch->Add(velController);
+  batch->SetTarget(posId, 1.0);
+  batch->SetTarget(velId, -2.0);
+
+  math::PID posPid;
+  posPid.Init(2.0, 0.5, 0.1, 0.2, -0.2, 3.0, -3.0, 0.25);
+  math::PID velPid;
+  velPid.Init(5.0, 1.0, 0.0, -1.0, 1.0, -1.0, 1.0, 0.0);
+
+  // The state components are created on the first update
+  batch->Update(this->Next(), this->ecm);
+  ASSERT_NE(nullptr, this->ecm.Component<components::JointPosition>(posJoint));
+  ASSERT_NE(nullptr, this->ecm.Component<components::JointVelocity>(velJoint));
+  EXPECT_EQ(nullptr, this->ecm.Component<components::JointForceCmd>(posJoint));
+  this->ecm.CreateComponent(posJoint, components::JointForceCmd({0.0, 0.0}));
+
+  for (int step = 0; step < 50; ++step)
+  {
+    const double pos = std::sin(step * 0.1);
+    const double vel = std::cos(step * 0.3) * 4.0;
+    this->ecm.SetComponentData<components::JointPosition>(posJoint,
+        {0.0, pos});
+    this->ecm.SetComponentData<components::JointVelocity>(velJoint, {vel});
+
+    // Later calls in the same iteration do nothing
+    const UpdateInfo info = this->Next();
+    batch->Update(info, this->ecm);
+    batch->Update(info, this->ecm);
+
+    const double posForce = posPid.Update(pos - 1.0, info.dt);
+    const double velForce = velPid.Update(vel + 2.0, info.dt);
+    EXPECT_NEAR(posForce, batch->Command(posId), 1e-12) << step;
+    EXPECT_NEAR(velForce, batch->Command(velId), 1e-12) << step;
+
+    auto posCmd = this->ecm.Component<components::JointForceCmd>(posJoint);
+    ASSERT_NE(nullptr, posCmd);
+    ASSERT_EQ(2u, posCmd->Data().size());
+    EXPECT_DOUBLE_EQ(batch->Command(posId), posCmd->Data()[1]);
+    auto velCmd = this->ecm.Component<components::JointForceCmd>(velJoint);
+    ASSERT_NE(nullptr, velCmd);
+    EXPECT_DOUBLE_EQ(batch->Command(velId), velCmd->Data()[0]);
+  }
+
+  // Invalid errors command zero without updating the PID
+  this->ecm.SetComponentData<components::JointVelocity>(velJoint,
+      {std::numeric_limits<double>::quiet_NaN()});
+  batch->Update(this->Next(), this->ecm);
+  EXPECT_DOUBLE_EQ(0.0, batch->Command(velId));
+  EXPECT_DOUBLE_EQ(0.0,
+      this->ecm.Component<components::JointForceCmd>(velJoint)->Data()[0]);
+
+  this->ecm.SetComponentData<components::JointVelocity>(velJoint, {1.0});
+  const UpdateInfo info = this->Next();
+  batch->Update(info, this->ecm);
+  EXPECT_NEAR(velPid.Update(3.0, info.dt), batch->Command(velId), 1e-12);
+
+  // Removing a controller keeps the others
+  batch->Remove(posId);
+  EXPECT_EQ(1u, batch->Count());
+  this->ecm.SetComponentData<components::JointVelocity>(velJoint, {0.5});
+  const UpdateInfo last = this->Next();
+  batch->Update(last, this->ecm);
+  EXPECT_NEAR(velPid.Update(2.5, last.dt), batch->Command(velId), 1e-12);
+}
+
+/////////////////////////////////////////////////
+TEST_F(JointPidBatchTest, InvalidAxis)
+{
+  const Entity joint = this->CreateJoint("joint");
+
+  JointPidBatch::Controller controller;
+  controller.model = this->model;
+  controller.jointName = "joint";
+  controller.axis = 2;
+
+  auto batch = JointPidBatch::Get(this->ecm);
+  const uint64_t id = batch->Add(controller);
+  batch->SetTarget(id, 1.0);
+
+  batch->Update(this->Next(), this->ecm);
+  this->ecm.SetComponentData<components::JointPosition>(joint, {0.0});
+  batch->Update(this->Next(), this->ecm);
+  EXPECT_DOUBLE_EQ(0.0, batch->Command(id));
+  EXPECT_EQ(nullptr, this->ecm.Component<components::JointForceCmd>(joint));
+
+  // Missing joints are looked up again
+  controller.jointName = "later";
+  const uint64_t laterId = batch->Add(controller);
+  batch->Update(this->Next(), this->ecm);
+  const Entity later = this->CreateJoint("later");
+  batch->Update(this->Next(), this->ecm);
+  EXPECT_NE(nullptr, this->ecm.Component<components::JointPosition>(later));
+  batch->Remove(laterId);
+}
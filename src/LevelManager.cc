@@ -50,6 +50,7 @@
 #include "ignition/gazebo/components/PhysicsEnginePlugin.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/RenderEngineGuiPlugin.hh"
+#include "ignition/gazebo/components/RenderCpus.hh"
 #include "ignition/gazebo/components/RenderEngineServerPlugin.hh"
 #include "ignition/gazebo/components/Scene.hh"
 #include "ignition/gazebo/components/Wind.hh"
@@ -86,6 +87,54 @@ LevelManager::LevelManager(SimulationRunner *_runner, const bool _useLevels)
     return;
   }
   this->node.Advertise(service, &LevelManager::OnSetPerformer, this);
+
+  std::string statsTopic = transport::TopicUtils::AsValidTopic("/world/" +
+      this->runner->sdfWorld->Name() + "/level/prefetch_stats");
+  if (!statsTopic.empty())
+  {
+    this->prefetchStatsPub =
+        this->node.Advertise<msgs::Param>(statsTopic);
+  }
+}
+
+/////////////////////////////////////////////////
+LevelManager::LevelManager(SimulationRunner *_runner,
+    const LevelManager &_source)
+    : runner(_runner), useLevels(_source.useLevels)
+{
+  if (nullptr == _runner)
+  {
+    ignerr << "Can't start level manager with null runner." << std::endl;
+    return;
+  }
+
+  this->entityCreator = std::make_unique<SdfEntityCreator>(
+      this->runner->entityCompMgr,
+      this->runner->eventMgr);
+
+  this->activeLevels = _source.activeLevels;
+  this->activeEntityNames = _source.activeEntityNames;
+  this->performerMap = _source.performerMap;
+  this->entityNamesInLevels = _source.entityNamesInLevels;
+  this->worldEntity = _source.worldEntity;
+  this->levelRegions = _source.levelRegions;
+  this->performerVolumes = _source.performerVolumes;
+  this->sdfByName = _source.sdfByName;
+  this->pendingLoads = _source.pendingLoads;
+  this->loadBudget = _source.loadBudget;
+  this->prefetchTime = _source.prefetchTime;
+  this->performerMotions = _source.performerMotions;
+  this->performerInside = _source.performerInside;
+  this->prefetchedLevels = _source.prefetchedLevels;
+  this->unloadHysteresis = _source.unloadHysteresis;
+  this->minResidency = _source.minResidency;
+  this->levelLoadTimes = _source.levelLoadTimes;
+  this->deferredUnloads = _source.deferredUnloads;
+  this->unloadedLevels = _source.unloadedLevels;
+
+  this->levelIndex.SetCellSize(_source.levelIndex.CellSize());
+  for (const auto &[entity, region] : this->levelRegions)
+    this->levelIndex.Update(entity, region.keep);
 }
 
 /////////////////////////////////////////////////
@@ -126,6 +175,12 @@ void LevelManager::ReadLevelPerformerInfo()
       components::RenderEngineGuiPlugin(
       this->runner->serverConfig.RenderEngineGui()));
 
+  if (!this->runner->serverConfig.RenderCpus().empty())
+  {
+    this->runner->entityCompMgr.CreateComponent(this->worldEntity,
+        components::RenderCpus(this->runner->serverConfig.RenderCpus()));
+  }
+
   auto worldElem = this->runner->sdfWorld->Element();
 
   // Create Wind
@@ -186,6 +241,23 @@ void LevelManager::ReadLevelPerformerInfo()
       this->ReadLevels(pluginElem);
   }
 
+  // Look up entities by name when loading levels
+  for (uint64_t i = 0; i < this->runner->sdfWorld->ModelCount(); ++i)
+  {
+    auto model = this->runner->sdfWorld->ModelByIndex(i);
+    this->sdfByName[model->Name()].model = model;
+  }
+  for (uint64_t i = 0; i < this->runner->sdfWorld->ActorCount(); ++i)
+  {
+    auto actor = this->runner->sdfWorld->ActorByIndex(i);
+    this->sdfByName[actor->Name()].actor = actor;
+  }
+  for (uint64_t i = 0; i < this->runner->sdfWorld->LightCount(); ++i)
+  {
+    auto light = this->runner->sdfWorld->LightByIndex(i);
+    this->sdfByName[light->Name()].light = light;
+  }
+
   this->ConfigureDefaultLevel();
 
   // Load world plugins.
@@ -342,6 +414,56 @@ void LevelManager::ReadLevels(const sdf::ElementPtr &_sdf)
   if (_sdf == nullptr)
     return;
 
+  if (_sdf->HasElement("level_load_budget"))
+  {
+    double budget = _sdf->Get<double>("level_load_budget");
+    if (budget < 0)
+    {
+      ignwarn << "The level_load_budget parameter cannot be a negative "
+              << "number. Loading levels without a budget.\n";
+      budget = 0.0;
+    }
+    this->loadBudget = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(budget));
+  }
+
+  if (_sdf->HasElement("level_prefetch_time"))
+  {
+    this->prefetchTime = _sdf->Get<double>("level_prefetch_time");
+    if (this->prefetchTime < 0)
+    {
+      ignwarn << "The level_prefetch_time parameter cannot be a negative "
+              << "number. Disabling level prefetching.\n";
+      this->prefetchTime = 0.0;
+    }
+  }
+
+  if (_sdf->HasElement("level_unload_hysteresis"))
+  {
+    this->unloadHysteresis = _sdf->Get<double>("level_unload_hysteresis");
+    if (this->unloadHysteresis < 0)
+    {
+      ignwarn << "The level_unload_hysteresis parameter cannot be a negative "
+              << "number. Setting to 0.0\n";
+      this->unloadHysteresis = 0.0;
+    }
+  }
+
+  if (_sdf->HasElement("level_min_residency"))
+  {
+    double residency = _sdf->Get<double>("level_min_residency");
+    if (residency < 0)
+    {
+      ignwarn << "The level_min_residency parameter cannot be a negative "
+              << "number. Levels can be unloaded right after loading.\n";
+      residency = 0.0;
+    }
+    this->minResidency = std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(residency));
+  }
+
   for (auto level = _sdf->GetElement("level"); level;
        level = level->GetNextElement("level"))
   {
@@ -395,6 +517,184 @@ void LevelManager::ReadLevels(const sdf::ElementPtr &_sdf)
 
     this->entityCreator->SetParent(levelEntity, this->worldEntity);
   }
+
+  this->BuildLevelIndex();
+}
+
+/////////////////////////////////////////////////
+void LevelManager::BuildLevelIndex()
+{
+  IGN_PROFILE("LevelManager::BuildLevelIndex");
+
+  this->levelRegions.clear();
+  this->levelIndex.Clear();
+
+  double largestSides{0.0};
+  this->runner->entityCompMgr.Each<components::Level, components::Pose,
+    components::Geometry, components::LevelBuffer>(
+        [&](const Entity &_entity, const components::Level *,
+          const components::Pose *_pose,
+          const components::Geometry *_levelGeometry,
+          const components::LevelBuffer *_levelBuffer) -> bool
+        {
+          auto box = _levelGeometry->Data().BoxShape();
+          if (nullptr == box)
+          {
+            ignerr << "Level [" << _entity
+                   << "]'s geometry is not a box." << std::endl;
+            return true;
+          }
+          auto buffer = _levelBuffer->Data();
+          auto center = _pose->Data().Pos();
+
+          LevelRegion region;
+          region.inner = math::AxisAlignedBox{center - box->Size() / 2,
+              center + box->Size() / 2};
+          region.outer = math::AxisAlignedBox{
+              center - (box->Size() / 2 + buffer),
+              center + (box->Size() / 2 + buffer)};
+          const double keep = buffer + this->unloadHysteresis;
+          region.keep = math::AxisAlignedBox{
+              center - (box->Size() / 2 + keep),
+              center + (box->Size() / 2 + keep)};
+          largestSides += region.keep.Size().Max();
+          this->levelRegions[_entity] = region;
+          return true;
+        });
+
+  // Cells about the size of a level keep each level in a few cells
+  if (!this->levelRegions.empty() && largestSides > 0.0)
+    this->levelIndex.SetCellSize(largestSides / this->levelRegions.size());
+
+  for (const auto &[entity, region] : this->levelRegions)
+    this->levelIndex.Update(entity, region.keep);
+}
+
+/////////////////////////////////////////////////
+std::unordered_map<Entity, math::AxisAlignedBox>
+    LevelManager::PerformerVolumes() const
+{
+  std::unordered_map<Entity, math::AxisAlignedBox> volumes;
+  this->runner->entityCompMgr.Each<
+    components::Performer,
+    components::PerformerLevels,
+    components::Geometry,
+    components::ParentEntity>(
+        [&](const Entity &_perfEntity,
+          const components::Performer *,
+          const components::PerformerLevels *,
+          const components::Geometry *_geometry,
+          const components::ParentEntity *_parent) -> bool
+        {
+          auto pose = this->runner->entityCompMgr.Component<components::Pose>(
+              _parent->Data());
+
+          // We assume the geometry contains a box.
+          auto perfBox = _geometry->Data().BoxShape();
+          if (nullptr == perfBox)
+          {
+            ignerr << "Internal error: geometry of performer [" << _perfEntity
+                   << "] missing box." << std::endl;
+            return true;
+          }
+
+          volumes[_perfEntity] = math::AxisAlignedBox{
+              pose->Data().Pos() - perfBox->Size() / 2,
+              pose->Data().Pos() + perfBox->Size() / 2};
+          return true;
+        });
+  return volumes;
+}
+
+/////////////////////////////////////////////////
+math::Vector3d LevelManager::PerformerVelocity(const Entity _perfEntity,
+    const math::AxisAlignedBox &_volume)
+{
+  auto &ecm = this->runner->entityCompMgr;
+  const auto simTime = this->runner->currentInfo.simTime;
+  const math::Vector3d position = _volume.Center();
+
+  auto motionIter = this->performerMotions.find(_perfEntity);
+  if (motionIter == this->performerMotions.end())
+  {
+    motionIter = this->performerMotions.emplace(_perfEntity,
+        PerformerMotion{position, simTime, math::Vector3d::Zero}).first;
+  }
+
+  auto &motion = motionIter->second;
+  if (simTime > motion.simTime)
+  {
+    const double dt = std::chrono::duration<double>(
+        simTime - motion.simTime).count();
+    motion.velocity = (position - motion.position) / dt;
+  }
+  motion.position = position;
+  motion.simTime = simTime;
+
+  // Prefer velocities reported by physics or controllers
+  auto parent = ecm.Component<components::ParentEntity>(_perfEntity);
+  if (parent)
+  {
+    auto worldVel = ecm.Component<components::WorldLinearVelocity>(
+        parent->Data());
+    if (worldVel)
+      return worldVel->Data();
+
+    auto vel = ecm.Component<components::LinearVelocity>(parent->Data());
+    auto pose = ecm.Component<components::Pose>(parent->Data());
+    if (vel && pose)
+      return pose->Data().Rot().RotateVector(vel->Data());
+  }
+  return motion.velocity;
+}
+
+/////////////////////////////////////////////////
+bool LevelManager::IsLevelReady(const Entity _level) const
+{
+  if (!this->IsLevelActive(_level))
+    return false;
+
+  if (this->pendingLoads.empty())
+    return true;
+
+  auto names = this->runner->entityCompMgr.Component<
+      components::LevelEntityNames>(_level);
+  if (!names)
+    return true;
+
+  for (const auto &name : this->pendingLoads)
+  {
+    if (names->Data().find(name) != names->Data().end())
+      return false;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+void LevelManager::PublishPrefetchStats()
+{
+  if (!this->prefetchStatsChanged)
+    return;
+  this->prefetchStatsChanged = false;
+
+  if (!this->prefetchStatsPub.HasConnections())
+    return;
+
+  // Any has no 64-bit integer field, and doubles hold counts exactly up to
+  // 2^53, so counters are published as doubles, like system statistics.
+  msgs::Param msg;
+  auto addStat = [&msg](const std::string &_name, uint64_t _value)
+  {
+    auto &param = (*msg.mutable_params())[_name];
+    param.set_type(msgs::Any::DOUBLE);
+    param.set_double_value(static_cast<double>(_value));
+  };
+  addStat("hits", this->prefetchHits);
+  addStat("misses", this->prefetchMisses);
+  addStat("wasted", this->prefetchWasted);
+  addStat("reloads", this->levelReloads);
+  addStat("deferred_unloads", this->deferredUnloadCount);
+  this->prefetchStatsPub.Publish(msg);
 }
 
 /////////////////////////////////////////////////
@@ -561,95 +861,129 @@ void LevelManager::UpdateLevelsState()
   // If levels are not being used, we only process the default level.
   if (this->useLevels)
   {
-    this->runner->entityCompMgr.Each<
-      components::Performer,
-      components::PerformerLevels,
-      components::Geometry,
-      components::ParentEntity>(
-          [&](const Entity &_perfEntity,
-            components::Performer *,
-            components::PerformerLevels *_perfLevels,
-            components::Geometry *_geometry,
-            components::ParentEntity *_parent) -> bool
+    IGN_PROFILE("Performers");
+
+    // Levels only change when performers move, are added or are removed,
+    // or when levels whose unloading was deferred may be unloaded.
+    // Volumes are compared with the ones from the last check, so slow
+    // motions eventually trigger a check too.
+    auto volumes = this->PerformerVolumes();
+    bool moved = volumes.size() != this->performerVolumes.size() ||
+        !this->deferredUnloads.empty();
+    for (auto iter = volumes.begin(); !moved && iter != volumes.end(); ++iter)
+    {
+      auto cached = this->performerVolumes.find(iter->first);
+      moved = cached == this->performerVolumes.end() ||
+          !(cached->second == iter->second);
+    }
+
+    if (moved)
+    {
+      for (const auto &[perfEntity, performerVolume] : volumes)
+      {
+        IGN_PROFILE("EachPerformer");
+        std::set<Entity> newPerfLevels;
+        std::set<Entity> inside;
+
+        // Volume the performer will sweep while moving at its current
+        // velocity
+        math::AxisAlignedBox sweptVolume = performerVolume;
+        if (this->prefetchTime > 0.0)
+        {
+          const math::Vector3d offset =
+              this->PerformerVelocity(perfEntity, performerVolume) *
+              this->prefetchTime;
+          sweptVolume.Merge(math::AxisAlignedBox(
+              performerVolume.Min() + offset, performerVolume.Max() + offset));
+        }
+
+        // Add all levels with intersections to the levelsToLoad even if they
+        // are currently active. Levels whose buffer and hysteresis regions
+        // don't reach the performer aren't returned by the index.
+        for (const Entity level : this->levelIndex.QueryBox(sweptVolume))
+        {
+          IGN_PROFILE("CheckPerformerAgainstLevel");
+          const auto &region = this->levelRegions.at(level);
+
+          const bool isInside = region.inner.Intersects(performerVolume);
+          if (isInside)
+            inside.insert(level);
+
+          // If the level is active, the performer only needs to be within
+          // the buffer and hysteresis of the level to keep it, so
+          // performers at the edge of the buffer don't keep toggling it
+          const bool kept = this->IsLevelActive(level) &&
+              region.keep.Intersects(performerVolume);
+
+          // Load levels whose buffer the performer is about to reach
+          const bool predicted = this->prefetchTime > 0.0 &&
+              region.outer.Intersects(sweptVolume);
+
+          if (isInside || kept || predicted)
           {
-          IGN_PROFILE("EachPerformer");
+            newPerfLevels.insert(level);
+            levelsToLoad.push_back(level);
+          }
 
-          auto pose = this->runner->entityCompMgr.Component<components::Pose>(
-              _parent->Data());
+          if (predicted && !isInside && !this->IsLevelActive(level) &&
+              !region.outer.Intersects(performerVolume))
+          {
+            this->prefetchedLevels.insert(level);
+          }
+        }
 
-          // We assume the geometry contains a box.
-          auto perfBox = _geometry->Data().BoxShape();
-          if (nullptr == perfBox)
+        // Check whether the levels the performer entered were ready
+        auto &previouslyInside = this->performerInside[perfEntity];
+        for (const Entity level : inside)
+        {
+          if (previouslyInside.find(level) != previouslyInside.end())
+            continue;
+
+          if (this->IsLevelReady(level))
           {
-          ignerr << "Internal error: geometry of performer [" << _perfEntity
-          << "] missing box." << std::endl;
-          return true;
+            ++this->prefetchHits;
+          }
+          else
+          {
+            ++this->prefetchMisses;
+            igndbg << "Performer [" << perfEntity << "] entered level ["
+                   << level << "] before it was loaded." << std::endl;
           }
+          this->prefetchedLevels.erase(level);
+          this->prefetchStatsChanged = true;
+        }
+        previouslyInside = std::move(inside);
 
-          math::AxisAlignedBox performerVolume{
-            pose->Data().Pos() - perfBox->Size() / 2,
-              pose->Data().Pos() + perfBox->Size() / 2};
+        // Mark active levels the performer is outside of to be unloaded
+        for (const Entity level : this->activeLevels)
+        {
+          if (this->levelRegions.find(level) != this->levelRegions.end() &&
+              newPerfLevels.find(level) == newPerfLevels.end())
+          {
+            levelsToUnload.push_back(level);
+          }
+        }
 
-          std::set<Entity> newPerfLevels;
-
-          // loop through levels and check for intersections
-          // Add all levels with intersections to the levelsToLoad even if they
-          // are currently active.
-          this->runner->entityCompMgr.Each<components::Level, components::Pose,
-            components::Geometry,
-            components::LevelBuffer >(
-                [&](const Entity &_entity, const components::Level *,
-                  const components::Pose *_pose,
-                  const components::Geometry *_levelGeometry,
-                  const components::LevelBuffer *_levelBuffer) -> bool
-                {
-                IGN_PROFILE("CheckPerformerAgainstLevel");
-                // Check if the performer is in this level
-                // assume a box for now
-                auto box = _levelGeometry->Data().BoxShape();
-                if (nullptr == box)
-                {
-                ignerr << "Level [" << _entity
-                << "]'s geometry is not a box." << std::endl;
-                return true;
-                }
-                auto buffer = _levelBuffer->Data();
-                auto center = _pose->Data().Pos();
-                math::AxisAlignedBox region{center - box->Size() / 2,
-                center + box->Size() / 2};
-
-                math::AxisAlignedBox outerRegion{
-                  center - (box->Size() / 2 + buffer),
-                         center + (box->Size() / 2 + buffer)};
-
-                if (region.Intersects(performerVolume))
-                {
-                  newPerfLevels.insert(_entity);
-                  levelsToLoad.push_back(_entity);
-                }
-                else
-                {
-                  // If the level is active, check if the performer is
-                  // outside of the buffer of this level
-                  if (this->IsLevelActive(_entity))
-                  {
-                    if (outerRegion.Intersects(performerVolume))
-                    {
-                      newPerfLevels.insert(_entity);
-                      levelsToLoad.push_back(_entity);
-                      return true;
-                    }
-                    // Otherwise, mark the level to be unloaded
-                    levelsToUnload.push_back(_entity);
-                  }
-                }
-                return true;
-                });
-
-          *_perfLevels = components::PerformerLevels(newPerfLevels);
+        auto perfLevels = this->runner->entityCompMgr.Component<
+            components::PerformerLevels>(perfEntity);
+        *perfLevels = components::PerformerLevels(newPerfLevels);
+      }
 
-          return true;
-          });
+      // Forget performers which were removed
+      for (auto iter = this->performerInside.begin();
+           iter != this->performerInside.end();)
+      {
+        if (volumes.find(iter->first) == volumes.end())
+        {
+          this->performerMotions.erase(iter->first);
+          iter = this->performerInside.erase(iter);
+        }
+        else
+          ++iter;
+      }
+
+      this->performerVolumes = std::move(volumes);
+    }
   }
 
   // Sort levelsToLoad and levelsToUnload so as to run std::unique on them.
@@ -700,6 +1034,45 @@ void LevelManager::UpdateLevelsState()
       });
   levelsToUnload.erase(pendingRemove, levelsToUnload.end());
 
+  // Keep levels which were loaded recently, so performers moving back and
+  // forth across a boundary don't create and remove their entities every
+  // time. They're checked again every iteration until they can go.
+  if (this->minResidency > std::chrono::steady_clock::duration::zero())
+  {
+    const auto simTime = this->runner->currentInfo.simTime;
+    std::set<Entity> deferred;
+    pendingRemove = std::remove_if(
+        levelsToUnload.begin(), levelsToUnload.end(), [&](Entity _entity)
+        {
+          auto loaded = this->levelLoadTimes.find(_entity);
+          if (loaded == this->levelLoadTimes.end() ||
+              simTime < loaded->second ||
+              simTime - loaded->second >= this->minResidency)
+          {
+            return false;
+          }
+          deferred.insert(_entity);
+          return true;
+        });
+    levelsToUnload.erase(pendingRemove, levelsToUnload.end());
+
+    for (const Entity level : deferred)
+    {
+      if (this->deferredUnloads.find(level) == this->deferredUnloads.end())
+      {
+        ++this->deferredUnloadCount;
+        this->prefetchStatsChanged = true;
+      }
+      levelsToLoad.push_back(level);
+
+      // Entities shared with levels being unloaded stay too
+      const auto &names = this->runner->entityCompMgr.Component<
+          components::LevelEntityNames>(level)->Data();
+      entityNamesMarked.insert(names.begin(), names.end());
+    }
+    this->deferredUnloads = std::move(deferred);
+  }
+
   // Make a list of entity names to unload making sure to leave out the ones
   // that have been marked to be loaded above
   std::set<std::string> entityNamesToUnload;
@@ -735,17 +1108,33 @@ void LevelManager::UpdateLevelsState()
     {
       ignmsg << "Loaded level [" << level << "]" << std::endl;
       this->activeLevels.push_back(level);
+      this->levelLoadTimes[level] = this->runner->currentInfo.simTime;
+      if (this->unloadedLevels.find(level) != this->unloadedLevels.end())
+      {
+        ++this->levelReloads;
+        this->prefetchStatsChanged = true;
+      }
     }
   }
 
   auto pendingEnd = this->activeLevels.end();
   for (const auto &toUnload : levelsToUnload)
   {
+    if (this->prefetchedLevels.erase(toUnload) > 0)
+    {
+      ++this->prefetchWasted;
+      this->prefetchStatsChanged = true;
+    }
     ignmsg << "Unloaded level [" << toUnload << "]" << std::endl;
+    this->levelLoadTimes.erase(toUnload);
+    this->unloadedLevels.insert(toUnload);
     pendingEnd = std::remove(this->activeLevels.begin(), pendingEnd, toUnload);
   }
   // Erase from vector
   this->activeLevels.erase(pendingEnd, this->activeLevels.end());
+
+  this->CommitPendingLoads();
+  this->PublishPrefetchStats();
 }
 
 /////////////////////////////////////////////////
@@ -753,62 +1142,108 @@ void LevelManager::LoadActiveEntities(const std::set<std::string> &_namesToLoad)
 {
   IGN_PROFILE("LevelManager::LoadActiveEntities");
 
+  this->pendingLoads.insert(this->pendingLoads.end(), _namesToLoad.begin(),
+      _namesToLoad.end());
+  this->activeEntityNames.insert(_namesToLoad.begin(), _namesToLoad.end());
+}
+
+/////////////////////////////////////////////////
+void LevelManager::CommitPendingLoads()
+{
+  IGN_PROFILE("LevelManager::CommitPendingLoads");
+
+  if (this->pendingLoads.empty())
+    return;
+
   if (this->worldEntity == kNullEntity)
   {
     ignerr << "Could not find the world entity while loading levels\n";
+    this->pendingLoads.clear();
     return;
   }
+  ++this->transitions;
 
-  // Models
-  for (uint64_t modelIndex = 0;
-       modelIndex < this->runner->sdfWorld->ModelCount(); ++modelIndex)
+  // Without a budget everything is loaded now, so convert all the models
+  // from SDF in parallel first.
+  const bool batchModels = this->loadBudget.count() <= 0;
+  if (batchModels)
   {
-    // There is no sdf::World::ModelByName so we have to iterate by index and
-    // check if the model is in this level
-    auto model = this->runner->sdfWorld->ModelByIndex(modelIndex);
-    if (_namesToLoad.find(model->Name()) != _namesToLoad.end())
+    std::vector<const sdf::Model *> models;
+    for (const auto &name : this->pendingLoads)
     {
-      Entity modelEntity = this->entityCreator->CreateEntities(model);
+      auto iter = this->sdfByName.find(name);
+      if (iter != this->sdfByName.end() && iter->second.model)
+        models.push_back(iter->second.model);
+    }
 
-      this->entityCreator->SetParent(modelEntity, this->worldEntity);
+    for (const auto modelEntity : this->entityCreator->CreateEntities(models))
+    {
+      if (kNullEntity != modelEntity)
+        this->entityCreator->SetParent(modelEntity, this->worldEntity);
     }
   }
 
-  // Actors
-  for (uint64_t actorIndex = 0;
-       actorIndex < this->runner->sdfWorld->ActorCount(); ++actorIndex)
+  const auto start = std::chrono::steady_clock::now();
+  bool first{true};
+  while (!this->pendingLoads.empty())
   {
-    // There is no sdf::World::ActorByName so we have to iterate by index and
-    // check if the actor is in this level
-    auto actor = this->runner->sdfWorld->ActorByIndex(actorIndex);
-    if (_namesToLoad.find(actor->Name()) != _namesToLoad.end())
+    // Create at least one entity per iteration, so loading always progresses
+    if (!first && this->loadBudget.count() > 0 &&
+        std::chrono::steady_clock::now() - start >= this->loadBudget)
     {
-      Entity actorEntity = this->entityCreator->CreateEntities(actor);
+      break;
+    }
+    first = false;
 
+    const std::string name = std::move(this->pendingLoads.front());
+    this->pendingLoads.pop_front();
+
+    auto iter = this->sdfByName.find(name);
+    if (iter == this->sdfByName.end())
+      continue;
+
+    const LevelEntitySdf &entitySdf = iter->second;
+    if (entitySdf.model && !batchModels)
+    {
+      Entity modelEntity = this->entityCreator->CreateEntities(entitySdf.model);
+      this->entityCreator->SetParent(modelEntity, this->worldEntity);
+    }
+    if (entitySdf.actor)
+    {
+      Entity actorEntity = this->entityCreator->CreateEntities(entitySdf.actor);
       this->entityCreator->SetParent(actorEntity, this->worldEntity);
     }
-  }
-
-  // Lights
-  for (uint64_t lightIndex = 0;
-       lightIndex < this->runner->sdfWorld->LightCount(); ++lightIndex)
-  {
-    auto light = this->runner->sdfWorld->LightByIndex(lightIndex);
-    if (_namesToLoad.find(light->Name()) != _namesToLoad.end())
+    if (entitySdf.light)
     {
-      Entity lightEntity = this->entityCreator->CreateEntities(light);
-
+      Entity lightEntity = this->entityCreator->CreateEntities(entitySdf.light);
       this->entityCreator->SetParent(lightEntity, this->worldEntity);
     }
   }
 
-  this->activeEntityNames.insert(_namesToLoad.begin(), _namesToLoad.end());
+  if (!this->pendingLoads.empty())
+  {
+    igndbg << this->pendingLoads.size() << " level entities left to load."
+           << std::endl;
+  }
 }
 
 /////////////////////////////////////////////////
 void LevelManager::UnloadInactiveEntities(
     const std::set<std::string> &_namesToUnload)
 {
+  IGN_PROFILE("LevelManager::UnloadInactiveEntities");
+
+  if (_namesToUnload.empty())
+    return;
+  ++this->transitions;
+
+  // Entities which weren't created yet don't need to be removed
+  this->pendingLoads.erase(std::remove_if(this->pendingLoads.begin(),
+      this->pendingLoads.end(), [&](const std::string &_name)
+      {
+        return _namesToUnload.find(_name) != _namesToUnload.end();
+      }), this->pendingLoads.end());
+
   this->runner->entityCompMgr.Each<components::Model, components::Name>(
       [&](const Entity &_entity, const components::Model *,
           const components::Name *_name) -> bool
@@ -848,6 +1283,12 @@ void LevelManager::UnloadInactiveEntities(
   }
 }
 
+/////////////////////////////////////////////////
+uint64_t LevelManager::Transitions() const
+{
+  return this->transitions;
+}
+
 /////////////////////////////////////////////////
 bool LevelManager::IsLevelActive(const Entity _entity) const
 {
@@ -19,8 +19,11 @@
 #define IGNITION_GAZEBO_LEVELMANAGER_HH
 
 #include <ignition/msgs/boolean.pb.h>
+#include <ignition/msgs/param.pb.h>
 #include <ignition/msgs/stringmsg.pb.h>
 
+#include <chrono>
+#include <deque>
 #include <list>
 #include <memory>
 #include <set>
@@ -29,13 +32,19 @@
 #include <utility>
 #include <vector>
 
+#include <sdf/Actor.hh>
 #include <sdf/Element.hh>
 #include <sdf/Geometry.hh>
+#include <sdf/Light.hh>
+#include <sdf/Model.hh>
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Vector3.hh>
 #include <ignition/transport/Node.hh>
 
 #include "ignition/gazebo/config.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/SdfEntityCreator.hh"
+#include "ignition/gazebo/SpatialIndex.hh"
 #include "ignition/gazebo/Types.hh"
 
 namespace ignition
@@ -73,6 +82,48 @@ namespace ignition
     ///   simulation. Any component changes or additions will be ignored
     ///   when the level is reloaded. Likewise, they should not be deleted.
     /// * Entities spawned during simulation are part of the default level.
+    /// * Levels don't move or change size.
+    ///
+    /// Levels are only checked against performers when a performer moves,
+    /// and only the levels near the performer are checked, using a spatial
+    /// index of the levels' buffer regions.
+    ///
+    /// Entities of levels which become active are queued and created over
+    /// the following iterations. The time spent creating them in each
+    /// iteration can be bounded with the `<level_load_budget>` element of
+    /// the `ignition::gazebo` plugin, in milliseconds, so that crossing into
+    /// a large level doesn't stall simulation. By default, all queued
+    /// entities are created right away.
+    ///
+    /// Levels can also be loaded before performers reach them, with the
+    /// `<level_prefetch_time>` element of the `ignition::gazebo` plugin, in
+    /// seconds. Levels whose buffer region the performer will reach within
+    /// that time, moving at its current velocity, are loaded as if the
+    /// performer was already in their buffer. The velocity is taken from
+    /// the WorldLinearVelocity or LinearVelocity component of the
+    /// performer's model, or estimated from its motion otherwise.
+    ///
+    /// Performers keep active levels loaded while they're within the
+    /// level's buffer plus the `<level_unload_hysteresis>` distance of the
+    /// `ignition::gazebo` plugin, in meters, so a performer sitting at the
+    /// edge of the buffer doesn't load and unload the level over and over.
+    /// Levels can also be kept for at least `<level_min_residency>` seconds
+    /// of sim time after being loaded. Both default to 0.
+    ///
+    /// Statistics about levels being ready when a performer enters them are
+    /// published on `/world/<world_name>/level/prefetch_stats`, as
+    /// msgs::Param with these integer parameters:
+    ///
+    /// * hits: Levels whose entities were all created when a performer
+    ///         entered them.
+    /// * misses: Levels which were still loading when a performer entered
+    ///           them.
+    /// * wasted: Levels loaded because of a prediction, which were unloaded
+    ///           without a performer entering them.
+    /// * reloads: Levels loaded again after being unloaded, which counts
+    ///            level churn.
+    /// * deferred_unloads: Times a level stayed loaded because of
+    ///                     `<level_min_residency>`.
     ///
     class IGNITION_GAZEBO_VISIBLE LevelManager
     {
@@ -82,17 +133,37 @@ namespace ignition
       /// will only be loaded for active performers.
       public: LevelManager(SimulationRunner *_runner, bool _useLevels = false);
 
+      /// \brief Constructor of the level manager of a forked runner, which
+      /// continues with the levels and performers of another manager. The
+      /// entities were already forked into the runner's entity component
+      /// manager, so nothing is created and no plugins are loaded. The fork
+      /// doesn't advertise the level services.
+      /// \param[in] _runner The forked runner that owns this
+      /// \param[in] _source Level manager of the source runner.
+      public: LevelManager(SimulationRunner *_runner,
+                           const LevelManager &_source);
+
       /// \brief Load and unload levels
       /// This is where we compute intersections and determine if a performer is
       /// in a level or not. This needs to be called by the simulation runner at
       /// every update cycle
       public: void UpdateLevelsState();
 
-      /// \brief Load entities that have been marked for loading.
+      /// \brief Get the number of times level entities were loaded or
+      /// unloaded, counting each batch of loads or unloads once.
+      /// \return Number of level transitions since the manager was created.
+      public: uint64_t Transitions() const;
+
+      /// \brief Queue entities that have been marked for loading, see
+      /// CommitPendingLoads.
       /// \param[in] _namesToLoad List of of entity names to load
       private: void LoadActiveEntities(
           const std::set<std::string> &_namesToLoad);
 
+      /// \brief Create queued entities, until the load budget of this
+      /// iteration is spent.
+      private: void CommitPendingLoads();
+
       /// \brief Unload entities that have been marked for unloading.
       /// \param[in] _namesToUnload List of entity names to unload
       private: void UnloadInactiveEntities(
@@ -120,6 +191,29 @@ namespace ignition
       /// schedule them to be loaded
       private: void ConfigureDefaultLevel();
 
+      /// \brief Put the regions of all levels in the level index.
+      private: void BuildLevelIndex();
+
+      /// \brief Compute the volume of all performers.
+      /// \return Volume of each performer, in the world frame.
+      private: std::unordered_map<Entity, math::AxisAlignedBox>
+          PerformerVolumes() const;
+
+      /// \brief Get the velocity of a performer, see `<level_prefetch_time>`.
+      /// \param[in] _perfEntity Performer entity.
+      /// \param[in] _volume Current volume of the performer.
+      /// \return Velocity in the world frame.
+      private: math::Vector3d PerformerVelocity(const Entity _perfEntity,
+          const math::AxisAlignedBox &_volume);
+
+      /// \brief Check whether all entities of a level were created.
+      /// \param[in] _level Level entity.
+      /// \return True if none of its entities are waiting to be created.
+      private: bool IsLevelReady(const Entity _level) const;
+
+      /// \brief Publish prefetch statistics, if they changed.
+      private: void PublishPrefetchStats();
+
       /// \brief Determine if a level is active
       /// \param[in] _entity Entity of level to be checked
       /// \return True of the level is currently active
@@ -178,6 +272,127 @@ namespace ignition
 
       /// \brief Mutex to protect performersToAdd list.
       private: std::mutex performerToAddMutex;
+
+      /// \brief Regions of a level.
+      private: struct LevelRegion
+      {
+        /// \brief Region where performers activate the level.
+        math::AxisAlignedBox inner;
+
+        /// \brief Region, inflated by the buffer, where performers activate
+        /// the level when prefetching.
+        math::AxisAlignedBox outer;
+
+        /// \brief Region, inflated by the buffer and the unload hysteresis,
+        /// where performers keep the level active.
+        math::AxisAlignedBox keep;
+      };
+
+      /// \brief Regions of all levels except the default level.
+      private: std::unordered_map<Entity, LevelRegion> levelRegions;
+
+      /// \brief Index of the keep regions of levels.
+      private: SpatialIndex levelIndex;
+
+      /// \brief Performer volumes when levels were last checked.
+      private: std::unordered_map<Entity, math::AxisAlignedBox>
+          performerVolumes;
+
+      /// \brief SDF of an entity which can be part of a level.
+      private: struct LevelEntitySdf
+      {
+        /// \brief Model with the name, if any.
+        const sdf::Model *model{nullptr};
+
+        /// \brief Actor with the name, if any.
+        const sdf::Actor *actor{nullptr};
+
+        /// \brief Light with the name, if any.
+        const sdf::Light *light{nullptr};
+      };
+
+      /// \brief SDF of the world's models, actors and lights, by name.
+      private: std::unordered_map<std::string, LevelEntitySdf> sdfByName;
+
+      /// \brief Names of entities queued to be created.
+      private: std::deque<std::string> pendingLoads;
+
+      /// \brief Time which can be spent creating queued entities in each
+      /// iteration. Zero to create all of them.
+      private: std::chrono::steady_clock::duration loadBudget{0};
+
+      /// \brief How far ahead, in seconds, to predict the levels performers
+      /// will reach. Zero to disable prefetching.
+      private: double prefetchTime{0.0};
+
+      /// \brief Motion of a performer, used to estimate its velocity.
+      private: struct PerformerMotion
+      {
+        /// \brief Center of the performer when it was last sampled.
+        math::Vector3d position;
+
+        /// \brief Simulation time when it was last sampled.
+        std::chrono::steady_clock::duration simTime{0};
+
+        /// \brief Estimated velocity.
+        math::Vector3d velocity;
+      };
+
+      /// \brief Motion of each performer.
+      private: std::unordered_map<Entity, PerformerMotion> performerMotions;
+
+      /// \brief Levels each performer was inside of when levels were last
+      /// checked.
+      private: std::unordered_map<Entity, std::set<Entity>> performerInside;
+
+      /// \brief Levels loaded because of a prediction, which no performer
+      /// entered yet.
+      private: std::set<Entity> prefetchedLevels;
+
+      /// \brief Levels which were ready when a performer entered them.
+      private: uint64_t prefetchHits{0};
+
+      /// \brief Levels which were still loading when a performer entered
+      /// them.
+      private: uint64_t prefetchMisses{0};
+
+      /// \brief Prefetched levels unloaded without being entered.
+      private: uint64_t prefetchWasted{0};
+
+      /// \brief True if statistics changed since they were last published.
+      private: bool prefetchStatsChanged{false};
+
+      /// \brief Publisher of prefetch statistics.
+      private: transport::Node::Publisher prefetchStatsPub;
+
+      /// \brief Distance beyond the buffer a performer must move to unload
+      /// a level, see `<level_unload_hysteresis>`.
+      private: double unloadHysteresis{0.0};
+
+      /// \brief Sim time levels stay loaded before they can be unloaded, see
+      /// `<level_min_residency>`.
+      private: std::chrono::steady_clock::duration minResidency{0};
+
+      /// \brief Sim time each active level was loaded at.
+      private: std::unordered_map<Entity, std::chrono::steady_clock::duration>
+          levelLoadTimes;
+
+      /// \brief Levels which would have been unloaded, but haven't been
+      /// loaded for the minimum residency yet.
+      private: std::set<Entity> deferredUnloads;
+
+      /// \brief Levels which were unloaded at least once.
+      private: std::set<Entity> unloadedLevels;
+
+      /// \brief Levels loaded again after being unloaded.
+      private: uint64_t levelReloads{0};
+
+      /// \brief Times a level's unloading was deferred.
+      private: uint64_t deferredUnloadCount{0};
+
+      /// \brief Batches of level entities loaded or unloaded, see
+      /// Transitions.
+      private: uint64_t transitions{0};
     };
     }
   }
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "ignition/gazebo/components/LevelEntityNames.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Performer.hh"
+#include "ignition/gazebo/components/PerformerLevels.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/LevelOfDetail.hh"
+#include "ignition/gazebo/Util.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+namespace
+{
+/// \brief Number of groups far entities are spread over within a period.
+constexpr Entity kDueGroups{8};
+}
+
+/// \brief Private data of LevelOfDetail.
+class ignition::gazebo::LevelOfDetailPrivate
+{
+  /// \brief Sim times at which an entity was and will be due.
+  public: struct DueTimes
+  {
+    /// \brief Sim time of the last update.
+    std::chrono::steady_clock::duration last{0};
+
+    /// \brief Sim time from which a far entity is due again.
+    std::chrono::steady_clock::duration next{0};
+  };
+
+  /// \brief Distance within which entities are near a performer.
+  public: double distance{0.0};
+
+  /// \brief Sim time between updates of far entities.
+  public: std::chrono::steady_clock::duration period{std::chrono::seconds(1)};
+
+  /// \brief Sim time of the current iteration.
+  public: std::chrono::steady_clock::duration simTime{0};
+
+  /// \brief Sim time handled by the current iteration.
+  public: std::chrono::steady_clock::duration dt{0};
+
+  /// \brief World positions of the performers' models.
+  public: std::vector<math::Vector3d> performerPositions;
+
+  /// \brief Levels which performers are in.
+  public: std::set<Entity> activeLevels;
+
+  /// \brief Names of the top level entities of activeLevels.
+  public: std::unordered_set<std::string> activeNames;
+
+  /// \brief Whether top level models are near a performer, computed once
+  /// per iteration.
+  public: mutable std::unordered_map<Entity, bool> nearModels;
+
+  /// \brief Update times of the entities passed to Due.
+  public: std::unordered_map<Entity, DueTimes> dueTimes;
+
+  /// \brief Component layout generation when removed entities were last
+  /// dropped from dueTimes.
+  public: uint64_t layoutGeneration{0};
+};
+
+//////////////////////////////////////////////////
+LevelOfDetail::LevelOfDetail()
+  : dataPtr(std::make_unique<LevelOfDetailPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+LevelOfDetail::~LevelOfDetail() = default;
+
+//////////////////////////////////////////////////
+void LevelOfDetail::Load(const sdf::ElementPtr &_sdf)
+{
+  if (!_sdf)
+    return;
+
+  this->SetDistance(_sdf->Get<double>("distance", 0.0).first);
+
+  auto period = _sdf->Get<double>("period", 1.0).first;
+  if (period < 0.0)
+  {
+    ignerr << "Level of detail <period> can't be negative, using [1] s."
+           << std::endl;
+    period = 1.0;
+  }
+  this->SetPeriod(
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(period)));
+}
+
+//////////////////////////////////////////////////
+void LevelOfDetail::SetDistance(double _distance)
+{
+  this->dataPtr->distance = _distance;
+}
+
+//////////////////////////////////////////////////
+double LevelOfDetail::Distance() const
+{
+  return this->dataPtr->distance;
+}
+
+//////////////////////////////////////////////////
+void LevelOfDetail::SetPeriod(
+    const std::chrono::steady_clock::duration &_period)
+{
+  this->dataPtr->period = _period;
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration LevelOfDetail::Period() const
+{
+  return this->dataPtr->period;
+}
+
+//////////////////////////////////////////////////
+bool LevelOfDetail::Enabled() const
+{
+  return this->dataPtr->distance > 0.0;
+}
+
+//////////////////////////////////////////////////
+void LevelOfDetail::Update(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("LevelOfDetail::Update");
+  auto &data = *this->dataPtr;
+  data.simTime = _info.simTime;
+  data.dt = _info.dt;
+  data.nearModels.clear();
+
+  // Start over after jumping back in time
+  if (_info.dt < std::chrono::steady_clock::duration::zero())
+    data.dueTimes.clear();
+
+  // Forget entities which were removed
+  if (data.layoutGeneration != _ecm.ComponentLayoutGeneration())
+  {
+    data.layoutGeneration = _ecm.ComponentLayoutGeneration();
+    for (auto it = data.dueTimes.begin(); it != data.dueTimes.end();)
+    {
+      if (_ecm.HasEntity(it->first))
+        ++it;
+      else
+        it = data.dueTimes.erase(it);
+    }
+  }
+
+  if (!this->Enabled())
+    return;
+
+  data.performerPositions.clear();
+  std::set<Entity> levels;
+  _ecm.Each<components::Performer, components::ParentEntity>(
+      [&](const Entity &_entity, const components::Performer *,
+          const components::ParentEntity *_parent) -> bool
+      {
+        if (nullptr != _ecm.Component<components::Pose>(_parent->Data()))
+        {
+          data.performerPositions.push_back(
+              worldPose(_parent->Data(), _ecm).Pos());
+        }
+
+        auto performerLevels =
+            _ecm.Component<components::PerformerLevels>(_entity);
+        if (nullptr != performerLevels)
+        {
+          levels.insert(performerLevels->Data().begin(),
+              performerLevels->Data().end());
+        }
+        return true;
+      });
+
+  // Levels only change when performers cross their boundaries
+  if (levels != data.activeLevels)
+  {
+    data.activeLevels = std::move(levels);
+    data.activeNames.clear();
+    for (const Entity level : data.activeLevels)
+    {
+      auto names = _ecm.Component<components::LevelEntityNames>(level);
+      if (nullptr != names)
+        data.activeNames.insert(names->Data().begin(), names->Data().end());
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+bool LevelOfDetail::Near(const EntityComponentManager &_ecm,
+    const Entity _entity) const
+{
+  if (!this->Enabled())
+    return true;
+
+  auto &data = *this->dataPtr;
+  Entity model = topLevelModel(_entity, _ecm);
+  if (kNullEntity == model)
+    model = _entity;
+
+  auto it = data.nearModels.find(model);
+  if (it != data.nearModels.end())
+    return it->second;
+
+  // Entities without a pose can't be placed, so they're always near
+  bool isNear = nullptr == _ecm.Component<components::Pose>(model);
+
+  if (!isNear && !data.activeNames.empty())
+  {
+    auto name = _ecm.Component<components::Name>(model);
+    isNear = nullptr != name &&
+        data.activeNames.find(name->Data()) != data.activeNames.end();
+  }
+
+  if (!isNear)
+  {
+    const auto position = worldPose(model, _ecm).Pos();
+    for (const auto &performer : data.performerPositions)
+    {
+      if (performer.Distance(position) <= data.distance)
+      {
+        isNear = true;
+        break;
+      }
+    }
+  }
+
+  data.nearModels[model] = isNear;
+  return isNear;
+}
+
+//////////////////////////////////////////////////
+std::optional<std::chrono::steady_clock::duration> LevelOfDetail::Due(
+    const EntityComponentManager &_ecm, const Entity _entity)
+{
+  auto &data = *this->dataPtr;
+  auto [it, inserted] = data.dueTimes.try_emplace(_entity);
+  auto &times = it->second;
+  if (inserted)
+  {
+    // As if the entity was updated in the previous iteration, and only due
+    // again once its group's turn in the period comes, if it's far
+    times.last = data.simTime - data.dt;
+    times.next = data.simTime +
+        data.period * static_cast<int64_t>(_entity % kDueGroups) /
+        static_cast<int64_t>(kDueGroups);
+  }
+
+  if (!this->Near(_ecm, _entity) && data.simTime < times.next)
+    return std::nullopt;
+
+  const auto elapsed = data.simTime - times.last;
+  times.last = data.simTime;
+  times.next = data.simTime + data.period;
+  return elapsed;
+}
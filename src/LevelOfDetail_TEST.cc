@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <set>
+#include <string>
+
+#include "ignition/gazebo/components/LevelEntityNames.hh"
+#include "ignition/gazebo/components/Link.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Performer.hh"
+#include "ignition/gazebo/components/PerformerLevels.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/LevelOfDetail.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/////////////////////////////////////////////////
+class LevelOfDetailTest : public ::testing::Test
+{
+  /// \brief Create a top level model with a link.
+  /// \param[in] _name Model name.
+  /// \param[in] _position Model position.
+  /// \return Link entity.
+  public: Entity CreateModel(const std::string &_name,
+              const math::Vector3d &_position)
+  {
+    Entity model = this->ecm.CreateEntity();
+    this->ecm.CreateComponent(model, components::Model());
+    this->ecm.CreateComponent(model, components::Name(_name));
+    this->ecm.CreateComponent(model,
+        components::Pose(math::Pose3d(_position, math::Quaterniond::Identity)));
+
+    Entity link = this->ecm.CreateEntity();
+    this->ecm.CreateComponent(link, components::Link());
+    this->ecm.CreateComponent(link, components::ParentEntity(model));
+    this->ecm.CreateComponent(link, components::Pose());
+    this->ecm.SetParentEntity(link, model);
+    return link;
+  }
+
+  /// \brief Entity component manager.
+  public: EntityComponentManager ecm;
+};
+
+/////////////////////////////////////////////////
+TEST_F(LevelOfDetailTest, Disabled)
+{
+  Entity farLink = this->CreateModel("far", {1000, 0, 0});
+
+  LevelOfDetail lod;
+  EXPECT_FALSE(lod.Enabled());
+
+  UpdateInfo info;
+  info.simTime = 1ms;
+  info.dt = 1ms;
+  lod.Update(info, this->ecm);
+  EXPECT_TRUE(lod.Near(this->ecm, farLink));
+  auto due = lod.Due(this->ecm, farLink);
+  ASSERT_TRUE(due.has_value());
+  EXPECT_EQ(1ms, *due);
+}
+
+/////////////////////////////////////////////////
+TEST_F(LevelOfDetailTest, Performers)
+{
+  Entity robot = this->CreateModel("robot", {0, 0, 0});
+  Entity nearLink = this->CreateModel("near", {5, 0, 0});
+  Entity farLink = this->CreateModel("far", {100, 0, 0});
+  Entity inLevel = this->CreateModel("in_level", {200, 0, 0});
+
+  Entity performer = this->ecm.CreateEntity();
+  this->ecm.CreateComponent(performer, components::Performer());
+  this->ecm.CreateComponent(performer, components::ParentEntity(
+      this->ecm.ParentEntity(robot)));
+
+  Entity level = this->ecm.CreateEntity();
+  this->ecm.CreateComponent(level,
+      components::LevelEntityNames(std::set<std::string>{"in_level"}));
+  this->ecm.CreateComponent(performer,
+      components::PerformerLevels(std::set<Entity>{level}));
+
+  LevelOfDetail lod;
+  lod.SetDistance(10.0);
+  lod.SetPeriod(100ms);
+  EXPECT_TRUE(lod.Enabled());
+
+  UpdateInfo info;
+  info.dt = 1ms;
+  info.simTime = 1ms;
+  lod.Update(info, this->ecm);
+  EXPECT_TRUE(lod.Near(this->ecm, robot));
+  EXPECT_TRUE(lod.Near(this->ecm, nearLink));
+  EXPECT_FALSE(lod.Near(this->ecm, farLink));
+  EXPECT_TRUE(lod.Near(this->ecm, inLevel));
+
+  // Near entities are due every iteration, far ones once per period
+  int nearCount = 0;
+  int farCount = 0;
+  std::chrono::steady_clock::duration farTime{0};
+  for (int i = 1; i <= 1000; ++i)
+  {
+    info.simTime = i * 1ms;
+    lod.Update(info, this->ecm);
+    if (lod.Due(this->ecm, nearLink))
+      ++nearCount;
+    if (auto due = lod.Due(this->ecm, farLink))
+    {
+      ++farCount;
+      farTime += *due;
+    }
+  }
+  EXPECT_EQ(1000, nearCount);
+  EXPECT_GE(farCount, 9);
+  EXPECT_LE(farCount, 11);
+
+  // Far updates cover the sim time since their previous update
+  EXPECT_GE(farTime, 800ms);
+  EXPECT_LE(farTime, 1000ms);
+
+  // Leaving the level makes the entity far
+  this->ecm.SetComponentData<components::PerformerLevels>(performer,
+      std::set<Entity>());
+  lod.Update(info, this->ecm);
+  EXPECT_FALSE(lod.Near(this->ecm, inLevel));
+}
@@ -15,6 +15,9 @@
  *
  */
 
+#include <cstddef>
+#include <optional>
+
 #include <ignition/msgs/Utility.hh>
 
 #include "ignition/gazebo/components/AngularVelocity.hh"
@@ -35,10 +38,57 @@
 
 #include "ignition/gazebo/Link.hh"
 
+#include "ComponentCache.hh"
+
 class ignition::gazebo::LinkPrivate
 {
+  /// \brief Slots of the components kept by the cache.
+  public: enum Slot : std::size_t
+  {
+    kLinkSlot,
+    kInertialSlot,
+    kWorldPoseSlot,
+    kWorldLinearVelocitySlot,
+    kWorldAngularVelocitySlot,
+    kWorldLinearAccelerationSlot,
+    kWindModeSlot,
+    kCanonicalLinkSlot,
+    kWrenchSlot,
+    kSlotCount
+  };
+
+  /// \brief Get a component of the link, through the cache when bound.
+  /// \param[in] _ecm Entity-component manager.
+  /// \param[in] _slot Slot of the component type.
+  /// \return Component, or nullptr if the link doesn't have it.
+  public: template <typename ComponentTypeT>
+          const ComponentTypeT *Component(const EntityComponentManager &_ecm,
+              const Slot _slot)
+  {
+    return this->cache.template Component<ComponentTypeT>(_ecm, this->id,
+        _slot);
+  }
+
+  /// \brief Get the data of a component of the link, through the cache
+  /// when bound.
+  /// \param[in] _ecm Entity-component manager.
+  /// \param[in] _slot Slot of the component type.
+  /// \return Data, or nullopt if the link doesn't have the component.
+  public: template <typename ComponentTypeT>
+          std::optional<typename ComponentTypeT::Type> ComponentData(
+              const EntityComponentManager &_ecm, const Slot _slot)
+  {
+    auto comp = this->Component<ComponentTypeT>(_ecm, _slot);
+    if (nullptr == comp)
+      return std::nullopt;
+    return std::make_optional(comp->Data());
+  }
+
   /// \brief Id of link entity.
   public: Entity id{kNullEntity};
+
+  /// \brief Component pointers kept while bound, see Link::Bind.
+  public: ComponentCache<kSlotCount> cache;
 };
 
 using namespace ignition;
@@ -83,12 +133,32 @@ Entity Link::Entity() const
 void Link::ResetEntity(gazebo::Entity _newEntity)
 {
   this->dataPtr->id = _newEntity;
+  this->dataPtr->cache.Bind(this->dataPtr->cache.Bound());
+}
+
+//////////////////////////////////////////////////
+void Link::Bind(const EntityComponentManager &_ecm)
+{
+  this->dataPtr->cache.Bind(&_ecm);
+}
+
+//////////////////////////////////////////////////
+void Link::Unbind()
+{
+  this->dataPtr->cache.Bind(nullptr);
+}
+
+//////////////////////////////////////////////////
+bool Link::Bound() const
+{
+  return nullptr != this->dataPtr->cache.Bound();
 }
 
 //////////////////////////////////////////////////
 bool Link::Valid(const EntityComponentManager &_ecm) const
 {
-  return nullptr != _ecm.Component<components::Link>(this->dataPtr->id);
+  return nullptr != this->dataPtr->Component<components::Link>(_ecm,
+      LinkPrivate::kLinkSlot);
 }
 
 //////////////////////////////////////////////////
@@ -159,14 +229,16 @@ uint64_t Link::VisualCount(const EntityComponentManager &_ecm) const
 //////////////////////////////////////////////////
 bool Link::IsCanonical(const EntityComponentManager &_ecm) const
 {
-  auto comp = _ecm.Component<components::CanonicalLink>(this->dataPtr->id);
+  auto comp = this->dataPtr->Component<components::CanonicalLink>(_ecm,
+      LinkPrivate::kCanonicalLinkSlot);
   return comp != nullptr;
 }
 
 //////////////////////////////////////////////////
 bool Link::WindMode(const EntityComponentManager &_ecm) const
 {
-  auto comp = _ecm.Component<components::WindMode>(this->dataPtr->id);
+  auto comp = this->dataPtr->Component<components::WindMode>(_ecm,
+      LinkPrivate::kWindModeSlot);
   if (comp)
     return comp->Data();
 
@@ -177,15 +249,18 @@ bool Link::WindMode(const EntityComponentManager &_ecm) const
 std::optional<math::Pose3d> Link::WorldPose(
     const EntityComponentManager &_ecm) const
 {
-  return _ecm.ComponentData<components::WorldPose>(this->dataPtr->id);
+  return this->dataPtr->ComponentData<components::WorldPose>(_ecm,
+      LinkPrivate::kWorldPoseSlot);
 }
 
 //////////////////////////////////////////////////
 std::optional<math::Pose3d> Link::WorldInertialPose(
     const EntityComponentManager &_ecm) const
 {
-  auto inertial = _ecm.Component<components::Inertial>(this->dataPtr->id);
-  auto worldPose = _ecm.Component<components::WorldPose>(this->dataPtr->id);
+  auto inertial = this->dataPtr->Component<components::Inertial>(_ecm,
+      LinkPrivate::kInertialSlot);
+  auto worldPose = this->dataPtr->Component<components::WorldPose>(_ecm,
+      LinkPrivate::kWorldPoseSlot);
 
   if (!worldPose || !inertial)
     return std::nullopt;
@@ -197,7 +272,8 @@ std::optional<math::Pose3d> Link::WorldInertialPose(
 std::optional<math::Vector3d> Link::WorldLinearVelocity(
     const EntityComponentManager &_ecm) const
 {
-  return _ecm.ComponentData<components::WorldLinearVelocity>(this->dataPtr->id);
+  return this->dataPtr->ComponentData<components::WorldLinearVelocity>(_ecm,
+      LinkPrivate::kWorldLinearVelocitySlot);
 }
 
 //////////////////////////////////////////////////
@@ -206,11 +282,14 @@ std::optional<math::Vector3d> Link::WorldLinearVelocity(
     const math::Vector3d &_offset) const
 {
   auto worldLinVel =
-      _ecm.Component<components::WorldLinearVelocity>(this->dataPtr->id);
+      this->dataPtr->Component<components::WorldLinearVelocity>(_ecm,
+      LinkPrivate::kWorldLinearVelocitySlot);
   auto worldPose =
-      _ecm.Component<components::WorldPose>(this->dataPtr->id);
+      this->dataPtr->Component<components::WorldPose>(_ecm,
+      LinkPrivate::kWorldPoseSlot);
   auto worldAngVel =
-      _ecm.Component<components::WorldAngularVelocity>(this->dataPtr->id);
+      this->dataPtr->Component<components::WorldAngularVelocity>(_ecm,
+      LinkPrivate::kWorldAngularVelocitySlot);
 
   if (!worldLinVel || !worldPose || !worldAngVel)
     return std::nullopt;
@@ -224,24 +303,26 @@ std::optional<math::Vector3d> Link::WorldLinearVelocity(
 std::optional<math::Vector3d> Link::WorldAngularVelocity(
     const EntityComponentManager &_ecm) const
 {
-  return _ecm.ComponentData<components::WorldAngularVelocity>(
-      this->dataPtr->id);
+  return this->dataPtr->ComponentData<components::WorldAngularVelocity>(_ecm,
+      LinkPrivate::kWorldAngularVelocitySlot);
 }
 
 //////////////////////////////////////////////////
 std::optional<math::Vector3d> Link::WorldLinearAcceleration(
     const EntityComponentManager &_ecm) const
 {
-  return _ecm.ComponentData<components::WorldLinearAcceleration>(
-      this->dataPtr->id);
+  return this->dataPtr->ComponentData<components::WorldLinearAcceleration>(
+      _ecm, LinkPrivate::kWorldLinearAccelerationSlot);
 }
 
 //////////////////////////////////////////////////
 std::optional<math::Matrix3d> Link::WorldInertiaMatrix(
     const EntityComponentManager &_ecm) const
 {
-  auto inertial = _ecm.Component<components::Inertial>(this->dataPtr->id);
-  auto worldPose = _ecm.Component<components::WorldPose>(this->dataPtr->id);
+  auto inertial = this->dataPtr->Component<components::Inertial>(_ecm,
+      LinkPrivate::kInertialSlot);
+  auto worldPose = this->dataPtr->Component<components::WorldPose>(_ecm,
+      LinkPrivate::kWorldPoseSlot);
 
   if (!worldPose || !inertial)
     return std::nullopt;
@@ -256,9 +337,11 @@ std::optional<math::Matrix3d> Link::WorldInertiaMatrix(
 std::optional<double> Link::WorldKineticEnergy(
     const EntityComponentManager &_ecm) const
 {
-  auto inertial = _ecm.Component<components::Inertial>(this->dataPtr->id);
+  auto inertial = this->dataPtr->Component<components::Inertial>(_ecm,
+      LinkPrivate::kInertialSlot);
   auto worldAngVel =
-      _ecm.Component<components::WorldAngularVelocity>(this->dataPtr->id);
+      this->dataPtr->Component<components::WorldAngularVelocity>(_ecm,
+      LinkPrivate::kWorldAngularVelocitySlot);
 
   if (!worldAngVel || !inertial)
     return std::nullopt;
@@ -281,8 +364,10 @@ std::optional<double> Link::WorldKineticEnergy(
 void Link::AddWorldForce(EntityComponentManager &_ecm,
                          const math::Vector3d &_force) const
 {
-  auto inertial = _ecm.Component<components::Inertial>(this->dataPtr->id);
-  auto worldPose = _ecm.Component<components::WorldPose>(this->dataPtr->id);
+  auto inertial = this->dataPtr->Component<components::Inertial>(_ecm,
+      LinkPrivate::kInertialSlot);
+  auto worldPose = this->dataPtr->Component<components::WorldPose>(_ecm,
+      LinkPrivate::kWorldPoseSlot);
 
   // Can't apply force if the inertial's pose is not found
   if (!inertial || !worldPose)
@@ -305,7 +390,9 @@ void Link::AddWorldWrench(EntityComponentManager &_ecm,
                          const math::Vector3d &_torque) const
 {
   auto linkWrenchComp =
-      _ecm.Component<components::ExternalWorldWrenchCmd>(this->dataPtr->id);
+      this->dataPtr->cache.MutableComponent<
+      components::ExternalWorldWrenchCmd>(_ecm, this->dataPtr->id,
+      LinkPrivate::kWrenchSlot);
 
   components::ExternalWorldWrenchCmd wrench;
 
@@ -17,6 +17,12 @@
 
 #include <gtest/gtest.h>
 
+#include <ignition/msgs/Utility.hh>
+
+#include "ignition/gazebo/components/ExternalWorldWrenchCmd.hh"
+#include "ignition/gazebo/components/Inertial.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/Link.hh"
 
 /////////////////////////////////////////////////
@@ -74,3 +80,52 @@ TEST(LinkTest, MoveAssignmentOperator)
   linkMoved = std::move(link);
   EXPECT_EQ(id, linkMoved.Entity());
 }
+
+/////////////////////////////////////////////////
+TEST(LinkTest, Bind)
+{
+  using namespace ignition;
+  gazebo::EntityComponentManager ecm;
+  auto id = ecm.CreateEntity();
+  ecm.CreateComponent(id, gazebo::components::WorldPose(
+      math::Pose3d(1, 2, 3, 0, 0, 0)));
+
+  gazebo::Link link(id);
+  EXPECT_FALSE(link.Bound());
+  link.Bind(ecm);
+  EXPECT_TRUE(link.Bound());
+
+  ASSERT_TRUE(link.WorldPose(ecm).has_value());
+  EXPECT_EQ(math::Pose3d(1, 2, 3, 0, 0, 0), *link.WorldPose(ecm));
+
+  // Values written to the component are seen through the kept pointer
+  ecm.Component<gazebo::components::WorldPose>(id)->Data() =
+      math::Pose3d(4, 5, 6, 0, 0, 0);
+  EXPECT_EQ(math::Pose3d(4, 5, 6, 0, 0, 0), *link.WorldPose(ecm));
+
+  // Created and removed components are seen too
+  EXPECT_FALSE(link.WorldInertialPose(ecm).has_value());
+  ecm.CreateComponent(id, gazebo::components::Inertial(
+      math::Inertiald(math::MassMatrix3d(1, {1, 1, 1}, {0, 0, 0}),
+      math::Pose3d(1, 0, 0, 0, 0, 0))));
+  ASSERT_TRUE(link.WorldInertialPose(ecm).has_value());
+  EXPECT_EQ(math::Pose3d(5, 5, 6, 0, 0, 0), *link.WorldInertialPose(ecm));
+
+  ecm.RemoveComponent<gazebo::components::WorldPose>(id);
+  EXPECT_FALSE(link.WorldPose(ecm).has_value());
+
+  // Wrenches accumulate in the kept component
+  link.AddWorldWrench(ecm, {1, 0, 0}, {0, 0, 0});
+  link.AddWorldWrench(ecm, {1, 0, 0}, {0, 0, 0});
+  auto wrench = ecm.Component<gazebo::components::ExternalWorldWrenchCmd>(id);
+  ASSERT_NE(nullptr, wrench);
+  EXPECT_EQ(math::Vector3d(2, 0, 0), msgs::Convert(wrench->Data().force()));
+
+  // Other managers are looked up directly
+  gazebo::EntityComponentManager other;
+  EXPECT_FALSE(link.WorldInertialPose(other).has_value());
+
+  link.Unbind();
+  EXPECT_FALSE(link.Bound());
+  EXPECT_FALSE(link.WorldPose(ecm).has_value());
+}
@@ -15,6 +15,8 @@
  *
 */
 
+#include <cstddef>
+
 #include "ignition/gazebo/components/Joint.hh"
 #include "ignition/gazebo/components/Link.hh"
 #include "ignition/gazebo/components/Model.hh"
@@ -27,10 +29,40 @@
 #include "ignition/gazebo/components/WindMode.hh"
 #include "ignition/gazebo/Model.hh"
 
+#include "ComponentCache.hh"
+
 class ignition::gazebo::ModelPrivate
 {
+  /// \brief Slots of the components kept by the cache.
+  public: enum Slot : std::size_t
+  {
+    kModelSlot,
+    kNameSlot,
+    kStaticSlot,
+    kSelfCollideSlot,
+    kWindModeSlot,
+    kSourceFilePathSlot,
+    kWorldPoseCmdSlot,
+    kSlotCount
+  };
+
+  /// \brief Get a component of the model, through the cache when bound.
+  /// \param[in] _ecm Entity-component manager.
+  /// \param[in] _slot Slot of the component type.
+  /// \return Component, or nullptr if the model doesn't have it.
+  public: template <typename ComponentTypeT>
+          const ComponentTypeT *Component(const EntityComponentManager &_ecm,
+              const Slot _slot)
+  {
+    return this->cache.template Component<ComponentTypeT>(_ecm, this->id,
+        _slot);
+  }
+
   /// \brief Id of model entity.
   public: Entity id{kNullEntity};
+
+  /// \brief Component pointers kept while bound, see Model::Bind.
+  public: ComponentCache<kSlotCount> cache;
 };
 
 using namespace ignition;
@@ -71,16 +103,36 @@ Entity Model::Entity() const
   return this->dataPtr->id;
 }
 
+//////////////////////////////////////////////////
+void Model::Bind(const EntityComponentManager &_ecm)
+{
+  this->dataPtr->cache.Bind(&_ecm);
+}
+
+//////////////////////////////////////////////////
+void Model::Unbind()
+{
+  this->dataPtr->cache.Bind(nullptr);
+}
+
+//////////////////////////////////////////////////
+bool Model::Bound() const
+{
+  return nullptr != this->dataPtr->cache.Bound();
+}
+
 //////////////////////////////////////////////////
 bool Model::Valid(const EntityComponentManager &_ecm) const
 {
-  return nullptr != _ecm.Component<components::Model>(this->dataPtr->id);
+  return nullptr != this->dataPtr->Component<components::Model>(_ecm,
+      ModelPrivate::kModelSlot);
 }
 
 //////////////////////////////////////////////////
 std::string Model::Name(const EntityComponentManager &_ecm) const
 {
-  auto comp = _ecm.Component<components::Name>(this->dataPtr->id);
+  auto comp = this->dataPtr->Component<components::Name>(_ecm,
+      ModelPrivate::kNameSlot);
   if (comp)
     return comp->Data();
 
@@ -90,7 +142,8 @@ std::string Model::Name(const EntityComponentManager &_ecm) const
 //////////////////////////////////////////////////
 bool Model::Static(const EntityComponentManager &_ecm) const
 {
-  auto comp = _ecm.Component<components::Static>(this->dataPtr->id);
+  auto comp = this->dataPtr->Component<components::Static>(_ecm,
+      ModelPrivate::kStaticSlot);
   if (comp)
     return comp->Data();
 
@@ -100,7 +153,8 @@ bool Model::Static(const EntityComponentManager &_ecm) const
 //////////////////////////////////////////////////
 bool Model::SelfCollide(const EntityComponentManager &_ecm) const
 {
-  auto comp = _ecm.Component<components::SelfCollide>(this->dataPtr->id);
+  auto comp = this->dataPtr->Component<components::SelfCollide>(_ecm,
+      ModelPrivate::kSelfCollideSlot);
   if (comp)
     return comp->Data();
 
@@ -110,7 +164,8 @@ bool Model::SelfCollide(const EntityComponentManager &_ecm) const
 //////////////////////////////////////////////////
 bool Model::WindMode(const EntityComponentManager &_ecm) const
 {
-  auto comp = _ecm.Component<components::WindMode>(this->dataPtr->id);
+  auto comp = this->dataPtr->Component<components::WindMode>(_ecm,
+      ModelPrivate::kWindModeSlot);
   if (comp)
     return comp->Data();
 
@@ -120,7 +175,8 @@ bool Model::WindMode(const EntityComponentManager &_ecm) const
 //////////////////////////////////////////////////
 std::string Model::SourceFilePath(const EntityComponentManager &_ecm) const
 {
-  auto comp = _ecm.Component<components::SourceFilePath>(this->dataPtr->id);
+  auto comp = this->dataPtr->Component<components::SourceFilePath>(_ecm,
+      ModelPrivate::kSourceFilePathSlot);
   if (comp)
     return comp->Data();
 
@@ -179,8 +235,9 @@ uint64_t Model::LinkCount(const EntityComponentManager &_ecm) const
 void Model::SetWorldPoseCmd(EntityComponentManager &_ecm,
     const math::Pose3d &_pose)
 {
-  auto poseCmdComp = _ecm.Component<components::WorldPoseCmd>(
-      this->dataPtr->id);
+  auto poseCmdComp =
+      this->dataPtr->cache.MutableComponent<components::WorldPoseCmd>(_ecm,
+      this->dataPtr->id, ModelPrivate::kWorldPoseCmdSlot);
   if (!poseCmdComp)
   {
     _ecm.CreateComponent(this->dataPtr->id, components::WorldPoseCmd(_pose));
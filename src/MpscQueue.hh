@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_MPSCQUEUE_HH_
+#define IGNITION_GAZEBO_MPSCQUEUE_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include <ignition/gazebo/config.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class MpscQueue MpscQueue.hh
+    /// \brief Lock-free queue with multiple producers and a single consumer,
+    /// which takes all queued values at once.
+    ///
+    /// Values are pushed on a linked list with a compare-and-swap, so
+    /// producers never wait for the consumer or for each other, and never
+    /// fail. The consumer detaches the whole list with a single exchange and
+    /// visits it in the order values were pushed. This suits messages which
+    /// are received on transport threads and handled once per iteration.
+    /// \tparam T Type of the values.
+    template <typename T>
+    class MpscQueue
+    {
+      /// \brief Constructor
+      public: MpscQueue() = default;
+
+      /// \brief Destructor, destroys values which weren't taken.
+      public: ~MpscQueue()
+      {
+        this->Drain([](T &&){});
+      }
+
+      /// \brief No copy, values are owned by a single queue.
+      public: MpscQueue(const MpscQueue &) = delete;
+
+      /// \brief No copy assignment.
+      public: MpscQueue &operator=(const MpscQueue &) = delete;
+
+      /// \brief Queue a value. May be called from any thread.
+      /// \param[in] _value Value to queue.
+      public: void Push(T _value)
+      {
+        Node *node = new Node{std::move(_value), nullptr};
+        node->next = this->head.load(std::memory_order_relaxed);
+        while (!this->head.compare_exchange_weak(node->next, node,
+            std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+      }
+
+      /// \brief Check whether values are queued.
+      /// \return True if there's nothing to take.
+      public: bool Empty() const
+      {
+        return nullptr == this->head.load(std::memory_order_acquire);
+      }
+
+      /// \brief Take all queued values and call a function on each, in the
+      /// order they were pushed. Values pushed meanwhile are kept for the
+      /// next call. Must only be called by one thread at a time.
+      /// \param[in] _fn Function called with each value.
+      /// \return Number of values taken.
+      public: template <typename Fn>
+              std::size_t Drain(Fn &&_fn)
+      {
+        Node *list = this->head.exchange(nullptr, std::memory_order_acquire);
+
+        // The list is newest first, reverse it
+        Node *reversed = nullptr;
+        while (list)
+        {
+          Node *next = list->next;
+          list->next = reversed;
+          reversed = list;
+          list = next;
+        }
+
+        std::size_t count = 0;
+        while (reversed)
+        {
+          Node *next = reversed->next;
+          _fn(std::move(reversed->value));
+          delete reversed;
+          reversed = next;
+          ++count;
+        }
+        return count;
+      }
+
+      /// \brief A queued value.
+      private: struct Node
+      {
+        /// \brief Value.
+        T value;
+
+        /// \brief Value pushed before this one.
+        Node *next;
+      };
+
+      /// \brief Last pushed value.
+      private: std::atomic<Node *> head{nullptr};
+    };
+    }
+  }
+}
+#endif
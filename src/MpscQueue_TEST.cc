@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "MpscQueue.hh"
+
+using namespace ignition::gazebo;
+
+/////////////////////////////////////////////////
+TEST(MpscQueueTest, Order)
+{
+  MpscQueue<int> queue;
+  EXPECT_TRUE(queue.Empty());
+  EXPECT_EQ(0u, queue.Drain([](int){}));
+
+  for (int i = 0; i < 5; ++i)
+    queue.Push(i);
+  EXPECT_FALSE(queue.Empty());
+
+  // Values are taken in the order they were pushed
+  std::vector<int> values;
+  EXPECT_EQ(5u, queue.Drain([&](int _value){ values.push_back(_value); }));
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3, 4}), values);
+  EXPECT_TRUE(queue.Empty());
+}
+
+/////////////////////////////////////////////////
+TEST(MpscQueueTest, MoveOnly)
+{
+  MpscQueue<std::unique_ptr<int>> queue;
+  queue.Push(std::make_unique<int>(3));
+
+  std::unique_ptr<int> taken;
+  queue.Drain([&](std::unique_ptr<int> &&_value){ taken = std::move(_value); });
+  ASSERT_NE(nullptr, taken);
+  EXPECT_EQ(3, *taken);
+
+  // Values which weren't taken are destroyed with the queue
+  queue.Push(std::make_unique<int>(4));
+}
+
+/////////////////////////////////////////////////
+TEST(MpscQueueTest, MultipleProducers)
+{
+  MpscQueue<int> queue;
+  const int producerCount = 4;
+  const int valueCount = 10000;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < producerCount; ++p)
+  {
+    producers.emplace_back([&queue, p]
+        {
+          for (int i = 0; i < valueCount; ++i)
+            queue.Push(p * valueCount + i);
+        });
+  }
+
+  // Drain while producers push, every value is taken once, and the values
+  // of each producer stay in order
+  std::vector<int> last(producerCount, -1);
+  std::size_t taken = 0;
+  bool ordered = true;
+  auto take = [&](int _value)
+  {
+    const int producer = _value / valueCount;
+    ordered = ordered && _value > last[producer];
+    last[producer] = _value;
+    ++taken;
+  };
+  while (taken < producerCount * valueCount)
+    queue.Drain(take);
+
+  for (auto &producer : producers)
+    producer.join();
+
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(static_cast<std::size_t>(producerCount * valueCount), taken);
+  EXPECT_TRUE(queue.Empty());
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "OdometryAggregator.hh"
+
+#include <ignition/msgs/pose_v.pb.h>
+
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <ignition/common/Profiler.hh>
+#include <ignition/msgs/Utility.hh>
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gazebo/Conversions.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+class ignition::gazebo::OdometryAggregatorPrivate
+{
+  /// \brief Publish the last snapshot if it's due. Must be called with the
+  /// mutex locked.
+  public: void Publish();
+
+  /// \brief Rebuild the message for the current set of valid slots. Must
+  /// be called with the mutex locked.
+  public: void BuildLayout();
+
+  /// \brief Ignition communication node.
+  public: transport::Node node;
+
+  /// \brief Publisher of the packed message
+  public: transport::Node::Publisher pub;
+
+  /// \brief Publication period
+  public: std::chrono::steady_clock::duration period{0};
+
+  /// \brief Sim time of the last publication
+  public: std::chrono::steady_clock::duration lastPubTime{0};
+
+  /// \brief Sim time of the snapshot being filled
+  public: std::chrono::steady_clock::duration snapshotTime{0};
+
+  /// \brief Iteration of the snapshot being filled
+  public: uint64_t lastIteration{0};
+
+  /// \brief True once any vehicle has stored its odometry
+  public: bool hasSnapshot{false};
+
+  /// \brief Odometry X position per slot
+  public: std::vector<double> x;
+
+  /// \brief Odometry Y position per slot
+  public: std::vector<double> y;
+
+  /// \brief Odometry heading per slot
+  public: std::vector<double> yaw;
+
+  /// \brief Whether each slot holds odometry that should be published
+  public: std::vector<uint8_t> valid;
+
+  /// \brief Whether each slot belongs to a vehicle
+  public: std::vector<uint8_t> active;
+
+  /// \brief Frame id per slot
+  public: std::vector<std::string> frameIds;
+
+  /// \brief Child frame id per slot
+  public: std::vector<std::string> childFrameIds;
+
+  /// \brief Slots released by vehicles that left
+  public: std::vector<std::size_t> freeSlots;
+
+  /// \brief Slot of each pose in the packed message
+  public: std::vector<std::size_t> layout;
+
+  /// \brief True if the message layout needs to be rebuilt
+  public: bool layoutDirty{true};
+
+  /// \brief Reused packed message
+  public: msgs::Pose_V msg;
+
+  /// \brief Protects all the state, vehicles update in parallel
+  public: mutable std::mutex mutex;
+};
+
+//////////////////////////////////////////////////
+OdometryAggregator::OdometryAggregator(const std::string &_topic,
+    const std::chrono::steady_clock::duration &_period)
+  : dataPtr(std::make_unique<OdometryAggregatorPrivate>())
+{
+  this->dataPtr->period = _period;
+  this->dataPtr->pub = this->dataPtr->node.Advertise<msgs::Pose_V>(_topic);
+}
+
+//////////////////////////////////////////////////
+OdometryAggregator::~OdometryAggregator() = default;
+
+//////////////////////////////////////////////////
+std::shared_ptr<OdometryAggregator> OdometryAggregator::Get(
+    const EntityComponentManager &_ecm, const std::string &_topic,
+    const std::chrono::steady_clock::duration &_period)
+{
+  return _ecm.SharedObject<OdometryAggregator>(
+      "ignition::gazebo::OdometryAggregator:" + _topic + ":" +
+      std::to_string(_period.count()), _topic, _period);
+}
+
+//////////////////////////////////////////////////
+std::size_t OdometryAggregator::Add(const std::string &_frameId,
+    const std::string &_childFrameId)
+{
+  auto &data = *this->dataPtr;
+  std::lock_guard<std::mutex> lock(data.mutex);
+  std::size_t slot;
+  if (data.freeSlots.empty())
+  {
+    slot = data.x.size();
+    data.x.push_back(0.0);
+    data.y.push_back(0.0);
+    data.yaw.push_back(0.0);
+    data.valid.push_back(0);
+    data.active.push_back(0);
+    data.frameIds.emplace_back();
+    data.childFrameIds.emplace_back();
+  }
+  else
+  {
+    slot = data.freeSlots.back();
+    data.freeSlots.pop_back();
+  }
+  data.x[slot] = 0.0;
+  data.y[slot] = 0.0;
+  data.yaw[slot] = 0.0;
+  data.valid[slot] = 0;
+  data.active[slot] = 1;
+  data.frameIds[slot] = _frameId;
+  data.childFrameIds[slot] = _childFrameId;
+  return slot;
+}
+
+//////////////////////////////////////////////////
+void OdometryAggregator::Remove(const std::size_t _slot)
+{
+  auto &data = *this->dataPtr;
+  std::lock_guard<std::mutex> lock(data.mutex);
+  if (_slot >= data.active.size() || !data.active[_slot])
+    return;
+  data.active[_slot] = 0;
+  if (data.valid[_slot])
+    data.layoutDirty = true;
+  data.valid[_slot] = 0;
+  data.freeSlots.push_back(_slot);
+}
+
+//////////////////////////////////////////////////
+void OdometryAggregator::Set(const UpdateInfo &_info,
+    const std::size_t _slot, const double _x, const double _y,
+    const double _yaw)
+{
+  auto &data = *this->dataPtr;
+  std::lock_guard<std::mutex> lock(data.mutex);
+  if (data.lastIteration != _info.iterations)
+  {
+    data.Publish();
+    data.lastIteration = _info.iterations;
+    data.snapshotTime = _info.simTime;
+  }
+
+  if (_slot >= data.active.size() || !data.active[_slot])
+    return;
+  if (!data.valid[_slot])
+  {
+    data.valid[_slot] = 1;
+    data.layoutDirty = true;
+  }
+  data.x[_slot] = _x;
+  data.y[_slot] = _y;
+  data.yaw[_slot] = _yaw;
+  data.hasSnapshot = true;
+}
+
+//////////////////////////////////////////////////
+std::size_t OdometryAggregator::Count() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->active.size() - this->dataPtr->freeSlots.size();
+}
+
+//////////////////////////////////////////////////
+void OdometryAggregatorPrivate::Publish()
+{
+  if (!this->hasSnapshot)
+    return;
+
+  auto diff = this->snapshotTime - this->lastPubTime;
+  if (diff > std::chrono::steady_clock::duration::zero() &&
+      diff < this->period)
+  {
+    return;
+  }
+
+  IGN_PROFILE("OdometryAggregator::Publish");
+  if (this->layoutDirty)
+    this->BuildLayout();
+
+  *this->msg.mutable_header()->mutable_stamp() =
+      convert<msgs::Time>(this->snapshotTime);
+
+  // Planar odometry only needs the first two position components and a
+  // rotation about Z, so fill the fields directly from the arrays.
+  for (std::size_t i = 0; i < this->layout.size(); ++i)
+  {
+    const std::size_t s = this->layout[i];
+    auto pose = this->msg.mutable_pose(static_cast<int>(i));
+    pose->mutable_position()->set_x(this->x[s]);
+    pose->mutable_position()->set_y(this->y[s]);
+    const double halfYaw = 0.5 * this->yaw[s];
+    pose->mutable_orientation()->set_z(std::sin(halfYaw));
+    pose->mutable_orientation()->set_w(std::cos(halfYaw));
+  }
+
+  this->pub.Publish(this->msg);
+  this->lastPubTime = this->snapshotTime;
+}
+
+//////////////////////////////////////////////////
+void OdometryAggregatorPrivate::BuildLayout()
+{
+  this->layout.clear();
+  this->msg.Clear();
+  for (std::size_t s = 0; s < this->valid.size(); ++s)
+  {
+    if (!this->valid[s])
+      continue;
+    this->layout.push_back(s);
+
+    auto pose = this->msg.add_pose();
+    auto frame = pose->mutable_header()->add_data();
+    frame->set_key("frame_id");
+    frame->add_value(this->frameIds[s]);
+    if (!this->childFrameIds[s].empty())
+    {
+      auto childFrame = pose->mutable_header()->add_data();
+      childFrame->set_key("child_frame_id");
+      childFrame->add_value(this->childFrameIds[s]);
+    }
+    pose->mutable_position()->set_z(0.0);
+    pose->mutable_orientation()->set_x(0.0);
+    pose->mutable_orientation()->set_y(0.0);
+  }
+  this->layoutDirty = false;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_ODOMETRYAGGREGATOR_HH_
+#define IGNITION_GAZEBO_ODOMETRYAGGREGATOR_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/Types.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class OdometryAggregatorPrivate;
+
+    /// \class OdometryAggregator OdometryAggregator.hh
+    /// \brief Packs the planar odometry of every wheeled vehicle that shares
+    /// an aggregate topic and a publication rate into a single Pose_V
+    /// message.
+    ///
+    /// Vehicle systems, such as DiffDrive and AckermannSteering, keep their
+    /// own kinematics and write their odometry into a slot of
+    /// structure-of-arrays storage every iteration. The aggregator lives in
+    /// this library, so vehicles of all systems publishing on the same
+    /// topic share it. The first vehicle to reach a new iteration publishes
+    /// the snapshot completed during the previous one, so the message is
+    /// always consistent across vehicles at the cost of one iteration of
+    /// latency. The message layout, including the frame ids, is only
+    /// rebuilt when vehicles join or leave.
+    class IGNITION_GAZEBO_VISIBLE OdometryAggregator
+    {
+      /// \brief Constructor
+      /// \param[in] _topic Topic of the packed message.
+      /// \param[in] _period Publication period, zero to publish every
+      /// iteration.
+      public: OdometryAggregator(const std::string &_topic,
+                  const std::chrono::steady_clock::duration &_period);
+
+      /// \brief Destructor
+      public: ~OdometryAggregator();
+
+      /// \brief Get the aggregator of an entity component manager for a
+      /// topic and rate, creating it if needed. The aggregator is kept
+      /// while any vehicle holds it.
+      /// \param[in] _ecm Entity component manager of the vehicles.
+      /// \param[in] _topic Topic of the packed message.
+      /// \param[in] _period Publication period.
+      /// \return The shared aggregator.
+      public: static std::shared_ptr<OdometryAggregator> Get(
+                  const EntityComponentManager &_ecm,
+                  const std::string &_topic,
+                  const std::chrono::steady_clock::duration &_period);
+
+      /// \brief Add a vehicle to the packed message.
+      /// \param[in] _frameId Frame id of the vehicle's odometry.
+      /// \param[in] _childFrameId Child frame id, may be empty.
+      /// \return Slot to pass to Set and Remove.
+      public: std::size_t Add(const std::string &_frameId,
+                  const std::string &_childFrameId);
+
+      /// \brief Remove a vehicle from the packed message.
+      /// \param[in] _slot Slot returned by Add.
+      public: void Remove(const std::size_t _slot);
+
+      /// \brief Store a vehicle's odometry for the current iteration. The
+      /// first call of each iteration publishes the previous snapshot if
+      /// it's due. This can be called from the threads of several systems.
+      /// \param[in] _info Update info.
+      /// \param[in] _slot Slot returned by Add.
+      /// \param[in] _x Odometry X position.
+      /// \param[in] _y Odometry Y position.
+      /// \param[in] _yaw Odometry heading.
+      public: void Set(const UpdateInfo &_info, const std::size_t _slot,
+                  const double _x, const double _y, const double _yaw);
+
+      /// \brief Get the number of vehicles.
+      /// \return Number of vehicles added and not removed.
+      public: std::size_t Count() const;
+
+      /// \brief Pointer to private data.
+      private: std::unique_ptr<OdometryAggregatorPrivate> dataPtr;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_ODOMETRYAGGREGATOR_HH_
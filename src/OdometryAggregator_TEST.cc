@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/msgs/pose_v.pb.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gazebo/EntityComponentManager.hh"
+
+#include "OdometryAggregator.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/////////////////////////////////////////////////
+/// \brief Get the update info of an iteration.
+/// \param[in] _iteration Iteration.
+/// \return Update info.
+UpdateInfo Info(const uint64_t _iteration)
+{
+  UpdateInfo info;
+  info.dt = 1ms;
+  info.iterations = _iteration;
+  info.simTime = info.dt * static_cast<int>(_iteration);
+  info.paused = false;
+  return info;
+}
+
+/////////////////////////////////////////////////
+TEST(OdometryAggregatorTest, Shared)
+{
+  EntityComponentManager ecm;
+  auto aggregator = OdometryAggregator::Get(ecm, "/odom_shared", 0ms);
+  EXPECT_EQ(aggregator, OdometryAggregator::Get(ecm, "/odom_shared", 0ms));
+
+  // Other topics, rates and managers get their own aggregator
+  EXPECT_NE(aggregator, OdometryAggregator::Get(ecm, "/odom_other", 0ms));
+  EXPECT_NE(aggregator, OdometryAggregator::Get(ecm, "/odom_shared", 10ms));
+  EntityComponentManager other;
+  EXPECT_NE(aggregator, OdometryAggregator::Get(other, "/odom_shared", 0ms));
+
+  const auto slot = aggregator->Add("a/odom", "a/chassis");
+  EXPECT_EQ(1u, aggregator->Count());
+  aggregator->Remove(slot);
+  EXPECT_EQ(0u, aggregator->Count());
+
+  // Removing again is ignored
+  aggregator->Remove(slot);
+  EXPECT_EQ(0u, aggregator->Count());
+}
+
+/////////////////////////////////////////////////
+TEST(OdometryAggregatorTest, PacksVehicles)
+{
+  std::mutex mutex;
+  msgs::Pose_V lastMsg;
+  unsigned int count{0};
+  std::function<void(const msgs::Pose_V &)> cb =
+    [&](const msgs::Pose_V &_msg)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      lastMsg = _msg;
+      ++count;
+    };
+
+  transport::Node node;
+  node.Subscribe("/odom_packed", cb);
+
+  // Vehicles of different systems get the aggregator the same way
+  EntityComponentManager ecm;
+  auto first = OdometryAggregator::Get(ecm, "/odom_packed", 0ms);
+  auto second = OdometryAggregator::Get(ecm, "/odom_packed", 0ms);
+  const auto slotA = first->Add("a/odom", "a/chassis");
+  const auto slotB = second->Add("b/odom", "");
+
+  first->Set(Info(1), slotA, 1.0, 2.0, 0.0);
+  second->Set(Info(1), slotB, 3.0, 4.0, 0.0);
+
+  // The snapshot of an iteration is published by the next one
+  first->Set(Info(2), slotA, 1.0, 2.0, 0.0);
+
+  for (int sleep = 0; sleep < 30; ++sleep)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (count > 0)
+        break;
+    }
+    std::this_thread::sleep_for(100ms);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(1u, count);
+  ASSERT_EQ(2, lastMsg.pose_size());
+  EXPECT_EQ(1, lastMsg.header().stamp().nsec() / 1000000);
+
+  EXPECT_EQ("a/odom", lastMsg.pose(0).header().data(0).value(0));
+  EXPECT_EQ("a/chassis", lastMsg.pose(0).header().data(1).value(0));
+  EXPECT_DOUBLE_EQ(1.0, lastMsg.pose(0).position().x());
+  EXPECT_DOUBLE_EQ(2.0, lastMsg.pose(0).position().y());
+
+  // Empty child frames are left out
+  ASSERT_EQ(1, lastMsg.pose(1).header().data_size());
+  EXPECT_EQ("b/odom", lastMsg.pose(1).header().data(0).value(0));
+  EXPECT_DOUBLE_EQ(3.0, lastMsg.pose(1).position().x());
+  EXPECT_DOUBLE_EQ(4.0, lastMsg.pose(1).position().y());
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Pose3.hh>
+
+#include "ignition/gazebo/PackedPoses.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(PackedPoses, WriteRead)
+{
+  const std::vector<std::pair<Entity, math::Pose3d>> poses{
+      {1, math::Pose3d(0, 0, 0, 0, 0, 0)},
+      {2, math::Pose3d(1.2345, -20.5, 300.01, 0.1, -0.2, 3.0)},
+      {(Entity(3) << 32) | 7, math::Pose3d(-1e3, 1e-4, 0.5, -3.1, 1.5, 0.7)},
+      {4, math::Pose3d(0, 0, 0, IGN_PI, 0, 0)}};
+
+  std::string buffer;
+  PackedPoses::Begin(0.001, std::chrono::milliseconds(1500), buffer);
+  for (const auto &[entity, pose] : poses)
+    PackedPoses::Append(entity, pose, buffer);
+  EXPECT_EQ(PackedPoses::kHeaderSize + poses.size() * PackedPoses::kPoseSize,
+      buffer.size());
+
+  std::vector<std::pair<Entity, math::Pose3d>> read;
+  std::chrono::steady_clock::duration simTime;
+  ASSERT_TRUE(PackedPoses::Read(buffer, read, simTime));
+  EXPECT_EQ(std::chrono::milliseconds(1500), simTime);
+  ASSERT_EQ(poses.size(), read.size());
+  for (std::size_t i = 0; i < poses.size(); ++i)
+  {
+    EXPECT_EQ(poses[i].first, read[i].first);
+    EXPECT_NEAR(0.0, (poses[i].second.Pos() - read[i].second.Pos()).Length(),
+        1e-3);
+
+    // Both quaternions describe the same rotation up to about 0.1 degrees
+    const auto &q1 = poses[i].second.Rot();
+    const auto &q2 = read[i].second.Rot();
+    const double dot = std::abs(q1.W() * q2.W() + q1.X() * q2.X() +
+        q1.Y() * q2.Y() + q1.Z() * q2.Z());
+    EXPECT_GT(dot, std::cos(IGN_DTOR(0.2) / 2.0));
+  }
+
+  // Buffers are reused
+  PackedPoses::Begin(0.01, std::chrono::seconds(2), buffer);
+  EXPECT_EQ(PackedPoses::kHeaderSize, buffer.size());
+  ASSERT_TRUE(PackedPoses::Read(buffer, read, simTime));
+  EXPECT_TRUE(read.empty());
+  EXPECT_EQ(std::chrono::seconds(2), simTime);
+}
+
+/////////////////////////////////////////////////
+TEST(PackedPoses, Invalid)
+{
+  std::vector<std::pair<Entity, math::Pose3d>> read;
+  std::chrono::steady_clock::duration simTime;
+  EXPECT_FALSE(PackedPoses::Read("", read, simTime));
+  EXPECT_FALSE(PackedPoses::Read("not packed poses", read, simTime));
+
+  // Truncated
+  std::string buffer;
+  PackedPoses::Begin(0.001, std::chrono::seconds(0), buffer);
+  PackedPoses::Append(1, math::Pose3d(1, 2, 3, 0, 0, 0), buffer);
+  buffer.pop_back();
+  EXPECT_FALSE(PackedPoses::Read(buffer, read, simTime));
+  EXPECT_TRUE(read.empty());
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+#include "ignition/gazebo/RandomStream.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(RandomStream, Keys)
+{
+  RandomStream a(1, 2, 3);
+  RandomStream b(1, 2, 3);
+  RandomStream seed(4, 2, 3);
+  RandomStream key(1, 5, 3);
+  RandomStream counter(1, 2, 6);
+
+  for (int i = 0; i < 100; ++i)
+  {
+    const uint64_t value = a();
+    EXPECT_EQ(value, b());
+    EXPECT_NE(value, seed());
+    EXPECT_NE(value, key());
+    EXPECT_NE(value, counter());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(RandomStream, Uniform)
+{
+  RandomStream random(1, 2);
+  double sum = 0.0;
+  const int count = 10000;
+  for (int i = 0; i < count; ++i)
+  {
+    const double value = random.Uniform(-2.0, 4.0);
+    EXPECT_LE(-2.0, value);
+    EXPECT_GT(4.0, value);
+    sum += value;
+  }
+  EXPECT_NEAR(1.0, sum / count, 0.1);
+}
+
+/////////////////////////////////////////////////
+TEST(RandomStream, Normal)
+{
+  RandomStream random(1, 2);
+  double sum = 0.0;
+  double squares = 0.0;
+  const int count = 10000;
+  for (int i = 0; i < count; ++i)
+  {
+    const double value = random.Normal(3.0, 2.0);
+    EXPECT_TRUE(std::isfinite(value));
+    sum += value;
+    squares += value * value;
+  }
+  const double mean = sum / count;
+  EXPECT_NEAR(3.0, mean, 0.1);
+  EXPECT_NEAR(2.0, std::sqrt(squares / count - mean * mean), 0.1);
+}
+
+/////////////////////////////////////////////////
+TEST(RandomStream, StandardDistribution)
+{
+  RandomStream a(1, 2);
+  RandomStream b(1, 2);
+  std::uniform_int_distribution<int> distribution(0, 9);
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(distribution(a), distribution(b));
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ResourcePrefetcher.hh"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Profiler.hh>
+#include <sdf/parser.hh>
+
+using namespace ignition;
+using namespace gazebo;
+
+//////////////////////////////////////////////////
+ResourcePrefetcher::ResourcePrefetcher(ResolveFn _resolve, FetchFn _fetch,
+    unsigned int _threads)
+  : resolve(std::move(_resolve)), fetch(std::move(_fetch)),
+    threads(std::max(1u, _threads))
+{
+}
+
+//////////////////////////////////////////////////
+std::vector<std::string> ResourcePrefetcher::FindUris(const std::string &_sdf)
+{
+  const std::string open{"<uri>"};
+  const std::string close{"</uri>"};
+  const std::string whitespace{" \t\r\n"};
+
+  std::vector<std::string> uris;
+  for (auto start = _sdf.find(open); start != std::string::npos;
+       start = _sdf.find(open, start))
+  {
+    start += open.size();
+    auto end = _sdf.find(close, start);
+    if (end == std::string::npos)
+      break;
+
+    auto first = _sdf.find_first_not_of(whitespace, start);
+    auto last = _sdf.find_last_not_of(whitespace, end - 1);
+    if (first < end && last != std::string::npos && last >= first)
+      uris.push_back(_sdf.substr(first, last - first + 1));
+    start = end + close.size();
+  }
+  return uris;
+}
+
+//////////////////////////////////////////////////
+std::size_t ResourcePrefetcher::Prefetch(const std::string &_sdf) const
+{
+  IGN_PROFILE("ResourcePrefetcher::Prefetch");
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<std::string> queue;
+  std::set<std::string> seen;
+  std::size_t active{0};
+  std::size_t done{0};
+  std::size_t fetched{0};
+
+  // Must be called with the mutex locked
+  auto enqueue = [&](const std::vector<std::string> &_uris)
+  {
+    for (const auto &uri : _uris)
+    {
+      auto key = this->resolve(uri);
+      if (!key.empty() && seen.insert(key).second)
+        queue.push_back(key);
+    }
+  };
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    enqueue(FindUris(_sdf));
+    if (queue.empty())
+      return 0;
+  }
+
+  auto work = [&]
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+      cv.wait(lock, [&] {return !queue.empty() || active == 0;});
+      if (queue.empty())
+        return;
+
+      auto key = queue.front();
+      queue.pop_front();
+      ++active;
+
+      lock.unlock();
+      auto path = this->fetch(key);
+
+      // Models included by the fetched model are fetched too
+      std::vector<std::string> nested;
+      if (!path.empty())
+      {
+        auto sdfPath = sdf::getModelFilePath(path);
+        std::ifstream file(sdfPath);
+        if (file)
+        {
+          std::string content{std::istreambuf_iterator<char>(file),
+              std::istreambuf_iterator<char>()};
+          nested = FindUris(content);
+        }
+      }
+      lock.lock();
+
+      --active;
+      ++done;
+      if (!path.empty())
+        ++fetched;
+      enqueue(nested);
+      ignmsg << "Prefetched resource [" << done << "/" << seen.size()
+             << "]: [" << key << "]" << (path.empty() ? " failed" : "")
+             << std::endl;
+      cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < this->threads; ++i)
+    workers.emplace_back(work);
+  for (auto &worker : workers)
+    worker.join();
+
+  return fetched;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_RESOURCEPREFETCHER_HH_
+#define IGNITION_GAZEBO_RESOURCEPREFETCHER_HH_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class ResourcePrefetcher ResourcePrefetcher.hh
+    /// \brief Fetches the remote resources referred to by a world in
+    /// parallel, before the world is parsed, so parsing finds them cached
+    /// instead of downloading them one at a time.
+    ///
+    /// Resources are found in the `<uri>` elements of the world, then in
+    /// the model SDF files of each fetched resource, so models included by
+    /// fetched models are fetched too.
+    class IGNITION_GAZEBO_VISIBLE ResourcePrefetcher
+    {
+      /// \brief Function mapping a URI to the key of the resource holding
+      /// it, or to an empty string if it isn't fetched. Several URIs, such
+      /// as the files of a model, may map to the same resource.
+      public: using ResolveFn =
+          std::function<std::string(const std::string &_uri)>;
+
+      /// \brief Function fetching a resource, called from several threads.
+      /// It returns the local directory of the resource, or an empty string
+      /// on failure.
+      public: using FetchFn =
+          std::function<std::string(const std::string &_key)>;
+
+      /// \brief Constructor
+      /// \param[in] _resolve Maps URIs to resources.
+      /// \param[in] _fetch Fetches resources.
+      /// \param[in] _threads Maximum number of resources fetched at once.
+      public: ResourcePrefetcher(ResolveFn _resolve, FetchFn _fetch,
+                                 unsigned int _threads);
+
+      /// \brief Find the content of the `<uri>` elements of an SDF document.
+      /// \param[in] _sdf SDF document.
+      /// \return URIs in the order they appear.
+      public: static std::vector<std::string> FindUris(
+                  const std::string &_sdf);
+
+      /// \brief Fetch the resources of a world, and of the resources it
+      /// refers to, blocking until they're all fetched. Progress is
+      /// reported as each resource is fetched.
+      /// \param[in] _sdf Content of the world.
+      /// \return Number of resources which were fetched successfully.
+      public: std::size_t Prefetch(const std::string &_sdf) const;
+
+      /// \brief Maps URIs to resources.
+      private: ResolveFn resolve;
+
+      /// \brief Fetches resources.
+      private: FetchFn fetch;
+
+      /// \brief Maximum number of resources fetched at once.
+      private: unsigned int threads;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_RESOURCEPREFETCHER_HH_
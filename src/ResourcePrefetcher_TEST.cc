@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Filesystem.hh>
+
+#include "ignition/gazebo/test_config.hh"
+
+#include "ResourcePrefetcher.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(ResourcePrefetcher, FindUris)
+{
+  const std::string sdf = R"(<sdf version="1.6">
+  <world name="default">
+    <include><uri>https://server/models/a</uri></include>
+    <include>
+      <uri>
+        model://b
+      </uri>
+    </include>
+    <model name="c"><link name="link"><visual name="visual"><geometry>
+      <mesh><uri>https://server/models/a/files/mesh.dae</uri></mesh>
+    </geometry></visual></link></model>
+    <uri></uri>
+    <uri>unterminated)";
+
+  EXPECT_EQ((std::vector<std::string>{"https://server/models/a", "model://b",
+      "https://server/models/a/files/mesh.dae"}),
+      ResourcePrefetcher::FindUris(sdf));
+  EXPECT_TRUE(ResourcePrefetcher::FindUris("<sdf/>").empty());
+}
+
+/////////////////////////////////////////////////
+TEST(ResourcePrefetcher, Prefetch)
+{
+  // Resource "outer" includes "inner", which is only found once "outer"
+  // is fetched
+  const std::string dir = common::joinPaths(PROJECT_BINARY_PATH,
+      "test_resource_prefetcher");
+  common::removeAll(dir);
+  for (const std::string name : {"outer", "inner"})
+  {
+    const auto modelDir = common::joinPaths(dir, name);
+    ASSERT_TRUE(common::createDirectories(modelDir));
+    std::ofstream(common::joinPaths(modelDir, "model.config")) <<
+        "<?xml version='1.0'?><model><name>" << name << "</name>"
+        "<sdf version='1.6'>model.sdf</sdf></model>";
+    std::ofstream(common::joinPaths(modelDir, "model.sdf")) <<
+        "<sdf version='1.6'><model name='" << name << "'>" <<
+        (name == "outer" ? "<include><uri>remote://inner</uri></include>" :
+        "") << "</model></sdf>";
+  }
+
+  std::mutex mutex;
+  std::map<std::string, int> fetches;
+  std::atomic<int> active{0};
+  std::atomic<int> maxActive{0};
+
+  ResourcePrefetcher prefetcher(
+      [](const std::string &_uri) -> std::string
+      {
+        // Files of a resource map to the resource
+        const std::string prefix{"remote://"};
+        if (_uri.compare(0, prefix.size(), prefix) != 0)
+          return "";
+        auto name = _uri.substr(prefix.size());
+        return name.substr(0, name.find('/'));
+      },
+      [&](const std::string &_key) -> std::string
+      {
+        int now = ++active;
+        int prev = maxActive;
+        while (now > prev && !maxActive.compare_exchange_weak(prev, now))
+        {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        --active;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++fetches[_key];
+        if (_key == "missing")
+          return "";
+        if (_key == "outer" || _key == "inner")
+          return common::joinPaths(dir, _key);
+        // Resources without files
+        return dir;
+      }, 2);
+
+  const std::string sdf = R"(<sdf version="1.6"><world name="default">
+    <include><uri>remote://outer</uri></include>
+    <include><uri>remote://outer/files/mesh.dae</uri></include>
+    <include><uri>model://local</uri></include>
+    <include><uri>remote://missing</uri></include>
+    <include><uri>remote://x</uri></include>
+    <include><uri>remote://y</uri></include>
+    <include><uri>remote://z</uri></include>
+  </world></sdf>)";
+
+  // Everything is fetched once, failures aren't counted
+  EXPECT_EQ(5u, prefetcher.Prefetch(sdf));
+  EXPECT_EQ((std::map<std::string, int>{{"outer", 1}, {"inner", 1},
+      {"missing", 1}, {"x", 1}, {"y", 1}, {"z", 1}}), fetches);
+
+  // Fetches ran in parallel, within the bound
+  EXPECT_GE(2, maxActive);
+  EXPECT_LT(0, maxActive);
+
+  EXPECT_EQ(0u, prefetcher.Prefetch("<sdf version='1.6'/>"));
+}
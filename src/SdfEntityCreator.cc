@@ -15,6 +15,15 @@
  *
 */
 
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Profiler.hh>
 #include <sdf/Types.hh>
@@ -73,8 +82,161 @@
 #include "ignition/gazebo/components/WindMode.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "StartupProfile.hh"
+#include "TaskPool.hh"
+
+namespace
+{
+/// \brief Parent index of the root of a batch of pending entities.
+constexpr std::size_t kNoParent = std::numeric_limits<std::size_t>::max();
+
+/////////////////////////////////////////////////
+/// \brief Get the task pool which converts models from SDF in parallel. It's
+/// created the first time it's needed.
+/// \return The task pool.
+ignition::gazebo::TaskPool &ConversionPool()
+{
+  static ignition::gazebo::TaskPool pool;
+  return pool;
+}
+}
+
 class ignition::gazebo::SdfEntityCreatorPrivate
 {
+  /// \brief Which plugins an entity's SDF element holds. They're loaded only
+  /// after the entire model has been created, so they get scoped names.
+  public: enum class Plugins
+  {
+    /// \brief The element has no plugins loaded by the creator.
+    kNone,
+
+    /// \brief Model plugins.
+    kModel,
+
+    /// \brief Sensor plugins.
+    kSensor,
+
+    /// \brief Visual plugins.
+    kVisual
+  };
+
+  /// \brief An entity converted from SDF whose components haven't been
+  /// created yet. Converting doesn't touch the ECM, so many models can be
+  /// converted in parallel and then created one after the other.
+  public: struct PendingEntity
+  {
+    /// \brief Add a component to create along with the entity.
+    /// \param[in] _component Component, which is moved into the ECM.
+    public: template<typename ComponentTypeT>
+            void Add(ComponentTypeT &&_component)
+    {
+      auto component = std::make_shared<std::decay_t<ComponentTypeT>>(
+          std::forward<ComponentTypeT>(_component));
+      this->components.push_back(
+          [component](EntityComponentManager &_ecm, const Entity _entity)
+          {
+            _ecm.CreateComponent(_entity, std::move(*component));
+          });
+    }
+
+    /// \brief Functions creating each component of the entity.
+    public: std::vector<std::function<void(EntityComponentManager &,
+        const Entity)>> components;
+
+    /// \brief Index of the parent within its batch, or kNoParent.
+    public: std::size_t parent{kNoParent};
+
+    /// \brief True if the conversion failed. The entity is still created
+    /// with the components converted so far, but it isn't parented and
+    /// kNullEntity is returned for it.
+    public: bool failed{false};
+
+    /// \brief Which plugins the element holds.
+    public: Plugins plugins{Plugins::kNone};
+
+    /// \brief Element holding the plugins.
+    public: sdf::ElementPtr element;
+
+    /// \brief Name of the canonical link relative to this model, which is
+    /// looked up after all descendants have been created. Empty if the
+    /// entity isn't a model or its canonical link couldn't be resolved.
+    public: std::string canonicalLinkName;
+  };
+
+  /// \brief A batch of pending entities, with parents before children.
+  public: using PendingEntities = std::vector<PendingEntity>;
+
+  /// \brief Convert a model and its descendants.
+  /// \param[in] _model SDF model object.
+  /// \param[in] _staticParent True if the parent is static.
+  /// \param[in] _parent Index of the parent within _pending, or kNoParent.
+  /// \param[in, out] _pending Batch the entities are appended to.
+  /// \return Index of the model within _pending.
+  public: static std::size_t ConvertModel(const sdf::Model *_model,
+              bool _staticParent, std::size_t _parent,
+              PendingEntities &_pending);
+
+  /// \brief Convert a light.
+  /// \param[in] _light SDF light object.
+  /// \param[in] _parent Index of the parent within _pending, or kNoParent.
+  /// \param[in, out] _pending Batch the entity is appended to.
+  /// \return Index of the light within _pending.
+  public: static std::size_t ConvertLight(const sdf::Light *_light,
+              std::size_t _parent, PendingEntities &_pending);
+
+  /// \brief Convert a link and its descendants.
+  /// \param[in] _link SDF link object.
+  /// \param[in] _parent Index of the parent within _pending, or kNoParent.
+  /// \param[in, out] _pending Batch the entities are appended to.
+  /// \return Index of the link within _pending.
+  public: static std::size_t ConvertLink(const sdf::Link *_link,
+              std::size_t _parent, PendingEntities &_pending);
+
+  /// \brief Convert a joint.
+  /// \param[in] _joint SDF joint object.
+  /// \param[in] _parent Index of the parent within _pending, or kNoParent.
+  /// \param[in, out] _pending Batch the entity is appended to.
+  /// \return Index of the joint within _pending.
+  public: static std::size_t ConvertJoint(const sdf::Joint *_joint,
+              std::size_t _parent, PendingEntities &_pending);
+
+  /// \brief Convert a visual.
+  /// \param[in] _visual SDF visual object.
+  /// \param[in] _parent Index of the parent within _pending, or kNoParent.
+  /// \param[in, out] _pending Batch the entity is appended to.
+  /// \return Index of the visual within _pending.
+  public: static std::size_t ConvertVisual(const sdf::Visual *_visual,
+              std::size_t _parent, PendingEntities &_pending);
+
+  /// \brief Convert a collision.
+  /// \param[in] _collision SDF collision object.
+  /// \param[in] _parent Index of the parent within _pending, or kNoParent.
+  /// \param[in, out] _pending Batch the entity is appended to.
+  /// \return Index of the collision within _pending.
+  public: static std::size_t ConvertCollision(
+              const sdf::Collision *_collision, std::size_t _parent,
+              PendingEntities &_pending);
+
+  /// \brief Convert a sensor.
+  /// \param[in] _sensor SDF sensor object.
+  /// \param[in] _parent Index of the parent within _pending, or kNoParent.
+  /// \param[in, out] _pending Batch the entity is appended to.
+  /// \return Index of the sensor within _pending.
+  public: static std::size_t ConvertSensor(const sdf::Sensor *_sensor,
+              std::size_t _parent, PendingEntities &_pending);
+
+  /// \brief Create a batch of converted entities in the ECM. Their plugins
+  /// are only tracked, see LoadPlugins.
+  /// \param[in, out] _pending Converted entities. Their components are
+  /// moved into the ECM.
+  /// \return Entity of the first element of the batch, or kNullEntity if
+  /// the batch is empty or its conversion failed.
+  public: Entity Create(PendingEntities &_pending);
+
+  /// \brief Load the plugins of the models, sensors and visuals created
+  /// since the last call.
+  public: void LoadPlugins();
+
   /// \brief Pointer to entity component manager. We don't assume ownership.
   public: EntityComponentManager *ecm{nullptr};
 
@@ -94,6 +256,22 @@ class ignition::gazebo::SdfEntityCreatorPrivate
   public: std::map<Entity, sdf::ElementPtr> newVisuals;
 };
 
+  /// \brief Pointer to event manager. We don't assume ownership.
+  public: EventManager *eventManager{nullptr};
+
+  /// \brief Keep track of new sensors being added, so we load their plugins
+  /// only after we have their scoped name.
+  public: std::map<Entity, sdf::ElementPtr> newSensors;
+
+  /// \brief Keep track of new models being added, so we load their plugins
+  /// only after we have their scoped name.
+  public: std::map<Entity, sdf::ElementPtr> newModels;
+
+  /// \brief Keep track of new visuals being added, so we load their plugins
+  /// only after we have their scoped name.
+  public: std::map<Entity, sdf::ElementPtr> newVisuals;
+};
+
 using namespace ignition;
 using namespace gazebo;
 
@@ -236,13 +414,18 @@ Entity SdfEntityCreator::CreateEntities(const sdf::World *_world)
   }
 
   // Models
+  std::vector<const sdf::Model *> models;
+  models.reserve(_world->ModelCount());
   for (uint64_t modelIndex = 0; modelIndex < _world->ModelCount();
       ++modelIndex)
   {
-    auto model = _world->ModelByIndex(modelIndex);
-    auto modelEntity = this->CreateEntities(model);
+    models.push_back(_world->ModelByIndex(modelIndex));
+  }
 
-    this->SetParent(modelEntity, worldEntity);
+  for (const auto modelEntity : this->CreateEntities(models))
+  {
+    if (kNullEntity != modelEntity)
+      this->SetParent(modelEntity, worldEntity);
   }
 
   // Actors
@@ -293,59 +476,185 @@ Entity SdfEntityCreator::CreateEntities(const sdf::World *_world)
   return worldEntity;
 }
 
+
 //////////////////////////////////////////////////
 Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model)
 {
   IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Model)");
 
+  const auto start = std::chrono::steady_clock::now();
   auto ent = this->CreateEntities(_model, false);
 
-  // Load all model plugins afterwards, so we get scoped name for nested models.
-  for (const auto &[entity, element] : this->dataPtr->newModels)
+  this->dataPtr->LoadPlugins();
+
+  if (auto *profile = StartupScope::Current())
+    profile->AddModel(_model->Name(), std::chrono::steady_clock::now() - start);
+
+  return ent;
+}
+
+//////////////////////////////////////////////////
+std::vector<Entity> SdfEntityCreator::CreateEntities(
+    const std::vector<const sdf::Model *> &_models)
+{
+  IGN_PROFILE("SdfEntityCreator::CreateEntities(std::vector<sdf::Model>)");
+
+  // Converting doesn't touch the ECM, so all models are converted in
+  // parallel.
+  std::vector<SdfEntityCreatorPrivate::PendingEntities> pending(
+      _models.size());
+  auto convert = [&](std::size_t _index)
   {
-    this->dataPtr->eventManager->Emit<events::LoadPlugins>(entity, element);
+    IGN_PROFILE("SdfEntityCreator::ConvertModel");
+    if (nullptr != _models[_index])
+    {
+      SdfEntityCreatorPrivate::ConvertModel(_models[_index], false,
+          kNoParent, pending[_index]);
+    }
+  };
+  if (_models.size() > 1u)
+  {
+    ConversionPool().ParallelFor(_models.size(), convert);
   }
-  this->dataPtr->newModels.clear();
-
-  // Load sensor plugins after model, so we get scoped name.
-  for (const auto &[entity, element] : this->dataPtr->newSensors)
+  else if (!_models.empty())
   {
-    this->dataPtr->eventManager->Emit<events::LoadPlugins>(entity, element);
+    convert(0u);
   }
-  this->dataPtr->newSensors.clear();
 
-  // Load visual plugins after model, so we get scoped name.
-  for (const auto &[entity, element] : this->dataPtr->newVisuals)
+  // Create them one model at a time, so each model's plugins are loaded
+  // before the next model is created, like when creating them one by one.
+  std::vector<Entity> entities;
+  entities.reserve(_models.size());
+  auto *profile = StartupScope::Current();
+  for (std::size_t i = 0; i < pending.size(); ++i)
   {
-    this->dataPtr->eventManager->Emit<events::LoadPlugins>(entity, element);
+    const auto start = std::chrono::steady_clock::now();
+    entities.push_back(this->dataPtr->Create(pending[i]));
+    this->dataPtr->LoadPlugins();
+    pending[i].clear();
+
+    if (profile && nullptr != _models[i])
+    {
+      profile->AddModel(_models[i]->Name(),
+          std::chrono::steady_clock::now() - start);
+    }
   }
-  this->dataPtr->newVisuals.clear();
 
-  return ent;
+  return entities;
 }
 
 //////////////////////////////////////////////////
 Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model,
                                         bool _staticParent)
 {
+  SdfEntityCreatorPrivate::PendingEntities pending;
+  SdfEntityCreatorPrivate::ConvertModel(_model, _staticParent, kNoParent,
+      pending);
+  return this->dataPtr->Create(pending);
+}
+
+//////////////////////////////////////////////////
+Entity SdfEntityCreator::CreateEntities(const sdf::Actor *_actor)
+{
+  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Actor)");
+
   // Entity
-  Entity modelEntity = this->dataPtr->ecm->CreateEntity();
+  Entity actorEntity = this->dataPtr->ecm->CreateEntity();
 
   // Components
-  this->dataPtr->ecm->CreateComponent(modelEntity, components::Model());
-  this->dataPtr->ecm->CreateComponent(modelEntity,
+  this->dataPtr->ecm->CreateComponent(actorEntity, components::Actor(*_actor));
+  this->dataPtr->ecm->CreateComponent(actorEntity,
+      components::Pose(_actor->RawPose()));
+  this->dataPtr->ecm->CreateComponent(actorEntity,
+      components::Name(_actor->Name()));
+
+  // Actor plugins
+  this->dataPtr->eventManager->Emit<events::LoadPlugins>(actorEntity,
+      _actor->Element());
+
+  return actorEntity;
+}
+
+//////////////////////////////////////////////////
+Entity SdfEntityCreator::CreateEntities(const sdf::Light *_light)
+{
+  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Light)");
+
+  SdfEntityCreatorPrivate::PendingEntities pending;
+  SdfEntityCreatorPrivate::ConvertLight(_light, kNoParent, pending);
+  return this->dataPtr->Create(pending);
+}
+
+//////////////////////////////////////////////////
+Entity SdfEntityCreator::CreateEntities(const sdf::Link *_link)
+{
+  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Link)");
+
+  SdfEntityCreatorPrivate::PendingEntities pending;
+  SdfEntityCreatorPrivate::ConvertLink(_link, kNoParent, pending);
+  return this->dataPtr->Create(pending);
+}
+
+//////////////////////////////////////////////////
+Entity SdfEntityCreator::CreateEntities(const sdf::Joint *_joint)
+{
+  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Joint)");
+
+  SdfEntityCreatorPrivate::PendingEntities pending;
+  SdfEntityCreatorPrivate::ConvertJoint(_joint, kNoParent, pending);
+  return this->dataPtr->Create(pending);
+}
+
+//////////////////////////////////////////////////
+Entity SdfEntityCreator::CreateEntities(const sdf::Visual *_visual)
+{
+  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Visual)");
+
+  SdfEntityCreatorPrivate::PendingEntities pending;
+  SdfEntityCreatorPrivate::ConvertVisual(_visual, kNoParent, pending);
+  return this->dataPtr->Create(pending);
+}
+
+//////////////////////////////////////////////////
+Entity SdfEntityCreator::CreateEntities(const sdf::Collision *_collision)
+{
+  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Collision)");
+
+  SdfEntityCreatorPrivate::PendingEntities pending;
+  SdfEntityCreatorPrivate::ConvertCollision(_collision, kNoParent, pending);
+  return this->dataPtr->Create(pending);
+}
+
+//////////////////////////////////////////////////
+Entity SdfEntityCreator::CreateEntities(const sdf::Sensor *_sensor)
+{
+  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Sensor)");
+
+  SdfEntityCreatorPrivate::PendingEntities pending;
+  SdfEntityCreatorPrivate::ConvertSensor(_sensor, kNoParent, pending);
+  return this->dataPtr->Create(pending);
+}
+
+//////////////////////////////////////////////////
+std::size_t SdfEntityCreatorPrivate::ConvertModel(const sdf::Model *_model,
+    bool _staticParent, std::size_t _parent, PendingEntities &_pending)
+{
+  // Entity
+  const std::size_t index = _pending.size();
+  _pending.emplace_back();
+  _pending[index].parent = _parent;
+
+  // Components
+  _pending[index].Add(components::Model());
+  _pending[index].Add(
       components::Pose(ResolveSdfPose(_model->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(modelEntity,
-      components::Name(_model->Name()));
+  _pending[index].Add(components::Name(_model->Name()));
   bool isStatic = _model->Static() || _staticParent;
-  this->dataPtr->ecm->CreateComponent(modelEntity,
-      components::Static(isStatic));
-  this->dataPtr->ecm->CreateComponent(
-      modelEntity, components::WindMode(_model->EnableWind()));
-  this->dataPtr->ecm->CreateComponent(
-      modelEntity, components::SelfCollide(_model->SelfCollide()));
-  this->dataPtr->ecm->CreateComponent(
-      modelEntity, components::SourceFilePath(_model->Element()->FilePath()));
+  _pending[index].Add(components::Static(isStatic));
+  _pending[index].Add(components::WindMode(_model->EnableWind()));
+  _pending[index].Add(components::SelfCollide(_model->SelfCollide()));
+  _pending[index].Add(
+      components::SourceFilePath(_model->Element()->FilePath()));
 
   // NOTE: Pose components of links, visuals, and collisions are expressed in
   // the parent frame until we get frames working.
@@ -357,21 +666,17 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model,
       ++linkIndex)
   {
     auto link = _model->LinkByIndex(linkIndex);
-    auto linkEntity = this->CreateEntities(link);
-
-    this->SetParent(linkEntity, modelEntity);
+    auto linkPending = ConvertLink(link, index, _pending);
 
     if (canonicalLink == link)
     {
-      this->dataPtr->ecm->CreateComponent(linkEntity,
-          components::CanonicalLink());
+      _pending[linkPending].Add(components::CanonicalLink());
     }
 
     // Set wind mode if the link didn't override it
-    if (!this->dataPtr->ecm->Component<components::WindMode>(linkEntity))
+    if (!link->EnableWind())
     {
-      this->dataPtr->ecm->CreateComponent(
-          linkEntity, components::WindMode(_model->EnableWind()));
+      _pending[linkPending].Add(components::WindMode(_model->EnableWind()));
     }
   }
 
@@ -380,9 +685,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model,
       ++jointIndex)
   {
     auto joint = _model->JointByIndex(jointIndex);
-    auto jointEntity = this->CreateEntities(joint);
-
-    this->SetParent(jointEntity, modelEntity);
+    ConvertJoint(joint, index, _pending);
   }
 
   // Nested Models
@@ -390,27 +693,14 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model,
       ++modelIndex)
   {
     auto nestedModel = _model->ModelByIndex(modelIndex);
-    auto nestedModelEntity = this->CreateEntities(nestedModel, isStatic);
-
-    this->SetParent(nestedModelEntity, modelEntity);
+    ConvertModel(nestedModel, isStatic, index, _pending);
   }
 
-  // Find canonical link
+  // Resolve the canonical link, whose entity is found once it's created
   const auto canonicalLinkPair = _model->CanonicalLinkAndRelativeName();
   if (canonicalLinkPair.first)
   {
-    Entity canonicalLinkEntity = FindDescendentLinkEntityByName(
-        canonicalLinkPair.second, modelEntity, *this->dataPtr->ecm);
-    if (kNullEntity != canonicalLinkEntity)
-    {
-      this->dataPtr->ecm->CreateComponent(
-          modelEntity, components::ModelCanonicalLink(canonicalLinkEntity));
-    }
-    else
-    {
-      ignerr << "Could not find the canonical link entity for "
-             << canonicalLinkPair.second << "\n";
-    }
+    _pending[index].canonicalLinkName = canonicalLinkPair.second;
   }
   else
   {
@@ -419,81 +709,56 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Model *_model,
   }
 
   // Store the model's SDF DOM to be used when saving the world to file
-  this->dataPtr->ecm->CreateComponent(
-      modelEntity, components::ModelSdf(*_model));
+  _pending[index].Add(components::ModelSdf(*_model));
 
   // Keep track of models so we can load their plugins after loading the entire
   // model and having its full scoped name.
-  this->dataPtr->newModels[modelEntity] = _model->Element();
-
-  return modelEntity;
-}
-
-//////////////////////////////////////////////////
-Entity SdfEntityCreator::CreateEntities(const sdf::Actor *_actor)
-{
-  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Actor)");
+  _pending[index].plugins = Plugins::kModel;
+  _pending[index].element = _model->Element();
 
-  // Entity
-  Entity actorEntity = this->dataPtr->ecm->CreateEntity();
-
-  // Components
-  this->dataPtr->ecm->CreateComponent(actorEntity, components::Actor(*_actor));
-  this->dataPtr->ecm->CreateComponent(actorEntity,
-      components::Pose(_actor->RawPose()));
-  this->dataPtr->ecm->CreateComponent(actorEntity,
-      components::Name(_actor->Name()));
-
-  // Actor plugins
-  this->dataPtr->eventManager->Emit<events::LoadPlugins>(actorEntity,
-      _actor->Element());
-
-  return actorEntity;
+  return index;
 }
 
 //////////////////////////////////////////////////
-Entity SdfEntityCreator::CreateEntities(const sdf::Light *_light)
+std::size_t SdfEntityCreatorPrivate::ConvertLight(const sdf::Light *_light,
+    std::size_t _parent, PendingEntities &_pending)
 {
-  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Light)");
-
   // Entity
-  Entity lightEntity = this->dataPtr->ecm->CreateEntity();
+  const std::size_t index = _pending.size();
+  _pending.emplace_back();
+  _pending[index].parent = _parent;
 
   // Components
-  this->dataPtr->ecm->CreateComponent(lightEntity, components::Light(*_light));
-  this->dataPtr->ecm->CreateComponent(lightEntity,
+  _pending[index].Add(components::Light(*_light));
+  _pending[index].Add(
       components::Pose(ResolveSdfPose(_light->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(lightEntity,
-      components::Name(_light->Name()));
+  _pending[index].Add(components::Name(_light->Name()));
 
-  this->dataPtr->ecm->CreateComponent(lightEntity,
-    components::LightType(convert(_light->Type())));
+  _pending[index].Add(components::LightType(convert(_light->Type())));
 
-  return lightEntity;
+  return index;
 }
 
 //////////////////////////////////////////////////
-Entity SdfEntityCreator::CreateEntities(const sdf::Link *_link)
+std::size_t SdfEntityCreatorPrivate::ConvertLink(const sdf::Link *_link,
+    std::size_t _parent, PendingEntities &_pending)
 {
-  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Link)");
-
   // Entity
-  Entity linkEntity = this->dataPtr->ecm->CreateEntity();
+  const std::size_t index = _pending.size();
+  _pending.emplace_back();
+  _pending[index].parent = _parent;
 
   // Components
-  this->dataPtr->ecm->CreateComponent(linkEntity, components::Link());
+  _pending[index].Add(components::Link());
 
-  this->dataPtr->ecm->CreateComponent(linkEntity,
+  _pending[index].Add(
       components::Pose(ResolveSdfPose(_link->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(linkEntity,
-      components::Name(_link->Name()));
-  this->dataPtr->ecm->CreateComponent(linkEntity,
-      components::Inertial(_link->Inertial()));
+  _pending[index].Add(components::Name(_link->Name()));
+  _pending[index].Add(components::Inertial(_link->Inertial()));
 
   if (_link->EnableWind())
   {
-    this->dataPtr->ecm->CreateComponent(
-        linkEntity, components::WindMode(_link->EnableWind()));
+    _pending[index].Add(components::WindMode(_link->EnableWind()));
   }
 
   // Visuals
@@ -501,9 +766,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Link *_link)
       ++visualIndex)
   {
     auto visual = _link->VisualByIndex(visualIndex);
-    auto visualEntity = this->CreateEntities(visual);
-
-    this->SetParent(visualEntity, linkEntity);
+    ConvertVisual(visual, index, _pending);
   }
 
   // Collisions
@@ -511,9 +774,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Link *_link)
       ++collisionIndex)
   {
     auto collision = _link->CollisionByIndex(collisionIndex);
-    auto collisionEntity = this->CreateEntities(collision);
-
-    this->SetParent(collisionEntity, linkEntity);
+    ConvertCollision(collision, index, _pending);
   }
 
   // Lights
@@ -521,9 +782,7 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Link *_link)
       ++lightIndex)
   {
     auto light = _link->LightByIndex(lightIndex);
-    auto lightEntity = this->CreateEntities(light);
-
-    this->SetParent(lightEntity, linkEntity);
+    ConvertLight(light, index, _pending);
   }
 
   // Sensors
@@ -531,27 +790,24 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Link *_link)
       ++sensorIndex)
   {
     auto sensor = _link->SensorByIndex(sensorIndex);
-    auto sensorEntity = this->CreateEntities(sensor);
-
-    this->SetParent(sensorEntity, linkEntity);
+    ConvertSensor(sensor, index, _pending);
   }
 
-  return linkEntity;
+  return index;
 }
 
 //////////////////////////////////////////////////
-Entity SdfEntityCreator::CreateEntities(const sdf::Joint *_joint)
+std::size_t SdfEntityCreatorPrivate::ConvertJoint(const sdf::Joint *_joint,
+    std::size_t _parent, PendingEntities &_pending)
 {
-  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Joint)");
-
   // Entity
-  Entity jointEntity = this->dataPtr->ecm->CreateEntity();
+  const std::size_t index = _pending.size();
+  _pending.emplace_back();
+  _pending[index].parent = _parent;
 
   // Components
-  this->dataPtr->ecm->CreateComponent(jointEntity,
-      components::Joint());
-  this->dataPtr->ecm->CreateComponent(jointEntity,
-      components::JointType(_joint->Type()));
+  _pending[index].Add(components::Joint());
+  _pending[index].Add(components::JointType(_joint->Type()));
 
   if (_joint->Axis(0))
   {
@@ -560,11 +816,11 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Joint *_joint)
     {
       ignerr << "Failed to resolve joint axis 0 for joint '" << _joint->Name()
              << "'" << std::endl;
-      return kNullEntity;
+      _pending[index].failed = true;
+      return index;
     }
 
-    this->dataPtr->ecm->CreateComponent(jointEntity,
-        components::JointAxis(std::move(*resolvedAxis)));
+    _pending[index].Add(components::JointAxis(std::move(*resolvedAxis)));
   }
 
   if (_joint->Axis(1))
@@ -574,19 +830,17 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Joint *_joint)
     {
       ignerr << "Failed to resolve joint axis 1 for joint '" << _joint->Name()
              << "'" << std::endl;
-      return kNullEntity;
+      _pending[index].failed = true;
+      return index;
     }
 
-    this->dataPtr->ecm->CreateComponent(jointEntity,
-        components::JointAxis2(std::move(*resolvedAxis)));
+    _pending[index].Add(components::JointAxis2(std::move(*resolvedAxis)));
   }
 
-  this->dataPtr->ecm->CreateComponent(jointEntity,
+  _pending[index].Add(
       components::Pose(ResolveSdfPose(_joint->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(jointEntity ,
-      components::Name(_joint->Name()));
-  this->dataPtr->ecm->CreateComponent(jointEntity ,
-      components::ThreadPitch(_joint->ThreadPitch()));
+  _pending[index].Add(components::Name(_joint->Name()));
+  _pending[index].Add(components::ThreadPitch(_joint->ThreadPitch()));
 
   std::string resolvedParentLinkName;
   const auto resolveParentErrors =
@@ -597,10 +851,10 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Joint *_joint)
            << "' with parent name '" << _joint->ParentLinkName() << "'"
            << std::endl;
 
-    return kNullEntity;
+    _pending[index].failed = true;
+    return index;
   }
-  this->dataPtr->ecm->CreateComponent(
-      jointEntity, components::ParentLinkName(resolvedParentLinkName));
+  _pending[index].Add(components::ParentLinkName(resolvedParentLinkName));
 
   std::string resolvedChildLinkName;
   const auto resolveChildErrors =
@@ -615,198 +869,171 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Joint *_joint)
       ignerr << error << std::endl;
     }
 
-    return kNullEntity;
+    _pending[index].failed = true;
+    return index;
   }
 
-  this->dataPtr->ecm->CreateComponent(
-      jointEntity, components::ChildLinkName(resolvedChildLinkName));
+  _pending[index].Add(components::ChildLinkName(resolvedChildLinkName));
 
-  return jointEntity;
+  return index;
 }
 
 //////////////////////////////////////////////////
-Entity SdfEntityCreator::CreateEntities(const sdf::Visual *_visual)
+std::size_t SdfEntityCreatorPrivate::ConvertVisual(const sdf::Visual *_visual,
+    std::size_t _parent, PendingEntities &_pending)
 {
-  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Visual)");
-
   // Entity
-  Entity visualEntity = this->dataPtr->ecm->CreateEntity();
+  const std::size_t index = _pending.size();
+  _pending.emplace_back();
+  _pending[index].parent = _parent;
 
   // Components
-  this->dataPtr->ecm->CreateComponent(visualEntity, components::Visual());
-  this->dataPtr->ecm->CreateComponent(visualEntity,
+  _pending[index].Add(components::Visual());
+  _pending[index].Add(
       components::Pose(ResolveSdfPose(_visual->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(visualEntity,
-      components::Name(_visual->Name()));
-  this->dataPtr->ecm->CreateComponent(visualEntity,
-      components::CastShadows(_visual->CastShadows()));
-  this->dataPtr->ecm->CreateComponent(visualEntity,
-      components::Transparency(_visual->Transparency()));
-  this->dataPtr->ecm->CreateComponent(visualEntity,
+  _pending[index].Add(components::Name(_visual->Name()));
+  _pending[index].Add(components::CastShadows(_visual->CastShadows()));
+  _pending[index].Add(components::Transparency(_visual->Transparency()));
+  _pending[index].Add(
       components::VisibilityFlags(_visual->VisibilityFlags()));
 
   if (_visual->HasLaserRetro())
   {
-    this->dataPtr->ecm->CreateComponent(visualEntity,
-        components::LaserRetro(_visual->LaserRetro()));
+    _pending[index].Add(components::LaserRetro(_visual->LaserRetro()));
   }
 
   if (_visual->Geom())
   {
-    this->dataPtr->ecm->CreateComponent(visualEntity,
-        components::Geometry(*_visual->Geom()));
+    _pending[index].Add(components::Geometry(*_visual->Geom()));
   }
 
   // \todo(louise) Populate with default material if undefined
   if (_visual->Material())
   {
-    this->dataPtr->ecm->CreateComponent(visualEntity,
-        components::Material(*_visual->Material()));
+    _pending[index].Add(components::Material(*_visual->Material()));
   }
 
   // Keep track of visuals so we can load their plugins after loading the
   // entire model and having its full scoped name.
-  this->dataPtr->newVisuals[visualEntity] = _visual->Element();
+  _pending[index].plugins = Plugins::kVisual;
+  _pending[index].element = _visual->Element();
 
-  return visualEntity;
+  return index;
 }
 
 //////////////////////////////////////////////////
-Entity SdfEntityCreator::CreateEntities(const sdf::Collision *_collision)
+std::size_t SdfEntityCreatorPrivate::ConvertCollision(
+    const sdf::Collision *_collision, std::size_t _parent,
+    PendingEntities &_pending)
 {
-  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Collision)");
-
   // Entity
-  Entity collisionEntity = this->dataPtr->ecm->CreateEntity();
+  const std::size_t index = _pending.size();
+  _pending.emplace_back();
+  _pending[index].parent = _parent;
 
   // Components
-  this->dataPtr->ecm->CreateComponent(collisionEntity,
-      components::Collision());
-  this->dataPtr->ecm->CreateComponent(collisionEntity,
+  _pending[index].Add(components::Collision());
+  _pending[index].Add(
       components::Pose(ResolveSdfPose(_collision->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(collisionEntity,
-      components::Name(_collision->Name()));
+  _pending[index].Add(components::Name(_collision->Name()));
 
   if (_collision->Geom())
   {
-    this->dataPtr->ecm->CreateComponent(collisionEntity,
-        components::Geometry(*_collision->Geom()));
+    _pending[index].Add(components::Geometry(*_collision->Geom()));
   }
 
-  this->dataPtr->ecm->CreateComponent(collisionEntity,
-      components::CollisionElement(*_collision));
+  _pending[index].Add(components::CollisionElement(*_collision));
 
-  return collisionEntity;
+  return index;
 }
 
 //////////////////////////////////////////////////
-Entity SdfEntityCreator::CreateEntities(const sdf::Sensor *_sensor)
+std::size_t SdfEntityCreatorPrivate::ConvertSensor(const sdf::Sensor *_sensor,
+    std::size_t _parent, PendingEntities &_pending)
 {
-  IGN_PROFILE("SdfEntityCreator::CreateEntities(sdf::Sensor)");
-
   // Entity
-  Entity sensorEntity = this->dataPtr->ecm->CreateEntity();
+  const std::size_t index = _pending.size();
+  _pending.emplace_back();
+  _pending[index].parent = _parent;
+  auto &sensorPending = _pending[index];
 
   // Components
-  this->dataPtr->ecm->CreateComponent(sensorEntity,
-      components::Sensor());
-  this->dataPtr->ecm->CreateComponent(sensorEntity,
+  sensorPending.Add(components::Sensor());
+  sensorPending.Add(
       components::Pose(ResolveSdfPose(_sensor->SemanticPose())));
-  this->dataPtr->ecm->CreateComponent(sensorEntity,
-      components::Name(_sensor->Name()));
+  sensorPending.Add(components::Name(_sensor->Name()));
 
   if (_sensor->Type() == sdf::SensorType::CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::Camera(*_sensor));
+    sensorPending.Add(components::Camera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::GPU_LIDAR)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::GpuLidar(*_sensor));
+    sensorPending.Add(components::GpuLidar(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::LIDAR)
   {
-    // \todo(anyone) Implement CPU-base lidar
-    // this->dataPtr->ecm->CreateComponent(sensorEntity,
-    //     components::Lidar(*_sensor));
-    ignwarn << "Sensor type LIDAR not supported yet. Try using"
-      << "a GPU LIDAR instead." << std::endl;
+    // Simulated by the CpuLidar system
+    sensorPending.Add(components::Lidar(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::DEPTH_CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::DepthCamera(*_sensor));
+    sensorPending.Add(components::DepthCamera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::RGBD_CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::RgbdCamera(*_sensor));
+    sensorPending.Add(components::RgbdCamera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::THERMAL_CAMERA)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::ThermalCamera(*_sensor));
+    sensorPending.Add(components::ThermalCamera(*_sensor));
   }
   else if (_sensor->Type() == sdf::SensorType::AIR_PRESSURE)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::AirPressureSensor(*_sensor));
+    sensorPending.Add(components::AirPressureSensor(*_sensor));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::WorldPose(math::Pose3d::Zero));
+    sensorPending.Add(components::WorldPose(math::Pose3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::ALTIMETER)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::Altimeter(*_sensor));
+    sensorPending.Add(components::Altimeter(*_sensor));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::WorldPose(math::Pose3d::Zero));
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
+    sensorPending.Add(components::WorldPose(math::Pose3d::Zero));
+    sensorPending.Add(
         components::WorldLinearVelocity(math::Vector3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::IMU)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-            components::Imu(*_sensor));
+    sensorPending.Add(components::Imu(*_sensor));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-            components::WorldPose(math::Pose3d::Zero));
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-            components::AngularVelocity(math::Vector3d::Zero));
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-            components::LinearAcceleration(math::Vector3d::Zero));
+    sensorPending.Add(components::WorldPose(math::Pose3d::Zero));
+    sensorPending.Add(components::AngularVelocity(math::Vector3d::Zero));
+    sensorPending.Add(components::LinearAcceleration(math::Vector3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::LOGICAL_CAMERA)
   {
     auto elem = _sensor->Element();
 
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::LogicalCamera(elem));
+    sensorPending.Add(components::LogicalCamera(elem));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::WorldPose(math::Pose3d::Zero));
+    sensorPending.Add(components::WorldPose(math::Pose3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::MAGNETOMETER)
   {
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::Magnetometer(*_sensor));
+    sensorPending.Add(components::Magnetometer(*_sensor));
 
     // create components to be filled by physics
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-        components::WorldPose(math::Pose3d::Zero));
+    sensorPending.Add(components::WorldPose(math::Pose3d::Zero));
   }
   else if (_sensor->Type() == sdf::SensorType::CONTACT)
   {
     auto elem = _sensor->Element();
 
-    this->dataPtr->ecm->CreateComponent(sensorEntity,
-            components::ContactSensor(elem));
+    sensorPending.Add(components::ContactSensor(elem));
     // We will let the contact system create the necessary components for
     // physics to populate.
   }
@@ -818,9 +1045,104 @@ Entity SdfEntityCreator::CreateEntities(const sdf::Sensor *_sensor)
 
   // Keep track of sensors so we can load their plugins after loading the entire
   // model and having its full scoped name.
-  this->dataPtr->newSensors[sensorEntity] = _sensor->Element();
+  sensorPending.plugins = Plugins::kSensor;
+  sensorPending.element = _sensor->Element();
+
+  return index;
+}
+
+//////////////////////////////////////////////////
+Entity SdfEntityCreatorPrivate::Create(PendingEntities &_pending)
+{
+  IGN_PROFILE("SdfEntityCreatorPrivate::Create");
+
+  std::vector<Entity> entities;
+  entities.reserve(_pending.size());
+  for (auto &pending : _pending)
+  {
+    Entity entity = this->ecm->CreateEntity();
+    entities.push_back(entity);
+
+    for (const auto &create : pending.components)
+      create(*this->ecm, entity);
+    pending.components.clear();
+
+    if (pending.parent != kNoParent && !pending.failed)
+    {
+      // TODO(louise) Figure out a way to avoid duplication while keeping all
+      // state in components and also keeping a convenient graph in the ECM
+      this->ecm->SetParentEntity(entity, entities[pending.parent]);
+      this->ecm->CreateComponent(entity,
+          components::ParentEntity(entities[pending.parent]));
+    }
+
+    switch (pending.plugins)
+    {
+      case Plugins::kModel:
+        this->newModels[entity] = pending.element;
+        break;
+      case Plugins::kSensor:
+        this->newSensors[entity] = pending.element;
+        break;
+      case Plugins::kVisual:
+        this->newVisuals[entity] = pending.element;
+        break;
+      case Plugins::kNone:
+      default:
+        break;
+    }
+  }
+
+  // Find canonical links, now that all descendants exist
+  for (std::size_t i = 0; i < _pending.size(); ++i)
+  {
+    const auto &name = _pending[i].canonicalLinkName;
+    if (name.empty())
+      continue;
 
-  return sensorEntity;
+    Entity canonicalLinkEntity =
+        FindDescendentLinkEntityByName(name, entities[i], *this->ecm);
+    if (kNullEntity != canonicalLinkEntity)
+    {
+      this->ecm->CreateComponent(
+          entities[i], components::ModelCanonicalLink(canonicalLinkEntity));
+    }
+    else
+    {
+      ignerr << "Could not find the canonical link entity for "
+             << name << "\n";
+    }
+  }
+
+  if (_pending.empty() || _pending.front().failed)
+    return kNullEntity;
+
+  return entities.front();
+}
+
+//////////////////////////////////////////////////
+void SdfEntityCreatorPrivate::LoadPlugins()
+{
+  // Load all model plugins afterwards, so we get scoped name for nested models.
+  for (const auto &[entity, element] : this->newModels)
+  {
+    this->eventManager->Emit<events::LoadPlugins>(entity, element);
+  }
+  this->newModels.clear();
+
+  // Load sensor plugins after model, so we get scoped name.
+  for (const auto &[entity, element] : this->newSensors)
+  {
+    this->eventManager->Emit<events::LoadPlugins>(entity, element);
+  }
+  this->newSensors.clear();
+
+  // Load visual plugins after model, so we get scoped name.
+  for (const auto &[entity, element] : this->newVisuals)
+  {
+    this->eventManager->Emit<events::LoadPlugins>(entity, element);
+  }
+  this->newVisuals.clear();
 }
 
 //////////////////////////////////////////////////
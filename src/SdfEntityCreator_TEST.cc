@@ -1273,3 +1273,80 @@ TEST_F(SdfEntityCreatorTest, EachRemovedRecursiveRemoved)
   EXPECT_EQ(0u, removedCount<components::Collision>(ecm));
   EXPECT_EQ(0u, removedCount<components::Visual>(ecm));
 }
+
+/////////////////////////////////////////////////
+TEST_F(SdfEntityCreatorTest, CreateModelsInParallel)
+{
+  // Load SDF file
+  sdf::Root root;
+  root.Load(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/demo_joint_types.sdf");
+  ASSERT_EQ(1u, root.WorldCount());
+  const sdf::World *world = root.WorldByIndex(0);
+  ASSERT_LT(1u, world->ModelCount());
+
+  std::vector<const sdf::Model *> models;
+  for (uint64_t i = 0; i < world->ModelCount(); ++i)
+    models.push_back(world->ModelByIndex(i));
+  models.push_back(nullptr);
+
+  // Create the models at once
+  SdfEntityCreator creator(this->ecm, evm);
+  auto entities = creator.CreateEntities(models);
+  ASSERT_EQ(models.size(), entities.size());
+  EXPECT_EQ(kNullEntity, entities.back());
+
+  // Create the same models one by one
+  EntityComponentManager serialEcm;
+  SdfEntityCreator serialCreator(serialEcm, evm);
+  std::vector<Entity> serialEntities;
+  for (uint64_t i = 0; i < world->ModelCount(); ++i)
+  {
+    serialEntities.push_back(
+        serialCreator.CreateEntities(world->ModelByIndex(i)));
+  }
+
+  // Entities are created in the same order, so they get the same ids
+  EXPECT_EQ(serialEcm.EntityCount(), this->ecm.EntityCount());
+  for (std::size_t i = 0; i < serialEntities.size(); ++i)
+  {
+    EXPECT_EQ(serialEntities[i], entities[i]);
+    EXPECT_EQ(world->ModelByIndex(i)->Name(),
+        this->ecm.Component<components::Name>(entities[i])->Data());
+  }
+
+  serialEcm.Each<components::Name>(
+    [&](const Entity &_entity, const components::Name *_name)->bool
+    {
+      auto name = this->ecm.Component<components::Name>(_entity);
+      EXPECT_NE(nullptr, name);
+      if (name)
+      {
+        EXPECT_EQ(_name->Data(), name->Data());
+      }
+
+      auto serialParent =
+          serialEcm.Component<components::ParentEntity>(_entity);
+      auto parent = this->ecm.Component<components::ParentEntity>(_entity);
+      EXPECT_EQ(nullptr == serialParent, nullptr == parent);
+      if (serialParent && parent)
+      {
+        EXPECT_EQ(serialParent->Data(), parent->Data());
+      }
+
+      auto serialCanonical =
+          serialEcm.Component<components::ModelCanonicalLink>(_entity);
+      auto canonical =
+          this->ecm.Component<components::ModelCanonicalLink>(_entity);
+      EXPECT_EQ(nullptr == serialCanonical, nullptr == canonical);
+      if (serialCanonical && canonical)
+      {
+        EXPECT_EQ(serialCanonical->Data(), canonical->Data());
+      }
+
+      EXPECT_EQ(
+          nullptr == serialEcm.Component<components::CanonicalLink>(_entity),
+          nullptr == this->ecm.Component<components::CanonicalLink>(_entity));
+      return true;
+    });
+}
@@ -18,6 +18,7 @@
 #include "SdfGenerator.hh"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <sdf/sdf.hh>
@@ -33,6 +34,7 @@
 #include "ignition/gazebo/components/SourceFilePath.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "TaskPool.hh"
 
 namespace ignition
 {
@@ -243,6 +245,121 @@ namespace sdf_generator
     }
   }
 
+  /////////////////////////////////////////////////
+  /// \brief Get the task pool which generates models in parallel. It's
+  /// created the first time it's needed.
+  /// \return The task pool.
+  static TaskPool &generatorPool()
+  {
+    static TaskPool pool;
+    return pool;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Components of a top level model needed to generate its element.
+  /// They're looked up before the elements are generated in parallel, so
+  /// the ECM is only accessed from one thread.
+  struct ModelSource
+  {
+    /// \brief Element to fill, already added to the world.
+    sdf::ElementPtr elem;
+
+    /// \brief Uri of the <include>, or empty to inline the model.
+    std::string uri;
+
+    /// \brief Model's SDF, only used to inline it.
+    const components::ModelSdf *modelSdf{nullptr};
+
+    /// \brief Model's current name.
+    const components::Name *name{nullptr};
+
+    /// \brief Model's current pose.
+    const components::Pose *pose{nullptr};
+
+    /// \brief File the model was loaded from, if any.
+    const components::SourceFilePath *path{nullptr};
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Set a pose element, removing its attributes.
+  /// \param[in] _elem Element containing the pose.
+  /// \param[in] _pose Pose component.
+  static void setPose(const sdf::ElementPtr &_elem,
+                      const components::Pose *_pose)
+  {
+    auto poseElem = _elem->GetElement("pose");
+
+    // Remove all attributes of poseElem
+    sdf::ParamPtr relativeTo = poseElem->GetAttribute("relative_to");
+    if (nullptr != relativeTo)
+    {
+      relativeTo->Reset();
+    }
+    poseElem->Set(_pose->Data());
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Fill the element of an inlined model from its components.
+  /// \param[in] _source Model components and element.
+  /// \returns False if the model has no SDF.
+  static bool fillModelElement(const ModelSource &_source)
+  {
+    if (!copySdf(_source.modelSdf, _source.elem))
+      return false;
+
+    // Update sdf based current components. Here are the list of components to
+    // be updated:
+    // - Name
+    // - Pose
+    // This list is to be updated as other components become updateable during
+    // simulation
+    _source.elem->GetAttribute("name")->Set(_source.name->Data());
+    setPose(_source.elem, _source.pose);
+
+    if (_source.elem->HasElement("link") && nullptr != _source.path)
+    {
+      // Update relative URIs to use absolute paths. Relative URIs work fine in
+      // included models, but they have to be converted to absolute URIs when
+      // the included model is expanded.
+      relativeToAbsoluteUri(_source.elem,
+          common::parentPath(_source.path->Data()));
+    }
+    return true;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Fill the element of an included model from its components.
+  /// \param[in] _source Model components and element.
+  static void fillIncludeElement(const ModelSource &_source)
+  {
+    _source.elem->GetElement("uri")->Set(_source.uri);
+    _source.elem->GetElement("name")->Set(_source.name->Data());
+    setPose(_source.elem, _source.pose);
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Look up the components of a model needed by fillModelElement
+  /// and fillIncludeElement.
+  /// \param[in] _elem Element to fill.
+  /// \param[in] _ecm Entity component manager.
+  /// \param[in] _entity Model entity.
+  /// \param[in] _uri Uri of the <include>, empty to inline the model.
+  /// \return The model's components.
+  static ModelSource modelSource(const sdf::ElementPtr &_elem,
+                                 const EntityComponentManager &_ecm,
+                                 const Entity &_entity,
+                                 const std::string &_uri)
+  {
+    ModelSource source;
+    source.elem = _elem;
+    source.uri = _uri;
+    source.modelSdf = _ecm.Component<components::ModelSdf>(_entity);
+    source.name = _ecm.Component<components::Name>(_entity);
+    source.pose = _ecm.Component<components::Pose>(_entity);
+    source.path = _ecm.Component<components::SourceFilePath>(_entity);
+    return source;
+  }
+
   /////////////////////////////////////////////////
   std::optional<std::string> generateWorld(
       const EntityComponentManager &_ecm, const Entity &_entity,
@@ -255,7 +372,52 @@ namespace sdf_generator
     if (!updateWorldElement(worldElem, _ecm, _entity, _includeUriMap, _config))
       return std::nullopt;
 
-    return elem->ToString("");
+    // Most of the output of large worlds is their models, so those are
+    // converted to text in parallel and then spliced into the rest of the
+    // world, which is written without them. Models are the last children of
+    // the world, see updateWorldElement.
+    std::vector<sdf::ElementPtr> models;
+    for (auto child = worldElem->GetFirstElement(); child;
+         child = child->GetNextElement())
+    {
+      if (child->GetName() == "model" || child->GetName() == "include")
+        models.push_back(child);
+    }
+    if (models.size() < 2u)
+      return elem->ToString("");
+
+    // Children of <world> are indented twice
+    std::vector<std::string> modelStrs(models.size());
+    generatorPool().ParallelFor(models.size(), [&](std::size_t _i)
+    {
+      modelStrs[_i] = models[_i]->ToString("    ");
+    });
+
+    for (const auto &model : models)
+      worldElem->RemoveChild(model);
+    std::string out = elem->ToString("");
+
+    const std::string worldEnd = "  </world>";
+    const auto pos = out.rfind(worldEnd);
+    if (pos == std::string::npos)
+    {
+      // The world has no other children, so it was written as an empty tag
+      for (const auto &model : models)
+        worldElem->InsertElement(model);
+      return elem->ToString("");
+    }
+
+    std::size_t size = out.size();
+    for (const auto &str : modelStrs)
+      size += str.size();
+
+    std::string result;
+    result.reserve(size);
+    result.append(out, 0, pos);
+    for (const auto &str : modelStrs)
+      result += str;
+    result.append(out, pos, std::string::npos);
+    return result;
   }
 
   /////////////////////////////////////////////////
@@ -293,6 +455,9 @@ namespace sdf_generator
 
     auto worldDir = common::parentPath(worldSdf->Data().Element()->FilePath());
 
+    // Models are added to the world in order, but their elements are filled
+    // afterwards, in parallel.
+    std::vector<ModelSource> sources;
     _ecm.Each<components::Model, components::ModelSdf>(
         [&](const Entity &_modelEntity, const components::Model *,
             const components::ModelSdf *_modelSdf)
@@ -323,7 +488,7 @@ namespace sdf_generator
           if (modelConfig.expand_include_tags().data() || !modelFromInclude)
           {
             auto modelElem = _elem->AddElement("model");
-            updateModelElement(modelElem, _ecm, _modelEntity);
+            sources.push_back(modelSource(modelElem, _ecm, _modelEntity, ""));
           }
           else if (uriMapIt != _includeUriMap.end())
           {
@@ -363,7 +528,8 @@ namespace sdf_generator
             }
 
             auto includeElem = _elem->AddElement("include");
-            updateIncludeElement(includeElem, _ecm, _modelEntity, uri.Str());
+            sources.push_back(
+                modelSource(includeElem, _ecm, _modelEntity, uri.Str()));
           }
           else
           {
@@ -372,11 +538,28 @@ namespace sdf_generator
             // model on the local machine
             auto includeElem = _elem->AddElement("include");
             const std::string uri = "file://" + modelDir;
-            updateIncludeElement(includeElem, _ecm, _modelEntity, uri);
+            sources.push_back(
+                modelSource(includeElem, _ecm, _modelEntity, uri));
           }
           return true;
         });
 
+    auto fill = [&](std::size_t _i)
+    {
+      if (sources[_i].uri.empty())
+        fillModelElement(sources[_i]);
+      else
+        fillIncludeElement(sources[_i]);
+    };
+    if (sources.size() > 1u)
+    {
+      generatorPool().ParallelFor(sources.size(), fill);
+    }
+    else if (!sources.empty())
+    {
+      fill(0u);
+    }
+
     return true;
   }
 
@@ -385,41 +568,7 @@ namespace sdf_generator
                           const EntityComponentManager &_ecm,
                           const Entity &_entity)
   {
-    if (!copySdf(_ecm.Component<components::ModelSdf>(_entity), _elem))
-      return false;
-
-    // Update sdf based current components. Here are the list of components to
-    // be updated:
-    // - Name
-    // - Pose
-    // This list is to be updated as other components become updateable during
-    // simulation
-    auto *nameComp = _ecm.Component<components::Name>(_entity);
-    _elem->GetAttribute("name")->Set(nameComp->Data());
-
-    auto *poseComp = _ecm.Component<components::Pose>(_entity);
-
-    auto poseElem = _elem->GetElement("pose");
-
-    // Remove all attributes of poseElem
-    sdf::ParamPtr relativeTo = poseElem->GetAttribute("relative_to");
-    if (nullptr != relativeTo)
-    {
-      relativeTo->Reset();
-    }
-    poseElem->Set(poseComp->Data());
-
-    const auto *pathComp =
-      _ecm.Component<components::SourceFilePath>(_entity);
-
-    if (_elem->HasElement("link") && nullptr != pathComp)
-    {
-      // Update relative URIs to use absolute paths. Relative URIs work fine in
-      // included models, but they have to be converted to absolute URIs when
-      // the included model is expanded.
-      relativeToAbsoluteUri(_elem, common::parentPath(pathComp->Data()));
-    }
-    return true;
+    return fillModelElement(modelSource(_elem, _ecm, _entity, ""));
   }
 
   /////////////////////////////////////////////////
@@ -427,22 +576,7 @@ namespace sdf_generator
                             const EntityComponentManager &_ecm,
                             const Entity &_entity, const std::string &_uri)
   {
-    _elem->GetElement("uri")->Set(_uri);
-
-    auto *nameComp = _ecm.Component<components::Name>(_entity);
-    _elem->GetElement("name")->Set(nameComp->Data());
-
-    auto *poseComp = _ecm.Component<components::Pose>(_entity);
-
-    auto poseElem = _elem->GetElement("pose");
-
-    // Remove all attributes of poseElem
-    sdf::ParamPtr relativeTo = poseElem->GetAttribute("relative_to");
-    if (nullptr != relativeTo)
-    {
-      relativeTo->Reset();
-    }
-    poseElem->Set(poseComp->Data());
+    fillIncludeElement(modelSource(_elem, _ecm, _entity, _uri));
     return true;
   }
 }
@@ -877,6 +877,27 @@ TEST_F(GenerateWorldFixture, ModelsInline)
   }
 }
 
+/////////////////////////////////////////////////
+/// Models are written in parallel, the result should be the same as writing
+/// the whole world element at once
+TEST_F(ElementUpdateFixture, GenerateWorldMatchesElement)
+{
+  const std::string worldFile{"test/worlds/shapes.sdf"};
+  this->LoadWorld(worldFile);
+  Entity worldEntity = this->ecm.EntityByComponents(components::World());
+
+  auto elem = std::make_shared<sdf::Element>();
+  sdf::initFile("root.sdf", elem);
+  auto worldElem = elem->AddElement("world");
+  ASSERT_TRUE(sdf_generator::updateWorldElement(worldElem, this->ecm,
+      worldEntity));
+
+  const std::optional<std::string> worldStr =
+      sdf_generator::generateWorld(this->ecm, worldEntity);
+  ASSERT_TRUE(worldStr.has_value());
+  EXPECT_EQ(elem->ToString(""), *worldStr);
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int _argc, char **_argv)
@@ -15,8 +15,12 @@
  *
 */
 
+#include <fstream>
 #include <numeric>
+#include <sstream>
+#include <utility>
 
+#include <ignition/common/Profiler.hh>
 #include <ignition/common/SystemPaths.hh>
 #include <ignition/fuel_tools/Interface.hh>
 #include <ignition/fuel_tools/ClientConfig.hh>
@@ -29,6 +33,7 @@
 
 #include "ServerPrivate.hh"
 #include "SimulationRunner.hh"
+#include "StartupProfile.hh"
 
 using namespace ignition;
 using namespace gazebo;
@@ -80,6 +85,7 @@ struct DefaultWorld
 Server::Server(const ServerConfig &_config)
   : dataPtr(new ServerPrivate)
 {
+  StartupScope startupScope(&this->dataPtr->startupProfile, "server");
   this->dataPtr->config = _config;
 
   // Configure the fuel client
@@ -111,7 +117,12 @@ Server::Server(const ServerConfig &_config)
       msg += "File path [" + _config.SdfFile() + "].\n";
     }
     ignmsg <<  msg;
-    errors = this->dataPtr->sdfRoot.LoadSdfString(_config.SdfString());
+    StartupScope sdfScope(&this->dataPtr->startupProfile, "sdf");
+    errors = this->dataPtr->LoadWorld(_config, _config.SdfString(),
+        [&]()
+        {
+          return this->dataPtr->sdfRoot.LoadSdfString(_config.SdfString());
+        });
   }
   else if (!_config.SdfFile().empty())
   {
@@ -121,6 +132,7 @@ Server::Server(const ServerConfig &_config)
     auto sdfUri = common::URI(_config.SdfFile());
     if (sdfUri.Scheme() == "http" || sdfUri.Scheme() == "https")
     {
+      StartupScope fuelScope(&this->dataPtr->startupProfile, "fuel");
       std::string fuelCachePath;
       if (this->dataPtr->fuelClient->CachedWorld(common::URI(_config.SdfFile()),
           fuelCachePath))
@@ -167,13 +179,22 @@ Server::Server(const ServerConfig &_config)
     // resources are downloaded. Blocking here causes the GUI to block with
     // a black screen (search for "Async resource download" in
     // 'src/gui_main.cc'.
-    errors = this->dataPtr->sdfRoot.Load(filePath);
+    StartupScope sdfScope(&this->dataPtr->startupProfile, "sdf");
+    std::ifstream file(filePath, std::ios::binary);
+    std::ostringstream content;
+    content << file.rdbuf();
+    errors = this->dataPtr->LoadWorld(_config, content.str(),
+        [&]()
+        {
+          return this->dataPtr->sdfRoot.Load(filePath);
+        });
   }
   else
   {
     ignmsg << "Loading default world.\n";
     // Load an empty world.
     /// \todo(nkoenig) Add a "AddWorld" function to sdf::Root.
+    StartupScope sdfScope(&this->dataPtr->startupProfile, "sdf");
     errors = this->dataPtr->sdfRoot.LoadSdfString(DefaultWorld::World());
   }
 
@@ -200,6 +221,7 @@ Server::Server(const ServerConfig &_config)
   }
 
   // Establish publishers and subscribers.
+  StartupScope transportScope(&this->dataPtr->startupProfile, "transport");
   this->dataPtr->SetupTransport();
 }
 
@@ -318,6 +340,15 @@ std::optional<uint64_t> Server::IterationCount(
   return std::nullopt;
 }
 
+//////////////////////////////////////////////////
+std::optional<double> Server::StepsPerSecond(
+    const unsigned int _worldIndex) const
+{
+  if (_worldIndex < this->dataPtr->simRunners.size())
+    return this->dataPtr->simRunners[_worldIndex]->StepsPerSecond();
+  return std::nullopt;
+}
+
 //////////////////////////////////////////////////
 std::optional<size_t> Server::EntityCount(const unsigned int _worldIndex) const
 {
@@ -401,3 +432,188 @@ bool Server::RequestRemoveEntity(const Entity _entity,
 
   return false;
 }
+
+//////////////////////////////////////////////////
+std::optional<uint64_t> Server::SaveSnapshot(const unsigned int _worldIndex)
+{
+  if (_worldIndex >= this->dataPtr->simRunners.size())
+    return std::nullopt;
+
+  // While running, the simulation thread processes the request
+  std::lock_guard<std::mutex> lock(this->dataPtr->runMutex);
+  auto &runner = this->dataPtr->simRunners[_worldIndex];
+  auto id = runner->SaveSnapshot();
+  if (!this->dataPtr->running)
+    runner->ProcessSnapshotRequests();
+  return id;
+}
+
+//////////////////////////////////////////////////
+bool Server::RestoreSnapshot(uint64_t _id, const unsigned int _worldIndex)
+{
+  if (_worldIndex >= this->dataPtr->simRunners.size())
+    return false;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->runMutex);
+  auto &runner = this->dataPtr->simRunners[_worldIndex];
+  if (!runner->RestoreSnapshot(_id))
+    return false;
+  if (!this->dataPtr->running)
+    runner->ProcessSnapshotRequests();
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Server::RemoveSnapshot(uint64_t _id, const unsigned int _worldIndex)
+{
+  if (_worldIndex >= this->dataPtr->simRunners.size())
+    return false;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->runMutex);
+  auto &runner = this->dataPtr->simRunners[_worldIndex];
+  if (!runner->RemoveSnapshot(_id))
+    return false;
+  if (!this->dataPtr->running)
+    runner->ProcessSnapshotRequests();
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::optional<unsigned int> Server::ForkWorld(const unsigned int _worldIndex)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->runMutex);
+  if (this->dataPtr->running)
+  {
+    ignerr << "Cannot fork a world while the server is running.\n";
+    return std::nullopt;
+  }
+
+  if (_worldIndex >= this->dataPtr->simRunners.size())
+    return std::nullopt;
+
+  auto fork = std::make_unique<SimulationRunner>(
+      *this->dataPtr->simRunners[_worldIndex], ++this->dataPtr->forkCount);
+  this->dataPtr->simRunners.push_back(std::move(fork));
+  return static_cast<unsigned int>(this->dataPtr->simRunners.size() - 1);
+}
+
+//////////////////////////////////////////////////
+void Server::SetBatchCallbacks(std::size_t _actionSize,
+    BatchActionCallback _onActions, std::size_t _observationSize,
+    BatchObservationCallback _onObservations)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->runMutex);
+  this->dataPtr->batchActionSize = _actionSize;
+  this->dataPtr->batchActionCb = std::move(_onActions);
+  this->dataPtr->batchObservationSize = _observationSize;
+  this->dataPtr->batchObservationCb = std::move(_onObservations);
+
+  const std::size_t worldCount = this->dataPtr->simRunners.size();
+  this->dataPtr->batchActions.assign(worldCount * _actionSize, 0.0);
+  this->dataPtr->batchObservations.assign(worldCount * _observationSize,
+      0.0);
+}
+
+//////////////////////////////////////////////////
+void Server::SetBatchViews(const TensorView &_actions,
+    const TensorView &_observations)
+{
+  auto actions = std::make_shared<TensorView>(_actions);
+  auto observations = std::make_shared<TensorView>(_observations);
+  this->SetBatchCallbacks(actions->Size(),
+      [actions](unsigned int, const double *_values,
+          EntityComponentManager &_ecm)
+      {
+        actions->Apply(_values, _ecm);
+      },
+      observations->Size(),
+      [observations](unsigned int, const EntityComponentManager &_ecm,
+          double *_values)
+      {
+        observations->Fill(_ecm, _values);
+      });
+}
+
+//////////////////////////////////////////////////
+std::vector<double> &Server::BatchActions()
+{
+  // Worlds may have been forked since the buffers were sized
+  this->dataPtr->batchActions.resize(this->dataPtr->simRunners.size() *
+      this->dataPtr->batchActionSize, 0.0);
+  return this->dataPtr->batchActions;
+}
+
+//////////////////////////////////////////////////
+const std::vector<double> &Server::BatchObservations() const
+{
+  return this->dataPtr->batchObservations;
+}
+
+//////////////////////////////////////////////////
+bool Server::StepAll(const uint64_t _iterations)
+{
+  IGN_PROFILE("Server::StepAll");
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->runMutex);
+    if (this->dataPtr->running)
+    {
+      ignwarn << "The server is already running.\n";
+      return false;
+    }
+
+    if (this->dataPtr->config.UseDistributedSimulation())
+    {
+      ignerr << "Distributed simulation can't be stepped in batches.\n";
+      return false;
+    }
+
+    this->dataPtr->running = true;
+  }
+
+  auto &runners = this->dataPtr->simRunners;
+  const std::size_t actionSize = this->dataPtr->batchActionSize;
+  const std::size_t observationSize = this->dataPtr->batchObservationSize;
+  auto &actions = this->BatchActions();
+  auto &observations = this->dataPtr->batchObservations;
+  observations.resize(runners.size() * observationSize, 0.0);
+
+  if (nullptr == this->dataPtr->batchPool)
+    this->dataPtr->batchPool = std::make_unique<TaskPool>();
+
+  for (auto &runner : runners)
+    runner->SetPaused(false);
+
+  const auto &onActions = this->dataPtr->batchActionCb;
+  for (uint64_t i = 0; i < _iterations && this->dataPtr->running; ++i)
+  {
+    this->dataPtr->batchPool->ParallelFor(runners.size(),
+        [&](std::size_t _world)
+        {
+          auto &runner = runners[_world];
+          if (onActions)
+          {
+            onActions(static_cast<unsigned int>(_world),
+                actions.data() + _world * actionSize,
+                runner->EntityCompMgr());
+          }
+          runner->BatchStep();
+        });
+  }
+
+  const auto &onObservations = this->dataPtr->batchObservationCb;
+  if (onObservations)
+  {
+    this->dataPtr->batchPool->ParallelFor(runners.size(),
+        [&](std::size_t _world)
+        {
+          const SimulationRunner &runner = *runners[_world];
+          onObservations(static_cast<unsigned int>(_world),
+              runner.EntityCompMgr(),
+              observations.data() + _world * observationSize);
+        });
+  }
+
+  this->dataPtr->running = false;
+  return true;
+}
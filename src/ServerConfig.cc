@@ -229,6 +229,8 @@ class ignition::gazebo::ServerConfigPrivate
             logRecordResources(_cfg->logRecordResources),
             logRecordCompressPath(_cfg->logRecordCompressPath),
             resourceCache(_cfg->resourceCache),
+            worldCache(_cfg->worldCache),
+            resourcePrefetchThreads(_cfg->resourcePrefetchThreads),
             physicsEngine(_cfg->physicsEngine),
             renderEngineServer(_cfg->renderEngineServer),
             renderEngineGui(_cfg->renderEngineGui),
@@ -236,6 +238,19 @@ class ignition::gazebo::ServerConfigPrivate
             networkRole(_cfg->networkRole),
             networkSecondaries(_cfg->networkSecondaries),
             seed(_cfg->seed),
+            workerThreadCount(_cfg->workerThreadCount),
+            deterministic(_cfg->deterministic),
+            simulationCpus(_cfg->simulationCpus),
+            workerCpus(_cfg->workerCpus),
+            renderCpus(_cfg->renderCpus),
+            entityRecycling(_cfg->entityRecycling),
+            maxThroughput(_cfg->maxThroughput),
+            throughputStatsPeriod(_cfg->throughputStatsPeriod),
+            pacing(_cfg->pacing),
+            pacingSpinTime(_cfg->pacingSpinTime),
+            traceBufferSize(_cfg->traceBufferSize),
+            traceSlowStepThreshold(_cfg->traceSlowStepThreshold),
+            tracePath(_cfg->tracePath),
             logRecordTopics(_cfg->logRecordTopics) { }
 
   // \brief The SDF file that the server should load
@@ -273,6 +288,13 @@ class ignition::gazebo::ServerConfigPrivate
   /// from fuel.ignitionrobotics.org, should be stored.
   public: std::string resourceCache = "";
 
+  /// \brief Directory where worlds are cached after their includes have
+  /// been resolved. Empty if worlds aren't cached.
+  public: std::string worldCache = "";
+
+  /// \brief Number of resources downloaded at once while prefetching.
+  public: unsigned int resourcePrefetchThreads{4};
+
   /// \brief File containing physics engine plugin. If empty, DART will be used.
   public: std::string physicsEngine = "";
 
@@ -296,6 +318,50 @@ class ignition::gazebo::ServerConfigPrivate
   /// \brief The given random seed.
   public: unsigned int seed = 0;
 
+  /// \brief Number of worker threads for parallel work, 0 to pick
+  /// automatically.
+  public: unsigned int workerThreadCount = 0;
+
+  /// \brief True to split parallel work independently of the number of
+  /// threads.
+  public: bool deterministic{false};
+
+  /// \brief CPUs the simulation thread is pinned to.
+  public: std::string simulationCpus = "";
+
+  /// \brief CPUs the worker threads are pinned to.
+  public: std::string workerCpus = "";
+
+  /// \brief CPUs the sensor render thread is pinned to.
+  public: std::string renderCpus = "";
+
+  /// \brief True if the slots of removed entities are reused.
+  public: bool entityRecycling = false;
+
+  /// \brief True to run in max throughput mode.
+  public: bool maxThroughput = false;
+
+  /// \brief Wall time between statistics in max throughput mode.
+  public: std::chrono::steady_clock::duration throughputStatsPeriod =
+      std::chrono::seconds(10);
+
+  /// \brief How iterations wait to match the update period.
+  public: ServerConfig::PacingStrategy pacing =
+      ServerConfig::PacingStrategy::Sleep;
+
+  /// \brief Time spent spinning by hybrid pacing.
+  public: std::chrono::steady_clock::duration pacingSpinTime =
+      std::chrono::microseconds(300);
+
+  /// \brief Number of scopes kept by the trace recorder, 0 to disable.
+  public: std::size_t traceBufferSize{0};
+
+  /// \brief Iteration wall time which triggers writing a trace.
+  public: std::chrono::steady_clock::duration traceSlowStepThreshold{0};
+
+  /// \brief Directory where slow iteration traces are written.
+  public: std::string tracePath = "";
+
   /// \brief Timestamp that marks when this ServerConfig was created.
   public: std::chrono::time_point<std::chrono::system_clock> timestamp;
 
@@ -502,6 +568,190 @@ void ServerConfig::SetSeed(unsigned int _seed)
   ignition::math::Rand::Seed(_seed);
 }
 
+/////////////////////////////////////////////////
+unsigned int ServerConfig::WorkerThreadCount() const
+{
+  return this->dataPtr->workerThreadCount;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetWorkerThreadCount(unsigned int _count)
+{
+  this->dataPtr->workerThreadCount = _count;
+}
+
+/////////////////////////////////////////////////
+bool ServerConfig::Deterministic() const
+{
+  return this->dataPtr->deterministic;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetDeterministic(bool _deterministic)
+{
+  this->dataPtr->deterministic = _deterministic;
+}
+
+/////////////////////////////////////////////////
+/// \brief Check a CPU list, logging an error if it's malformed.
+/// \param[in] _cpus CPU list.
+/// \param[in] _option Name of the option being set.
+/// \return True if the list is valid.
+bool checkCpuList(const std::string &_cpus, const std::string &_option)
+{
+  if (parseCpuList(_cpus))
+    return true;
+
+  ignerr << "Invalid CPU list [" << _cpus << "] for the " << _option
+         << " CPUs, expected a list such as [0-3,8]." << std::endl;
+  return false;
+}
+
+/////////////////////////////////////////////////
+std::string ServerConfig::SimulationCpus() const
+{
+  return this->dataPtr->simulationCpus;
+}
+
+/////////////////////////////////////////////////
+bool ServerConfig::SetSimulationCpus(const std::string &_cpus)
+{
+  if (!checkCpuList(_cpus, "simulation"))
+    return false;
+  this->dataPtr->simulationCpus = _cpus;
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::string ServerConfig::WorkerCpus() const
+{
+  return this->dataPtr->workerCpus;
+}
+
+/////////////////////////////////////////////////
+bool ServerConfig::SetWorkerCpus(const std::string &_cpus)
+{
+  if (!checkCpuList(_cpus, "worker"))
+    return false;
+  this->dataPtr->workerCpus = _cpus;
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::string ServerConfig::RenderCpus() const
+{
+  return this->dataPtr->renderCpus;
+}
+
+/////////////////////////////////////////////////
+bool ServerConfig::SetRenderCpus(const std::string &_cpus)
+{
+  if (!checkCpuList(_cpus, "render"))
+    return false;
+  this->dataPtr->renderCpus = _cpus;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool ServerConfig::EntityRecycling() const
+{
+  return this->dataPtr->entityRecycling;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetEntityRecycling(const bool _enabled)
+{
+  this->dataPtr->entityRecycling = _enabled;
+}
+
+/////////////////////////////////////////////////
+bool ServerConfig::MaxThroughput() const
+{
+  return this->dataPtr->maxThroughput;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetMaxThroughput(const bool _enabled)
+{
+  this->dataPtr->maxThroughput = _enabled;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration ServerConfig::ThroughputStatsPeriod() const
+{
+  return this->dataPtr->throughputStatsPeriod;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetThroughputStatsPeriod(
+    const std::chrono::steady_clock::duration &_period)
+{
+  this->dataPtr->throughputStatsPeriod = _period;
+}
+
+/////////////////////////////////////////////////
+ServerConfig::PacingStrategy ServerConfig::Pacing() const
+{
+  return this->dataPtr->pacing;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetPacing(const PacingStrategy _pacing)
+{
+  this->dataPtr->pacing = _pacing;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration ServerConfig::PacingSpinTime() const
+{
+  return this->dataPtr->pacingSpinTime;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetPacingSpinTime(
+    const std::chrono::steady_clock::duration &_spinTime)
+{
+  this->dataPtr->pacingSpinTime = _spinTime;
+}
+
+/////////////////////////////////////////////////
+std::size_t ServerConfig::TraceBufferSize() const
+{
+  return this->dataPtr->traceBufferSize;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetTraceBufferSize(std::size_t _size)
+{
+  this->dataPtr->traceBufferSize = _size;
+}
+
+/////////////////////////////////////////////////
+std::chrono::steady_clock::duration ServerConfig::TraceSlowStepThreshold()
+    const
+{
+  return this->dataPtr->traceSlowStepThreshold;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetTraceSlowStepThreshold(
+    const std::chrono::steady_clock::duration &_threshold)
+{
+  this->dataPtr->traceSlowStepThreshold = _threshold;
+}
+
+/////////////////////////////////////////////////
+const std::string &ServerConfig::TracePath() const
+{
+  return this->dataPtr->tracePath;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetTracePath(const std::string &_path)
+{
+  this->dataPtr->tracePath = _path;
+}
+
 /////////////////////////////////////////////////
 const std::string &ServerConfig::ResourceCache() const
 {
@@ -514,6 +764,30 @@ void ServerConfig::SetResourceCache(const std::string &_path)
   this->dataPtr->resourceCache = _path;
 }
 
+/////////////////////////////////////////////////
+const std::string &ServerConfig::WorldCachePath() const
+{
+  return this->dataPtr->worldCache;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetWorldCachePath(const std::string &_path)
+{
+  this->dataPtr->worldCache = _path;
+}
+
+/////////////////////////////////////////////////
+unsigned int ServerConfig::ResourcePrefetchThreads() const
+{
+  return this->dataPtr->resourcePrefetchThreads;
+}
+
+/////////////////////////////////////////////////
+void ServerConfig::SetResourcePrefetchThreads(unsigned int _threads)
+{
+  this->dataPtr->resourcePrefetchThreads = _threads;
+}
+
 /////////////////////////////////////////////////
 const std::string &ServerConfig::PhysicsEngine() const
 {
@@ -228,3 +228,121 @@ TEST(ServerConfig, GenerateRecordPlugin)
   EXPECT_EQ(plugin.Name(), "ignition::gazebo::systems::LogRecord");
 }
 
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, WorkerThreadCount)
+{
+  ServerConfig config;
+  EXPECT_EQ(0u, config.WorkerThreadCount());
+
+  config.SetWorkerThreadCount(6);
+  EXPECT_EQ(6u, config.WorkerThreadCount());
+
+  ServerConfig copy(config);
+  EXPECT_EQ(6u, copy.WorkerThreadCount());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, Deterministic)
+{
+  ServerConfig config;
+  EXPECT_FALSE(config.Deterministic());
+
+  config.SetDeterministic(true);
+  EXPECT_TRUE(config.Deterministic());
+
+  ServerConfig copy(config);
+  EXPECT_TRUE(copy.Deterministic());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, EntityRecycling)
+{
+  ServerConfig config;
+  EXPECT_FALSE(config.EntityRecycling());
+
+  config.SetEntityRecycling(true);
+  EXPECT_TRUE(config.EntityRecycling());
+
+  ServerConfig copy(config);
+  EXPECT_TRUE(copy.EntityRecycling());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, MaxThroughput)
+{
+  ServerConfig config;
+  EXPECT_FALSE(config.MaxThroughput());
+  EXPECT_EQ(std::chrono::seconds(10), config.ThroughputStatsPeriod());
+
+  config.SetMaxThroughput(true);
+  config.SetThroughputStatsPeriod(std::chrono::seconds(2));
+  EXPECT_TRUE(config.MaxThroughput());
+  EXPECT_EQ(std::chrono::seconds(2), config.ThroughputStatsPeriod());
+
+  ServerConfig copy(config);
+  EXPECT_TRUE(copy.MaxThroughput());
+  EXPECT_EQ(std::chrono::seconds(2), copy.ThroughputStatsPeriod());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, Trace)
+{
+  ServerConfig config;
+  EXPECT_EQ(0u, config.TraceBufferSize());
+  EXPECT_EQ(std::chrono::steady_clock::duration::zero(),
+      config.TraceSlowStepThreshold());
+  EXPECT_TRUE(config.TracePath().empty());
+
+  config.SetTraceBufferSize(1000);
+  config.SetTraceSlowStepThreshold(std::chrono::milliseconds(20));
+  config.SetTracePath("traces");
+
+  ServerConfig copy(config);
+  EXPECT_EQ(1000u, copy.TraceBufferSize());
+  EXPECT_EQ(std::chrono::milliseconds(20), copy.TraceSlowStepThreshold());
+  EXPECT_EQ("traces", copy.TracePath());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, Pacing)
+{
+  ServerConfig config;
+  EXPECT_EQ(ServerConfig::PacingStrategy::Sleep, config.Pacing());
+  EXPECT_EQ(std::chrono::microseconds(300), config.PacingSpinTime());
+
+  config.SetPacing(ServerConfig::PacingStrategy::Hybrid);
+  config.SetPacingSpinTime(std::chrono::microseconds(500));
+  EXPECT_EQ(ServerConfig::PacingStrategy::Hybrid, config.Pacing());
+  EXPECT_EQ(std::chrono::microseconds(500), config.PacingSpinTime());
+
+  ServerConfig copy(config);
+  EXPECT_EQ(ServerConfig::PacingStrategy::Hybrid, copy.Pacing());
+  EXPECT_EQ(std::chrono::microseconds(500), copy.PacingSpinTime());
+}
+
+//////////////////////////////////////////////////
+TEST(ServerConfig, Cpus)
+{
+  ServerConfig config;
+  EXPECT_TRUE(config.SimulationCpus().empty());
+  EXPECT_TRUE(config.WorkerCpus().empty());
+  EXPECT_TRUE(config.RenderCpus().empty());
+
+  EXPECT_TRUE(config.SetSimulationCpus("0-3,8"));
+  EXPECT_TRUE(config.SetWorkerCpus("4-7"));
+  EXPECT_TRUE(config.SetRenderCpus("9"));
+
+  // Malformed lists are ignored
+  EXPECT_FALSE(config.SetSimulationCpus("3-1"));
+  EXPECT_FALSE(config.SetWorkerCpus("a"));
+  EXPECT_FALSE(config.SetRenderCpus("1,"));
+
+  ServerConfig copy(config);
+  EXPECT_EQ("0-3,8", copy.SimulationCpus());
+  EXPECT_EQ("4-7", copy.WorkerCpus());
+  EXPECT_EQ("9", copy.RenderCpus());
+
+  EXPECT_TRUE(copy.SetRenderCpus(""));
+  EXPECT_TRUE(copy.RenderCpus().empty());
+}
@@ -22,14 +22,19 @@
 #include <sdf/World.hh>
 
 #include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Profiler.hh>
 #include <ignition/common/Util.hh>
 
 #include <ignition/fuel_tools/Interface.hh>
+#include <ignition/fuel_tools/ModelIdentifier.hh>
 
 #include <ignition/gui/Application.hh>
 
 #include "ignition/gazebo/Util.hh"
+#include "ResourcePrefetcher.hh"
 #include "SimulationRunner.hh"
+#include "WorldCache.hh"
 
 using namespace ignition;
 using namespace gazebo;
@@ -159,23 +164,29 @@ bool ServerPrivate::Run(const uint64_t _iterations,
   }
 
   // Minor performance tweak. In many situations there will only be one
-  // simulation runner, and we can avoid using the thread pool.
+  // simulation runner, and we can avoid creating threads.
   if (this->simRunners.size() == 1)
   {
     result = this->simRunners[0]->Run(_iterations);
   }
   else
   {
+    // Each runner gets a thread of its own. Runners without an iteration
+    // limit only return once stopped, so they can't wait for one from a
+    // pool, for example when there are more forked worlds than cores.
+    std::vector<std::thread> threads;
+    threads.reserve(this->simRunners.size());
     for (std::unique_ptr<SimulationRunner> &runner : this->simRunners)
     {
-      this->workerPool.AddWork([&runner, &_iterations] ()
+      threads.emplace_back([&runner, &_iterations] ()
         {
           runner->Run(_iterations);
         });
     }
 
-    // Wait for the runner to complete.
-    result = this->workerPool.WaitForResults();
+    // Wait for the runners to complete.
+    for (auto &thread : threads)
+      thread.join();
   }
 
   this->running = false;
@@ -296,6 +307,95 @@ void ServerPrivate::AddRecordPlugin(const ServerConfig &_config)
   }
 }
 
+//////////////////////////////////////////////////
+sdf::Errors ServerPrivate::LoadWorld(const ServerConfig &_config,
+    const std::string &_source, const std::function<sdf::Errors()> &_load)
+{
+  if (_config.WorldCachePath().empty())
+  {
+    this->PrefetchResources(_config, _source);
+    return _load();
+  }
+
+  WorldCache cache(_config.WorldCachePath(), _source);
+
+  std::string cachedSdf;
+  if (cache.Load(cachedSdf))
+  {
+    ignmsg << "Loading world from cache [" << cache.Path() << "].\n";
+    auto errors = this->sdfRoot.LoadSdfString(cachedSdf);
+    if (!errors.empty())
+    {
+      ignerr << "Failed to load world cache [" << cache.Path()
+             << "], removing it. Restart to load the world from its source."
+             << std::endl;
+      common::removeFile(cache.Path());
+    }
+    return errors;
+  }
+
+  this->PrefetchResources(_config, _source);
+  auto errors = _load();
+  if (errors.empty())
+    cache.Save(this->sdfRoot);
+  return errors;
+}
+
+//////////////////////////////////////////////////
+void ServerPrivate::PrefetchResources(const ServerConfig &_config,
+    const std::string &_source)
+{
+  if (_config.ResourcePrefetchThreads() == 0 || !this->fuelClient)
+    return;
+
+  IGN_PROFILE("ServerPrivate::PrefetchResources");
+  StartupScope startupScope(&this->startupProfile, "fuel");
+
+  // Resources are identified by their model, so the files of a model are
+  // downloaded with it
+  auto resolve = [this](const std::string &_uri) -> std::string
+  {
+    if (_uri.compare(0, 7, "http://") != 0 &&
+        _uri.compare(0, 8, "https://") != 0)
+    {
+      return "";
+    }
+
+    common::URI uri(_uri);
+    fuel_tools::ModelIdentifier id;
+    std::string file;
+    if (this->fuelClient->ParseModelUrl(uri, id) ||
+        this->fuelClient->ParseModelFileUrl(uri, id, file))
+    {
+      return id.UniqueName();
+    }
+    return "";
+  };
+
+  // Each download uses its own client, the shared one isn't thread safe
+  const auto clientConfig = this->fuelClient->Config();
+  auto fetch = [clientConfig](const std::string &_key) -> std::string
+  {
+    fuel_tools::FuelClient client(clientConfig);
+    common::URI uri(_key);
+    std::string path;
+    if (client.CachedModel(uri, path))
+      return path;
+
+    if (!client.DownloadModel(uri, path))
+    {
+      ignwarn << "Failed to prefetch [" << _key << "], it will be fetched "
+              << "when the world is loaded." << std::endl;
+      return "";
+    }
+    return path;
+  };
+
+  ResourcePrefetcher prefetcher(resolve, fetch,
+      _config.ResourcePrefetchThreads());
+  prefetcher.Prefetch(_source);
+}
+
 //////////////////////////////////////////////////
 void ServerPrivate::CreateEntities()
 {
@@ -310,7 +410,7 @@ void ServerPrivate::CreateEntities()
       this->worldNames.push_back(world->Name());
     }
     auto runner = std::make_unique<SimulationRunner>(
-        world, this->systemLoader, this->config);
+        world, this->systemLoader, this->config, &this->startupProfile);
     runner->SetFuelUriMap(this->fuelUriMap);
     this->simRunners.push_back(std::move(runner));
   }
@@ -434,6 +534,9 @@ bool ServerPrivate::ResourcePathsService(
 //////////////////////////////////////////////////
 std::string ServerPrivate::FetchResource(const std::string &_uri)
 {
+  // Only resources fetched while starting count for the startup profile
+  StartupScope startupScope(
+      StartupScope::Current() ? &this->startupProfile : nullptr, "fuel");
   auto path =
       fuel_tools::fetchResourceWithClient(_uri, *this->fuelClient.get());
 
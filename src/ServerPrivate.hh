@@ -21,6 +21,8 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -34,7 +36,6 @@
 
 #include <ignition/common/SignalHandler.hh>
 #include <ignition/common/URI.hh>
-#include <ignition/common/WorkerPool.hh>
 
 #include <ignition/fuel_tools/FuelClient.hh>
 
@@ -42,9 +43,13 @@
 
 #include "ignition/gazebo/config.hh"
 #include "ignition/gazebo/Export.hh"
+#include "ignition/gazebo/Server.hh"
 #include "ignition/gazebo/ServerConfig.hh"
 #include "ignition/gazebo/SystemLoader.hh"
 
+#include "StartupProfile.hh"
+#include "TaskPool.hh"
+
 using namespace std::chrono_literals;
 
 namespace ignition
@@ -75,6 +80,24 @@ namespace ignition
       /// \param[in] _config Server configuration parameters.
       public: void AddRecordPlugin(const ServerConfig &_config);
 
+      /// \brief Load the world into sdfRoot, from the world cache if it's
+      /// enabled and holds the world.
+      /// \param[in] _config Server configuration parameters.
+      /// \param[in] _source Content of the world file or SDF string.
+      /// \param[in] _load Function loading the world from its source, used
+      /// when the world isn't cached. Its result is then cached.
+      /// \return Errors from loading the world.
+      public: sdf::Errors LoadWorld(const ServerConfig &_config,
+                  const std::string &_source,
+                  const std::function<sdf::Errors()> &_load);
+
+      /// \brief Download the Fuel models referred to by a world in
+      /// parallel, so they're cached when the world is parsed.
+      /// \param[in] _config Server configuration parameters.
+      /// \param[in] _source Content of the world file or SDF string.
+      public: void PrefetchResources(const ServerConfig &_config,
+                  const std::string &_source);
+
       /// \brief Create all entities that exist in the sdf::Root object.
       public: void CreateEntities();
 
@@ -115,12 +138,39 @@ namespace ignition
       /// \return True if successful.
       private: bool ResourcePathsService(ignition::msgs::StringMsg_V &_res);
 
-      /// \brief A pool of worker threads.
-      public: common::WorkerPool workerPool{2};
+      /// \brief Time spent starting the server, reported by the runners
+      /// after their first iteration. Declared before the runners, which
+      /// record into it, so it outlives them.
+      public: StartupProfile startupProfile;
 
       /// \brief All the simulation runners.
       public: std::vector<std::unique_ptr<SimulationRunner>> simRunners;
 
+      /// \brief Number of worlds forked so far, see Server::ForkWorld.
+      public: unsigned int forkCount{0};
+
+      /// \brief Threads stepping worlds in Server::StepAll, created on first
+      /// use.
+      public: std::unique_ptr<TaskPool> batchPool;
+
+      /// \brief Number of actions per world, see Server::SetBatchCallbacks.
+      public: std::size_t batchActionSize{0};
+
+      /// \brief Number of observations per world.
+      public: std::size_t batchObservationSize{0};
+
+      /// \brief Applies the actions of a world.
+      public: Server::BatchActionCallback batchActionCb;
+
+      /// \brief Fills the observations of a world.
+      public: Server::BatchObservationCallback batchObservationCb;
+
+      /// \brief Actions of all worlds, row-major.
+      public: std::vector<double> batchActions;
+
+      /// \brief Observations of all worlds, row-major.
+      public: std::vector<double> batchObservations;
+
       /// \brief Mutex to protect the Run operation.
       public: std::mutex runMutex;
 
@@ -27,6 +27,7 @@
 #include "ignition/gazebo/components/AxisAlignedBox.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/System.hh"
@@ -593,6 +594,165 @@ TEST_P(ServerFixture, RunNonBlockingMultiple)
   EXPECT_FALSE(*server.Running(0));
 }
 
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, Snapshot)
+{
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  gazebo::Server server(serverConfig);
+  server.SetUpdatePeriod(1ns);
+  const size_t entityCount = *server.EntityCount();
+
+  EXPECT_FALSE(server.SaveSnapshot(1).has_value());
+  EXPECT_FALSE(server.RestoreSnapshot(1));
+
+  auto id = server.SaveSnapshot();
+  ASSERT_TRUE(id.has_value());
+
+  EXPECT_TRUE(server.Run(true, 100, false));
+  EXPECT_EQ(100u, *server.IterationCount());
+
+  // Removed entities are created again
+  EXPECT_TRUE(server.RequestRemoveEntity("box"));
+  EXPECT_TRUE(server.Run(true, 1, false));
+  EXPECT_FALSE(server.HasEntity("box"));
+
+  EXPECT_TRUE(server.RestoreSnapshot(*id));
+  EXPECT_EQ(0u, *server.IterationCount());
+  EXPECT_TRUE(server.HasEntity("box"));
+  EXPECT_EQ(entityCount, *server.EntityCount());
+
+  // Snapshots can be restored again, while running too
+  EXPECT_TRUE(server.Run(true, 10, false));
+  EXPECT_EQ(10u, *server.IterationCount());
+  EXPECT_TRUE(server.RestoreSnapshot(*id));
+  EXPECT_EQ(0u, *server.IterationCount());
+
+  EXPECT_TRUE(server.Run(false, 1000, false));
+  EXPECT_TRUE(server.RestoreSnapshot(*id));
+  while (server.Running())
+    IGN_SLEEP_MS(10);
+  EXPECT_EQ(entityCount, *server.EntityCount());
+
+  EXPECT_TRUE(server.RemoveSnapshot(*id));
+  EXPECT_FALSE(server.RestoreSnapshot(*id));
+  EXPECT_FALSE(server.RemoveSnapshot(*id));
+}
+
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, ForkWorld)
+{
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  gazebo::Server server(serverConfig);
+  server.SetUpdatePeriod(1ns);
+  const size_t entityCount = *server.EntityCount();
+  EXPECT_TRUE(server.Run(true, 10, false));
+
+  EXPECT_FALSE(server.ForkWorld(1).has_value());
+  auto fork = server.ForkWorld();
+  ASSERT_TRUE(fork.has_value());
+  EXPECT_EQ(1u, *fork);
+  EXPECT_EQ(entityCount, *server.EntityCount(*fork));
+  EXPECT_EQ(10u, *server.IterationCount(*fork));
+
+  // Worlds step together, but change independently
+  EXPECT_TRUE(server.RequestRemoveEntity("box", true, *fork));
+  EXPECT_TRUE(server.Run(true, 10, false));
+  EXPECT_EQ(20u, *server.IterationCount());
+  EXPECT_EQ(20u, *server.IterationCount(*fork));
+  EXPECT_TRUE(server.HasEntity("box"));
+  EXPECT_FALSE(server.HasEntity("box", *fork));
+
+  // Forks can't be created while running
+  EXPECT_TRUE(server.Run(false, 1000, false));
+  EXPECT_FALSE(server.ForkWorld().has_value());
+  while (server.Running())
+    IGN_SLEEP_MS(10);
+}
+
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, StepAll)
+{
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/shapes.sdf");
+
+  gazebo::Server server(serverConfig);
+  ASSERT_TRUE(server.ForkWorld().has_value());
+  ASSERT_TRUE(server.ForkWorld().has_value());
+  const size_t entityCount = *server.EntityCount();
+
+  auto findBox = [](const EntityComponentManager &_ecm)
+  {
+    return _ecm.EntityByComponents(components::Name("box"),
+        components::Model());
+  };
+
+  // Worlds whose action is positive remove their box
+  server.SetBatchCallbacks(1,
+      [&](unsigned int, const double *_actions, EntityComponentManager &_ecm)
+      {
+        Entity box = findBox(_ecm);
+        if (_actions[0] > 0 && kNullEntity != box)
+          _ecm.RequestRemoveEntity(box);
+      },
+      2,
+      [&](unsigned int, const EntityComponentManager &_ecm,
+          double *_observations)
+      {
+        _observations[0] = kNullEntity != findBox(_ecm) ? 1.0 : 0.0;
+        _observations[1] = static_cast<double>(_ecm.EntityCount());
+      });
+
+  auto &actions = server.BatchActions();
+  ASSERT_EQ(3u, actions.size());
+  actions = {0.0, 1.0, 0.0};
+
+  EXPECT_TRUE(server.StepAll(5));
+  EXPECT_FALSE(server.Running());
+  for (unsigned int i = 0; i < 3; ++i)
+    EXPECT_EQ(5u, *server.IterationCount(i));
+
+  const auto &observations = server.BatchObservations();
+  ASSERT_EQ(6u, observations.size());
+  EXPECT_DOUBLE_EQ(1.0, observations[0]);
+  EXPECT_DOUBLE_EQ(0.0, observations[2]);
+  EXPECT_DOUBLE_EQ(1.0, observations[4]);
+  EXPECT_DOUBLE_EQ(static_cast<double>(entityCount), observations[1]);
+  EXPECT_GT(observations[1], observations[3]);
+  EXPECT_FALSE(server.HasEntity("box", 1));
+
+  // Batched steps can't overlap a run
+  EXPECT_TRUE(server.Run(false, 1000, false));
+  EXPECT_FALSE(server.StepAll(1));
+  while (server.Running())
+    IGN_SLEEP_MS(10);
+}
+
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, MaxThroughput)
+{
+  ServerConfig serverConfig;
+  serverConfig.SetMaxThroughput(true);
+  serverConfig.SetThroughputStatsPeriod(100ms);
+
+  // The scene broadcaster isn't loaded
+  gazebo::Server server(serverConfig);
+  EXPECT_EQ(2u, *server.SystemCount());
+  EXPECT_DOUBLE_EQ(0.0, *server.StepsPerSecond());
+  EXPECT_FALSE(server.StepsPerSecond(1).has_value());
+
+  EXPECT_TRUE(server.Run(false, 0, false));
+  while (*server.StepsPerSecond() <= 0.0)
+    IGN_SLEEP_MS(10);
+  EXPECT_GT(*server.IterationCount(), 0u);
+}
+
 /////////////////////////////////////////////////
 TEST_P(ServerFixture, SigInt)
 {
@@ -690,6 +850,42 @@ TEST_P(ServerFixture, AddSystemAfterLoad)
   EXPECT_EQ(1u, mockSystem->postUpdateCallCount);
 }
 
+/////////////////////////////////////////////////
+TEST_P(ServerFixture, PostUpdateWorkerThreads)
+{
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfString(TestWorldSansPhysics::World());
+
+  // Fewer worker threads than systems, so systems share threads.
+  serverConfig.SetWorkerThreadCount(2);
+
+  gazebo::Server server(serverConfig);
+
+  gazebo::SystemLoader systemLoader;
+  std::vector<gazebo::MockSystem *> mockSystems;
+  for (int i = 0; i < 8; ++i)
+  {
+    auto mockSystemPlugin = systemLoader.LoadPlugin("libMockSystem.so",
+        "ignition::gazebo::MockSystem", nullptr);
+    ASSERT_TRUE(mockSystemPlugin.has_value());
+    EXPECT_TRUE(*server.AddSystem(mockSystemPlugin.value()));
+
+    auto system = mockSystemPlugin.value()->QueryInterface<gazebo::System>();
+    auto mockSystem = dynamic_cast<gazebo::MockSystem*>(system);
+    ASSERT_NE(mockSystem, nullptr);
+    mockSystems.push_back(mockSystem);
+  }
+
+  server.SetUpdatePeriod(1ns);
+  server.Run(true, 10, false);
+
+  for (const auto &mockSystem : mockSystems)
+  {
+    EXPECT_EQ(10u, mockSystem->updateCallCount);
+    EXPECT_EQ(10u, mockSystem->postUpdateCallCount);
+  }
+}
+
 /////////////////////////////////////////////////
 TEST_P(ServerFixture, Seed)
 {
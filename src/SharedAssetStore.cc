@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "ignition/gazebo/SharedAssetStore.hh"
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
+
+using namespace ignition;
+using namespace gazebo;
+
+namespace
+{
+  /// \brief Identifies gazebo assets.
+  constexpr uint32_t kMagic{0x69676173};
+
+  /// \brief Layout version, increased on incompatible changes.
+  constexpr uint32_t kVersion{1};
+
+  /// \brief Start of each asset file, followed by the data.
+  struct AssetHeader
+  {
+    /// \brief Always kMagic.
+    uint32_t magic{kMagic};
+
+    /// \brief Always kVersion.
+    uint32_t version{kVersion};
+
+    /// \brief Data size.
+    uint64_t size{0};
+  };
+
+  /// \brief Assets mapped by this process by file path, so each is only
+  /// mapped once, whichever store finds it.
+  /// \return Registry.
+  std::unordered_map<std::string, std::weak_ptr<const std::string_view>> &
+      mappedAssets()
+  {
+    static std::unordered_map<std::string,
+        std::weak_ptr<const std::string_view>> assets;
+    return assets;
+  }
+
+  /// \brief Mutex protecting mappedAssets.
+  /// \return Mutex.
+  std::mutex &mappedAssetsMutex()
+  {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  /// \brief Map an asset file.
+  /// \param[in] _path File path.
+  /// \return The asset data, or nullptr if the file doesn't exist or isn't
+  /// a valid asset.
+  SharedAssetStore::Asset mapAsset(const std::string &_path)
+  {
+#ifdef _WIN32
+    std::ifstream file(_path, std::ios::binary);
+    if (!file)
+      return nullptr;
+
+    auto contents = std::make_shared<std::string>(
+        std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>());
+    AssetHeader header;
+    if (contents->size() < sizeof(header))
+      return nullptr;
+    std::memcpy(&header, contents->data(), sizeof(header));
+    if (header.magic != kMagic || header.version != kVersion ||
+        header.size != contents->size() - sizeof(header))
+    {
+      return nullptr;
+    }
+
+    return SharedAssetStore::Asset(
+        new std::string_view(contents->data() + sizeof(header), header.size),
+        [contents](const std::string_view *_view)
+        {
+          delete _view;
+        });
+#else
+    int fd = open(_path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return nullptr;
+
+    struct stat info;
+    void *memory{MAP_FAILED};
+    std::size_t size{0};
+    if (fstat(fd, &info) == 0 &&
+        static_cast<std::size_t>(info.st_size) >= sizeof(AssetHeader))
+    {
+      size = static_cast<std::size_t>(info.st_size);
+      memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+
+    if (memory == MAP_FAILED)
+      return nullptr;
+
+    AssetHeader header;
+    std::memcpy(&header, memory, sizeof(header));
+    if (header.magic != kMagic || header.version != kVersion ||
+        header.size != size - sizeof(header))
+    {
+      munmap(memory, size);
+      return nullptr;
+    }
+
+    return SharedAssetStore::Asset(
+        new std::string_view(
+            static_cast<const char *>(memory) + sizeof(header),
+            header.size),
+        [memory, size](const std::string_view *_view)
+        {
+          munmap(memory, size);
+          delete _view;
+        });
+#endif
+  }
+
+  /// \brief Check whether a key can be used as a file name.
+  /// \param[in] _key Asset key.
+  /// \return True if it's made of letters, digits, dashes and underscores.
+  bool validKey(const std::string &_key)
+  {
+    if (_key.empty())
+      return false;
+
+    for (auto c : _key)
+    {
+      if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' &&
+          c != '_')
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+/// \brief Private data for SharedAssetStore
+class ignition::gazebo::SharedAssetStorePrivate
+{
+  /// \brief Get the path of an asset file.
+  /// \param[in] _key Asset key.
+  /// \return File path.
+  public: std::string Path(const std::string &_key) const
+  {
+    return common::joinPaths(this->directory, _key + ".asset");
+  }
+
+  /// \brief Directory of the assets.
+  public: std::string directory;
+
+  /// \brief Whether the directory exists.
+  public: bool valid{false};
+};
+
+//////////////////////////////////////////////////
+SharedAssetStore::SharedAssetStore(const std::string &_directory)
+  : dataPtr(std::make_unique<SharedAssetStorePrivate>())
+{
+  this->dataPtr->directory = _directory;
+  this->dataPtr->valid = common::createDirectories(_directory);
+  if (!this->dataPtr->valid)
+  {
+    ignerr << "Failed to create shared asset directory [" << _directory
+           << "]." << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+SharedAssetStore::~SharedAssetStore() = default;
+
+//////////////////////////////////////////////////
+bool SharedAssetStore::Valid() const
+{
+  return this->dataPtr->valid;
+}
+
+//////////////////////////////////////////////////
+const std::string &SharedAssetStore::Directory() const
+{
+  return this->dataPtr->directory;
+}
+
+//////////////////////////////////////////////////
+SharedAssetStore::Asset SharedAssetStore::Find(const std::string &_key) const
+{
+  if (!this->dataPtr->valid || !validKey(_key))
+    return nullptr;
+
+  IGN_PROFILE("SharedAssetStore::Find");
+
+  const auto path = this->dataPtr->Path(_key);
+  std::lock_guard<std::mutex> lock(mappedAssetsMutex());
+  auto &assets = mappedAssets();
+  auto it = assets.find(path);
+  if (it != assets.end())
+  {
+    if (auto asset = it->second.lock())
+      return asset;
+  }
+
+  auto asset = mapAsset(path);
+  if (nullptr == asset)
+  {
+    if (it != assets.end())
+      assets.erase(it);
+    return nullptr;
+  }
+  assets[path] = asset;
+  return asset;
+}
+
+//////////////////////////////////////////////////
+SharedAssetStore::Asset SharedAssetStore::Insert(const std::string &_key,
+    const std::string &_data) const
+{
+  if (!this->dataPtr->valid)
+    return nullptr;
+
+  if (!validKey(_key))
+  {
+    ignerr << "Invalid shared asset key [" << _key << "]." << std::endl;
+    return nullptr;
+  }
+
+  IGN_PROFILE("SharedAssetStore::Insert");
+
+  // Write to a temporary file unique to this process first, so other
+  // processes never map a partial asset
+  const auto path = this->dataPtr->Path(_key);
+#ifdef _WIN32
+  const auto tmpPath = path + ".tmp" + std::to_string(_getpid());
+#else
+  const auto tmpPath = path + ".tmp" + std::to_string(getpid());
+#endif
+  {
+    std::ofstream out(tmpPath, std::ios::binary);
+    AssetHeader header;
+    header.size = _data.size();
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(_data.data(), static_cast<std::streamsize>(_data.size()));
+    if (!out)
+    {
+      ignwarn << "Failed to write shared asset [" << tmpPath << "]."
+              << std::endl;
+      out.close();
+      common::removeFile(tmpPath);
+      return nullptr;
+    }
+  }
+  if (!common::moveFile(tmpPath, path))
+  {
+    ignwarn << "Failed to move shared asset [" << tmpPath << "] to ["
+            << path << "]." << std::endl;
+    common::removeFile(tmpPath);
+    return nullptr;
+  }
+
+  // Mappings of a replaced asset stay valid, but new views should see the
+  // new file
+  {
+    std::lock_guard<std::mutex> lock(mappedAssetsMutex());
+    mappedAssets().erase(path);
+  }
+  return this->Find(_key);
+}
+
+//////////////////////////////////////////////////
+std::string SharedAssetStore::ContentKey(const std::string &_content)
+{
+  // FNV-1a, which unlike std::hash is the same for all builds
+  uint64_t hash{14695981039346656037ull};
+  for (auto c : _content)
+  {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ull;
+  }
+
+  std::ostringstream key;
+  key << std::hex << hash << "-" << _content.size();
+  return key.str();
+}
+
+//////////////////////////////////////////////////
+std::string SharedAssetStore::DefaultDirectory()
+{
+  std::string home;
+  common::env(IGN_HOMEDIR, home);
+  return common::joinPaths(home, ".ignition", "gazebo", "assets");
+}
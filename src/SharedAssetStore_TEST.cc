@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <ignition/common/Filesystem.hh>
+
+#include "ignition/gazebo/SharedAssetStore.hh"
+#include "ignition/gazebo/test_config.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(SharedAssetStore, InsertFind)
+{
+  const std::string dir = common::joinPaths(PROJECT_BINARY_PATH,
+      "test_shared_assets");
+  common::removeAll(dir);
+
+  SharedAssetStore store(dir);
+  ASSERT_TRUE(store.Valid());
+  EXPECT_EQ(dir, store.Directory());
+
+  const std::string data("mesh\0data", 9);
+  const auto key = SharedAssetStore::ContentKey("mesh file");
+  EXPECT_EQ(nullptr, store.Find(key));
+
+  auto inserted = store.Insert(key, data);
+  ASSERT_NE(nullptr, inserted);
+  EXPECT_EQ(data, std::string(*inserted));
+
+  // Each asset is only mapped once per process
+  EXPECT_EQ(inserted, store.Find(key));
+  SharedAssetStore other(dir);
+  EXPECT_EQ(inserted, other.Find(key));
+
+  // Mapped again once released
+  inserted.reset();
+  auto found = other.Find(key);
+  ASSERT_NE(nullptr, found);
+  EXPECT_EQ(data, std::string(*found));
+
+  // Replacing an asset keeps held views valid
+  auto replaced = store.Insert(key, "other");
+  ASSERT_NE(nullptr, replaced);
+  EXPECT_EQ("other", std::string(*replaced));
+  EXPECT_EQ(data, std::string(*found));
+
+  // Keys must be valid file names
+  EXPECT_EQ(nullptr, store.Insert("../escape", data));
+  EXPECT_EQ(nullptr, store.Insert("", data));
+  EXPECT_EQ(nullptr, store.Find("../escape"));
+}
+
+/////////////////////////////////////////////////
+TEST(SharedAssetStore, InvalidFiles)
+{
+  const std::string dir = common::joinPaths(PROJECT_BINARY_PATH,
+      "test_shared_assets_invalid");
+  common::removeAll(dir);
+  SharedAssetStore store(dir);
+  ASSERT_TRUE(store.Valid());
+
+  // Files which aren't assets are ignored
+  std::ofstream(common::joinPaths(dir, "short.asset")) << "abc";
+  EXPECT_EQ(nullptr, store.Find("short"));
+  std::ofstream(common::joinPaths(dir, "garbage.asset"))
+      << "not an asset file at all";
+  EXPECT_EQ(nullptr, store.Find("garbage"));
+
+  // Truncated assets are ignored
+  ASSERT_NE(nullptr, store.Insert("truncated", "0123456789"));
+  const auto path = common::joinPaths(dir, "truncated.asset");
+  std::string contents;
+  {
+    std::ifstream in(path, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in),
+        std::istreambuf_iterator<char>());
+  }
+  std::ofstream(path, std::ios::binary)
+      << contents.substr(0, contents.size() - 1);
+  EXPECT_EQ(nullptr, store.Find("truncated"));
+}
+
+/////////////////////////////////////////////////
+TEST(SharedAssetStore, ContentKey)
+{
+  // Stable across builds
+  EXPECT_EQ("cbf29ce484222325-0", SharedAssetStore::ContentKey(""));
+  EXPECT_EQ("af63df4c8601f1a5-1", SharedAssetStore::ContentKey("b"));
+  EXPECT_NE(SharedAssetStore::ContentKey("ab"),
+      SharedAssetStore::ContentKey("ba"));
+}
@@ -0,0 +1,503 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ignition/gazebo/SharedMemoryChannel.hh"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+
+using namespace ignition;
+using namespace gazebo;
+
+namespace
+{
+  /// \brief Identifies gazebo channels.
+  constexpr uint32_t kMagic{0x6967736d};
+
+  /// \brief Layout version, increased on incompatible changes.
+  constexpr uint32_t kVersion{1};
+
+  /// \brief Alignment of the header and slots, so that the writer and
+  /// readers of different slots don't share cache lines.
+  constexpr std::size_t kAlignment{64};
+
+  /// \brief Start of the channel.
+  struct alignas(kAlignment) ChannelHeader
+  {
+    /// \brief kMagic once the channel is initialized.
+    uint32_t magic{0};
+
+    /// \brief Always kVersion.
+    uint32_t version{kVersion};
+
+    /// \brief Number of slots.
+    uint64_t slotCount{0};
+
+    /// \brief Payload capacity of each slot.
+    uint64_t slotSize{0};
+
+    /// \brief Sequence number of the last committed message.
+    std::atomic<uint64_t> sequence{0};
+  };
+
+  /// \brief Start of each slot, followed by the payload.
+  struct alignas(kAlignment) SlotHeader
+  {
+    /// \brief Twice the sequence number of the message in the slot, minus
+    /// one while the message is being written.
+    std::atomic<uint64_t> lock{0};
+
+    /// \brief Message size.
+    uint64_t size{0};
+  };
+
+  static_assert(std::atomic<uint64_t>::is_always_lock_free,
+      "Shared memory channels need lock free atomics");
+
+  /// \brief Get the distance between the start of slots.
+  /// \param[in] _slotSize Payload capacity.
+  /// \return Stride in bytes.
+  std::size_t slotStride(std::size_t _slotSize)
+  {
+    std::size_t size = sizeof(SlotHeader) + _slotSize;
+    return (size + kAlignment - 1) / kAlignment * kAlignment;
+  }
+
+  /// \brief Get the POSIX name of a channel.
+  /// \param[in] _name Channel name.
+  /// \return Name starting with a slash.
+  std::string shmName(const std::string &_name)
+  {
+    return "/" + _name;
+  }
+}
+
+/// \brief Private data for SharedMemoryWriter
+class ignition::gazebo::SharedMemoryWriterPrivate
+{
+  /// \brief Get a slot.
+  /// \param[in] _sequence Sequence number of the message in the slot.
+  /// \return Slot header, followed by the payload.
+  public: SlotHeader *Slot(uint64_t _sequence) const
+  {
+    return reinterpret_cast<SlotHeader *>(this->memory +
+        sizeof(ChannelHeader) + (_sequence % this->slotCount) * this->stride);
+  }
+
+  /// \brief Channel name.
+  public: std::string name;
+
+  /// \brief Mapped channel, nullptr if it wasn't created.
+  public: char *memory{nullptr};
+
+  /// \brief Size of the mapping.
+  public: std::size_t mappedSize{0};
+
+  /// \brief Number of slots.
+  public: std::size_t slotCount{0};
+
+  /// \brief Payload capacity of each slot.
+  public: std::size_t slotSize{0};
+
+  /// \brief Distance between slots.
+  public: std::size_t stride{0};
+
+  /// \brief Sequence number of the reserved message, 0 if none.
+  public: uint64_t reserved{0};
+
+  /// \brief Size of the reserved message.
+  public: std::size_t reservedSize{0};
+
+  /// \brief True once a too large message was reported.
+  public: bool warnedSize{false};
+};
+
+/// \brief Private data for SharedMemoryReader
+class ignition::gazebo::SharedMemoryReaderPrivate
+{
+  /// \brief Get a slot.
+  /// \param[in] _sequence Sequence number of the message in the slot.
+  /// \return Slot header, followed by the payload.
+  public: const SlotHeader *Slot(uint64_t _sequence) const
+  {
+    return reinterpret_cast<const SlotHeader *>(this->memory +
+        sizeof(ChannelHeader) + (_sequence % this->slotCount) * this->stride);
+  }
+
+  /// \brief Mapped channel, nullptr if it wasn't mapped.
+  public: const char *memory{nullptr};
+
+  /// \brief Size of the mapping.
+  public: std::size_t mappedSize{0};
+
+  /// \brief Number of slots.
+  public: std::size_t slotCount{0};
+
+  /// \brief Payload capacity of each slot.
+  public: std::size_t slotSize{0};
+
+  /// \brief Distance between slots.
+  public: std::size_t stride{0};
+
+  /// \brief Sequence number of the next message to read.
+  public: uint64_t next{1};
+
+  /// \brief Number of overwritten messages.
+  public: uint64_t missed{0};
+};
+
+//////////////////////////////////////////////////
+/// \brief Replace the characters of a channel name which aren't letters or
+/// digits, so it's a valid shared memory object name.
+/// \param[in] _name Name.
+/// \return Sanitized name.
+static std::string sanitizedChannelName(std::string _name)
+{
+  for (auto &c : _name)
+  {
+    if (!std::isalnum(static_cast<unsigned char>(c)))
+      c = '_';
+  }
+  return _name;
+}
+
+//////////////////////////////////////////////////
+std::string ignition::gazebo::stateChannelName(const std::string &_worldName)
+{
+  return sanitizedChannelName("ign_gazebo_" + _worldName + "_state");
+}
+
+//////////////////////////////////////////////////
+std::string ignition::gazebo::topicChannelName(const std::string &_topic)
+{
+  return sanitizedChannelName("ign_gazebo_topic" + _topic);
+}
+
+//////////////////////////////////////////////////
+SharedMemoryWriter::SharedMemoryWriter(const std::string &_name,
+    std::size_t _slotCount, std::size_t _slotSize)
+  : dataPtr(std::make_unique<SharedMemoryWriterPrivate>())
+{
+#ifdef _WIN32
+  ignerr << "Shared memory channels aren't supported on Windows, failed to "
+         << "create [" << _name << "]." << std::endl;
+  (void) _slotCount;
+  (void) _slotSize;
+#else
+  if (_slotCount == 0 || _slotSize == 0)
+  {
+    ignerr << "Shared memory channel [" << _name << "] needs at least one "
+           << "slot of at least one byte." << std::endl;
+    return;
+  }
+
+  // Replace channels left behind by writers which didn't exit cleanly
+  auto name = shmName(_name);
+  shm_unlink(name.c_str());
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0)
+  {
+    ignerr << "Failed to create shared memory channel [" << _name << "]: "
+           << std::strerror(errno) << std::endl;
+    return;
+  }
+
+  auto stride = slotStride(_slotSize);
+  std::size_t size = sizeof(ChannelHeader) + _slotCount * stride;
+
+  // Pages are only backed once written, so large slots only cost the size
+  // of the messages actually written into them
+  void *memory{MAP_FAILED};
+  if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+    memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (memory == MAP_FAILED)
+  {
+    ignerr << "Failed to map shared memory channel [" << _name << "]: "
+           << std::strerror(errno) << std::endl;
+    shm_unlink(name.c_str());
+    return;
+  }
+
+  auto header = new (memory) ChannelHeader;
+  header->slotCount = _slotCount;
+  header->slotSize = _slotSize;
+  this->dataPtr->memory = static_cast<char *>(memory);
+  for (std::size_t i = 0; i < _slotCount; ++i)
+  {
+    new (this->dataPtr->memory + sizeof(ChannelHeader) + i * stride)
+        SlotHeader;
+  }
+
+  // Readers which open the channel before this ignore it
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = kMagic;
+
+  this->dataPtr->name = name;
+  this->dataPtr->mappedSize = size;
+  this->dataPtr->slotCount = _slotCount;
+  this->dataPtr->slotSize = _slotSize;
+  this->dataPtr->stride = stride;
+#endif
+}
+
+//////////////////////////////////////////////////
+SharedMemoryWriter::~SharedMemoryWriter()
+{
+#ifndef _WIN32
+  if (nullptr == this->dataPtr->memory)
+    return;
+
+  munmap(this->dataPtr->memory, this->dataPtr->mappedSize);
+  shm_unlink(this->dataPtr->name.c_str());
+#endif
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryWriter::Valid() const
+{
+  return nullptr != this->dataPtr->memory;
+}
+
+//////////////////////////////////////////////////
+std::size_t SharedMemoryWriter::SlotSize() const
+{
+  return this->dataPtr->slotSize;
+}
+
+//////////////////////////////////////////////////
+void *SharedMemoryWriter::Reserve(std::size_t _size)
+{
+  if (nullptr == this->dataPtr->memory)
+    return nullptr;
+
+  if (_size > this->dataPtr->slotSize)
+  {
+    if (!this->dataPtr->warnedSize)
+    {
+      ignwarn << "Message of [" << _size << "] bytes doesn't fit in the ["
+              << this->dataPtr->slotSize << "] byte slots of shared memory "
+              << "channel [" << this->dataPtr->name << "], dropping it. "
+              << "Further messages won't be reported." << std::endl;
+      this->dataPtr->warnedSize = true;
+    }
+    return nullptr;
+  }
+
+  auto header = reinterpret_cast<ChannelHeader *>(this->dataPtr->memory);
+  if (this->dataPtr->reserved == 0)
+  {
+    this->dataPtr->reserved =
+        header->sequence.load(std::memory_order_relaxed) + 1;
+
+    // Readers which see the odd value, or see it change while copying,
+    // discard what they copied
+    auto slot = this->dataPtr->Slot(this->dataPtr->reserved);
+    slot->lock.store(2 * this->dataPtr->reserved - 1,
+        std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  this->dataPtr->reservedSize = _size;
+
+  return this->dataPtr->Slot(this->dataPtr->reserved) + 1;
+}
+
+//////////////////////////////////////////////////
+void SharedMemoryWriter::Commit()
+{
+  if (this->dataPtr->reserved == 0)
+    return;
+
+  auto slot = this->dataPtr->Slot(this->dataPtr->reserved);
+  slot->size = this->dataPtr->reservedSize;
+  slot->lock.store(2 * this->dataPtr->reserved, std::memory_order_release);
+
+  auto header = reinterpret_cast<ChannelHeader *>(this->dataPtr->memory);
+  header->sequence.store(this->dataPtr->reserved, std::memory_order_release);
+  this->dataPtr->reserved = 0;
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryWriter::Write(const void *_data, std::size_t _size)
+{
+  IGN_PROFILE("SharedMemoryWriter::Write");
+
+  auto slot = this->Reserve(_size);
+  if (nullptr == slot)
+    return false;
+
+  std::memcpy(slot, _data, _size);
+  this->Commit();
+  return true;
+}
+
+//////////////////////////////////////////////////
+uint64_t SharedMemoryWriter::Sequence() const
+{
+  if (nullptr == this->dataPtr->memory)
+    return 0;
+
+  auto header = reinterpret_cast<ChannelHeader *>(this->dataPtr->memory);
+  return header->sequence.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+SharedMemoryReader::SharedMemoryReader(const std::string &_name)
+  : dataPtr(std::make_unique<SharedMemoryReaderPrivate>())
+{
+#ifdef _WIN32
+  ignerr << "Shared memory channels aren't supported on Windows, failed to "
+         << "open [" << _name << "]." << std::endl;
+#else
+  int fd = shm_open(shmName(_name).c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    return;
+
+  struct stat info;
+  void *memory{MAP_FAILED};
+  std::size_t size{0};
+  if (fstat(fd, &info) == 0 &&
+      static_cast<std::size_t>(info.st_size) >= sizeof(ChannelHeader))
+  {
+    size = static_cast<std::size_t>(info.st_size);
+    memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+
+  if (memory == MAP_FAILED)
+    return;
+
+  auto header = static_cast<const ChannelHeader *>(memory);
+  auto stride = slotStride(header->slotSize);
+  if (header->magic != kMagic || header->version != kVersion ||
+      header->slotCount == 0 ||
+      sizeof(ChannelHeader) + header->slotCount * stride > size)
+  {
+    ignerr << "Shared memory channel [" << _name << "] has an unknown "
+           << "layout, ignoring it." << std::endl;
+    munmap(memory, size);
+    return;
+  }
+
+  this->dataPtr->memory = static_cast<const char *>(memory);
+  this->dataPtr->mappedSize = size;
+  this->dataPtr->slotCount = header->slotCount;
+  this->dataPtr->slotSize = header->slotSize;
+  this->dataPtr->stride = stride;
+
+  // Start with the newest message
+  auto sequence = header->sequence.load(std::memory_order_acquire);
+  this->dataPtr->next = sequence > 0 ? sequence : 1;
+#endif
+}
+
+//////////////////////////////////////////////////
+SharedMemoryReader::~SharedMemoryReader()
+{
+#ifndef _WIN32
+  if (nullptr != this->dataPtr->memory)
+  {
+    munmap(const_cast<char *>(this->dataPtr->memory),
+        this->dataPtr->mappedSize);
+  }
+#endif
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryReader::Valid() const
+{
+  return nullptr != this->dataPtr->memory;
+}
+
+//////////////////////////////////////////////////
+bool SharedMemoryReader::Read(std::string &_data)
+{
+  if (nullptr == this->dataPtr->memory)
+    return false;
+
+  IGN_PROFILE("SharedMemoryReader::Read");
+
+  auto header = reinterpret_cast<const ChannelHeader *>(this->dataPtr->memory);
+  while (true)
+  {
+    auto latest = header->sequence.load(std::memory_order_acquire);
+    auto &next = this->dataPtr->next;
+    if (latest < next)
+      return false;
+
+    // The writer is already reusing the slot of the next message
+    if (latest - next + 1 >= this->dataPtr->slotCount)
+    {
+      this->dataPtr->missed += latest - next;
+      next = latest;
+    }
+
+    auto slot = this->dataPtr->Slot(next);
+    auto before = slot->lock.load(std::memory_order_acquire);
+    if (before != 2 * next)
+    {
+      // The writer is rewriting the newest slot, which only happens with a
+      // single slot
+      if (next == latest)
+        return false;
+
+      // Overwritten while checking, try again with the newest message
+      this->dataPtr->missed += latest - next;
+      next = latest;
+      continue;
+    }
+
+    auto size = slot->size;
+    if (size <= this->dataPtr->slotSize)
+    {
+      _data.assign(reinterpret_cast<const char *>(slot + 1), size);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->lock.load(std::memory_order_relaxed) != before ||
+        size > this->dataPtr->slotSize)
+    {
+      this->dataPtr->missed += 1;
+      ++next;
+      continue;
+    }
+
+    ++next;
+    return true;
+  }
+}
+
+//////////////////////////////////////////////////
+uint64_t SharedMemoryReader::Missed() const
+{
+  return this->dataPtr->missed;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "ignition/gazebo/SharedMemoryChannel.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+// Shared memory channels are only supported on POSIX systems
+#ifndef _WIN32
+/////////////////////////////////////////////////
+TEST(SharedMemoryChannel, WriteRead)
+{
+  const std::string name{"ign_gazebo_test_write_read"};
+
+  // Nothing to map yet
+  {
+    SharedMemoryReader reader(name);
+    EXPECT_FALSE(reader.Valid());
+  }
+
+  SharedMemoryWriter writer(name, 4, 16);
+  ASSERT_TRUE(writer.Valid());
+  EXPECT_EQ(16u, writer.SlotSize());
+  EXPECT_EQ(0u, writer.Sequence());
+
+  EXPECT_TRUE(writer.Write("first", 5));
+
+  // Readers start at the newest message
+  SharedMemoryReader reader(name);
+  ASSERT_TRUE(reader.Valid());
+
+  std::string data;
+  ASSERT_TRUE(reader.Read(data));
+  EXPECT_EQ("first", data);
+  EXPECT_FALSE(reader.Read(data));
+
+  // In order
+  EXPECT_TRUE(writer.Write("second", 6));
+  EXPECT_TRUE(writer.Write("third", 5));
+  ASSERT_TRUE(reader.Read(data));
+  EXPECT_EQ("second", data);
+  ASSERT_TRUE(reader.Read(data));
+  EXPECT_EQ("third", data);
+  EXPECT_FALSE(reader.Read(data));
+  EXPECT_EQ(0u, reader.Missed());
+
+  // Too large
+  EXPECT_FALSE(writer.Write("this doesn't fit in a slot", 26));
+  EXPECT_FALSE(reader.Read(data));
+
+  // In place
+  auto slot = writer.Reserve(4);
+  ASSERT_NE(nullptr, slot);
+  std::memcpy(slot, "four", 4);
+  EXPECT_FALSE(reader.Read(data));
+  writer.Commit();
+  ASSERT_TRUE(reader.Read(data));
+  EXPECT_EQ("four", data);
+  EXPECT_EQ(4u, writer.Sequence());
+
+  // Slow readers skip to the newest message
+  for (int i = 0; i < 10; ++i)
+  {
+    auto msg = std::to_string(i);
+    EXPECT_TRUE(writer.Write(msg.data(), msg.size()));
+  }
+  ASSERT_TRUE(reader.Read(data));
+  EXPECT_EQ("9", data);
+  EXPECT_EQ(9u, reader.Missed());
+  EXPECT_FALSE(reader.Read(data));
+}
+
+/////////////////////////////////////////////////
+TEST(SharedMemoryChannel, Concurrent)
+{
+  const std::string name{"ign_gazebo_test_concurrent"};
+  SharedMemoryWriter writer(name, 8, 64);
+  ASSERT_TRUE(writer.Valid());
+  SharedMemoryReader reader(name);
+  ASSERT_TRUE(reader.Valid());
+
+  // Messages are strings of a repeated digit, so torn reads show up as
+  // mixed digits
+  std::atomic<bool> done{false};
+  std::thread writerThread([&]()
+  {
+    for (int i = 0; i < 100000; ++i)
+    {
+      std::string msg(1 + i % 64, static_cast<char>('0' + i % 10));
+      writer.Write(msg.data(), msg.size());
+    }
+    done = true;
+  });
+
+  uint64_t count{0};
+  std::string data;
+  while (true)
+  {
+    bool finished = done;
+    if (!reader.Read(data))
+    {
+      if (finished)
+        break;
+      continue;
+    }
+    ++count;
+    ASSERT_FALSE(data.empty());
+    EXPECT_EQ(std::string(data.size(), data[0]), data);
+  }
+  writerThread.join();
+  EXPECT_GT(count, 0u);
+}
+#endif
+
+/////////////////////////////////////////////////
+TEST(SharedMemoryChannel, StateChannelName)
+{
+  EXPECT_EQ("ign_gazebo_shapes_state", stateChannelName("shapes"));
+  EXPECT_EQ("ign_gazebo_my_world__state", stateChannelName("my world/"));
+}
+
+/////////////////////////////////////////////////
+TEST(SharedMemoryChannel, TopicChannelName)
+{
+  EXPECT_EQ("ign_gazebo_topic_camera_image",
+      topicChannelName("/camera/image"));
+  EXPECT_NE(topicChannelName("/camera/image"), stateChannelName("camera"));
+}
@@ -21,10 +21,22 @@
 
 #include <sdf/Root.hh>
 
+#include "ignition/common/Filesystem.hh"
 #include "ignition/common/Profiler.hh"
+#include "ignition/gazebo/components/AngularVelocityCmd.hh"
+#include "ignition/gazebo/components/Factory.hh"
+#include "ignition/gazebo/components/JointPosition.hh"
+#include "ignition/gazebo/components/JointPositionReset.hh"
+#include "ignition/gazebo/components/JointVelocity.hh"
+#include "ignition/gazebo/components/JointVelocityReset.hh"
+#include "ignition/gazebo/components/LinearVelocityCmd.hh"
 #include "ignition/gazebo/components/Model.hh"
 #include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/PoseCmd.hh"
 #include "ignition/gazebo/components/Sensor.hh"
+#include "ignition/gazebo/components/Static.hh"
 #include "ignition/gazebo/components/Visual.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/components/Physics.hh"
@@ -35,21 +47,144 @@
 
 #include "network/NetworkManagerPrimary.hh"
 #include "SdfGenerator.hh"
+#include "SystemStages.hh"
 
 using namespace ignition;
 using namespace gazebo;
 
 using StringSet = std::unordered_set<std::string>;
 
+namespace
+{
+/// \brief Call a function and record its wall time.
+/// \param[in] _histogram Histogram to record the time in.
+/// \param[in] _function Function to call.
+/// \return Wall time of the call.
+template <typename FunctionT>
+std::chrono::steady_clock::duration timed(DurationHistogram &_histogram,
+    const FunctionT &_function)
+{
+  const auto start = std::chrono::steady_clock::now();
+  _function();
+  const auto duration = std::chrono::steady_clock::now() - start;
+  _histogram.Add(duration);
+  return duration;
+}
+
+/// \brief Get a duration in milliseconds, as text.
+/// \param[in] _duration Duration.
+/// \return Milliseconds.
+std::string toMs(const std::chrono::steady_clock::duration &_duration)
+{
+  return std::to_string(
+      std::chrono::duration<double, std::milli>(_duration).count());
+}
+
+/// \brief Set a number in a param.
+/// \param[in] _param Param to set the number in.
+/// \param[in] _key Key of the number.
+/// \param[in] _value Value of the number.
+void setNumber(msgs::Param *_param, const std::string &_key, double _value)
+{
+  auto &any = (*_param->mutable_params())[_key];
+  any.set_type(msgs::Any_ValueType_DOUBLE);
+  any.set_double_value(_value);
+}
+
+/// \brief Set the statistics of a histogram in a param, and start the
+/// histogram over.
+/// \param[in] _param Param to set the statistics in.
+/// \param[in] _prefix Prefix of the statistics keys.
+/// \param[in] _histogram Histogram of wall times.
+void setHistogram(msgs::Param *_param, const std::string &_prefix,
+    DurationHistogram &_histogram)
+{
+  auto us = [](const std::chrono::steady_clock::duration &_duration)
+  {
+    return std::chrono::duration<double, std::micro>(_duration).count();
+  };
+  setNumber(_param, _prefix + "_count",
+      static_cast<double>(_histogram.Count()));
+  setNumber(_param, _prefix + "_p50_us", us(_histogram.Percentile(0.5)));
+  setNumber(_param, _prefix + "_p99_us", us(_histogram.Percentile(0.99)));
+  setNumber(_param, _prefix + "_max_us", us(_histogram.Max()));
+  setNumber(_param, _prefix + "_mean_us", us(_histogram.Mean()));
+  _histogram.Reset();
+}
+
+/// \brief Get the CPUs of a CPU list set in the server config.
+/// \param[in] _cpus CPU list, validated by the server config.
+/// \return CPU indices, empty to not pin threads.
+std::vector<unsigned int> cpus(const std::string &_cpus)
+{
+  return parseCpuList(_cpus).value_or(std::vector<unsigned int>());
+}
+
+/// \brief Pins the calling thread to a set of CPUs while in scope, and
+/// restores its previous CPUs when destroyed.
+class ScopedAffinity
+{
+  /// \brief Constructor
+  /// \param[in] _cpus CPUs to pin the thread to, empty to not pin it.
+  public: explicit ScopedAffinity(const std::vector<unsigned int> &_cpus)
+  {
+    if (_cpus.empty())
+      return;
+    auto previous = threadAffinity();
+    if (setThreadAffinity(_cpus))
+      this->previous = previous;
+  }
+
+  /// \brief Destructor
+  public: ~ScopedAffinity()
+  {
+    setThreadAffinity(this->previous);
+  }
+
+  /// \brief CPUs of the thread before it was pinned, empty if it wasn't.
+  private: std::vector<unsigned int> previous;
+};
+}
 
 //////////////////////////////////////////////////
 SimulationRunner::SimulationRunner(const sdf::World *_world,
                                    const SystemLoaderPtr &_systemLoader,
-                                   const ServerConfig &_config)
+                                   const ServerConfig &_config,
+                                   StartupProfile *_startupProfile)
     // \todo(nkoenig) Either copy the world, or add copy constructor to the
     // World and other elements.
-    : sdfWorld(_world), serverConfig(_config)
+    : sdfWorld(_world), serverConfig(_config),
+      startupProfile(_startupProfile)
 {
+  StartupScope startupScope(this->startupProfile, "runner");
+
+  // Entities are created on the simulation CPUs, so that with first-touch
+  // allocation component storage lives on the memory node of the thread
+  // which will update it. Worker threads without CPUs of their own inherit
+  // the simulation CPUs.
+  ScopedAffinity affinity(cpus(_config.SimulationCpus()));
+
+  // Threads for parallel work, shared with the entity component manager
+  this->taskPool = std::make_unique<TaskPool>(_config.WorkerThreadCount(),
+      cpus(_config.WorkerCpus()));
+  this->entityCompMgr.SetTaskPool(this->taskPool.get());
+  this->entityCompMgr.SetDeterministic(_config.Deterministic());
+  igndbg << "Using [" << this->taskPool->ThreadCount()
+         << "] worker threads for parallel work." << std::endl;
+
+  if (_config.TraceBufferSize() > 0)
+  {
+    this->traceRecorder =
+        std::make_unique<TraceRecorder>(_config.TraceBufferSize());
+  }
+
+  this->entityCompMgr.SetEntityRecycling(_config.EntityRecycling());
+
+  // Entities are often looked up by name and parent, for example by user
+  // commands and by systems while they're configured.
+  this->entityCompMgr.EnableComponentIndex<components::Name,
+      components::ParentEntity>();
+
   if (nullptr == _world)
   {
     ignerr << "Can't start simulation runner with null world." << std::endl;
@@ -117,7 +252,10 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
       std::placeholders::_2));
 
   // Create the level manager
-  this->levelMgr = std::make_unique<LevelManager>(this, _config.UseLevels());
+  {
+    StartupScope entitiesScope(this->startupProfile, "entities");
+    this->levelMgr = std::make_unique<LevelManager>(this, _config.UseLevels());
+  }
 
   // Check if this is going to be a distributed runner
   // Attempt to create the manager based on environment variables.
@@ -157,7 +295,10 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
   }
 
   // Load the active levels
-  this->levelMgr->UpdateLevelsState();
+  {
+    StartupScope entitiesScope(this->startupProfile, "entities");
+    this->levelMgr->UpdateLevelsState();
+  }
 
   // Load any additional plugins from the Server Configuration
   this->LoadServerPlugins(this->serverConfig.Plugins());
@@ -174,18 +315,93 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
 
   this->LoadLoggingPlugins(this->serverConfig);
 
+  // Publish empty GUI messages for worlds that have no GUI in the beginning.
+  // In the future, support modifying GUI from the server at runtime.
+  if (_world->Gui())
+  {
+    this->guiMsg = convert<msgs::GUI>(*_world->Gui());
+  }
+
   // World control
-  transport::NodeOptions opts;
   std::string ns{"/world/" + this->worldName};
   if (this->networkMgr)
   {
     ns = this->networkMgr->Namespace() + ns;
   }
+  {
+    StartupScope transportScope(this->startupProfile, "transport");
+    this->AdvertiseServices(ns);
+  }
+
+  ignmsg << "World [" << _world->Name() << "] initialized with ["
+         << physics->Name() << "] physics profile." << std::endl;
+}
+
+//////////////////////////////////////////////////
+SimulationRunner::SimulationRunner(const SimulationRunner &_source,
+                                   const unsigned int _forkId)
+    : sdfWorld(_source.sdfWorld), serverConfig(_source.serverConfig)
+{
+  IGN_PROFILE("SimulationRunner::Fork");
+
+  // Each fork has threads of its own, so forks run in parallel.
+  this->taskPool = std::make_unique<TaskPool>(
+      this->serverConfig.WorkerThreadCount(),
+      cpus(this->serverConfig.WorkerCpus()));
+  this->entityCompMgr.SetTaskPool(this->taskPool.get());
+  this->entityCompMgr.SetDeterministic(this->serverConfig.Deterministic());
+
+  this->worldName = _source.worldName;
+  this->systemLoader = _source.systemLoader;
+  this->stepSize = _source.stepSize;
+  this->desiredRtf = _source.desiredRtf;
+  this->updatePeriod = _source.updatePeriod;
+  this->fuelUriMap = _source.fuelUriMap;
+  this->guiMsg = _source.guiMsg;
+
+  this->pauseConn = this->eventMgr.Connect<events::Pause>(
+      std::bind(&SimulationRunner::SetPaused, this, std::placeholders::_1));
+
+  this->stopConn = this->eventMgr.Connect<events::Stop>(
+      std::bind(&SimulationRunner::OnStop, this));
+
+  this->loadPluginsConn = this->eventMgr.Connect<events::LoadPlugins>(
+      std::bind(&SimulationRunner::LoadPlugins, this, std::placeholders::_1,
+      std::placeholders::_2));
+
+  // Share the components of the source, and continue from its current time.
+  this->entityCompMgr.Fork(_source.entityCompMgr);
+  this->levelMgr = std::make_unique<LevelManager>(this, *_source.levelMgr);
+  this->currentInfo = _source.currentInfo;
+
+  // Load the same plugins, configured with the forked entities. Logging
+  // plugins would write to or read from the same files as the source.
+  const std::string recordName = this->serverConfig.LogRecordPlugin().Name();
+  const std::string playbackName =
+      this->serverConfig.LogPlaybackPlugin().Name();
+  for (const auto &plugin : _source.loadedPlugins)
+  {
+    if (plugin.name == recordName || plugin.name == playbackName)
+      continue;
+    this->LoadPlugin(plugin.entity, plugin.filename, plugin.name, plugin.sdf);
+  }
 
-  auto validNs = transport::TopicUtils::AsValidTopic(ns);
+  this->AdvertiseServices("/world/" + this->worldName + "/fork_" +
+      std::to_string(_forkId));
+
+  ignmsg << "World [" << this->worldName << "] forked at iteration ["
+         << this->currentInfo.iterations << "] with ["
+         << this->loadedPlugins.size() << "] plugins." << std::endl;
+}
+
+//////////////////////////////////////////////////
+void SimulationRunner::AdvertiseServices(const std::string &_namespace)
+{
+  transport::NodeOptions opts;
+  auto validNs = transport::TopicUtils::AsValidTopic(_namespace);
   if (validNs.empty())
   {
-    ignerr << "Invalid namespace [" << ns
+    ignerr << "Invalid namespace [" << _namespace
            << "], not initializing runner transport." << std::endl;
     return;
   }
@@ -202,35 +418,57 @@ SimulationRunner::SimulationRunner(const sdf::World *_world,
          << "/control] and [" << opts.NameSpace() << "/playback/control]"
          << std::endl;
 
-  // Publish empty GUI messages for worlds that have no GUI in the beginning.
-  // In the future, support modifying GUI from the server at runtime.
-  if (_world->Gui())
-  {
-    this->guiMsg = convert<msgs::GUI>(*_world->Gui());
-  }
-
   std::string infoService{"gui/info"};
   this->node->Advertise(infoService, &SimulationRunner::GuiInfoService, this);
 
   ignmsg << "Serving GUI information on [" << opts.NameSpace() << "/"
          << infoService << "]" << std::endl;
 
-  ignmsg << "World [" << _world->Name() << "] initialized with ["
-         << physics->Name() << "] physics profile." << std::endl;
-
   std::string genWorldSdfService{"generate_world_sdf"};
   this->node->Advertise(
       genWorldSdfService, &SimulationRunner::GenerateWorldSdf, this);
 
   ignmsg << "Serving world SDF generation service on [" << opts.NameSpace()
          << "/" << genWorldSdfService << "]" << std::endl;
+
+  std::string memoryUsageService{"memory_usage"};
+  this->node->Advertise(
+      memoryUsageService, &SimulationRunner::MemoryUsageService, this);
+
+  ignmsg << "Serving ECM memory usage on [" << opts.NameSpace() << "/"
+         << memoryUsageService << "]" << std::endl;
+
+  std::string systemStatsService{"system_stats"};
+  this->node->Advertise(
+      systemStatsService, &SimulationRunner::SystemStatsService, this);
+  this->systemStatsPub =
+      this->node->Advertise<msgs::Param_V>(systemStatsService);
+
+  ignmsg << "Serving system timing statistics on [" << opts.NameSpace()
+         << "/" << systemStatsService << "]" << std::endl;
+
+  std::string stepMetricsService{"step_metrics"};
+  this->node->Advertise(
+      stepMetricsService, &SimulationRunner::StepMetricsService, this);
+  this->stepMetricsPub =
+      this->node->Advertise<msgs::Param_V>(stepMetricsService);
+
+  ignmsg << "Serving step metrics on [" << opts.NameSpace() << "/"
+         << stepMetricsService << "]" << std::endl;
+
+  if (this->traceRecorder)
+  {
+    std::string traceService{"trace"};
+    this->node->Advertise(traceService, &SimulationRunner::TraceService,
+        this);
+
+    ignmsg << "Serving trace requests on [" << opts.NameSpace() << "/"
+           << traceService << "]" << std::endl;
+  }
 }
 
 //////////////////////////////////////////////////
-SimulationRunner::~SimulationRunner()
-{
-  this->StopWorkerThreads();
-}
+SimulationRunner::~SimulationRunner() = default;
 
 /////////////////////////////////////////////////
 void SimulationRunner::UpdateCurrentInfo()
@@ -422,120 +660,295 @@ void SimulationRunner::PublishStats()
 }
 
 /////////////////////////////////////////////////
-void SimulationRunner::AddSystem(const SystemPluginPtr &_system)
+void SimulationRunner::AddSystem(const SystemPluginPtr &_system,
+    const std::chrono::steady_clock::duration &_updatePeriod,
+    const std::string &_name)
 {
   std::lock_guard<std::mutex> lock(this->pendingSystemsMutex);
-  this->pendingSystems.push_back(_system);
+  this->pendingSystems.push_back({_system, _updatePeriod, _name});
 }
 
 /////////////////////////////////////////////////
-void SimulationRunner::AddSystemToRunner(const SystemPluginPtr &_system)
+void SimulationRunner::AddSystemToRunner(const SystemPluginPtr &_system,
+    const std::chrono::steady_clock::duration &_updatePeriod,
+    const std::string &_name)
 {
   this->systems.push_back(SystemInternal(_system));
+  const std::size_t index = this->systems.size() - 1;
+
+  auto &system = this->systems.back();
+  system.name = _name.empty() ? "system_" + std::to_string(index) : _name;
+  if (this->traceRecorder)
+    system.traceName = this->traceRecorder->Intern(system.name);
+  system.updatePeriod = std::max(_updatePeriod,
+      std::chrono::steady_clock::duration::zero());
+  this->hasUpdatePeriods |= system.updatePeriod > 0ns;
 
-  const auto &system = this->systems.back();
+  std::optional<ComponentAccess> access;
+  if (system.access)
+    access = system.access->Access(this->entityCompMgr);
 
   if (system.preupdate)
-    this->systemsPreupdate.push_back(system.preupdate);
+  {
+    this->systemsPreupdate.push_back(index);
+    this->preupdateAccess.push_back(access);
+  }
 
   if (system.update)
-    this->systemsUpdate.push_back(system.update);
+  {
+    this->systemsUpdate.push_back(index);
+    this->updateAccess.push_back(access);
+  }
+
+  this->systemStagesDirty = true;
 
   if (system.postupdate)
-    this->systemsPostupdate.push_back(system.postupdate);
+    this->systemsPostupdate.push_back(index);
 }
 
 /////////////////////////////////////////////////
 void SimulationRunner::ProcessSystemQueue()
 {
   std::lock_guard<std::mutex> lock(this->pendingSystemsMutex);
-  auto pending = this->pendingSystems.size();
+  this->pendingSystemsQueued = std::max(this->pendingSystemsQueued,
+      this->pendingSystems.size());
+  for (const auto &pending : this->pendingSystems)
+  {
+    this->AddSystemToRunner(pending.system, pending.updatePeriod,
+        pending.name);
+  }
+
+  this->pendingSystems.clear();
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::UpdateSystems()
+{
+  IGN_PROFILE("SimulationRunner::UpdateSystems");
+  if (this->systemStagesDirty)
+    this->UpdateSystemStages();
+
+  // Storages shared with forks are copied when their components are first
+  // accessed, which must not happen from systems running at the same time.
+  for (const ComponentTypeId type : this->parallelComponentTypes)
+    this->entityCompMgr.UnshareComponents(type);
+
+  this->UpdateDueSystems();
 
-  if (pending > 0)
+  // Systems within a stage declared accesses which don't conflict, so they
+  // can run at the same time. Stages run in order. Systems which aren't due
+  // are left out before dispatching. Views are updated once before each
+  // parallel stage, instead of by the first query of each system.
   {
-    // If additional systems are to be added, stop the existing threads.
-    this->StopWorkerThreads();
+    IGN_PROFILE("PreUpdate");
+    TraceScope phaseScope(this->traceRecorder.get(), "PreUpdate");
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto &stage : this->preupdateStages)
+    {
+      const auto &due = this->DueSystems(stage);
+      auto preupdate = [&](std::size_t _i)
+      {
+        auto &system = this->systems[due[_i]];
+        TraceScope scope(this->traceRecorder.get(), "PreUpdate",
+            system.traceName);
+        system.iterationTime[0] = timed(system.preupdateTime, [&]
+            {
+              system.preupdate->PreUpdate(system.info, this->entityCompMgr);
+            });
+      };
+      if (due.size() == 1)
+      {
+        preupdate(0);
+        continue;
+      }
+      this->entityCompMgr.SetConcurrent(true);
+      this->taskPool->ParallelFor(due.size(), preupdate);
+      this->entityCompMgr.SetConcurrent(false);
+    }
+    this->stepPhaseTimes[0] = std::chrono::steady_clock::now() - start;
+    this->preupdatePhaseTime.Add(this->stepPhaseTimes[0]);
   }
 
-  for (const auto &system : this->pendingSystems)
+  // Link states reflect the last physics step until the Update systems run
+  // again.
+  this->entityCompMgr.InvalidateLinkStates();
+
   {
-    this->AddSystemToRunner(system);
+    IGN_PROFILE("Update");
+    TraceScope phaseScope(this->traceRecorder.get(), "Update");
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto &stage : this->updateStages)
+    {
+      const auto &due = this->DueSystems(stage);
+      auto update = [&](std::size_t _i)
+      {
+        auto &system = this->systems[due[_i]];
+        TraceScope scope(this->traceRecorder.get(), "Update",
+            system.traceName);
+        system.iterationTime[1] = timed(system.updateTime, [&]
+            {
+              system.update->Update(system.info, this->entityCompMgr);
+            });
+      };
+      if (due.size() == 1)
+      {
+        update(0);
+        continue;
+      }
+      this->entityCompMgr.SetConcurrent(true);
+      this->taskPool->ParallelFor(due.size(), update);
+      this->entityCompMgr.SetConcurrent(false);
+    }
+    this->stepPhaseTimes[1] = std::chrono::steady_clock::now() - start;
+    this->updatePhaseTime.Add(this->stepPhaseTimes[1]);
   }
 
-  this->pendingSystems.clear();
+  // Poses and the entity tree don't change while PostUpdate systems run, so
+  // world poses and static subtrees are computed once for all of them.
+  this->stepPhaseTimes[2] = timed(this->worldStateTime, [&]
+      {
+        TraceScope scope(this->traceRecorder.get(), "UpdateWorldState");
+        this->entityCompMgr.UpdateWorldPoses();
+        this->entityCompMgr.UpdateLinkStates();
+        this->entityCompMgr.UpdateStaticEntities();
+      });
 
-  // If additional systems were added, recreate the worker threads.
-  if (pending > 0)
   {
-    igndbg << "Creating PostUpdate worker threads: "
-      << this->systemsPostupdate.size() + 1 << std::endl;
+    IGN_PROFILE("PostUpdate");
+    TraceScope phaseScope(this->traceRecorder.get(), "PostUpdate");
+    // PostUpdate systems only get read access to the ECM, so they can run
+    // concurrently as tasks on the worker pool.
+    // Nothing writes to the ECM meanwhile, so its queries skip locking.
+    this->entityCompMgr.SetReadOnly(true);
+    const EntityComponentManager &ecm = this->entityCompMgr;
+    const auto &due = this->DueSystems(this->systemsPostupdate);
+    const auto start = std::chrono::steady_clock::now();
+    this->taskPool->ParallelFor(due.size(), [&](std::size_t _index)
+        {
+          auto &system = this->systems[due[_index]];
+          TraceScope scope(this->traceRecorder.get(), "PostUpdate",
+              system.traceName);
+          system.iterationTime[2] = timed(system.postupdateTime, [&]
+              {
+                system.postupdate->PostUpdate(system.info, ecm);
+              });
+        });
+    this->stepPhaseTimes[3] = std::chrono::steady_clock::now() - start;
+    this->postupdatePhaseTime.Add(this->stepPhaseTimes[3]);
+    this->entityCompMgr.SetReadOnly(false);
+  }
+  this->entityCompMgr.InvalidateWorldPoses();
 
-    this->postUpdateStartBarrier =
-      std::make_unique<Barrier>(this->systemsPostupdate.size() + 1);
-    this->postUpdateStopBarrier =
-      std::make_unique<Barrier>(this->systemsPostupdate.size() + 1);
+  this->UpdateSystemStats();
+}
 
-    this->postUpdateThreadsRunning = true;
-    int id = 0;
+/////////////////////////////////////////////////
+void SimulationRunner::UpdateDueSystems()
+{
+  const auto simTime = this->currentInfo.simTime;
+  for (auto &system : this->systems)
+  {
+    system.info = this->currentInfo;
+    system.iterationTime.fill(0ns);
+    if (system.updatePeriod <= 0ns)
+      continue;
+
+    // Sim time doesn't advance while paused, so throttled systems get the
+    // paused steps like the others, without moving their schedule.
+    if (this->currentInfo.paused)
+    {
+      system.due = true;
+      continue;
+    }
 
-    for (auto &system : this->systemsPostupdate)
+    // Jumping back in time, such as when rewinding, restarts the schedule
+    if (simTime < system.lastUpdate)
     {
-      igndbg << "Creating postupdate worker thread (" << id << ")" << std::endl;
+      system.nextUpdate = simTime;
+      system.lastUpdate = std::chrono::steady_clock::duration{-1};
+    }
 
-      this->postUpdateThreads.push_back(std::thread([&, id]()
-      {
-        std::stringstream ss;
-        ss << "PostUpdateThread: " << id;
-        IGN_PROFILE_THREAD_NAME(ss.str().c_str());
-        while (this->postUpdateThreadsRunning)
-        {
-          this->postUpdateStartBarrier->Wait();
-          if (this->postUpdateThreadsRunning)
-          {
-            system->PostUpdate(this->currentInfo, this->entityCompMgr);
-          }
-          this->postUpdateStopBarrier->Wait();
-        }
-        igndbg << "Exiting postupdate worker thread ("
-          << id << ")" << std::endl;
-      }));
-      id++;
+    system.due = simTime >= system.nextUpdate;
+    if (!system.due)
+      continue;
+
+    // The system gets the sim time since its last call. Later calls keep to
+    // the period of the first one, unless the system fell behind more than
+    // a period.
+    if (system.lastUpdate >= 0ns)
+    {
+      system.info.dt = simTime - system.lastUpdate;
+      system.nextUpdate += system.updatePeriod;
     }
+    if (system.nextUpdate <= simTime)
+      system.nextUpdate = simTime + system.updatePeriod;
+    system.lastUpdate = simTime;
   }
 }
 
 /////////////////////////////////////////////////
-void SimulationRunner::UpdateSystems()
+const std::vector<std::size_t> &SimulationRunner::DueSystems(
+    const std::vector<std::size_t> &_systems)
 {
-  IGN_PROFILE("SimulationRunner::UpdateSystems");
-  // \todo(nkoenig)  Systems used to be updated in parallel using
-  // an ignition::common::WorkerPool. There is overhead associated with
-  // this, most notably the creation and destruction of WorkOrders (see
-  // WorkerPool.cc). We could turn on parallel updates in the future, and/or
-  // turn it on if there are sufficient systems. More testing is required.
+  if (!this->hasUpdatePeriods)
+    return _systems;
 
+  this->dueSystems.clear();
+  for (const std::size_t index : _systems)
   {
-    IGN_PROFILE("PreUpdate");
-    for (auto& system : this->systemsPreupdate)
-      system->PreUpdate(this->currentInfo, this->entityCompMgr);
+    if (this->systems[index].due)
+      this->dueSystems.push_back(index);
   }
+  return this->dueSystems;
+}
 
-  {
-    IGN_PROFILE("Update");
-    for (auto& system : this->systemsUpdate)
-      system->Update(this->currentInfo, this->entityCompMgr);
-  }
+/////////////////////////////////////////////////
+void SimulationRunner::UpdateSystemStages()
+{
+  IGN_PROFILE("SimulationRunner::UpdateSystemStages");
+  this->systemStagesDirty = false;
 
+  // Component types accessed by systems which run at the same time.
+  this->parallelComponentTypes.clear();
+  auto addParallelTypes = [this](const std::vector<std::size_t> &_stage,
+      const std::vector<std::optional<ComponentAccess>> &_access)
   {
-    IGN_PROFILE("PostUpdate");
-    // If no systems implementing PostUpdate have been added, then
-    // the barriers will be uninitialized, so guard against that condition.
-    if (this->postUpdateStartBarrier && this->postUpdateStopBarrier)
+    if (_stage.size() < 2)
+      return;
+    for (const std::size_t i : _stage)
     {
-      this->postUpdateStartBarrier->Wait();
-      this->postUpdateStopBarrier->Wait();
+      this->parallelComponentTypes.insert(_access[i]->reads.begin(),
+          _access[i]->reads.end());
+      this->parallelComponentTypes.insert(_access[i]->writes.begin(),
+          _access[i]->writes.end());
     }
+  };
+
+  this->preupdateStages.clear();
+  for (const auto &stage :
+      ComputeSystemStages(this->preupdateAccess, this->entityCompMgr))
+  {
+    this->preupdateStages.emplace_back();
+    for (const std::size_t i : stage)
+      this->preupdateStages.back().push_back(this->systemsPreupdate[i]);
+    addParallelTypes(stage, this->preupdateAccess);
+  }
+
+  this->updateStages.clear();
+  for (const auto &stage :
+      ComputeSystemStages(this->updateAccess, this->entityCompMgr))
+  {
+    this->updateStages.emplace_back();
+    for (const std::size_t i : stage)
+      this->updateStages.back().push_back(this->systemsUpdate[i]);
+    addParallelTypes(stage, this->updateAccess);
   }
+
+  igndbg << "Running [" << this->systemsPreupdate.size()
+         << "] PreUpdate systems in [" << this->preupdateStages.size()
+         << "] stages and [" << this->systemsUpdate.size()
+         << "] Update systems in [" << this->updateStages.size()
+         << "] stages." << std::endl;
 }
 
 /////////////////////////////////////////////////
@@ -551,25 +964,6 @@ void SimulationRunner::OnStop()
   this->running = false;
 }
 
-/////////////////////////////////////////////////
-void SimulationRunner::StopWorkerThreads()
-{
-  this->postUpdateThreadsRunning = false;
-  if (this->postUpdateStartBarrier)
-  {
-    this->postUpdateStartBarrier->Cancel();
-  }
-  if (this->postUpdateStopBarrier)
-  {
-    this->postUpdateStopBarrier->Cancel();
-  }
-  for (auto &thread : this->postUpdateThreads)
-  {
-    thread.join();
-  }
-  this->postUpdateThreads.clear();
-}
-
 /////////////////////////////////////////////////
 bool SimulationRunner::Run(const uint64_t _iterations)
 {
@@ -580,6 +974,8 @@ bool SimulationRunner::Run(const uint64_t _iterations)
   // in the design.
   IGN_PROFILE_THREAD_NAME("SimulationRunner");
 
+  ScopedAffinity affinity(cpus(this->serverConfig.SimulationCpus()));
+
   // Initialize network communications.
   if (this->networkMgr)
   {
@@ -695,13 +1091,22 @@ bool SimulationRunner::Run(const uint64_t _iterations)
     this->UpdatePhysicsParams();
 
     // Compute the time to sleep in order to match, as closely as possible,
-    // the update period.
+    // the update period. Hybrid pacing wakes up early and spins for the
+    // rest of the period. Max throughput mode never waits.
     sleepTime = 0ns;
     actualSleep = 0ns;
+    const bool pace = !this->serverConfig.MaxThroughput();
+    const bool spin = pace && this->serverConfig.Pacing() ==
+        ServerConfig::PacingStrategy::Hybrid;
+    const auto dueTime = this->prevUpdateRealTime + this->updatePeriod;
 
-    sleepTime = std::max(0ns, this->prevUpdateRealTime +
-        this->updatePeriod - std::chrono::steady_clock::now() -
-        this->sleepOffset);
+    if (pace)
+    {
+      const std::chrono::steady_clock::duration spinTime =
+          spin ? this->serverConfig.PacingSpinTime() : 0ns;
+      sleepTime = std::max(0ns, dueTime - spinTime -
+          std::chrono::steady_clock::now() - this->sleepOffset);
+    }
 
     // Only sleep if needed.
     if (sleepTime > 0ns)
@@ -720,6 +1125,22 @@ bool SimulationRunner::Run(const uint64_t _iterations)
       std::chrono::duration_cast<std::chrono::nanoseconds>(
           (actualSleep - sleepTime) * 0.01 + this->sleepOffset * 0.99);
 
+    if (spin)
+    {
+      IGN_PROFILE("Spin");
+      while (std::chrono::steady_clock::now() < dueTime)
+      {
+      }
+    }
+
+    if (pace)
+      this->UpdateJitter(dueTime);
+
+    // Take and restore snapshots between iterations, while sim time still
+    // matches the state of the entities.
+    this->ProcessSnapshotRequests();
+    this->ProcessWorldSdfRequests();
+
     // Update time information. This will update the iteration count, RTF,
     // and other values.
     this->UpdateCurrentInfo();
@@ -754,17 +1175,44 @@ bool SimulationRunner::Run(const uint64_t _iterations)
   return true;
 }
 
+/////////////////////////////////////////////////
+void SimulationRunner::BatchStep()
+{
+  IGN_PROFILE("SimulationRunner::BatchStep");
+
+  if (!this->realTimeWatch.Running())
+    this->realTimeWatch.Start();
+
+  this->UpdatePhysicsParams();
+  this->ProcessSnapshotRequests();
+  this->ProcessWorldSdfRequests();
+  this->UpdateCurrentInfo();
+  this->Step(this->currentInfo);
+}
+
 /////////////////////////////////////////////////
 void SimulationRunner::Step(const UpdateInfo &_info)
 {
   IGN_PROFILE("SimulationRunner::Step");
   this->currentInfo = _info;
 
-  // Publish info
-  this->PublishStats();
+  // Temporaries of the previous iteration are gone
+  this->entityCompMgr.ResetStepMemory();
+
+  // Publish info. In max throughput mode, this only happens once per stats
+  // period.
+  if (!this->serverConfig.MaxThroughput())
+    this->PublishStats();
+  this->UpdateThroughput();
 
   // Record when the update step starts.
   this->prevUpdateRealTime = std::chrono::steady_clock::now();
+  int64_t traceStart{0};
+  if (this->traceRecorder)
+  {
+    this->traceRecorder->SetIteration(this->currentInfo.iterations);
+    traceStart = this->traceRecorder->Now();
+  }
 
   this->levelMgr->UpdateLevelsState();
 
@@ -774,6 +1222,19 @@ void SimulationRunner::Step(const UpdateInfo &_info)
   // Update all the systems.
   this->UpdateSystems();
 
+  // Models were stopped by a restored snapshot during this update, their
+  // velocity commands would keep them from moving from now on.
+  for (const Entity entity : this->snapshotVelocityCmds)
+  {
+    this->entityCompMgr.RemoveComponent<components::LinearVelocityCmd>(
+        entity);
+    this->entityCompMgr.RemoveComponent<components::AngularVelocityCmd>(
+        entity);
+  }
+  this->snapshotVelocityCmds.clear();
+
+  this->UpdateMemoryUsage();
+
   if (!this->Paused() &&
        this->requestedRunToSimTime >
        std::chrono::steady_clock::duration::zero() &&
@@ -796,13 +1257,18 @@ void SimulationRunner::Step(const UpdateInfo &_info)
   }
 
   // Process world control messages.
-  this->ProcessMessages();
+  this->stepPhaseTimes[4] = timed(this->messagesTime, [&]
+      {
+        TraceScope scope(this->traceRecorder.get(), "ProcessMessages");
+        this->ProcessMessages();
+      });
 
   // Clear all new entities
   this->entityCompMgr.ClearNewlyCreatedEntities();
 
-  // Process entity removals.
+  // Process entity removals, and reclaim the storage of earlier ones.
   this->entityCompMgr.ProcessRemoveEntityRequests();
+  this->entityCompMgr.CompactComponentStorage();
 
   // Process components removals
   this->entityCompMgr.ClearRemovedComponents();
@@ -810,6 +1276,23 @@ void SimulationRunner::Step(const UpdateInfo &_info)
   // Each network manager takes care of marking its components as unchanged
   if (!this->networkMgr)
     this->entityCompMgr.SetAllComponentsUnchanged();
+
+  const auto stepDuration = std::chrono::steady_clock::now() -
+      this->prevUpdateRealTime;
+  this->stepTime.Add(stepDuration);
+  const uint64_t levelTransitions = this->levelMgr->Transitions();
+  if (levelTransitions != this->levelTransitions)
+  {
+    this->levelTransitionTime.Add(stepDuration);
+    this->levelTransitions = levelTransitions;
+  }
+  this->UpdateStepMetrics();
+  this->ReportStartup(stepDuration);
+
+  // The iteration is recorded before its trace may be written
+  if (this->traceRecorder)
+    this->traceRecorder->Record("Step", nullptr, traceStart);
+  this->UpdateTrace(stepDuration);
 }
 
 //////////////////////////////////////////////////
@@ -818,24 +1301,57 @@ void SimulationRunner::LoadPlugin(const Entity _entity,
                                   const std::string &_name,
                                   const sdf::ElementPtr &_sdf)
 {
+  // There's no GUI to broadcast the scene to in max throughput mode
+  if (this->serverConfig.MaxThroughput() &&
+      _name == "ignition::gazebo::systems::SceneBroadcaster")
+  {
+    igndbg << "Skipping [" << _name << "] in max throughput mode."
+           << std::endl;
+    return;
+  }
+
   std::optional<SystemPluginPtr> system;
   {
+    StartupScope pluginsScope(StartupScope::Current(), "plugins");
     std::lock_guard<std::mutex> lock(this->systemLoaderMutex);
     system = this->systemLoader->LoadPlugin(_fname, _name, _sdf);
+    if (system)
+      this->loadedPlugins.push_back({_entity, _fname, _name, _sdf});
   }
 
   // System correctly loaded from library, try to configure
   if (system)
   {
+    // The custom `ignition:update_rate` attribute of the plugin element sets
+    // how often the system runs, in Hz of sim time
+    std::chrono::steady_clock::duration updatePeriod{0};
+    if (_sdf && _sdf->HasAttribute("ignition:update_rate"))
+    {
+      double rate{0.0};
+      if (_sdf->GetAttribute("ignition:update_rate")->Get<double>(rate) &&
+          rate > 0.0)
+      {
+        updatePeriod =
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / rate));
+      }
+      else
+      {
+        ignerr << "Invalid update rate for system [" << _name
+               << "], it will run on every iteration." << std::endl;
+      }
+    }
+
     auto systemConfig = system.value()->QueryInterface<ISystemConfigure>();
     if (systemConfig != nullptr)
     {
+      StartupScope configureScope(StartupScope::Current(), "configure");
       systemConfig->Configure(_entity, _sdf,
           this->entityCompMgr,
           this->eventMgr);
     }
 
-    this->AddSystem(system.value());
+    this->AddSystem(system.value(), updatePeriod, _name);
     igndbg << "Loaded system [" << _name
            << "] for entity [" << _entity << "]" << std::endl;
   }
@@ -1060,8 +1576,6 @@ void SimulationRunner::SetRunToSimTime(
 bool SimulationRunner::OnWorldControl(const msgs::WorldControl &_req,
     msgs::Boolean &_res)
 {
-  std::lock_guard<std::mutex> lock(this->msgBufferMutex);
-
   WorldControl control;
   control.pause = _req.pause();
 
@@ -1091,7 +1605,7 @@ bool SimulationRunner::OnWorldControl(const msgs::WorldControl &_req,
                    std::chrono::nanoseconds(_req.run_to_sim_time().nsec());
   }
 
-  this->worldControls.push_back(control);
+  this->worldControls.Push(control);
 
   _res.set_data(true);
   return true;
@@ -1101,8 +1615,6 @@ bool SimulationRunner::OnWorldControl(const msgs::WorldControl &_req,
 bool SimulationRunner::OnPlaybackControl(const msgs::LogPlaybackControl &_req,
     msgs::Boolean &_res)
 {
-  std::lock_guard<std::mutex> lock(this->msgBufferMutex);
-
   WorldControl control;
   control.pause = _req.pause();
   control.multiStep = _req.multi_step();
@@ -1119,7 +1631,7 @@ bool SimulationRunner::OnPlaybackControl(const msgs::LogPlaybackControl &_req,
     ignwarn << "Log forwarding is not supported, use seek." << std::endl;
   }
 
-  this->worldControls.push_back(control);
+  this->worldControls.Push(control);
 
   _res.set_data(true);
   return true;
@@ -1129,7 +1641,6 @@ bool SimulationRunner::OnPlaybackControl(const msgs::LogPlaybackControl &_req,
 void SimulationRunner::ProcessMessages()
 {
   IGN_PROFILE("SimulationRunner::ProcessMessages");
-  std::lock_guard<std::mutex> lock(this->msgBufferMutex);
   this->ProcessWorldControl();
 }
 
@@ -1137,32 +1648,256 @@ void SimulationRunner::ProcessMessages()
 void SimulationRunner::ProcessWorldControl()
 {
   IGN_PROFILE("SimulationRunner::ProcessWorldControl");
-  for (const auto &control : this->worldControls)
+  // Requests are applied in the order they were received
+  auto apply = [this](const WorldControl &_control)
   {
     // Play / pause
-    this->SetPaused(control.pause);
+    this->SetPaused(_control.pause);
 
     // Step, only if we are paused.
-    if (this->Paused() && control.multiStep > 0)
+    if (this->Paused() && _control.multiStep > 0)
     {
-      this->pendingSimIterations += control.multiStep;
+      this->pendingSimIterations += _control.multiStep;
       // Unpause so that stepping can occur.
       this->SetPaused(false);
     }
 
     // Rewind / reset
-    this->requestedRewind = control.rewind;
+    this->requestedRewind = _control.rewind;
 
     // Seek
-    if (control.seek >= std::chrono::steady_clock::duration::zero())
+    if (_control.seek >= std::chrono::steady_clock::duration::zero())
+    {
+      this->requestedSeek = _control.seek;
+    }
+
+    this->SetRunToSimTime(_control.runToSimTime);
+  };
+  const std::size_t queued = this->worldControls.Drain(apply);
+  this->worldControlQueued = std::max(this->worldControlQueued, queued);
+}
+
+/////////////////////////////////////////////////
+std::optional<uint64_t> SimulationRunner::SaveSnapshot()
+{
+  if (this->networkMgr)
+  {
+    ignerr << "Snapshots aren't supported by distributed simulation."
+           << std::endl;
+    return std::nullopt;
+  }
+
+  std::lock_guard<std::mutex> lock(this->snapshotMutex);
+  const uint64_t id = this->nextSnapshotId++;
+  this->snapshotIds.insert(id);
+  this->snapshotRequests.emplace_back(SnapshotOp::SAVE, id);
+  return id;
+}
+
+/////////////////////////////////////////////////
+bool SimulationRunner::RestoreSnapshot(uint64_t _id)
+{
+  std::lock_guard<std::mutex> lock(this->snapshotMutex);
+  if (this->snapshotIds.find(_id) == this->snapshotIds.end())
+  {
+    ignerr << "Failed to restore snapshot [" << _id << "], it doesn't exist."
+           << std::endl;
+    return false;
+  }
+
+  this->snapshotRequests.emplace_back(SnapshotOp::RESTORE, _id);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool SimulationRunner::RemoveSnapshot(uint64_t _id)
+{
+  std::lock_guard<std::mutex> lock(this->snapshotMutex);
+  if (this->snapshotIds.erase(_id) == 0)
+  {
+    ignerr << "Failed to remove snapshot [" << _id << "], it doesn't exist."
+           << std::endl;
+    return false;
+  }
+
+  this->snapshotRequests.emplace_back(SnapshotOp::REMOVE, _id);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::ProcessSnapshotRequests()
+{
+  std::vector<std::pair<SnapshotOp, uint64_t>> requests;
+  {
+    std::lock_guard<std::mutex> lock(this->snapshotMutex);
+    requests.swap(this->snapshotRequests);
+  }
+  if (requests.empty())
+    return;
+
+  IGN_PROFILE("SimulationRunner::ProcessSnapshotRequests");
+  for (const auto &request : requests)
+  {
+    switch (request.first)
     {
-      this->requestedSeek = control.seek;
+      case SnapshotOp::SAVE:
+      {
+        auto &snapshot = this->snapshots[request.second];
+        snapshot.state = this->entityCompMgr.CopyState();
+        snapshot.simTime = this->currentInfo.simTime;
+        snapshot.iterations = this->currentInfo.iterations;
+        break;
+      }
+      case SnapshotOp::RESTORE:
+      {
+        auto iter = this->snapshots.find(request.second);
+        if (iter != this->snapshots.end())
+          this->ApplySnapshot(iter->second);
+        break;
+      }
+      case SnapshotOp::REMOVE:
+        this->snapshots.erase(request.second);
+        break;
     }
+  }
+}
 
-    this->SetRunToSimTime(control.runToSimTime);
+/////////////////////////////////////////////////
+void SimulationRunner::ApplySnapshot(const WorldSnapshot &_snapshot)
+{
+  IGN_PROFILE("SimulationRunner::ApplySnapshot");
+  auto &ecm = this->entityCompMgr;
+
+  // Copy the snapshot, so it can be restored again. Components added since
+  // the snapshot was taken are removed.
+  DeserializedState state;
+  state.oneTimeChanges = _snapshot.state.oneTimeChanges;
+  state.entities.reserve(_snapshot.state.entities.size());
+  std::unordered_set<Entity> inSnapshot;
+  for (const auto &entity : _snapshot.state.entities)
+  {
+    inSnapshot.insert(entity.id);
+
+    state.entities.emplace_back();
+    auto &copy = state.entities.back();
+    copy.id = entity.id;
+    copy.remove = entity.remove;
+    copy.components.reserve(entity.components.size());
+
+    std::unordered_set<ComponentTypeId> types;
+    for (const auto &comp : entity.components)
+    {
+      types.insert(comp->TypeId());
+      copy.components.push_back(comp->Clone());
+    }
+
+    if (ecm.HasEntity(entity.id))
+    {
+      for (const ComponentTypeId type : ecm.ComponentTypes(entity.id))
+      {
+        if (types.find(type) == types.end())
+          copy.removedComponents.push_back(type);
+      }
+    }
   }
 
-  this->worldControls.clear();
+  // Entities created since the snapshot was taken are removed
+  std::vector<Entity> created;
+  for (const auto &vertex : ecm.Entities().Vertices())
+  {
+    if (inSnapshot.find(vertex.first) == inSnapshot.end())
+      created.push_back(vertex.first);
+  }
+
+  ecm.SetState(std::move(state));
+  for (const Entity entity : created)
+    ecm.RequestRemoveEntity(entity, false);
+
+  // Entities removed since the snapshot was taken are created again without
+  // a parent
+  std::vector<std::pair<Entity, Entity>> parents;
+  ecm.Each<components::ParentEntity>(
+      [&](const Entity &_entity, const components::ParentEntity *_parent)
+      {
+        if (ecm.ParentEntity(_entity) != _parent->Data())
+          parents.emplace_back(_entity, _parent->Data());
+        return true;
+      });
+  for (const auto &parent : parents)
+    ecm.SetParentEntity(parent.first, parent.second);
+
+  // The physics engine keeps its own copy of the state, which is reset
+  // through commands. Top level models are moved back and stopped, unless
+  // the snapshot has velocity commands of its own, and joints are moved
+  // back.
+  const Entity worldEntity = ecm.EntityByComponents(components::World());
+  std::vector<std::pair<Entity, math::Pose3d>> poses;
+  std::vector<Entity> toStop;
+  ecm.Each<components::Model, components::Pose, components::ParentEntity>(
+      [&](const Entity &_entity, const components::Model *,
+          const components::Pose *_pose,
+          const components::ParentEntity *_parent)
+      {
+        if (_parent->Data() != worldEntity)
+          return true;
+
+        poses.emplace_back(_entity, _pose->Data());
+
+        auto staticComp = ecm.Component<components::Static>(_entity);
+        if ((nullptr == staticComp || !staticComp->Data()) &&
+            nullptr == ecm.Component<components::LinearVelocityCmd>(_entity)
+            && nullptr ==
+            ecm.Component<components::AngularVelocityCmd>(_entity))
+        {
+          toStop.push_back(_entity);
+        }
+        return true;
+      });
+
+  std::vector<std::pair<Entity, std::vector<double>>> jointPositions;
+  ecm.Each<components::JointPosition>(
+      [&](const Entity &_entity, const components::JointPosition *_pos)
+      {
+        jointPositions.emplace_back(_entity, _pos->Data());
+        return true;
+      });
+
+  std::vector<std::pair<Entity, std::vector<double>>> jointVelocities;
+  ecm.Each<components::JointVelocity>(
+      [&](const Entity &_entity, const components::JointVelocity *_vel)
+      {
+        jointVelocities.emplace_back(_entity, _vel->Data());
+        return true;
+      });
+
+  for (const auto &pose : poses)
+    ecm.SetComponentData<components::WorldPoseCmd>(pose.first, pose.second);
+  for (const Entity entity : toStop)
+  {
+    ecm.SetComponentData<components::LinearVelocityCmd>(entity,
+        math::Vector3d::Zero);
+    ecm.SetComponentData<components::AngularVelocityCmd>(entity,
+        math::Vector3d::Zero);
+  }
+  for (auto &pos : jointPositions)
+  {
+    ecm.SetComponentData<components::JointPositionReset>(pos.first,
+        std::move(pos.second));
+  }
+  for (auto &vel : jointVelocities)
+  {
+    ecm.SetComponentData<components::JointVelocityReset>(vel.first,
+        std::move(vel.second));
+  }
+  this->snapshotVelocityCmds.insert(this->snapshotVelocityCmds.end(),
+      toStop.begin(), toStop.end());
+
+  // Time goes back or forward to the snapshot, like when seeking
+  this->realTimes.clear();
+  this->simTimes.clear();
+  this->realTimeFactor = 0;
+  this->currentInfo.simTime = _snapshot.simTime;
+  this->currentInfo.iterations = _snapshot.iterations;
 }
 
 /////////////////////////////////////////////////
@@ -1177,6 +1912,18 @@ const EntityComponentManager &SimulationRunner::EntityCompMgr() const
   return this->entityCompMgr;
 }
 
+/////////////////////////////////////////////////
+double SimulationRunner::StepsPerSecond() const
+{
+  return this->stepsPerSecond;
+}
+
+/////////////////////////////////////////////////
+EntityComponentManager &SimulationRunner::EntityCompMgr()
+{
+  return this->entityCompMgr;
+}
+
 /////////////////////////////////////////////////
 EventManager &SimulationRunner::EventMgr()
 {
@@ -1288,15 +2035,465 @@ bool SimulationRunner::GuiInfoService(ignition::msgs::GUI &_res)
   return true;
 }
 
+//////////////////////////////////////////////////
+bool SimulationRunner::MemoryUsageService(msgs::Param_V &_res)
+{
+  std::lock_guard<std::mutex> lock(this->memoryUsageMutex);
+  _res.CopyFrom(this->memoryUsageMsg);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void SimulationRunner::UpdateSystemStats()
+{
+  const auto now = std::chrono::steady_clock::now();
+  if (now - this->systemStatsTime < std::chrono::seconds(1))
+    return;
+  this->systemStatsTime = now;
+
+  IGN_PROFILE("SimulationRunner::UpdateSystemStats");
+  msgs::Param_V msg;
+  for (auto &system : this->systems)
+  {
+    auto *param = msg.add_param();
+    auto &nameAny = (*param->mutable_params())["name"];
+    nameAny.set_type(msgs::Any_ValueType_STRING);
+    nameAny.set_string_value(system.name);
+
+    if (system.preupdate)
+      setHistogram(param, "preupdate", system.preupdateTime);
+    if (system.update)
+      setHistogram(param, "update", system.updateTime);
+    if (system.postupdate)
+      setHistogram(param, "postupdate", system.postupdateTime);
+  }
+
+  if (this->systemStatsPub.Valid())
+    this->systemStatsPub.Publish(msg);
+
+  std::lock_guard<std::mutex> lock(this->systemStatsMutex);
+  this->systemStatsMsg = std::move(msg);
+}
+
+//////////////////////////////////////////////////
+bool SimulationRunner::SystemStatsService(msgs::Param_V &_res)
+{
+  std::lock_guard<std::mutex> lock(this->systemStatsMutex);
+  _res.CopyFrom(this->systemStatsMsg);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void SimulationRunner::UpdateStepMetrics()
+{
+  // Metrics are only recorded by the simulation thread, so they're
+  // aggregated without locking and only copied out once per second.
+  const auto now = std::chrono::steady_clock::now();
+  if (now - this->stepMetricsTime < std::chrono::seconds(1))
+    return;
+  this->stepMetricsTime = now;
+
+  IGN_PROFILE("SimulationRunner::UpdateStepMetrics");
+  msgs::Param_V msg;
+  auto *param = msg.add_param();
+  setHistogram(param, "step", this->stepTime);
+  setHistogram(param, "preupdate", this->preupdatePhaseTime);
+  setHistogram(param, "update", this->updatePhaseTime);
+  setHistogram(param, "postupdate", this->postupdatePhaseTime);
+  setHistogram(param, "world_state", this->worldStateTime);
+  setHistogram(param, "messages", this->messagesTime);
+  setHistogram(param, "level_transition", this->levelTransitionTime);
+
+  setNumber(param, "entity_count",
+      static_cast<double>(this->entityCompMgr.EntityCount()));
+  setNumber(param, "component_count",
+      static_cast<double>(this->componentCount));
+  setNumber(param, "view_count", static_cast<double>(this->viewCount));
+
+  setNumber(param, "world_control_queued",
+      static_cast<double>(this->worldControlQueued));
+  {
+    std::lock_guard<std::mutex> lock(this->pendingSystemsMutex);
+    setNumber(param, "pending_systems",
+        static_cast<double>(this->pendingSystemsQueued));
+    this->pendingSystemsQueued = 0;
+  }
+  this->worldControlQueued = 0;
+
+  setNumber(param, "steps_per_second", this->stepsPerSecond);
+  setNumber(param, "real_time_factor", this->realTimeFactor);
+
+  if (this->networkMgr && this->networkMgr->IsPrimary())
+  {
+    auto us = [](const std::chrono::steady_clock::duration &_duration)
+    {
+      return std::chrono::duration<double, std::micro>(_duration).count();
+    };
+    const auto stats = dynamic_cast<NetworkManagerPrimary *>(
+        this->networkMgr.get())->StepStats();
+    setNumber(param, "network_steps", static_cast<double>(stats.steps));
+    setNumber(param, "network_bytes_sent",
+        static_cast<double>(stats.bytesSent));
+    setNumber(param, "network_bytes_received",
+        static_cast<double>(stats.bytesReceived));
+    setNumber(param, "network_state_bytes",
+        static_cast<double>(stats.stateBytesReceived));
+    setNumber(param, "network_resyncs", static_cast<double>(stats.resyncs));
+    setNumber(param, "network_mean_latency_us", us(stats.totalLatency) /
+        static_cast<double>(std::max<uint64_t>(stats.steps, 1)));
+    setNumber(param, "network_max_latency_us", us(stats.maxLatency));
+  }
+
+  if (this->stepMetricsPub.Valid())
+    this->stepMetricsPub.Publish(msg);
+
+  std::lock_guard<std::mutex> lock(this->stepMetricsMutex);
+  this->stepMetricsMsg = std::move(msg);
+}
+
+//////////////////////////////////////////////////
+bool SimulationRunner::StepMetricsService(msgs::Param_V &_res)
+{
+  std::lock_guard<std::mutex> lock(this->stepMetricsMutex);
+  _res.CopyFrom(this->stepMetricsMsg);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SimulationRunner::TraceService(const msgs::StringMsg &_req,
+    msgs::Boolean &_res)
+{
+  if (!this->traceRecorder || _req.data().empty())
+  {
+    _res.set_data(false);
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(this->traceMutex);
+  this->traceRequestPath = _req.data();
+  _res.set_data(true);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void SimulationRunner::UpdateTrace(
+    const std::chrono::steady_clock::duration &_stepTime)
+{
+  std::string path;
+  if (this->traceRecorder)
+  {
+    std::lock_guard<std::mutex> lock(this->traceMutex);
+    path.swap(this->traceRequestPath);
+  }
+
+  // Slow iterations are reported, but not more than once per second
+  const auto threshold = this->serverConfig.TraceSlowStepThreshold();
+  const auto now = std::chrono::steady_clock::now();
+  std::map<std::string, std::string> report;
+  if (threshold > 0ns && _stepTime > threshold &&
+      now - this->slowStepTraceTime >= std::chrono::seconds(1))
+  {
+    this->slowStepTraceTime = now;
+    report = this->SlowStepReport(_stepTime);
+
+    if (this->traceRecorder && path.empty())
+    {
+      const std::string fileName = "slow_step_" +
+          std::to_string(this->currentInfo.iterations) + ".json";
+      const std::string &dir = this->serverConfig.TracePath();
+      if (!dir.empty())
+        common::createDirectories(dir);
+      path = dir.empty() ? fileName : common::joinPaths(dir, fileName);
+    }
+
+    std::string phases;
+    for (const std::string phase : kStepPhases)
+      phases += " " + phase + " [" + report[phase + "_ms"] + "]";
+    ignwarn << "Iteration [" << report["iteration"] << "] took ["
+            << report["step_ms"] << "] ms, over the budget of ["
+            << report["budget_ms"] << "] ms. The slowest call was ["
+            << report["slowest_system"] << "] in ["
+            << report["slowest_phase"] << "] with ["
+            << report["slowest_system_ms"] << "] ms. Phases took" << phases
+            << " ms, with [" << report["entity_count"] << "] entities."
+            << (path.empty() ? "" : " Writing trace to [" + path + "].")
+            << std::endl;
+  }
+
+  if (path.empty())
+    return;
+
+  // The events are copied here, since recording continues with the next
+  // iteration, and written in the background, so the simulation isn't held
+  // up by the file.
+  if (this->traceWrite.valid())
+    this->traceWrite.wait();
+  this->traceWrite = std::async(std::launch::async,
+      [events = this->traceRecorder->Events(), name = this->worldName,
+       path, report]
+      {
+        TraceRecorder::Write(events, name, path, report);
+      });
+}
+
+//////////////////////////////////////////////////
+void SimulationRunner::ReportStartup(
+    const std::chrono::steady_clock::duration &_stepTime)
+{
+  if (!this->startupProfile)
+    return;
+
+  // The first iteration is where systems such as physics and rendering
+  // create their own representation of the world
+  this->startupProfile->AddPhase("first_iteration", _stepTime);
+  for (const auto &system : this->systems)
+  {
+    std::chrono::steady_clock::duration time{0};
+    for (const auto &phaseTime : system.iterationTime)
+      time += phaseTime;
+    this->startupProfile->AddSystem(system.name, time);
+  }
+
+  ignmsg << "Startup profile of world [" << this->worldName << "]:\n"
+         << this->startupProfile->Report();
+  this->startupProfile = nullptr;
+}
+
+//////////////////////////////////////////////////
+std::map<std::string, std::string> SimulationRunner::SlowStepReport(
+    const std::chrono::steady_clock::duration &_stepTime) const
+{
+  std::map<std::string, std::string> report;
+  report["iteration"] = std::to_string(this->currentInfo.iterations);
+  report["step_ms"] = toMs(_stepTime);
+  report["budget_ms"] = toMs(this->serverConfig.TraceSlowStepThreshold());
+  for (std::size_t i = 0; i < kStepPhases.size(); ++i)
+    report[std::string(kStepPhases[i]) + "_ms"] = toMs(this->stepPhaseTimes[i]);
+
+  // The slowest single call, systems of the same stage may have run at the
+  // same time
+  const std::array<const char *, 3> systemPhases{
+      "preupdate", "update", "postupdate"};
+  const SystemInternal *slowest{nullptr};
+  std::size_t slowestPhase{0};
+  for (const auto &system : this->systems)
+  {
+    for (std::size_t i = 0; i < system.iterationTime.size(); ++i)
+    {
+      if (!slowest || system.iterationTime[i] >
+          slowest->iterationTime[slowestPhase])
+      {
+        slowest = &system;
+        slowestPhase = i;
+      }
+    }
+  }
+  if (slowest)
+  {
+    report["slowest_system"] = slowest->name;
+    report["slowest_phase"] = systemPhases[slowestPhase];
+    report["slowest_system_ms"] =
+        toMs(slowest->iterationTime[slowestPhase]);
+  }
+
+  report["entity_count"] = std::to_string(this->entityCompMgr.EntityCount());
+  report["component_count"] = std::to_string(this->componentCount);
+  report["view_count"] = std::to_string(this->viewCount);
+  report["component_layout_generation"] =
+      std::to_string(this->entityCompMgr.ComponentLayoutGeneration());
+  return report;
+}
+
+//////////////////////////////////////////////////
+void SimulationRunner::UpdateJitter(
+    const std::chrono::steady_clock::time_point &_dueTime)
+{
+  // There's no due time before the first step
+  if (this->prevUpdateRealTime == std::chrono::steady_clock::time_point())
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+  const double lateUs =
+      std::chrono::duration<double, std::micro>(now - _dueTime).count();
+  if (lateUs > 0.0)
+  {
+    std::size_t bin = 0;
+    while (bin < kJitterBinsUs.size() && lateUs >= kJitterBinsUs[bin])
+      ++bin;
+    ++this->jitterCounts[bin];
+    this->jitterMaxUs = std::max(this->jitterMaxUs, lateUs);
+    this->jitterSumUs += lateUs;
+  }
+  else
+  {
+    ++this->jitterCounts[0];
+  }
+  ++this->jitterSteps;
+
+  if (now - this->jitterTime < std::chrono::seconds(1))
+    return;
+  this->jitterTime = now;
+
+  if (!this->jitterPub.Valid())
+    this->jitterPub = this->node->Advertise<msgs::Param_V>("step_jitter");
+
+  // Each bin counts the steps which started late by less than its upper
+  // bound, the last bin counts the rest.
+  msgs::Param_V msg;
+  auto *param = msg.add_param();
+  setNumber(param, "steps", static_cast<double>(this->jitterSteps));
+  setNumber(param, "mean_us", this->jitterSumUs / this->jitterSteps);
+  setNumber(param, "max_us", this->jitterMaxUs);
+  for (std::size_t i = 0; i < this->jitterCounts.size(); ++i)
+  {
+    const std::string key = i < kJitterBinsUs.size() ?
+        "below_" + std::to_string(static_cast<int>(kJitterBinsUs[i])) + "us" :
+        "above_" + std::to_string(static_cast<int>(kJitterBinsUs.back())) +
+        "us";
+    setNumber(param, key, static_cast<double>(this->jitterCounts[i]));
+  }
+  this->jitterPub.Publish(msg);
+
+  this->jitterCounts.fill(0);
+  this->jitterSteps = 0;
+  this->jitterSumUs = 0.0;
+  this->jitterMaxUs = 0.0;
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::UpdateThroughput()
+{
+  const auto now = std::chrono::steady_clock::now();
+  const uint64_t iterations = this->currentInfo.iterations;
+  if (this->throughputTime == std::chrono::steady_clock::time_point() ||
+      iterations < this->throughputIterations)
+  {
+    this->throughputTime = now;
+    this->throughputIterations = iterations;
+    return;
+  }
+
+  const bool maxThroughput = this->serverConfig.MaxThroughput();
+  const auto period = maxThroughput ?
+      this->serverConfig.ThroughputStatsPeriod() :
+      std::chrono::steady_clock::duration(std::chrono::seconds(1));
+  const auto elapsed = now - this->throughputTime;
+  if (elapsed < period)
+    return;
+
+  this->stepsPerSecond = static_cast<double>(iterations -
+      this->throughputIterations) /
+      std::chrono::duration<double>(elapsed).count();
+  this->throughputTime = now;
+  this->throughputIterations = iterations;
+
+  if (maxThroughput)
+  {
+    this->PublishStats();
+    ignmsg << "World [" << this->worldName << "] running at "
+           << this->stepsPerSecond << " steps/s, real time factor ["
+           << this->realTimeFactor << "]." << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+void SimulationRunner::UpdateMemoryUsage()
+{
+  // The ECM can only be read from the simulation thread, so the usage is
+  // measured here, but not more than once per second.
+  const auto now = std::chrono::steady_clock::now();
+  if (now - this->memoryUsageTime < std::chrono::seconds(1))
+    return;
+  this->memoryUsageTime = now;
+
+  IGN_PROFILE("SimulationRunner::UpdateMemoryUsage");
+  std::vector<ComponentMemoryUsage> componentUsages;
+  std::vector<ViewMemoryUsage> viewUsages;
+  this->entityCompMgr.MemoryUsage(componentUsages, viewUsages);
+
+  this->componentCount = 0;
+  for (const auto &usage : componentUsages)
+    this->componentCount += usage.count;
+  this->viewCount = viewUsages.size();
+
+  auto setString = [](msgs::Param *_param, const std::string &_key,
+      const std::string &_value)
+  {
+    auto &any = (*_param->mutable_params())[_key];
+    any.set_type(msgs::Any_ValueType_STRING);
+    any.set_string_value(_value);
+  };
+
+  msgs::Param_V msg;
+  for (const auto &usage : componentUsages)
+  {
+    auto param = msg.add_param();
+    setString(param, "kind", "component");
+    setString(param, "name", usage.name);
+    setNumber(param, "count", usage.count);
+    setNumber(param, "bytes", usage.bytes);
+    setNumber(param, "overhead", usage.overhead);
+  }
+
+  for (const auto &usage : viewUsages)
+  {
+    std::string name;
+    for (const ComponentTypeId typeId : usage.types)
+    {
+      if (!name.empty())
+        name += ",";
+      name += components::Factory::Instance()->Name(typeId);
+    }
+
+    auto param = msg.add_param();
+    setString(param, "kind", "view");
+    setString(param, "name", name);
+    setNumber(param, "count", usage.entityCount);
+    setNumber(param, "bytes", usage.bytes);
+  }
+
+  std::lock_guard<std::mutex> lock(this->memoryUsageMutex);
+  this->memoryUsageMsg = std::move(msg);
+}
+
 //////////////////////////////////////////////////
 bool SimulationRunner::GenerateWorldSdf(const msgs::SdfGeneratorConfig &_req,
                                         msgs::StringMsg &_res)
 {
-  // TODO(addisu) This is not thread-safe. Wait until it is safe to access the
-  // ECM.
-  Entity world = this->entityCompMgr.EntityByComponents(components::World());
+  std::shared_ptr<WorldSdfSource> source;
+  if (this->running)
+  {
+    // Only hold the simulation for as long as it takes to fork the ECM, the
+    // SDFormat is generated on this thread.
+    std::future<std::shared_ptr<WorldSdfSource>> future;
+    {
+      std::lock_guard<std::mutex> lock(this->worldSdfMutex);
+      this->worldSdfRequests.emplace_back();
+      future = this->worldSdfRequests.back().get_future();
+    }
+    while (this->running)
+    {
+      if (future.wait_for(std::chrono::milliseconds(100)) ==
+          std::future_status::ready)
+      {
+        source = future.get();
+        break;
+      }
+    }
+  }
+
+  // Not running, so the ECM isn't being modified
+  if (!source)
+  {
+    source = std::make_shared<WorldSdfSource>();
+    source->ecm.Fork(this->entityCompMgr);
+    source->fuelUriMap = this->fuelUriMap;
+  }
+
+  const EntityComponentManager &ecm = source->ecm;
+  Entity world = ecm.EntityByComponents(components::World());
   std::optional<std::string> genString = sdf_generator::generateWorld(
-      this->entityCompMgr, world, this->fuelUriMap, _req);
+      ecm, world, source->fuelUriMap, _req);
   if (genString.has_value())
   {
     _res.set_data(*genString);
@@ -1305,6 +2502,28 @@ bool SimulationRunner::GenerateWorldSdf(const msgs::SdfGeneratorConfig &_req,
   return false;
 }
 
+//////////////////////////////////////////////////
+void SimulationRunner::ProcessWorldSdfRequests()
+{
+  std::vector<std::promise<std::shared_ptr<WorldSdfSource>>> requests;
+  {
+    std::lock_guard<std::mutex> lock(this->worldSdfMutex);
+    requests.swap(this->worldSdfRequests);
+  }
+  if (requests.empty())
+    return;
+
+  IGN_PROFILE("SimulationRunner::ProcessWorldSdfRequests");
+
+  // Forking shares the component storages instead of copying them, and all
+  // requests made during the same iteration share one fork.
+  auto source = std::make_shared<WorldSdfSource>();
+  source->ecm.Fork(this->entityCompMgr);
+  source->fuelUriMap = this->fuelUriMap;
+  for (auto &request : requests)
+    request.set_value(source);
+}
+
 //////////////////////////////////////////////////
 void SimulationRunner::SetFuelUriMap(
     const std::unordered_map<std::string, std::string> &_map)
@@ -19,14 +19,20 @@
 
 #include <ignition/msgs/gui.pb.h>
 #include <ignition/msgs/log_playback_control.pb.h>
+#include <ignition/msgs/param_v.pb.h>
 #include <ignition/msgs/sdf_generator_config.pb.h>
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include <future>
 #include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -52,8 +58,12 @@
 #include "ignition/gazebo/Types.hh"
 
 #include "network/NetworkManager.hh"
+#include "DurationHistogram.hh"
 #include "LevelManager.hh"
-#include "Barrier.hh"
+#include "MpscQueue.hh"
+#include "StartupProfile.hh"
+#include "TaskPool.hh"
+#include "TraceRecorder.hh"
 
 using namespace std::chrono_literals;
 
@@ -93,6 +103,30 @@ namespace ignition
       std::chrono::steady_clock::duration seek{-1};
     };
 
+    /// \brief In-memory image of a world, see SimulationRunner::SaveSnapshot.
+    struct WorldSnapshot
+    {
+      /// \brief Copy of all entities and components.
+      DeserializedState state;
+
+      /// \brief Sim time when the snapshot was taken.
+      std::chrono::steady_clock::duration simTime{0};
+
+      /// \brief Iterations when the snapshot was taken.
+      uint64_t iterations{0};
+    };
+
+    /// \brief Copy of a world to generate its SDFormat representation from,
+    /// see SimulationRunner::GenerateWorldSdf.
+    struct WorldSdfSource
+    {
+      /// \brief Fork of the world's entities and components.
+      EntityComponentManager ecm;
+
+      /// \brief Map from file paths to Fuel URIs.
+      std::unordered_map<std::string, std::string> fuelUriMap;
+    };
+
     /// \brief Class to hold systems internally
     class SystemInternal
     {
@@ -102,7 +136,8 @@ namespace ignition
                 system(systemPlugin->QueryInterface<System>()),
                 preupdate(systemPlugin->QueryInterface<ISystemPreUpdate>()),
                 update(systemPlugin->QueryInterface<ISystemUpdate>()),
-                postupdate(systemPlugin->QueryInterface<ISystemPostUpdate>())
+                postupdate(systemPlugin->QueryInterface<ISystemPostUpdate>()),
+                access(systemPlugin->QueryInterface<ISystemComponentAccess>())
       {
       }
 
@@ -125,8 +160,50 @@ namespace ignition
       /// Will be nullptr if the System doesn't implement this interface.
       public: ISystemPostUpdate *postupdate = nullptr;
 
+      /// \brief Access this system via the ISystemComponentAccess interface
+      /// Will be nullptr if the System doesn't implement this interface.
+      public: ISystemComponentAccess *access = nullptr;
+
       /// \brief Vector of queries and callbacks
       public: std::vector<EntityQueryCallback> updates;
+
+      /// \brief Sim time between calls, or zero to call the system on every
+      /// iteration.
+      public: std::chrono::steady_clock::duration updatePeriod{0};
+
+      /// \brief Sim time at which the system is next due.
+      public: std::chrono::steady_clock::duration nextUpdate{0};
+
+      /// \brief Sim time of the last call, negative before the first one.
+      public: std::chrono::steady_clock::duration lastUpdate{-1};
+
+      /// \brief True if the system is called during the current iteration.
+      public: bool due{true};
+
+      /// \brief Info passed to the system during the current iteration,
+      /// whose dt is the sim time since the system's last call.
+      public: UpdateInfo info;
+
+      /// \brief Name of the system, used for statistics.
+      public: std::string name;
+
+      /// \brief Wall time of PreUpdate calls since the last statistics.
+      public: DurationHistogram preupdateTime;
+
+      /// \brief Wall time of Update calls since the last statistics.
+      public: DurationHistogram updateTime;
+
+      /// \brief Wall time of PostUpdate calls since the last statistics.
+      public: DurationHistogram postupdateTime;
+
+      /// \brief Name of the system interned by the trace recorder, nullptr
+      /// if tracing is disabled.
+      public: const char *traceName{nullptr};
+
+      /// \brief Wall time of the PreUpdate, Update and PostUpdate calls
+      /// during the current iteration, zero if not called.
+      public: std::array<std::chrono::steady_clock::duration, 3>
+              iterationTime{};
     };
 
     class IGNITION_GAZEBO_VISIBLE SimulationRunner
@@ -135,9 +212,25 @@ namespace ignition
       /// \param[in] _world Pointer to the SDF world.
       /// \param[in] _systemLoader Reference to system manager.
       /// \param[in] _useLevels Whether to use levles or not. False by default.
+      /// \param[in] _startupProfile Profile to record the time spent
+      /// loading the world and running the first iteration into, which is
+      /// reported after the first iteration. Nullptr to not record it.
       public: explicit SimulationRunner(const sdf::World *_world,
                                 const SystemLoaderPtr &_systemLoader,
-                                const ServerConfig &_config = ServerConfig());
+                                const ServerConfig &_config = ServerConfig(),
+                                StartupProfile *_startupProfile = nullptr);
+
+      /// \brief Constructor of a fork of another runner, which continues
+      /// independently from the current state of the source. The entity
+      /// component manager is forked, see EntityComponentManager::Fork, so
+      /// components are only copied when modified. The plugins loaded by
+      /// the source are loaded again, except for logging, while systems
+      /// added with AddSystem aren't. The source must not be running.
+      /// \param[in] _source Runner to fork.
+      /// \param[in] _forkId Number of the fork, used to serve the world
+      /// controls of the fork on `/world/<name>/fork_<id>`.
+      public: SimulationRunner(const SimulationRunner &_source,
+                               const unsigned int _forkId);
 
       /// \brief Destructor.
       public: virtual ~SimulationRunner();
@@ -148,9 +241,6 @@ namespace ignition
       /// \brief Internal method for handling stop event (to prevent recursion)
       private: void OnStop();
 
-      /// \brief Stop and join all post update worker threads
-      private: void StopWorkerThreads();
-
       /// \brief Run the simulationrunner.
       /// \param[in] _iterations Number of iterations.
       /// \return True if the operation completed successfully.
@@ -163,15 +253,37 @@ namespace ignition
       /// \param[in] _info Time information for the step.
       public: void Step(const UpdateInfo &_info);
 
+      /// \brief Run a single unpaused iteration right away, without
+      /// sleeping to match the update period, for batched stepping of many
+      /// worlds. Distributed simulation isn't supported.
+      public: void BatchStep();
+
       /// \brief Add system after the simulation runner has been instantiated
       /// \note This actually adds system to a queue. The system is added to the
       /// runner at the begining of the a simulation cycle (call to Run)
       /// \param[in] _system System to be added
-      public: void AddSystem(const SystemPluginPtr &_system);
+      /// \param[in] _updatePeriod Sim time between calls to the system, zero
+      /// to call it on every iteration. Paused iterations, which don't
+      /// advance sim time, always call the system.
+      /// \param[in] _name Name of the system in statistics, defaults to its
+      /// index.
+      public: void AddSystem(const SystemPluginPtr &_system,
+                  const std::chrono::steady_clock::duration &_updatePeriod =
+                  std::chrono::steady_clock::duration::zero(),
+                  const std::string &_name = "");
 
       /// \brief Update all the systems
       public: void UpdateSystems();
 
+      /// \brief Group the PreUpdate and Update systems in stages, according
+      /// to the component access they declare.
+      private: void UpdateSystemStages();
+
+      /// \brief Create the transport node and advertise the world control,
+      /// GUI information, SDF generation and memory usage services.
+      /// \param[in] _namespace Namespace of the services.
+      private: void AdvertiseServices(const std::string &_namespace);
+
       /// \brief Publish current world statistics.
       public: void PublishStats();
 
@@ -218,6 +330,12 @@ namespace ignition
       /// \return The current iteration count.
       public: uint64_t IterationCount() const;
 
+      /// \brief Get the number of iterations per wall clock second, measured
+      /// every second, or every ServerConfig::ThroughputStatsPeriod in max
+      /// throughput mode.
+      /// \return Steps per second, or 0 before the first measurement.
+      public: double StepsPerSecond() const;
+
       /// \brief Get the number of entities on the runner.
       /// \return Entity count.
       public: size_t EntityCount() const;
@@ -256,6 +374,11 @@ namespace ignition
       /// \return Reference to the entity component manager.
       public: const EntityComponentManager &EntityCompMgr() const;
 
+      /// \brief Get the mutable EntityComponentManager, which must only be
+      /// used while the runner isn't stepping.
+      /// \return Reference to the entity component manager.
+      public: EntityComponentManager &EntityCompMgr();
+
       /// \brief Return an entity with the provided name.
       /// \details If multiple entities with the same name exist, the first
       /// entity found will be returned.
@@ -316,7 +439,12 @@ namespace ignition
 
       /// \brief World control service callback. This function stores the
       /// the request which will then be processed by the ProcessMessages
-      /// function.
+      /// function. Requests are queued without locking, so they don't wait
+      /// for the simulation loop and it doesn't wait for them. A request is
+      /// applied at the end of the iteration which is running when it's
+      /// received, so it takes effect at most one iteration period later,
+      /// paused or not. With a pacing rate of 1 kHz that's 1 ms, plus the
+      /// duration of the iteration if it's slower than real time.
       /// \param[in] _req Request from client, currently handling play / pause
       /// and multistep.
       /// \param[out] _res Response to client, true if successful.
@@ -326,7 +454,8 @@ namespace ignition
 
       /// \brief World control service callback. This function stores the
       /// the request which will then be processed by the ProcessMessages
-      /// function.
+      /// function. Requests are queued and applied like the ones of
+      /// OnWorldControl.
       /// \param[in] _req Request from client, currently handling play / pause
       /// and multistep.
       /// \param[out] _res Response to client, true if successful.
@@ -339,6 +468,29 @@ namespace ignition
       /// \return True if successful.
       private: bool GuiInfoService(ignition::msgs::GUI &_res);
 
+      /// \brief Callback for the memory usage service.
+      /// \param[out] _res Memory used by each component type and view of the
+      /// ECM, measured at most a second ago. Each param has a "kind", which
+      /// is "component" or "view", a "name", and "count", "bytes" and, for
+      /// components, "overhead" numbers.
+      /// \return True if successful.
+      private: bool MemoryUsageService(msgs::Param_V &_res);
+
+      /// \brief Measure the memory used by the ECM for the memory usage
+      /// service, if it wasn't measured during the last second.
+      private: void UpdateMemoryUsage();
+
+      /// \brief Measure the steps per second once per measurement period.
+      /// In max throughput mode, statistics are also published and printed
+      /// then, instead of on every step.
+      private: void UpdateThroughput();
+
+      /// \brief Record how late an iteration started, and publish the
+      /// histogram of the last second on the `step_jitter` topic.
+      /// \param[in] _dueTime When the iteration should have started.
+      private: void UpdateJitter(
+                   const std::chrono::steady_clock::time_point &_dueTime);
+
       /// \brief Calculate real time factor and populate currentInfo.
       private: void UpdateCurrentInfo();
 
@@ -351,13 +503,101 @@ namespace ignition
 
       /// \brief Actually add system to the runner
       /// \param[in] _system System to be added
-      public: void AddSystemToRunner(const SystemPluginPtr &_system);
+      /// \param[in] _updatePeriod Sim time between calls to the system, zero
+      /// to call it on every iteration.
+      /// \param[in] _name Name of the system in statistics, defaults to its
+      /// index.
+      public: void AddSystemToRunner(const SystemPluginPtr &_system,
+                  const std::chrono::steady_clock::duration &_updatePeriod =
+                  std::chrono::steady_clock::duration::zero(),
+                  const std::string &_name = "");
+
+      /// \brief Publish the timing statistics of each system on the
+      /// `system_stats` topic, once per second, and start over.
+      private: void UpdateSystemStats();
+
+      /// \brief Publish the step metrics on the `step_metrics` topic, once
+      /// per second, and start over.
+      private: void UpdateStepMetrics();
+
+      /// \brief Service which returns the latest step metrics.
+      /// \param[out] _res A single param, with "step_count" iterations and
+      /// "step_p50_us", "step_p99_us", "step_max_us" and "step_mean_us" wall
+      /// times of the iterations during the last second. The same numbers
+      /// are given for the "preupdate", "update" and "postupdate" phases, the
+      /// "world_state" pass which caches world poses and link states,
+      /// "messages", which applies queued requests, and "level_transition",
+      /// the iterations which loaded or unloaded level entities. It also
+      /// holds the "entity_count", the "component_count" and "view_count" of
+      /// the last memory usage measurement, the most "world_control_queued" and
+      /// "pending_systems" found at once, "steps_per_second" and
+      /// "real_time_factor". On a distributed simulation primary, it adds
+      /// the totals since the start of "network_steps", the
+      /// "network_bytes_sent" of steps, the "network_bytes_received" of
+      /// acknowledgements, their uncompressed "network_state_bytes" and
+      /// "network_resyncs", and the "network_mean_latency_us" and
+      /// "network_max_latency_us" of acknowledgements.
+      /// \return True if successful.
+      private: bool StepMetricsService(msgs::Param_V &_res);
+
+      /// \brief Service which writes the trace recorded so far, see
+      /// ServerConfig::SetTraceBufferSize. The trace is written at the end
+      /// of the current iteration, in the background.
+      /// \param[in] _req Path of the Chrome trace file to write.
+      /// \param[out] _res True if tracing is enabled and a path was given.
+      /// \return True if successful.
+      private: bool TraceService(const msgs::StringMsg &_req,
+                                 msgs::Boolean &_res);
+
+      /// \brief Report the startup profile after the first iteration, with
+      /// the time spent by each system during it.
+      /// \param[in] _stepTime Wall time of the iteration.
+      private: void ReportStartup(
+                   const std::chrono::steady_clock::duration &_stepTime);
+
+      /// \brief Write the trace if it was requested. Report iterations
+      /// slower than ServerConfig::TraceSlowStepThreshold, and write their
+      /// trace if tracing is enabled.
+      /// \param[in] _stepTime Wall time of the iteration.
+      private: void UpdateTrace(
+                   const std::chrono::steady_clock::duration &_stepTime);
+
+      /// \brief Describe where the current iteration spent its time: the
+      /// budget, each phase, the slowest system call and the ECM counters.
+      /// \param[in] _stepTime Wall time of the iteration.
+      /// \return Values by name, such as "slowest_system" and
+      /// "entity_count".
+      private: std::map<std::string, std::string> SlowStepReport(
+                   const std::chrono::steady_clock::duration &_stepTime)
+                   const;
+
+      /// \brief Service which returns the latest system timing statistics.
+      /// \param[out] _res One param per system, with its "name" string, and
+      /// for each of "preupdate", "update" and "postupdate" it implements,
+      /// "<phase>_count" calls and "<phase>_p50_us", "<phase>_p99_us",
+      /// "<phase>_max_us" and "<phase>_mean_us" wall times of the calls
+      /// during the last second.
+      /// \return True if successful.
+      private: bool SystemStatsService(msgs::Param_V &_res);
+
+      /// \brief Find out which systems are due during this iteration, see
+      /// SystemInternal::updatePeriod.
+      private: void UpdateDueSystems();
+
+      /// \brief Keep the systems of a list which are due.
+      /// \param[in] _systems Indices of systems in systems.
+      /// \return Indices of the due systems, stored in dueSystems.
+      private: const std::vector<std::size_t> &DueSystems(
+                   const std::vector<std::size_t> &_systems);
 
       /// \brief Calls AddSystemToRunner to each system that is pending to be
       /// added.
       public: void ProcessSystemQueue();
 
       /// \brief Generate the current world's SDFormat representation.
+      /// While running, the simulation thread only forks the ECM between
+      /// iterations, see ProcessWorldSdfRequests, and the SDFormat is
+      /// generated from the fork on the calling thread.
       /// \param[in] _req Request message with options for saving a world to an
       /// SDFormat file.
       /// \param[out] _res Generated SDFormat string.
@@ -365,6 +605,10 @@ namespace ignition
       public: bool GenerateWorldSdf(const msgs::SdfGeneratorConfig &_req,
                                     msgs::StringMsg &_res);
 
+      /// \brief Fork the ECM for pending GenerateWorldSdf calls. Called
+      /// before each iteration.
+      public: void ProcessWorldSdfRequests();
+
       /// \brief Sets the file path to fuel URI map.
       /// \param[in] _map A populated map of file paths to fuel URIs.
       public: void SetFuelUriMap(
@@ -388,6 +632,35 @@ namespace ignition
       /// Physics component of the world, if any.
       public: void UpdatePhysicsParams();
 
+      /// \brief Request a snapshot of all entities and components, and of
+      /// sim time. The snapshot is taken by ProcessSnapshotRequests, before
+      /// the next iteration.
+      /// \return Id of the snapshot, or std::nullopt if this is a
+      /// distributed simulation, which doesn't support snapshots.
+      public: std::optional<uint64_t> SaveSnapshot();
+
+      /// \brief Request to restore a snapshot, which is done by
+      /// ProcessSnapshotRequests, before the next iteration. Entities created
+      /// since then are removed, and physics is reset through commands, see
+      /// Server::RestoreSnapshot.
+      /// \param[in] _id Id returned by SaveSnapshot.
+      /// \return False if there's no snapshot with that id.
+      public: bool RestoreSnapshot(uint64_t _id);
+
+      /// \brief Request to remove a snapshot, freeing its memory.
+      /// \param[in] _id Id returned by SaveSnapshot.
+      /// \return False if there's no snapshot with that id.
+      public: bool RemoveSnapshot(uint64_t _id);
+
+      /// \brief Save, restore and remove snapshots as requested, in order.
+      /// Called before each iteration, or directly by the server while it
+      /// isn't running.
+      public: void ProcessSnapshotRequests();
+
+      /// \brief Restore a snapshot.
+      /// \param[in] _snapshot Snapshot to restore.
+      private: void ApplySnapshot(const WorldSnapshot &_snapshot);
+
       /// \brief This is used to indicate that a stop event has been received.
       private: std::atomic<bool> stopReceived{false};
 
@@ -398,8 +671,21 @@ namespace ignition
       /// \brief All the systems.
       private: std::vector<SystemInternal> systems;
 
+      /// \brief A system waiting to be added to systems.
+      private: struct PendingSystem
+      {
+        /// \brief The system.
+        SystemPluginPtr system;
+
+        /// \brief Sim time between calls to the system.
+        std::chrono::steady_clock::duration updatePeriod;
+
+        /// \brief Name of the system in statistics.
+        std::string name;
+      };
+
       /// \brief Pending systems to be added to systems.
-      private: std::vector<SystemPluginPtr> pendingSystems;
+      private: std::vector<PendingSystem> pendingSystems;
 
       /// \brief Mutex to protect pendingSystems
       private: mutable std::mutex pendingSystemsMutex;
@@ -407,18 +693,57 @@ namespace ignition
       /// \brief Systems implementing Configure
       private: std::vector<ISystemConfigure *> systemsConfigure;
 
-      /// \brief Systems implementing PreUpdate
-      private: std::vector<ISystemPreUpdate *> systemsPreupdate;
+      /// \brief Indices in systems of the systems implementing PreUpdate
+      private: std::vector<std::size_t> systemsPreupdate;
+
+      /// \brief Indices in systems of the systems implementing Update
+      private: std::vector<std::size_t> systemsUpdate;
+
+      /// \brief Component access declared by each system in
+      /// systemsPreupdate, or nullopt if it doesn't declare it.
+      private: std::vector<std::optional<ComponentAccess>> preupdateAccess;
+
+      /// \brief Component access declared by each system in systemsUpdate,
+      /// or nullopt if it doesn't declare it.
+      private: std::vector<std::optional<ComponentAccess>> updateAccess;
 
-      /// \brief Systems implementing Update
-      private: std::vector<ISystemUpdate *> systemsUpdate;
+      /// \brief Indices in systems of the systems implementing PreUpdate,
+      /// grouped in stages of systems which can run at the same time.
+      private: std::vector<std::vector<std::size_t>> preupdateStages;
 
-      /// \brief Systems implementing PostUpdate
-      private: std::vector<ISystemPostUpdate *> systemsPostupdate;
+      /// \brief Indices in systems of the systems implementing Update,
+      /// grouped in stages of systems which can run at the same time.
+      private: std::vector<std::vector<std::size_t>> updateStages;
+
+      /// \brief True if systems were added, and the stages must be
+      /// computed again.
+      private: bool systemStagesDirty{true};
+
+      /// \brief Component types accessed by systems of stages with more
+      /// than one system.
+      private: std::set<ComponentTypeId> parallelComponentTypes;
+
+      /// \brief Indices in systems of the systems implementing PostUpdate
+      private: std::vector<std::size_t> systemsPostupdate;
+
+      /// \brief True if any system has an update period.
+      private: bool hasUpdatePeriods{false};
+
+      /// \brief Due systems of a stage, reused between stages.
+      private: std::vector<std::size_t> dueSystems;
 
       /// \brief Manager of all events.
       private: EventManager eventMgr;
 
+      /// \brief Worker threads shared by all parallel work of this runner,
+      /// such as PostUpdate systems, EntityComponentManager::ParallelEach
+      /// and state serialization. Declared before the entity component
+      /// manager so it outlives it. The pool has a fixed number of threads,
+      /// see ServerConfig::SetWorkerThreadCount, so PostUpdate systems no
+      /// longer get a thread each: a PostUpdate which blocks holds one of
+      /// the threads, and the other systems wait for a free one.
+      private: std::unique_ptr<TaskPool> taskPool;
+
       /// \brief Manager of all components.
       private: EntityComponentManager entityCompMgr;
 
@@ -451,9 +776,28 @@ namespace ignition
       /// \brief System loader, for loading system plugins.
       private: SystemLoaderPtr systemLoader;
 
-      /// \brief Mutex to protect systemLoader
+      /// \brief Mutex to protect systemLoader and loadedPlugins
       private: std::mutex systemLoaderMutex;
 
+      /// \brief A plugin loaded by LoadPlugin.
+      private: struct LoadedPlugin
+      {
+        /// \brief Entity the plugin was loaded for.
+        Entity entity;
+
+        /// \brief Filename of the plugin library.
+        std::string filename;
+
+        /// \brief Name of the plugin.
+        std::string name;
+
+        /// \brief SDF element of the plugin.
+        sdf::ElementPtr sdf;
+      };
+
+      /// \brief Plugins loaded so far, in order, so forks load them too.
+      private: std::vector<LoadedPlugin> loadedPlugins;
+
       /// \brief Node for communication.
       private: std::unique_ptr<transport::Node> node{nullptr};
 
@@ -515,36 +859,190 @@ namespace ignition
       /// \brief Keeps the latest simulation info.
       private: UpdateInfo currentInfo;
 
-      /// \brief Buffer of world control messages.
-      private: std::list<WorldControl> worldControls;
-
-      /// \brief Mutex to protect message buffers.
-      private: std::mutex msgBufferMutex;
+      /// \brief World control messages received from transport threads,
+      /// drained by ProcessMessages.
+      private: MpscQueue<WorldControl> worldControls;
 
       /// \brief Keep the latest GUI message.
       public: msgs::GUI guiMsg;
 
-      /// \brief Copy of the server configuration.
-      public: ServerConfig serverConfig;
+      /// \brief Latest ECM memory usage, see MemoryUsageService.
+      private: msgs::Param_V memoryUsageMsg;
+
+      /// \brief Protects memoryUsageMsg.
+      private: std::mutex memoryUsageMutex;
+
+      /// \brief When memoryUsageMsg was last updated.
+      private: std::chrono::steady_clock::time_point memoryUsageTime;
+
+      /// \brief Latest system timing statistics, see SystemStatsService.
+      private: msgs::Param_V systemStatsMsg;
+
+      /// \brief Protects systemStatsMsg.
+      private: std::mutex systemStatsMutex;
+
+      /// \brief When the system statistics were last published.
+      private: std::chrono::steady_clock::time_point systemStatsTime;
+
+      /// \brief Publisher of system timing statistics.
+      private: transport::Node::Publisher systemStatsPub;
+
+      /// \brief Wall time of whole iterations.
+      private: DurationHistogram stepTime;
+
+      /// \brief Wall time of the PreUpdate phase.
+      private: DurationHistogram preupdatePhaseTime;
+
+      /// \brief Wall time of the Update phase.
+      private: DurationHistogram updatePhaseTime;
+
+      /// \brief Wall time of the PostUpdate phase.
+      private: DurationHistogram postupdatePhaseTime;
+
+      /// \brief Wall time of caching world poses and link states.
+      private: DurationHistogram worldStateTime;
+
+      /// \brief Wall time of processing queued messages.
+      private: DurationHistogram messagesTime;
+
+      /// \brief Wall time of the iterations which loaded or unloaded level
+      /// entities.
+      private: DurationHistogram levelTransitionTime;
+
+      /// \brief Level transitions counted by the level manager at the end of
+      /// the previous iteration.
+      private: uint64_t levelTransitions{0};
+
+      /// \brief Most world control requests drained at once since the step
+      /// metrics were last published.
+      private: std::size_t worldControlQueued{0};
+
+      /// \brief Most systems pending to be added at once since the step
+      /// metrics were last published.
+      private: std::size_t pendingSystemsQueued{0};
+
+      /// \brief Components counted by the last memory usage measurement.
+      private: std::size_t componentCount{0};
+
+      /// \brief Views counted by the last memory usage measurement.
+      private: std::size_t viewCount{0};
+
+      /// \brief Latest step metrics, see StepMetricsService.
+      private: msgs::Param_V stepMetricsMsg;
+
+      /// \brief Protects stepMetricsMsg.
+      private: std::mutex stepMetricsMutex;
 
-      /// \brief Collection of threads running system PostUpdates
-      private: std::vector<std::thread> postUpdateThreads;
+      /// \brief When the step metrics were last published.
+      private: std::chrono::steady_clock::time_point stepMetricsTime;
 
-      /// \brief Flag to indicate running status of PostUpdate threads
-      private: std::atomic<bool> postUpdateThreadsRunning{false};
+      /// \brief Publisher of step metrics.
+      private: transport::Node::Publisher stepMetricsPub;
 
-      /// \brief Barrier to signal beginning of PostUpdate thread execution
-      private: std::unique_ptr<Barrier> postUpdateStartBarrier;
+      /// \brief Phases of an iteration, in the order of stepPhaseTimes.
+      private: static constexpr std::array<const char *, 5> kStepPhases{
+          "preupdate", "update", "world_state", "postupdate", "messages"};
 
-      /// \brief Barrier to signal end of PostUpdate thread execution
-      private: std::unique_ptr<Barrier> postUpdateStopBarrier;
+      /// \brief Wall time of each phase of the current iteration.
+      private: std::array<std::chrono::steady_clock::duration,
+               kStepPhases.size()> stepPhaseTimes{};
+
+      /// \brief Records the scopes of recent iterations, nullptr if tracing
+      /// is disabled.
+      private: std::unique_ptr<TraceRecorder> traceRecorder;
+
+      /// \brief Startup profile, reported after the first iteration, nullptr
+      /// if not recorded or already reported.
+      private: StartupProfile *startupProfile{nullptr};
+
+      /// \brief Path of the trace requested by TraceService, empty if none
+      /// is pending.
+      private: std::string traceRequestPath;
+
+      /// \brief Protects traceRequestPath.
+      private: std::mutex traceMutex;
+
+      /// \brief When a slow iteration last triggered a trace.
+      private: std::chrono::steady_clock::time_point slowStepTraceTime;
+
+      /// \brief Trace being written in the background. Declared after the
+      /// recorder, so the write finishes before the recorder's labels go
+      /// away.
+      private: std::future<void> traceWrite;
+
+      /// \brief When the steps per second were last measured.
+      private: std::chrono::steady_clock::time_point throughputTime;
+
+      /// \brief Iteration count when the steps per second were last
+      /// measured.
+      private: uint64_t throughputIterations{0};
+
+      /// \brief Latest steps per second, read by other threads.
+      private: std::atomic<double> stepsPerSecond{0.0};
+
+      /// \brief Upper bounds of the step jitter histogram bins, in
+      /// microseconds.
+      private: static constexpr std::array<double, 8> kJitterBinsUs{
+          10, 50, 100, 200, 500, 1000, 2000, 5000};
+
+      /// \brief Steps per jitter histogram bin, with one more bin for
+      /// steps beyond the last bound.
+      private: std::array<uint64_t, kJitterBinsUs.size() + 1> jitterCounts{};
+
+      /// \brief Steps in the jitter histogram.
+      private: uint64_t jitterSteps{0};
+
+      /// \brief Sum of the step jitter, in microseconds.
+      private: double jitterSumUs{0.0};
+
+      /// \brief Largest step jitter, in microseconds.
+      private: double jitterMaxUs{0.0};
+
+      /// \brief When the jitter histogram was last published.
+      private: std::chrono::steady_clock::time_point jitterTime;
+
+      /// \brief Publisher of step jitter histograms.
+      private: transport::Node::Publisher jitterPub;
+
+      /// \brief Copy of the server configuration.
+      public: ServerConfig serverConfig;
 
       /// \brief Map from file paths to Fuel URIs.
       private: std::unordered_map<std::string, std::string> fuelUriMap;
 
+      /// \brief GenerateWorldSdf calls waiting for a fork of the ECM.
+      private: std::vector<std::promise<std::shared_ptr<WorldSdfSource>>>
+          worldSdfRequests;
+
+      /// \brief Protects worldSdfRequests.
+      private: std::mutex worldSdfMutex;
+
       /// \brief True if Server::RunOnce triggered a blocking paused step
       private: bool blockingPausedStepPending{false};
 
+      /// \brief Snapshots, by id.
+      private: std::unordered_map<uint64_t, WorldSnapshot> snapshots;
+
+      /// \brief Ids of the snapshots which exist, or will once the pending
+      /// requests are processed.
+      private: std::unordered_set<uint64_t> snapshotIds;
+
+      /// \brief Id of the next snapshot.
+      private: uint64_t nextSnapshotId{1};
+
+      /// \brief What a snapshot request does.
+      private: enum class SnapshotOp {SAVE, RESTORE, REMOVE};
+
+      /// \brief Pending snapshot requests, in order.
+      private: std::vector<std::pair<SnapshotOp, uint64_t>> snapshotRequests;
+
+      /// \brief Protects snapshotIds, nextSnapshotId and snapshotRequests.
+      private: std::mutex snapshotMutex;
+
+      /// \brief Models given velocity commands to stop them when a snapshot
+      /// was restored, whose commands are removed after the next update.
+      private: std::vector<Entity> snapshotVelocityCmds;
+
       friend class LevelManager;
     };
     }
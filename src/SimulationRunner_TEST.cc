@@ -18,7 +18,12 @@
 #include <gtest/gtest.h>
 #include <tinyxml2.h>
 
+#include <array>
+#include <fstream>
+#include <vector>
+
 #include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/transport/Node.hh>
 #include <sdf/Box.hh>
@@ -58,6 +63,8 @@
 #include "ignition/gazebo/config.hh"
 #include "SimulationRunner.hh"
 
+#include "plugins/MockSystem.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace components;
@@ -1509,6 +1516,404 @@ TEST_P(SimulationRunnerTest, LoadPluginsEvent)
       componentId)) << componentId;
 }
 
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, SystemUpdatePeriod)
+{
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(R"(
+      <?xml version="1.0" ?>
+      <sdf version="1.6">
+        <world name="default">
+          <physics name="1ms" type="ignored">
+            <max_step_size>0.001</max_step_size>
+          </physics>
+        </world>
+      </sdf>)").empty());
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader);
+  runner.SetUpdatePeriod(1ns);
+  runner.SetPaused(false);
+
+  auto loadMock = [&]()
+  {
+    auto plugin = systemLoader->LoadPlugin("libMockSystem.so",
+        "ignition::gazebo::MockSystem", nullptr);
+    EXPECT_TRUE(plugin.has_value());
+    return plugin.value();
+  };
+  auto everyStepPlugin = loadMock();
+  auto slowPlugin = loadMock();
+  auto *everyStep = dynamic_cast<MockSystem *>(
+      everyStepPlugin->QueryInterface<System>());
+  auto *slow = dynamic_cast<MockSystem *>(
+      slowPlugin->QueryInterface<System>());
+  ASSERT_NE(nullptr, everyStep);
+  ASSERT_NE(nullptr, slow);
+
+  // The slow system gets the sim time since its last call
+  std::vector<std::chrono::steady_clock::duration> slowDts;
+  slow->preUpdateCallback = [&](const UpdateInfo &_info,
+      EntityComponentManager &)
+  {
+    slowDts.push_back(_info.dt);
+  };
+
+  runner.AddSystem(everyStepPlugin);
+  runner.AddSystem(slowPlugin, 10ms, "slow");
+  EXPECT_TRUE(runner.Run(100));
+
+  EXPECT_EQ(100u, everyStep->preUpdateCallCount);
+  EXPECT_EQ(100u, everyStep->updateCallCount);
+  EXPECT_EQ(100u, everyStep->postUpdateCallCount);
+  EXPECT_EQ(10u, slow->preUpdateCallCount);
+  EXPECT_EQ(10u, slow->updateCallCount);
+  EXPECT_EQ(10u, slow->postUpdateCallCount);
+
+  ASSERT_EQ(10u, slowDts.size());
+  EXPECT_EQ(1ms, slowDts.front());
+  for (std::size_t i = 1; i < slowDts.size(); ++i)
+    EXPECT_EQ(10ms, slowDts[i]);
+
+  // Statistics are first taken on the first iteration
+  transport::Node node;
+  bool result{false};
+  msgs::Param_V res;
+  EXPECT_TRUE(node.Request("/world/default/system_stats", 5000u, res,
+      result));
+  EXPECT_TRUE(result);
+  ASSERT_EQ(2, res.param_size());
+
+  const auto &everyStepStats = res.param(0).params();
+  EXPECT_EQ("system_0", everyStepStats.at("name").string_value());
+  EXPECT_DOUBLE_EQ(1.0, everyStepStats.at("preupdate_count").double_value());
+  EXPECT_GE(everyStepStats.at("update_max_us").double_value(), 0.0);
+  EXPECT_LE(everyStepStats.at("postupdate_p50_us").double_value(),
+      everyStepStats.at("postupdate_max_us").double_value());
+
+  const auto &slowStats = res.param(1).params();
+  EXPECT_EQ("slow", slowStats.at("name").string_value());
+  EXPECT_DOUBLE_EQ(1.0, slowStats.at("update_count").double_value());
+
+  // Paused steps don't advance sim time, but throttled systems still get
+  // them, like the other systems
+  runner.SetPaused(true);
+  for (int i = 0; i < 5; ++i)
+  {
+    runner.SetNextStepAsBlockingPaused(true);
+    EXPECT_TRUE(runner.Run(1));
+  }
+  EXPECT_EQ(105u, everyStep->preUpdateCallCount);
+  EXPECT_EQ(15u, slow->preUpdateCallCount);
+  EXPECT_EQ(15u, slow->updateCallCount);
+  EXPECT_EQ(15u, slow->postUpdateCallCount);
+
+  // They keep their schedule once unpaused
+  runner.SetPaused(false);
+  EXPECT_TRUE(runner.Run(20));
+  EXPECT_EQ(125u, everyStep->preUpdateCallCount);
+  EXPECT_EQ(17u, slow->preUpdateCallCount);
+}
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, ThrottledSystemKeepsViews)
+{
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(R"(
+      <?xml version="1.0" ?>
+      <sdf version="1.6">
+        <world name="default">
+          <physics name="1ms" type="ignored">
+            <max_step_size>0.001</max_step_size>
+          </physics>
+        </world>
+      </sdf>)").empty());
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader);
+  runner.SetUpdatePeriod(1ns);
+  runner.SetPaused(false);
+
+  auto plugin = systemLoader->LoadPlugin("libMockSystem.so",
+      "ignition::gazebo::MockSystem", nullptr);
+  ASSERT_TRUE(plugin.has_value());
+  auto *slow = dynamic_cast<MockSystem *>(
+      plugin.value()->QueryInterface<System>());
+  ASSERT_NE(nullptr, slow);
+
+  // The system uses its view once every 2000 iterations
+  int worlds{0};
+  slow->updateCallback = [&](const UpdateInfo &,
+      EntityComponentManager &_ecm)
+  {
+    _ecm.Each<components::World>(
+        [&](const Entity &, const components::World *) -> bool
+        {
+          ++worlds;
+          return true;
+        });
+  };
+
+  runner.AddSystem(plugin.value(), 2s);
+  EXPECT_TRUE(runner.Run(5000));
+  EXPECT_EQ(3u, slow->updateCallCount);
+  EXPECT_EQ(3, worlds);
+
+  // Views aren't evicted by default, so the view isn't built again on
+  // every call
+  EXPECT_EQ(0u, runner.EntityCompMgr().EvictedViewCount());
+}
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, ParallelStageViews)
+{
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(R"(
+      <?xml version="1.0" ?>
+      <sdf version="1.6">
+        <world name="default">
+          <physics name="1ms" type="ignored">
+            <max_step_size>0.001</max_step_size>
+          </physics>
+        </world>
+      </sdf>)").empty());
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader);
+  runner.SetUpdatePeriod(1ns);
+  runner.SetPaused(false);
+
+  auto creatorPlugin = systemLoader->LoadPlugin("libMockSystem.so",
+      "ignition::gazebo::MockSystem", nullptr);
+  ASSERT_TRUE(creatorPlugin.has_value());
+  auto *creator = dynamic_cast<MockSystem *>(
+      creatorPlugin.value()->QueryInterface<System>());
+  ASSERT_NE(nullptr, creator);
+
+  // Entities are created right before the stage of the readers, so their
+  // view updates are still queued when it starts
+  const int perStep{50};
+  creator->preUpdateCallback = [&](const UpdateInfo &,
+      EntityComponentManager &_ecm)
+  {
+    for (int i = 0; i < perStep; ++i)
+    {
+      const Entity entity = _ecm.CreateEntity();
+      _ecm.CreateComponent(entity, IntComponent(i));
+      _ecm.CreateComponent(entity, DoubleComponent(i));
+    }
+  };
+  runner.AddSystem(creatorPlugin.value());
+
+  // Both readers only read, so they run at the same time. They query a
+  // view built on the first step, and first build the other one from
+  // different threads, sharing it afterwards.
+  constexpr int kSteps{20};
+  std::array<std::vector<int>, 2> counts;
+  for (std::size_t r = 0; r < counts.size(); ++r)
+  {
+    auto plugin = systemLoader->LoadPlugin("libMockSystem.so",
+        "ignition::gazebo::MockAccessSystem", nullptr);
+    ASSERT_TRUE(plugin.has_value());
+    auto *reader = dynamic_cast<MockAccessSystem *>(
+        plugin.value()->QueryInterface<System>());
+    ASSERT_NE(nullptr, reader);
+    reader->access.reads = {IntComponent::typeId, DoubleComponent::typeId};
+
+    auto &readerCounts = counts[r];
+    reader->preUpdateCallback = [&readerCounts, r](const UpdateInfo &_info,
+        EntityComponentManager &_ecm)
+    {
+      int count{0};
+      _ecm.Each<IntComponent>(
+          [&](const Entity &, const IntComponent *) -> bool
+          {
+            ++count;
+            return true;
+          });
+
+      int withDouble{0};
+      auto countBoth = [&](const Entity &, const IntComponent *,
+          const DoubleComponent *) -> bool
+      {
+        ++withDouble;
+        return true;
+      };
+      // The same view is found through both orders of its types
+      if (_info.iterations % 2 == r)
+        _ecm.Each<IntComponent, DoubleComponent>(countBoth);
+      else
+        _ecm.Each<DoubleComponent, IntComponent>(
+            [&](const Entity &_entity, const DoubleComponent *_double,
+                const IntComponent *_int) -> bool
+            {
+              return countBoth(_entity, _int, _double);
+            });
+
+      EXPECT_EQ(count, withDouble);
+      readerCounts.push_back(count);
+    };
+    runner.AddSystem(plugin.value());
+  }
+
+  EXPECT_TRUE(runner.Run(kSteps));
+
+  // Both readers saw all the entities created so far, on every step
+  for (const auto &readerCounts : counts)
+  {
+    ASSERT_EQ(static_cast<std::size_t>(kSteps), readerCounts.size());
+    for (int step = 0; step < kSteps; ++step)
+      EXPECT_EQ((step + 1) * perStep, readerCounts[step]);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, StepMetrics)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  SimulationRunner runner(root.WorldByIndex(0), systemLoader);
+  runner.SetUpdatePeriod(1ns);
+  runner.SetPaused(false);
+  EXPECT_TRUE(runner.Run(10));
+
+  // Metrics are first taken on the first iteration
+  transport::Node node;
+  bool result{false};
+  msgs::Param_V res;
+  EXPECT_TRUE(node.Request("/world/default/step_metrics", 5000u, res,
+      result));
+  EXPECT_TRUE(result);
+  ASSERT_EQ(1, res.param_size());
+
+  const auto &metrics = res.param(0).params();
+  EXPECT_DOUBLE_EQ(1.0, metrics.at("step_count").double_value());
+  EXPECT_LE(metrics.at("step_p50_us").double_value(),
+      metrics.at("step_max_us").double_value());
+  EXPECT_GE(metrics.at("step_max_us").double_value(),
+      metrics.at("postupdate_max_us").double_value());
+  for (const std::string phase :
+      {"preupdate", "update", "postupdate", "world_state", "messages"})
+  {
+    EXPECT_DOUBLE_EQ(1.0, metrics.at(phase + "_count").double_value())
+        << phase;
+  }
+
+  EXPECT_DOUBLE_EQ(static_cast<double>(runner.EntityCompMgr().EntityCount()),
+      metrics.at("entity_count").double_value());
+  EXPECT_GT(metrics.at("component_count").double_value(), 0.0);
+  EXPECT_DOUBLE_EQ(0.0, metrics.at("world_control_queued").double_value());
+  EXPECT_EQ(1u, metrics.count("real_time_factor"));
+}
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, Trace)
+{
+  sdf::Root root;
+  root.Load(common::joinPaths(PROJECT_SOURCE_PATH,
+      "test", "worlds", "shapes.sdf"));
+  ASSERT_EQ(1u, root.WorldCount());
+
+  const auto tracePath = common::joinPaths(PROJECT_BINARY_PATH, "test",
+      "simulation_runner_trace.json");
+  common::removeFile(tracePath);
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  ServerConfig serverConfig;
+  serverConfig.SetTraceBufferSize(1000);
+  {
+    SimulationRunner runner(root.WorldByIndex(0), systemLoader,
+        serverConfig);
+    runner.SetUpdatePeriod(1ns);
+    runner.SetPaused(false);
+    EXPECT_TRUE(runner.Run(10));
+
+    // The trace is written after the next iteration
+    transport::Node node;
+    msgs::StringMsg req;
+    req.set_data(tracePath);
+    msgs::Boolean res;
+    bool result{false};
+    EXPECT_TRUE(node.Request("/world/default/trace", req, 5000u, res,
+        result));
+    EXPECT_TRUE(result);
+    EXPECT_TRUE(res.data());
+    EXPECT_TRUE(runner.Run(1));
+  }
+
+  // Destroying the runner waits for the trace to be written
+  std::ifstream file(tracePath);
+  const std::string trace{std::istreambuf_iterator<char>(file),
+      std::istreambuf_iterator<char>()};
+  EXPECT_NE(std::string::npos, trace.find("\"cat\":\"PostUpdate\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"Step\""));
+  EXPECT_NE(std::string::npos, trace.find("\"iteration\":10"));
+  common::removeFile(tracePath);
+}
+
+/////////////////////////////////////////////////
+TEST_P(SimulationRunnerTest, SlowStepReport)
+{
+  sdf::Root root;
+  ASSERT_TRUE(root.LoadSdfString(R"(
+      <?xml version="1.0" ?>
+      <sdf version="1.6">
+        <world name="default">
+          <physics name="1ms" type="ignored">
+            <max_step_size>0.001</max_step_size>
+          </physics>
+        </world>
+      </sdf>)").empty());
+
+  const auto traceDir = common::joinPaths(PROJECT_BINARY_PATH, "test",
+      "slow_steps");
+  common::removeAll(traceDir);
+
+  auto systemLoader = std::make_shared<SystemLoader>();
+  ServerConfig serverConfig;
+  serverConfig.SetTraceBufferSize(1000);
+  serverConfig.SetTraceSlowStepThreshold(10ms);
+  serverConfig.SetTracePath(traceDir);
+  {
+    SimulationRunner runner(root.WorldByIndex(0), systemLoader,
+        serverConfig);
+    runner.SetUpdatePeriod(1ns);
+    runner.SetPaused(false);
+
+    auto plugin = systemLoader->LoadPlugin("libMockSystem.so",
+        "ignition::gazebo::MockSystem", nullptr);
+    ASSERT_TRUE(plugin.has_value());
+    auto *mock = dynamic_cast<MockSystem *>(
+        plugin.value()->QueryInterface<System>());
+    ASSERT_NE(nullptr, mock);
+    mock->updateCallback = [](const UpdateInfo &, EntityComponentManager &)
+    {
+      std::this_thread::sleep_for(20ms);
+    };
+    runner.AddSystem(plugin.value(), 0ms, "sleepy");
+    EXPECT_TRUE(runner.Run(3));
+  }
+
+  // Only one trace is written per second
+  std::vector<std::string> traces;
+  for (common::DirIter file(traceDir); file != common::DirIter(); ++file)
+    traces.push_back(*file);
+  ASSERT_EQ(1u, traces.size());
+
+  std::ifstream file(traces[0]);
+  const std::string trace{std::istreambuf_iterator<char>(file),
+      std::istreambuf_iterator<char>()};
+  EXPECT_NE(std::string::npos,
+      trace.find("\"slowest_system\":\"sleepy\""));
+  EXPECT_NE(std::string::npos, trace.find("\"slowest_phase\":\"update\""));
+  EXPECT_NE(std::string::npos, trace.find("\"entity_count\""));
+  common::removeAll(traceDir);
+}
+
 /////////////////////////////////////////////////
 TEST_P(SimulationRunnerTest, GuiInfo)
 {
@@ -0,0 +1,469 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+
+#include "ignition/gazebo/SpatialIndex.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Private data for SpatialIndex.
+class ignition::gazebo::SpatialIndexPrivate
+{
+  /// \brief Inclusive range of cells along each axis.
+  public: struct CellRange
+  {
+    /// \brief First cell along X, Y and Z.
+    int64_t min[3];
+
+    /// \brief Last cell along X, Y and Z.
+    int64_t max[3];
+
+    /// \brief Equality operator.
+    /// \param[in] _other Range to compare to.
+    /// \return True if both ranges cover the same cells.
+    bool operator==(const CellRange &_other) const
+    {
+      return std::equal(this->min, this->min + 3, _other.min) &&
+          std::equal(this->max, this->max + 3, _other.max);
+    }
+  };
+
+  /// \brief An entity in the index.
+  public: struct Item
+  {
+    /// \brief Box of the entity.
+    math::AxisAlignedBox box;
+
+    /// \brief Cells covered by the box.
+    CellRange cells;
+
+    /// \brief True if the box covers too many cells to be put in them.
+    bool large{false};
+  };
+
+  /// \brief Entity and its item, as stored in cells.
+  public: using CellEntry = std::pair<Entity, const Item *>;
+
+  /// \brief Get the cells covered by a box. Cells are clamped to the range
+  /// of cell keys, which is more than a thousand kilometers for 1 meter
+  /// cells, so far away boxes share border cells.
+  /// \param[in] _box Box.
+  /// \return Range of cells.
+  public: CellRange Range(const math::AxisAlignedBox &_box) const;
+
+  /// \brief Get the number of cells in a range.
+  /// \param[in] _range Range of cells.
+  /// \return Number of cells.
+  public: static uint64_t CellCount(const CellRange &_range);
+
+  /// \brief Get the key of a cell.
+  /// \param[in] _x Cell along X.
+  /// \param[in] _y Cell along Y.
+  /// \param[in] _z Cell along Z.
+  /// \return Key in the cell map.
+  public: static uint64_t Key(int64_t _x, int64_t _y, int64_t _z);
+
+  /// \brief Add an item to its cells.
+  /// \param[in] _entity Entity.
+  /// \param[in] _item Item, stored in the items map.
+  public: void Insert(const Entity _entity, const Item &_item);
+
+  /// \brief Remove an item from its cells.
+  /// \param[in] _entity Entity.
+  /// \param[in] _item Item, stored in the items map.
+  public: void Erase(const Entity _entity, const Item &_item);
+
+  /// \brief Get the entities in the cells overlapping some bounds, and
+  /// which pass a test.
+  /// \param[in] _bounds Bounds of the query.
+  /// \param[in] _test Exact test of an entity's box.
+  /// \return Entities which passed the test.
+  public: template<typename TestT>
+          std::vector<Entity> Query(const math::AxisAlignedBox &_bounds,
+              const TestT &_test) const;
+
+  /// \brief Boxes spanning more cells than this are kept aside.
+  public: static constexpr uint64_t kMaxCells{64};
+
+  /// \brief Cells along each axis are clamped to +-kMaxCell.
+  public: static constexpr int64_t kMaxCell{(int64_t{1} << 20) - 1};
+
+  /// \brief Size of the cells.
+  public: double cellSize{1.0};
+
+  /// \brief All entities. Items don't move in the map, so cells can point
+  /// to them.
+  public: std::unordered_map<Entity, Item> items;
+
+  /// \brief Entities in each cell. Empty cells are kept, so entities moving
+  /// back and forth don't allocate.
+  public: std::unordered_map<uint64_t, std::vector<CellEntry>> cells;
+
+  /// \brief Entities whose box covers too many cells.
+  public: std::vector<CellEntry> large;
+};
+
+namespace
+{
+  /// \brief Check whether two boxes intersect, including touching boxes.
+  /// \param[in] _a First box.
+  /// \param[in] _b Second box.
+  /// \return True if they intersect.
+  bool Overlap(const math::AxisAlignedBox &_a, const math::AxisAlignedBox &_b)
+  {
+    return _a.Min().X() <= _b.Max().X() && _a.Max().X() >= _b.Min().X() &&
+        _a.Min().Y() <= _b.Max().Y() && _a.Max().Y() >= _b.Min().Y() &&
+        _a.Min().Z() <= _b.Max().Z() && _a.Max().Z() >= _b.Min().Z();
+  }
+
+  /// \brief Check whether a box has a min corner below its max corner.
+  /// \param[in] _box Box.
+  /// \return True if it's valid.
+  bool Valid(const math::AxisAlignedBox &_box)
+  {
+    return _box.Min().X() <= _box.Max().X() &&
+        _box.Min().Y() <= _box.Max().Y() && _box.Min().Z() <= _box.Max().Z();
+  }
+}
+
+//////////////////////////////////////////////////
+SpatialIndexPrivate::CellRange SpatialIndexPrivate::Range(
+    const math::AxisAlignedBox &_box) const
+{
+  auto cell = [this](double _value)
+  {
+    const double index = std::floor(_value / this->cellSize);
+    return static_cast<int64_t>(std::clamp(index,
+        static_cast<double>(-kMaxCell), static_cast<double>(kMaxCell)));
+  };
+
+  CellRange range;
+  for (int i = 0; i < 3; ++i)
+  {
+    range.min[i] = cell(_box.Min()[i]);
+    range.max[i] = cell(_box.Max()[i]);
+  }
+  return range;
+}
+
+//////////////////////////////////////////////////
+uint64_t SpatialIndexPrivate::CellCount(const CellRange &_range)
+{
+  uint64_t count{1};
+  for (int i = 0; i < 3; ++i)
+    count *= static_cast<uint64_t>(_range.max[i] - _range.min[i] + 1);
+  return count;
+}
+
+//////////////////////////////////////////////////
+uint64_t SpatialIndexPrivate::Key(int64_t _x, int64_t _y, int64_t _z)
+{
+  // 21 bits per axis, offset so they're positive
+  constexpr uint64_t mask{(uint64_t{1} << 21) - 1};
+  return ((static_cast<uint64_t>(_x + kMaxCell) & mask) << 42) |
+      ((static_cast<uint64_t>(_y + kMaxCell) & mask) << 21) |
+      (static_cast<uint64_t>(_z + kMaxCell) & mask);
+}
+
+//////////////////////////////////////////////////
+void SpatialIndexPrivate::Insert(const Entity _entity, const Item &_item)
+{
+  if (_item.large)
+  {
+    this->large.emplace_back(_entity, &_item);
+    return;
+  }
+
+  const CellRange &r = _item.cells;
+  for (int64_t x = r.min[0]; x <= r.max[0]; ++x)
+    for (int64_t y = r.min[1]; y <= r.max[1]; ++y)
+      for (int64_t z = r.min[2]; z <= r.max[2]; ++z)
+        this->cells[Key(x, y, z)].emplace_back(_entity, &_item);
+}
+
+//////////////////////////////////////////////////
+void SpatialIndexPrivate::Erase(const Entity _entity, const Item &_item)
+{
+  auto eraseFrom = [_entity](std::vector<CellEntry> &_entries)
+  {
+    auto iter = std::find_if(_entries.begin(), _entries.end(),
+        [_entity](const CellEntry &_entry)
+        {
+          return _entry.first == _entity;
+        });
+    if (iter != _entries.end())
+    {
+      *iter = _entries.back();
+      _entries.pop_back();
+    }
+  };
+
+  if (_item.large)
+  {
+    eraseFrom(this->large);
+    return;
+  }
+
+  const CellRange &r = _item.cells;
+  for (int64_t x = r.min[0]; x <= r.max[0]; ++x)
+    for (int64_t y = r.min[1]; y <= r.max[1]; ++y)
+      for (int64_t z = r.min[2]; z <= r.max[2]; ++z)
+        eraseFrom(this->cells[Key(x, y, z)]);
+}
+
+//////////////////////////////////////////////////
+template<typename TestT>
+std::vector<Entity> SpatialIndexPrivate::Query(
+    const math::AxisAlignedBox &_bounds, const TestT &_test) const
+{
+  std::vector<Entity> result;
+  if (!Valid(_bounds))
+    return result;
+
+  const CellRange range = this->Range(_bounds);
+
+  // Visiting the cells would take longer than checking every entity
+  if (CellCount(range) > this->items.size())
+  {
+    for (const auto &[entity, item] : this->items)
+    {
+      if (Overlap(item.box, _bounds) && _test(item.box))
+        result.push_back(entity);
+    }
+    return result;
+  }
+
+  for (int64_t x = range.min[0]; x <= range.max[0]; ++x)
+  {
+    for (int64_t y = range.min[1]; y <= range.max[1]; ++y)
+    {
+      for (int64_t z = range.min[2]; z <= range.max[2]; ++z)
+      {
+        auto cellIter = this->cells.find(Key(x, y, z));
+        if (cellIter == this->cells.end())
+          continue;
+
+        const int64_t cell[3]{x, y, z};
+        for (const auto &[entity, item] : cellIter->second)
+        {
+          // An entity is in all the cells its box covers. Only check it in
+          // the first covered cell which is also part of the query.
+          bool first{true};
+          for (int i = 0; i < 3 && first; ++i)
+            first = cell[i] == std::max(item->cells.min[i], range.min[i]);
+
+          if (first && Overlap(item->box, _bounds) && _test(item->box))
+            result.push_back(entity);
+        }
+      }
+    }
+  }
+
+  for (const auto &[entity, item] : this->large)
+  {
+    if (Overlap(item->box, _bounds) && _test(item->box))
+      result.push_back(entity);
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+SpatialIndex::SpatialIndex(double _cellSize)
+  : dataPtr(std::make_unique<SpatialIndexPrivate>())
+{
+  this->SetCellSize(_cellSize);
+}
+
+//////////////////////////////////////////////////
+SpatialIndex::~SpatialIndex() = default;
+
+//////////////////////////////////////////////////
+double SpatialIndex::CellSize() const
+{
+  return this->dataPtr->cellSize;
+}
+
+//////////////////////////////////////////////////
+void SpatialIndex::SetCellSize(double _cellSize)
+{
+  if (!(_cellSize > 0.0))
+  {
+    ignerr << "Spatial index cell size must be positive, got [" << _cellSize
+           << "]." << std::endl;
+    return;
+  }
+
+  this->dataPtr->cellSize = _cellSize;
+
+  // Rebuild the grid
+  auto items = std::move(this->dataPtr->items);
+  this->Clear();
+  for (const auto &[entity, item] : items)
+    this->Update(entity, item.box);
+}
+
+//////////////////////////////////////////////////
+void SpatialIndex::Update(const Entity _entity,
+    const math::AxisAlignedBox &_box)
+{
+  if (!Valid(_box))
+  {
+    this->Remove(_entity);
+    return;
+  }
+
+  const auto cells = this->dataPtr->Range(_box);
+  const bool large =
+      SpatialIndexPrivate::CellCount(cells) > SpatialIndexPrivate::kMaxCells;
+
+  auto iter = this->dataPtr->items.find(_entity);
+  if (iter != this->dataPtr->items.end())
+  {
+    auto &item = iter->second;
+    item.box = _box;
+
+    // Moving within its cells
+    if (item.large == large && (large || item.cells == cells))
+      return;
+
+    this->dataPtr->Erase(_entity, item);
+    item.cells = cells;
+    item.large = large;
+    this->dataPtr->Insert(_entity, item);
+    return;
+  }
+
+  auto &item = this->dataPtr->items[_entity];
+  item.box = _box;
+  item.cells = cells;
+  item.large = large;
+  this->dataPtr->Insert(_entity, item);
+}
+
+//////////////////////////////////////////////////
+void SpatialIndex::Remove(const Entity _entity)
+{
+  auto iter = this->dataPtr->items.find(_entity);
+  if (iter == this->dataPtr->items.end())
+    return;
+
+  this->dataPtr->Erase(_entity, iter->second);
+  this->dataPtr->items.erase(iter);
+}
+
+//////////////////////////////////////////////////
+void SpatialIndex::Clear()
+{
+  this->dataPtr->items.clear();
+  this->dataPtr->cells.clear();
+  this->dataPtr->large.clear();
+}
+
+//////////////////////////////////////////////////
+std::size_t SpatialIndex::Size() const
+{
+  return this->dataPtr->items.size();
+}
+
+//////////////////////////////////////////////////
+std::optional<math::AxisAlignedBox> SpatialIndex::Box(
+    const Entity _entity) const
+{
+  auto iter = this->dataPtr->items.find(_entity);
+  if (iter == this->dataPtr->items.end())
+    return std::nullopt;
+  return iter->second.box;
+}
+
+//////////////////////////////////////////////////
+std::vector<Entity> SpatialIndex::QueryBox(
+    const math::AxisAlignedBox &_box) const
+{
+  IGN_PROFILE("SpatialIndex::QueryBox");
+  return this->dataPtr->Query(_box, [](const math::AxisAlignedBox &)
+  {
+    return true;
+  });
+}
+
+//////////////////////////////////////////////////
+std::vector<Entity> SpatialIndex::QuerySphere(const math::Vector3d &_center,
+    double _radius) const
+{
+  IGN_PROFILE("SpatialIndex::QuerySphere");
+  const math::Vector3d extent(_radius, _radius, _radius);
+  return this->dataPtr->Query(
+      math::AxisAlignedBox(_center - extent, _center + extent),
+      [&](const math::AxisAlignedBox &_box)
+      {
+        // Distance from the center to the closest point of the box
+        double distanceSquared{0.0};
+        for (int i = 0; i < 3; ++i)
+        {
+          const double closest =
+              std::clamp(_center[i], _box.Min()[i], _box.Max()[i]);
+          distanceSquared += (closest - _center[i]) * (closest - _center[i]);
+        }
+        return distanceSquared <= _radius * _radius;
+      });
+}
+
+//////////////////////////////////////////////////
+std::vector<Entity> SpatialIndex::QueryFrustum(
+    const math::Frustum &_frustum) const
+{
+  IGN_PROFILE("SpatialIndex::QueryFrustum");
+
+  // Bounds of the frustum's corners. Frustums look along +X.
+  const double tanHalfFov = std::tan(_frustum.FOV().Radian() * 0.5);
+  math::AxisAlignedBox bounds;
+  bool first{true};
+  for (double distance : {_frustum.Near(), _frustum.Far()})
+  {
+    const double halfWidth = distance * tanHalfFov;
+    const double halfHeight = halfWidth / _frustum.AspectRatio();
+    for (double y : {-halfWidth, halfWidth})
+    {
+      for (double z : {-halfHeight, halfHeight})
+      {
+        const math::Vector3d corner = _frustum.Pose().Pos() +
+            _frustum.Pose().Rot().RotateVector(
+            math::Vector3d(distance, y, z));
+        if (first)
+          bounds = math::AxisAlignedBox(corner, corner);
+        else
+          bounds.Merge(math::AxisAlignedBox(corner, corner));
+        first = false;
+      }
+    }
+  }
+
+  return this->dataPtr->Query(bounds, [&](const math::AxisAlignedBox &_box)
+  {
+    return _frustum.Contains(_box);
+  });
+}
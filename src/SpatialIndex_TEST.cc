@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <vector>
+
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Pose3.hh>
+
+#include "ignition/gazebo/SpatialIndex.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+/// \brief Get a box with equal corners.
+/// \param[in] _x X position.
+/// \param[in] _y Y position.
+/// \param[in] _z Z position.
+/// \return Box.
+math::AxisAlignedBox Point(double _x, double _y, double _z)
+{
+  return math::AxisAlignedBox({_x, _y, _z}, {_x, _y, _z});
+}
+
+/////////////////////////////////////////////////
+/// \brief Sort query results, whose order is unspecified.
+/// \param[in] _entities Query result.
+/// \return Sorted entities.
+std::set<Entity> Sorted(const std::vector<Entity> &_entities)
+{
+  return std::set<Entity>(_entities.begin(), _entities.end());
+}
+
+/////////////////////////////////////////////////
+TEST(SpatialIndex, UpdateRemove)
+{
+  SpatialIndex index(2.0);
+  EXPECT_DOUBLE_EQ(2.0, index.CellSize());
+  EXPECT_EQ(0u, index.Size());
+
+  index.Update(1, Point(0, 0, 0));
+  index.Update(2, math::AxisAlignedBox({-3, -3, -3}, {3, 3, 3}));
+  EXPECT_EQ(2u, index.Size());
+  ASSERT_TRUE(index.Box(2).has_value());
+  EXPECT_EQ(math::AxisAlignedBox({-3, -3, -3}, {3, 3, 3}), *index.Box(2));
+  EXPECT_FALSE(index.Box(3).has_value());
+
+  // Moving across cells
+  index.Update(1, Point(10, 0, 0));
+  EXPECT_EQ(2u, index.Size());
+  EXPECT_EQ(std::set<Entity>({1}), Sorted(index.QueryBox(Point(10, 0, 0))));
+  EXPECT_EQ(std::set<Entity>({2}), Sorted(index.QueryBox(
+      math::AxisAlignedBox({-0.5, -0.5, -0.5}, {0.5, 0.5, 0.5}))));
+
+  // Invalid boxes remove the entity
+  index.Update(2, math::AxisAlignedBox());
+  EXPECT_FALSE(index.Box(2).has_value());
+
+  index.Remove(1);
+  index.Remove(100);
+  EXPECT_EQ(0u, index.Size());
+  EXPECT_TRUE(index.QueryBox(Point(10, 0, 0)).empty());
+
+  index.Update(3, Point(1, 1, 1));
+  index.Clear();
+  EXPECT_EQ(0u, index.Size());
+
+  // Invalid cell sizes are ignored
+  index.SetCellSize(0.0);
+  EXPECT_DOUBLE_EQ(2.0, index.CellSize());
+}
+
+/////////////////////////////////////////////////
+TEST(SpatialIndex, Queries)
+{
+  SpatialIndex index(1.0);
+  for (Entity e = 0; e < 10; ++e)
+    index.Update(e, Point(static_cast<double>(e), 0, 0));
+
+  // Spans many cells, so it's checked by all queries
+  const Entity ground{100};
+  index.Update(ground, math::AxisAlignedBox({-100, -100, -3}, {100, 100, -2}));
+
+  // Spans a few cells, so it's only reported once
+  const Entity table{101};
+  index.Update(table, math::AxisAlignedBox({2, -1, 0}, {4, 1, 1}));
+
+  EXPECT_EQ(std::set<Entity>({2, 3, table}), Sorted(index.QueryBox(
+      math::AxisAlignedBox({1.5, -0.5, -0.5}, {3.5, 0.5, 0.5}))));
+  EXPECT_EQ(std::set<Entity>({ground}), Sorted(index.QueryBox(
+      math::AxisAlignedBox({50, 50, -2.5}, {60, 60, -2.5}))));
+  EXPECT_EQ(std::set<Entity>({table}), Sorted(index.QueryBox(
+      math::AxisAlignedBox({3, 0.5, 0.5}, {3.5, 1, 1}))));
+  EXPECT_TRUE(index.QueryBox(Point(50, 50, 50)).empty());
+
+  // Spheres are exact, not just their bounds
+  EXPECT_EQ(std::set<Entity>({5, 6, 7}),
+      Sorted(index.QuerySphere({6, 0, 0}, 1.0)));
+  EXPECT_EQ(std::set<Entity>({9}),
+      Sorted(index.QuerySphere({9.5, 0.5, 0.5}, 1.0)));
+  EXPECT_TRUE(index.QuerySphere({9.9, 0.9, 0.9}, 1.0).empty());
+
+  // Huge queries check all entities instead of all cells
+  EXPECT_EQ(12u, index.QuerySphere({0, 0, 0}, 1e6).size());
+
+  // Frustum at the origin looking along +X
+  math::Frustum frustum(0.5, 5.5, math::Angle(IGN_PI_2), 1.0,
+      math::Pose3d(0, 0, 0.1, 0, 0, 0));
+  EXPECT_EQ(std::set<Entity>({1, 2, 3, 4, 5, ground, table}),
+      Sorted(index.QueryFrustum(frustum)));
+
+  // Cell size changes keep entities
+  index.SetCellSize(0.25);
+  EXPECT_EQ(12u, index.Size());
+  EXPECT_EQ(std::set<Entity>({5, 6, 7}),
+      Sorted(index.QuerySphere({6, 0, 0}, 1.0)));
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "StartupProfile.hh"
+
+using namespace ignition::gazebo;
+
+namespace
+{
+/// \brief Innermost scope of the calling thread.
+thread_local StartupScope *tlsCurrentScope{nullptr};
+
+/// \brief Get a duration in milliseconds.
+/// \param[in] _duration Duration.
+/// \return Milliseconds.
+double toMs(const std::chrono::steady_clock::duration &_duration)
+{
+  return std::chrono::duration<double, std::milli>(_duration).count();
+}
+}
+
+//////////////////////////////////////////////////
+void StartupProfile::AddPhase(const std::string &_phase,
+    const std::chrono::steady_clock::duration &_duration)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  Add(this->phases, _phase, _duration);
+}
+
+//////////////////////////////////////////////////
+void StartupProfile::AddModel(const std::string &_model,
+    const std::chrono::steady_clock::duration &_duration)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  Add(this->models, _model, _duration);
+}
+
+//////////////////////////////////////////////////
+void StartupProfile::AddSystem(const std::string &_system,
+    const std::chrono::steady_clock::duration &_duration)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  Add(this->systems, _system, _duration);
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration StartupProfile::PhaseTime(
+    const std::string &_phase) const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return Find(this->phases, _phase);
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration StartupProfile::ModelTime(
+    const std::string &_model) const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return Find(this->models, _model);
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration StartupProfile::Total() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  std::chrono::steady_clock::duration total{0};
+  for (const auto &phase : this->phases.list)
+    total += phase.second;
+  return total;
+}
+
+//////////////////////////////////////////////////
+std::string StartupProfile::Report(std::size_t _maxEntries) const
+{
+  const auto total = this->Total();
+
+  std::lock_guard<std::mutex> lock(this->mutex);
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(1);
+  out << "Startup took [" << toMs(total) << "] ms." << std::endl;
+  for (const auto &phase : this->phases.list)
+  {
+    out << "  " << phase.first << ": [" << toMs(phase.second) << "] ms";
+    if (total.count() > 0)
+      out << " (" << 100.0 * phase.second.count() / total.count() << "%)";
+    out << std::endl;
+  }
+
+  // Only the slowest models and systems are listed
+  using List = decltype(Entries::list);
+  auto slowest = [&](const std::string &_title, List _entries)
+  {
+    if (_entries.empty())
+      return;
+
+    std::stable_sort(_entries.begin(), _entries.end(),
+        [](const auto &_a, const auto &_b)
+        {
+          return _a.second > _b.second;
+        });
+    out << "Slowest " << _title << " of [" << _entries.size() << "]:"
+        << std::endl;
+    for (std::size_t i = 0; i < std::min(_maxEntries, _entries.size()); ++i)
+    {
+      out << "  " << _entries[i].first << ": [" << toMs(_entries[i].second)
+          << "] ms" << std::endl;
+    }
+  };
+  slowest("models", this->models.list);
+  slowest("systems in the first iteration", this->systems.list);
+
+  return out.str();
+}
+
+//////////////////////////////////////////////////
+void StartupProfile::Add(Entries &_entries, const std::string &_name,
+    const std::chrono::steady_clock::duration &_duration)
+{
+  auto inserted = _entries.index.emplace(_name, _entries.list.size());
+  if (inserted.second)
+    _entries.list.emplace_back(_name, _duration);
+  else
+    _entries.list[inserted.first->second].second += _duration;
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration StartupProfile::Find(
+    const Entries &_entries, const std::string &_name)
+{
+  auto iter = _entries.index.find(_name);
+  if (iter == _entries.index.end())
+    return std::chrono::steady_clock::duration::zero();
+  return _entries.list[iter->second].second;
+}
+
+//////////////////////////////////////////////////
+StartupScope::StartupScope(StartupProfile *_profile, const char *_phase)
+  : profile(_profile), phase(_phase)
+{
+  if (!this->profile)
+    return;
+
+  this->parent = tlsCurrentScope;
+  tlsCurrentScope = this;
+  this->start = std::chrono::steady_clock::now();
+}
+
+//////////////////////////////////////////////////
+StartupProfile *StartupScope::Current()
+{
+  return tlsCurrentScope ? tlsCurrentScope->profile : nullptr;
+}
+
+//////////////////////////////////////////////////
+StartupScope::~StartupScope()
+{
+  if (!this->profile)
+    return;
+
+  const auto duration = std::chrono::steady_clock::now() - this->start;
+  this->profile->AddPhase(this->phase, duration - this->nested);
+
+  tlsCurrentScope = this->parent;
+  if (this->parent)
+    this->parent->nested += duration;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_STARTUPPROFILE_HH_
+#define IGNITION_GAZEBO_STARTUPPROFILE_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class StartupProfile StartupProfile.hh
+    /// \brief Wall time spent in each phase of starting a server, such as
+    /// parsing SDF, fetching resources and loading plugins, in each model
+    /// and in each system during the first iteration. All functions are
+    /// thread safe.
+    class IGNITION_GAZEBO_VISIBLE StartupProfile
+    {
+      /// \brief Add time to a phase.
+      /// \param[in] _phase Name of the phase.
+      /// \param[in] _duration Time spent.
+      public: void AddPhase(const std::string &_phase,
+                  const std::chrono::steady_clock::duration &_duration);
+
+      /// \brief Add time to a model, spent creating its entities and
+      /// loading its plugins.
+      /// \param[in] _model Name of the model.
+      /// \param[in] _duration Time spent.
+      public: void AddModel(const std::string &_model,
+                  const std::chrono::steady_clock::duration &_duration);
+
+      /// \brief Add time to a system, spent in its calls during the first
+      /// iteration.
+      /// \param[in] _system Name of the system.
+      /// \param[in] _duration Time spent.
+      public: void AddSystem(const std::string &_system,
+                  const std::chrono::steady_clock::duration &_duration);
+
+      /// \brief Get the time spent in a phase.
+      /// \param[in] _phase Name of the phase.
+      /// \return Time spent, zero for unknown phases.
+      public: std::chrono::steady_clock::duration PhaseTime(
+                  const std::string &_phase) const;
+
+      /// \brief Get the time spent in a model.
+      /// \param[in] _model Name of the model.
+      /// \return Time spent, zero for unknown models.
+      public: std::chrono::steady_clock::duration ModelTime(
+                  const std::string &_model) const;
+
+      /// \brief Get the total time of all phases.
+      /// \return Time spent.
+      public: std::chrono::steady_clock::duration Total() const;
+
+      /// \brief Get a report of the phases, in the order they were first
+      /// recorded, and of the slowest models and systems.
+      /// \param[in] _maxEntries Number of models and of systems listed.
+      /// \return Multi line report.
+      public: std::string Report(std::size_t _maxEntries = 10) const;
+
+      /// \brief Durations by name, in the order names were first added.
+      private: struct Entries
+      {
+        /// \brief Names and durations.
+        std::vector<std::pair<std::string,
+            std::chrono::steady_clock::duration>> list;
+
+        /// \brief Index in the list by name.
+        std::unordered_map<std::string, std::size_t> index;
+      };
+
+      /// \brief Add time to an entry.
+      /// \param[in] _entries Entries to add to.
+      /// \param[in] _name Name of the entry.
+      /// \param[in] _duration Time spent.
+      private: static void Add(Entries &_entries, const std::string &_name,
+                  const std::chrono::steady_clock::duration &_duration);
+
+      /// \brief Get the time of an entry.
+      /// \param[in] _entries Entries to search.
+      /// \param[in] _name Name of the entry.
+      /// \return Time spent, zero if there's no such entry.
+      private: static std::chrono::steady_clock::duration Find(
+                  const Entries &_entries, const std::string &_name);
+
+      /// \brief Protects all entries.
+      private: mutable std::mutex mutex;
+
+      /// \brief Phases.
+      private: Entries phases;
+
+      /// \brief Models.
+      private: Entries models;
+
+      /// \brief Systems.
+      private: Entries systems;
+    };
+
+    /// \brief Adds the wall time of a scope to a phase of a StartupProfile.
+    /// Time spent in scopes nested in it on the same thread only counts for
+    /// the nested phase, so phases add up to the total startup time.
+    class IGNITION_GAZEBO_VISIBLE StartupScope
+    {
+      /// \brief Constructor, starts the scope.
+      /// \param[in] _profile Profile to record into, or nullptr to record
+      /// nothing.
+      /// \param[in] _phase Name of the phase, a string literal.
+      public: StartupScope(StartupProfile *_profile, const char *_phase);
+
+      /// \brief Destructor, adds the time since construction to the phase.
+      public: ~StartupScope();
+
+      /// \brief No copy.
+      public: StartupScope(const StartupScope &) = delete;
+
+      /// \brief No copy assignment.
+      public: StartupScope &operator=(const StartupScope &) = delete;
+
+      /// \brief Get the profile of the innermost scope of the calling thread,
+      /// for code which records into the profile without being given one.
+      /// \return The profile, nullptr if no scope is recording.
+      public: static StartupProfile *Current();
+
+      /// \brief Profile, or nullptr.
+      private: StartupProfile *profile;
+
+      /// \brief Name of the phase.
+      private: const char *phase;
+
+      /// \brief Start time.
+      private: std::chrono::steady_clock::time_point start;
+
+      /// \brief Time spent in nested scopes.
+      private: std::chrono::steady_clock::duration nested{0};
+
+      /// \brief Scope this one is nested in, or nullptr.
+      private: StartupScope *parent{nullptr};
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_STARTUPPROFILE_HH_
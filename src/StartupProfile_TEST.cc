@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "StartupProfile.hh"
+
+using namespace ignition::gazebo;
+using namespace std::chrono_literals;
+
+/////////////////////////////////////////////////
+TEST(StartupProfileTest, Entries)
+{
+  StartupProfile profile;
+  EXPECT_EQ(0ns, profile.Total());
+  EXPECT_EQ(0ns, profile.PhaseTime("sdf"));
+
+  profile.AddPhase("sdf", 3ms);
+  profile.AddPhase("plugins", 2ms);
+  profile.AddPhase("sdf", 1ms);
+  EXPECT_EQ(4ms, profile.PhaseTime("sdf"));
+  EXPECT_EQ(2ms, profile.PhaseTime("plugins"));
+  EXPECT_EQ(6ms, profile.Total());
+
+  profile.AddModel("small", 1ms);
+  profile.AddModel("large", 5ms);
+  profile.AddModel("medium", 3ms);
+  EXPECT_EQ(5ms, profile.ModelTime("large"));
+  EXPECT_EQ(0ns, profile.ModelTime("missing"));
+  profile.AddSystem("Physics", 7ms);
+
+  // Phases keep their order, models are listed slowest first, up to the
+  // given number
+  const std::string report = profile.Report(2);
+  EXPECT_NE(std::string::npos, report.find("Startup took [6.0] ms"));
+  EXPECT_LT(report.find("sdf: [4.0] ms"), report.find("plugins: [2.0] ms"));
+  EXPECT_NE(std::string::npos, report.find("Slowest models of [3]"));
+  EXPECT_LT(report.find("large"), report.find("medium"));
+  EXPECT_EQ(std::string::npos, report.find("small"));
+  EXPECT_NE(std::string::npos, report.find("Physics: [7.0] ms"));
+}
+
+/////////////////////////////////////////////////
+TEST(StartupProfileTest, NestedScopes)
+{
+  StartupProfile profile;
+  {
+    StartupScope outer(&profile, "outer");
+    std::this_thread::sleep_for(10ms);
+    {
+      StartupScope inner(&profile, "inner");
+      std::this_thread::sleep_for(20ms);
+    }
+
+    // Scopes without a profile record nothing and don't affect others
+    StartupScope ignored(nullptr, "ignored");
+    EXPECT_EQ(&profile, StartupScope::Current());
+  }
+  EXPECT_EQ(nullptr, StartupScope::Current());
+
+  // Nested time only counts for the inner phase
+  const auto outer = profile.PhaseTime("outer");
+  const auto inner = profile.PhaseTime("inner");
+  EXPECT_GE(outer, 10ms);
+  EXPECT_LT(outer, 20ms);
+  EXPECT_GE(inner, 20ms);
+  EXPECT_EQ(0ns, profile.PhaseTime("ignored"));
+  EXPECT_EQ(outer + inner, profile.Total());
+}
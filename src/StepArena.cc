@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "StepArena.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+StepArena::StepArena(std::size_t _capacity)
+  : buffer(_capacity)
+{
+  this->CreateArena();
+}
+
+/////////////////////////////////////////////////
+void StepArena::Reset()
+{
+  // Destroying the arena returns the overflow blocks
+  const std::size_t overflowBytes = this->overflow.bytes;
+  this->arena.reset();
+  this->overflow.bytes = 0;
+
+  if (overflowBytes > 0)
+  {
+    // Overflow blocks grow geometrically, so their total is at least the
+    // memory which didn't fit
+    const std::size_t capacity = this->buffer.size() + overflowBytes;
+    this->buffer = std::vector<std::byte>(capacity);
+  }
+
+  this->CreateArena();
+}
+
+/////////////////////////////////////////////////
+void StepArena::CreateArena()
+{
+  if (this->buffer.empty())
+  {
+    this->arena.emplace(&this->overflow);
+  }
+  else
+  {
+    this->arena.emplace(this->buffer.data(), this->buffer.size(),
+        &this->overflow);
+  }
+}
+
+/////////////////////////////////////////////////
+std::size_t StepArena::Capacity() const
+{
+  return this->buffer.size();
+}
+
+/////////////////////////////////////////////////
+std::size_t StepArena::Overflow() const
+{
+  return this->overflow.bytes;
+}
+
+/////////////////////////////////////////////////
+void *StepArena::do_allocate(std::size_t _bytes, std::size_t _alignment)
+{
+  return this->arena->allocate(_bytes, _alignment);
+}
+
+/////////////////////////////////////////////////
+void StepArena::do_deallocate(void *, std::size_t, std::size_t)
+{
+  // Memory is released by Reset
+}
+
+/////////////////////////////////////////////////
+bool StepArena::do_is_equal(const std::pmr::memory_resource &_other) const
+    noexcept
+{
+  return this == &_other;
+}
+
+/////////////////////////////////////////////////
+void *StepArena::OverflowResource::do_allocate(std::size_t _bytes,
+    std::size_t _alignment)
+{
+  this->bytes += _bytes;
+  return std::pmr::new_delete_resource()->allocate(_bytes, _alignment);
+}
+
+/////////////////////////////////////////////////
+void StepArena::OverflowResource::do_deallocate(void *_p, std::size_t _bytes,
+    std::size_t _alignment)
+{
+  std::pmr::new_delete_resource()->deallocate(_p, _bytes, _alignment);
+}
+
+/////////////////////////////////////////////////
+bool StepArena::OverflowResource::do_is_equal(
+    const std::pmr::memory_resource &_other) const noexcept
+{
+  return this == &_other;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_STEPARENA_HH_
+#define IGNITION_GAZEBO_STEPARENA_HH_
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class StepArena StepArena.hh
+    /// \brief A memory resource for temporaries which only live during one
+    /// iteration.
+    ///
+    /// Allocations bump a pointer into a buffer and deallocations do
+    /// nothing. All memory is released at once by Reset, and the buffer
+    /// grows to the most memory used between two resets, so once that is
+    /// reached iterations don't allocate from the global allocator at all.
+    /// It isn't thread safe.
+    class IGNITION_GAZEBO_VISIBLE StepArena : public std::pmr::memory_resource
+    {
+      /// \brief Constructor
+      /// \param[in] _capacity Initial size of the buffer in bytes.
+      public: explicit StepArena(std::size_t _capacity = 0);
+
+      /// \brief Release all the memory allocated since the last reset. If
+      /// the buffer was too small, it's replaced by one large enough to hold
+      /// everything that was allocated.
+      public: void Reset();
+
+      /// \brief Get the size of the buffer.
+      /// \return Size of the buffer in bytes.
+      public: std::size_t Capacity() const;
+
+      /// \brief Get the memory allocated since the last reset which didn't
+      /// fit in the buffer.
+      /// \return Size in bytes, including unused memory of overflow blocks.
+      public: std::size_t Overflow() const;
+
+      /// \brief Create the arena over the current buffer.
+      private: void CreateArena();
+
+      // Documentation inherited
+      private: void *do_allocate(std::size_t _bytes,
+                   std::size_t _alignment) override;
+
+      // Documentation inherited
+      private: void do_deallocate(void *_p, std::size_t _bytes,
+                   std::size_t _alignment) override;
+
+      // Documentation inherited
+      private: bool do_is_equal(
+                   const std::pmr::memory_resource &_other) const
+                   noexcept override;
+
+      /// \brief Counts the memory the arena gets from the global allocator
+      /// once the buffer is full.
+      private: class OverflowResource : public std::pmr::memory_resource
+      {
+        // Documentation inherited
+        private: void *do_allocate(std::size_t _bytes,
+                     std::size_t _alignment) override;
+
+        // Documentation inherited
+        private: void do_deallocate(void *_p, std::size_t _bytes,
+                     std::size_t _alignment) override;
+
+        // Documentation inherited
+        private: bool do_is_equal(
+                     const std::pmr::memory_resource &_other) const
+                     noexcept override;
+
+        /// \brief Bytes allocated since the arena was created.
+        public: std::size_t bytes{0};
+      };
+
+      /// \brief Buffer allocations are served from.
+      private: std::vector<std::byte> buffer;
+
+      /// \brief Source of the blocks used once the buffer is full.
+      private: OverflowResource overflow;
+
+      /// \brief Arena handing out the buffer, recreated on every reset.
+      private: std::optional<std::pmr::monotonic_buffer_resource> arena;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_STEPARENA_HH_
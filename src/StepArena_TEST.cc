@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "StepArena.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+//////////////////////////////////////////////////
+TEST(StepArena, Alignment)
+{
+  StepArena arena;
+  EXPECT_NE(nullptr, arena.allocate(1, 1));
+  void *p = arena.allocate(64, 64);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(p) % 64);
+}
+
+//////////////////////////////////////////////////
+TEST(StepArena, GrowsToPeak)
+{
+  StepArena arena;
+  EXPECT_EQ(0u, arena.Capacity());
+
+  auto fill = [&arena]()
+  {
+    std::pmr::vector<int> values(&arena);
+    for (int i = 0; i < 1000; ++i)
+      values.push_back(i);
+    EXPECT_EQ(999, values.back());
+  };
+
+  // The first iteration overflows
+  fill();
+  EXPECT_GE(arena.Overflow(), 1000 * sizeof(int));
+
+  // The buffer grows and holds everything from then on
+  arena.Reset();
+  EXPECT_EQ(0u, arena.Overflow());
+  const std::size_t capacity = arena.Capacity();
+  EXPECT_GE(capacity, 1000 * sizeof(int));
+
+  for (int i = 0; i < 10; ++i)
+  {
+    fill();
+    EXPECT_EQ(0u, arena.Overflow());
+    arena.Reset();
+    EXPECT_EQ(capacity, arena.Capacity());
+  }
+}
+
+//////////////////////////////////////////////////
+TEST(StepArena, Reuse)
+{
+  StepArena arena(1024);
+  EXPECT_EQ(1024u, arena.Capacity());
+
+  void *first = arena.allocate(16);
+  EXPECT_NE(first, arena.allocate(16));
+
+  // Memory is handed out again after a reset
+  arena.Reset();
+  EXPECT_EQ(first, arena.allocate(16));
+  EXPECT_EQ(0u, arena.Overflow());
+}
@@ -15,8 +15,10 @@
  *
 */
 
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <ignition/gazebo/SystemLoader.hh>
@@ -41,11 +43,26 @@ class ignition::gazebo::SystemLoaderPrivate
   public: explicit SystemLoaderPrivate() = default;
 
   //////////////////////////////////////////////////
-  public: bool InstantiateSystemPlugin(const std::string &_filename,
-              const std::string &_name,
-              const sdf::ElementPtr &/*_sdf*/,
-              ignition::plugin::PluginPtr &_plugin)
+  /// \brief Find the shared library for a plugin filename.
+  /// \param[in] _filename Plugin filename, as given in SDF.
+  /// \return Full path to the library, or empty if it wasn't found.
+  public: std::string FindLibrary(const std::string &_filename)
   {
+    // The search path environment variable may be changed at runtime
+    std::string envPaths;
+    ignition::common::env(this->pluginPathEnv, envPaths);
+    if (envPaths != this->cachedEnvPaths)
+    {
+      this->libraryPaths.clear();
+      this->cachedEnvPaths = envPaths;
+    }
+
+    // Both hits and misses are remembered, so spawning the same plugin
+    // repeatedly doesn't search the filesystem every time.
+    auto it = this->libraryPaths.find(_filename);
+    if (it != this->libraryPaths.end())
+      return it->second;
+
     ignition::common::SystemPaths systemPaths;
     systemPaths.SetPluginPathEnv(pluginPathEnv);
 
@@ -58,6 +75,19 @@ class ignition::gazebo::SystemLoaderPrivate
     systemPaths.AddPluginPaths(IGN_GAZEBO_PLUGIN_INSTALL_DIR);
 
     auto pathToLib = systemPaths.FindSharedLibrary(_filename);
+    this->libraryPaths[_filename] = pathToLib;
+    return pathToLib;
+  }
+
+  //////////////////////////////////////////////////
+  public: bool InstantiateSystemPlugin(const std::string &_filename,
+              const std::string &_name,
+              const sdf::ElementPtr &/*_sdf*/,
+              ignition::plugin::PluginPtr &_plugin)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    auto pathToLib = this->FindLibrary(_filename);
     if (pathToLib.empty())
     {
       // We assume ignition::gazebo corresponds to the levels feature
@@ -69,22 +99,19 @@ class ignition::gazebo::SystemLoaderPrivate
       return false;
     }
 
-    auto pluginNames = this->loader.LoadLib(pathToLib);
-    if (pluginNames.empty())
-    {
-      ignerr << "Failed to load system plugin [" << _filename <<
-                "] : couldn't load library on path [" << pathToLib <<
-                "]." << std::endl;
-      return false;
-    }
-
-    auto pluginName = *pluginNames.begin();
-    if (pluginName.empty())
+    // Only open each library once, later instances are created from the
+    // plugins it already registered with the loader.
+    if (this->loadedLibraries.find(pathToLib) == this->loadedLibraries.end())
     {
-      ignerr << "Failed to load system plugin [" << _filename <<
-                "] : couldn't load library on path [" << pathToLib <<
-                "]." << std::endl;
-      return false;
+      auto pluginNames = this->loader.LoadLib(pathToLib);
+      if (pluginNames.empty() || pluginNames.begin()->empty())
+      {
+        ignerr << "Failed to load system plugin [" << _filename <<
+                  "] : couldn't load library on path [" << pathToLib <<
+                  "]." << std::endl;
+        return false;
+      }
+      this->loadedLibraries.insert(pathToLib);
     }
 
     _plugin = this->loader.Instantiate(_name);
@@ -120,6 +147,21 @@ class ignition::gazebo::SystemLoaderPrivate
 
   /// \brief System plugins that have instances loaded via the manager.
   public: std::unordered_set<SystemPluginPtr> systemPluginsAdded;
+
+  /// \brief Resolved library path for each plugin filename. An empty path
+  /// means the library couldn't be found.
+  public: std::unordered_map<std::string, std::string> libraryPaths;
+
+  /// \brief Value of the plugin path environment variable when
+  /// libraryPaths was filled.
+  public: std::string cachedEnvPaths;
+
+  /// \brief Paths of libraries which have already been loaded.
+  public: std::unordered_set<std::string> loadedLibraries;
+
+  /// \brief Protects the loader and caches, which may be shared by the
+  /// runners of several worlds.
+  public: std::mutex mutex;
 };
 
 //////////////////////////////////////////////////
@@ -134,7 +176,12 @@ SystemLoader::~SystemLoader() = default;
 //////////////////////////////////////////////////
 void SystemLoader::AddSystemPluginPath(const std::string &_path)
 {
-  this->dataPtr->systemPluginPaths.insert(_path);
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (this->dataPtr->systemPluginPaths.insert(_path).second)
+  {
+    // A new path may change where, or whether, libraries are found
+    this->dataPtr->libraryPaths.clear();
+  }
 }
 
 //////////////////////////////////////////////////
@@ -180,6 +227,7 @@ std::optional<SystemPluginPtr> SystemLoader::LoadPlugin(
 //////////////////////////////////////////////////
 std::string SystemLoader::PrettyStr() const
 {
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
   return this->dataPtr->loader.PrettyStr();
 }
 
@@ -65,3 +65,30 @@ TEST(SystemLoader, EmptyNames)
   auto system = sm.LoadPlugin("", "", element);
   ASSERT_FALSE(system.has_value());
 }
+
+/////////////////////////////////////////////////
+TEST(SystemLoader, RepeatedLoads)
+{
+  gazebo::SystemLoader sm;
+
+  auto testBuildPath = ignition::common::joinPaths(
+      std::string(PROJECT_BINARY_PATH), "lib");
+  sm.AddSystemPluginPath(testBuildPath);
+
+  const std::string filename = std::string("libignition-gazebo") +
+      IGNITION_GAZEBO_MAJOR_VERSION_STR + "-physics-system.so";
+  const std::string name = "ignition::gazebo::systems::Physics";
+  sdf::ElementPtr element;
+
+  // Each load gives a separate instance, even though the library is only
+  // searched for and opened once
+  auto first = sm.LoadPlugin(filename, name, element);
+  ASSERT_TRUE(first.has_value());
+  auto second = sm.LoadPlugin(filename, name, element);
+  ASSERT_TRUE(second.has_value());
+  EXPECT_NE(first.value(), second.value());
+
+  // Missing libraries keep failing
+  EXPECT_FALSE(sm.LoadPlugin("libnot-a-plugin.so", name, element).has_value());
+  EXPECT_FALSE(sm.LoadPlugin("libnot-a-plugin.so", name, element).has_value());
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <set>
+
+#include "SystemStages.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+namespace
+{
+//////////////////////////////////////////////////
+/// \brief Check whether two sets have elements in common.
+/// \param[in] _a A sorted set.
+/// \param[in] _b Another sorted set.
+/// \return True if an element is in both sets.
+template<typename T>
+bool Intersects(const std::set<T> &_a, const std::set<T> &_b)
+{
+  auto aIt = _a.begin();
+  auto bIt = _b.begin();
+  while (aIt != _a.end() && bIt != _b.end())
+  {
+    if (*aIt < *bIt)
+      ++aIt;
+    else if (*bIt < *aIt)
+      ++bIt;
+    else
+      return true;
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check whether an entity is another entity or one of its
+/// ancestors.
+/// \param[in] _ancestor Potential ancestor.
+/// \param[in] _entity Entity whose ancestors are checked.
+/// \param[in] _ecm Entity component manager holding the entity tree.
+/// \return True if _ancestor is _entity or one of its ancestors.
+bool IsSelfOrAncestor(Entity _ancestor, Entity _entity,
+    const EntityComponentManager &_ecm)
+{
+  while (kNullEntity != _entity)
+  {
+    if (_entity == _ancestor)
+      return true;
+    _entity = _ecm.ParentEntity(_entity);
+  }
+  return false;
+}
+}
+
+//////////////////////////////////////////////////
+bool ignition::gazebo::AccessConflicts(const ComponentAccess &_a,
+    const ComponentAccess &_b, const EntityComponentManager &_ecm)
+{
+  // Reading the same types is fine.
+  if (!Intersects(_a.writes, _b.writes) &&
+      !Intersects(_a.writes, _b.reads) &&
+      !Intersects(_b.writes, _a.reads))
+  {
+    return false;
+  }
+
+  // Unrestricted access overlaps with everything.
+  if (_a.entities.empty() || _b.entities.empty())
+    return true;
+
+  for (const Entity a : _a.entities)
+  {
+    for (const Entity b : _b.entities)
+    {
+      if (IsSelfOrAncestor(a, b, _ecm) || IsSelfOrAncestor(b, a, _ecm))
+        return true;
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+std::vector<std::vector<std::size_t>> ignition::gazebo::ComputeSystemStages(
+    const std::vector<std::optional<ComponentAccess>> &_access,
+    const EntityComponentManager &_ecm)
+{
+  std::vector<std::vector<std::size_t>> stages;
+
+  // Whether the last stage can take more systems.
+  bool open{false};
+  for (std::size_t i = 0; i < _access.size(); ++i)
+  {
+    if (!_access[i])
+    {
+      // Undeclared access runs alone.
+      stages.push_back({i});
+      open = false;
+      continue;
+    }
+
+    bool conflict{!open};
+    if (open)
+    {
+      for (const std::size_t other : stages.back())
+      {
+        if (AccessConflicts(*_access[i], *_access[other], _ecm))
+        {
+          conflict = true;
+          break;
+        }
+      }
+    }
+
+    if (conflict)
+    {
+      stages.push_back({i});
+      open = true;
+    }
+    else
+    {
+      stages.back().push_back(i);
+    }
+  }
+
+  return stages;
+}
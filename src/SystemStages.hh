@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMSTAGES_HH_
+#define IGNITION_GAZEBO_SYSTEMSTAGES_HH_
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Export.hh>
+#include <ignition/gazebo/System.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief Check whether two systems can't run at the same time. That is
+    /// the case if one writes a component type the other one reads or
+    /// writes, for entities that overlap. An entity overlaps with another if
+    /// they are the same, or if one is an ancestor of the other.
+    /// \param[in] _a Access declared by one system.
+    /// \param[in] _b Access declared by the other system.
+    /// \param[in] _ecm Entity component manager holding the entity tree.
+    /// \return True if the accesses conflict.
+    bool IGNITION_GAZEBO_VISIBLE AccessConflicts(const ComponentAccess &_a,
+        const ComponentAccess &_b, const EntityComponentManager &_ecm);
+
+    /// \brief Split systems into consecutive stages. The systems of a stage
+    /// can run at the same time, and stages run one after the other. The
+    /// order of conflicting systems is kept, and systems which don't declare
+    /// their access get a stage of their own.
+    /// \param[in] _access Access declared by each system, in the order the
+    /// systems run. nullopt for systems which don't declare it.
+    /// \param[in] _ecm Entity component manager holding the entity tree.
+    /// \return Indices into _access of the systems of each stage.
+    std::vector<std::vector<std::size_t>> IGNITION_GAZEBO_VISIBLE
+    ComputeSystemStages(
+        const std::vector<std::optional<ComponentAccess>> &_access,
+        const EntityComponentManager &_ecm);
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_SYSTEMSTAGES_HH_
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <vector>
+
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/System.hh"
+
+#include "SystemStages.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+class SystemStagesTest : public ::testing::Test
+{
+  protected: void SetUp() override
+  {
+    this->world = this->ecm.CreateEntity();
+    this->model1 = this->ecm.CreateEntity();
+    this->ecm.SetParentEntity(this->model1, this->world);
+    this->link1 = this->ecm.CreateEntity();
+    this->ecm.SetParentEntity(this->link1, this->model1);
+    this->model2 = this->ecm.CreateEntity();
+    this->ecm.SetParentEntity(this->model2, this->world);
+  }
+
+  /// \brief Create an access declaration.
+  public: static ComponentAccess Access(std::set<ComponentTypeId> _reads,
+      std::set<ComponentTypeId> _writes, std::set<Entity> _entities = {})
+  {
+    ComponentAccess access;
+    access.reads = std::move(_reads);
+    access.writes = std::move(_writes);
+    access.entities = std::move(_entities);
+    return access;
+  }
+
+  public: EntityComponentManager ecm;
+  public: Entity world{kNullEntity};
+  public: Entity model1{kNullEntity};
+  public: Entity link1{kNullEntity};
+  public: Entity model2{kNullEntity};
+};
+
+/////////////////////////////////////////////////
+TEST_F(SystemStagesTest, AccessConflicts)
+{
+  // Readers don't conflict
+  EXPECT_FALSE(AccessConflicts(Access({1, 2}, {}), Access({1}, {}), ecm));
+
+  // Writing a type the other one reads or writes conflicts
+  EXPECT_TRUE(AccessConflicts(Access({1}, {}), Access({}, {1}), ecm));
+  EXPECT_TRUE(AccessConflicts(Access({}, {1}), Access({1}, {}), ecm));
+  EXPECT_TRUE(AccessConflicts(Access({}, {1}), Access({}, {1}), ecm));
+
+  // Different types
+  EXPECT_FALSE(AccessConflicts(Access({1}, {2}), Access({1}, {3}), ecm));
+
+  // Same types on different models
+  EXPECT_FALSE(AccessConflicts(Access({}, {1}, {model1}),
+      Access({}, {1}, {model2}), ecm));
+
+  // Same types on a model and an entity inside it
+  EXPECT_TRUE(AccessConflicts(Access({}, {1}, {model1}),
+      Access({}, {1}, {link1}), ecm));
+  EXPECT_TRUE(AccessConflicts(Access({}, {1}, {link1}),
+      Access({}, {1}, {model1}), ecm));
+  EXPECT_TRUE(AccessConflicts(Access({}, {1}, {world}),
+      Access({}, {1}, {model2}), ecm));
+
+  // Unrestricted entities overlap with everything
+  EXPECT_TRUE(AccessConflicts(Access({}, {1}),
+      Access({}, {1}, {model2}), ecm));
+}
+
+/////////////////////////////////////////////////
+TEST_F(SystemStagesTest, ComputeSystemStages)
+{
+  EXPECT_TRUE(ComputeSystemStages({}, ecm).empty());
+
+  std::vector<std::optional<ComponentAccess>> access{
+    // 0 and 1 control different models, 2 reads what they write
+    Access({}, {1}, {model1}),
+    Access({}, {1}, {model2}),
+    Access({1}, {}),
+    // 3 doesn't declare anything
+    std::nullopt,
+    // 4 and 5 read the same types
+    Access({1}, {2}),
+    Access({1}, {3}),
+    // 6 is after an undeclared system again
+    std::nullopt,
+    Access({}, {4}),
+  };
+
+  auto stages = ComputeSystemStages(access, ecm);
+  std::vector<std::vector<std::size_t>> expected{
+    {0, 1}, {2}, {3}, {4, 5}, {6}, {7}};
+  EXPECT_EQ(expected, stages);
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ignition/gazebo/Util.hh"
+
+#include "TaskPool.hh"
+
+namespace
+{
+/// \brief A batch of tasks started by a single ParallelFor call.
+struct Batch
+{
+  /// \brief Function to call for each task.
+  const std::function<void(std::size_t)> *task{nullptr};
+
+  /// \brief Number of tasks.
+  std::size_t count{0};
+
+  /// \brief Index of the next task to be claimed.
+  std::atomic<std::size_t> next{0};
+
+  /// \brief Number of tasks that finished running.
+  std::atomic<std::size_t> done{0};
+};
+}
+
+class ignition::gazebo::TaskPoolPrivate
+{
+  /// \brief Run tasks of a batch until there are none left to claim.
+  /// \param[in] _batch The batch.
+  public: void Run(Batch &_batch);
+
+  /// \brief Main loop of each worker thread.
+  /// \param[in] _cpus CPUs to pin the worker to, empty to not pin it.
+  public: void Worker(const std::vector<unsigned int> &_cpus);
+
+  /// \brief Mutex protecting the queue of batches.
+  public: std::mutex mutex;
+
+  /// \brief Signaled when a batch is queued or the pool is stopped.
+  public: std::condition_variable workCv;
+
+  /// \brief Signaled when a batch finishes.
+  public: std::condition_variable doneCv;
+
+  /// \brief Batches with tasks that may still need to be claimed.
+  public: std::deque<std::shared_ptr<Batch>> batches;
+
+  /// \brief True when the worker threads should exit.
+  public: bool stop{false};
+
+  /// \brief Worker threads.
+  public: std::vector<std::thread> workers;
+};
+
+using namespace ignition::gazebo;
+
+//////////////////////////////////////////////////
+void TaskPoolPrivate::Run(Batch &_batch)
+{
+  std::size_t executed{0};
+  for (std::size_t i = _batch.next++; i < _batch.count; i = _batch.next++)
+  {
+    (*_batch.task)(i);
+    ++executed;
+  }
+
+  if (executed > 0 && _batch.done.fetch_add(executed) + executed ==
+      _batch.count)
+  {
+    // Lock so the waiting thread can't miss the notification between
+    // checking its condition and going to sleep.
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+    }
+    this->doneCv.notify_all();
+  }
+}
+
+//////////////////////////////////////////////////
+void TaskPoolPrivate::Worker(const std::vector<unsigned int> &_cpus)
+{
+  setThreadAffinity(_cpus);
+
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (true)
+  {
+    this->workCv.wait(lock, [this]
+    {
+      return this->stop || !this->batches.empty();
+    });
+
+    if (this->stop)
+      return;
+
+    std::shared_ptr<Batch> batch = this->batches.front();
+    lock.unlock();
+    this->Run(*batch);
+    lock.lock();
+
+    // All tasks of the batch have been claimed, so other workers don't
+    // need to look at it anymore.
+    if (!this->batches.empty() && this->batches.front() == batch)
+      this->batches.pop_front();
+  }
+}
+
+//////////////////////////////////////////////////
+TaskPool::TaskPool(unsigned int _threadCount,
+    const std::vector<unsigned int> &_cpus)
+  : dataPtr(std::make_unique<TaskPoolPrivate>())
+{
+  if (_threadCount == 0)
+  {
+    const unsigned int hardware = std::thread::hardware_concurrency();
+    _threadCount = hardware > 1 ? hardware - 1 : 0;
+  }
+
+  for (unsigned int i = 0; i < _threadCount; ++i)
+  {
+    this->dataPtr->workers.emplace_back(&TaskPoolPrivate::Worker,
+        this->dataPtr.get(), _cpus);
+  }
+}
+
+//////////////////////////////////////////////////
+TaskPool::~TaskPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->stop = true;
+  }
+  this->dataPtr->workCv.notify_all();
+
+  for (auto &worker : this->dataPtr->workers)
+    worker.join();
+}
+
+//////////////////////////////////////////////////
+unsigned int TaskPool::ThreadCount() const
+{
+  return static_cast<unsigned int>(this->dataPtr->workers.size());
+}
+
+//////////////////////////////////////////////////
+void TaskPool::ParallelFor(std::size_t _count,
+    const std::function<void(std::size_t)> &_task)
+{
+  if (_count == 0)
+    return;
+
+  // Nothing to share, run on the calling thread.
+  if (_count == 1 || this->dataPtr->workers.empty())
+  {
+    for (std::size_t i = 0; i < _count; ++i)
+      _task(i);
+    return;
+  }
+
+  auto batch = std::make_shared<Batch>();
+  batch->task = &_task;
+  batch->count = _count;
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->batches.push_back(batch);
+  }
+  this->dataPtr->workCv.notify_all();
+
+  // Help with the batch instead of sleeping.
+  this->dataPtr->Run(*batch);
+
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->doneCv.wait(lock, [&batch]
+  {
+    return batch->done == batch->count;
+  });
+
+  // The batch may still be queued if no worker got to it.
+  auto iter = std::find(this->dataPtr->batches.begin(),
+      this->dataPtr->batches.end(), batch);
+  if (iter != this->dataPtr->batches.end())
+    this->dataPtr->batches.erase(iter);
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_TASKPOOL_HH_
+#define IGNITION_GAZEBO_TASKPOOL_HH_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    // Forward declarations.
+    class TaskPoolPrivate;
+
+    /// \class TaskPool TaskPool.hh
+    /// \brief A fixed set of worker threads which run batches of indexed
+    /// tasks.
+    ///
+    /// The threads are created once, so running a batch doesn't pay for
+    /// thread creation. The thread which runs a batch also executes tasks
+    /// of that batch while it waits, so batches can be started from within
+    /// a task without deadlocking.
+    class IGNITION_GAZEBO_VISIBLE TaskPool
+    {
+      /// \brief Constructor
+      /// \param[in] _threadCount Number of worker threads. Zero uses one
+      /// thread less than the number of hardware threads, since the calling
+      /// thread also runs tasks.
+      /// \param[in] _cpus CPUs the worker threads are pinned to, see
+      /// setThreadAffinity. Empty to keep the CPUs of the calling thread.
+      public: explicit TaskPool(unsigned int _threadCount = 0,
+                  const std::vector<unsigned int> &_cpus = {});
+
+      /// \brief Destructor. Waits for the worker threads to finish.
+      public: ~TaskPool();
+
+      /// \brief Get the number of worker threads.
+      /// \return Number of worker threads, not counting the calling thread.
+      public: unsigned int ThreadCount() const;
+
+      /// \brief Call a function for every index in [0, _count), spreading
+      /// the calls across the worker threads and the calling thread. This
+      /// blocks until all calls are done. It is safe to call this from
+      /// multiple threads at once, and from within a task.
+      /// \param[in] _count Number of tasks.
+      /// \param[in] _task Function called with the index of each task.
+      public: void ParallelFor(std::size_t _count,
+                  const std::function<void(std::size_t)> &_task);
+
+      /// \brief Pointer to private data.
+      private: std::unique_ptr<TaskPoolPrivate> dataPtr;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_TASKPOOL_HH_
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "TaskPool.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+//////////////////////////////////////////////////
+TEST(TaskPool, ThreadCount)
+{
+  TaskPool pool(3);
+  EXPECT_EQ(3u, pool.ThreadCount());
+
+  TaskPool defaultPool;
+  EXPECT_EQ(std::max(1u, std::thread::hardware_concurrency()) - 1,
+      defaultPool.ThreadCount());
+}
+
+//////////////////////////////////////////////////
+TEST(TaskPool, ParallelFor)
+{
+  TaskPool pool(4);
+
+  // Each task runs exactly once
+  std::vector<int> values(1000, 0);
+  for (int i = 0; i < 100; ++i)
+  {
+    pool.ParallelFor(values.size(), [&](std::size_t _index)
+    {
+      values[_index] += 1;
+    });
+  }
+  for (auto value : values)
+    EXPECT_EQ(100, value);
+
+  // Empty batch
+  pool.ParallelFor(0, [](std::size_t)
+  {
+    FAIL() << "No task should run";
+  });
+}
+
+//////////////////////////////////////////////////
+TEST(TaskPool, SingleTask)
+{
+  TaskPool pool(2);
+
+  // A single task isn't worth handing to a worker
+  std::thread::id id;
+  pool.ParallelFor(1, [&](std::size_t _index)
+  {
+    EXPECT_EQ(0u, _index);
+    id = std::this_thread::get_id();
+  });
+  EXPECT_EQ(std::this_thread::get_id(), id);
+}
+
+//////////////////////////////////////////////////
+TEST(TaskPool, Nested)
+{
+  TaskPool pool(2);
+
+  // Batches started from tasks, and from several threads at once, don't
+  // deadlock
+  std::atomic<int> count{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&]()
+    {
+      for (int i = 0; i < 50; ++i)
+      {
+        pool.ParallelFor(4, [&](std::size_t)
+        {
+          pool.ParallelFor(4, [&](std::size_t)
+          {
+            ++count;
+          });
+        });
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(4 * 50 * 4 * 4, count);
+}
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Profiler.hh>
+
+#include "ignition/gazebo/TensorView.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+namespace
+{
+/// \brief A field bound to a value of the buffer.
+struct Binding
+{
+  /// \brief Entity with the component.
+  Entity entity{kNullEntity};
+
+  /// \brief Type of the component.
+  ComponentTypeId type{0};
+
+  /// \brief Looks up the component for Fill.
+  TensorView::Lookup lookup;
+
+  /// \brief Looks up the component for Apply.
+  TensorView::MutableLookup mutableLookup;
+
+  /// \brief Reads the field, empty if it isn't read.
+  TensorView::Getter get;
+
+  /// \brief Writes the field, empty if it isn't written.
+  TensorView::Setter set;
+};
+
+/// \brief Components looked up in one manager.
+template <typename ComponentT>
+struct ComponentCache
+{
+  /// \brief Component layout generation the components were looked up
+  /// at.
+  uint64_t generation{0};
+
+  /// \brief Component of each binding, null if it's missing or the
+  /// binding isn't used in this direction.
+  std::vector<ComponentT *> components;
+};
+}
+
+class ignition::gazebo::TensorViewPrivate
+{
+  /// \brief Constructor
+  public: TensorViewPrivate() = default;
+
+  /// \brief Copy constructor, which only copies the bindings.
+  /// \param[in] _other Data to copy.
+  public: TensorViewPrivate(const TensorViewPrivate &_other)
+    : bindings(_other.bindings)
+  {
+  }
+
+  /// \brief Get the components looked up for reading a manager, looking
+  /// them up again if the manager's layout changed.
+  /// \param[in] _ecm Entity component manager.
+  /// \return Component of each binding.
+  public: const std::vector<const components::BaseComponent *> &Components(
+              const EntityComponentManager &_ecm) const;
+
+  /// \brief Get the components looked up for writing to a manager, looking
+  /// them up again if the manager's layout changed.
+  /// \param[in] _ecm Entity component manager.
+  /// \return Component of each binding.
+  public: const std::vector<components::BaseComponent *> &MutableComponents(
+              EntityComponentManager &_ecm) const;
+
+  /// \brief Bound fields, in the order of the buffer.
+  public: std::vector<Binding> bindings;
+
+  /// \brief Protects the maps of caches, whose entries are used by one
+  /// thread at a time.
+  public: mutable std::mutex cacheMutex;
+
+  /// \brief Components for reading, for each manager.
+  public: mutable std::unordered_map<const EntityComponentManager *,
+      ComponentCache<const components::BaseComponent>> caches;
+
+  /// \brief Components for writing, for each manager.
+  public: mutable std::unordered_map<const EntityComponentManager *,
+      ComponentCache<components::BaseComponent>> mutableCaches;
+};
+
+//////////////////////////////////////////////////
+const std::vector<const components::BaseComponent *> &
+    TensorViewPrivate::Components(const EntityComponentManager &_ecm) const
+{
+  ComponentCache<const components::BaseComponent> *cache;
+  {
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    cache = &this->caches[&_ecm];
+  }
+
+  const uint64_t generation = _ecm.ComponentLayoutGeneration();
+  if (cache->components.size() == this->bindings.size() &&
+      cache->generation == generation)
+  {
+    return cache->components;
+  }
+
+  IGN_PROFILE("TensorView::Lookup");
+  cache->components.resize(this->bindings.size());
+  for (std::size_t i = 0; i < this->bindings.size(); ++i)
+  {
+    const auto &binding = this->bindings[i];
+    cache->components[i] = binding.get ? binding.lookup(_ecm) : nullptr;
+  }
+  cache->generation = generation;
+  return cache->components;
+}
+
+//////////////////////////////////////////////////
+const std::vector<components::BaseComponent *> &
+    TensorViewPrivate::MutableComponents(EntityComponentManager &_ecm) const
+{
+  ComponentCache<components::BaseComponent> *cache;
+  {
+    std::lock_guard<std::mutex> lock(this->cacheMutex);
+    cache = &this->mutableCaches[&_ecm];
+  }
+
+  uint64_t generation = _ecm.ComponentLayoutGeneration();
+  if (cache->components.size() == this->bindings.size() &&
+      cache->generation == generation)
+  {
+    return cache->components;
+  }
+
+  IGN_PROFILE("TensorView::MutableLookup");
+  cache->components.resize(this->bindings.size());
+
+  // Creating missing components, or copying storages shared with a fork,
+  // may move the components looked up before, so look them up until none
+  // moves. The second pass doesn't create or copy anything.
+  do
+  {
+    generation = _ecm.ComponentLayoutGeneration();
+    for (std::size_t i = 0; i < this->bindings.size(); ++i)
+    {
+      const auto &binding = this->bindings[i];
+      cache->components[i] =
+          binding.set ? binding.mutableLookup(_ecm) : nullptr;
+    }
+  }
+  while (generation != _ecm.ComponentLayoutGeneration());
+
+  cache->generation = generation;
+  return cache->components;
+}
+
+//////////////////////////////////////////////////
+TensorView::TensorView()
+  : dataPtr(std::make_unique<TensorViewPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+TensorView::TensorView(const TensorView &_view)
+  : dataPtr(std::make_unique<TensorViewPrivate>(*_view.dataPtr))
+{
+}
+
+//////////////////////////////////////////////////
+TensorView::TensorView(TensorView &&_view) noexcept = default;
+
+//////////////////////////////////////////////////
+TensorView::~TensorView() = default;
+
+//////////////////////////////////////////////////
+TensorView &TensorView::operator=(const TensorView &_view)
+{
+  if (this != &_view)
+    this->dataPtr = std::make_unique<TensorViewPrivate>(*_view.dataPtr);
+  return *this;
+}
+
+//////////////////////////////////////////////////
+TensorView &TensorView::operator=(TensorView &&_view) noexcept = default;
+
+//////////////////////////////////////////////////
+std::size_t TensorView::AddBinding(const Entity _entity,
+    const ComponentTypeId _type, Lookup _lookup,
+    MutableLookup _mutableLookup, Getter _get, Setter _set)
+{
+  Binding binding;
+  binding.entity = _entity;
+  binding.type = _type;
+  binding.lookup = std::move(_lookup);
+  binding.mutableLookup = std::move(_mutableLookup);
+  binding.get = std::move(_get);
+  binding.set = std::move(_set);
+
+  // Fields can't be used in a direction they have no lookup for
+  if (!binding.lookup)
+    binding.get = nullptr;
+  if (!binding.mutableLookup)
+    binding.set = nullptr;
+
+  this->dataPtr->bindings.push_back(std::move(binding));
+  return this->dataPtr->bindings.size() - 1;
+}
+
+//////////////////////////////////////////////////
+std::size_t TensorView::Size() const
+{
+  return this->dataPtr->bindings.size();
+}
+
+//////////////////////////////////////////////////
+void TensorView::Fill(const EntityComponentManager &_ecm,
+    double *_buffer) const
+{
+  IGN_PROFILE("TensorView::Fill");
+  const auto &bindings = this->dataPtr->bindings;
+  const auto &comps = this->dataPtr->Components(_ecm);
+  for (std::size_t i = 0; i < bindings.size(); ++i)
+  {
+    _buffer[i] = nullptr == comps[i] ?
+        std::numeric_limits<double>::quiet_NaN() : bindings[i].get(*comps[i]);
+  }
+}
+
+//////////////////////////////////////////////////
+void TensorView::Apply(const double *_buffer,
+    EntityComponentManager &_ecm) const
+{
+  IGN_PROFILE("TensorView::Apply");
+  const auto &bindings = this->dataPtr->bindings;
+  const auto &comps = this->dataPtr->MutableComponents(_ecm);
+  for (std::size_t i = 0; i < bindings.size(); ++i)
+  {
+    if (nullptr == comps[i] || std::isnan(_buffer[i]))
+      continue;
+
+    bindings[i].set(*comps[i], _buffer[i]);
+    _ecm.SetChanged(bindings[i].entity, bindings[i].type,
+        ComponentState::PeriodicChange);
+  }
+}
+
+//////////////////////////////////////////////////
+void TensorView::Reset()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->cacheMutex);
+  this->dataPtr->caches.clear();
+  this->dataPtr->mutableCaches.clear();
+}
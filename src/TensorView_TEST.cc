@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "ignition/gazebo/components/JointForceCmd.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/TensorView.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(TensorViewTest, Fill)
+{
+  EntityComponentManager ecm;
+  Entity model = ecm.CreateEntity();
+  ecm.CreateComponent(model, components::Pose(math::Pose3d(1, 2, 3, 0, 0, 0)));
+  Entity other = ecm.CreateEntity();
+
+  TensorView view;
+  EXPECT_EQ(0u, view.Bind<components::Pose>(model,
+      [](const math::Pose3d &_pose) {return _pose.Pos().X();}));
+  EXPECT_EQ(1u, view.Bind<components::Pose>(model,
+      [](const math::Pose3d &_pose) {return _pose.Pos().Z();}));
+  EXPECT_EQ(2u, view.Bind<components::Pose>(other,
+      [](const math::Pose3d &_pose) {return _pose.Pos().Z();}));
+  EXPECT_EQ(3u, view.Size());
+
+  std::vector<double> buffer(view.Size());
+  view.Fill(ecm, buffer.data());
+  EXPECT_DOUBLE_EQ(1.0, buffer[0]);
+  EXPECT_DOUBLE_EQ(3.0, buffer[1]);
+  EXPECT_TRUE(std::isnan(buffer[2]));
+
+  // Values follow the components
+  ecm.SetComponentData<components::Pose>(model,
+      math::Pose3d(4, 5, 6, 0, 0, 0));
+  view.Fill(ecm, buffer.data());
+  EXPECT_DOUBLE_EQ(4.0, buffer[0]);
+  EXPECT_DOUBLE_EQ(6.0, buffer[1]);
+
+  // Components are looked up again when they're created or removed
+  ecm.CreateComponent(other, components::Pose(math::Pose3d(0, 0, 7, 0, 0, 0)));
+  ecm.RemoveComponent<components::Pose>(model);
+  view.Fill(ecm, buffer.data());
+  EXPECT_TRUE(std::isnan(buffer[0]));
+  EXPECT_DOUBLE_EQ(7.0, buffer[2]);
+
+  // A fork with different values uses the same view
+  EntityComponentManager fork;
+  fork.Fork(ecm);
+  fork.SetComponentData<components::Pose>(other,
+      math::Pose3d(0, 0, 8, 0, 0, 0));
+  view.Fill(fork, buffer.data());
+  EXPECT_DOUBLE_EQ(8.0, buffer[2]);
+  view.Fill(ecm, buffer.data());
+  EXPECT_DOUBLE_EQ(7.0, buffer[2]);
+
+  // Copies keep the bindings
+  TensorView copy(view);
+  EXPECT_EQ(3u, copy.Size());
+  copy.Fill(fork, buffer.data());
+  EXPECT_DOUBLE_EQ(8.0, buffer[2]);
+}
+
+/////////////////////////////////////////////////
+TEST(TensorViewTest, Apply)
+{
+  EntityComponentManager ecm;
+  Entity joint1 = ecm.CreateEntity();
+  Entity joint2 = ecm.CreateEntity();
+  ecm.CreateComponent(joint2, components::JointForceCmd({0.0, 0.0}));
+
+  auto setForce = [](std::size_t _index)
+  {
+    return [_index](std::vector<double> &_force, double _value)
+    {
+      _force.resize(std::max(_force.size(), _index + 1));
+      _force[_index] = _value;
+    };
+  };
+
+  TensorView view;
+  view.Bind<components::JointForceCmd>(joint1, setForce(0));
+  view.Bind<components::JointForceCmd>(joint2, setForce(0));
+  view.Bind<components::JointForceCmd>(joint2, setForce(1));
+  view.Bind<components::JointForceCmd>(Entity{12345}, setForce(0));
+
+  // Missing components are created, and entities which don't exist are
+  // skipped
+  std::vector<double> buffer{1.0, 2.0, 3.0, 4.0};
+  view.Apply(buffer.data(), ecm);
+  EXPECT_EQ(std::vector<double>({1.0}),
+      ecm.ComponentData<components::JointForceCmd>(joint1));
+  EXPECT_EQ(std::vector<double>({2.0, 3.0}),
+      ecm.ComponentData<components::JointForceCmd>(joint2));
+  EXPECT_EQ(ComponentState::PeriodicChange,
+      ecm.ComponentState(joint2, components::JointForceCmd::typeId));
+
+  // NaN values are skipped
+  buffer = {5.0, std::nan(""), 6.0, 0.0};
+  view.Apply(buffer.data(), ecm);
+  EXPECT_EQ(std::vector<double>({5.0}),
+      ecm.ComponentData<components::JointForceCmd>(joint1));
+  EXPECT_EQ(std::vector<double>({2.0, 6.0}),
+      ecm.ComponentData<components::JointForceCmd>(joint2));
+
+  // Fields bound for writing can't be read
+  view.Fill(ecm, buffer.data());
+  EXPECT_TRUE(std::isnan(buffer[0]));
+}
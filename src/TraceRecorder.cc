@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <fstream>
+
+#include <ignition/common/Console.hh>
+
+#include "TraceRecorder.hh"
+
+using namespace ignition::gazebo;
+
+namespace
+{
+/// \brief Write a string as a JSON string.
+/// \param[in] _out Stream to write to.
+/// \param[in] _value String to write.
+void writeJsonString(std::ostream &_out, const char *_value)
+{
+  _out << '"';
+  for (const char *c = _value; *c != '\0'; ++c)
+  {
+    if (*c == '"' || *c == '\\')
+      _out << '\\' << *c;
+    else if (static_cast<unsigned char>(*c) >= 0x20)
+      _out << *c;
+  }
+  _out << '"';
+}
+}
+
+//////////////////////////////////////////////////
+TraceRecorder::TraceRecorder(std::size_t _capacity)
+  : epoch(std::chrono::steady_clock::now()),
+    events(std::max<std::size_t>(_capacity, 1))
+{
+}
+
+//////////////////////////////////////////////////
+void TraceRecorder::SetIteration(uint64_t _iteration)
+{
+  this->iteration.store(_iteration, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+const char *TraceRecorder::Intern(const std::string &_label)
+{
+  return this->labels.insert(_label).first->c_str();
+}
+
+//////////////////////////////////////////////////
+int64_t TraceRecorder::Now() const
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - this->epoch).count();
+}
+
+//////////////////////////////////////////////////
+void TraceRecorder::Record(const char *_name, const char *_label,
+    int64_t _startNs)
+{
+  const int64_t endNs = this->Now();
+  const uint64_t index =
+      this->recorded.fetch_add(1, std::memory_order_relaxed);
+
+  auto &event = this->events[index % this->events.size()];
+  event.name = _name;
+  event.label = _label;
+  event.startNs = _startNs;
+  event.durationNs = endNs - _startNs;
+  event.iteration = this->iteration.load(std::memory_order_relaxed);
+  event.threadId = ThreadId();
+}
+
+//////////////////////////////////////////////////
+std::vector<TraceEvent> TraceRecorder::Events() const
+{
+  const uint64_t recordedCount =
+      this->recorded.load(std::memory_order_acquire);
+  const std::size_t capacity = this->events.size();
+  if (recordedCount <= capacity)
+  {
+    return std::vector<TraceEvent>(this->events.begin(),
+        this->events.begin() + recordedCount);
+  }
+
+  // The oldest event is the one which would be overwritten next
+  const std::size_t oldest = recordedCount % capacity;
+  std::vector<TraceEvent> result(this->events.begin() + oldest,
+      this->events.end());
+  result.insert(result.end(), this->events.begin(),
+      this->events.begin() + oldest);
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool TraceRecorder::Write(const std::vector<TraceEvent> &_events,
+    const std::string &_processName, const std::string &_path,
+    const std::map<std::string, std::string> &_metadata)
+{
+  std::ofstream out(_path);
+  if (!out)
+  {
+    ignerr << "Failed to open trace file [" << _path << "]" << std::endl;
+    return false;
+  }
+
+  out << "{\"displayTimeUnit\":\"ms\",\"otherData\":{";
+  for (auto it = _metadata.begin(); it != _metadata.end(); ++it)
+  {
+    if (it != _metadata.begin())
+      out << ",";
+    writeJsonString(out, it->first.c_str());
+    out << ":";
+    writeJsonString(out, it->second.c_str());
+  }
+  out << "},\n";
+
+  // Complete events, with times in microseconds
+  out << "\"traceEvents\":[\n";
+  out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+      << "\"args\":{\"name\":";
+  writeJsonString(out, _processName.c_str());
+  out << "}}";
+
+  out.setf(std::ios::fixed);
+  out.precision(3);
+  for (const auto &event : _events)
+  {
+    out << ",\n{\"name\":";
+    writeJsonString(out, event.label ? event.label : event.name);
+    out << ",\"cat\":";
+    writeJsonString(out, event.name);
+    out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+        << ",\"ts\":" << event.startNs * 1e-3
+        << ",\"dur\":" << event.durationNs * 1e-3
+        << ",\"args\":{\"iteration\":" << event.iteration << "}}";
+  }
+  out << "\n]}\n";
+
+  return static_cast<bool>(out);
+}
+
+//////////////////////////////////////////////////
+uint32_t TraceRecorder::ThreadId()
+{
+  static std::atomic<uint32_t> nextId{1};
+  thread_local const uint32_t id =
+      nextId.fetch_add(1, std::memory_order_relaxed);
+  return id;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_TRACERECORDER_HH_
+#define IGNITION_GAZEBO_TRACERECORDER_HH_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief A scope recorded by a TraceRecorder.
+    struct TraceEvent
+    {
+      /// \brief Name of the scope, a string literal.
+      const char *name{nullptr};
+
+      /// \brief Optional label, such as the system which ran, interned by
+      /// TraceRecorder::Intern.
+      const char *label{nullptr};
+
+      /// \brief Start time, in nanoseconds since the recorder was created.
+      int64_t startNs{0};
+
+      /// \brief Duration in nanoseconds.
+      int64_t durationNs{0};
+
+      /// \brief Iteration the scope ran in.
+      uint64_t iteration{0};
+
+      /// \brief Thread the scope ran on, see TraceRecorder::ThreadId.
+      uint32_t threadId{0};
+    };
+
+    /// \class TraceRecorder TraceRecorder.hh
+    /// \brief Records timed scopes into a fixed size ring buffer, which can
+    /// be written as a Chrome trace, readable by chrome://tracing and
+    /// Perfetto.
+    ///
+    /// Recording is cheap enough to stay enabled in production, so recent
+    /// history is available after a hitch. Scopes can be recorded from
+    /// multiple threads at once, but Events must not be called while
+    /// scopes are being recorded.
+    class IGNITION_GAZEBO_VISIBLE TraceRecorder
+    {
+      /// \brief Constructor.
+      /// \param[in] _capacity Number of events kept, older events are
+      /// overwritten.
+      public: explicit TraceRecorder(std::size_t _capacity);
+
+      /// \brief Set the iteration which following scopes run in.
+      /// \param[in] _iteration Iteration number.
+      public: void SetIteration(uint64_t _iteration);
+
+      /// \brief Get a string which stays valid as long as the recorder,
+      /// to label events with.
+      /// \param[in] _label Label.
+      /// \return Interned label.
+      public: const char *Intern(const std::string &_label);
+
+      /// \brief Get the time since the recorder was created.
+      /// \return Time in nanoseconds.
+      public: int64_t Now() const;
+
+      /// \brief Record a scope.
+      /// \param[in] _name Name of the scope, a string literal.
+      /// \param[in] _label Label from Intern, or nullptr.
+      /// \param[in] _startNs Start time from Now.
+      public: void Record(const char *_name, const char *_label,
+                  int64_t _startNs);
+
+      /// \brief Get the recorded events, oldest first.
+      /// \return Events, at most the capacity.
+      public: std::vector<TraceEvent> Events() const;
+
+      /// \brief Write events as a Chrome trace file.
+      /// \param[in] _events Events from Events.
+      /// \param[in] _processName Name shown for the process.
+      /// \param[in] _path Path of the file.
+      /// \param[in] _metadata Values written as the trace's "otherData",
+      /// shown by trace viewers as metadata.
+      /// \return True if the file was written.
+      public: static bool Write(const std::vector<TraceEvent> &_events,
+                  const std::string &_processName, const std::string &_path,
+                  const std::map<std::string, std::string> &_metadata = {});
+
+      /// \brief Get a small number identifying the calling thread.
+      /// \return Thread number, starting at 1 for the first thread asking.
+      public: static uint32_t ThreadId();
+
+      /// \brief When the recorder was created.
+      private: const std::chrono::steady_clock::time_point epoch;
+
+      /// \brief Ring buffer of events.
+      private: std::vector<TraceEvent> events;
+
+      /// \brief Number of events recorded so far.
+      private: std::atomic<uint64_t> recorded{0};
+
+      /// \brief Iteration which scopes run in.
+      private: std::atomic<uint64_t> iteration{0};
+
+      /// \brief Interned labels.
+      private: std::unordered_set<std::string> labels;
+    };
+
+    /// \brief Records the lifetime of a scope into a TraceRecorder.
+    class TraceScope
+    {
+      /// \brief Constructor, starts the scope.
+      /// \param[in] _recorder Recorder, nullptr to record nothing.
+      /// \param[in] _name Name of the scope, a string literal.
+      /// \param[in] _label Label from TraceRecorder::Intern, or nullptr.
+      public: TraceScope(TraceRecorder *_recorder, const char *_name,
+                  const char *_label = nullptr)
+              : recorder(_recorder), name(_name), label(_label),
+                startNs(_recorder ? _recorder->Now() : 0)
+      {
+      }
+
+      /// \brief Destructor, records the scope.
+      public: ~TraceScope()
+      {
+        if (this->recorder)
+          this->recorder->Record(this->name, this->label, this->startNs);
+      }
+
+      /// \brief Recorder, or nullptr.
+      private: TraceRecorder *recorder;
+
+      /// \brief Name of the scope.
+      private: const char *name;
+
+      /// \brief Label of the scope.
+      private: const char *label;
+
+      /// \brief Start time.
+      private: int64_t startNs;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_TRACERECORDER_HH_
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ignition/common/Filesystem.hh>
+
+#include "ignition/gazebo/test_config.hh"
+#include "TraceRecorder.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+TEST(TraceRecorder, Scopes)
+{
+  TraceRecorder recorder(10);
+  EXPECT_TRUE(recorder.Events().empty());
+
+  const char *label = recorder.Intern("my_system");
+  EXPECT_EQ(label, recorder.Intern("my_system"));
+
+  recorder.SetIteration(3);
+  {
+    TraceScope outer(&recorder, "outer");
+    TraceScope inner(&recorder, "inner", label);
+  }
+
+  // Scopes are recorded as they end
+  auto events = recorder.Events();
+  ASSERT_EQ(2u, events.size());
+  EXPECT_STREQ("inner", events[0].name);
+  EXPECT_STREQ("my_system", events[0].label);
+  EXPECT_STREQ("outer", events[1].name);
+  EXPECT_EQ(nullptr, events[1].label);
+  EXPECT_EQ(3u, events[0].iteration);
+  EXPECT_LE(events[1].startNs, events[0].startNs);
+  EXPECT_GE(events[1].durationNs, events[0].durationNs);
+  EXPECT_EQ(TraceRecorder::ThreadId(), events[0].threadId);
+
+  // Nothing is recorded without a recorder
+  {
+    TraceScope scope(nullptr, "nothing");
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(TraceRecorder, RingBuffer)
+{
+  TraceRecorder recorder(4);
+  for (uint64_t i = 0; i < 10; ++i)
+  {
+    recorder.SetIteration(i);
+    TraceScope scope(&recorder, "step");
+  }
+
+  // Only the latest events are kept, oldest first
+  auto events = recorder.Events();
+  ASSERT_EQ(4u, events.size());
+  for (uint64_t i = 0; i < events.size(); ++i)
+    EXPECT_EQ(6u + i, events[i].iteration);
+}
+
+/////////////////////////////////////////////////
+TEST(TraceRecorder, Threads)
+{
+  TraceRecorder recorder(1000);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&recorder]
+        {
+          for (int j = 0; j < 100; ++j)
+          {
+            TraceScope scope(&recorder, "task");
+          }
+        });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  auto events = recorder.Events();
+  ASSERT_EQ(400u, events.size());
+  for (const auto &event : events)
+  {
+    EXPECT_STREQ("task", event.name);
+    EXPECT_NE(0u, event.threadId);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(TraceRecorder, Write)
+{
+  TraceRecorder recorder(10);
+  recorder.SetIteration(7);
+  {
+    TraceScope scope(&recorder, "Update", recorder.Intern("say \"hi\""));
+  }
+
+  const auto path = common::joinPaths(PROJECT_BINARY_PATH, "test",
+      "trace_recorder.json");
+  ASSERT_TRUE(TraceRecorder::Write(recorder.Events(), "world", path,
+      {{"slowest_system", "physics"}}));
+
+  std::ifstream file(path);
+  const std::string trace{std::istreambuf_iterator<char>(file),
+      std::istreambuf_iterator<char>()};
+  EXPECT_NE(std::string::npos, trace.find("\"traceEvents\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"world\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"say \\\"hi\\\"\""));
+  EXPECT_NE(std::string::npos, trace.find("\"cat\":\"Update\""));
+  EXPECT_NE(std::string::npos, trace.find("\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos, trace.find("\"iteration\":7"));
+  EXPECT_NE(std::string::npos,
+      trace.find("\"otherData\":{\"slowest_system\":\"physics\"}"));
+  common::removeFile(path);
+
+  EXPECT_FALSE(TraceRecorder::Write(recorder.Events(), "world",
+      common::joinPaths(PROJECT_BINARY_PATH, "no_such_dir", "trace.json")));
+}
@@ -15,6 +15,13 @@
  *
 */
 
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #ifndef __APPLE__
   #if (defined(_MSVC_LANG))
     #if (_MSVC_LANG >= 201703L || __cplusplus >= 201703L)
@@ -30,6 +37,11 @@
   #endif
 #endif
 
+#ifdef __linux__
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
 #include <ignition/common/Filesystem.hh>
 #include <ignition/common/StringUtils.hh>
 #include <ignition/common/Util.hh>
@@ -50,6 +62,28 @@
 
 #include "ignition/gazebo/Util.hh"
 
+namespace
+{
+/// \brief Full paths of the resources found by findResource.
+struct ResourceCache
+{
+  /// \brief Protects paths.
+  std::mutex mutex;
+
+  /// \brief Full path of each resource, by the URI it was searched with.
+  std::unordered_map<std::string, std::string> paths;
+};
+
+//////////////////////////////////////////////////
+/// \brief Get the process-wide cache of resources.
+/// \return The cache.
+ResourceCache &resourceCache()
+{
+  static ResourceCache cache;
+  return cache;
+}
+}
+
 namespace ignition
 {
 namespace gazebo
@@ -60,6 +94,10 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
 math::Pose3d worldPose(const Entity &_entity,
     const EntityComponentManager &_ecm)
 {
+  // use the pose computed by the world pose pass if there is one
+  if (auto cached = _ecm.CachedWorldPose(_entity))
+    return *cached;
+
   // work out pose in world frame
   math::Pose3d pose = _ecm.Component<components::Pose>(_entity)->Data();
   auto p = _ecm.Component<components::ParentEntity>(_entity);
@@ -82,6 +120,9 @@ std::string scopedName(const Entity &_entity,
     const EntityComponentManager &_ecm, const std::string &_delim,
     bool _includePrefix)
 {
+  if (auto cached = _ecm.CachedScopedName(_entity, _delim, _includePrefix))
+    return *cached;
+
   std::string result;
 
   auto entity = _entity;
@@ -123,6 +164,7 @@ std::string scopedName(const Entity &_entity,
     entity = parentComp->Data();
   }
 
+  _ecm.CacheScopedName(_entity, _delim, _includePrefix, result);
   return result;
 }
 
@@ -315,6 +357,33 @@ std::string asFullPath(const std::string &_uri, const std::string &_filePath)
   return common::joinPaths(path,  uri);
 }
 
+//////////////////////////////////////////////////
+std::string findResource(const std::string &_uri,
+    const std::string &_filePath)
+{
+  if (_uri.empty())
+    return "";
+
+  const std::string uri = asFullPath(_uri, _filePath);
+
+  auto &cache = resourceCache();
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.paths.find(uri);
+    if (it != cache.paths.end())
+      return it->second;
+  }
+
+  // Search without holding the lock, since it may download the resource
+  std::string fullPath = common::findFile(uri);
+  if (fullPath.empty())
+    return fullPath;
+
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.paths[uri] = fullPath;
+  return fullPath;
+}
+
 //////////////////////////////////////////////////
 std::vector<std::string> resourcePaths()
 {
@@ -408,12 +477,20 @@ void addResourcePaths(const std::vector<std::string> &_paths)
   // Force re-evaluation
   // SDF is evaluated at find call
   systemPaths->SetFilePathEnv(systemPaths->FilePathEnv());
+
+  // Resources may now be found elsewhere
+  auto &cache = resourceCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.paths.clear();
 }
 
 //////////////////////////////////////////////////
 ignition::gazebo::Entity topLevelModel(const Entity &_entity,
     const EntityComponentManager &_ecm)
 {
+  if (auto cached = _ecm.CachedTopLevelModel(_entity))
+    return *cached;
+
   auto entity = _entity;
 
   // search up the entity tree and find the model with no parent models
@@ -432,6 +509,7 @@ ignition::gazebo::Entity topLevelModel(const Entity &_entity,
     entity = parentComp->Data();
   }
 
+  _ecm.CacheTopLevelModel(_entity, modelEntity);
   return modelEntity;
 }
 
@@ -455,6 +533,121 @@ std::string validTopic(const std::vector<std::string> &_topics)
   }
   return std::string();
 }
+
+//////////////////////////////////////////////////
+std::optional<std::vector<unsigned int>> parseCpuList(const std::string &_cpus)
+{
+  // Largest CPU index accepted, so typos don't create huge lists
+  const unsigned int kMaxCpu{4095};
+
+  auto parseCpu = [&](const std::string &_str, unsigned int &_cpu)
+  {
+    auto str = common::trimmed(_str);
+    if (str.empty() || str.size() > 4 ||
+        str.find_first_not_of("0123456789") != std::string::npos)
+    {
+      return false;
+    }
+    _cpu = static_cast<unsigned int>(std::stoul(str));
+    return _cpu <= kMaxCpu;
+  };
+
+  std::vector<unsigned int> cpus;
+  const auto list = common::trimmed(_cpus);
+  if (list.empty())
+    return cpus;
+
+  std::size_t start{0};
+  while (start <= list.size())
+  {
+    auto end = list.find(',', start);
+    if (end == std::string::npos)
+      end = list.size();
+    auto item = list.substr(start, end - start);
+    start = end + 1;
+
+    unsigned int first{0};
+    unsigned int last{0};
+    auto dash = item.find('-');
+    if (dash == std::string::npos)
+    {
+      if (!parseCpu(item, first))
+        return std::nullopt;
+      last = first;
+    }
+    else if (!parseCpu(item.substr(0, dash), first) ||
+        !parseCpu(item.substr(dash + 1), last) || last < first)
+    {
+      return std::nullopt;
+    }
+
+    for (unsigned int cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(cpu);
+  }
+
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+//////////////////////////////////////////////////
+bool setThreadAffinity(const std::vector<unsigned int> &_cpus)
+{
+  if (_cpus.empty())
+    return true;
+
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (auto cpu : _cpus)
+  {
+    if (cpu >= CPU_SETSIZE)
+    {
+      ignerr << "CPU [" << cpu << "] is out of range, can't pin thread."
+             << std::endl;
+      return false;
+    }
+    CPU_SET(cpu, &set);
+  }
+
+  int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (result != 0)
+  {
+    ignerr << "Failed to pin thread to CPUs: " << std::strerror(result)
+           << std::endl;
+    return false;
+  }
+  return true;
+#else
+  static bool warned{false};
+  if (!warned)
+  {
+    ignwarn << "Thread affinity isn't supported on this platform, threads "
+            << "won't be pinned." << std::endl;
+    warned = true;
+  }
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////
+std::vector<unsigned int> threadAffinity()
+{
+  std::vector<unsigned int> cpus;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+  {
+    for (unsigned int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+      if (CPU_ISSET(cpu, &set))
+        cpus.push_back(cpu);
+    }
+  }
+#endif
+  return cpus;
+}
 }
 }
 }
@@ -16,6 +16,9 @@
 */
 
 #include <gtest/gtest.h>
+
+#include <thread>
+
 #include <ignition/common/Console.hh>
 #include <sdf/Actor.hh>
 #include <sdf/Light.hh>
@@ -487,6 +490,54 @@ TEST_F(UtilTest, TopLevelModel)
   EXPECT_EQ(kNullEntity, topLevelModel(worldEntity, ecm));
 }
 
+/////////////////////////////////////////////////
+TEST_F(UtilTest, NameCacheInvalidation)
+{
+  EntityComponentManager ecm;
+
+  auto worldEntity = ecm.CreateEntity();
+  ecm.CreateComponent(worldEntity, components::World());
+  ecm.CreateComponent(worldEntity, components::Name("world"));
+
+  auto modelAEntity = ecm.CreateEntity();
+  ecm.CreateComponent(modelAEntity, components::Model());
+  ecm.CreateComponent(modelAEntity, components::Name("modelA"));
+  ecm.CreateComponent(modelAEntity, components::ParentEntity(worldEntity));
+
+  auto modelBEntity = ecm.CreateEntity();
+  ecm.CreateComponent(modelBEntity, components::Model());
+  ecm.CreateComponent(modelBEntity, components::Name("modelB"));
+  ecm.CreateComponent(modelBEntity, components::ParentEntity(worldEntity));
+
+  auto linkEntity = ecm.CreateEntity();
+  ecm.CreateComponent(linkEntity, components::Link());
+  ecm.CreateComponent(linkEntity, components::Name("link"));
+  ecm.CreateComponent(linkEntity, components::ParentEntity(modelAEntity));
+
+  // Different delimiters and prefix options are cached separately
+  EXPECT_EQ("world/modelA/link", scopedName(linkEntity, ecm, "/", false));
+  EXPECT_EQ("world::modelA::link", scopedName(linkEntity, ecm, "::", false));
+  EXPECT_EQ("world/world/model/modelA/link/link",
+      scopedName(linkEntity, ecm));
+  EXPECT_EQ("world/modelA/link", scopedName(linkEntity, ecm, "/", false));
+  EXPECT_EQ(modelAEntity, topLevelModel(linkEntity, ecm));
+
+  // Renaming an ancestor
+  ecm.SetComponentData<components::Name>(modelAEntity, "renamed");
+  EXPECT_EQ("world/renamed/link", scopedName(linkEntity, ecm, "/", false));
+
+  // Renaming through a pointer is seen once marked as changed
+  ecm.Component<components::Name>(linkEntity)->Data() = "link2";
+  ecm.SetChanged(linkEntity, components::Name::typeId,
+      ComponentState::OneTimeChange);
+  EXPECT_EQ("world/renamed/link2", scopedName(linkEntity, ecm, "/", false));
+
+  // Moving to another model
+  ecm.SetComponentData<components::ParentEntity>(linkEntity, modelBEntity);
+  EXPECT_EQ("world/modelB/link2", scopedName(linkEntity, ecm, "/", false));
+  EXPECT_EQ(modelBEntity, topLevelModel(linkEntity, ecm));
+}
+
 /////////////////////////////////////////////////
 TEST_F(UtilTest, ValidTopic)
 {
@@ -510,3 +561,61 @@ TEST_F(UtilTest, ValidTopic)
   EXPECT_EQ("not_bad", validTopic({fixable, invalid, good}));
   EXPECT_EQ("good", validTopic({invalid, good, fixable}));
 }
+
+/////////////////////////////////////////////////
+TEST_F(UtilTest, FindResource)
+{
+  EXPECT_TRUE(findResource("", "").empty());
+  EXPECT_TRUE(findResource("does_not_exist.dae", "/no/such/dir").empty());
+
+  const std::string mediaDir = common::joinPaths(
+      std::string(PROJECT_SOURCE_PATH), "test", "media");
+  const std::string sdfFile = common::joinPaths(mediaDir, "test_model.sdf");
+
+  // Relative URIs are resolved against the SDF file's directory
+  const auto duck = common::joinPaths(mediaDir, "duck.dae");
+  EXPECT_EQ(duck, findResource("duck.dae", sdfFile));
+
+  // Repeated lookups are served from the cache and give the same result
+  EXPECT_EQ(duck, findResource("duck.dae", sdfFile));
+  EXPECT_EQ(duck, findResource(duck, ""));
+}
+
+/////////////////////////////////////////////////
+TEST_F(UtilTest, ParseCpuList)
+{
+  auto cpus = parseCpuList(" 0-3, 8,2 ,10-11");
+  ASSERT_TRUE(cpus.has_value());
+  EXPECT_EQ((std::vector<unsigned int>{0, 1, 2, 3, 8, 10, 11}), *cpus);
+
+  cpus = parseCpuList("");
+  ASSERT_TRUE(cpus.has_value());
+  EXPECT_TRUE(cpus->empty());
+
+  for (const std::string bad : {"a", "1,", "1,,2", "3-1", "-1", "1-", "5000"})
+  {
+    EXPECT_FALSE(parseCpuList(bad).has_value()) << bad;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_F(UtilTest, ThreadAffinity)
+{
+  EXPECT_TRUE(setThreadAffinity({}));
+
+#ifdef __linux__
+  auto original = threadAffinity();
+  ASSERT_FALSE(original.empty());
+
+  // Pin a thread to the first CPU it may run on, other threads keep theirs
+  std::vector<unsigned int> pinned;
+  std::thread thread([&]
+  {
+    EXPECT_TRUE(setThreadAffinity({original.front()}));
+    pinned = threadAffinity();
+  });
+  thread.join();
+  EXPECT_EQ(std::vector<unsigned int>{original.front()}, pinned);
+  EXPECT_EQ(original, threadAffinity());
+#endif
+}
@@ -14,6 +14,11 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
 #include "ignition/gazebo/detail/View.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 
@@ -21,51 +26,169 @@ using namespace ignition;
 using namespace gazebo;
 using namespace detail;
 
+namespace
+{
+//////////////////////////////////////////////////
+/// \brief Insert an entity into a sorted list, unless it's already there.
+/// \param[in] _list Sorted list of entities.
+/// \param[in] _entity Entity to insert.
+/// \return Index of the entity and whether it was inserted.
+std::pair<std::size_t, bool> InsertSorted(std::vector<Entity> &_list,
+    const Entity _entity)
+{
+  // Entities are usually created in increasing order, so check the back
+  // before searching.
+  if (_list.empty() || _list.back() < _entity)
+  {
+    _list.push_back(_entity);
+    return {_list.size() - 1, true};
+  }
+
+  auto it = std::lower_bound(_list.begin(), _list.end(), _entity);
+  const std::size_t index = static_cast<std::size_t>(it - _list.begin());
+  if (it != _list.end() && *it == _entity)
+    return {index, false};
+
+  _list.insert(it, _entity);
+  return {index, true};
+}
+
+//////////////////////////////////////////////////
+/// \brief Erase an entity from a sorted list.
+/// \param[in] _list Sorted list of entities.
+/// \param[in] _entity Entity to erase.
+void EraseSorted(std::vector<Entity> &_list, const Entity _entity)
+{
+  auto it = std::lower_bound(_list.begin(), _list.end(), _entity);
+  if (it != _list.end() && *it == _entity)
+    _list.erase(it);
+}
+}
+
+//////////////////////////////////////////////////
+View::View(const ComponentTypeKey &_types)
+  : types(_types.begin(), _types.end())
+{
+}
+
 //////////////////////////////////////////////////
 void View::AddEntity(const Entity _entity, const bool _new)
 {
-  this->entities.insert(_entity);
+  auto inserted = InsertSorted(this->entities, _entity);
+  if (inserted.second)
+  {
+    // Make room for the entity's row of components.
+    const auto rowStart = this->components.begin() +
+        static_cast<std::ptrdiff_t>(inserted.first * this->types.size());
+    this->components.insert(rowStart, this->types.size(), nullptr);
+  }
+
   if (_new)
   {
-    this->newEntities.insert(_entity);
+    InsertSorted(this->newEntities, _entity);
   }
 }
 
 //////////////////////////////////////////////////
 void View::AddComponent(const Entity _entity,
     const ComponentTypeId _typeId,
-    const ComponentId _componentId)
+    const components::BaseComponent *_comp)
 {
-  this->components.insert(
-      std::make_pair(std::make_pair(_entity, _typeId), _componentId));
+  const std::size_t slot = this->Slot(_entity);
+  const std::size_t column = this->TypeIndex(_typeId);
+  if (slot >= this->entities.size() || column >= this->types.size())
+    return;
+
+  this->components[slot * this->types.size() + column] = _comp;
 }
 
 //////////////////////////////////////////////////
-bool View::RemoveEntity(const Entity _entity, const ComponentTypeKey &_key)
+void View::RefreshComponents(const ComponentTypeId _typeId,
+    const EntityComponentManager *_ecm)
 {
-  if (this->entities.find(_entity) == this->entities.end())
+  const std::size_t column = this->TypeIndex(_typeId);
+  if (column >= this->types.size())
+    return;
+
+  for (std::size_t slot = 0; slot < this->entities.size(); ++slot)
+  {
+    this->components[slot * this->types.size() + column] =
+        _ecm->ComponentImplementation(this->entities[slot], _typeId);
+  }
+}
+
+//////////////////////////////////////////////////
+bool View::RemoveEntity(const Entity _entity,
+    const ComponentTypeKey &/*_key*/)
+{
+  const std::size_t slot = this->Slot(_entity);
+  if (slot >= this->entities.size())
     return false;
 
-  // Otherwise, remove the entity from the view
-  this->entities.erase(_entity);
-  this->newEntities.erase(_entity);
-  this->toRemoveEntities.erase(_entity);
+  // Otherwise, remove the entity and its row of components from the view
+  this->entities.erase(this->entities.begin() +
+      static_cast<std::ptrdiff_t>(slot));
+  const auto rowStart = this->components.begin() +
+      static_cast<std::ptrdiff_t>(slot * this->types.size());
+  this->components.erase(rowStart,
+      rowStart + static_cast<std::ptrdiff_t>(this->types.size()));
 
-  // Remove the entity from the components map
-  for (const ComponentTypeId &compTypeId : _key)
-    this->components.erase(std::make_pair(_entity, compTypeId));
+  EraseSorted(this->newEntities, _entity);
+  EraseSorted(this->toRemoveEntities, _entity);
 
   return true;
 }
 
-/////////////////////////////////////////////////
-const components::BaseComponent *View::ComponentImplementation(
-    const Entity _entity,
-    ComponentTypeId _typeId,
-    const EntityComponentManager *_ecm) const
+//////////////////////////////////////////////////
+void View::RemoveEntities(const std::vector<Entity> &_entities)
 {
-  return _ecm->ComponentImplementation(
-      {_typeId, this->components.at({_entity, _typeId})});
+  if (_entities.empty() || this->entities.empty())
+    return;
+
+  auto removed = [&_entities](const Entity _entity)
+  {
+    return std::binary_search(_entities.begin(), _entities.end(), _entity);
+  };
+
+  // Rows before the first removed entity stay in place
+  const std::size_t width = this->types.size();
+  std::size_t out = static_cast<std::size_t>(std::lower_bound(
+      this->entities.begin(), this->entities.end(), _entities.front()) -
+      this->entities.begin());
+  for (std::size_t in = out; in < this->entities.size(); ++in)
+  {
+    if (removed(this->entities[in]))
+      continue;
+
+    if (in != out)
+    {
+      this->entities[out] = this->entities[in];
+      std::copy_n(this->components.begin() +
+          static_cast<std::ptrdiff_t>(in * width), width,
+          this->components.begin() + static_cast<std::ptrdiff_t>(out * width));
+    }
+    ++out;
+  }
+  if (out == this->entities.size())
+    return;
+
+  this->entities.resize(out);
+  this->components.resize(out * width);
+
+  this->newEntities.erase(std::remove_if(this->newEntities.begin(),
+      this->newEntities.end(), removed), this->newEntities.end());
+  this->toRemoveEntities.erase(std::remove_if(this->toRemoveEntities.begin(),
+      this->toRemoveEntities.end(), removed), this->toRemoveEntities.end());
+}
+
+//////////////////////////////////////////////////
+std::size_t View::Slot(const Entity _entity) const
+{
+  auto it = std::lower_bound(this->entities.begin(), this->entities.end(),
+      _entity);
+  if (it == this->entities.end() || *it != _entity)
+    return this->entities.size();
+  return static_cast<std::size_t>(it - this->entities.begin());
 }
 
 //////////////////////////////////////////////////
@@ -74,11 +197,28 @@ void View::ClearNewEntities()
   this->newEntities.clear();
 }
 
+//////////////////////////////////////////////////
+std::size_t View::MemoryUsage() const
+{
+  return sizeof(View) +
+      (this->entities.capacity() + this->newEntities.capacity() +
+       this->toRemoveEntities.capacity()) * sizeof(Entity) +
+      this->types.capacity() * sizeof(ComponentTypeId) +
+      this->components.capacity() * sizeof(const components::BaseComponent *);
+}
+
+//////////////////////////////////////////////////
+void View::Clear()
+{
+  this->entities.clear();
+  this->components.clear();
+}
+
 //////////////////////////////////////////////////
 bool View::AddEntityToRemoved(const Entity _entity)
 {
-  if (this->entities.find(_entity) == this->entities.end())
+  if (this->Slot(_entity) >= this->entities.size())
     return false;
-  this->toRemoveEntities.insert(_entity);
+  InsertSorted(this->toRemoveEntities, _entity);
   return true;
 }
@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "WorldCache.hh"
+
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
+#include <sdf/Element.hh>
+#include <sdf/config.hh>
+
+#include "ignition/gazebo/Util.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+namespace
+{
+/// \brief First line of every entry, to be bumped when the format changes.
+const char kMagic[] = "ign-gazebo-world-cache 1";
+
+/// \brief Names of elements holding paths to resources.
+const std::set<std::string> kResourceElements{
+    "uri", "albedo_map", "normal_map", "roughness_map", "metalness_map",
+    "emissive_map", "light_map", "environment_map", "ambient_occlusion_map",
+    "diffuse", "normal", "filename"};
+
+//////////////////////////////////////////////////
+/// \brief Get a stamp which changes whenever a file is modified.
+/// \param[in] _path Path to the file.
+/// \return Modification time and size of the file, or an empty string if it
+/// doesn't exist.
+std::string fileStamp(const std::string &_path)
+{
+  struct stat info;
+  if (stat(_path.c_str(), &info) != 0)
+    return "";
+
+  return std::to_string(static_cast<int64_t>(info.st_mtime)) + ":" +
+      std::to_string(static_cast<int64_t>(info.st_size));
+}
+
+//////////////////////////////////////////////////
+/// \brief Make the relative resource paths of an element and its
+/// descendants absolute, and collect the files they were loaded from.
+/// \param[in] _elem Element to update.
+/// \param[out] _files Files the elements were loaded from.
+void resolvePaths(const sdf::ElementPtr &_elem, std::set<std::string> &_files)
+{
+  const std::string &filePath = _elem->FilePath();
+  if (!filePath.empty() && filePath != "data-string")
+    _files.insert(filePath);
+
+  auto value = _elem->GetValue();
+  if (value && value->GetTypeName() == "string" && !filePath.empty() &&
+      kResourceElements.count(_elem->GetName()) > 0)
+  {
+    std::string uri;
+    if (value->Get<std::string>(uri) && !uri.empty())
+    {
+      std::string fullPath = asFullPath(uri, filePath);
+      if (fullPath != uri && common::exists(fullPath))
+        value->Set(fullPath);
+    }
+  }
+
+  for (auto child = _elem->GetFirstElement(); child;
+       child = child->GetNextElement())
+  {
+    resolvePaths(child, _files);
+  }
+}
+}
+
+//////////////////////////////////////////////////
+WorldCache::WorldCache(const std::string &_dir, const std::string &_source)
+{
+  // Resource paths change how includes are resolved
+  std::string key = _source;
+  key += '\n';
+  key += IGNITION_GAZEBO_VERSION_FULL;
+  key += '\n';
+  key += SDF_VERSION_FULL;
+  for (const auto &env : {kResourcePathEnv, kSdfPathEnv,
+      std::string("IGN_FILE_PATH")})
+  {
+    std::string value;
+    common::env(env, value);
+    key += '\n' + value;
+  }
+
+  std::ostringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0')
+       << std::hash<std::string>()(key) << ".sdf";
+  this->path = common::joinPaths(_dir, name.str());
+}
+
+//////////////////////////////////////////////////
+const std::string &WorldCache::Path() const
+{
+  return this->path;
+}
+
+//////////////////////////////////////////////////
+bool WorldCache::Load(std::string &_sdfString) const
+{
+  IGN_PROFILE("WorldCache::Load");
+
+  std::ifstream file(this->path, std::ios::binary);
+  if (!file)
+    return false;
+
+  std::string line;
+  if (!std::getline(file, line) || line != kMagic)
+    return false;
+
+  // Check that the files the world was loaded from haven't changed
+  std::size_t fileCount{0};
+  if (!std::getline(file, line))
+    return false;
+  std::istringstream(line) >> fileCount;
+
+  for (std::size_t i = 0; i < fileCount; ++i)
+  {
+    std::string stamp;
+    if (!std::getline(file, stamp) || !std::getline(file, line))
+      return false;
+
+    if (fileStamp(line) != stamp)
+    {
+      igndbg << "World cache [" << this->path << "] is outdated, file ["
+             << line << "] changed." << std::endl;
+      return false;
+    }
+  }
+
+  std::ostringstream sdfString;
+  sdfString << file.rdbuf();
+
+  _sdfString = sdfString.str();
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool WorldCache::Save(const sdf::Root &_root) const
+{
+  IGN_PROFILE("WorldCache::Save");
+
+  if (!_root.Element())
+    return false;
+
+  auto elem = _root.Element()->Clone();
+  std::set<std::string> files;
+  resolvePaths(elem, files);
+
+  const std::string dir = common::parentPath(this->path);
+  if (!common::exists(dir) && !common::createDirectories(dir))
+  {
+    ignwarn << "Failed to create world cache directory [" << dir << "]"
+            << std::endl;
+    return false;
+  }
+
+  // Write to a temporary file first, so a concurrent load never sees a
+  // partial entry
+  const std::string tmpPath = this->path + ".tmp";
+  {
+    std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+      ignwarn << "Failed to write world cache [" << tmpPath << "]"
+              << std::endl;
+      return false;
+    }
+
+    file << kMagic << '\n' << files.size() << '\n';
+    for (const auto &filePath : files)
+      file << fileStamp(filePath) << '\n' << filePath << '\n';
+    file << elem->ToString("");
+
+    if (!file)
+    {
+      ignwarn << "Failed to write world cache [" << tmpPath << "]"
+              << std::endl;
+      return false;
+    }
+  }
+
+  if (!common::moveFile(tmpPath, this->path))
+  {
+    ignwarn << "Failed to write world cache [" << this->path << "]"
+            << std::endl;
+    common::removeFile(tmpPath);
+    return false;
+  }
+
+  igndbg << "Saved world cache [" << this->path << "]" << std::endl;
+  return true;
+}
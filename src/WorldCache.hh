@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_WORLDCACHE_HH_
+#define IGNITION_GAZEBO_WORLDCACHE_HH_
+
+#include <string>
+
+#include <sdf/Root.hh>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \class WorldCache WorldCache.hh
+    /// \brief On-disk cache of worlds whose includes have been resolved, so
+    /// loading them again doesn't need to find, fetch and parse every
+    /// included model.
+    ///
+    /// An entry holds the world as a single SDF document, where relative
+    /// resource paths have been made absolute, along with the files it was
+    /// loaded from. It's keyed by the content of the world, the version of
+    /// Gazebo and SDFormat and the resource path environment variables, and
+  /// it's
+    /// ignored if any of its files changed since it was saved.
+    class IGNITION_GAZEBO_VISIBLE WorldCache
+    {
+      /// \brief Constructor
+      /// \param[in] _dir Directory holding the cache entries. It's created
+      /// when it doesn't exist.
+      /// \param[in] _source Content of the world, either an SDF string or
+      /// the content of the world file.
+      public: WorldCache(const std::string &_dir, const std::string &_source);
+
+      /// \brief Get the file holding the entry of the world.
+      /// \return Path of the entry, which may not exist.
+      public: const std::string &Path() const;
+
+      /// \brief Read the entry of the world.
+      /// \param[out] _sdfString The world as a single SDF document, to be
+      /// loaded with sdf::Root::LoadSdfString. It's untouched if there's no
+      /// valid entry.
+      /// \return True if a valid entry was found.
+      public: bool Load(std::string &_sdfString) const;
+
+      /// \brief Save a world, replacing its entry.
+      /// \param[in] _root Root holding the world, as loaded from _source.
+      /// \return True if the entry was written.
+      public: bool Save(const sdf::Root &_root) const;
+
+      /// \brief Path of the entry of the world.
+      private: std::string path;
+    };
+    }  // namespace IGNITION_GAZEBO_VERSION_NAMESPACE
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_WORLDCACHE_HH_
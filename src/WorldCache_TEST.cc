@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+
+#include <ignition/common/Filesystem.hh>
+#include <sdf/Root.hh>
+#include <sdf/World.hh>
+
+#include "ignition/gazebo/test_config.hh"
+
+#include "WorldCache.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/////////////////////////////////////////////////
+/// \brief Write a world with a mesh referred to by a relative path.
+/// \param[in] _path Path of the world file.
+/// \param[in] _modelName Name of the world's model.
+/// \return Content of the world.
+std::string writeWorld(const std::string &_path, const std::string &_modelName)
+{
+  const std::string content = R"(<?xml version="1.0" ?>
+<sdf version="1.6">
+  <world name="default">
+    <model name=")" + _modelName + R"(">
+      <link name="link">
+        <visual name="visual">
+          <geometry>
+            <mesh>
+              <uri>meshes/box.dae</uri>
+            </mesh>
+          </geometry>
+        </visual>
+      </link>
+    </model>
+  </world>
+</sdf>)";
+
+  std::ofstream file(_path);
+  file << content;
+  return content;
+}
+
+/////////////////////////////////////////////////
+TEST(WorldCache, SaveLoad)
+{
+  const std::string dir = common::joinPaths(PROJECT_BINARY_PATH,
+      "test_world_cache");
+  common::removeAll(dir);
+  ASSERT_TRUE(common::createDirectories(common::joinPaths(dir, "meshes")));
+  const std::string meshPath = common::joinPaths(dir, "meshes", "box.dae");
+  std::ofstream(meshPath) << "mesh";
+
+  const std::string worldPath = common::joinPaths(dir, "world.sdf");
+  const std::string content = writeWorld(worldPath, "box");
+  const std::string cacheDir = common::joinPaths(dir, "cache");
+
+  WorldCache cache(cacheDir, content);
+  EXPECT_EQ(cacheDir, common::parentPath(cache.Path()));
+
+  // Nothing cached yet
+  std::string cachedSdf;
+  EXPECT_FALSE(cache.Load(cachedSdf));
+  EXPECT_TRUE(cachedSdf.empty());
+
+  sdf::Root root;
+  ASSERT_TRUE(root.Load(worldPath).empty());
+  ASSERT_TRUE(cache.Save(root));
+  EXPECT_TRUE(common::exists(cache.Path()));
+
+  // The cached world has the same model, with an absolute mesh path
+  ASSERT_TRUE(cache.Load(cachedSdf));
+  sdf::Root cachedRoot;
+  ASSERT_TRUE(cachedRoot.LoadSdfString(cachedSdf).empty());
+  ASSERT_EQ(1u, cachedRoot.WorldCount());
+  ASSERT_EQ(1u, cachedRoot.WorldByIndex(0)->ModelCount());
+  EXPECT_EQ("box", cachedRoot.WorldByIndex(0)->ModelByIndex(0)->Name());
+  EXPECT_NE(std::string::npos, cachedSdf.find(meshPath));
+
+  // Other content has another entry
+  WorldCache otherCache(cacheDir, content + " ");
+  EXPECT_NE(cache.Path(), otherCache.Path());
+  EXPECT_FALSE(otherCache.Load(cachedSdf));
+
+  // Changing a file the world was loaded from invalidates the entry
+  writeWorld(worldPath, "sphere_model");
+  EXPECT_FALSE(cache.Load(cachedSdf));
+
+  common::removeAll(dir);
+}
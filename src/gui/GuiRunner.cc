@@ -15,8 +15,24 @@
  *
 */
 
+#include <ignition/msgs/boolean.pb.h>
+#include <ignition/msgs/param.pb.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
 #include <ignition/fuel_tools/Interface.hh>
 #include <ignition/gui/Application.hh>
 #include <ignition/gui/MainWindow.hh>
@@ -26,6 +42,7 @@
 #include "ignition/gazebo/components/components.hh"
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SharedMemoryChannel.hh"
 #include "ignition/gazebo/gui/GuiRunner.hh"
 #include "ignition/gazebo/gui/GuiSystem.hh"
 
@@ -38,6 +55,30 @@ class ignition::gazebo::GuiRunner::Implementation
   /// \brief Update the plugins.
   public: void UpdatePlugins();
 
+  /// \brief Apply a state to the ECM. Components which aren't replicated
+  /// are dropped from the state first.
+  /// \param[in, out] _msg State message.
+  /// \return True if deltas were missed and the full state should be
+  /// requested.
+  public: bool ApplyState(msgs::SerializedStepMap &_msg);
+
+  /// \brief Find the component types to replicate from the loaded GUI
+  /// systems, see GuiSystem::ComponentTypes, and remove the components of
+  /// other types from the ECM.
+  /// \return True if only some types are replicated.
+  public: bool UpdateReplicatedTypes();
+
+  /// \brief Ask the server to publish the replicated component types on
+  /// interestTopic, if only some types are replicated.
+  /// \param[in] _runner Runner which receives the states.
+  /// \return True if the request was made, false if all types are
+  /// replicated.
+  public: bool RequestInterest(GuiRunner *_runner);
+
+  /// \brief Stop receiving the replicated component types on
+  /// interestTopic, and ask the server to stop publishing them.
+  public: void RemoveInterest();
+
   /// \brief Entity-component manager.
   public: gazebo::EntityComponentManager ecm;
 
@@ -47,9 +88,31 @@ class ignition::gazebo::GuiRunner::Implementation
   /// \brief Topic to request state
   public: std::string stateTopic;
 
+  /// \brief Topic the server publishes the replicated component types on,
+  /// while only some types are replicated.
+  public: std::string interestTopic;
+
+  /// \brief Component types replicated from the server, or empty to
+  /// replicate all of them.
+  public: std::set<ComponentTypeId> replicatedTypes;
+
+  /// \brief True if the server couldn't publish only some types, so all
+  /// of them are replicated from then on.
+  public: bool interestFailed{false};
+
+  /// \brief Protects replicatedTypes and interestFailed.
+  public: std::mutex replicationMutex;
+
   /// \brief Latest update info
   public: UpdateInfo updateInfo;
 
+  /// \brief Sequence number of the last state message, zero if the server
+  /// doesn't publish deltas.
+  public: uint64_t lastStateSeq{0};
+
+  /// \brief True while waiting for the full state after missing deltas.
+  public: bool resyncRequested{false};
+
   /// \brief Flag used to end the updateThread.
   public: bool running{false};
 
@@ -58,8 +121,50 @@ class ignition::gazebo::GuiRunner::Implementation
 
   /// \brief The plugin update thread..
   public: std::thread updateThread;
+
+  /// \brief True to read states from shared memory instead of
+  /// subscribing to them, see IGN_GAZEBO_SHARED_MEMORY_STATE.
+  public: bool sharedMemory{false};
+
+  /// \brief Name of the world's shared memory state channel.
+  public: std::string stateChannelName;
+
+  /// \brief True once the initial state was received.
+  public: std::atomic<bool> initialState{false};
+
+  /// \brief Thread reading states from shared memory.
+  public: std::thread sharedMemoryThread;
+
+  /// \brief States received and not applied yet, oldest first.
+  public: std::deque<msgs::SerializedStepMap> pendingStates;
+
+  /// \brief Mutex to protect pendingStates.
+  public: std::mutex pendingStatesMutex;
+
+  /// \brief Notifies the state thread of new states and of the runner
+  /// being destroyed.
+  public: std::condition_variable pendingStatesCv;
+
+  /// \brief Thread applying the states, so receiving them never waits for
+  /// the plugins.
+  public: std::thread stateThread;
 };
 
+/////////////////////////////////////////////////
+/// \brief Check if a state message holds the full state, see
+/// SceneBroadcaster's state deltas.
+/// \param[in] _msg State message.
+/// \return True for full states.
+static bool isKeyframe(const msgs::SerializedStepMap &_msg)
+{
+  for (const auto &data : _msg.state().header().data())
+  {
+    if (data.key() == "frame" && data.value_size() > 0)
+      return data.value(0) == "key";
+  }
+  return false;
+}
+
 /////////////////////////////////////////////////
 GuiRunner::GuiRunner(const std::string &_worldName)
   : dataPtr(utils::MakeUniqueImpl<Implementation>())
@@ -79,6 +184,9 @@ GuiRunner::GuiRunner(const std::string &_worldName)
            << std::endl;
     return;
   }
+  this->dataPtr->interestTopic = transport::TopicUtils::AsValidTopic(
+      this->dataPtr->stateTopic + "/gui_" +
+      std::to_string(gui::App()->applicationPid()));
 
   common::addFindFileURICallback([] (common::URI _uri)
   {
@@ -93,6 +201,7 @@ GuiRunner::GuiRunner(const std::string &_worldName)
   // Periodically update the plugins
   // \todo(anyone) Move the global variables to GuiRunner::Implementation on v5
   this->dataPtr->running = true;
+  this->dataPtr->stateThread = std::thread(&GuiRunner::ProcessStates, this);
   this->dataPtr->updateThread = std::thread([&]()
   {
     while (this->dataPtr->running)
@@ -105,19 +214,95 @@ GuiRunner::GuiRunner(const std::string &_worldName)
       std::this_thread::sleep_for(std::chrono::milliseconds(33));
     }
   });
+
+  // States from servers on the same host can be read from shared memory,
+  // which skips the socket copies
+  std::string sharedMemoryEnv;
+  if (common::env("IGN_GAZEBO_SHARED_MEMORY_STATE", sharedMemoryEnv) &&
+      sharedMemoryEnv == "1")
+  {
+    this->dataPtr->sharedMemory = true;
+    this->dataPtr->stateChannelName = stateChannelName(_worldName);
+    this->dataPtr->sharedMemoryThread = std::thread(
+        &GuiRunner::ReadSharedMemory, this);
+  }
 }
 
 /////////////////////////////////////////////////
 GuiRunner::~GuiRunner()
 {
-  this->dataPtr->running = false;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->pendingStatesMutex);
+    this->dataPtr->running = false;
+  }
+  this->dataPtr->pendingStatesCv.notify_all();
+  if (this->dataPtr->stateThread.joinable())
+    this->dataPtr->stateThread.join();
   if (this->dataPtr->updateThread.joinable())
     this->dataPtr->updateThread.join();
+  if (this->dataPtr->sharedMemoryThread.joinable())
+    this->dataPtr->sharedMemoryThread.join();
+}
+
+/////////////////////////////////////////////////
+void GuiRunner::ReadSharedMemory()
+{
+  IGN_PROFILE_THREAD_NAME("GuiRunner::ReadSharedMemory");
+
+  // The server may not have created the channel yet
+  std::unique_ptr<SharedMemoryReader> reader;
+  while (this->dataPtr->running)
+  {
+    reader = std::make_unique<SharedMemoryReader>(
+        this->dataPtr->stateChannelName);
+    if (reader->Valid())
+      break;
+
+    // The server is up but doesn't write states to shared memory
+    if (this->dataPtr->initialState)
+    {
+      ignwarn << "Failed to open shared memory state channel ["
+              << this->dataPtr->stateChannelName << "], is the scene "
+              << "broadcaster's <state_shared_memory> set? Subscribing to ["
+              << this->dataPtr->stateTopic << "] instead." << std::endl;
+      this->dataPtr->node.Subscribe(this->dataPtr->stateTopic,
+          &GuiRunner::OnState, this);
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  igndbg << "Reading states from shared memory channel ["
+         << this->dataPtr->stateChannelName << "]." << std::endl;
+
+  std::string data;
+  msgs::SerializedStepMap msg;
+  while (this->dataPtr->running)
+  {
+    if (!reader->Read(data))
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+
+    if (!msg.ParseFromString(data))
+    {
+      ignerr << "Failed to parse state from shared memory." << std::endl;
+      continue;
+    }
+
+    // Missed deltas are detected from the state's sequence numbers
+    this->OnState(msg);
+  }
 }
 
 /////////////////////////////////////////////////
 void GuiRunner::RequestState()
 {
+  // Only some component types are replicated
+  if (this->dataPtr->RequestInterest(this))
+    return;
+
   // set up service for async state response callback
   std::string id = std::to_string(gui::App()->applicationPid());
   std::string reqSrv =
@@ -160,6 +345,10 @@ void GuiRunner::OnPluginAdded(const QString &_objectName)
     return;
   }
 
+  // A plugin which needs all component types stops partial replication
+  if (!this->dataPtr->UpdateReplicatedTypes())
+    this->dataPtr->RemoveInterest();
+
   this->RequestState();
 }
 
@@ -175,8 +364,11 @@ void GuiRunner::OnStateAsyncService(const msgs::SerializedStepMap &_res)
       this->dataPtr->node.Options().NameSpace() + "/" + id + "/state_async";
   this->dataPtr->node.UnadvertiseSrv(reqSrv);
 
+  this->dataPtr->initialState = true;
+
   // Only subscribe to periodic updates after receiving initial state
-  if (this->dataPtr->node.SubscribedTopics().empty())
+  if (!this->dataPtr->sharedMemory &&
+      this->dataPtr->node.SubscribedTopics().empty())
   {
     this->dataPtr->node.Subscribe(this->dataPtr->stateTopic,
         &GuiRunner::OnState, this);
@@ -187,16 +379,301 @@ void GuiRunner::OnStateAsyncService(const msgs::SerializedStepMap &_res)
 void GuiRunner::OnState(const msgs::SerializedStepMap &_msg)
 {
   IGN_PROFILE_THREAD_NAME("GuiRunner::OnState");
-  IGN_PROFILE("GuiRunner::Update");
+  IGN_PROFILE("GuiRunner::OnState");
+
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->pendingStatesMutex);
+
+    // A full state supersedes the states before it, except for the entities
+    // and components they removed, which full states don't list
+    if (isKeyframe(_msg) && !this->dataPtr->pendingStates.empty())
+    {
+      msgs::SerializedStepMap msg(_msg);
+      auto *entities = msg.mutable_state()->mutable_entities();
+      for (const auto &pending : this->dataPtr->pendingStates)
+      {
+        for (const auto &entity : pending.state().entities())
+        {
+          auto it = entities->find(entity.first);
+          if (it == entities->end())
+          {
+            if (entity.second.remove())
+              (*entities)[entity.first] = entity.second;
+            continue;
+          }
+
+          auto *components = it->second.mutable_components();
+          for (const auto &comp : entity.second.components())
+          {
+            if (comp.second.remove() &&
+                components->find(comp.first) == components->end())
+            {
+              (*components)[comp.first] = comp.second;
+            }
+          }
+        }
+      }
+      this->dataPtr->pendingStates.clear();
+      this->dataPtr->pendingStates.push_back(std::move(msg));
+    }
+    else
+    {
+      this->dataPtr->pendingStates.push_back(_msg);
+    }
+  }
+  this->dataPtr->pendingStatesCv.notify_one();
+}
+
+/////////////////////////////////////////////////
+void GuiRunner::ProcessStates()
+{
+  IGN_PROFILE_THREAD_NAME("GuiRunner::ProcessStates");
+
+  std::deque<msgs::SerializedStepMap> states;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->dataPtr->pendingStatesMutex);
+      this->dataPtr->pendingStatesCv.wait(lock, [this]
+      {
+        return !this->dataPtr->running ||
+            !this->dataPtr->pendingStates.empty();
+      });
+
+      if (!this->dataPtr->running)
+        return;
+
+      std::swap(states, this->dataPtr->pendingStates);
+    }
+
+    IGN_PROFILE("GuiRunner::Update");
+    bool resync{false};
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->updateMutex);
 
-  std::lock_guard<std::mutex> lock(this->dataPtr->updateMutex);
-  this->dataPtr->ecm.SetState(_msg.state());
+      for (auto &msg : states)
+        resync = this->dataPtr->ApplyState(msg) || resync;
 
-  // Update all plugins
-  this->dataPtr->updateInfo = convert<UpdateInfo>(_msg.stats());
-  this->dataPtr->UpdatePlugins();
-  this->dataPtr->ecm.ClearNewlyCreatedEntities();
-  this->dataPtr->ecm.ProcessRemoveEntityRequests();
+      // Update all plugins
+      this->dataPtr->updateInfo = convert<UpdateInfo>(states.back().stats());
+      this->dataPtr->UpdatePlugins();
+      this->dataPtr->ecm.ClearNewlyCreatedEntities();
+      this->dataPtr->ecm.ProcessRemoveEntityRequests();
+
+      // Start a new change generation, so plugins can tell which
+      // components changed since they last looked at them, see
+      // EntityComponentManager::ComponentChangedSince
+      this->dataPtr->ecm.SetAllComponentsUnchanged();
+    }
+    states.clear();
+
+    if (resync)
+      this->RequestState();
+  }
+}
+
+/////////////////////////////////////////////////
+bool GuiRunner::Implementation::ApplyState(msgs::SerializedStepMap &_msg)
+{
+  // Full states requested before only some types were replicated still
+  // hold all of them
+  {
+    std::lock_guard<std::mutex> lock(this->replicationMutex);
+    if (!this->replicatedTypes.empty())
+    {
+      for (auto &entity : *_msg.mutable_state()->mutable_entities())
+      {
+        auto *comps = entity.second.mutable_components();
+        for (auto iter = comps->begin(); iter != comps->end();)
+        {
+          if (this->replicatedTypes.find(iter->first) ==
+              this->replicatedTypes.end())
+          {
+            iter = comps->erase(iter);
+          }
+          else
+          {
+            ++iter;
+          }
+        }
+      }
+    }
+  }
+
+  // When the server publishes deltas, each one builds on the previous
+  // message, so request the full state if any were missed.
+  bool keyframe{false};
+  uint64_t seq{0};
+  for (const auto &data : _msg.state().header().data())
+  {
+    if (data.value_size() == 0)
+      continue;
+    if (data.key() == "frame")
+      keyframe = data.value(0) == "key";
+    else if (data.key() == "seq")
+      seq = std::strtoull(data.value(0).c_str(), nullptr, 10);
+  }
+
+  bool resync{false};
+  if (seq > 0)
+  {
+    if (keyframe)
+    {
+      this->resyncRequested = false;
+    }
+    else if (this->lastStateSeq > 0 &&
+        seq != this->lastStateSeq + 1 &&
+        !this->resyncRequested)
+    {
+      igndbg << "Expected state [" << this->lastStateSeq + 1
+             << "], got [" << seq << "]. Requesting full state." << std::endl;
+      this->resyncRequested = true;
+      resync = true;
+    }
+    this->lastStateSeq = seq;
+  }
+
+  this->ecm.SetState(_msg.state());
+  return resync;
+}
+
+/////////////////////////////////////////////////
+bool GuiRunner::Implementation::UpdateReplicatedTypes()
+{
+  // Shared memory states hold all types anyway
+  std::set<ComponentTypeId> types;
+  bool all = this->sharedMemory;
+  for (auto plugin : gui::App()->findChildren<GuiSystem *>())
+  {
+    auto pluginTypes = plugin->ComponentTypes();
+    if (pluginTypes.empty())
+    {
+      all = true;
+      break;
+    }
+    types.insert(pluginTypes.begin(), pluginTypes.end());
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(this->replicationMutex);
+    if (all || this->interestFailed)
+      types.clear();
+    if (types == this->replicatedTypes)
+      return !types.empty();
+    this->replicatedTypes = types;
+  }
+
+  if (types.empty())
+  {
+    igndbg << "Replicating all component types." << std::endl;
+    return false;
+  }
+
+  igndbg << "Replicating [" << types.size() << "] component types."
+         << std::endl;
+
+  // Drop the components which were replicated before
+  std::lock_guard<std::mutex> lock(this->updateMutex);
+  for (const auto &vertex : this->ecm.Entities().Vertices())
+  {
+    const Entity entity = vertex.first;
+    for (const auto type : this->ecm.ComponentTypes(entity))
+    {
+      if (types.find(type) == types.end())
+        this->ecm.RemoveComponent(entity, type);
+    }
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool GuiRunner::Implementation::RequestInterest(GuiRunner *_runner)
+{
+  if (this->interestTopic.empty())
+    return false;
+
+  std::string names;
+  {
+    std::lock_guard<std::mutex> lock(this->replicationMutex);
+    if (this->replicatedTypes.empty())
+      return false;
+
+    auto factory = components::Factory::Instance();
+    for (const auto type : this->replicatedTypes)
+    {
+      if (!names.empty())
+        names += ",";
+      names += factory->Name(type);
+    }
+  }
+
+  // Subscribe first, so the first state isn't missed
+  auto subscribed = this->node.SubscribedTopics();
+  if (std::find(subscribed.begin(), subscribed.end(), this->interestTopic) ==
+      subscribed.end())
+  {
+    this->node.Subscribe(this->interestTopic, &GuiRunner::OnState, _runner);
+  }
+
+  msgs::Param req;
+  auto &topic = (*req.mutable_params())["topic"];
+  topic.set_type(msgs::Any::STRING);
+  topic.set_string_value(this->interestTopic);
+  auto &types = (*req.mutable_params())["components"];
+  types.set_type(msgs::Any::STRING);
+  types.set_string_value(names);
+
+  std::function<void(const msgs::Boolean &, const bool)> cb =
+      [this, _runner](const msgs::Boolean &_rep, const bool _result)
+  {
+    if (_result && _rep.data())
+    {
+      // The full state now only comes through the interest topic
+      this->node.Unsubscribe(this->stateTopic);
+      this->initialState = true;
+      return;
+    }
+
+    ignwarn << "The server can't publish only some component types on ["
+            << this->interestTopic << "], replicating all of them."
+            << std::endl;
+    {
+      std::lock_guard<std::mutex> lock(this->replicationMutex);
+      this->interestFailed = true;
+      this->replicatedTypes.clear();
+    }
+    this->node.Unsubscribe(this->interestTopic);
+    _runner->RequestState();
+  };
+
+  igndbg << "Requesting component types [" << names << "] on ["
+         << this->interestTopic << "]..." << std::endl;
+  this->node.Request(this->stateTopic + "_interest", req, cb);
+  return true;
+}
+
+/////////////////////////////////////////////////
+void GuiRunner::Implementation::RemoveInterest()
+{
+  auto subscribed = this->node.SubscribedTopics();
+  if (std::find(subscribed.begin(), subscribed.end(), this->interestTopic) ==
+      subscribed.end())
+  {
+    return;
+  }
+  this->node.Unsubscribe(this->interestTopic);
+
+  msgs::Param req;
+  auto &topic = (*req.mutable_params())["topic"];
+  topic.set_type(msgs::Any::STRING);
+  topic.set_string_value(this->interestTopic);
+  auto &remove = (*req.mutable_params())["remove"];
+  remove.set_type(msgs::Any::BOOLEAN);
+  remove.set_bool_value(true);
+
+  std::function<void(const msgs::Boolean &, const bool)> cb =
+      [](const msgs::Boolean &, const bool) {};
+  this->node.Request(this->stateTopic + "_interest", req, cb);
 }
 
 /////////////////////////////////////////////////
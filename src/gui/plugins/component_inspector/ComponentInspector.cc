@@ -15,8 +15,10 @@
  *
 */
 
+#include <chrono>
 #include <iostream>
 #include <regex>
+#include <unordered_map>
 #include <ignition/common/Console.hh>
 #include <ignition/common/Profiler.hh>
 #include <ignition/gui/Application.hh>
@@ -96,6 +98,22 @@ namespace ignition::gazebo
 
     /// \brief Transport node for making command requests
     public: transport::Node node;
+
+    /// \brief Minimum time between refreshes, zero to refresh on every
+    /// update.
+    public: std::chrono::steady_clock::duration updatePeriod{
+        std::chrono::milliseconds(100)};
+
+    /// \brief Time of the last refresh.
+    public: std::chrono::steady_clock::time_point lastRefreshTime;
+
+    /// \brief Entity whose components were last refreshed.
+    public: Entity refreshedEntity{kNullEntity};
+
+    /// \brief Change generation at which each component's row was last
+    /// refreshed, see EntityComponentManager::ChangeGeneration.
+    public: std::unordered_map<ComponentTypeId, uint64_t>
+        refreshedGenerations;
   };
 }
 
@@ -340,6 +358,28 @@ void ComponentsModel::RemoveComponentType(
   }
 }
 
+/////////////////////////////////////////////////
+void ComponentsModel::SetRowVisible(const QString &_typeId, bool _visible)
+{
+  bool ok{false};
+  auto typeId = static_cast<ComponentTypeId>(_typeId.toULongLong(&ok));
+  if (!ok)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->visibleTypesMutex);
+  if (_visible)
+    this->visibleTypes.insert(typeId);
+  else
+    this->visibleTypes.erase(typeId);
+}
+
+/////////////////////////////////////////////////
+bool ComponentsModel::RowVisible(ComponentTypeId _typeId) const
+{
+  std::lock_guard<std::mutex> lock(this->visibleTypesMutex);
+  return this->visibleTypes.find(_typeId) != this->visibleTypes.end();
+}
+
 /////////////////////////////////////////////////
 QHash<int, QByteArray> ComponentsModel::roleNames() const
 {
@@ -369,11 +409,24 @@ ComponentInspector::ComponentInspector()
 ComponentInspector::~ComponentInspector() = default;
 
 /////////////////////////////////////////////////
-void ComponentInspector::LoadConfig(const tinyxml2::XMLElement *)
+void ComponentInspector::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
 {
   if (this->title.empty())
     this->title = "Component inspector";
 
+  if (_pluginElem)
+  {
+    if (auto elem = _pluginElem->FirstChildElement("update_rate"))
+    {
+      double rate{0.0};
+      elem->QueryDoubleText(&rate);
+      this->dataPtr->updatePeriod = rate > 0.0 ?
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(1.0 / rate)) :
+          std::chrono::steady_clock::duration::zero();
+    }
+  }
+
   ignition::gui::App()->findChild<
       ignition::gui::MainWindow *>()->installEventFilter(this);
 
@@ -391,6 +444,23 @@ void ComponentInspector::Update(const UpdateInfo &,
   if (this->dataPtr->paused)
     return;
 
+  // Refresh at most at the update rate, unless another entity was selected
+  auto now = std::chrono::steady_clock::now();
+  bool entityChanged = this->dataPtr->entity != this->dataPtr->refreshedEntity;
+  if (!entityChanged &&
+      now - this->dataPtr->lastRefreshTime < this->dataPtr->updatePeriod)
+  {
+    return;
+  }
+  this->dataPtr->lastRefreshTime = now;
+
+  if (entityChanged)
+  {
+    this->dataPtr->refreshedEntity = this->dataPtr->entity;
+    this->dataPtr->refreshedGenerations.clear();
+  }
+  auto generation = _ecm.ChangeGeneration();
+
   auto componentTypes = _ecm.ComponentTypes(this->dataPtr->entity);
 
   // List all components
@@ -487,9 +557,6 @@ void ComponentInspector::Update(const UpdateInfo &,
           Q_ARG(ignition::gazebo::ComponentTypeId, typeId));
     }
 
-    item->setData(QString::number(this->dataPtr->entity),
-                  ComponentsModel::RoleNames().key("entity"));
-
     if (nullptr == item)
     {
       ignerr << "Failed to get item for component type [" << typeId << "]"
@@ -497,6 +564,22 @@ void ComponentInspector::Update(const UpdateInfo &,
       continue;
     }
 
+    // Rows which aren't shown or whose component didn't change since they
+    // were last refreshed are left as they are. Hidden rows are refreshed
+    // once they're shown.
+    auto refreshed = this->dataPtr->refreshedGenerations.find(typeId);
+    if (refreshed != this->dataPtr->refreshedGenerations.end() &&
+        (!this->dataPtr->componentsModel.RowVisible(typeId) ||
+         !_ecm.ComponentChangedSince(this->dataPtr->entity, typeId,
+             refreshed->second)))
+    {
+      continue;
+    }
+    this->dataPtr->refreshedGenerations[typeId] = generation;
+
+    item->setData(QString::number(this->dataPtr->entity),
+                  ComponentsModel::RoleNames().key("entity"));
+
     // Populate component-specific data
     if (typeId == components::AngularAcceleration::typeId)
     {
@@ -721,6 +804,7 @@ void ComponentInspector::Update(const UpdateInfo &,
     auto typeId = itemIt.first;
     if (componentTypes.find(typeId) == componentTypes.end())
     {
+      this->dataPtr->refreshedGenerations.erase(typeId);
       QMetaObject::invokeMethod(&this->dataPtr->componentsModel,
           "RemoveComponentType",
           Qt::QueuedConnection,
@@ -20,6 +20,8 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
@@ -150,14 +152,38 @@ namespace gazebo
     public slots: void RemoveComponentType(
         ignition::gazebo::ComponentTypeId _typeId);
 
+    /// \brief Set whether a component's row is shown, which the view calls
+    /// as it creates and destroys the rows' delegates. Thread-safe.
+    /// \param[in] _typeId Type of the component, as a string.
+    /// \param[in] _visible True if the row is shown.
+    public: Q_INVOKABLE void SetRowVisible(const QString &_typeId,
+        bool _visible);
+
+    /// \brief Check whether a component's row is shown. Thread-safe.
+    /// \param[in] _typeId Type of the component.
+    /// \return True if the row is shown.
+    public: bool RowVisible(ComponentTypeId _typeId) const;
+
     /// \brief Keep track of items in the tree, according to type ID.
     public: std::map<ComponentTypeId, QStandardItem *> items;
+
+    /// \brief Types of the components whose rows are shown.
+    private: std::set<ComponentTypeId> visibleTypes;
+
+    /// \brief Protects visibleTypes.
+    private: mutable std::mutex visibleTypesMutex;
   };
 
   /// \brief Displays a tree view with all the entities in the world.
   ///
+  /// Only rows which are shown, and whose components changed since they were
+  /// last refreshed, are updated.
+  ///
   /// ## Configuration
-  /// None
+  ///
+  /// * `<update_rate>`: Maximum rate, in Hz, at which the components are
+  /// refreshed. Selecting another entity refreshes them right away.
+  /// Defaults to 10, 0 refreshes them on every update.
   class ComponentInspector : public gazebo::GuiSystem
   {
     Q_OBJECT
@@ -211,6 +211,11 @@ Rectangle {
     delegate: Loader {
       id: loader
       source: delegateQml(model)
+
+      // Only the components of rows which are shown are refreshed
+      property string typeId: model.typeId
+      Component.onCompleted: ComponentsModel.SetRowVisible(typeId, true)
+      Component.onDestruction: ComponentsModel.SetRowVisible(typeId, false)
     }
   }
 }
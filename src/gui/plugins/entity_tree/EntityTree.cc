@@ -17,7 +17,13 @@
 
 #include "EntityTree.hh"
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <utility>
 #include <vector>
 
 #include <ignition/common/Console.hh>
@@ -100,6 +106,50 @@ QString entityType(Entity _entity,
 /////////////////////////////////////////////////
 TreeModel::TreeModel() : QStandardItemModel()
 {
+  // The top level always has items
+  this->fetchedEntities.insert(kNullEntity);
+}
+
+/////////////////////////////////////////////////
+void TreeModel::QueueEntities(std::vector<EntityInfo> &&_added,
+    std::vector<Entity> &&_removed)
+{
+  if (_added.empty() && _removed.empty())
+    return;
+
+  std::lock_guard<std::mutex> lock(this->queueMutex);
+  this->queuedAdded.insert(this->queuedAdded.end(),
+      std::make_move_iterator(_added.begin()),
+      std::make_move_iterator(_added.end()));
+  this->queuedRemoved.insert(this->queuedRemoved.end(), _removed.begin(),
+      _removed.end());
+
+  // A single call processes everything queued until it runs
+  if (this->queueScheduled)
+    return;
+
+  this->queueScheduled = true;
+  QMetaObject::invokeMethod(this, "ProcessQueuedEntities",
+      Qt::QueuedConnection);
+}
+
+/////////////////////////////////////////////////
+void TreeModel::ProcessQueuedEntities()
+{
+  IGN_PROFILE_THREAD_NAME("Qt thread");
+  IGN_PROFILE("TreeModel::ProcessQueuedEntities");
+  std::vector<EntityInfo> added;
+  std::vector<Entity> removed;
+  {
+    std::lock_guard<std::mutex> lock(this->queueMutex);
+    std::swap(added, this->queuedAdded);
+    std::swap(removed, this->queuedRemoved);
+    this->queueScheduled = false;
+  }
+
+  this->AddEntities(added);
+  for (const auto &entity : removed)
+    this->RemoveEntity(entity);
 }
 
 /////////////////////////////////////////////////
@@ -108,93 +158,168 @@ void TreeModel::AddEntity(unsigned int _entity, const QString &_entityName,
 {
   IGN_PROFILE_THREAD_NAME("Qt thread");
   IGN_PROFILE("TreeModel::AddEntity");
-  QStandardItem *parentItem{nullptr};
+  this->AddEntities({{_entity, _entityName, _parentEntity, _type}});
+}
+
+/////////////////////////////////////////////////
+void TreeModel::AddEntities(const std::vector<EntityInfo> &_entities)
+{
+  IGN_PROFILE("TreeModel::AddEntities");
 
-  // Root
-  if (_parentEntity == kNullEntity)
+  // New children of the entities whose children have items, which get items
+  // too, and of the entities which have items but haven't been expanded
+  std::map<Entity, std::vector<Entity>> newItems;
+  std::set<Entity> newChildren;
+  for (const auto &info : _entities)
   {
-    parentItem = this->invisibleRootItem();
+    if (!this->entityInfos.emplace(info.entity, info).second)
+      continue;
+
+    this->entityChildren[info.parentEntity].push_back(info.entity);
+
+    if (this->fetchedEntities.find(info.parentEntity) !=
+        this->fetchedEntities.end())
+    {
+      newItems[info.parentEntity].push_back(info.entity);
+    }
+    else if (this->entityItems.find(info.parentEntity) !=
+        this->entityItems.end())
+    {
+      newChildren.insert(info.parentEntity);
+    }
+  }
+
+  for (const auto &children : newItems)
+    this->CreateItems(children.first, children.second);
+
+  // Let views know that these can be expanded now
+  for (const auto &entity : newChildren)
+  {
+    auto index = this->indexFromItem(this->entityItems[entity]);
+    emit this->dataChanged(index, index);
   }
+}
 
-  // Nested
-  // TODO(louise) There should be a way to easily access these from
-  // QStandardItemModel instead of keeping our own map
-  auto item = this->entityItems.find(_parentEntity);
-  if (item != this->entityItems.end())
+/////////////////////////////////////////////////
+void TreeModel::CreateItems(Entity _entity,
+    const std::vector<Entity> &_children)
+{
+  QStandardItem *parentItem{nullptr};
+  if (_entity == kNullEntity)
   {
+    parentItem = this->invisibleRootItem();
+  }
+  else
+  {
+    auto item = this->entityItems.find(_entity);
+    if (item == this->entityItems.end())
+      return;
     parentItem = item->second;
   }
 
-  if (nullptr == parentItem)
+  auto roles = this->roleNames();
+  int nameRole = roles.key("entityName");
+  int entityRole = roles.key("entity");
+  int typeRole = roles.key("type");
+
+  QList<QStandardItem *> items;
+  for (const auto &child : _children)
   {
-    this->pendingEntities.push_back(
-      {_entity, _entityName, _parentEntity, _type});
-    return;
+    const auto &info = this->entityInfos[child];
+
+    // New entity item
+    auto entityItem = new QStandardItem(info.name);
+    entityItem->setData(info.name, nameRole);
+    entityItem->setData(QString::number(info.entity), entityRole);
+    entityItem->setData(info.type, typeRole);
+
+    this->entityItems[child] = entityItem;
+    items.append(entityItem);
   }
 
-  // New entity item
-  auto entityItem = new QStandardItem(_entityName);
-  entityItem->setData(_entityName, this->roleNames().key("entityName"));
-  entityItem->setData(QString::number(_entity),
-      this->roleNames().key("entity"));
-  entityItem->setData(_type, this->roleNames().key("type"));
+  // All rows are inserted at once
+  parentItem->appendRows(items);
+}
 
-  parentItem->appendRow(entityItem);
+/////////////////////////////////////////////////
+bool TreeModel::hasChildren(const QModelIndex &_parent) const
+{
+  if (!_parent.isValid() || QStandardItemModel::hasChildren(_parent))
+    return QStandardItemModel::hasChildren(_parent);
 
-  this->entityItems[_entity] = entityItem;
+  // Children whose items haven't been created yet
+  auto children = this->entityChildren.find(this->EntityId(_parent));
+  return children != this->entityChildren.end() && !children->second.empty();
+}
 
-  // Check if there are pending children
-  auto sep = std::partition(this->pendingEntities.begin(),
-      this->pendingEntities.end(), [&_entity](const EntityInfo &_entityInfo)
-      {
-        return _entityInfo.parentEntity != _entity;
-      });
+/////////////////////////////////////////////////
+bool TreeModel::canFetchMore(const QModelIndex &_parent) const
+{
+  if (!_parent.isValid())
+    return QStandardItemModel::canFetchMore(_parent);
 
-  for (auto it = sep; it != this->pendingEntities.end(); ++it)
-  {
-    this->AddEntity(it->entity, it->name, it->parentEntity, it->type);
-  }
-  this->pendingEntities.erase(sep, this->pendingEntities.end());
+  auto entity = this->EntityId(_parent);
+  if (this->fetchedEntities.find(entity) != this->fetchedEntities.end())
+    return false;
+
+  auto children = this->entityChildren.find(entity);
+  return children != this->entityChildren.end() && !children->second.empty();
+}
+
+/////////////////////////////////////////////////
+void TreeModel::fetchMore(const QModelIndex &_parent)
+{
+  IGN_PROFILE("TreeModel::fetchMore");
+  if (!this->canFetchMore(_parent))
+    return;
+
+  auto entity = this->EntityId(_parent);
+  this->fetchedEntities.insert(entity);
+  this->CreateItems(entity, this->entityChildren[entity]);
 }
 
 /////////////////////////////////////////////////
 void TreeModel::RemoveEntity(unsigned int _entity)
 {
   IGN_PROFILE("TreeModel::RemoveEntity");
+  auto infoIt = this->entityInfos.find(_entity);
+  if (infoIt == this->entityInfos.end())
+    return;
+
+  // Remove from the parent's children
+  auto siblings = this->entityChildren.find(infoIt->second.parentEntity);
+  if (siblings != this->entityChildren.end())
+  {
+    siblings->second.erase(std::remove(siblings->second.begin(),
+        siblings->second.end(), _entity), siblings->second.end());
+    if (siblings->second.empty())
+      this->entityChildren.erase(siblings);
+  }
+
   QStandardItem *item{nullptr};
   auto itemIt = this->entityItems.find(_entity);
   if (itemIt != this->entityItems.end())
-  {
     item = itemIt->second;
-  }
 
-  if (nullptr == item)
+  // Remove the entity and all its descendants from our custom maps
+  std::function<void(Entity)> removeChildren = [&](Entity _child)
   {
-    // See if it's pending
-    auto toRemove = std::remove_if(this->pendingEntities.begin(),
-        this->pendingEntities.end(), [&_entity](const EntityInfo &_entityInfo)
-        {
-          return _entityInfo.entity == _entity;
-        });
-    this->pendingEntities.erase(toRemove, this->pendingEntities.end());
-
-    return;
-  }
-
-  // Remove all children from our custom map
-  std::function<void(const QStandardItem *)> removeChildren =
-      [&](const QStandardItem *_item)
-  {
-    for (int i = 0; i < _item->rowCount(); ++i)
+    auto children = this->entityChildren.find(_child);
+    if (children != this->entityChildren.end())
     {
-      auto childItem = _item->child(i);
-      removeChildren(childItem);
-      this->entityItems.erase(childItem->data(
-          this->roleNames().key("entity")).toUInt());
+      auto grandChildren = std::move(children->second);
+      this->entityChildren.erase(children);
+      for (const auto &grandChild : grandChildren)
+        removeChildren(grandChild);
     }
+    this->entityInfos.erase(_child);
+    this->entityItems.erase(_child);
+    this->fetchedEntities.erase(_child);
   };
-  this->entityItems.erase(_entity);
-  removeChildren(item);
+  removeChildren(_entity);
+
+  if (nullptr == item)
+    return;
 
   // Remove from the view
   if (nullptr == item->parent())
@@ -254,6 +379,30 @@ unsigned int TreeModel::EntityId(const QModelIndex &_index) const
   return entityVar.toUInt();
 }
 
+/////////////////////////////////////////////////
+QModelIndex TreeModel::EntityIndex(unsigned int _entity)
+{
+  auto item = this->entityItems.find(_entity);
+  if (item == this->entityItems.end())
+  {
+    auto info = this->entityInfos.find(_entity);
+    if (info == this->entityInfos.end())
+      return QModelIndex();
+
+    // Create the items down from the closest ancestor which has one
+    auto parentIndex = this->EntityIndex(info->second.parentEntity);
+    if (!parentIndex.isValid())
+      return QModelIndex();
+
+    this->fetchMore(parentIndex);
+    item = this->entityItems.find(_entity);
+    if (item == this->entityItems.end())
+      return QModelIndex();
+  }
+
+  return this->indexFromItem(item->second);
+}
+
 /////////////////////////////////////////////////
 QHash<int, QByteArray> TreeModel::roleNames() const
 {
@@ -288,6 +437,11 @@ void EntityTree::LoadConfig(const tinyxml2::XMLElement *)
 void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
 {
   IGN_PROFILE("EntityTree::Update");
+
+  // Entities are sent to the Qt thread in a single batch per update
+  std::vector<TreeModel::EntityInfo> added;
+  std::vector<Entity> removed;
+
   // Treat all pre-existent entities as new at startup
   if (!this->dataPtr->initialized)
   {
@@ -320,12 +474,8 @@ void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
         parentEntity = kNullEntity;
       }
 
-      QMetaObject::invokeMethod(&this->dataPtr->treeModel, "AddEntity",
-          Qt::QueuedConnection,
-          Q_ARG(unsigned int, _entity),
-          Q_ARG(QString, QString::fromStdString(_name->Data())),
-          Q_ARG(unsigned int, parentEntity),
-          Q_ARG(QString, entityType(_entity, _ecm)));
+      added.push_back({_entity, QString::fromStdString(_name->Data()),
+          parentEntity, entityType(_entity, _ecm)});
       return true;
     });
 
@@ -350,12 +500,8 @@ void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
         parentEntity = kNullEntity;
       }
 
-      QMetaObject::invokeMethod(&this->dataPtr->treeModel, "AddEntity",
-          Qt::QueuedConnection,
-          Q_ARG(unsigned int, _entity),
-          Q_ARG(QString, QString::fromStdString(_name->Data())),
-          Q_ARG(unsigned int, parentEntity),
-          Q_ARG(QString, entityType(_entity, _ecm)));
+      added.push_back({_entity, QString::fromStdString(_name->Data()),
+          parentEntity, entityType(_entity, _ecm)});
       return true;
     });
   }
@@ -364,11 +510,11 @@ void EntityTree::Update(const UpdateInfo &, EntityComponentManager &_ecm)
     [&](const Entity &_entity,
         const components::Name *)->bool
   {
-    QMetaObject::invokeMethod(&this->dataPtr->treeModel, "RemoveEntity",
-        Qt::QueuedConnection,
-        Q_ARG(unsigned int, _entity));
+    removed.push_back(_entity);
     return true;
   });
+
+  this->dataPtr->treeModel.QueueEntities(std::move(added), std::move(removed));
 }
 
 /////////////////////////////////////////////////
@@ -20,6 +20,9 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <ignition/gazebo/gui/GuiSystem.hh>
@@ -30,11 +33,36 @@ namespace gazebo
 {
   class EntityTreePrivate;
 
-  /// \brief TODO
+  /// \brief Tree of the entities in the world. Items are only created for
+  /// the top-level entities and for the children of entities which have been
+  /// expanded, so large worlds don't populate the whole tree. The hierarchy
+  /// of the other entities is kept to create their items when they're
+  /// fetched, see fetchMore.
+  ///
+  /// Entities can be queued from any thread with QueueEntities, and are
+  /// added and removed in batches on the Qt thread.
   class TreeModel : public QStandardItemModel
   {
     Q_OBJECT
 
+    /// \brief Entity information used to queue the pending entities
+    public: struct EntityInfo
+    {
+      /// \brief Entity ID
+      // cppcheck-suppress unusedStructMember
+      unsigned int entity;
+
+      /// \brief Entity name
+      QString name;
+
+      /// \brief Parent ID
+      // cppcheck-suppress unusedStructMember
+      unsigned int parentEntity;
+
+      /// \brief Entity type
+      QString type;
+    };
+
     /// \brief Constructor
     public: explicit TreeModel();
 
@@ -44,6 +72,23 @@ namespace gazebo
     // Documentation inherited
     public: QHash<int, QByteArray> roleNames() const override;
 
+    // Documentation inherited
+    public: bool hasChildren(
+        const QModelIndex &_parent = QModelIndex()) const override;
+
+    // Documentation inherited
+    public: bool canFetchMore(const QModelIndex &_parent) const override;
+
+    // Documentation inherited
+    public: void fetchMore(const QModelIndex &_parent) override;
+
+    /// \brief Queue entities to be added to and removed from the tree. They
+    /// are processed together on the Qt thread, added first. Thread-safe.
+    /// \param[in] _added Entities to be added.
+    /// \param[in] _removed Entities to be removed.
+    public: void QueueEntities(std::vector<EntityInfo> &&_added,
+        std::vector<Entity> &&_removed);
+
     /// \brief Add an entity to the tree.
     /// \param[in] _entity Entity to be added
     /// \param[in] _entityName Name of entity to be added
@@ -59,6 +104,9 @@ namespace gazebo
     /// \param[in] _entity Entity to be removed
     public slots: void RemoveEntity(unsigned int _entity);
 
+    /// \brief Process the entities queued with QueueEntities.
+    private slots: void ProcessQueuedEntities();
+
     /// \brief Get the entity type of a tree item at specified index
     /// \param[in] _index Model index
     /// \return Type of entity
@@ -74,30 +122,48 @@ namespace gazebo
     /// \return Entity ID
     public: Q_INVOKABLE unsigned int EntityId(const QModelIndex &_index) const;
 
+    /// \brief Get the index of an entity's item, fetching the children of
+    /// its ancestors if they haven't been yet.
+    /// \param[in] _entity Entity ID
+    /// \return Model index, invalid if the entity isn't in the tree.
+    public: Q_INVOKABLE QModelIndex EntityIndex(unsigned int _entity);
+
+    /// \brief Add entities to the tree, creating the items of those whose
+    /// parent's children have been fetched.
+    /// \param[in] _entities Entities to be added.
+    private: void AddEntities(const std::vector<EntityInfo> &_entities);
+
+    /// \brief Create the items of an entity's children.
+    /// \param[in] _entity Parent entity, kNullEntity for the top level.
+    /// \param[in] _children Children whose items should be created.
+    private: void CreateItems(Entity _entity,
+        const std::vector<Entity> &_children);
+
     /// \brief Keep track of which item corresponds to which entity.
     private: std::map<Entity, QStandardItem *> entityItems;
 
-    /// \brief Entity information used to queue the pending entities
-    struct EntityInfo
-    {
-      /// \brief Entity ID
-      // cppcheck-suppress unusedStructMember
-      unsigned int entity;
+    /// \brief All the entities in the tree, with or without items.
+    private: std::unordered_map<Entity, EntityInfo> entityInfos;
 
-      /// \brief Entity name
-      QString name;
+    /// \brief Children of each entity, kNullEntity for the top level. An
+    /// entity added before its parent waits here until its parent shows up
+    /// or it's deleted.
+    private: std::unordered_map<Entity, std::vector<Entity>> entityChildren;
 
-      /// \brief Parent ID
-      // cppcheck-suppress unusedStructMember
-      unsigned int parentEntity;
+    /// \brief Entities whose children have items.
+    private: std::unordered_set<Entity> fetchedEntities;
 
-      /// \brief Entity type
-      QString type;
-    };
+    /// \brief Protects the queued entities.
+    private: std::mutex queueMutex;
+
+    /// \brief Entities queued to be added.
+    private: std::vector<EntityInfo> queuedAdded;
+
+    /// \brief Entities queued to be removed.
+    private: std::vector<Entity> queuedRemoved;
 
-    /// \brief If an entity is added before its parent, we queue it in this
-    /// vector until their parent shows up or they are deleted.
-    private: std::vector<EntityInfo> pendingEntities;
+    /// \brief True while the queued entities wait to be processed.
+    private: bool queueScheduled{false};
   };
 
   /// \brief Displays a tree view with all the entities in the world.
@@ -61,28 +61,14 @@ Rectangle {
     tree.selection.clear()
   }
 
-  /*
-   * Iterate through item's children until the one corresponding to _entity is
-   * found and select that.
-   */
-  function selectFromCpp(_entity, itemId) {
-    if (EntityTreeModel.data(itemId, 101) == _entity) {
-      tree.selection.select(itemId, ItemSelectionModel.Select)
-      return
-    }
-    for (var i = 0; i < EntityTreeModel.rowCount(itemId); i++) {
-      selectFromCpp(_entity, EntityTreeModel.index(i, 0, itemId))
-    }
-  }
-
   /*
    * Callback when an entity selection comes from the C++ code.
    * For example, if it comes from the 3D window.
    */
   function onEntitySelectedFromCpp(_entity) {
-    for(var i = 0; i < EntityTreeModel.rowCount(); i++) {
-      var itemId = EntityTreeModel.index(i, 0)
-      selectFromCpp(_entity, itemId)
+    var itemId = EntityTreeModel.EntityIndex(_entity)
+    if (itemId.valid) {
+      tree.selection.select(itemId, ItemSelectionModel.Select)
     }
   }
 
@@ -17,6 +17,12 @@
 
 #include "Plotting.hh"
 
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include <ignition/common/Profiler.hh>
 #include <ignition/plugin/Register.hh>
 
 #include "ignition/gazebo/components/AngularAcceleration.hh"
@@ -49,6 +55,92 @@ namespace ignition::gazebo
     /// map key: string contains EntityID + "," + ComponentID
     public: std::map<std::string,
       std::shared_ptr<PlotComponent>> components;
+
+    /// \brief Protects the components, which are updated by the GUI runner
+    /// and registered and sent to the charts on the Qt thread
+    public: std::mutex mutex;
+
+    /// \brief Timer to update the charts
+    public: QTimer chartTimer;
+
+    /// \brief Period between chart updates, in milliseconds
+    public: int chartPeriod{33};
+
+    /// \brief Maximum samples buffered per attribute between chart updates
+    public: std::size_t bufferSize{1000};
+
+    /// \brief Sim time of the last sampled update, samples are only taken
+    /// when it changes
+    public: std::chrono::steady_clock::duration lastSimTime{-1};
+  };
+
+  /// \brief Fixed-capacity ring buffer of the samples of an attribute which
+  /// haven't been sent to the charts yet. Once full, the oldest samples are
+  /// overwritten.
+  class SampleRing
+  {
+    /// \brief Constructor
+    /// \param[in] _capacity Maximum number of samples
+    public: explicit SampleRing(std::size_t _capacity)
+        : samples(std::max<std::size_t>(_capacity, 1u))
+    {
+    }
+
+    /// \brief Add a sample
+    /// \param[in] _sample Time in X, value in Y
+    public: void Push(const math::Vector2d &_sample)
+    {
+      this->samples[(this->start + this->count) % this->samples.size()] =
+          _sample;
+      if (this->count < this->samples.size())
+        ++this->count;
+      else
+        this->start = (this->start + 1) % this->samples.size();
+    }
+
+    /// \brief Take the minimum and maximum samples, in time order, and
+    /// empty the buffer
+    /// \param[out] _points Samples are appended here
+    public: void Take(std::vector<math::Vector2d> &_points)
+    {
+      if (this->count == 0)
+        return;
+
+      std::size_t minIndex{0};
+      std::size_t maxIndex{0};
+      for (std::size_t i = 1; i < this->count; ++i)
+      {
+        double value = this->At(i).Y();
+        if (value < this->At(minIndex).Y())
+          minIndex = i;
+        if (value > this->At(maxIndex).Y())
+          maxIndex = i;
+      }
+
+      _points.push_back(this->At(std::min(minIndex, maxIndex)));
+      if (minIndex != maxIndex)
+        _points.push_back(this->At(std::max(minIndex, maxIndex)));
+
+      this->start = 0;
+      this->count = 0;
+    }
+
+    /// \brief Get a sample
+    /// \param[in] _index Index from the oldest sample
+    /// \return The sample
+    private: const math::Vector2d &At(std::size_t _index) const
+    {
+      return this->samples[(this->start + _index) % this->samples.size()];
+    }
+
+    /// \brief Storage
+    private: std::vector<math::Vector2d> samples;
+
+    /// \brief Index of the oldest sample
+    private: std::size_t start{0};
+
+    /// \brief Number of samples
+    private: std::size_t count{0};
   };
 
   class PlotComponentPrivate
@@ -66,6 +158,12 @@ namespace ignition::gazebo
     /// ex: x,y,z attributes in Vector3d type component
     public: std::map<std::string,
       std::shared_ptr<ignition::gui::PlotData>> data;
+
+    /// \brief Maximum samples buffered per attribute
+    public: std::size_t bufferSize;
+
+    /// \brief Samples not sent to the charts yet, per attribute
+    public: std::map<std::string, SampleRing> samples;
   };
 }
 
@@ -75,12 +173,14 @@ using namespace ignition::gui;
 //////////////////////////////////////////////////
 PlotComponent::PlotComponent(const std::string &_type,
                              ignition::gazebo::Entity _entity,
-                             ComponentTypeId _typeId) :
+                             ComponentTypeId _typeId,
+                             std::size_t _bufferSize) :
     dataPtr(std::make_unique<PlotComponentPrivate>())
 {
   this->dataPtr->entity = _entity;
   this->dataPtr->typeId = _typeId;
   this->dataPtr->type = _type;
+  this->dataPtr->bufferSize = _bufferSize;
 
   if (_type == "Vector3d")
   {
@@ -175,6 +275,33 @@ void PlotComponent::SetAttributeValue(std::string _attribute,
     this->dataPtr->data[_attribute]->SetValue(_value);
 }
 
+//////////////////////////////////////////////////
+void PlotComponent::BufferSample(const std::string &_attribute, double _time)
+{
+  auto attribute = this->dataPtr->data.find(_attribute);
+  if (attribute == this->dataPtr->data.end())
+    return;
+
+  auto ring = this->dataPtr->samples.find(_attribute);
+  if (ring == this->dataPtr->samples.end())
+  {
+    ring = this->dataPtr->samples.emplace(_attribute,
+        SampleRing(this->dataPtr->bufferSize)).first;
+  }
+  ring->second.Push({_time, attribute->second->Value()});
+}
+
+//////////////////////////////////////////////////
+std::vector<ignition::math::Vector2d> PlotComponent::TakeSamples(
+    const std::string &_attribute)
+{
+  std::vector<ignition::math::Vector2d> points;
+  auto ring = this->dataPtr->samples.find(_attribute);
+  if (ring != this->dataPtr->samples.end())
+    ring->second.Take(points);
+  return points;
+}
+
 //////////////////////////////////////////////////
 std::map<std::string, std::shared_ptr<PlotData>> PlotComponent::Data() const
 {
@@ -212,6 +339,9 @@ Plotting ::Plotting() : GuiSystem(),
 
   this->connect(this->dataPtr->plottingIface.get(),
           SIGNAL(ComponentName(uint64_t)), this, SLOT(ComponentName(uint64_t)));
+
+  this->connect(&this->dataPtr->chartTimer, &QTimer::timeout,
+          this, &Plotting::UpdateCharts);
 }
 
 //////////////////////////////////////////////////
@@ -220,10 +350,31 @@ Plotting ::~Plotting()
 }
 
 //////////////////////////////////////////
-void Plotting::LoadConfig(const tinyxml2::XMLElement *)
+void Plotting::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
 {
   if (this->title.empty())
     this->title = "Plotting";
+
+  if (_pluginElem)
+  {
+    if (auto elem = _pluginElem->FirstChildElement("update_rate"))
+    {
+      double rate{0.0};
+      elem->QueryDoubleText(&rate);
+      if (rate > 0.0)
+        this->dataPtr->chartPeriod = std::max(1, static_cast<int>(1000 / rate));
+    }
+
+    if (auto elem = _pluginElem->FirstChildElement("buffer_size"))
+    {
+      unsigned int size{0};
+      elem->QueryUnsignedText(&size);
+      if (size > 0)
+        this->dataPtr->bufferSize = size;
+    }
+  }
+
+  this->dataPtr->chartTimer.start(this->dataPtr->chartPeriod);
 }
 
 //////////////////////////////////////////////////
@@ -323,10 +474,11 @@ void Plotting::RegisterChartToComponent(uint64_t _entity, uint64_t _typeId,
 {
   std::string Id = std::to_string(_entity) + "," + std::to_string(_typeId);
 
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
   if (this->dataPtr->components.count(Id) == 0)
   {
     this->dataPtr->components[Id] = std::make_shared<PlotComponent>(
-          _type, _entity, _typeId);
+          _type, _entity, _typeId, this->dataPtr->bufferSize);
   }
 
   this->dataPtr->components[Id]->RegisterChart(_attribute, _chart);
@@ -339,6 +491,7 @@ void Plotting::UnRegisterChartFromComponent(uint64_t _entity, uint64_t _typeId,
   std::string id = std::to_string(_entity) + "," + std::to_string(_typeId);
   igndbg << "UnRegister [" << id  << "]" << std::endl;
 
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
   if (this->dataPtr->components.count(id) == 0)
     return;
 
@@ -365,6 +518,16 @@ std::string Plotting::ComponentName(const uint64_t &_typeId)
 void Plotting ::Update(const ignition::gazebo::UpdateInfo &_info,
                        ignition::gazebo::EntityComponentManager &_ecm)
 {
+  IGN_PROFILE("Plotting::Update");
+
+  // Plugins are also updated between states, which don't add samples
+  if (_info.simTime == this->dataPtr->lastSimTime)
+    return;
+  this->dataPtr->lastSimTime = _info.simTime;
+
+  double x = _info.simTime.count() * std::pow(10, -9);
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
   for (auto component : this->dataPtr->components)
   {
     auto entity = component.second->Entity();
@@ -492,17 +655,41 @@ void Plotting ::Update(const ignition::gazebo::UpdateInfo &_info,
       }
     }
 
+    // The charts get the samples at their next update
     for (auto attribute : component.second->Data())
     {
-      for (auto chart : attribute.second->Charts())
-      {
-        QString attributeName = QString::fromStdString(
-                    component.first + "," + attribute.first);
-        double y = attribute.second->Value();
+      if (attribute.second->ChartCount() > 0)
+        component.second->BufferSample(attribute.first, x);
+    }
+  }
+}
 
-        double x = _info.simTime.count() * std::pow(10, -9);
+//////////////////////////////////////////////////
+void Plotting::UpdateCharts()
+{
+  IGN_PROFILE("Plotting::UpdateCharts");
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  for (auto component : this->dataPtr->components)
+  {
+    for (auto attribute : component.second->Data())
+    {
+      auto charts = attribute.second->Charts();
+      if (charts.empty())
+        continue;
 
-        emit this->dataPtr->plottingIface->plot(chart, attributeName, x, y);
+      auto points = component.second->TakeSamples(attribute.first);
+      if (points.empty())
+        continue;
+
+      QString attributeName = QString::fromStdString(
+                  component.first + "," + attribute.first);
+      for (auto chart : charts)
+      {
+        for (const auto &point : points)
+        {
+          emit this->dataPtr->plottingIface->plot(chart, attributeName,
+              point.X(), point.Y());
+        }
       }
     }
   }
@@ -21,6 +21,7 @@
 #include <ignition/gui/Application.hh>
 #include <ignition/gui/PlottingInterface.hh>
 #include <ignition/gazebo/gui/GuiSystem.hh>
+#include <ignition/math/Vector2.hh>
 #include <ignition/math/Vector3.hh>
 #include <ignition/math/Pose3.hh>
 #include <ignition/msgs/light.pb.h>
@@ -30,6 +31,7 @@
 #include <map>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace ignition {
 
@@ -45,9 +47,12 @@ class PlotComponent
   /// \param[in] _type component data type (Pose3d, Vector3d, double)
   /// \param [in] _entity entity id of that component
   /// \param [in] _typeId type identifier unique to each component type
+  /// \param [in] _bufferSize maximum number of samples buffered per
+  /// attribute between calls to TakeSamples, older samples are dropped
   public: PlotComponent(const std::string &_type,
                         ignition::gazebo::Entity _entity,
-                        ComponentTypeId _typeId);
+                        ComponentTypeId _typeId,
+                        std::size_t _bufferSize = 1000);
 
   /// \brief Destructor
   public: ~PlotComponent();
@@ -73,6 +78,19 @@ class PlotComponent
   /// \param[in] _value value to be set to the attribute
   public: void SetAttributeValue(std::string _attribute, const double &_value);
 
+  /// \brief Buffer the current value of an attribute, to be sent to its
+  /// charts later, see TakeSamples
+  /// \param[in] _attribute component attribute
+  /// \param[in] _time time of the sample, in seconds
+  public: void BufferSample(const std::string &_attribute, double _time);
+
+  /// \brief Take the samples buffered for an attribute since the previous
+  /// call, decimated to their minimum and maximum values, in time order
+  /// \param[in] _attribute component attribute
+  /// \return up to two samples, time in X and value in Y
+  public: std::vector<ignition::math::Vector2d> TakeSamples(
+              const std::string &_attribute);
+
   /// \brief Get all attributes of the component
   /// \return component attributes
   public: std::map<std::string, std::shared_ptr<ignition::gui::PlotData>>
@@ -94,6 +112,14 @@ class PlottingPrivate;
 
 /// \brief Physics data plotting handler that keeps track of the
 /// registered components, update them and update the plot
+///
+/// ## Configuration
+///
+/// * `<update_rate>`: Rate, in Hz, at which the charts are updated. The
+/// samples of each attribute since the previous chart update are decimated
+/// to their minimum and maximum. Defaults to 30.
+/// * `<buffer_size>`: Maximum number of samples buffered per attribute
+/// between chart updates. Defaults to 1000.
 class Plotting : public ignition::gazebo::GuiSystem
 {
   Q_OBJECT
@@ -164,6 +190,12 @@ class Plotting : public ignition::gazebo::GuiSystem
                                                   std::string _attribute,
                                                   int _chart);
 
+  /// \brief Send the samples buffered since the previous call to the
+  /// charts. Called once per GUI frame, so however often the components
+  /// are updated, each attribute adds at most its minimum and maximum
+  /// values to its charts per frame.
+  private: void UpdateCharts();
+
   /// \brief Get Component Name based on its type Id
   /// \param[in] _typeId type Id of the component
   /// \return Component name
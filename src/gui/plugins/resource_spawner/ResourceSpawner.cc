@@ -21,8 +21,17 @@
 #include <ignition/msgs/stringmsg.pb.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
 #include <set>
+#include <sstream>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 
 #include <sdf/Root.hh>
 #include <sdf/parser.hh>
@@ -30,6 +39,7 @@
 #include <ignition/common/Console.hh>
 #include <ignition/common/Profiler.hh>
 #include <ignition/common/Filesystem.hh>
+#include <ignition/common/Util.hh>
 #include <ignition/gui/Application.hh>
 #include <ignition/gui/GuiEvents.hh>
 #include <ignition/gui/MainWindow.hh>
@@ -70,12 +80,74 @@ namespace ignition::gazebo
     public: std::unordered_map<std::string,
             std::vector<Resource>> ownerModelMap;
 
+    /// \brief Resources found at each local path by the last scan.
+    public: std::unordered_map<std::string,
+            std::vector<Resource>> localResourceMap;
+
+    /// \brief Time of the last scan of each local path.
+    public: std::unordered_map<std::string,
+            std::chrono::steady_clock::time_point> localScanTimes;
+
+    /// \brief Local paths waiting to be scanned in the background.
+    public: std::deque<std::string> localScanQueue;
+
+    /// \brief Protects the maps and queue above, which are filled by the
+    /// background threads.
+    public: std::mutex mutex;
+
+    /// \brief Wakes up the local scan thread.
+    public: std::condition_variable localScanCv;
+
+    /// \brief Tells the background threads to stop.
+    public: std::atomic<bool> stop{false};
+
+    /// \brief Thread loading the Fuel catalog.
+    public: std::thread fuelThread;
+
+    /// \brief Thread scanning local paths.
+    public: std::thread localThread;
+
     /// \brief Holds all of the relevant data used by `DisplayData()` in order
     /// to filter and sort the displayed resources as desired by the user.
     public: Display displayData;
+
+    /// \brief Path of the index of the Fuel catalog, which is kept between
+    /// sessions so owners are listed before the catalog is fetched again.
+    /// \return Path to the index file.
+    public: static std::string FuelIndexPath();
+
+    /// \brief Read the Fuel index.
+    /// \return Resources with their name, owner and URI.
+    public: static std::vector<Resource> LoadFuelIndex();
+
+    /// \brief Write the Fuel index.
+    /// \param[in] _resources Resources of the catalog, with the URI of
+    /// each model as their SDF path.
+    public: static void SaveFuelIndex(const std::vector<Resource> &_resources);
   };
 }
 
+namespace
+{
+/// \brief Minimum time between background scans of a local path.
+const std::chrono::seconds kLocalRescanPeriod{5};
+
+/// \brief Check whether two lists of resources are the same.
+/// \param[in] _a First list
+/// \param[in] _b Second list
+/// \return True if both have the same resources in the same order.
+bool sameResources(const std::vector<ignition::gazebo::Resource> &_a,
+                   const std::vector<ignition::gazebo::Resource> &_b)
+{
+  return std::equal(_a.begin(), _a.end(), _b.begin(), _b.end(),
+      [](const auto &_left, const auto &_right)
+      {
+        return _left.name == _right.name && _left.sdfPath == _right.sdfPath &&
+            _left.thumbnailPath == _right.thumbnailPath;
+      });
+}
+}
+
 using namespace ignition;
 using namespace gazebo;
 
@@ -100,6 +172,16 @@ void PathModel::AddPath(const std::string &_path)
   parentItem->appendRow(localModel);
 }
 
+/////////////////////////////////////////////////
+void PathModel::SetPaths(const QStringList &_paths)
+{
+  IGN_PROFILE_THREAD_NAME("Qt thread");
+  IGN_PROFILE("PathModel::SetPaths");
+  this->clear();
+  for (const auto &path : _paths)
+    this->AddPath(path.toStdString());
+}
+
 /////////////////////////////////////////////////
 QHash<int, QByteArray> PathModel::roleNames() const
 {
@@ -223,7 +305,74 @@ ResourceSpawner::ResourceSpawner()
 }
 
 /////////////////////////////////////////////////
-ResourceSpawner::~ResourceSpawner() = default;
+ResourceSpawner::~ResourceSpawner()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->stop = true;
+  }
+  this->dataPtr->localScanCv.notify_all();
+  if (this->dataPtr->localThread.joinable())
+    this->dataPtr->localThread.join();
+  if (this->dataPtr->fuelThread.joinable())
+    this->dataPtr->fuelThread.join();
+}
+
+/////////////////////////////////////////////////
+std::string ResourceSpawnerPrivate::FuelIndexPath()
+{
+  std::string home;
+  common::env(IGN_HOMEDIR, home);
+  return common::joinPaths(home, ".ignition", "gazebo", "resource_spawner",
+      "fuel_index.txt");
+}
+
+/////////////////////////////////////////////////
+std::vector<Resource> ResourceSpawnerPrivate::LoadFuelIndex()
+{
+  // One model per line, with tab separated owner, name and URI
+  std::vector<Resource> resources;
+  std::ifstream file(FuelIndexPath());
+  std::string line;
+  while (std::getline(file, line))
+  {
+    std::istringstream fields(line);
+    Resource resource;
+    if (!std::getline(fields, resource.owner, '\t') ||
+        !std::getline(fields, resource.name, '\t') ||
+        !std::getline(fields, resource.sdfPath))
+    {
+      continue;
+    }
+    resource.isFuel = true;
+    resources.push_back(resource);
+  }
+  return resources;
+}
+
+/////////////////////////////////////////////////
+void ResourceSpawnerPrivate::SaveFuelIndex(
+    const std::vector<Resource> &_resources)
+{
+  const auto path = FuelIndexPath();
+  if (!common::createDirectories(common::parentPath(path)))
+    return;
+
+  // Write to a temporary file first, so an interrupted write doesn't leave
+  // a truncated index
+  const auto tmpPath = path + ".tmp";
+  {
+    std::ofstream file(tmpPath);
+    for (const auto &resource : _resources)
+    {
+      file << resource.owner << '\t' << resource.name << '\t'
+           << resource.sdfPath << '\n';
+    }
+    if (!file)
+      return;
+  }
+  common::moveFile(tmpPath, path);
+}
 
 /////////////////////////////////////////////////
 void ResourceSpawner::SetThumbnail(const std::string &_thumbnailPath,
@@ -293,6 +442,36 @@ Resource ResourceSpawner::LocalResource(const std::string &_path)
 /////////////////////////////////////////////////
 std::vector<Resource> ResourceSpawner::LocalResources(const std::string &_path)
 {
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    auto cached = this->dataPtr->localResourceMap.find(_path);
+    if (cached != this->dataPtr->localResourceMap.end())
+    {
+      // Refresh in the background, results are displayed if they changed
+      auto &scanTime = this->dataPtr->localScanTimes[_path];
+      if (std::chrono::steady_clock::now() - scanTime > kLocalRescanPeriod)
+      {
+        scanTime = std::chrono::steady_clock::now();
+        this->dataPtr->localScanQueue.push_back(_path);
+        this->dataPtr->localScanCv.notify_one();
+      }
+      return cached->second;
+    }
+  }
+
+  auto resources = this->ScanLocalResources(_path);
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->localResourceMap[_path] = resources;
+  this->dataPtr->localScanTimes[_path] = std::chrono::steady_clock::now();
+  return resources;
+}
+
+/////////////////////////////////////////////////
+std::vector<Resource> ResourceSpawner::ScanLocalResources(
+    const std::string &_path)
+{
+  IGN_PROFILE("ResourceSpawner::ScanLocalResources");
   // Only searches one directory deep for potential files named `model.config`
   std::string path = _path;
   std::vector<Resource> localResources;
@@ -330,6 +509,7 @@ std::vector<Resource> ResourceSpawner::FuelResources(const std::string &_owner)
 {
   std::vector<Resource> fuelResources;
 
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
   if (this->dataPtr->ownerModelMap.find(_owner) !=
       this->dataPtr->ownerModelMap.end())
   {
@@ -496,6 +676,7 @@ void ResourceSpawner::OnDownloadFuelResource(const QString &_path,
     this->dataPtr->resourceModel.UpdateResourceModel(index, modelResource);
 
     // Update the ground truth ownerModelMap
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
     if (this->dataPtr->ownerModelMap.find(_owner.toStdString()) !=
         this->dataPtr->ownerModelMap.end())
     {
@@ -552,63 +733,160 @@ void ResourceSpawner::LoadConfig(const tinyxml2::XMLElement *)
     this->AddPath(path);
   }
 
+  // Scan local paths in the background, so they're listed right away when
+  // clicked, and rescan them when they're viewed again
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    for (int i = 0; i < res.data_size(); i++)
+      this->dataPtr->localScanQueue.push_back(res.data(i));
+  }
+  this->dataPtr->localThread = std::thread([this]
+  {
+    std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+    while (!this->dataPtr->stop)
+    {
+      if (this->dataPtr->localScanQueue.empty())
+      {
+        this->dataPtr->localScanCv.wait(lock);
+        continue;
+      }
+      auto path = this->dataPtr->localScanQueue.front();
+      this->dataPtr->localScanQueue.pop_front();
+
+      lock.unlock();
+      auto resources = this->ScanLocalResources(path);
+      lock.lock();
+
+      this->dataPtr->localScanTimes[path] = std::chrono::steady_clock::now();
+      auto &cached = this->dataPtr->localResourceMap[path];
+      if (sameResources(cached, resources))
+        continue;
+      cached = std::move(resources);
+      QMetaObject::invokeMethod(this, "OnLocalResourcesChanged",
+          Qt::QueuedConnection, Q_ARG(QString, QString::fromStdString(path)));
+    }
+  });
+
   auto servers = this->dataPtr->fuelClient->Config().Servers();
-  ignmsg << "Please wait... Loading models from Fuel.\n";
 
-  // Add notice for the user that fuel resources are being loaded
-  this->dataPtr->ownerModel.AddPath("Please wait... Loading models from Fuel.");
+  // Owners of the previous session are listed until the catalog is fetched
+  auto catalog = ResourceSpawnerPrivate::LoadFuelIndex();
+  if (catalog.empty())
+  {
+    ignmsg << "Please wait... Loading models from Fuel.\n";
+
+    // Add notice for the user that fuel resources are being loaded
+    this->dataPtr->ownerModel.AddPath(
+        "Please wait... Loading models from Fuel.");
+  }
 
   // Pull in fuel models asynchronously
-  std::thread t([this, servers]
+  this->dataPtr->fuelThread = std::thread([this, servers, catalog]
   {
-    // A set isn't necessary to keep track of the owners, but it
-    // maintains alphabetical order
-    std::set<std::string> ownerSet;
-    for (auto const &server : servers)
+    // Fill the resources of the catalog with their cached state, and hand
+    // them over to the Qt thread
+    auto publish = [this](const std::vector<Resource> &_catalog)
     {
-      std::vector<ignition::fuel_tools::ModelIdentifier> models;
-      for (auto iter = this->dataPtr->fuelClient->Models(server); iter; ++iter)
+      // A set isn't necessary to keep track of the owners, but it
+      // maintains alphabetical order
+      std::set<std::string> ownerSet;
+      std::unordered_map<std::string, std::vector<Resource>> ownerModelMap;
+      for (auto resource : _catalog)
       {
-        models.push_back(iter->Identification());
-      }
-
-      // Create each fuel resource and add them to the ownerModelMap
-      for (auto id : models)
-      {
-        Resource resource;
-        resource.name = id.Name();
-        resource.isFuel = true;
-        resource.isDownloaded = false;
-        resource.owner = id.Owner();
-        resource.sdfPath = id.UniqueName();
-        std::string path;
+        if (this->dataPtr->stop)
+          return;
 
         // If the resource is cached, we can go ahead and populate the
         // respective information
+        std::string path;
         if (this->dataPtr->fuelClient->CachedModel(
-              ignition::common::URI(id.UniqueName()), path))
+              ignition::common::URI(resource.sdfPath), path))
         {
           resource.isDownloaded = true;
           resource.sdfPath = ignition::common::joinPaths(path, "model.sdf");
           std::string thumbnailPath = common::joinPaths(path, "thumbnails");
           this->SetThumbnail(thumbnailPath, resource);
         }
-        ownerSet.insert(id.Owner());
-        this->dataPtr->ownerModelMap[id.Owner()].push_back(resource);
+        ownerSet.insert(resource.owner);
+        ownerModelMap[resource.owner].push_back(resource);
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+        this->dataPtr->ownerModelMap = std::move(ownerModelMap);
       }
-    }
 
-    // Clear the loading message
-    this->dataPtr->ownerModel.clear();
+      QStringList owners;
+      for (const auto &owner : ownerSet)
+        owners.push_back(QString::fromStdString(owner));
+      QMetaObject::invokeMethod(&this->dataPtr->ownerModel, "SetPaths",
+          Qt::QueuedConnection, Q_ARG(QStringList, owners));
+      QMetaObject::invokeMethod(this, "OnFuelResourcesChanged",
+          Qt::QueuedConnection);
+    };
 
-    // Add all unique owners to the owner model
-    for (const auto &resource : ownerSet)
+    const bool hadIndex = !catalog.empty();
+    if (hadIndex)
+      publish(catalog);
+
+    std::vector<Resource> fetched;
+    for (auto const &server : servers)
     {
-      this->dataPtr->ownerModel.AddPath(resource);
+      for (auto iter = this->dataPtr->fuelClient->Models(server); iter; ++iter)
+      {
+        if (this->dataPtr->stop)
+          return;
+
+        auto id = iter->Identification();
+        Resource resource;
+        resource.name = id.Name();
+        resource.isFuel = true;
+        resource.isDownloaded = false;
+        resource.owner = id.Owner();
+        resource.sdfPath = id.UniqueName();
+        fetched.push_back(resource);
+      }
+
+      // Without an index, owners are listed as each server is loaded
+      if (!hadIndex)
+        publish(fetched);
     }
+
+    if (fetched.empty())
+    {
+      if (!hadIndex)
+      {
+        QMetaObject::invokeMethod(&this->dataPtr->ownerModel, "SetPaths",
+            Qt::QueuedConnection, Q_ARG(QStringList, QStringList()));
+      }
+      return;
+    }
+
+    if (hadIndex)
+      publish(fetched);
+    ResourceSpawnerPrivate::SaveFuelIndex(fetched);
     ignmsg << "Fuel resources loaded.\n";
   });
-  t.detach();
+}
+
+/////////////////////////////////////////////////
+void ResourceSpawner::OnLocalResourcesChanged(const QString &_path)
+{
+  if (!this->dataPtr->displayData.isFuel &&
+      this->dataPtr->displayData.ownerPath == _path.toStdString())
+  {
+    this->DisplayResources();
+  }
+}
+
+/////////////////////////////////////////////////
+void ResourceSpawner::OnFuelResourcesChanged()
+{
+  if (this->dataPtr->displayData.isFuel &&
+      !this->dataPtr->displayData.ownerPath.empty())
+  {
+    this->DisplayResources();
+  }
 }
 
 /////////////////////////////////////////////////
@@ -97,6 +97,11 @@ namespace gazebo
     /// param[in] _model The local model to be added
     public slots: void AddPath(const std::string &_path);
 
+    /// \brief Replace all paths, so lists gathered on other threads can
+    /// be queued to the Qt thread.
+    /// \param[in] _paths The new paths
+    public slots: void SetPaths(const QStringList &_paths);
+
     // Documentation inherited
     public: QHash<int, QByteArray> roleNames() const override;
   };
@@ -168,11 +173,17 @@ namespace gazebo
     public: void AddPath(const std::string &_path);
 
     /// \brief Returns the local resources as a vector located under
-    /// the passed in path.
+    /// the passed in path. Resources found by a previous scan are returned
+    /// right away, and the path is scanned again in the background.
     /// \param[in] _path The path to search
     /// \return The vector of resources
     public: std::vector<Resource> LocalResources(const std::string &_path);
 
+    /// \brief Scan a path for local resources, without using the cache.
+    /// \param[in] _path The path to search
+    /// \return The vector of resources
+    public: std::vector<Resource> ScanLocalResources(const std::string &_path);
+
     /// \brief Returns the fuel resources as a vector belonging to the
     /// passed in owner.
     /// \param[in] _owner The name of the owner
@@ -217,6 +228,15 @@ namespace gazebo
     public slots: void OnDownloadFuelResource(const QString &_path,
         const QString &_name, const QString &_owner, int index);
 
+    /// \brief Callback when a background scan found different resources
+    /// at a local path, which are displayed again if they're being viewed.
+    /// \param[in] _path The scanned path
+    public slots: void OnLocalResourcesChanged(const QString &_path);
+
+    /// \brief Callback when the Fuel catalog has been loaded or refreshed
+    /// in the background.
+    public slots: void OnFuelResourcesChanged();
+
     /// \brief Callback when a sort request is made.
     /// \param[in] _sortType The sorting type as a string, accepts
     /// "Most Recent", "A - Z", "Z - A", and "Downloaded." Defaults to
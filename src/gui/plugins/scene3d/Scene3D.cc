@@ -39,7 +39,6 @@
 #include <ignition/common/MeshManager.hh>
 #include <ignition/common/Profiler.hh>
 #include <ignition/common/Uuid.hh>
-#include <ignition/common/VideoEncoder.hh>
 
 #include <ignition/plugin/Register.hh>
 
@@ -68,6 +67,7 @@
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/gui/GuiEvents.hh"
+#include "ignition/gazebo/rendering/AsyncVideoEncoder.hh"
 #include "ignition/gazebo/rendering/RenderUtil.hh"
 
 /// \brief condition variable for lockstepping video recording
@@ -166,7 +166,8 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \brief Flag to indicate if mouse event is dirty
     public: bool mouseDirty = false;
 
-    /// \brief Flag to indicate if hover event is dirty
+    /// \brief Flag to indicate if hover event is dirty, cleared once the
+    /// mouse events of a frame are handled
     public: bool hoverDirty = false;
 
     /// \brief Mouse event
@@ -309,8 +310,9 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
     /// \brief Image from user camera
     public: rendering::Image cameraImage;
 
-    /// \brief Video encoder
-    public: common::VideoEncoder videoEncoder;
+    /// \brief Video encoder, which encodes on its own thread so rendering
+    /// isn't stalled
+    public: AsyncVideoEncoder videoEncoder;
 
     /// \brief Ray query for mouse clicks
     public: rendering::RayQueryPtr rayQuery;
@@ -459,6 +461,29 @@ IgnRenderer::IgnRenderer()
     this->dataPtr->node.Advertise<msgs::Time>(recorderStatsTopic);
   ignmsg << "Video recorder stats topic advertised on ["
          << recorderStatsTopic << "]" << std::endl;
+
+  // Publish recorder stats for each frame kept by the encoder, from the
+  // encoding thread
+  this->dataPtr->videoEncoder.SetFrameCallback(
+      [this](const std::chrono::steady_clock::time_point &_t)
+      {
+        if (this->dataPtr->recordStartTime ==
+            std::chrono::steady_clock::time_point(
+            std::chrono::duration(std::chrono::seconds(0))))
+        {
+          // start time, i.e. time when first frame is added
+          this->dataPtr->recordStartTime = _t;
+        }
+
+        std::chrono::steady_clock::duration dt;
+        dt = _t - this->dataPtr->recordStartTime;
+        int64_t sec, nsec;
+        std::tie(sec, nsec) = ignition::math::durationToSecNsec(dt);
+        msgs::Time msg;
+        msg.set_sec(sec);
+        msg.set_nsec(nsec);
+        this->dataPtr->recorderStatsPub.Publish(msg);
+      });
 }
 
 
@@ -507,6 +532,8 @@ void IgnRenderer::Render()
   this->dataPtr->renderUtil.SetTransformActive(
       this->dataPtr->transformControl.Active());
   this->dataPtr->renderUtil.Update();
+  this->dataPtr->renderUtil.SceneManager().UpdateCulling(
+      {this->dataPtr->camera->WorldPosition()});
 
   // view control
   this->HandleMouseEvent();
@@ -576,29 +603,8 @@ void IgnRenderer::Render()
           t = std::chrono::steady_clock::time_point(
               this->dataPtr->renderUtil.SimTime());
         }
-        bool frameAdded = this->dataPtr->videoEncoder.AddFrame(
+        this->dataPtr->videoEncoder.AddFrame(
             this->dataPtr->cameraImage.Data<unsigned char>(), width, height, t);
-
-        if (frameAdded)
-        {
-          // publish recorder stats
-          if (this->dataPtr->recordStartTime ==
-              std::chrono::steady_clock::time_point(
-              std::chrono::duration(std::chrono::seconds(0))))
-          {
-            // start time, i.e. time when first frame is added
-            this->dataPtr->recordStartTime = t;
-          }
-
-          std::chrono::steady_clock::duration dt;
-          dt = t - this->dataPtr->recordStartTime;
-          int64_t sec, nsec;
-          std::tie(sec, nsec) = ignition::math::durationToSecNsec(dt);
-          msgs::Time msg;
-          msg.set_sec(sec);
-          msg.set_nsec(nsec);
-          this->dataPtr->recorderStatsPub.Publish(msg);
-        }
       }
       // Video recorder is idle. Start recording.
       else
@@ -616,11 +622,16 @@ void IgnRenderer::Render()
         }
         ignmsg << "Recording video using bitrate: "
                << this->dataPtr->recordVideoBitrate <<  std::endl;
+
+        // Every frame is kept in lockstep mode, otherwise frames are dropped
+        // when the encoder can't keep up
+        this->dataPtr->videoEncoder.SetDropFrames(
+            !this->dataPtr->recordVideoLockstep);
+        this->dataPtr->recordStartTime = std::chrono::steady_clock::time_point(
+            std::chrono::duration(std::chrono::seconds(0)));
         this->dataPtr->videoEncoder.Start(this->dataPtr->recordVideoFormat,
             this->dataPtr->recordVideoSavePath, width, height, 25,
             this->dataPtr->recordVideoBitrate);
-        this->dataPtr->recordStartTime = std::chrono::steady_clock::time_point(
-            std::chrono::duration(std::chrono::seconds(0)));
       }
     }
     else if (this->dataPtr->videoEncoder.IsEncoding())
@@ -983,6 +994,9 @@ void IgnRenderer::HandleMouseEvent()
   this->HandleModelPlacement();
   this->HandleMouseTransformControl();
   this->HandleMouseViewControl();
+
+  // The hover position is only queried again once the mouse moves
+  this->dataPtr->hoverDirty = false;
 }
 
 /////////////////////////////////////////////////
@@ -1052,8 +1066,9 @@ void IgnRenderer::HandleMouseContextMenu()
     if (dt.Length() > 5.0)
       return;
 
-    rendering::VisualPtr visual = this->dataPtr->camera->Scene()->VisualAt(
-          this->dataPtr->camera,
+    // Pick through the camera's selection buffer, whose cost doesn't depend
+    // on the number of visuals in the scene
+    rendering::VisualPtr visual = this->dataPtr->camera->VisualAt(
           this->dataPtr->mouseEvent.Pos());
 
     if (!visual)
@@ -1488,11 +1503,8 @@ void IgnRenderer::HandleMouseTransformControl()
       // Select entity
       else if (!this->dataPtr->mouseEvent.Dragging())
       {
-        rendering::VisualPtr v = this->dataPtr->camera->VisualAt(
-              this->dataPtr->mouseEvent.Pos());
-
-        rendering::VisualPtr visual = this->dataPtr->camera->Scene()->VisualAt(
-              this->dataPtr->camera,
+        // Pick through the camera's selection buffer, like the gizmo axes
+        rendering::VisualPtr visual = this->dataPtr->camera->VisualAt(
               this->dataPtr->mouseEvent.Pos());
 
         if (!visual)
@@ -2551,6 +2563,15 @@ void Scene3D::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
       this->dataPtr->renderUtil->SetBackgroundColor(bgColor);
     }
 
+    if (auto elem = _pluginElem->FirstChildElement("culling_size"))
+    {
+      double cullingSize{0.0};
+      std::stringstream cullingSizeStr;
+      cullingSizeStr << std::string(elem->GetText());
+      cullingSizeStr >> cullingSize;
+      this->dataPtr->renderUtil->SceneManager().SetCullingSize(cullingSize);
+    }
+
     if (auto elem = _pluginElem->FirstChildElement("sky"))
     {
       this->dataPtr->renderUtil->SetSkyEnabled(true);
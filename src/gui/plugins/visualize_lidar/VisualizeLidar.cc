@@ -17,6 +17,7 @@
 
 #include "VisualizeLidar.hh"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -123,6 +124,29 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE
 
     /// \brief lidar sensor entity dirty flag
     public: bool lidarEntityDirty{true};
+
+    /// \brief Set when a scan arrived that hasn't been uploaded to the
+    /// lidar visual yet. Scans arriving faster than the render rate
+    /// overwrite each other, so only the latest one is uploaded per frame.
+    public: bool scanDirty{false};
+
+    /// \brief Set when the range limits of the visual must be updated.
+    public: bool rangeDirty{false};
+
+    /// \brief Only every N-th horizontal ray is displayed.
+    public: unsigned int horizontalStride{1u};
+
+    /// \brief Only every N-th vertical ray is displayed.
+    public: unsigned int verticalStride{1u};
+
+    /// \brief Subsampled ranges, reused across scans to avoid allocating
+    /// a new buffer for each message.
+    public: std::vector<double> points;
+
+    /// \brief Upload the latest scan to the lidar visual, subsampled
+    /// according to the configured strides. Must be called from the
+    /// rendering thread with serviceMutex locked.
+    public: void UploadScan();
   };
 }
 }
@@ -131,6 +155,56 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE
 using namespace ignition;
 using namespace gazebo;
 
+/////////////////////////////////////////////////
+void VisualizeLidarPrivate::UploadScan()
+{
+  IGN_PROFILE("VisualizeLidarPrivate::UploadScan");
+
+  const unsigned int hCount = this->msg.count();
+  const unsigned int vCount = std::max(1u, this->msg.vertical_count());
+  const unsigned int hStride = std::max(1u, this->horizontalStride);
+  const unsigned int vStride = std::max(1u, this->verticalStride);
+
+  if (static_cast<uint64_t>(hCount) * vCount >
+      static_cast<uint64_t>(this->msg.ranges_size()))
+  {
+    ignerr << "LaserScan has [" << this->msg.ranges_size()
+           << "] ranges, but [" << hCount << " x " << vCount
+           << "] were expected. Ignoring it." << std::endl;
+    return;
+  }
+
+  // Number of rays kept in each direction
+  const unsigned int hKept = hCount == 0u ? 0u : (hCount - 1u) / hStride + 1u;
+  const unsigned int vKept = (vCount - 1u) / vStride + 1u;
+
+  this->points.clear();
+  this->points.reserve(static_cast<size_t>(hKept) * vKept);
+  for (unsigned int j = 0u; j < vCount; j += vStride)
+  {
+    for (unsigned int i = 0u; i < hCount; i += hStride)
+      this->points.push_back(this->msg.ranges(j * hCount + i));
+  }
+
+  // Keep the angle of the last displayed ray, so the remaining rays are
+  // still drawn in their original directions.
+  double hStep = hCount > 1u ?
+      (this->msg.angle_max() - this->msg.angle_min()) / (hCount - 1u) : 0.0;
+  double vStep = vCount > 1u ?
+      (this->msg.vertical_angle_max() - this->msg.vertical_angle_min()) /
+      (vCount - 1u) : 0.0;
+
+  this->lidar->SetHorizontalRayCount(hKept);
+  this->lidar->SetVerticalRayCount(vKept);
+  this->lidar->SetMinHorizontalAngle(this->msg.angle_min());
+  this->lidar->SetMaxHorizontalAngle(this->msg.angle_min() +
+      hStep * (hKept > 0u ? (hKept - 1u) * hStride : 0u));
+  this->lidar->SetMinVerticalAngle(this->msg.vertical_angle_min());
+  this->lidar->SetMaxVerticalAngle(this->msg.vertical_angle_min() +
+      vStep * (vKept - 1u) * vStride);
+  this->lidar->SetPoints(this->points);
+}
+
 /////////////////////////////////////////////////
 VisualizeLidar::VisualizeLidar()
   : GuiSystem(), dataPtr(new VisualizeLidarPrivate)
@@ -209,11 +283,27 @@ void VisualizeLidar::LoadLidar()
 }
 
 /////////////////////////////////////////////////
-void VisualizeLidar::LoadConfig(const tinyxml2::XMLElement *)
+void VisualizeLidar::LoadConfig(const tinyxml2::XMLElement *_pluginElem)
 {
   if (this->title.empty())
     this->title = "Visualize lidar";
 
+  if (_pluginElem)
+  {
+    if (auto elem = _pluginElem->FirstChildElement("horizontal_stride"))
+    {
+      elem->QueryUnsignedText(&this->dataPtr->horizontalStride);
+      this->dataPtr->horizontalStride =
+          std::max(1u, this->dataPtr->horizontalStride);
+    }
+    if (auto elem = _pluginElem->FirstChildElement("vertical_stride"))
+    {
+      elem->QueryUnsignedText(&this->dataPtr->verticalStride);
+      this->dataPtr->verticalStride =
+          std::max(1u, this->dataPtr->verticalStride);
+    }
+  }
+
   ignition::gui::App()->findChild<
     ignition::gui::MainWindow *>()->installEventFilter(this);
 }
@@ -238,6 +328,18 @@ bool VisualizeLidar::eventFilter(QObject *_obj, QEvent *_event)
       {
         this->dataPtr->lidar->ClearPoints();
         this->dataPtr->resetVisual = false;
+        this->dataPtr->scanDirty = false;
+      }
+      if (this->dataPtr->rangeDirty)
+      {
+        this->dataPtr->lidar->SetMaxRange(this->dataPtr->maxVisualRange);
+        this->dataPtr->lidar->SetMinRange(this->dataPtr->minVisualRange);
+        this->dataPtr->rangeDirty = false;
+      }
+      if (this->dataPtr->scanDirty)
+      {
+        this->dataPtr->UploadScan();
+        this->dataPtr->scanDirty = false;
       }
       if (this->dataPtr->visualDirty)
       {
@@ -367,7 +469,7 @@ void VisualizeLidar::UpdateType(int _type)
 //////////////////////////////////////////////////
 void VisualizeLidar::OnTopic(const QString &_topicName)
 {
-  std::lock_guard<std::mutex>(this->dataPtr->serviceMutex);
+  std::lock_guard<std::mutex> lock(this->dataPtr->serviceMutex);
   if (!this->dataPtr->topicName.empty() &&
       !this->dataPtr->node.Unsubscribe(this->dataPtr->topicName))
   {
@@ -394,14 +496,14 @@ void VisualizeLidar::OnTopic(const QString &_topicName)
 //////////////////////////////////////////////////
 void VisualizeLidar::UpdateNonHitting(bool _value)
 {
-  std::lock_guard<std::mutex>(this->dataPtr->serviceMutex);
+  std::lock_guard<std::mutex> lock(this->dataPtr->serviceMutex);
   this->dataPtr->lidar->SetDisplayNonHitting(_value);
 }
 
 //////////////////////////////////////////////////
 void VisualizeLidar::DisplayVisual(bool _value)
 {
-  std::lock_guard<std::mutex>(this->dataPtr->serviceMutex);
+  std::lock_guard<std::mutex> lock(this->dataPtr->serviceMutex);
   this->dataPtr->lidar->SetVisible(_value);
   ignmsg << "Lidar Visual Display " << ((_value) ? "ON." : "OFF.")
          << std::endl;
@@ -410,7 +512,6 @@ void VisualizeLidar::DisplayVisual(bool _value)
 /////////////////////////////////////////////////
 void VisualizeLidar::OnRefresh()
 {
-  std::lock_guard<std::mutex>(this->dataPtr->serviceMutex);
   ignmsg << "Refreshing topic list for LaserScan messages." << std::endl;
 
   // Clear
@@ -456,27 +557,13 @@ void VisualizeLidar::SetTopicList(const QStringList &_topicList)
 //////////////////////////////////////////////////
 void VisualizeLidar::OnScan(const msgs::LaserScan &_msg)
 {
-  std::lock_guard<std::mutex>(this->dataPtr->serviceMutex);
+  std::lock_guard<std::mutex> lock(this->dataPtr->serviceMutex);
   if (this->dataPtr->initialized)
   {
-    this->dataPtr->msg = std::move(_msg);
-    this->dataPtr->lidar->SetVerticalRayCount(
-                                  this->dataPtr->msg.vertical_count());
-    this->dataPtr->lidar->SetHorizontalRayCount(
-                                  this->dataPtr->msg.count());
-    this->dataPtr->lidar->SetMinHorizontalAngle(
-                                  this->dataPtr->msg.angle_min());
-    this->dataPtr->lidar->SetMaxHorizontalAngle(
-                                  this->dataPtr->msg.angle_max());
-    this->dataPtr->lidar->SetMinVerticalAngle(
-                                  this->dataPtr->msg.vertical_angle_min());
-    this->dataPtr->lidar->SetMaxVerticalAngle(
-                                  this->dataPtr->msg.vertical_angle_max());
-
-    this->dataPtr->lidar->SetPoints(std::vector<double>(
-                                  this->dataPtr->msg.ranges().begin(),
-                                  this->dataPtr->msg.ranges().end()));
-
+    // The scan is uploaded to the visual from the rendering thread, so
+    // only keep the latest one here.
+    this->dataPtr->msg = _msg;
+    this->dataPtr->scanDirty = true;
     this->dataPtr->visualDirty = true;
 
     for (auto data_values : this->dataPtr->msg.header().data())
@@ -490,8 +577,7 @@ void VisualizeLidar::OnScan(const msgs::LaserScan &_msg)
           this->dataPtr->lidarEntityDirty = true;
           this->dataPtr->maxVisualRange = this->dataPtr->msg.range_max();
           this->dataPtr->minVisualRange = this->dataPtr->msg.range_min();
-          this->dataPtr->lidar->SetMaxRange(this->dataPtr->maxVisualRange);
-          this->dataPtr->lidar->SetMinRange(this->dataPtr->minVisualRange);
+          this->dataPtr->rangeDirty = true;
           this->MinRangeChanged();
           this->MaxRangeChanged();
           break;
@@ -37,6 +37,16 @@ inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE
   /// checkbox to turn visualization of non-hitting rays on or off and
   /// the textfield to select the message to be visualised. The combobox is
   /// used to select the type of visual for the sensor data.
+  ///
+  /// Scans are uploaded to the visual once per rendered frame, and only the
+  /// latest one is kept when they arrive faster than that.
+  ///
+  /// ## Configuration
+  ///
+  /// * `<horizontal_stride>`: Only display every N-th horizontal ray.
+  /// Defaults to 1, which displays all rays.
+  /// * `<vertical_stride>`: Only display every N-th vertical ray.
+  /// Defaults to 1, which displays all rays.
   class VisualizeLidar : public ignition::gazebo::GuiSystem
   {
     Q_OBJECT
@@ -17,6 +17,7 @@
 
 #include "ign.hh"
 
+#include <chrono>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -34,6 +35,8 @@
 
 #include "ignition/gazebo/gui/Gui.hh"
 
+#include "systems/log/LogExport.hh"
+
 //////////////////////////////////////////////////
 extern "C" char *ignitionGazeboVersion()
 {
@@ -121,7 +124,8 @@ extern "C" int runServer(const char *_sdfString,
     int _recordResources, int _logOverwrite, int _logCompress,
     const char *_playback, const char *_physicsEngine,
     const char *_renderEngineServer, const char *_renderEngineGui,
-    const char *_file, const char *_recordTopics)
+    const char *_file, const char *_recordTopics, float _maxThroughput,
+    const char *_simCpus, const char *_workerCpus, const char *_renderCpus)
 {
   ignition::gazebo::ServerConfig serverConfig;
 
@@ -298,6 +302,24 @@ extern "C" int runServer(const char *_sdfString,
   if (_hz > 0.0)
     serverConfig.SetUpdateRate(_hz);
 
+  // Run as fast as possible, reporting steps per second periodically
+  if (_maxThroughput > 0.0)
+  {
+    ignmsg << "Using max throughput mode\n";
+    serverConfig.SetMaxThroughput(true);
+    serverConfig.SetThroughputStatsPeriod(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(_maxThroughput)));
+  }
+
+  // Pin threads to CPUs
+  if (_simCpus != nullptr && !serverConfig.SetSimulationCpus(_simCpus))
+    return -1;
+  if (_workerCpus != nullptr && !serverConfig.SetWorkerCpus(_workerCpus))
+    return -1;
+  if (_renderCpus != nullptr && !serverConfig.SetRenderCpus(_renderCpus))
+    return -1;
+
   // Set whether levels should be used.
   if (_levels > 0)
   {
@@ -370,3 +392,35 @@ extern "C" int runGui(const char *_guiConfig)
   char *argv = const_cast<char *>("ign-gazebo-gui");
   return ignition::gazebo::gui::runGui(argc, &argv, _guiConfig);
 }
+
+//////////////////////////////////////////////////
+extern "C" int exportLogs(const char *_logPaths, const char *_outputDir,
+    const char *_series, int _jobs)
+{
+  if (_logPaths == nullptr || std::strlen(_logPaths) == 0)
+  {
+    ignerr << "No logs to export." << std::endl;
+    return 1;
+  }
+
+  ignition::gazebo::systems::LogExportOptions options;
+  if (_outputDir != nullptr && std::strlen(_outputDir) > 0)
+    options.outputDir = _outputDir;
+  else
+    options.outputDir = ignition::common::cwd();
+
+  if (_series != nullptr && std::strlen(_series) > 0)
+  {
+    options.series.clear();
+    for (const auto &series : ignition::common::split(_series, ","))
+      options.series.insert(series);
+  }
+  options.jobs = _jobs > 0 ? static_cast<std::size_t>(_jobs) : 0u;
+
+  std::vector<std::string> logPaths;
+  for (const auto &logPath : ignition::common::split(_logPaths, ":"))
+    logPaths.push_back(ignition::common::absPath(logPath));
+
+  auto exported = ignition::gazebo::systems::exportLogs(logPaths, options);
+  return exported == logPaths.size() ? 0 : 1;
+}
@@ -54,6 +54,11 @@ extern "C" const char *worldInstallDir();
 /// \param[in] _file Path to file being loaded
 /// \param[in] _recordTopics Colon separated list of topics to record. Leave
 /// null to record the default topics.
+/// \param[in] _maxThroughput --max-throughput option. Seconds between
+/// statistics in max throughput mode, which is disabled if not positive.
+/// \param[in] _simCpus --sim-cpus option
+/// \param[in] _workerCpus --worker-cpus option
+/// \param[in] _renderCpus --render-cpus option
 /// \return 0 if successful, 1 if not.
 extern "C" int runServer(const char *_sdfString,
     int _iterations, int _run, float _hz, int _levels,
@@ -62,7 +67,8 @@ extern "C" int runServer(const char *_sdfString,
     int _logCompress, const char *_playback,
     const char *_physicsEngine, const char *_renderEngineServer,
     const char *_renderEngineGui, const char *_file,
-    const char *_recordTopics);
+    const char *_recordTopics, float _maxThroughput, const char *_simCpus,
+    const char *_workerCpus, const char *_renderCpus);
 
 /// \brief External hook to run simulation GUI.
 /// \param[in] _guiConfig Path to Ignition GUI configuration file.
@@ -76,4 +82,17 @@ extern "C" int runGui(const char *_guiConfig);
 extern "C" const char *findFuelResource(
     char *_pathToResource);
 
+/// \brief External hook to export recorded logs to NumPy column files,
+/// without running a simulation, see systems::exportLogs.
+/// \param[in] _logPaths Colon separated list of log directories.
+/// \param[in] _outputDir --export-logs option. Directory to export to,
+/// defaults to the working directory.
+/// \param[in] _series --export-series option. Comma separated list of
+/// series, leave empty to export all.
+/// \param[in] _jobs --jobs option. Number of logs exported at the same time,
+/// 0 for one per hardware thread.
+/// \return 0 if all logs were exported, 1 if not.
+extern "C" int exportLogs(const char *_logPaths, const char *_outputDir,
+    const char *_series, int _jobs);
+
 #endif
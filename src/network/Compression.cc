@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "Compression.hh"
+
+#ifdef IGNITION_GAZEBO_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Largest size accepted when decompressing, so a corrupt size
+/// doesn't exhaust memory.
+static constexpr std::size_t kMaxDecompressedSize{std::size_t{1} << 30};
+
+//////////////////////////////////////////////////
+bool ignition::gazebo::CompressionAvailable()
+{
+#ifdef IGNITION_GAZEBO_HAVE_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool ignition::gazebo::Compress(const std::string &_data,
+    std::string &_compressed)
+{
+#ifdef IGNITION_GAZEBO_HAVE_ZLIB
+  if (_data.empty())
+  {
+    _compressed.clear();
+    return true;
+  }
+
+  uLongf size = compressBound(static_cast<uLong>(_data.size()));
+  _compressed.resize(size);
+  if (compress2(reinterpret_cast<Bytef *>(&_compressed[0]), &size,
+      reinterpret_cast<const Bytef *>(_data.data()),
+      static_cast<uLong>(_data.size()), Z_BEST_SPEED) != Z_OK)
+  {
+    return false;
+  }
+  _compressed.resize(size);
+  return true;
+#else
+  (void)_data;
+  (void)_compressed;
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////
+bool ignition::gazebo::Decompress(const std::string &_compressed,
+    std::size_t _size, std::string &_data)
+{
+#ifdef IGNITION_GAZEBO_HAVE_ZLIB
+  if (_size > kMaxDecompressedSize)
+    return false;
+
+  _data.resize(_size);
+  if (_size == 0)
+    return _compressed.empty();
+
+  uLongf size = static_cast<uLongf>(_size);
+  if (uncompress(reinterpret_cast<Bytef *>(&_data[0]), &size,
+      reinterpret_cast<const Bytef *>(_compressed.data()),
+      static_cast<uLong>(_compressed.size())) != Z_OK)
+  {
+    return false;
+  }
+  return size == _size;
+#else
+  (void)_compressed;
+  (void)_size;
+  (void)_data;
+  return false;
+#endif
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GAZEBO_NETWORK_COMPRESSION_HH_
+#define IGNITION_GAZEBO_NETWORK_COMPRESSION_HH_
+
+#include <cstddef>
+#include <string>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Export.hh>
+
+namespace ignition
+{
+  namespace gazebo
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+    /// \brief Check whether data can be compressed, which needs zlib when
+    /// building.
+    /// \return True if Compress and Decompress work.
+    IGNITION_GAZEBO_VISIBLE bool CompressionAvailable();
+
+    /// \brief Compress data with zlib, favoring speed over size.
+    /// \param[in] _data Data to compress.
+    /// \param[out] _compressed Compressed data. Its memory is reused.
+    /// \return True if the data was compressed.
+    IGNITION_GAZEBO_VISIBLE bool Compress(const std::string &_data,
+        std::string &_compressed);
+
+    /// \brief Decompress data compressed by Compress.
+    /// \param[in] _compressed Compressed data.
+    /// \param[in] _size Size of the data before compression.
+    /// \param[out] _data Decompressed data. Its memory is reused.
+    /// \return True if the data was decompressed and has the given size.
+    IGNITION_GAZEBO_VISIBLE bool Decompress(const std::string &_compressed,
+        std::size_t _size, std::string &_data);
+    }
+  }  // namespace gazebo
+}  // namespace ignition
+
+#endif  // IGNITION_GAZEBO_NETWORK_COMPRESSION_HH_
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "Compression.hh"
+
+using namespace ignition::gazebo;
+
+//////////////////////////////////////////////////
+TEST(Compression, RoundTrip)
+{
+  std::string data;
+  for (int i = 0; i < 1000; ++i)
+    data += "pose " + std::to_string(i % 10) + ";";
+
+  std::string compressed;
+  std::string decompressed;
+  if (!CompressionAvailable())
+  {
+    EXPECT_FALSE(Compress(data, compressed));
+    EXPECT_FALSE(Decompress(data, data.size(), decompressed));
+    return;
+  }
+
+  ASSERT_TRUE(Compress(data, compressed));
+  EXPECT_LT(compressed.size(), data.size());
+  ASSERT_TRUE(Decompress(compressed, data.size(), decompressed));
+  EXPECT_EQ(data, decompressed);
+
+  // Wrong sizes and corrupt data are rejected
+  EXPECT_FALSE(Decompress(compressed, data.size() - 1, decompressed));
+  EXPECT_FALSE(Decompress(compressed, data.size() + 1, decompressed));
+  EXPECT_FALSE(Decompress("garbage", data.size(), decompressed));
+
+  // Empty data
+  ASSERT_TRUE(Compress("", compressed));
+  ASSERT_TRUE(Decompress(compressed, 0, decompressed));
+  EXPECT_TRUE(decompressed.empty());
+}
@@ -18,10 +18,13 @@
 #include "NetworkManagerPrimary.hh"
 
 #include <algorithm>
-#include <future>
+#include <chrono>
 #include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
@@ -30,6 +33,7 @@
 #include "msgs/peer_control.pb.h"
 #include "msgs/simulation_step.pb.h"
 
+#include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/PerformerAffinity.hh"
 #include "ignition/gazebo/components/PerformerLevels.hh"
 #include "ignition/gazebo/Conversions.hh"
@@ -37,6 +41,7 @@
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/Events.hh"
 
+#include "Compression.hh"
 #include "NetworkManagerPrivate.hh"
 #include "PeerTracker.hh"
 
@@ -55,6 +60,46 @@ NetworkManagerPrimary::NetworkManagerPrimary(
   this->simStepPub = this->node.Advertise<private_msgs::SimulationStep>("step");
 
   this->node.Subscribe("step_ack", &NetworkManagerPrimary::OnStepAck, this);
+
+  // The calling thread deserializes one of the states
+  const auto secondaryCount = this->dataPtr->config.numSecondariesExpected;
+  if (secondaryCount > 1)
+  {
+    const unsigned int hardwareThreads =
+        std::max(std::thread::hardware_concurrency(), 2u);
+    this->mergePool = std::make_unique<TaskPool>(std::min<unsigned int>(
+        static_cast<unsigned int>(secondaryCount) - 1, hardwareThreads - 1));
+  }
+
+  std::string period;
+  if (common::env("IGN_GAZEBO_NETWORK_REBALANCE_PERIOD", period))
+  {
+    try
+    {
+      this->rebalancePeriod = std::stoul(period);
+    }
+    catch (...)
+    {
+      ignerr << "Invalid IGN_GAZEBO_NETWORK_REBALANCE_PERIOD [" << period
+             << "], expected a number of steps. Performers won't be "
+             << "rebalanced." << std::endl;
+    }
+  }
+
+  std::string stepsAhead;
+  if (common::env("IGN_GAZEBO_NETWORK_MAX_STEPS_AHEAD", stepsAhead))
+  {
+    try
+    {
+      this->maxStepsAhead = std::stoul(stepsAhead);
+    }
+    catch (...)
+    {
+      ignerr << "Invalid IGN_GAZEBO_NETWORK_MAX_STEPS_AHEAD [" << stepsAhead
+             << "], expected a number of steps. Running in lockstep."
+             << std::endl;
+    }
+  }
 }
 
 //////////////////////////////////////////////////
@@ -142,45 +187,170 @@ bool NetworkManagerPrimary::Step(const UpdateInfo &_info)
     return false;
   }
 
+  // Affinity changes move performers between secondaries, so all states
+  // from the previous steps must be merged before and the step runs in
+  // lockstep.
+  const std::size_t maxInFlight =
+      step.affinity_size() > 0 ? 0 : this->maxStepsAhead;
+  if (step.affinity_size() > 0 && !this->WaitForSteps(0))
+    return false;
+
   // Send step to all secondaries
-  this->secondaryStates.clear();
-  this->secondaryStatesPromise = std::promise<void>{};
-  auto future = this->secondaryStatesPromise.get_future();
+  {
+    std::lock_guard<std::mutex> lock(this->secondaryStatesMutex);
+    step.set_sequence(++this->stepSequence);
+    step.set_full_state(this->resyncRequested);
+    this->resyncRequested = false;
+    this->inFlightSteps.push_back(
+        {this->stepSequence, std::chrono::steady_clock::now(), 0});
+    ++this->stepStats.steps;
+    this->stepStats.bytesSent += step.ByteSizeLong();
+  }
   this->simStepPub.Publish(step);
 
-  // Block until all secondaries are done
+  // Block until secondaries are at most maxInFlight steps ahead, merging the
+  // states which arrived so far
+  if (!this->WaitForSteps(maxInFlight))
+    return false;
+
+  // Throttle the number of stats going to the debug output.
+  if (!_info.paused && _info.iterations % 1000 == 0)
   {
-    IGN_PROFILE("Waiting for secondaries");
+    auto stats = this->StepStats();
+    igndbg << "Network steps [" << stats.steps << "], sent ["
+           << stats.bytesSent << "] bytes, received ["
+           << stats.bytesReceived << "] bytes (" << stats.stateBytesReceived
+           << " uncompressed, " << stats.fullStatesReceived
+           << " full states, " << stats.resyncs << " resyncs), average "
+           << "latency ["
+           << std::chrono::duration_cast<std::chrono::microseconds>(
+              stats.totalLatency / std::max<uint64_t>(stats.steps, 1)).count()
+           << " us], max latency ["
+           << std::chrono::duration_cast<std::chrono::microseconds>(
+              stats.maxLatency).count() << " us]" << std::endl;
+  }
 
-    auto result = future.wait_for(10s);
+  // Step all systems
+  this->dataPtr->stepFunction(_info);
+
+  this->dataPtr->ecm->SetAllComponentsUnchanged();
 
-    if (std::future_status::ready != result)
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool NetworkManagerPrimary::WaitForSteps(std::size_t _maxInFlight)
+{
+  IGN_PROFILE("NetworkManagerPrimary::WaitForSteps");
+
+  std::vector<SecondaryState> states;
+  bool timedOut{false};
+  {
+    IGN_PROFILE("Waiting for secondaries");
+    std::unique_lock<std::mutex> lock(this->secondaryStatesMutex);
+    while (this->inFlightSteps.size() > _maxInFlight)
     {
-      ignerr << "Waited 10 s and got only [" << this->secondaryStates.size()
-             << " / " << this->secondaries.size()
-             << "] responses from secondaries. Stopping simulation."
-             << std::endl;
-      this->dataPtr->eventMgr->Emit<events::Stop>();
-      return false;
+      auto &oldest = this->inFlightSteps.front();
+      if (oldest.acks >= this->secondaries.size())
+      {
+        this->inFlightSteps.pop_front();
+        continue;
+      }
+
+      if (!this->acksCv.wait_until(lock, oldest.sentTime + 10s,
+          [&]
+          {
+            return this->inFlightSteps.front().acks >=
+                this->secondaries.size();
+          }))
+      {
+        ignerr << "Waited 10 s and got only [" << oldest.acks
+               << " / " << this->secondaries.size()
+               << "] responses from secondaries. Stopping simulation."
+               << std::endl;
+        timedOut = true;
+        break;
+      }
     }
+    states.swap(this->secondaryStates);
   }
 
-  // Update primary state with states received from secondaries
+  if (timedOut)
   {
-    IGN_PROFILE("Updating primary state");
-    for (const auto &msg : this->secondaryStates)
+    this->dataPtr->eventMgr->Emit<events::Stop>();
+    return false;
+  }
+
+  this->MergeStates(states);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::MergeStates(std::vector<SecondaryState> &_states)
+{
+  IGN_PROFILE("NetworkManagerPrimary::MergeStates");
+  if (_states.empty())
+    return;
+
+  // Secondaries own different performers, so their states don't overlap and
+  // the order they're applied in doesn't matter, other than for the acks of
+  // a single secondary, which arrive in order. Check that, since an
+  // overlap means the secondaries disagree on affinities.
+  uint64_t overlapping{0};
+  {
+    IGN_PROFILE("Checking disjoint states");
+    std::unordered_map<uint64_t, const std::string *> owners;
+    for (const auto &state : _states)
     {
-      this->dataPtr->ecm->SetState(msg);
+      for (const auto &entity : state.state.entities())
+      {
+        auto owner = owners.emplace(entity.first, &state.prefix).first;
+        if (*owner->second == state.prefix)
+          continue;
+
+        if (overlapping == 0)
+        {
+          ignerr << "Entity [" << entity.first << "] is in the states of "
+                 << "secondaries [" << *owner->second << "] and ["
+                 << state.prefix << "], applying them in the order they "
+                 << "arrived." << std::endl;
+        }
+        owner->second = &state.prefix;
+        ++overlapping;
+      }
     }
-    this->secondaryStates.clear();
+  }
+  if (overlapping > 0)
+  {
+    std::lock_guard<std::mutex> lock(this->secondaryStatesMutex);
+    this->stepStats.overlappingEntities += overlapping;
   }
 
-  // Step all systems
-  this->dataPtr->stepFunction(_info);
-
-  this->dataPtr->ecm->SetAllComponentsUnchanged();
+  // Deserializing doesn't touch the ECM, so states are deserialized in
+  // parallel, and the ECM only moves the components in
+  std::vector<DeserializedState> decoded(_states.size());
+  auto deserialize = [&](std::size_t _i)
+  {
+    decoded[_i] = EntityComponentManager::DeserializeState(_states[_i].state);
+  };
+  {
+    IGN_PROFILE("Deserializing states");
+    if (nullptr != this->mergePool && _states.size() > 1)
+    {
+      this->mergePool->ParallelFor(_states.size(), deserialize);
+    }
+    else
+    {
+      for (std::size_t i = 0; i < _states.size(); ++i)
+        deserialize(i);
+    }
+  }
 
-  return true;
+  {
+    IGN_PROFILE("Updating primary state");
+    for (auto &state : decoded)
+      this->dataPtr->ecm->SetState(std::move(state));
+  }
 }
 
 //////////////////////////////////////////////////
@@ -197,12 +367,92 @@ std::map<std::string, SecondaryControl::Ptr>
 }
 
 //////////////////////////////////////////////////
-void NetworkManagerPrimary::OnStepAck(const msgs::SerializedStateMap &_msg)
+NetworkStepStats NetworkManagerPrimary::StepStats() const
 {
-  this->secondaryStates.push_back(_msg);
-  if (this->secondaryStates.size() == this->secondaries.size())
+  std::lock_guard<std::mutex> lock(this->secondaryStatesMutex);
+  return this->stepStats;
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::OnStepAck(const private_msgs::StepAck &_msg)
+{
+  IGN_PROFILE("NetworkManagerPrimary::OnStepAck");
+  const auto now = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lock(this->secondaryStatesMutex);
+  auto step = std::find_if(this->inFlightSteps.begin(),
+      this->inFlightSteps.end(), [&](const InFlightStep &_step)
+      {
+        return _step.sequence == _msg.sequence();
+      });
+  if (step == this->inFlightSteps.end())
   {
-    this->secondaryStatesPromise.set_value();
+    // The changes it holds are lost, so secondaries start over from their
+    // full state
+    ignwarn << "Ignoring late step acknowledgement from secondary ["
+            << _msg.secondary_prefix() << "], requesting full states."
+            << std::endl;
+    this->resyncRequested = true;
+    ++this->stepStats.resyncs;
+    return;
+  }
+
+  // Parse the state
+  msgs::SerializedStateMap state;
+  bool parsed{false};
+  if (_msg.compression() == private_msgs::StepAck::ZLIB)
+  {
+    parsed = Decompress(_msg.state(), _msg.raw_size(),
+        this->decompressBuffer) &&
+        state.ParseFromString(this->decompressBuffer);
+  }
+  else
+  {
+    parsed = state.ParseFromString(_msg.state());
+  }
+
+  if (parsed)
+  {
+    this->secondaryStates.push_back({_msg.secondary_prefix(),
+        std::move(state)});
+  }
+  else
+  {
+    ignerr << "Failed to read state from secondary ["
+           << _msg.secondary_prefix() << "], requesting full states."
+           << std::endl;
+    this->resyncRequested = true;
+    ++this->stepStats.resyncs;
+  }
+  if (_msg.full_state())
+    ++this->stepStats.fullStatesReceived;
+
+  // Counters
+  this->stepStats.bytesReceived += _msg.ByteSizeLong();
+  this->stepStats.stateBytesReceived += _msg.raw_size();
+  auto secondary = this->secondaries.find(_msg.secondary_prefix());
+  if (secondary != this->secondaries.end())
+  {
+    secondary->second->latency = now - step->sentTime;
+    secondary->second->stepTime =
+        std::chrono::microseconds(_msg.step_time_us());
+
+    // Smooth step times, so the rebalancer doesn't react to single slow
+    // steps
+    constexpr double kSmoothing{0.05};
+    const double stepTimeSec = _msg.step_time_us() * 1e-6;
+    auto &average = secondary->second->averageStepTime;
+    average = secondary->second->stepTimeSamples++ == 0 ? stepTimeSec :
+        average + kSmoothing * (stepTimeSec - average);
+  }
+
+  if (++step->acks == this->secondaries.size())
+  {
+    const auto latency = now - step->sentTime;
+    this->stepStats.lastLatency = latency;
+    this->stepStats.maxLatency = std::max(this->stepStats.maxLatency, latency);
+    this->stepStats.totalLatency += latency;
+    this->acksCv.notify_all();
   }
 }
 
@@ -300,7 +550,115 @@ void NetworkManagerPrimary::PopulateAffinities(
     return;
   }
 
-  // TODO(louise) Process level changes
+  if (this->rebalancePeriod > 0 &&
+      this->stepSequence % this->rebalancePeriod == 0)
+  {
+    this->Rebalance(_msg);
+  }
+}
+
+//////////////////////////////////////////////////
+void NetworkManagerPrimary::Rebalance(private_msgs::SimulationStep &_msg)
+{
+  IGN_PROFILE("NetworkManagerPrimary::Rebalance");
+
+  if (this->secondaries.size() < 2)
+    return;
+
+  // Performers of each secondary, and the levels they're in
+  std::map<std::string, std::vector<Entity>> sToP;
+  std::map<std::string, std::set<Entity>> sToL;
+  this->dataPtr->ecm->Each<components::PerformerAffinity,
+      components::PerformerLevels>(
+    [&](const Entity &_entity,
+        const components::PerformerAffinity *_affinity,
+        const components::PerformerLevels *_perfLevels) -> bool
+    {
+      sToP[_affinity->Data()].push_back(_entity);
+      sToL[_affinity->Data()].insert(_perfLevels->Data().begin(),
+          _perfLevels->Data().end());
+      return true;
+    });
+
+  // Find the slowest and fastest secondaries
+  SecondaryControl *slowest{nullptr};
+  SecondaryControl *fastest{nullptr};
+  {
+    std::lock_guard<std::mutex> lock(this->secondaryStatesMutex);
+    for (auto &secondary : this->secondaries)
+    {
+      auto *control = secondary.second.get();
+      if (control->stepTimeSamples == 0)
+        return;
+      if (!slowest || control->averageStepTime > slowest->averageStepTime)
+        slowest = control;
+      if (!fastest || control->averageStepTime < fastest->averageStepTime)
+        fastest = control;
+    }
+  }
+
+  const auto &candidates = sToP[slowest->prefix];
+  const double slowTime = slowest->averageStepTime;
+  const double fastTime = fastest->averageStepTime;
+  if (slowest == fastest || candidates.size() < 2 ||
+      slowTime <= fastTime * (1.0 + this->rebalanceThreshold))
+  {
+    return;
+  }
+
+  // Only move a performer if it's expected to even out the load, assuming
+  // the slowest secondary's time is spread over its performers
+  const double performerTime = slowTime / candidates.size();
+  if (fastTime + performerTime >= slowTime)
+    return;
+
+  // Prefer performers in levels the fastest secondary already has, so
+  // levels aren't loaded on more secondaries than needed
+  const auto &fastLevels = sToL[fastest->prefix];
+  Entity performer{kNullEntity};
+  int bestShared{-1};
+  std::size_t bestLevels{0};
+  for (const auto &candidate : candidates)
+  {
+    const auto &levels = this->dataPtr->ecm->Component<
+        components::PerformerLevels>(candidate)->Data();
+    int shared{0};
+    for (const auto &level : levels)
+      shared += fastLevels.count(level) > 0 ? 1 : 0;
+
+    if (shared > bestShared || (shared == bestShared &&
+        levels.size() < bestLevels))
+    {
+      performer = candidate;
+      bestShared = shared;
+      bestLevels = levels.size();
+    }
+  }
+
+  // The performer's entities were removed from the fastest secondary, send
+  // their full state, including the levels of the performer, so they can be
+  // recreated there
+  auto parent =
+      this->dataPtr->ecm->Component<components::ParentEntity>(performer);
+  if (nullptr == parent)
+  {
+    ignerr << "Failed to get parent for performer [" << performer
+           << "], it won't be moved." << std::endl;
+    return;
+  }
+  this->dataPtr->ecm->State(*_msg.mutable_migrated_state(),
+      this->dataPtr->ecm->Descendants(parent->Data()), {}, true);
+
+  ignmsg << "Moving performer [" << performer << "] from secondary ["
+         << slowest->prefix << "] (" << slowTime * 1e3 << " ms per step) to ["
+         << fastest->prefix << "] (" << fastTime * 1e3 << " ms per step)."
+         << std::endl;
+  this->SetAffinity(performer, fastest->prefix, _msg.add_affinity());
+
+  // Measure again, so the next decision sees the effect of this one
+  std::lock_guard<std::mutex> lock(this->secondaryStatesMutex);
+  slowest->stepTimeSamples = 0;
+  fastest->stepTimeSamples = 0;
 }
 
 //////////////////////////////////////////////////
@@ -18,9 +18,13 @@
 #define IGNITION_GAZEBO_NETWORK_NETWORKMANAGERPRIMARY_HH_
 
 #include <atomic>
-#include <future>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -31,6 +35,7 @@
 
 #include "msgs/simulation_step.pb.h"
 
+#include "../TaskPool.hh"
 #include "NetworkManager.hh"
 
 namespace ignition
@@ -50,13 +55,80 @@ namespace ignition
       /// \brief prefix namespace of the secondary peer
       std::string prefix;
 
+      /// \brief Time between sending the last step and receiving its
+      /// acknowledgement from this secondary.
+      std::chrono::steady_clock::duration latency{0};
+
+      /// \brief Time this secondary spent running the last step.
+      std::chrono::steady_clock::duration stepTime{0};
+
+      /// \brief Smoothed time this secondary spends running steps, in
+      /// seconds.
+      double averageStepTime{0.0};
+
+      /// \brief Number of step times in averageStepTime.
+      uint64_t stepTimeSamples{0};
+
       /// \brief Convenience alias for unique_ptr.
       using Ptr = std::unique_ptr<SecondaryControl>;
     };
 
+    /// \brief Counters of the messages exchanged with secondaries.
+    struct NetworkStepStats
+    {
+      /// \brief Number of steps sent to secondaries.
+      uint64_t steps{0};
+
+      /// \brief Bytes of step messages sent.
+      uint64_t bytesSent{0};
+
+      /// \brief Bytes of step acknowledgements received.
+      uint64_t bytesReceived{0};
+
+      /// \brief Bytes of the states in step acknowledgements, before
+      /// compression.
+      uint64_t stateBytesReceived{0};
+
+      /// \brief Number of acknowledgements holding the full state of a
+      /// secondary's performers instead of their changes.
+      uint64_t fullStatesReceived{0};
+
+      /// \brief Number of times full states were requested because an
+      /// acknowledgement was late or couldn't be read.
+      uint64_t resyncs{0};
+
+      /// \brief Number of entities which were in the states of more than one
+      /// secondary being merged together. Affinities are disjoint, so this
+      /// should stay at zero.
+      uint64_t overlappingEntities{0};
+
+      /// \brief Time between sending the last step and receiving all its
+      /// acknowledgements.
+      std::chrono::steady_clock::duration lastLatency{0};
+
+      /// \brief Longest time taken to receive all acknowledgements of a
+      /// step.
+      std::chrono::steady_clock::duration maxLatency{0};
+
+      /// \brief Total time spent waiting for acknowledgements.
+      std::chrono::steady_clock::duration totalLatency{0};
+    };
+
     /// \class NetworkManagerPrimary NetworkManagerPrimary.hh
     ///   ignition/gazebo/network/NetworkManagerPrimary.hh
     /// \brief Simulation primary specific behaviors
+    ///
+    /// By default, the primary waits for all secondaries to acknowledge a
+    /// step before running it. Setting the IGN_GAZEBO_NETWORK_MAX_STEPS_AHEAD
+    /// environment variable to N lets secondaries run up to N steps ahead of
+    /// the states the primary merged, which hides the round trip latency.
+    /// States are then merged as they arrive, at most N steps late. Steps
+    /// which change performer affinities always run in lockstep.
+    ///
+    /// Setting the IGN_GAZEBO_NETWORK_REBALANCE_PERIOD environment variable
+    /// to N checks every N steps whether a secondary is much slower than the
+    /// others, and if it is, moves one of its performers to the fastest
+    /// secondary.
     class IGNITION_GAZEBO_VISIBLE NetworkManagerPrimary:
       public NetworkManager
     {
@@ -88,9 +160,22 @@ namespace ignition
       /// peers.
       public: std::map<std::string, SecondaryControl::Ptr>& Secondaries();
 
-      /// \brief Callback for step ack messages.
+      /// \brief Get counters of the messages exchanged with secondaries.
+      /// \return Counters since the primary started.
+      public: NetworkStepStats StepStats() const;
+
+      /// \brief Callback for step ack messages. The state is decompressed
+      /// and parsed here, in the transport thread, so the simulation thread
+      /// only applies it.
       /// \param[in] _msg Message containing secondary's updated state.
-      private: void OnStepAck(const msgs::SerializedStateMap &_msg);
+      private: void OnStepAck(const private_msgs::StepAck &_msg);
+
+      /// \brief Wait until at most a number of steps are waiting for
+      /// acknowledgements, and merge the states received so far.
+      /// \param[in] _maxInFlight Steps which can still wait for
+      /// acknowledgements.
+      /// \return False if secondaries timed out, which stops simulation.
+      private: bool WaitForSteps(std::size_t _maxInFlight);
 
       /// \brief Check if the step publisher has connections.
       private: bool SecondariesCanStep() const;
@@ -100,6 +185,12 @@ namespace ignition
       /// \param[in] _msg Step message.
       private: void PopulateAffinities(private_msgs::SimulationStep &_msg);
 
+      /// \brief Move a performer from the slowest secondary to the fastest
+      /// one, if their step times are too different.
+      /// \param[in] _msg Step message, populated with the new affinity and
+      /// the performer's state.
+      private: void Rebalance(private_msgs::SimulationStep &_msg);
+
       /// \brief Set the performer to secondary affinity.
       /// \param[in] _performer Performer entity.
       /// \param[in] _secondary Secondary identifier.
@@ -116,11 +207,78 @@ namespace ignition
       /// \brief Publisher for network step sync
       private: ignition::transport::Node::Publisher simStepPub;
 
-      /// \brief Keep track of states received from secondaries.
-      private: std::vector<msgs::SerializedStateMap> secondaryStates;
+      /// \brief A state received from a secondary.
+      private: struct SecondaryState
+      {
+        /// \brief Prefix of the secondary.
+        std::string prefix;
+
+        /// \brief The state.
+        msgs::SerializedStateMap state;
+      };
+
+      /// \brief Merge states received from secondaries into the ECM. The
+      /// states are deserialized in parallel, then applied in the order they
+      /// arrived, so the ECM is only modified in one place.
+      /// \param[in] _states States, in the order they arrived.
+      private: void MergeStates(std::vector<SecondaryState> &_states);
+
+      /// \brief States received from secondaries which weren't merged yet.
+      private: std::vector<SecondaryState> secondaryStates;
+
+      /// \brief Threads deserializing the states of secondaries, nullptr if
+      /// there is a single secondary.
+      private: std::unique_ptr<TaskPool> mergePool;
+
+      /// \brief A step which didn't get all its acknowledgements yet.
+      private: struct InFlightStep
+      {
+        /// \brief Sequence of the step.
+        uint64_t sequence;
+
+        /// \brief Time the step was sent.
+        std::chrono::steady_clock::time_point sentTime;
+
+        /// \brief Acknowledgements received so far.
+        std::size_t acks;
+      };
+
+      /// \brief Steps waiting for acknowledgements, oldest first.
+      private: std::deque<InFlightStep> inFlightSteps;
+
+      /// \brief Notified when a step got all its acknowledgements.
+      private: std::condition_variable acksCv;
+
+      /// \brief Protects secondaryStates, inFlightSteps, resyncRequested and
+      /// the step counters, which are updated from transport threads.
+      private: mutable std::mutex secondaryStatesMutex;
+
+      /// \brief Sequence of the last step sent.
+      private: uint64_t stepSequence{0};
+
+      /// \brief True to request the full state from secondaries in the next
+      /// step, because an acknowledgement was lost. Also true before the
+      /// first step.
+      private: bool resyncRequested{true};
+
+      /// \brief Number of steps secondaries may run ahead of the merged
+      /// states, see IGN_GAZEBO_NETWORK_MAX_STEPS_AHEAD.
+      private: std::size_t maxStepsAhead{0};
+
+      /// \brief Number of steps between load balancing checks, 0 to never
+      /// move performers. See IGN_GAZEBO_NETWORK_REBALANCE_PERIOD.
+      private: uint64_t rebalancePeriod{0};
+
+      /// \brief How much slower than the fastest secondary the slowest one
+      /// must be for performers to move, as a fraction of the fastest's
+      /// step time.
+      private: double rebalanceThreshold{0.25};
+
+      /// \brief Buffer reused to decompress states.
+      private: std::string decompressBuffer;
 
-      /// \brief Promise used to notify when all secondaryStates where received.
-      private: std::promise<void> secondaryStatesPromise;
+      /// \brief Counters of exchanged messages.
+      private: NetworkStepStats stepStats;
     };
     }
   }  // namespace gazebo
@@ -16,6 +16,7 @@
 */
 
 #include <algorithm>
+#include <chrono>
 #include <string>
 
 #include <ignition/common/Console.hh>
@@ -30,6 +31,7 @@
 #include "ignition/gazebo/EntityComponentManager.hh"
 #include "ignition/gazebo/Events.hh"
 
+#include "Compression.hh"
 #include "NetworkManagerPrivate.hh"
 #include "NetworkManagerSecondary.hh"
 #include "PeerTracker.hh"
@@ -61,7 +63,23 @@ NetworkManagerSecondary::NetworkManagerSecondary(
 
   this->node.Subscribe("step", &NetworkManagerSecondary::OnStep, this);
 
-  this->stepAckPub = this->node.Advertise<msgs::SerializedStateMap>("step_ack");
+  this->stepAckPub = this->node.Advertise<private_msgs::StepAck>("step_ack");
+
+  std::string compression;
+  if (common::env("IGN_GAZEBO_NETWORK_COMPRESSION", compression) &&
+      (compression == "1" || compression == "true"))
+  {
+    if (CompressionAvailable())
+    {
+      this->compressState = true;
+    }
+    else
+    {
+      ignwarn << "IGN_GAZEBO_NETWORK_COMPRESSION is set, but compression "
+              << "isn't available in this build. Sending states "
+              << "uncompressed." << std::endl;
+    }
+  }
 }
 
 //////////////////////////////////////////////////
@@ -110,6 +128,7 @@ void NetworkManagerSecondary::OnStep(
   }
 
   // Update affinities
+  bool performersChanged{false};
   for (int i = 0; i < _msg.affinity_size(); ++i)
   {
     const auto &affinityMsg = _msg.affinity(i);
@@ -117,7 +136,15 @@ void NetworkManagerSecondary::OnStep(
 
     if (affinityMsg.secondary_prefix() == this->Namespace())
     {
-      this->performers.insert(entityId);
+      // Performers moved from another secondary were removed from this one,
+      // create them from the primary's state
+      if (!this->dataPtr->ecm->HasEntity(entityId) &&
+          _msg.has_migrated_state())
+      {
+        this->dataPtr->ecm->SetState(_msg.migrated_state());
+      }
+
+      performersChanged |= this->performers.insert(entityId).second;
 
       ignmsg << "Secondary [" << this->Namespace()
              << "] assigned affinity to performer [" << entityId << "]."
@@ -126,9 +153,12 @@ void NetworkManagerSecondary::OnStep(
     // If performer has been assigned to another secondary, remove it
     else
     {
+      // The performer may have been removed already, when it was assigned
+      // to another secondary before
       auto parent =
           this->dataPtr->ecm->Component<components::ParentEntity>(entityId);
-      this->dataPtr->ecm->RequestRemoveEntity(parent->Data());
+      if (parent)
+        this->dataPtr->ecm->RequestRemoveEntity(parent->Data());
 
       if (this->performers.find(entityId) != this->performers.end())
       {
@@ -136,6 +166,7 @@ void NetworkManagerSecondary::OnStep(
                << "] unassigned affinity to performer [" << entityId << "]."
                << std::endl;
         this->performers.erase(entityId);
+        performersChanged = true;
       }
     }
   }
@@ -144,7 +175,9 @@ void NetworkManagerSecondary::OnStep(
   auto info = convert<UpdateInfo>(_msg.stats());
 
   // Step runner
+  const auto stepStart = std::chrono::steady_clock::now();
   this->dataPtr->stepFunction(info);
+  const auto stepTime = std::chrono::steady_clock::now() - stepStart;
 
   // Update state with all the performer's entities
   std::unordered_set<Entity> entities;
@@ -164,14 +197,49 @@ void NetworkManagerSecondary::OnStep(
     entities.insert(children.begin(), children.end());
   }
 
-  msgs::SerializedStateMap stateMsg;
+  // Send the components which changed since the previous acknowledgement,
+  // so acknowledgements scale with activity. The full state is sent at
+  // first, when performers change and when the primary missed one.
+  const bool full = _msg.full_state() || performersChanged ||
+      this->ackGeneration == 0;
   if (!entities.empty())
-    this->dataPtr->ecm->State(stateMsg, entities);
-  stateMsg.set_has_one_time_component_changes(
+  {
+    this->dataPtr->ecm->RebuildState(this->stateMsg, entities, {}, full,
+        full ? 0 : this->ackGeneration);
+  }
+  else
+  {
+    this->stateMsg.mutable_entities()->clear();
+  }
+  this->stateMsg.set_has_one_time_component_changes(
     this->dataPtr->ecm->HasOneTimeComponentChanges());
 
-  this->stepAckPub.Publish(stateMsg);
+  // Only small states are left uncompressed, where compression doesn't pay
+  // off
+  constexpr std::size_t kMinCompressSize{256};
+  this->stateMsg.SerializeToString(&this->stateBuffer);
+  this->ackMsg.set_sequence(_msg.sequence());
+  this->ackMsg.set_secondary_prefix(this->Namespace());
+  this->ackMsg.set_raw_size(this->stateBuffer.size());
+  this->ackMsg.set_full_state(full);
+  this->ackMsg.set_step_time_us(static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+      stepTime).count()));
+  if (this->compressState && this->stateBuffer.size() >= kMinCompressSize &&
+      Compress(this->stateBuffer, *this->ackMsg.mutable_state()) &&
+      this->ackMsg.state().size() < this->stateBuffer.size())
+  {
+    this->ackMsg.set_compression(private_msgs::StepAck::ZLIB);
+  }
+  else
+  {
+    this->ackMsg.set_compression(private_msgs::StepAck::NONE);
+    this->ackMsg.mutable_state()->swap(this->stateBuffer);
+  }
+
+  this->stepAckPub.Publish(this->ackMsg);
 
+  this->ackGeneration = this->dataPtr->ecm->ChangeGeneration() + 1;
   this->dataPtr->ecm->SetAllComponentsUnchanged();
 }
 
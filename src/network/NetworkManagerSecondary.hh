@@ -22,6 +22,8 @@
 #include <string>
 #include <unordered_set>
 
+#include <ignition/msgs/serialized_map.pb.h>
+
 #include <ignition/gazebo/config.hh>
 #include <ignition/gazebo/Export.hh>
 #include <ignition/transport/Node.hh>
@@ -81,6 +83,26 @@ namespace ignition
 
       /// \brief Collection of performers associated with this secondary.
       private: std::unordered_set<Entity> performers;
+
+      /// \brief State sent back on every step, rebuilt in place so its
+      /// memory is reused.
+      private: msgs::SerializedStateMap stateMsg;
+
+      /// \brief Acknowledgement sent back on every step.
+      private: private_msgs::StepAck ackMsg;
+
+      /// \brief Buffer the state is serialized into, swapped with the
+      /// acknowledgement's so both keep their memory.
+      private: std::string stateBuffer;
+
+      /// \brief Change generation following the previous acknowledgement,
+      /// see EntityComponentManager::ChangeGeneration. Zero before the
+      /// first one.
+      private: uint64_t ackGeneration{0};
+
+      /// \brief True to compress states, set with the
+      /// IGN_GAZEBO_NETWORK_COMPRESSION environment variable.
+      private: bool compressState{false};
     };
     }
   }  // namespace gazebo
@@ -260,4 +260,11 @@ TEST(NetworkManager, Step)
   secondaryThread2.join();
 
   EXPECT_FALSE(running);
+
+  // Secondaries start with their full state, then only send changes
+  auto stats =
+      static_cast<NetworkManagerPrimary *>(nmPrimary.get())->StepStats();
+  EXPECT_EQ(101u, stats.steps);
+  EXPECT_LE(2u, stats.fullStatesReceived);
+  EXPECT_GT(2u * stats.steps, stats.fullStatesReceived);
 }
@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
+#include <ignition/common/VideoEncoder.hh>
+
+#include "ignition/gazebo/rendering/AsyncVideoEncoder.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+namespace
+{
+/// \brief A frame waiting to be encoded.
+struct QueuedFrame
+{
+  /// \brief Frame data
+  std::vector<unsigned char> data;
+
+  /// \brief Frame width in pixels
+  unsigned int width{0};
+
+  /// \brief Frame height in pixels
+  unsigned int height{0};
+
+  /// \brief Frame timestamp
+  std::chrono::steady_clock::time_point timestamp;
+};
+}
+
+/// \brief Private data class for AsyncVideoEncoder
+class ignition::gazebo::AsyncVideoEncoderPrivate
+{
+  /// \brief Encode queued frames until stopped.
+  public: void Run();
+
+  /// \brief Encoder, only used by the encoding thread while encoding.
+  public: common::VideoEncoder encoder;
+
+  /// \brief Encoding thread.
+  public: std::thread worker;
+
+  /// \brief Protects the members below.
+  public: mutable std::mutex mutex;
+
+  /// \brief Notified when a frame is queued or encoding is stopped.
+  public: std::condition_variable frameCv;
+
+  /// \brief Notified when a frame is taken from the queue.
+  public: std::condition_variable spaceCv;
+
+  /// \brief Frames waiting to be encoded.
+  public: std::deque<QueuedFrame> queue;
+
+  /// \brief Buffers of encoded frames, reused for new frames.
+  public: std::vector<std::vector<unsigned char>> pool;
+
+  /// \brief Maximum number of queued frames.
+  public: std::size_t queueSize{4};
+
+  /// \brief True to drop frames when the queue is full.
+  public: bool dropFrames{true};
+
+  /// \brief Allowed hardware encoders, see SetHardwareEncoders.
+  public: std::string hwEncoders;
+
+  /// \brief Called for every encoded frame.
+  public: std::function<void(const std::chrono::steady_clock::time_point &)>
+      frameCb;
+
+  /// \brief Whether encoding.
+  public: bool encoding{false};
+
+  /// \brief Whether the encoding thread should finish.
+  public: bool stopping{false};
+
+  /// \brief Frames dropped since encoding started.
+  public: uint64_t droppedFrames{0};
+};
+
+/////////////////////////////////////////////////
+void AsyncVideoEncoderPrivate::Run()
+{
+  while (true)
+  {
+    QueuedFrame frame;
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->frameCv.wait(lock, [this]
+          {
+            return this->stopping || !this->queue.empty();
+          });
+
+      // Queued frames are still encoded when stopping
+      if (this->queue.empty())
+        return;
+
+      frame = std::move(this->queue.front());
+      this->queue.pop_front();
+    }
+    this->spaceCv.notify_one();
+
+    {
+      IGN_PROFILE("AsyncVideoEncoder::AddFrame");
+      bool added = this->encoder.AddFrame(frame.data.data(), frame.width,
+          frame.height, frame.timestamp);
+      if (added && this->frameCb)
+        this->frameCb(frame.timestamp);
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->pool.push_back(std::move(frame.data));
+  }
+}
+
+/////////////////////////////////////////////////
+AsyncVideoEncoder::AsyncVideoEncoder()
+  : dataPtr(std::make_unique<AsyncVideoEncoderPrivate>())
+{
+}
+
+/////////////////////////////////////////////////
+AsyncVideoEncoder::~AsyncVideoEncoder()
+{
+  this->Stop();
+}
+
+/////////////////////////////////////////////////
+void AsyncVideoEncoder::SetQueueSize(std::size_t _size)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->queueSize = std::max<std::size_t>(1u, _size);
+}
+
+/////////////////////////////////////////////////
+void AsyncVideoEncoder::SetDropFrames(bool _drop)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->dropFrames = _drop;
+}
+
+/////////////////////////////////////////////////
+void AsyncVideoEncoder::SetHardwareEncoders(const std::string &_encoders)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->hwEncoders = _encoders;
+}
+
+/////////////////////////////////////////////////
+void AsyncVideoEncoder::SetFrameCallback(
+    std::function<void(const std::chrono::steady_clock::time_point &)> _cb)
+{
+  // The callback is only read by the encoding thread, which isn't running
+  // while not encoding
+  if (this->IsEncoding())
+  {
+    ignerr << "Can't set the frame callback while encoding." << std::endl;
+    return;
+  }
+  this->dataPtr->frameCb = std::move(_cb);
+}
+
+/////////////////////////////////////////////////
+bool AsyncVideoEncoder::Start(const std::string &_format,
+    const std::string &_filename, unsigned int _width, unsigned int _height,
+    unsigned int _fps, unsigned int _bitRate)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (this->dataPtr->encoding)
+    return false;
+
+  std::string allowed;
+  if (!this->dataPtr->hwEncoders.empty() &&
+      !common::env("IGN_VIDEO_ALLOWED_ENCODERS", allowed))
+  {
+    common::setenv("IGN_VIDEO_ALLOWED_ENCODERS", this->dataPtr->hwEncoders);
+  }
+
+  if (!this->dataPtr->encoder.Start(_format, _filename, _width, _height, _fps,
+      _bitRate))
+  {
+    return false;
+  }
+
+  this->dataPtr->encoding = true;
+  this->dataPtr->stopping = false;
+  this->dataPtr->droppedFrames = 0;
+  this->dataPtr->worker = std::thread(&AsyncVideoEncoderPrivate::Run,
+      this->dataPtr.get());
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool AsyncVideoEncoder::IsEncoding() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->encoding;
+}
+
+/////////////////////////////////////////////////
+bool AsyncVideoEncoder::AddFrame(const unsigned char *_frame,
+    unsigned int _width, unsigned int _height,
+    const std::chrono::steady_clock::time_point &_timestamp)
+{
+  IGN_PROFILE("AsyncVideoEncoder::QueueFrame");
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  if (!this->dataPtr->encoding || this->dataPtr->stopping)
+    return false;
+
+  if (this->dataPtr->queue.size() >= this->dataPtr->queueSize)
+  {
+    if (this->dataPtr->dropFrames)
+    {
+      ++this->dataPtr->droppedFrames;
+      return false;
+    }
+    this->dataPtr->spaceCv.wait(lock, [this]
+        {
+          return this->dataPtr->stopping ||
+              this->dataPtr->queue.size() < this->dataPtr->queueSize;
+        });
+    if (this->dataPtr->stopping)
+      return false;
+  }
+
+  QueuedFrame frame;
+  if (!this->dataPtr->pool.empty())
+  {
+    frame.data = std::move(this->dataPtr->pool.back());
+    this->dataPtr->pool.pop_back();
+  }
+  // RGB, 3 bytes per pixel
+  frame.data.assign(_frame, _frame + 3u * _width * _height);
+  frame.width = _width;
+  frame.height = _height;
+  frame.timestamp = _timestamp;
+  this->dataPtr->queue.push_back(std::move(frame));
+  lock.unlock();
+
+  this->dataPtr->frameCv.notify_one();
+  return true;
+}
+
+/////////////////////////////////////////////////
+void AsyncVideoEncoder::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    if (!this->dataPtr->encoding)
+      return;
+    this->dataPtr->stopping = true;
+  }
+  this->dataPtr->frameCv.notify_all();
+  this->dataPtr->spaceCv.notify_all();
+
+  if (this->dataPtr->worker.joinable())
+    this->dataPtr->worker.join();
+
+  this->dataPtr->encoder.Stop();
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->encoding = false;
+  this->dataPtr->stopping = false;
+  if (this->dataPtr->droppedFrames > 0)
+  {
+    igndbg << "Dropped [" << this->dataPtr->droppedFrames
+           << "] frames while encoding video." << std::endl;
+  }
+}
+
+/////////////////////////////////////////////////
+uint64_t AsyncVideoEncoder::DroppedFrames() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->droppedFrames;
+}
@@ -16,10 +16,11 @@
 */
 
 #include <functional>
-#include <list>
 #include <map>
 #include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <ignition/msgs.hh>
 #include <ignition/transport/Node.hh>
@@ -60,6 +61,12 @@ class ignition::gazebo::MarkerManagerPrivate
   /// \brief Updates the markers.
   public: void Update();
 
+  /// \brief Queue a marker message, merging it into the pending message of
+  /// the same marker if there's one, so each marker is updated at most once
+  /// per frame. Must be called with the mutex locked.
+  /// \param[in] _msg The marker message.
+  public: void QueueMarkerMsg(const ignition::msgs::Marker &_msg);
+
   /// \brief Callback that receives marker messages.
   /// \param[in] _req The marker message.
   public: void OnMarkerMsg(const ignition::msgs::Marker &_req);
@@ -102,8 +109,18 @@ class ignition::gazebo::MarkerManagerPrivate
   public: std::map<std::string,
       std::map<uint64_t, ignition::rendering::VisualPtr>> visuals;
 
-  /// \brief List of marker message to process.
-  public: std::list<ignition::msgs::Marker> markerMsgs;
+  /// \brief Marker messages to process, in the order they were received.
+  /// Kept between frames so its storage is reused.
+  public: std::vector<ignition::msgs::Marker> markerMsgs;
+
+  /// \brief Index in markerMsgs of the pending add / modify message of each
+  /// marker, by namespace and id.
+  public: std::map<std::pair<std::string, uint64_t>, std::size_t>
+      pendingMarkers;
+
+  /// \brief Material reused to convert marker materials, which markers
+  /// clone.
+  public: rendering::MaterialPtr scratchMaterial;
 
   /// \brief Pointer to the scene
   public: rendering::ScenePtr scene;
@@ -134,6 +151,7 @@ MarkerManager::~MarkerManager() = default;
 void MarkerManager::SetScene(rendering::ScenePtr _scene)
 {
   this->dataPtr->scene = std::move(_scene);
+  this->dataPtr->scratchMaterial.reset();
 }
 
 /////////////////////////////////////////////////
@@ -158,6 +176,7 @@ bool MarkerManager::Init(const ignition::rendering::ScenePtr &_scene)
   }
 
   this->dataPtr->scene = _scene;
+  this->dataPtr->scratchMaterial.reset();
 
   if (this->dataPtr->topicName.empty())
   {
@@ -211,13 +230,10 @@ void MarkerManagerPrivate::Update()
   std::lock_guard<std::mutex> lock(this->mutex);
 
   // Process the marker messages.
-  for (auto markerIter = this->markerMsgs.begin();
-       markerIter != this->markerMsgs.end();)
-  {
-    this->ProcessMarkerMsg(*markerIter);
-    this->markerMsgs.erase(markerIter++);
-  }
-
+  for (const auto &markerMsg : this->markerMsgs)
+    this->ProcessMarkerMsg(markerMsg);
+  this->markerMsgs.clear();
+  this->pendingMarkers.clear();
 
   // Erase any markers that have a lifetime.
   for (auto mit = this->visuals.begin();
@@ -327,9 +343,6 @@ void MarkerManagerPrivate::SetMarker(const ignition::msgs::Marker &_msg,
   {
     rendering::MaterialPtr materialPtr = MsgToMaterial(_msg);
     _markerPtr->SetMaterial(materialPtr, true /* clone */);
-
-    // clean up material after clone
-    this->scene->DestroyMaterial(materialPtr);
   }
 
   // Assume the presence of points means we clear old ones
@@ -401,7 +414,10 @@ ignition::rendering::MarkerType MarkerManagerPrivate::MsgToType(
 rendering::MaterialPtr MarkerManagerPrivate::MsgToMaterial(
                               const ignition::msgs::Marker &_msg)
 {
-  rendering::MaterialPtr material = this->scene->CreateMaterial();
+  // The marker clones the material, so the same one is filled every time
+  if (!this->scratchMaterial)
+    this->scratchMaterial = this->scene->CreateMaterial();
+  rendering::MaterialPtr material = this->scratchMaterial;
 
   material->SetAmbient(
       _msg.material().ambient().r(),
@@ -612,11 +628,68 @@ bool MarkerManagerPrivate::OnList(ignition::msgs::Marker_V &_rep)
   return true;
 }
 
+/////////////////////////////////////////////////
+void MarkerManagerPrivate::QueueMarkerMsg(const ignition::msgs::Marker &_msg)
+{
+  // Markers without id get a new one each time, they're never merged
+  const auto key = std::make_pair(_msg.ns(), _msg.id());
+  if (_msg.id() == 0)
+  {
+    this->markerMsgs.push_back(_msg);
+    return;
+  }
+
+  if (_msg.action() != ignition::msgs::Marker::ADD_MODIFY)
+  {
+    // Later messages can't be merged across a deletion
+    if (_msg.action() == ignition::msgs::Marker::DELETE_ALL)
+    {
+      for (auto it = this->pendingMarkers.begin();
+           it != this->pendingMarkers.end();)
+      {
+        if (_msg.ns().empty() || it->first.first == _msg.ns())
+          it = this->pendingMarkers.erase(it);
+        else
+          ++it;
+      }
+    }
+    else
+    {
+      this->pendingMarkers.erase(key);
+    }
+    this->markerMsgs.push_back(_msg);
+    return;
+  }
+
+  auto pendingIt = this->pendingMarkers.find(key);
+  if (pendingIt == this->pendingMarkers.end())
+  {
+    this->pendingMarkers[key] = this->markerMsgs.size();
+    this->markerMsgs.push_back(_msg);
+    return;
+  }
+
+  // Merge into the pending message, with the same result as applying both.
+  // Points and materials replace the previous ones, and the layer and
+  // lifetime are always set.
+  auto &pending = this->markerMsgs[pendingIt->second];
+  if (_msg.point_size() > 0)
+    pending.clear_point();
+  if (_msg.has_material())
+    pending.clear_material();
+  pending.MergeFrom(_msg);
+  pending.set_layer(_msg.layer());
+  if (_msg.has_lifetime())
+    *pending.mutable_lifetime() = _msg.lifetime();
+  else
+    pending.clear_lifetime();
+}
+
 /////////////////////////////////////////////////
 void MarkerManagerPrivate::OnMarkerMsg(const ignition::msgs::Marker &_req)
 {
   std::lock_guard<std::mutex> lock(this->mutex);
-  this->markerMsgs.push_back(_req);
+  this->QueueMarkerMsg(_req);
 }
 
 /////////////////////////////////////////////////
@@ -624,8 +697,9 @@ bool MarkerManagerPrivate::OnMarkerMsgArray(
     const ignition::msgs::Marker_V&_req, ignition::msgs::Boolean &_res)
 {
   std::lock_guard<std::mutex> lock(this->mutex);
-  std::copy(_req.marker().begin(), _req.marker().end(),
-            std::back_inserter(this->markerMsgs));
+  this->markerMsgs.reserve(this->markerMsgs.size() + _req.marker_size());
+  for (const auto &marker : _req.marker())
+    this->QueueMarkerMsg(marker);
   _res.set_data(true);
   return true;
 }
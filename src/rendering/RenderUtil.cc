@@ -15,10 +15,13 @@
  *
  */
 
+#include <iterator>
 #include <map>
+#include <set>
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -107,6 +110,13 @@ class ignition::gazebo::RenderUtilPrivate
   /// \param[in] _ecm The entity-component manager
   public: void UpdateRenderingEntities(const EntityComponentManager &_ecm);
 
+  /// \brief Queue a visual's temperature for the rendering thread, if it
+  /// differs from the one last sent for it.
+  /// \param[in] _ecm The entity-component manager
+  /// \param[in] _entity Visual entity
+  public: void UpdateVisualTemperature(const EntityComponentManager &_ecm,
+      Entity _entity);
+
   /// \brief Total time elapsed in simulation. This will not increase while
   /// paused.
   public: std::chrono::steady_clock::duration simTime{0};
@@ -195,6 +205,16 @@ class ignition::gazebo::RenderUtilPrivate
   /// \brief A map of entity ids and pose updates.
   public: std::unordered_map<Entity, math::Pose3d> entityPoses;
 
+  /// \brief Change token of the poses, see
+  /// EntityComponentManager::EachChanged. Only poses which changed since
+  /// the previous update are sent to the rendering thread.
+  public: uint64_t poseToken{0};
+
+  /// \brief Pose updates which the rendering thread held back while their
+  /// entities were being manipulated, applied once they aren't anymore.
+  /// Only used by the rendering thread.
+  public: std::unordered_map<Entity, math::Pose3d> heldPoses;
+
   /// \brief A map of entity ids and light updates.
   public: std::unordered_map<Entity, msgs::Light> entityLights;
 
@@ -219,6 +239,15 @@ class ignition::gazebo::RenderUtilPrivate
   /// All temperatures are in Kelvin.
   public: std::map<Entity, std::tuple<float, float, std::string>> entityTemp;
 
+  /// \brief Temperature data last sent for each visual, in the same format
+  /// as entityTemp. Temperatures are only sent again when they change.
+  public: std::unordered_map<Entity, std::tuple<float, float, std::string>>
+      visualTemps;
+
+  /// \brief Change token of the temperatures, see
+  /// EntityComponentManager::EachChanged.
+  public: uint64_t temperatureToken{0};
+
   /// \brief A map of entity ids and wire boxes
   public: std::unordered_map<Entity, ignition::rendering::WireBoxPtr> wireBoxes;
 
@@ -234,9 +263,57 @@ class ignition::gazebo::RenderUtilPrivate
   /// \todo(anyone) Let this be turned on from a component
   public: bool actorManualSkeletonUpdate = false;
 
+  /// \brief True to animate actor skeletons, false to only animate their
+  /// trajectories, see RenderUtil::SetActorSkinningEnabled.
+  public: bool actorSkinning = true;
+
   /// \brief Mutex to protect updates
   public: std::mutex updateMutex;
 
+  /// \brief Scene updates which were prepared from the ECM and are ready to
+  /// be applied by the rendering thread. The containers with the same names
+  /// in RenderUtilPrivate hold the updates being prepared, so the rendering
+  /// thread doesn't wait for the data thread to visit the ECM. See their
+  /// documentation for the contents.
+  public: struct SceneUpdate
+  {
+    std::vector<sdf::Scene> newScenes;
+    std::vector<std::tuple<Entity, sdf::Model, Entity, uint64_t>> newModels;
+    std::vector<std::tuple<Entity, sdf::Link, Entity>> newLinks;
+    std::vector<std::tuple<Entity, sdf::Visual, Entity>> newVisuals;
+    std::vector<std::tuple<Entity, sdf::Actor, Entity>> newActors;
+    std::vector<std::tuple<Entity, sdf::Light, Entity>> newLights;
+    std::vector<std::tuple<Entity, sdf::Sensor, Entity>> newSensors;
+    std::vector<std::tuple<Entity, msgs::ParticleEmitter, Entity>>
+        newParticleEmitters;
+    std::unordered_map<Entity, msgs::ParticleEmitter> newParticleEmittersCmds;
+    std::unordered_map<Entity, uint64_t> removeEntities;
+    std::unordered_map<Entity, math::Pose3d> entityPoses;
+    std::unordered_map<Entity, msgs::Light> entityLights;
+    std::unordered_map<Entity, math::Pose3d> trajectoryPoses;
+    std::map<Entity, std::map<std::string, math::Matrix4d>> actorTransforms;
+    std::unordered_map<Entity, AnimationUpdateData> actorAnimationData;
+    std::map<Entity, std::tuple<float, float, std::string>> entityTemp;
+    std::vector<Entity> newCollisionLinks;
+    std::unordered_map<Entity,
+        std::tuple<double, components::TemperatureRangeInfo>>
+        thermalCameraData;
+  };
+
+  /// \brief Updates ready for the rendering thread, protected by
+  /// sceneUpdateMutex.
+  public: SceneUpdate sceneUpdate;
+
+  /// \brief Mutex to protect sceneUpdate. It's only held to hand updates
+  /// over, never while visiting the ECM or rendering.
+  public: std::mutex sceneUpdateMutex;
+
+  /// \brief Hand the updates prepared since the previous call over to the
+  /// rendering thread. They're swapped in if the rendering thread took the
+  /// previous ones, and appended to them otherwise, newer values replacing
+  /// older ones for the same entity.
+  public: void PublishSceneUpdate();
+
   //// \brief Flag to indicate whether to create sensors
   public: bool enableSensors = false;
 
@@ -304,9 +381,10 @@ class ignition::gazebo::RenderUtilPrivate
   public: std::vector<Entity> newCollisions;
 
   /// \brief Finds the links (collision parent) that are used to create child
-  /// collision visuals in RenderUtil::Update
-  /// \param[in] _ecm The entity-component manager
-  public: void FindCollisionLinks(const EntityComponentManager &_ecm);
+  /// collision visuals in RenderUtil::Update. Links are looked up in the
+  /// maps filled as entities are created, so this only costs anything
+  /// when collisions are requested.
+  public: void FindCollisionLinks();
 
   /// \brief A list of links used to create new collision visuals
   public: std::vector<Entity> newCollisionLinks;
@@ -363,9 +441,11 @@ void RenderUtil::UpdateECM(const UpdateInfo &/*_info*/,
       [&](const Entity &_entity,
           const components::ParticleEmitterCmd *_emitterCmd) -> bool
       {
-        // store emitter properties and update them in rendering thread
-        this->dataPtr->newParticleEmittersCmds[_entity] =
-        _emitterCmd->Data();
+        // store emitter properties and update them in rendering thread.
+        // Commands only hold changed parameters, so merge them with any
+        // command that hasn't been rendered yet.
+        this->dataPtr->newParticleEmittersCmds[_entity].MergeFrom(
+            _emitterCmd->Data());
 
         // update pose comp here
         if (_emitterCmd->Data().has_pose())
@@ -460,44 +540,107 @@ void RenderUtil::UpdateFromECM(const UpdateInfo &_info,
   std::lock_guard<std::mutex> lock(this->dataPtr->updateMutex);
   this->dataPtr->simTime = _info.simTime;
 
-  this->dataPtr->CreateRenderingEntities(_ecm, _info);
+  // Only new and removed entities, and changed poses, are visited after
+  // the first update, so the cost follows the changes in the scene
+  if (!this->dataPtr->initialized || _ecm.HasNewEntities())
+    this->dataPtr->CreateRenderingEntities(_ecm, _info);
   this->dataPtr->UpdateRenderingEntities(_ecm);
-  this->dataPtr->RemoveRenderingEntities(_ecm, _info);
+  if (_ecm.HasEntitiesMarkedForRemoval())
+    this->dataPtr->RemoveRenderingEntities(_ecm, _info);
   this->dataPtr->markerManager.SetSimTime(_info.simTime);
-  this->dataPtr->FindCollisionLinks(_ecm);
+  if (!this->dataPtr->newCollisions.empty())
+    this->dataPtr->FindCollisionLinks();
+  this->dataPtr->PublishSceneUpdate();
 }
 
 //////////////////////////////////////////////////
-void RenderUtilPrivate::FindCollisionLinks(const EntityComponentManager &_ecm)
+void RenderUtilPrivate::PublishSceneUpdate()
 {
-  if (this->newCollisions.empty())
-    return;
+  IGN_PROFILE("RenderUtilPrivate::PublishSceneUpdate");
+  auto append = [](auto &_to, auto &_from)
+  {
+    if (_to.empty())
+    {
+      std::swap(_to, _from);
+    }
+    else
+    {
+      _to.insert(_to.end(), std::make_move_iterator(_from.begin()),
+          std::make_move_iterator(_from.end()));
+    }
+    _from.clear();
+  };
+  auto assign = [](auto &_to, auto &_from)
+  {
+    if (_to.empty())
+    {
+      std::swap(_to, _from);
+    }
+    else
+    {
+      for (auto &value : _from)
+        _to[value.first] = std::move(value.second);
+    }
+    _from.clear();
+  };
+
+  std::lock_guard<std::mutex> lock(this->sceneUpdateMutex);
+  auto &update = this->sceneUpdate;
+  append(update.newScenes, this->newScenes);
+  append(update.newModels, this->newModels);
+  append(update.newLinks, this->newLinks);
+  append(update.newVisuals, this->newVisuals);
+  append(update.newActors, this->newActors);
+  append(update.newLights, this->newLights);
+  append(update.newSensors, this->newSensors);
+  append(update.newParticleEmitters, this->newParticleEmitters);
+  // Particle emitter commands only hold changed parameters, merge them
+  for (auto &[entity, cmd] : this->newParticleEmittersCmds)
+    update.newParticleEmittersCmds[entity].MergeFrom(cmd);
+  this->newParticleEmittersCmds.clear();
+  assign(update.removeEntities, this->removeEntities);
+  assign(update.entityPoses, this->entityPoses);
+  assign(update.entityLights, this->entityLights);
+  assign(update.trajectoryPoses, this->trajectoryPoses);
+  assign(update.actorTransforms, this->actorTransforms);
+  assign(update.actorAnimationData, this->actorAnimationData);
+  assign(update.entityTemp, this->entityTemp);
+  append(update.newCollisionLinks, this->newCollisionLinks);
+  assign(update.thermalCameraData, this->thermalCameraData);
+}
+
+//////////////////////////////////////////////////
+void RenderUtilPrivate::FindCollisionLinks()
+{
+  // Each link is only queued once, even if it's requested through its model
+  // and itself
+  std::set<Entity> queued(this->newCollisionLinks.begin(),
+      this->newCollisionLinks.end());
+  auto queue = [&](Entity _link)
+  {
+    if (queued.insert(_link).second)
+      this->newCollisionLinks.push_back(_link);
+  };
 
   for (const auto &entity : this->newCollisions)
   {
-    std::vector<Entity> links;
-    if (_ecm.EntityMatches(entity,
-          std::set<ComponentTypeId>{components::Model::typeId}))
+    auto modelIt = this->modelToLinkEntities.find(entity);
+    if (modelIt != this->modelToLinkEntities.end())
     {
-      links = _ecm.EntitiesByComponents(components::ParentEntity(entity),
-                                        components::Link());
+      for (const auto &link : modelIt->second)
+        queue(link);
     }
-    else if (_ecm.EntityMatches(entity,
-                std::set<ComponentTypeId>{components::Link::typeId}))
+    else if (this->linkToCollisionEntities.find(entity) !=
+        this->linkToCollisionEntities.end())
     {
-      links.push_back(entity);
+      queue(entity);
     }
     else
     {
       ignerr << "Entity [" << entity
              << "] for viewing collision must be a model or link"
              << std::endl;
-      continue;
     }
-
-    this->newCollisionLinks.insert(this->newCollisionLinks.end(),
-        links.begin(),
-        links.end());
   }
   this->newCollisions.clear();
 }
@@ -511,10 +654,8 @@ int RenderUtil::PendingSensors() const
   if (!this->dataPtr->scene)
     return -1;
 
-  this->dataPtr->updateMutex.lock();
-  int nSensors = this->dataPtr->newSensors.size();
-  this->dataPtr->updateMutex.unlock();
-  return nSensors;
+  std::lock_guard<std::mutex> lock(this->dataPtr->sceneUpdateMutex);
+  return static_cast<int>(this->dataPtr->sceneUpdate.newSensors.size());
 }
 
 //////////////////////////////////////////////////
@@ -527,53 +668,38 @@ void RenderUtil::Update()
   if (!this->dataPtr->scene)
     return;
 
-  this->dataPtr->updateMutex.lock();
-  auto newScenes = std::move(this->dataPtr->newScenes);
-  auto newModels = std::move(this->dataPtr->newModels);
-  auto newLinks = std::move(this->dataPtr->newLinks);
-  auto newVisuals = std::move(this->dataPtr->newVisuals);
-  auto newActors = std::move(this->dataPtr->newActors);
-  auto newLights = std::move(this->dataPtr->newLights);
-  auto newParticleEmitters = std::move(this->dataPtr->newParticleEmitters);
-  auto newParticleEmittersCmds =
-    std::move(this->dataPtr->newParticleEmittersCmds);
-  auto removeEntities = std::move(this->dataPtr->removeEntities);
-  auto entityPoses = std::move(this->dataPtr->entityPoses);
-  auto entityLights = std::move(this->dataPtr->entityLights);
-  auto trajectoryPoses = std::move(this->dataPtr->trajectoryPoses);
-  auto actorTransforms = std::move(this->dataPtr->actorTransforms);
-  auto actorAnimationData = std::move(this->dataPtr->actorAnimationData);
-  auto entityTemp = std::move(this->dataPtr->entityTemp);
-  auto newCollisionLinks = std::move(this->dataPtr->newCollisionLinks);
-  auto thermalCameraData = std::move(this->dataPtr->thermalCameraData);
-
-  this->dataPtr->newScenes.clear();
-  this->dataPtr->newModels.clear();
-  this->dataPtr->newLinks.clear();
-  this->dataPtr->newVisuals.clear();
-  this->dataPtr->newActors.clear();
-  this->dataPtr->newLights.clear();
-  this->dataPtr->newParticleEmitters.clear();
-  this->dataPtr->newParticleEmittersCmds.clear();
-  this->dataPtr->removeEntities.clear();
-  this->dataPtr->entityPoses.clear();
-  this->dataPtr->entityLights.clear();
-  this->dataPtr->trajectoryPoses.clear();
-  this->dataPtr->actorTransforms.clear();
-  this->dataPtr->actorAnimationData.clear();
-  this->dataPtr->entityTemp.clear();
-  this->dataPtr->newCollisionLinks.clear();
-  this->dataPtr->thermalCameraData.clear();
-
-  this->dataPtr->markerManager.Update();
-
-  std::vector<std::tuple<Entity, sdf::Sensor, Entity>> newSensors;
-  if (this->dataPtr->enableSensors)
+  // Take the updates prepared since the previous call. The data thread
+  // only holds this mutex to hand them over, so the rendering thread
+  // doesn't wait for the ECM to be visited.
+  RenderUtilPrivate::SceneUpdate update;
   {
-    newSensors = std::move(this->dataPtr->newSensors);
-    this->dataPtr->newSensors.clear();
+    std::lock_guard<std::mutex> lock(this->dataPtr->sceneUpdateMutex);
+    std::swap(update, this->dataPtr->sceneUpdate);
+
+    // Sensors are kept until sensors are enabled
+    if (!this->dataPtr->enableSensors)
+      std::swap(update.newSensors, this->dataPtr->sceneUpdate.newSensors);
   }
-  this->dataPtr->updateMutex.unlock();
+  auto &newScenes = update.newScenes;
+  auto &newModels = update.newModels;
+  auto &newLinks = update.newLinks;
+  auto &newVisuals = update.newVisuals;
+  auto &newActors = update.newActors;
+  auto &newLights = update.newLights;
+  auto &newParticleEmitters = update.newParticleEmitters;
+  auto &newParticleEmittersCmds = update.newParticleEmittersCmds;
+  auto &removeEntities = update.removeEntities;
+  auto &entityPoses = update.entityPoses;
+  auto &entityLights = update.entityLights;
+  auto &trajectoryPoses = update.trajectoryPoses;
+  auto &actorTransforms = update.actorTransforms;
+  auto &actorAnimationData = update.actorAnimationData;
+  auto &entityTemp = update.entityTemp;
+  auto &newCollisionLinks = update.newCollisionLinks;
+  auto &thermalCameraData = update.thermalCameraData;
+  auto &newSensors = update.newSensors;
+
+  this->dataPtr->markerManager.Update();
 
   // scene - only one scene is supported for now
   // extend the sensor system to support mutliple scenes in the future
@@ -828,6 +954,13 @@ void RenderUtil::Update()
   // update entities' pose
   {
     IGN_PROFILE("RenderUtil::Update Poses");
+
+    // Only changed poses are sent, so poses held back earlier are kept
+    // until they're applied or replaced
+    for (const auto &pose : this->dataPtr->heldPoses)
+      entityPoses.insert(pose);
+    this->dataPtr->heldPoses.clear();
+
     for (const auto &pose : entityPoses)
     {
       auto node = this->dataPtr->sceneManager.NodeById(pose.first);
@@ -853,6 +986,7 @@ void RenderUtil::Update()
           entityId == this->dataPtr->selectedEntities.back())) ||
           updateNode)
       {
+        this->dataPtr->heldPoses.insert(pose);
         continue;
       }
 
@@ -860,7 +994,8 @@ void RenderUtil::Update()
     }
 
     // update entities' local transformations
-    if (this->dataPtr->actorManualSkeletonUpdate)
+    if (this->dataPtr->actorManualSkeletonUpdate &&
+        this->dataPtr->actorSkinning)
     {
       for (auto &tf : actorTransforms)
       {
@@ -894,6 +1029,10 @@ void RenderUtil::Update()
 
         actorVisual->SetLocalPose(trajPose + globalPose);
 
+        // Limbs of actors which aren't drawn don't need to be posed
+        if (this->dataPtr->sceneManager.Culled(tf.first))
+          continue;
+
         tf.second.erase("actorPose");
         actorMesh->SetSkeletonLocalTransforms(tf.second);
       }
@@ -919,8 +1058,15 @@ void RenderUtil::Update()
           ignerr << "invalid animation update data" << std::endl;
           continue;
         }
+
+        // Only animate the skeletons of actors which are drawn. Animations
+        // are set by time, so they're right again as soon as they're drawn.
+        bool skinning = this->dataPtr->actorSkinning &&
+            !this->dataPtr->sceneManager.Culled(it.first);
+
         // Enable skeleton animation
-        if (!actorMesh->SkeletonAnimationEnabled(animData.animationName))
+        if (skinning &&
+            !actorMesh->SkeletonAnimationEnabled(animData.animationName))
         {
           // disable all animations for this actor
           for (unsigned int i = 0; i < actorSkel->AnimationCount(); ++i)
@@ -952,11 +1098,12 @@ void RenderUtil::Update()
         // have multiple animations. Animation time is associated with
         // current animation that is being played. It is also adjusted if
         // interpotate_x is enabled.
-        actorMesh->UpdateSkeletonAnimation(animData.time);
+        if (skinning)
+          actorMesh->UpdateSkeletonAnimation(animData.time);
 
         // manually update root transform in order to sync with trajectory
         // animation
-        if (animData.followTrajectory)
+        if (skinning && animData.followTrajectory)
         {
           common::SkeletonPtr skeleton =
               this->dataPtr->sceneManager.ActorSkeletonById(it.first);
@@ -1054,7 +1201,7 @@ void RenderUtil::Update()
   }
 
   // update thermal camera
-  for (const auto &thermal : this->dataPtr->thermalCameraData)
+  for (const auto &thermal : thermalCameraData)
   {
     Entity id = thermal.first;
     rendering::ThermalCameraPtr camera =
@@ -1213,30 +1360,7 @@ void RenderUtilPrivate::CreateRenderingEntities(
             visual.SetLaserRetro(laserRetro->Data());
           }
 
-          if (auto temp = _ecm.Component<components::Temperature>(_entity))
-          {
-            // get the uniform temperature for the entity
-            this->entityTemp[_entity] =
-              std::make_tuple<float, float, std::string>(
-                  temp->Data().Kelvin(), 0.0, "");
-          }
-          else
-          {
-            // entity doesn't have a uniform temperature. Check if it has
-            // a heat signature with an associated temperature range
-            auto heatSignature =
-              _ecm.Component<components::SourceFilePath>(_entity);
-            auto tempRange =
-               _ecm.Component<components::TemperatureRange>(_entity);
-            if (heatSignature && tempRange)
-            {
-              this->entityTemp[_entity] =
-                std::make_tuple<float, float, std::string>(
-                    tempRange->Data().min.Kelvin(),
-                    tempRange->Data().max.Kelvin(),
-                    std::string(heatSignature->Data()));
-            }
-          }
+          this->UpdateVisualTemperature(_ecm, _entity);
 
           this->newVisuals.push_back(
               std::make_tuple(_entity, visual, _parent->Data()));
@@ -1441,30 +1565,7 @@ void RenderUtilPrivate::CreateRenderingEntities(
             visual.SetLaserRetro(laserRetro->Data());
           }
 
-          if (auto temp = _ecm.Component<components::Temperature>(_entity))
-          {
-            // get the uniform temperature for the entity
-            this->entityTemp[_entity] =
-              std::make_tuple<float, float, std::string>(
-                  temp->Data().Kelvin(), 0.0, "");
-          }
-          else
-          {
-            // entity doesn't have a uniform temperature. Check if it has
-            // a heat signature with an associated temperature range
-            auto heatSignature =
-              _ecm.Component<components::SourceFilePath>(_entity);
-            auto tempRange =
-               _ecm.Component<components::TemperatureRange>(_entity);
-            if (heatSignature && tempRange)
-            {
-              this->entityTemp[_entity] =
-                std::make_tuple<float, float, std::string>(
-                    tempRange->Data().min.Kelvin(),
-                    tempRange->Data().max.Kelvin(),
-                    std::string(heatSignature->Data()));
-            }
-          }
+          this->UpdateVisualTemperature(_ecm, _entity);
 
           this->newVisuals.push_back(
               std::make_tuple(_entity, visual, _parent->Data()));
@@ -1506,7 +1607,19 @@ void RenderUtilPrivate::CreateRenderingEntities(
             const components::ParentEntity *_parent) -> bool
         {
           this->entityCollisions[_entity] = _collElement->Data();
-          this->linkToCollisionEntities[_parent->Data()].push_back(_entity);
+          auto &siblings = this->linkToCollisionEntities[_parent->Data()];
+
+          // Show collisions added to a link whose collisions are shown
+          for (const auto &sibling : siblings)
+          {
+            auto viewIt = this->viewingCollisions.find(sibling);
+            if (viewIt != this->viewingCollisions.end() && viewIt->second)
+            {
+              this->newCollisions.push_back(_parent->Data());
+              break;
+            }
+          }
+          siblings.push_back(_entity);
           return true;
         });
 
@@ -1586,35 +1699,53 @@ void RenderUtilPrivate::UpdateRenderingEntities(
     const EntityComponentManager &_ecm)
 {
   IGN_PROFILE("RenderUtilPrivate::UpdateRenderingEntities");
-  _ecm.Each<components::Model, components::Pose>(
-      [&](const Entity &_entity,
-        const components::Model *,
-        const components::Pose *_pose)->bool
+
+  // Types of the entities which are rendered. Actors are handled below.
+  static const std::set<ComponentTypeId> renderedTypes{
+      components::Model::typeId, components::Link::typeId,
+      components::Visual::typeId, components::Light::typeId,
+      components::Camera::typeId, components::DepthCamera::typeId,
+      components::RgbdCamera::typeId, components::GpuLidar::typeId,
+      components::ThermalCamera::typeId};
+
+  // Poses which changed since the previous update, including those of new
+  // entities. Systems mark the poses they move with SetChanged.
+  _ecm.EachChanged<components::Pose>(this->poseToken,
+      [&](const Entity &_entity, const components::Pose *_pose)->bool
       {
-        this->entityPoses[_entity] = _pose->Data();
+        for (const auto &typeId : renderedTypes)
+        {
+          if (_ecm.EntityHasComponentType(_entity, typeId))
+          {
+            this->entityPoses[_entity] = _pose->Data();
+            break;
+          }
+        }
         return true;
       });
 
-  _ecm.Each<components::Link, components::Pose>(
-      [&](const Entity &_entity,
-        const components::Link *,
-        const components::Pose *_pose)->bool
+  // Temperatures of visuals which changed since the previous update.
+  // Visuals have either a uniform temperature or a heat signature with a
+  // range.
+  uint64_t rangeToken = this->temperatureToken;
+  _ecm.EachChanged<components::Temperature, components::Visual>(
+      this->temperatureToken,
+      [&](const Entity &_entity, const components::Temperature *,
+          const components::Visual *)->bool
       {
-        this->entityPoses[_entity] = _pose->Data();
+        this->UpdateVisualTemperature(_ecm, _entity);
         return true;
       });
-
-  // visuals
-  _ecm.Each<components::Visual, components::Pose >(
-      [&](const Entity &_entity,
-        const components::Visual *,
-        const components::Pose *_pose)->bool
+  _ecm.EachChanged<components::TemperatureRange, components::Visual>(
+      rangeToken,
+      [&](const Entity &_entity, const components::TemperatureRange *,
+          const components::Visual *)->bool
       {
-        this->entityPoses[_entity] = _pose->Data();
+        this->UpdateVisualTemperature(_ecm, _entity);
         return true;
       });
 
-  // actors
+  // actors, which are animated on every update
   _ecm.Each<components::Actor, components::Pose>(
       [&](const Entity &_entity,
         const components::Actor *,
@@ -1644,7 +1775,7 @@ void RenderUtilPrivate::UpdateRenderingEntities(
           }
         }
         // Bone poses calculated by ign-common
-        else if (this->actorManualSkeletonUpdate)
+        else if (this->actorManualSkeletonUpdate && this->actorSkinning)
         {
           this->actorTransforms[_entity] =
               this->sceneManager.ActorSkeletonTransformsAt(
@@ -1668,66 +1799,42 @@ void RenderUtilPrivate::UpdateRenderingEntities(
           this->trajectoryPoses[_entity] = trajPoseComp->Data();
         return true;
       });
+}
 
-  // update lights
-  _ecm.Each<components::Light, components::Pose>(
-      [&](const Entity &_entity,
-        const components::Light *,
-        const components::Pose *_pose)->bool
-      {
-        this->entityPoses[_entity] = _pose->Data();
-        return true;
-      });
-
-  // Update cameras
-  _ecm.Each<components::Camera, components::Pose>(
-      [&](const Entity &_entity,
-        const components::Camera *,
-        const components::Pose *_pose)->bool
-      {
-        this->entityPoses[_entity] = _pose->Data();
-        return true;
-      });
-
-  // Update depth cameras
-  _ecm.Each<components::DepthCamera, components::Pose>(
-      [&](const Entity &_entity,
-        const components::DepthCamera *,
-        const components::Pose *_pose)->bool
-      {
-        this->entityPoses[_entity] = _pose->Data();
-        return true;
-      });
-
-  // Update RGBD cameras
-  _ecm.Each<components::RgbdCamera, components::Pose>(
-      [&](const Entity &_entity,
-        const components::RgbdCamera *,
-        const components::Pose *_pose)->bool
-      {
-        this->entityPoses[_entity] = _pose->Data();
-        return true;
-      });
+//////////////////////////////////////////////////
+void RenderUtilPrivate::UpdateVisualTemperature(
+    const EntityComponentManager &_ecm, Entity _entity)
+{
+  std::tuple<float, float, std::string> temperature;
+  if (auto temp = _ecm.Component<components::Temperature>(_entity))
+  {
+    // get the uniform temperature for the entity
+    temperature = std::make_tuple<float, float, std::string>(
+        temp->Data().Kelvin(), 0.0, "");
+  }
+  else
+  {
+    // entity doesn't have a uniform temperature. Check if it has
+    // a heat signature with an associated temperature range
+    auto heatSignature =
+      _ecm.Component<components::SourceFilePath>(_entity);
+    auto tempRange =
+       _ecm.Component<components::TemperatureRange>(_entity);
+    if (!heatSignature || !tempRange)
+      return;
+
+    temperature = std::make_tuple<float, float, std::string>(
+        tempRange->Data().min.Kelvin(),
+        tempRange->Data().max.Kelvin(),
+        std::string(heatSignature->Data()));
+  }
 
-  // Update gpu_lidar
-  _ecm.Each<components::GpuLidar, components::Pose>(
-      [&](const Entity &_entity,
-        const components::GpuLidar *,
-        const components::Pose *_pose)->bool
-      {
-        this->entityPoses[_entity] = _pose->Data();
-        return true;
-      });
+  auto it = this->visualTemps.find(_entity);
+  if (it != this->visualTemps.end() && it->second == temperature)
+    return;
 
-  // Update thermal cameras
-  _ecm.Each<components::ThermalCamera, components::Pose>(
-      [&](const Entity &_entity,
-        const components::ThermalCamera *,
-        const components::Pose *_pose)->bool
-      {
-        this->entityPoses[_entity] = _pose->Data();
-        return true;
-      });
+  this->visualTemps[_entity] = temperature;
+  this->entityTemp[_entity] = std::move(temperature);
 }
 
 //////////////////////////////////////////////////
@@ -1756,6 +1863,7 @@ void RenderUtilPrivate::RemoveRenderingEntities(
       [&](const Entity &_entity, const components::Visual *)->bool
       {
         this->removeEntities[_entity] = _info.iterations;
+        this->visualTemps.erase(_entity);
         return true;
       });
 
@@ -1944,6 +2052,12 @@ void RenderUtil::SetSkyEnabled(bool _enabled)
   this->dataPtr->skyEnabled = _enabled;
 }
 
+/////////////////////////////////////////////////
+void RenderUtil::SetActorSkinningEnabled(bool _enabled)
+{
+  this->dataPtr->actorSkinning = _enabled;
+}
+
 /////////////////////////////////////////////////
 void RenderUtil::SetUseCurrentGLContext(bool _enable)
 {
@@ -2129,7 +2243,8 @@ void RenderUtil::ViewCollisions(const Entity &_entity)
   // create and/or toggle collision visuals
 
   bool showCol, showColInit = false;
-  // first loop looks for new collisions
+  // first loop looks for new collisions, which are all created at once on
+  // the next update
   for (const auto &colEntity : colEntities)
   {
     if (this->dataPtr->viewingCollisions.find(colEntity) ==
@@ -2137,6 +2252,7 @@ void RenderUtil::ViewCollisions(const Entity &_entity)
     {
       this->dataPtr->newCollisions.push_back(_entity);
       showColInit = showCol = true;
+      break;
     }
   }
 
@@ -16,7 +16,12 @@
  */
 
 
+#include <algorithm>
 #include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
 
 #include <sdf/Box.hh>
 #include <sdf/Capsule.hh>
@@ -34,10 +39,14 @@
 #include <ignition/common/HeightmapData.hh>
 #include <ignition/common/ImageHeightmap.hh>
 #include <ignition/common/KeyFrame.hh>
+#include <ignition/common/Mesh.hh>
 #include <ignition/common/MeshManager.hh>
+#include <ignition/common/Profiler.hh>
 #include <ignition/common/Skeleton.hh>
 #include <ignition/common/SkeletonAnimation.hh>
 
+#include <ignition/math/Vector2.hh>
+
 #include <ignition/msgs/Utility.hh>
 
 #include "ignition/rendering/Capsule.hh"
@@ -49,6 +58,7 @@
 #include <ignition/rendering/Material.hh>
 #include <ignition/rendering/ParticleEmitter.hh>
 #include <ignition/rendering/Scene.hh>
+#include <ignition/rendering/Sensor.hh>
 #include <ignition/rendering/Visual.hh>
 
 #include "ignition/gazebo/Conversions.hh"
@@ -95,6 +105,35 @@ class ignition::gazebo::SceneManagerPrivate
   /// \brief Map of sensor entity in Gazebo to sensor pointers.
   public: std::map<Entity, rendering::SensorPtr> sensors;
 
+  /// \brief True if visuals share materials, see
+  /// SceneManager::SetShareMaterials.
+  public: bool shareMaterials{false};
+
+  /// \brief Culling size, see SceneManager::SetCullingSize.
+  public: double cullingSize{0.0};
+
+  /// \brief Radius of the bounding sphere of each visual which can be
+  /// culled, in its visual's frame.
+  public: std::map<Entity, double> visualRadii;
+
+  /// \brief Visibility flags of the visuals which are currently culled.
+  public: std::map<Entity, uint32_t> culledVisuals;
+
+  /// \brief Restore the visibility flags of all culled visuals.
+  public: void RestoreCulledVisuals();
+
+  /// \brief Materials shared by visuals, keyed by their description.
+  public: std::map<std::string, rendering::MaterialPtr> sharedMaterials;
+
+  /// \brief Get the material shared by all visuals with the given
+  /// description, creating it the first time.
+  /// \param[in] _key Description of the material.
+  /// \param[in] _material Material which is copied if the shared material
+  /// doesn't exist yet.
+  /// \return The shared material.
+  public: rendering::MaterialPtr SharedMaterial(const std::string &_key,
+      const rendering::MaterialPtr &_material);
+
   /// \brief Helper function to compute actor trajectory at specified tiime
   /// \param[in] _id Actor entity's unique id
   /// \param[in] _time Simulation time
@@ -105,6 +144,48 @@ class ignition::gazebo::SceneManagerPrivate
 };
 
 
+/////////////////////////////////////////////////
+/// \brief Get the radius of the bounding sphere of a geometry, centered on
+/// the geometry's origin.
+/// \param[in] _geom Geometry.
+/// \return Radius, or nullopt for geometries which are unbounded, or
+/// whose size is unknown.
+static std::optional<double> boundingRadius(const sdf::Geometry &_geom)
+{
+  switch (_geom.Type())
+  {
+    case sdf::GeometryType::BOX:
+      return _geom.BoxShape()->Size().Length() * 0.5;
+    case sdf::GeometryType::CAPSULE:
+      return _geom.CapsuleShape()->Radius() +
+          _geom.CapsuleShape()->Length() * 0.5;
+    case sdf::GeometryType::CYLINDER:
+      return math::Vector2d(_geom.CylinderShape()->Radius(),
+          _geom.CylinderShape()->Length() * 0.5).Length();
+    case sdf::GeometryType::ELLIPSOID:
+      return _geom.EllipsoidShape()->Radii().Max();
+    case sdf::GeometryType::SPHERE:
+      return _geom.SphereShape()->Radius();
+    case sdf::GeometryType::MESH:
+    {
+      // Meshes are cached, so this doesn't load them again
+      auto fullPath = findResource(_geom.MeshShape()->Uri(),
+          _geom.MeshShape()->FilePath());
+      if (fullPath.empty())
+        return std::nullopt;
+      auto mesh = common::MeshManager::Instance()->Load(fullPath);
+      if (nullptr == mesh)
+        return std::nullopt;
+      auto scale = _geom.MeshShape()->Scale();
+      auto extent = mesh->Max().Abs();
+      extent.Max(mesh->Min().Abs());
+      return (extent * scale.Abs()).Length();
+    }
+    default:
+      return std::nullopt;
+  }
+}
+
 /////////////////////////////////////////////////
 SceneManager::SceneManager()
   : dataPtr(std::make_unique<SceneManagerPrivate>())
@@ -118,6 +199,7 @@ SceneManager::~SceneManager() = default;
 void SceneManager::SetScene(rendering::ScenePtr _scene)
 {
   this->dataPtr->scene = std::move(_scene);
+  this->dataPtr->sharedMaterials.clear();
 }
 
 /////////////////////////////////////////////////
@@ -138,6 +220,18 @@ Entity SceneManager::WorldId() const
   return this->dataPtr->worldId;
 }
 
+/////////////////////////////////////////////////
+void SceneManager::SetShareMaterials(bool _share)
+{
+  this->dataPtr->shareMaterials = _share;
+}
+
+/////////////////////////////////////////////////
+bool SceneManager::ShareMaterials() const
+{
+  return this->dataPtr->shareMaterials;
+}
+
 /////////////////////////////////////////////////
 rendering::VisualPtr SceneManager::CreateModel(Entity _id,
     const sdf::Model &_model, Entity _parentId)
@@ -348,6 +442,20 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
               (1.0 - submeshMat->Transparency());
           submeshMat->SetTransparency(1 - productAlpha);
           submeshMat->SetCastShadows(_visual.CastShadows());
+
+          // Submeshes of the same mesh file start with the same material
+          if (this->dataPtr->shareMaterials)
+          {
+            std::stringstream key;
+            key << "mesh:"
+                << asFullPath(_visual.Geom()->MeshShape()->Uri(),
+                   _visual.Geom()->MeshShape()->FilePath())
+                << ":" << _visual.Geom()->MeshShape()->Submesh() << ":" << i
+                << ":" << _visual.Transparency() << ":"
+                << _visual.CastShadows();
+            submesh->SetMaterial(
+                this->dataPtr->SharedMaterial(key.str(), submeshMat), false);
+          }
         }
       }
     }
@@ -360,7 +468,27 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
       // cast shadows
       material->SetCastShadows(_visual.CastShadows());
 
-      geom->SetMaterial(material);
+      if (this->dataPtr->shareMaterials)
+      {
+        std::stringstream key;
+        if (_visual.Material())
+        {
+          key << "sdf:" << _visual.Material()->FilePath() << ":"
+              << convert<msgs::Material>(*_visual.Material())
+                 .SerializeAsString();
+        }
+        else
+        {
+          key << "default:";
+        }
+        key << ":" << _visual.Transparency() << ":" << _visual.CastShadows();
+        geom->SetMaterial(
+            this->dataPtr->SharedMaterial(key.str(), material), false);
+      }
+      else
+      {
+        geom->SetMaterial(material);
+      }
       // todo(anyone) SetMaterial function clones the input material.
       // but does not take ownership of it so we need to destroy it here.
       // This is not ideal. We should let ign-rendering handle the lifetime
@@ -377,6 +505,12 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
   // visibility flags
   visualVis->SetVisibilityFlags(_visual.VisibilityFlags());
 
+  // Visuals are culled around their origin, which the geometry's bounding
+  // sphere is centered on
+  auto radius = boundingRadius(*_visual.Geom());
+  if (radius)
+    this->dataPtr->visualRadii[_id] = *radius;
+
   this->dataPtr->visuals[_id] = visualVis;
   if (parent)
     parent->AddChild(visualVis);
@@ -384,6 +518,20 @@ rendering::VisualPtr SceneManager::CreateVisual(Entity _id,
   return visualVis;
 }
 
+/////////////////////////////////////////////////
+rendering::MaterialPtr SceneManagerPrivate::SharedMaterial(
+    const std::string &_key, const rendering::MaterialPtr &_material)
+{
+  auto it = this->sharedMaterials.find(_key);
+  if (it != this->sharedMaterials.end())
+    return it->second;
+
+  // A copy, since the given material is owned by the caller
+  auto material = _material->Clone();
+  this->sharedMaterials[_key] = material;
+  return material;
+}
+
 /////////////////////////////////////////////////
 rendering::VisualPtr SceneManager::VisualById(Entity _id)
 {
@@ -471,11 +619,17 @@ rendering::GeometryPtr SceneManager::LoadGeometry(const sdf::Geometry &_geom,
   }
   else if (_geom.Type() == sdf::GeometryType::MESH)
   {
-    auto fullPath = asFullPath(_geom.MeshShape()->Uri(),
+    if (_geom.MeshShape()->Uri().empty())
+    {
+      ignerr << "Mesh geometry missing uri" << std::endl;
+      return geom;
+    }
+    auto fullPath = findResource(_geom.MeshShape()->Uri(),
         _geom.MeshShape()->FilePath());
     if (fullPath.empty())
     {
-      ignerr << "Mesh geometry missing uri" << std::endl;
+      ignerr << "Unable to find mesh [" << _geom.MeshShape()->Uri() << "]"
+             << std::endl;
       return geom;
     }
     rendering::MeshDescriptor descriptor;
@@ -583,8 +737,8 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
       std::string roughnessMap = metal->RoughnessMap();
       if (!roughnessMap.empty())
       {
-        std::string fullPath = common::findFile(
-            asFullPath(roughnessMap, _material.FilePath()));
+        std::string fullPath = findResource(roughnessMap,
+            _material.FilePath());
         if (!fullPath.empty())
           material->SetRoughnessMap(fullPath);
         else
@@ -595,8 +749,8 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
       std::string metalnessMap = metal->MetalnessMap();
       if (!metalnessMap.empty())
       {
-        std::string fullPath = common::findFile(
-            asFullPath(metalnessMap, _material.FilePath()));
+        std::string fullPath = findResource(metalnessMap,
+            _material.FilePath());
         if (!fullPath.empty())
           material->SetMetalnessMap(fullPath);
         else
@@ -614,8 +768,8 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
     std::string albedoMap = workflow->AlbedoMap();
     if (!albedoMap.empty())
     {
-      std::string fullPath = common::findFile(
-          asFullPath(albedoMap, _material.FilePath()));
+      std::string fullPath = findResource(albedoMap,
+          _material.FilePath());
       if (!fullPath.empty())
       {
         material->SetTexture(fullPath);
@@ -630,8 +784,8 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
     std::string normalMap = workflow->NormalMap();
     if (!normalMap.empty())
     {
-      std::string fullPath = common::findFile(
-          asFullPath(normalMap, _material.FilePath()));
+      std::string fullPath = findResource(normalMap,
+          _material.FilePath());
       if (!fullPath.empty())
         material->SetNormalMap(fullPath);
       else
@@ -643,8 +797,8 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
     std::string environmentMap = workflow->EnvironmentMap();
     if (!environmentMap.empty())
     {
-      std::string fullPath = common::findFile(
-          asFullPath(environmentMap, _material.FilePath()));
+      std::string fullPath = findResource(environmentMap,
+          _material.FilePath());
       if (!fullPath.empty())
         material->SetEnvironmentMap(fullPath);
       else
@@ -655,8 +809,8 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
     std::string emissiveMap = workflow->EmissiveMap();
     if (!emissiveMap.empty())
     {
-      std::string fullPath = common::findFile(
-          asFullPath(emissiveMap, _material.FilePath()));
+      std::string fullPath = findResource(emissiveMap,
+          _material.FilePath());
       if (!fullPath.empty())
         material->SetEmissiveMap(fullPath);
       else
@@ -667,8 +821,8 @@ rendering::MaterialPtr SceneManager::LoadMaterial(
     std::string lightMap = workflow->LightMap();
     if (!lightMap.empty())
     {
-      std::string fullPath = common::findFile(
-          asFullPath(lightMap, _material.FilePath()));
+      std::string fullPath = findResource(lightMap,
+          _material.FilePath());
       if (!fullPath.empty())
       {
         unsigned int uvSet = workflow->LightMapTexCoordSet();
@@ -980,6 +1134,10 @@ rendering::VisualPtr SceneManager::CreateActor(Entity _id,
   this->dataPtr->visuals[_id] = actorVisual;
   this->dataPtr->actors[_id] = actorMesh;
 
+  // Actors are culled like visuals, with a sphere around their origin which
+  // contains the skin in its bind pose
+  this->dataPtr->visualRadii[_id] = std::max(
+      descriptor.mesh->Min().Length(), descriptor.mesh->Max().Length());
 
   if (parent)
     parent->AddChild(actorVisual);
@@ -1587,6 +1745,8 @@ void SceneManager::RemoveEntity(Entity _id)
     {
       this->dataPtr->scene->DestroyVisual(it->second);
       this->dataPtr->visuals.erase(it);
+      this->dataPtr->visualRadii.erase(_id);
+      this->dataPtr->culledVisuals.erase(_id);
       return;
     }
   }
@@ -1623,6 +1783,96 @@ void SceneManager::RemoveEntity(Entity _id)
   }
 }
 
+/////////////////////////////////////////////////
+void SceneManager::SetCullingSize(double _size)
+{
+  this->dataPtr->cullingSize = std::max(0.0, _size);
+}
+
+/////////////////////////////////////////////////
+double SceneManager::CullingSize() const
+{
+  return this->dataPtr->cullingSize;
+}
+
+/////////////////////////////////////////////////
+void SceneManager::UpdateCulling(
+    const std::vector<math::Vector3d> &_viewpoints)
+{
+  if (this->dataPtr->cullingSize <= 0.0 || _viewpoints.empty())
+  {
+    this->dataPtr->RestoreCulledVisuals();
+    return;
+  }
+
+  IGN_PROFILE("SceneManager::UpdateCulling");
+  for (const auto &[entity, radius] : this->dataPtr->visualRadii)
+  {
+    auto visIt = this->dataPtr->visuals.find(entity);
+    if (visIt == this->dataPtr->visuals.end())
+      continue;
+    const auto &vis = visIt->second;
+
+    // Visible if it's large enough from any of the viewpoints
+    auto position = vis->WorldPosition();
+    auto worldRadius = radius * vis->WorldScale().Max();
+    bool visible{false};
+    for (const auto &viewpoint : _viewpoints)
+    {
+      if (worldRadius >=
+          this->dataPtr->cullingSize * position.Distance(viewpoint))
+      {
+        visible = true;
+        break;
+      }
+    }
+
+    auto culledIt = this->dataPtr->culledVisuals.find(entity);
+    if (!visible && culledIt == this->dataPtr->culledVisuals.end())
+    {
+      this->dataPtr->culledVisuals[entity] = vis->VisibilityFlags();
+      vis->SetVisibilityFlags(0u);
+    }
+    else if (visible && culledIt != this->dataPtr->culledVisuals.end())
+    {
+      vis->SetVisibilityFlags(culledIt->second);
+      this->dataPtr->culledVisuals.erase(culledIt);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void SceneManager::UpdateCulling()
+{
+  std::vector<math::Vector3d> viewpoints;
+  viewpoints.reserve(this->dataPtr->sensors.size());
+  for (const auto &sensor : this->dataPtr->sensors)
+  {
+    if (sensor.second)
+      viewpoints.push_back(sensor.second->WorldPosition());
+  }
+  this->UpdateCulling(viewpoints);
+}
+
+/////////////////////////////////////////////////
+bool SceneManager::Culled(Entity _id) const
+{
+  return this->dataPtr->culledVisuals.find(_id) !=
+      this->dataPtr->culledVisuals.end();
+}
+
+/////////////////////////////////////////////////
+void SceneManagerPrivate::RestoreCulledVisuals()
+{
+  for (const auto &[entity, flags] : this->culledVisuals)
+  {
+    auto visIt = this->visuals.find(entity);
+    if (visIt != this->visuals.end())
+      visIt->second->SetVisibilityFlags(flags);
+  }
+  this->culledVisuals.clear();
+}
+
 /////////////////////////////////////////////////
 rendering::VisualPtr SceneManager::TopLevelVisual(
     const rendering::VisualPtr &_visual) const
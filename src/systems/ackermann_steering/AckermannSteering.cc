@@ -20,7 +20,9 @@
 #include <ignition/msgs/odometry.pb.h>
 
 #include <limits>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -30,15 +32,18 @@
 #include <ignition/math/Angle.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/transport/Node.hh>
+#include <ignition/transport/TopicUtils.hh>
 
 #include "ignition/gazebo/components/CanonicalLink.hh"
 #include "ignition/gazebo/components/JointPosition.hh"
 #include "ignition/gazebo/components/JointVelocityCmd.hh"
+#include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/Link.hh"
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/Util.hh"
 
 #include "SpeedLimiter.hh"
+#include "../../OdometryAggregator.hh"
 
 using namespace ignition;
 using namespace gazebo;
@@ -58,6 +63,9 @@ struct Commands
 
 class ignition::gazebo::systems::AckermannSteeringPrivate
 {
+  /// \brief Destructor, leaves the aggregated odometry
+  public: ~AckermannSteeringPrivate();
+
   /// \brief Callback for velocity subscription
   /// \param[in] _msg Velocity message
   public: void OnCmdVel(const ignition::msgs::Twist &_msg);
@@ -186,8 +194,29 @@ class ignition::gazebo::systems::AckermannSteeringPrivate
 
   /// \brief child_frame_id from sdf.
   public: std::string sdfChildFrameId;
+
+  /// \brief Resolved frame_id, computed once on configure.
+  public: std::string frameId;
+
+  /// \brief Resolved child_frame_id, computed once on configure. Empty if
+  /// the model has no canonical link and none was given.
+  public: std::string childFrameId;
+
+  /// \brief Aggregated odometry this vehicle is part of, null if odometry
+  /// is published on the vehicle's own topic.
+  public: std::shared_ptr<OdometryAggregator> odomAggregator;
+
+  /// \brief Slot of this vehicle in the aggregated odometry.
+  public: std::size_t odomSlot{0};
 };
 
+//////////////////////////////////////////////////
+AckermannSteeringPrivate::~AckermannSteeringPrivate()
+{
+  if (this->odomAggregator)
+    this->odomAggregator->Remove(this->odomSlot);
+}
+
 //////////////////////////////////////////////////
 AckermannSteering::AckermannSteering()
   : dataPtr(std::make_unique<AckermannSteeringPrivate>())
@@ -335,30 +364,74 @@ void AckermannSteering::Configure(const Entity &_entity,
   this->dataPtr->node.Subscribe(topic, &AckermannSteeringPrivate::OnCmdVel,
       this->dataPtr.get());
 
-  std::vector<std::string> odomTopics;
-  if (_sdf->HasElement("odom_topic"))
-  {
-    odomTopics.push_back(_sdf->Get<std::string>("odom_topic"));
-  }
-  odomTopics.push_back("/model/" + this->dataPtr->model.Name(_ecm) +
-      "/odometry");
-  auto odomTopic = validTopic(odomTopics);
-  if (topic.empty())
-  {
-    ignerr << "AckermannSteering plugin received invalid model name "
-           << "Failed to initialize." << std::endl;
-    return;
-  }
-
-  this->dataPtr->odomPub = this->dataPtr->node.Advertise<msgs::Odometry>(
-      odomTopic);
-
   if (_sdf->HasElement("frame_id"))
     this->dataPtr->sdfFrameId = _sdf->Get<std::string>("frame_id");
 
   if (_sdf->HasElement("child_frame_id"))
     this->dataPtr->sdfChildFrameId = _sdf->Get<std::string>("child_frame_id");
 
+  // Resolve the frame ids once, they don't change afterwards
+  auto modelName = this->dataPtr->model.Name(_ecm);
+  this->dataPtr->frameId = this->dataPtr->sdfFrameId.empty() ?
+      modelName + "/odom" : this->dataPtr->sdfFrameId;
+  if (!this->dataPtr->sdfChildFrameId.empty())
+  {
+    this->dataPtr->childFrameId = this->dataPtr->sdfChildFrameId;
+  }
+  else
+  {
+    std::optional<std::string> linkName =
+        this->dataPtr->canonicalLink.Name(_ecm);
+    if (linkName)
+      this->dataPtr->childFrameId = modelName + "/" + *linkName;
+  }
+
+  // Aggregate with all other wheeled vehicles on the same topic and rate,
+  // including those driven by DiffDrive
+  if (_sdf->Get<bool>("aggregate_odometry", false).first)
+  {
+    auto world = worldEntity(_entity, _ecm);
+    auto worldName = _ecm.Component<components::Name>(world);
+    std::string defaultTopic = "/world/" +
+        (worldName ? worldName->Data() : std::string("default")) +
+        "/odometry_aggregate";
+    auto aggregateTopic = transport::TopicUtils::AsValidTopic(
+        _sdf->Get<std::string>("aggregate_odometry_topic",
+        defaultTopic).first);
+    if (aggregateTopic.empty())
+    {
+      ignerr << "Invalid aggregate odometry topic, odometry won't be "
+             << "published." << std::endl;
+    }
+    else
+    {
+      this->dataPtr->odomAggregator =
+          OdometryAggregator::Get(_ecm, aggregateTopic,
+          this->dataPtr->odomPubPeriod);
+      this->dataPtr->odomSlot = this->dataPtr->odomAggregator->Add(
+          this->dataPtr->frameId, this->dataPtr->childFrameId);
+    }
+  }
+  else
+  {
+    std::vector<std::string> odomTopics;
+    if (_sdf->HasElement("odom_topic"))
+    {
+      odomTopics.push_back(_sdf->Get<std::string>("odom_topic"));
+    }
+    odomTopics.push_back("/model/" + modelName + "/odometry");
+    auto odomTopic = validTopic(odomTopics);
+    if (odomTopic.empty())
+    {
+      ignerr << "AckermannSteering plugin received invalid model name "
+             << "Failed to initialize." << std::endl;
+      return;
+    }
+
+    this->dataPtr->odomPub = this->dataPtr->node.Advertise<msgs::Odometry>(
+        odomTopic);
+  }
+
   ignmsg << "AckermannSteering subscribing to twist messages on [" <<
       topic << "]" << std::endl;
 }
@@ -624,6 +697,14 @@ void AckermannSteeringPrivate::UpdateOdometry(
   this->odomOldLeft = leftPos->Data()[0];
   this->odomOldRight = rightPos->Data()[0];
 
+  // The aggregator throttles and publishes for all vehicles
+  if (this->odomAggregator)
+  {
+    this->odomAggregator->Set(_info, this->odomSlot, this->odomX,
+        this->odomY, this->odomYaw);
+    return;
+  }
+
   // Throttle odometry publishing
   auto diff = _info.simTime - this->lastOdomPubTime;
   if (diff > std::chrono::steady_clock::duration::zero() &&
@@ -648,33 +729,16 @@ void AckermannSteeringPrivate::UpdateOdometry(
   msg.mutable_header()->mutable_stamp()->CopyFrom(
       convert<msgs::Time>(_info.simTime));
 
-  // Set the frame id.
+  // Set the frame ids.
   auto frame = msg.mutable_header()->add_data();
   frame->set_key("frame_id");
-  if (this->sdfFrameId.empty())
-  {
-    frame->add_value(this->model.Name(_ecm) + "/odom");
-  }
-  else
-  {
-    frame->add_value(this->sdfFrameId);
-  }
+  frame->add_value(this->frameId);
 
-  std::optional<std::string> linkName = this->canonicalLink.Name(_ecm);
-  if (this->sdfChildFrameId.empty())
-  {
-    if (linkName)
-    {
-      auto childFrame = msg.mutable_header()->add_data();
-      childFrame->set_key("child_frame_id");
-      childFrame->add_value(this->model.Name(_ecm) + "/" + *linkName);
-    }
-  }
-  else
+  if (!this->childFrameId.empty())
   {
     auto childFrame = msg.mutable_header()->add_data();
     childFrame->set_key("child_frame_id");
-    childFrame->add_value(this->sdfChildFrameId);
+    childFrame->add_value(this->childFrameId);
   }
 
   // Publish the message
@@ -90,6 +90,18 @@ namespace systems
   /// messages. This element if optional, and the default value is
   /// `/model/{name_of_model}/odometry`.
   ///
+  /// `<aggregate_odometry>`: Set to true to publish this vehicle's odometry
+  /// packed with that of all other vehicles in the world that have the same
+  /// aggregate topic and `<odom_publish_frequency>`, including vehicles
+  /// driven by DiffDrive, instead of on `<odom_topic>`. The packed
+  /// `ignition.msgs.Pose_V` message holds one pose per vehicle, with the
+  /// frame ids in its header, and lags one iteration behind. Twist isn't
+  /// included. This element is optional, and the default value is false.
+  ///
+  /// `<aggregate_odometry_topic>`: Topic of the packed odometry message.
+  /// This element is optional, and the default value is
+  /// `/world/{name_of_world}/odometry_aggregate`.
+  ///
   /// A robot with rear drive and front steering would have one each
   /// of left_joint, right_joint, left_steering_joint and
   /// right_steering_joint
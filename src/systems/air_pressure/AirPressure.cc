@@ -62,7 +62,10 @@ class ignition::gazebo::systems::AirPressurePrivate
 
   /// \brief Update air pressure sensor data based on physics data
   /// \param[in] _ecm Immutable reference to ECM.
-  public: void UpdateAirPressures(const EntityComponentManager &_ecm);
+  /// \param[in] _now Current simulation time. Only the sensors which are
+  /// due are given data and updated.
+  public: void UpdateAirPressures(const EntityComponentManager &_ecm,
+      const std::chrono::steady_clock::duration &_now);
 
   /// \brief Remove air pressure sensors if their entities have been removed
   /// from simulation.
@@ -104,15 +107,10 @@ void AirPressure::PostUpdate(const UpdateInfo &_info,
 
   if (!_info.paused)
   {
-    this->dataPtr->UpdateAirPressures(_ecm);
-
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      // Update measurement time
-      auto time = math::durationToSecNsec(_info.simTime);
-      dynamic_cast<sensors::Sensor *>(it.second.get())->Update(
-          math::secNsecToDuration(time.first, time.second), false);
-    }
+    // Update measurement time
+    auto time = math::durationToSecNsec(_info.simTime);
+    this->dataPtr->UpdateAirPressures(_ecm,
+        math::secNsecToDuration(time.first, time.second));
   }
 
   this->dataPtr->RemoveAirPressureEntities(_ecm);
@@ -171,7 +169,8 @@ void AirPressurePrivate::CreateAirPressureEntities(EntityComponentManager &_ecm)
 }
 
 //////////////////////////////////////////////////
-void AirPressurePrivate::UpdateAirPressures(const EntityComponentManager &_ecm)
+void AirPressurePrivate::UpdateAirPressures(const EntityComponentManager &_ecm,
+    const std::chrono::steady_clock::duration &_now)
 {
   IGN_PROFILE("AirPressurePrivate::UpdateAirPressures");
   _ecm.Each<components::AirPressureSensor, components::WorldPose>(
@@ -182,8 +181,16 @@ void AirPressurePrivate::UpdateAirPressures(const EntityComponentManager &_ecm)
         auto it = this->entitySensorMap.find(_entity);
         if (it != this->entitySensorMap.end())
         {
+          // Sensors which aren't due don't need any data
+          if (it->second->NextDataUpdateTime() > _now)
+            return true;
+
           const math::Pose3d &worldPose = _worldPose->Data();
           it->second->SetPose(worldPose);
+
+          // The data and the update share a single pass over the sensors
+          static_cast<sensors::Sensor *>(it->second.get())->Update(
+              _now, false);
         }
         else
         {
@@ -64,7 +64,10 @@ class ignition::gazebo::systems::AltimeterPrivate
 
   /// \brief Update altimeter sensor data based on physics data
   /// \param[in] _ecm Immutable reference to ECM.
-  public: void UpdateAltimeters(const EntityComponentManager &_ecm);
+  /// \param[in] _now Current simulation time. Only the sensors which are
+  /// due are given data and updated.
+  public: void UpdateAltimeters(const EntityComponentManager &_ecm,
+      const std::chrono::steady_clock::duration &_now);
 
   /// \brief Remove altimeter sensors if their entities have been removed from
   /// simulation.
@@ -105,15 +108,10 @@ void Altimeter::PostUpdate(const UpdateInfo &_info,
   // Only update and publish if not paused.
   if (!_info.paused)
   {
-    this->dataPtr->UpdateAltimeters(_ecm);
-
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      // Update measurement time
-      auto time = math::durationToSecNsec(_info.simTime);
-      dynamic_cast<sensors::Sensor *>(it.second.get())->Update(
-          math::secNsecToDuration(time.first, time.second), false);
-    }
+    // Update measurement time
+    auto time = math::durationToSecNsec(_info.simTime);
+    this->dataPtr->UpdateAltimeters(_ecm,
+        math::secNsecToDuration(time.first, time.second));
   }
 
   this->dataPtr->RemoveAltimeterEntities(_ecm);
@@ -173,7 +171,8 @@ void AltimeterPrivate::CreateAltimeterEntities(EntityComponentManager &_ecm)
 }
 
 //////////////////////////////////////////////////
-void AltimeterPrivate::UpdateAltimeters(const EntityComponentManager &_ecm)
+void AltimeterPrivate::UpdateAltimeters(const EntityComponentManager &_ecm,
+    const std::chrono::steady_clock::duration &_now)
 {
   IGN_PROFILE("Altimeter::UpdateAltimeters");
   _ecm.Each<components::Altimeter, components::WorldPose,
@@ -186,10 +185,18 @@ void AltimeterPrivate::UpdateAltimeters(const EntityComponentManager &_ecm)
         auto it = this->entitySensorMap.find(_entity);
         if (it != this->entitySensorMap.end())
         {
+          // Sensors which aren't due don't need any data
+          if (it->second->NextDataUpdateTime() > _now)
+            return true;
+
           math::Vector3d linearVel;
           math::Pose3d worldPose = _worldPose->Data();
           it->second->SetPosition(worldPose.Pos().Z());
           it->second->SetVerticalVelocity(_worldLinearVel->Data().Z());
+
+          // The data and the update share a single pass over the sensors
+          static_cast<sensors::Sensor *>(it->second.get())->Update(
+              _now, false);
         }
         else
         {
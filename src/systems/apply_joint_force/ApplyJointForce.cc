@@ -27,6 +27,8 @@
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/Util.hh"
 
+#include "../../CommandMailbox.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
@@ -46,11 +48,9 @@ class ignition::gazebo::systems::ApplyJointForcePrivate
   /// \brief Joint name
   public: std::string jointName;
 
-  /// \brief Commanded joint force
-  public: double jointForceCmd;
-
-  /// \brief mutex to protect jointForceCmd
-  public: std::mutex jointForceCmdMutex;
+  /// \brief Commanded joint force, posted by the transport thread without
+  /// waiting for the simulation thread.
+  public: CommandMailbox<double> jointForceCmd{0.0};
 
   /// \brief Model interface
   public: Model model{kNullEntity};
@@ -142,25 +142,25 @@ void ApplyJointForce::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
   auto force = _ecm.Component<components::JointForceCmd>(
       this->dataPtr->jointEntity);
 
-  std::lock_guard<std::mutex> lock(this->dataPtr->jointForceCmdMutex);
+  this->dataPtr->jointForceCmd.Receive();
+  const double forceCmd = this->dataPtr->jointForceCmd.Latest();
 
   if (force == nullptr)
   {
     _ecm.CreateComponent(
         this->dataPtr->jointEntity,
-        components::JointForceCmd({this->dataPtr->jointForceCmd}));
+        components::JointForceCmd({forceCmd}));
   }
   else
   {
-    force->Data()[0] += this->dataPtr->jointForceCmd;
+    force->Data()[0] += forceCmd;
   }
 }
 
 //////////////////////////////////////////////////
 void ApplyJointForcePrivate::OnCmdForce(const msgs::Double &_msg)
 {
-  std::lock_guard<std::mutex> lock(this->jointForceCmdMutex);
-  this->jointForceCmd = _msg.data();
+  this->jointForceCmd.Post(_msg.data());
 }
 
 IGNITION_ADD_PLUGIN(ApplyJointForce,
@@ -22,8 +22,11 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cmath>
 #include <deque>
 #include <functional>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -61,6 +64,21 @@ class ignition::gazebo::systems::LinearBatteryPluginPrivate
   /// \return State of charge of the battery in range [0.0, 1.0].
   public: double StateOfCharge() const;
 
+  /// \brief Integrate the battery over the time accumulated since the last
+  /// integration, write the state of charge and schedule the next
+  /// integration.
+  /// \param[in] _ecm Entity component manager
+  /// \param[in] _simTime Sim time the integration reaches
+  public: void Integrate(EntityComponentManager &_ecm,
+      const std::chrono::steady_clock::duration &_simTime);
+
+  /// \brief Schedule the next integration at the update period, or earlier
+  /// if the state of charge is expected to change by the update threshold
+  /// or to deplete before that.
+  /// \param[in] _simTime Sim time of the last integration
+  public: void ScheduleIntegration(
+      const std::chrono::steady_clock::duration &_simTime);
+
   /// \brief Callback executed to start recharging.
   /// \param[in] _req This value should be true.
   public: void OnEnableRecharge(const ignition::msgs::Boolean &_req);
@@ -135,6 +153,26 @@ class ignition::gazebo::systems::LinearBatteryPluginPrivate
   /// \brief Simulation time handled during a single update.
   public: std::chrono::steady_clock::duration stepSize;
 
+  /// \brief Minimum time between integrations, calculated from
+  /// <soc_update_rate>. Zero to integrate every step.
+  public: std::chrono::steady_clock::duration updatePeriod{0};
+
+  /// \brief Change of state of charge that triggers an integration before
+  /// the update period has elapsed.
+  public: double updateThreshold{0.01};
+
+  /// \brief Simulation time accumulated since the last integration.
+  public: std::chrono::steady_clock::duration pendingTime{0};
+
+  /// \brief Sim time of the next scheduled integration.
+  public: std::chrono::steady_clock::duration nextIntegrationTime{0};
+
+  /// \brief Whether the battery drains over the time being integrated.
+  public: bool integrateDraining{false};
+
+  /// \brief Whether the battery charges over the time being integrated.
+  public: bool integrateCharging{false};
+
   /// \brief Flag on whether the battery should start draining
   public: bool startDraining = true;
 
@@ -248,6 +286,29 @@ void LinearBatteryPlugin::Configure(const Entity &_entity,
   if (_sdf->HasElement("fix_issue_225"))
     this->dataPtr->fixIssue225 = _sdf->Get<bool>("fix_issue_225");
 
+  if (_sdf->HasElement("soc_update_rate"))
+  {
+    auto rate = _sdf->Get<double>("soc_update_rate");
+    if (rate > 0 && !this->dataPtr->fixIssue225)
+    {
+      ignwarn << "<soc_update_rate> requires <fix_issue_225>, the battery "
+              << "will be updated every step." << std::endl;
+    }
+    else if (rate > 0)
+    {
+      std::chrono::duration<double> period{1 / rate};
+      this->dataPtr->updatePeriod =
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          period);
+    }
+  }
+
+  if (_sdf->HasElement("soc_update_threshold"))
+  {
+    this->dataPtr->updateThreshold =
+        _sdf->Get<double>("soc_update_threshold");
+  }
+
   if (_sdf->HasElement("battery_name") && _sdf->HasElement("voltage"))
   {
     auto batteryName = _sdf->Get<std::string>("battery_name");
@@ -379,6 +440,53 @@ double LinearBatteryPluginPrivate::StateOfCharge() const
   return this->soc;
 }
 
+/////////////////////////////////////////////////
+void LinearBatteryPluginPrivate::Integrate(EntityComponentManager &_ecm,
+    const std::chrono::steady_clock::duration &_simTime)
+{
+  if (!this->battery)
+    return;
+
+  this->stepSize = this->pendingTime;
+  this->pendingTime = std::chrono::steady_clock::duration::zero();
+  this->battery->Update();
+
+  // Only notify other systems, such as physics, when the value changed
+  if (_ecm.SetComponentData<components::BatterySoC>(this->batteryEntity,
+      this->StateOfCharge()))
+  {
+    _ecm.SetChanged(this->batteryEntity, components::BatterySoC::typeId,
+        ComponentState::PeriodicChange);
+  }
+
+  this->ScheduleIntegration(_simTime);
+}
+
+/////////////////////////////////////////////////
+void LinearBatteryPluginPrivate::ScheduleIntegration(
+    const std::chrono::steady_clock::duration &_simTime)
+{
+  if (this->updatePeriod == std::chrono::steady_clock::duration::zero())
+    return;
+
+  // Bound the state of charge rate with the larger of the raw and smoothed
+  // currents, so the estimate errs on the early side
+  double seconds = std::chrono::duration<double>(this->updatePeriod).count();
+  double current = std::max(std::abs(this->iraw), std::abs(this->ismooth));
+  if (current > 0)
+  {
+    double socPerSecond = current / (3600.0 * this->c);
+    if (this->updateThreshold > 0)
+      seconds = std::min(seconds, this->updateThreshold / socPerSecond);
+    if (this->integrateDraining && !this->integrateCharging && this->soc > 0)
+      seconds = std::min(seconds, this->soc / socPerSecond);
+  }
+
+  this->nextIntegrationTime = _simTime +
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(seconds));
+}
+
 //////////////////////////////////////////////////
 void LinearBatteryPluginPrivate::OnEnableRecharge(
   const ignition::msgs::Boolean &/*_req*/)
@@ -459,7 +567,21 @@ void LinearBatteryPlugin::Update(const UpdateInfo &_info,
   if (_info.paused)
     return;
 
-  if (!this->dataPtr->startDraining && !this->dataPtr->startCharging)
+  bool draining = this->dataPtr->startDraining;
+  bool charging = this->dataPtr->startCharging;
+
+  // Integrate the time accumulated so far before draining or charging start
+  // or stop, so it's integrated with the state it was accumulated in
+  if (this->dataPtr->pendingTime > std::chrono::steady_clock::duration::zero()
+      && (draining != this->dataPtr->integrateDraining ||
+      charging != this->dataPtr->integrateCharging))
+  {
+    this->dataPtr->Integrate(_ecm, _info.simTime - _info.dt);
+  }
+  this->dataPtr->integrateDraining = draining;
+  this->dataPtr->integrateCharging = charging;
+
+  if (!draining && !charging)
     return;
 
   // Find the time at which battery starts to drain
@@ -477,12 +599,9 @@ void LinearBatteryPlugin::Update(const UpdateInfo &_info,
       " minutes passed.\n";
   }
 
-  // Update actual battery
-  this->dataPtr->stepSize = _info.dt;
-
   // Sanity check: tau should be between [dt, +inf).
   double dt = (std::chrono::duration_cast<std::chrono::nanoseconds>(
-    this->dataPtr->stepSize).count()) * 1e-9;
+    _info.dt).count()) * 1e-9;
   if (this->dataPtr->tau < dt)
   {
     ignerr << "<smooth_current_tau> should be in the range [dt, +inf) but is "
@@ -491,16 +610,12 @@ void LinearBatteryPlugin::Update(const UpdateInfo &_info,
     this->dataPtr->tau = dt;
   }
 
-  if (this->dataPtr->battery)
-  {
-    this->dataPtr->battery->Update();
-
-    // Update component
-    auto *batteryComp =
-      _ecm.Component<components::BatterySoC>(this->dataPtr->batteryEntity);
+  // Update actual battery once the next integration is due
+  this->dataPtr->pendingTime += _info.dt;
+  if (_info.simTime < this->dataPtr->nextIntegrationTime)
+    return;
 
-    batteryComp->Data() = this->dataPtr->StateOfCharge();
-  }
+  this->dataPtr->Integrate(_ecm, _info.simTime);
 }
 
 //////////////////////////////////////////////////
@@ -543,9 +658,9 @@ double LinearBatteryPlugin::OnUpdateVoltage(
 {
   IGN_ASSERT(_battery != nullptr, "common::Battery is null.");
 
-  if (fabs(_battery->Voltage()) < 1e-3 && !this->dataPtr->startCharging)
+  if (fabs(_battery->Voltage()) < 1e-3 && !this->dataPtr->integrateCharging)
     return 0.0;
-  if (this->dataPtr->StateOfCharge() < 0 && !this->dataPtr->startCharging)
+  if (this->dataPtr->StateOfCharge() < 0 && !this->dataPtr->integrateCharging)
     return _battery->Voltage();
 
   auto prevSocInt = static_cast<int>(this->dataPtr->StateOfCharge() * 100);
@@ -556,7 +671,7 @@ double LinearBatteryPlugin::OnUpdateVoltage(
   double totalpower = 0.0;
   double k = dt / this->dataPtr->tau;
 
-  if (this->dataPtr->startDraining)
+  if (this->dataPtr->integrateDraining)
   {
     for (auto powerLoad : _battery->PowerLoads())
       totalpower += powerLoad.second;
@@ -568,26 +683,42 @@ double LinearBatteryPlugin::OnUpdateVoltage(
   auto iCharge = this->dataPtr->c / this->dataPtr->tCharge;
 
   // add charging current to battery
-  if (this->dataPtr->startCharging && this->dataPtr->StateOfCharge() < 0.9)
+  if (this->dataPtr->integrateCharging &&
+      this->dataPtr->StateOfCharge() < 0.9)
     this->dataPtr->iraw -= iCharge;
 
-  this->dataPtr->ismooth = this->dataPtr->ismooth + k *
-    (this->dataPtr->iraw - this->dataPtr->ismooth);
-
-  if (!this->dataPtr->fixIssue225)
+  if (this->dataPtr->updatePeriod > std::chrono::steady_clock::duration::zero())
+  {
+    // Integrate over long intervals with the exact solution of the current
+    // filter, assuming the raw current is constant over the interval
+    double alpha = std::exp(-dt / this->dataPtr->tau);
+    double ismooth0 = this->dataPtr->ismooth;
+    this->dataPtr->ismooth = this->dataPtr->iraw +
+      (ismooth0 - this->dataPtr->iraw) * alpha;
+    this->dataPtr->q = this->dataPtr->q - (this->dataPtr->iraw * dt +
+      (ismooth0 - this->dataPtr->iraw) * this->dataPtr->tau * (1 - alpha)) /
+      3600.0;
+  }
+  else
   {
-    if (this->dataPtr->iList.size() >= 100)
+    this->dataPtr->ismooth = this->dataPtr->ismooth + k *
+      (this->dataPtr->iraw - this->dataPtr->ismooth);
+
+    if (!this->dataPtr->fixIssue225)
     {
-      this->dataPtr->iList.pop_front();
-      this->dataPtr->dtList.pop_front();
+      if (this->dataPtr->iList.size() >= 100)
+      {
+        this->dataPtr->iList.pop_front();
+        this->dataPtr->dtList.pop_front();
+      }
+      this->dataPtr->iList.push_back(this->dataPtr->ismooth);
+      this->dataPtr->dtList.push_back(dt);
     }
-    this->dataPtr->iList.push_back(this->dataPtr->ismooth);
-    this->dataPtr->dtList.push_back(dt);
-  }
 
-  // Convert dt to hours
-  this->dataPtr->q = this->dataPtr->q - ((dt * this->dataPtr->ismooth) /
-    3600.0);
+    // Convert dt to hours
+    this->dataPtr->q = this->dataPtr->q - ((dt * this->dataPtr->ismooth) /
+      3600.0);
+  }
 
   // open circuit voltage
   double voltage = this->dataPtr->e0 + this->dataPtr->e1 * (
@@ -613,7 +744,7 @@ double LinearBatteryPlugin::OnUpdateVoltage(
     igndbg << "PowerLoads().size(): " << _battery->PowerLoads().size()
            << std::endl;
     igndbg << "charging status: " << std::boolalpha
-           << this->dataPtr->startCharging << std::endl;
+           << this->dataPtr->integrateCharging << std::endl;
     igndbg << "charging current: " << iCharge << std::endl;
     igndbg << "voltage: " << voltage << std::endl;
     igndbg << "state of charge: " << this->dataPtr->StateOfCharge()
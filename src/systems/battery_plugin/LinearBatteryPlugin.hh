@@ -58,6 +58,15 @@ namespace systems
   ///                 (Required if <enable_recharge> is set to true)
   /// <fix_issue_225> True to change the battery behavior to fix some issues
   /// described in https://github.com/ignitionrobotics/ign-gazebo/issues/225.
+  /// <soc_update_rate> Rate in Hz at which the battery is integrated and its
+  ///                   state of charge is written to the BatterySoC
+  ///                   component. The charge is integrated exactly over each
+  ///                   interval. Requires <fix_issue_225>. Defaults to 0,
+  ///                   which updates every step.
+  /// <soc_update_threshold> Change in state of charge that triggers an update
+  ///                        before the next one is due by rate. Updates are
+  ///                        also scheduled for when the battery is expected
+  ///                        to deplete. Defaults to 0.01.
   class LinearBatteryPlugin
       : public System,
         public ISystemConfigure,
@@ -41,6 +41,7 @@
 #include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/Performer.hh"
 #include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/PoseCmd.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/Util.hh"
 
@@ -168,9 +169,157 @@ void Breadcrumbs::Configure(const Entity &_entity,
 
   this->worldEntity = _ecm.EntityByComponents(components::World());
 
+  int poolSize = _sdf->Get<int>("pool_size", 0).first;
+  if (this->maxDeployments > 0)
+    poolSize = std::min(poolSize, this->maxDeployments);
+  if (poolSize > 0)
+  {
+    math::Pose3d parkingPose = _sdf->Get<math::Pose3d>("pool_parking_pose",
+        math::Pose3d(0, 0, -1000, 0, 0, 0)).first;
+    this->CreatePool(poolSize, parkingPose, _ecm);
+  }
+
   this->initialized = true;
 }
 
+//////////////////////////////////////////////////
+std::optional<std::string> Breadcrumbs::BreadcrumbName(
+    const std::string &_desiredName, const EntityComponentManager &_ecm) const
+{
+  std::vector<std::string> modelNames;
+  _ecm.Each<components::Name, components::Model>(
+      [&modelNames](const Entity &, const components::Name *_name,
+                    const components::Model *)
+      {
+        modelNames.push_back(_name->Data());
+        return true;
+      });
+
+  // Check if there's a model with the same name.
+  auto it = std::find(modelNames.begin(), modelNames.end(), _desiredName);
+  if (it == modelNames.end())
+    return _desiredName;
+
+  if (!this->allowRenaming)
+  {
+    ignwarn << "Entity named [" << _desiredName
+            << "] already exists and "
+            << "[allow_renaming] is false. Entity not spawned."
+            << std::endl;
+    return std::nullopt;
+  }
+
+  std::string newName = _desiredName;
+  int counter = 0;
+  while (std::find(modelNames.begin(), modelNames.end(), newName) !=
+         modelNames.end())
+  {
+    newName = _desiredName + "_" + std::to_string(++counter);
+  }
+  return newName;
+}
+
+//////////////////////////////////////////////////
+void Breadcrumbs::CreatePool(int _size, const math::Pose3d &_parkingPose,
+    EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("Breadcrumbs::CreatePool");
+
+  // Static anchor holding the pooled breadcrumbs in place, the same way
+  // MakeStatic holds breadcrumbs
+  const std::string &crumbName = this->modelRoot.Model()->Name();
+  sdf::ElementPtr anchorSDF(new sdf::Element);
+  sdf::initFile("model.sdf", anchorSDF);
+  anchorSDF->GetAttribute("name")->Set(
+      this->model.Name(_ecm) + "_" + crumbName + "__pool__");
+  anchorSDF->GetElement("static")->Set(true);
+  anchorSDF->AddElement("link")->GetAttribute("name")->Set("anchor_link");
+  sdf::Model anchorModel;
+  anchorModel.Load(anchorSDF);
+  anchorModel.SetRawPose(_parkingPose);
+
+  Entity anchor = this->creator->CreateEntities(&anchorModel);
+  this->creator->SetParent(anchor, this->worldEntity);
+  Entity anchorLink = _ecm.EntityByComponents(
+      components::Link(), components::ParentEntity(anchor),
+      components::Name("anchor_link"));
+  if (anchorLink == kNullEntity)
+  {
+    ignerr << "Failed to create the breadcrumb pool anchor." << std::endl;
+    return;
+  }
+
+  for (int i = 0; i < _size; ++i)
+  {
+    auto name = this->BreadcrumbName(crumbName + "_" + std::to_string(i),
+        _ecm);
+    if (!name)
+      break;
+
+    sdf::Model modelToSpawn = *this->modelRoot.Model();
+    modelToSpawn.SetName(*name);
+    modelToSpawn.SetRawPose(math::Pose3d(_parkingPose.Pos() +
+        _parkingPose.Rot().RotateVector(math::Vector3d(10.0 * (i + 1), 0, 0)),
+        _parkingPose.Rot()));
+
+    Entity entity = this->creator->CreateEntities(&modelToSpawn);
+    this->creator->SetParent(entity, this->worldEntity);
+
+    Entity childLink = _ecm.EntityByComponents(
+        components::CanonicalLink(), components::ParentEntity(entity));
+    if (childLink == kNullEntity)
+    {
+      ignerr << "Breadcrumb [" << *name << "] has no canonical link, it "
+             << "can't be pooled." << std::endl;
+      this->creator->RequestRemoveEntity(entity);
+      break;
+    }
+
+    Entity joint = _ecm.CreateEntity();
+    _ecm.CreateComponent(joint, components::DetachableJoint(
+        {anchorLink, childLink, "fixed"}));
+
+    this->pool.push_back(entity);
+    this->poolJoints[entity] = joint;
+  }
+
+  ignmsg << "Created a pool of " << this->pool.size() << " ["
+         << crumbName << "] breadcrumbs." << std::endl;
+}
+
+//////////////////////////////////////////////////
+void Breadcrumbs::OnDeployed(Entity _entity, const std::string &_name,
+    const std::chrono::steady_clock::duration &_simTime,
+    EntityComponentManager &_ecm)
+{
+  // keep track of entities that are set to auto disable
+  if (!this->modelRoot.Model()->Static() &&
+      this->disablePhysicsTime >
+      std::chrono::steady_clock::duration::zero())
+  {
+    this->autoStaticEntities[_entity] = _simTime;
+  }
+
+  if (this->isPerformer)
+  {
+    auto worldName =
+        _ecm.Component<components::Name>(this->worldEntity)->Data();
+    msgs::StringMsg req;
+    req.set_data(_name);
+    this->node.Request<msgs::StringMsg, msgs::Boolean>(
+        "/world/" + worldName + "/level/set_performer", req,
+        [](const msgs::Boolean &, const bool)
+        {
+        });
+
+    // When using the set_performer service, the performer gets a default
+    // geometry for its bounding volume. To update the geometry, we make a
+    // list of performer breadcrumbs and process them as we detect that
+    // they have become performers
+    this->pendingGeometryUpdate.insert(_entity);
+  }
+}
+
 //////////////////////////////////////////////////
 void Breadcrumbs::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
     ignition::gazebo::EntityComponentManager &_ecm)
@@ -196,6 +345,22 @@ void Breadcrumbs::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
       return;
     }
 
+    // Move pooled breadcrumbs detached in the previous iteration to their
+    // deployment pose
+    for (const auto &[entity, pose] : this->pendingPoolPoses)
+    {
+      auto poseCmd = _ecm.Component<components::WorldPoseCmd>(entity);
+      if (!poseCmd)
+        _ecm.CreateComponent(entity, components::WorldPoseCmd(pose));
+      else
+        poseCmd->Data() = pose;
+
+      this->OnDeployed(entity,
+          _ecm.Component<components::Name>(entity)->Data(), _info.simTime,
+          _ecm);
+    }
+    this->pendingPoolPoses.clear();
+
     auto poseComp = _ecm.Component<components::Pose>(this->model.Entity());
 
     for (std::size_t i = 0; i < cmds.size(); ++i)
@@ -203,77 +368,49 @@ void Breadcrumbs::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
       if (this->maxDeployments < 0 ||
           this->numDeployments < this->maxDeployments)
       {
-        sdf::Model modelToSpawn = *this->modelRoot.Model();
-        std::string desiredName =
-            modelToSpawn.Name() + "_" + std::to_string(this->numDeployments);
-
-        std::vector<std::string> modelNames;
-        _ecm.Each<components::Name, components::Model>(
-            [&modelNames](const Entity &, const components::Name *_name,
-                          const components::Model *)
-            {
-              modelNames.push_back(_name->Data());
-              return true;
-            });
-
-        // Check if there's a model with the same name.
-        auto it = std::find(modelNames.begin(), modelNames.end(), desiredName);
-        if (it != modelNames.end())
+        // Deploy from the pool by detaching a breadcrumb, its pose is set
+        // in the next iteration
+        if (!this->pool.empty())
         {
-          if (!this->allowRenaming)
-          {
-            ignwarn << "Entity named [" << desiredName
-                    << "] already exists and "
-                    << "[allow_renaming] is false. Entity not spawned."
-                    << std::endl;
-            return;
-          }
+          Entity entity = this->pool.front();
+          this->pool.pop_front();
 
-          std::string newName = desiredName;
-          int counter = 0;
-          while (std::find(modelNames.begin(), modelNames.end(), newName) !=
-                 modelNames.end())
+          auto jointIt = this->poolJoints.find(entity);
+          if (jointIt != this->poolJoints.end())
           {
-            newName = desiredName + "_" + std::to_string(++counter);
+            _ecm.RequestRemoveEntity(jointIt->second);
+            this->poolJoints.erase(jointIt);
           }
-          desiredName = newName;
-        }
 
-        modelToSpawn.SetName(desiredName);
-        modelToSpawn.SetRawPose(poseComp->Data() * modelToSpawn.RawPose());
-        ignmsg << "Deploying " << modelToSpawn.Name() << " at "
-               << modelToSpawn.RawPose() << std::endl;
-        Entity entity = this->creator->CreateEntities(&modelToSpawn);
-        this->creator->SetParent(entity, this->worldEntity);
-
-        // keep track of entities that are set to auto disable
-        if (!modelToSpawn.Static() &&
-            this->disablePhysicsTime >
-            std::chrono::steady_clock::duration::zero())
-        {
-          this->autoStaticEntities[entity] = _info.simTime;
-        }
+          math::Pose3d pose =
+              poseComp->Data() * this->modelRoot.Model()->RawPose();
+          this->pendingPoolPoses[entity] = pose;
+          ignmsg << "Deploying "
+                 << _ecm.Component<components::Name>(entity)->Data()
+                 << " at " << pose << std::endl;
 
-        if (this->isPerformer)
-        {
-          auto worldName =
-              _ecm.Component<components::Name>(this->worldEntity)->Data();
-          msgs::StringMsg req;
-          req.set_data(modelToSpawn.Name());
-          this->node.Request<msgs::StringMsg, msgs::Boolean>(
-              "/world/" + worldName + "/level/set_performer", req,
-              [](const msgs::Boolean &, const bool)
-              {
-              });
-
-          // When using the set_performer service, the performer gets a default
-          // geometry for its bounding volume. To update the geometry, we make a
-          // list of performer breadcrumbs and process them as we detect that
-          // they have become performers
-          this->pendingGeometryUpdate.insert(entity);
+          ++this->numDeployments;
         }
+        else
+        {
+          sdf::Model modelToSpawn = *this->modelRoot.Model();
+          auto name = this->BreadcrumbName(
+              modelToSpawn.Name() + "_" +
+              std::to_string(this->numDeployments), _ecm);
+          if (!name)
+            return;
 
-        ++this->numDeployments;
+          modelToSpawn.SetName(*name);
+          modelToSpawn.SetRawPose(poseComp->Data() * modelToSpawn.RawPose());
+          ignmsg << "Deploying " << modelToSpawn.Name() << " at "
+                 << modelToSpawn.RawPose() << std::endl;
+          Entity entity = this->creator->CreateEntities(&modelToSpawn);
+          this->creator->SetParent(entity, this->worldEntity);
+
+          this->OnDeployed(entity, modelToSpawn.Name(), _info.simTime, _ecm);
+
+          ++this->numDeployments;
+        }
       }
       else
       {
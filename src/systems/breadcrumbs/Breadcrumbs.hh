@@ -17,6 +17,8 @@
 #ifndef IGNITION_GAZEBO_SYSTEMS_BREADCRUMBS_HH_
 #define IGNITION_GAZEBO_SYSTEMS_BREADCRUMBS_HH_
 
+#include <deque>
+#include <map>
 #include <memory>
 #include <optional>
 #include <set>
@@ -84,6 +86,15 @@ namespace systems
   /// `<topic_statistics>`: If true, then topic statistics are enabled on
   /// `<topic>` and error messages will be generated when messages are
   /// dropped. Default to false.
+  /// `<pool_size>`: Number of breadcrumbs created up front, when the system
+  /// is configured, so deploying them doesn't create any entities. Pooled
+  /// breadcrumbs are held by a static anchor at `<pool_parking_pose>`, and
+  /// deploying one detaches it and moves it to the deployment pose. Once
+  /// the pool is used up, breadcrumbs are created on deployment. Defaults to
+  /// 0, and is limited to `<max_deployments>` when that is positive.
+  /// `<pool_parking_pose>`: World pose around which pooled breadcrumbs wait
+  /// to be deployed, spaced 10m apart along X. Defaults to 1km below the
+  /// origin.
   class Breadcrumbs
       : public System,
         public ISystemConfigure,
@@ -106,6 +117,32 @@ namespace systems
     /// \brief Callback to deployment topic
     private: void OnDeploy(const msgs::Empty &_msg);
 
+    /// \brief Get a name for a breadcrumb which isn't used by another model,
+    /// see `<allow_renaming>`.
+    /// \param[in] _desiredName Name the breadcrumb should have.
+    /// \param[in] _ecm Entity component manager
+    /// \return The name, or nullopt if it's taken and renaming isn't allowed.
+    private: std::optional<std::string> BreadcrumbName(
+                 const std::string &_desiredName,
+                 const EntityComponentManager &_ecm) const;
+
+    /// \brief Create the pool of breadcrumbs, see `<pool_size>`.
+    /// \param[in] _size Number of breadcrumbs.
+    /// \param[in] _parkingPose Pose around which they are parked.
+    /// \param[in] _ecm Entity component manager
+    private: void CreatePool(int _size, const math::Pose3d &_parkingPose,
+                             EntityComponentManager &_ecm);
+
+    /// \brief Finish deploying a breadcrumb, whether it came from the pool or
+    /// was just created.
+    /// \param[in] _entity Breadcrumb model.
+    /// \param[in] _name Name of the breadcrumb.
+    /// \param[in] _simTime Current sim time.
+    /// \param[in] _ecm Entity component manager
+    private: void OnDeployed(Entity _entity, const std::string &_name,
+                 const std::chrono::steady_clock::duration &_simTime,
+                 EntityComponentManager &_ecm);
+
     /// \brief Make an entity static
     /// \param[in] _entity Entity to make static
     /// \param[in] _ecm Entity component manager
@@ -166,6 +203,18 @@ namespace systems
     /// \brief SDF DOM of a static model with empty link
     private: sdf::Model staticModelToSpawn;
 
+    /// \brief Pooled breadcrumbs which weren't deployed yet, in deployment
+    /// order.
+    private: std::deque<Entity> pool;
+
+    /// \brief Joint holding each pooled breadcrumb to the pool anchor.
+    private: std::unordered_map<Entity, Entity> poolJoints;
+
+    /// \brief Deployed pooled breadcrumbs waiting for their pose to be set.
+    /// The pose is set one iteration after they are detached from the
+    /// anchor, because physics can't move a model while it's attached.
+    private: std::map<Entity, math::Pose3d> pendingPoolPoses;
+
     /// \brief Publishes remaining deployments.
     public: transport::Node::Publisher remainingPub;
 
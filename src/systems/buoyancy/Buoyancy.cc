@@ -17,7 +17,12 @@
 #include <ignition/msgs/wrench.pb.h>
 
 #include <mutex>
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <ignition/common/Mesh.hh>
@@ -27,6 +32,7 @@
 #include <ignition/plugin/Register.hh>
 
 #include <ignition/math/Helpers.hh>
+#include <ignition/math/Matrix3.hh>
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/Vector3.hh>
 
@@ -64,6 +70,113 @@ class ignition::gazebo::systems::BuoyancyPrivate
   /// \return The fluid density at the givein pose.
   public: double FluidDensity(const math::Pose3d &_pose) const;
 
+  /// \brief Compute the buoyancy force and torque of every gathered link,
+  /// see LinkBatch. Each output only depends on the inputs at the same
+  /// index, so the loop is a straight pass over contiguous arrays which
+  /// the compiler can vectorize.
+  /// \param[in] _gravity Gravity vector in the world frame.
+  public: void ComputeWrenches(const math::Vector3d &_gravity);
+
+  /// \brief State of the buoyant links gathered each step, stored as
+  /// structure of arrays. The vectors are reused across steps so they
+  /// are only reallocated when the number of links grows.
+  public: struct LinkBatch
+  {
+    /// \brief Remove all links, keeping the allocated memory.
+    public: void Clear();
+
+    /// \brief Add a link to the batch.
+    /// \param[in] _entity Link entity.
+    /// \param[in] _pose World pose of the link.
+    /// \param[in] _density Fluid density at the link pose.
+    /// \param[in] _volume Volume of the link.
+    /// \param[in] _cov Center of volume in the link frame.
+    public: void Add(const Entity _entity, const math::Pose3d &_pose,
+        const double _density, const double _volume,
+        const math::Vector3d &_cov);
+
+    /// \brief Link entities.
+    public: std::vector<Entity> entities;
+
+    /// \brief Fluid density times volume of each link.
+    public: std::vector<double> displaced;
+
+    /// \brief Components of the world orientation of each link.
+    public: std::vector<double> qw, qx, qy, qz;
+
+    /// \brief Components of the center of volume in the link frame.
+    public: std::vector<double> cx, cy, cz;
+
+    /// \brief Components of the world position of each link.
+    public: std::vector<double> px, py, pz;
+
+    /// \brief Components of the resulting force in the world frame.
+    public: std::vector<double> fx, fy, fz;
+
+    /// \brief Components of the resulting torque in the world frame.
+    public: std::vector<double> tx, ty, tz;
+  };
+
+  /// \brief Buoyant links of the current step.
+  public: LinkBatch batch;
+
+  /// \brief Volume samples of a link, used to compute partial submersion
+  /// in graded mode. Each collision is split into small cells when the
+  /// link is first seen, so each step only has to transform the cell
+  /// centers and look up the density they are submerged in.
+  public: struct LinkSamples
+  {
+    /// \brief Components of the cell centers in the link frame.
+    public: std::vector<double> x, y, z;
+
+    /// \brief Volume of each cell.
+    public: std::vector<double> volume;
+
+    /// \brief Edge length of each cell, used to interpolate the density
+    /// when a cell crosses a layer boundary.
+    public: std::vector<double> size;
+  };
+
+  /// \brief Add the volume samples of a collision geometry to a link.
+  /// \param[in] _geom Collision geometry.
+  /// \param[in] _pose Pose of the collision in the link frame.
+  /// \param[in] _volume Volume of the geometry.
+  /// \param[in] _meshMin Minimum corner of the mesh bounding box, only
+  /// used for meshes.
+  /// \param[in] _meshMax Maximum corner of the mesh bounding box, only
+  /// used for meshes.
+  /// \param[out] _samples Samples to add to.
+  public: static void AddSamples(const sdf::Geometry &_geom,
+      const math::Pose3d &_pose, const double _volume,
+      const math::Vector3d &_meshMin, const math::Vector3d &_meshMax,
+      LinkSamples &_samples);
+
+  /// \brief Get the average fluid density over a vertical interval, using
+  /// the graded layers.
+  /// \param[in] _low Lower world height of the interval.
+  /// \param[in] _high Upper world height of the interval.
+  /// \return Average density over the interval.
+  public: double AverageDensity(const double _low, const double _high) const;
+
+  /// \brief Compute the buoyancy wrench of a link from its volume samples
+  /// and store it in the batch.
+  /// \param[in] _index Index of the link in the batch.
+  /// \param[in] _samples Volume samples of the link.
+  /// \param[in] _gravity Gravity vector in the world frame.
+  public: void ComputeGradedWrench(const std::size_t _index,
+      const LinkSamples &_samples, const math::Vector3d &_gravity);
+
+  /// \brief True if graded buoyancy is enabled, see the header.
+  public: bool graded{false};
+
+  /// \brief Density layers in graded mode, as pairs of the height above
+  /// which the density applies and the density, sorted by height. Below
+  /// the first layer the fluid density is `fluidDensity`.
+  public: std::vector<std::pair<double, double>> layers;
+
+  /// \brief Volume samples of each buoyant link in graded mode.
+  public: std::unordered_map<Entity, LinkSamples> samples;
+
   /// \brief Model interface
   public: Entity world{kNullEntity};
 
@@ -85,6 +198,243 @@ double BuoyancyPrivate::FluidDensity(const math::Pose3d & /*_pose*/) const
   return this->fluidDensity;
 }
 
+//////////////////////////////////////////////////
+void BuoyancyPrivate::LinkBatch::Clear()
+{
+  this->entities.clear();
+  this->displaced.clear();
+  this->qw.clear();
+  this->qx.clear();
+  this->qy.clear();
+  this->qz.clear();
+  this->cx.clear();
+  this->cy.clear();
+  this->cz.clear();
+  this->px.clear();
+  this->py.clear();
+  this->pz.clear();
+}
+
+//////////////////////////////////////////////////
+void BuoyancyPrivate::LinkBatch::Add(const Entity _entity,
+    const math::Pose3d &_pose, const double _density, const double _volume,
+    const math::Vector3d &_cov)
+{
+  this->entities.push_back(_entity);
+  this->displaced.push_back(_density * _volume);
+  this->qw.push_back(_pose.Rot().W());
+  this->qx.push_back(_pose.Rot().X());
+  this->qy.push_back(_pose.Rot().Y());
+  this->qz.push_back(_pose.Rot().Z());
+  this->cx.push_back(_cov.X());
+  this->cy.push_back(_cov.Y());
+  this->cz.push_back(_cov.Z());
+  this->px.push_back(_pose.Pos().X());
+  this->py.push_back(_pose.Pos().Y());
+  this->pz.push_back(_pose.Pos().Z());
+}
+
+//////////////////////////////////////////////////
+void BuoyancyPrivate::ComputeWrenches(const math::Vector3d &_gravity)
+{
+  auto &b = this->batch;
+  const std::size_t count = b.entities.size();
+  b.fx.resize(count);
+  b.fy.resize(count);
+  b.fz.resize(count);
+  b.tx.resize(count);
+  b.ty.resize(count);
+  b.tz.resize(count);
+
+  const double gx = _gravity.X();
+  const double gy = _gravity.Y();
+  const double gz = _gravity.Z();
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    // By Archimedes' principle,
+    // buoyancy = -(mass*gravity)*fluid_density/object_density
+    // object_density = mass/volume, so the mass term cancels.
+    const double fx = -b.displaced[i] * gx;
+    const double fy = -b.displaced[i] * gy;
+    const double fz = -b.displaced[i] * gz;
+
+    // Convert the center of volume to the world frame, this is the same as
+    // math::Quaterniond::RotateVector: v + 2w(q x v) + 2q x (q x v)
+    const double w = b.qw[i];
+    const double x = b.qx[i];
+    const double y = b.qy[i];
+    const double z = b.qz[i];
+    const double ux = 2.0 * (y * b.cz[i] - z * b.cy[i]);
+    const double uy = 2.0 * (z * b.cx[i] - x * b.cz[i]);
+    const double uz = 2.0 * (x * b.cy[i] - y * b.cx[i]);
+    const double ox = b.cx[i] + w * ux + (y * uz - z * uy);
+    const double oy = b.cy[i] + w * uy + (z * ux - x * uz);
+    const double oz = b.cz[i] + w * uz + (x * uy - y * ux);
+
+    b.fx[i] = fx;
+    b.fy[i] = fy;
+    b.fz[i] = fz;
+
+    // Compute the torque that should be applied due to buoyancy and
+    // the center of volume.
+    b.tx[i] = oy * fz - oz * fy;
+    b.ty[i] = oz * fx - ox * fz;
+    b.tz[i] = ox * fy - oy * fx;
+  }
+}
+
+//////////////////////////////////////////////////
+void BuoyancyPrivate::AddSamples(const sdf::Geometry &_geom,
+    const math::Pose3d &_pose, const double _volume,
+    const math::Vector3d &_meshMin, const math::Vector3d &_meshMax,
+    LinkSamples &_samples)
+{
+  // Number of cells along each axis of the bounding box of a geometry.
+  const int cellsPerAxis = 8;
+
+  // Bounding box of the geometry in the collision frame, and a test for
+  // cell centers which are inside the geometry.
+  math::Vector3d min, max;
+  std::function<bool(const math::Vector3d &)> inside =
+      [](const math::Vector3d &) { return true; };
+  switch (_geom.Type())
+  {
+    case sdf::GeometryType::BOX:
+      max = _geom.BoxShape()->Size() * 0.5;
+      min = -max;
+      break;
+    case sdf::GeometryType::SPHERE:
+    {
+      const double r = _geom.SphereShape()->Radius();
+      max.Set(r, r, r);
+      min = -max;
+      inside = [r](const math::Vector3d &_p)
+      {
+        return _p.SquaredLength() <= r * r;
+      };
+      break;
+    }
+    case sdf::GeometryType::CYLINDER:
+    {
+      const double r = _geom.CylinderShape()->Radius();
+      max.Set(r, r, _geom.CylinderShape()->Length() * 0.5);
+      min = -max;
+      inside = [r](const math::Vector3d &_p)
+      {
+        return _p.X() * _p.X() + _p.Y() * _p.Y() <= r * r;
+      };
+      break;
+    }
+    case sdf::GeometryType::MESH:
+      // The mesh is approximated by its bounding box, with the cell
+      // volumes scaled to match the mesh volume.
+      min = _meshMin;
+      max = _meshMax;
+      break;
+    default:
+      return;
+  }
+
+  const math::Vector3d cell = (max - min) / cellsPerAxis;
+  const double cellSize = std::cbrt(std::abs(cell.X() * cell.Y() * cell.Z()));
+
+  const std::size_t first = _samples.x.size();
+  for (int i = 0; i < cellsPerAxis; ++i)
+  {
+    for (int j = 0; j < cellsPerAxis; ++j)
+    {
+      for (int k = 0; k < cellsPerAxis; ++k)
+      {
+        const math::Vector3d center = min + math::Vector3d(
+            (i + 0.5) * cell.X(), (j + 0.5) * cell.Y(), (k + 0.5) * cell.Z());
+        if (!inside(center))
+          continue;
+
+        const math::Vector3d pos = _pose.Pos() +
+            _pose.Rot().RotateVector(center);
+        _samples.x.push_back(pos.X());
+        _samples.y.push_back(pos.Y());
+        _samples.z.push_back(pos.Z());
+        _samples.size.push_back(cellSize);
+      }
+    }
+  }
+
+  // Split the volume evenly among the cells, so the total is exact even
+  // though the cells only approximate the shape.
+  const std::size_t count = _samples.x.size() - first;
+  if (count > 0)
+    _samples.volume.resize(_samples.x.size(), _volume / count);
+}
+
+//////////////////////////////////////////////////
+double BuoyancyPrivate::AverageDensity(const double _low,
+    const double _high) const
+{
+  double density = this->fluidDensity;
+  if (_high <= _low)
+  {
+    for (const auto &layer : this->layers)
+    {
+      if (_low < layer.first)
+        break;
+      density = layer.second;
+    }
+    return density;
+  }
+
+  // Integrate the piecewise constant density over the interval.
+  double sum = 0;
+  double bottom = _low;
+  for (const auto &layer : this->layers)
+  {
+    if (layer.first >= _high)
+      break;
+    if (layer.first > bottom)
+    {
+      sum += density * (layer.first - bottom);
+      bottom = layer.first;
+    }
+    density = layer.second;
+  }
+  sum += density * (_high - bottom);
+  return sum / (_high - _low);
+}
+
+//////////////////////////////////////////////////
+void BuoyancyPrivate::ComputeGradedWrench(const std::size_t _index,
+    const LinkSamples &_samples, const math::Vector3d &_gravity)
+{
+  auto &b = this->batch;
+  const math::Matrix3d rot(math::Quaterniond(
+      b.qw[_index], b.qx[_index], b.qy[_index], b.qz[_index]));
+  const double pz = b.pz[_index];
+
+  math::Vector3d force, torque;
+  for (std::size_t i = 0; i < _samples.x.size(); ++i)
+  {
+    // Offset of the cell center from the link origin, in the world frame.
+    const math::Vector3d offset = rot * math::Vector3d(
+        _samples.x[i], _samples.y[i], _samples.z[i]);
+    const double z = pz + offset.Z();
+    const double halfSize = _samples.size[i] * 0.5;
+
+    // Buoyancy of the fluid displaced by this cell, see ComputeWrenches.
+    const math::Vector3d cellForce = -this->AverageDensity(
+        z - halfSize, z + halfSize) * _samples.volume[i] * _gravity;
+    force += cellForce;
+    torque += offset.Cross(cellForce);
+  }
+
+  b.fx[_index] = force.X();
+  b.fy[_index] = force.Y();
+  b.fz[_index] = force.Z();
+  b.tx[_index] = torque.X();
+  b.ty[_index] = torque.Y();
+  b.tz[_index] = torque.Z();
+}
+
 //////////////////////////////////////////////////
 Buoyancy::Buoyancy()
   : dataPtr(std::make_unique<BuoyancyPrivate>())
@@ -114,6 +464,41 @@ void Buoyancy::Configure(const Entity &_entity,
   {
     this->dataPtr->fluidDensity = _sdf->Get<double>("uniform_fluid_density");
   }
+  else if (_sdf->HasElement("graded_buoyancy"))
+  {
+    this->dataPtr->graded = true;
+
+    // Ugly, but needed because the sdf::Element::GetElement is not a const
+    // function and _sdf is a const shared pointer to a const sdf::Element.
+    auto ptr = const_cast<sdf::Element *>(_sdf.get());
+    auto gradedElem = ptr->GetElement("graded_buoyancy");
+
+    if (gradedElem->HasElement("default_density"))
+    {
+      this->dataPtr->fluidDensity =
+          gradedElem->Get<double>("default_density");
+    }
+
+    auto layerElem = gradedElem->HasElement("density_change") ?
+        gradedElem->GetElement("density_change") : nullptr;
+    while (layerElem)
+    {
+      if (!layerElem->HasElement("above_depth") ||
+          !layerElem->HasElement("density"))
+      {
+        ignerr << "<density_change> requires both <above_depth> and "
+               << "<density>, ignoring it." << std::endl;
+      }
+      else
+      {
+        this->dataPtr->layers.emplace_back(
+            layerElem->Get<double>("above_depth"),
+            layerElem->Get<double>("density"));
+      }
+      layerElem = layerElem->GetNextElement("density_change");
+    }
+    std::sort(this->dataPtr->layers.begin(), this->dataPtr->layers.end());
+  }
 }
 
 //////////////////////////////////////////////////
@@ -153,12 +538,14 @@ void Buoyancy::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
     double volumeSum = 0;
     ignition::math::Vector3d weightedPosSum =
       ignition::math::Vector3d::Zero;
+    BuoyancyPrivate::LinkSamples linkSamples;
 
     // Compute the volume of the link by iterating over all the collision
     // elements and storing each geometry's volume.
     for (const Entity &collision : collisions)
     {
       double volume = 0;
+      math::Vector3d meshMin, meshMax;
       const components::CollisionElement *coll =
         _ecm.Component<components::CollisionElement>(collision);
 
@@ -193,7 +580,11 @@ void Buoyancy::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
               const common::Mesh *mesh =
                 common::MeshManager::Instance()->Load(file);
               if (mesh)
+              {
                 volume = mesh->Volume();
+                meshMin = mesh->Min();
+                meshMax = mesh->Max();
+              }
               else
                 ignerr << "Unable to load mesh[" << file << "]\n";
             }
@@ -212,6 +603,14 @@ void Buoyancy::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
       volumeSum += volume;
       math::Pose3d pose = worldPose(collision, _ecm);
       weightedPosSum += volume * pose.Pos();
+
+      if (this->dataPtr->graded && volume > 0)
+      {
+        auto collPose = _ecm.Component<components::Pose>(collision);
+        BuoyancyPrivate::AddSamples(*coll->Data().Geom(),
+            collPose ? collPose->Data() : math::Pose3d::Zero, volume,
+            meshMin, meshMax, linkSamples);
+      }
     }
 
     if (volumeSum > 0)
@@ -223,15 +622,33 @@ void Buoyancy::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
 
       // Store the volume
       _ecm.CreateComponent(_entity, components::Volume(volumeSum));
+
+      // The link's world pose is then computed once per step for all
+      // systems
+      _ecm.TrackLinkState(_entity);
+
+      if (this->dataPtr->graded)
+        this->dataPtr->samples[_entity] = std::move(linkSamples);
     }
 
     return true;
   });
 
+  _ecm.EachRemoved<components::Link>(
+      [&](const Entity &_entity, const components::Link *) -> bool
+  {
+    this->dataPtr->samples.erase(_entity);
+    return true;
+  });
+
   // Only update if not paused.
   if (_info.paused)
     return;
 
+  // Gather the state of all buoyant links, then compute their wrenches
+  // in one pass and write them back.
+  auto &batch = this->dataPtr->batch;
+  batch.Clear();
   _ecm.Each<components::Link,
             components::Volume,
             components::CenterOfVolume>(
@@ -241,29 +658,38 @@ void Buoyancy::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
           const components::CenterOfVolume *_centerOfVolume) -> bool
     {
       // World pose of the link.
-      math::Pose3d linkWorldPose = worldPose(_entity, _ecm);
-
-      // By Archimedes' principle,
-      // buoyancy = -(mass*gravity)*fluid_density/object_density
-      // object_density = mass/volume, so the mass term cancels.
-      math::Vector3d buoyancy =
-        -this->dataPtr->FluidDensity(linkWorldPose) *
-        _volume->Data() * gravity->Data();
-
-      // Convert the center of volume to the world frame
-      math::Vector3d offsetWorld = linkWorldPose.Rot().RotateVector(
+      auto state = _ecm.CachedLinkState(_entity);
+      math::Pose3d linkWorldPose = state ? state->worldPose :
+          worldPose(_entity, _ecm);
+      batch.Add(_entity, linkWorldPose,
+          this->dataPtr->FluidDensity(linkWorldPose), _volume->Data(),
           _centerOfVolume->Data());
-      // Compute the torque that should be applied due to buoyancy and
-      // the center of volume.
-      math::Vector3d torque = offsetWorld.Cross(buoyancy);
-
-      // Apply the wrench to the link. This wrench is applied in the
-      // Physics System.
-      Link link(_entity);
-      link.AddWorldWrench(_ecm, buoyancy, torque);
-
       return true;
   });
+
+  this->dataPtr->ComputeWrenches(gravity->Data());
+
+  // In graded mode, replace the wrenches of links which have volume
+  // samples with their partially submerged buoyancy.
+  if (this->dataPtr->graded)
+  {
+    for (std::size_t i = 0; i < batch.entities.size(); ++i)
+    {
+      auto it = this->dataPtr->samples.find(batch.entities[i]);
+      if (it != this->dataPtr->samples.end())
+        this->dataPtr->ComputeGradedWrench(i, it->second, gravity->Data());
+    }
+  }
+
+  // Apply the wrenches to the links. They are applied in the Physics
+  // System.
+  for (std::size_t i = 0; i < batch.entities.size(); ++i)
+  {
+    Link link(batch.entities[i]);
+    link.AddWorldWrench(_ecm,
+        math::Vector3d(batch.fx[i], batch.fy[i], batch.fz[i]),
+        math::Vector3d(batch.tx[i], batch.ty[i], batch.tz[i]));
+  }
 }
 
 IGNITION_ADD_PLUGIN(Buoyancy,
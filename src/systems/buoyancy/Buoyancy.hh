@@ -47,6 +47,32 @@ namespace systems
   ///
   /// * <uniform_fluid_density> sets the density of the fluid that surrounds
   /// the buoyant object.
+  /// * <graded_buoyancy> enables a fluid whose density changes with height,
+  /// such as water below an air layer. Links crossing a density change are
+  /// partially submerged, and receive buoyancy and torque only for the
+  /// part of their volume in each layer. This is ignored if
+  /// <uniform_fluid_density> is set.
+  ///   * <default_density> density of the fluid below all density changes.
+  ///   Defaults to 1000, the density of water.
+  ///   * <density_change> may be repeated, each one sets the density above
+  ///   a height.
+  ///     * <above_depth> world height above which the density applies.
+  ///     * <density> density of the fluid above that height.
+  ///
+  /// In graded mode each collision is split into small cells once, when
+  /// its link is first seen. Each step the cells are moved with the link
+  /// and weighted by the density of the layer they are in. Meshes are
+  /// approximated by their bounding box.
+  ///
+  /// ```
+  /// <graded_buoyancy>
+  ///   <default_density>1000</default_density>
+  ///   <density_change>
+  ///     <above_depth>0</above_depth>
+  ///     <density>1</density>
+  ///   </density_change>
+  /// </graded_buoyancy>
+  /// ```
   ///
   /// ## Example
   ///
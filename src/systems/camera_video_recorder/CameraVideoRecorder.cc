@@ -15,13 +15,14 @@
  *
 */
 
+#include <algorithm>
+#include <chrono>
 #include <regex>
 #include <set>
 #include <string>
 #include <unordered_map>
 
 #include <ignition/common/Profiler.hh>
-#include <ignition/common/VideoEncoder.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/transport/Node.hh>
 
@@ -30,6 +31,7 @@
 #include <ignition/rendering/RenderingIface.hh>
 #include <ignition/rendering/Scene.hh>
 
+#include "ignition/gazebo/rendering/AsyncVideoEncoder.hh"
 #include "ignition/gazebo/rendering/Events.hh"
 
 #include "ignition/gazebo/components/Camera.hh"
@@ -91,8 +93,9 @@ class ignition::gazebo::systems::CameraVideoRecorderPrivate
   /// \brief Image from user camera
   public: rendering::Image cameraImage;
 
-  /// \brief Video encoder
-  public: common::VideoEncoder videoEncoder;
+  /// \brief Video encoder, which encodes on its own thread so rendering
+  /// isn't stalled
+  public: AsyncVideoEncoder videoEncoder;
 
   /// \brief Video encoding format
   public: std::string recordVideoFormat;
@@ -210,6 +213,11 @@ void CameraVideoRecorder::Configure(
   }
   this->dataPtr->eventMgr = &_eventMgr;
 
+  this->dataPtr->videoEncoder.SetQueueSize(static_cast<std::size_t>(
+      std::max(1, _sdf->Get<int>("queue_size", 4).first)));
+  this->dataPtr->videoEncoder.SetHardwareEncoders(
+      _sdf->Get<std::string>("hw_encoders", "").first);
+
   // get sensor topic
   sdf::Sensor sensorSdf = cameraEntComp->Data();
   std::string topic  = sensorSdf.Topic();
@@ -313,7 +321,8 @@ void CameraVideoRecorderPrivate::OnPostRender()
     {
       this->camera->Copy(this->cameraImage);
       this->videoEncoder.AddFrame(
-          this->cameraImage.Data<unsigned char>(), width, height);
+          this->cameraImage.Data<unsigned char>(), width, height,
+          std::chrono::steady_clock::now());
     }
     // Video recorder is idle. Start recording.
     else
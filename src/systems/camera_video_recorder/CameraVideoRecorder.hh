@@ -40,6 +40,12 @@ namespace systems
   ///              not specified, the topic defaults to:
   ///              /world/<world_name/model/<model_name>/link/<link_name>/
   ///                  sensor/<sensor_name>/record_video
+  ///   <queue_size> Number of frames which can wait to be encoded. Frames
+  ///              are encoded on a background thread, and dropped when
+  ///              the queue is full. Defaults to 4.
+  ///   <hw_encoders> Hardware encoders which may be used, such as NVENC or
+  ///              VAAPI, separated by ":", see
+  ///              AsyncVideoEncoder::SetHardwareEncoders. Defaults to none.
   class CameraVideoRecorder:
     public System,
     public ISystemConfigure,
@@ -15,7 +15,11 @@
  *
  */
 
+#include <memory>
+#include <optional>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <ignition/plugin/Register.hh>
@@ -33,6 +37,8 @@
 #include <ignition/gazebo/EntityComponentManager.hh>
 #include <ignition/gazebo/Util.hh>
 
+#include <sdf/Geometry.hh>
+#include <sdf/Material.hh>
 #include <sdf/Visual.hh>
 #include <sdf/Mesh.hh>
 #include <sdf/Model.hh>
@@ -46,199 +52,310 @@
 
 #include <ignition/common/ColladaExporter.hh>
 
+#include "../../TaskPool.hh"
 #include "ColladaWorldExporter.hh"
 
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+namespace
+{
+/// \brief Data of a visual copied from the ECM, so the world can be
+/// exported without accessing the ECM.
+struct VisualSnapshot
+{
+  /// \brief Visual geometry.
+  sdf::Geometry geometry;
+
+  /// \brief Full path of the mesh, for mesh geometries.
+  std::string meshPath;
+
+  /// \brief World pose of the visual.
+  math::Pose3d worldPose;
+
+  /// \brief Visual material, if it has one.
+  std::optional<sdf::Material> material;
+
+  /// \brief Visual transparency.
+  float transparency{0.0f};
+};
+
+/// \brief A submesh of the world mesh, ready to be merged.
+struct SubMeshPart
+{
+  /// \brief Scaled copy of the submesh.
+  std::unique_ptr<common::SubMesh> subMesh;
+
+  /// \brief Material of the source mesh, shared across visuals using the
+  /// same mesh. Null if the visual material is used.
+  common::MaterialPtr meshMaterial;
+
+  /// \brief World transform of the submesh.
+  math::Matrix4d matrix;
+};
+
+/// \brief The submeshes created for a single visual.
+struct VisualParts
+{
+  /// \brief Material created from the visual, used by parts without a
+  /// mesh material.
+  common::MaterialPtr material;
+
+  /// \brief Submeshes of the visual.
+  std::vector<SubMeshPart> parts;
+};
+}
 
 class ignition::gazebo::systems::ColladaWorldExporterPrivate
 {
   // Default constructor
   public: ColladaWorldExporterPrivate() = default;
 
+  /// \brief Destructor. Waits for an ongoing export to finish.
+  public: ~ColladaWorldExporterPrivate()
+  {
+    if (this->exportThread.joinable())
+      this->exportThread.join();
+  }
+
   /// \brief Has the world already been exported?.
   private: bool exported{false};
 
-  /// \brief Exports the world to a mesh.
+  /// \brief Thread which builds and writes the world mesh.
+  private: std::thread exportThread;
+
+  /// \brief Snapshot the world and start exporting it on a background
+  /// thread, so the simulation isn't blocked.
   /// \param[_ecm] _ecm Mutable reference to the EntityComponentManager.
   public: void Export(const EntityComponentManager &_ecm)
   {
     if (this->exported) return;
+    this->exported = true;
 
-    common::Mesh worldMesh;
-    std::vector<math::Matrix4d> subMeshMatrix;
-
+    std::string worldName;
     _ecm.Each<components::World, components::Name>(
       [&](const Entity /*& _entity*/,
         const components::World *,
         const components::Name * _name)->bool
     {
-      worldMesh.SetName(_name->Data());
+      worldName = _name->Data();
       return true;
     });
 
+    std::vector<VisualSnapshot> visuals;
     _ecm.Each<components::Visual,
             components::Name,
             components::Geometry,
             components::Transparency>(
     [&](const ignition::gazebo::Entity &_entity,
         const components::Visual *,
-        const components::Name *_name,
+        const components::Name *,
         const components::Geometry *_geom,
         const components::Transparency *_transparency)->bool
     {
-      std::string name = _name->Data().empty() ? std::to_string(_entity) :
-          _name->Data();
-
-      math::Pose3d worldPose = gazebo::worldPose(_entity, _ecm);
+      VisualSnapshot visual;
+      visual.geometry = _geom->Data();
+      visual.worldPose = gazebo::worldPose(_entity, _ecm);
+      visual.transparency = _transparency->Data();
 
-      common::MaterialPtr mat = std::make_shared<common::Material>();
       auto material = _ecm.Component<components::Material>(_entity);
       if (material != nullptr)
-      {
-        mat->SetDiffuse(material->Data().Diffuse());
-        mat->SetAmbient(material->Data().Ambient());
-        mat->SetEmissive(material->Data().Emissive());
-        mat->SetSpecular(material->Data().Specular());
-      }
-      mat->SetTransparency(_transparency->Data());
-
-      const ignition::common::Mesh *mesh;
-      std::weak_ptr<ignition::common::SubMesh> subm;
-      math::Vector3d scale;
-      math::Matrix4d matrix(worldPose);
-      ignition::common::MeshManager *meshManager =
-          ignition::common::MeshManager::Instance();
-
-      auto addSubmeshFunc = [&](int i) {
-          subm = worldMesh.AddSubMesh(
-              *mesh->SubMeshByIndex(0).lock().get());
-          subm.lock()->SetMaterialIndex(i);
-          subm.lock()->Scale(scale);
-          subMeshMatrix.push_back(matrix);
-      };
-
-      if (_geom->Data().Type() == sdf::GeometryType::BOX)
-      {
-        if (meshManager->HasMesh("unit_box"))
-        {
-          mesh = meshManager->MeshByName("unit_box");
-          scale = _geom->Data().BoxShape()->Size();
-          int i = worldMesh.AddMaterial(mat);
+        visual.material = material->Data();
 
-          addSubmeshFunc(i);
-        }
-      }
-      else if (_geom->Data().Type() == sdf::GeometryType::CYLINDER)
+      if (visual.geometry.Type() == sdf::GeometryType::MESH)
       {
-        if (meshManager->HasMesh("unit_cylinder"))
-        {
-          mesh = meshManager->MeshByName("unit_cylinder");
-          scale.X() = _geom->Data().CylinderShape()->Radius() * 2;
-          scale.Y() = scale.X();
-          scale.Z() = _geom->Data().CylinderShape()->Length();
-
-          int i = worldMesh.AddMaterial(mat);
-
-          addSubmeshFunc(i);
-        }
+        visual.meshPath = asFullPath(visual.geometry.MeshShape()->Uri(),
+            visual.geometry.MeshShape()->FilePath());
       }
-      else if (_geom->Data().Type() == sdf::GeometryType::PLANE)
-      {
-        if (meshManager->HasMesh("unit_plane"))
-        {
-          // Create a rotation for the plane mesh to account
-          // for the normal vector.
-          mesh = meshManager->MeshByName("unit_plane");
 
-          scale.X() = _geom->Data().PlaneShape()->Size().X();
-          scale.Y() = _geom->Data().PlaneShape()->Size().Y();
+      visuals.push_back(std::move(visual));
+      return true;
+    });
 
-          // // The rotation is the angle between the +z(0,0,1) vector and the
-          // // normal, which are both expressed in the local (Visual) frame.
-          math::Vector3d normal = _geom->Data().PlaneShape()->Normal();
-          math::Quaterniond normalRot;
-          normalRot.From2Axes(math::Vector3d::UnitZ, normal.Normalized());
-          worldPose.Rot() = worldPose.Rot() * normalRot;
+    this->exportThread = std::thread(&ColladaWorldExporterPrivate::Write,
+        std::move(worldName), std::move(visuals));
+  }
 
-          matrix = math::Matrix4d(worldPose);
+  /// \brief Build the world mesh from a snapshot and write it.
+  /// \param[in] _worldName Name of the world, which is also the name of
+  /// the export directory.
+  /// \param[in] _visuals Snapshot of all visuals.
+  private: static void Write(const std::string &_worldName,
+      const std::vector<VisualSnapshot> &_visuals)
+  {
+    ignition::common::MeshManager *meshManager =
+        ignition::common::MeshManager::Instance();
 
-          int i = worldMesh.AddMaterial(mat);
-          addSubmeshFunc(i);
-        }
-      }
-      else if (_geom->Data().Type() == sdf::GeometryType::SPHERE)
+    // The mesh manager isn't thread safe, so meshes are looked up before
+    // building the submeshes in parallel.
+    std::vector<const common::Mesh *> meshes(_visuals.size(), nullptr);
+    for (std::size_t v = 0; v < _visuals.size(); ++v)
+    {
+      const auto &geom = _visuals[v].geometry;
+      std::string meshName;
+      if (geom.Type() == sdf::GeometryType::BOX)
+        meshName = "unit_box";
+      else if (geom.Type() == sdf::GeometryType::CYLINDER)
+        meshName = "unit_cylinder";
+      else if (geom.Type() == sdf::GeometryType::PLANE)
+        meshName = "unit_plane";
+      else if (geom.Type() == sdf::GeometryType::SPHERE)
+        meshName = "unit_sphere";
+
+      if (!meshName.empty())
       {
-        if (meshManager->HasMesh("unit_sphere"))
-        {
-          mesh = meshManager->MeshByName("unit_sphere");
-
-          scale.X() = _geom->Data().SphereShape()->Radius() * 2;
-          scale.Y() = scale.X();
-          scale.Z() = scale.X();
-
-          int i = worldMesh.AddMaterial(mat);
-
-          addSubmeshFunc(i);
-        }
+        if (meshManager->HasMesh(meshName))
+          meshes[v] = meshManager->MeshByName(meshName);
       }
-      else if (_geom->Data().Type() == sdf::GeometryType::MESH)
+      else if (geom.Type() == sdf::GeometryType::MESH)
       {
-        auto fullPath = asFullPath(_geom->Data().MeshShape()->Uri(),
-            _geom->Data().MeshShape()->FilePath());
-
-        if (fullPath.empty())
+        if (_visuals[v].meshPath.empty())
         {
           ignerr << "Mesh geometry missing uri" << std::endl;
-          return true;
+          continue;
         }
-        mesh = meshManager->Load(fullPath);
+        meshes[v] = meshManager->Load(_visuals[v].meshPath);
 
-        if (!mesh) {
+        if (!meshes[v]) {
           ignerr << "mesh not found!" << std::endl;
-          return true;
-        }
-
-        for (unsigned int k = 0; k < mesh->SubMeshCount(); k++)
-        {
-          auto subMeshLock = mesh->SubMeshByIndex(k).lock();
-          int j = subMeshLock->MaterialIndex();
-
-          int i = 0;
-          if (j != -1)
-          {
-            i = worldMesh.IndexOfMaterial(mesh->MaterialByIndex(j).get());
-            if (i < 0)
-            {
-              i = worldMesh.AddMaterial(mesh->MaterialByIndex(j));
-            }
-          }
-          else
-          {
-            i = worldMesh.AddMaterial(mat);
-          }
-
-          scale = _geom->Data().MeshShape()->Scale();
-
-          addSubmeshFunc(i);
         }
       }
       else
       {
         ignwarn << "Unsupported geometry type" << std::endl;
       }
+    }
 
-      return true;
+    // Copying and scaling submeshes is the bulk of the work, and each
+    // visual is independent.
+    std::vector<VisualParts> parts(_visuals.size());
+    TaskPool pool;
+    pool.ParallelFor(_visuals.size(), [&](std::size_t _v)
+    {
+      if (meshes[_v] != nullptr)
+        parts[_v] = BuildParts(_visuals[_v], *meshes[_v]);
     });
 
+    // Merge in order, so the output doesn't depend on scheduling.
+    common::Mesh worldMesh;
+    worldMesh.SetName(_worldName);
+    std::vector<math::Matrix4d> subMeshMatrix;
+    for (auto &visualParts : parts)
+    {
+      for (auto &part : visualParts.parts)
+      {
+        int i = 0;
+        if (part.meshMaterial)
+        {
+          i = worldMesh.IndexOfMaterial(part.meshMaterial.get());
+          if (i < 0)
+            i = worldMesh.AddMaterial(part.meshMaterial);
+        }
+        else
+        {
+          i = worldMesh.AddMaterial(visualParts.material);
+        }
+
+        part.subMesh->SetMaterialIndex(i);
+        worldMesh.AddSubMesh(std::move(part.subMesh));
+        subMeshMatrix.push_back(part.matrix);
+      }
+      visualParts.parts.clear();
+    }
+
     common::ColladaExporter exporter;
     exporter.Export(&worldMesh, "./" + worldMesh.Name(), true,
                     subMeshMatrix);
     ignmsg << "The world has been exported into the "
            << "./" + worldMesh.Name() << " directory." << std::endl;
-    this->exported = true;
+  }
+
+  /// \brief Create the scaled submeshes of a visual.
+  /// \param[in] _visual Visual snapshot.
+  /// \param[in] _mesh Mesh of the visual's geometry.
+  /// \return The visual's submeshes and material.
+  private: static VisualParts BuildParts(const VisualSnapshot &_visual,
+      const common::Mesh &_mesh)
+  {
+    VisualParts result;
+    result.material = std::make_shared<common::Material>();
+    if (_visual.material)
+    {
+      result.material->SetDiffuse(_visual.material->Diffuse());
+      result.material->SetAmbient(_visual.material->Ambient());
+      result.material->SetEmissive(_visual.material->Emissive());
+      result.material->SetSpecular(_visual.material->Specular());
+    }
+    result.material->SetTransparency(_visual.transparency);
+
+    const auto &geom = _visual.geometry;
+    math::Pose3d worldPose = _visual.worldPose;
+    math::Vector3d scale;
+
+    if (geom.Type() == sdf::GeometryType::BOX)
+    {
+      scale = geom.BoxShape()->Size();
+    }
+    else if (geom.Type() == sdf::GeometryType::CYLINDER)
+    {
+      scale.X() = geom.CylinderShape()->Radius() * 2;
+      scale.Y() = scale.X();
+      scale.Z() = geom.CylinderShape()->Length();
+    }
+    else if (geom.Type() == sdf::GeometryType::PLANE)
+    {
+      // Create a rotation for the plane mesh to account
+      // for the normal vector.
+      scale.X() = geom.PlaneShape()->Size().X();
+      scale.Y() = geom.PlaneShape()->Size().Y();
+
+      // // The rotation is the angle between the +z(0,0,1) vector and the
+      // // normal, which are both expressed in the local (Visual) frame.
+      math::Vector3d normal = geom.PlaneShape()->Normal();
+      math::Quaterniond normalRot;
+      normalRot.From2Axes(math::Vector3d::UnitZ, normal.Normalized());
+      worldPose.Rot() = worldPose.Rot() * normalRot;
+    }
+    else if (geom.Type() == sdf::GeometryType::SPHERE)
+    {
+      scale.X() = geom.SphereShape()->Radius() * 2;
+      scale.Y() = scale.X();
+      scale.Z() = scale.X();
+    }
+    else if (geom.Type() == sdf::GeometryType::MESH)
+    {
+      scale = geom.MeshShape()->Scale();
+    }
+
+    math::Matrix4d matrix(worldPose);
+
+    auto addPart = [&](unsigned int _index,
+        common::MaterialPtr _meshMaterial)
+    {
+      SubMeshPart part;
+      part.subMesh = std::make_unique<common::SubMesh>(
+          *_mesh.SubMeshByIndex(_index).lock().get());
+      part.subMesh->Scale(scale);
+      part.meshMaterial = std::move(_meshMaterial);
+      part.matrix = matrix;
+      result.parts.push_back(std::move(part));
+    };
+
+    if (geom.Type() != sdf::GeometryType::MESH)
+    {
+      addPart(0, nullptr);
+      return result;
+    }
+
+    for (unsigned int k = 0; k < _mesh.SubMeshCount(); k++)
+    {
+      auto subMeshLock = _mesh.SubMeshByIndex(k).lock();
+      int j = subMeshLock->MaterialIndex();
+      addPart(k, j != -1 ? _mesh.MaterialByIndex(j) : nullptr);
+    }
+
+    return result;
   }
 };
 
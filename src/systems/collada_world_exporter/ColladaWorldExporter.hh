@@ -35,6 +35,10 @@ namespace systems
   /// \brief A plugin that exports a world to a mesh.
   /// When loaded the plugin will dump a mesh containing all the models in
   /// the world to the current directory.
+  /// The world is copied on the first update, and the mesh is built and
+  /// written on a background thread, so the simulation isn't blocked while
+  /// large worlds are exported. Destroying the system waits for the export
+  /// to finish.
   class ColladaWorldExporter:
     public System,
     public ISystemPostUpdate
@@ -19,6 +19,7 @@
 
 #include <ignition/msgs/contact.pb.h>
 #include <ignition/msgs/contacts.pb.h>
+#include <ignition/msgs/Utility.hh>
 
 #include <string>
 #include <unordered_map>
@@ -26,6 +27,7 @@
 #include <vector>
 
 #include <ignition/common/Profiler.hh>
+#include <ignition/math/Vector3.hh>
 #include <ignition/plugin/Register.hh>
 
 #include <sdf/Element.hh>
@@ -62,6 +64,16 @@ class ContactSensor
   public: void AddContacts(const std::chrono::steady_clock::duration &_stamp,
                            const msgs::Contacts &_contacts);
 
+  /// \brief Add one summarized contact per pair of collisions to the list to
+  /// be published. The summary holds the mean position and normal of all the
+  /// contact points of the pair, and their number in the "count" header
+  /// field.
+  /// \param[in] _stamp Time stamp of the sensor measurement
+  /// \param[in] _contacts Contacts to be summarized
+  public: void AddContactSummaries(
+      const std::chrono::steady_clock::duration &_stamp,
+      const msgs::Contacts &_contacts);
+
   /// \brief Publish sensor data over ign transport
   public: void Publish();
 
@@ -79,6 +91,10 @@ class ContactSensor
 
   /// \brief Entities for which this sensor publishes data
   public: std::vector<Entity> collisionEntities;
+
+  /// \brief Whether to publish a summary of each pair of collisions instead
+  /// of every contact point.
+  public: bool summary{false};
 };
 
 class ignition::gazebo::systems::ContactPrivate
@@ -100,6 +116,9 @@ class ignition::gazebo::systems::ContactPrivate
   /// \brief A map of Contact entity to its Contact sensor.
   public: std::unordered_map<Entity,
       std::unique_ptr<ContactSensor>> entitySensorMap;
+
+  /// \brief Whether sensors publish contact summaries, set by <summary>.
+  public: bool summary{false};
 };
 
 //////////////////////////////////////////////////
@@ -142,6 +161,45 @@ void ContactSensor::AddContacts(
   this->contactsMsg.mutable_header()->mutable_stamp()->CopyFrom(stamp);
 }
 
+//////////////////////////////////////////////////
+void ContactSensor::AddContactSummaries(
+    const std::chrono::steady_clock::duration &_stamp,
+    const msgs::Contacts &_contacts)
+{
+  auto stamp = convert<msgs::Time>(_stamp);
+  for (const auto &contact : _contacts.contact())
+  {
+    if (contact.position_size() == 0)
+      continue;
+
+    math::Vector3d position;
+    for (const auto &point : contact.position())
+      position += msgs::Convert(point);
+    position /= contact.position_size();
+
+    auto *newContact = this->contactsMsg.add_contact();
+    newContact->mutable_collision1()->CopyFrom(contact.collision1());
+    newContact->mutable_collision2()->CopyFrom(contact.collision2());
+    msgs::Set(newContact->add_position(), position);
+
+    if (contact.normal_size() > 0)
+    {
+      math::Vector3d normal;
+      for (const auto &n : contact.normal())
+        normal += msgs::Convert(n);
+      msgs::Set(newContact->add_normal(), normal.Normalize());
+    }
+
+    auto *header = newContact->mutable_header();
+    header->mutable_stamp()->CopyFrom(stamp);
+    auto *count = header->add_data();
+    count->set_key("count");
+    count->add_value(std::to_string(contact.position_size()));
+  }
+
+  this->contactsMsg.mutable_header()->mutable_stamp()->CopyFrom(stamp);
+}
+
 //////////////////////////////////////////////////
 void ContactSensor::Publish()
 {
@@ -204,6 +262,7 @@ void ContactPrivate::CreateSensors(EntityComponentManager &_ecm)
 
         auto sensor = std::make_unique<ContactSensor>();
         sensor->Load(_contact->Data(), defaultTopic, collisionEntities);
+        sensor->summary = this->summary;
         this->entitySensorMap.insert(
             std::make_pair(_entity, std::move(sensor)));
 
@@ -218,6 +277,12 @@ void ContactPrivate::UpdateSensors(const UpdateInfo &_info,
   IGN_PROFILE("ContactPrivate::UpdateSensors");
   for (const auto &item : this->entitySensorMap)
   {
+    // Nobody is listening, don't bother building the message. Systems such
+    // as the TouchPlugin read the ContactSensorData components directly, so
+    // they're not affected.
+    if (!item.second->pub.HasConnections())
+      continue;
+
     for (const Entity &entity : item.second->collisionEntities)
     {
       auto contacts = _ecm.Component<components::ContactSensorData>(entity);
@@ -226,7 +291,10 @@ void ContactPrivate::UpdateSensors(const UpdateInfo &_info,
       // this entity is in the collisionEntities list
       if (contacts->Data().contact_size() > 0)
       {
-        item.second->AddContacts(_info.simTime, contacts->Data());
+        if (item.second->summary)
+          item.second->AddContactSummaries(_info.simTime, contacts->Data());
+        else
+          item.second->AddContacts(_info.simTime, contacts->Data());
       }
     }
   }
@@ -259,6 +327,15 @@ Contact::Contact() : System(), dataPtr(std::make_unique<ContactPrivate>())
 {
 }
 
+//////////////////////////////////////////////////
+void Contact::Configure(const Entity &,
+                        const std::shared_ptr<const sdf::Element> &_sdf,
+                        EntityComponentManager &, EventManager &)
+{
+  if (_sdf->HasElement("summary"))
+    this->dataPtr->summary = _sdf->Get<bool>("summary");
+}
+
 //////////////////////////////////////////////////
 void Contact::PreUpdate(const UpdateInfo &, EntityComponentManager &_ecm)
 {
@@ -295,6 +372,7 @@ void Contact::PostUpdate(const UpdateInfo &_info,
 }
 
 IGNITION_ADD_PLUGIN(Contact, System,
+  Contact::ISystemConfigure,
   Contact::ISystemPreUpdate,
   Contact::ISystemPostUpdate
 )
@@ -36,8 +36,19 @@ namespace systems
   **/
   /// \brief Contact sensor system which manages all contact sensors in
   /// simulation
+  ///
+  /// Contact messages are only built for sensors whose topic has
+  /// subscribers.
+  ///
+  /// ## System Parameters
+  ///
+  /// - `<summary>`: If true, each published contact summarizes a pair of
+  /// collisions with the mean position and normal of its contact points, and
+  /// the number of points in the `count` header field, instead of holding
+  /// every point. Defaults to false.
   class Contact :
     public System,
+    public ISystemConfigure,
     public ISystemPreUpdate,
     public ISystemPostUpdate
   {
@@ -47,6 +58,12 @@ namespace systems
     /// \brief Destructor
     public: ~Contact() final = default;
 
+    /// Documentation inherited
+    public: void Configure(const Entity &_entity,
+                           const std::shared_ptr<const sdf::Element> &_sdf,
+                           EntityComponentManager &_ecm,
+                           EventManager &_eventMgr) final;
+
     /// Documentation inherited
     public: void PreUpdate(const UpdateInfo &_info,
                            EntityComponentManager &_ecm) final;
@@ -0,0 +1,536 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "CpuLidar.hh"
+
+#include <ignition/msgs/laserscan.pb.h>
+#include <ignition/msgs/pointcloud_packed.pb.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Mesh.hh>
+#include <ignition/common/MeshManager.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/SubMesh.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Rand.hh>
+#include <ignition/msgs/Utility.hh>
+#include <ignition/plugin/Register.hh>
+#include <ignition/transport/Node.hh>
+
+#include <sdf/Geometry.hh>
+#include <sdf/Lidar.hh>
+#include <sdf/Noise.hh>
+#include <sdf/Sensor.hh>
+
+#include "ignition/gazebo/components/Collision.hh"
+#include "ignition/gazebo/components/Geometry.hh"
+#include "ignition/gazebo/components/Lidar.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Sensor.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/RandomStream.hh"
+#include "ignition/gazebo/Util.hh"
+
+#include "RayCaster.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+namespace
+{
+/// \brief A lidar sensor and its publishers.
+struct LidarState
+{
+  /// \brief Scoped name of the sensor, used as the frame of its messages.
+  std::string frame;
+
+  /// \brief Publisher of scans.
+  transport::Node::Publisher scanPub;
+
+  /// \brief Publisher of point clouds.
+  transport::Node::Publisher pointsPub;
+
+  /// \brief Sim time between scans, zero to scan every iteration.
+  std::chrono::steady_clock::duration period{0};
+
+  /// \brief Sim time of the next scan.
+  std::chrono::steady_clock::duration nextScan{0};
+
+  /// \brief Minimum range, closer hits are reported as -inf.
+  double rangeMin{0.0};
+
+  /// \brief Maximum range, rays which hit nothing closer are reported as
+  /// +inf.
+  double rangeMax{0.0};
+
+  /// \brief Range noise.
+  sdf::Noise noise;
+
+  /// \brief Unit direction of each ray in the sensor frame, row by row
+  /// from the lowest vertical angle.
+  std::vector<math::Vector3d> directions;
+
+  /// \brief Scan message, whose ranges are filled in place.
+  msgs::LaserScan scan;
+
+  /// \brief Point cloud message, whose data is filled in place.
+  msgs::PointCloudPacked points;
+};
+
+/// \brief A collision rays are cast against.
+struct CollisionShape
+{
+  /// \brief Shape in the collision frame.
+  cpu_lidar::Shape shape;
+
+  /// \brief Whether the collision is an infinite plane.
+  bool plane{false};
+
+  /// \brief Normal of planes in the collision frame.
+  math::Vector3d normal;
+};
+}
+
+/// \brief Private CpuLidar data class.
+class ignition::gazebo::systems::CpuLidarPrivate
+{
+  /// \brief Create lidars and collisions which are new.
+  /// \param[in] _ecm Mutable reference to ECM.
+  public: void CreateEntities(EntityComponentManager &_ecm);
+
+  /// \brief Remove lidars and collisions which were removed.
+  /// \param[in] _ecm Immutable reference to ECM.
+  public: void RemoveEntities(const EntityComponentManager &_ecm);
+
+  /// \brief Add the shape of a collision.
+  /// \param[in] _entity Collision entity.
+  /// \param[in] _geom Collision geometry.
+  public: void AddCollision(const Entity _entity,
+      const sdf::Geometry &_geom);
+
+  /// \brief Get the triangles of a mesh, loading them if needed.
+  /// \param[in] _mesh Mesh geometry.
+  /// \return Triangles, or nullptr if the mesh couldn't be loaded.
+  public: std::shared_ptr<const cpu_lidar::TriangleMesh> LoadMesh(
+      const sdf::Mesh &_mesh);
+
+  /// \brief Cast the rays of a lidar and publish the results.
+  /// \param[in] _info Update info.
+  /// \param[in] _ecm Immutable reference to ECM.
+  /// \param[in] _entity Lidar entity.
+  /// \param[in] _lidar Lidar.
+  public: void Scan(const UpdateInfo &_info,
+      const EntityComponentManager &_ecm, const Entity _entity,
+      LidarState &_lidar);
+
+  /// \brief Transport node.
+  public: transport::Node node;
+
+  /// \brief Lidars by entity.
+  public: std::unordered_map<Entity, LidarState> lidars;
+
+  /// \brief Collisions by entity.
+  public: std::unordered_map<Entity, CollisionShape> collisions;
+
+  /// \brief Triangles of loaded meshes, by path and scale.
+  public: std::unordered_map<std::string,
+      std::shared_ptr<const cpu_lidar::TriangleMesh>> meshes;
+
+  /// \brief Collisions in the world frame, rebuilt once per iteration in
+  /// which a lidar scans.
+  public: cpu_lidar::RayCaster caster;
+};
+
+//////////////////////////////////////////////////
+CpuLidar::CpuLidar() : System(),
+    dataPtr(std::make_unique<CpuLidarPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+CpuLidar::~CpuLidar() = default;
+
+//////////////////////////////////////////////////
+void CpuLidar::PreUpdate(const UpdateInfo &/*_info*/,
+    EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("CpuLidar::PreUpdate");
+  this->dataPtr->CreateEntities(_ecm);
+}
+
+//////////////////////////////////////////////////
+void CpuLidar::PostUpdate(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("CpuLidar::PostUpdate");
+
+  // \TODO(anyone) Support rewind
+  if (_info.dt < std::chrono::steady_clock::duration::zero())
+  {
+    ignwarn << "Detected jump back in time ["
+        << std::chrono::duration_cast<std::chrono::seconds>(_info.dt).count()
+        << "s]. System may not work properly." << std::endl;
+  }
+
+  if (!_info.paused)
+  {
+    bool built{false};
+    for (auto &[entity, lidar] : this->dataPtr->lidars)
+    {
+      if (_info.simTime < lidar.nextScan)
+        continue;
+      lidar.nextScan = _info.simTime + lidar.period;
+
+      // Collisions are moved to their world poses once for all lidars
+      if (!built)
+      {
+        IGN_PROFILE("CpuLidar::BuildWorld");
+        auto &caster = this->dataPtr->caster;
+        caster.Clear();
+        for (const auto &[collision, shape] : this->dataPtr->collisions)
+        {
+          const math::Pose3d pose = worldPose(collision, _ecm);
+          if (shape.plane)
+          {
+            caster.AddPlane(pose.Rot().RotateVector(shape.normal),
+                pose.Pos());
+            continue;
+          }
+          cpu_lidar::Shape worldShape = shape.shape;
+          worldShape.pose = pose;
+          caster.AddShape(std::move(worldShape));
+        }
+        caster.Build();
+        built = true;
+      }
+
+      this->dataPtr->Scan(_info, _ecm, entity, lidar);
+    }
+  }
+
+  this->dataPtr->RemoveEntities(_ecm);
+}
+
+//////////////////////////////////////////////////
+void CpuLidarPrivate::CreateEntities(EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("CpuLidarPrivate::CreateEntities");
+  _ecm.EachNew<components::Collision, components::Geometry>(
+    [&](const Entity &_entity,
+        const components::Collision *,
+        const components::Geometry *_geom)->bool
+      {
+        this->AddCollision(_entity, _geom->Data());
+        return true;
+      });
+
+  _ecm.EachNew<components::Lidar, components::ParentEntity>(
+    [&](const Entity &_entity,
+        const components::Lidar *_lidar,
+        const components::ParentEntity *)->bool
+      {
+        const sdf::Sensor &sensor = _lidar->Data();
+        const sdf::Lidar *sdfLidar = sensor.LidarSensor();
+        if (nullptr == sdfLidar)
+        {
+          ignerr << "Lidar sensor [" << sensor.Name() << "] is missing its "
+                 << "<lidar> element." << std::endl;
+          return true;
+        }
+
+        LidarState lidar;
+        lidar.frame =
+            removeParentScope(scopedName(_entity, _ecm, "::", false), "::");
+        if (sensor.UpdateRate() > 0)
+        {
+          lidar.period = std::chrono::duration_cast<
+              std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>(1.0 / sensor.UpdateRate()));
+        }
+        lidar.rangeMin = sdfLidar->RangeMin();
+        lidar.rangeMax = sdfLidar->RangeMax();
+        lidar.noise = sdfLidar->LidarNoise();
+
+        // Resolution multiplies the samples, as for GPU lidars
+        auto rayCount = [](unsigned int _samples, double _resolution)
+        {
+          const double count = _resolution > 0 ?
+              std::round(_samples * _resolution) : _samples;
+          return std::max(1u, static_cast<unsigned int>(count));
+        };
+        const unsigned int hCount = rayCount(
+            sdfLidar->HorizontalScanSamples(),
+            sdfLidar->HorizontalScanResolution());
+        const unsigned int vCount = rayCount(
+            sdfLidar->VerticalScanSamples(),
+            sdfLidar->VerticalScanResolution());
+        const double hMin = sdfLidar->HorizontalScanMinAngle().Radian();
+        const double hMax = sdfLidar->HorizontalScanMaxAngle().Radian();
+        const double vMin = vCount > 1 ?
+            sdfLidar->VerticalScanMinAngle().Radian() : 0.0;
+        const double vMax = vCount > 1 ?
+            sdfLidar->VerticalScanMaxAngle().Radian() : 0.0;
+        const double hStep = hCount > 1 ? (hMax - hMin) / (hCount - 1) : 0.0;
+        const double vStep = vCount > 1 ? (vMax - vMin) / (vCount - 1) : 0.0;
+
+        lidar.directions.reserve(hCount * vCount);
+        for (unsigned int v = 0; v < vCount; ++v)
+        {
+          const double pitch = vMin + v * vStep;
+          for (unsigned int h = 0; h < hCount; ++h)
+          {
+            const double yaw = hMin + h * hStep;
+            lidar.directions.emplace_back(std::cos(pitch) * std::cos(yaw),
+                std::cos(pitch) * std::sin(yaw), std::sin(pitch));
+          }
+        }
+
+        std::string topic = sensor.Topic();
+        if (topic.empty())
+          topic = scopedName(_entity, _ecm) + "/scan";
+
+        auto &scan = lidar.scan;
+        scan.set_frame(lidar.frame);
+        auto frame = scan.mutable_header()->add_data();
+        frame->set_key("frame_id");
+        frame->add_value(lidar.frame);
+        scan.set_count(hCount);
+        scan.set_angle_min(hMin);
+        scan.set_angle_max(hMax);
+        scan.set_angle_step(hStep);
+        scan.set_vertical_count(vCount);
+        scan.set_vertical_angle_min(vMin);
+        scan.set_vertical_angle_max(vMax);
+        scan.set_vertical_angle_step(vStep);
+        scan.set_range_min(lidar.rangeMin);
+        scan.set_range_max(lidar.rangeMax);
+        for (std::size_t i = 0; i < lidar.directions.size(); ++i)
+        {
+          scan.add_ranges(0.0);
+          scan.add_intensities(0.0);
+        }
+
+        msgs::InitPointCloudPacked(lidar.points, lidar.frame, false,
+            {{"xyz", msgs::PointCloudPacked::Field::FLOAT32}});
+        lidar.points.set_width(hCount);
+        lidar.points.set_height(vCount);
+        lidar.points.set_is_dense(false);
+        lidar.points.set_row_step(lidar.points.point_step() * hCount);
+        lidar.points.mutable_data()->resize(
+            lidar.points.row_step() * vCount);
+
+        lidar.scanPub = this->node.Advertise<msgs::LaserScan>(topic);
+        lidar.pointsPub =
+            this->node.Advertise<msgs::PointCloudPacked>(topic + "/points");
+
+        _ecm.CreateComponent(_entity, components::SensorTopic(topic));
+
+        igndbg << "CPU lidar [" << lidar.frame << "] casts ["
+               << lidar.directions.size() << "] rays, publishing on ["
+               << topic << "]" << std::endl;
+
+        this->lidars[_entity] = std::move(lidar);
+        return true;
+      });
+}
+
+//////////////////////////////////////////////////
+void CpuLidarPrivate::AddCollision(const Entity _entity,
+    const sdf::Geometry &_geom)
+{
+  CollisionShape collision;
+  auto &shape = collision.shape;
+  switch (_geom.Type())
+  {
+    case sdf::GeometryType::BOX:
+      shape.type = cpu_lidar::ShapeType::BOX;
+      shape.size = _geom.BoxShape()->Size();
+      break;
+    case sdf::GeometryType::SPHERE:
+      shape.type = cpu_lidar::ShapeType::SPHERE;
+      shape.size.X(_geom.SphereShape()->Radius());
+      break;
+    case sdf::GeometryType::CYLINDER:
+      shape.type = cpu_lidar::ShapeType::CYLINDER;
+      shape.size.Set(_geom.CylinderShape()->Radius(), 0,
+          _geom.CylinderShape()->Length());
+      break;
+    case sdf::GeometryType::PLANE:
+      collision.plane = true;
+      collision.normal = _geom.PlaneShape()->Normal();
+      break;
+    case sdf::GeometryType::MESH:
+      shape.type = cpu_lidar::ShapeType::MESH;
+      shape.mesh = this->LoadMesh(*_geom.MeshShape());
+      if (nullptr == shape.mesh)
+        return;
+      break;
+    default:
+      return;
+  }
+  this->collisions[_entity] = std::move(collision);
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<const cpu_lidar::TriangleMesh> CpuLidarPrivate::LoadMesh(
+    const sdf::Mesh &_mesh)
+{
+  const std::string fullPath = findResource(_mesh.Uri(), _mesh.FilePath());
+  if (fullPath.empty())
+  {
+    ignwarn << "Failed to find mesh [" << _mesh.Uri() << "], lidars won't "
+            << "see it." << std::endl;
+    return nullptr;
+  }
+
+  const math::Vector3d scale = _mesh.Scale();
+  std::ostringstream key;
+  key << fullPath << ":" << scale;
+  auto iter = this->meshes.find(key.str());
+  if (iter != this->meshes.end())
+    return iter->second;
+
+  const common::Mesh *mesh = common::MeshManager::Instance()->Load(fullPath);
+  if (nullptr == mesh)
+  {
+    ignwarn << "Failed to load mesh from [" << fullPath << "], lidars won't "
+            << "see it." << std::endl;
+    this->meshes[key.str()] = nullptr;
+    return nullptr;
+  }
+
+  std::vector<math::Vector3d> vertices;
+  std::vector<unsigned int> indices;
+  for (unsigned int i = 0; i < mesh->SubMeshCount(); ++i)
+  {
+    auto subMesh = mesh->SubMeshByIndex(i).lock();
+    if (nullptr == subMesh)
+      continue;
+
+    const auto offset = static_cast<unsigned int>(vertices.size());
+    for (unsigned int v = 0; v < subMesh->VertexCount(); ++v)
+    {
+      const auto vertex = subMesh->Vertex(v);
+      vertices.emplace_back(vertex.X() * scale.X(), vertex.Y() * scale.Y(),
+          vertex.Z() * scale.Z());
+    }
+    for (unsigned int n = 0; n < subMesh->IndexCount(); ++n)
+      indices.push_back(offset + static_cast<unsigned int>(subMesh->Index(n)));
+  }
+
+  auto triangles = std::make_shared<cpu_lidar::TriangleMesh>();
+  triangles->Set(std::move(vertices), std::move(indices));
+  this->meshes[key.str()] = triangles;
+  return triangles;
+}
+
+//////////////////////////////////////////////////
+void CpuLidarPrivate::Scan(const UpdateInfo &_info,
+    const EntityComponentManager &_ecm, const Entity _entity,
+    LidarState &_lidar)
+{
+  IGN_PROFILE("CpuLidarPrivate::Scan");
+  const math::Pose3d pose = worldPose(_entity, _ecm);
+  const auto &directions = _lidar.directions;
+  auto *ranges = _lidar.scan.mutable_ranges()->mutable_data();
+
+  // Rays are independent, so they're split over threads
+  _ecm.ParallelFor(directions.size(), 256,
+      [&](std::size_t _begin, std::size_t _end)
+      {
+        for (std::size_t i = _begin; i < _end; ++i)
+        {
+          ranges[i] = this->caster.Cast(pose.Pos(),
+              pose.Rot().RotateVector(directions[i]), _lidar.rangeMax);
+        }
+      });
+
+  const bool gaussian = _lidar.noise.Type() == sdf::NoiseType::GAUSSIAN ||
+      _lidar.noise.Type() == sdf::NoiseType::GAUSSIAN_QUANTIZED;
+  auto *data = _lidar.points.mutable_data()->data();
+  const std::size_t pointStep = _lidar.points.point_step();
+  // Noise only depends on the sensor and the iteration, not on the
+  // scheduling of other systems drawing random numbers
+  RandomStream random(math::Rand::Seed(), _entity, _info.iterations);
+  for (std::size_t i = 0; i < directions.size(); ++i)
+  {
+    double &range = ranges[i];
+    if (std::isfinite(range) && gaussian)
+    {
+      range += random.Normal(_lidar.noise.Mean(), _lidar.noise.StdDev());
+    }
+    if (range < _lidar.rangeMin)
+      range = -std::numeric_limits<double>::infinity();
+
+    float point[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      point[axis] = std::isfinite(range) ?
+          static_cast<float>(directions[i][axis] * range) :
+          std::numeric_limits<float>::quiet_NaN();
+    }
+    std::memcpy(data + i * pointStep, point, sizeof(point));
+  }
+
+  auto stamp = math::durationToSecNsec(_info.simTime);
+  _lidar.scan.mutable_header()->mutable_stamp()->set_sec(stamp.first);
+  _lidar.scan.mutable_header()->mutable_stamp()->set_nsec(stamp.second);
+  msgs::Set(_lidar.scan.mutable_world_pose(), pose);
+  *_lidar.points.mutable_header()->mutable_stamp() =
+      _lidar.scan.header().stamp();
+
+  _lidar.scanPub.Publish(_lidar.scan);
+  if (_lidar.pointsPub.HasConnections())
+    _lidar.pointsPub.Publish(_lidar.points);
+}
+
+//////////////////////////////////////////////////
+void CpuLidarPrivate::RemoveEntities(const EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("CpuLidarPrivate::RemoveEntities");
+  _ecm.EachRemoved<components::Lidar>(
+    [&](const Entity &_entity, const components::Lidar *)->bool
+      {
+        this->lidars.erase(_entity);
+        return true;
+      });
+
+  _ecm.EachRemoved<components::Collision>(
+    [&](const Entity &_entity, const components::Collision *)->bool
+      {
+        this->collisions.erase(_entity);
+        return true;
+      });
+}
+
+IGNITION_ADD_PLUGIN(CpuLidar, System,
+  CpuLidar::ISystemPreUpdate,
+  CpuLidar::ISystemPostUpdate
+)
+
+IGNITION_ADD_PLUGIN_ALIAS(CpuLidar, "ignition::gazebo::systems::CpuLidar")
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_CPULIDAR_HH_
+#define IGNITION_GAZEBO_SYSTEMS_CPULIDAR_HH_
+
+#include <memory>
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/System.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  // Forward declarations.
+  class CpuLidarPrivate;
+
+  /// \class CpuLidar CpuLidar.hh ignition/gazebo/systems/CpuLidar.hh
+  /// \brief A lidar which casts rays against the collisions of the world on
+  /// the CPU, so it doesn't need a GPU or the rendering stack. It handles
+  /// sensors of type `lidar`, configured like `gpu_lidar` sensors, and
+  /// publishes the same messages:
+  ///
+  /// * ignition.msgs.LaserScan on the sensor's `<topic>`, which defaults
+  /// to `<scoped name>/scan`.
+  /// * ignition.msgs.PointCloudPacked, with points in the sensor frame,
+  /// on `<topic>/points`.
+  ///
+  /// Box, sphere, cylinder, plane and mesh collisions are supported. Rays
+  /// which start inside a primitive shape don't hit it, so sensors inside
+  /// their own link's collision see past it. Rays of a scan are spread
+  /// over the threads of the entity component manager. Gaussian range
+  /// noise is applied, other noise types are ignored.
+  class CpuLidar:
+    public System,
+    public ISystemPreUpdate,
+    public ISystemPostUpdate
+  {
+    /// \brief Constructor
+    public: explicit CpuLidar();
+
+    /// \brief Destructor
+    public: ~CpuLidar() override;
+
+    /// Documentation inherited
+    public: void PreUpdate(const UpdateInfo &_info,
+                           EntityComponentManager &_ecm) final;
+
+    /// Documentation inherited
+    public: void PostUpdate(const UpdateInfo &_info,
+                            const EntityComponentManager &_ecm) final;
+
+    /// \brief Private data pointer.
+    private: std::unique_ptr<CpuLidarPrivate> dataPtr;
+  };
+  }
+}
+}
+}
+#endif
@@ -0,0 +1,658 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_CPU_LIDAR_RAYCASTER_HH_
+#define IGNITION_GAZEBO_SYSTEMS_CPU_LIDAR_RAYCASTER_HH_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <ignition/math/Matrix3.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "ignition/gazebo/config.hh"
+
+namespace ignition::gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems::cpu_lidar
+{
+  /// \brief Distance returned by ray queries which don't hit anything.
+  constexpr double kNoHit = std::numeric_limits<double>::infinity();
+
+  /// \brief Bounding volume hierarchy over a set of boxes, to find the
+  /// boxes a ray goes through without testing all of them.
+  class Bvh
+  {
+    /// \brief Build the hierarchy, replacing the previous one.
+    /// \param[in] _min Minimum corner of each box.
+    /// \param[in] _max Maximum corner of each box.
+    public: void Build(const std::vector<math::Vector3d> &_min,
+                       const std::vector<math::Vector3d> &_max)
+    {
+      this->nodes.clear();
+      this->items.resize(_min.size());
+      for (std::size_t i = 0; i < this->items.size(); ++i)
+        this->items[i] = static_cast<unsigned int>(i);
+
+      if (!this->items.empty())
+        this->BuildNode(0, this->items.size(), _min, _max);
+    }
+
+    /// \brief Get whether the hierarchy has no boxes.
+    /// \return True if it's empty.
+    public: bool Empty() const
+    {
+      return this->nodes.empty();
+    }
+
+    /// \brief Find the nearest hit of a ray among the boxes it goes
+    /// through. Boxes are visited nearest first, and skipped once they're
+    /// further than the nearest hit found so far.
+    /// \param[in] _origin Origin of the ray.
+    /// \param[in] _dir Unit direction of the ray.
+    /// \param[in] _maxDist Distance beyond which hits are ignored.
+    /// \param[in] _hit Function called with the index of a box and the
+    /// current maximum distance, returning the distance of the ray's hit
+    /// with what the box contains, or kNoHit.
+    /// \return Distance of the nearest hit, or kNoHit.
+    public: template <typename HitT>
+            double Intersect(const math::Vector3d &_origin,
+                             const math::Vector3d &_dir, double _maxDist,
+                             HitT &&_hit) const
+    {
+      double nearest = kNoHit;
+      if (this->nodes.empty())
+        return nearest;
+
+      const math::Vector3d invDir(1.0 / _dir.X(), 1.0 / _dir.Y(),
+          1.0 / _dir.Z());
+
+      std::array<unsigned int, 64> stack;
+      std::size_t stackSize = 0;
+      stack[stackSize++] = 0;
+      while (stackSize > 0)
+      {
+        const Node &node = this->nodes[stack[--stackSize]];
+        if (!(SlabDistance(_origin, invDir, node.min, node.max) < _maxDist))
+          continue;
+
+        if (node.count > 0)
+        {
+          for (unsigned int i = node.first; i < node.first + node.count; ++i)
+          {
+            const double dist = _hit(this->items[i], _maxDist);
+            if (dist < nearest)
+            {
+              nearest = dist;
+              _maxDist = dist;
+            }
+          }
+          continue;
+        }
+
+        // Visit the nearest child first, it's pushed last
+        const unsigned int left = static_cast<unsigned int>(
+            &node - this->nodes.data()) + 1;
+        const unsigned int right = node.first;
+        const double leftDist = SlabDistance(_origin, invDir,
+            this->nodes[left].min, this->nodes[left].max);
+        const double rightDist = SlabDistance(_origin, invDir,
+            this->nodes[right].min, this->nodes[right].max);
+        if (stackSize + 2 > stack.size())
+          continue;
+        if (leftDist < rightDist)
+        {
+          stack[stackSize++] = right;
+          stack[stackSize++] = left;
+        }
+        else
+        {
+          stack[stackSize++] = left;
+          stack[stackSize++] = right;
+        }
+      }
+      return nearest;
+    }
+
+    /// \brief Get the distance at which a ray enters a box.
+    /// \param[in] _origin Origin of the ray.
+    /// \param[in] _invDir Inverse of each component of the ray direction.
+    /// \param[in] _min Minimum corner of the box.
+    /// \param[in] _max Maximum corner of the box.
+    /// \return Distance, zero if the origin is inside, or kNoHit if the ray
+    /// misses the box.
+    public: static double SlabDistance(const math::Vector3d &_origin,
+                                       const math::Vector3d &_invDir,
+                                       const math::Vector3d &_min,
+                                       const math::Vector3d &_max)
+    {
+      double tMin = 0.0;
+      double tMax = kNoHit;
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        double t0 = (_min[axis] - _origin[axis]) * _invDir[axis];
+        double t1 = (_max[axis] - _origin[axis]) * _invDir[axis];
+        if (t0 > t1)
+          std::swap(t0, t1);
+        // NaN, from an origin on a face of the box, leaves the bounds as
+        // they are
+        if (t0 > tMin)
+          tMin = t0;
+        if (t1 < tMax)
+          tMax = t1;
+        if (tMin > tMax)
+          return kNoHit;
+      }
+      return tMin;
+    }
+
+    /// \brief Build the node of a range of items and its children.
+    /// \param[in] _begin Beginning of the range in items.
+    /// \param[in] _end End of the range in items.
+    /// \param[in] _min Minimum corner of each box.
+    /// \param[in] _max Maximum corner of each box.
+    private: void BuildNode(std::size_t _begin, std::size_t _end,
+                            const std::vector<math::Vector3d> &_min,
+                            const std::vector<math::Vector3d> &_max)
+    {
+      const std::size_t index = this->nodes.size();
+      this->nodes.emplace_back();
+
+      math::Vector3d min(kNoHit, kNoHit, kNoHit);
+      math::Vector3d max(-kNoHit, -kNoHit, -kNoHit);
+      math::Vector3d centerMin = min;
+      math::Vector3d centerMax = max;
+      for (std::size_t i = _begin; i < _end; ++i)
+      {
+        const unsigned int item = this->items[i];
+        min.Min(_min[item]);
+        max.Max(_max[item]);
+        const math::Vector3d center = (_min[item] + _max[item]) * 0.5;
+        centerMin.Min(center);
+        centerMax.Max(center);
+      }
+
+      // Split the longest axis of the centers at the median
+      const math::Vector3d extent = centerMax - centerMin;
+      int axis = 0;
+      if (extent.Y() > extent[axis])
+        axis = 1;
+      if (extent.Z() > extent[axis])
+        axis = 2;
+
+      if (_end - _begin <= kLeafSize || !(extent[axis] > 0))
+      {
+        Node &leaf = this->nodes[index];
+        leaf.min = min;
+        leaf.max = max;
+        leaf.first = static_cast<unsigned int>(_begin);
+        leaf.count = static_cast<unsigned int>(_end - _begin);
+        return;
+      }
+
+      const std::size_t middle = _begin + (_end - _begin) / 2;
+      std::nth_element(this->items.begin() + _begin,
+          this->items.begin() + middle, this->items.begin() + _end,
+          [&](unsigned int _a, unsigned int _b)
+          {
+            return _min[_a][axis] + _max[_a][axis] <
+                   _min[_b][axis] + _max[_b][axis];
+          });
+
+      this->BuildNode(_begin, middle, _min, _max);
+      const std::size_t right = this->nodes.size();
+      this->BuildNode(middle, _end, _min, _max);
+
+      Node &node = this->nodes[index];
+      node.min = min;
+      node.max = max;
+      node.first = static_cast<unsigned int>(right);
+      node.count = 0;
+    }
+
+    /// \brief Maximum number of boxes in a leaf.
+    private: static constexpr std::size_t kLeafSize = 4;
+
+    /// \brief A node of the hierarchy. Its left child follows it.
+    private: struct Node
+    {
+      /// \brief Minimum corner of the node's bounds.
+      math::Vector3d min;
+
+      /// \brief Maximum corner of the node's bounds.
+      math::Vector3d max;
+
+      /// \brief First item of a leaf, or the right child of an inner node.
+      unsigned int first{0};
+
+      /// \brief Number of items of a leaf, zero for inner nodes.
+      unsigned int count{0};
+    };
+
+    /// \brief Nodes, the root being the first one.
+    private: std::vector<Node> nodes;
+
+    /// \brief Indices of the boxes, ordered so leaves cover ranges of it.
+    private: std::vector<unsigned int> items;
+  };
+
+  /// \brief Get the distance at which a ray enters a box centered on the
+  /// origin.
+  /// \param[in] _origin Origin of the ray in the box frame.
+  /// \param[in] _dir Unit direction of the ray in the box frame.
+  /// \param[in] _halfSize Half of the box size.
+  /// \return Distance, or kNoHit if the ray misses the box or starts inside
+  /// it.
+  inline double IntersectBox(const math::Vector3d &_origin,
+                             const math::Vector3d &_dir,
+                             const math::Vector3d &_halfSize)
+  {
+    if (std::abs(_origin.X()) <= _halfSize.X() &&
+        std::abs(_origin.Y()) <= _halfSize.Y() &&
+        std::abs(_origin.Z()) <= _halfSize.Z())
+    {
+      return kNoHit;
+    }
+    const math::Vector3d invDir(1.0 / _dir.X(), 1.0 / _dir.Y(),
+        1.0 / _dir.Z());
+    return Bvh::SlabDistance(_origin, invDir, -_halfSize, _halfSize);
+  }
+
+  /// \brief Get the distance at which a ray enters a sphere centered on
+  /// the origin.
+  /// \param[in] _origin Origin of the ray in the sphere frame.
+  /// \param[in] _dir Unit direction of the ray in the sphere frame.
+  /// \param[in] _radius Radius of the sphere.
+  /// \return Distance, or kNoHit if the ray misses the sphere or starts
+  /// inside it.
+  inline double IntersectSphere(const math::Vector3d &_origin,
+                                const math::Vector3d &_dir, double _radius)
+  {
+    const double b = _origin.Dot(_dir);
+    const double c = _origin.SquaredLength() - _radius * _radius;
+    if (c <= 0)
+      return kNoHit;
+    const double discriminant = b * b - c;
+    if (discriminant < 0)
+      return kNoHit;
+    const double t = -b - std::sqrt(discriminant);
+    return t >= 0 ? t : kNoHit;
+  }
+
+  /// \brief Get the distance at which a ray enters a cylinder centered on
+  /// the origin, along the Z axis.
+  /// \param[in] _origin Origin of the ray in the cylinder frame.
+  /// \param[in] _dir Unit direction of the ray in the cylinder frame.
+  /// \param[in] _radius Radius of the cylinder.
+  /// \param[in] _halfLength Half of the cylinder length.
+  /// \return Distance, or kNoHit if the ray misses the cylinder or starts
+  /// inside it.
+  inline double IntersectCylinder(const math::Vector3d &_origin,
+                                  const math::Vector3d &_dir,
+                                  double _radius, double _halfLength)
+  {
+    const double r2 = _radius * _radius;
+    const double originR2 =
+        _origin.X() * _origin.X() + _origin.Y() * _origin.Y();
+    if (originR2 <= r2 && std::abs(_origin.Z()) <= _halfLength)
+      return kNoHit;
+
+    double nearest = kNoHit;
+
+    // Side
+    const double a = _dir.X() * _dir.X() + _dir.Y() * _dir.Y();
+    if (a > 0)
+    {
+      const double b = _origin.X() * _dir.X() + _origin.Y() * _dir.Y();
+      const double discriminant = b * b - a * (originR2 - r2);
+      if (discriminant >= 0)
+      {
+        const double t = (-b - std::sqrt(discriminant)) / a;
+        if (t >= 0 && std::abs(_origin.Z() + t * _dir.Z()) <= _halfLength)
+          nearest = t;
+      }
+    }
+
+    // Caps
+    if (_dir.Z() != 0)
+    {
+      for (const double z : {-_halfLength, _halfLength})
+      {
+        const double t = (z - _origin.Z()) / _dir.Z();
+        if (t < 0 || t >= nearest)
+          continue;
+        const double x = _origin.X() + t * _dir.X();
+        const double y = _origin.Y() + t * _dir.Y();
+        if (x * x + y * y <= r2)
+          nearest = t;
+      }
+    }
+    return nearest;
+  }
+
+  /// \brief Triangles of a mesh in its own frame, with a hierarchy over
+  /// them for ray queries.
+  class TriangleMesh
+  {
+    /// \brief Set the triangles, and build the hierarchy over them.
+    /// \param[in] _vertices Vertices, already scaled.
+    /// \param[in] _indices Three vertex indices per triangle.
+    public: void Set(std::vector<math::Vector3d> _vertices,
+                     std::vector<unsigned int> _indices)
+    {
+      this->vertices = std::move(_vertices);
+      this->indices = std::move(_indices);
+      this->indices.resize(this->indices.size() / 3 * 3);
+
+      this->min.Set(kNoHit, kNoHit, kNoHit);
+      this->max.Set(-kNoHit, -kNoHit, -kNoHit);
+      const std::size_t count = this->indices.size() / 3;
+      std::vector<math::Vector3d> triMin(count, this->min);
+      std::vector<math::Vector3d> triMax(count, this->max);
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        for (std::size_t j = 0; j < 3; ++j)
+        {
+          const auto &vertex = this->vertices[this->indices[i * 3 + j]];
+          triMin[i].Min(vertex);
+          triMax[i].Max(vertex);
+        }
+        this->min.Min(triMin[i]);
+        this->max.Max(triMax[i]);
+      }
+      this->bvh.Build(triMin, triMax);
+    }
+
+    /// \brief Get the distance of the nearest triangle hit by a ray.
+    /// \param[in] _origin Origin of the ray in the mesh frame.
+    /// \param[in] _dir Unit direction of the ray in the mesh frame.
+    /// \param[in] _maxDist Distance beyond which hits are ignored.
+    /// \return Distance, or kNoHit.
+    public: double Intersect(const math::Vector3d &_origin,
+                             const math::Vector3d &_dir,
+                             double _maxDist) const
+    {
+      return this->bvh.Intersect(_origin, _dir, _maxDist,
+          [&](unsigned int _triangle, double _max)
+          {
+            const auto &v0 = this->vertices[this->indices[_triangle * 3]];
+            const auto &v1 = this->vertices[this->indices[_triangle * 3 + 1]];
+            const auto &v2 = this->vertices[this->indices[_triangle * 3 + 2]];
+            const double t = IntersectTriangle(_origin, _dir, v0, v1, v2);
+            return t <= _max ? t : kNoHit;
+          });
+    }
+
+    /// \brief Get the distance at which a ray hits a triangle, from either
+    /// side.
+    /// \param[in] _origin Origin of the ray.
+    /// \param[in] _dir Direction of the ray.
+    /// \param[in] _v0 First vertex.
+    /// \param[in] _v1 Second vertex.
+    /// \param[in] _v2 Third vertex.
+    /// \return Distance, or kNoHit.
+    public: static double IntersectTriangle(const math::Vector3d &_origin,
+                                            const math::Vector3d &_dir,
+                                            const math::Vector3d &_v0,
+                                            const math::Vector3d &_v1,
+                                            const math::Vector3d &_v2)
+    {
+      const math::Vector3d edge1 = _v1 - _v0;
+      const math::Vector3d edge2 = _v2 - _v0;
+      const math::Vector3d p = _dir.Cross(edge2);
+      const double det = edge1.Dot(p);
+      if (std::abs(det) < 1e-12)
+        return kNoHit;
+
+      const double invDet = 1.0 / det;
+      const math::Vector3d s = _origin - _v0;
+      const double u = s.Dot(p) * invDet;
+      if (u < 0 || u > 1)
+        return kNoHit;
+
+      const math::Vector3d q = s.Cross(edge1);
+      const double v = _dir.Dot(q) * invDet;
+      if (v < 0 || u + v > 1)
+        return kNoHit;
+
+      const double t = edge2.Dot(q) * invDet;
+      return t >= 0 ? t : kNoHit;
+    }
+
+    /// \brief Minimum corner of the mesh bounds.
+    public: math::Vector3d min;
+
+    /// \brief Maximum corner of the mesh bounds.
+    public: math::Vector3d max;
+
+    /// \brief Vertices.
+    private: std::vector<math::Vector3d> vertices;
+
+    /// \brief Three vertex indices per triangle.
+    private: std::vector<unsigned int> indices;
+
+    /// \brief Hierarchy over the triangles.
+    private: Bvh bvh;
+  };
+
+  /// \brief Type of a shape rays are cast against.
+  enum class ShapeType
+  {
+    /// \brief Box, whose size is the full size.
+    BOX,
+
+    /// \brief Sphere, whose radius is the X of the size.
+    SPHERE,
+
+    /// \brief Cylinder along Z, whose radius is the X of the size, and
+    /// length the Z.
+    CYLINDER,
+
+    /// \brief Triangle mesh.
+    MESH
+  };
+
+  /// \brief A shape with its world pose.
+  struct Shape
+  {
+    /// \brief Type of shape.
+    ShapeType type{ShapeType::BOX};
+
+    /// \brief World pose of the shape.
+    math::Pose3d pose;
+
+    /// \brief Size, see ShapeType.
+    math::Vector3d size;
+
+    /// \brief Triangles of mesh shapes.
+    std::shared_ptr<const TriangleMesh> mesh;
+  };
+
+  /// \brief Casts rays against shapes and infinite planes in the world
+  /// frame, using a hierarchy over the world bounds of the shapes.
+  /// Building the hierarchy isn't thread safe, but once it's built rays can
+  /// be cast from any number of threads.
+  class RayCaster
+  {
+    /// \brief Remove all shapes and planes.
+    public: void Clear()
+    {
+      this->shapes.clear();
+      this->planeNormals.clear();
+      this->planeOffsets.clear();
+    }
+
+    /// \brief Add a shape. Call Build once all shapes are added.
+    /// \param[in] _shape Shape to add.
+    public: void AddShape(Shape _shape)
+    {
+      this->shapes.push_back(std::move(_shape));
+    }
+
+    /// \brief Add an infinite plane, which is hit from either side.
+    /// \param[in] _normal Normal of the plane in the world frame.
+    /// \param[in] _point Point on the plane in the world frame.
+    public: void AddPlane(const math::Vector3d &_normal,
+                          const math::Vector3d &_point)
+    {
+      const math::Vector3d normal = _normal.Normalized();
+      this->planeNormals.push_back(normal);
+      this->planeOffsets.push_back(normal.Dot(_point));
+    }
+
+    /// \brief Build the hierarchy over the shapes.
+    public: void Build()
+    {
+      std::vector<math::Vector3d> min(this->shapes.size());
+      std::vector<math::Vector3d> max(this->shapes.size());
+      for (std::size_t i = 0; i < this->shapes.size(); ++i)
+      {
+        const auto &shape = this->shapes[i];
+        math::Vector3d center;
+        math::Vector3d halfSize;
+        switch (shape.type)
+        {
+          case ShapeType::BOX:
+            halfSize = shape.size * 0.5;
+            break;
+          case ShapeType::SPHERE:
+            halfSize.Set(shape.size.X(), shape.size.X(), shape.size.X());
+            break;
+          case ShapeType::CYLINDER:
+            halfSize.Set(shape.size.X(), shape.size.X(), shape.size.Z() * 0.5);
+            break;
+          case ShapeType::MESH:
+            if (shape.mesh)
+            {
+              center = (shape.mesh->min + shape.mesh->max) * 0.5;
+              halfSize = (shape.mesh->max - shape.mesh->min) * 0.5;
+            }
+            break;
+        }
+
+        // Bounds of the rotated box around the shape
+        const math::Matrix3d rot(shape.pose.Rot());
+        math::Vector3d extent;
+        for (int row = 0; row < 3; ++row)
+        {
+          extent[row] = std::abs(rot(row, 0)) * halfSize.X() +
+              std::abs(rot(row, 1)) * halfSize.Y() +
+              std::abs(rot(row, 2)) * halfSize.Z();
+        }
+        const math::Vector3d worldCenter = shape.pose.Pos() +
+            shape.pose.Rot().RotateVector(center);
+        min[i] = worldCenter - extent;
+        max[i] = worldCenter + extent;
+      }
+      this->bvh.Build(min, max);
+    }
+
+    /// \brief Get the number of shapes.
+    /// \return Number of shapes, not counting planes.
+    public: std::size_t ShapeCount() const
+    {
+      return this->shapes.size();
+    }
+
+    /// \brief Cast a ray.
+    /// \param[in] _origin Origin of the ray in the world frame.
+    /// \param[in] _dir Unit direction of the ray in the world frame.
+    /// \param[in] _maxDist Distance beyond which hits are ignored.
+    /// \return Distance of the nearest hit, or kNoHit.
+    public: double Cast(const math::Vector3d &_origin,
+                        const math::Vector3d &_dir, double _maxDist) const
+    {
+      double nearest = kNoHit;
+      for (std::size_t i = 0; i < this->planeNormals.size(); ++i)
+      {
+        const double denom = this->planeNormals[i].Dot(_dir);
+        if (denom == 0)
+          continue;
+        const double t = (this->planeOffsets[i] -
+            this->planeNormals[i].Dot(_origin)) / denom;
+        if (t >= 0 && t <= _maxDist && t < nearest)
+          nearest = t;
+      }
+      if (nearest < _maxDist)
+        _maxDist = nearest;
+
+      const double hit = this->bvh.Intersect(_origin, _dir, _maxDist,
+          [&](unsigned int _index, double _max)
+          {
+            const double t = this->CastShape(this->shapes[_index], _origin,
+                _dir, _max);
+            return t <= _max ? t : kNoHit;
+          });
+      return std::min(nearest, hit);
+    }
+
+    /// \brief Cast a ray against a shape.
+    /// \param[in] _shape Shape.
+    /// \param[in] _origin Origin of the ray in the world frame.
+    /// \param[in] _dir Unit direction of the ray in the world frame.
+    /// \param[in] _maxDist Distance beyond which hits are ignored.
+    /// \return Distance, or kNoHit.
+    private: static double CastShape(const Shape &_shape,
+                                     const math::Vector3d &_origin,
+                                     const math::Vector3d &_dir,
+                                     double _maxDist)
+    {
+      // Rigid transforms keep distances, so the ray is cast in the shape
+      // frame
+      const math::Vector3d origin =
+          _shape.pose.Rot().RotateVectorReverse(_origin - _shape.pose.Pos());
+      const math::Vector3d dir = _shape.pose.Rot().RotateVectorReverse(_dir);
+      switch (_shape.type)
+      {
+        case ShapeType::BOX:
+          return IntersectBox(origin, dir, _shape.size * 0.5);
+        case ShapeType::SPHERE:
+          return IntersectSphere(origin, dir, _shape.size.X());
+        case ShapeType::CYLINDER:
+          return IntersectCylinder(origin, dir, _shape.size.X(),
+              _shape.size.Z() * 0.5);
+        case ShapeType::MESH:
+          return _shape.mesh ? _shape.mesh->Intersect(origin, dir, _maxDist) :
+              kNoHit;
+      }
+      return kNoHit;
+    }
+
+    /// \brief Shapes.
+    private: std::vector<Shape> shapes;
+
+    /// \brief Hierarchy over the world bounds of the shapes.
+    private: Bvh bvh;
+
+    /// \brief Unit normal of each plane.
+    private: std::vector<math::Vector3d> planeNormals;
+
+    /// \brief Offset of each plane along its normal.
+    private: std::vector<double> planeOffsets;
+  };
+}
+}
+}
+
+#endif
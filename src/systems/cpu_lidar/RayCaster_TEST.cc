@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "RayCaster.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems::cpu_lidar;
+
+/////////////////////////////////////////////////
+TEST(RayCasterTest, Primitives)
+{
+  const math::Vector3d origin(0, 0, 0);
+  const math::Vector3d xAxis(1, 0, 0);
+
+  EXPECT_DOUBLE_EQ(1.5, IntersectBox(math::Vector3d(-2, 0, 0), xAxis,
+      math::Vector3d(0.5, 0.5, 0.5)));
+  EXPECT_DOUBLE_EQ(kNoHit, IntersectBox(math::Vector3d(-2, 1, 0), xAxis,
+      math::Vector3d(0.5, 0.5, 0.5)));
+  // Rays starting inside don't hit
+  EXPECT_DOUBLE_EQ(kNoHit, IntersectBox(origin, xAxis,
+      math::Vector3d(0.5, 0.5, 0.5)));
+
+  EXPECT_DOUBLE_EQ(1.0, IntersectSphere(math::Vector3d(-2, 0, 0), xAxis, 1));
+  EXPECT_DOUBLE_EQ(kNoHit, IntersectSphere(math::Vector3d(2, 0, 0), xAxis, 1));
+  EXPECT_DOUBLE_EQ(kNoHit, IntersectSphere(origin, xAxis, 1));
+
+  // Side and cap of a cylinder
+  EXPECT_DOUBLE_EQ(1.0, IntersectCylinder(math::Vector3d(-2, 0, 0), xAxis,
+      1, 1));
+  EXPECT_DOUBLE_EQ(2.0, IntersectCylinder(math::Vector3d(0, 0, 3),
+      math::Vector3d(0, 0, -1), 1, 1));
+  EXPECT_DOUBLE_EQ(kNoHit, IntersectCylinder(math::Vector3d(-2, 0, 1.5),
+      xAxis, 1, 1));
+
+  EXPECT_DOUBLE_EQ(2.0, TriangleMesh::IntersectTriangle(
+      math::Vector3d(0.2, 0.2, 2), math::Vector3d(0, 0, -1),
+      math::Vector3d(0, 0, 0), math::Vector3d(1, 0, 0),
+      math::Vector3d(0, 1, 0)));
+  EXPECT_DOUBLE_EQ(kNoHit, TriangleMesh::IntersectTriangle(
+      math::Vector3d(0.8, 0.8, 2), math::Vector3d(0, 0, -1),
+      math::Vector3d(0, 0, 0), math::Vector3d(1, 0, 0),
+      math::Vector3d(0, 1, 0)));
+}
+
+/////////////////////////////////////////////////
+TEST(RayCasterTest, Scene)
+{
+  RayCaster caster;
+  caster.AddPlane(math::Vector3d(0, 0, 1), math::Vector3d(0, 0, 0));
+
+  // A row of boxes along X, the nearest is hit
+  for (int i = 0; i < 100; ++i)
+  {
+    Shape box;
+    box.type = ShapeType::BOX;
+    box.pose = math::Pose3d(5.0 + i * 2, 0, 1, 0, 0, 0);
+    box.size = math::Vector3d(1, 1, 1);
+    caster.AddShape(box);
+  }
+
+  // A rotated cylinder lying along Y
+  Shape cylinder;
+  cylinder.type = ShapeType::CYLINDER;
+  cylinder.pose = math::Pose3d(-3, 0, 1, IGN_PI_2, 0, 0);
+  cylinder.size = math::Vector3d(0.5, 0, 10);
+  caster.AddShape(cylinder);
+
+  // A mesh of one square facing -Y
+  auto mesh = std::make_shared<TriangleMesh>();
+  mesh->Set({{-1, 0, -1}, {1, 0, -1}, {1, 0, 1}, {-1, 0, 1}},
+      {0, 1, 2, 0, 2, 3});
+  Shape meshShape;
+  meshShape.type = ShapeType::MESH;
+  meshShape.pose = math::Pose3d(0, 4, 1, 0, 0, 0);
+  meshShape.mesh = mesh;
+  caster.AddShape(meshShape);
+
+  caster.Build();
+  EXPECT_EQ(102u, caster.ShapeCount());
+
+  const math::Vector3d origin(0, 0, 1);
+  EXPECT_NEAR(4.5, caster.Cast(origin, math::Vector3d(1, 0, 0), 100), 1e-9);
+  EXPECT_NEAR(2.5, caster.Cast(origin, math::Vector3d(-1, 0, 0), 100), 1e-9);
+  EXPECT_NEAR(4.0, caster.Cast(origin, math::Vector3d(0, 1, 0), 100), 1e-9);
+  EXPECT_NEAR(1.0, caster.Cast(origin, math::Vector3d(0, 0, -1), 100), 1e-9);
+  EXPECT_DOUBLE_EQ(kNoHit, caster.Cast(origin, math::Vector3d(0, 0, 1), 100));
+
+  // Hits beyond the maximum distance are ignored
+  EXPECT_DOUBLE_EQ(kNoHit, caster.Cast(origin, math::Vector3d(1, 0, 0), 4));
+
+  // Rays hitting the far end of the row
+  const math::Vector3d high(0, 0, 1.2);
+  const double dist = caster.Cast(high,
+      math::Vector3d(1, 0, -0.001).Normalized(), 1000);
+  EXPECT_NEAR(4.5, dist, 1e-3);
+
+  caster.Clear();
+  caster.Build();
+  EXPECT_DOUBLE_EQ(kNoHit, caster.Cast(origin, math::Vector3d(1, 0, 0), 100));
+}
@@ -15,6 +15,10 @@
  *
  */
 
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
 #include <vector>
 
 #include <ignition/plugin/Register.hh>
@@ -39,6 +43,103 @@ using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+namespace ignition
+{
+namespace gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+namespace detachable_joint
+{
+/// \brief Index of model entities by name, shared by all the detachable
+/// joints of an ECM. The first joint to update it in an iteration applies
+/// the models created and removed since the last one.
+class ModelIndex
+{
+  /// \brief Get the index of an ECM, creating it if needed.
+  /// \param[in] _ecm Entity component manager
+  /// \return The shared index.
+  public: static std::shared_ptr<ModelIndex> Get(
+      const EntityComponentManager &_ecm)
+  {
+    return _ecm.SharedObject<ModelIndex>(
+        "ignition::gazebo::systems::detachable_joint::ModelIndex");
+  }
+
+  /// \brief Apply the models created and removed in this iteration. While
+  /// paused the iteration count doesn't advance, so every call applies them.
+  /// \param[in] _info Simulation update info
+  /// \param[in] _ecm Entity component manager
+  public: void Update(const UpdateInfo &_info,
+      const EntityComponentManager &_ecm)
+  {
+    if (!this->loaded)
+    {
+      _ecm.Each<components::Model, components::Name>(
+          [&](const Entity &_entity, const components::Model *,
+              const components::Name *_name) -> bool
+          {
+            this->models[_name->Data()].insert(_entity);
+            return true;
+          });
+      this->loaded = true;
+      this->iteration = _info.iterations;
+      return;
+    }
+
+    if (!_info.paused && this->iteration == _info.iterations)
+      return;
+    this->iteration = _info.iterations;
+
+    _ecm.EachNew<components::Model, components::Name>(
+        [&](const Entity &_entity, const components::Model *,
+            const components::Name *_name) -> bool
+        {
+          this->models[_name->Data()].insert(_entity);
+          return true;
+        });
+    _ecm.EachRemoved<components::Model, components::Name>(
+        [&](const Entity &_entity, const components::Model *,
+            const components::Name *_name) -> bool
+        {
+          auto it = this->models.find(_name->Data());
+          if (it != this->models.end())
+          {
+            it->second.erase(_entity);
+            if (it->second.empty())
+              this->models.erase(it);
+          }
+          return true;
+        });
+  }
+
+  /// \brief Find a model by name.
+  /// \param[in] _name Model name
+  /// \return The oldest model with that name, kNullEntity if none.
+  public: Entity Find(const std::string &_name) const
+  {
+    auto it = this->models.find(_name);
+    if (it == this->models.end() || it->second.empty())
+      return kNullEntity;
+    return *it->second.begin();
+  }
+
+  /// \brief Model entities by name.
+  private: std::map<std::string, std::set<Entity>> models;
+
+  /// \brief Whether the existing models have been indexed.
+  private: bool loaded{false};
+
+  /// \brief Iteration of the last update.
+  private: uint64_t iteration{0};
+};
+}
+}
+}
+}
+}
+
 /////////////////////////////////////////////////
 void DetachableJoint::Configure(const Entity &_entity,
                const std::shared_ptr<const sdf::Element> &_sdf,
@@ -105,6 +206,17 @@ void DetachableJoint::Configure(const Entity &_entity,
       "/detachable_joint/detach");
   this->topic = validTopic(topics);
 
+  std::vector<std::string> attachTopics;
+  if (_sdf->HasElement("attach_topic"))
+  {
+    attachTopics.push_back(_sdf->Get<std::string>("attach_topic"));
+  }
+  attachTopics.push_back("/model/" + this->model.Name(_ecm) +
+      "/detachable_joint/attach");
+  this->attachTopic = validTopic(attachTopics);
+
+  this->modelIndex = detachable_joint::ModelIndex::Get(_ecm);
+
   this->suppressChildWarning =
       _sdf->Get<bool>("suppress_child_warning", this->suppressChildWarning)
           .first;
@@ -113,80 +225,114 @@ void DetachableJoint::Configure(const Entity &_entity,
 }
 
 //////////////////////////////////////////////////
-void DetachableJoint::PreUpdate(
-  const ignition::gazebo::UpdateInfo &/*_info*/,
-  ignition::gazebo::EntityComponentManager &_ecm)
+Entity DetachableJoint::FindChildLink(const EntityComponentManager &_ecm)
 {
-  IGN_PROFILE("DetachableJoint::PreUpdate");
-  if (this->validConfig && !this->initialized)
+  // Look for the child model and link
+  Entity modelEntity{kNullEntity};
+
+  if ("__model__" == this->childModelName)
+  {
+    modelEntity = this->model.Entity();
+  }
+  else
   {
-    // Look for the child model and link
-    Entity modelEntity{kNullEntity};
+    modelEntity = this->modelIndex->Find(this->childModelName);
+  }
 
-    if ("__model__" == this->childModelName)
-    {
-      modelEntity = this->model.Entity();
-    }
-    else
-    {
-      modelEntity = _ecm.EntityByComponents(
-          components::Model(), components::Name(this->childModelName));
-    }
-    if (kNullEntity != modelEntity)
-    {
-      this->childLinkEntity = _ecm.EntityByComponents(
-          components::Link(), components::ParentEntity(modelEntity),
-          components::Name(this->childLinkName));
-
-      if (kNullEntity != this->childLinkEntity)
-      {
-        // Attach the models
-        // We do this by creating a detachable joint entity.
-        this->detachableJointEntity = _ecm.CreateEntity();
-
-        _ecm.CreateComponent(
-            this->detachableJointEntity,
-            components::DetachableJoint({this->parentLinkEntity,
-                                         this->childLinkEntity, "fixed"}));
-
-        this->node.Subscribe(
-            this->topic, &DetachableJoint::OnDetachRequest, this);
-
-        ignmsg << "DetachableJoint subscribing to messages on "
-               << "[" << this->topic << "]" << std::endl;
-
-        this->initialized = true;
-      }
-      else
-      {
-        ignwarn << "Child Link " << this->childLinkName
-                << " could not be found.\n";
-      }
-    }
-    else if (!this->suppressChildWarning)
+  if (kNullEntity == modelEntity)
+  {
+    if (!this->suppressChildWarning)
     {
       ignwarn << "Child Model " << this->childModelName
               << " could not be found.\n";
     }
+    return kNullEntity;
   }
 
-  if (this->initialized)
+  auto linkEntity = Model(modelEntity).LinkByName(_ecm, this->childLinkName);
+  if (kNullEntity == linkEntity)
+  {
+    ignwarn << "Child Link " << this->childLinkName
+            << " could not be found.\n";
+  }
+  return linkEntity;
+}
+
+//////////////////////////////////////////////////
+void DetachableJoint::PreUpdate(
+  const ignition::gazebo::UpdateInfo &_info,
+  ignition::gazebo::EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("DetachableJoint::PreUpdate");
+  if (!this->validConfig)
+    return;
+
+  this->modelIndex->Update(_info, _ecm);
+
+  // Invalidate the cached child link if it's been removed, so a new child
+  // with the same name can be attached
+  if (kNullEntity != this->childLinkEntity &&
+      !_ecm.HasEntity(this->childLinkEntity))
   {
-    if (this->detachRequested && (kNullEntity != this->detachableJointEntity))
+    this->childLinkEntity = kNullEntity;
+    if (kNullEntity != this->detachableJointEntity)
     {
-      // Detach the models
-      igndbg << "Removing entity: " << this->detachableJointEntity << std::endl;
       _ecm.RequestRemoveEntity(this->detachableJointEntity);
       this->detachableJointEntity = kNullEntity;
-      this->detachRequested = false;
     }
   }
+
+  bool attach = this->attachRequested;
+  if (attach && kNullEntity == this->detachableJointEntity)
+  {
+    if (kNullEntity == this->childLinkEntity)
+      this->childLinkEntity = this->FindChildLink(_ecm);
+
+    if (kNullEntity != this->childLinkEntity)
+    {
+      // Attach the models
+      // We do this by creating a detachable joint entity.
+      this->detachableJointEntity = _ecm.CreateEntity();
+
+      _ecm.CreateComponent(
+          this->detachableJointEntity,
+          components::DetachableJoint({this->parentLinkEntity,
+                                       this->childLinkEntity, "fixed"}));
+    }
+  }
+  else if (!attach && kNullEntity != this->detachableJointEntity)
+  {
+    // Detach the models
+    igndbg << "Removing entity: " << this->detachableJointEntity << std::endl;
+    _ecm.RequestRemoveEntity(this->detachableJointEntity);
+    this->detachableJointEntity = kNullEntity;
+  }
+
+  if (!this->initialized && kNullEntity != this->detachableJointEntity)
+  {
+    this->node.Subscribe(
+        this->topic, &DetachableJoint::OnDetachRequest, this);
+    this->node.Subscribe(
+        this->attachTopic, &DetachableJoint::OnAttachRequest, this);
+
+    ignmsg << "DetachableJoint subscribing to messages on "
+           << "[" << this->topic << "] and [" << this->attachTopic << "]"
+           << std::endl;
+
+    this->initialized = true;
+  }
 }
 
 //////////////////////////////////////////////////
 void DetachableJoint::OnDetachRequest(const msgs::Empty &)
 {
-  this->detachRequested = true;
+  this->attachRequested = false;
+}
+
+//////////////////////////////////////////////////
+void DetachableJoint::OnAttachRequest(const msgs::Empty &)
+{
+  this->attachRequested = true;
 }
 
 IGNITION_ADD_PLUGIN(DetachableJoint,
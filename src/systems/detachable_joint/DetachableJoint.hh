@@ -20,6 +20,7 @@
 
 #include <ignition/msgs/empty.pb.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <ignition/transport/Node.hh>
@@ -35,8 +36,23 @@ namespace gazebo
 inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
 namespace systems
 {
+namespace detachable_joint
+{
+  // Forward declaration
+  class ModelIndex;
+}
+
   /// \brief A system that initially attaches two models via a fixed joint and
-  /// allows for the models to get detached during simulation via a topic.
+  /// allows for the models to get detached and attached again during
+  /// simulation via topics.
+  ///
+  /// The child model is found through a name index shared by all detachable
+  /// joints of a simulation, which is only updated when models are created
+  /// or removed. The resolved child link is cached until it's removed, after
+  /// which the child model is looked up again, so a respawned child gets
+  /// attached. Requests received between updates are applied together, and
+  /// Physics processes all the joints created or removed in an update in a
+  /// single pass.
   ///
   /// Parameters:
   ///
@@ -50,6 +66,10 @@ namespace systems
   ///
   /// <topic> (optional): Topic name to be used for detaching connections
   ///
+  /// <attach_topic> (optional): Topic name to be used for attaching the
+  /// models again after they've been detached. Defaults to
+  /// `/model/<model_name>/detachable_joint/attach`.
+  ///
   /// <suppress_child_warning> (optional): If true, the system
   /// will not print a warning message if a child model does not exist yet.
   /// Otherwise, a warning message is printed. Defaults to false.
@@ -76,6 +96,14 @@ namespace systems
     /// \brief Callback for detach request topic
     private: void OnDetachRequest(const msgs::Empty &_msg);
 
+    /// \brief Callback for attach request topic
+    private: void OnAttachRequest(const msgs::Empty &_msg);
+
+    /// \brief Find the child link, using the shared model index.
+    /// \param[in] _ecm Entity component manager
+    /// \return The child link entity, kNullEntity if not found.
+    private: Entity FindChildLink(const EntityComponentManager &_ecm);
+
     /// \brief The model associated with this system.
     private: Model model;
 
@@ -88,6 +116,12 @@ namespace systems
     /// \brief Topic to be used for detaching connections
     private: std::string topic;
 
+    /// \brief Topic to be used for attaching connections
+    private: std::string attachTopic;
+
+    /// \brief Model names shared with the other detachable joints.
+    private: std::shared_ptr<detachable_joint::ModelIndex> modelIndex;
+
     /// \brief Whether to suppress warning about missing child model.
     private: bool suppressChildWarning{false};
 
@@ -100,8 +134,9 @@ namespace systems
     /// \brief Entity of the detachable joint created by this system
     private: Entity detachableJointEntity{kNullEntity};
 
-    /// \brief Whether detachment has been requested
-    private: std::atomic<bool> detachRequested{false};
+    /// \brief Whether the models should be attached. Set by the latest
+    /// attach or detach request.
+    private: std::atomic<bool> attachRequested{true};
 
     /// \brief Ignition communication node.
     public: transport::Node node;
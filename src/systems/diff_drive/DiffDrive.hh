@@ -60,7 +60,10 @@ namespace systems
   ///
   /// `<odom_topic>`: Custom topic on which this system will publish odometry
   /// messages. This element if optional, and the default value is
-  /// `/model/{name_of_model}/odometry`.
+  /// `/model/{name_of_model}/odometry`. Other systems of the simulation can
+  /// receive the same messages without serialization, from the
+  /// `ignition::msgs::Odometry` channel of the same name, see
+  /// EventManager::Channel.
   ///
   /// `<tf_topic>`: Custom topic on which this system will publish the
   /// transform from `frame_id` to `child_frame_id`. This element if optional,
@@ -77,6 +80,19 @@ namespace systems
   /// `ignition.msgs.Pose_V` message and the `<odom_topic>`
   /// `ignition.msgs.Odometry` message. This element if optional,
   ///  and the default value is `{name_of_model}/{name_of_link}`.
+  ///
+  /// `<aggregate_odometry>`: Set to true to publish this vehicle's odometry
+  /// packed with that of all other vehicles in the world that have the same
+  /// aggregate topic and `<odom_publish_frequency>`, including vehicles
+  /// driven by AckermannSteering, instead of on `<odom_topic>` and
+  /// `<tf_topic>`. The packed `ignition.msgs.Pose_V` message holds one
+  /// pose per vehicle, with the frame ids in its header, and lags one
+  /// iteration behind. Twist isn't included. This element is optional, and
+  /// the default value is false.
+  ///
+  /// `<aggregate_odometry_topic>`: Topic of the packed odometry message.
+  /// This element is optional, and the default value is
+  /// `/world/{name_of_world}/odometry_aggregate`.
   class DiffDrive
       : public System,
         public ISystemConfigure,
@@ -66,7 +66,10 @@ class ignition::gazebo::systems::ImuPrivate
 
   /// \brief Update IMU sensor data based on physics data
   /// \param[in] _ecm Immutable reference to ECM.
-  public: void Update(const EntityComponentManager &_ecm);
+  /// \param[in] _now Current simulation time. Only the sensors which are
+  /// due are given data and updated.
+  public: void Update(const EntityComponentManager &_ecm,
+      const std::chrono::steady_clock::duration &_now);
 
   /// \brief Remove IMU sensors if their entities have been removed from
   /// simulation.
@@ -107,15 +110,10 @@ void Imu::PostUpdate(const UpdateInfo &_info,
   // Only update and publish if not paused.
   if (!_info.paused)
   {
-    this->dataPtr->Update(_ecm);
-
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      // Update measurement time
-      auto time = math::durationToSecNsec(_info.simTime);
-      dynamic_cast<sensors::Sensor *>(it.second.get())->Update(
-          math::secNsecToDuration(time.first, time.second), false);
-    }
+    // Update measurement time
+    auto time = math::durationToSecNsec(_info.simTime);
+    this->dataPtr->Update(_ecm,
+        math::secNsecToDuration(time.first, time.second));
   }
 
   this->dataPtr->RemoveImuEntities(_ecm);
@@ -194,7 +192,8 @@ void ImuPrivate::CreateImuEntities(EntityComponentManager &_ecm)
 }
 
 //////////////////////////////////////////////////
-void ImuPrivate::Update(const EntityComponentManager &_ecm)
+void ImuPrivate::Update(const EntityComponentManager &_ecm,
+    const std::chrono::steady_clock::duration &_now)
 {
   IGN_PROFILE("ImuPrivate::Update");
   _ecm.Each<components::Imu,
@@ -210,6 +209,10 @@ void ImuPrivate::Update(const EntityComponentManager &_ecm)
         auto it = this->entitySensorMap.find(_entity);
         if (it != this->entitySensorMap.end())
         {
+          // Sensors which aren't due don't need any data
+          if (it->second->NextDataUpdateTime() > _now)
+            return true;
+
           const auto &imuWorldPose = _worldPose->Data();
           it->second->SetWorldPose(imuWorldPose);
 
@@ -218,7 +221,11 @@ void ImuPrivate::Update(const EntityComponentManager &_ecm)
 
           // Set the IMU linear acceleration in the imu local frame
           it->second->SetLinearAcceleration(_linearAccel->Data());
-         }
+
+          // The data and the update share a single pass over the sensors
+          static_cast<sensors::Sensor *>(it->second.get())->Update(
+              _now, false);
+        }
         else
         {
           ignerr << "Failed to update IMU: " << _entity << ". "
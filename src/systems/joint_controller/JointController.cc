@@ -19,6 +19,7 @@
 
 #include <ignition/msgs/double.pb.h>
 
+#include <memory>
 #include <string>
 
 #include <ignition/common/Profiler.hh>
@@ -31,12 +32,17 @@
 #include "ignition/gazebo/components/JointVelocityCmd.hh"
 #include "ignition/gazebo/Model.hh"
 
+#include "../../JointPidBatch.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
 class ignition::gazebo::systems::JointControllerPrivate
 {
+  /// \brief Destructor, leaves the PID batch
+  public: ~JointControllerPrivate();
+
   /// \brief Callback for velocity subscription
   /// \param[in] _msg Velocity message
   public: void OnCmdVel(const ignition::msgs::Double &_msg);
@@ -51,7 +57,7 @@ class ignition::gazebo::systems::JointControllerPrivate
   public: std::string jointName;
 
   /// \brief Commanded joint velocity
-  public: double jointVelCmd;
+  public: double jointVelCmd{0.0};
 
   /// \brief mutex to protect jointVelCmd
   public: std::mutex jointVelCmdMutex;
@@ -65,8 +71,23 @@ class ignition::gazebo::systems::JointControllerPrivate
 
   /// \brief Velocity PID controller.
   public: ignition::math::PID velPid;
+
+  /// \brief Batch evaluating this controller's PID together with the PIDs
+  /// of all other batched joint controllers, null if not batched. Only
+  /// force commands use a PID.
+  public: std::shared_ptr<JointPidBatch> batch;
+
+  /// \brief Id of this controller in the batch.
+  public: uint64_t batchId{0};
 };
 
+//////////////////////////////////////////////////
+JointControllerPrivate::~JointControllerPrivate()
+{
+  if (this->batch)
+    this->batch->Remove(this->batchId);
+}
+
 //////////////////////////////////////////////////
 JointController::JointController()
   : dataPtr(std::make_unique<JointControllerPrivate>())
@@ -122,6 +143,20 @@ void JointController::Configure(const Entity &_entity,
 
     this->dataPtr->velPid.Init(p, i, d, iMax, iMin, cmdMax, cmdMin, cmdOffset);
 
+    if (_sdf->Get<bool>("batch", true).first)
+    {
+      JointPidBatch::Controller controller;
+      controller.model = _entity;
+      controller.jointName = this->dataPtr->jointName;
+      controller.input = JointPidBatch::Input::VELOCITY;
+      controller.gains = {p, i, d, iMax, iMin, cmdMax, cmdMin, cmdOffset};
+      controller.owner = "JointController";
+      this->dataPtr->batch = JointPidBatch::Get(_ecm);
+      this->dataPtr->batchId = this->dataPtr->batch->Add(controller);
+      this->dataPtr->batch->SetTarget(this->dataPtr->batchId,
+          this->dataPtr->jointVelCmd);
+    }
+
     igndbg << "[JointController] Force mode with parameters:" << std::endl;
     igndbg << "p_gain: ["     << p         << "]"             << std::endl;
     igndbg << "i_gain: ["     << i         << "]"             << std::endl;
@@ -131,6 +166,8 @@ void JointController::Configure(const Entity &_entity,
     igndbg << "cmd_max: ["    << cmdMax    << "]"             << std::endl;
     igndbg << "cmd_min: ["    << cmdMin    << "]"             << std::endl;
     igndbg << "cmd_offset: [" << cmdOffset << "]"             << std::endl;
+    igndbg << "batched: ["    << (this->dataPtr->batch != nullptr) << "]"
+           << std::endl;
   }
   else
   {
@@ -181,6 +218,14 @@ void JointController::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
         << "s]. System may not work properly." << std::endl;
   }
 
+  // Batched controllers are updated together by the first of them to run
+  if (this->dataPtr->batch)
+  {
+    if (!_info.paused)
+      this->dataPtr->batch->Update(_info, _ecm);
+    return;
+  }
+
   // If the joint hasn't been identified yet, look for it
   if (this->dataPtr->jointEntity == kNullEntity)
   {
@@ -253,6 +298,12 @@ void JointController::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
 //////////////////////////////////////////////////
 void JointControllerPrivate::OnCmdVel(const msgs::Double &_msg)
 {
+  if (this->batch)
+  {
+    this->batch->SetTarget(this->batchId, _msg.data());
+    return;
+  }
+
   std::lock_guard<std::mutex> lock(this->jointVelCmdMutex);
   this->jointVelCmd = _msg.data();
 }
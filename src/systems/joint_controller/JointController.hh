@@ -74,6 +74,11 @@ namespace systems
   ///
   /// `<cmd_offset>` Command offset (feed-forward) of the PID.
   /// The default value is 0.
+  ///
+  /// `<batch>` Evaluate the PID together with the PIDs of all other batched
+  /// joint controllers of the world, in a single pass, instead of on its
+  /// own. Only used with `<use_force_commands>`. The results are the same.
+  /// The default value is true.
   class JointController
       : public System,
         public ISystemConfigure,
@@ -19,6 +19,7 @@
 
 #include <ignition/msgs/double.pb.h>
 
+#include <memory>
 #include <string>
 
 #include <ignition/common/Profiler.hh>
@@ -30,12 +31,17 @@
 #include "ignition/gazebo/components/JointPosition.hh"
 #include "ignition/gazebo/Model.hh"
 
+#include "../../JointPidBatch.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
 class ignition::gazebo::systems::JointPositionControllerPrivate
 {
+  /// \brief Destructor, leaves the PID batch
+  public: ~JointPositionControllerPrivate();
+
   /// \brief Callback for position subscription
   /// \param[in] _msg Position message
   public: void OnCmdPos(const ignition::msgs::Double &_msg);
@@ -63,8 +69,22 @@ class ignition::gazebo::systems::JointPositionControllerPrivate
 
   /// \brief Joint index to be used.
   public: unsigned int jointIndex = 0u;
+
+  /// \brief Batch evaluating this controller's PID together with the PIDs
+  /// of all other batched joint controllers, null if not batched.
+  public: std::shared_ptr<JointPidBatch> batch;
+
+  /// \brief Id of this controller in the batch.
+  public: uint64_t batchId{0};
 };
 
+//////////////////////////////////////////////////
+JointPositionControllerPrivate::~JointPositionControllerPrivate()
+{
+  if (this->batch)
+    this->batch->Remove(this->batchId);
+}
+
 //////////////////////////////////////////////////
 JointPositionController::JointPositionController()
   : dataPtr(std::make_unique<JointPositionControllerPrivate>())
@@ -146,6 +166,19 @@ void JointPositionController::Configure(const Entity &_entity,
 
   this->dataPtr->posPid.Init(p, i, d, iMax, iMin, cmdMax, cmdMin, cmdOffset);
 
+  if (_sdf->Get<bool>("batch", true).first)
+  {
+    JointPidBatch::Controller controller;
+    controller.model = _entity;
+    controller.jointName = this->dataPtr->jointName;
+    controller.axis = this->dataPtr->jointIndex;
+    controller.input = JointPidBatch::Input::POSITION;
+    controller.gains = {p, i, d, iMax, iMin, cmdMax, cmdMin, cmdOffset};
+    controller.owner = "JointPositionController";
+    this->dataPtr->batch = JointPidBatch::Get(_ecm);
+    this->dataPtr->batchId = this->dataPtr->batch->Add(controller);
+  }
+
   // Subscribe to commands
   std::string topic = transport::TopicUtils::AsValidTopic("/model/" +
       this->dataPtr->model.Name(_ecm) + "/joint/" + this->dataPtr->jointName +
@@ -182,6 +215,8 @@ void JointPositionController::Configure(const Entity &_entity,
   igndbg << "cmd_min: ["    << cmdMin    << "]"            << std::endl;
   igndbg << "cmd_offset: [" << cmdOffset << "]"            << std::endl;
   igndbg << "Topic: ["      << topic     << "]"            << std::endl;
+  igndbg << "Batched: ["    << (this->dataPtr->batch != nullptr) << "]"
+         << std::endl;
 }
 
 //////////////////////////////////////////////////
@@ -199,6 +234,14 @@ void JointPositionController::PreUpdate(
         << "s]. System may not work properly." << std::endl;
   }
 
+  // Batched controllers are updated together by the first of them to run
+  if (this->dataPtr->batch)
+  {
+    if (!_info.paused)
+      this->dataPtr->batch->Update(_info, _ecm);
+    return;
+  }
+
   // If the joint hasn't been identified yet, look for it
   if (this->dataPtr->jointEntity == kNullEntity)
   {
@@ -266,6 +309,12 @@ void JointPositionController::PreUpdate(
 //////////////////////////////////////////////////
 void JointPositionControllerPrivate::OnCmdPos(const msgs::Double &_msg)
 {
+  if (this->batch)
+  {
+    this->batch->SetTarget(this->batchId, _msg.data());
+    return;
+  }
+
   std::lock_guard<std::mutex> lock(this->jointCmdMutex);
   this->jointPosCmd = _msg.data();
 }
@@ -71,6 +71,11 @@ namespace systems
   ///
   /// `<cmd_offset>` Command offset (feed-forward) of the PID. Optional
   /// parameter. The default value is 0.
+  ///
+  /// `<batch>` Evaluate the PID together with the PIDs of all other batched
+  /// joint controllers of the world, in a single pass, instead of on its
+  /// own. The results are the same. Optional parameter. The default value
+  /// is true.
   class JointPositionController
       : public System,
         public ISystemConfigure,
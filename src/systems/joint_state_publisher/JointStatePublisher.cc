@@ -19,6 +19,8 @@
 
 #include <ignition/msgs/model.pb.h>
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -56,6 +58,9 @@ void JointStatePublisher::Configure(
     return;
   }
 
+  this->publishThreshold = std::max(0.0,
+      _sdf->Get<double>("publish_threshold", 0.0).first);
+
   // If a joint_name is specified in the plugin, then only publish the
   // specified joints. Otherwise, publish all the joints.
   if (_sdf->HasElement("joint_name"))
@@ -154,33 +159,72 @@ void JointStatePublisher::PostUpdate(const UpdateInfo &_info,
   if (!this->modelPub)
     return;
 
-  // Create the message
-  msgs::Model msg;
-  msg.mutable_header()->mutable_stamp()->CopyFrom(
-      convert<msgs::Time>(_info.simTime));
+  if (!this->msgBuilt)
+    this->BuildMessage(_ecm);
 
-  // Set the name and ID.
-  msg.set_name(this->model.Name(_ecm));
-  msg.set_id(this->model.Entity());
+  bool changed = this->FillJointStates(_ecm);
+  if (this->publishThreshold > 0.0 && !changed)
+    return;
+
+  this->msg.mutable_header()->mutable_stamp()->CopyFrom(
+      convert<msgs::Time>(_info.simTime));
 
   // Set the model pose
   const auto *pose = _ecm.Component<components::Pose>(
       this->model.Entity());
   if (pose)
-    msgs::Set(msg.mutable_pose(), pose->Data());
+    msgs::Set(this->msg.mutable_pose(), pose->Data());
+
+  // Publish the message.
+  this->modelPub->Publish(this->msg);
+}
+
+//////////////////////////////////////////////////
+void JointStatePublisher::BuildMessage(const EntityComponentManager &_ecm)
+{
+  // Set the name and ID.
+  this->msg.set_name(this->model.Name(_ecm));
+  this->msg.set_id(this->model.Entity());
 
-  // Process each joint
   for (const Entity &joint : this->joints)
   {
     // Add a joint message.
-    msgs::Joint *jointMsg = msg.add_joint();
+    msgs::Joint *jointMsg = this->msg.add_joint();
     jointMsg->set_name(_ecm.Component<components::Name>(joint)->Data());
     jointMsg->set_id(joint);
 
     // Set the joint pose
-    pose = _ecm.Component<components::Pose>(joint);
+    const auto *pose = _ecm.Component<components::Pose>(joint);
     if (pose)
       msgs::Set(jointMsg->mutable_pose(), pose->Data());
+  }
+
+  this->lastPublished.assign(this->joints.size() * 6, 0.0);
+  this->lastAxisCount.assign(this->joints.size(), 0u);
+  this->msgBuilt = true;
+}
+
+//////////////////////////////////////////////////
+bool JointStatePublisher::FillJointStates(const EntityComponentManager &_ecm)
+{
+  bool changed{false};
+
+  // Record a value and check it against the last published one
+  auto update = [&](std::size_t _index, double _value)
+  {
+    if (std::abs(_value - this->lastPublished[_index]) >
+        this->publishThreshold)
+    {
+      changed = true;
+    }
+  };
+
+  int index = 0;
+  for (const Entity &joint : this->joints)
+  {
+    msgs::Joint *jointMsg = this->msg.mutable_joint(index);
+    std::size_t base = static_cast<std::size_t>(index) * 6;
+    std::size_t axisCount{0};
 
     // Set the joint position
     const auto *jointPositions  =
@@ -189,13 +233,17 @@ void JointStatePublisher::PostUpdate(const UpdateInfo &_info,
     {
       for (size_t i = 0; i < jointPositions->Data().size(); ++i)
       {
+        double value = jointPositions->Data()[i];
         if (i == 0)
-          jointMsg->mutable_axis1()->set_position(jointPositions->Data()[i]);
+          jointMsg->mutable_axis1()->set_position(value);
         else if (i == 1)
-          jointMsg->mutable_axis2()->set_position(jointPositions->Data()[i]);
+          jointMsg->mutable_axis2()->set_position(value);
         else
           ignwarn << "Joint state publisher only supports two joint axis\n";
+        if (i < 2)
+          update(base + i * 3, value);
       }
+      axisCount = std::max(axisCount, jointPositions->Data().size());
     }
 
     // Set the joint velocity
@@ -205,13 +253,17 @@ void JointStatePublisher::PostUpdate(const UpdateInfo &_info,
     {
       for (size_t i = 0; i < jointVelocity->Data().size(); ++i)
       {
+        double value = jointVelocity->Data()[i];
         if (i == 0)
-          jointMsg->mutable_axis1()->set_velocity(jointVelocity->Data()[i]);
+          jointMsg->mutable_axis1()->set_velocity(value);
         else if (i == 1)
-          jointMsg->mutable_axis2()->set_velocity(jointVelocity->Data()[i]);
+          jointMsg->mutable_axis2()->set_velocity(value);
         else
           ignwarn << "Joint state publisher only supports two joint axis\n";
+        if (i < 2)
+          update(base + i * 3 + 1, value);
       }
+      axisCount = std::max(axisCount, jointVelocity->Data().size());
     }
 
     // Set the joint force
@@ -221,18 +273,43 @@ void JointStatePublisher::PostUpdate(const UpdateInfo &_info,
     {
       for (size_t i = 0; i < jointForce->Data().size(); ++i)
       {
+        double value = jointForce->Data()[i];
         if (i == 0)
-          jointMsg->mutable_axis1()->set_force(jointForce->Data()[i]);
+          jointMsg->mutable_axis1()->set_force(value);
         else if (i == 1)
-          jointMsg->mutable_axis2()->set_force(jointForce->Data()[i]);
+          jointMsg->mutable_axis2()->set_force(value);
         else
           ignwarn << "Joint state publisher only supports two joint axis\n";
+        if (i < 2)
+          update(base + i * 3 + 2, value);
       }
+      axisCount = std::max(axisCount, jointForce->Data().size());
     }
+
+    if (axisCount != this->lastAxisCount[index])
+      changed = true;
+    this->lastAxisCount[index] = axisCount;
+    ++index;
   }
 
-  // Publish the message.
-  this->modelPub->Publish(msg);
+  // Only remember values that were published, so slow drifts still add up
+  // to a publication
+  if (changed || this->publishThreshold <= 0.0)
+  {
+    index = 0;
+    for (const auto &jointMsg : this->msg.joint())
+    {
+      std::size_t base = static_cast<std::size_t>(index++) * 6;
+      this->lastPublished[base] = jointMsg.axis1().position();
+      this->lastPublished[base + 1] = jointMsg.axis1().velocity();
+      this->lastPublished[base + 2] = jointMsg.axis1().force();
+      this->lastPublished[base + 3] = jointMsg.axis2().position();
+      this->lastPublished[base + 4] = jointMsg.axis2().velocity();
+      this->lastPublished[base + 5] = jointMsg.axis2().force();
+    }
+  }
+
+  return changed;
 }
 
 IGNITION_ADD_PLUGIN(JointStatePublisher,
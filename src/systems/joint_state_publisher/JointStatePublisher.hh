@@ -18,8 +18,11 @@
 #ifndef IGNITION_GAZEBO_SYSTEMS_STATE_PUBLISHER_HH_
 #define IGNITION_GAZEBO_SYSTEMS_STATE_PUBLISHER_HH_
 
+#include <ignition/msgs/model.pb.h>
+
 #include <memory>
 #include <set>
+#include <vector>
 #include <ignition/gazebo/Model.hh>
 #include <ignition/transport/Node.hh>
 #include <ignition/gazebo/System.hh>
@@ -45,6 +48,16 @@ namespace systems
   /// `<joint_name>`: Name of a joint to publish. This parameter can be
   /// specified multiple times, and is optional. All joints in a model will
   /// be published if joint names are not specified.
+  ///
+  /// `<publish_threshold>`: Only publish when a joint position, velocity or
+  /// force changed by more than this value since the last publication.
+  /// Any joint whose number of axes changed also triggers a publication.
+  /// Idle models then don't publish at all. This parameter is optional, and
+  /// the default of 0 publishes every iteration.
+  ///
+  /// The message, including joint names, ids and poses, is built once, and
+  /// each publication only updates the stamp, the model pose and the axis
+  /// values.
   class JointStatePublisher
       : public System,
         public ISystemConfigure,
@@ -80,8 +93,34 @@ namespace systems
     /// \brief The publisher
     private: std::unique_ptr<transport::Node::Publisher> modelPub;
 
+    /// \brief Build the message skeleton with the joint names and poses.
+    /// \param[in] _ecm The EntityComponentManager.
+    private: void BuildMessage(const EntityComponentManager &_ecm);
+
+    /// \brief Fill the axis values of the message.
+    /// \param[in] _ecm The EntityComponentManager.
+    /// \return True if any value changed by more than the threshold since
+    /// the last publication.
+    private: bool FillJointStates(const EntityComponentManager &_ecm);
+
     /// \brief The joints that will be published.
     private: std::set<Entity> joints;
+
+    /// \brief Reused message, joints are in the same order as `joints`.
+    private: msgs::Model msg;
+
+    /// \brief Whether the message skeleton was built.
+    private: bool msgBuilt{false};
+
+    /// \brief Change threshold for publishing, 0 to always publish.
+    private: double publishThreshold{0.0};
+
+    /// \brief Position, velocity and force of each axis at the last
+    /// publication, 6 values per joint.
+    private: std::vector<double> lastPublished;
+
+    /// \brief Number of axes of each joint at the last publication.
+    private: std::vector<std::size_t> lastAxisCount;
   };
   }
 }
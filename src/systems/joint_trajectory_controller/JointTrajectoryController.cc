@@ -35,7 +35,11 @@
 #include <ignition/transport/Publisher.hh>
 #include <ignition/transport/TopicUtils.hh>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <map>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -161,11 +165,14 @@ class ActuatedJoint
               const ignition::msgs::JointTrajectoryPoint &_targetPoint,
               const size_t &_jointIndex);
 
-  /// \brief Update command force that is applied on the joint
-  /// \param[in,out] _ecm Ignition Entity Component Manager
+  /// \brief Compute the command force that is applied on the joint
+  /// \param[in] _position Current position of the joint, if known
+  /// \param[in] _velocity Current velocity of the joint, if known
   /// \param[in] _dt Time difference to update for
-  public: void Update(ignition::gazebo::EntityComponentManager &_ecm,
-                      const std::chrono::steady_clock::duration &_dt);
+  /// \return The command force
+  public: double ComputeForce(const std::optional<double> &_position,
+                              const std::optional<double> &_velocity,
+                              const std::chrono::steady_clock::duration &_dt);
 
   /// \brief Reset the target of the joint
   public: void ResetTarget();
@@ -251,6 +258,14 @@ class Trajectory
   /// \brief Trajectory defined in terms of temporal points, whose members are
   /// ordered according to `jointNames`
   public: std::vector<ignition::msgs::JointTrajectoryPoint> points;
+
+  /// \brief Time from start of each point, converted once when the
+  /// trajectory is received
+  public: std::vector<std::chrono::steady_clock::duration> pointTimes;
+
+  /// \brief Whether the joints and interpolation of this trajectory are
+  /// already resolved
+  public: bool compiled{false};
 };
 
 /// \brief Private data of the JointTrajectoryController plugin
@@ -279,6 +294,17 @@ class ignition::gazebo::systems::JointTrajectoryControllerPrivate
   /// components
   public: void Reset();
 
+  /// \brief Resolve the actuated joint of each trajectory joint and, if
+  /// interpolation is enabled, precompute the polynomial of each segment
+  /// and joint. Starts from the current joint targets.
+  public: void CompileTrajectory();
+
+  /// \brief Set position and velocity targets of the trajectory joints by
+  /// evaluating the current segment's polynomials.
+  /// \param[in] _simTime Current simulation time
+  public: void InterpolateTargets(
+              const std::chrono::steady_clock::duration &_simTime);
+
   /// \brief Ignition communication node
   public: transport::Node node;
 
@@ -289,6 +315,33 @@ class ignition::gazebo::systems::JointTrajectoryControllerPrivate
   /// of the joint
   public: std::map<std::string, ActuatedJoint> actuatedJoints;
 
+  /// \brief Actuated joints in a flat list for the control loop
+  public: std::vector<ActuatedJoint *> controlledJoints;
+
+  /// \brief Actuated joint of each joint of the current trajectory, null for
+  /// joints that aren't controlled by this plugin
+  public: std::vector<ActuatedJoint *> trajectoryJoints;
+
+  /// \brief Coefficients {a, b, c, d} of the position polynomial
+  /// a + b*s + c*s^2 + d*s^3 of each segment and joint of the current
+  /// trajectory, where s is the time in seconds since the start of the
+  /// segment. Segment k ends at point k. Indexed by k * joints + joint.
+  /// Empty if the trajectory isn't interpolated.
+  public: std::vector<std::array<double, 4>> coefficients;
+
+  /// \brief Joint positions read in the control loop
+  public: std::vector<std::optional<double>> jointPositions;
+
+  /// \brief Joint velocities read in the control loop
+  public: std::vector<std::optional<double>> jointVelocities;
+
+  /// \brief Forces computed in the control loop
+  public: std::vector<double> jointForces;
+
+  /// \brief Flag that determines whether targets are interpolated between
+  /// trajectory points
+  public: bool interpolate{false};
+
   /// \brief Mutex projecting trajectory
   public: std::mutex trajectoryMutex;
 
@@ -363,7 +416,12 @@ void JointTrajectoryController::Configure(
     return;
   }
 
+  for (auto &actuatedJoint : this->dataPtr->actuatedJoints)
+    this->dataPtr->controlledJoints.push_back(&actuatedJoint.second);
+
   // Get additional parameters from SDF
+  this->dataPtr->interpolate = _sdf->Get<bool>("interpolate", false).first;
+
   if (_sdf->HasAttribute("use_header_start_time"))
   {
     this->dataPtr->useHeaderStartTime =
@@ -462,6 +520,11 @@ void JointTrajectoryController::PreUpdate(
         this->dataPtr->trajectory.status = Trajectory::Reached;
       }
 
+      if (!this->dataPtr->trajectory.compiled)
+      {
+        this->dataPtr->CompileTrajectory();
+      }
+
       // Update is always needed for a new trajectory
       isTargetUpdateRequired = true;
     }
@@ -485,16 +548,15 @@ void JointTrajectoryController::PreUpdate(
           this->dataPtr->trajectory.points[this->dataPtr->trajectory
                                                .pointIndex];
       for (auto jointIndex = 0u;
-           jointIndex < this->dataPtr->trajectory.jointNames.size();
+           jointIndex < this->dataPtr->trajectoryJoints.size();
            ++jointIndex)
       {
-        const auto jointName = this->dataPtr->trajectory.jointNames[jointIndex];
-        if (this->dataPtr->actuatedJoints.count(jointName) == 0)
+        auto *joint = this->dataPtr->trajectoryJoints[jointIndex];
+        if (nullptr == joint)
         {
-          // Warning about unconfigured joint is already logged above
+          // Warning about unconfigured joint is already logged when compiling
           continue;
         }
-        auto *joint = &this->dataPtr->actuatedJoints[jointName];
         joint->SetTarget(targetPoint, jointIndex);
       }
 
@@ -510,13 +572,49 @@ void JointTrajectoryController::PreUpdate(
       progressMsg.set_data(this->dataPtr->trajectory.ComputeProgress());
       this->dataPtr->progressPub.Publish(progressMsg);
     }
+
+    // Follow the polynomials between points
+    if (!this->dataPtr->coefficients.empty())
+    {
+      this->dataPtr->InterpolateTargets(_info.simTime);
+    }
   }
 
-  // Control loop
-  for (auto &actuatedJoint : this->dataPtr->actuatedJoints)
+  // Control loop. All joint states are read before any command is computed
+  // and written.
+  auto &joints = this->dataPtr->controlledJoints;
+  auto &positions = this->dataPtr->jointPositions;
+  auto &velocities = this->dataPtr->jointVelocities;
+  auto &forces = this->dataPtr->jointForces;
+  positions.assign(joints.size(), std::nullopt);
+  velocities.assign(joints.size(), std::nullopt);
+  forces.resize(joints.size());
+
+  for (std::size_t i = 0; i < joints.size(); ++i)
   {
-    auto *joint = &actuatedJoint.second;
-    joint->Update(_ecm, _info.dt);
+    const auto *position = _ecm.Component<components::JointPosition>(
+        joints[i]->entity);
+    if (position && !position->Data().empty())
+      positions[i] = position->Data()[0];
+
+    const auto *velocity = _ecm.Component<components::JointVelocity>(
+        joints[i]->entity);
+    if (velocity && !velocity->Data().empty())
+      velocities[i] = velocity->Data()[0];
+  }
+
+  for (std::size_t i = 0; i < joints.size(); ++i)
+  {
+    forces[i] = joints[i]->ComputeForce(positions[i], velocities[i],
+        _info.dt);
+  }
+
+  for (std::size_t i = 0; i < joints.size(); ++i)
+  {
+    auto *forceCmd = _ecm.Component<components::JointForceCmd>(
+        joints[i]->entity);
+    if (forceCmd && !forceCmd->Data().empty())
+      forceCmd->Data()[0] = forces[i];
   }
 }
 
@@ -685,6 +783,11 @@ void JointTrajectoryControllerPrivate::JointTrajectoryCallback(
   for (const auto &point : _msg.points())
   {
     this->trajectory.points.push_back(point);
+
+    const auto &pointTFS = point.time_from_start();
+    this->trajectory.pointTimes.push_back(
+        std::chrono::seconds(pointTFS.sec()) +
+        std::chrono::nanoseconds(pointTFS.nsec()));
   }
 }
 
@@ -702,6 +805,133 @@ void JointTrajectoryControllerPrivate::Reset()
 
   // Reset trajectory
   this->trajectory.Reset();
+  this->trajectoryJoints.clear();
+  this->coefficients.clear();
+}
+
+//////////////////////////////////////////////////
+void JointTrajectoryControllerPrivate::CompileTrajectory()
+{
+  this->trajectory.compiled = true;
+
+  const auto jointCount = this->trajectory.jointNames.size();
+  this->trajectoryJoints.assign(jointCount, nullptr);
+  for (std::size_t j = 0; j < jointCount; ++j)
+  {
+    const auto &jointName = this->trajectory.jointNames[j];
+    auto it = this->actuatedJoints.find(jointName);
+    if (it == this->actuatedJoints.end())
+    {
+      ignwarn << "[JointTrajectoryController] Trajectory contains joint ["
+              << jointName << "], which is not controlled by this plugin.\n";
+      continue;
+    }
+    this->trajectoryJoints[j] = &it->second;
+  }
+
+  this->coefficients.clear();
+  if (!this->interpolate || this->trajectory.points.empty())
+    return;
+
+  // Segments start from the current targets
+  std::vector<double> startPosition(jointCount, 0.0);
+  std::vector<double> startVelocity(jointCount, 0.0);
+  for (std::size_t j = 0; j < jointCount; ++j)
+  {
+    if (this->trajectoryJoints[j])
+    {
+      startPosition[j] = this->trajectoryJoints[j]->target.position;
+      startVelocity[j] = this->trajectoryJoints[j]->target.velocity;
+    }
+  }
+
+  const auto &points = this->trajectory.points;
+  const auto &times = this->trajectory.pointTimes;
+  this->coefficients.resize(points.size() * jointCount);
+  for (std::size_t k = 0; k < points.size(); ++k)
+  {
+    const auto segmentStart = k == 0 ?
+        std::chrono::steady_clock::duration::zero() : times[k - 1];
+    const double duration =
+        std::chrono::duration<double>(times[k] - segmentStart).count();
+
+    for (std::size_t j = 0; j < jointCount; ++j)
+    {
+      const int index = static_cast<int>(j);
+      const double p0 = startPosition[j];
+      const double v0 = startVelocity[j];
+      const double p1 = index < points[k].positions_size() ?
+          points[k].positions(index) : p0;
+      const bool hasVelocity = index < points[k].velocities_size();
+      const double v1 = hasVelocity ? points[k].velocities(index) : 0.0;
+
+      auto &c = this->coefficients[k * jointCount + j];
+      if (duration <= 0.0)
+      {
+        c = {p1, 0.0, 0.0, 0.0};
+      }
+      else if (hasVelocity)
+      {
+        // Cubic Hermite segment matching positions and velocities at both
+        // ends
+        c = {p0, v0,
+             (3.0 * (p1 - p0) / duration - 2.0 * v0 - v1) / duration,
+             (2.0 * (p0 - p1) / duration + v0 + v1) / (duration * duration)};
+      }
+      else
+      {
+        // Linear segment
+        c = {p0, (p1 - p0) / duration, 0.0, 0.0};
+      }
+
+      startPosition[j] = p1;
+      startVelocity[j] = hasVelocity ? v1 : c[1];
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void JointTrajectoryControllerPrivate::InterpolateTargets(
+    const std::chrono::steady_clock::duration &_simTime)
+{
+  const auto &trajectory = this->trajectory;
+  const auto pointIndex = trajectory.pointIndex;
+  const auto jointCount = this->trajectoryJoints.size();
+  if (pointIndex >= trajectory.points.size())
+    return;
+
+  // Past the last point, hold its targets exactly and stop interpolating
+  const auto trajectoryTime = _simTime - trajectory.startTime;
+  if (trajectoryTime > trajectory.pointTimes[pointIndex])
+  {
+    for (std::size_t j = 0; j < jointCount; ++j)
+    {
+      if (this->trajectoryJoints[j])
+        this->trajectoryJoints[j]->SetTarget(trajectory.points[pointIndex], j);
+    }
+    this->coefficients.clear();
+    return;
+  }
+
+  const auto segmentStart = pointIndex == 0 ?
+      std::chrono::steady_clock::duration::zero() :
+      trajectory.pointTimes[pointIndex - 1];
+  const double s = std::max(0.0,
+      std::chrono::duration<double>(trajectoryTime - segmentStart).count());
+
+  const auto *c = &this->coefficients[pointIndex * jointCount];
+  for (std::size_t j = 0; j < jointCount; ++j, ++c)
+  {
+    auto *joint = this->trajectoryJoints[j];
+    if (nullptr == joint)
+      continue;
+
+    const auto &coef = *c;
+    joint->target.position =
+        coef[0] + s * (coef[1] + s * (coef[2] + s * coef[3]));
+    joint->target.velocity =
+        coef[1] + s * (2.0 * coef[2] + 3.0 * s * coef[3]);
+  }
 }
 
 ///////////////////////
@@ -941,37 +1171,25 @@ void ActuatedJoint::SetTarget(
 }
 
 //////////////////////////////////////////////////
-void ActuatedJoint::Update(ignition::gazebo::EntityComponentManager &_ecm,
-                           const std::chrono::steady_clock::duration &_dt)
+double ActuatedJoint::ComputeForce(const std::optional<double> &_position,
+    const std::optional<double> &_velocity,
+    const std::chrono::steady_clock::duration &_dt)
 {
-  // Get JointPosition and JointVelocity components
-  const auto jointPositionComponent = _ecm.Component<components::JointPosition>(
-      this->entity);
-  const auto jointVelocityComponent = _ecm.Component<components::JointVelocity>(
-      this->entity);
-
   // Compute control errors and force for each PID controller
   double forcePosition = 0.0, forceVelocity = 0.0;
-  if (!jointPositionComponent->Data().empty())
+  if (_position)
   {
-    double errorPosition = jointPositionComponent->Data()[0] -
-                           this->target.position;
+    double errorPosition = *_position - this->target.position;
     forcePosition = this->pids.position.Update(errorPosition, _dt);
   }
-  if (!jointVelocityComponent->Data().empty())
+  if (_velocity)
   {
-    double errorVelocity = jointVelocityComponent->Data()[0] -
-                           this->target.velocity;
+    double errorVelocity = *_velocity - this->target.velocity;
     forceVelocity = this->pids.velocity.Update(errorVelocity, _dt);
   }
 
   // Sum all forces
-  const double force = forcePosition + forceVelocity + this->target.effort;
-
-  // Get JointForceCmd component and apply command force
-  auto jointForceCmdComponent = _ecm.Component<components::JointForceCmd>(
-      this->entity);
-  jointForceCmdComponent->Data()[0] = force;
+  return forcePosition + forceVelocity + this->target.effort;
 }
 
 //////////////////////////////////////////////////
@@ -1011,10 +1229,7 @@ bool Trajectory::UpdateCurrentPoint(
     }
 
     // Break if point needs to be followed
-    const auto pointTFS = this->points[this->pointIndex].time_from_start();
-    const auto pointTime = std::chrono::seconds(pointTFS.sec()) +
-                           std::chrono::nanoseconds(pointTFS.nsec());
-    if (pointTime >= trajectoryTime)
+    if (this->pointTimes[this->pointIndex] >= trajectoryTime)
     {
       break;
     }
@@ -1055,6 +1270,8 @@ void Trajectory::Reset()
   this->pointIndex = 0;
   this->jointNames.clear();
   this->points.clear();
+  this->pointTimes.clear();
+  this->compiled = false;
 }
 
 // Register plugin
@@ -56,7 +56,7 @@ namespace systems
   /// MoveIt2. For smooth execution of the trajectory, its points should to be
   /// interpolated before sending them via Ignition Transport (interpolation
   /// might already be implemented in the motion planning framework of your
-  /// choice).
+  /// choice), or the `<interpolate>` parameter can be enabled.
   ///
   /// The progress of the current trajectory can be tracked on topic whose name
   /// is derived as `<topic>_progress`. This progress is indicated in the range
@@ -74,6 +74,14 @@ namespace systems
   ///  Optional parameter.
   ///  Defaults to false.
   ///
+  /// `<interpolate>` If enabled, position and velocity targets follow
+  ///  polynomials between trajectory points instead of jumping to the next
+  ///  point. Segments are cubic where both points have velocities, and linear
+  ///  otherwise. The polynomials are computed once when a trajectory starts,
+  ///  so each update only evaluates the current segment for each joint.
+  ///  Optional parameter.
+  ///  Defaults to false.
+  ///
   /// `<joint_name>` Name of a joint to control.
   ///  This parameter can be specified multiple times, i.e. once for each joint.
   ///  Optional parameter.
@@ -18,6 +18,7 @@
 #include <google/protobuf/message.h>
 #include <ignition/msgs/double.pb.h>
 
+#include <optional>
 #include <string>
 
 #include <ignition/gazebo/components/AngularVelocity.hh>
@@ -161,6 +162,9 @@ void KineticEnergyMonitor::Configure(const Entity &_entity,
     _ecm.CreateComponent(this->dataPtr->linkEntity,
         components::WorldAngularVelocity());
   }
+
+  // Share the kinetic energy computed once per step with other systems
+  _ecm.TrackLinkState(this->dataPtr->linkEntity);
 }
 
 //////////////////////////////////////////////////
@@ -169,10 +173,16 @@ void KineticEnergyMonitor::PostUpdate(const UpdateInfo &/*_info*/,
 {
   if (this->dataPtr->linkEntity != kNullEntity)
   {
-    Link link(this->dataPtr->linkEntity);
-    if (std::nullopt != link.WorldKineticEnergy(_ecm))
+    std::optional<double> kineticEnergy;
+    auto state = _ecm.CachedLinkState(this->dataPtr->linkEntity);
+    if (state)
+      kineticEnergy = state->worldKineticEnergy;
+    else
+      kineticEnergy = Link(this->dataPtr->linkEntity).WorldKineticEnergy(_ecm);
+
+    if (kineticEnergy)
     {
-      double currKineticEnergy = *link.WorldKineticEnergy(_ecm);
+      double currKineticEnergy = *kineticEnergy;
 
       // We only care about positive values of this (the links looses energy)
       double deltaKE = this->dataPtr->prevKineticEnergy - currKineticEnergy;
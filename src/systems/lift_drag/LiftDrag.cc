@@ -18,6 +18,10 @@
 #include "LiftDrag.hh"
 
 #include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -44,16 +48,28 @@ using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+class LiftDragEngine;
+
 class ignition::gazebo::systems::LiftDragPrivate
 {
   // Initialize the system
   public: void Load(const EntityComponentManager &_ecm,
                     const sdf::ElementPtr &_sdf);
 
-  /// \brief Compute lift and drag forces and update the corresponding
-  /// components
-  /// \param[in] _ecm Immutable reference to the EntityComponentManager
-  public: void Update(EntityComponentManager &_ecm);
+  /// \brief Compute the lift and drag wrench of this surface.
+  /// \param[in] _pose World pose of the link.
+  /// \param[in] _linVel World linear velocity of the link.
+  /// \param[in] _angVel World angular velocity of the link.
+  /// \param[in] _controlJointPosition Position of the control joint, or
+  /// zero if there is none.
+  /// \param[out] _force Force to apply at the link origin, in the world
+  /// frame.
+  /// \param[out] _torque Torque to apply, in the world frame.
+  /// \return False if the surface is too slow to generate forces.
+  public: bool ComputeWrench(const math::Pose3d &_pose,
+      const math::Vector3d &_linVel, const math::Vector3d &_angVel,
+      double _controlJointPosition, math::Vector3d &_force,
+      math::Vector3d &_torque);
 
   /// \brief Model interface
   public: Model model{kNullEntity};
@@ -135,8 +151,174 @@ class ignition::gazebo::systems::LiftDragPrivate
 
   /// \brief Initialization flag
   public: bool initialized{false};
+
+  /// \brief Engine this surface is registered with, null if it isn't
+  /// registered.
+  public: std::shared_ptr<LiftDragEngine> engine;
+
+  /// \brief Last iteration in which this surface was evaluated.
+  public: uint64_t lastIteration{std::numeric_limits<uint64_t>::max()};
 };
 
+/// \brief Evaluates the surfaces of all LiftDrag systems that share an
+/// EntityComponentManager in one pass. Each system still loads its own
+/// SDF configuration, but the first one to run in an iteration gathers the
+/// link states of every surface, computes all wrenches and writes them
+/// back, and the others find nothing left to do.
+class LiftDragEngine
+{
+  /// \brief Register a surface with the engine of a manager, creating the
+  /// engine if needed.
+  /// \param[in] _surface Surface to add.
+  /// \param[in] _ecm Entity component manager.
+  public: static void Register(LiftDragPrivate *_surface,
+      const EntityComponentManager &_ecm);
+
+  /// \brief Unregister a surface from its engine.
+  /// \param[in] _surface Surface to remove.
+  public: static void Unregister(LiftDragPrivate *_surface);
+
+  /// \brief Mutex protecting the engine.
+  public: std::mutex mutex;
+
+  /// \brief Evaluate every surface which hasn't been evaluated in this
+  /// iteration yet.
+  /// \param[in] _iteration Current iteration.
+  /// \param[in] _ecm Entity component manager.
+  public: void Update(uint64_t _iteration, EntityComponentManager &_ecm);
+
+  /// \brief Registered surfaces.
+  public: std::vector<LiftDragPrivate *> surfaces;
+
+  /// \brief Surfaces gathered in the current pass.
+  private: std::vector<LiftDragPrivate *> batch;
+
+  /// \brief Link world poses of the gathered surfaces.
+  private: std::vector<math::Pose3d> poses;
+
+  /// \brief Link world linear velocities of the gathered surfaces.
+  private: std::vector<math::Vector3d> linVels;
+
+  /// \brief Link world angular velocities of the gathered surfaces.
+  private: std::vector<math::Vector3d> angVels;
+
+  /// \brief Control joint positions of the gathered surfaces.
+  private: std::vector<double> controlPositions;
+
+  /// \brief Computed forces.
+  private: std::vector<math::Vector3d> forces;
+
+  /// \brief Computed torques.
+  private: std::vector<math::Vector3d> torques;
+
+  /// \brief Whether each gathered surface generated a wrench.
+  private: std::vector<char> applied;
+};
+
+//////////////////////////////////////////////////
+void LiftDragEngine::Register(LiftDragPrivate *_surface,
+    const EntityComponentManager &_ecm)
+{
+  _surface->engine = _ecm.SharedObject<LiftDragEngine>(
+      "ignition::gazebo::systems::LiftDragEngine");
+
+  std::lock_guard<std::mutex> lock(_surface->engine->mutex);
+  _surface->engine->surfaces.push_back(_surface);
+}
+
+//////////////////////////////////////////////////
+void LiftDragEngine::Unregister(LiftDragPrivate *_surface)
+{
+  if (!_surface->engine)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(_surface->engine->mutex);
+    auto &surfaces = _surface->engine->surfaces;
+    surfaces.erase(std::remove(surfaces.begin(), surfaces.end(), _surface),
+        surfaces.end());
+  }
+  _surface->engine.reset();
+}
+
+//////////////////////////////////////////////////
+void LiftDragEngine::Update(uint64_t _iteration, EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("LiftDragEngine::Update");
+
+  // Gather the state of every pending surface
+  this->batch.clear();
+  this->poses.clear();
+  this->linVels.clear();
+  this->angVels.clear();
+  this->controlPositions.clear();
+  for (auto *surface : this->surfaces)
+  {
+    if (surface->lastIteration == _iteration)
+      continue;
+    surface->lastIteration = _iteration;
+
+    // Use the state shared with other systems when it's available
+    std::optional<math::Pose3d> worldPose;
+    std::optional<math::Vector3d> worldLinVel;
+    std::optional<math::Vector3d> worldAngVel;
+    auto state = _ecm.CachedLinkState(surface->linkEntity);
+    if (state)
+    {
+      worldPose = state->worldPose;
+      worldLinVel = state->worldLinearVelocity;
+      worldAngVel = state->worldAngularVelocity;
+    }
+    else
+    {
+      worldPose = _ecm.ComponentData<components::WorldPose>(
+          surface->linkEntity);
+      worldLinVel = _ecm.ComponentData<components::WorldLinearVelocity>(
+          surface->linkEntity);
+      worldAngVel = _ecm.ComponentData<components::WorldAngularVelocity>(
+          surface->linkEntity);
+    }
+    if (!worldLinVel || !worldAngVel || !worldPose)
+      continue;
+
+    double controlPosition = 0.0;
+    if (surface->controlJointEntity != kNullEntity)
+    {
+      auto jointPos = _ecm.Component<components::JointPosition>(
+          surface->controlJointEntity);
+      if (jointPos && !jointPos->Data().empty())
+        controlPosition = jointPos->Data()[0];
+    }
+
+    this->batch.push_back(surface);
+    this->poses.push_back(*worldPose);
+    this->linVels.push_back(*worldLinVel);
+    this->angVels.push_back(*worldAngVel);
+    this->controlPositions.push_back(controlPosition);
+  }
+
+  // Compute all wrenches
+  const std::size_t count = this->batch.size();
+  this->forces.resize(count);
+  this->torques.resize(count);
+  this->applied.resize(count);
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    this->applied[i] = this->batch[i]->ComputeWrench(this->poses[i],
+        this->linVels[i], this->angVels[i], this->controlPositions[i],
+        this->forces[i], this->torques[i]);
+  }
+
+  // Write them back
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (!this->applied[i])
+      continue;
+    Link link(this->batch[i]->linkEntity);
+    link.AddWorldWrench(_ecm, this->forces[i], this->torques[i]);
+  }
+}
+
 //////////////////////////////////////////////////
 void LiftDragPrivate::Load(const EntityComponentManager &_ecm,
                            const sdf::ElementPtr &_sdf)
@@ -213,33 +395,24 @@ LiftDrag::LiftDrag()
 }
 
 //////////////////////////////////////////////////
-void LiftDragPrivate::Update(EntityComponentManager &_ecm)
+LiftDrag::~LiftDrag()
 {
-  IGN_PROFILE("LiftDragPrivate::Update");
-  // get linear velocity at cp in world frame
-  const auto worldLinVel =
-      _ecm.Component<components::WorldLinearVelocity>(this->linkEntity);
-  const auto worldAngVel =
-      _ecm.Component<components::WorldAngularVelocity>(this->linkEntity);
-  const auto worldPose =
-      _ecm.Component<components::WorldPose>(this->linkEntity);
-
-  components::JointPosition *controlJointPosition = nullptr;
-  if (this->controlJointEntity != kNullEntity)
-  {
-    controlJointPosition =
-        _ecm.Component<components::JointPosition>(this->controlJointEntity);
-  }
-
-  if (!worldLinVel || !worldAngVel || !worldPose)
-    return;
+  LiftDragEngine::Unregister(this->dataPtr.get());
+}
 
-  const auto &pose = worldPose->Data();
+//////////////////////////////////////////////////
+bool LiftDragPrivate::ComputeWrench(const math::Pose3d &_pose,
+    const math::Vector3d &_linVel, const math::Vector3d &_angVel,
+    double _controlJointPosition, math::Vector3d &_force,
+    math::Vector3d &_torque)
+{
+  // get linear velocity at cp in world frame
+  const auto &pose = _pose;
   const auto cpWorld = pose.Rot().RotateVector(this->cp);
-  const auto vel = worldLinVel->Data() + worldAngVel->Data().Cross(cpWorld);
+  const auto vel = _linVel + _angVel.Cross(cpWorld);
 
   if (vel.Length() <= 0.01)
-    return;
+    return false;
 
   const auto velI = vel.Normalized();
 
@@ -347,11 +520,8 @@ void LiftDragPrivate::Update(EntityComponentManager &_ecm)
     cl = this->cla * alpha * cosSweepAngle;
 
   // modify cl per control joint value
-  if (controlJointPosition)
-  {
-    cl = cl + this->controlJointRadToCL * controlJointPosition->Data()[0];
-    /// \todo(anyone): also change cm and cd
-  }
+  cl = cl + this->controlJointRadToCL * _controlJointPosition;
+  /// \todo(anyone): also change cm and cd
 
   // compute lift force at cp
   ignition::math::Vector3d lift = cl * q * this->area * liftI;
@@ -431,9 +601,8 @@ void LiftDragPrivate::Update(EntityComponentManager &_ecm)
   //
   // \todo(addisu) Create a convenient API for applying forces at offset
   // positions
-  const auto totalTorque = torque + cpWorld.Cross(force);
-  Link link(this->linkEntity);
-  link.AddWorldWrench(_ecm, force, totalTorque);
+  _force = force;
+  _torque = torque + cpWorld.Cross(force);
 
   // Debug
   // auto linkName = _ecm.Component<components::Name>(this->linkEntity)->Data();
@@ -457,7 +626,8 @@ void LiftDragPrivate::Update(EntityComponentManager &_ecm)
   // igndbg << "moment: " << moment << "\n";
   // igndbg << "force: " << force << "\n";
   // igndbg << "torque: " << torque << "\n";
-  // igndbg << "totalTorque: " << totalTorque << "\n";
+  // igndbg << "totalTorque: " << _torque << "\n";
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -516,6 +686,7 @@ void LiftDrag::PreUpdate(const UpdateInfo &_info, EntityComponentManager &_ecm)
         _ecm.CreateComponent(this->dataPtr->linkEntity,
                              components::WorldAngularVelocity());
       }
+      _ecm.TrackLinkState(this->dataPtr->linkEntity);
 
       if ((this->dataPtr->controlJointEntity != kNullEntity) &&
           !_ecm.Component<components::JointPosition>(
@@ -534,7 +705,11 @@ void LiftDrag::PreUpdate(const UpdateInfo &_info, EntityComponentManager &_ecm)
   // above
   if (this->dataPtr->initialized && this->dataPtr->validConfig)
   {
-    this->dataPtr->Update(_ecm);
+    if (!this->dataPtr->engine)
+      LiftDragEngine::Register(this->dataPtr.get(), _ecm);
+
+    std::lock_guard<std::mutex> lock(this->dataPtr->engine->mutex);
+    this->dataPtr->engine->Update(_info.iterations, _ecm);
   }
 }
 
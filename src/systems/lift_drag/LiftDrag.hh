@@ -59,6 +59,10 @@ namespace systems
   ///               coefficient curve.
   /// cda_stall   : The ratio of coefficient of drag and alpha slope after
   ///               stall.
+  ///
+  /// All LiftDrag systems in a world are evaluated together: the first one
+  /// to run in an iteration computes and applies the forces of every
+  /// configured surface in one pass.
   class LiftDrag
       : public System,
         public ISystemConfigure,
@@ -68,7 +72,7 @@ namespace systems
     public: LiftDrag();
 
     /// \brief Destructor
-    public: ~LiftDrag() override = default;
+    public: ~LiftDrag() override;
 
     // Documentation inherited
     public: void Configure(const Entity &_entity,
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "KeyframeCache.hh"
+
+#include <utility>
+
+#include <ignition/common/Profiler.hh>
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+//////////////////////////////////////////////////
+KeyframeCache::KeyframeCache(std::size_t _capacity)
+  : capacity(_capacity)
+{
+}
+
+//////////////////////////////////////////////////
+std::size_t KeyframeCache::Capacity() const
+{
+  return this->capacity;
+}
+
+//////////////////////////////////////////////////
+std::size_t KeyframeCache::Size() const
+{
+  return this->entries.size();
+}
+
+//////////////////////////////////////////////////
+void KeyframeCache::Insert(const std::chrono::steady_clock::duration &_time,
+    DeserializedState &&_state)
+{
+  if (0u == this->capacity)
+    return;
+
+  auto it = this->entries.find(_time);
+  if (it != this->entries.end())
+  {
+    it->second.state = std::move(_state);
+    this->lru.splice(this->lru.begin(), this->lru, it->second.lruIt);
+    return;
+  }
+
+  if (this->entries.size() >= this->capacity)
+  {
+    this->entries.erase(this->lru.back());
+    this->lru.pop_back();
+  }
+
+  this->lru.push_front(_time);
+  this->entries.emplace(_time, Entry{std::move(_state), this->lru.begin()});
+}
+
+//////////////////////////////////////////////////
+bool KeyframeCache::Restore(const std::chrono::steady_clock::duration &_time,
+    std::chrono::steady_clock::duration &_keyframeTime,
+    DeserializedState &_state)
+{
+  auto it = this->entries.upper_bound(_time);
+  if (it == this->entries.begin())
+    return false;
+  --it;
+
+  IGN_PROFILE("KeyframeCache::Restore");
+
+  this->lru.splice(this->lru.begin(), this->lru, it->second.lruIt);
+  _keyframeTime = it->first;
+
+  // The cached state is copied, since setting a state moves its components
+  const auto &source = it->second.state;
+  _state.entities.clear();
+  _state.entities.reserve(source.entities.size());
+  _state.oneTimeChanges = source.oneTimeChanges;
+  for (const auto &entity : source.entities)
+  {
+    _state.entities.emplace_back();
+    auto &copy = _state.entities.back();
+    copy.id = entity.id;
+    copy.remove = entity.remove;
+    copy.removedComponents = entity.removedComponents;
+    copy.components.reserve(entity.components.size());
+    for (const auto &comp : entity.components)
+    {
+      auto compCopy = comp->Clone();
+      if (nullptr != compCopy)
+        copy.components.push_back(std::move(compCopy));
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void KeyframeCache::Clear()
+{
+  this->entries.clear();
+  this->lru.clear();
+}
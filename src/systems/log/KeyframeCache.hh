@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_LOG_KEYFRAMECACHE_HH_
+#define IGNITION_GAZEBO_SYSTEMS_LOG_KEYFRAMECACHE_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <map>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/log-system/Export.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \brief Least recently used cache of full states reconstructed during
+  /// playback, so seeking back in a log which has no keyframes of its own
+  /// only has to replay the log from the closest cached state.
+  class IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE KeyframeCache
+  {
+    /// \brief Constructor
+    /// \param[in] _capacity Maximum number of states kept. Zero disables
+    /// the cache.
+    public: explicit KeyframeCache(std::size_t _capacity);
+
+    /// \brief Get the maximum number of states kept.
+    /// \return Capacity.
+    public: std::size_t Capacity() const;
+
+    /// \brief Get the number of states kept.
+    /// \return Number of states.
+    public: std::size_t Size() const;
+
+    /// \brief Keep a state, evicting the least recently used one if the
+    /// cache is full. A state already kept for the same time is replaced.
+    /// \param[in] _time Sim time of the state.
+    /// \param[in] _state Full state, for example from
+    /// EntityComponentManager::CopyState.
+    public: void Insert(const std::chrono::steady_clock::duration &_time,
+        DeserializedState &&_state);
+
+    /// \brief Copy the latest state kept at or before a time.
+    /// \param[in] _time Sim time to seek to.
+    /// \param[out] _keyframeTime Sim time of the state.
+    /// \param[out] _state Copy of the state, which the cache keeps.
+    /// \return False if no state was kept at or before _time.
+    public: bool Restore(const std::chrono::steady_clock::duration &_time,
+        std::chrono::steady_clock::duration &_keyframeTime,
+        DeserializedState &_state);
+
+    /// \brief Remove all states.
+    public: void Clear();
+
+    /// \brief A kept state.
+    private: struct Entry
+    {
+      /// \brief The state.
+      DeserializedState state;
+
+      /// \brief Position in lru.
+      std::list<std::chrono::steady_clock::duration>::iterator lruIt;
+    };
+
+    /// \brief Maximum number of states kept.
+    private: std::size_t capacity{0};
+
+    /// \brief States by sim time.
+    private: std::map<std::chrono::steady_clock::duration, Entry> entries;
+
+    /// \brief Times of the states, most recently used first.
+    private: std::list<std::chrono::steady_clock::duration> lru;
+  };
+}
+}
+}
+}
+#endif
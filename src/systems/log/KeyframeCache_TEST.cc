@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+
+#include "KeyframeCache.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+using namespace std::chrono_literals;
+
+/////////////////////////////////////////////////
+/// \brief Make a state with one named entity.
+/// \param[in] _entity Entity id.
+/// \param[in] _name Entity name.
+/// \return State.
+DeserializedState makeState(Entity _entity, const std::string &_name)
+{
+  DeserializedState state;
+  state.oneTimeChanges = true;
+  state.entities.emplace_back();
+  state.entities.back().id = _entity;
+  state.entities.back().components.push_back(
+      std::make_unique<components::Name>(_name));
+  return state;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the name of the first entity of a state.
+/// \param[in] _state State.
+/// \return Name.
+std::string name(const DeserializedState &_state)
+{
+  auto comp = dynamic_cast<const components::Name *>(
+      _state.entities.front().components.front().get());
+  return nullptr == comp ? "" : comp->Data();
+}
+
+/////////////////////////////////////////////////
+TEST(KeyframeCache, Restore)
+{
+  KeyframeCache cache(3);
+  EXPECT_EQ(3u, cache.Capacity());
+
+  std::chrono::steady_clock::duration time;
+  DeserializedState state;
+  EXPECT_FALSE(cache.Restore(10s, time, state));
+
+  cache.Insert(5s, makeState(1, "five"));
+  cache.Insert(10s, makeState(2, "ten"));
+  EXPECT_EQ(2u, cache.Size());
+
+  // Latest state at or before the time
+  EXPECT_FALSE(cache.Restore(4s, time, state));
+  ASSERT_TRUE(cache.Restore(9s, time, state));
+  EXPECT_EQ(std::chrono::steady_clock::duration(5s), time);
+  ASSERT_EQ(1u, state.entities.size());
+  EXPECT_EQ(1u, state.entities.front().id);
+  EXPECT_EQ("five", name(state));
+  EXPECT_TRUE(state.oneTimeChanges);
+
+  ASSERT_TRUE(cache.Restore(10s, time, state));
+  EXPECT_EQ(std::chrono::steady_clock::duration(10s), time);
+  EXPECT_EQ("ten", name(state));
+
+  // States are copied, so they can be restored again
+  ASSERT_TRUE(cache.Restore(12s, time, state));
+  EXPECT_EQ("ten", name(state));
+
+  // Replacing a state
+  cache.Insert(10s, makeState(2, "ten again"));
+  EXPECT_EQ(2u, cache.Size());
+  ASSERT_TRUE(cache.Restore(10s, time, state));
+  EXPECT_EQ("ten again", name(state));
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.Size());
+  EXPECT_FALSE(cache.Restore(10s, time, state));
+}
+
+/////////////////////////////////////////////////
+TEST(KeyframeCache, Eviction)
+{
+  KeyframeCache cache(2);
+  cache.Insert(1s, makeState(1, "one"));
+  cache.Insert(2s, makeState(2, "two"));
+
+  // Using the first state makes the second one the least recently used
+  std::chrono::steady_clock::duration time;
+  DeserializedState state;
+  ASSERT_TRUE(cache.Restore(1s, time, state));
+
+  cache.Insert(3s, makeState(3, "three"));
+  EXPECT_EQ(2u, cache.Size());
+  ASSERT_TRUE(cache.Restore(2500ms, time, state));
+  EXPECT_EQ(std::chrono::steady_clock::duration(1s), time);
+  ASSERT_TRUE(cache.Restore(3s, time, state));
+  EXPECT_EQ(std::chrono::steady_clock::duration(3s), time);
+
+  // Disabled cache
+  KeyframeCache disabled(0);
+  disabled.Insert(1s, makeState(1, "one"));
+  EXPECT_EQ(0u, disabled.Size());
+  EXPECT_FALSE(disabled.Restore(1s, time, state));
+}
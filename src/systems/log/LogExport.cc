@@ -0,0 +1,507 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "LogExport.hh"
+
+#include <ignition/msgs/serialized.pb.h>
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/transport/log/Batch.hh>
+#include <ignition/transport/log/Log.hh>
+#include <ignition/transport/log/Message.hh>
+
+#include "ignition/gazebo/components/ContactSensorData.hh"
+#include "ignition/gazebo/components/JointPosition.hh"
+#include "ignition/gazebo/components/JointVelocity.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+
+#include "StateLog.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+namespace
+{
+  /// \brief Function called with each recorded state and its sim time.
+  using StateCallback = std::function<void(
+      std::chrono::steady_clock::duration, const msgs::SerializedStateMap &)>;
+
+  /// \brief A column of a NumPy array file. Values are written as they're
+  /// appended, and the row count is filled in when the file is closed.
+  class NpyColumn
+  {
+    /// \brief Create the file.
+    /// \param[in] _path File path.
+    /// \param[in] _type NumPy type code without byte order, such as `f8`.
+    /// \return True if the file was created.
+    public: bool Open(const std::string &_path, const std::string &_type)
+    {
+      this->file.open(_path, std::ios::binary | std::ios::trunc);
+      if (!this->file)
+      {
+        ignerr << "Failed to create [" << _path << "]." << std::endl;
+        return false;
+      }
+
+      const uint16_t one{1};
+      char byteOrder =
+          *reinterpret_cast<const char *>(&one) == 1 ? '<' : '>';
+      this->descr = std::string(1, byteOrder) + _type;
+      this->WriteHeader();
+      return static_cast<bool>(this->file);
+    }
+
+    /// \brief Append a value.
+    /// \param[in] _value Value, whose type must match the column's.
+    public: template<typename T>
+            void Append(T _value)
+    {
+      this->file.write(reinterpret_cast<const char *>(&_value), sizeof(T));
+      ++this->rows;
+    }
+
+    /// \brief Write the row count and close the file.
+    /// \return True if all data was written.
+    public: bool Close()
+    {
+      if (!this->file.is_open())
+        return true;
+
+      this->file.seekp(0);
+      this->WriteHeader();
+      bool result = static_cast<bool>(this->file);
+      this->file.close();
+      return result;
+    }
+
+    /// \brief Write the header, whose size doesn't depend on the row count,
+    /// so it can be rewritten once the count is known.
+    private: void WriteHeader()
+    {
+      char shape[32];
+      std::snprintf(shape, sizeof(shape), "(%-20llu,)",
+          static_cast<unsigned long long>(this->rows));
+      std::string dict = "{'descr': '" + this->descr +
+          "', 'fortran_order': False, 'shape': " + shape + ", }";
+
+      // Magic, version 1.0, header length, then the header padded with
+      // spaces and ending with a newline, so data starts on 64 bytes
+      const std::size_t prefix{10};
+      std::size_t total = (prefix + dict.size() + 1 + 63) / 64 * 64;
+      dict.append(total - prefix - dict.size() - 1, ' ');
+      dict.push_back('\n');
+
+      auto headerLength = static_cast<uint16_t>(dict.size());
+      this->file.write("\x93NUMPY\x01\x00", 8);
+      const char length[2] = {static_cast<char>(headerLength & 0xff),
+          static_cast<char>(headerLength >> 8)};
+      this->file.write(length, 2);
+      this->file.write(dict.data(), dict.size());
+    }
+
+    /// \brief The file.
+    private: std::ofstream file;
+
+    /// \brief NumPy type, with byte order.
+    private: std::string descr;
+
+    /// \brief Number of rows.
+    private: uint64_t rows{0};
+  };
+
+  /// \brief A series of rows, stored in a directory with a file per column.
+  class NpySeries
+  {
+    /// \brief Create the directory and the column files.
+    /// \param[in] _dir Directory.
+    /// \param[in] _columns Column names and NumPy types.
+    /// \return True if all files were created.
+    public: bool Open(const std::string &_dir,
+        const std::vector<std::pair<std::string, std::string>> &_columns)
+    {
+      if (!common::createDirectories(_dir))
+      {
+        ignerr << "Failed to create directory [" << _dir << "]." << std::endl;
+        return false;
+      }
+
+      this->columns.resize(_columns.size());
+      for (std::size_t i = 0; i < _columns.size(); ++i)
+      {
+        if (!this->columns[i].Open(
+            common::joinPaths(_dir, _columns[i].first + ".npy"),
+            _columns[i].second))
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// \brief Get a column.
+    /// \param[in] _index Column index, in the order given to Open.
+    /// \return The column.
+    public: NpyColumn &Column(std::size_t _index)
+    {
+      return this->columns[_index];
+    }
+
+    /// \brief Close all columns.
+    /// \return True if all data was written.
+    public: bool Close()
+    {
+      bool result{true};
+      for (auto &column : this->columns)
+        result = column.Close() && result;
+      return result;
+    }
+
+    /// \brief Columns.
+    private: std::vector<NpyColumn> columns;
+  };
+
+  /// \brief Convert a state in the older vector format.
+  /// \param[in] _state State.
+  /// \param[out] _map Converted state.
+  void toMap(const msgs::SerializedState &_state,
+      msgs::SerializedStateMap &_map)
+  {
+    _map.Clear();
+    for (const auto &entityMsg : _state.entities())
+    {
+      auto &entity = (*_map.mutable_entities())[entityMsg.id()];
+      entity.set_id(entityMsg.id());
+      entity.set_remove(entityMsg.remove());
+      for (const auto &compMsg : entityMsg.components())
+      {
+        auto &comp = (*entity.mutable_components())[compMsg.type()];
+        comp.set_type(compMsg.type());
+        comp.set_component(compMsg.component());
+        comp.set_remove(compMsg.remove());
+      }
+    }
+  }
+
+  /// \brief Visit the states of a log in time order.
+  /// \param[in] _logPath Log directory.
+  /// \param[in] _callback Called with each state.
+  /// \return True if the log has states.
+  bool forEachState(const std::string &_logPath,
+      const StateCallback &_callback)
+  {
+    std::string stateLogPath = common::joinPaths(_logPath, "state.glog");
+    if (common::exists(stateLogPath))
+    {
+      StateLogReader reader;
+      if (!reader.Open(stateLogPath))
+        return false;
+
+      // Keyframes repeat all components, only changes are exported
+      StateChangeFilter filter;
+      for (std::size_t c = 0; c < reader.ChunkCount(); ++c)
+      {
+        auto frames = reader.Frames(c);
+        if (nullptr == frames)
+          return false;
+
+        for (const auto &frame : *frames)
+        {
+          msgs::SerializedStateMap state = frame.state;
+          filter.Filter(state, false);
+          _callback(frame.time, state);
+        }
+      }
+      return true;
+    }
+
+    std::string dbPath = common::joinPaths(_logPath, "state.tlog");
+    transport::log::Log log;
+    if (!common::exists(dbPath) || !log.Open(dbPath))
+    {
+      ignerr << "No [state.glog] or [state.tlog] in [" << _logPath << "]."
+             << std::endl;
+      return false;
+    }
+
+    msgs::SerializedStateMap state;
+    auto batch = log.QueryMessages();
+    for (const auto &msg : batch)
+    {
+      if (msg.Type() == "ignition.msgs.SerializedStateMap")
+      {
+        state.ParseFromString(msg.Data());
+      }
+      else if (msg.Type() == "ignition.msgs.SerializedState")
+      {
+        msgs::SerializedState vectorState;
+        vectorState.ParseFromString(msg.Data());
+        toMap(vectorState, state);
+      }
+      else
+      {
+        continue;
+      }
+      _callback(msg.TimeReceived(), state);
+    }
+    return true;
+  }
+
+  /// \brief Quote a CSV field.
+  /// \param[in] _field Field.
+  /// \return Quoted field.
+  std::string csvQuote(const std::string &_field)
+  {
+    std::string result{"\""};
+    for (char c : _field)
+    {
+      if (c == '"')
+        result.push_back('"');
+      result.push_back(c);
+    }
+    result.push_back('"');
+    return result;
+  }
+}
+
+//////////////////////////////////////////////////
+bool systems::exportLog(const std::string &_logPath,
+    const std::string &_outputPath, const std::set<std::string> &_series)
+{
+  IGN_PROFILE("exportLog");
+
+  const bool exportPose = _series.count("pose") > 0;
+  const bool exportJointPosition = _series.count("joint_position") > 0;
+  const bool exportJointVelocity = _series.count("joint_velocity") > 0;
+  const bool exportContacts = _series.count("contacts") > 0;
+
+  NpySeries pose;
+  NpySeries jointPosition;
+  NpySeries jointVelocity;
+  NpySeries contacts;
+
+  const std::vector<std::pair<std::string, std::string>> jointColumns{
+      {"time", "f8"}, {"entity", "u8"}, {"axis", "u4"}, {"value", "f8"}};
+  if ((exportPose && !pose.Open(common::joinPaths(_outputPath, "pose"),
+          {{"time", "f8"}, {"entity", "u8"}, {"x", "f8"}, {"y", "f8"},
+          {"z", "f8"}, {"qw", "f8"}, {"qx", "f8"}, {"qy", "f8"},
+          {"qz", "f8"}})) ||
+      (exportJointPosition && !jointPosition.Open(
+          common::joinPaths(_outputPath, "joint_position"), jointColumns)) ||
+      (exportJointVelocity && !jointVelocity.Open(
+          common::joinPaths(_outputPath, "joint_velocity"), jointColumns)) ||
+      (exportContacts && !contacts.Open(
+          common::joinPaths(_outputPath, "contacts"),
+          {{"time", "f8"}, {"entity", "u8"}, {"collision1", "u8"},
+          {"collision2", "u8"}, {"x", "f8"}, {"y", "f8"}, {"z", "f8"},
+          {"depth", "f8"}})))
+  {
+    return false;
+  }
+
+  auto appendJoint = [](NpySeries &_series, double _time, uint64_t _entity,
+      const std::vector<double> &_values)
+  {
+    for (std::size_t axis = 0; axis < _values.size(); ++axis)
+    {
+      _series.Column(0).Append(_time);
+      _series.Column(1).Append(_entity);
+      _series.Column(2).Append(static_cast<uint32_t>(axis));
+      _series.Column(3).Append(_values[axis]);
+    }
+  };
+
+  // Name and parent of every entity seen
+  std::map<uint64_t, std::pair<uint64_t, std::string>> names;
+
+  components::Pose poseComp;
+  components::JointPosition jointPositionComp;
+  components::JointVelocity jointVelocityComp;
+  components::ContactSensorData contactsComp;
+  components::Name nameComp;
+  components::ParentEntity parentComp;
+
+  bool result = forEachState(_logPath, [&](
+      std::chrono::steady_clock::duration _time,
+      const msgs::SerializedStateMap &_state)
+  {
+    double time = std::chrono::duration<double>(_time).count();
+    for (const auto &entityIter : _state.entities())
+    {
+      const auto &entityMsg = entityIter.second;
+      uint64_t entity = entityMsg.id();
+      for (const auto &compIter : entityMsg.components())
+      {
+        const auto &compMsg = compIter.second;
+        if (compMsg.remove() || compMsg.component().empty())
+          continue;
+
+        auto type = compMsg.type();
+        if (type == components::Name::typeId)
+        {
+          nameComp.DeserializeFromBuffer(compMsg.component());
+          names[entity].second = nameComp.Data();
+        }
+        else if (type == components::ParentEntity::typeId)
+        {
+          parentComp.DeserializeFromBuffer(compMsg.component());
+          names[entity].first = parentComp.Data();
+        }
+        else if (exportPose && type == components::Pose::typeId)
+        {
+          poseComp.DeserializeFromBuffer(compMsg.component());
+          const auto &p = poseComp.Data();
+          pose.Column(0).Append(time);
+          pose.Column(1).Append(entity);
+          pose.Column(2).Append(p.Pos().X());
+          pose.Column(3).Append(p.Pos().Y());
+          pose.Column(4).Append(p.Pos().Z());
+          pose.Column(5).Append(p.Rot().W());
+          pose.Column(6).Append(p.Rot().X());
+          pose.Column(7).Append(p.Rot().Y());
+          pose.Column(8).Append(p.Rot().Z());
+        }
+        else if (exportJointPosition &&
+            type == components::JointPosition::typeId)
+        {
+          jointPositionComp.DeserializeFromBuffer(compMsg.component());
+          appendJoint(jointPosition, time, entity, jointPositionComp.Data());
+        }
+        else if (exportJointVelocity &&
+            type == components::JointVelocity::typeId)
+        {
+          jointVelocityComp.DeserializeFromBuffer(compMsg.component());
+          appendJoint(jointVelocity, time, entity, jointVelocityComp.Data());
+        }
+        else if (exportContacts &&
+            type == components::ContactSensorData::typeId)
+        {
+          contactsComp.DeserializeFromBuffer(compMsg.component());
+          for (const auto &contact : contactsComp.Data().contact())
+          {
+            for (int i = 0; i < contact.position_size(); ++i)
+            {
+              const auto &position = contact.position(i);
+              contacts.Column(0).Append(time);
+              contacts.Column(1).Append(entity);
+              contacts.Column(2).Append(
+                  static_cast<uint64_t>(contact.collision1().id()));
+              contacts.Column(3).Append(
+                  static_cast<uint64_t>(contact.collision2().id()));
+              contacts.Column(4).Append(position.x());
+              contacts.Column(5).Append(position.y());
+              contacts.Column(6).Append(position.z());
+              contacts.Column(7).Append(
+                  i < contact.depth_size() ? contact.depth(i) : 0.0);
+            }
+          }
+        }
+      }
+    }
+  });
+
+  result = pose.Close() && result;
+  result = jointPosition.Close() && result;
+  result = jointVelocity.Close() && result;
+  result = contacts.Close() && result;
+
+  std::ofstream namesFile(common::joinPaths(_outputPath, "names.csv"));
+  namesFile << "entity,parent,name\n";
+  for (const auto &name : names)
+  {
+    namesFile << name.first << "," << name.second.first << ","
+              << csvQuote(name.second.second) << "\n";
+  }
+  return result && static_cast<bool>(namesFile);
+}
+
+//////////////////////////////////////////////////
+std::size_t systems::exportLogs(const std::vector<std::string> &_logPaths,
+    const LogExportOptions &_options)
+{
+  if (!common::createDirectories(_options.outputDir))
+  {
+    ignerr << "Failed to create directory [" << _options.outputDir << "]."
+           << std::endl;
+    return 0;
+  }
+
+  // Output directories are chosen up front, so logs with the same name
+  // don't race for the same directory
+  std::vector<std::string> outputPaths;
+  for (const auto &logPath : _logPaths)
+  {
+    std::string name = common::basename(logPath);
+    if (name.empty())
+      name = "log";
+    auto outputPath = common::uniqueDirectoryPath(
+        common::joinPaths(_options.outputDir, name));
+    common::createDirectories(outputPath);
+    outputPaths.push_back(outputPath);
+  }
+
+  std::size_t jobs = _options.jobs;
+  if (jobs == 0)
+    jobs = std::max(1u, std::thread::hardware_concurrency());
+  jobs = std::min(jobs, _logPaths.size());
+
+  // Logs are independent, so each thread takes the next one
+  std::atomic<std::size_t> next{0};
+  std::atomic<std::size_t> exported{0};
+  auto work = [&]()
+  {
+    for (auto i = next++; i < _logPaths.size(); i = next++)
+    {
+      if (exportLog(_logPaths[i], outputPaths[i], _options.series))
+      {
+        ignmsg << "Exported [" << _logPaths[i] << "] to [" << outputPaths[i]
+               << "]." << std::endl;
+        ++exported;
+      }
+      else
+      {
+        ignerr << "Failed to export [" << _logPaths[i] << "]." << std::endl;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 1; t < jobs; ++t)
+    threads.emplace_back(work);
+  work();
+  for (auto &thread : threads)
+    thread.join();
+
+  return exported;
+}
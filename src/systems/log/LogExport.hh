@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GAZEBO_SYSTEMS_LOG_LOGEXPORT_HH_
+#define IGNITION_GAZEBO_SYSTEMS_LOG_LOGEXPORT_HH_
+
+#include <cstddef>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/log-system/Export.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \brief Options of exportLogs.
+  struct LogExportOptions
+  {
+    /// \brief Directory which receives a directory per log.
+    std::string outputDir;
+
+    /// \brief Time series to export: `pose`, `joint_position`,
+    /// `joint_velocity` and `contacts`.
+    std::set<std::string> series{"pose", "joint_position", "joint_velocity",
+        "contacts"};
+
+    /// \brief Number of logs exported at the same time, 0 to use one per
+    /// hardware thread.
+    std::size_t jobs{0};
+  };
+
+  /// \brief Export component time series from a recorded log, reading
+  /// `state.glog` or `state.tlog` directly, without running a simulation.
+  ///
+  /// Each series goes to a directory of NumPy `.npy` files, one per column,
+  /// which all have a row per recorded change:
+  ///
+  /// - `pose`: `time`, `entity`, `x`, `y`, `z`, `qw`, `qx`, `qy`, `qz`. Poses
+  /// are relative to the parent entity.
+  /// - `joint_position` and `joint_velocity`: `time`, `entity`, `axis`,
+  /// `value`.
+  /// - `contacts`: `time`, `entity`, `collision1`, `collision2`, `x`, `y`,
+  /// `z`, `depth`, with a row per contact point.
+  ///
+  /// `names.csv` maps entities to their name and parent.
+  /// \param[in] _logPath Log directory.
+  /// \param[in] _outputPath Directory to create the files in.
+  /// \param[in] _series Series to export, see LogExportOptions.
+  /// \return True if the log was exported.
+  bool IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE exportLog(
+      const std::string &_logPath, const std::string &_outputPath,
+      const std::set<std::string> &_series);
+
+  /// \brief Export many logs in parallel, see exportLog. Each log goes to a
+  /// directory named after it in the output directory.
+  /// \param[in] _logPaths Log directories.
+  /// \param[in] _options Options.
+  /// \return Number of logs exported.
+  std::size_t IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE exportLogs(
+      const std::vector<std::string> &_logPaths,
+      const LogExportOptions &_options);
+}
+}
+}
+}
+#endif
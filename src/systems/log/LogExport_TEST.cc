@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <ignition/common/Filesystem.hh>
+
+#include "ignition/gazebo/components/JointPosition.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
+
+#include "LogExport.hh"
+#include "StateLog.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+using namespace std::chrono_literals;
+
+/////////////////////////////////////////////////
+/// \brief Add a component to a state.
+/// \param[in,out] _state State.
+/// \param[in] _entity Entity id.
+/// \param[in] _comp Component.
+void addComponent(msgs::SerializedStateMap &_state, uint64_t _entity,
+    const components::BaseComponent &_comp)
+{
+  auto &entity = (*_state.mutable_entities())[_entity];
+  entity.set_id(_entity);
+  auto &comp = (*entity.mutable_components())[_comp.TypeId()];
+  comp.set_type(_comp.TypeId());
+  _comp.SerializeToBuffer(*comp.mutable_component());
+}
+
+/////////////////////////////////////////////////
+/// \brief Read a whole file.
+/// \param[in] _path File path.
+/// \return Content.
+std::string readFile(const std::string &_path)
+{
+  std::ifstream file(_path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file),
+      std::istreambuf_iterator<char>());
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the number of rows of a .npy column, checking its header.
+/// \param[in] _path File path.
+/// \param[in] _itemSize Size of each value.
+/// \return Number of rows.
+std::size_t npyRows(const std::string &_path, std::size_t _itemSize)
+{
+  auto data = readFile(_path);
+  EXPECT_GE(data.size(), 64u);
+  if (data.size() < 64u)
+    return 0;
+  EXPECT_EQ(std::string("\x93NUMPY", 6), data.substr(0, 6));
+
+  std::size_t headerLength = static_cast<unsigned char>(data[8]) +
+      (static_cast<std::size_t>(static_cast<unsigned char>(data[9])) << 8);
+  EXPECT_EQ(0u, (10 + headerLength) % 64);
+  auto header = data.substr(10, headerLength);
+  EXPECT_EQ('\n', header.back());
+
+  auto shape = header.find("'shape': (");
+  EXPECT_NE(std::string::npos, shape);
+  std::size_t rows = std::stoul(header.substr(shape + 10));
+  EXPECT_EQ(10 + headerLength + rows * _itemSize, data.size());
+  return rows;
+}
+
+/////////////////////////////////////////////////
+TEST(LogExport, StateLog)
+{
+  const std::string logPath{"log_export_test_log"};
+  const std::string outputDir{"log_export_test_output"};
+  common::removeAll(logPath);
+  common::removeAll(outputDir);
+  ASSERT_TRUE(common::createDirectories(logPath));
+
+  // A model which moves every other step, with a joint
+  {
+    StateLogWriter writer;
+    ASSERT_TRUE(writer.Open(common::joinPaths(logPath, "state.glog"), 1s,
+        StateLogCompression::ZLIB));
+    for (int i = 0; i < 20; ++i)
+    {
+      std::chrono::steady_clock::duration time = i * 100ms;
+      msgs::SerializedStateMap state;
+      addComponent(state, 10, components::Name("box"));
+      addComponent(state, 10,
+          components::Pose(math::Pose3d(i / 2, 0, 0, 0, 0, 0)));
+      addComponent(state, 11,
+          components::JointPosition(std::vector<double>{0.1 * i, 0.5}));
+      writer.Write(time, std::move(state), writer.NeedsKeyframe(time));
+    }
+  }
+
+  EXPECT_EQ(1u, exportLogs({logPath}, {outputDir, {"pose", "joint_position"},
+      2}));
+
+  auto exported = common::joinPaths(outputDir, logPath);
+  EXPECT_EQ(10u, npyRows(common::joinPaths(exported, "pose", "time.npy"), 8));
+  EXPECT_EQ(10u, npyRows(common::joinPaths(exported, "pose", "qz.npy"), 8));
+  EXPECT_EQ(40u, npyRows(
+      common::joinPaths(exported, "joint_position", "axis.npy"), 4));
+  EXPECT_FALSE(common::exists(common::joinPaths(exported, "contacts")));
+
+  auto names = readFile(common::joinPaths(exported, "names.csv"));
+  EXPECT_NE(std::string::npos, names.find("10,0,\"box\""));
+
+  // Missing logs aren't exported
+  EXPECT_EQ(0u, exportLogs({"log_export_test_missing"}, {outputDir, {}, 1}));
+
+  common::removeAll(logPath);
+  common::removeAll(outputDir);
+}
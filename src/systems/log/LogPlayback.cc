@@ -20,9 +20,12 @@
 #include <ignition/msgs/pose_v.pb.h>
 #include <ignition/msgs/log_playback_stats.pb.h>
 
+#include <chrono>
 #include <set>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 #include <ignition/common/Filesystem.hh>
 #include <ignition/common/Profiler.hh>
@@ -41,12 +44,18 @@
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/Events.hh"
 #include "ignition/gazebo/SdfEntityCreator.hh"
+#include "ignition/gazebo/components/Factory.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/LogPlaybackStatistics.hh"
 #include "ignition/gazebo/components/Material.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/World.hh"
 
+#include "KeyframeCache.hh"
+#include "PlaybackFilter.hh"
+#include "StateLog.hh"
+#include "StateLogPrefetcher.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
@@ -93,9 +102,72 @@ class ignition::gazebo::systems::LogPlaybackPrivate
   public: void Parse(EntityComponentManager &_ecm,
       const msgs::SerializedStateMap &_msg);
 
+  /// \brief Play back states from the state log up to the current time.
+  /// Jumps back in time, or forward past the next chunk, start from the
+  /// keyframe before the current time.
+  /// \param[in] _info Current update info.
+  /// \param[in] _ecm Mutable ECM.
+  public: void UpdateStateLog(const UpdateInfo &_info,
+      EntityComponentManager &_ecm);
+
+  /// \brief Set the full state from a keyframe, removing entities which
+  /// aren't in it.
+  /// \param[in] _ecm Mutable ECM.
+  /// \param[in] _state Full state, whose components are moved from.
+  public: void SetKeyframe(EntityComponentManager &_ecm,
+      DeserializedState &&_state);
+
+  /// \brief Read the entities and components to play back.
+  /// \param[in] _sdf The <filter> element.
+  public: void ConfigureFilter(const sdf::ElementPtr &_sdf);
+
+  /// \brief Get whether playback is restricted to some entities or
+  /// components.
+  /// \return True if filtering.
+  public: bool Filtering() const;
+
+  /// \brief Entities and components to play back. It's copied by the state
+  /// log prefetcher, or used while playing back the transport log.
+  public: PlaybackFilter filter;
+
+  /// \brief True if the next state played back from the transport log is
+  /// the first state of the log, which holds all entities.
+  public: bool filterKeyframe{true};
+
+  /// \brief Full states reconstructed while playing back the transport
+  /// log, so seeking back doesn't replay it from the start.
+  public: KeyframeCache keyframes{32};
+
+  /// \brief Sim time between states kept in keyframes.
+  public: std::chrono::steady_clock::duration keyframePeriod{
+      std::chrono::seconds(5)};
+
+  /// \brief Sim time at which the next state is kept in keyframes.
+  public: std::chrono::steady_clock::duration nextKeyframeTime{0};
+
   /// \brief A batch of data from log file, of all pose messages
   public: transport::log::Batch batch;
 
+  /// \brief State log, used instead of the transport log when the log
+  /// directory has a `state.glog` file. Nullptr otherwise.
+  public: std::unique_ptr<StateLogPrefetcher> stateLog;
+
+  /// \brief Number of state log chunks to prepare ahead of playback.
+  public: std::size_t prefetchChunks{2};
+
+  /// \brief State log chunk being played back, nullptr if none.
+  public: std::unique_ptr<PreparedStateLogChunk> stateLogChunk;
+
+  /// \brief Index of the next frame to play back in stateLogChunk.
+  public: std::size_t stateLogFrame{0};
+
+  /// \brief True if the next frame played back replaces the whole state,
+  /// which happens after seeking.
+  public: bool stateLogSeeking{false};
+
+  /// \brief Time of the last state played back from the state log.
+  public: std::chrono::steady_clock::duration stateLogTime{0};
+
   /// \brief Pointer to ign-transport Log
   public: std::unique_ptr<transport::log::Log> log;
 
@@ -155,6 +227,8 @@ void LogPlaybackPrivate::Parse(const msgs::Pose_V &_msg, bool &_clear)
   for (auto i=0; i < _msg.pose_size(); ++i)
   {
     const auto &pose = _msg.pose(i);
+    if (!this->filter.Allowed(pose.id()))
+      continue;
     this->recentEntityPoseUpdates.insert_or_assign(pose.id(), pose);
   }
 
@@ -167,6 +241,12 @@ void LogPlaybackPrivate::Parse(const msgs::Pose_V &_msg, bool &_clear)
 void LogPlaybackPrivate::Parse(EntityComponentManager &_ecm,
     const msgs::SerializedStateMap &_msg)
 {
+  if (this->Filtering())
+  {
+    _ecm.SetState(this->filter.Deserialize(_msg, this->filterKeyframe));
+    this->filterKeyframe = false;
+    return;
+  }
   _ecm.SetState(_msg);
 }
 
@@ -174,9 +254,81 @@ void LogPlaybackPrivate::Parse(EntityComponentManager &_ecm,
 void LogPlaybackPrivate::Parse(EntityComponentManager &_ecm,
     const msgs::SerializedState &_msg)
 {
+  if (this->Filtering())
+  {
+    static bool warned{false};
+    if (!warned)
+    {
+      ignwarn << "The log was recorded with the SerializedState format, "
+              << "which can't be filtered. Playing back all entities."
+              << std::endl;
+      warned = true;
+    }
+  }
   _ecm.SetState(_msg);
 }
 
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::ConfigureFilter(const sdf::ElementPtr &_sdf)
+{
+  for (auto elem = _sdf->FindElement("entity"); nullptr != elem;
+       elem = elem->GetNextElement("entity"))
+  {
+    auto entity = elem->Get<Entity>();
+    if (kNullEntity == entity)
+      continue;
+    this->filter.AllowEntity(entity);
+  }
+
+  for (auto elem = _sdf->FindElement("model"); nullptr != elem;
+       elem = elem->GetNextElement("model"))
+  {
+    auto name = elem->Get<std::string>();
+    if (!name.empty())
+      this->filter.AllowModel(name);
+  }
+
+  // Component types are given by name, with or without the
+  // "ign_gazebo_components." prefix
+  auto factory = components::Factory::Instance();
+  for (auto elem = _sdf->FindElement("component"); nullptr != elem;
+       elem = elem->GetNextElement("component"))
+  {
+    auto name = elem->Get<std::string>();
+    if (name.empty())
+      continue;
+
+    bool found{false};
+    for (auto typeId : factory->TypeIds())
+    {
+      auto typeName = factory->Name(typeId);
+      if (typeName == name || typeName == "ign_gazebo_components." + name)
+      {
+        this->filter.AllowComponent(typeId);
+        found = true;
+        break;
+      }
+    }
+    if (!found)
+    {
+      ignerr << "Unknown component type [" << name << "] in <filter>, "
+             << "ignoring it." << std::endl;
+    }
+  }
+
+  if (this->Filtering())
+  {
+    ignmsg << "Playing back a subset of the log's entities and components."
+           << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+bool LogPlaybackPrivate::Filtering() const
+{
+  return this->filter.FiltersEntities() || this->filter.FiltersComponents();
+}
+
 //////////////////////////////////////////////////
 void LogPlayback::Configure(const Entity &,
     const std::shared_ptr<const sdf::Element> &_sdf,
@@ -190,6 +342,48 @@ void LogPlayback::Configure(const Entity &,
   // Prepend working directory if path is relative
   this->dataPtr->logPath = common::absPath(this->dataPtr->logPath);
 
+  auto prefetchChunks = _sdf->Get<int>("prefetch_chunks", 2).first;
+  if (prefetchChunks > 0)
+  {
+    this->dataPtr->prefetchChunks = static_cast<std::size_t>(prefetchChunks);
+  }
+  else
+  {
+    ignerr << "Prefetch chunks must be positive, got [" << prefetchChunks
+           << "]. Using 2." << std::endl;
+  }
+
+  if (_sdf->HasElement("filter"))
+  {
+    auto sdfClone = _sdf->Clone();
+    this->dataPtr->ConfigureFilter(sdfClone->GetElement("filter"));
+  }
+
+  auto keyframeCache = _sdf->Get<int>("keyframe_cache", 32).first;
+  if (keyframeCache >= 0)
+  {
+    this->dataPtr->keyframes = KeyframeCache(
+        static_cast<std::size_t>(keyframeCache));
+  }
+  else
+  {
+    ignerr << "Keyframe cache size can't be negative, got ["
+           << keyframeCache << "]. Using 32." << std::endl;
+  }
+
+  auto keyframePeriod = _sdf->Get<double>("keyframe_period", 5.0).first;
+  if (keyframePeriod > 0)
+  {
+    this->dataPtr->keyframePeriod =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(keyframePeriod));
+  }
+  else
+  {
+    ignerr << "Keyframe period must be positive, got [" << keyframePeriod
+           << "]. Using 5 seconds." << std::endl;
+  }
+
   // Set the entity offset.
   // \todo This number should be included in the log file.
   _ecm.SetEntityCreateOffset(math::MAX_I64 / 2);
@@ -233,56 +427,92 @@ bool LogPlaybackPrivate::Start(EntityComponentManager &_ecm)
     return false;
   }
 
-  // Append file name
-  std::string dbPath = common::joinPaths(this->logPath, "state.tlog");
-  ignmsg << "Loading log file [" + dbPath + "]\n";
-  if (!common::exists(dbPath))
-  {
-    ignerr << "Log path invalid. File [" << dbPath << "] "
-      << "does not exist. Nothing to play.\n";
-    return false;
-  }
+  std::chrono::steady_clock::duration logStartTime;
+  std::chrono::steady_clock::duration logEndTime;
 
-  // Call Log.hh directly to load a .tlog file
-  this->log = std::make_unique<transport::log::Log>();
-  if (!this->log->Open(dbPath))
+  // Prefer the seekable state log
+  std::string stateLogPath = common::joinPaths(this->logPath, "state.glog");
+  if (common::exists(stateLogPath))
   {
-    ignerr << "Failed to open log file [" << dbPath << "]" << std::endl;
+    ignmsg << "Loading state log [" << stateLogPath << "]" << std::endl;
+    auto reader = std::make_unique<StateLogReader>();
+    if (!reader->Open(stateLogPath))
+    {
+      ignerr << "Failed to open state log [" << stateLogPath << "]. "
+             << "Nothing to play." << std::endl;
+      return false;
+    }
+    this->stateLog = std::make_unique<StateLogPrefetcher>(std::move(reader),
+        this->prefetchChunks, this->Filtering() ?
+        std::make_unique<PlaybackFilter>(this->filter) : nullptr);
+
+    this->stateLogChunk = this->stateLog->Take(0);
+    if (nullptr != this->stateLogChunk)
+    {
+      auto &frame = this->stateLogChunk->frames.front();
+      _ecm.SetState(std::move(frame.state));
+      this->stateLogTime = frame.time;
+      this->stateLogFrame = 1;
+    }
+    logStartTime = this->stateLog->Reader().StartTime();
+    logEndTime = this->stateLog->Reader().EndTime();
   }
+  else
+  {
+    // Append file name
+    std::string dbPath = common::joinPaths(this->logPath, "state.tlog");
+    ignmsg << "Loading log file [" + dbPath + "]\n";
+    if (!common::exists(dbPath))
+    {
+      ignerr << "Log path invalid. File [" << dbPath << "] "
+        << "does not exist. Nothing to play.\n";
+      return false;
+    }
 
-  // Access all messages in .tlog file
-  this->batch = this->log->QueryMessages();
-  auto iter = this->batch.begin();
+    // Call Log.hh directly to load a .tlog file
+    this->log = std::make_unique<transport::log::Log>();
+    if (!this->log->Open(dbPath))
+    {
+      ignerr << "Failed to open log file [" << dbPath << "]" << std::endl;
+    }
 
-  if (iter == this->batch.end())
-  {
-    ignerr << "No messages found in log file [" << dbPath << "]" << std::endl;
-  }
+    // Access all messages in .tlog file
+    this->batch = this->log->QueryMessages();
+    auto iter = this->batch.begin();
 
-  // Look for the first SerializedState message and use it to set the initial
-  // state of the world. Messages received before this are ignored.
-  for (; iter != this->batch.end(); ++iter)
-  {
-    auto msgType = iter->Type();
-    if (msgType == "ignition.msgs.SerializedState")
+    if (iter == this->batch.end())
     {
-      msgs::SerializedState msg;
-      msg.ParseFromString(iter->Data());
-      this->Parse(_ecm, msg);
-      break;
+      ignerr << "No messages found in log file [" << dbPath << "]"
+             << std::endl;
     }
-    else if (msgType == "ignition.msgs.SerializedStateMap")
+
+    // Look for the first SerializedState message and use it to set the
+    // initial state of the world. Messages received before this are ignored.
+    for (; iter != this->batch.end(); ++iter)
     {
-      msgs::SerializedStateMap msg;
-      msg.ParseFromString(iter->Data());
-      this->Parse(_ecm, msg);
-      break;
+      auto msgType = iter->Type();
+      if (msgType == "ignition.msgs.SerializedState")
+      {
+        msgs::SerializedState msg;
+        msg.ParseFromString(iter->Data());
+        this->Parse(_ecm, msg);
+        break;
+      }
+      else if (msgType == "ignition.msgs.SerializedStateMap")
+      {
+        msgs::SerializedStateMap msg;
+        msg.ParseFromString(iter->Data());
+        this->Parse(_ecm, msg);
+        break;
+      }
     }
+    logStartTime = this->log->StartTime();
+    logEndTime = this->log->EndTime();
   }
 
   msgs::LogPlaybackStatistics logStats;
-  auto startTime = convert<msgs::Time>(this->log->StartTime());
-  auto endTime = convert<msgs::Time>(this->log->EndTime());
+  auto startTime = convert<msgs::Time>(logStartTime);
+  auto endTime = convert<msgs::Time>(logEndTime);
   logStats.mutable_start_time()->set_sec(startTime.sec());
   logStats.mutable_start_time()->set_nsec(startTime.nsec());
   logStats.mutable_end_time()->set_sec(endTime.sec());
@@ -483,6 +713,12 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
   if (!this->dataPtr->instStarted)
     return;
 
+  if (nullptr != this->dataPtr->stateLog)
+  {
+    this->dataPtr->UpdateStateLog(_info, _ecm);
+    return;
+  }
+
   // Get all messages from this timestep
   // TODO(anyone) Jumping forward can be expensive for long jumps. For now,
   // just playing every single step so we don't miss insertions and deletions.
@@ -495,12 +731,10 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
   {
     // Detected jumping back in time. This can be expensive.
     // To rewind / seek backward in time, we also need to play every single
-    // step from the beginning so we don't miss insertions and deletions
-    // This is because each serialized state is a changed state and not an
-    // absolute state.
-    // todo(anyone) Record absolute states during recording, i.e. key frames,
-    // so that playback can jump to these states without the need to
-    // incrementally build the states from the beginning
+    // step from the closest full state so we don't miss insertions and
+    // deletions. This is because each serialized state is a changed state
+    // and not an absolute state. The closest full state is the latest
+    // cached keyframe before the target time, or the start of the log.
 
     // Create a list of entities to be removed. The list will be updated later
     // as the log steps forward below
@@ -509,7 +743,28 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
     for (const auto &entity : entities)
       entitiesToRemove.insert(Entity(entity.first));
 
-    startTime = std::chrono::steady_clock::duration::zero();
+    DeserializedState keyframe;
+    std::chrono::steady_clock::duration keyframeTime;
+    if (this->dataPtr->keyframes.Restore(_info.simTime, keyframeTime,
+        keyframe))
+    {
+      for (const auto &entity : keyframe.entities)
+      {
+        if (!entity.remove)
+          entitiesToRemove.erase(entity.id);
+      }
+      this->dataPtr->filter.SetKeyframe(keyframe);
+      this->dataPtr->filterKeyframe = false;
+      _ecm.SetState(std::move(keyframe));
+      startTime = keyframeTime;
+    }
+    else
+    {
+      this->dataPtr->filterKeyframe = true;
+      startTime = std::chrono::steady_clock::duration::zero();
+    }
+    this->dataPtr->nextKeyframeTime = startTime +
+        this->dataPtr->keyframePeriod;
   }
 
   this->dataPtr->batch = this->dataPtr->log->QueryMessages(
@@ -643,6 +898,16 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
     _ecm.RequestRemoveEntity(entity);
   }
 
+  // Keep the reconstructed state periodically, so seeking back can start
+  // from it
+  if (this->dataPtr->keyframes.Capacity() > 0 &&
+      _info.simTime >= this->dataPtr->nextKeyframeTime)
+  {
+    this->dataPtr->keyframes.Insert(_info.simTime, _ecm.CopyState());
+    this->dataPtr->nextKeyframeTime = _info.simTime +
+        this->dataPtr->keyframePeriod;
+  }
+
   // pause playback if end of log is reached
   if (_info.simTime >= this->dataPtr->log->EndTime())
   {
@@ -654,6 +919,90 @@ void LogPlayback::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
   }
 }
 
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::SetKeyframe(EntityComponentManager &_ecm,
+    DeserializedState &&_state)
+{
+  std::unordered_set<Entity> inKeyframe;
+  for (const auto &entity : _state.entities)
+    inKeyframe.insert(entity.id);
+
+  std::unordered_set<Entity> toRemove;
+  for (const auto &entity : _ecm.Entities().Vertices())
+  {
+    if (inKeyframe.find(entity.first) == inKeyframe.end())
+      toRemove.insert(entity.first);
+  }
+
+  _ecm.SetState(std::move(_state));
+  for (auto entity : toRemove)
+    _ecm.RequestRemoveEntity(entity);
+}
+
+//////////////////////////////////////////////////
+void LogPlaybackPrivate::UpdateStateLog(const UpdateInfo &_info,
+    EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("LogPlaybackPrivate::UpdateStateLog");
+
+  const auto &reader = this->stateLog->Reader();
+  auto target = _info.simTime;
+  auto targetChunk = reader.ChunkAt(target);
+
+  // Replaying the chunks in between would take longer than decoding the
+  // target's chunk, which starts with a keyframe. Frames are moved into
+  // the ECM once played, so going back always seeks.
+  bool seek = target < this->stateLogTime ||
+      nullptr == this->stateLogChunk ||
+      targetChunk > this->stateLogChunk->index + 1;
+  if (seek)
+  {
+    this->stateLogChunk = this->stateLog->Take(targetChunk);
+    this->stateLogFrame = 0;
+    this->stateLogSeeking = true;
+  }
+
+  // Chunks are decoded ahead by the prefetcher, only their components are
+  // moved into the ECM here
+  while (nullptr != this->stateLogChunk)
+  {
+    auto &frames = this->stateLogChunk->frames;
+    if (this->stateLogFrame < frames.size())
+    {
+      auto &frame = frames[this->stateLogFrame];
+      if (frame.time > target)
+        break;
+
+      if (this->stateLogSeeking)
+        this->SetKeyframe(_ecm, std::move(frame.state));
+      else
+        _ecm.SetState(std::move(frame.state));
+      this->stateLogSeeking = false;
+      ++this->stateLogFrame;
+      continue;
+    }
+
+    if (this->stateLogChunk->index >= targetChunk)
+      break;
+
+    this->stateLogChunk = this->stateLog->Take(
+        this->stateLogChunk->index + 1);
+    this->stateLogFrame = 0;
+  }
+  this->stateLogTime = target;
+  this->ReplaceResourceURIs(_ecm);
+
+  // pause playback if end of log is reached
+  if (_info.simTime >= reader.EndTime())
+  {
+    ignmsg << "End of log file reached. Time: " <<
+      std::chrono::duration_cast<std::chrono::seconds>(
+      reader.EndTime()).count() << " seconds" << std::endl;
+
+    this->eventManager->Emit<events::Pause>(true);
+  }
+}
+
 IGNITION_ADD_PLUGIN(ignition::gazebo::systems::LogPlayback,
                     ignition::gazebo::System,
                     LogPlayback::ISystemConfigure,
@@ -36,6 +36,29 @@ namespace systems
   /// \class LogPlayback LogPlayback.hh
   ///   ignition/gazebo/systems/log/LogPlayback.hh
   /// \brief Log state playback
+  ///
+  /// ## System Parameters
+  ///
+  /// - `<playback_path>`: Log directory or compressed log file.
+  /// - `<prefetch_chunks>`: Number of `state.glog` chunks to decode ahead of
+  /// playback on a separate thread, defaults to 2.
+  /// - `<keyframe_cache>`: Number of full states kept in memory while
+  /// playing back a `state.tlog`, defaults to 32. Seeking back replays the
+  /// log from the closest kept state instead of from the start. Zero
+  /// disables the cache.
+  /// - `<keyframe_period>`: Sim time in seconds between kept states,
+  /// defaults to 5.
+  /// - `<filter>`: Restricts playback to some entities and components, so
+  /// the rest of the log is never deserialized. It can hold:
+  ///   - `<entity>`: Id of an entity to play back with its descendants.
+  ///   - `<model>`: Name of the models to play back with their descendants.
+  ///   - `<component>`: Component type to update, such as
+  ///     `ign_gazebo_components.Pose` or `Pose`. Entities are still created
+  ///     with all their components.
+  ///
+  ///   Each may be repeated. The world is always played back. Without
+  ///   `<entity>` or `<model>`, all entities are played back, and without
+  ///   `<component>`, all components.
   class LogPlayback:
     public System,
     public ISystemConfigure,
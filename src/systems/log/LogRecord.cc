@@ -18,13 +18,20 @@
 #include "LogRecord.hh"
 
 #include <sys/stat.h>
+#include <ignition/msgs/param.pb.h>
 #include <ignition/msgs/stringmsg.pb.h>
 
+#include <chrono>
 #include <string>
 #include <fstream>
 #include <ctime>
+#include <functional>
 #include <set>
 #include <list>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Filesystem.hh>
@@ -61,6 +68,9 @@
 
 #include "ignition/gazebo/Util.hh"
 
+#include "SensorLog.hh"
+#include "StateLog.hh"
+
 using namespace ignition;
 using namespace ignition::gazebo;
 using namespace ignition::gazebo::systems;
@@ -144,6 +154,9 @@ class ignition::gazebo::systems::LogRecordPrivate
   /// \brief Publisher for state changes
   public: transport::Node::Publisher statePub;
 
+  /// \brief Publisher of state log writer counters, see PublishStats.
+  public: transport::Node::Publisher statsPub;
+
   /// \brief Message holding SDF string of world
   public: msgs::StringMsg sdfMsg;
 
@@ -158,6 +171,52 @@ class ignition::gazebo::systems::LogRecordPrivate
 
   /// \brief List of saved models if record with resources is enabled.
   public: std::set<std::string> savedModels;
+
+  /// \brief True to record states into a state log instead of the
+  /// transport log, see `<format>`.
+  public: bool stateLogFormat{false};
+
+  /// \brief Publish the state log writer's counters, if anyone listens.
+  public: void PublishStats();
+
+  /// \brief Sim time between keyframes in the state log.
+  public: std::chrono::steady_clock::duration keyframePeriod{
+      std::chrono::seconds(1)};
+
+  /// \brief Compression of state log chunks.
+  public: StateLogCompression stateLogCompression{StateLogCompression::ZLIB};
+
+  /// \brief What to do when the state log writer falls behind.
+  public: StateLogBackPressure backPressure{StateLogBackPressure::BLOCK};
+
+  /// \brief Number of frames the state log writer can fall behind.
+  public: std::size_t maxQueuedFrames{256};
+
+  /// \brief State log writer, used for the glog format.
+  public: StateLogWriter stateLog;
+
+  /// \brief Open the sensor log and subscribe to the sensor streams.
+  /// \return True if there aren't any streams, or the log was opened.
+  public: bool StartSensorLog();
+
+  /// \brief Sensor streams to record, from `<record_sensor>`.
+  public: std::vector<SensorLogStream> sensorStreams;
+
+  /// \brief Bytes of sensor messages which can wait to be written before
+  /// messages are dropped.
+  public: std::size_t maxQueuedSensorBytes{256u << 20};
+
+  /// \brief Sensor log writer, open if there are sensor streams.
+  public: SensorLogWriter sensorLog;
+
+  /// \brief Time of the last keyframe marked in the sensor log.
+  public: std::optional<std::chrono::steady_clock::duration>
+      lastSensorKeyframe;
+
+  /// \brief Drops components which were marked as changed but whose data
+  /// is the same as last recorded, nullptr if disabled. Only used for the
+  /// tlog format, the state log writer filters on its own thread.
+  public: std::unique_ptr<StateChangeFilter> changeFilter;
 };
 
 bool LogRecordPrivate::started{false};
@@ -175,6 +234,29 @@ std::string LogRecordPrivate::AppendExtension(const std::string &_dir,
   return rv;
 }
 
+//////////////////////////////////////////////////
+void LogRecordPrivate::PublishStats()
+{
+  if (!this->statsPub.HasConnections())
+    return;
+
+  auto stats = this->stateLog.Stats();
+  msgs::Param msg;
+  // Any has no 64-bit integer field, and doubles hold counts exactly up to
+  // 2^53, so counters are published as doubles, like system statistics.
+  auto addStat = [&msg](const std::string &_name, uint64_t _value)
+  {
+    auto &param = (*msg.mutable_params())[_name];
+    param.set_type(msgs::Any::DOUBLE);
+    param.set_double_value(static_cast<double>(_value));
+  };
+  addStat("queue_depth", stats.queueDepth);
+  addStat("max_queue_depth", stats.maxQueueDepth);
+  addStat("dropped_frames", stats.droppedFrames);
+  addStat("written_frames", stats.writtenFrames);
+  this->statsPub.Publish(msg);
+}
+
 //////////////////////////////////////////////////
 LogRecord::LogRecord()
   : System(), dataPtr(std::make_unique<LogRecordPrivate>())
@@ -188,13 +270,59 @@ LogRecord::~LogRecord()
   {
     // Use ign-transport directly
     this->dataPtr->recorder.Stop();
+    this->dataPtr->stateLog.Close();
 
-    if (this->dataPtr->compress)
+    // Stop the callbacks before the sensor log goes away
+    for (const auto &stream : this->dataPtr->sensorStreams)
+      this->dataPtr->node.Unsubscribe(stream.topic);
+    this->dataPtr->sensorLog.Close();
+    if (!this->dataPtr->sensorStreams.empty())
+    {
+      auto stats = this->dataPtr->sensorLog.Stats();
+      igndbg << "Recorded [" << stats.writtenRecords << "] sensor messages, "
+             << "dropped [" << stats.droppedRecords << "]." << std::endl;
+      if (stats.droppedRecords > 0)
+      {
+        ignwarn << "Dropped [" << stats.droppedRecords << "] sensor messages "
+                << "because the disk couldn't keep up. Increase "
+                << "<max_queued_sensor_mb> to keep them." << std::endl;
+      }
+    }
+    if (this->dataPtr->stateLogFormat)
+    {
+      auto stats = this->dataPtr->stateLog.Stats();
+      igndbg << "Recorded [" << stats.writtenFrames << "] states, dropped ["
+             << stats.droppedFrames << "], largest queue ["
+             << stats.maxQueueDepth << "]." << std::endl;
+      if (stats.droppedFrames > 0)
+      {
+        ignwarn << "Dropped [" << stats.droppedFrames << "] states because "
+                << "the disk couldn't keep up. Increase <max_queued_frames> "
+                << "or use <back_pressure>block</back_pressure> to keep "
+                << "them." << std::endl;
+      }
+    }
+
+    // State logs compress chunks while recording, so zipping them would
+    // take a long pass over data which doesn't compress further
+    if (this->dataPtr->compress && this->dataPtr->stateLogFormat)
+    {
+      ignmsg << "States were compressed while recording, not compressing ["
+             << this->dataPtr->logPath << "]." << std::endl;
+    }
+    else if (this->dataPtr->compress)
+    {
       this->dataPtr->CompressStateAndResources();
+    }
     this->dataPtr->savedModels.clear();
 
     LogRecordPrivate::started = false;
     ignmsg << "Stopping recording" << std::endl;
+    if (this->dataPtr->changeFilter)
+    {
+      igndbg << "Skipped [" << this->dataPtr->changeFilter->Dropped()
+             << "] unchanged components." << std::endl;
+    }
   }
 }
 
@@ -213,6 +341,125 @@ void LogRecord::Configure(const Entity &_entity,
   this->dataPtr->compress = _sdf->Get<bool>("compress", false).first;
   this->dataPtr->cmpPath = _sdf->Get<std::string>("compress_path", "").first;
 
+  auto format = _sdf->Get<std::string>("format", "tlog").first;
+  if (format == "glog")
+  {
+    this->dataPtr->stateLogFormat = true;
+  }
+  else if (format != "tlog")
+  {
+    ignerr << "Unknown log format [" << format << "], expected [tlog] or "
+           << "[glog]. Recording in [tlog]." << std::endl;
+  }
+
+  auto keyframePeriod = _sdf->Get<double>("keyframe_period", 1.0).first;
+  if (keyframePeriod > 0.0)
+  {
+    this->dataPtr->keyframePeriod =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(keyframePeriod));
+  }
+  else
+  {
+    ignerr << "Keyframe period must be positive, got [" << keyframePeriod
+           << "]. Using 1 second." << std::endl;
+  }
+
+  if (_sdf->Get<bool>("skip_unchanged", true).first)
+    this->dataPtr->changeFilter = std::make_unique<StateChangeFilter>();
+
+  auto compression = _sdf->Get<std::string>("compression", "zlib").first;
+  if (compression == "none")
+    this->dataPtr->stateLogCompression = StateLogCompression::NONE;
+  else if (compression != "zlib")
+  {
+    ignerr << "Unknown compression [" << compression << "], expected "
+           << "[zlib] or [none]. Using [zlib]." << std::endl;
+  }
+
+  auto backPressure = _sdf->Get<std::string>("back_pressure", "block").first;
+  if (backPressure == "drop")
+    this->dataPtr->backPressure = StateLogBackPressure::DROP;
+  else if (backPressure == "keyframes_only")
+    this->dataPtr->backPressure = StateLogBackPressure::KEYFRAMES_ONLY;
+  else if (backPressure != "block")
+  {
+    ignerr << "Unknown back pressure policy [" << backPressure << "], "
+           << "expected [block], [drop] or [keyframes_only]. Using [block]."
+           << std::endl;
+  }
+
+  auto maxQueuedFrames = _sdf->Get<int>("max_queued_frames", 256).first;
+  if (maxQueuedFrames > 0)
+  {
+    this->dataPtr->maxQueuedFrames =
+        static_cast<std::size_t>(maxQueuedFrames);
+  }
+  else
+  {
+    ignerr << "Max queued frames must be positive, got [" << maxQueuedFrames
+           << "]. Using 256." << std::endl;
+  }
+
+  auto maxQueuedSensorMb = _sdf->Get<double>("max_queued_sensor_mb",
+      256.0).first;
+  if (maxQueuedSensorMb > 0.0)
+  {
+    this->dataPtr->maxQueuedSensorBytes =
+        static_cast<std::size_t>(maxQueuedSensorMb * (1u << 20));
+  }
+  else
+  {
+    ignerr << "Max queued sensor data must be positive, got ["
+           << maxQueuedSensorMb << "] MiB. Using 256 MiB." << std::endl;
+  }
+
+  auto ptr = const_cast<sdf::Element *>(_sdf.get());
+  for (auto sensorElem = ptr->FindElement("record_sensor"); sensorElem;
+      sensorElem = sensorElem->GetNextElement("record_sensor"))
+  {
+    SensorLogStream stream;
+    stream.topic = sensorElem->Get<std::string>("topic", "").first;
+    if (stream.topic.empty())
+    {
+      ignerr << "<record_sensor> is missing a <topic>, ignoring it."
+             << std::endl;
+      continue;
+    }
+
+    auto type = sensorElem->Get<std::string>("type", "image").first;
+    if (type == "laser_scan")
+    {
+      stream.type = SensorLogStreamType::LASER_SCAN;
+    }
+    else if (type != "image")
+    {
+      ignerr << "Unknown sensor message type [" << type << "] on ["
+             << stream.topic << "], expected [image] or [laser_scan]. "
+             << "Not recording it." << std::endl;
+      continue;
+    }
+
+    bool scan = stream.type == SensorLogStreamType::LASER_SCAN;
+    auto codec = sensorElem->Get<std::string>("codec",
+        scan ? "delta" : "zlib").first;
+    if (codec == "raw")
+      stream.codec = SensorLogCodec::RAW;
+    else if (codec == "zlib")
+      stream.codec = SensorLogCodec::ZLIB;
+    else if (codec == "delta" && scan)
+      stream.codec = SensorLogCodec::DELTA;
+    else
+    {
+      stream.codec = scan ? SensorLogCodec::DELTA : SensorLogCodec::ZLIB;
+      ignerr << "Unknown codec [" << codec << "] for [" << type
+             << "] on [" << stream.topic << "], expected [raw], [zlib]"
+             << (scan ? " or [delta]" : "") << ". Using ["
+             << (scan ? "delta" : "zlib") << "]." << std::endl;
+    }
+    this->dataPtr->sensorStreams.push_back(stream);
+  }
+
   // If plugin is specified in both the SDF tag and on command line, only
   //   activate one recorder.
   if (!LogRecordPrivate::started)
@@ -323,12 +570,39 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
   std::string dynPoseTopic = "/world/" + this->worldName +
     "/dynamic_pose/info";
 
-  igndbg << "Recording default topic[" << dynPoseTopic << "].\n";
   igndbg << "Recording default topic[" << sdfTopic << "].\n";
-  igndbg << "Recording default topic[" << stateTopic << "].\n";
-  this->recorder.AddTopic(dynPoseTopic);
   this->recorder.AddTopic(sdfTopic);
-  this->recorder.AddTopic(stateTopic);
+
+  // States go to their own file, which also holds the poses
+  if (this->stateLogFormat)
+  {
+    std::string stateLogPath = common::joinPaths(this->logPath, "state.glog");
+    ignmsg << "Recording states to [" << stateLogPath << "]" << std::endl;
+    this->stateLog.SetBackPressure(this->backPressure, this->maxQueuedFrames);
+    this->stateLog.SetSkipUnchanged(this->changeFilter != nullptr);
+    this->changeFilter.reset();
+    if (!this->stateLog.Open(stateLogPath, this->keyframePeriod,
+        this->stateLogCompression))
+    {
+      return false;
+    }
+
+    std::string statsTopic = "/world/" + this->worldName +
+        "/log/record_stats";
+    auto validStatsTopic = transport::TopicUtils::AsValidTopic(statsTopic);
+    if (!validStatsTopic.empty())
+      this->statsPub = this->node.Advertise<msgs::Param>(validStatsTopic);
+  }
+  else
+  {
+    igndbg << "Recording default topic[" << dynPoseTopic << "].\n";
+    igndbg << "Recording default topic[" << stateTopic << "].\n";
+    this->recorder.AddTopic(dynPoseTopic);
+    this->recorder.AddTopic(stateTopic);
+  }
+
+  if (!this->StartSensorLog())
+    return false;
 
   // Get the topics to record, if any.
   if (this->sdf->HasElement("record_topic"))
@@ -374,6 +648,57 @@ bool LogRecordPrivate::Start(const std::string &_logPath,
     return false;
 }
 
+//////////////////////////////////////////////////
+bool LogRecordPrivate::StartSensorLog()
+{
+  if (this->sensorStreams.empty())
+    return true;
+
+  std::string sensorLogPath = common::joinPaths(this->logPath,
+      "sensors.slog");
+  ignmsg << "Recording sensors to [" << sensorLogPath << "]" << std::endl;
+  this->sensorLog.SetMaxQueuedBytes(this->maxQueuedSensorBytes);
+
+  std::vector<uint32_t> indices;
+  for (const auto &stream : this->sensorStreams)
+    indices.push_back(this->sensorLog.AddStream(stream));
+  if (!this->sensorLog.Open(sensorLogPath))
+    return false;
+
+  // Transport threads only copy messages into the writer's queue
+  for (std::size_t i = 0; i < this->sensorStreams.size(); ++i)
+  {
+    const auto &topic = this->sensorStreams[i].topic;
+    auto index = indices[i];
+    bool subscribed{false};
+    if (this->sensorStreams[i].type == SensorLogStreamType::IMAGE)
+    {
+      std::function<void(const msgs::Image &)> cb =
+          [this, index](const msgs::Image &_msg)
+          {
+            this->sensorLog.Write(index, _msg);
+          };
+      subscribed = this->node.Subscribe(topic, cb);
+    }
+    else
+    {
+      std::function<void(const msgs::LaserScan &)> cb =
+          [this, index](const msgs::LaserScan &_msg)
+          {
+            this->sensorLog.Write(index, _msg);
+          };
+      subscribed = this->node.Subscribe(topic, cb);
+    }
+
+    if (subscribed)
+      igndbg << "Recording sensor topic[" << topic << "].\n";
+    else
+      ignerr << "Failed to subscribe to sensor topic [" << topic << "]."
+             << std::endl;
+  }
+  return true;
+}
+
 //////////////////////////////////////////////////
 bool LogRecordPrivate::RecordResources() const
 {
@@ -698,14 +1023,54 @@ void LogRecord::PostUpdate(const UpdateInfo &_info,
 
   // TODO(louise) Use the SceneBroadcaster's topic once that publishes
   // the changed state
-  // \todo(anyone) A potential enhancement here is have a keyframe mechanism
-  // to store complete state periodically, and then store incremental from
-  // that. It would reduce some of the compute on replaying
-  // (especially in tools like plotting or seeking through logs).
+  // Only changes are recorded. The glog format also records keyframes
+  // with the full state periodically, so playback can seek.
   msgs::SerializedStateMap stateMsg;
-  _ecm.ChangedState(stateMsg);
-  if (!stateMsg.entities().empty())
-    this->dataPtr->statePub.Publish(stateMsg);
+  bool keyframe{false};
+  if (this->dataPtr->stateLogFormat)
+  {
+    // Keyframes hold the full state, so playback can seek to them
+    keyframe = this->dataPtr->stateLog.NeedsKeyframe(_info.simTime);
+    if (keyframe)
+      _ecm.State(stateMsg, {}, {}, true);
+    else
+      _ecm.ChangedState(stateMsg);
+
+    // Unchanged components are filtered on the writer thread
+    if (keyframe || !stateMsg.entities().empty())
+    {
+      this->dataPtr->stateLog.Write(_info.simTime, std::move(stateMsg),
+          keyframe);
+    }
+
+    if (keyframe)
+      this->dataPtr->PublishStats();
+  }
+  else
+  {
+    _ecm.ChangedState(stateMsg);
+    if (this->dataPtr->changeFilter)
+      this->dataPtr->changeFilter->Filter(stateMsg, false);
+    if (!stateMsg.entities().empty())
+      this->dataPtr->statePub.Publish(stateMsg);
+  }
+
+  // Index sensor data by the state keyframes, or by the keyframe period
+  // when states go to the transport log
+  if (!this->dataPtr->sensorStreams.empty())
+  {
+    auto &last = this->dataPtr->lastSensorKeyframe;
+    if (!this->dataPtr->stateLogFormat)
+    {
+      keyframe = !last || _info.simTime < *last ||
+          _info.simTime - *last >= this->dataPtr->keyframePeriod;
+    }
+    if (keyframe)
+    {
+      this->dataPtr->sensorLog.MarkKeyframe(_info.simTime);
+      last = _info.simTime;
+    }
+  }
 
   // If there are new models loaded, save meshes and textures
   if (this->dataPtr->RecordResources() && _ecm.HasNewEntities())
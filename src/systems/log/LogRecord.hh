@@ -35,6 +35,34 @@ namespace systems
 
   /// \class LogRecord LogRecord.hh ignition/gazebo/systems/log/LogRecord.hh
   /// \brief Log state recorder
+  ///
+  /// ## System Parameters
+  ///
+  /// - `<format>`: `tlog` to record states to the transport log, or `glog`
+  /// to record them to a seekable StateLogWriter file. Defaults to `tlog`.
+  /// - `<keyframe_period>`: Sim time in seconds between `glog` keyframes,
+  /// and between sensor log index entries, defaults to 1.
+  /// - `<compression>`: Compression of `glog` chunks, `zlib` or `none`.
+  /// Defaults to `zlib`.
+  /// - `<skip_unchanged>`: True to leave out components which were marked
+  /// as changed but have the same data as when they were last recorded,
+  /// such as the poses of resting bodies. Defaults to true.
+  /// - `<back_pressure>`: What to do when `glog` writing falls behind
+  /// simulation: `block` to wait, `drop` to drop states, or
+  /// `keyframes_only` to only keep keyframes until writing catches up.
+  /// Defaults to `block`.
+  /// - `<max_queued_frames>`: Number of states `glog` writing can fall
+  /// behind before `<back_pressure>` applies, defaults to 256.
+  /// - `<record_sensor>`: Sensor topic to record into `sensors.slog`, see
+  /// SensorLogWriter. May be repeated. Messages are compressed on a writer
+  /// thread and indexed by the state keyframes. Children:
+  ///   - `<topic>`: Topic to subscribe to.
+  ///   - `<type>`: `image` for msgs::Image or `laser_scan` for
+  ///   msgs::LaserScan. Defaults to `image`.
+  ///   - `<codec>`: `raw`, `zlib` or, for scans only, `delta`. Defaults to
+  ///   `zlib` for images and `delta` for scans.
+  /// - `<max_queued_sensor_mb>`: MiB of sensor messages which can wait to be
+  /// written before messages are dropped, defaults to 256.
   class LogRecord:
     public System,
     public ISystemConfigure,
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "PlaybackFilter.hh"
+
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include <ignition/common/Profiler.hh>
+
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/World.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+//////////////////////////////////////////////////
+void PlaybackFilter::AllowEntity(Entity _entity)
+{
+  this->entities.insert(_entity);
+}
+
+//////////////////////////////////////////////////
+void PlaybackFilter::AllowModel(const std::string &_name)
+{
+  this->models.insert(_name);
+}
+
+//////////////////////////////////////////////////
+void PlaybackFilter::AllowComponent(ComponentTypeId _type)
+{
+  this->components.insert(_type);
+}
+
+//////////////////////////////////////////////////
+bool PlaybackFilter::FiltersEntities() const
+{
+  return !this->entities.empty() || !this->models.empty();
+}
+
+//////////////////////////////////////////////////
+bool PlaybackFilter::FiltersComponents() const
+{
+  return !this->components.empty();
+}
+
+//////////////////////////////////////////////////
+bool PlaybackFilter::Allowed(Entity _entity) const
+{
+  return !this->FiltersEntities() ||
+      this->entities.find(_entity) != this->entities.end();
+}
+
+//////////////////////////////////////////////////
+void PlaybackFilter::SetKeyframe(const DeserializedState &_state)
+{
+  this->known.clear();
+  for (const auto &entity : _state.entities)
+    this->known.insert(entity.id);
+}
+
+//////////////////////////////////////////////////
+void PlaybackFilter::AllowDescendants(const msgs::SerializedStateMap &_state)
+{
+  // Only the few components identifying an entity are deserialized. A
+  // child may come before its parent in the state, so parents are resolved
+  // once all entities have been looked at.
+  std::unordered_map<Entity, Entity> parents;
+  for (const auto &iter : _state.entities())
+  {
+    const auto &entityMsg = iter.second;
+    const Entity entity = entityMsg.id();
+    if (entityMsg.remove() || this->Allowed(entity))
+      continue;
+
+    const auto &comps = entityMsg.components();
+
+    // The world is always played back, it holds the scene and physics
+    if (comps.find(components::World::typeId) != comps.end())
+    {
+      this->entities.insert(entity);
+      continue;
+    }
+
+    auto nameIt = comps.find(components::Name::typeId);
+    if (!this->models.empty() && nameIt != comps.end() &&
+        comps.find(components::Model::typeId) != comps.end())
+    {
+      components::Name name;
+      name.DeserializeFromBuffer(nameIt->second.component());
+      if (this->models.find(name.Data()) != this->models.end())
+      {
+        this->entities.insert(entity);
+        continue;
+      }
+    }
+
+    auto parentIt = comps.find(components::ParentEntity::typeId);
+    if (parentIt != comps.end())
+    {
+      components::ParentEntity parent;
+      parent.DeserializeFromBuffer(parentIt->second.component());
+      parents[entity] = parent.Data();
+    }
+  }
+
+  bool changed{true};
+  while (changed)
+  {
+    changed = false;
+    for (auto it = parents.begin(); it != parents.end();)
+    {
+      if (this->Allowed(it->second))
+      {
+        this->entities.insert(it->first);
+        it = parents.erase(it);
+        changed = true;
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+DeserializedState PlaybackFilter::Deserialize(
+    const msgs::SerializedStateMap &_state, bool _keyframe)
+{
+  IGN_PROFILE("PlaybackFilter::Deserialize");
+
+  if (!this->FiltersEntities() && !this->FiltersComponents())
+    return EntityComponentManager::DeserializeState(_state);
+
+  if (this->FiltersEntities())
+    this->AllowDescendants(_state);
+
+  std::function<bool(Entity)> entityFilter;
+  if (this->FiltersEntities())
+  {
+    entityFilter = [this](Entity _entity)
+    {
+      return this->Allowed(_entity);
+    };
+  }
+
+  // Entities which weren't in the previous states are complete
+  std::function<bool(Entity, ComponentTypeId)> componentFilter;
+  if (this->FiltersComponents())
+  {
+    if (_keyframe)
+      this->known.clear();
+
+    std::unordered_set<Entity> created;
+    for (const auto &iter : _state.entities())
+    {
+      const Entity entity = iter.second.id();
+      if (_keyframe || this->known.insert(entity).second)
+        created.insert(entity);
+    }
+    if (_keyframe)
+      this->known = created;
+
+    componentFilter = [this, created = std::move(created)](
+        Entity _entity, ComponentTypeId _type)
+    {
+      return created.find(_entity) != created.end() ||
+          this->components.find(_type) != this->components.end();
+    };
+  }
+
+  return EntityComponentManager::DeserializeState(_state, entityFilter,
+      componentFilter);
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_LOG_PLAYBACKFILTER_HH_
+#define IGNITION_GAZEBO_SYSTEMS_LOG_PLAYBACKFILTER_HH_
+
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include <string>
+#include <unordered_set>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/Entity.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/Types.hh>
+#include <ignition/gazebo/log-system/Export.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \brief Restricts log playback to a subset of the recorded entities
+  /// and components. The filter is applied while deserializing states, so
+  /// the data of skipped entities and components is never deserialized.
+  ///
+  /// An allowed entity's descendants are allowed too. They're found from
+  /// the ParentEntity components of the states, so states must be
+  /// deserialized in order, starting from a keyframe.
+  ///
+  /// When component types are given, only those types are updated.
+  /// Keyframes, and entities that first appear after the last keyframe,
+  /// keep all their components, so allowed entities are complete when
+  /// they're created.
+  ///
+  /// The filter keeps track of entities across states, so it must only be
+  /// used from one thread at a time.
+  class IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE PlaybackFilter
+  {
+    /// \brief Allow an entity and its descendants.
+    /// \param[in] _entity Entity id, as recorded in the log.
+    public: void AllowEntity(Entity _entity);
+
+    /// \brief Allow the models with a name, and their descendants.
+    /// \param[in] _name Model name.
+    public: void AllowModel(const std::string &_name);
+
+    /// \brief Allow a component type to be updated.
+    /// \param[in] _type Component type id.
+    public: void AllowComponent(ComponentTypeId _type);
+
+    /// \brief Get whether entities are filtered.
+    /// \return True if entities or models were allowed.
+    public: bool FiltersEntities() const;
+
+    /// \brief Get whether component types are filtered.
+    /// \return True if component types were allowed.
+    public: bool FiltersComponents() const;
+
+    /// \brief Get whether an entity is played back.
+    /// \param[in] _entity Entity id.
+    /// \return True if the entity is allowed, or if entities aren't
+    /// filtered.
+    public: bool Allowed(Entity _entity) const;
+
+    /// \brief Deserialize the allowed part of a state.
+    /// \param[in] _state State message.
+    /// \param[in] _keyframe True if the state holds all entities, such as
+    /// the first state of a log or of a state log chunk.
+    /// \return The allowed entities and components.
+    public: DeserializedState Deserialize(
+        const msgs::SerializedStateMap &_state, bool _keyframe);
+
+    /// \brief Start filtering from a full state which didn't go through the
+    /// filter, such as a cached keyframe. Entities which aren't in it keep
+    /// all their components when they first appear.
+    /// \param[in] _state Full state.
+    public: void SetKeyframe(const DeserializedState &_state);
+
+    /// \brief Allow new entities of a state whose parent, or whose model
+    /// name, is allowed.
+    /// \param[in] _state State message.
+    private: void AllowDescendants(const msgs::SerializedStateMap &_state);
+
+    /// \brief Allowed entities, including descendants found so far.
+    private: std::unordered_set<Entity> entities;
+
+    /// \brief Allowed model names.
+    private: std::unordered_set<std::string> models;
+
+    /// \brief Allowed component types.
+    private: std::unordered_set<ComponentTypeId> components;
+
+    /// \brief Entities present since the last keyframe, whose components
+    /// are filtered.
+    private: std::unordered_set<Entity> known;
+  };
+}
+}
+}
+}
+#endif
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Pose.hh"
+#include "ignition/gazebo/components/World.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+
+#include "PlaybackFilter.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/////////////////////////////////////////////////
+/// \brief Get the ids of the entities of a state.
+/// \param[in] _state State.
+/// \return Entity ids.
+std::set<Entity> ids(const DeserializedState &_state)
+{
+  std::set<Entity> result;
+  for (const auto &entity : _state.entities)
+    result.insert(entity.id);
+  return result;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the component types of an entity of a state.
+/// \param[in] _state State.
+/// \param[in] _entity Entity id.
+/// \return Component types.
+std::set<ComponentTypeId> types(const DeserializedState &_state,
+    Entity _entity)
+{
+  std::set<ComponentTypeId> result;
+  for (const auto &entity : _state.entities)
+  {
+    if (entity.id != _entity)
+      continue;
+    for (const auto &comp : entity.components)
+      result.insert(comp->TypeId());
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+class PlaybackFilterTest : public ::testing::Test
+{
+  /// \brief Create a model with a link.
+  /// \param[in] _name Model name.
+  /// \return Model entity.
+  protected: Entity CreateModel(const std::string &_name)
+  {
+    auto model = this->ecm.CreateEntity();
+    this->ecm.CreateComponent(model, components::Model());
+    this->ecm.CreateComponent(model, components::Name(_name));
+    this->ecm.CreateComponent(model, components::ParentEntity(this->world));
+    this->ecm.CreateComponent(model, components::Pose());
+
+    auto link = this->ecm.CreateEntity();
+    this->ecm.CreateComponent(link, components::Name("link"));
+    this->ecm.CreateComponent(link, components::ParentEntity(model));
+    this->ecm.CreateComponent(link, components::Pose());
+    return model;
+  }
+
+  // Documentation inherited
+  protected: void SetUp() override
+  {
+    this->world = this->ecm.CreateEntity();
+    this->ecm.CreateComponent(this->world, components::World());
+    this->ecm.CreateComponent(this->world, components::Name("default"));
+
+    this->robot = this->CreateModel("robot");
+    this->other = this->CreateModel("other");
+  }
+
+  /// \brief Entity component manager recording the states.
+  protected: EntityComponentManager ecm;
+
+  /// \brief World entity.
+  protected: Entity world{kNullEntity};
+
+  /// \brief Model whose link is robot + 1.
+  protected: Entity robot{kNullEntity};
+
+  /// \brief Model whose link is other + 1.
+  protected: Entity other{kNullEntity};
+};
+
+/////////////////////////////////////////////////
+TEST_F(PlaybackFilterTest, NoFilter)
+{
+  msgs::SerializedStateMap msg;
+  this->ecm.State(msg);
+
+  PlaybackFilter filter;
+  EXPECT_FALSE(filter.FiltersEntities());
+  EXPECT_FALSE(filter.FiltersComponents());
+  EXPECT_TRUE(filter.Allowed(this->other));
+
+  auto state = filter.Deserialize(msg, true);
+  EXPECT_EQ(5u, state.entities.size());
+}
+
+/////////////////////////////////////////////////
+TEST_F(PlaybackFilterTest, Model)
+{
+  msgs::SerializedStateMap msg;
+  this->ecm.State(msg);
+
+  PlaybackFilter filter;
+  filter.AllowModel("robot");
+  EXPECT_TRUE(filter.FiltersEntities());
+
+  // The world, the model and its link are played back
+  auto state = filter.Deserialize(msg, true);
+  EXPECT_EQ((std::set<Entity>{this->world, this->robot, this->robot + 1}),
+      ids(state));
+  EXPECT_TRUE(filter.Allowed(this->robot + 1));
+  EXPECT_FALSE(filter.Allowed(this->other + 1));
+
+  // Links created later are found from their parent
+  auto newLink = this->ecm.CreateEntity();
+  this->ecm.CreateComponent(newLink, components::ParentEntity(this->robot));
+  auto newOther = this->ecm.CreateEntity();
+  this->ecm.CreateComponent(newOther, components::ParentEntity(this->other));
+
+  msgs::SerializedStateMap update;
+  this->ecm.State(update, {newLink, newOther, this->other});
+  state = filter.Deserialize(update, false);
+  EXPECT_EQ(std::set<Entity>{newLink}, ids(state));
+
+  // Removals of filtered out entities are dropped too
+  msgs::SerializedStateMap removal;
+  for (auto entity : {this->other, this->robot + 1})
+  {
+    auto &entityMsg = (*removal.mutable_entities())[entity];
+    entityMsg.set_id(entity);
+    entityMsg.set_remove(true);
+  }
+  state = filter.Deserialize(removal, false);
+  EXPECT_EQ(std::set<Entity>{this->robot + 1}, ids(state));
+}
+
+/////////////////////////////////////////////////
+TEST_F(PlaybackFilterTest, Entity)
+{
+  msgs::SerializedStateMap msg;
+  this->ecm.State(msg);
+
+  PlaybackFilter filter;
+  filter.AllowEntity(this->other + 1);
+
+  auto state = filter.Deserialize(msg, true);
+  EXPECT_EQ((std::set<Entity>{this->world, this->other + 1}), ids(state));
+}
+
+/////////////////////////////////////////////////
+TEST_F(PlaybackFilterTest, Component)
+{
+  msgs::SerializedStateMap msg;
+  this->ecm.State(msg);
+
+  PlaybackFilter filter;
+  filter.AllowComponent(components::Pose::typeId);
+  EXPECT_TRUE(filter.FiltersComponents());
+
+  // Keyframes are complete
+  auto state = filter.Deserialize(msg, true);
+  EXPECT_EQ(5u, state.entities.size());
+  EXPECT_EQ(4u, types(state, this->robot).size());
+
+  // Entities already played back only get the allowed components
+  state = filter.Deserialize(msg, false);
+  EXPECT_EQ(5u, state.entities.size());
+  EXPECT_EQ(std::set<ComponentTypeId>{components::Pose::typeId},
+      types(state, this->robot));
+  EXPECT_TRUE(types(state, this->world).empty());
+
+  // New entities are complete
+  auto model = this->CreateModel("new");
+  msgs::SerializedStateMap update;
+  this->ecm.State(update, {model, this->robot});
+  state = filter.Deserialize(update, false);
+  EXPECT_EQ(4u, types(state, model).size());
+  EXPECT_EQ(std::set<ComponentTypeId>{components::Pose::typeId},
+      types(state, this->robot));
+}
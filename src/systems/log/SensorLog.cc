@@ -0,0 +1,794 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "SensorLog.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+
+#include "../../network/Compression.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+namespace
+{
+  /// \brief Start of every sensor log.
+  constexpr char kFileMagic[8] = {'I', 'G', 'N', 'S', 'N', 'L', 'O', 'G'};
+
+  /// \brief Format version, increased on incompatible changes.
+  constexpr uint32_t kVersion{1};
+
+  /// \brief Start of every record.
+  constexpr uint32_t kRecordMagic{0x43455253};
+
+  /// \brief Magic number after the index.
+  constexpr uint32_t kIndexMagic{0x58444e53};
+
+  /// \brief Stream index of keyframe marks.
+  constexpr uint32_t kMarkStream{0xffffffff};
+
+  /// \brief Record payload isn't compressed.
+  constexpr uint32_t kStoredRaw{0};
+
+  /// \brief Record payload is compressed with zlib.
+  constexpr uint32_t kStoredZlib{1};
+
+  /// \brief Size of a record header: magic, stream, compression, time, raw
+  /// and stored sizes.
+  constexpr std::size_t kRecordHeaderSize{4 + 4 + 4 + 8 + 8 + 8};
+
+  /// \brief Size of the trailer: index offset and magic.
+  constexpr std::size_t kTrailerSize{8 + 4};
+
+  /// \brief Size of each index entry: time and offset.
+  constexpr std::size_t kIndexEntrySize{8 + 8};
+
+  /// \brief Scan values are filtered against the previous ray.
+  constexpr char kScanFromRay{0};
+
+  /// \brief Scan values are filtered against the previous scan.
+  constexpr char kScanFromReference{1};
+
+  //////////////////////////////////////////////////
+  /// \brief Append a little endian integer.
+  /// \param[in] _out Buffer.
+  /// \param[in] _value Value.
+  /// \param[in] _bytes Number of bytes to write.
+  void appendFixed(std::string &_out, uint64_t _value, std::size_t _bytes)
+  {
+    for (std::size_t i = 0; i < _bytes; ++i)
+      _out.push_back(static_cast<char>((_value >> (8 * i)) & 0xff));
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Read a little endian integer.
+  /// \param[in] _data Data, at least _bytes long.
+  /// \param[in] _bytes Number of bytes to read.
+  /// \return Value.
+  uint64_t readFixed(const char *_data, std::size_t _bytes)
+  {
+    uint64_t value{0};
+    for (std::size_t i = 0; i < _bytes; ++i)
+    {
+      value |= static_cast<uint64_t>(static_cast<unsigned char>(_data[i]))
+          << (8 * i);
+    }
+    return value;
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Convert a duration to nanoseconds for storage.
+  /// \param[in] _time Duration.
+  /// \return Nanoseconds.
+  uint64_t toNs(std::chrono::steady_clock::duration _time)
+  {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(_time).count());
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Convert stored nanoseconds to a duration.
+  /// \param[in] _ns Nanoseconds.
+  /// \return Duration.
+  std::chrono::steady_clock::duration fromNs(uint64_t _ns)
+  {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::nanoseconds(static_cast<int64_t>(_ns)));
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Get the time a message was stamped with.
+  /// \param[in] _header Message header.
+  /// \return Sim time.
+  std::chrono::steady_clock::duration stamp(const msgs::Header &_header)
+  {
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::seconds(_header.stamp().sec()) +
+        std::chrono::nanoseconds(_header.stamp().nsec()));
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Get the distance between image rows, which the rows are
+  /// filtered with.
+  /// \param[in] _msg Image whose data may have been moved out.
+  /// \param[in] _size Size of the image data.
+  /// \return Bytes per row, 0 if the rows can't be told apart.
+  std::size_t rowStep(const msgs::Image &_msg, std::size_t _size)
+  {
+    if (_msg.height() == 0)
+      return 0;
+    std::size_t step = _msg.step();
+    if (step == 0 || step * _msg.height() != _size)
+    {
+      if (_size % _msg.height() != 0)
+        return 0;
+      step = _size / _msg.height();
+    }
+    return step;
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Append the bytes of scan values.
+  /// \param[in] _values Values.
+  /// \param[out] _out Buffer.
+  void appendValues(const google::protobuf::RepeatedField<double> &_values,
+      std::string &_out)
+  {
+    for (double value : _values)
+    {
+      uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      appendFixed(_out, bits, 8);
+    }
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Read scan values.
+  /// \param[in] _data Bytes of the values.
+  /// \param[in] _count Number of values.
+  /// \param[out] _values Values.
+  void readValues(const char *_data, std::size_t _count,
+      google::protobuf::RepeatedField<double> &_values)
+  {
+    _values.Clear();
+    _values.Reserve(static_cast<int>(_count));
+    for (std::size_t i = 0; i < _count; ++i)
+    {
+      uint64_t bits = readFixed(_data + 8 * i, 8);
+      double value;
+      std::memcpy(&value, &bits, sizeof(value));
+      _values.Add(value);
+    }
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Encode the metadata of a message followed by its bulk data.
+  /// \param[in] _meta Message without bulk data.
+  /// \param[in] _bulk Bulk data.
+  /// \param[out] _out Payload.
+  void encodePayload(const google::protobuf::Message &_meta,
+      const std::string &_bulk, std::string &_out)
+  {
+    auto meta = _meta.SerializeAsString();
+    _out.clear();
+    _out.reserve(8 + meta.size() + _bulk.size());
+    appendFixed(_out, meta.size(), 8);
+    _out.append(meta);
+    _out.append(_bulk);
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Split a payload into the metadata and bulk data.
+  /// \param[in] _payload Payload.
+  /// \param[out] _meta Message to parse the metadata into.
+  /// \param[out] _bulkOffset Offset of the bulk data.
+  /// \return True if the payload was valid.
+  bool decodePayload(const std::string &_payload,
+      google::protobuf::Message &_meta, std::size_t &_bulkOffset)
+  {
+    if (_payload.size() < 8)
+      return false;
+    auto metaSize = readFixed(_payload.data(), 8);
+    if (metaSize > _payload.size() - 8)
+      return false;
+    _bulkOffset = 8 + static_cast<std::size_t>(metaSize);
+    return _meta.ParseFromArray(_payload.data() + 8,
+        static_cast<int>(metaSize));
+  }
+}
+
+//////////////////////////////////////////////////
+SensorLogWriter::~SensorLogWriter()
+{
+  this->Close();
+}
+
+//////////////////////////////////////////////////
+void SensorLogWriter::SetMaxQueuedBytes(std::size_t _bytes)
+{
+  this->maxQueuedBytes = _bytes;
+}
+
+//////////////////////////////////////////////////
+uint32_t SensorLogWriter::AddStream(SensorLogStream _stream)
+{
+  if (_stream.type == SensorLogStreamType::IMAGE &&
+      _stream.codec == SensorLogCodec::DELTA)
+  {
+    ignwarn << "Delta encoding is only for scans, recording images on ["
+            << _stream.topic << "] with zlib." << std::endl;
+    _stream.codec = SensorLogCodec::ZLIB;
+  }
+  if (_stream.codec != SensorLogCodec::RAW && !CompressionAvailable())
+  {
+    ignwarn << "Compression isn't available, messages on ["
+            << _stream.topic << "] won't be compressed." << std::endl;
+    _stream.codec = SensorLogCodec::RAW;
+  }
+  this->streams.push_back(std::move(_stream));
+  return static_cast<uint32_t>(this->streams.size() - 1);
+}
+
+//////////////////////////////////////////////////
+bool SensorLogWriter::Open(const std::string &_path)
+{
+  this->Close();
+
+  this->file.open(_path, std::ios::binary | std::ios::trunc);
+  if (!this->file)
+  {
+    ignerr << "Failed to create sensor log [" << _path << "]." << std::endl;
+    return false;
+  }
+  this->path = _path;
+
+  std::string header(kFileMagic, sizeof(kFileMagic));
+  appendFixed(header, kVersion, 4);
+  appendFixed(header, this->streams.size(), 4);
+  for (const auto &stream : this->streams)
+  {
+    appendFixed(header, static_cast<uint32_t>(stream.type), 4);
+    appendFixed(header, static_cast<uint32_t>(stream.codec), 4);
+    appendFixed(header, stream.topic.size(), 4);
+    header.append(stream.topic);
+  }
+  this->file.write(header.data(), header.size());
+  if (!this->file)
+    return false;
+
+  this->references.clear();
+  this->stats = SensorLogWriterStats();
+  this->stopWriter = false;
+  this->writerThread = std::thread(&SensorLogWriter::RunWriter, this);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool SensorLogWriter::Write(uint32_t _stream, const msgs::Image &_msg)
+{
+  if (_stream >= this->streams.size() ||
+      this->streams[_stream].type != SensorLogStreamType::IMAGE)
+  {
+    return false;
+  }
+
+  QueuedRecord record;
+  record.stream = _stream;
+  record.time = stamp(_msg.header());
+  record.bytes = _msg.data().size();
+  record.image = std::make_unique<msgs::Image>(_msg);
+  return this->Push(std::move(record));
+}
+
+//////////////////////////////////////////////////
+bool SensorLogWriter::Write(uint32_t _stream, const msgs::LaserScan &_msg)
+{
+  if (_stream >= this->streams.size() ||
+      this->streams[_stream].type != SensorLogStreamType::LASER_SCAN)
+  {
+    return false;
+  }
+
+  QueuedRecord record;
+  record.stream = _stream;
+  record.time = stamp(_msg.header());
+  record.bytes = sizeof(double) *
+      static_cast<std::size_t>(_msg.ranges_size() + _msg.intensities_size());
+  record.scan = std::make_unique<msgs::LaserScan>(_msg);
+  return this->Push(std::move(record));
+}
+
+//////////////////////////////////////////////////
+void SensorLogWriter::MarkKeyframe(std::chrono::steady_clock::duration _time)
+{
+  QueuedRecord record;
+  record.stream = kMarkStream;
+  record.time = _time;
+  this->Push(std::move(record));
+}
+
+//////////////////////////////////////////////////
+bool SensorLogWriter::Push(QueuedRecord &&_record)
+{
+  IGN_PROFILE("SensorLogWriter::Push");
+
+  std::lock_guard<std::mutex> lock(this->queueMutex);
+  if (this->stopWriter || !this->file.is_open())
+    return false;
+
+  // Publishers must never wait for the disk, marks are tiny and always kept
+  if (_record.bytes > 0 &&
+      this->stats.queuedBytes + _record.bytes > this->maxQueuedBytes)
+  {
+    ++this->stats.droppedRecords;
+    return false;
+  }
+
+  this->stats.queuedBytes += _record.bytes;
+  this->queue.push_back(std::move(_record));
+  this->queueCv.notify_all();
+  return true;
+}
+
+//////////////////////////////////////////////////
+SensorLogWriterStats SensorLogWriter::Stats() const
+{
+  std::lock_guard<std::mutex> lock(this->queueMutex);
+  return this->stats;
+}
+
+//////////////////////////////////////////////////
+void SensorLogWriter::RunWriter()
+{
+  IGN_PROFILE_THREAD_NAME("SensorLogWriter");
+
+  QueuedRecord record;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->queueMutex);
+      this->queueCv.wait(lock, [this]
+          {
+            return !this->queue.empty() || this->stopWriter;
+          });
+      if (this->queue.empty())
+        break;
+
+      record = std::move(this->queue.front());
+      this->queue.pop_front();
+      this->stats.queuedBytes -= record.bytes;
+      if (record.stream != kMarkStream)
+        ++this->stats.writtenRecords;
+    }
+
+    this->WriteRecord(record);
+  }
+}
+
+//////////////////////////////////////////////////
+void SensorLogWriter::WriteRecord(QueuedRecord &_record)
+{
+  IGN_PROFILE("SensorLogWriter::WriteRecord");
+
+  auto offset = static_cast<uint64_t>(this->file.tellp());
+  this->raw.clear();
+  auto storage = kStoredRaw;
+
+  if (_record.stream == kMarkStream)
+  {
+    // Records after a mark decode without the ones before it
+    this->references.clear();
+    this->index.push_back({_record.time, offset});
+  }
+  else if (_record.image)
+  {
+    std::string bulk;
+    bulk.swap(*_record.image->mutable_data());
+    if (this->streams[_record.stream].codec == SensorLogCodec::ZLIB)
+    {
+      // Neighboring rows are similar, so their differences are mostly
+      // small values, which compress much better than the pixels. Going
+      // backwards keeps the rows above unfiltered.
+      auto step = rowStep(*_record.image, bulk.size());
+      for (std::size_t i = bulk.size(); step > 0 && i-- > step;)
+      {
+        bulk[i] = static_cast<char>(static_cast<unsigned char>(bulk[i]) -
+            static_cast<unsigned char>(bulk[i - step]));
+      }
+    }
+    encodePayload(*_record.image, bulk, this->raw);
+  }
+  else if (_record.scan)
+  {
+    auto &scan = *_record.scan;
+    std::string values;
+    appendFixed(values, static_cast<uint64_t>(scan.ranges_size()), 8);
+    appendFixed(values, static_cast<uint64_t>(scan.intensities_size()), 8);
+    appendValues(scan.ranges(), values);
+    appendValues(scan.intensities(), values);
+    scan.clear_ranges();
+    scan.clear_intensities();
+
+    auto codec = this->streams[_record.stream].codec;
+    std::string bulk(1, kScanFromRay);
+    if (codec == SensorLogCodec::RAW)
+    {
+      bulk.append(values);
+    }
+    else
+    {
+      // XOR the values with the previous scan's, or the previous ray's.
+      // Identical values become zeros, and close ones share their sign,
+      // exponent and leading mantissa bytes.
+      auto ref = this->references.find(_record.stream);
+      bool fromReference = codec == SensorLogCodec::DELTA &&
+          ref != this->references.end() && ref->second.size() == values.size();
+      bulk[0] = fromReference ? kScanFromReference : kScanFromRay;
+      bulk.append(values);
+      for (std::size_t i = values.size(); i-- > 16;)
+      {
+        auto previous = fromReference ? ref->second[i] :
+            (i >= 24 ? values[i - 8] : 0);
+        bulk[1 + i] = static_cast<char>(values[i] ^ previous);
+      }
+      if (codec == SensorLogCodec::DELTA)
+        this->references[_record.stream] = std::move(values);
+    }
+    encodePayload(scan, bulk, this->raw);
+  }
+
+  const std::string *payload = &this->raw;
+  if (_record.stream != kMarkStream &&
+      this->streams[_record.stream].codec != SensorLogCodec::RAW &&
+      Compress(this->raw, this->compressed))
+  {
+    payload = &this->compressed;
+    storage = kStoredZlib;
+  }
+
+  std::string header;
+  appendFixed(header, kRecordMagic, 4);
+  appendFixed(header, _record.stream, 4);
+  appendFixed(header, storage, 4);
+  appendFixed(header, toNs(_record.time), 8);
+  appendFixed(header, this->raw.size(), 8);
+  appendFixed(header, payload->size(), 8);
+
+  this->file.write(header.data(), header.size());
+  this->file.write(payload->data(), payload->size());
+  if (!this->file)
+  {
+    ignerr << "Failed to write to sensor log [" << this->path << "]."
+           << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void SensorLogWriter::Close()
+{
+  if (!this->file.is_open())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(this->queueMutex);
+    this->stopWriter = true;
+    this->queueCv.notify_all();
+  }
+  if (this->writerThread.joinable())
+    this->writerThread.join();
+
+  auto indexOffset = static_cast<uint64_t>(this->file.tellp());
+  std::string data;
+  appendFixed(data, this->index.size(), 8);
+  for (const auto &entry : this->index)
+  {
+    appendFixed(data, toNs(entry.time), 8);
+    appendFixed(data, entry.offset, 8);
+  }
+  appendFixed(data, indexOffset, 8);
+  appendFixed(data, kIndexMagic, 4);
+
+  this->file.write(data.data(), data.size());
+  this->file.close();
+  this->index.clear();
+  this->references.clear();
+}
+
+//////////////////////////////////////////////////
+bool SensorLogReader::Open(const std::string &_path)
+{
+  this->streams.clear();
+  this->index.clear();
+  this->references.clear();
+  this->file.close();
+  this->file.clear();
+
+  this->file.open(_path, std::ios::binary);
+  if (!this->file)
+    return false;
+
+  char header[sizeof(kFileMagic) + 8];
+  if (!this->file.read(header, sizeof(header)) ||
+      std::memcmp(header, kFileMagic, sizeof(kFileMagic)) != 0)
+  {
+    ignerr << "[" << _path << "] isn't a sensor log." << std::endl;
+    return false;
+  }
+
+  auto version = readFixed(header + sizeof(kFileMagic), 4);
+  if (version != kVersion)
+  {
+    ignerr << "Sensor log [" << _path << "] has unsupported version ["
+           << version << "]." << std::endl;
+    return false;
+  }
+
+  auto streamCount = readFixed(header + sizeof(kFileMagic) + 4, 4);
+  for (uint64_t i = 0; i < streamCount; ++i)
+  {
+    char info[12];
+    if (!this->file.read(info, sizeof(info)))
+      break;
+    SensorLogStream stream;
+    stream.type = static_cast<SensorLogStreamType>(readFixed(info, 4));
+    stream.codec = static_cast<SensorLogCodec>(readFixed(info + 4, 4));
+    auto topicSize = readFixed(info + 8, 4);
+    stream.topic.resize(topicSize);
+    if (!this->file.read(&stream.topic[0], topicSize))
+      break;
+    this->streams.push_back(std::move(stream));
+  }
+  if (this->streams.size() != streamCount)
+  {
+    ignerr << "Sensor log [" << _path << "] is truncated." << std::endl;
+    return false;
+  }
+  this->start = static_cast<uint64_t>(this->file.tellg());
+
+  // Load the index from the end of the file
+  bool indexed{false};
+  this->file.seekg(0, std::ios::end);
+  auto size = static_cast<uint64_t>(this->file.tellg());
+  char trailer[kTrailerSize];
+  if (size >= this->start + kTrailerSize + 8 &&
+      this->file.seekg(size - kTrailerSize) &&
+      this->file.read(trailer, kTrailerSize) &&
+      readFixed(trailer + 8, 4) == kIndexMagic)
+  {
+    auto indexOffset = readFixed(trailer, 8);
+    char count[8];
+    if (indexOffset >= this->start && indexOffset < size &&
+        this->file.seekg(indexOffset) && this->file.read(count, 8))
+    {
+      auto entries = readFixed(count, 8);
+      if (indexOffset + 8 + entries * kIndexEntrySize + kTrailerSize == size)
+      {
+        std::string data(entries * kIndexEntrySize, '\0');
+        if (entries == 0 || this->file.read(&data[0], data.size()))
+        {
+          for (uint64_t i = 0; i < entries; ++i)
+          {
+            const char *entry = data.data() + i * kIndexEntrySize;
+            this->index.push_back(
+                {fromNs(readFixed(entry, 8)), readFixed(entry + 8, 8)});
+          }
+          this->end = indexOffset;
+          indexed = true;
+        }
+      }
+    }
+  }
+
+  if (!indexed)
+  {
+    ignwarn << "Sensor log [" << _path << "] doesn't have an index, it may "
+            << "not have been closed. Scanning its records." << std::endl;
+    this->ScanRecords();
+  }
+
+  this->file.clear();
+  this->offset = this->start;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void SensorLogReader::ScanRecords()
+{
+  IGN_PROFILE("SensorLogReader::ScanRecords");
+
+  this->index.clear();
+  this->file.clear();
+  this->file.seekg(0, std::ios::end);
+  auto size = static_cast<uint64_t>(this->file.tellg());
+
+  uint64_t pos{this->start};
+  char header[kRecordHeaderSize];
+  while (pos + kRecordHeaderSize <= size &&
+      this->file.seekg(pos) &&
+      this->file.read(header, kRecordHeaderSize) &&
+      readFixed(header, 4) == kRecordMagic)
+  {
+    auto stored = readFixed(header + 28, 8);
+
+    // Truncated record
+    if (pos + kRecordHeaderSize + stored > size)
+      break;
+
+    if (readFixed(header + 4, 4) == kMarkStream)
+      this->index.push_back({fromNs(readFixed(header + 12, 8)), pos});
+
+    pos += kRecordHeaderSize + stored;
+  }
+  this->end = pos;
+}
+
+//////////////////////////////////////////////////
+const std::vector<SensorLogStream> &SensorLogReader::Streams() const
+{
+  return this->streams;
+}
+
+//////////////////////////////////////////////////
+const std::vector<SensorLogIndexEntry> &SensorLogReader::Index() const
+{
+  return this->index;
+}
+
+//////////////////////////////////////////////////
+void SensorLogReader::Seek(std::chrono::steady_clock::duration _time)
+{
+  this->references.clear();
+  this->offset = this->start;
+  for (const auto &entry : this->index)
+  {
+    if (entry.time > _time)
+      break;
+    this->offset = entry.offset;
+  }
+}
+
+//////////////////////////////////////////////////
+bool SensorLogReader::Next(SensorLogRecord &_record)
+{
+  IGN_PROFILE("SensorLogReader::Next");
+
+  char header[kRecordHeaderSize];
+  while (this->offset + kRecordHeaderSize <= this->end)
+  {
+    this->file.clear();
+    if (!this->file.seekg(this->offset) ||
+        !this->file.read(header, kRecordHeaderSize) ||
+        readFixed(header, 4) != kRecordMagic)
+    {
+      ignerr << "Failed to read sensor log record at [" << this->offset
+             << "]." << std::endl;
+      return false;
+    }
+
+    auto stream = static_cast<uint32_t>(readFixed(header + 4, 4));
+    auto storage = readFixed(header + 8, 4);
+    auto time = fromNs(readFixed(header + 12, 8));
+    auto rawSize = readFixed(header + 20, 8);
+    auto stored = readFixed(header + 28, 8);
+    if (this->offset + kRecordHeaderSize + stored > this->end)
+      return false;
+    this->offset += kRecordHeaderSize + stored;
+
+    if (stream == kMarkStream)
+    {
+      this->references.clear();
+      continue;
+    }
+    if (stream >= this->streams.size())
+    {
+      ignerr << "Sensor log record has unknown stream [" << stream << "]."
+             << std::endl;
+      return false;
+    }
+
+    this->payload.resize(stored);
+    if (stored > 0 && !this->file.read(&this->payload[0], stored))
+      return false;
+
+    const std::string *data = &this->payload;
+    if (storage == kStoredZlib)
+    {
+      if (!Decompress(this->payload, rawSize, this->raw))
+      {
+        ignerr << "Failed to decompress sensor log record." << std::endl;
+        return false;
+      }
+      data = &this->raw;
+    }
+
+    const auto &info = this->streams[stream];
+    std::size_t bulk{0};
+    if (info.type == SensorLogStreamType::IMAGE)
+    {
+      msgs::Image msg;
+      if (!decodePayload(*data, msg, bulk))
+        return false;
+
+      std::string pixels = data->substr(bulk);
+      if (info.codec == SensorLogCodec::ZLIB)
+      {
+        auto step = rowStep(msg, pixels.size());
+        for (std::size_t i = step; step > 0 && i < pixels.size(); ++i)
+        {
+          pixels[i] = static_cast<char>(
+              static_cast<unsigned char>(pixels[i]) +
+              static_cast<unsigned char>(pixels[i - step]));
+        }
+      }
+      msg.set_data(std::move(pixels));
+      _record.data = msg.SerializeAsString();
+    }
+    else
+    {
+      msgs::LaserScan msg;
+      if (!decodePayload(*data, msg, bulk) || data->size() < bulk + 17)
+        return false;
+
+      char mode = (*data)[bulk];
+      std::string values = data->substr(bulk + 1);
+      auto ranges = readFixed(values.data(), 8);
+      auto intensities = readFixed(values.data() + 8, 8);
+      if (values.size() != 16 + 8 * (ranges + intensities))
+        return false;
+
+      if (info.codec != SensorLogCodec::RAW)
+      {
+        auto ref = this->references.find(stream);
+        if (mode == kScanFromReference)
+        {
+          if (ref == this->references.end() ||
+              ref->second.size() != values.size())
+          {
+            ignerr << "Sensor log scan on [" << info.topic << "] is missing "
+                   << "the scan it was encoded against." << std::endl;
+            return false;
+          }
+          for (std::size_t i = 16; i < values.size(); ++i)
+            values[i] = static_cast<char>(values[i] ^ ref->second[i]);
+        }
+        else
+        {
+          for (std::size_t i = 24; i < values.size(); ++i)
+            values[i] = static_cast<char>(values[i] ^ values[i - 8]);
+        }
+        if (info.codec == SensorLogCodec::DELTA)
+          this->references[stream] = values;
+      }
+
+      readValues(values.data() + 16, ranges, *msg.mutable_ranges());
+      readValues(values.data() + 16 + 8 * ranges, intensities,
+          *msg.mutable_intensities());
+      _record.data = msg.SerializeAsString();
+    }
+
+    _record.stream = stream;
+    _record.time = time;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_LOG_SENSORLOG_HH_
+#define IGNITION_GAZEBO_SYSTEMS_LOG_SENSORLOG_HH_
+
+#include <ignition/msgs/image.pb.h>
+#include <ignition/msgs/laserscan.pb.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/log-system/Export.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \brief Kind of messages in a sensor log stream.
+  enum class SensorLogStreamType : uint32_t
+  {
+    /// \brief msgs::Image, such as camera and depth camera outputs.
+    IMAGE = 0,
+
+    /// \brief msgs::LaserScan, such as lidar outputs.
+    LASER_SCAN = 1
+  };
+
+  /// \brief How sensor messages are stored.
+  enum class SensorLogCodec : uint32_t
+  {
+    /// \brief Messages are stored as they are.
+    RAW = 0,
+
+    /// \brief Bulk data is filtered and compressed with zlib. Image rows
+    /// are stored as the difference with the row above, like PNG's up
+    /// filter, scan ranges as the difference with the previous ray.
+    ZLIB = 1,
+
+    /// \brief Only for scans. Ranges and intensities are stored as the
+    /// difference with the same ray of the previous scan of the stream, then
+    /// compressed with zlib. Scans of static scenes become mostly zeros.
+    DELTA = 2
+  };
+
+  /// \brief A stream of sensor messages recorded from one topic.
+  struct SensorLogStream
+  {
+    /// \brief Topic the messages were published on.
+    std::string topic;
+
+    /// \brief Kind of messages.
+    SensorLogStreamType type{SensorLogStreamType::IMAGE};
+
+    /// \brief How the messages are stored.
+    SensorLogCodec codec{SensorLogCodec::RAW};
+  };
+
+  /// \brief A sensor message read back from a sensor log.
+  struct SensorLogRecord
+  {
+    /// \brief Index of the stream, see SensorLogReader::Streams.
+    uint32_t stream{0};
+
+    /// \brief Sim time of the message, from its header.
+    std::chrono::steady_clock::duration time{0};
+
+    /// \brief The message, serialized. Parse it according to the stream's
+    /// type.
+    std::string data;
+  };
+
+  /// \brief Location of the records following a state keyframe.
+  struct SensorLogIndexEntry
+  {
+    /// \brief Sim time of the keyframe.
+    std::chrono::steady_clock::duration time{0};
+
+    /// \brief Offset of the first record written after the keyframe.
+    uint64_t offset{0};
+  };
+
+  /// \brief Counters of a SensorLogWriter.
+  struct SensorLogWriterStats
+  {
+    /// \brief Bytes of messages waiting for the writer thread.
+    std::size_t queuedBytes{0};
+
+    /// \brief Messages dropped because the queue was full.
+    uint64_t droppedRecords{0};
+
+    /// \brief Messages taken by the writer thread.
+    uint64_t writtenRecords{0};
+  };
+
+  /// \brief Writes sensor messages into a seekable log file, usually named
+  /// `sensors.slog`, next to the state log.
+  ///
+  /// Records are written in the order they're queued. Keyframe marks split
+  /// the file into sections which decode on their own, and the file ends
+  /// with an index of the marks, so readers seek to the sensor data of a
+  /// state keyframe.
+  ///
+  /// Write only copies the message into a queue. A writer thread encodes,
+  /// compresses and writes it, so sensors only pay for the copy. If the
+  /// writer falls behind and the queue holds too many bytes, messages are
+  /// dropped instead of slowing down the publishers.
+  class IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE SensorLogWriter
+  {
+    /// \brief Destructor, which closes the file.
+    public: ~SensorLogWriter();
+
+    /// \brief Set how many bytes of messages may wait for the writer
+    /// thread before messages are dropped. Must be called before Open.
+    /// \param[in] _bytes Size, defaults to 256 MiB.
+    public: void SetMaxQueuedBytes(std::size_t _bytes);
+
+    /// \brief Add a stream. Must be called before Open.
+    /// \param[in] _stream Stream to add. DELTA falls back to ZLIB for
+    /// images, and compressed codecs fall back to RAW if compression isn't
+    /// available.
+    /// \return Index of the stream, to pass to Write.
+    public: uint32_t AddStream(SensorLogStream _stream);
+
+    /// \brief Create a log file, replacing any existing file.
+    /// \param[in] _path Path of the file.
+    /// \return True if the file was created.
+    public: bool Open(const std::string &_path);
+
+    /// \brief Queue an image. Thread safe.
+    /// \param[in] _stream Index of an image stream.
+    /// \param[in] _msg Image, stamped with sim time.
+    /// \return True if the image was queued, false if it was dropped.
+    public: bool Write(uint32_t _stream, const msgs::Image &_msg);
+
+    /// \brief Queue a scan. Thread safe.
+    /// \param[in] _stream Index of a scan stream.
+    /// \param[in] _msg Scan, stamped with sim time.
+    /// \return True if the scan was queued, false if it was dropped.
+    public: bool Write(uint32_t _stream, const msgs::LaserScan &_msg);
+
+    /// \brief Mark a state keyframe. Messages queued afterwards don't
+    /// depend on earlier ones and are indexed under the keyframe's time.
+    /// Thread safe.
+    /// \param[in] _time Sim time of the keyframe.
+    public: void MarkKeyframe(std::chrono::steady_clock::duration _time);
+
+    /// \brief Get the writer's counters.
+    /// \return Counters since Open.
+    public: SensorLogWriterStats Stats() const;
+
+    /// \brief Write the queued messages and the index, and close the file.
+    /// Has no effect if the file isn't open.
+    public: void Close();
+
+    /// \brief A message or a keyframe mark waiting for the writer thread.
+    private: struct QueuedRecord
+    {
+      /// \brief Index of the stream, unused by marks.
+      uint32_t stream{0};
+
+      /// \brief Sim time.
+      std::chrono::steady_clock::duration time{0};
+
+      /// \brief Image, nullptr if not an image.
+      std::unique_ptr<msgs::Image> image;
+
+      /// \brief Scan, nullptr if not a scan.
+      std::unique_ptr<msgs::LaserScan> scan;
+
+      /// \brief Size of the message, counted against the queue size.
+      std::size_t bytes{0};
+    };
+
+    /// \brief Queue a record, dropping it if the queue is full.
+    /// \param[in] _record Record.
+    /// \return True if the record was queued.
+    private: bool Push(QueuedRecord &&_record);
+
+    /// \brief Write queued records until Close.
+    private: void RunWriter();
+
+    /// \brief Encode, compress and write a record.
+    /// \param[in] _record Record holding a message, whose bulk data is
+    /// moved out.
+    private: void WriteRecord(QueuedRecord &_record);
+
+    /// \brief The file.
+    private: std::ofstream file;
+
+    /// \brief Path of the file.
+    private: std::string path;
+
+    /// \brief Streams, in the order they were added.
+    private: std::vector<SensorLogStream> streams;
+
+    /// \brief Largest number of queued bytes.
+    private: std::size_t maxQueuedBytes{256u << 20};
+
+    /// \brief Keyframe marks written so far, only used by the writer thread
+    /// until it's stopped.
+    private: std::vector<SensorLogIndexEntry> index;
+
+    /// \brief Last ranges and intensities of each DELTA stream, only used by
+    /// the writer thread. Cleared at keyframe marks.
+    private: std::unordered_map<uint32_t, std::string> references;
+
+    /// \brief Records waiting for the writer thread.
+    private: std::deque<QueuedRecord> queue;
+
+    /// \brief Counters, protected by queueMutex.
+    private: SensorLogWriterStats stats;
+
+    /// \brief Protects queue, stats and stopWriter.
+    private: mutable std::mutex queueMutex;
+
+    /// \brief Notified when records are queued.
+    private: std::condition_variable queueCv;
+
+    /// \brief True to stop the writer thread once the queue is empty.
+    private: bool stopWriter{false};
+
+    /// \brief Thread writing records.
+    private: std::thread writerThread;
+
+    /// \brief Encoded record, reused between records by the writer thread.
+    private: std::string raw;
+
+    /// \brief Compressed record, reused between records by the writer
+    /// thread.
+    private: std::string compressed;
+  };
+
+  /// \brief Reads log files written by SensorLogWriter.
+  ///
+  /// Files which weren't closed don't have an index, which is then rebuilt
+  /// by scanning the records.
+  class IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE SensorLogReader
+  {
+    /// \brief Open a log file, load its streams and index, and go to the
+    /// first record.
+    /// \param[in] _path Path of the file.
+    /// \return True if the file is a sensor log.
+    public: bool Open(const std::string &_path);
+
+    /// \brief Get the streams of the log.
+    /// \return Streams, indexed by SensorLogRecord::stream.
+    public: const std::vector<SensorLogStream> &Streams() const;
+
+    /// \brief Get the keyframe marks of the log.
+    /// \return Index entries, sorted by offset.
+    public: const std::vector<SensorLogIndexEntry> &Index() const;
+
+    /// \brief Go to the records of the last keyframe mark at or before a
+    /// time. Records just after the mark may be a little older than it, as
+    /// messages are recorded in the order they were received.
+    /// \param[in] _time Sim time.
+    public: void Seek(std::chrono::steady_clock::duration _time);
+
+    /// \brief Read the next record.
+    /// \param[out] _record Record.
+    /// \return False at the end of the log, or if the record couldn't be
+    /// decoded.
+    public: bool Next(SensorLogRecord &_record);
+
+    /// \brief Rebuild the index by reading all record headers.
+    private: void ScanRecords();
+
+    /// \brief The file.
+    private: std::ifstream file;
+
+    /// \brief Offset right after the last record.
+    private: uint64_t end{0};
+
+    /// \brief Offset of the next record.
+    private: uint64_t offset{0};
+
+    /// \brief Offset of the first record.
+    private: uint64_t start{0};
+
+    /// \brief Streams of the log.
+    private: std::vector<SensorLogStream> streams;
+
+    /// \brief Keyframe marks.
+    private: std::vector<SensorLogIndexEntry> index;
+
+    /// \brief Last ranges and intensities of each DELTA stream.
+    private: std::unordered_map<uint32_t, std::string> references;
+
+    /// \brief Stored payload, reused between records.
+    private: std::string payload;
+
+    /// \brief Decoded payload, reused between records.
+    private: std::string raw;
+  };
+}
+}
+}
+}
+#endif
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "SensorLog.hh"
+#include "../../network/Compression.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+using namespace std::chrono_literals;
+
+/////////////////////////////////////////////////
+/// \brief Stamp a header with a time.
+/// \param[in] _time Sim time.
+/// \param[out] _header Header.
+void setStamp(std::chrono::steady_clock::duration _time,
+    msgs::Header &_header)
+{
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      _time).count();
+  _header.mutable_stamp()->set_sec(ns / 1000000000);
+  _header.mutable_stamp()->set_nsec(ns % 1000000000);
+}
+
+/////////////////////////////////////////////////
+/// \brief Get an 8 bit gradient image.
+/// \param[in] _frame Frame number the pixels are offset by.
+/// \return Image.
+msgs::Image makeImage(int _frame)
+{
+  msgs::Image msg;
+  setStamp(_frame * 100ms, *msg.mutable_header());
+  msg.set_width(32);
+  msg.set_height(16);
+  msg.set_step(32 * 3);
+  msg.set_pixel_format_type(msgs::PixelFormatType::RGB_INT8);
+  std::string data(msg.step() * msg.height(), '\0');
+  for (std::size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<char>(i / msg.step() + i % 3 + _frame);
+  msg.set_data(data);
+  return msg;
+}
+
+/////////////////////////////////////////////////
+/// \brief Get a scan of a static scene with one moving ray.
+/// \param[in] _frame Frame number.
+/// \return Scan.
+msgs::LaserScan makeScan(int _frame)
+{
+  msgs::LaserScan msg;
+  setStamp(_frame * 100ms, *msg.mutable_header());
+  msg.set_frame("lidar");
+  msg.set_count(180);
+  for (int i = 0; i < 180; ++i)
+  {
+    msg.add_ranges(i == 90 ? 1.0 + 0.01 * _frame : 5.0 + 0.001 * i);
+    msg.add_intensities(i % 2);
+  }
+  return msg;
+}
+
+/////////////////////////////////////////////////
+/// \brief Write a log with an image and a scan every 100 ms, and a
+/// keyframe mark every second.
+/// \param[in] _path Log path.
+/// \param[in] _imageCodec Image codec.
+/// \param[in] _scanCodec Scan codec.
+void writeLog(const std::string &_path, SensorLogCodec _imageCodec,
+    SensorLogCodec _scanCodec)
+{
+  SensorLogWriter writer;
+  EXPECT_EQ(0u, writer.AddStream(
+      {"/camera", SensorLogStreamType::IMAGE, _imageCodec}));
+  EXPECT_EQ(1u, writer.AddStream(
+      {"/lidar", SensorLogStreamType::LASER_SCAN, _scanCodec}));
+  ASSERT_TRUE(writer.Open(_path));
+
+  // Wrong message types aren't recorded
+  EXPECT_FALSE(writer.Write(1, makeImage(0)));
+  EXPECT_FALSE(writer.Write(0, makeScan(0)));
+  EXPECT_FALSE(writer.Write(2, makeScan(0)));
+
+  for (int i = 0; i <= 30; ++i)
+  {
+    if (i % 10 == 0)
+      writer.MarkKeyframe(i * 100ms);
+    EXPECT_TRUE(writer.Write(0, makeImage(i)));
+    EXPECT_TRUE(writer.Write(1, makeScan(i)));
+  }
+  writer.Close();
+
+  auto stats = writer.Stats();
+  EXPECT_EQ(62u, stats.writtenRecords);
+  EXPECT_EQ(0u, stats.droppedRecords);
+  EXPECT_EQ(0u, stats.queuedBytes);
+}
+
+/////////////////////////////////////////////////
+/// \brief Check the records of the log written by writeLog, starting from
+/// a frame.
+/// \param[in] _reader Reader.
+/// \param[in] _first First frame.
+void checkRecords(SensorLogReader &_reader, int _first)
+{
+  SensorLogRecord record;
+  for (int i = _first; i <= 30; ++i)
+  {
+    ASSERT_TRUE(_reader.Next(record)) << i;
+    EXPECT_EQ(0u, record.stream);
+    EXPECT_EQ(i * 100ms, record.time);
+    msgs::Image image;
+    ASSERT_TRUE(image.ParseFromString(record.data));
+    EXPECT_EQ(makeImage(i).SerializeAsString(), image.SerializeAsString());
+
+    ASSERT_TRUE(_reader.Next(record)) << i;
+    EXPECT_EQ(1u, record.stream);
+    EXPECT_EQ(i * 100ms, record.time);
+    msgs::LaserScan scan;
+    ASSERT_TRUE(scan.ParseFromString(record.data));
+    EXPECT_EQ(makeScan(i).SerializeAsString(), scan.SerializeAsString());
+  }
+  EXPECT_FALSE(_reader.Next(record));
+}
+
+/////////////////////////////////////////////////
+/// \brief Check the log written by writeLog.
+/// \param[in] _path Log path.
+void checkLog(const std::string &_path)
+{
+  SensorLogReader reader;
+  ASSERT_TRUE(reader.Open(_path));
+  ASSERT_EQ(2u, reader.Streams().size());
+  EXPECT_EQ("/camera", reader.Streams()[0].topic);
+  EXPECT_EQ(SensorLogStreamType::IMAGE, reader.Streams()[0].type);
+  EXPECT_EQ("/lidar", reader.Streams()[1].topic);
+  EXPECT_EQ(SensorLogStreamType::LASER_SCAN, reader.Streams()[1].type);
+
+  ASSERT_EQ(4u, reader.Index().size());
+  EXPECT_EQ(2s, reader.Index()[2].time);
+
+  checkRecords(reader, 0);
+
+  // Scans delta encoded against earlier scans decode after seeking
+  reader.Seek(2500ms);
+  checkRecords(reader, 20);
+  reader.Seek(0s);
+  checkRecords(reader, 0);
+}
+
+/////////////////////////////////////////////////
+TEST(SensorLog, WriteRead)
+{
+  for (auto codec : {SensorLogCodec::RAW, SensorLogCodec::ZLIB,
+      SensorLogCodec::DELTA})
+  {
+    const std::string path{"sensor_log_test.slog"};
+    writeLog(path, codec, codec);
+    checkLog(path);
+    std::remove(path.c_str());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(SensorLog, Compression)
+{
+  const std::string rawPath{"sensor_log_test_raw.slog"};
+  const std::string deltaPath{"sensor_log_test_delta.slog"};
+  writeLog(rawPath, SensorLogCodec::RAW, SensorLogCodec::RAW);
+  writeLog(deltaPath, SensorLogCodec::ZLIB, SensorLogCodec::DELTA);
+
+  std::ifstream raw(rawPath, std::ios::binary | std::ios::ate);
+  std::ifstream delta(deltaPath, std::ios::binary | std::ios::ate);
+  if (CompressionAvailable())
+  {
+    EXPECT_LT(delta.tellg() * 4, raw.tellg());
+  }
+
+  std::remove(rawPath.c_str());
+  std::remove(deltaPath.c_str());
+}
+
+/////////////////////////////////////////////////
+TEST(SensorLog, MissingIndex)
+{
+  const std::string path{"sensor_log_test_no_index.slog"};
+  writeLog(path, SensorLogCodec::ZLIB, SensorLogCodec::DELTA);
+
+  // Cut off the index, like a recording which crashed
+  std::string data;
+  {
+    std::ifstream in(path, std::ios::binary);
+    data.assign(std::istreambuf_iterator<char>(in),
+        std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), data.size() - 12 - 8 - 4 * 16);
+  }
+
+  checkLog(path);
+  std::remove(path.c_str());
+}
+
+/////////////////////////////////////////////////
+TEST(SensorLog, Invalid)
+{
+  SensorLogReader reader;
+  EXPECT_FALSE(reader.Open("sensor_log_test_missing.slog"));
+
+  const std::string path{"sensor_log_test_invalid.slog"};
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "not a sensor log";
+  }
+  EXPECT_FALSE(reader.Open(path));
+  std::remove(path.c_str());
+
+  // Writers which aren't open drop everything
+  SensorLogWriter writer;
+  auto stream = writer.AddStream(
+      {"/camera", SensorLogStreamType::IMAGE, SensorLogCodec::RAW});
+  EXPECT_FALSE(writer.Write(stream, makeImage(0)));
+}
+
+/////////////////////////////////////////////////
+TEST(SensorLog, QueueFull)
+{
+  const std::string path{"sensor_log_test_full.slog"};
+  SensorLogWriter writer;
+  writer.SetMaxQueuedBytes(0);
+  auto stream = writer.AddStream(
+      {"/camera", SensorLogStreamType::IMAGE, SensorLogCodec::RAW});
+  ASSERT_TRUE(writer.Open(path));
+  EXPECT_FALSE(writer.Write(stream, makeImage(0)));
+  writer.MarkKeyframe(0s);
+  writer.Close();
+
+  EXPECT_EQ(1u, writer.Stats().droppedRecords);
+  EXPECT_EQ(0u, writer.Stats().writtenRecords);
+
+  SensorLogReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  EXPECT_EQ(1u, reader.Index().size());
+  SensorLogRecord record;
+  EXPECT_FALSE(reader.Next(record));
+  std::remove(path.c_str());
+}
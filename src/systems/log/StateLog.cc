@@ -0,0 +1,889 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "StateLog.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+
+#include "../../network/Compression.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+namespace
+{
+  /// \brief Start of every state log.
+  constexpr char kFileMagic[8] = {'I', 'G', 'N', 'S', 'T', 'L', 'O', 'G'};
+
+  /// \brief Format version, increased on incompatible changes.
+  constexpr uint32_t kVersion{1};
+
+  /// \brief Size of the file header.
+  constexpr std::size_t kFileHeaderSize{sizeof(kFileMagic) + 4};
+
+  /// \brief Start of every chunk.
+  constexpr uint32_t kChunkMagic{0x4b4e4843};
+
+  /// \brief Magic number after the index.
+  constexpr uint32_t kIndexMagic{0x58495a47};
+
+  /// \brief Size of a chunk header: magic, compression, start and end
+  /// times, raw and stored sizes.
+  constexpr std::size_t kChunkHeaderSize{4 + 4 + 8 + 8 + 8 + 8};
+
+  /// \brief Size of the trailer: index offset and magic.
+  constexpr std::size_t kTrailerSize{8 + 4};
+
+  /// \brief Size of each index entry: start and end times, offset.
+  constexpr std::size_t kIndexEntrySize{8 + 8 + 8};
+
+  //////////////////////////////////////////////////
+  /// \brief Append a little endian integer.
+  /// \param[in] _out Buffer.
+  /// \param[in] _value Value.
+  /// \param[in] _bytes Number of bytes to write.
+  void appendFixed(std::string &_out, uint64_t _value, std::size_t _bytes)
+  {
+    for (std::size_t i = 0; i < _bytes; ++i)
+      _out.push_back(static_cast<char>((_value >> (8 * i)) & 0xff));
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Read a little endian integer.
+  /// \param[in] _data Data, at least _bytes long.
+  /// \param[in] _bytes Number of bytes to read.
+  /// \return Value.
+  uint64_t readFixed(const char *_data, std::size_t _bytes)
+  {
+    uint64_t value{0};
+    for (std::size_t i = 0; i < _bytes; ++i)
+    {
+      value |= static_cast<uint64_t>(static_cast<unsigned char>(_data[i]))
+          << (8 * i);
+    }
+    return value;
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Append a variable length integer, using 7 bits per byte.
+  /// \param[in] _out Buffer.
+  /// \param[in] _value Value.
+  void appendVarint(std::string &_out, uint64_t _value)
+  {
+    while (_value >= 0x80)
+    {
+      _out.push_back(static_cast<char>((_value & 0x7f) | 0x80));
+      _value >>= 7;
+    }
+    _out.push_back(static_cast<char>(_value));
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Append a signed variable length integer, so that small
+  /// negative values are short too.
+  /// \param[in] _out Buffer.
+  /// \param[in] _value Value.
+  void appendSignedVarint(std::string &_out, int64_t _value)
+  {
+    appendVarint(_out, (static_cast<uint64_t>(_value) << 1) ^
+        static_cast<uint64_t>(_value >> 63));
+  }
+
+  /// \brief Reads a chunk payload, stopping at the first error.
+  class Decoder
+  {
+    /// \brief Constructor
+    /// \param[in] _data Payload.
+    public: explicit Decoder(const std::string &_data)
+      : pos(_data.data()), end(_data.data() + _data.size())
+    {
+    }
+
+    /// \brief Read a variable length integer.
+    /// \return Value, 0 on errors.
+    public: uint64_t Varint()
+    {
+      uint64_t value{0};
+      for (int shift = 0; shift < 64; shift += 7)
+      {
+        if (this->pos >= this->end)
+          break;
+        auto byte = static_cast<unsigned char>(*this->pos++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+          return value;
+      }
+      this->ok = false;
+      return 0;
+    }
+
+    /// \brief Read a signed variable length integer.
+    /// \return Value, 0 on errors.
+    public: int64_t SignedVarint()
+    {
+      auto value = this->Varint();
+      return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+    }
+
+    /// \brief Read one byte.
+    /// \return Value, 0 on errors.
+    public: uint8_t Byte()
+    {
+      if (this->pos >= this->end)
+      {
+        this->ok = false;
+        return 0;
+      }
+      return static_cast<uint8_t>(*this->pos++);
+    }
+
+    /// \brief Read bytes.
+    /// \param[in] _size Number of bytes.
+    /// \param[out] _out The bytes.
+    public: void Bytes(std::size_t _size, std::string &_out)
+    {
+      if (static_cast<std::size_t>(this->end - this->pos) < _size)
+      {
+        this->ok = false;
+        return;
+      }
+      _out.assign(this->pos, _size);
+      this->pos += _size;
+    }
+
+    /// \brief Next byte to read.
+    private: const char *pos;
+
+    /// \brief End of the payload.
+    private: const char *end;
+
+    /// \brief False once an error happened.
+    public: bool ok{true};
+  };
+
+  /// \brief A component in a column.
+  struct ComponentRecord
+  {
+    /// \brief Frame of the component.
+    uint64_t frame;
+
+    /// \brief Entity of the component.
+    uint64_t entity;
+
+    /// \brief The component.
+    const msgs::SerializedComponent *component;
+  };
+
+  //////////////////////////////////////////////////
+  /// \brief Serialize frames into a chunk payload. Frame times are relative
+  /// to the first frame, entities are delta encoded and components are
+  /// grouped by type.
+  /// \param[in] _frames Frames.
+  /// \param[out] _out Payload.
+  void encodeFrames(const std::vector<StateLogFrame> &_frames,
+      std::string &_out)
+  {
+    _out.clear();
+    appendVarint(_out, _frames.size());
+
+    const auto start = _frames.front().time;
+    for (const auto &frame : _frames)
+    {
+      appendSignedVarint(_out,
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+          frame.time - start).count());
+      _out.push_back(frame.keyframe ? 1 : 0);
+    }
+
+    // Entity column, sorted so ids are close together
+    std::map<uint64_t, std::vector<ComponentRecord>> columns;
+    std::vector<std::pair<uint64_t, const msgs::SerializedEntityMap *>>
+        entities;
+    for (std::size_t f = 0; f < _frames.size(); ++f)
+    {
+      entities.clear();
+      for (const auto &[id, entity] : _frames[f].state.entities())
+        entities.emplace_back(id, &entity);
+      std::sort(entities.begin(), entities.end(),
+          [](const auto &_a, const auto &_b) {return _a.first < _b.first;});
+
+      appendVarint(_out, entities.size());
+      uint64_t previous{0};
+      for (const auto &[id, entity] : entities)
+      {
+        appendSignedVarint(_out, static_cast<int64_t>(id - previous));
+        _out.push_back(entity->remove() ? 1 : 0);
+        previous = id;
+
+        for (const auto &[type, component] : entity->components())
+          columns[type].push_back({f, id, &component});
+      }
+    }
+
+    // Component columns
+    appendVarint(_out, columns.size());
+    for (const auto &[type, records] : columns)
+    {
+      appendVarint(_out, type);
+      appendVarint(_out, records.size());
+      uint64_t previous{0};
+      for (const auto &record : records)
+      {
+        appendVarint(_out, record.frame);
+        appendSignedVarint(_out,
+            static_cast<int64_t>(record.entity - previous));
+        _out.push_back(record.component->remove() ? 1 : 0);
+        appendVarint(_out, record.component->component().size());
+        _out.append(record.component->component());
+        previous = record.entity;
+      }
+    }
+  }
+
+  //////////////////////////////////////////////////
+  /// \brief Deserialize a chunk payload.
+  /// \param[in] _data Payload.
+  /// \param[in] _start Time of the first frame.
+  /// \param[out] _frames Frames.
+  /// \return True if the payload was valid.
+  bool decodeFrames(const std::string &_data,
+      std::chrono::steady_clock::duration _start,
+      std::vector<StateLogFrame> &_frames)
+  {
+    Decoder decoder(_data);
+    auto frameCount = decoder.Varint();
+    if (!decoder.ok || frameCount > _data.size())
+      return false;
+
+    _frames.clear();
+    _frames.resize(frameCount);
+    for (auto &frame : _frames)
+    {
+      frame.time = _start + std::chrono::duration_cast<
+          std::chrono::steady_clock::duration>(
+          std::chrono::nanoseconds(decoder.SignedVarint()));
+      frame.keyframe = decoder.Byte() != 0;
+    }
+
+    for (auto &frame : _frames)
+    {
+      auto entityCount = decoder.Varint();
+      uint64_t id{0};
+      for (uint64_t e = 0; e < entityCount && decoder.ok; ++e)
+      {
+        id += static_cast<uint64_t>(decoder.SignedVarint());
+        auto &entity = (*frame.state.mutable_entities())[id];
+        entity.set_id(id);
+        entity.set_remove(decoder.Byte() != 0);
+      }
+    }
+
+    auto typeCount = decoder.Varint();
+    for (uint64_t t = 0; t < typeCount && decoder.ok; ++t)
+    {
+      auto type = decoder.Varint();
+      auto recordCount = decoder.Varint();
+      uint64_t entity{0};
+      for (uint64_t r = 0; r < recordCount && decoder.ok; ++r)
+      {
+        auto frame = decoder.Varint();
+        entity += static_cast<uint64_t>(decoder.SignedVarint());
+        bool remove = decoder.Byte() != 0;
+        auto size = decoder.Varint();
+        if (frame >= _frames.size())
+          return false;
+
+        auto &entityMsg =
+            (*_frames[frame].state.mutable_entities())[entity];
+        entityMsg.set_id(entity);
+        auto &component = (*entityMsg.mutable_components())[type];
+        component.set_type(type);
+        component.set_remove(remove);
+        decoder.Bytes(size, *component.mutable_component());
+      }
+    }
+
+    return decoder.ok;
+  }
+}
+
+//////////////////////////////////////////////////
+void StateChangeFilter::Filter(msgs::SerializedStateMap &_state, bool _full)
+{
+  IGN_PROFILE("StateChangeFilter::Filter");
+
+  if (_full)
+    this->recorded.clear();
+
+  auto &entities = *_state.mutable_entities();
+  for (auto entityIt = entities.begin(); entityIt != entities.end();)
+  {
+    auto &entity = entityIt->second;
+    if (entity.remove())
+    {
+      this->recorded.erase(entityIt->first);
+      ++entityIt;
+      continue;
+    }
+
+    auto recordedIt = this->recorded.find(entityIt->first);
+    bool isNew = recordedIt == this->recorded.end();
+    if (isNew)
+      recordedIt = this->recorded.emplace(entityIt->first,
+          std::unordered_map<int64_t, std::string>()).first;
+    auto &components = recordedIt->second;
+
+    auto &msgComponents = *entity.mutable_components();
+    for (auto compIt = msgComponents.begin(); compIt != msgComponents.end();)
+    {
+      const auto &component = compIt->second;
+      if (component.remove())
+      {
+        components.erase(compIt->first);
+        ++compIt;
+        continue;
+      }
+
+      auto &data = components[compIt->first];
+      if (!_full && !isNew && data == component.component())
+      {
+        compIt = msgComponents.erase(compIt);
+        ++this->dropped;
+        continue;
+      }
+      data = component.component();
+      ++compIt;
+    }
+
+    // Entities are only needed to create them, or to carry components
+    if (!_full && !isNew && msgComponents.empty())
+      entityIt = entities.erase(entityIt);
+    else
+      ++entityIt;
+  }
+}
+
+//////////////////////////////////////////////////
+void StateChangeFilter::Reset()
+{
+  this->recorded.clear();
+}
+
+//////////////////////////////////////////////////
+uint64_t StateChangeFilter::Dropped() const
+{
+  return this->dropped;
+}
+
+//////////////////////////////////////////////////
+StateLogWriter::~StateLogWriter()
+{
+  this->Close();
+}
+
+//////////////////////////////////////////////////
+void StateLogWriter::SetBackPressure(StateLogBackPressure _policy,
+    std::size_t _maxQueuedFrames)
+{
+  this->backPressure = _policy;
+  this->maxQueuedFrames = std::max<std::size_t>(_maxQueuedFrames, 1);
+}
+
+//////////////////////////////////////////////////
+void StateLogWriter::SetSkipUnchanged(bool _skip)
+{
+  if (_skip)
+    this->changeFilter = std::make_unique<StateChangeFilter>();
+  else
+    this->changeFilter.reset();
+}
+
+//////////////////////////////////////////////////
+bool StateLogWriter::Open(const std::string &_path,
+    std::chrono::steady_clock::duration _keyframePeriod,
+    StateLogCompression _compression)
+{
+  this->Close();
+
+  this->file.open(_path, std::ios::binary | std::ios::trunc);
+  if (!this->file)
+  {
+    ignerr << "Failed to create state log [" << _path << "]." << std::endl;
+    return false;
+  }
+
+  this->path = _path;
+  this->keyframePeriod = _keyframePeriod;
+  this->compression = _compression;
+  if (this->compression == StateLogCompression::ZLIB &&
+      !CompressionAvailable())
+  {
+    ignwarn << "Compression isn't available, state log [" << _path
+            << "] won't be compressed." << std::endl;
+    this->compression = StateLogCompression::NONE;
+  }
+
+  std::string header(kFileMagic, sizeof(kFileMagic));
+  appendFixed(header, kVersion, 4);
+  this->file.write(header.data(), header.size());
+  if (!this->file)
+    return false;
+
+  this->started = false;
+  this->awaitingKeyframe = true;
+  this->forceKeyframe = false;
+  this->stats = StateLogWriterStats();
+  this->stopWriter = false;
+  this->writerThread = std::thread(&StateLogWriter::RunWriter, this);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool StateLogWriter::NeedsKeyframe(
+    std::chrono::steady_clock::duration _time) const
+{
+  return !this->started || this->forceKeyframe || _time < this->lastTime ||
+      _time - this->lastKeyframeTime >= this->keyframePeriod;
+}
+
+//////////////////////////////////////////////////
+bool StateLogWriter::Write(std::chrono::steady_clock::duration _time,
+    msgs::SerializedStateMap _state, bool _keyframe)
+{
+  if (!this->file.is_open())
+    return false;
+
+  IGN_PROFILE("StateLogWriter::Write");
+
+  // Deltas build on every previous frame, so once one is lost, the log
+  // can only continue from a keyframe
+  if (!_keyframe && this->awaitingKeyframe)
+  {
+    if (!this->started)
+    {
+      ignerr << "State logs must start with a keyframe, dropping state."
+             << std::endl;
+    }
+    std::lock_guard<std::mutex> lock(this->queueMutex);
+    ++this->stats.droppedFrames;
+    return false;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(this->queueMutex);
+    if (this->queue.size() >= this->maxQueuedFrames)
+    {
+      // Keyframes are only dropped by the drop policy, deltas by all but
+      // the blocking one
+      bool drop = this->backPressure == StateLogBackPressure::DROP ||
+          (!_keyframe &&
+          this->backPressure == StateLogBackPressure::KEYFRAMES_ONLY);
+      if (drop)
+      {
+        ++this->stats.droppedFrames;
+        this->awaitingKeyframe = true;
+        this->forceKeyframe =
+            this->backPressure == StateLogBackPressure::DROP;
+        return false;
+      }
+
+      IGN_PROFILE("StateLogWriter::Write Wait");
+      this->queueCv.wait(lock, [this]
+          {
+            return this->queue.size() < this->maxQueuedFrames;
+          });
+    }
+
+    this->queue.push_back({_time, _keyframe, std::move(_state)});
+    this->stats.queueDepth = this->queue.size();
+    this->stats.maxQueueDepth =
+        std::max(this->stats.maxQueueDepth, this->stats.queueDepth);
+    this->queueCv.notify_all();
+  }
+
+  if (_keyframe)
+  {
+    this->started = true;
+    this->awaitingKeyframe = false;
+    this->forceKeyframe = false;
+    this->lastKeyframeTime = _time;
+  }
+  this->lastTime = _time;
+  return true;
+}
+
+//////////////////////////////////////////////////
+StateLogWriterStats StateLogWriter::Stats() const
+{
+  std::lock_guard<std::mutex> lock(this->queueMutex);
+  return this->stats;
+}
+
+//////////////////////////////////////////////////
+void StateLogWriter::RunWriter()
+{
+  IGN_PROFILE_THREAD_NAME("StateLogWriter");
+
+  std::vector<StateLogFrame> chunk;
+  StateLogFrame frame;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(this->queueMutex);
+      this->queueCv.wait(lock, [this]
+          {
+            return !this->queue.empty() || this->stopWriter;
+          });
+      if (this->queue.empty())
+        break;
+
+      frame = std::move(this->queue.front());
+      this->queue.pop_front();
+      this->stats.queueDepth = this->queue.size();
+      ++this->stats.writtenFrames;
+      this->queueCv.notify_all();
+    }
+
+    if (nullptr != this->changeFilter)
+      this->changeFilter->Filter(frame.state, frame.keyframe);
+
+    // Keyframes start chunks, unchanged deltas aren't needed
+    if (frame.keyframe && !chunk.empty())
+    {
+      this->WriteChunk(chunk);
+      chunk.clear();
+    }
+    if (frame.keyframe || !frame.state.entities().empty())
+      chunk.push_back(std::move(frame));
+  }
+
+  if (!chunk.empty())
+    this->WriteChunk(chunk);
+}
+
+//////////////////////////////////////////////////
+void StateLogWriter::WriteChunk(const std::vector<StateLogFrame> &_frames)
+{
+  IGN_PROFILE("StateLogWriter::WriteChunk");
+
+  encodeFrames(_frames, this->raw);
+
+  const std::string *payload = &this->raw;
+  auto chunkCompression = this->compression;
+  if (chunkCompression == StateLogCompression::ZLIB)
+  {
+    if (Compress(this->raw, this->compressed))
+      payload = &this->compressed;
+    else
+      chunkCompression = StateLogCompression::NONE;
+  }
+
+  StateLogChunkInfo info;
+  info.startTime = _frames.front().time;
+  info.endTime = _frames.back().time;
+  info.offset = static_cast<uint64_t>(this->file.tellp());
+
+  std::string header;
+  appendFixed(header, kChunkMagic, 4);
+  appendFixed(header, static_cast<uint32_t>(chunkCompression), 4);
+  appendFixed(header, static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+      info.startTime).count()), 8);
+  appendFixed(header, static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+      info.endTime).count()), 8);
+  appendFixed(header, this->raw.size(), 8);
+  appendFixed(header, payload->size(), 8);
+
+  this->file.write(header.data(), header.size());
+  this->file.write(payload->data(), payload->size());
+
+  // Flush so that recordings which crash keep all finished chunks
+  this->file.flush();
+  if (!this->file)
+  {
+    ignerr << "Failed to write to state log [" << this->path << "]."
+           << std::endl;
+  }
+
+  this->index.push_back(info);
+}
+
+//////////////////////////////////////////////////
+void StateLogWriter::Close()
+{
+  if (!this->file.is_open())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(this->queueMutex);
+    this->stopWriter = true;
+    this->queueCv.notify_all();
+  }
+  if (this->writerThread.joinable())
+    this->writerThread.join();
+
+  auto indexOffset = static_cast<uint64_t>(this->file.tellp());
+  std::string data;
+  appendFixed(data, this->index.size(), 8);
+  for (const auto &info : this->index)
+  {
+    appendFixed(data, static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+        info.startTime).count()), 8);
+    appendFixed(data, static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+        info.endTime).count()), 8);
+    appendFixed(data, info.offset, 8);
+  }
+  appendFixed(data, indexOffset, 8);
+  appendFixed(data, kIndexMagic, 4);
+
+  this->file.write(data.data(), data.size());
+  this->file.close();
+  this->index.clear();
+}
+
+//////////////////////////////////////////////////
+bool StateLogReader::Open(const std::string &_path)
+{
+  this->index.clear();
+  this->cachedFrames.clear();
+  this->file.close();
+  this->file.clear();
+
+  this->file.open(_path, std::ios::binary);
+  if (!this->file)
+    return false;
+
+  char header[kFileHeaderSize];
+  if (!this->file.read(header, kFileHeaderSize) ||
+      std::memcmp(header, kFileMagic, sizeof(kFileMagic)) != 0)
+  {
+    ignerr << "[" << _path << "] isn't a state log." << std::endl;
+    return false;
+  }
+
+  auto version = readFixed(header + sizeof(kFileMagic), 4);
+  if (version != kVersion)
+  {
+    ignerr << "State log [" << _path << "] has unsupported version ["
+           << version << "]." << std::endl;
+    return false;
+  }
+
+  // Load the index from the end of the file
+  this->file.seekg(0, std::ios::end);
+  auto size = static_cast<uint64_t>(this->file.tellg());
+  char trailer[kTrailerSize];
+  if (size >= kFileHeaderSize + kTrailerSize &&
+      this->file.seekg(size - kTrailerSize) &&
+      this->file.read(trailer, kTrailerSize) &&
+      readFixed(trailer + 8, 4) == kIndexMagic)
+  {
+    auto indexOffset = readFixed(trailer, 8);
+    char count[8];
+    if (indexOffset < size && this->file.seekg(indexOffset) &&
+        this->file.read(count, 8))
+    {
+      auto entries = readFixed(count, 8);
+      if (indexOffset + 8 + entries * kIndexEntrySize + kTrailerSize == size)
+      {
+        std::string data(entries * kIndexEntrySize, '\0');
+        this->file.read(&data[0], data.size());
+        for (uint64_t i = 0; i < entries && this->file; ++i)
+        {
+          const char *entry = data.data() + i * kIndexEntrySize;
+          StateLogChunkInfo info;
+          info.startTime = std::chrono::nanoseconds(
+              static_cast<int64_t>(readFixed(entry, 8)));
+          info.endTime = std::chrono::nanoseconds(
+              static_cast<int64_t>(readFixed(entry + 8, 8)));
+          info.offset = readFixed(entry + 16, 8);
+          this->index.push_back(info);
+        }
+      }
+    }
+  }
+
+  if (this->index.empty() || !this->file)
+  {
+    this->file.clear();
+    ignwarn << "State log [" << _path << "] doesn't have an index, it may "
+            << "not have been closed. Scanning its chunks." << std::endl;
+    if (!this->ScanChunks())
+    {
+      ignerr << "State log [" << _path << "] doesn't have any states."
+             << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool StateLogReader::ScanChunks()
+{
+  IGN_PROFILE("StateLogReader::ScanChunks");
+
+  this->index.clear();
+  this->file.clear();
+  this->file.seekg(0, std::ios::end);
+  auto size = static_cast<uint64_t>(this->file.tellg());
+
+  uint64_t offset{kFileHeaderSize};
+  char header[kChunkHeaderSize];
+  while (offset + kChunkHeaderSize <= size &&
+      this->file.seekg(offset) &&
+      this->file.read(header, kChunkHeaderSize) &&
+      readFixed(header, 4) == kChunkMagic)
+  {
+    auto stored = readFixed(header + 32, 8);
+
+    // Truncated chunk
+    if (offset + kChunkHeaderSize + stored > size)
+      break;
+
+    StateLogChunkInfo info;
+    info.startTime = std::chrono::nanoseconds(
+        static_cast<int64_t>(readFixed(header + 8, 8)));
+    info.endTime = std::chrono::nanoseconds(
+        static_cast<int64_t>(readFixed(header + 16, 8)));
+    info.offset = offset;
+    this->index.push_back(info);
+
+    offset += kChunkHeaderSize + stored;
+  }
+  this->file.clear();
+
+  return !this->index.empty();
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration StateLogReader::StartTime() const
+{
+  if (this->index.empty())
+    return std::chrono::steady_clock::duration::zero();
+  return this->index.front().startTime;
+}
+
+//////////////////////////////////////////////////
+std::chrono::steady_clock::duration StateLogReader::EndTime() const
+{
+  if (this->index.empty())
+    return std::chrono::steady_clock::duration::zero();
+  return this->index.back().endTime;
+}
+
+//////////////////////////////////////////////////
+std::size_t StateLogReader::ChunkCount() const
+{
+  return this->index.size();
+}
+
+//////////////////////////////////////////////////
+std::size_t StateLogReader::ChunkAt(
+    std::chrono::steady_clock::duration _time) const
+{
+  auto it = std::upper_bound(this->index.begin(), this->index.end(), _time,
+      [](const auto &_t, const StateLogChunkInfo &_info)
+      {
+        return _t < _info.startTime;
+      });
+  if (it == this->index.begin())
+    return 0;
+  return static_cast<std::size_t>(it - this->index.begin()) - 1;
+}
+
+//////////////////////////////////////////////////
+const std::vector<StateLogFrame> *StateLogReader::Frames(std::size_t _chunk)
+{
+  if (_chunk >= this->index.size())
+    return nullptr;
+
+  if (_chunk == this->cachedChunk && !this->cachedFrames.empty())
+    return &this->cachedFrames;
+
+  IGN_PROFILE("StateLogReader::Frames");
+
+  this->cachedFrames.clear();
+  const auto &info = this->index[_chunk];
+  char header[kChunkHeaderSize];
+  this->file.clear();
+  if (!this->file.seekg(info.offset) ||
+      !this->file.read(header, kChunkHeaderSize) ||
+      readFixed(header, 4) != kChunkMagic)
+  {
+    ignerr << "Failed to read state log chunk [" << _chunk << "]."
+           << std::endl;
+    return nullptr;
+  }
+
+  auto chunkCompression = static_cast<StateLogCompression>(
+      readFixed(header + 4, 4));
+  auto rawSize = readFixed(header + 24, 8);
+  auto stored = readFixed(header + 32, 8);
+
+  std::string payload(stored, '\0');
+  if (!this->file.read(&payload[0], stored))
+  {
+    ignerr << "State log chunk [" << _chunk << "] is truncated."
+           << std::endl;
+    return nullptr;
+  }
+
+  std::string raw;
+  if (chunkCompression == StateLogCompression::ZLIB)
+  {
+    if (!Decompress(payload, rawSize, raw))
+    {
+      ignerr << "Failed to decompress state log chunk [" << _chunk << "]."
+             << std::endl;
+      return nullptr;
+    }
+  }
+  else if (chunkCompression == StateLogCompression::NONE)
+  {
+    raw = std::move(payload);
+  }
+  else
+  {
+    ignerr << "State log chunk [" << _chunk << "] has unknown compression ["
+           << static_cast<uint32_t>(chunkCompression) << "]." << std::endl;
+    return nullptr;
+  }
+
+  if (!decodeFrames(raw, info.startTime, this->cachedFrames) ||
+      this->cachedFrames.empty())
+  {
+    ignerr << "State log chunk [" << _chunk << "] is corrupt." << std::endl;
+    this->cachedFrames.clear();
+    return nullptr;
+  }
+
+  this->cachedChunk = _chunk;
+  return &this->cachedFrames;
+}
@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GAZEBO_SYSTEMS_LOG_STATELOG_HH_
+#define IGNITION_GAZEBO_SYSTEMS_LOG_STATELOG_HH_
+
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/log-system/Export.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \brief Compression of state log chunks.
+  enum class StateLogCompression : uint32_t
+  {
+    /// \brief Chunks are stored as they are.
+    NONE = 0,
+
+    /// \brief Chunks are compressed with zlib.
+    ZLIB = 1
+  };
+
+  /// \brief A state recorded at one time.
+  struct StateLogFrame
+  {
+    /// \brief Sim time of the state.
+    std::chrono::steady_clock::duration time{0};
+
+    /// \brief True if the state holds all entities and components, false
+    /// if it only holds the changes since the previous frame.
+    bool keyframe{false};
+
+    /// \brief The state.
+    msgs::SerializedStateMap state;
+  };
+
+  /// \brief Location of a chunk in a state log.
+  struct StateLogChunkInfo
+  {
+    /// \brief Time of the chunk's first frame.
+    std::chrono::steady_clock::duration startTime{0};
+
+    /// \brief Time of the chunk's last frame.
+    std::chrono::steady_clock::duration endTime{0};
+
+    /// \brief Offset of the chunk from the start of the file.
+    uint64_t offset{0};
+  };
+
+  /// \brief Drops components whose data didn't change since they were last
+  /// recorded.
+  ///
+  /// Components with periodic changes, such as poses, are marked as changed
+  /// whenever they're set, even if their value is the same, for example
+  /// for resting bodies. Comparing the serialized data against the last
+  /// recorded data keeps those out of the log.
+  class IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE StateChangeFilter
+  {
+    /// \brief Remove unchanged components from a state, and remember the
+    /// data of the remaining ones.
+    /// \param[in,out] _state State to filter.
+    /// \param[in] _full True if _state is the full state, which is kept as
+    /// it is and replaces everything remembered so far.
+    public: void Filter(msgs::SerializedStateMap &_state, bool _full);
+
+    /// \brief Forget all recorded data, so the next state is kept whole.
+    public: void Reset();
+
+    /// \brief Get the number of components dropped so far.
+    /// \return Number of components.
+    public: uint64_t Dropped() const;
+
+    /// \brief Last recorded data, keyed by entity, then component type.
+    private: std::unordered_map<uint64_t,
+        std::unordered_map<int64_t, std::string>> recorded;
+
+    /// \brief Number of dropped components.
+    private: uint64_t dropped{0};
+  };
+
+  /// \brief What StateLogWriter::Write does when the writer thread falls
+  /// behind and its queue is full.
+  enum class StateLogBackPressure
+  {
+    /// \brief Wait for the writer thread, which slows down simulation.
+    BLOCK,
+
+    /// \brief Drop the frame. The next frame must then be a keyframe.
+    DROP,
+
+    /// \brief Drop deltas until the next periodic keyframe, and wait for
+    /// the writer thread on keyframes, so the log is only missing detail.
+    KEYFRAMES_ONLY
+  };
+
+  /// \brief Counters of a StateLogWriter.
+  struct StateLogWriterStats
+  {
+    /// \brief Frames waiting for the writer thread.
+    std::size_t queueDepth{0};
+
+    /// \brief Largest queue depth so far.
+    std::size_t maxQueueDepth{0};
+
+    /// \brief Frames dropped because the queue was full, or because they
+    /// followed a dropped frame.
+    uint64_t droppedFrames{0};
+
+    /// \brief Frames taken by the writer thread.
+    uint64_t writtenFrames{0};
+  };
+
+  /// \brief Writes states into a seekable log file, usually named
+  /// `state.glog`.
+  ///
+  /// States are grouped into chunks, each starting with a keyframe which
+  /// holds the full state, followed by the changes since then. Inside a
+  /// chunk, component data is stored in columns, one per component type, so
+  /// similar data ends up next to each other, which compresses well. The
+  /// file ends with an index of chunk times, so readers jump to any time by
+  /// decoding a single chunk.
+  ///
+  /// Write only queues frames. A writer thread filters, encodes, compresses
+  /// and writes them, so disk stalls don't slow down the caller unless the
+  /// queue fills up, see StateLogBackPressure. The file is complete shortly
+  /// after Close, without a compression pass over the whole recording.
+  class IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE StateLogWriter
+  {
+    /// \brief Destructor, which closes the file.
+    public: ~StateLogWriter();
+
+    /// \brief Set what happens when the queue is full. Must be called
+    /// before Open.
+    /// \param[in] _policy Policy, defaults to BLOCK.
+    /// \param[in] _maxQueuedFrames Queue size, at least 1. Defaults to 256.
+    public: void SetBackPressure(StateLogBackPressure _policy,
+        std::size_t _maxQueuedFrames);
+
+    /// \brief Set whether to leave out unchanged components, see
+    /// StateChangeFilter. Filtering happens on the writer thread. Must be
+    /// called before Open.
+    /// \param[in] _skip True to skip unchanged components. Defaults to
+    /// false.
+    public: void SetSkipUnchanged(bool _skip);
+
+    /// \brief Create a log file, replacing any existing file.
+    /// \param[in] _path Path of the file.
+    /// \param[in] _keyframePeriod Sim time between keyframes.
+    /// \param[in] _compression Compression of chunks. Falls back to NONE if
+    /// the compression isn't available.
+    /// \return True if the file was created.
+    public: bool Open(const std::string &_path,
+        std::chrono::steady_clock::duration _keyframePeriod,
+        StateLogCompression _compression);
+
+    /// \brief Whether the next frame must be a keyframe.
+    /// \param[in] _time Time of the next frame.
+    /// \return True if there aren't any frames yet, or the keyframe period
+    /// has passed since the last keyframe, or time went back, or the last
+    /// frame was dropped.
+    public: bool NeedsKeyframe(std::chrono::steady_clock::duration _time) const;
+
+    /// \brief Queue a frame. Keyframes start a new chunk, writing the
+    /// previous one to disk.
+    /// \param[in] _time Sim time of the state.
+    /// \param[in] _state State, either full or changes only. Move it in to
+    /// avoid a copy.
+    /// \param[in] _keyframe True if _state is the full state.
+    /// \return True if the frame was queued, false if it was dropped.
+    public: bool Write(std::chrono::steady_clock::duration _time,
+        msgs::SerializedStateMap _state, bool _keyframe);
+
+    /// \brief Get the writer's counters.
+    /// \return Counters since Open.
+    public: StateLogWriterStats Stats() const;
+
+    /// \brief Write the queued frames and the index, and close the file.
+    /// Has no effect if the file isn't open.
+    public: void Close();
+
+    /// \brief Write queued frames until Close.
+    private: void RunWriter();
+
+    /// \brief Encode, compress and write a chunk.
+    /// \param[in] _frames Frames of the chunk.
+    private: void WriteChunk(const std::vector<StateLogFrame> &_frames);
+
+    /// \brief The file.
+    private: std::ofstream file;
+
+    /// \brief Path of the file.
+    private: std::string path;
+
+    /// \brief Sim time between keyframes.
+    private: std::chrono::steady_clock::duration keyframePeriod{0};
+
+    /// \brief Chunk compression.
+    private: StateLogCompression compression{StateLogCompression::NONE};
+
+    /// \brief What to do when the queue is full.
+    private: StateLogBackPressure backPressure{StateLogBackPressure::BLOCK};
+
+    /// \brief Largest number of queued frames.
+    private: std::size_t maxQueuedFrames{256};
+
+    /// \brief Filter of unchanged components, used by the writer thread.
+    /// Nullptr if disabled.
+    private: std::unique_ptr<StateChangeFilter> changeFilter;
+
+    /// \brief Chunks written so far, only used by the writer thread until
+    /// it's stopped.
+    private: std::vector<StateLogChunkInfo> index;
+
+    /// \brief Frames waiting for the writer thread.
+    private: std::deque<StateLogFrame> queue;
+
+    /// \brief Counters, protected by queueMutex.
+    private: StateLogWriterStats stats;
+
+    /// \brief Protects queue, stats and stopWriter.
+    private: mutable std::mutex queueMutex;
+
+    /// \brief Notified when frames are queued or taken.
+    private: std::condition_variable queueCv;
+
+    /// \brief True to stop the writer thread once the queue is empty.
+    private: bool stopWriter{false};
+
+    /// \brief Thread writing chunks.
+    private: std::thread writerThread;
+
+    /// \brief True once a keyframe was queued.
+    private: bool started{false};
+
+    /// \brief True while deltas are dropped because a previous frame was.
+    private: bool awaitingKeyframe{true};
+
+    /// \brief True if the next frame must be a keyframe.
+    private: bool forceKeyframe{false};
+
+    /// \brief Time of the last keyframe.
+    private: std::chrono::steady_clock::duration lastKeyframeTime{0};
+
+    /// \brief Time of the last frame.
+    private: std::chrono::steady_clock::duration lastTime{0};
+
+    /// \brief Encoded chunk, reused between chunks by the writer thread.
+    private: std::string raw;
+
+    /// \brief Compressed chunk, reused between chunks by the writer thread.
+    private: std::string compressed;
+  };
+
+  /// \brief Reads log files written by StateLogWriter.
+  ///
+  /// Files which weren't closed, for example because the recording
+  /// crashed, don't have an index, which is then rebuilt by scanning the
+  /// chunks.
+  class IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE StateLogReader
+  {
+    /// \brief Open a log file and load its index.
+    /// \param[in] _path Path of the file.
+    /// \return True if the file is a state log with at least one chunk.
+    public: bool Open(const std::string &_path);
+
+    /// \brief Get the time of the first frame.
+    /// \return Sim time.
+    public: std::chrono::steady_clock::duration StartTime() const;
+
+    /// \brief Get the time of the last frame.
+    /// \return Sim time.
+    public: std::chrono::steady_clock::duration EndTime() const;
+
+    /// \brief Get the number of chunks.
+    /// \return Number of chunks.
+    public: std::size_t ChunkCount() const;
+
+    /// \brief Find the chunk to start from to get the state at a time,
+    /// using a binary search over the index.
+    /// \param[in] _time Sim time.
+    /// \return Index of the last chunk starting at or before _time, 0 if
+    /// _time is before the start of the log.
+    public: std::size_t ChunkAt(std::chrono::steady_clock::duration _time)
+        const;
+
+    /// \brief Get the frames of a chunk. The last chunk read is cached.
+    /// \param[in] _chunk Chunk index.
+    /// \return Frames, whose first one is a keyframe, or nullptr if the
+    /// chunk couldn't be read.
+    public: const std::vector<StateLogFrame> *Frames(std::size_t _chunk);
+
+    /// \brief Rebuild the index by reading all chunk headers.
+    /// \return True if at least one chunk was found.
+    private: bool ScanChunks();
+
+    /// \brief The file.
+    private: std::ifstream file;
+
+    /// \brief Chunk locations.
+    private: std::vector<StateLogChunkInfo> index;
+
+    /// \brief Index of the cached chunk.
+    private: std::size_t cachedChunk{0};
+
+    /// \brief Frames of the cached chunk, empty if none.
+    private: std::vector<StateLogFrame> cachedFrames;
+  };
+}
+}
+}
+}
+#endif
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "StateLogPrefetcher.hh"
+
+#include <algorithm>
+#include <utility>
+
+#include <ignition/common/Profiler.hh>
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+//////////////////////////////////////////////////
+StateLogPrefetcher::StateLogPrefetcher(
+    std::unique_ptr<StateLogReader> _reader, std::size_t _depth,
+    std::unique_ptr<PlaybackFilter> _filter)
+  : reader(std::move(_reader)), depth(std::max<std::size_t>(_depth, 1)),
+    filter(std::move(_filter))
+{
+  this->thread = std::thread(&StateLogPrefetcher::Run, this);
+}
+
+//////////////////////////////////////////////////
+StateLogPrefetcher::~StateLogPrefetcher()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stop = true;
+    this->cv.notify_all();
+  }
+  if (this->thread.joinable())
+    this->thread.join();
+}
+
+//////////////////////////////////////////////////
+const StateLogReader &StateLogPrefetcher::Reader() const
+{
+  return *this->reader;
+}
+
+//////////////////////////////////////////////////
+std::unique_ptr<PreparedStateLogChunk> StateLogPrefetcher::Take(
+    std::size_t _chunk)
+{
+  if (_chunk >= this->reader->ChunkCount())
+    return nullptr;
+
+  IGN_PROFILE("StateLogPrefetcher::Take");
+
+  std::unique_lock<std::mutex> lock(this->mutex);
+
+  // Chunks before the requested one won't be needed anymore
+  while (!this->ready.empty() && this->ready.front()->index < _chunk)
+    this->ready.pop_front();
+
+  bool upcoming = this->ready.empty() ? this->nextChunk == _chunk :
+      this->ready.front()->index == _chunk;
+  if (!upcoming)
+  {
+    this->ready.clear();
+    this->nextChunk = _chunk;
+    ++this->generation;
+    this->cv.notify_all();
+  }
+
+  {
+    IGN_PROFILE("StateLogPrefetcher::Take Wait");
+    this->cv.wait(lock, [this]
+        {
+          return !this->ready.empty() || this->stop;
+        });
+  }
+  if (this->ready.empty())
+    return nullptr;
+
+  auto chunk = std::move(this->ready.front());
+  this->ready.pop_front();
+  this->cv.notify_all();
+
+  if (chunk->frames.empty())
+    return nullptr;
+  return chunk;
+}
+
+//////////////////////////////////////////////////
+void StateLogPrefetcher::Run()
+{
+  IGN_PROFILE_THREAD_NAME("StateLogPrefetcher");
+
+  while (true)
+  {
+    std::size_t chunkIndex;
+    uint64_t chunkGeneration;
+    {
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->cv.wait(lock, [this]
+          {
+            return this->stop || (this->ready.size() < this->depth &&
+                this->nextChunk < this->reader->ChunkCount());
+          });
+      if (this->stop)
+        break;
+
+      chunkIndex = this->nextChunk;
+      chunkGeneration = this->generation;
+    }
+
+    IGN_PROFILE("StateLogPrefetcher::Prepare");
+
+    auto chunk = std::make_unique<PreparedStateLogChunk>();
+    chunk->index = chunkIndex;
+    auto frames = this->reader->Frames(chunkIndex);
+    if (nullptr != frames)
+    {
+      chunk->frames.reserve(frames->size());
+      for (const auto &frame : *frames)
+      {
+        chunk->frames.push_back({frame.time, frame.keyframe,
+            nullptr != this->filter ?
+            this->filter->Deserialize(frame.state, frame.keyframe) :
+            EntityComponentManager::DeserializeState(frame.state)});
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (chunkGeneration != this->generation)
+      continue;
+
+    this->ready.push_back(std::move(chunk));
+    this->nextChunk = chunkIndex + 1;
+    this->cv.notify_all();
+  }
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef IGNITION_GAZEBO_SYSTEMS_LOG_STATELOGPREFETCHER_HH_
+#define IGNITION_GAZEBO_SYSTEMS_LOG_STATELOGPREFETCHER_HH_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/EntityComponentManager.hh>
+#include <ignition/gazebo/log-system/Export.hh>
+
+#include "PlaybackFilter.hh"
+#include "StateLog.hh"
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  /// \brief A state log frame whose components are deserialized.
+  struct PreparedStateLogFrame
+  {
+    /// \brief Sim time of the state.
+    std::chrono::steady_clock::duration time{0};
+
+    /// \brief True if the state holds all entities and components.
+    bool keyframe{false};
+
+    /// \brief The state, ready to be set on an ECM.
+    DeserializedState state;
+  };
+
+  /// \brief The deserialized frames of a state log chunk.
+  struct PreparedStateLogChunk
+  {
+    /// \brief Chunk index.
+    std::size_t index{0};
+
+    /// \brief Frames, whose first one is a keyframe. Empty if the chunk
+    /// couldn't be read.
+    std::vector<PreparedStateLogFrame> frames;
+  };
+
+  /// \brief Reads, decompresses and deserializes the chunks of a state log
+  /// ahead of playback on a thread of its own, so playback only has to move
+  /// the components into the ECM.
+  ///
+  /// Chunks are prepared in order, starting with the last chunk taken.
+  /// Taking any other chunk, for example when seeking, discards the
+  /// prepared chunks and restarts from there.
+  class IGNITION_GAZEBO_LOG_SYSTEM_VISIBLE StateLogPrefetcher
+  {
+    /// \brief Constructor, which starts preparing the first chunk.
+    /// \param[in] _reader Opened state log. Its frames must only be read by
+    /// the prefetcher from now on.
+    /// \param[in] _depth Number of chunks to prepare ahead, at least 1.
+    /// \param[in] _filter Filter applied while deserializing frames,
+    /// nullptr to deserialize them whole.
+    public: StateLogPrefetcher(std::unique_ptr<StateLogReader> _reader,
+        std::size_t _depth, std::unique_ptr<PlaybackFilter> _filter = nullptr);
+
+    /// \brief Destructor, which stops the thread.
+    public: ~StateLogPrefetcher();
+
+    /// \brief Get the state log, to look up times and chunks, which is safe
+    /// while chunks are being prepared.
+    /// \return The state log.
+    public: const StateLogReader &Reader() const;
+
+    /// \brief Take a prepared chunk, waiting until it's ready. The next
+    /// chunks are then prepared.
+    /// \param[in] _chunk Chunk index.
+    /// \return The chunk, or nullptr if it couldn't be read.
+    public: std::unique_ptr<PreparedStateLogChunk> Take(std::size_t _chunk);
+
+    /// \brief Prepare chunks until stopped.
+    private: void Run();
+
+    /// \brief The state log.
+    private: std::unique_ptr<StateLogReader> reader;
+
+    /// \brief Number of chunks to prepare ahead.
+    private: std::size_t depth{1};
+
+    /// \brief Filter applied while deserializing, only used by the thread.
+    /// Nullptr if frames are deserialized whole.
+    private: std::unique_ptr<PlaybackFilter> filter;
+
+    /// \brief Prepared chunks, in order.
+    private: std::deque<std::unique_ptr<PreparedStateLogChunk>> ready;
+
+    /// \brief Chunk being prepared, or to prepare next.
+    private: std::size_t nextChunk{0};
+
+    /// \brief Incremented whenever the prepared chunks are discarded, so
+    /// the chunk being prepared is discarded too.
+    private: uint64_t generation{0};
+
+    /// \brief True to stop the thread.
+    private: bool stop{false};
+
+    /// \brief Protects ready, nextChunk, generation and stop.
+    private: std::mutex mutex;
+
+    /// \brief Notified when chunks are prepared or taken.
+    private: std::condition_variable cv;
+
+    /// \brief Thread preparing chunks.
+    private: std::thread thread;
+  };
+}
+}
+}
+}
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "StateLogPrefetcher.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+using namespace std::chrono_literals;
+
+/////////////////////////////////////////////////
+/// \brief Write a log with a chunk per second, 10 frames per chunk, and
+/// as many entities in each frame as its chunk index plus one.
+/// \param[in] _path Log path.
+void writeLog(const std::string &_path)
+{
+  StateLogWriter writer;
+  ASSERT_TRUE(writer.Open(_path, 1s, StateLogCompression::ZLIB));
+  for (int i = 0; i < 50; ++i)
+  {
+    std::chrono::steady_clock::duration time = i * 100ms;
+    msgs::SerializedStateMap state;
+    for (int e = 0; e <= i / 10; ++e)
+    {
+      auto &entity = (*state.mutable_entities())[100 + e];
+      entity.set_id(100 + e);
+    }
+    writer.Write(time, std::move(state), writer.NeedsKeyframe(time));
+  }
+  writer.Close();
+}
+
+/////////////////////////////////////////////////
+TEST(StateLogPrefetcher, Take)
+{
+  const std::string path{"state_log_prefetcher_test.glog"};
+  writeLog(path);
+
+  auto reader = std::make_unique<StateLogReader>();
+  ASSERT_TRUE(reader->Open(path));
+  StateLogPrefetcher prefetcher(std::move(reader), 2);
+  ASSERT_EQ(5u, prefetcher.Reader().ChunkCount());
+  EXPECT_EQ(2u, prefetcher.Reader().ChunkAt(2500ms));
+
+  // In order
+  for (std::size_t c = 0; c < 5; ++c)
+  {
+    auto chunk = prefetcher.Take(c);
+    ASSERT_NE(nullptr, chunk) << c;
+    EXPECT_EQ(c, chunk->index);
+    ASSERT_EQ(10u, chunk->frames.size());
+    EXPECT_TRUE(chunk->frames.front().keyframe);
+    EXPECT_FALSE(chunk->frames.back().keyframe);
+    EXPECT_EQ(std::chrono::steady_clock::duration(c * 1s),
+        chunk->frames.front().time);
+    EXPECT_EQ(c + 1, chunk->frames.front().state.entities.size());
+  }
+  EXPECT_EQ(nullptr, prefetcher.Take(5));
+
+  // Seeking back and forward
+  auto chunk = prefetcher.Take(1);
+  ASSERT_NE(nullptr, chunk);
+  EXPECT_EQ(1u, chunk->index);
+  chunk = prefetcher.Take(4);
+  ASSERT_NE(nullptr, chunk);
+  EXPECT_EQ(4u, chunk->index);
+  chunk = prefetcher.Take(0);
+  ASSERT_NE(nullptr, chunk);
+  EXPECT_EQ(0u, chunk->index);
+  chunk = prefetcher.Take(1);
+  ASSERT_NE(nullptr, chunk);
+  EXPECT_EQ(1u, chunk->index);
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "StateLog.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+using namespace std::chrono_literals;
+
+/////////////////////////////////////////////////
+/// \brief Get a state with one component per entity.
+/// \param[in] _entities Number of entities.
+/// \param[in] _value Component data.
+/// \return State.
+msgs::SerializedStateMap makeState(uint64_t _entities,
+    const std::string &_value)
+{
+  msgs::SerializedStateMap state;
+  for (uint64_t id = 1; id <= _entities; ++id)
+  {
+    auto &entity = (*state.mutable_entities())[1000 + id];
+    entity.set_id(1000 + id);
+    auto &component = (*entity.mutable_components())[42];
+    component.set_type(42);
+    component.set_component(_value + std::to_string(id));
+  }
+  return state;
+}
+
+/////////////////////////////////////////////////
+/// \brief Write a log with a keyframe every second and a state every
+/// 100 ms, whose component data is the frame number.
+/// \param[in] _path Log path.
+/// \param[in] _compression Compression.
+void writeLog(const std::string &_path, StateLogCompression _compression)
+{
+  StateLogWriter writer;
+  ASSERT_TRUE(writer.Open(_path, 1s, _compression));
+
+  for (int i = 0; i <= 50; ++i)
+  {
+    std::chrono::steady_clock::duration time = i * 100ms;
+    bool keyframe = writer.NeedsKeyframe(time);
+    EXPECT_EQ(i % 10 == 0, keyframe) << i;
+
+    auto state = makeState(keyframe ? 3 : 1, std::to_string(i) + "_");
+    if (i == 25)
+      (*state.mutable_entities())[1001].set_remove(true);
+    writer.Write(time, state, keyframe);
+  }
+  writer.Close();
+}
+
+/////////////////////////////////////////////////
+/// \brief Check the log written by writeLog.
+/// \param[in] _path Log path.
+void checkLog(const std::string &_path)
+{
+  StateLogReader reader;
+  ASSERT_TRUE(reader.Open(_path));
+  EXPECT_EQ(6u, reader.ChunkCount());
+  EXPECT_EQ(0s, reader.StartTime());
+  EXPECT_EQ(5s, reader.EndTime());
+
+  EXPECT_EQ(0u, reader.ChunkAt(-1s));
+  EXPECT_EQ(0u, reader.ChunkAt(0s));
+  EXPECT_EQ(0u, reader.ChunkAt(999ms));
+  EXPECT_EQ(2u, reader.ChunkAt(2500ms));
+  EXPECT_EQ(5u, reader.ChunkAt(100s));
+
+  auto frames = reader.Frames(2);
+  ASSERT_NE(nullptr, frames);
+  ASSERT_EQ(10u, frames->size());
+
+  const auto &keyframe = frames->front();
+  EXPECT_TRUE(keyframe.keyframe);
+  EXPECT_EQ(2s, keyframe.time);
+  ASSERT_EQ(3, keyframe.state.entities().size());
+  const auto &entity = keyframe.state.entities().at(1003);
+  EXPECT_EQ(1003u, entity.id());
+  ASSERT_EQ(1, entity.components().size());
+  EXPECT_EQ(42, entity.components().at(42).type());
+  EXPECT_EQ("20_3", entity.components().at(42).component());
+
+  const auto &delta = (*frames)[5];
+  EXPECT_FALSE(delta.keyframe);
+  EXPECT_EQ(2500ms, delta.time);
+  ASSERT_EQ(1, delta.state.entities().size());
+  EXPECT_TRUE(delta.state.entities().at(1001).remove());
+  EXPECT_EQ("25_1",
+      delta.state.entities().at(1001).components().at(42).component());
+
+  // Cached
+  EXPECT_EQ(frames, reader.Frames(2));
+  EXPECT_EQ(nullptr, reader.Frames(6));
+}
+
+/////////////////////////////////////////////////
+TEST(StateLog, WriteRead)
+{
+  const std::string path{"state_log_test.glog"};
+  writeLog(path, StateLogCompression::NONE);
+  checkLog(path);
+
+  // Compression may not be available, which falls back to no compression
+  writeLog(path, StateLogCompression::ZLIB);
+  checkLog(path);
+  std::remove(path.c_str());
+}
+
+/////////////////////////////////////////////////
+TEST(StateLog, MissingIndex)
+{
+  const std::string path{"state_log_test_no_index.glog"};
+  writeLog(path, StateLogCompression::ZLIB);
+
+  // Drop the index, as if recording had crashed while writing a chunk
+  std::string data;
+  {
+    std::ifstream file(path, std::ios::binary);
+    data.assign(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>());
+  }
+  const std::size_t indexSize{8 + 6 * 24 + 12};
+  ASSERT_GT(data.size(), indexSize);
+  data.resize(data.size() - indexSize);
+  data += "CHNK";
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), data.size());
+  }
+
+  checkLog(path);
+  std::remove(path.c_str());
+}
+
+/////////////////////////////////////////////////
+TEST(StateLog, Invalid)
+{
+  StateLogReader reader;
+  EXPECT_FALSE(reader.Open("state_log_test_missing.glog"));
+
+  const std::string path{"state_log_test_invalid.glog"};
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << "not a state log";
+  }
+  EXPECT_FALSE(reader.Open(path));
+  std::remove(path.c_str());
+
+  // Chunks need a keyframe first
+  StateLogWriter writer;
+  ASSERT_TRUE(writer.Open(path, 1s, StateLogCompression::NONE));
+  writer.Write(0s, makeState(1, "a"), false);
+  writer.Close();
+  EXPECT_FALSE(reader.Open(path));
+  std::remove(path.c_str());
+}
+
+/////////////////////////////////////////////////
+TEST(StateLog, ChangeFilter)
+{
+  StateChangeFilter filter;
+
+  // Full states are kept
+  auto state = makeState(3, "a");
+  filter.Filter(state, true);
+  EXPECT_EQ(3, state.entities().size());
+
+  // Unchanged components and their entities are dropped
+  state = makeState(3, "a");
+  (*state.mutable_entities())[1002].mutable_components()->at(42)
+      .set_component("changed");
+  filter.Filter(state, false);
+  ASSERT_EQ(1, state.entities().size());
+  EXPECT_EQ("changed",
+      state.entities().at(1002).components().at(42).component());
+  EXPECT_EQ(2u, filter.Dropped());
+
+  // New entities, removals and component removals are kept
+  state = makeState(3, "a");
+  (*state.mutable_entities())[1002].mutable_components()->at(42)
+      .set_component("changed");
+  (*state.mutable_entities())[1001].set_remove(true);
+  (*state.mutable_entities())[1003].mutable_components()->at(42)
+      .set_remove(true);
+  auto &created = (*state.mutable_entities())[2000];
+  created.set_id(2000);
+  filter.Filter(state, false);
+  EXPECT_EQ(3, state.entities().size());
+  EXPECT_TRUE(state.entities().at(1001).remove());
+  EXPECT_TRUE(state.entities().at(1003).components().at(42).remove());
+  EXPECT_EQ(1u, state.entities().count(2000));
+  EXPECT_EQ(0u, state.entities().count(1002));
+
+  // Removed entities and components are recorded again when they're back
+  state = makeState(3, "a");
+  (*state.mutable_entities())[1002].mutable_components()->at(42)
+      .set_component("changed");
+  filter.Filter(state, false);
+  EXPECT_EQ(2, state.entities().size());
+  EXPECT_EQ(1u, state.entities().count(1001));
+  EXPECT_EQ(1u, state.entities().count(1003));
+
+  filter.Reset();
+  state = makeState(3, "a");
+  filter.Filter(state, false);
+  EXPECT_EQ(3, state.entities().size());
+}
+
+/////////////////////////////////////////////////
+TEST(StateLog, SkipUnchanged)
+{
+  const std::string path{"state_log_test_skip.glog"};
+  StateLogWriter writer;
+  writer.SetSkipUnchanged(true);
+  ASSERT_TRUE(writer.Open(path, 1s, StateLogCompression::NONE));
+
+  // Only the first delta changes anything
+  EXPECT_TRUE(writer.Write(0ms, makeState(3, "a"), true));
+  EXPECT_TRUE(writer.Write(100ms, makeState(3, "b"), false));
+  EXPECT_TRUE(writer.Write(200ms, makeState(3, "b"), false));
+  EXPECT_TRUE(writer.Write(300ms, makeState(3, "b"), false));
+  writer.Close();
+  EXPECT_EQ(4u, writer.Stats().writtenFrames);
+
+  StateLogReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  auto frames = reader.Frames(0);
+  ASSERT_NE(nullptr, frames);
+  ASSERT_EQ(2u, frames->size());
+  EXPECT_EQ(100ms, frames->back().time);
+  EXPECT_EQ(3, frames->back().state.entities().size());
+  std::remove(path.c_str());
+}
+
+/////////////////////////////////////////////////
+/// \brief Write many frames through a tiny queue, and check that the log
+/// stays consistent whatever was dropped.
+/// \param[in] _policy Back pressure policy.
+void checkBackPressure(StateLogBackPressure _policy)
+{
+  const std::string path{"state_log_test_back_pressure.glog"};
+  StateLogWriter writer;
+  writer.SetBackPressure(_policy, 1);
+  ASSERT_TRUE(writer.Open(path, 100ms, StateLogCompression::ZLIB));
+
+  const int count{2000};
+  int keyframes{0};
+  int queued{0};
+  for (int i = 0; i < count; ++i)
+  {
+    std::chrono::steady_clock::duration time = i * 10ms;
+    bool keyframe = writer.NeedsKeyframe(time);
+    keyframes += keyframe ? 1 : 0;
+    if (writer.Write(time, makeState(keyframe ? 50 : 5, std::to_string(i)),
+        keyframe))
+    {
+      ++queued;
+    }
+  }
+  writer.Close();
+
+  auto stats = writer.Stats();
+  EXPECT_EQ(0u, stats.queueDepth);
+  EXPECT_EQ(1u, stats.maxQueueDepth);
+  EXPECT_EQ(static_cast<uint64_t>(queued), stats.writtenFrames);
+  EXPECT_EQ(static_cast<uint64_t>(count),
+      stats.writtenFrames + stats.droppedFrames);
+  if (_policy == StateLogBackPressure::BLOCK)
+  {
+    EXPECT_EQ(0u, stats.droppedFrames);
+  }
+
+  StateLogReader reader;
+  ASSERT_TRUE(reader.Open(path));
+  std::size_t frameCount{0};
+  for (std::size_t c = 0; c < reader.ChunkCount(); ++c)
+  {
+    auto frames = reader.Frames(c);
+    ASSERT_NE(nullptr, frames);
+    ASSERT_FALSE(frames->empty());
+    EXPECT_TRUE(frames->front().keyframe);
+    frameCount += frames->size();
+  }
+  EXPECT_EQ(stats.writtenFrames, frameCount);
+
+  // Keyframes are never dropped, and periodic keyframes are the only ones
+  if (_policy != StateLogBackPressure::DROP)
+  {
+    EXPECT_EQ(static_cast<std::size_t>(keyframes), reader.ChunkCount());
+  }
+  if (_policy == StateLogBackPressure::KEYFRAMES_ONLY)
+  {
+    EXPECT_EQ(static_cast<std::size_t>(count / 10), reader.ChunkCount());
+  }
+  std::remove(path.c_str());
+}
+
+/////////////////////////////////////////////////
+TEST(StateLog, BackPressure)
+{
+  checkBackPressure(StateLogBackPressure::BLOCK);
+  checkBackPressure(StateLogBackPressure::DROP);
+  checkBackPressure(StateLogBackPressure::KEYFRAMES_ONLY);
+}
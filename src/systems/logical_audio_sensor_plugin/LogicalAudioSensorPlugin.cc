@@ -17,6 +17,7 @@
 
 #include "LogicalAudioSensorPlugin.hh"
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <mutex>
@@ -35,6 +36,7 @@
 #include <ignition/transport.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/gazebo/SdfEntityCreator.hh>
+#include <ignition/gazebo/SpatialIndex.hh>
 #include <ignition/gazebo/Util.hh>
 #include <sdf/Element.hh>
 #include "LogicalAudio.hh"
@@ -77,9 +79,32 @@ class ignition::gazebo::systems::LogicalAudioSensorPluginPrivate
   public: bool DurationExceeded(const UpdateInfo &_simTimeInfo,
                const logical_audio::SourcePlayInfo &_sourcePlayInfo);
 
+  /// \brief Bring the source index up to date with the sources of the
+  /// world, only moving the sources whose position or falloff distance
+  /// changed.
+  /// \param[in] _ecm The simulation's EntityComponentManager.
+  public: void UpdateSourceIndex(const EntityComponentManager &_ecm);
+
   /// \brief Node used to create publishers and services
   public: ignition::transport::Node node;
 
+  /// \brief Audio sources of the world bucketed by the sphere they can be
+  /// heard in, so each microphone only checks the sources that reach it.
+  public: SpatialIndex sourceIndex;
+
+  /// \brief State of a source when it was last added to sourceIndex.
+  public: struct IndexedSource
+  {
+    /// \brief World pose of the source.
+    public: math::Pose3d pose;
+
+    /// \brief Falloff distance of the source.
+    public: double falloffDistance{0.0};
+  };
+
+  /// \brief Sources in sourceIndex.
+  public: std::unordered_map<Entity, IndexedSource> indexedSources;
+
   /// \brief A flag used to initialize a source's playing information
   /// before starting simulation.
   public: bool firstTime{true};
@@ -212,49 +237,117 @@ void LogicalAudioSensorPlugin::PostUpdate(const UpdateInfo &_info,
     std::chrono::duration_cast<std::chrono::nanoseconds>(_info.simTime);
   const auto nanosecondOffset = (simNanoseconds - simSeconds).count();
 
+  if (this->dataPtr->micEntities.empty())
+    return;
+
+  this->dataPtr->UpdateSourceIndex(_ecm);
+
   for (auto & [micEntity, detectionPub] : this->dataPtr->micEntities)
   {
-    const auto micPose = worldPose(micEntity, _ecm);
+    auto cachedMicPose = _ecm.CachedWorldPose(micEntity);
+    const auto micPose =
+        cachedMicPose ? *cachedMicPose : worldPose(micEntity, _ecm);
     const auto micInfo = _ecm.Component<components::LogicalMicrophone>(
         micEntity)->Data();
 
-    _ecm.Each<components::LogicalAudioSource,
-              components::LogicalAudioSourcePlayInfo>(
-      [&, &publisher = detectionPub](const Entity &_entity,
+    // Only the sources whose falloff sphere bounds contain the microphone
+    // can be heard by it. Sort them so detections are published in a
+    // stable order.
+    auto candidates = this->dataPtr->sourceIndex.QueryBox(
+        math::AxisAlignedBox(micPose.Pos(), micPose.Pos()));
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const Entity sourceEntity : candidates)
+    {
+      const auto source =
+          _ecm.Component<components::LogicalAudioSource>(sourceEntity);
+      const auto playInfo =
+          _ecm.Component<components::LogicalAudioSourcePlayInfo>(
+          sourceEntity);
+      if (!source || !playInfo)
+        continue;
+
+      const auto vol = logical_audio::computeVolume(
+          playInfo->Data().playing,
+          source->Data().attFunc,
+          source->Data().attShape,
+          source->Data().emissionVolume,
+          source->Data().innerRadius,
+          source->Data().falloffDistance,
+          this->dataPtr->indexedSources[sourceEntity].pose,
+          micPose);
+
+      if (logical_audio::detect(vol, micInfo.volumeDetectionThreshold))
+      {
+        // publish the source that the microphone heard, along with the
+        // volume level the microphone detected. The detected source's
+        // ID is embedded in the message's header
+        ignition::msgs::Double msg;
+        auto header = msg.mutable_header();
+        auto timeStamp = header->mutable_stamp();
+        timeStamp->set_sec(simSeconds.count());
+        timeStamp->set_nsec(nanosecondOffset);
+        auto headerData = header->add_data();
+        headerData->set_key(scopedName(sourceEntity, _ecm));
+        msg.set_data(vol);
+
+        detectionPub.Publish(msg);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void LogicalAudioSensorPluginPrivate::UpdateSourceIndex(
+    const EntityComponentManager &_ecm)
+{
+  _ecm.EachRemoved<components::LogicalAudioSource>(
+      [&](const Entity &_entity, const components::LogicalAudioSource *)
+      {
+        this->sourceIndex.Remove(_entity);
+        this->indexedSources.erase(_entity);
+        return true;
+      });
+
+  // Size the cells after the largest falloff distance the first time
+  // sources are seen, so a source's sphere only spans a few cells
+  if (this->indexedSources.empty())
+  {
+    double maxFalloff = 0.0;
+    _ecm.Each<components::LogicalAudioSource>(
+        [&](const Entity &, const components::LogicalAudioSource *_source)
+        {
+          maxFalloff = std::max(maxFalloff, _source->Data().falloffDistance);
+          return true;
+        });
+    this->sourceIndex.SetCellSize(std::max(1.0, maxFalloff));
+  }
+
+  _ecm.Each<components::LogicalAudioSource,
+            components::LogicalAudioSourcePlayInfo>(
+      [&](const Entity &_entity,
           const components::LogicalAudioSource *_source,
-          const components::LogicalAudioSourcePlayInfo *_playInfo)
+          const components::LogicalAudioSourcePlayInfo *)
       {
-        const auto sourcePose = worldPose(_entity, _ecm);
-        const auto vol = logical_audio::computeVolume(
-            _playInfo->Data().playing,
-            _source->Data().attFunc,
-            _source->Data().attShape,
-            _source->Data().emissionVolume,
-            _source->Data().innerRadius,
-            _source->Data().falloffDistance,
-            sourcePose,
-            micPose);
-
-        if (logical_audio::detect(vol, micInfo.volumeDetectionThreshold))
+        auto cached = _ecm.CachedWorldPose(_entity);
+        const auto pose = cached ? *cached : worldPose(_entity, _ecm);
+        const double falloff = _source->Data().falloffDistance;
+
+        auto it = this->indexedSources.find(_entity);
+        if (it != this->indexedSources.end() &&
+            it->second.pose.Pos() == pose.Pos() &&
+            it->second.falloffDistance == falloff)
         {
-          // publish the source that the microphone heard, along with the
-          // volume level the microphone detected. The detected source's
-          // ID is embedded in the message's header
-          ignition::msgs::Double msg;
-          auto header = msg.mutable_header();
-          auto timeStamp = header->mutable_stamp();
-          timeStamp->set_sec(simSeconds.count());
-          timeStamp->set_nsec(nanosecondOffset);
-          auto headerData = header->add_data();
-          headerData->set_key(scopedName(_entity, _ecm));
-          msg.set_data(vol);
-
-          publisher.Publish(msg);
+          it->second.pose = pose;
+          return true;
         }
 
+        const math::Vector3d reach(falloff, falloff, falloff);
+        this->sourceIndex.Update(_entity,
+            math::AxisAlignedBox(pose.Pos() - reach, pose.Pos() + reach));
+        this->indexedSources[_entity] = {pose, falloff};
         return true;
       });
-  }
 }
 
 //////////////////////////////////////////////////
@@ -20,6 +20,7 @@
 #include <ignition/msgs/logical_camera_image.pb.h>
 
 #include <map>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -29,6 +30,7 @@
 
 #include <sdf/Sensor.hh>
 
+#include <ignition/math/Frustum.hh>
 #include <ignition/math/Helpers.hh>
 #include <ignition/transport/Node.hh>
 
@@ -59,6 +61,37 @@ class ignition::gazebo::systems::LogicalCameraPrivate
   /// \brief Ign-sensors sensor factory for creating sensors
   public: sensors::SensorFactory sensorFactory;
 
+  /// \brief Inputs last given to a sensor, so they are only set again
+  /// when the camera or a model in view moved.
+  public: struct SensorInputs
+  {
+    /// \brief World pose of the camera.
+    public: math::Pose3d pose;
+
+    /// \brief Poses of the models which may be in view.
+    public: std::map<std::string, math::Pose3d> modelPoses;
+  };
+
+  /// \brief Last inputs of each logicalCamera entity.
+  public: std::unordered_map<Entity, SensorInputs> lastInputs;
+
+  /// \brief Whether the spatial index of the ECM was enabled.
+  public: bool spatialIndexEnabled{false};
+
+  /// \brief Get the world poses of the models which may be in view of a
+  /// camera, using the spatial index of the ECM.
+  /// \param[in] _ecm Immutable reference to ECM.
+  /// \param[in] _entity Logical camera entity.
+  /// \param[in] _sensor Logical camera sensor.
+  /// \param[in] _pose World pose of the camera.
+  /// \param[out] _modelPoses Model poses by name.
+  /// \return False if the spatial index isn't up to date, in which case
+  /// all models must be tested.
+  public: bool ModelsInView(const EntityComponentManager &_ecm,
+      const Entity _entity, const sensors::LogicalCameraSensor &_sensor,
+      const math::Pose3d &_pose,
+      std::map<std::string, math::Pose3d> &_modelPoses) const;
+
   /// \brief Create logicalCamera sensor
   /// \param[in] _ecm Mutable reference to ECM.
   public: void CreateLogicalCameraEntities(EntityComponentManager &_ecm);
@@ -168,29 +201,74 @@ void LogicalCameraPrivate::CreateLogicalCameraEntities(
         this->entitySensorMap.insert(
             std::make_pair(_entity, std::move(sensor)));
 
+        // Cull models with the spatial index instead of testing all of them.
+        // Only enable it if nothing else did, to keep their cell size.
+        if (!this->spatialIndexEnabled)
+        {
+          if (_ecm.WorldSpatialIndex().Size() == 0)
+            _ecm.EnableSpatialIndex();
+          this->spatialIndexEnabled = true;
+        }
+
         return true;
       });
 }
 
+//////////////////////////////////////////////////
+bool LogicalCameraPrivate::ModelsInView(const EntityComponentManager &_ecm,
+    const Entity _entity, const sensors::LogicalCameraSensor &_sensor,
+    const math::Pose3d &_pose,
+    std::map<std::string, math::Pose3d> &_modelPoses) const
+{
+  // The index is refreshed along with the cached world poses, so if the
+  // camera has none the index doesn't reflect this iteration.
+  if (!this->spatialIndexEnabled || !_ecm.CachedWorldPose(_entity))
+    return false;
+
+  const math::Frustum frustum(_sensor.Near(), _sensor.Far(),
+      _sensor.HorizontalFOV(), _sensor.AspectRatio(), _pose);
+
+  for (const Entity entity : _ecm.WorldSpatialIndex().QueryFrustum(frustum))
+  {
+    if (!_ecm.Component<components::Model>(entity))
+      continue;
+    auto name = _ecm.Component<components::Name>(entity);
+    auto pose = _ecm.CachedWorldPose(entity);
+    if (name && pose)
+      _modelPoses[name->Data()] = *pose;
+  }
+  return true;
+}
+
 //////////////////////////////////////////////////
 void LogicalCameraPrivate::UpdateLogicalCameras(
     const EntityComponentManager &_ecm)
 {
   IGN_PROFILE("LogicalCameraPrivate::UpdateLogicalCameras");
-  std::map<std::string, math::Pose3d> modelPoses;
-
-  _ecm.Each<components::Model, components::Name, components::Pose>(
-      [&](const Entity &,
-        const components::Model *,
-        const components::Name *_name,
-        const components::Pose *_pose)->bool
-      {
-        /// todo(anyone) We currently assume there are only top level models
-        /// Update to retrieve world pose when nested models are supported.
-        modelPoses[_name->Data()] = _pose->Data();
-        return true;
-      });
 
+  // Poses of all models, only gathered if a camera can't use the spatial
+  // index
+  std::optional<std::map<std::string, math::Pose3d>> allModelPoses;
+  auto allModels = [&]() -> const std::map<std::string, math::Pose3d> &
+  {
+    if (!allModelPoses)
+    {
+      allModelPoses.emplace();
+      _ecm.Each<components::Model, components::Name, components::Pose>(
+          [&](const Entity &,
+            const components::Model *,
+            const components::Name *_name,
+            const components::Pose *_pose)->bool
+          {
+            /// todo(anyone) We currently assume there are only top level
+            /// models. Update to retrieve world pose when nested models are
+            /// supported.
+            (*allModelPoses)[_name->Data()] = _pose->Data();
+            return true;
+          });
+    }
+    return *allModelPoses;
+  };
 
   _ecm.Each<components::LogicalCamera, components::WorldPose>(
     [&](const Entity &_entity,
@@ -198,20 +276,35 @@ void LogicalCameraPrivate::UpdateLogicalCameras(
         const components::WorldPose *_worldPose)->bool
       {
         auto it = this->entitySensorMap.find(_entity);
-        if (it != this->entitySensorMap.end())
-        {
-          const math::Pose3d &worldPose = _worldPose->Data();
-          it->second->SetPose(worldPose);
-          // Make a copy of modelPoses s.t. SetModelPoses can take ownership
-          auto modelPoses_ = modelPoses;
-          it->second->SetModelPoses(std::move(modelPoses_));
-        }
-        else
+        if (it == this->entitySensorMap.end())
         {
           ignerr << "Failed to update logicalCamera: " << _entity << ". "
                  << "Entity not found." << std::endl;
+          return true;
+        }
+
+        const math::Pose3d &worldPose = _worldPose->Data();
+        std::map<std::string, math::Pose3d> modelPoses;
+        if (!this->ModelsInView(_ecm, _entity, *it->second, worldPose,
+              modelPoses))
+          modelPoses = allModels();
+
+        // Skip the sensor if neither the camera nor the models in view
+        // moved, it keeps the poses it was given last.
+        auto last = this->lastInputs.find(_entity);
+        if (last != this->lastInputs.end() &&
+            last->second.pose == worldPose &&
+            last->second.modelPoses == modelPoses)
+        {
+          return true;
         }
 
+        it->second->SetPose(worldPose);
+        auto &inputs = this->lastInputs[_entity];
+        inputs.pose = worldPose;
+        inputs.modelPoses = modelPoses;
+        it->second->SetModelPoses(std::move(modelPoses));
+
         return true;
       });
 }
@@ -234,6 +327,7 @@ void LogicalCameraPrivate::RemoveLogicalCameraEntities(
         }
 
         this->entitySensorMap.erase(sensorIt);
+        this->lastInputs.erase(_entity);
 
         return true;
       });
@@ -62,7 +62,10 @@ class ignition::gazebo::systems::MagnetometerPrivate
 
   /// \brief Update magnetometer sensor data based on physics data
   /// \param[in] _ecm Immutable reference to ECM.
-  public: void Update(const EntityComponentManager &_ecm);
+  /// \param[in] _now Current simulation time. Only the sensors which are
+  /// due are given data and updated.
+  public: void Update(const EntityComponentManager &_ecm,
+      const std::chrono::steady_clock::duration &_now);
 
   /// \brief Remove magnetometer sensors if their entities have been removed
   /// from simulation.
@@ -104,15 +107,10 @@ void Magnetometer::PostUpdate(const UpdateInfo &_info,
   // Only update and publish if not paused.
   if (!_info.paused)
   {
-    this->dataPtr->Update(_ecm);
-
-    for (auto &it : this->dataPtr->entitySensorMap)
-    {
-      // Update measurement time
-      auto time = math::durationToSecNsec(_info.simTime);
-      dynamic_cast<sensors::Sensor *>(it.second.get())->Update(
-          math::secNsecToDuration(time.first, time.second), false);
-    }
+    // Update measurement time
+    auto time = math::durationToSecNsec(_info.simTime);
+    this->dataPtr->Update(_ecm,
+        math::secNsecToDuration(time.first, time.second));
   }
 
   this->dataPtr->RemoveMagnetometerEntities(_ecm);
@@ -191,8 +189,8 @@ void MagnetometerPrivate::CreateMagnetometerEntities(
 }
 
 //////////////////////////////////////////////////
-void MagnetometerPrivate::Update(
-    const EntityComponentManager &_ecm)
+void MagnetometerPrivate::Update(const EntityComponentManager &_ecm,
+    const std::chrono::steady_clock::duration &_now)
 {
   IGN_PROFILE("MagnetometerPrivate::Update");
   _ecm.Each<components::Magnetometer,
@@ -204,9 +202,17 @@ void MagnetometerPrivate::Update(
         auto it = this->entitySensorMap.find(_entity);
         if (it != this->entitySensorMap.end())
         {
+          // Sensors which aren't due don't need any data
+          if (it->second->NextDataUpdateTime() > _now)
+            return true;
+
           // Get the magnetometer physical position
           const math::Pose3d &magnetometerWorldPose = _worldPose->Data();
           it->second->SetWorldPose(magnetometerWorldPose);
+
+          // The data and the update share a single pass over the sensors
+          static_cast<sensors::Sensor *>(it->second.get())->Update(
+              _now, false);
         }
         else
         {
@@ -40,6 +40,15 @@ namespace systems
 {
 namespace multicopter_control
 {
+  /// \brief Maximum number of rotors of a vehicle. Bounding it lets the
+  /// controller keep its rotor sized matrices inline, so a controller step
+  /// never allocates.
+  constexpr int kMaxRotorCount = 16;
+
+  /// \brief Vector with one velocity per rotor
+  using RotorVelocities = Eigen::Matrix<double, Eigen::Dynamic, 1,
+      Eigen::ColMajor, kMaxRotorCount, 1>;
+
   /// \brief Struct containing linear and angular velocities
   struct EigenTwist
   {
@@ -17,6 +17,8 @@
 
 #include "LeeVelocityController.hh"
 
+#include <ignition/common/Console.hh>
+
 namespace ignition
 {
 namespace gazebo
@@ -51,6 +53,16 @@ std::unique_ptr<LeeVelocityController> LeeVelocityController::MakeController(
 //////////////////////////////////////////////////
 bool LeeVelocityController::InitializeParameters()
 {
+  if (this->vehicleParameters.rotorConfiguration.size() >
+      static_cast<std::size_t>(kMaxRotorCount))
+  {
+    ignerr << "The vehicle has ["
+           << this->vehicleParameters.rotorConfiguration.size()
+           << "] rotors, at most [" << kMaxRotorCount << "] are supported."
+           << std::endl;
+    return false;
+  }
+
   auto allocationMatrix =
       calculateAllocationMatrix(this->vehicleParameters.rotorConfiguration);
   if (!allocationMatrix.has_value())
@@ -87,7 +99,7 @@ bool LeeVelocityController::InitializeParameters()
 //////////////////////////////////////////////////
 void LeeVelocityController::CalculateRotorVelocities(
     const FrameData &_frameData, const EigenTwist &_cmdVel,
-    Eigen::VectorXd &_rotorVelocities) const
+    RotorVelocities &_rotorVelocities) const
 {
   Eigen::Vector3d acceleration =
       this->ComputeDesiredAcceleration(_frameData, _cmdVel);
@@ -103,12 +115,11 @@ void LeeVelocityController::CalculateRotorVelocities(
   angularAccelerationThrust.block<3, 1>(0, 0) = angularAcceleration;
   angularAccelerationThrust(3) = thrust;
 
-  _rotorVelocities =
+  // The product can't alias its operands, evaluate it in place
+  _rotorVelocities.noalias() =
       this->angularAccToRotorVelocities * angularAccelerationThrust;
 
-  _rotorVelocities =
-      _rotorVelocities.cwiseMax(Eigen::VectorXd::Zero(_rotorVelocities.rows()));
-  _rotorVelocities = _rotorVelocities.cwiseSqrt();
+  _rotorVelocities = _rotorVelocities.cwiseMax(0.0).cwiseSqrt();
 }
 
 //////////////////////////////////////////////////
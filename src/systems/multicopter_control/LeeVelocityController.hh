@@ -69,7 +69,7 @@ namespace multicopter_control
     public: void CalculateRotorVelocities(
                  const FrameData &_frameData,
                  const EigenTwist &_cmdVel,
-                 Eigen::VectorXd &_rotorVelocities) const;
+                 RotorVelocities &_rotorVelocities) const;
 
     /// \brief Private constructor. Use MakeController to create an instance of
     /// this class
@@ -104,7 +104,8 @@ namespace multicopter_control
 
     /// \brief Holds the matrix that maps angular acceleration and thrust to
     /// rotor velocities
-    private: Eigen::MatrixX4d angularAccToRotorVelocities;
+    private: Eigen::Matrix<double, Eigen::Dynamic, 4, Eigen::ColMajor,
+                 kMaxRotorCount, 4> angularAccToRotorVelocities;
   };
 }  // namespace multicopter_control
 }  // namespace systems
@@ -18,7 +18,10 @@
 #include <ignition/msgs/actuators.pb.h>
 #include <ignition/msgs/twist.pb.h>
 
+#include <algorithm>
 #include <limits>
+#include <mutex>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
 
@@ -49,6 +52,102 @@ using namespace gazebo;
 using namespace systems;
 using namespace multicopter_control;
 
+/// \brief Evaluates the controller of every batched vehicle in a world in a
+/// single pass. The first batched vehicle to run in an iteration gathers the
+/// commands and frame data of all vehicles, computes all rotor velocities in
+/// one loop and then publishes them.
+class ignition::gazebo::systems::multicopter_control::VehicleBatch
+{
+  /// \brief Get the batch for an ECM, creating it if needed.
+  /// \param[in] _ecm Entity component manager of the vehicles
+  /// \return The shared batch.
+  public: static std::shared_ptr<VehicleBatch> Get(
+      const EntityComponentManager &_ecm)
+  {
+    return _ecm.SharedObject<VehicleBatch>(
+        "ignition::gazebo::systems::multicopter_control::VehicleBatch");
+  }
+
+  /// \brief Add a vehicle to the batch.
+  /// \param[in] _vehicle Vehicle to add
+  public: void Add(MulticopterVelocityControl *_vehicle)
+  {
+    this->vehicles.push_back(_vehicle);
+    this->slots.reserve(this->vehicles.size());
+  }
+
+  /// \brief Remove a vehicle from the batch.
+  /// \param[in] _vehicle Vehicle to remove
+  public: void Remove(const MulticopterVelocityControl *_vehicle)
+  {
+    this->vehicles.erase(std::remove(this->vehicles.begin(),
+        this->vehicles.end(), _vehicle), this->vehicles.end());
+  }
+
+  /// \brief Update the rotor velocities of all vehicles. Only the first call
+  /// of each iteration does any work. Not to be called while paused.
+  /// \param[in] _info Update info
+  /// \param[in] _ecm Entity component manager
+  public: void Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
+  {
+    if (this->lastIteration == _info.iterations)
+      return;
+    this->lastIteration = _info.iterations;
+
+    IGN_PROFILE("VehicleBatch::Update");
+    this->slots.clear();
+    for (auto *vehicle : this->vehicles)
+    {
+      Slot slot;
+      slot.vehicle = vehicle;
+      if (vehicle->ControllerInputs(_ecm, slot.cmdVel, slot.frameData))
+        this->slots.push_back(slot);
+    }
+
+    for (auto &slot : this->slots)
+    {
+      slot.vehicle->velocityController->CalculateRotorVelocities(
+          slot.frameData, slot.cmdVel, slot.vehicle->rotorVelocities);
+    }
+
+    for (const auto &slot : this->slots)
+    {
+      slot.vehicle->PublishRotorVelocities(_ecm,
+          slot.vehicle->rotorVelocities);
+    }
+  }
+
+  /// \brief Inputs of a vehicle whose rotor velocities are computed this
+  /// iteration
+  private: struct Slot
+  {
+    /// \brief Vehicle
+    MulticopterVelocityControl *vehicle;
+
+    /// \brief Clipped velocity command
+    EigenTwist cmdVel;
+
+    /// \brief Frame data of the center of mass link
+    FrameData frameData;
+  };
+
+  /// \brief All batched vehicles
+  private: std::vector<MulticopterVelocityControl *> vehicles;
+
+  /// \brief Vehicles gathered this iteration
+  private: std::vector<Slot> slots;
+
+  /// \brief Iteration the batch was last updated
+  private: uint64_t lastIteration{0};
+};
+
+//////////////////////////////////////////////////
+MulticopterVelocityControl::~MulticopterVelocityControl()
+{
+  if (this->batch)
+    this->batch->Remove(this);
+}
+
 //////////////////////////////////////////////////
 void MulticopterVelocityControl::Configure(const Entity &_entity,
     const std::shared_ptr<const sdf::Element> &_sdf,
@@ -130,6 +229,15 @@ void MulticopterVelocityControl::Configure(const Entity &_entity,
     ignerr << "Please specify rotorConfiguration.\n";
   }
 
+  if (vehicleParams.rotorConfiguration.size() >
+      static_cast<std::size_t>(kMaxRotorCount))
+  {
+    ignerr << "Found [" << vehicleParams.rotorConfiguration.size()
+           << "] rotors, at most [" << kMaxRotorCount << "] are supported. "
+           << "Failed to initialize." << std::endl;
+    return;
+  }
+
   this->rotorVelocities.resize(vehicleParams.rotorConfiguration.size());
 
   auto worldEntity = _ecm.EntityByComponents(components::World());
@@ -315,6 +423,12 @@ void MulticopterVelocityControl::Configure(const Entity &_entity,
   _ecm.CreateComponent(this->model.Entity(),
                        components::Actuators(this->rotorVelocitiesMsg));
 
+  if (sdfClone->Get<bool>("batch", false).first)
+  {
+    this->batch = VehicleBatch::Get(_ecm);
+    this->batch->Add(this);
+  }
+
   this->initialized = true;
 }
 
@@ -344,6 +458,29 @@ void MulticopterVelocityControl::PreUpdate(
     return;
   }
 
+  // Batched vehicles are updated together by the first of them to run
+  if (this->batch)
+  {
+    this->batch->Update(_info, _ecm);
+    return;
+  }
+
+  EigenTwist cmdVel;
+  FrameData frameData;
+  if (!this->ControllerInputs(_ecm, cmdVel, frameData))
+    return;
+
+  this->velocityController->CalculateRotorVelocities(frameData, cmdVel,
+                                                     this->rotorVelocities);
+
+  this->PublishRotorVelocities(_ecm, this->rotorVelocities);
+}
+
+//////////////////////////////////////////////////
+bool MulticopterVelocityControl::ControllerInputs(
+    ignition::gazebo::EntityComponentManager &_ecm,
+    EigenTwist &_cmdVel, FrameData &_frameData)
+{
   if (!this->controllerActive)
   {
     // If the last published rotor velocities were not 0, publish zero
@@ -357,15 +494,14 @@ void MulticopterVelocityControl::PreUpdate(
       std::lock_guard<std::mutex> lock(this->cmdVelMsgMutex);
       this->cmdVelMsg.reset();
     }
-    return;
+    return false;
   }
 
-  EigenTwist cmdVel;
   {
     std::lock_guard<std::mutex> lock(this->cmdVelMsgMutex);
     if (!this->cmdVelMsg.has_value())
     {
-      return;
+      return false;
     }
 
     // Clip with max linear velocity
@@ -377,8 +513,8 @@ void MulticopterVelocityControl::PreUpdate(
     angular.Min(this->maximumAngularVelocity);
     angular.Max(-this->maximumAngularVelocity);
 
-    cmdVel.linear = math::eigen3::convert(linear);
-    cmdVel.angular = math::eigen3::convert(angular);
+    _cmdVel.linear = math::eigen3::convert(linear);
+    _cmdVel.angular = math::eigen3::convert(angular);
   }
 
   std::optional<FrameData> frameData =
@@ -386,13 +522,11 @@ void MulticopterVelocityControl::PreUpdate(
   if (!frameData.has_value())
   {
     // Errors would have already been printed
-    return;
+    return false;
   }
 
-  this->velocityController->CalculateRotorVelocities(*frameData, cmdVel,
-                                                     this->rotorVelocities);
-
-  this->PublishRotorVelocities(_ecm, this->rotorVelocities);
+  _frameData = *frameData;
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -413,7 +547,7 @@ void MulticopterVelocityControl::OnEnable(
 //////////////////////////////////////////////////
 void MulticopterVelocityControl::PublishRotorVelocities(
     ignition::gazebo::EntityComponentManager &_ecm,
-    const Eigen::VectorXd &_vels)
+    const RotorVelocities &_vels)
 {
   if (_vels.size() != this->rotorVelocitiesMsg.velocity_size())
   {
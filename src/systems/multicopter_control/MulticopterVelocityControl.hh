@@ -38,6 +38,12 @@ namespace gazebo
 inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
 namespace systems
 {
+namespace multicopter_control
+{
+  // Forward declaration
+  class VehicleBatch;
+}
+
   /// \brief This is a velocity controller for multicopters that allows control
   /// over the linear velocity and the yaw angular velocity of the vehicle. The
   /// velocities are expressed in the body frame of the vehicle. A vehicle with
@@ -143,6 +149,10 @@ namespace systems
   ///      direction: Direction of rotation of the rotor. +1 is counterclockwise
   ///      and -1 is clockwise.
   ///
+  /// batch: Evaluate the controller together with the controllers of all
+  /// other batched vehicles of the world, in a single pass, instead of on its
+  /// own. The results are the same. The default value is false.
+  ///
   /// # Examples
   /// See examples/worlds/quadcopter.sdf for a demonstration.
   ///
@@ -154,6 +164,9 @@ namespace systems
     /// \brief Constructor
     public: MulticopterVelocityControl() = default;
 
+    /// \brief Destructor, leaves the vehicle batch
+    public: ~MulticopterVelocityControl() override;
+
     // Documentation inherited
     public: void Configure(const Entity &_entity,
                            const std::shared_ptr<const sdf::Element> &_sdf,
@@ -183,7 +196,22 @@ namespace systems
     /// \param[in] _vels Rotor velocities to be published
     private: void PublishRotorVelocities(
                  ignition::gazebo::EntityComponentManager &_ecm,
-                 const Eigen::VectorXd &_vels);
+                 const multicopter_control::RotorVelocities &_vels);
+
+    /// \brief Get the clipped velocity command and the frame data to compute
+    /// rotor velocities from. Stops the rotors if the controller was
+    /// disabled.
+    /// \param[in] _ecm Mutable reference to the EntityComponentManager
+    /// \param[out] _cmdVel Commanded velocity
+    /// \param[out] _frameData Frame data of the center of mass link
+    /// \return True if rotor velocities should be computed.
+    private: bool ControllerInputs(
+                 ignition::gazebo::EntityComponentManager &_ecm,
+                 multicopter_control::EigenTwist &_cmdVel,
+                 multicopter_control::FrameData &_frameData);
+
+    // The batch updates the controller of every batched vehicle
+    friend class multicopter_control::VehicleBatch;
 
     /// \brief Model interface
     private: Model model{kNullEntity};
@@ -208,7 +236,7 @@ namespace systems
 
     /// \brief Holds the rotor velocities computed by the controller. This is
     /// here so we don't need to allocate memory every simulation step.
-    private: Eigen::VectorXd rotorVelocities;
+    private: multicopter_control::RotorVelocities rotorVelocities;
 
     /// \brief Velocity controller
     private: std::unique_ptr<multicopter_control::LeeVelocityController>
@@ -240,6 +268,10 @@ namespace systems
 
     /// \brief Whether the controller is active
     private: std::atomic<bool> controllerActive{true};
+
+    /// \brief Batch evaluating this controller together with the
+    /// controllers of all other batched vehicles, null if not batched.
+    private: std::shared_ptr<multicopter_control::VehicleBatch> batch;
   };
   }
 }
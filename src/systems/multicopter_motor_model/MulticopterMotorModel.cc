@@ -23,8 +23,13 @@
 
 #include "MulticopterMotorModel.hh"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
 
@@ -40,6 +45,7 @@
 
 #include "ignition/gazebo/components/Actuators.hh"
 #include "ignition/gazebo/components/ExternalWorldWrenchCmd.hh"
+#include "ignition/gazebo/components/Inertial.hh"
 #include "ignition/gazebo/components/JointAxis.hh"
 #include "ignition/gazebo/components/JointVelocity.hh"
 #include "ignition/gazebo/components/JointVelocityCmd.hh"
@@ -115,11 +121,32 @@ enum class MotorType {
   kForce
 };
 
+namespace
+{
+class RotorBatch;
+}
+
 class ignition::gazebo::systems::MulticopterMotorModelPrivate
 {
+  /// \brief Destructor, leaves the rotor batch
+  public: ~MulticopterMotorModelPrivate();
+
   /// \brief Callback for actuator commands.
   public: void OnActuatorMsg(const ignition::msgs::Actuators &_msg);
 
+  /// \brief Look up the joint and links if needed and create the
+  /// components the motor model reads.
+  /// \param[in] _ecm Entity component manager
+  /// \return True if every entity and component needed to update forces and
+  /// moments is available.
+  public: bool Prepare(EntityComponentManager &_ecm);
+
+  /// \brief Update the reference motor input from the latest actuator
+  /// command, if any.
+  /// \param[in] _ecm Entity component manager
+  /// \return False if the command doesn't hold this motor's index.
+  public: bool UpdateCommand(const EntityComponentManager &_ecm);
+
   /// \brief Apply link forces and moments based on propeller state.
   public: void UpdateForcesAndMoments(EntityComponentManager &_ecm);
 
@@ -216,8 +243,329 @@ class ignition::gazebo::systems::MulticopterMotorModelPrivate
 
   /// \brief Ignition communication node.
   public: transport::Node node;
+
+  /// \brief Batch evaluating this rotor together with all other batched
+  /// rotors in the world, null if the rotor is evaluated on its own.
+  public: std::shared_ptr<RotorBatch> batch;
 };
 
+namespace
+{
+/// \brief Evaluates the motor model of every batched rotor in a world in a
+/// single pass. The first batched rotor to run in an iteration gathers the
+/// state of all rotors into contiguous arrays, computes thrust, drag and
+/// moments over those arrays in one loop the compiler can vectorize, and
+/// writes the resulting wrenches back.
+class RotorBatch
+{
+  /// \brief Get the batch for an ECM, creating it if needed.
+  /// \param[in] _ecm Entity component manager of the rotors
+  /// \return The shared batch.
+  public: static std::shared_ptr<RotorBatch> Get(
+      const EntityComponentManager &_ecm)
+  {
+    return _ecm.SharedObject<RotorBatch>(
+        "ignition::gazebo::systems::RotorBatch");
+  }
+
+  /// \brief Add a rotor to the batch.
+  /// \param[in] _rotor Rotor to add
+  public: void Add(MulticopterMotorModelPrivate *_rotor)
+  {
+    this->rotors.push_back(_rotor);
+  }
+
+  /// \brief Remove a rotor from the batch.
+  /// \param[in] _rotor Rotor to remove
+  public: void Remove(const MulticopterMotorModelPrivate *_rotor)
+  {
+    this->rotors.erase(std::remove(this->rotors.begin(), this->rotors.end(),
+        _rotor), this->rotors.end());
+  }
+
+  /// \brief Update forces and moments of all rotors. Only the first call of
+  /// each iteration does any work. Not to be called while paused.
+  /// \param[in] _info Update info
+  /// \param[in] _ecm Entity component manager
+  public: void Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
+  {
+    if (this->lastIteration == _info.iterations)
+      return;
+    this->lastIteration = _info.iterations;
+
+    IGN_PROFILE("RotorBatch::Update");
+    this->Gather(_info, _ecm);
+    if (this->slots.empty())
+      return;
+    this->Compute();
+    this->Scatter(_ecm);
+  }
+
+  /// \brief Prepare every rotor and copy the state of the ones that can be
+  /// updated into the arrays.
+  /// \param[in] _info Update info
+  /// \param[in] _ecm Entity component manager
+  private: void Gather(const UpdateInfo &_info, EntityComponentManager &_ecm)
+  {
+    IGN_PROFILE("RotorBatch::Gather");
+    this->slots.clear();
+    this->vel.clear();
+    this->coef.clear();
+    for (auto &v : this->vec)
+      v.clear();
+
+    // All rotors share the wind, look it up once per iteration
+    if (this->windEntity == kNullEntity)
+      this->windEntity = _ecm.EntityByComponents(components::Wind());
+    math::Vector3d windVel;
+    auto windComp =
+        _ecm.Component<components::WorldLinearVelocity>(this->windEntity);
+    if (windComp)
+      windVel = windComp->Data();
+
+    const double dt = std::chrono::duration<double>(_info.dt).count();
+    for (auto *rotor : this->rotors)
+    {
+      if (!rotor->Prepare(_ecm))
+        continue;
+
+      rotor->samplingTime = dt;
+      if (!rotor->UpdateCommand(_ecm) ||
+          rotor->motorType != MotorType::kVelocity)
+      {
+        continue;
+      }
+
+      const auto jointPose =
+          _ecm.Component<components::Pose>(rotor->jointEntity);
+      const auto jointAxis =
+          _ecm.Component<components::JointAxis>(rotor->jointEntity);
+      if (!jointPose || !jointAxis)
+      {
+        ignerr << "joint " << rotor->jointName << " has no Pose or "
+               << "JointAxis component" << std::endl;
+        continue;
+      }
+
+      double motorRotVel = _ecm.Component<components::JointVelocity>(
+          rotor->jointEntity)->Data()[0];
+      if (motorRotVel / (2 * IGN_PI) > 1 / (2 * rotor->samplingTime))
+      {
+        ignerr << "Aliasing on motor [" << rotor->motorNumber
+              << "] might occur. Consider making smaller simulation time "
+                 "steps or raising the rotorVelocitySlowdownSim param.\n";
+      }
+
+      const auto &worldPose = _ecm.Component<components::WorldPose>(
+          rotor->linkEntity)->Data();
+      const auto &parentWorldPose = _ecm.Component<components::WorldPose>(
+          rotor->parentLinkEntity)->Data();
+      const auto &linkVel = _ecm.Component<components::WorldLinearVelocity>(
+          rotor->linkEntity)->Data();
+
+      // Forces are applied at the link's center of mass, so they also
+      // produce a torque about the link origin. Links without inertial
+      // don't get forces, like with Link::AddWorldForce.
+      const auto inertial =
+          _ecm.Component<components::Inertial>(rotor->linkEntity);
+      math::Vector3d comOffset;
+      if (inertial)
+      {
+        comOffset =
+            worldPose.Rot().RotateVector(inertial->Data().Pose().Pos());
+      }
+
+      math::Vector3d thrustDir =
+          worldPose.Rot().RotateVector(math::Vector3d::UnitZ);
+      math::Vector3d axis = (worldPose * jointPose->Data()).Rot()
+          .RotateVector(jointAxis->Data().Xyz());
+      math::Vector3d relWind = linkVel - windVel;
+      // World direction of the drag torque, see UpdateForcesAndMoments
+      math::Pose3d poseDifference = worldPose - parentWorldPose;
+      math::Vector3d dragDir = parentWorldPose.Rot().RotateVector(
+          poseDifference.Rot().RotateVector(math::Vector3d::UnitZ));
+
+      this->slots.push_back({rotor, inertial != nullptr});
+      this->vel.push_back(motorRotVel * rotor->rotorVelocitySlowdownSim);
+      this->coef.push_back({static_cast<double>(rotor->turningDirection),
+          rotor->motorConstant, rotor->momentConstant,
+          rotor->rotorDragCoefficient, rotor->rollingMomentCoefficient});
+      const math::Vector3d *inputs[kInputs] =
+          {&thrustDir, &axis, &relWind, &dragDir, &comOffset};
+      for (int v = 0; v < kInputs; ++v)
+      {
+        for (int c = 0; c < 3; ++c)
+          this->vec[v * 3 + c].push_back((*inputs[v])[c]);
+      }
+    }
+  }
+
+  /// \brief Compute the wrenches of all gathered rotors.
+  private: void Compute()
+  {
+    IGN_PROFILE("RotorBatch::Compute");
+    const std::size_t n = this->vel.size();
+    for (int c = kInputs * 3; c < kVectors * 3; ++c)
+      this->vec[c].resize(n);
+
+    const double *tx = this->vec[0].data();
+    const double *ty = this->vec[1].data();
+    const double *tz = this->vec[2].data();
+    const double *ax = this->vec[3].data();
+    const double *ay = this->vec[4].data();
+    const double *az = this->vec[5].data();
+    const double *wx = this->vec[6].data();
+    const double *wy = this->vec[7].data();
+    const double *wz = this->vec[8].data();
+    const double *dx = this->vec[9].data();
+    const double *dy = this->vec[10].data();
+    const double *dz = this->vec[11].data();
+    const double *cx = this->vec[12].data();
+    const double *cy = this->vec[13].data();
+    const double *cz = this->vec[14].data();
+    double *fx = this->vec[15].data();
+    double *fy = this->vec[16].data();
+    double *fz = this->vec[17].data();
+    double *lx = this->vec[18].data();
+    double *ly = this->vec[19].data();
+    double *lz = this->vec[20].data();
+    double *px = this->vec[21].data();
+    double *py = this->vec[22].data();
+    double *pz = this->vec[23].data();
+    const double *realVel = this->vel.data();
+    const Coefficients *k = this->coef.data();
+
+    // Same model as UpdateForcesAndMoments, without branches and over plain
+    // arrays
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      const double v = realVel[i];
+      const double absV = std::abs(v);
+      // Assuming symmetric propellers, sign(v) * v^2
+      const double thrust = k[i].direction * v * absV * k[i].motor;
+
+      // Relative wind velocity perpendicular to the rotor axis
+      const double along = wx[i] * ax[i] + wy[i] * ay[i] + wz[i] * az[i];
+      const double perpX = wx[i] - along * ax[i];
+      const double perpY = wy[i] - along * ay[i];
+      const double perpZ = wz[i] - along * az[i];
+
+      // Thrust plus air drag on the rotor link
+      const double drag = -absV * k[i].drag;
+      fx[i] = thrust * tx[i] + drag * perpX;
+      fy[i] = thrust * ty[i] + drag * perpY;
+      fz[i] = thrust * tz[i] + drag * perpZ;
+
+      // Torque of that force about the link origin
+      lx[i] = cy[i] * fz[i] - cz[i] * fy[i];
+      ly[i] = cz[i] * fx[i] - cx[i] * fz[i];
+      lz[i] = cx[i] * fy[i] - cy[i] * fx[i];
+
+      // Drag torque plus rolling moment on the parent link
+      const double dragTorque = -k[i].direction * thrust * k[i].moment;
+      const double rolling = -absV * k[i].rolling;
+      px[i] = dragTorque * dx[i] + rolling * perpX;
+      py[i] = dragTorque * dy[i] + rolling * perpY;
+      pz[i] = dragTorque * dz[i] + rolling * perpZ;
+    }
+  }
+
+  /// \brief Add the computed wrenches to the links and command the joints.
+  /// \param[in] _ecm Entity component manager
+  private: void Scatter(EntityComponentManager &_ecm)
+  {
+    IGN_PROFILE("RotorBatch::Scatter");
+    for (std::size_t i = 0; i < this->slots.size(); ++i)
+    {
+      auto output = [this, i](int _v)
+      {
+        const int c = (kInputs + _v) * 3;
+        return math::Vector3d(this->vec[c][i], this->vec[c + 1][i],
+            this->vec[c + 2][i]);
+      };
+
+      auto *rotor = this->slots[i].rotor;
+      if (this->slots[i].hasInertial)
+        Link(rotor->linkEntity).AddWorldWrench(_ecm, output(0), output(1));
+      Link(rotor->parentLinkEntity).AddWorldWrench(_ecm,
+          math::Vector3d::Zero, output(2));
+
+      // Apply the filter on the motor's velocity.
+      double refMotorRotVel = rotor->rotorVelocityFilter->UpdateFilter(
+          rotor->refMotorInput, rotor->samplingTime);
+      *_ecm.Component<components::JointVelocityCmd>(rotor->jointEntity) =
+          components::JointVelocityCmd({rotor->turningDirection *
+          refMotorRotVel / rotor->rotorVelocitySlowdownSim});
+    }
+  }
+
+  /// \brief Per rotor constants used by the model
+  private: struct Coefficients
+  {
+    /// \brief Turning direction, 1 or -1
+    double direction;
+
+    /// \brief Thrust coefficient
+    double motor;
+
+    /// \brief Moment constant
+    double moment;
+
+    /// \brief Rotor drag coefficient
+    double drag;
+
+    /// \brief Rolling moment coefficient
+    double rolling;
+  };
+
+  /// \brief Rotor gathered in an iteration
+  private: struct Slot
+  {
+    /// \brief The rotor
+    MulticopterMotorModelPrivate *rotor;
+
+    /// \brief Whether the rotor link has an inertial to apply forces to
+    bool hasInertial;
+  };
+
+  /// \brief Number of input vectors: thrust direction, rotor axis, relative
+  /// wind velocity, drag torque direction and center of mass offset
+  private: static constexpr int kInputs{5};
+
+  /// \brief Number of vectors, the inputs followed by the link force, link
+  /// torque and parent link torque
+  private: static constexpr int kVectors{kInputs + 3};
+
+  /// \brief All batched rotors
+  private: std::vector<MulticopterMotorModelPrivate *> rotors;
+
+  /// \brief Rotors gathered this iteration
+  private: std::vector<Slot> slots;
+
+  /// \brief Real motor velocity of each gathered rotor
+  private: std::vector<double> vel;
+
+  /// \brief Constants of each gathered rotor
+  private: std::vector<Coefficients> coef;
+
+  /// \brief One array per vector component, see kInputs and kVectors
+  private: std::vector<double> vec[kVectors * 3];
+
+  /// \brief Wind entity
+  private: Entity windEntity{kNullEntity};
+
+  /// \brief Last iteration that was evaluated
+  private: uint64_t lastIteration{0};
+};
+}
+
+//////////////////////////////////////////////////
+MulticopterMotorModelPrivate::~MulticopterMotorModelPrivate()
+{
+  if (this->batch)
+    this->batch->Remove(this);
+}
+
 //////////////////////////////////////////////////
 MulticopterMotorModel::MulticopterMotorModel()
   : dataPtr(std::make_unique<MulticopterMotorModelPrivate>())
@@ -367,6 +715,12 @@ void MulticopterMotorModel::Configure(const Entity &_entity,
   }
   this->dataPtr->node.Subscribe(topic,
       &MulticopterMotorModelPrivate::OnActuatorMsg, this->dataPtr.get());
+
+  if (sdfClone->Get<bool>("batch", false).first)
+  {
+    this->dataPtr->batch = RotorBatch::Get(_ecm);
+    this->dataPtr->batch->Add(this->dataPtr.get());
+  }
 }
 
 //////////////////////////////////////////////////
@@ -383,88 +737,102 @@ void MulticopterMotorModel::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
         << "s]. System may not work properly." << std::endl;
   }
 
+  // Batched rotors are prepared and updated together, but components still
+  // need to be created while paused
+  if (this->dataPtr->batch)
+  {
+    if (_info.paused)
+      this->dataPtr->Prepare(_ecm);
+    else
+      this->dataPtr->batch->Update(_info, _ecm);
+    return;
+  }
+
+  // skip UpdateForcesAndMoments if needed components are missing
+  bool doUpdateForcesAndMoments = this->dataPtr->Prepare(_ecm);
+
+  // Nothing left to do if paused.
+  if (_info.paused)
+    return;
+
+  this->dataPtr->samplingTime =
+    std::chrono::duration<double>(_info.dt).count();
+  if (doUpdateForcesAndMoments)
+  {
+    this->dataPtr->UpdateForcesAndMoments(_ecm);
+  }
+}
+
+//////////////////////////////////////////////////
+bool MulticopterMotorModelPrivate::Prepare(EntityComponentManager &_ecm)
+{
   // If the joint or links haven't been identified yet, look for them
-  if (this->dataPtr->jointEntity == kNullEntity)
+  if (this->jointEntity == kNullEntity)
   {
-    this->dataPtr->jointEntity =
-        this->dataPtr->model.JointByName(_ecm, this->dataPtr->jointName);
+    this->jointEntity = this->model.JointByName(_ecm, this->jointName);
 
-    const auto parentLinkName = _ecm.Component<components::ParentLinkName>(
-        this->dataPtr->jointEntity);
-    this->dataPtr->parentLinkName = parentLinkName->Data();
+    const auto parentLinkNameComp =
+        _ecm.Component<components::ParentLinkName>(this->jointEntity);
+    if (parentLinkNameComp)
+      this->parentLinkName = parentLinkNameComp->Data();
   }
 
-  if (this->dataPtr->linkEntity == kNullEntity)
+  if (this->linkEntity == kNullEntity)
   {
-    this->dataPtr->linkEntity =
-        this->dataPtr->model.LinkByName(_ecm, this->dataPtr->linkName);
+    this->linkEntity = this->model.LinkByName(_ecm, this->linkName);
   }
 
-  if (this->dataPtr->parentLinkEntity == kNullEntity)
+  if (this->parentLinkEntity == kNullEntity)
   {
-    this->dataPtr->parentLinkEntity =
-        this->dataPtr->model.LinkByName(_ecm, this->dataPtr->parentLinkName);
+    this->parentLinkEntity =
+        this->model.LinkByName(_ecm, this->parentLinkName);
   }
 
-  if (this->dataPtr->jointEntity == kNullEntity ||
-      this->dataPtr->linkEntity == kNullEntity ||
-      this->dataPtr->parentLinkEntity == kNullEntity)
-    return;
+  if (this->jointEntity == kNullEntity ||
+      this->linkEntity == kNullEntity ||
+      this->parentLinkEntity == kNullEntity)
+    return false;
 
-  // skip UpdateForcesAndMoments if needed components are missing
-  bool doUpdateForcesAndMoments = true;
+  bool ready = true;
 
   const auto jointVelocity = _ecm.Component<components::JointVelocity>(
-      this->dataPtr->jointEntity);
+      this->jointEntity);
   if (!jointVelocity)
   {
-    _ecm.CreateComponent(this->dataPtr->jointEntity,
-        components::JointVelocity());
-    doUpdateForcesAndMoments = false;
+    _ecm.CreateComponent(this->jointEntity, components::JointVelocity());
+    ready = false;
   }
   else if (jointVelocity->Data().empty())
   {
-    doUpdateForcesAndMoments = false;
+    ready = false;
   }
 
-  if (!_ecm.Component<components::JointVelocityCmd>(
-      this->dataPtr->jointEntity))
+  if (!_ecm.Component<components::JointVelocityCmd>(this->jointEntity))
   {
-    _ecm.CreateComponent(this->dataPtr->jointEntity,
+    _ecm.CreateComponent(this->jointEntity,
         components::JointVelocityCmd({0}));
-    doUpdateForcesAndMoments = false;
+    ready = false;
   }
 
-  if (!_ecm.Component<components::WorldPose>(this->dataPtr->linkEntity))
+  if (!_ecm.Component<components::WorldPose>(this->linkEntity))
   {
-    _ecm.CreateComponent(this->dataPtr->linkEntity, components::WorldPose());
-    doUpdateForcesAndMoments = false;
+    _ecm.CreateComponent(this->linkEntity, components::WorldPose());
+    ready = false;
   }
-  if (!_ecm.Component<components::WorldLinearVelocity>(
-      this->dataPtr->linkEntity))
+  if (!_ecm.Component<components::WorldLinearVelocity>(this->linkEntity))
   {
-    _ecm.CreateComponent(this->dataPtr->linkEntity,
+    _ecm.CreateComponent(this->linkEntity,
         components::WorldLinearVelocity());
-    doUpdateForcesAndMoments = false;
+    ready = false;
   }
 
-  if (!_ecm.Component<components::WorldPose>(this->dataPtr->parentLinkEntity))
+  if (!_ecm.Component<components::WorldPose>(this->parentLinkEntity))
   {
-    _ecm.CreateComponent(this->dataPtr->parentLinkEntity,
-        components::WorldPose());
-    doUpdateForcesAndMoments = false;
+    _ecm.CreateComponent(this->parentLinkEntity, components::WorldPose());
+    ready = false;
   }
 
-  // Nothing left to do if paused.
-  if (_info.paused)
-    return;
-
-  this->dataPtr->samplingTime =
-    std::chrono::duration<double>(_info.dt).count();
-  if (doUpdateForcesAndMoments)
-  {
-    this->dataPtr->UpdateForcesAndMoments(_ecm);
-  }
+  return ready;
 }
 
 //////////////////////////////////////////////////
@@ -476,11 +844,9 @@ void MulticopterMotorModelPrivate::OnActuatorMsg(
 }
 
 //////////////////////////////////////////////////
-void MulticopterMotorModelPrivate::UpdateForcesAndMoments(
-    EntityComponentManager &_ecm)
+bool MulticopterMotorModelPrivate::UpdateCommand(
+    const EntityComponentManager &_ecm)
 {
-  IGN_PROFILE("MulticopterMotorModelPrivate::UpdateForcesAndMoments");
-
   std::optional<msgs::Actuators> msg;
   auto actuatorMsgComp =
       _ecm.Component<components::Actuators>(this->model.Entity());
@@ -508,7 +874,7 @@ void MulticopterMotorModelPrivate::UpdateForcesAndMoments(
       ignerr << "You tried to access index " << this->motorNumber
         << " of the Actuator velocity array which is of size "
         << msg->velocity_size() << std::endl;
-      return;
+      return false;
     }
 
     if (this->motorType == MotorType::kVelocity)
@@ -524,6 +890,18 @@ void MulticopterMotorModelPrivate::UpdateForcesAndMoments(
     }
   }
 
+  return true;
+}
+
+//////////////////////////////////////////////////
+void MulticopterMotorModelPrivate::UpdateForcesAndMoments(
+    EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("MulticopterMotorModelPrivate::UpdateForcesAndMoments");
+
+  if (!this->UpdateCommand(_ecm))
+    return;
+
   switch (this->motorType)
   {
     case (MotorType::kPosition):
@@ -33,6 +33,12 @@ namespace systems
 
   /// \brief This system applies a thrust force to models with spinning
   /// propellers. See examples/worlds/quadcopter.sdf for a demonstration.
+  ///
+  /// Set `<batch>` to true to evaluate the rotor together with every other
+  /// batched rotor in the world. The first batched rotor to update in an
+  /// iteration computes the thrust, drag and moments of all of them in a
+  /// single pass, which removes most of the per rotor overhead in worlds
+  /// with many vehicles. Defaults to false.
   class MulticopterMotorModel
       : public System,
         public ISystemConfigure,
@@ -70,7 +70,8 @@ class ignition::gazebo::systems::OpticalTactilePluginPrivate
   /// of the image, pointing rightwards
   /// \param[in] _j Vertical camera coordinate defined in the top-left corner
   /// of the image, pointing downwards
-  /// \param[in] _msgBuffer Buffer with the point cloud data
+  /// \param[in] _msgBuffer Buffer with the point cloud data, laid out as
+  /// described by the cached point cloud layout
   /// \returns The corresponding (X,Y,Z) point
   public: ignition::math::Vector3f MapPointCloudData(const uint64_t &_i,
     const uint64_t &_j, const char *_msgBuffer);
@@ -141,6 +142,24 @@ class ignition::gazebo::systems::OpticalTactilePluginPrivate
   /// \brief Message returned by the depth camera
   public: ignition::msgs::PointCloudPacked cameraMsg;
 
+  /// \brief Message being processed, swapped with cameraMsg so the camera
+  /// callback isn't blocked while normal forces are computed.
+  public: ignition::msgs::PointCloudPacked processedMsg;
+
+  /// \brief Layout of the point cloud being processed, read once per message
+  /// instead of for every point.
+  public: struct
+  {
+    /// \brief Bytes between consecutive rows
+    uint32_t rowStep{0};
+
+    /// \brief Bytes between consecutive points
+    uint32_t pointStep{0};
+
+    /// \brief Offsets of the X, Y and Z fields within a point
+    uint32_t offsets[3]{0, 0, 0};
+  } cloudLayout;
+
   /// \brief Mutex for variables mutated by the camera callback.
   /// The variables are: newCameraMsg, cameraMsg.
   public: std::mutex serviceMutex;
@@ -337,15 +356,25 @@ void OpticalTactilePlugin::PostUpdate(
 
   // TODO(anyone) Get ContactSensor data and merge it with DepthCamera data
 
-  // Process camera message if it's new
+  // Process camera message if it's new. The normal forces are only used for
+  // visualization for now, so skip them altogether when it's off.
+  if (this->dataPtr->visualizeForces)
   {
-    std::lock_guard<std::mutex> lock(this->dataPtr->serviceMutex);
-    if (this->dataPtr->newCameraMsg)
+    bool newCameraMsg{false};
     {
-      this->dataPtr->ComputeNormalForces(this->dataPtr->cameraMsg,
-        this->dataPtr->visualizeForces);
+      std::lock_guard<std::mutex> lock(this->dataPtr->serviceMutex);
+      newCameraMsg = this->dataPtr->newCameraMsg;
+      if (newCameraMsg)
+      {
+        this->dataPtr->processedMsg.Swap(&this->dataPtr->cameraMsg);
+        this->dataPtr->newCameraMsg = false;
+      }
+    }
 
-      this->dataPtr->newCameraMsg = false;
+    if (newCameraMsg)
+    {
+      this->dataPtr->ComputeNormalForces(this->dataPtr->processedMsg,
+        this->dataPtr->visualizeForces);
     }
   }
 
@@ -538,6 +567,10 @@ void OpticalTactilePluginPrivate::DepthCameraCallback(
   if (!this->initialized)
     return;
 
+  // Nothing consumes the image when forces aren't visualized, don't copy it
+  if (!this->visualizeForces)
+    return;
+
   // Check whether DepthCamera returns FLOAT32 data
   if (this->checkDepthCameraData)
   {
@@ -578,21 +611,20 @@ ignition::math::Vector3f OpticalTactilePluginPrivate::MapPointCloudData(
 
   // Number of bytes from the beginning of the pointer (image coordinates at
   // 0,0) to the desired (i,j) position
-  uint32_t msgBufferIndex =
-    _j*this->cameraMsg.row_step() + _i*this->cameraMsg.point_step();
+  uint64_t msgBufferIndex =
+    _j*this->cloudLayout.rowStep + _i*this->cloudLayout.pointStep;
 
   temporaryMsgBuffer += msgBufferIndex;
-  int fieldIndex = 0;
 
   // X coordinate
   measuredPoint.X() = *reinterpret_cast<const float *>(
-    temporaryMsgBuffer + this->cameraMsg.field(fieldIndex++).offset());
+    temporaryMsgBuffer + this->cloudLayout.offsets[0]);
   // Y coordinate
   measuredPoint.Y() = *reinterpret_cast<const float *>(
-    temporaryMsgBuffer + this->cameraMsg.field(fieldIndex++).offset());
+    temporaryMsgBuffer + this->cloudLayout.offsets[1]);
   // Z coordinate
   measuredPoint.Z() = *reinterpret_cast<const float *>(
-    temporaryMsgBuffer + this->cameraMsg.field(fieldIndex).offset());
+    temporaryMsgBuffer + this->cloudLayout.offsets[2]);
 
   // Check if point is inside the sensor
   bool pointInside = this->PointInsideSensor(measuredPoint);
@@ -646,6 +678,22 @@ void OpticalTactilePluginPrivate::ComputeNormalForces(
   if (!this->initialized)
     return;
 
+  // The X, Y and Z fields are expected to be the first three
+  if (_msg.field_size() < 3 || _msg.width() < 3 || _msg.height() < 3)
+    return;
+
+  if (_msg.data().size() < static_cast<size_t>(_msg.height()) * _msg.row_step())
+  {
+    ignerr << "Point cloud data is smaller than its dimensions" << std::endl;
+    return;
+  }
+
+  // Read the layout once for the whole image
+  this->cloudLayout.rowStep = _msg.row_step();
+  this->cloudLayout.pointStep = _msg.point_step();
+  for (int f = 0; f < 3; ++f)
+    this->cloudLayout.offsets[f] = _msg.field(f).offset();
+
   // Get data from the message
   const char *msgBuffer = _msg.data().data();
 
@@ -51,8 +51,8 @@ namespace systems
     /// The default value is 30
     ///
     /// <visualize_forces> Set this to true so the plugin visualizes the normal
-    /// forces in the 3D world. This element is optional, and the
-    /// default value is false.
+    /// forces in the 3D world. The depth images are only processed when this
+    /// is true. This element is optional, and the default value is false.
     ///
     /// <force_length> Length in meters of the forces visualized if
     /// <visualize_forces> is set to true. This parameter is optional, and the
@@ -17,9 +17,12 @@
 
 #include <ignition/msgs/particle_emitter.pb.h>
 
+#include <google/protobuf/util/message_differencer.h>
+
 #include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
 #include <ignition/math/Color.hh>
@@ -50,7 +53,15 @@ class ignition::gazebo::systems::ParticleEmitterPrivate
   /// \param[in] _msg Particle emitter message.
   public: void OnCmd(const ignition::msgs::ParticleEmitter &_msg);
 
-  /// \brief The particle emitter parsed from SDF.
+  /// \brief Reduce a command to the parameters that differ from the
+  /// current emitter state.
+  /// \param[in] _cmd Particle emitter command.
+  /// \return A copy of _cmd holding only the changed parameters.
+  public: ignition::msgs::ParticleEmitter ChangedFields(
+      const ignition::msgs::ParticleEmitter &_cmd) const;
+
+  /// \brief The current state of the particle emitter, initially parsed
+  /// from SDF.
   public: ignition::msgs::ParticleEmitter emitter;
 
   /// \brief The transport node.
@@ -59,7 +70,8 @@ class ignition::gazebo::systems::ParticleEmitterPrivate
   /// \brief Particle emitter entity.
   public: Entity emitterEntity{kNullEntity};
 
-  /// \brief The particle emitter command requested externally.
+  /// \brief The particle emitter commands requested externally since the
+  /// last update, merged into a single message.
   public: ignition::msgs::ParticleEmitter userCmd;
 
   public: bool newDataReceived = false;
@@ -72,10 +84,53 @@ class ignition::gazebo::systems::ParticleEmitterPrivate
 void ParticleEmitterPrivate::OnCmd(const msgs::ParticleEmitter &_msg)
 {
   std::lock_guard<std::mutex> lock(this->mutex);
-  this->userCmd = _msg;
+  this->userCmd.MergeFrom(_msg);
   this->newDataReceived = true;
 }
 
+//////////////////////////////////////////////////
+msgs::ParticleEmitter ParticleEmitterPrivate::ChangedFields(
+    const msgs::ParticleEmitter &_cmd) const
+{
+  msgs::ParticleEmitter delta = _cmd;
+  const auto *reflection = delta.GetReflection();
+
+  std::vector<const google::protobuf::FieldDescriptor *> fields;
+  reflection->ListFields(_cmd, &fields);
+  for (const auto *field : fields)
+  {
+    bool changed{true};
+    // The header, name and id identify the emitter, they aren't parameters
+    if (field->name() == "header" || field->name() == "name" ||
+        field->name() == "id")
+    {
+      changed = false;
+    }
+    else if (!reflection->HasField(this->emitter, field))
+    {
+      changed = true;
+    }
+    else if (field->cpp_type() ==
+        google::protobuf::FieldDescriptor::CPPTYPE_MESSAGE)
+    {
+      changed = !google::protobuf::util::MessageDifferencer::Equals(
+          reflection->GetMessage(this->emitter, field),
+          reflection->GetMessage(_cmd, field));
+    }
+    else if (field->cpp_type() ==
+        google::protobuf::FieldDescriptor::CPPTYPE_ENUM)
+    {
+      changed = reflection->GetEnumValue(this->emitter, field) !=
+          reflection->GetEnumValue(_cmd, field);
+    }
+
+    if (!changed)
+      reflection->ClearField(&delta, field);
+  }
+
+  return delta;
+}
+
 //////////////////////////////////////////////////
 ParticleEmitter::ParticleEmitter()
   : System(), dataPtr(std::make_unique<ParticleEmitterPrivate>())
@@ -305,6 +360,24 @@ void ParticleEmitter::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
 
   this->dataPtr->newDataReceived = false;
 
+  // Only changed parameters are sent to rendering, so unchanged materials
+  // and images aren't reloaded. Particles themselves are simulated by the
+  // rendering engine and never go through the ECM.
+  auto delta = this->dataPtr->ChangedFields(this->dataPtr->userCmd);
+  this->dataPtr->userCmd.Clear();
+  if (delta.ByteSizeLong() == 0)
+    return;
+
+  // Keep the emitter component up to date so that emitters created later,
+  // for example by a GUI connecting mid-simulation, start from the current
+  // state. It's not marked as changed, since existing emitters are updated
+  // through the command component below.
+  this->dataPtr->emitter.MergeFrom(delta);
+  auto stateComp = _ecm.Component<components::ParticleEmitter>(
+      this->dataPtr->emitterEntity);
+  if (stateComp)
+    stateComp->Data() = this->dataPtr->emitter;
+
   // Create component.
   auto emitterComp = _ecm.Component<components::ParticleEmitterCmd>(
       this->dataPtr->emitterEntity);
@@ -312,11 +385,11 @@ void ParticleEmitter::PreUpdate(const ignition::gazebo::UpdateInfo &_info,
   {
     _ecm.CreateComponent(
         this->dataPtr->emitterEntity,
-        components::ParticleEmitterCmd(this->dataPtr->userCmd));
+        components::ParticleEmitterCmd(delta));
   }
   else
   {
-    emitterComp->Data() = this->dataPtr->userCmd;
+    emitterComp->Data() = delta;
 
     // Note: we process the cmd component in RenderUtil but if there is only
     // rendering on the gui side, it will not be able to remove the cmd
@@ -108,6 +108,11 @@ namespace systems
   ///            The default topic is
   ///            /model/<model_name>/particle_emitter/<emitter_name>
   ///            Note that the emitter id and name may not be changed.
+  ///            Only parameters that differ from the current state are
+  ///            forwarded to rendering, and commands received within one
+  ///            iteration are merged. Particles are simulated entirely by
+  ///            the rendering engine, no per-particle state goes through
+  ///            the ECM or transport.
   ///            See the examples/worlds/particle_emitter.sdf example world for
   ///            example usage.
   class ParticleEmitter
@@ -17,6 +17,11 @@
 
 #include <ignition/msgs/pose.pb.h>
 
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include <ignition/common/Profiler.hh>
 #include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/Vector3.hh>
@@ -27,6 +32,7 @@
 #include <sdf/Geometry.hh>
 
 #include "ignition/gazebo/Model.hh"
+#include "ignition/gazebo/SpatialIndex.hh"
 #include "ignition/gazebo/Util.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Model.hh"
@@ -41,6 +47,114 @@ using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+/// \brief Boxes of all performers of an entity component manager, shared
+/// by every PerformerDetector using that manager. The first detector to
+/// run in an iteration refreshes it, only moving the performers whose box
+/// changed, and each detector then queries it with its own region.
+class ignition::gazebo::systems::PerformerBroadphase
+{
+  /// \brief Mutex protecting the broadphase.
+  public: std::mutex mutex;
+
+  /// \brief Refresh the performer boxes, once per iteration.
+  /// \param[in] _iteration Current iteration.
+  /// \param[in] _ecm Entity component manager.
+  public: void Update(uint64_t _iteration,
+      const EntityComponentManager &_ecm);
+
+  /// \brief Performer tracked by the broadphase.
+  public: struct Performer
+  {
+    /// \brief Model the performer belongs to.
+    public: Entity parent{kNullEntity};
+
+    /// \brief Pose of the model.
+    public: math::Pose3d pose;
+
+    /// \brief Box of the performer in the world frame.
+    public: math::AxisAlignedBox box;
+
+    /// \brief Last iteration the performer was seen in.
+    public: uint64_t seen{0};
+  };
+
+  /// \brief Performers by entity.
+  public: std::unordered_map<Entity, Performer> performers;
+
+  /// \brief Index of the performer boxes.
+  public: SpatialIndex index;
+
+  /// \brief Incremented every time a performer is added, moved or
+  /// removed.
+  public: uint64_t version{1};
+
+  /// \brief Last iteration the broadphase was refreshed in.
+  private: std::optional<uint64_t> lastIteration;
+};
+
+//////////////////////////////////////////////////
+void PerformerBroadphase::Update(uint64_t _iteration,
+    const EntityComponentManager &_ecm)
+{
+  if (this->lastIteration && *this->lastIteration == _iteration)
+    return;
+  this->lastIteration = _iteration;
+
+  IGN_PROFILE("PerformerBroadphase::Update");
+  _ecm.Each<components::Performer, components::Geometry,
+            components::ParentEntity>(
+      [&](const Entity &_entity, const components::Performer *,
+          const components::Geometry *_geometry,
+          const components::ParentEntity *_parent) -> bool
+      {
+        // We assume the geometry contains a box.
+        auto perfBox = _geometry->Data().BoxShape();
+        if (nullptr == perfBox)
+        {
+          ignerr << "Internal error: geometry of performer [" << _entity
+                 << "] missing box." << std::endl;
+          return true;
+        }
+
+        auto pose = _ecm.Component<components::Pose>(_parent->Data())->Data();
+        math::AxisAlignedBox box{pose.Pos() - perfBox->Size() / 2,
+                                 pose.Pos() + perfBox->Size() / 2};
+
+        auto it = this->performers.find(_entity);
+        if (it == this->performers.end() || it->second.box != box ||
+            it->second.parent != _parent->Data())
+        {
+          this->index.Update(_entity, box);
+          ++this->version;
+        }
+
+        auto &performer = this->performers[_entity];
+        performer.parent = _parent->Data();
+        performer.pose = pose;
+        performer.box = box;
+        performer.seen = _iteration;
+        return true;
+      });
+
+  // Forget performers which no longer exist
+  for (auto it = this->performers.begin(); it != this->performers.end();)
+  {
+    if (it->second.seen != _iteration)
+    {
+      this->index.Remove(it->first);
+      it = this->performers.erase(it);
+      ++this->version;
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+PerformerDetector::~PerformerDetector() = default;
+
 /////////////////////////////////////////////////
 void PerformerDetector::Configure(const Entity &_entity,
                const std::shared_ptr<const sdf::Element> &_sdf,
@@ -159,45 +273,67 @@ void PerformerDetector::PostUpdate(
   auto region = this->detectorGeometry -
     (-(modelPose.Pos() + modelPose.Rot() * this->poseOffset.Pos()));
 
-  _ecm.Each<components::Performer, components::Geometry,
-            components::ParentEntity>(
-      [&](const Entity &_entity, const components::Performer *,
-          const components::Geometry *_geometry,
-          const components::ParentEntity *_parent) -> bool
-      {
-        auto pose = _ecm.Component<components::Pose>(_parent->Data())->Data();
-        auto name = _ecm.Component<components::Name>(_parent->Data())->Data();
-        const math::Pose3d relPose = modelPose.Inverse() * pose;
+  if (!this->broadphase)
+  {
+    this->broadphase = _ecm.SharedObject<PerformerBroadphase>(
+        "ignition::gazebo::systems::PerformerBroadphase");
+  }
+  auto &broadphase = *this->broadphase;
+  std::lock_guard<std::mutex> lock(broadphase.mutex);
+  broadphase.Update(_info.iterations, _ecm);
 
-        // We assume the geometry contains a box.
-        auto perfBox = _geometry->Data().BoxShape();
-        if (nullptr == perfBox)
-        {
-          ignerr << "Internal error: geometry of performer [" << _entity
-                 << "] missing box." << std::endl;
-          return true;
-        }
+  // Overlaps can only change if the detector or a performer moved
+  if (this->lastRegion && *this->lastRegion == region &&
+      this->lastBroadphaseVersion == broadphase.version)
+  {
+    return;
+  }
+  this->lastRegion = region;
+  this->lastBroadphaseVersion = broadphase.version;
 
-        math::AxisAlignedBox performerVolume{pose.Pos() - perfBox->Size() / 2,
-                                             pose.Pos() + perfBox->Size() / 2};
+  auto publish = [&](const Entity _entity,
+      const PerformerBroadphase::Performer &_performer, bool _state)
+  {
+    auto name = _ecm.Component<components::Name>(_performer.parent)->Data();
+    const math::Pose3d relPose = modelPose.Inverse() * _performer.pose;
+    this->Publish(_entity, name, _state, relPose, _info.simTime);
+  };
+
+  // Performers entering the region
+  auto candidates = broadphase.index.QueryBox(region);
+  std::sort(candidates.begin(), candidates.end());
+  std::unordered_set<Entity> inside;
+  for (const Entity entity : candidates)
+  {
+    const auto &performer = broadphase.performers.at(entity);
+    if (!region.Intersects(performer.box))
+      continue;
 
-        bool alreadyDetected = this->IsAlreadyDetected(_entity);
-        if (region.Intersects(performerVolume))
-        {
-          if (!alreadyDetected)
-          {
-            this->AddToDetected(_entity);
-            this->Publish(_entity, name, true, relPose, _info.simTime);
-          }
-        }
-        else if (alreadyDetected)
-        {
-          this->RemoveFromDetected(_entity);
-          this->Publish(_entity, name, false, relPose, _info.simTime);
-        }
+    inside.insert(entity);
+    if (!this->IsAlreadyDetected(entity))
+    {
+      this->AddToDetected(entity);
+      publish(entity, performer, true);
+    }
+  }
 
-        return true;
-      });
+  // Performers leaving the region. Performers which were removed are kept
+  // as detected.
+  std::vector<Entity> detected(this->detectedEntities.begin(),
+      this->detectedEntities.end());
+  std::sort(detected.begin(), detected.end());
+  for (const Entity entity : detected)
+  {
+    if (inside.find(entity) != inside.end())
+      continue;
+
+    auto it = broadphase.performers.find(entity);
+    if (it == broadphase.performers.end())
+      continue;
+
+    this->RemoveFromDetected(entity);
+    publish(entity, it->second, false);
+  }
 }
 
 //////////////////////////////////////////////////
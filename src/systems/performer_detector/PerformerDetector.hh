@@ -20,6 +20,7 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_set>
 
@@ -36,6 +37,9 @@ namespace gazebo
 inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
 namespace systems
 {
+  // Forward declaration
+  class PerformerBroadphase;
+
   /// \brief A system system that publishes on a topic when a performer enters
   /// or leaves a specified region.
   ///
@@ -87,6 +91,9 @@ namespace systems
     /// Documentation inherited
     public: PerformerDetector() = default;
 
+    /// \brief Destructor
+    public: ~PerformerDetector() override;
+
     /// Documentation inherited
     public: void Configure(const Entity &_entity,
                            const std::shared_ptr<const sdf::Element> &_sdf,
@@ -125,6 +132,17 @@ namespace systems
     /// \brief Keeps a set of detected entities
     private: std::unordered_set<Entity> detectedEntities;
 
+    /// \brief Performer broadphase shared with the other detectors of the
+    /// manager, null until the first update.
+    private: std::shared_ptr<PerformerBroadphase> broadphase;
+
+    /// \brief Region tested in the last update, used to skip the test when
+    /// neither the detector nor any performer moved.
+    private: std::optional<math::AxisAlignedBox> lastRegion;
+
+    /// \brief Version of the broadphase in the last update.
+    private: uint64_t lastBroadphaseVersion{0};
+
     /// \brief The model associated with this system.
     private: Model model;
 
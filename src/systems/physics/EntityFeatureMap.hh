@@ -21,6 +21,7 @@
 #include <tuple>
 #include <type_traits>
 #include <unordered_map>
+#include <utility>
 
 #include <ignition/physics/Entity.hh>
 #include <ignition/physics/FindFeatures.hh>
@@ -29,6 +30,8 @@
 
 #include "ignition/gazebo/Entity.hh"
 
+#include "EntitySlotMap.hh"
+
 namespace ignition::gazebo
 {
 inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
@@ -109,10 +112,9 @@ namespace systems::physics_system
       {
         using ToEntityPtr = PhysicsEntityPtr<ToFeatureList>;
         // Has already been cast
-        auto castIt = this->castCache.find(_entity);
-        if (castIt != this->castCache.end())
+        if (auto cached = this->castCache.Get(_entity))
         {
-          auto castEntity = std::get<ToEntityPtr>(castIt->second);
+          auto castEntity = std::get<ToEntityPtr>(*cached);
           if (nullptr != castEntity)
           {
             return castEntity;
@@ -165,10 +167,9 @@ namespace systems::physics_system
     /// nullptr
     public: RequiredEntityPtr Get(const Entity &_entity) const
     {
-      auto it = this->entityMap.find(_entity);
-      if (it != this->entityMap.end())
+      if (auto physEntity = this->entityMap.Get(_entity))
       {
-        return it->second;
+        return *physEntity;
       }
       return nullptr;
     }
@@ -210,7 +211,7 @@ namespace systems::physics_system
     /// Gazebo entity
     public: bool HasEntity(const Entity &_entity) const
     {
-      return this->entityMap.find(_entity) != this->entityMap.end();
+      return this->entityMap.Has(_entity);
     }
 
     /// \brief Check whether there is a gazebo entity associated with the given
@@ -239,13 +240,13 @@ namespace systems::physics_system
     /// \return True if the entity was found and removed.
     public: bool Remove(Entity _entity)
     {
-      auto it = this->entityMap.find(_entity);
-      if (it != this->entityMap.end())
+      auto physEntity = this->entityMap.Get(_entity);
+      if (nullptr != physEntity)
       {
-        this->reverseMap.erase(it->second);
-        this->physEntityById.erase(it->second->EntityID());
-        this->castCache.erase(_entity);
-        this->entityMap.erase(it);
+        this->reverseMap.erase(*physEntity);
+        this->physEntityById.erase((*physEntity)->EntityID());
+        this->castCache.Erase(_entity);
+        this->entityMap.Erase(_entity);
         return true;
       }
       return false;
@@ -259,21 +260,24 @@ namespace systems::physics_system
       auto it = this->reverseMap.find(_physicsEntity);
       if (it != this->reverseMap.end())
       {
-        this->entityMap.erase(it->second);
+        this->entityMap.Erase(it->second);
         this->physEntityById.erase(it->first->EntityID());
-        this->castCache.erase(it->second);
+        this->castCache.Erase(it->second);
         this->reverseMap.erase(it);
         return true;
       }
       return false;
     }
 
-    /// \brief Get the map from Gazebo entity to physics entities with required
-    /// features
-    /// \return Immumtable entity map
-    public: const std::unordered_map<Entity, RequiredEntityPtr> &Map() const
+    /// \brief Call a function for each Gazebo entity and its physics entity
+    /// with required features, in no particular order. The function must not
+    /// modify the map.
+    /// \param[in] _f Function called with each Gazebo entity and its
+    /// physics entity.
+    public: template <typename FunctionT>
+            void Each(FunctionT &&_f) const
     {
-      return this->entityMap;
+      this->entityMap.Each(std::forward<FunctionT>(_f));
     }
 
     /// \brief Get the total number of entries in the maps. Only used for
@@ -281,12 +285,14 @@ namespace systems::physics_system
     /// \return Number of entries in all the maps.
     public: std::size_t TotalMapEntryCount() const
     {
-      return this->entityMap.size() + this->reverseMap.size() +
-             this->castCache.size() + this->physEntityById.size();
+      return this->entityMap.Size() + this->reverseMap.size() +
+             this->castCache.Size() + this->physEntityById.size();
     }
 
-    /// \brief Map from Gazebo entity to physics entities with required features
-    private: std::unordered_map<Entity, RequiredEntityPtr> entityMap;
+    /// \brief Map from Gazebo entity to physics entities with required
+    /// features. Indexed by entity slot, since it's queried for every link
+    /// on every step.
+    private: EntitySlotMap<RequiredEntityPtr> entityMap;
 
     /// \brief Reverse map of entityMap
     private: std::unordered_map<RequiredEntityPtr, Entity> reverseMap;
@@ -297,7 +303,7 @@ namespace systems::physics_system
 
     /// \brief Cache map from Gazebo entity to physics entities with optional
     /// features
-    private: mutable std::unordered_map<Entity, ValueType> castCache;
+    private: mutable EntitySlotMap<ValueType> castCache;
   };
 
   /// \brief Convenience template that presets EntityFeatureMap with
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_PHYSICS_ENTITY_SLOT_MAP_HH_
+#define IGNITION_GAZEBO_SYSTEMS_PHYSICS_ENTITY_SLOT_MAP_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ignition/gazebo/config.hh"
+#include "ignition/gazebo/Entity.hh"
+
+namespace ignition::gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems::physics_system
+{
+  // \brief Map from Gazebo entities to values, stored in an array indexed by
+  // the slot of each entity, see gazebo::entitySlot. Slots are compact, so
+  // lookups are array accesses rather than hash lookups, which matters for
+  // maps queried for every link on every step.
+  //
+  // Entities whose slot is 0, or too large to index an array, such as
+  // entities created after EntityComponentManager::SetEntityCreateOffset,
+  // are kept in a hash map instead. So are entities whose slot is taken by
+  // another entity.
+  //
+  // Erasing an entity destroys its value, so physics entity pointers are
+  // released right away.
+  //
+  // \tparam T Type of the values, which must be default constructible.
+  template <typename T>
+  class EntitySlotMap
+  {
+    /// \brief Get the value of an entity.
+    /// \param[in] _entity Gazebo entity.
+    /// \return Pointer to the value, nullptr if the entity isn't in the map.
+    /// It stays valid until the map is modified.
+    public: T *Get(const Entity _entity)
+    {
+      return const_cast<T *>(
+          static_cast<const EntitySlotMap *>(this)->Get(_entity));
+    }
+
+    /// \brief Get the value of an entity.
+    /// \param[in] _entity Gazebo entity.
+    /// \return Pointer to the value, nullptr if the entity isn't in the map.
+    /// It stays valid until the map is modified.
+    public: const T *Get(const Entity _entity) const
+    {
+      const uint64_t slot = entitySlot(_entity);
+      if (slot < this->slots.size() && this->slots[slot].entity == _entity &&
+          kNullEntity != _entity)
+      {
+        return &this->slots[slot].value;
+      }
+
+      if (this->overflow.empty())
+        return nullptr;
+
+      auto it = this->overflow.find(_entity);
+      return it == this->overflow.end() ? nullptr : &it->second;
+    }
+
+    /// \brief Check whether an entity is in the map.
+    /// \param[in] _entity Gazebo entity.
+    /// \return True if the entity is in the map.
+    public: bool Has(const Entity _entity) const
+    {
+      return nullptr != this->Get(_entity);
+    }
+
+    /// \brief Add an entity, unless it's already in the map.
+    /// \param[in] _entity Gazebo entity.
+    /// \param[in] _value Value of the entity.
+    /// \return True if the entity was added, false if it was already in the
+    /// map, in which case its value is left unchanged.
+    public: bool Insert(const Entity _entity, T _value)
+    {
+      if (this->Has(_entity))
+        return false;
+      this->Add(_entity) = std::move(_value);
+      return true;
+    }
+
+    /// \brief Get the value of an entity, adding the entity with a default
+    /// value if it isn't in the map.
+    /// \param[in] _entity Gazebo entity.
+    /// \return The value.
+    public: T &operator[](const Entity _entity)
+    {
+      if (auto value = this->Get(_entity))
+        return *value;
+      return this->Add(_entity);
+    }
+
+    /// \brief Remove an entity.
+    /// \param[in] _entity Gazebo entity.
+    /// \return True if the entity was in the map.
+    public: bool Erase(const Entity _entity)
+    {
+      const uint64_t slot = entitySlot(_entity);
+      if (slot < this->slots.size() && this->slots[slot].entity == _entity &&
+          kNullEntity != _entity)
+      {
+        this->slots[slot] = Slot();
+        --this->count;
+        return true;
+      }
+
+      if (this->overflow.erase(_entity) > 0)
+      {
+        --this->count;
+        return true;
+      }
+      return false;
+    }
+
+    /// \brief Get the number of entities in the map.
+    /// \return Number of entities.
+    public: std::size_t Size() const
+    {
+      return this->count;
+    }
+
+    /// \brief Remove all entities.
+    public: void Clear()
+    {
+      this->slots.clear();
+      this->overflow.clear();
+      this->count = 0;
+    }
+
+    /// \brief Call a function for each entity in the map, in no particular
+    /// order. The function must not modify the map.
+    /// \param[in] _f Function called with each entity and its value.
+    public: template <typename FunctionT>
+            void Each(FunctionT &&_f) const
+    {
+      for (const auto &slot : this->slots)
+      {
+        if (kNullEntity != slot.entity)
+          _f(slot.entity, slot.value);
+      }
+      for (const auto &[entity, value] : this->overflow)
+        _f(entity, value);
+    }
+
+    /// \brief Add an entity which isn't in the map yet.
+    /// \param[in] _entity Gazebo entity.
+    /// \return Its value, default constructed.
+    private: T &Add(const Entity _entity)
+    {
+      ++this->count;
+
+      const uint64_t slot = entitySlot(_entity);
+      if (0 == slot || slot >= kMaxSlots)
+        return this->overflow[_entity];
+
+      if (slot >= this->slots.size())
+        this->slots.resize(slot + 1);
+
+      if (kNullEntity != this->slots[slot].entity)
+        return this->overflow[_entity];
+
+      this->slots[slot].entity = _entity;
+      return this->slots[slot].value;
+    }
+
+    /// \brief An entity and its value.
+    private: struct Slot
+    {
+      /// \brief Entity which owns the slot, kNullEntity if it's free.
+      Entity entity{kNullEntity};
+
+      /// \brief Value of the entity.
+      T value{};
+    };
+
+    /// \brief Slots above this are kept in the overflow map, so a few
+    /// entities with very large slots don't take up a huge array.
+    private: static constexpr uint64_t kMaxSlots{uint64_t{1} << 22};
+
+    /// \brief Values indexed by entity slot.
+    private: std::vector<Slot> slots;
+
+    /// \brief Entities which can't be stored in slots.
+    private: std::unordered_map<Entity, T> overflow;
+
+    /// \brief Number of entities in the map.
+    private: std::size_t count{0};
+  };
+}
+}
+}
+#endif
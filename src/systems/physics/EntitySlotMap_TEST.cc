@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "EntitySlotMap.hh"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+using namespace ignition;
+using namespace ignition::gazebo;
+using namespace ignition::gazebo::systems::physics_system;
+
+/////////////////////////////////////////////////
+TEST(EntitySlotMap, AddGetErase)
+{
+  EntitySlotMap<std::string> map;
+  EXPECT_EQ(0u, map.Size());
+  EXPECT_EQ(nullptr, map.Get(1));
+  EXPECT_FALSE(map.Has(kNullEntity));
+  EXPECT_FALSE(map.Erase(1));
+
+  EXPECT_TRUE(map.Insert(1, "one"));
+  EXPECT_TRUE(map.Insert(10, "ten"));
+  EXPECT_EQ(2u, map.Size());
+  ASSERT_NE(nullptr, map.Get(1));
+  EXPECT_EQ("one", *map.Get(1));
+  EXPECT_EQ("ten", *map.Get(10));
+  EXPECT_EQ(nullptr, map.Get(5));
+
+  // Insert doesn't overwrite, operator[] does
+  EXPECT_FALSE(map.Insert(1, "uno"));
+  EXPECT_EQ("one", *map.Get(1));
+  map[1] = "uno";
+  EXPECT_EQ("uno", *map.Get(1));
+  EXPECT_EQ(2u, map.Size());
+
+  // operator[] adds default values
+  EXPECT_TRUE(map[3].empty());
+  EXPECT_EQ(3u, map.Size());
+
+  EXPECT_TRUE(map.Erase(1));
+  EXPECT_FALSE(map.Erase(1));
+  EXPECT_FALSE(map.Has(1));
+  EXPECT_EQ(2u, map.Size());
+
+  map.Clear();
+  EXPECT_EQ(0u, map.Size());
+  EXPECT_FALSE(map.Has(10));
+}
+
+/////////////////////////////////////////////////
+TEST(EntitySlotMap, Overflow)
+{
+  EntitySlotMap<int> map;
+
+  // Null entity, an entity sharing the slot of another one because of its
+  // generation, and an entity with a very large slot
+  const Entity recycled = (uint64_t{1} << kEntitySlotBits) | 7;
+  const Entity offset = uint64_t{1} << 62;
+  const Entity large = (uint64_t{1} << 31) + 5;
+
+  EXPECT_TRUE(map.Insert(7, 1));
+  EXPECT_TRUE(map.Insert(recycled, 2));
+  EXPECT_TRUE(map.Insert(offset, 3));
+  EXPECT_TRUE(map.Insert(large, 4));
+  EXPECT_TRUE(map.Insert(kNullEntity, 5));
+  EXPECT_EQ(5u, map.Size());
+
+  EXPECT_EQ(1, *map.Get(7));
+  EXPECT_EQ(2, *map.Get(recycled));
+  EXPECT_EQ(3, *map.Get(offset));
+  EXPECT_EQ(4, *map.Get(large));
+  EXPECT_EQ(5, *map.Get(kNullEntity));
+
+  std::map<Entity, int> visited;
+  map.Each([&](const Entity _entity, const int _value)
+      {
+        visited[_entity] = _value;
+      });
+  EXPECT_EQ((std::map<Entity, int>{{kNullEntity, 5}, {7, 1}, {large, 4},
+      {recycled, 2}, {offset, 3}}), visited);
+
+  // Removing the slot's owner leaves the other entity
+  EXPECT_TRUE(map.Erase(7));
+  EXPECT_EQ(nullptr, map.Get(7));
+  EXPECT_EQ(2, *map.Get(recycled));
+  EXPECT_TRUE(map.Erase(recycled));
+  EXPECT_TRUE(map.Erase(kNullEntity));
+  EXPECT_EQ(2u, map.Size());
+}
+
+/////////////////////////////////////////////////
+TEST(EntitySlotMap, EraseReleasesValue)
+{
+  EntitySlotMap<std::shared_ptr<int>> map;
+  auto value = std::make_shared<int>(3);
+  map[2] = value;
+  EXPECT_EQ(2, value.use_count());
+
+  map.Erase(2);
+  EXPECT_EQ(1, value.use_count());
+}
@@ -0,0 +1,421 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_PHYSICS_MESHPROXY_HH_
+#define IGNITION_GAZEBO_SYSTEMS_PHYSICS_MESHPROXY_HH_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <ignition/math/Vector3.hh>
+
+#include "ignition/gazebo/config.hh"
+
+namespace ignition::gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems::physics_system
+{
+  /// \brief How collision meshes are replaced by proxies.
+  enum class ProxyMode
+  {
+    /// \brief Use the mesh as is.
+    NONE,
+
+    /// \brief Use the convex hull of the mesh.
+    CONVEX_HULL,
+
+    /// \brief Use a simplified mesh.
+    SIMPLIFY
+  };
+
+  /// \brief Parse a proxy mode.
+  /// \param[in] _name `none`, `convex_hull` or `simplify`.
+  /// \param[out] _mode Parsed mode, untouched if the name is unknown.
+  /// \return True if the name is known.
+  inline bool parseProxyMode(const std::string &_name, ProxyMode &_mode)
+  {
+    if (_name == "none")
+      _mode = ProxyMode::NONE;
+    else if (_name == "convex_hull")
+      _mode = ProxyMode::CONVEX_HULL;
+    else if (_name == "simplify")
+      _mode = ProxyMode::SIMPLIFY;
+    else
+      return false;
+    return true;
+  }
+
+  /// \brief A triangle mesh, with three vertex indices per triangle.
+  struct TriangleSoup
+  {
+    /// \brief Vertex positions.
+    std::vector<math::Vector3d> vertices;
+
+    /// \brief Vertex indices, three per triangle.
+    std::vector<unsigned int> indices;
+  };
+
+  /// \brief Compute the convex hull of points, with triangles wound
+  /// counter-clockwise seen from outside.
+  /// \param[in] _points Points.
+  /// \return The hull, or an empty mesh if the points are all on a plane.
+  inline TriangleSoup convexHull(const std::vector<math::Vector3d> &_points)
+  {
+    TriangleSoup hull;
+    if (_points.size() < 4)
+      return hull;
+
+    math::Vector3d min(_points[0]);
+    math::Vector3d max(_points[0]);
+    for (const auto &point : _points)
+    {
+      min.Min(point);
+      max.Max(point);
+    }
+    const double eps = 1e-9 * std::max(1.0, (max - min).Length());
+
+    // Initial tetrahedron, from extreme points
+    std::size_t i0 = 0, i1 = 0;
+    for (std::size_t i = 0; i < _points.size(); ++i)
+    {
+      if (_points[i].X() < _points[i0].X())
+        i0 = i;
+      if (_points[i].X() > _points[i1].X())
+        i1 = i;
+    }
+    if (_points[i0].Distance(_points[i1]) <= eps)
+    {
+      // All points share their X, pick the farthest from the first one
+      for (std::size_t i = 0; i < _points.size(); ++i)
+      {
+        if (_points[i].Distance(_points[i0]) >
+            _points[i1].Distance(_points[i0]))
+        {
+          i1 = i;
+        }
+      }
+    }
+    const math::Vector3d axis = _points[i1] - _points[i0];
+
+    std::size_t i2 = i0;
+    double best = eps;
+    for (std::size_t i = 0; i < _points.size(); ++i)
+    {
+      double dist = axis.Cross(_points[i] - _points[i0]).Length();
+      if (dist > best)
+      {
+        best = dist;
+        i2 = i;
+      }
+    }
+    if (i2 == i0)
+      return hull;
+
+    const math::Vector3d planeNormal =
+        axis.Cross(_points[i2] - _points[i0]).Normalized();
+    std::size_t i3 = i0;
+    best = eps;
+    for (std::size_t i = 0; i < _points.size(); ++i)
+    {
+      double dist = std::abs(planeNormal.Dot(_points[i] - _points[i0]));
+      if (dist > best)
+      {
+        best = dist;
+        i3 = i;
+      }
+    }
+    if (i3 == i0)
+      return hull;
+
+    struct Face
+    {
+      std::array<std::size_t, 3> v;
+      math::Vector3d normal;
+      double offset;
+      bool alive;
+    };
+    std::vector<Face> faces;
+    const math::Vector3d inside =
+        (_points[i0] + _points[i1] + _points[i2] + _points[i3]) / 4.0;
+    auto addFace = [&](std::size_t _a, std::size_t _b, std::size_t _c)
+    {
+      math::Vector3d normal =
+          (_points[_b] - _points[_a]).Cross(_points[_c] - _points[_a]);
+      normal.Normalize();
+      if (normal.Dot(inside - _points[_a]) > 0)
+      {
+        std::swap(_b, _c);
+        normal = -normal;
+      }
+      faces.push_back({{_a, _b, _c}, normal, normal.Dot(_points[_a]), true});
+    };
+    addFace(i0, i1, i2);
+    addFace(i0, i1, i3);
+    addFace(i0, i2, i3);
+    addFace(i1, i2, i3);
+
+    // Add the points one at a time, replacing the faces they see with a
+    // fan from the point to the horizon
+    std::vector<std::size_t> visible;
+    std::set<std::pair<std::size_t, std::size_t>> edges;
+    std::size_t dead = 0;
+    for (std::size_t p = 0; p < _points.size(); ++p)
+    {
+      if (p == i0 || p == i1 || p == i2 || p == i3)
+        continue;
+
+      visible.clear();
+      for (std::size_t f = 0; f < faces.size(); ++f)
+      {
+        if (faces[f].alive &&
+            faces[f].normal.Dot(_points[p]) - faces[f].offset > eps)
+        {
+          visible.push_back(f);
+        }
+      }
+      if (visible.empty())
+        continue;
+
+      edges.clear();
+      dead += visible.size();
+      for (auto f : visible)
+      {
+        faces[f].alive = false;
+        for (int e = 0; e < 3; ++e)
+          edges.insert({faces[f].v[e], faces[f].v[(e + 1) % 3]});
+      }
+
+      // Edges whose twin isn't part of a visible face are on the horizon
+      for (const auto &edge : edges)
+      {
+        if (edges.count({edge.second, edge.first}))
+          continue;
+        math::Vector3d normal = (_points[edge.second] - _points[edge.first])
+            .Cross(_points[p] - _points[edge.first]);
+        normal.Normalize();
+        faces.push_back({{edge.first, edge.second, p}, normal,
+            normal.Dot(_points[p]), true});
+      }
+
+      // Drop dead faces once they outnumber the others, so the scans stay
+      // short
+      if (dead * 2 > faces.size())
+      {
+        faces.erase(std::remove_if(faces.begin(), faces.end(),
+            [](const Face &_face) {return !_face.alive;}), faces.end());
+        dead = 0;
+      }
+    }
+
+    std::unordered_map<std::size_t, unsigned int> remap;
+    for (const auto &face : faces)
+    {
+      if (!face.alive)
+        continue;
+      for (auto v : face.v)
+      {
+        auto iter = remap.find(v);
+        if (iter == remap.end())
+        {
+          iter = remap.emplace(v,
+              static_cast<unsigned int>(hull.vertices.size())).first;
+          hull.vertices.push_back(_points[v]);
+        }
+        hull.indices.push_back(iter->second);
+      }
+    }
+    return hull;
+  }
+
+  /// \brief Simplify a mesh by merging the vertices in each cell of a
+  /// uniform grid into their average, and dropping the triangles which
+  /// collapse.
+  /// \param[in] _mesh Mesh to simplify.
+  /// \param[in] _resolution Number of cells along the longest side of the
+  /// mesh's bounding box.
+  /// \return The simplified mesh.
+  inline TriangleSoup simplify(const TriangleSoup &_mesh,
+      unsigned int _resolution)
+  {
+    TriangleSoup result;
+    if (_mesh.vertices.empty() || _resolution == 0)
+      return result;
+
+    math::Vector3d min(_mesh.vertices[0]);
+    math::Vector3d max(_mesh.vertices[0]);
+    for (const auto &vertex : _mesh.vertices)
+    {
+      min.Min(vertex);
+      max.Max(vertex);
+    }
+    const math::Vector3d size = max - min;
+    const double extent = std::max({size.X(), size.Y(), size.Z()});
+    const double cell = extent > 0 ? extent / _resolution : 1.0;
+
+    auto cellIndex = [&](double _value, double _min) -> uint64_t
+    {
+      return std::min(static_cast<uint64_t>(_resolution),
+          static_cast<uint64_t>((_value - _min) / cell));
+    };
+
+    // Cluster of each vertex, and the sum of the vertices of each cluster
+    std::unordered_map<uint64_t, unsigned int> clusters;
+    std::vector<unsigned int> clusterOf(_mesh.vertices.size());
+    std::vector<std::pair<math::Vector3d, unsigned int>> sums;
+    const uint64_t stride = static_cast<uint64_t>(_resolution) + 1;
+    for (std::size_t i = 0; i < _mesh.vertices.size(); ++i)
+    {
+      const auto &vertex = _mesh.vertices[i];
+      uint64_t key = (cellIndex(vertex.X(), min.X()) * stride +
+          cellIndex(vertex.Y(), min.Y())) * stride +
+          cellIndex(vertex.Z(), min.Z());
+      auto iter = clusters.find(key);
+      if (iter == clusters.end())
+      {
+        iter = clusters.emplace(key,
+            static_cast<unsigned int>(sums.size())).first;
+        sums.push_back({math::Vector3d::Zero, 0u});
+      }
+      clusterOf[i] = iter->second;
+      sums[iter->second].first += vertex;
+      ++sums[iter->second].second;
+    }
+
+    result.vertices.reserve(sums.size());
+    for (const auto &sum : sums)
+      result.vertices.push_back(sum.first / sum.second);
+
+    std::set<std::array<unsigned int, 3>> triangles;
+    for (std::size_t i = 0; i + 2 < _mesh.indices.size(); i += 3)
+    {
+      std::array<unsigned int, 3> tri{clusterOf[_mesh.indices[i]],
+          clusterOf[_mesh.indices[i + 1]], clusterOf[_mesh.indices[i + 2]]};
+      if (tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2])
+        continue;
+
+      // Skip duplicates regardless of their winding's starting vertex
+      auto key = tri;
+      std::rotate(key.begin(), std::min_element(key.begin(), key.end()),
+          key.end());
+      if (!triangles.insert(key).second)
+        continue;
+      result.indices.insert(result.indices.end(), tri.begin(), tri.end());
+    }
+    return result;
+  }
+
+  /// \brief Write a mesh in the Wavefront OBJ format.
+  /// \param[in] _mesh Mesh to write.
+  /// \param[out] _out Stream to write to.
+  inline void writeObj(const TriangleSoup &_mesh, std::ostream &_out)
+  {
+    _out.precision(std::numeric_limits<double>::max_digits10);
+    for (const auto &vertex : _mesh.vertices)
+    {
+      _out << "v " << vertex.X() << " " << vertex.Y() << " " << vertex.Z()
+           << "\n";
+    }
+    for (std::size_t i = 0; i + 2 < _mesh.indices.size(); i += 3)
+    {
+      _out << "f " << _mesh.indices[i] + 1 << " " << _mesh.indices[i + 1] + 1
+           << " " << _mesh.indices[i + 2] + 1 << "\n";
+    }
+  }
+
+  /// \brief Encode a mesh into a compact binary blob, which can be decoded
+  /// with decodeTriangleSoup without parsing the original mesh file, see
+  /// SharedAssetStore.
+  /// \param[in] _mesh Mesh to encode.
+  /// \return Vertex and index counts, followed by the vertices and indices.
+  inline std::string encodeTriangleSoup(const TriangleSoup &_mesh)
+  {
+    const uint64_t counts[2]{_mesh.vertices.size(), _mesh.indices.size()};
+    std::string data(sizeof(counts) +
+        counts[0] * 3 * sizeof(double) + counts[1] * sizeof(uint32_t), '\0');
+    char *out = &data[0];
+    std::memcpy(out, counts, sizeof(counts));
+    out += sizeof(counts);
+    for (const auto &vertex : _mesh.vertices)
+    {
+      const double xyz[3]{vertex.X(), vertex.Y(), vertex.Z()};
+      std::memcpy(out, xyz, sizeof(xyz));
+      out += sizeof(xyz);
+    }
+    for (auto index : _mesh.indices)
+    {
+      const auto index32 = static_cast<uint32_t>(index);
+      std::memcpy(out, &index32, sizeof(index32));
+      out += sizeof(index32);
+    }
+    return data;
+  }
+
+  /// \brief Decode a mesh encoded by encodeTriangleSoup.
+  /// \param[in] _data Encoded mesh.
+  /// \param[out] _mesh Decoded mesh.
+  /// \return False if the data is truncated or has out of range indices.
+  inline bool decodeTriangleSoup(std::string_view _data, TriangleSoup &_mesh)
+  {
+    uint64_t counts[2];
+    if (_data.size() < sizeof(counts))
+      return false;
+    std::memcpy(counts, _data.data(), sizeof(counts));
+    if (counts[0] > _data.size() || counts[1] > _data.size() ||
+        _data.size() != sizeof(counts) + counts[0] * 3 * sizeof(double) +
+        counts[1] * sizeof(uint32_t))
+    {
+      return false;
+    }
+
+    const char *in = _data.data() + sizeof(counts);
+    _mesh.vertices.resize(counts[0]);
+    for (auto &vertex : _mesh.vertices)
+    {
+      double xyz[3];
+      std::memcpy(xyz, in, sizeof(xyz));
+      in += sizeof(xyz);
+      vertex.Set(xyz[0], xyz[1], xyz[2]);
+    }
+    _mesh.indices.resize(counts[1]);
+    for (auto &index : _mesh.indices)
+    {
+      uint32_t index32;
+      std::memcpy(&index32, in, sizeof(index32));
+      in += sizeof(index32);
+      if (index32 >= counts[0])
+        return false;
+      index = index32;
+    }
+    return true;
+  }
+}
+}
+}
+
+#endif
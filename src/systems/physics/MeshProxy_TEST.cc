@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "MeshProxy.hh"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ignition;
+using namespace ignition::gazebo;
+using namespace ignition::gazebo::systems::physics_system;
+
+/////////////////////////////////////////////////
+/// \brief Check that all points are inside or on a hull, and that its
+/// triangles face outwards.
+void expectEnclosed(const TriangleSoup &_hull,
+    const std::vector<math::Vector3d> &_points)
+{
+  for (std::size_t i = 0; i + 2 < _hull.indices.size(); i += 3)
+  {
+    const auto &a = _hull.vertices[_hull.indices[i]];
+    const auto &b = _hull.vertices[_hull.indices[i + 1]];
+    const auto &c = _hull.vertices[_hull.indices[i + 2]];
+    const auto normal = (b - a).Cross(c - a);
+    for (const auto &point : _points)
+      EXPECT_LE(normal.Dot(point - a), 1e-9);
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(MeshProxy, ConvexHull)
+{
+  std::vector<math::Vector3d> points;
+  for (int x : {-1, 1})
+    for (int y : {-1, 1})
+      for (int z : {-1, 1})
+        points.emplace_back(x, y, z);
+  // Interior points and points on faces aren't part of the hull
+  points.emplace_back(0, 0, 0);
+  points.emplace_back(0.5, -0.2, 0.1);
+  points.emplace_back(1, 0, 0);
+
+  auto hull = convexHull(points);
+  EXPECT_EQ(8u, hull.vertices.size());
+  EXPECT_EQ(36u, hull.indices.size());
+  expectEnclosed(hull, points);
+
+  // Points on a plane have no hull
+  std::vector<math::Vector3d> flat{{0, 0, 0}, {1, 0, 0}, {0, 1, 0},
+      {1, 1, 0}, {0.5, 0.5, 0}};
+  EXPECT_TRUE(convexHull(flat).indices.empty());
+  EXPECT_TRUE(convexHull({{0, 0, 0}, {1, 0, 0}}).indices.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(MeshProxy, ConvexHullSphere)
+{
+  std::vector<math::Vector3d> points;
+  for (int i = 0; i < 20; ++i)
+  {
+    for (int j = 0; j < 20; ++j)
+    {
+      double theta = 3.14159 * (i + 0.5) / 20;
+      double phi = 2 * 3.14159 * j / 20;
+      points.emplace_back(std::sin(theta) * std::cos(phi),
+          std::sin(theta) * std::sin(phi), std::cos(theta));
+      points.push_back(points.back() * 0.5);
+    }
+  }
+
+  auto hull = convexHull(points);
+  EXPECT_EQ(400u, hull.vertices.size());
+  // A closed triangulation of a sphere has 2V - 4 triangles
+  EXPECT_EQ((2 * 400u - 4) * 3, hull.indices.size());
+  expectEnclosed(hull, points);
+}
+
+/////////////////////////////////////////////////
+TEST(MeshProxy, Simplify)
+{
+  // Flat grid of 10x10 quads
+  TriangleSoup grid;
+  for (int y = 0; y <= 10; ++y)
+    for (int x = 0; x <= 10; ++x)
+      grid.vertices.emplace_back(x, y, 0);
+  for (unsigned int y = 0; y < 10; ++y)
+  {
+    for (unsigned int x = 0; x < 10; ++x)
+    {
+      unsigned int i = y * 11 + x;
+      grid.indices.insert(grid.indices.end(), {i, i + 1, i + 12});
+      grid.indices.insert(grid.indices.end(), {i, i + 12, i + 11});
+    }
+  }
+
+  // A resolution finer than the samples changes nothing
+  auto same = simplify(grid, 20);
+  EXPECT_EQ(grid.vertices.size(), same.vertices.size());
+  EXPECT_EQ(grid.indices.size(), same.indices.size());
+
+  auto coarse = simplify(grid, 2);
+  EXPECT_LT(coarse.vertices.size(), 10u);
+  EXPECT_LT(coarse.indices.size(), grid.indices.size() / 10);
+  EXPECT_FALSE(coarse.indices.empty());
+  for (auto index : coarse.indices)
+    EXPECT_LT(index, coarse.vertices.size());
+
+  EXPECT_TRUE(simplify(TriangleSoup(), 2).vertices.empty());
+}
+
+/////////////////////////////////////////////////
+TEST(MeshProxy, ParseMode)
+{
+  ProxyMode mode{ProxyMode::NONE};
+  EXPECT_TRUE(parseProxyMode("convex_hull", mode));
+  EXPECT_EQ(ProxyMode::CONVEX_HULL, mode);
+  EXPECT_TRUE(parseProxyMode("simplify", mode));
+  EXPECT_EQ(ProxyMode::SIMPLIFY, mode);
+  EXPECT_FALSE(parseProxyMode("decompose", mode));
+  EXPECT_EQ(ProxyMode::SIMPLIFY, mode);
+  EXPECT_TRUE(parseProxyMode("none", mode));
+  EXPECT_EQ(ProxyMode::NONE, mode);
+}
+
+/////////////////////////////////////////////////
+TEST(MeshProxy, WriteObj)
+{
+  TriangleSoup mesh;
+  mesh.vertices = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}};
+  mesh.indices = {0, 1, 2};
+
+  std::ostringstream out;
+  writeObj(mesh, out);
+  EXPECT_EQ("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", out.str());
+}
+
+/////////////////////////////////////////////////
+TEST(MeshProxy, EncodeDecode)
+{
+  TriangleSoup mesh;
+  mesh.vertices = {{0, 0, 0}, {1.5, 0, -2}, {0, 1, 0.25}, {3, 2, 1}};
+  mesh.indices = {0, 1, 2, 2, 1, 3};
+
+  const auto data = encodeTriangleSoup(mesh);
+  TriangleSoup decoded;
+  ASSERT_TRUE(decodeTriangleSoup(data, decoded));
+  ASSERT_EQ(mesh.vertices.size(), decoded.vertices.size());
+  for (std::size_t i = 0; i < mesh.vertices.size(); ++i)
+    EXPECT_EQ(mesh.vertices[i], decoded.vertices[i]);
+  EXPECT_EQ(mesh.indices, decoded.indices);
+
+  EXPECT_TRUE(decodeTriangleSoup(encodeTriangleSoup(TriangleSoup()),
+      decoded));
+  EXPECT_TRUE(decoded.vertices.empty());
+  EXPECT_TRUE(decoded.indices.empty());
+
+  // Truncated data and out of range indices
+  EXPECT_FALSE(decodeTriangleSoup(data.substr(0, data.size() - 1), decoded));
+  EXPECT_FALSE(decodeTriangleSoup(std::string("abc"), decoded));
+  mesh.indices.back() = 4;
+  EXPECT_FALSE(decodeTriangleSoup(encodeTriangleSoup(mesh), decoded));
+}
@@ -23,16 +23,30 @@
 #include <ignition/msgs/Utility.hh>
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <deque>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory_resource>
+#include <optional>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include <ignition/common/Mesh.hh>
 #include <ignition/common/MeshManager.hh>
+#include <ignition/common/Filesystem.hh>
 #include <ignition/common/Profiler.hh>
+#include <ignition/common/SubMesh.hh>
 #include <ignition/common/SystemPaths.hh>
+#include <ignition/common/Util.hh>
 #include <ignition/math/AxisAlignedBox.hh>
 #include <ignition/math/eigen3/Conversions.hh>
 #include <ignition/math/Vector3.hh>
@@ -76,6 +90,7 @@
 #include <sdf/World.hh>
 
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SharedAssetStore.hh"
 #include "ignition/gazebo/Util.hh"
 
 // Components
@@ -120,6 +135,8 @@
 #include "ignition/gazebo/components/World.hh"
 
 #include "EntityFeatureMap.hh"
+#include "EntitySlotMap.hh"
+#include "MeshProxy.hh"
 
 using namespace ignition;
 using namespace ignition::gazebo;
@@ -127,6 +144,301 @@ using namespace ignition::gazebo::systems;
 using namespace ignition::gazebo::systems::physics_system;
 namespace components = ignition::gazebo::components;
 
+namespace
+{
+/// \brief A component to be written by a parallel pass, and whether its
+/// value changed, so the change can be reported afterwards.
+/// \tparam ComponentT Component type.
+template <typename ComponentT>
+struct WriteBackSlot
+{
+  /// \brief The component, nullptr if the entity doesn't have it.
+  ComponentT *component{nullptr};
+
+  /// \brief True if the pass changed the component's value.
+  bool changed{false};
+
+  /// \brief Look up the component. Must be called before the parallel
+  /// pass, since looking up mutable components isn't thread safe.
+  /// \param[in] _ecm Entity component manager.
+  /// \param[in] _entity Entity which owns the component.
+  void Acquire(EntityComponentManager &_ecm, const Entity _entity)
+  {
+    this->component = _ecm.Component<ComponentT>(_entity);
+    this->changed = false;
+  }
+
+  /// \brief Set the component's value, if the entity has the component.
+  /// \param[in] _data New value.
+  /// \param[in] _eql Equality comparison function.
+  template <typename DataT, typename EqualT>
+  void Write(const DataT &_data, const EqualT &_eql)
+  {
+    if (nullptr != this->component)
+      this->changed = this->component->SetData(_data, _eql);
+  }
+
+  /// \brief Report whether the component changed, after the parallel pass.
+  /// \param[in] _ecm Entity component manager.
+  /// \param[in] _entity Entity which owns the component.
+  void Apply(EntityComponentManager &_ecm, const Entity _entity) const
+  {
+    if (nullptr == this->component)
+      return;
+    _ecm.SetChanged(_entity, ComponentT::typeId, this->changed ?
+        ComponentState::PeriodicChange : ComponentState::NoChange);
+  }
+};
+
+/// \brief Components of a link which moved in the latest step.
+struct LinkWriteBack
+{
+  /// \brief Link entity.
+  Entity entity{kNullEntity};
+
+  /// \brief Link frame data from physics.
+  const physics::FrameData3d *frameData{nullptr};
+
+  /// \brief World pose of the parent model, nullptr for canonical links,
+  /// whose pose is set with their model's.
+  const math::Pose3d *parentWorldPose{nullptr};
+
+  /// \brief Pose relative to the parent model, only set if parentWorldPose
+  /// is set.
+  components::Pose *pose{nullptr};
+
+  /// \brief World frame quantities.
+  WriteBackSlot<components::WorldPose> worldPose;
+  WriteBackSlot<components::WorldLinearVelocity> worldLinearVelocity;
+  WriteBackSlot<components::WorldAngularVelocity> worldAngularVelocity;
+  WriteBackSlot<components::WorldLinearAcceleration> worldLinearAcceleration;
+  WriteBackSlot<components::WorldAngularAcceleration>
+      worldAngularAcceleration;
+
+  /// \brief Body frame quantities.
+  WriteBackSlot<components::LinearVelocity> linearVelocity;
+  WriteBackSlot<components::AngularVelocity> angularVelocity;
+  WriteBackSlot<components::LinearAcceleration> linearAcceleration;
+  WriteBackSlot<components::AngularAcceleration> angularAcceleration;
+};
+
+/// \brief A component of an entity attached to a link, such as a sensor or
+/// a collision, whose value follows the link.
+struct OffsetWriteBack
+{
+  /// \brief Frame data of the parent link.
+  const physics::FrameData3d *linkFrameData{nullptr};
+
+  /// \brief Pose of the entity relative to the link.
+  const math::Pose3d *offset{nullptr};
+
+  /// \brief Only one of these is set.
+  components::WorldPose *worldPose{nullptr};
+  components::WorldLinearVelocity *worldLinearVelocity{nullptr};
+  components::AngularVelocity *angularVelocity{nullptr};
+  components::LinearAcceleration *linearAcceleration{nullptr};
+};
+
+/// \brief Frame data of links, keyed by link entity. It's rebuilt every
+/// step, so it's allocated from memory which only lives for one iteration.
+using LinkFrameDataMap =
+    std::pmr::unordered_map<Entity, physics::FrameData3d>;
+
+/// \brief Frame data of a point fixed to a link. This is what the engine
+/// computes when resolving a frame attached to the link, without querying
+/// the engine, so it's safe to call concurrently.
+/// \param[in] _link Frame data of the link.
+/// \param[in] _offset Pose of the point relative to the link.
+/// \return Frame data of the point relative to the world.
+physics::FrameData3d FrameDataAtOffset(const physics::FrameData3d &_link,
+    const math::Pose3d &_offset)
+{
+  physics::FrameData3d result;
+  result.pose = _link.pose * math::eigen3::convert(_offset);
+
+  const Eigen::Vector3d r = _link.pose.linear() *
+      math::eigen3::convert(_offset.Pos());
+  const Eigen::Vector3d &w = _link.angularVelocity;
+  result.linearVelocity = _link.linearVelocity + w.cross(r);
+  result.angularVelocity = w;
+  result.linearAcceleration = _link.linearAcceleration +
+      _link.angularAcceleration.cross(r) + w.cross(w.cross(r));
+  result.angularAcceleration = _link.angularAcceleration;
+  return result;
+}
+
+/// \brief Assigns top-level models to partitions of the physics system,
+/// each of which is simulated by its own engine instance, so they can be
+/// stepped in parallel. Models in different partitions don't interact.
+/// Static models are simulated by all partitions.
+class PhysicsPartitioning
+{
+  /// \brief How models are grouped into partitions.
+  public: enum class Criterion
+  {
+    /// \brief Models whose collide bitmasks don't overlap are put in
+    /// different partitions, since they can't collide anyway.
+    COLLIDE_BITMASK,
+
+    /// \brief Models are put in partitions according to the cell of a
+    /// horizontal grid where they're spawned. They're expected to stay away
+    /// from models spawned in other cells.
+    SPATIAL
+  };
+
+  /// \brief Partition of models which are in all partitions.
+  public: static constexpr std::size_t kAllPartitions =
+      std::numeric_limits<std::size_t>::max();
+
+  /// \brief Constructor
+  /// \param[in] _criterion How models are grouped.
+  /// \param[in] _count Number of partitions, at least 2.
+  /// \param[in] _cellSize Size of the grid cells, for SPATIAL.
+  public: PhysicsPartitioning(Criterion _criterion, std::size_t _count,
+      double _cellSize)
+    : criterion(_criterion), masks(_count, 0), modelCounts(_count, 0),
+      cellSize(_cellSize)
+  {
+  }
+
+  /// \brief Get the number of partitions.
+  /// \return Number of partitions.
+  public: std::size_t Count() const
+  {
+    return this->modelCounts.size();
+  }
+
+  /// \brief Get the partition of a top-level model, assigning it the first
+  /// time the model is seen.
+  /// \param[in] _model Top-level model entity.
+  /// \param[in] _ecm Entity component manager.
+  /// \return Partition index, or kAllPartitions.
+  public: std::size_t PartitionOf(const Entity _model,
+      const EntityComponentManager &_ecm)
+  {
+    if (auto partition = this->assignments.Get(_model))
+      return *partition;
+
+    const std::size_t partition = this->Assign(_model, _ecm);
+    this->assignments.Insert(_model, partition);
+    if (partition != kAllPartitions)
+      ++this->modelCounts[partition];
+    return partition;
+  }
+
+  /// \brief Forget removed top-level models.
+  /// \param[in] _ecm Entity component manager.
+  public: void RemoveModels(const EntityComponentManager &_ecm)
+  {
+    _ecm.EachRemoved<components::Model>(
+        [&](const Entity &_entity, const components::Model *) -> bool
+        {
+          auto partition = this->assignments.Get(_entity);
+          if (nullptr == partition)
+            return true;
+          if (*partition != kAllPartitions)
+            --this->modelCounts[*partition];
+          this->assignments.Erase(_entity);
+          return true;
+        });
+  }
+
+  /// \brief Choose the partition of a new top-level model.
+  /// \param[in] _model Top-level model entity.
+  /// \param[in] _ecm Entity component manager.
+  /// \return Partition index, or kAllPartitions.
+  private: std::size_t Assign(const Entity _model,
+      const EntityComponentManager &_ecm)
+  {
+    auto staticComp = _ecm.Component<components::Static>(_model);
+    if (staticComp && staticComp->Data())
+      return kAllPartitions;
+
+    if (this->criterion == Criterion::SPATIAL)
+    {
+      auto pose = _ecm.Component<components::Pose>(_model);
+      const math::Vector3d pos = pose ? pose->Data().Pos() :
+          math::Vector3d::Zero;
+      const std::pair<int64_t, int64_t> cell{
+          static_cast<int64_t>(std::floor(pos.X() / this->cellSize)),
+          static_cast<int64_t>(std::floor(pos.Y() / this->cellSize))};
+
+      // Cells are spread over the partitions in the order they're first
+      // used, which is deterministic for a given world
+      auto cellIt = this->cells.find(cell);
+      if (cellIt == this->cells.end())
+      {
+        cellIt = this->cells.emplace(cell,
+            this->cells.size() % this->Count()).first;
+      }
+      return cellIt->second;
+    }
+
+    uint16_t mask{0};
+    _ecm.EachDescendantDepthFirst(_model, [&](const Entity &_entity) -> bool
+        {
+          auto collision = _ecm.Component<components::CollisionElement>(
+              _entity);
+          if (collision && collision->Data().Surface() &&
+              collision->Data().Surface()->Contact())
+          {
+            mask |= collision->Data().Surface()->Contact()->CollideBitmask();
+          }
+          return true;
+        });
+
+    // Models which may collide with the models of a partition join it.
+    // Others join the partition with the fewest models.
+    std::size_t partition{kAllPartitions};
+    for (std::size_t i = 0; i < this->Count(); ++i)
+    {
+      if ((this->masks[i] & mask) == 0)
+        continue;
+
+      if (partition == kAllPartitions)
+      {
+        partition = i;
+      }
+      else
+      {
+        ignwarn << "Model [" << _model << "] may collide with models of "
+                << "partitions [" << partition << "] and [" << i << "], but "
+                << "it's only simulated in partition [" << partition
+                << "]." << std::endl;
+        break;
+      }
+    }
+
+    if (partition == kAllPartitions)
+    {
+      partition = static_cast<std::size_t>(std::distance(
+          this->modelCounts.begin(), std::min_element(
+            this->modelCounts.begin(), this->modelCounts.end())));
+    }
+    this->masks[partition] |= mask;
+    return partition;
+  }
+
+  /// \brief How models are grouped.
+  private: Criterion criterion;
+
+  /// \brief Partition of each top-level model.
+  private: EntitySlotMap<std::size_t> assignments;
+
+  /// \brief Combined collide bitmask of the models of each partition.
+  private: std::vector<uint16_t> masks;
+
+  /// \brief Number of models of each partition, not counting static ones.
+  private: std::vector<std::size_t> modelCounts;
+
+  /// \brief Size of the grid cells.
+  private: double cellSize{10.0};
+
+  /// \brief Partition of each grid cell in use.
+  private: std::map<std::pair<int64_t, int64_t>, std::size_t> cells;
+};
+}
+
 
 // Private data class.
 class ignition::gazebo::systems::PhysicsPrivate
@@ -187,15 +499,18 @@ class ignition::gazebo::systems::PhysicsPrivate
               const std::chrono::steady_clock::duration &_dt);
 
   /// \brief Get data of links that were updated in the latest physics step.
-  /// \param[in] _ecm Mutable reference to ECM.
   /// \param[in] _updatedLinks Updated link poses from the latest physics step
   /// that were written to by the physics engine (some physics engines may
-  /// not write this data to ForwardStep::Output. If not, _ecm is used to get
-  /// this updated link pose data).
+  /// not write this data to ForwardStep::Output. If not, the poses of
+  /// dynamicLinks are compared to the previous ones). Links which moved in
+  /// the previous step but not in this one are included once more, so their
+  /// final velocities and accelerations are written.
+  /// \param[in] _memory Memory the result is allocated from, such as
+  /// EntityComponentManager::StepMemory.
   /// \return A map of gazebo link entities to their updated pose data.
-  public: std::unordered_map<Entity, physics::FrameData3d> ChangedLinks(
-              EntityComponentManager &_ecm,
-              const ignition::physics::ForwardStep::Output &_updatedLinks);
+  public: LinkFrameDataMap ChangedLinks(
+              const ignition::physics::ForwardStep::Output &_updatedLinks,
+              std::pmr::memory_resource *_memory);
 
   /// \brief Update components from physics simulation
   /// \param[in] _ecm Mutable reference to ECM.
@@ -203,19 +518,18 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// most recent physics step. The key is the entity of the link, and the
   /// value is the updated frame data corresponding to that entity.
   public: void UpdateSim(EntityComponentManager &_ecm,
-              const std::unordered_map<
-                Entity, physics::FrameData3d> &_linkFrameData);
+              const LinkFrameDataMap &_linkFrameData);
 
-  /// \brief Update collision components from physics simulation
+  /// \brief Update collision components from physics simulation. Partitions
+  /// other than the first one add their contacts to those set by the first
+  /// partition.
   /// \param[in] _ecm Mutable reference to ECM.
   public: void UpdateCollisions(EntityComponentManager &_ecm);
 
-  /// \brief FrameData relative to world at a given offset pose
-  /// \param[in] _link ign-physics link
-  /// \param[in] _pose Offset pose in which to compute the frame data
-  /// \returns FrameData at the given offset pose
-  public: physics::FrameData3d LinkFrameDataAtOffset(
-      const LinkPtrType &_link, const math::Pose3d &_pose) const;
+  /// \brief Clear commands and resets once they have been applied by all
+  /// partitions.
+  /// \param[in] _ecm Mutable reference to ECM.
+  public: void ClearCommands(EntityComponentManager &_ecm);
 
   /// \brief Get transform from one ancestor entity to a descendant entity
   /// that are in the same model.
@@ -227,24 +541,227 @@ class ignition::gazebo::systems::PhysicsPrivate
 
   /// \brief Cache the top-level model for each entity.
   /// The key is an entity and the value is its top level model.
-  public: std::unordered_map<Entity, Entity> topLevelModelMap;
+  public: EntitySlotMap<Entity> topLevelModelMap;
 
   /// \brief Keep track of what entities are static (models and links).
   public: std::unordered_set<Entity> staticEntities;
 
-  /// \brief Keep track of poses for links attached to non-static models.
-  /// This allows for skipping pose updates if a link's pose didn't change
-  /// after a physics step.
-  public: std::unordered_map<Entity, ignition::math::Pose3d> linkWorldPoses;
+  /// \brief A link attached to a non-static model.
+  public: struct DynamicLink
+  {
+    /// \brief Link entity.
+    Entity entity{kNullEntity};
+
+    /// \brief Physics link.
+    LinkPtrType link;
+
+    /// \brief World pose when the link was last reported as changed, unset
+    /// if it never was. This allows for skipping pose updates if a link's
+    /// pose didn't change after a physics step.
+    std::optional<math::Pose3d> lastWorldPose;
+  };
+
+  /// \brief Links attached to non-static models, which are the only ones
+  /// checked for changes when the physics engine doesn't report them, so
+  /// static links don't cost anything per step.
+  public: std::vector<DynamicLink> dynamicLinks;
+
+  /// \brief Index of each link in dynamicLinks.
+  public: EntitySlotMap<std::size_t> dynamicLinkIndices;
+
+  /// \brief Remove a link from dynamicLinks, if it's there.
+  /// \param[in] _entity Link entity.
+  public: void RemoveDynamicLink(const Entity _entity);
+
+  /// \brief Top level models which may have moved since their bounding boxes
+  /// were last computed, either because some of their links changed during a
+  /// physics step or because they were teleported.
+  public: std::unordered_set<Entity> movedModels;
+
+  /// \brief Models whose AxisAlignedBox component has been populated. Their
+  /// boxes are only computed again when they move.
+  public: std::unordered_set<Entity> boxedModels;
 
   /// \brief Keep track of non-static model world poses. Since non-static
   /// models may not move on a given iteration, we want to keep track of the
   /// most recent model world pose change that took place.
-  public: std::unordered_map<Entity, math::Pose3d> modelWorldPoses;
+  public: EntitySlotMap<math::Pose3d> modelWorldPoses;
 
   /// \brief A map between model entity ids in the ECM to whether its battery
   /// has drained.
-  public: std::unordered_map<Entity, bool> entityOffMap;
+  public: EntitySlotMap<bool> entityOffMap;
+
+  /// \brief Change token for battery states, so only batteries whose state
+  /// of charge changed are visited, see EntityComponentManager::EachChanged.
+  public: uint64_t batteryToken{0};
+
+  /// \brief Get the mesh of a mesh collision, loading it only if no mesh
+  /// with the same path or the same file contents was loaded before.
+  /// \param[in] _fullPath Full path to the mesh file.
+  /// \return The mesh, or nullptr if it couldn't be loaded.
+  public: const common::Mesh *CollisionMesh(const std::string &_fullPath);
+
+  /// \brief Collision meshes by full path.
+  public: std::unordered_map<std::string, const common::Mesh *> meshesByPath;
+
+  /// \brief A collision mesh and the file it was loaded from.
+  public: struct MeshSource
+  {
+    /// \brief Full path of the file.
+    std::string path;
+
+    /// \brief Size of the file contents.
+    std::size_t size{0};
+
+    /// \brief The mesh.
+    const common::Mesh *mesh{nullptr};
+  };
+
+  /// \brief Collision meshes by hash of their file contents, so identical
+  /// copies of a mesh at different paths are only loaded once. Hashes may
+  /// collide, so contents are compared before a mesh is reused.
+  public: std::unordered_multimap<std::size_t, MeshSource> meshesByContent;
+
+  /// \brief Hash of the file contents of each collision mesh.
+  public: std::unordered_map<const common::Mesh *, std::size_t> meshHashes;
+
+  /// \brief Get a collision mesh from the shared asset store, storing it
+  /// there if no process stored it yet.
+  /// \param[in] _fullPath Full path to the mesh file.
+  /// \param[in] _contents Contents of the mesh file.
+  /// \return The mesh, or nullptr if it couldn't be loaded.
+  public: const common::Mesh *SharedMesh(const std::string &_fullPath,
+              const std::string &_contents);
+
+  /// \brief Store of collision meshes shared with other processes, nullptr
+  /// unless enabled with `<shared_assets>`.
+  public: std::shared_ptr<SharedAssetStore> assetStore;
+
+  /// \brief Collision meshes decoded from the shared asset store.
+  public: std::vector<std::unique_ptr<common::Mesh>> sharedMeshes;
+
+  /// \brief Get the proxy of a collision mesh, generating it if it isn't
+  /// cached on disk yet.
+  /// \param[in] _mesh Collision mesh, see CollisionMesh.
+  /// \param[in] _mode How the mesh is replaced.
+  /// \param[in] _minTriangles Meshes with fewer triangles are used as is.
+  /// \return The proxy, or _mesh if it doesn't need one or generating it
+  /// failed.
+  public: const common::Mesh *CollisionProxy(const common::Mesh *_mesh,
+              physics_system::ProxyMode _mode, std::size_t _minTriangles);
+
+  /// \brief Proxy mode of meshes whose collision has no hint.
+  public: physics_system::ProxyMode proxyMode{
+              physics_system::ProxyMode::NONE};
+
+  /// \brief Cells along the longest side of simplified meshes.
+  public: unsigned int proxyResolution{32};
+
+  /// \brief Meshes with fewer triangles than this don't get a proxy.
+  public: std::size_t proxyMinTriangles{1000};
+
+  /// \brief Directory where proxies are cached.
+  public: std::string proxyCacheDir;
+
+  /// \brief Proxies by cache file path.
+  public: std::unordered_map<std::string, const common::Mesh *> proxies;
+
+  /// \brief Check whether this partition simulates an entity, see
+  /// PhysicsPartitioning, and the entity's model isn't waiting to be created.
+  /// \param[in] _entity Entity of a model or one of its descendants.
+  /// \param[in] _ecm Entity component manager.
+  /// \return True if the entity's model isn't deferred, and the system isn't
+  /// partitioned or the entity belongs to this partition or to all of them.
+  public: bool Owns(const Entity _entity, const EntityComponentManager &_ecm);
+
+  /// \brief Check whether an entity belongs to this partition, see
+  /// PhysicsPartitioning.
+  /// \param[in] _entity Entity of a model or one of its descendants.
+  /// \param[in] _ecm Entity component manager.
+  /// \return True if the system isn't partitioned, or the entity belongs to
+  /// this partition or to all of them.
+  public: bool InPartition(const Entity _entity,
+              const EntityComponentManager &_ecm);
+
+  /// \brief Maximum number of top level models created per step, 0 for no
+  /// limit. Models spawned beyond it are created in later steps, in the order
+  /// they were spawned.
+  public: std::size_t maxNewModelsPerStep{0};
+
+  /// \brief Top level models waiting to be created, oldest first. Models
+  /// removed while waiting are skipped.
+  public: std::deque<Entity> pendingModels;
+
+  /// \brief Top level models waiting to be created. Their entities are
+  /// ignored until they're admitted.
+  public: std::unordered_set<Entity> deferredModels;
+
+  /// \brief Top level models which stopped waiting on this step, and whose
+  /// entities are created even though they aren't new.
+  public: std::unordered_set<Entity> admittedModels;
+
+  /// \brief Call a creation function for the entities of models admitted on
+  /// this step.
+  /// \param[in] _ecm Entity component manager.
+  /// \param[in] _f Creation function, as passed to EachNew.
+  public: template <typename ...ComponentTypeTs, typename FunctionT>
+          void EachAdmitted(const EntityComponentManager &_ecm, FunctionT &_f)
+  {
+    if (this->admittedModels.empty())
+      return;
+
+    _ecm.Each<ComponentTypeTs...>(
+        [&](const Entity &_entity,
+            const ComponentTypeTs *..._components) -> bool
+        {
+          if (this->admittedModels.find(topLevelModel(_entity, _ecm)) ==
+              this->admittedModels.end())
+          {
+            return true;
+          }
+          return _f(_entity, _components...);
+        });
+  }
+
+  /// \brief Choose which models are created on this step, according to
+  /// maxNewModelsPerStep.
+  /// \param[in] _ecm Entity component manager.
+  public: void AdmitNewModels(const EntityComponentManager &_ecm);
+
+  /// \brief Partitioning of models, shared by all partitions, nullptr if the
+  /// system isn't partitioned.
+  public: std::shared_ptr<PhysicsPartitioning> partitioning;
+
+  /// \brief Index of this partition.
+  public: std::size_t partition{0};
+
+  /// \brief All partitions, starting with this one. Only set on the first
+  /// partition.
+  public: std::vector<PhysicsPrivate *> partitions;
+
+  /// \brief Partitions other than this one, each with its own engine
+  /// instance. Only set on the first partition.
+  public: std::vector<std::unique_ptr<PhysicsPrivate>> otherPartitions;
+
+  /// \brief Links written back by the latest UpdateSim, kept to reuse
+  /// their memory.
+  public: std::vector<LinkWriteBack> linkWriteBacks;
+
+  /// \brief Entities attached to links written back by the latest
+  /// UpdateSim, kept to reuse their memory.
+  public: std::vector<OffsetWriteBack> offsetWriteBacks;
+
+  /// \brief Frame data of links which didn't move in the latest step, but
+  /// have attached entities whose components need to be initialized.
+  public: std::unordered_map<Entity, physics::FrameData3d>
+      restingLinkFrameData;
+
+  /// \brief Links which moved in the latest step, see ChangedLinks.
+  public: std::vector<Entity> movingLinks;
+
+  /// \brief Links which stopped moving in the latest step, kept to reuse
+  /// their memory.
+  public: std::vector<Entity> stoppedLinks;
 
   /// \brief Entities whose pose commands have been processed and should be
   /// deleted the following iteration.
@@ -335,6 +852,24 @@ class ignition::gazebo::systems::PhysicsPrivate
   public: using WorldShapeType = ignition::physics::World<
             ignition::physics::FeaturePolicy3d, CollisionFeatureList>;
 
+  /// \brief One side of a contact between two collisions, as seen from a
+  /// collision which has a ContactSensorData component.
+  public: struct ContactEntry
+  {
+    /// \brief Collision with the ContactSensorData component.
+    Entity collision{kNullEntity};
+
+    /// \brief The other collision in contact.
+    Entity other{kNullEntity};
+
+    /// \brief Contact point, owned by the contacts of the last step.
+    const WorldShapeType::ContactPoint *contact{nullptr};
+  };
+
+  /// \brief Contacts of the last step, sorted by collision and then by the
+  /// other collision. It's kept between steps so its memory is reused.
+  public: std::vector<ContactEntry> contactBuffer;
+
   //////////////////////////////////////////////////
   // Collision filtering with bitmasks
 
@@ -438,6 +973,106 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// ign-physics
   public: EntityJointMap entityJointMap;
 
+  /// \brief A joint which can receive commands from the ECM. Everything that
+  /// doesn't change during the joint's lifetime is resolved when it's
+  /// created, so applying commands doesn't need any map lookups.
+  public: struct JointCommandTarget
+  {
+    /// \brief Joint entity.
+    Entity entity{kNullEntity};
+
+    /// \brief Model entity containing the joint, whose battery may cut its
+    /// actuation.
+    Entity model{kNullEntity};
+
+    /// \brief Joint name, used in warnings.
+    std::string name;
+
+    /// \brief Physics joint.
+    EntityJointMap::RequiredEntityPtr joint;
+
+    /// \brief Physics joint with velocity commands, nullptr if the engine
+    /// doesn't support them.
+    EntityJointMap::PhysicsEntityPtr<JointVelocityCommandFeatureList>
+        velocityCommand;
+
+    /// \brief Number of degrees of freedom of the joint.
+    std::size_t dofs{0};
+
+    /// \brief Velocity reset gathered for the current step, if any.
+    const components::JointVelocityReset *velocityReset{nullptr};
+
+    /// \brief Position reset gathered for the current step, if any.
+    const components::JointPositionReset *positionReset{nullptr};
+
+    /// \brief Force command gathered for the current step, if any.
+    const components::JointForceCmd *force{nullptr};
+
+    /// \brief Velocity command gathered for the current step, if any.
+    const components::JointVelocityCmd *velocity{nullptr};
+  };
+
+  /// \brief Joints which can receive commands, stored contiguously so that
+  /// all commands of a step are applied in a single pass.
+  public: std::vector<JointCommandTarget> jointCommandTargets;
+
+  /// \brief Index of each joint in jointCommandTargets.
+  public: EntitySlotMap<std::size_t> jointCommandIndices;
+
+  /// \brief Remove a joint from jointCommandTargets, if it's there.
+  /// \param[in] _entity Joint entity.
+  public: void RemoveJointCommandTarget(const Entity _entity);
+
+  /// \brief Apply the joint commands and resets gathered on
+  /// jointCommandTargets.
+  /// \param[in] _target Joint to apply commands to.
+  public: void ApplyJointCommands(const JointCommandTarget &_target) const;
+
+  /// \brief Number of physics steps taken for each ECM iteration. Poses are
+  /// only written back to the ECM after the last one.
+  public: std::size_t substeps{1};
+
+  /// \brief A joint force or velocity command, which engines clear after
+  /// every step, so it's applied again before each substep.
+  public: struct JointSubstepCommand
+  {
+    /// \brief Physics joint receiving the forces.
+    EntityJointMap::RequiredEntityPtr joint;
+
+    /// \brief Physics joint receiving the velocity commands, nullptr for a
+    /// force command.
+    EntityJointMap::PhysicsEntityPtr<JointVelocityCommandFeatureList>
+        velocityCommand;
+
+    /// \brief Force or velocity for each degree of freedom.
+    std::vector<double> values;
+  };
+
+  /// \brief A link wrench, which engines clear after every step, so it's
+  /// applied again before each substep.
+  public: struct WrenchSubstepCommand
+  {
+    /// \brief Physics link receiving the wrench.
+    EntityLinkMap::PhysicsEntityPtr<LinkForceFeatureList> link;
+
+    /// \brief Force in the world frame.
+    Eigen::Vector3d force;
+
+    /// \brief Torque in the world frame.
+    Eigen::Vector3d torque;
+  };
+
+  /// \brief Joint commands of the current iteration, only recorded when
+  /// there's more than one substep.
+  public: std::vector<JointSubstepCommand> jointSubstepCommands;
+
+  /// \brief Link wrenches of the current iteration, only recorded when
+  /// there's more than one substep.
+  public: std::vector<WrenchSubstepCommand> wrenchSubstepCommands;
+
+  /// \brief Apply the commands recorded for substeps again.
+  public: void ApplySubstepCommands() const;
+
   /// \brief Collision EntityFeatureMap
   public: using EntityCollisionMap = EntityFeatureMap3d<
             physics::Shape,
@@ -450,6 +1085,11 @@ class ignition::gazebo::systems::PhysicsPrivate
   /// ign-physics.
   public: EntityCollisionMap entityCollisionMap;
 
+  /// \brief Change generation from which slip compliance commands haven't
+  /// been applied to their shapes yet. Shapes keep the last command, so
+  /// unchanged commands are skipped.
+  public: uint64_t slipComplianceGeneration{0};
+
   /// \brief FreeGroup EntityFeatureMap
   public: using EntityFreeGroupMap = EntityFeatureMap3d<
             physics::FreeGroup,
@@ -540,6 +1180,7 @@ void Physics::Configure(const Entity &_entity,
   }
 
   // Get the first plugin that works
+  std::string engineClassName;
   for (auto className : classNames)
   {
     auto plugin = pluginLoader.Instantiate(className);
@@ -555,6 +1196,7 @@ void Physics::Configure(const Entity &_entity,
     {
       igndbg << "Loaded [" << className << "] from library ["
              << pathToLib << "]" << std::endl;
+      engineClassName = className;
       break;
     }
 
@@ -577,7 +1219,120 @@ void Physics::Configure(const Entity &_entity,
     ignerr << "Failed to load a valid physics engine from [" << pathToLib
            << "]."
            << std::endl;
+    return;
+  }
+  this->dataPtr->partitions.push_back(this->dataPtr.get());
+
+  this->dataPtr->maxNewModelsPerStep =
+      _sdf->Get<unsigned int>("max_new_models_per_step", 0).first;
+  this->dataPtr->substeps = std::max(1u,
+      _sdf->Get<unsigned int>("substeps", 1).first);
+
+  if (_sdf->HasElement("collision_proxy"))
+  {
+    auto proxyElem = _sdf->Clone()->GetElement("collision_proxy");
+    auto mode = proxyElem->Get<std::string>("mode", "none").first;
+    if (!physics_system::parseProxyMode(mode, this->dataPtr->proxyMode))
+    {
+      ignerr << "Unknown <collision_proxy><mode> [" << mode
+             << "], meshes will be used as is." << std::endl;
+    }
+    this->dataPtr->proxyResolution = std::max(1u,
+        proxyElem->Get<unsigned int>("resolution", 32).first);
+    this->dataPtr->proxyMinTriangles =
+        proxyElem->Get<unsigned int>("min_triangles", 1000).first;
+    this->dataPtr->proxyCacheDir =
+        proxyElem->Get<std::string>("cache_dir", "").first;
+  }
+  if (this->dataPtr->proxyCacheDir.empty())
+  {
+    common::env(IGN_HOMEDIR, this->dataPtr->proxyCacheDir);
+    this->dataPtr->proxyCacheDir = common::joinPaths(
+        this->dataPtr->proxyCacheDir, ".ignition", "gazebo",
+        "collision_proxies");
+  }
+  if (!common::createDirectories(this->dataPtr->proxyCacheDir))
+  {
+    ignwarn << "Failed to create collision proxy cache ["
+            << this->dataPtr->proxyCacheDir << "], meshes will be used as is."
+            << std::endl;
+    this->dataPtr->proxyMode = physics_system::ProxyMode::NONE;
+  }
+
+  std::string sharedAssetsEnv;
+  if (_sdf->Get<bool>("shared_assets", false).first ||
+      (common::env("IGN_GAZEBO_SHARED_ASSETS", sharedAssetsEnv) &&
+      sharedAssetsEnv == "1"))
+  {
+    auto store = std::make_shared<SharedAssetStore>(
+        SharedAssetStore::DefaultDirectory());
+    if (store->Valid())
+      this->dataPtr->assetStore = store;
+  }
+
+  if (!_sdf->HasElement("partitions"))
+    return;
+
+  // Each additional partition is simulated by another instance of the engine
+  auto partitionsElem = _sdf->Clone()->GetElement("partitions");
+  const auto count = partitionsElem->Get<unsigned int>("count", 1).first;
+  const auto criterionStr =
+      partitionsElem->Get<std::string>("by", "collide_bitmask").first;
+  const auto cellSize = partitionsElem->Get<double>("cell_size", 10.0).first;
+
+  PhysicsPartitioning::Criterion criterion;
+  if (criterionStr == "collide_bitmask")
+  {
+    criterion = PhysicsPartitioning::Criterion::COLLIDE_BITMASK;
   }
+  else if (criterionStr == "spatial" && cellSize > 0.0)
+  {
+    criterion = PhysicsPartitioning::Criterion::SPATIAL;
+  }
+  else
+  {
+    ignerr << "Invalid <partitions> configuration, with <by> [" << criterionStr
+           << "] and <cell_size> [" << cellSize << "]. The world won't be "
+           << "partitioned." << std::endl;
+    return;
+  }
+
+  for (unsigned int i = 1; i < count; ++i)
+  {
+    auto partition = std::make_unique<PhysicsPrivate>();
+    partition->engine = ignition::physics::RequestEngine<
+      ignition::physics::FeaturePolicy3d,
+      PhysicsPrivate::MinimumFeatureList>::From(
+          pluginLoader.Instantiate(engineClassName));
+    if (nullptr == partition->engine)
+    {
+      ignerr << "Failed to create another instance of [" << engineClassName
+             << "], the world will have [" << i << "] partitions."
+             << std::endl;
+      break;
+    }
+    partition->partition = i;
+    partition->maxNewModelsPerStep = this->dataPtr->maxNewModelsPerStep;
+    partition->substeps = this->dataPtr->substeps;
+    partition->proxyMode = this->dataPtr->proxyMode;
+    partition->proxyResolution = this->dataPtr->proxyResolution;
+    partition->proxyMinTriangles = this->dataPtr->proxyMinTriangles;
+    partition->proxyCacheDir = this->dataPtr->proxyCacheDir;
+    partition->assetStore = this->dataPtr->assetStore;
+    this->dataPtr->partitions.push_back(partition.get());
+    this->dataPtr->otherPartitions.push_back(std::move(partition));
+  }
+
+  if (this->dataPtr->partitions.size() < 2)
+    return;
+
+  auto partitioning = std::make_shared<PhysicsPartitioning>(criterion,
+      this->dataPtr->partitions.size(), cellSize);
+  for (auto *partition : this->dataPtr->partitions)
+    partition->partitioning = partitioning;
+
+  igndbg << "Physics is split into [" << this->dataPtr->partitions.size()
+         << "] partitions by [" << criterionStr << "]." << std::endl;
 }
 
 //////////////////////////////////////////////////
@@ -598,21 +1353,46 @@ void Physics::Update(const UpdateInfo &_info, EntityComponentManager &_ecm)
 
   if (this->dataPtr->engine)
   {
-    this->dataPtr->CreatePhysicsEntities(_ecm);
-    this->dataPtr->UpdatePhysics(_ecm);
-    ignition::physics::ForwardStep::Output stepOutput;
+    const auto &partitions = this->dataPtr->partitions;
+    for (auto *partition : partitions)
+    {
+      partition->CreatePhysicsEntities(_ecm);
+      partition->UpdatePhysics(_ecm);
+    }
+
+    std::vector<ignition::physics::ForwardStep::Output> stepOutputs(
+        partitions.size());
     // Only step if not paused.
     if (!_info.paused)
     {
-      stepOutput = this->dataPtr->Step(_info.dt);
+      // Partitions don't share any state, so they're stepped in parallel
+      IGN_PROFILE_BEGIN("Step partitions");
+      _ecm.ParallelFor(partitions.size(), 1,
+          [&](std::size_t _begin, std::size_t _end)
+          {
+            for (std::size_t i = _begin; i < _end; ++i)
+              stepOutputs[i] = partitions[i]->Step(_info.dt);
+          });
+      IGN_PROFILE_END();
+    }
+
+    // Partitions write their results in order, so the results don't depend
+    // on which partition finished stepping first
+    for (std::size_t i = 0; i < partitions.size(); ++i)
+    {
+      auto changedLinks = partitions[i]->ChangedLinks(stepOutputs[i],
+          _ecm.StepMemory());
+      partitions[i]->UpdateSim(_ecm, changedLinks);
     }
-    auto changedLinks = this->dataPtr->ChangedLinks(_ecm, stepOutput);
-    this->dataPtr->UpdateSim(_ecm, changedLinks);
+    this->dataPtr->ClearCommands(_ecm);
 
     // Entities scheduled to be removed should be removed from physics after the
     // simulation step. Otherwise, since the to-be-removed entity still shows up
     // in the ECM::Each the UpdatePhysics and UpdateSim calls will have an error
-    this->dataPtr->RemovePhysicsEntities(_ecm);
+    for (auto *partition : partitions)
+      partition->RemovePhysicsEntities(_ecm);
+    if (this->dataPtr->partitioning)
+      this->dataPtr->partitioning->RemoveModels(_ecm);
   }
 }
 
@@ -644,8 +1424,9 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
         return true;
       });
 
-  _ecm.EachNew<components::Model, components::Name, components::Pose,
-            components::ParentEntity>(
+  this->AdmitNewModels(_ecm);
+
+  auto createModel =
       [&](const Entity &_entity,
           const components::Model *,
           const components::Name *_name,
@@ -660,6 +1441,8 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
                   << std::endl;
           return true;
         }
+        if (!this->Owns(_entity, _ecm))
+          return true;
         // TODO(anyone) Don't load models unless they have collisions
 
         // Check if parent world / model exists
@@ -704,15 +1487,15 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
             }
             auto modelPtrPhys = nestedModelFeature->ConstructNestedModel(model);
             this->entityModelMap.AddEntity(_entity, modelPtrPhys);
-            this->topLevelModelMap.insert(std::make_pair(_entity,
-                topLevelModel(_entity, _ecm)));
+            this->topLevelModelMap.Insert(_entity,
+                topLevelModel(_entity, _ecm));
           }
           else
           {
             auto modelPtrPhys = worldPtrPhys->ConstructModel(model);
             this->entityModelMap.AddEntity(_entity, modelPtrPhys);
-            this->topLevelModelMap.insert(std::make_pair(_entity,
-                topLevelModel(_entity, _ecm)));
+            this->topLevelModelMap.Insert(_entity,
+                topLevelModel(_entity, _ecm));
           }
         }
         // check if parent is a model (nested model)
@@ -751,8 +1534,8 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
             if (modelPtrPhys)
             {
               this->entityModelMap.AddEntity(_entity, modelPtrPhys);
-              this->topLevelModelMap.insert(std::make_pair(_entity,
-                  topLevelModel(_entity, _ecm)));
+              this->topLevelModelMap.Insert(_entity,
+                  topLevelModel(_entity, _ecm));
             }
             else
             {
@@ -770,10 +1553,13 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
         }
 
         return true;
-      });
+      };
+  _ecm.EachNew<components::Model, components::Name, components::Pose,
+            components::ParentEntity>(createModel);
+  this->EachAdmitted<components::Model, components::Name, components::Pose,
+            components::ParentEntity>(_ecm, createModel);
 
-  _ecm.EachNew<components::Link, components::Name, components::Pose,
-            components::ParentEntity>(
+  auto createLink =
       [&](const Entity &_entity,
         const components::Link * /* _link */,
         const components::Name *_name,
@@ -788,6 +1574,8 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
                   << std::endl;
           return true;
         }
+        if (!this->Owns(_entity, _ecm))
+          return true;
 
         // TODO(anyone) Don't load links unless they have collisions
 
@@ -805,8 +1593,9 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
         link.SetName(_name->Data());
         link.SetRawPose(_pose->Data());
 
-        if (this->staticEntities.find(_parent->Data()) !=
-            this->staticEntities.end())
+        const bool isStatic = this->staticEntities.find(_parent->Data()) !=
+            this->staticEntities.end();
+        if (isStatic)
         {
           this->staticEntities.insert(_entity);
         }
@@ -820,18 +1609,26 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
 
         auto linkPtrPhys = modelPtrPhys->ConstructLink(link);
         this->entityLinkMap.AddEntity(_entity, linkPtrPhys);
-        this->topLevelModelMap.insert(std::make_pair(_entity,
-            topLevelModel(_entity, _ecm)));
+        this->topLevelModelMap.Insert(_entity,
+            topLevelModel(_entity, _ecm));
+
+        if (!isStatic)
+        {
+          this->dynamicLinkIndices[_entity] = this->dynamicLinks.size();
+          this->dynamicLinks.push_back({_entity, linkPtrPhys, std::nullopt});
+        }
 
         return true;
-      });
+      };
+  _ecm.EachNew<components::Link, components::Name, components::Pose,
+            components::ParentEntity>(createLink);
+  this->EachAdmitted<components::Link, components::Name, components::Pose,
+            components::ParentEntity>(_ecm, createLink);
 
   // We don't need to add visuals to the physics engine.
 
   // collisions
-  _ecm.EachNew<components::Collision, components::Name, components::Pose,
-            components::Geometry, components::CollisionElement,
-            components::ParentEntity>(
+  auto createCollision =
       [&](const Entity &_entity,
           const components::Collision *,
           const components::Name *_name,
@@ -847,6 +1644,8 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
                    << std::endl;
           return true;
         }
+        if (!this->Owns(_entity, _ecm))
+          return true;
 
         // Check if parent link exists
         if (!this->entityLinkMap.HasEntity(_parent->Data()))
@@ -876,9 +1675,15 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
             return true;
           }
 
-          auto &meshManager = *ignition::common::MeshManager::Instance();
-          auto fullPath = asFullPath(meshSdf->Uri(), meshSdf->FilePath());
-          auto *mesh = meshManager.Load(fullPath);
+          auto fullPath = findResource(meshSdf->Uri(), meshSdf->FilePath());
+          if (fullPath.empty())
+          {
+            ignwarn << "Failed to find mesh [" << meshSdf->Uri()
+                    << "] for collision [" << _name->Data() << "]."
+                    << std::endl;
+            return true;
+          }
+          auto *mesh = this->CollisionMesh(fullPath);
           if (nullptr == mesh)
           {
             ignwarn << "Failed to load mesh from [" << fullPath
@@ -886,6 +1691,27 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
             return true;
           }
 
+          // A hint on the collision overrides the proxy policy, whatever
+          // the size of the mesh
+          auto proxyMode = this->proxyMode;
+          auto minTriangles = this->proxyMinTriangles;
+          auto collisionElem = collision.Element();
+          if (collisionElem &&
+              collisionElem->HasElement("ignition:collision_proxy"))
+          {
+            auto hint = collisionElem->GetElement(
+                "ignition:collision_proxy")->Get<std::string>();
+            if (!physics_system::parseProxyMode(hint, proxyMode))
+            {
+              ignwarn << "Unknown collision proxy [" << hint
+                      << "] for collision [" << _name->Data()
+                      << "], using the mesh as is." << std::endl;
+              proxyMode = physics_system::ProxyMode::NONE;
+            }
+            minTriangles = 0;
+          }
+          mesh = this->CollisionProxy(mesh, proxyMode, minTriangles);
+
           auto linkMeshFeature =
               this->entityLinkMap.EntityCast<MeshFeatureList>(_parent->Data());
           if (!linkMeshFeature)
@@ -932,6 +1758,11 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
 
         this->entityCollisionMap.AddEntity(_entity, collisionPtrPhys);
 
+        // New shapes don't have the slip compliance commanded before they
+        // were created yet, apply all commands again
+        if (_ecm.Component<components::SlipComplianceCmd>(_entity))
+          this->slipComplianceGeneration = 0;
+
         // Check that the physics engine has a filter mask feature
         // Set the collide_bitmask if it does
         auto filterMaskFeature =
@@ -953,16 +1784,19 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
           }
         }
 
-        this->topLevelModelMap.insert(std::make_pair(_entity,
-            topLevelModel(_entity, _ecm)));
+        this->topLevelModelMap.Insert(_entity,
+            topLevelModel(_entity, _ecm));
         return true;
-      });
+      };
+  _ecm.EachNew<components::Collision, components::Name, components::Pose,
+            components::Geometry, components::CollisionElement,
+            components::ParentEntity>(createCollision);
+  this->EachAdmitted<components::Collision, components::Name, components::Pose,
+            components::Geometry, components::CollisionElement,
+            components::ParentEntity>(_ecm, createCollision);
 
   // joints
-  _ecm.EachNew<components::Joint, components::Name, components::JointType,
-               components::Pose, components::ThreadPitch,
-               components::ParentEntity, components::ParentLinkName,
-               components::ChildLinkName>(
+  auto createJoint =
       [&](const Entity &_entity,
           const components::Joint * /* _joint */,
           const components::Name *_name,
@@ -981,6 +1815,8 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
                   << std::endl;
           return true;
         }
+        if (!this->Owns(_entity, _ecm))
+          return true;
 
         // Check if parent model exists
         if (!this->entityModelMap.HasEntity(_parentModel->Data()))
@@ -1037,23 +1873,42 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
           // Some joints may not be supported, so only add them to the map if
           // the physics entity is valid
           this->entityJointMap.AddEntity(_entity, jointPtrPhys);
-          this->topLevelModelMap.insert(std::make_pair(_entity,
-              topLevelModel(_entity, _ecm)));
+          this->topLevelModelMap.Insert(_entity,
+              topLevelModel(_entity, _ecm));
+
+          JointCommandTarget target;
+          target.entity = _entity;
+          target.model = _parentModel->Data();
+          target.name = _name->Data();
+          target.joint = this->entityJointMap.Get(_entity);
+          target.velocityCommand =
+              this->entityJointMap.EntityCast<JointVelocityCommandFeatureList>(
+                  _entity);
+          target.dofs = target.joint->GetDegreesOfFreedom();
+          this->jointCommandIndices[_entity] = this->jointCommandTargets.size();
+          this->jointCommandTargets.push_back(std::move(target));
         }
         return true;
-      });
+      };
+  _ecm.EachNew<components::Joint, components::Name, components::JointType,
+               components::Pose, components::ThreadPitch,
+               components::ParentEntity, components::ParentLinkName,
+               components::ChildLinkName>(createJoint);
+  this->EachAdmitted<components::Joint, components::Name, components::JointType,
+               components::Pose, components::ThreadPitch,
+               components::ParentEntity, components::ParentLinkName,
+               components::ChildLinkName>(_ecm, createJoint);
 
   _ecm.EachNew<components::BatterySoC>(
       [&](const Entity & _entity, const components::BatterySoC *)->bool
       {
         // Parent entity of battery is model entity
-        this->entityOffMap.insert(std::make_pair(
-          _ecm.ParentEntity(_entity), false));
+        this->entityOffMap.Insert(_ecm.ParentEntity(_entity), false);
         return true;
       });
 
   // Detachable joints
-  _ecm.EachNew<components::DetachableJoint>(
+  auto createDetachableJoint =
       [&](const Entity &_entity,
           const components::DetachableJoint *_jointInfo) -> bool
       {
@@ -1072,6 +1927,17 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
           return true;
         }
 
+        // The joint is simulated with its child link
+        if (!this->Owns(_jointInfo->Data().childLink, _ecm))
+          return true;
+        if (!this->Owns(_jointInfo->Data().parentLink, _ecm))
+        {
+          ignwarn << "DetachableJoint [" << _entity << "] connects links "
+                  << "of different physics partitions, it will be ignored."
+                  << std::endl;
+          return true;
+        }
+
         // Check if the link entities exist in the physics engine
         auto parentLinkPhys =
             this->entityLinkMap.Get(_jointInfo->Data().parentLink);
@@ -1130,31 +1996,100 @@ void PhysicsPrivate::CreatePhysicsEntities(const EntityComponentManager &_ecm)
           igndbg << "Creating detachable joint [" << _entity << "]"
                  << std::endl;
           this->entityJointMap.AddEntity(_entity, jointPtrPhys);
-          this->topLevelModelMap.insert(std::make_pair(_entity,
-              topLevelModel(_entity, _ecm)));
+          this->topLevelModelMap.Insert(_entity,
+              topLevelModel(_entity, _ecm));
         }
         else
         {
           ignwarn << "DetachableJoint could not be created." << std::endl;
         }
         return true;
-      });
+      };
+  _ecm.EachNew<components::DetachableJoint>(createDetachableJoint);
+  if (!this->admittedModels.empty())
+  {
+    _ecm.Each<components::DetachableJoint>(
+        [&](const Entity &_entity,
+            const components::DetachableJoint *_jointInfo) -> bool
+        {
+          for (auto link : {_jointInfo->Data().childLink,
+                            _jointInfo->Data().parentLink})
+          {
+            if (this->admittedModels.find(topLevelModel(link, _ecm)) !=
+                this->admittedModels.end())
+            {
+              return createDetachableJoint(_entity, _jointInfo);
+            }
+          }
+          return true;
+        });
+  }
 }
 
 //////////////////////////////////////////////////
-void PhysicsPrivate::RemovePhysicsEntities(const EntityComponentManager &_ecm)
+void PhysicsPrivate::AdmitNewModels(const EntityComponentManager &_ecm)
 {
-  // Assume the world will not be erased
-  // Only removing models is supported by ign-physics right now so we only
-  // remove links, joints and collisions if they are children of the removed
-  // model.
-  // We assume the links, joints and collisions will be removed from the
-  // physics engine when the containing model gets removed so, here, we only
-  // remove the entities from the gazebo entity->physics entity map.
-  _ecm.EachRemoved<components::Model>(
-      [&](const Entity &_entity, const components::Model *
-          /* _model */) -> bool
-      {
+  this->admittedModels.clear();
+  if (0 == this->maxNewModelsPerStep)
+    return;
+
+  // Models that have waited the longest go first
+  std::size_t budget = this->maxNewModelsPerStep;
+  while (budget > 0 && !this->pendingModels.empty())
+  {
+    const Entity model = this->pendingModels.front();
+    this->pendingModels.pop_front();
+    if (0 == this->deferredModels.erase(model))
+      continue;
+    this->admittedModels.insert(model);
+    --budget;
+  }
+
+  // Nested models are created with their top level model
+  _ecm.EachNew<components::Model>(
+      [&](const Entity &_entity, const components::Model *) -> bool
+      {
+        if (topLevelModel(_entity, _ecm) != _entity ||
+            !this->InPartition(_entity, _ecm))
+        {
+          return true;
+        }
+
+        if (budget > 0)
+        {
+          --budget;
+          return true;
+        }
+
+        this->deferredModels.insert(_entity);
+        this->pendingModels.push_back(_entity);
+        return true;
+      });
+
+  if (!this->pendingModels.empty())
+  {
+    igndbg << "[" << this->pendingModels.size() << "] models are waiting to "
+           << "be created by physics." << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::RemovePhysicsEntities(const EntityComponentManager &_ecm)
+{
+  // Assume the world will not be erased
+  // Only removing models is supported by ign-physics right now so we only
+  // remove links, joints and collisions if they are children of the removed
+  // model.
+  // We assume the links, joints and collisions will be removed from the
+  // physics engine when the containing model gets removed so, here, we only
+  // remove the entities from the gazebo entity->physics entity map.
+  _ecm.EachRemoved<components::Model>(
+      [&](const Entity &_entity, const components::Model *
+          /* _model */) -> bool
+      {
+        // Models removed before being created are simply forgotten
+        this->deferredModels.erase(_entity);
+
         // Remove model if found
         if (auto modelPtrPhys = this->entityModelMap.Get(_entity))
         {
@@ -1166,28 +2101,31 @@ void PhysicsPrivate::RemovePhysicsEntities(const EntityComponentManager &_ecm)
                  _ecm.ChildrenByComponents(childLink, components::Collision()))
             {
               this->entityCollisionMap.Remove(childCollision);
-              this->topLevelModelMap.erase(childCollision);
+              this->topLevelModelMap.Erase(childCollision);
             }
             this->entityLinkMap.Remove(childLink);
-            this->topLevelModelMap.erase(childLink);
+            this->topLevelModelMap.Erase(childLink);
             this->staticEntities.erase(childLink);
-            this->linkWorldPoses.erase(childLink);
+            this->RemoveDynamicLink(childLink);
           }
 
           for (const auto &childJoint :
                _ecm.ChildrenByComponents(_entity, components::Joint()))
           {
             this->entityJointMap.Remove(childJoint);
-            this->topLevelModelMap.erase(childJoint);
+            this->topLevelModelMap.Erase(childJoint);
+            this->RemoveJointCommandTarget(childJoint);
           }
 
           this->entityFreeGroupMap.Remove(_entity);
           // Remove the model from the physics engine
           modelPtrPhys->Remove();
           this->entityModelMap.Remove(_entity);
-          this->topLevelModelMap.erase(_entity);
+          this->topLevelModelMap.Erase(_entity);
           this->staticEntities.erase(_entity);
-          this->modelWorldPoses.erase(_entity);
+          this->modelWorldPoses.Erase(_entity);
+          this->movedModels.erase(_entity);
+          this->boxedModels.erase(_entity);
         }
         return true;
       });
@@ -1231,8 +2169,9 @@ void PhysicsPrivate::RemovePhysicsEntities(const EntityComponentManager &_ecm)
 void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
 {
   IGN_PROFILE("PhysicsPrivate::UpdatePhysics");
-  // Battery state
-  _ecm.Each<components::BatterySoC>(
+  // Battery state. Battery systems mark the state of charge as changed when
+  // they update it, so depletion is picked up without polling every battery.
+  _ecm.EachChanged<components::BatterySoC>(this->batteryToken,
       [&](const Entity & _entity, const components::BatterySoC *_bat)
       {
         if (_bat->Data() <= 0)
@@ -1242,146 +2181,90 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
         return true;
       });
 
-  // Handle joint state
-  _ecm.Each<components::Joint, components::Name>(
-      [&](const Entity &_entity, const components::Joint *,
-          const components::Name *_name)
+  // Handle joint state. Commands are gathered from the views of each command
+  // component, which only hold the joints that are being commanded, and are
+  // then applied in one pass over the joints. Use a constant ECM so that
+  // reading commands doesn't copy their storage.
+  const EntityComponentManager &constEcm = _ecm;
+  auto commandTarget = [this](const Entity _entity) -> JointCommandTarget *
+  {
+    auto index = this->jointCommandIndices.Get(_entity);
+    return nullptr == index ? nullptr : &this->jointCommandTargets[*index];
+  };
+  constEcm.Each<components::JointVelocityReset>(
+      [&](const Entity &_entity, const components::JointVelocityReset *_reset)
       {
-        auto jointPhys = this->entityJointMap.Get(_entity);
-        if (nullptr == jointPhys)
-          return true;
-
-        // Model is out of battery
-        if (this->entityOffMap[_ecm.ParentEntity(_entity)])
-        {
-          std::size_t nDofs = jointPhys->GetDegreesOfFreedom();
-          for (std::size_t i = 0; i < nDofs; ++i)
-          {
-            jointPhys->SetForce(i, 0);
-          }
-          return true;
-        }
-
-        auto posReset = _ecm.Component<components::JointPositionReset>(
-            _entity);
-        auto velReset = _ecm.Component<components::JointVelocityReset>(
-            _entity);
-
-        // Reset the velocity
-        if (velReset)
-        {
-          auto& jointVelocity = velReset->Data();
-
-          if (jointVelocity.size() != jointPhys->GetDegreesOfFreedom())
-          {
-            ignwarn << "There is a mismatch in the degrees of freedom "
-                    << "between Joint [" << _name->Data() << "(Entity="
-                    << _entity << ")] and its JointVelocityReset "
-                    << "component. The joint has "
-                    << jointPhys->GetDegreesOfFreedom()
-                    << " while the component has "
-                    << jointVelocity.size() << ".\n";
-            }
-
-            std::size_t nDofs = std::min(
-                jointVelocity.size(), jointPhys->GetDegreesOfFreedom());
-
-            for (std::size_t i = 0; i < nDofs; ++i)
-            {
-              jointPhys->SetVelocity(i, jointVelocity[i]);
-            }
-        }
-
-        // Reset the position
-        if (posReset)
-        {
-          auto &jointPosition = posReset->Data();
-
-          if (jointPosition.size() != jointPhys->GetDegreesOfFreedom())
-          {
-            ignwarn << "There is a mismatch in the degrees of freedom "
-                    << "between Joint [" << _name->Data() << "(Entity="
-                    << _entity << ")] and its JointPositionyReset "
-                    << "component. The joint has "
-                    << jointPhys->GetDegreesOfFreedom()
-                    << " while the component has "
-                    << jointPosition.size() << ".\n";
-            }
-            std::size_t nDofs = std::min(
-                jointPosition.size(), jointPhys->GetDegreesOfFreedom());
-            for (std::size_t i = 0; i < nDofs; ++i)
-            {
-              jointPhys->SetPosition(i, jointPosition[i]);
-            }
-        }
-
-        auto force = _ecm.Component<components::JointForceCmd>(_entity);
-        auto velCmd = _ecm.Component<components::JointVelocityCmd>(_entity);
-
-        if (force)
-        {
-          if (force->Data().size() != jointPhys->GetDegreesOfFreedom())
-          {
-            ignwarn << "There is a mismatch in the degrees of freedom between "
-                    << "Joint [" << _name->Data() << "(Entity=" << _entity
-                    << ")] and its JointForceCmd component. The joint has "
-                    << jointPhys->GetDegreesOfFreedom() << " while the "
-                    << " component has " << force->Data().size() << ".\n";
-          }
-          std::size_t nDofs = std::min(force->Data().size(),
-                                       jointPhys->GetDegreesOfFreedom());
-          for (std::size_t i = 0; i < nDofs; ++i)
-          {
-            jointPhys->SetForce(i, force->Data()[i]);
-          }
-        }
-        // Only set joint velocity if joint force is not set.
-        // If both the cmd and reset components are found, cmd is ignored.
-        else if (velCmd)
-        {
-          auto velocityCmd = velCmd->Data();
-
-          if (velReset)
-          {
-            ignwarn << "Found both JointVelocityReset and "
-                    << "JointVelocityCmd components for Joint ["
-                    << _name->Data() << "(Entity=" << _entity
-                    << "]). Ignoring JointVelocityCmd component."
-                    << std::endl;
-            return true;
-          }
-
-          if (velocityCmd.size() != jointPhys->GetDegreesOfFreedom())
-          {
-            ignwarn << "There is a mismatch in the degrees of freedom"
-                    << " between Joint [" << _name->Data()
-                    << "(Entity=" << _entity<< ")] and its "
-                    << "JointVelocityCmd component. The joint has "
-                    << jointPhys->GetDegreesOfFreedom()
-                    << " while the component has "
-                    << velocityCmd.size() << ".\n";
-          }
-
-          auto jointVelFeature =
-              this->entityJointMap.EntityCast<JointVelocityCommandFeatureList>(
-                  _entity);
-          if (!jointVelFeature)
-          {
-            return true;
-          }
+        if (auto target = commandTarget(_entity))
+          target->velocityReset = _reset;
+        return true;
+      });
+  constEcm.Each<components::JointPositionReset>(
+      [&](const Entity &_entity, const components::JointPositionReset *_reset)
+      {
+        if (auto target = commandTarget(_entity))
+          target->positionReset = _reset;
+        return true;
+      });
+  constEcm.Each<components::JointForceCmd>(
+      [&](const Entity &_entity, const components::JointForceCmd *_force)
+      {
+        if (auto target = commandTarget(_entity))
+          target->force = _force;
+        return true;
+      });
+  constEcm.Each<components::JointVelocityCmd>(
+      [&](const Entity &_entity, const components::JointVelocityCmd *_vel)
+      {
+        if (auto target = commandTarget(_entity))
+          target->velocity = _vel;
+        return true;
+      });
 
-          std::size_t nDofs = std::min(
-            velocityCmd.size(),
-            jointPhys->GetDegreesOfFreedom());
+  this->jointSubstepCommands.clear();
+  this->wrenchSubstepCommands.clear();
+  const bool anyBattery = this->entityOffMap.Size() > 0;
+  for (auto &target : this->jointCommandTargets)
+  {
+    // Model is out of battery
+    auto off = anyBattery ? this->entityOffMap.Get(target.model) : nullptr;
+    if (off && *off)
+    {
+      for (std::size_t i = 0; i < target.dofs; ++i)
+      {
+        target.joint->SetForce(i, 0);
+      }
+    }
+    else
+    {
+      this->ApplyJointCommands(target);
+      if (target.positionReset)
+      {
+        if (auto model = this->topLevelModelMap.Get(target.entity))
+          this->movedModels.insert(*model);
+      }
 
-          for (std::size_t i = 0; i < nDofs; ++i)
-          {
-            jointVelFeature->SetVelocityCommand(i, velocityCmd[i]);
-          }
-        }
+      if (this->substeps > 1 && target.force)
+      {
+        const auto &force = target.force->Data();
+        this->jointSubstepCommands.push_back({target.joint, nullptr,
+            {force.begin(), force.begin() +
+                std::min(force.size(), target.dofs)}});
+      }
+      else if (this->substeps > 1 && target.velocity &&
+          !target.velocityReset && target.velocityCommand)
+      {
+        const auto &velocity = target.velocity->Data();
+        this->jointSubstepCommands.push_back({target.joint,
+            target.velocityCommand, {velocity.begin(), velocity.begin() +
+                std::min(velocity.size(), target.dofs)}});
+      }
+    }
 
-        return true;
-      });
+    target.velocityReset = nullptr;
+    target.positionReset = nullptr;
+    target.force = nullptr;
+    target.velocity = nullptr;
+  }
 
   // Link wrenches
   _ecm.Each<components::ExternalWorldWrenchCmd>(
@@ -1390,8 +2273,11 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
       {
         if (!this->entityLinkMap.HasEntity(_entity))
         {
-          ignwarn << "Failed to find link [" << _entity
-                  << "]." << std::endl;
+          if (this->Owns(_entity, _ecm))
+          {
+            ignwarn << "Failed to find link [" << _entity
+                    << "]." << std::endl;
+          }
           return true;
         }
 
@@ -1418,6 +2304,12 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
         linkForceFeature->AddExternalForce(math::eigen3::convert(force));
         linkForceFeature->AddExternalTorque(math::eigen3::convert(torque));
 
+        if (this->substeps > 1)
+        {
+          this->wrenchSubstepCommands.push_back({linkForceFeature,
+              math::eigen3::convert(force), math::eigen3::convert(torque)});
+        }
+
         return true;
       });
 
@@ -1463,6 +2355,7 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
 
         freeGroup->SetWorldPose(math::eigen3::convert(_poseCmd->Data() *
                                 linkPose));
+        this->movedModels.insert(_entity);
 
         // Process pose commands for static models here, as one-time changes
         if (this->staticEntities.find(_entity) != this->staticEntities.end())
@@ -1488,14 +2381,25 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
     _ecm.RemoveComponent<components::WorldPoseCmd>(entity);
   }
 
-  // Slip compliance on Collisions
+  // Slip compliance on Collisions, only for commands which changed
   _ecm.Each<components::SlipComplianceCmd>(
       [&](const Entity &_entity,
           const components::SlipComplianceCmd *_slipCmdComp)
       {
+        if (!_ecm.ComponentChangedSince(_entity,
+            components::SlipComplianceCmd::typeId,
+            this->slipComplianceGeneration))
+        {
+          return true;
+        }
+
         if (!this->entityCollisionMap.HasEntity(_entity))
         {
-          ignwarn << "Failed to find shape [" << _entity << "]." << std::endl;
+          if (this->Owns(_entity, _ecm))
+          {
+            ignwarn << "Failed to find shape [" << _entity << "]."
+                    << std::endl;
+          }
           return true;
         }
 
@@ -1523,6 +2427,7 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
 
         return true;
       });
+  this->slipComplianceGeneration = _ecm.ChangeGeneration() + 1;
 
   // Update model angular velocity
   _ecm.Each<components::Model, components::AngularVelocityCmd>(
@@ -1627,14 +2532,29 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
 
   // Populate bounding box info
   // Only compute bounding box if component exists to avoid unnecessary
-  // computations
+  // computations. Boxes are kept until their model moves, or until the
+  // component is created again or changed by another system.
   _ecm.Each<components::Model, components::AxisAlignedBox>(
       [&](const Entity &_entity, const components::Model *,
           components::AxisAlignedBox *_bbox)
       {
         if (!this->entityModelMap.HasEntity(_entity))
         {
-          ignwarn << "Failed to find model [" << _entity << "]." << std::endl;
+          if (this->Owns(_entity, _ecm))
+          {
+            ignwarn << "Failed to find model [" << _entity << "]."
+                    << std::endl;
+          }
+          return true;
+        }
+
+        auto topLevel = this->topLevelModelMap.Get(_entity);
+        if (this->boxedModels.find(_entity) != this->boxedModels.end() &&
+            (nullptr == topLevel ||
+             this->movedModels.find(*topLevel) == this->movedModels.end()) &&
+            _ecm.ComponentState(_entity, components::AxisAlignedBox::typeId) ==
+                ComponentState::NoChange)
+        {
           return true;
         }
 
@@ -1663,9 +2583,11 @@ void PhysicsPrivate::UpdatePhysics(EntityComponentManager &_ecm)
             ComponentState::OneTimeChange :
             ComponentState::NoChange;
         _ecm.SetChanged(_entity, components::AxisAlignedBox::typeId, state);
+        this->boxedModels.insert(_entity);
 
         return true;
       });
+  this->movedModels.clear();
 }
 
 //////////////////////////////////////////////////
@@ -1677,16 +2599,88 @@ ignition::physics::ForwardStep::Output PhysicsPrivate::Step(
   ignition::physics::ForwardStep::State state;
   ignition::physics::ForwardStep::Output output;
 
-  input.Get<std::chrono::steady_clock::duration>() = _dt;
+  if (this->substeps <= 1)
+  {
+    input.Get<std::chrono::steady_clock::duration>() = _dt;
 
-  for (const auto &world : this->entityWorldMap.Map())
+    this->entityWorldMap.Each(
+        [&](const Entity &, const WorldPtrType &_world)
+        {
+          _world->Step(output, state, input);
+        });
+
+    return output;
+  }
+
+  // The last substep takes whatever is left of _dt, so the total is exact
+  const auto substepDt = _dt / static_cast<int64_t>(this->substeps);
+  std::vector<ignition::physics::WorldPose> changedPoses;
+  std::unordered_map<std::size_t, std::size_t> changedPoseIndices;
+  bool reportsChanges{true};
+  for (std::size_t i = 0; i < this->substeps; ++i)
   {
-    world.second->Step(output, state, input);
+    if (i > 0)
+      this->ApplySubstepCommands();
+
+    input.Get<std::chrono::steady_clock::duration>() =
+        i + 1 < this->substeps ?
+        substepDt : _dt - substepDt * static_cast<int64_t>(i);
+
+    ignition::physics::ForwardStep::Output substepOutput;
+    this->entityWorldMap.Each(
+        [&](const Entity &, const WorldPtrType &_world)
+        {
+          _world->Step(substepOutput, state, input);
+        });
+
+    // A link is reported if it changed in any substep, with its latest pose
+    auto changed =
+        substepOutput.Query<ignition::physics::ChangedWorldPoses>();
+    if (nullptr == changed)
+    {
+      reportsChanges = false;
+      continue;
+    }
+    for (const auto &entry : changed->entries)
+    {
+      auto [it, inserted] =
+          changedPoseIndices.emplace(entry.body, changedPoses.size());
+      if (inserted)
+        changedPoses.push_back(entry);
+      else
+        changedPoses[it->second] = entry;
+    }
   }
 
+  if (reportsChanges)
+  {
+    output.Get<ignition::physics::ChangedWorldPoses>().entries =
+        std::move(changedPoses);
+  }
   return output;
 }
 
+//////////////////////////////////////////////////
+void PhysicsPrivate::ApplySubstepCommands() const
+{
+  for (const auto &command : this->jointSubstepCommands)
+  {
+    for (std::size_t i = 0; i < command.values.size(); ++i)
+    {
+      if (command.velocityCommand)
+        command.velocityCommand->SetVelocityCommand(i, command.values[i]);
+      else
+        command.joint->SetForce(i, command.values[i]);
+    }
+  }
+
+  for (const auto &command : this->wrenchSubstepCommands)
+  {
+    command.link->AddExternalForce(command.force);
+    command.link->AddExternalTorque(command.torque);
+  }
+}
+
 //////////////////////////////////////////////////
 ignition::math::Pose3d PhysicsPrivate::RelativePose(const Entity &_from,
   const Entity &_to, const EntityComponentManager &_ecm) const
@@ -1724,16 +2718,380 @@ ignition::math::Pose3d PhysicsPrivate::RelativePose(const Entity &_from,
 }
 
 //////////////////////////////////////////////////
-std::unordered_map<Entity, physics::FrameData3d> PhysicsPrivate::ChangedLinks(
-    EntityComponentManager &_ecm,
-    const ignition::physics::ForwardStep::Output &_updatedLinks)
+const common::Mesh *PhysicsPrivate::CollisionMesh(const std::string &_fullPath)
+{
+  auto pathIt = this->meshesByPath.find(_fullPath);
+  if (pathIt != this->meshesByPath.end())
+    return pathIt->second;
+
+  // Hash the file contents, which is much cheaper than parsing the file. The
+  // path may not be a regular file, in which case it's up to the mesh manager.
+  std::optional<std::size_t> contentHash;
+  std::string contents;
+  std::ifstream file(_fullPath, std::ios::binary);
+  if (file)
+  {
+    contents.assign(std::istreambuf_iterator<char>(file),
+        std::istreambuf_iterator<char>());
+    contentHash = std::hash<std::string>()(contents);
+
+    auto range = this->meshesByContent.equal_range(*contentHash);
+    for (auto contentIt = range.first; contentIt != range.second; ++contentIt)
+    {
+      const auto &source = contentIt->second;
+      if (source.size != contents.size())
+        continue;
+
+      std::ifstream sourceFile(source.path, std::ios::binary);
+      const std::string sourceContents{
+          std::istreambuf_iterator<char>(sourceFile),
+          std::istreambuf_iterator<char>()};
+      if (sourceContents != contents)
+        continue;
+
+      igndbg << "Mesh [" << _fullPath << "] is identical to ["
+             << source.path << "], reusing it." << std::endl;
+      this->meshesByPath[_fullPath] = source.mesh;
+      return source.mesh;
+    }
+  }
+
+  const common::Mesh *mesh{nullptr};
+  if (this->assetStore && contentHash)
+    mesh = this->SharedMesh(_fullPath, contents);
+  else
+    mesh = common::MeshManager::Instance()->Load(_fullPath);
+  if (nullptr == mesh)
+    return nullptr;
+
+  this->meshesByPath[_fullPath] = mesh;
+  if (contentHash)
+  {
+    this->meshesByContent.emplace(*contentHash,
+        MeshSource{_fullPath, contents.size(), mesh});
+  }
+  this->meshHashes[mesh] = contentHash ? *contentHash :
+      std::hash<std::string>()(_fullPath);
+  return mesh;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the triangles of all the submeshes of a mesh.
+/// \param[in] _mesh Mesh.
+/// \return Triangles, with the vertices of all the submeshes.
+static physics_system::TriangleSoup triangleSoup(const common::Mesh &_mesh)
+{
+  physics_system::TriangleSoup soup;
+  for (unsigned int i = 0; i < _mesh.SubMeshCount(); ++i)
+  {
+    auto subMesh = _mesh.SubMeshByIndex(i).lock();
+    if (!subMesh)
+      continue;
+    auto offset = static_cast<unsigned int>(soup.vertices.size());
+    for (unsigned int v = 0; v < subMesh->VertexCount(); ++v)
+      soup.vertices.push_back(subMesh->Vertex(v));
+    for (unsigned int j = 0; j < subMesh->IndexCount(); ++j)
+      soup.indices.push_back(offset + subMesh->Index(j));
+  }
+  return soup;
+}
+
+//////////////////////////////////////////////////
+const common::Mesh *PhysicsPrivate::SharedMesh(const std::string &_fullPath,
+    const std::string &_contents)
+{
+  IGN_PROFILE("PhysicsPrivate::SharedMesh");
+
+  // Collisions only need the triangles, so that's all that's stored, and
+  // other processes don't need to parse the file at all
+  const auto key = SharedAssetStore::ContentKey(_contents) + "_collision";
+  physics_system::TriangleSoup soup;
+  auto asset = this->assetStore->Find(key);
+  if (nullptr == asset || !physics_system::decodeTriangleSoup(*asset, soup))
+  {
+    auto *mesh = common::MeshManager::Instance()->Load(_fullPath);
+    if (nullptr != mesh &&
+        nullptr == this->assetStore->Insert(key,
+            physics_system::encodeTriangleSoup(triangleSoup(*mesh))))
+    {
+      ignwarn << "Failed to store mesh [" << _fullPath << "] in the shared "
+              << "assets [" << this->assetStore->Directory() << "]."
+              << std::endl;
+    }
+    return mesh;
+  }
+
+  common::SubMesh subMesh;
+  subMesh.SetPrimitiveType(common::SubMesh::TRIANGLES);
+  for (const auto &vertex : soup.vertices)
+    subMesh.AddVertex(vertex);
+  for (auto index : soup.indices)
+    subMesh.AddIndex(index);
+
+  auto mesh = std::make_unique<common::Mesh>();
+  mesh->SetName(_fullPath);
+  mesh->AddSubMesh(subMesh);
+  this->sharedMeshes.push_back(std::move(mesh));
+  return this->sharedMeshes.back().get();
+}
+
+//////////////////////////////////////////////////
+const common::Mesh *PhysicsPrivate::CollisionProxy(const common::Mesh *_mesh,
+    physics_system::ProxyMode _mode, std::size_t _minTriangles)
+{
+  if (_mode == physics_system::ProxyMode::NONE ||
+      _mesh->IndexCount() / 3 < _minTriangles)
+  {
+    return _mesh;
+  }
+
+  // Proxies are cached by the hash of their source and their parameters,
+  // so they're only generated the first time a mesh is used
+  auto hashIt = this->meshHashes.find(_mesh);
+  if (hashIt == this->meshHashes.end())
+    return _mesh;
+  std::ostringstream name;
+  name << std::hex << hashIt->second << std::dec;
+  if (_mode == physics_system::ProxyMode::CONVEX_HULL)
+    name << "_convex_hull.obj";
+  else
+    name << "_simplify_" << this->proxyResolution << ".obj";
+  const auto path = common::joinPaths(this->proxyCacheDir, name.str());
+
+  auto proxyIt = this->proxies.find(path);
+  if (proxyIt != this->proxies.end())
+    return proxyIt->second;
+
+  if (!common::isFile(path))
+  {
+    IGN_PROFILE("PhysicsPrivate::CollisionProxy");
+
+    auto soup = triangleSoup(*_mesh);
+    auto proxy = _mode == physics_system::ProxyMode::CONVEX_HULL ?
+        physics_system::convexHull(soup.vertices) :
+        physics_system::simplify(soup, this->proxyResolution);
+    if (proxy.indices.empty())
+    {
+      ignwarn << "Failed to generate a collision proxy for mesh ["
+              << _mesh->Name() << "], using the mesh as is." << std::endl;
+      this->proxies[path] = _mesh;
+      return _mesh;
+    }
+
+    // Write to a temporary file first, so other servers sharing the cache
+    // never load a partial file
+    const auto tmpPath = path + ".tmp" +
+        std::to_string(reinterpret_cast<std::uintptr_t>(this));
+    {
+      std::ofstream out(tmpPath);
+      physics_system::writeObj(proxy, out);
+      if (!out)
+      {
+        ignwarn << "Failed to write collision proxy [" << tmpPath << "]."
+                << std::endl;
+        this->proxies[path] = _mesh;
+        return _mesh;
+      }
+    }
+    common::moveFile(tmpPath, path);
+
+    igndbg << "Generated collision proxy [" << path << "] with ["
+           << proxy.indices.size() / 3 << "] triangles for mesh ["
+           << _mesh->Name() << "] with [" << _mesh->IndexCount() / 3
+           << "] triangles." << std::endl;
+  }
+
+  const common::Mesh *proxy = common::MeshManager::Instance()->Load(path);
+  if (nullptr == proxy)
+  {
+    ignwarn << "Failed to load collision proxy [" << path
+            << "], using mesh [" << _mesh->Name() << "] as is." << std::endl;
+    proxy = _mesh;
+  }
+  this->proxies[path] = proxy;
+  return proxy;
+}
+
+//////////////////////////////////////////////////
+bool PhysicsPrivate::Owns(const Entity _entity,
+    const EntityComponentManager &_ecm)
+{
+  if (!this->deferredModels.empty() &&
+      this->deferredModels.find(topLevelModel(_entity, _ecm)) !=
+      this->deferredModels.end())
+  {
+    return false;
+  }
+
+  return this->InPartition(_entity, _ecm);
+}
+
+//////////////////////////////////////////////////
+bool PhysicsPrivate::InPartition(const Entity _entity,
+    const EntityComponentManager &_ecm)
+{
+  if (nullptr == this->partitioning)
+    return true;
+
+  const std::size_t owner = this->partitioning->PartitionOf(
+      topLevelModel(_entity, _ecm), _ecm);
+  return owner == PhysicsPartitioning::kAllPartitions ||
+      owner == this->partition;
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::RemoveDynamicLink(const Entity _entity)
+{
+  auto index = this->dynamicLinkIndices.Get(_entity);
+  if (nullptr == index)
+    return;
+
+  // Move the last link into the removed one's place
+  const std::size_t removed = *index;
+  if (removed + 1 != this->dynamicLinks.size())
+  {
+    this->dynamicLinks[removed] = std::move(this->dynamicLinks.back());
+    this->dynamicLinkIndices[this->dynamicLinks[removed].entity] = removed;
+  }
+  this->dynamicLinks.pop_back();
+  this->dynamicLinkIndices.Erase(_entity);
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::RemoveJointCommandTarget(const Entity _entity)
+{
+  auto index = this->jointCommandIndices.Get(_entity);
+  if (nullptr == index)
+    return;
+
+  // Move the last joint into the removed one's place
+  const std::size_t removed = *index;
+  if (removed + 1 != this->jointCommandTargets.size())
+  {
+    this->jointCommandTargets[removed] =
+        std::move(this->jointCommandTargets.back());
+    this->jointCommandIndices[this->jointCommandTargets[removed].entity] =
+        removed;
+  }
+  this->jointCommandTargets.pop_back();
+  this->jointCommandIndices.Erase(_entity);
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::ApplyJointCommands(
+    const JointCommandTarget &_target) const
+{
+  // Reset the velocity
+  if (_target.velocityReset)
+  {
+    auto &jointVelocity = _target.velocityReset->Data();
+
+    if (jointVelocity.size() != _target.dofs)
+    {
+      ignwarn << "There is a mismatch in the degrees of freedom "
+              << "between Joint [" << _target.name << "(Entity="
+              << _target.entity << ")] and its JointVelocityReset "
+              << "component. The joint has " << _target.dofs
+              << " while the component has "
+              << jointVelocity.size() << ".\n";
+    }
+
+    std::size_t nDofs = std::min(jointVelocity.size(), _target.dofs);
+    for (std::size_t i = 0; i < nDofs; ++i)
+    {
+      _target.joint->SetVelocity(i, jointVelocity[i]);
+    }
+  }
+
+  // Reset the position
+  if (_target.positionReset)
+  {
+    auto &jointPosition = _target.positionReset->Data();
+
+    if (jointPosition.size() != _target.dofs)
+    {
+      ignwarn << "There is a mismatch in the degrees of freedom "
+              << "between Joint [" << _target.name << "(Entity="
+              << _target.entity << ")] and its JointPositionyReset "
+              << "component. The joint has " << _target.dofs
+              << " while the component has "
+              << jointPosition.size() << ".\n";
+    }
+
+    std::size_t nDofs = std::min(jointPosition.size(), _target.dofs);
+    for (std::size_t i = 0; i < nDofs; ++i)
+    {
+      _target.joint->SetPosition(i, jointPosition[i]);
+    }
+  }
+
+  if (_target.force)
+  {
+    auto &force = _target.force->Data();
+
+    if (force.size() != _target.dofs)
+    {
+      ignwarn << "There is a mismatch in the degrees of freedom between "
+              << "Joint [" << _target.name << "(Entity=" << _target.entity
+              << ")] and its JointForceCmd component. The joint has "
+              << _target.dofs << " while the "
+              << " component has " << force.size() << ".\n";
+    }
+
+    std::size_t nDofs = std::min(force.size(), _target.dofs);
+    for (std::size_t i = 0; i < nDofs; ++i)
+    {
+      _target.joint->SetForce(i, force[i]);
+    }
+  }
+  // Only set joint velocity if joint force is not set.
+  // If both the cmd and reset components are found, cmd is ignored.
+  else if (_target.velocity)
+  {
+    auto &velocityCmd = _target.velocity->Data();
+
+    if (_target.velocityReset)
+    {
+      ignwarn << "Found both JointVelocityReset and "
+              << "JointVelocityCmd components for Joint ["
+              << _target.name << "(Entity=" << _target.entity
+              << "]). Ignoring JointVelocityCmd component."
+              << std::endl;
+      return;
+    }
+
+    if (velocityCmd.size() != _target.dofs)
+    {
+      ignwarn << "There is a mismatch in the degrees of freedom"
+              << " between Joint [" << _target.name
+              << "(Entity=" << _target.entity << ")] and its "
+              << "JointVelocityCmd component. The joint has "
+              << _target.dofs << " while the component has "
+              << velocityCmd.size() << ".\n";
+    }
+
+    if (!_target.velocityCommand)
+      return;
+
+    std::size_t nDofs = std::min(velocityCmd.size(), _target.dofs);
+    for (std::size_t i = 0; i < nDofs; ++i)
+    {
+      _target.velocityCommand->SetVelocityCommand(i, velocityCmd[i]);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+LinkFrameDataMap PhysicsPrivate::ChangedLinks(
+    const ignition::physics::ForwardStep::Output &_updatedLinks,
+    std::pmr::memory_resource *_memory)
 {
   IGN_PROFILE("Links Frame Data");
 
-  std::unordered_map<Entity, physics::FrameData3d> linkFrameData;
+  LinkFrameDataMap linkFrameData(_memory);
 
   // Check to see if the physics engine gave a list of changed poses. If not, we
-  // will iterate through all of the links via the ECM to see which ones changed
+  // will iterate through all of the non-static links to see which ones changed
   if (_updatedLinks.Has<ignition::physics::ChangedWorldPoses>())
   {
     for (const auto &link :
@@ -1761,39 +3119,45 @@ std::unordered_map<Entity, physics::FrameData3d> PhysicsPrivate::ChangedLinks(
   }
   else
   {
-    _ecm.Each<components::Link>(
-      [&](const Entity &_entity, components::Link *) -> bool
+    for (auto &dynamicLink : this->dynamicLinks)
+    {
+      auto frameData = dynamicLink.link->FrameDataRelativeToWorld();
+
+      // update the link pose if this is the first update,
+      // or if the link pose has changed since the last update
+      // (if the link pose hasn't changed, there's no need for a pose update)
+      const auto worldPoseMath3d = ignition::math::eigen3::convert(
+          frameData.pose);
+      if (!dynamicLink.lastWorldPose ||
+          !this->pose3Eql(*dynamicLink.lastWorldPose, worldPoseMath3d))
       {
-        if (this->staticEntities.find(_entity) != this->staticEntities.end())
-          return true;
+        // cache the updated link pose to check if the link pose has changed
+        // during the next iteration
+        dynamicLink.lastWorldPose = worldPoseMath3d;
 
-        auto linkPhys = this->entityLinkMap.Get(_entity);
-        if (nullptr == linkPhys)
-        {
-          ignerr << "Internal error: link [" << _entity
-                 << "] not in entity map" << std::endl;
-          return true;
-        }
-
-        auto frameData = linkPhys->FrameDataRelativeToWorld();
-
-        // update the link pose if this is the first update,
-        // or if the link pose has changed since the last update
-        // (if the link pose hasn't changed, there's no need for a pose update)
-        const auto worldPoseMath3d = ignition::math::eigen3::convert(
-            frameData.pose);
-        if ((this->linkWorldPoses.find(_entity) == this->linkWorldPoses.end())
-            || !this->pose3Eql(this->linkWorldPoses[_entity], worldPoseMath3d))
-        {
-          // cache the updated link pose to check if the link pose has changed
-          // during the next iteration
-          this->linkWorldPoses[_entity] = worldPoseMath3d;
+        linkFrameData[dynamicLink.entity] = frameData;
+      }
+    }
+  }
 
-          linkFrameData[_entity] = frameData;
-        }
+  // Links which just stopped moving, and the entities attached to them, such
+  // as IMUs, would otherwise keep the velocities and accelerations they had
+  // while moving.
+  this->stoppedLinks.clear();
+  for (const Entity entity : this->movingLinks)
+  {
+    if (linkFrameData.find(entity) == linkFrameData.end())
+      this->stoppedLinks.push_back(entity);
+  }
+  this->movingLinks.clear();
+  for (const auto &link : linkFrameData)
+    this->movingLinks.push_back(link.first);
 
-        return true;
-      });
+  for (const Entity entity : this->stoppedLinks)
+  {
+    auto linkPhys = this->entityLinkMap.Get(entity);
+    if (linkPhys)
+      linkFrameData[entity] = linkPhys->FrameDataRelativeToWorld();
   }
 
   return linkFrameData;
@@ -1801,10 +3165,17 @@ std::unordered_map<Entity, physics::FrameData3d> PhysicsPrivate::ChangedLinks(
 
 //////////////////////////////////////////////////
 void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
-    const std::unordered_map<Entity, physics::FrameData3d> &_linkFrameData)
+    const LinkFrameDataMap &_linkFrameData)
 {
   IGN_PROFILE("PhysicsPrivate::UpdateSim");
 
+  // Bounding boxes of these models need to be computed again
+  for (const auto &linkFrame : _linkFrameData)
+  {
+    if (auto model = this->topLevelModelMap.Get(linkFrame.first))
+      this->movedModels.insert(*model);
+  }
+
   IGN_PROFILE_BEGIN("Models");
 
   _ecm.Each<components::Model, components::ModelCanonicalLink>(
@@ -1823,12 +3194,11 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
         // already been updated. We expect to find the updated pose in
         // this->modelWorldPoses. If not found, this must not be nested, so
         // this model's pose component would reflect it's absolute pose.
-        auto parentModelPoseIt =
-          this->modelWorldPoses.find(
-              _ecm.Component<components::ParentEntity>(_entity)->Data());
-        if (parentModelPoseIt != this->modelWorldPoses.end())
+        auto parentModelPose = this->modelWorldPoses.Get(
+            _ecm.Component<components::ParentEntity>(_entity)->Data());
+        if (nullptr != parentModelPose)
         {
-          parentWorldPose = parentModelPoseIt->second;
+          parentWorldPose = *parentModelPose;
         }
 
         // Given the following frame names:
@@ -1880,279 +3250,316 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
       });
   IGN_PROFILE_END();
 
-  // Link poses, velocities...
+  // Link poses, velocities... and those of entities attached to links, such
+  // as sensors and collisions, which get updated only if another system has
+  // created the corresponding component on the entity. Components are looked
+  // up first, then all values are computed and written in a single parallel
+  // pass, and finally the changes are reported.
   IGN_PROFILE_BEGIN("Links");
+  IGN_PROFILE_BEGIN("Gather");
+  this->linkWriteBacks.clear();
+  this->linkWriteBacks.reserve(_linkFrameData.size());
   for (const auto &[entity, frameData] : _linkFrameData)
   {
-    IGN_PROFILE_BEGIN("Local pose");
-    auto canonicalLink =
-        _ecm.Component<components::CanonicalLink>(entity);
+    LinkWriteBack writeBack;
+    writeBack.entity = entity;
+    writeBack.frameData = &frameData;
 
-    const auto &worldPose = frameData.pose;
-    const auto parentEntity = _ecm.ParentEntity(entity);
-
-    if (!canonicalLink)
+    if (!_ecm.Component<components::CanonicalLink>(entity))
     {
       // Compute the relative pose of this link from the parent model
-      auto parentModelPoseIt = this->modelWorldPoses.find(parentEntity);
-      if (parentModelPoseIt == this->modelWorldPoses.end())
+      const auto parentEntity = _ecm.ParentEntity(entity);
+      auto parentModelPose = this->modelWorldPoses.Get(parentEntity);
+      if (nullptr == parentModelPose)
       {
         ignerr << "Internal error: parent model [" << parentEntity
               << "] does not have a world pose available" << std::endl;
         continue;
       }
-      const math::Pose3d &parentWorldPose = parentModelPoseIt->second;
 
       // Unlike canonical links, pose of regular links can move relative.
       // to the parent. Same for links inside nested models.
-      auto pose = _ecm.Component<components::Pose>(entity);
-      *pose = components::Pose(parentWorldPose.Inverse() *
-                                math::eigen3::convert(worldPose));
-      _ecm.SetChanged(entity, components::Pose::typeId,
-          ComponentState::PeriodicChange);
-    }
-    IGN_PROFILE_END();
-
-    // Populate world poses, velocities and accelerations of the link. For
-    // now these components are updated only if another system has created
-    // the corresponding component on the entity.
-    auto worldPoseComp = _ecm.Component<components::WorldPose>(entity);
-    if (worldPoseComp)
-    {
-      auto state =
-          worldPoseComp->SetData(math::eigen3::convert(frameData.pose),
-          this->pose3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity, components::WorldPose::typeId, state);
+      writeBack.parentWorldPose = parentModelPose;
+      writeBack.pose = _ecm.Component<components::Pose>(entity);
     }
 
-    // Velocity in world coordinates
-    auto worldLinVelComp =
-        _ecm.Component<components::WorldLinearVelocity>(entity);
-    if (worldLinVelComp)
-    {
-      auto state = worldLinVelComp->SetData(
-            math::eigen3::convert(frameData.linearVelocity),
-            this->vec3Eql) ?
-            ComponentState::PeriodicChange :
-            ComponentState::NoChange;
-      _ecm.SetChanged(entity,
-          components::WorldLinearVelocity::typeId, state);
-    }
-
-    // Angular velocity in world frame coordinates
-    auto worldAngVelComp =
-        _ecm.Component<components::WorldAngularVelocity>(entity);
-    if (worldAngVelComp)
-    {
-      auto state = worldAngVelComp->SetData(
-          math::eigen3::convert(frameData.angularVelocity),
-          this->vec3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity,
-          components::WorldAngularVelocity::typeId, state);
-    }
-
-    // Acceleration in world frame coordinates
-    auto worldLinAccelComp =
-        _ecm.Component<components::WorldLinearAcceleration>(entity);
-    if (worldLinAccelComp)
-    {
-      auto state = worldLinAccelComp->SetData(
-          math::eigen3::convert(frameData.linearAcceleration),
-          this->vec3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity,
-          components::WorldLinearAcceleration::typeId, state);
-    }
-
-    // Angular acceleration in world frame coordinates
-    auto worldAngAccelComp =
-        _ecm.Component<components::WorldAngularAcceleration>(entity);
-
-    if (worldAngAccelComp)
-    {
-      auto state = worldAngAccelComp->SetData(
-          math::eigen3::convert(frameData.angularAcceleration),
-          this->vec3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity,
-          components::WorldAngularAcceleration::typeId, state);
-    }
-
-    const Eigen::Matrix3d R_bs = worldPose.linear().transpose(); // NOLINT
+    writeBack.worldPose.Acquire(_ecm, entity);
+    writeBack.worldLinearVelocity.Acquire(_ecm, entity);
+    writeBack.worldAngularVelocity.Acquire(_ecm, entity);
+    writeBack.worldLinearAcceleration.Acquire(_ecm, entity);
+    writeBack.worldAngularAcceleration.Acquire(_ecm, entity);
+    writeBack.linearVelocity.Acquire(_ecm, entity);
+    writeBack.angularVelocity.Acquire(_ecm, entity);
+    writeBack.linearAcceleration.Acquire(_ecm, entity);
+    writeBack.angularAcceleration.Acquire(_ecm, entity);
+
+    this->linkWriteBacks.push_back(writeBack);
+  }
 
-    // Velocity in body-fixed frame coordinates
-    auto bodyLinVelComp =
-        _ecm.Component<components::LinearVelocity>(entity);
-    if (bodyLinVelComp)
-    {
-      Eigen::Vector3d bodyLinVel = R_bs * frameData.linearVelocity;
-      auto state =
-          bodyLinVelComp->SetData(math::eigen3::convert(bodyLinVel),
-          this->vec3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity, components::LinearVelocity::typeId, state);
-    }
+  // Entities attached to links which moved follow them. Entities attached to
+  // links which didn't move keep their values, unless their components were
+  // just created or set by someone else.
+  this->offsetWriteBacks.clear();
+  this->restingLinkFrameData.clear();
+  auto linkFrameDataFor = [&](const Entity _child, const Entity _link,
+      const ComponentTypeId _type) -> const physics::FrameData3d *
+  {
+    auto linkFrameIt = _linkFrameData.find(_link);
+    if (linkFrameIt != _linkFrameData.end())
+      return &linkFrameIt->second;
 
-    // Angular velocity in body-fixed frame coordinates
-    auto bodyAngVelComp =
-        _ecm.Component<components::AngularVelocity>(entity);
-    if (bodyAngVelComp)
-    {
-      Eigen::Vector3d bodyAngVel = R_bs * frameData.angularVelocity;
-      auto state =
-          bodyAngVelComp->SetData(math::eigen3::convert(bodyAngVel),
-          this->vec3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity, components::AngularVelocity::typeId,
-          state);
-    }
+    if (_ecm.ComponentState(_child, _type) == ComponentState::NoChange)
+      return nullptr;
 
-    // Acceleration in body-fixed frame coordinates
-    auto bodyLinAccelComp =
-        _ecm.Component<components::LinearAcceleration>(entity);
-    if (bodyLinAccelComp)
-    {
-      Eigen::Vector3d bodyLinAccel = R_bs * frameData.linearAcceleration;
-      auto state =
-          bodyLinAccelComp->SetData(math::eigen3::convert(bodyLinAccel),
-          this->vec3Eql)?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity, components::LinearAcceleration::typeId,
-          state);
-    }
+    auto linkPhys = this->entityLinkMap.Get(_link);
+    if (!linkPhys)
+      return nullptr;
 
-    // Angular acceleration in world frame coordinates
-    auto bodyAngAccelComp =
-        _ecm.Component<components::AngularAcceleration>(entity);
-    if (bodyAngAccelComp)
+    auto restingIt = this->restingLinkFrameData.find(_link);
+    if (restingIt == this->restingLinkFrameData.end())
     {
-      Eigen::Vector3d bodyAngAccel = R_bs * frameData.angularAcceleration;
-      auto state =
-          bodyAngAccelComp->SetData(math::eigen3::convert(bodyAngAccel),
-          this->vec3Eql) ?
-          ComponentState::PeriodicChange :
-          ComponentState::NoChange;
-      _ecm.SetChanged(entity, components::AngularAcceleration::typeId,
-          state);
+      restingIt = this->restingLinkFrameData.emplace(
+          _link, linkPhys->FrameDataRelativeToWorld()).first;
     }
-  }
-  IGN_PROFILE_END();
+    return &restingIt->second;
+  };
 
-  // pose/velocity/acceleration of non-link entities such as sensors /
-  // collisions. These get updated only if another system has created a
-  // components::WorldPose component for the entity.
-  // Populated components:
-  // * WorldPose
-  // * WorldLinearVelocity
-  // * AngularVelocity
-  // * LinearAcceleration
-
-  IGN_PROFILE_BEGIN("Sensors / collisions");
-  // world pose
   _ecm.Each<components::Pose, components::WorldPose,
             components::ParentEntity>(
-      [&](const Entity &,
+      [&](const Entity &_entity,
           const components::Pose *_pose, components::WorldPose *_worldPose,
           const components::ParentEntity *_parent)->bool
       {
-        // check if parent entity is a link, e.g. entity is sensor / collision
-        if (auto linkPhys = this->entityLinkMap.Get(_parent->Data()))
+        if (auto linkFrameData = linkFrameDataFor(_entity, _parent->Data(),
+              components::WorldPose::typeId))
         {
-          const auto entityFrameData =
-              this->LinkFrameDataAtOffset(linkPhys, _pose->Data());
-
-          *_worldPose = components::WorldPose(
-              math::eigen3::convert(entityFrameData.pose));
+          OffsetWriteBack writeBack;
+          writeBack.linkFrameData = linkFrameData;
+          writeBack.offset = &_pose->Data();
+          writeBack.worldPose = _worldPose;
+          this->offsetWriteBacks.push_back(writeBack);
         }
-
         return true;
       });
 
-  // world linear velocity
   _ecm.Each<components::Pose, components::WorldLinearVelocity,
             components::ParentEntity>(
-      [&](const Entity &,
+      [&](const Entity &_entity,
           const components::Pose *_pose,
           components::WorldLinearVelocity *_worldLinearVel,
           const components::ParentEntity *_parent)->bool
       {
-        // check if parent entity is a link, e.g. entity is sensor / collision
-        if (auto linkPhys = this->entityLinkMap.Get(_parent->Data()))
+        if (auto linkFrameData = linkFrameDataFor(_entity, _parent->Data(),
+              components::WorldLinearVelocity::typeId))
         {
-          const auto entityFrameData =
-              this->LinkFrameDataAtOffset(linkPhys, _pose->Data());
-
-          // set entity world linear velocity
-          *_worldLinearVel = components::WorldLinearVelocity(
-              math::eigen3::convert(entityFrameData.linearVelocity));
+          OffsetWriteBack writeBack;
+          writeBack.linkFrameData = linkFrameData;
+          writeBack.offset = &_pose->Data();
+          writeBack.worldLinearVelocity = _worldLinearVel;
+          this->offsetWriteBacks.push_back(writeBack);
         }
-
         return true;
       });
 
-  // body angular velocity
   _ecm.Each<components::Pose, components::AngularVelocity,
             components::ParentEntity>(
-      [&](const Entity &,
+      [&](const Entity &_entity,
           const components::Pose *_pose,
           components::AngularVelocity *_angularVel,
           const components::ParentEntity *_parent)->bool
       {
-        // check if parent entity is a link, e.g. entity is sensor / collision
-        if (auto linkPhys = this->entityLinkMap.Get(_parent->Data()))
+        // Links have angular velocities too, but they aren't attached to
+        // another link.
+        if (auto linkFrameData = linkFrameDataFor(_entity, _parent->Data(),
+              components::AngularVelocity::typeId))
         {
-          const auto entityFrameData =
-              this->LinkFrameDataAtOffset(linkPhys, _pose->Data());
-
-          auto entityWorldPose = math::eigen3::convert(entityFrameData.pose);
-          ignition::math::Vector3d entityWorldAngularVel =
-              math::eigen3::convert(entityFrameData.angularVelocity);
-
-          auto entityBodyAngularVel =
-              entityWorldPose.Rot().RotateVectorReverse(entityWorldAngularVel);
-          *_angularVel = components::AngularVelocity(entityBodyAngularVel);
+          OffsetWriteBack writeBack;
+          writeBack.linkFrameData = linkFrameData;
+          writeBack.offset = &_pose->Data();
+          writeBack.angularVelocity = _angularVel;
+          this->offsetWriteBacks.push_back(writeBack);
         }
-
         return true;
       });
 
-  // body linear acceleration
   _ecm.Each<components::Pose, components::LinearAcceleration,
             components::ParentEntity>(
-      [&](const Entity &,
+      [&](const Entity &_entity,
           const components::Pose *_pose,
           components::LinearAcceleration *_linearAcc,
           const components::ParentEntity *_parent)->bool
       {
-        if (auto linkPhys = this->entityLinkMap.Get(_parent->Data()))
+        if (auto linkFrameData = linkFrameDataFor(_entity, _parent->Data(),
+              components::LinearAcceleration::typeId))
         {
-          const auto entityFrameData =
-              this->LinkFrameDataAtOffset(linkPhys, _pose->Data());
+          OffsetWriteBack writeBack;
+          writeBack.linkFrameData = linkFrameData;
+          writeBack.offset = &_pose->Data();
+          writeBack.linearAcceleration = _linearAcc;
+          this->offsetWriteBacks.push_back(writeBack);
+        }
+        return true;
+      });
+  IGN_PROFILE_END();
 
-          auto entityWorldPose = math::eigen3::convert(entityFrameData.pose);
-          ignition::math::Vector3d entityWorldLinearAcc =
-              math::eigen3::convert(entityFrameData.linearAcceleration);
+  // Each task writes components of a single entity, and only reads the frame
+  // data gathered above.
+  IGN_PROFILE_BEGIN("Write back");
+  const std::size_t linkCount = this->linkWriteBacks.size();
+  _ecm.ParallelFor(linkCount + this->offsetWriteBacks.size(), 64,
+      [&](std::size_t _begin, std::size_t _end)
+      {
+        for (std::size_t i = _begin; i < _end; ++i)
+        {
+          if (i >= linkCount)
+          {
+            const auto &writeBack = this->offsetWriteBacks[i - linkCount];
+            const auto frameData = FrameDataAtOffset(
+                *writeBack.linkFrameData, *writeBack.offset);
+            const auto worldPose = math::eigen3::convert(frameData.pose);
 
-          auto entityBodyLinearAcc =
-              entityWorldPose.Rot().RotateVectorReverse(entityWorldLinearAcc);
-          *_linearAcc = components::LinearAcceleration(entityBodyLinearAcc);
+            if (writeBack.worldPose)
+            {
+              *writeBack.worldPose = components::WorldPose(worldPose);
+            }
+            else if (writeBack.worldLinearVelocity)
+            {
+              *writeBack.worldLinearVelocity = components::WorldLinearVelocity(
+                  math::eigen3::convert(frameData.linearVelocity));
+            }
+            else if (writeBack.angularVelocity)
+            {
+              *writeBack.angularVelocity = components::AngularVelocity(
+                  worldPose.Rot().RotateVectorReverse(
+                      math::eigen3::convert(frameData.angularVelocity)));
+            }
+            else if (writeBack.linearAcceleration)
+            {
+              *writeBack.linearAcceleration = components::LinearAcceleration(
+                  worldPose.Rot().RotateVectorReverse(
+                      math::eigen3::convert(frameData.linearAcceleration)));
+            }
+            continue;
+          }
+
+          auto &writeBack = this->linkWriteBacks[i];
+          const auto &frameData = *writeBack.frameData;
+          const auto &worldPose = frameData.pose;
+
+          if (writeBack.pose)
+          {
+            *writeBack.pose = components::Pose(
+                writeBack.parentWorldPose->Inverse() *
+                math::eigen3::convert(worldPose));
+          }
+
+          // World frame
+          writeBack.worldPose.Write(math::eigen3::convert(worldPose),
+              this->pose3Eql);
+          writeBack.worldLinearVelocity.Write(
+              math::eigen3::convert(frameData.linearVelocity), this->vec3Eql);
+          writeBack.worldAngularVelocity.Write(
+              math::eigen3::convert(frameData.angularVelocity),
+              this->vec3Eql);
+          writeBack.worldLinearAcceleration.Write(
+              math::eigen3::convert(frameData.linearAcceleration),
+              this->vec3Eql);
+          writeBack.worldAngularAcceleration.Write(
+              math::eigen3::convert(frameData.angularAcceleration),
+              this->vec3Eql);
+
+          // Body-fixed frame
+          const Eigen::Matrix3d R_bs = worldPose.linear().transpose(); // NOLINT
+          writeBack.linearVelocity.Write(
+              math::eigen3::convert(
+                Eigen::Vector3d(R_bs * frameData.linearVelocity)),
+              this->vec3Eql);
+          writeBack.angularVelocity.Write(
+              math::eigen3::convert(
+                Eigen::Vector3d(R_bs * frameData.angularVelocity)),
+              this->vec3Eql);
+          writeBack.linearAcceleration.Write(
+              math::eigen3::convert(
+                Eigen::Vector3d(R_bs * frameData.linearAcceleration)),
+              this->vec3Eql);
+          writeBack.angularAcceleration.Write(
+              math::eigen3::convert(
+                Eigen::Vector3d(R_bs * frameData.angularAcceleration)),
+              this->vec3Eql);
         }
+      });
+  IGN_PROFILE_END();
 
+  IGN_PROFILE_BEGIN("Report changes");
+  for (const auto &writeBack : this->linkWriteBacks)
+  {
+    const auto entity = writeBack.entity;
+    if (writeBack.pose)
+    {
+      _ecm.SetChanged(entity, components::Pose::typeId,
+          ComponentState::PeriodicChange);
+    }
+    writeBack.worldPose.Apply(_ecm, entity);
+    writeBack.worldLinearVelocity.Apply(_ecm, entity);
+    writeBack.worldAngularVelocity.Apply(_ecm, entity);
+    writeBack.worldLinearAcceleration.Apply(_ecm, entity);
+    writeBack.worldAngularAcceleration.Apply(_ecm, entity);
+    writeBack.linearVelocity.Apply(_ecm, entity);
+    writeBack.angularVelocity.Apply(_ecm, entity);
+    writeBack.linearAcceleration.Apply(_ecm, entity);
+    writeBack.angularAcceleration.Apply(_ecm, entity);
+  }
+  IGN_PROFILE_END();
+  IGN_PROFILE_END();
+
+  // Update joint positions
+  IGN_PROFILE_BEGIN("Joints");
+  _ecm.Each<components::Joint, components::JointPosition>(
+      [&](const Entity &_entity, components::Joint *,
+          components::JointPosition *_jointPos) -> bool
+      {
+        if (auto jointPhys = this->entityJointMap.Get(_entity))
+        {
+          _jointPos->Data().resize(jointPhys->GetDegreesOfFreedom());
+          for (std::size_t i = 0; i < jointPhys->GetDegreesOfFreedom();
+               ++i)
+          {
+            _jointPos->Data()[i] = jointPhys->GetPosition(i);
+          }
+          _ecm.SetChanged(_entity, components::JointPosition::typeId,
+              ComponentState::PeriodicChange);
+        }
+        return true;
+      });
+
+  // Update joint Velocities
+  _ecm.Each<components::Joint, components::JointVelocity>(
+      [&](const Entity &_entity, components::Joint *,
+          components::JointVelocity *_jointVel) -> bool
+      {
+        if (auto jointPhys = this->entityJointMap.Get(_entity))
+        {
+          _jointVel->Data().resize(jointPhys->GetDegreesOfFreedom());
+          for (std::size_t i = 0; i < jointPhys->GetDegreesOfFreedom();
+               ++i)
+          {
+            _jointVel->Data()[i] = jointPhys->GetVelocity(i);
+          }
+        }
         return true;
       });
   IGN_PROFILE_END();
 
+  // TODO(louise) Skip this if there are no collision features
+  this->UpdateCollisions(_ecm);
+}
+
+//////////////////////////////////////////////////
+void PhysicsPrivate::ClearCommands(EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("PhysicsPrivate::ClearCommands");
+
   // Clear reset components
-  IGN_PROFILE_BEGIN("Clear / reset components");
   std::vector<Entity> entitiesPositionReset;
   _ecm.Each<components::JointPositionReset>(
       [&](const Entity &_entity, components::JointPositionReset *) -> bool
@@ -2200,63 +3607,14 @@ void PhysicsPrivate::UpdateSim(EntityComponentManager &_ecm,
         std::fill(_vel->Data().begin(), _vel->Data().end(), 0.0);
         return true;
       });
-
-  _ecm.Each<components::SlipComplianceCmd>(
-      [&](const Entity &, components::SlipComplianceCmd *_slip) -> bool
-      {
-        std::fill(_slip->Data().begin(), _slip->Data().end(), 0.0);
-        return true;
-      });
-  IGN_PROFILE_END();
-
-  // Update joint positions
-  IGN_PROFILE_BEGIN("Joints");
-  _ecm.Each<components::Joint, components::JointPosition>(
-      [&](const Entity &_entity, components::Joint *,
-          components::JointPosition *_jointPos) -> bool
-      {
-        if (auto jointPhys = this->entityJointMap.Get(_entity))
-        {
-          _jointPos->Data().resize(jointPhys->GetDegreesOfFreedom());
-          for (std::size_t i = 0; i < jointPhys->GetDegreesOfFreedom();
-               ++i)
-          {
-            _jointPos->Data()[i] = jointPhys->GetPosition(i);
-          }
-          _ecm.SetChanged(_entity, components::JointPosition::typeId,
-              ComponentState::PeriodicChange);
-        }
-        return true;
-      });
-
-  // Update joint Velocities
-  _ecm.Each<components::Joint, components::JointVelocity>(
-      [&](const Entity &_entity, components::Joint *,
-          components::JointVelocity *_jointVel) -> bool
-      {
-        if (auto jointPhys = this->entityJointMap.Get(_entity))
-        {
-          _jointVel->Data().resize(jointPhys->GetDegreesOfFreedom());
-          for (std::size_t i = 0; i < jointPhys->GetDegreesOfFreedom();
-               ++i)
-          {
-            _jointVel->Data()[i] = jointPhys->GetVelocity(i);
-          }
-        }
-        return true;
-      });
-  IGN_PROFILE_END();
-
-  // TODO(louise) Skip this if there are no collision features
-  this->UpdateCollisions(_ecm);
 }
 
 //////////////////////////////////////////////////
 void PhysicsPrivate::UpdateCollisions(EntityComponentManager &_ecm)
 {
   IGN_PROFILE("PhysicsPrivate::UpdateCollisions");
-  // Quit early if the ContactData component hasn't been created. This means
-  // there are no systems that need contact information
+  // Quit early if the ContactSensorData component hasn't been created. This
+  // means there are no systems that need contact information
   if (!_ecm.HasComponentType(components::ContactSensorData::typeId))
     return;
 
@@ -2294,78 +3652,97 @@ void PhysicsPrivate::UpdateCollisions(EntityComponentManager &_ecm)
 
   // Each contact object we get from ign-physics contains the EntityPtrs of the
   // two colliding entities and other data about the contact such as the
-  // position. This map groups contacts so that it is easy to query all the
-  // contacts of one entity.
-  using EntityContactMap = std::unordered_map<Entity,
-      std::deque<const WorldShapeType::ContactPoint *>>;
-
-  // This data structure is essentially a mapping between a pair of entities and
-  // a list of pointers to their contact object. We use a map inside a map to
-  // create msgs::Contact objects conveniently later on.
-  std::unordered_map<Entity, EntityContactMap> entityContactMap;
-
+  // position. Only the sides of contacts whose collision has a
+  // ContactSensorData component are kept, and they're sorted so that all the
+  // contacts of one collision, and then of one pair of collisions, are
+  // contiguous.
+  //
   // Note that we are temporarily storing pointers to elements in this
   // ("allContacts") container. Thus, we must make sure it doesn't get destroyed
   // until the end of this function.
   auto allContacts = worldCollisionFeature->GetContactsFromLastStep();
+  this->contactBuffer.clear();
   for (const auto &contactComposite : allContacts)
   {
     const auto &contact = contactComposite.Get<WorldShapeType::ContactPoint>();
     auto coll1Entity = this->entityCollisionMap.Get(contact.collision1);
     auto coll2Entity = this->entityCollisionMap.Get(contact.collision2);
 
-
     if (coll1Entity != kNullEntity && coll2Entity != kNullEntity)
     {
-      entityContactMap[coll1Entity][coll2Entity].push_back(&contact);
-      entityContactMap[coll2Entity][coll1Entity].push_back(&contact);
+      if (_ecm.EntityHasComponentType(coll1Entity,
+          components::ContactSensorData::typeId))
+      {
+        this->contactBuffer.push_back({coll1Entity, coll2Entity, &contact});
+      }
+      if (_ecm.EntityHasComponentType(coll2Entity,
+          components::ContactSensorData::typeId))
+      {
+        this->contactBuffer.push_back({coll2Entity, coll1Entity, &contact});
+      }
     }
   }
 
-  // Go through each collision entity that has a ContactData component and
-  // set the component value to the list of contacts that correspond to
+  // Keep the order of contact points within a pair of collisions
+  auto byCollisions = [](const ContactEntry &_a, const ContactEntry &_b)
+  {
+    return _a.collision < _b.collision ||
+        (_a.collision == _b.collision && _a.other < _b.other);
+  };
+  std::stable_sort(this->contactBuffer.begin(), this->contactBuffer.end(),
+      byCollisions);
+
+  // Go through each collision entity that has a ContactSensorData component
+  // and set the component value to the list of contacts that correspond to
   // the collision entity
   _ecm.Each<components::Collision, components::ContactSensorData>(
       [&](const Entity &_collEntity1, components::Collision *,
           components::ContactSensorData *_contacts) -> bool
       {
-        if (entityContactMap.find(_collEntity1) == entityContactMap.end())
+        auto [begin, end] = std::equal_range(this->contactBuffer.begin(),
+            this->contactBuffer.end(), ContactEntry{_collEntity1, 0, nullptr},
+            [](const ContactEntry &_a, const ContactEntry &_b)
+            {
+              return _a.collision < _b.collision;
+            });
+
+        if (begin == end)
         {
-          // Clear the last contact data
-          *_contacts = components::ContactSensorData();
+          // Clear the last contact data, unless it was set by the first
+          // partition
+          if (0 == this->partition)
+            *_contacts = components::ContactSensorData();
           return true;
         }
 
-        const auto &contactMap = entityContactMap[_collEntity1];
-
         msgs::Contacts contactsComp;
 
-        for (const auto &[collEntity2, contactData] : contactMap)
+        msgs::Contact *contactMsg{nullptr};
+        for (auto it = begin; it != end; ++it)
         {
-          msgs::Contact *contactMsg = contactsComp.add_contact();
-          contactMsg->mutable_collision1()->set_id(_collEntity1);
-          contactMsg->mutable_collision2()->set_id(collEntity2);
-          for (const auto &contact : contactData)
+          if (it == begin || it->other != std::prev(it)->other)
           {
-            auto *position = contactMsg->add_position();
-            position->set_x(contact->point.x());
-            position->set_y(contact->point.y());
-            position->set_z(contact->point.z());
+            contactMsg = contactsComp.add_contact();
+            contactMsg->mutable_collision1()->set_id(_collEntity1);
+            contactMsg->mutable_collision2()->set_id(it->other);
           }
+          auto *position = contactMsg->add_position();
+          position->set_x(it->contact->point.x());
+          position->set_y(it->contact->point.y());
+          position->set_z(it->contact->point.z());
         }
-        *_contacts = components::ContactSensorData(contactsComp);
+        // Static collisions are in all partitions, and may have contacts in
+        // each of them
+        if (0 == this->partition)
+          *_contacts = components::ContactSensorData(contactsComp);
+        else
+          _contacts->Data().MergeFrom(contactsComp);
 
         return true;
       });
-}
 
-physics::FrameData3d PhysicsPrivate::LinkFrameDataAtOffset(
-      const LinkPtrType &_link, const math::Pose3d &_pose) const
-{
-  physics::FrameData3d parent;
-  parent.pose = math::eigen3::convert(_pose);
-  physics::RelativeFrameData3d relFrameData(_link->GetFrameID(), parent);
-  return this->engine->Resolve(relFrameData, physics::FrameID::World());
+  // Don't keep pointers to the contacts of this step
+  this->contactBuffer.clear();
 }
 
 IGNITION_ADD_PLUGIN(Physics,
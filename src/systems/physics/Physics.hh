@@ -63,6 +63,62 @@ namespace systems
 
   /// \class Physics Physics.hh ignition/gazebo/systems/Physics.hh
   /// \brief Base class for a System.
+  ///
+  /// ## System Parameters
+  ///
+  /// `<engine><filename>`: Physics engine plugin. Defaults to DART.
+  ///
+  /// `<partitions>`: Optional. Splits the models into partitions which don't
+  /// interact with each other, each simulated by its own instance of the
+  /// engine, so they're stepped in parallel. Static models are part of all
+  /// partitions. Results are written back in partition order, so they don't
+  /// depend on thread timing. It contains:
+  ///
+  /// * `<count>`: Number of partitions.
+  /// * `<by>`: `collide_bitmask` (default) puts models whose collide
+  ///   bitmasks don't overlap in different partitions. `spatial` puts
+  ///   models in partitions according to the cell of a horizontal grid they
+  ///   spawn in, so models must stay away from those spawned in other
+  ///   cells.
+  /// * `<cell_size>`: Size of the grid cells in meters, for `spatial`.
+  ///   Defaults to 10.
+  ///
+  /// `<max_new_models_per_step>`: Optional. Maximum number of top level models
+  /// created in the physics engine on each step, so spawning many models at
+  /// once doesn't stall a step. The others wait for later steps, in the order
+  /// they were spawned, and ignore commands until they're created. Defaults
+  /// to 0, which means no limit.
+  ///
+  /// `<collision_proxy>`: Optional. Replaces collision meshes by proxies
+  /// which are cheaper to collide. Proxies are generated the first time a
+  /// mesh is loaded and cached on disk by the hash of the mesh file, so
+  /// later runs load them directly. It contains:
+  ///
+  /// * `<mode>`: `none` (default) uses meshes as is, `convex_hull` uses
+  ///   the convex hull of each mesh, and `simplify` merges nearby vertices.
+  /// * `<resolution>`: Cells along the longest side of a mesh where
+  ///   vertices are merged, for `simplify`. Defaults to 32.
+  /// * `<min_triangles>`: Meshes with fewer triangles are used as is.
+  ///   Defaults to 1000.
+  /// * `<cache_dir>`: Directory of the cached proxies. Defaults to
+  ///   `~/.ignition/gazebo/collision_proxies`.
+  ///
+  /// A collision can override the mode for its mesh, whatever its size,
+  /// with `<ignition:collision_proxy>mode</ignition:collision_proxy>`.
+  ///
+  /// `<shared_assets>`: Optional. True to keep the triangles of collision
+  /// meshes in a gazebo::SharedAssetStore, keyed by the hash of the mesh
+  /// file, so server processes on the same host map them read-only instead
+  /// of each parsing the file and holding the full mesh. Also enabled by
+  /// setting the `IGN_GAZEBO_SHARED_ASSETS` environment variable to 1.
+  /// Defaults to false.
+  ///
+  /// `<substeps>`: Optional. Number of physics steps taken for each
+  /// simulation iteration, each lasting a fraction of the iteration. Commands
+  /// are read and poses are written to the ECM only once per iteration, which
+  /// saves their cost when physics needs a small step size. Forces and
+  /// velocity commands are applied on every substep, resets only on the
+  /// first, and contacts are those of the last substep. Defaults to 1.
   class Physics:
     public System,
     public ISystemConfigure,
@@ -18,7 +18,12 @@
 #include "PosePublisher.hh"
 
 #include <ignition/msgs/pose.pb.h>
+#include <ignition/msgs/pose_v.pb.h>
 
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <stack>
 #include <string>
 #include <unordered_map>
@@ -32,6 +37,7 @@
 #include <ignition/math/Pose3.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/transport/Node.hh>
+#include <ignition/transport/TopicUtils.hh>
 
 #include "ignition/gazebo/Util.hh"
 #include "ignition/gazebo/components/CanonicalLink.hh"
@@ -47,6 +53,7 @@
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/Sensor.hh"
 #include "ignition/gazebo/components/Visual.hh"
+#include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/Model.hh"
 
@@ -54,9 +61,21 @@ using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+namespace
+{
+class PoseAggregator;
+}
+
 /// \brief Private data class for PosePublisher
 class ignition::gazebo::systems::PosePublisherPrivate
 {
+  /// \brief Destructor, leaves the aggregated publications
+  public: ~PosePublisherPrivate();
+
+  /// \brief Initialize the entity caches if they haven't been yet.
+  /// \param[in] _ecm Immutable reference to the entity component manager
+  public: void EnsureInitialized(const EntityComponentManager &_ecm);
+
   /// \brief Initializes internal caches for entities whose poses are to be
   /// published and their names
   /// \param[in] _ecm Immutable reference to the entity component manager
@@ -166,7 +185,191 @@ class ignition::gazebo::systems::PosePublisherPrivate
 
   /// \brief Whether cache variables have been initialized
   public: bool initialized{false};
+
+  /// \brief Protects initialization, which aggregators may trigger from
+  /// other instances' PostUpdate
+  public: std::mutex initMutex;
+
+  /// \brief Aggregated publications this instance is part of, empty if
+  /// poses are published on the instance's own topics
+  public: std::vector<std::shared_ptr<PoseAggregator>> aggregators;
+};
+
+namespace
+{
+/// \brief Packs the poses of all the PosePublisher instances that share an
+/// aggregate topic and an update rate into a single Pose_V message. The
+/// message layout, including frame names, is built once when members join
+/// or leave; each publication only rewrites the stamp and the pose values.
+class PoseAggregator
+{
+  /// \brief Constructor
+  /// \param[in] _topic Topic of the packed message
+  /// \param[in] _period Update period, zero to publish every iteration
+  public: PoseAggregator(const std::string &_topic,
+      const std::chrono::steady_clock::duration &_period)
+    : period(_period)
+  {
+    this->pub = this->node.Advertise<msgs::Pose_V>(_topic);
+  }
+
+  /// \brief Get the aggregator for a topic and rate, creating it if needed.
+  /// \param[in] _ecm Entity component manager of the instances
+  /// \param[in] _topic Topic of the packed message
+  /// \param[in] _period Update period
+  /// \return The shared aggregator.
+  public: static std::shared_ptr<PoseAggregator> Get(
+      const EntityComponentManager &_ecm, const std::string &_topic,
+      const std::chrono::steady_clock::duration &_period)
+  {
+    return _ecm.SharedObject<PoseAggregator>(
+        "ignition::gazebo::systems::PoseAggregator:" + _topic + ":" +
+        std::to_string(_period.count()), _topic, _period);
+  }
+
+  /// \brief Add an instance to the packed message.
+  /// \param[in] _member Instance to add
+  /// \param[in] _static True to publish the instance's static poses, false
+  /// for its dynamic poses. Ignored if the instance doesn't separate them.
+  public: void Add(PosePublisherPrivate *_member, bool _static)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->members.emplace_back(_member, _static);
+    this->layoutDirty = true;
+  }
+
+  /// \brief Remove an instance from the packed message.
+  /// \param[in] _member Instance to remove
+  public: void Remove(const PosePublisherPrivate *_member)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->members.erase(std::remove_if(this->members.begin(),
+        this->members.end(), [_member](const auto &_m)
+        {
+          return _m.first == _member;
+        }), this->members.end());
+    this->layoutDirty = true;
+  }
+
+  /// \brief Publish the packed message if it's due. Only the first call of
+  /// each iteration does any work.
+  /// \param[in] _info Update info
+  /// \param[in] _ecm Entity component manager
+  public: void Update(const UpdateInfo &_info,
+      const EntityComponentManager &_ecm)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->lastIteration == _info.iterations)
+      return;
+    this->lastIteration = _info.iterations;
+
+    auto diff = _info.simTime - this->lastPubTime;
+    if ((diff > std::chrono::steady_clock::duration::zero()) &&
+        (diff < this->period))
+    {
+      return;
+    }
+
+    IGN_PROFILE("PoseAggregator::Update");
+    if (this->layoutDirty)
+      this->BuildLayout(_ecm);
+
+    *this->msg.mutable_header()->mutable_stamp() =
+        convert<msgs::Time>(_info.simTime);
+    for (std::size_t i = 0; i < this->entities.size(); ++i)
+    {
+      // Entities that lost their pose keep their last value
+      auto pose = _ecm.Component<components::Pose>(this->entities[i]);
+      if (pose)
+        msgs::Set(this->msg.mutable_pose(static_cast<int>(i)), pose->Data());
+    }
+
+    this->pub.Publish(this->msg);
+    this->lastPubTime = _info.simTime;
+  }
+
+  /// \brief Rebuild the message layout from the members' caches.
+  /// \param[in] _ecm Entity component manager
+  private: void BuildLayout(const EntityComponentManager &_ecm)
+  {
+    this->msg.Clear();
+    this->entities.clear();
+    for (const auto &[member, isStatic] : this->members)
+    {
+      // Members that haven't run yet this iteration are initialized here,
+      // so the first message already holds all of them
+      member->EnsureInitialized(_ecm);
+
+      for (const auto &[entity, frames] : member->entitiesToPublish)
+      {
+        bool entityStatic = member->dynamicEntities.find(entity) ==
+            member->dynamicEntities.end();
+        if (member->staticPosePublisher && entityStatic != isStatic)
+          continue;
+
+        auto poseMsg = this->msg.add_pose();
+        auto frame = poseMsg->mutable_header()->add_data();
+        frame->set_key("frame_id");
+        frame->add_value(frames.first);
+        auto childFrame = poseMsg->mutable_header()->add_data();
+        childFrame->set_key("child_frame_id");
+        childFrame->add_value(frames.second);
+        poseMsg->set_name(frames.second);
+        this->entities.push_back(entity);
+      }
+    }
+    this->layoutDirty = false;
+  }
+
+  /// \brief Transport node
+  private: transport::Node node;
+
+  /// \brief Publisher of the packed message
+  private: transport::Node::Publisher pub;
+
+  /// \brief Update period
+  private: std::chrono::steady_clock::duration period{0};
+
+  /// \brief Last time the message was published
+  private: std::chrono::steady_clock::duration lastPubTime{0};
+
+  /// \brief Last iteration processed
+  private: uint64_t lastIteration{std::numeric_limits<uint64_t>::max()};
+
+  /// \brief Members and whether they contribute their static poses
+  private: std::vector<std::pair<PosePublisherPrivate *, bool>> members;
+
+  /// \brief Entity of each pose in the message
+  private: std::vector<Entity> entities;
+
+  /// \brief Reused packed message
+  private: msgs::Pose_V msg;
+
+  /// \brief True if members changed since the layout was built
+  private: bool layoutDirty{true};
+
+  /// \brief Protects the members and the message
+  private: std::mutex mutex;
 };
+}
+
+//////////////////////////////////////////////////
+PosePublisherPrivate::~PosePublisherPrivate()
+{
+  for (auto &aggregator : this->aggregators)
+    aggregator->Remove(this);
+}
+
+//////////////////////////////////////////////////
+void PosePublisherPrivate::EnsureInitialized(
+    const EntityComponentManager &_ecm)
+{
+  std::lock_guard<std::mutex> lock(this->initMutex);
+  if (this->initialized)
+    return;
+  this->InitializeEntitiesToPublish(_ecm);
+  this->initialized = true;
+}
 
 //////////////////////////////////////////////////
 PosePublisher::PosePublisher()
@@ -241,6 +444,38 @@ void PosePublisher::Configure(const Entity &_entity,
   this->dataPtr->usePoseV =
     _sdf->Get<bool>("use_pose_vector_msg", this->dataPtr->usePoseV).first;
 
+  // Aggregate with all other instances at the same rate
+  if (_sdf->Get<bool>("aggregate", false).first)
+  {
+    auto world = worldEntity(_entity, _ecm);
+    auto worldName = _ecm.Component<components::Name>(world);
+    std::string defaultTopic = "/world/" +
+        (worldName ? worldName->Data() : std::string("default")) +
+        "/pose_aggregate";
+    auto aggregateTopic = transport::TopicUtils::AsValidTopic(
+        _sdf->Get<std::string>("aggregate_topic", defaultTopic).first);
+    if (aggregateTopic.empty())
+    {
+      ignerr << "Invalid aggregate topic, poses won't be published."
+             << std::endl;
+      return;
+    }
+
+    auto aggregator = PoseAggregator::Get(_ecm, aggregateTopic,
+        this->dataPtr->updatePeriod);
+    aggregator->Add(this->dataPtr.get(), false);
+    this->dataPtr->aggregators.push_back(aggregator);
+
+    if (this->dataPtr->staticPosePublisher)
+    {
+      auto staticAggregator = PoseAggregator::Get(_ecm,
+          aggregateTopic + "_static", this->dataPtr->staticUpdatePeriod);
+      staticAggregator->Add(this->dataPtr.get(), true);
+      this->dataPtr->aggregators.push_back(staticAggregator);
+    }
+    return;
+  }
+
   std::string poseTopic = scopedName(_entity, _ecm) + "/pose";
   std::string staticPoseTopic = poseTopic + "_static";
 
@@ -287,6 +522,14 @@ void PosePublisher::PostUpdate(const UpdateInfo &_info,
   if (_info.paused)
     return;
 
+  if (!this->dataPtr->aggregators.empty())
+  {
+    this->dataPtr->EnsureInitialized(_ecm);
+    for (auto &aggregator : this->dataPtr->aggregators)
+      aggregator->Update(_info, _ecm);
+    return;
+  }
+
   bool publish = true;
   auto diff = _info.simTime - this->dataPtr->lastPosePubTime;
   // If the diff is positive and it's less than the update period, we skip
@@ -310,11 +553,7 @@ void PosePublisher::PostUpdate(const UpdateInfo &_info,
   if (!publish && !publishStatic)
     return;
 
-  if (!this->dataPtr->initialized)
-  {
-    this->dataPtr->InitializeEntitiesToPublish(_ecm);
-    this->dataPtr->initialized = true;
-  }
+  this->dataPtr->EnsureInitialized(_ecm);
 
 
   // if static transforms are published through a different topic
@@ -62,6 +62,18 @@ namespace systems
   ///                             negative frequency publishes as fast as
   ///                             possible (i.e, at the rate of the simulation
   ///                             step).
+  /// aggregate                 : Set to true to publish the poses of all
+  ///                             instances with the same update_frequency in
+  ///                             a single ignition::msgs::Pose_V message on
+  ///                             the aggregate topic, instead of on this
+  ///                             model's topics. The message layout and frame
+  ///                             names are built once, and each publication
+  ///                             only updates the header stamp and the poses.
+  ///                             With static_publisher, static poses are
+  ///                             aggregated on "<aggregate_topic>_static"
+  ///                             at the static_update_frequency.
+  /// aggregate_topic           : Topic of the aggregated message. Defaults to
+  ///                             "/world/<world_name>/pose_aggregate".
   class PosePublisher
       : public System,
         public ISystemConfigure,
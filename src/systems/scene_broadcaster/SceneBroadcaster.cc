@@ -17,19 +17,37 @@
 
 #include "SceneBroadcaster.hh"
 
+#include <ignition/msgs/boolean.pb.h>
+#include <ignition/msgs/bytes.pb.h>
+#include <ignition/msgs/param.pb.h>
 #include <ignition/msgs/scene.pb.h>
 
+#include <ignition/msgs/Utility.hh>
+
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Frustum.hh>
 #include <ignition/math/graph/Graph.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/transport/Node.hh>
 
+#include "ignition/gazebo/components/BinarySerializer.hh"
 #include "ignition/gazebo/components/CastShadows.hh"
+#include "ignition/gazebo/components/Factory.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Light.hh"
 #include "ignition/gazebo/components/Link.hh"
@@ -43,6 +61,9 @@
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/Conversions.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/PackedPoses.hh"
+#include "ignition/gazebo/SharedMemoryChannel.hh"
+#include "ignition/gazebo/Util.hh"
 
 using namespace std::chrono_literals;
 
@@ -57,6 +78,18 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   public: using SceneGraphType = math::graph::DirectedGraph<
           std::shared_ptr<google::protobuf::Message>, bool>;
 
+  /// \brief Destructor, stops the publish thread.
+  public: ~SceneBroadcasterPrivate();
+
+  /// \brief Publish a state message and write it into the shared memory
+  /// channel.
+  /// \param[in] _msg State to publish.
+  public: void PublishState(const msgs::SerializedStepMap &_msg);
+
+  /// \brief Body of the publish thread, which publishes each message handed
+  /// over in publishMsg.
+  public: void PublishLoop();
+
   /// \brief Setup Ignition transport services and publishers
   /// \param[in] _worldName Name of world.
   public: void SetupTransport(const std::string &_worldName);
@@ -80,6 +113,29 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \param[out] _res Response containing the last available full state.
   public: void StateAsyncService(const ignition::msgs::StringMsg &_req);
 
+  /// \brief Quantize the poses in the state message.
+  public: void QuantizePoses();
+
+  /// \brief Tag the state message with its frame type and sequence number.
+  /// \param[in] _keyframe True if the message holds the full state.
+  public: void SetFrameHeader(bool _keyframe);
+
+  /// \brief Callback for the state interest service, which registers or
+  /// removes a client's area of interest.
+  /// \param[in] _req Interest parameters, see the SceneBroadcaster
+  /// documentation.
+  /// \param[out] _res True if the request was valid.
+  /// \return True.
+  public: bool StateInterestService(const msgs::Param &_req,
+      msgs::Boolean &_res);
+
+  /// \brief Publish the state of each client's area of interest.
+  /// \param[in] _info Update info.
+  /// \param[in] _manager The entity component manager.
+  /// \param[in] _full True to send the full state of each area.
+  public: void PublishInterestStates(const UpdateInfo &_info,
+      const EntityComponentManager &_manager, bool _full);
+
   /// \brief Updates the scene graph when entities are added
   /// \param[in] _manager The entity component manager
   public: void SceneGraphAddEntities(const EntityComponentManager &_manager);
@@ -124,6 +180,19 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   public: static void AddVisuals(msgs::Link *_msg, const Entity _entity,
                                  const SceneGraphType &_graph);
 
+  /// \brief Get the model or light directly under the world which an entity
+  /// of the scene graph belongs to.
+  /// \param[in] _entity Entity in the scene graph.
+  /// \return The top level entity, or kNullEntity if the entity isn't
+  /// connected to the world in the scene graph.
+  public: Entity TopLevelEntity(Entity _entity) const;
+
+  /// \brief Rebuild the cached messages of top level entities from the scene
+  /// graph, or remove them if they're no longer in it. The graph mutex must
+  /// be locked.
+  /// \param[in] _entities Top level models and lights which changed.
+  public: void UpdateSceneCache(const std::set<Entity> &_entities);
+
   /// \brief Recursively remove entities from the graph
   /// \param[in] _entity Entity
   /// \param[in/out] _graph Scene graph
@@ -136,6 +205,12 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   public: void PoseUpdate(const UpdateInfo &_info,
     const EntityComponentManager &_manager);
 
+  /// \brief Create and send out packed dynamic poses.
+  /// \param[in] _info The update information
+  /// \param[in] _manager The entity component manager
+  public: void PackedPoseUpdate(const UpdateInfo &_info,
+    const EntityComponentManager &_manager);
+
   /// \brief Transport node.
   public: std::unique_ptr<transport::Node> node{nullptr};
 
@@ -148,6 +223,23 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \brief Rate at which to publish dynamic poses
   public: int dyPoseHertz{60};
 
+  /// \brief Packed dynamic pose publisher, see PackedPoses.
+  public: transport::Node::Publisher packedPosePub;
+
+  /// \brief Period to publish packed poses, zero if they're disabled.
+  public: std::chrono::duration<int64_t, std::ratio<1, 1000>>
+      packedPosePeriod{0};
+
+  /// \brief Position resolution of packed poses, in meters.
+  public: double packedPoseResolution{0.001};
+
+  /// \brief Last time packed poses were published.
+  public: std::chrono::time_point<std::chrono::system_clock>
+      lastPackedPosePubTime;
+
+  /// \brief Packed poses message, rebuilt in place.
+  public: msgs::Bytes packedPoseMsg;
+
   /// \brief Scene publisher
   public: transport::Node::Publisher scenePub;
 
@@ -176,6 +268,21 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   /// \brief Protects scene graph.
   public: std::mutex graphMutex;
 
+  /// \brief Full message of each top level model, including its nested
+  /// models, links, visuals and lights, patched when entities are added or
+  /// removed. Sorted like the scene graph's vertices.
+  public: std::map<Entity, msgs::Model> sceneModels;
+
+  /// \brief Message of each light directly under the world.
+  public: std::map<Entity, msgs::Light> sceneLights;
+
+  /// \brief Scene served by the scene info service, assembled from
+  /// sceneModels and sceneLights.
+  public: msgs::Scene sceneMsg;
+
+  /// \brief True if sceneMsg must be assembled again before it's served.
+  public: bool sceneMsgDirty{true};
+
   /// \brief Protects stepMsg.
   public: std::mutex stateMutex;
 
@@ -193,13 +300,126 @@ class ignition::gazebo::systems::SceneBroadcasterPrivate
   public: std::chrono::duration<int64_t, std::ratio<1, 1000>>
       statePublishPeriod{std::chrono::milliseconds(1000/60)};
 
+  /// \brief True to publish keyframes and deltas instead of all periodic
+  /// changes.
+  public: bool stateDeltas{false};
+
+  /// \brief Period between keyframes when publishing deltas.
+  public: std::chrono::duration<int64_t, std::ratio<1, 1000>>
+      keyframePeriod{std::chrono::seconds(1)};
+
+  /// \brief Last time a keyframe was published.
+  public: std::chrono::time_point<std::chrono::system_clock> lastKeyframeTime;
+
+  /// \brief Sequence number of the last published state.
+  public: uint64_t stateSequence{0};
+
+  /// \brief Change generation which the next delta starts from, zero
+  /// before the first keyframe.
+  public: uint64_t deltaGeneration{0};
+
+  /// \brief Resolution of quantized poses in deltas, zero to send full
+  /// precision poses.
+  public: double poseResolution{0.0};
+
+  /// \brief Shared memory channel which states are also written into,
+  /// nullptr if disabled.
+  public: std::unique_ptr<SharedMemoryWriter> stateChannel;
+
+  /// \brief True to serialize and publish states on publishThread, while
+  /// the next iteration runs.
+  public: bool asyncStatePublish{true};
+
+  /// \brief True to send static entities in states which only hold
+  /// periodic changes.
+  public: bool staticPeriodicState{false};
+
+  /// \brief Thread which publishes states, started with the first one.
+  public: std::thread publishThread;
+
+  /// \brief Protects publishMsg, publishPending and publishStop.
+  public: std::mutex publishMutex;
+
+  /// \brief Signals publishPending and publishStop changes.
+  public: std::condition_variable publishCv;
+
+  /// \brief State being published, swapped with stepMsg.
+  public: msgs::SerializedStepMap publishMsg;
+
+  /// \brief True while publishMsg hasn't been published yet.
+  public: bool publishPending{false};
+
+  /// \brief True to stop publishThread.
+  public: bool publishStop{false};
+
   /// \brief Flag used to indicate if the state service was called.
   public: bool stateServiceRequest{false};
 
   /// \brief A list of async state requests
   public: std::unordered_set<std::string> stateRequests;
+
+  /// \brief Area of interest and component filter of a client.
+  public: struct StateInterest
+  {
+    /// \brief Publisher of the client's state.
+    transport::Node::Publisher pub;
+
+    /// \brief Entity which the sphere follows, or kNullEntity.
+    Entity entity{kNullEntity};
+
+    /// \brief Center of the sphere, as an offset from the entity's world
+    /// position if there's an entity.
+    math::Vector3d center;
+
+    /// \brief Radius of the sphere, negative if there's no sphere.
+    double radius{-1.0};
+
+    /// \brief Box in the world frame.
+    std::optional<math::AxisAlignedBox> box;
+
+    /// \brief Camera frustum in the world frame.
+    std::optional<math::Frustum> frustum;
+
+    /// \brief Component types to send, empty for all.
+    std::unordered_set<ComponentTypeId> types;
+
+    /// \brief Entities sent in the last message.
+    std::unordered_set<Entity> entities;
+
+    /// \brief Client's message, rebuilt in place.
+    msgs::SerializedStepMap msg;
+  };
+
+  /// \brief Areas of interest, keyed by the topic they're published on.
+  public: std::map<std::string, StateInterest> interests;
+
+  /// \brief Protects interests.
+  public: std::mutex interestMutex;
+
+  /// \brief True if an area of interest was registered since they were
+  /// last published, so its client gets its initial state even while
+  /// paused.
+  public: std::atomic<bool> newInterest{false};
+
+  /// \brief Last time the areas of interest were published.
+  public: std::chrono::time_point<std::chrono::system_clock>
+      lastInterestPubTime{std::chrono::system_clock::now()};
 };
 
+//////////////////////////////////////////////////
+SceneBroadcasterPrivate::~SceneBroadcasterPrivate()
+{
+  if (this->publishThread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->publishMutex);
+      this->publishStop = true;
+    }
+    this->publishCv.notify_all();
+    this->publishThread.join();
+  }
+}
+
 //////////////////////////////////////////////////
 SceneBroadcaster::SceneBroadcaster()
   : System(), dataPtr(std::make_unique<SceneBroadcasterPrivate>())
@@ -226,11 +446,64 @@ void SceneBroadcaster::Configure(
   auto readHertz = _sdf->Get<int>("dynamic_pose_hertz", 60);
   this->dataPtr->dyPoseHertz = readHertz.first;
 
+  auto packedPoseHertz = _sdf->Get<double>("packed_pose_hertz", 0.0).first;
+  if (packedPoseHertz > 0.0)
+  {
+    this->dataPtr->packedPosePeriod =
+        std::chrono::duration<int64_t, std::ratio<1, 1000>>(
+        static_cast<int64_t>(1000.0 / packedPoseHertz));
+  }
+  auto packedPoseResolution =
+      _sdf->Get<double>("packed_pose_resolution", 0.001).first;
+  if (packedPoseResolution > 0.0)
+  {
+    this->dataPtr->packedPoseResolution = packedPoseResolution;
+  }
+  else
+  {
+    ignerr << "Packed pose resolution must be positive, using ["
+           << this->dataPtr->packedPoseResolution << "] m." << std::endl;
+  }
+
   auto stateHerz = _sdf->Get<int>("state_hertz", 60);
   this->dataPtr->statePublishPeriod =
       std::chrono::duration<int64_t, std::ratio<1, 1000>>(
       std::chrono::milliseconds(1000/stateHerz.first));
 
+  this->dataPtr->stateDeltas = _sdf->Get<bool>("state_deltas", false).first;
+  auto keyframePeriod = _sdf->Get<double>("state_keyframe_period", 1.0);
+  this->dataPtr->keyframePeriod =
+      std::chrono::duration<int64_t, std::ratio<1, 1000>>(
+      std::chrono::milliseconds(
+      static_cast<int64_t>(keyframePeriod.first * 1000)));
+  this->dataPtr->poseResolution =
+      _sdf->Get<double>("state_pose_resolution", 0.0).first;
+
+  this->dataPtr->asyncStatePublish =
+      _sdf->Get<bool>("state_async_publish", true).first;
+  this->dataPtr->staticPeriodicState =
+      _sdf->Get<bool>("state_static_periodic", false).first;
+
+  if (_sdf->Get<bool>("state_shared_memory", false).first)
+  {
+    auto slotCount = _sdf->Get<int>("state_shared_memory_slots", 16).first;
+    auto slotSize =
+        _sdf->Get<int>("state_shared_memory_slot_size", 16 << 20).first;
+    if (slotCount <= 0 || slotSize <= 0)
+    {
+      ignerr << "Invalid shared memory slots [" << slotCount << "] of ["
+             << slotSize << "] bytes. State won't be written to shared memory."
+             << std::endl;
+    }
+    else
+    {
+      auto channel = std::make_unique<SharedMemoryWriter>(
+          stateChannelName(this->dataPtr->worldName), slotCount, slotSize);
+      if (channel->Valid())
+        this->dataPtr->stateChannel = std::move(channel);
+    }
+  }
+
   // Add to graph
   {
     std::lock_guard<std::mutex> lock(this->dataPtr->graphMutex);
@@ -259,6 +532,20 @@ void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
     this->dataPtr->PoseUpdate(_info, _manager);
   }
 
+  // Packed poses are throttled here, so they aren't packed when they
+  // wouldn't be sent
+  if (this->dataPtr->packedPosePub &&
+      this->dataPtr->packedPosePub.HasConnections())
+  {
+    auto now = std::chrono::system_clock::now();
+    if (now - this->dataPtr->lastPackedPosePubTime >=
+        this->dataPtr->packedPosePeriod)
+    {
+      this->dataPtr->lastPackedPosePubTime = now;
+      this->dataPtr->PackedPoseUpdate(_info, _manager);
+    }
+  }
+
   // call SceneGraphRemoveEntities at the end of this update cycle so that
   // removed entities are removed from the scene graph for the next update cycle
   this->dataPtr->SceneGraphRemoveEntities(_manager);
@@ -278,31 +565,69 @@ void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
   auto now = std::chrono::system_clock::now();
   bool itsPubTime = !_info.paused && (now - this->dataPtr->lastStatePubTime >
        this->dataPtr->statePublishPeriod);
-  auto shouldPublish = this->dataPtr->statePub.HasConnections() &&
-       (changeEvent || itsPubTime);
+  auto shouldPublish = (this->dataPtr->statePub.HasConnections() ||
+       nullptr != this->dataPtr->stateChannel) && (changeEvent || itsPubTime);
 
   if (this->dataPtr->stateServiceRequest || shouldPublish)
   {
     std::unique_lock<std::mutex> lock(this->dataPtr->stateMutex);
-    this->dataPtr->stepMsg.Clear();
 
+    // The message isn't cleared, the state is rebuilt in place instead, so
+    // that steady state publishing reuses its memory.
     set(this->dataPtr->stepMsg.mutable_stats(), _info);
 
+    if (this->dataPtr->stateDeltas)
+    {
+      // Keyframes hold the full state. Deltas hold everything that changed
+      // since the previous published message, including one-time changes,
+      // which are published right away.
+      bool keyframe = this->dataPtr->deltaGeneration == 0 ||
+          jumpBackInTime || this->dataPtr->stateServiceRequest ||
+          now - this->dataPtr->lastKeyframeTime >
+          this->dataPtr->keyframePeriod;
+      if (keyframe)
+      {
+        _manager.RebuildState(*this->dataPtr->stepMsg.mutable_state(), {}, {},
+            true);
+      }
+      else
+      {
+        IGN_PROFILE("SceneBroadcast::PostUpdate UpdateDelta");
+        _manager.RebuildState(*this->dataPtr->stepMsg.mutable_state(), {}, {},
+            false, this->dataPtr->deltaGeneration);
+        if (this->dataPtr->poseResolution > 0.0)
+          this->dataPtr->QuantizePoses();
+      }
+
+      // Messages which are only sent to the state service don't move the
+      // stream forward
+      if (shouldPublish)
+      {
+        ++this->dataPtr->stateSequence;
+        this->dataPtr->deltaGeneration = _manager.ChangeGeneration() + 1;
+        if (keyframe)
+          this->dataPtr->lastKeyframeTime = now;
+      }
+      this->dataPtr->SetFrameHeader(keyframe);
+    }
     // Publish full state if there are change events
-    if (changeEvent || this->dataPtr->stateServiceRequest)
+    else if (changeEvent || this->dataPtr->stateServiceRequest)
     {
-      _manager.State(*this->dataPtr->stepMsg.mutable_state(), {}, {}, true);
+      _manager.RebuildState(*this->dataPtr->stepMsg.mutable_state(), {}, {},
+          true);
     }
     // Otherwise publish just periodic change components
     else
     {
       IGN_PROFILE("SceneBroadcast::PostUpdate UpdateState");
       auto periodicComponents = _manager.ComponentTypesWithPeriodicChanges();
-      _manager.State(*this->dataPtr->stepMsg.mutable_state(),
-          {}, periodicComponents);
+      _manager.RebuildState(*this->dataPtr->stepMsg.mutable_state(),
+          {}, periodicComponents, false, 0,
+          this->dataPtr->staticPeriodicState);
     }
 
     // Full state on demand
+    bool served = this->dataPtr->stateServiceRequest;
     if (this->dataPtr->stateServiceRequest)
     {
       this->dataPtr->stateServiceRequest = false;
@@ -324,11 +649,303 @@ void SceneBroadcaster::PostUpdate(const UpdateInfo &_info,
     // changed components
     if (shouldPublish)
     {
-      IGN_PROFILE("SceneBroadcast::PostUpdate Publish State");
-      this->dataPtr->statePub.Publish(this->dataPtr->stepMsg);
       this->dataPtr->lastStatePubTime = now;
+
+      // Wait for the previous message, so messages go out in order
+      std::unique_lock<std::mutex> publishLock(this->dataPtr->publishMutex);
+      {
+        IGN_PROFILE("SceneBroadcast::PostUpdate Wait Publish");
+        this->dataPtr->publishCv.wait(publishLock,
+            [&] { return !this->dataPtr->publishPending; });
+      }
+
+      // Hand the message over to the publish thread, which serializes it
+      // while the next iteration runs. The state service still reads
+      // stepMsg when it was served, so that message is published here.
+      if (this->dataPtr->asyncStatePublish && !served)
+      {
+        if (!this->dataPtr->publishThread.joinable())
+        {
+          this->dataPtr->publishThread = std::thread(
+              &SceneBroadcasterPrivate::PublishLoop, this->dataPtr.get());
+        }
+        this->dataPtr->publishMsg.Swap(&this->dataPtr->stepMsg);
+        this->dataPtr->publishPending = true;
+        publishLock.unlock();
+        this->dataPtr->publishCv.notify_all();
+      }
+      else
+      {
+        this->dataPtr->PublishState(this->dataPtr->stepMsg);
+      }
+    }
+  }
+
+  // Per client areas of interest, on the same schedule
+  const bool newInterest = this->dataPtr->newInterest.exchange(false);
+  if (changeEvent || newInterest || (!_info.paused &&
+      now - this->dataPtr->lastInterestPubTime >
+      this->dataPtr->statePublishPeriod))
+  {
+    this->dataPtr->PublishInterestStates(_info, _manager, jumpBackInTime);
+    this->dataPtr->lastInterestPubTime = now;
+  }
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::PublishState(const msgs::SerializedStepMap &_msg)
+{
+  IGN_PROFILE("SceneBroadcast::PublishState");
+  if (this->statePub.HasConnections())
+    this->statePub.Publish(_msg);
+
+  // Serialize straight into the ring, so local clients don't need any
+  // copies through sockets
+  if (nullptr != this->stateChannel)
+  {
+    IGN_PROFILE("SceneBroadcast::PublishState Write State");
+    auto size = _msg.ByteSizeLong();
+    auto slot = this->stateChannel->Reserve(size);
+    if (nullptr != slot && _msg.SerializeToArray(slot, static_cast<int>(size)))
+    {
+      this->stateChannel->Commit();
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::PublishLoop()
+{
+  std::unique_lock<std::mutex> lock(this->publishMutex);
+  while (true)
+  {
+    this->publishCv.wait(lock,
+        [&] { return this->publishPending || this->publishStop; });
+    if (!this->publishPending)
+      return;
+
+    // PostUpdate doesn't touch publishMsg while it's pending
+    lock.unlock();
+    this->PublishState(this->publishMsg);
+    lock.lock();
+
+    this->publishPending = false;
+    this->publishCv.notify_all();
+  }
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::PublishInterestStates(const UpdateInfo &_info,
+    const EntityComponentManager &_manager, bool _full)
+{
+  std::lock_guard<std::mutex> lock(this->interestMutex);
+  if (this->interests.empty())
+    return;
+
+  IGN_PROFILE("SceneBroadcasterPrivate::PublishInterestStates");
+
+  // World positions of top level entities, shared by all clients. Entities
+  // are sent with all their descendants, so that whole models are shown.
+  std::vector<std::pair<Entity, std::optional<math::Vector3d>>> topLevel;
+  for (const Entity &child : _manager.ChildEntities(this->worldEntity))
+  {
+    std::optional<math::Vector3d> position;
+    if (nullptr != _manager.Component<components::Pose>(child))
+      position = worldPose(child, _manager).Pos();
+    topLevel.emplace_back(child, position);
+  }
+
+  for (auto &[topic, interest] : this->interests)
+  {
+    if (!interest.pub.HasConnections())
+    {
+      // Clients which didn't get their initial state yet get it as soon as
+      // they're connected
+      if (interest.entities.empty())
+        this->newInterest = true;
+      continue;
+    }
+
+    math::Vector3d center = interest.center;
+    if (interest.entity != kNullEntity)
+      center += worldPose(interest.entity, _manager).Pos();
+
+    // Entities without a pose are always of interest
+    std::unordered_set<Entity> entities{this->worldEntity};
+    for (const auto &[entity, position] : topLevel)
+    {
+      if (position)
+      {
+        if (interest.radius >= 0.0 &&
+            position->Distance(center) > interest.radius)
+        {
+          continue;
+        }
+        if (interest.box && !interest.box->Contains(*position))
+          continue;
+        if (interest.frustum && !interest.frustum->Contains(*position))
+          continue;
+      }
+      auto descendants = _manager.Descendants(entity);
+      entities.insert(descendants.begin(), descendants.end());
+    }
+
+    // Entities which just entered the area need all their components
+    bool entered{false};
+    for (const Entity &entity : entities)
+    {
+      if (interest.entities.find(entity) == interest.entities.end())
+      {
+        entered = true;
+        break;
+      }
+    }
+
+    set(interest.msg.mutable_stats(), _info);
+    _manager.RebuildState(*interest.msg.mutable_state(), entities,
+        interest.types, _full || entered);
+    interest.entities = std::move(entities);
+    interest.pub.Publish(interest.msg);
+  }
+}
+
+//////////////////////////////////////////////////
+bool SceneBroadcasterPrivate::StateInterestService(const msgs::Param &_req,
+    msgs::Boolean &_res)
+{
+  _res.set_data(false);
+
+  auto param = [&](const std::string &_key) -> const msgs::Any *
+  {
+    auto iter = _req.params().find(_key);
+    return iter == _req.params().end() ? nullptr : &iter->second;
+  };
+  auto doubleParam = [&](const std::string &_key, double _default)
+  {
+    auto value = param(_key);
+    return nullptr == value ? _default : value->double_value();
+  };
+
+  auto topicParam = param("topic");
+  std::string topic = nullptr == topicParam ? "" :
+      transport::TopicUtils::AsValidTopic(topicParam->string_value());
+  if (topic.empty())
+  {
+    ignerr << "State interest requests need a valid [topic]." << std::endl;
+    return true;
+  }
+
+  auto removeParam = param("remove");
+  if (nullptr != removeParam && removeParam->bool_value())
+  {
+    std::lock_guard<std::mutex> lock(this->interestMutex);
+    _res.set_data(this->interests.erase(topic) > 0);
+    return true;
+  }
+
+  StateInterest interest;
+  if (auto entity = param("entity"))
+    interest.entity = static_cast<Entity>(entity->int_value());
+  if (auto center = param("center"))
+    interest.center = msgs::Convert(center->vector3d_value());
+  interest.radius = doubleParam("radius", -1.0);
+
+  auto boxMin = param("box_min");
+  auto boxMax = param("box_max");
+  if (nullptr != boxMin && nullptr != boxMax)
+  {
+    interest.box = math::AxisAlignedBox(msgs::Convert(boxMin->vector3d_value()),
+        msgs::Convert(boxMax->vector3d_value()));
+  }
+
+  if (auto frustumPose = param("frustum_pose"))
+  {
+    interest.frustum = math::Frustum(doubleParam("frustum_near", 0.1),
+        doubleParam("frustum_far", 100.0),
+        math::Angle(doubleParam("frustum_fov", IGN_PI / 2.0)),
+        doubleParam("frustum_aspect", 1.0),
+        msgs::Convert(frustumPose->pose3d_value()));
+  }
+
+  // Comma separated component names
+  if (auto componentsParam = param("components"))
+  {
+    std::stringstream names(componentsParam->string_value());
+    std::string name;
+    auto factory = components::Factory::Instance();
+    while (std::getline(names, name, ','))
+    {
+      bool found{false};
+      for (const auto &typeId : factory->TypeIds())
+      {
+        if (factory->Name(typeId) == name)
+        {
+          interest.types.insert(typeId);
+          found = true;
+          break;
+        }
+      }
+      if (!found)
+      {
+        ignerr << "Unknown component [" << name << "] in state interest for ["
+               << topic << "]." << std::endl;
+        return true;
+      }
     }
   }
+
+  interest.pub = this->node->Advertise<msgs::SerializedStepMap>(topic);
+  if (!interest.pub)
+  {
+    ignerr << "Failed to advertise state interest topic [" << topic << "]."
+           << std::endl;
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(this->interestMutex);
+  this->interests[topic] = std::move(interest);
+  this->newInterest = true;
+  _res.set_data(true);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::QuantizePoses()
+{
+  IGN_PROFILE("SceneBroadcasterPrivate::QuantizePoses");
+  components::Pose pose;
+  for (auto &entity : *this->stepMsg.mutable_state()->mutable_entities())
+  {
+    auto &comps = *entity.second.mutable_components();
+    auto compIter = comps.find(components::Pose::typeId);
+    if (compIter == comps.end() || compIter->second.remove())
+      continue;
+
+    auto &buffer = *compIter->second.mutable_component();
+    pose.DeserializeFromBuffer(buffer);
+    serializers::QuantizedPoseLayout::Write(pose.Data(),
+        this->poseResolution, buffer);
+  }
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::SetFrameHeader(bool _keyframe)
+{
+  // Update the entries in place, so the message keeps its memory
+  auto header = this->stepMsg.mutable_state()->mutable_header();
+  if (header->data_size() != 2)
+  {
+    header->clear_data();
+    auto frame = header->add_data();
+    frame->set_key("frame");
+    frame->add_value();
+    auto seq = header->add_data();
+    seq->set_key("seq");
+    seq->add_value();
+  }
+  header->mutable_data(0)->set_value(0, _keyframe ? "key" : "delta");
+  header->mutable_data(1)->set_value(0,
+      std::to_string(this->stateSequence));
 }
 
 //////////////////////////////////////////////////
@@ -375,7 +992,7 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
       [&](const Entity &_entity, const components::Link *,
           const components::Name *_nameComp,
           const components::Pose *_poseComp,
-          const components::ParentEntity *_parentComp) -> bool
+          const components::ParentEntity *) -> bool
       {
         // Add to pose msg
         if (poseConnections)
@@ -386,10 +1003,7 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
           pose->set_id(_entity);
         }
 
-        // Check whether parent model is static
-        auto staticComp = _manager.Component<components::Static>(
-          _parentComp->Data());
-        if (dyPoseConnections && !staticComp->Data())
+        if (dyPoseConnections && !_manager.IsStatic(_entity))
         {
           // Add to dynamic pose msg
           auto dyPose = dyPoseMsg.add_pose();
@@ -447,6 +1061,39 @@ void SceneBroadcasterPrivate::PoseUpdate(const UpdateInfo &_info,
   }
 }
 
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::PackedPoseUpdate(const UpdateInfo &_info,
+    const EntityComponentManager &_manager)
+{
+  IGN_PROFILE("SceneBroadcast::PackedPoseUpdate");
+
+  // Same poses as the dynamic pose message: non-static models and links
+  auto &buffer = *this->packedPoseMsg.mutable_data();
+  PackedPoses::Begin(this->packedPoseResolution, _info.simTime, buffer);
+
+  _manager.Each<components::Model, components::Pose, components::Static>(
+      [&](const Entity &_entity, const components::Model *,
+          const components::Pose *_poseComp,
+          const components::Static *_staticComp) -> bool
+      {
+        if (!_staticComp->Data())
+          PackedPoses::Append(_entity, _poseComp->Data(), buffer);
+        return true;
+      });
+
+  _manager.Each<components::Link, components::Pose, components::ParentEntity>(
+      [&](const Entity &_entity, const components::Link *,
+          const components::Pose *_poseComp,
+          const components::ParentEntity *) -> bool
+      {
+        if (!_manager.IsStatic(_entity))
+          PackedPoses::Append(_entity, _poseComp->Data(), buffer);
+        return true;
+      });
+
+  this->packedPosePub.Publish(this->packedPoseMsg);
+}
+
 //////////////////////////////////////////////////
 void SceneBroadcasterPrivate::SetupTransport(const std::string &_worldName)
 {
@@ -500,6 +1147,15 @@ void SceneBroadcasterPrivate::SetupTransport(const std::string &_worldName)
   ignmsg << "Serving full state (async) on [" << opts.NameSpace() << "/"
          << stateAsyncService << "]" << std::endl;
 
+  // State interest service
+  std::string stateInterestService{"state_interest"};
+
+  this->node->Advertise(stateInterestService,
+      &SceneBroadcasterPrivate::StateInterestService, this);
+
+  ignmsg << "Serving state areas of interest on [" << opts.NameSpace() << "/"
+         << stateInterestService << "]" << std::endl;
+
   // Scene info topic
   std::string sceneTopic{ns + "/scene/info"};
 
@@ -547,6 +1203,17 @@ void SceneBroadcasterPrivate::SetupTransport(const std::string &_worldName)
 
   ignmsg << "Publishing dynamic pose messages on [" << opts.NameSpace() << "/"
          << dyPoseTopic << "]" << std::endl;
+
+  // Packed dynamic pose publisher
+  if (this->packedPosePeriod.count() > 0)
+  {
+    std::string packedPoseTopic{"dynamic_pose/packed"};
+
+    this->packedPosePub = this->node->Advertise<msgs::Bytes>(packedPoseTopic);
+
+    ignmsg << "Publishing packed dynamic poses on [" << opts.NameSpace()
+           << "/" << packedPoseTopic << "]" << std::endl;
+  }
 }
 
 //////////////////////////////////////////////////
@@ -554,15 +1221,20 @@ bool SceneBroadcasterPrivate::SceneInfoService(ignition::msgs::Scene &_res)
 {
   std::lock_guard<std::mutex> lock(this->graphMutex);
 
-  _res.Clear();
-
-  // Populate scene message
-
-  // Add models
-  AddModels(&_res, this->worldEntity, this->sceneGraph);
+  // The scene is only assembled again if entities were added or removed
+  // since the last request
+  if (this->sceneMsgDirty)
+  {
+    IGN_PROFILE("SceneBroadcasterPrivate::SceneInfoService Assemble");
+    this->sceneMsg.Clear();
+    for (const auto &[entity, modelMsg] : this->sceneModels)
+      this->sceneMsg.add_model()->CopyFrom(modelMsg);
+    for (const auto &[entity, lightMsg] : this->sceneLights)
+      this->sceneMsg.add_light()->CopyFrom(lightMsg);
+    this->sceneMsgDirty = false;
+  }
 
-  // Add lights
-  AddLights(&_res, this->worldEntity, this->sceneGraph);
+  _res.CopyFrom(this->sceneMsg);
 
   return true;
 }
@@ -647,7 +1319,7 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         auto modelMsg = std::make_shared<msgs::Model>();
         modelMsg->set_id(_entity);
         modelMsg->set_name(_nameComp->Data());
-        modelMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(modelMsg->mutable_pose(), _poseComp->Data());
 
         // Add to graph
         newGraph.AddVertex(_nameComp->Data(), modelMsg, _entity);
@@ -668,7 +1340,7 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         auto linkMsg = std::make_shared<msgs::Link>();
         linkMsg->set_id(_entity);
         linkMsg->set_name(_nameComp->Data());
-        linkMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(linkMsg->mutable_pose(), _poseComp->Data());
 
         // Add to graph
         newGraph.AddVertex(_nameComp->Data(), linkMsg, _entity);
@@ -693,23 +1365,21 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         visualMsg->set_id(_entity);
         visualMsg->set_parent_id(_parentComp->Data());
         visualMsg->set_name(_nameComp->Data());
-        visualMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(visualMsg->mutable_pose(), _poseComp->Data());
         visualMsg->set_cast_shadows(_castShadowsComp->Data());
 
         // Geometry is optional
         auto geometryComp = _manager.Component<components::Geometry>(_entity);
         if (geometryComp)
         {
-          visualMsg->mutable_geometry()->CopyFrom(
-              convert<msgs::Geometry>(geometryComp->Data()));
+          set(visualMsg->mutable_geometry(), geometryComp->Data());
         }
 
         // Material is optional
         auto materialComp = _manager.Component<components::Material>(_entity);
         if (materialComp)
         {
-          visualMsg->mutable_material()->CopyFrom(
-              convert<msgs::Material>(materialComp->Data()));
+          set(visualMsg->mutable_material(), materialComp->Data());
         }
 
         // Add to graph
@@ -729,11 +1399,11 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
           const components::Pose *_poseComp) -> bool
       {
         auto lightMsg = std::make_shared<msgs::Light>();
-        lightMsg->CopyFrom(convert<msgs::Light>(_lightComp->Data()));
+        set(lightMsg.get(), _lightComp->Data());
         lightMsg->set_id(_entity);
         lightMsg->set_parent_id(_parentComp->Data());
         lightMsg->set_name(_nameComp->Data());
-        lightMsg->mutable_pose()->CopyFrom(msgs::Convert(_poseComp->Data()));
+        msgs::Set(lightMsg->mutable_pose(), _poseComp->Data());
 
         // Add to graph
         newGraph.AddVertex(_nameComp->Data(), lightMsg, _entity);
@@ -761,6 +1431,16 @@ void SceneBroadcasterPrivate::SceneGraphAddEntities(
         this->sceneGraph.AddEdge(edge.get().Vertices(), edge.get().Data());
       }
     }
+
+    // Patch the cached scene with the top level entities that have new
+    // descendants
+    std::set<Entity> changed;
+    for (const auto &[id, vert] : newGraph.Vertices())
+    {
+      if (id != this->worldEntity)
+        changed.insert(this->TopLevelEntity(id));
+    }
+    this->UpdateSceneCache(changed);
   }
 
   if (newEntity)
@@ -788,6 +1468,9 @@ void SceneBroadcasterPrivate::SceneGraphRemoveEntities(
   // Handle Removed Entities
   std::vector<Entity> removedEntities;
 
+  // Top level entities whose cached messages must be patched
+  std::set<Entity> changed;
+
   // Scene a deleted model deletes all its child entities, we don't have to
   // handle links. We assume here that links are not deleted by themselves.
   // TODO(anyone) Handle case where other entities can be deleted without the
@@ -797,6 +1480,8 @@ void SceneBroadcasterPrivate::SceneGraphRemoveEntities(
       [&](const Entity &_entity, const components::Model *) -> bool
       {
         removedEntities.push_back(_entity);
+        changed.insert(this->TopLevelEntity(_entity));
+        changed.insert(_entity);
         // Remove from graph
         RemoveFromGraph(_entity, this->sceneGraph);
         return true;
@@ -807,11 +1492,15 @@ void SceneBroadcasterPrivate::SceneGraphRemoveEntities(
       [&](const Entity &_entity, const components::Light *) -> bool
       {
         removedEntities.push_back(_entity);
+        changed.insert(this->TopLevelEntity(_entity));
+        changed.insert(_entity);
         // Remove from graph
         RemoveFromGraph(_entity, this->sceneGraph);
         return true;
       });
 
+  this->UpdateSceneCache(changed);
+
   if (!removedEntities.empty())
   {
     // Send the list of deleted entities
@@ -911,6 +1600,58 @@ void SceneBroadcasterPrivate::AddLinks(msgs::Model *_msg, const Entity _entity,
   }
 }
 
+//////////////////////////////////////////////////
+Entity SceneBroadcasterPrivate::TopLevelEntity(Entity _entity) const
+{
+  if (!this->sceneGraph.VertexFromId(_entity).Valid())
+    return kNullEntity;
+
+  while (true)
+  {
+    // Entities which aren't connected to the world aren't part of the scene
+    auto parents = this->sceneGraph.AdjacentsTo(_entity);
+    if (parents.empty())
+      return kNullEntity;
+    if (parents.begin()->first == this->worldEntity)
+      return _entity;
+    _entity = parents.begin()->first;
+  }
+}
+
+//////////////////////////////////////////////////
+void SceneBroadcasterPrivate::UpdateSceneCache(
+    const std::set<Entity> &_entities)
+{
+  for (const auto entity : _entities)
+  {
+    if (kNullEntity == entity)
+      continue;
+
+    this->sceneMsgDirty = true;
+
+    const auto &vertex = this->sceneGraph.VertexFromId(entity);
+    if (!vertex.Valid())
+    {
+      this->sceneModels.erase(entity);
+      this->sceneLights.erase(entity);
+      continue;
+    }
+
+    if (auto modelMsg = std::dynamic_pointer_cast<msgs::Model>(vertex.Data()))
+    {
+      auto &cached = this->sceneModels[entity];
+      cached.CopyFrom(*modelMsg);
+      AddModels(&cached, entity, this->sceneGraph);
+      AddLinks(&cached, entity, this->sceneGraph);
+    }
+    else if (auto lightMsg =
+        std::dynamic_pointer_cast<msgs::Light>(vertex.Data()))
+    {
+      this->sceneLights[entity].CopyFrom(*lightMsg);
+    }
+  }
+}
+
 //////////////////////////////////////////////////
 void SceneBroadcasterPrivate::RemoveFromGraph(const Entity _entity,
                                               SceneGraphType &_graph)
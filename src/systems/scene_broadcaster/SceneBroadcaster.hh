@@ -37,6 +37,72 @@ namespace systems
   **/
   /// \brief System which periodically publishes an ignition::msgs::Scene
   /// message with updated information.
+  ///
+  /// ## System Parameters
+  ///
+  /// - `<dynamic_pose_hertz>`: Rate to publish dynamic poses, defaults to 60.
+  /// - `<packed_pose_hertz>`: If positive, dynamic poses are also published
+  /// at this rate on `/world/<world_name>/dynamic_pose/packed`, as an
+  /// ignition::msgs::Bytes message holding a gazebo::PackedPoses buffer.
+  /// They take a fraction of the bandwidth and CPU of the dynamic pose
+  /// messages. Defaults to 0, disabled.
+  /// - `<packed_pose_resolution>`: Position resolution of packed poses in
+  /// meters, defaults to 0.001.
+  /// - `<state_hertz>`: Rate to publish state, defaults to 60.
+  /// - `<state_deltas>`: True to publish state as keyframes, which hold the
+  /// full state, followed by deltas, which only hold components that
+  /// changed since the previous message. Defaults to false, in which case
+  /// every message holds all components with periodic changes. The header
+  /// of each state message then has a `frame` key, either `key` or
+  /// `delta`, and a `seq` key which increases by one on every message, so
+  /// clients can detect missed deltas and request the full state.
+  /// - `<state_async_publish>`: True to serialize and publish each state on
+  /// a background thread while the next iteration runs, so the step only
+  /// waits on it when publishing takes longer than an iteration. Defaults
+  /// to true.
+  /// - `<state_keyframe_period>`: Seconds between keyframes, defaults to 1.
+  /// - `<state_static_periodic>`: True to include static entities, see
+  /// EntityComponentManager::IsStatic, in messages which only hold
+  /// periodic changes. Static entities are still sent in full states.
+  /// Defaults to false, since they aren't expected to move.
+  /// - `<state_pose_resolution>`: If positive, poses in state deltas are
+  /// quantized to this resolution in meters, see
+  /// serializers::QuantizedPoseLayout. Defaults to 0, for full precision.
+  /// - `<state_shared_memory>`: True to also write every state message into
+  /// a shared memory ring buffer, named by gazebo::stateChannelName, so
+  /// clients on the same host can read states without sockets. GUIs use it
+  /// when the `IGN_GAZEBO_SHARED_MEMORY_STATE` environment variable is set
+  /// to 1. Only on POSIX systems, defaults to false.
+  /// - `<state_shared_memory_slots>`: Number of messages kept in the ring,
+  /// defaults to 16.
+  /// - `<state_shared_memory_slot_size>`: Largest message in bytes, larger
+  /// messages are only published. Memory is only used for the size of the
+  /// messages written. Defaults to 16 MiB.
+  ///
+  /// ## Areas of interest
+  ///
+  /// Clients which only need part of the world can call the
+  /// `/world/<world_name>/state_interest` service with an
+  /// ignition::msgs::Param request. The state of the top level entities
+  /// inside the area, with all their descendants, is then published on the
+  /// requested topic at the state rate, starting right after the request,
+  /// even while paused. Entities without a pose are always sent. When
+  /// several shapes are given, entities must be inside all of them. Without
+  /// any shape, the whole world is sent, which lets clients such as the GUI
+  /// only receive some component types. Parameters:
+  ///
+  /// - `topic` (string): Topic to publish on. Required.
+  /// - `remove` (bool): True to stop publishing on the topic.
+  /// - `radius` (double): Radius of a sphere around `center`.
+  /// - `center` (vector3d): Center of the sphere, defaults to the origin.
+  /// - `entity` (int): Entity whose world position is added to `center`,
+  /// so the sphere follows it.
+  /// - `box_min`, `box_max` (vector3d): Corners of a box.
+  /// - `frustum_pose` (pose3d): Pose of a camera frustum, which also uses
+  /// `frustum_near`, `frustum_far`, `frustum_fov` and `frustum_aspect`
+  /// (double), defaulting to 0.1, 100, pi/2 and 1.
+  /// - `components` (string): Comma separated names of the components to
+  /// send, such as `ign_gazebo_components.Pose`. Defaults to all.
   class SceneBroadcaster:
     public System,
     public ISystemConfigure,
@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include "RenderStreams.hh"
+
+#include <algorithm>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/math/Angle.hh>
+#include <ignition/msgs/Utility.hh>
+#include <ignition/rendering/Visual.hh>
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems::sensors_system;
+
+//////////////////////////////////////////////////
+bool RenderStreams::Load(const sdf::ElementPtr &_sdf,
+    const std::string &_worldName)
+{
+  this->maxStreams = static_cast<std::size_t>(std::max(1,
+      _sdf->Get<int>("max_streams", 4).first));
+  this->width = std::max(1u, _sdf->Get<unsigned int>("width", 1280).first);
+  this->height = std::max(1u, _sdf->Get<unsigned int>("height", 720).first);
+  this->fps = std::max(1u, _sdf->Get<unsigned int>("fps", 25).first);
+  this->bitRate = _sdf->Get<unsigned int>("bit_rate", 2070000).first;
+  this->hfov = _sdf->Get<double>("horizontal_fov", 1.047).first;
+  this->initialPose = _sdf->Get<math::Pose3d>("pose", this->initialPose).first;
+  this->hwEncoders = _sdf->Get<std::string>("hw_encoders", "").first;
+
+  auto service = transport::TopicUtils::AsValidTopic(
+      _sdf->Get<std::string>("service",
+      "/world/" + _worldName + "/render_stream").first);
+  if (service.empty())
+  {
+    ignerr << "Invalid render stream service for world [" << _worldName
+           << "], streams are disabled." << std::endl;
+    return false;
+  }
+
+  if (!this->node.Advertise(service, &RenderStreams::OnRequest, this) ||
+      !this->node.Subscribe(service + "/pose", &RenderStreams::OnPose, this))
+  {
+    ignerr << "Failed to advertise render stream service [" << service
+           << "]." << std::endl;
+    return false;
+  }
+
+  ignmsg << "Render stream service on [" << service << "]" << std::endl;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool RenderStreams::Active() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return !this->streams.empty();
+}
+
+//////////////////////////////////////////////////
+bool RenderStreams::Due() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto &stream : this->streams)
+  {
+    if (stream.second.stop || !stream.second.camera ||
+        stream.second.nextFrame <= now)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+void RenderStreams::Render(const rendering::ScenePtr &_scene)
+{
+  IGN_PROFILE("RenderStreams::Render");
+  std::lock_guard<std::mutex> lock(this->mutex);
+  const auto now = std::chrono::steady_clock::now();
+  const auto period = std::chrono::duration_cast<
+      std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / this->fps));
+
+  for (auto it = this->streams.begin(); it != this->streams.end();)
+  {
+    auto &stream = it->second;
+    if (stream.stop)
+    {
+      stream.encoder->Stop();
+      if (stream.camera)
+        _scene->DestroySensor(stream.camera);
+      ignmsg << "Stopped render stream to [" << it->first << "]"
+             << std::endl;
+      it = this->streams.erase(it);
+      continue;
+    }
+
+    if (!stream.camera)
+    {
+      stream.camera = _scene->CreateCamera(
+          "render_stream_" + std::to_string(this->cameraCount++));
+      if (!stream.camera)
+      {
+        ignerr << "Failed to create a camera for render stream to ["
+               << it->first << "]." << std::endl;
+        it = this->streams.erase(it);
+        continue;
+      }
+      stream.camera->SetImageWidth(this->width);
+      stream.camera->SetImageHeight(this->height);
+      stream.camera->SetImageFormat(rendering::PF_R8G8B8);
+      stream.camera->SetAspectRatio(
+          static_cast<double>(this->width) / this->height);
+      stream.camera->SetHFOV(math::Angle(this->hfov));
+      _scene->RootVisual()->AddChild(stream.camera);
+      stream.image = stream.camera->CreateImage();
+
+      stream.encoder = std::make_unique<AsyncVideoEncoder>();
+      stream.encoder->SetHardwareEncoders(this->hwEncoders);
+      if (!stream.encoder->Start(stream.format, it->first, this->width,
+          this->height, this->fps, this->bitRate))
+      {
+        ignerr << "Failed to start render stream to [" << it->first << "]."
+               << std::endl;
+        _scene->DestroySensor(stream.camera);
+        it = this->streams.erase(it);
+        continue;
+      }
+      ignmsg << "Started render stream to [" << it->first << "]"
+             << std::endl;
+    }
+
+    if (stream.nextFrame <= now)
+    {
+      stream.camera->SetWorldPose(stream.pose);
+      stream.camera->Update();
+      stream.camera->Copy(stream.image);
+      stream.encoder->AddFrame(stream.image.Data<unsigned char>(),
+          this->width, this->height, now);
+
+      // Frames which are late don't accumulate, the stream skips them
+      stream.nextFrame = std::max(stream.nextFrame + period, now);
+    }
+    ++it;
+  }
+}
+
+//////////////////////////////////////////////////
+void RenderStreams::Clear()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  for (auto &stream : this->streams)
+  {
+    if (stream.second.encoder)
+      stream.second.encoder->Stop();
+  }
+  this->streams.clear();
+}
+
+//////////////////////////////////////////////////
+bool RenderStreams::OnRequest(const msgs::VideoRecord &_req,
+    msgs::Boolean &_res)
+{
+  const auto &url = _req.save_filename();
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (!_req.start() || _req.stop())
+  {
+    auto it = this->streams.find(url);
+    _res.set_data(it != this->streams.end());
+    if (it != this->streams.end())
+      it->second.stop = true;
+    return true;
+  }
+
+  if (url.empty())
+  {
+    ignerr << "Render stream requests need a URL in save_filename."
+           << std::endl;
+    _res.set_data(false);
+    return true;
+  }
+
+  auto it = this->streams.find(url);
+  if (it != this->streams.end() && !it->second.stop)
+  {
+    _res.set_data(true);
+    return true;
+  }
+
+  if (it == this->streams.end() && this->streams.size() >= this->maxStreams)
+  {
+    ignerr << "Refusing render stream to [" << url << "], there are already ["
+           << this->maxStreams << "] streams." << std::endl;
+    _res.set_data(false);
+    return true;
+  }
+
+  // The render thread didn't remove the stream being stopped yet
+  if (it != this->streams.end())
+  {
+    ignwarn << "Render stream to [" << url << "] is still stopping, request "
+            << "it again later." << std::endl;
+    _res.set_data(false);
+    return true;
+  }
+
+  auto &stream = this->streams[url];
+  stream.format = _req.format().empty() ? "mpeg" : _req.format();
+  stream.pose = this->initialPose;
+  _res.set_data(true);
+  return true;
+}
+
+//////////////////////////////////////////////////
+void RenderStreams::OnPose(const msgs::Pose &_msg)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto it = this->streams.find(_msg.name());
+  if (it != this->streams.end())
+    it->second.pose = msgs::Convert(_msg);
+}
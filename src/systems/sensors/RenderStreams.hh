@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_SENSORS_RENDERSTREAMS_HH_
+#define IGNITION_GAZEBO_SYSTEMS_SENSORS_RENDERSTREAMS_HH_
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <ignition/math/Pose3.hh>
+#include <ignition/msgs/boolean.pb.h>
+#include <ignition/msgs/pose.pb.h>
+#include <ignition/msgs/video_record.pb.h>
+#include <ignition/rendering/Camera.hh>
+#include <ignition/rendering/Image.hh>
+#include <ignition/rendering/Scene.hh>
+#include <ignition/transport/Node.hh>
+#include <sdf/Element.hh>
+
+#include "ignition/gazebo/config.hh"
+#include "ignition/gazebo/rendering/AsyncVideoEncoder.hh"
+
+namespace ignition::gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems::sensors_system
+{
+  /// \brief Renders viewpoints requested by remote clients into the scene
+  /// of the sensors, and streams them as encoded video, so thin clients
+  /// never receive the simulation state.
+  ///
+  /// Clients start and stop streams with a msgs::VideoRecord request, where
+  /// `save_filename` is the URL the video is streamed to, such as
+  /// `udp://host:port`, and `format` the container, `mpeg` by default.
+  /// Streams are identified by their URL, and clients move their viewpoint
+  /// by publishing a msgs::Pose whose name is the URL.
+  ///
+  /// Transport callbacks only record requests. Cameras are created, moved,
+  /// rendered and removed by the render thread, in Render.
+  class RenderStreams
+  {
+    /// \brief Load the parameters and advertise the service.
+    /// \param[in] _sdf The `<render_streams>` element.
+    /// \param[in] _worldName Name of the world, used in the default
+    /// service name.
+    /// \return True if the service was advertised.
+    public: bool Load(const sdf::ElementPtr &_sdf,
+                const std::string &_worldName);
+
+    /// \brief Whether any stream was requested, so the scene is needed even
+    /// without rendering sensors.
+    /// \return True if there are streams.
+    public: bool Active() const;
+
+    /// \brief Whether a stream needs to be started, stopped or sent a
+    /// frame.
+    /// \return True if Render has work to do.
+    public: bool Due() const;
+
+    /// \brief Render and encode the streams which are due, after the scene
+    /// was prepared for rendering. Only called by the render thread.
+    /// \param[in] _scene Scene of the sensors.
+    public: void Render(const rendering::ScenePtr &_scene);
+
+    /// \brief Stop all streams and remove their cameras. Only called by the
+    /// render thread.
+    public: void Clear();
+
+    /// \brief Callback for stream requests.
+    /// \param[in] _req Request, see the class description.
+    /// \param[out] _res True if the request was accepted.
+    /// \return True, the service always responds.
+    private: bool OnRequest(const msgs::VideoRecord &_req,
+                 msgs::Boolean &_res);
+
+    /// \brief Callback for viewpoint poses.
+    /// \param[in] _msg New viewpoint of the stream named by the message.
+    private: void OnPose(const msgs::Pose &_msg);
+
+    /// \brief A stream to a client.
+    private: struct Stream
+    {
+      /// \brief Container format.
+      std::string format;
+
+      /// \brief Viewpoint requested by the client.
+      math::Pose3d pose;
+
+      /// \brief True once the client asked to stop the stream.
+      bool stop{false};
+
+      /// \brief Time at which the next frame is due.
+      std::chrono::steady_clock::time_point nextFrame;
+
+      /// \brief Camera, created by the render thread.
+      rendering::CameraPtr camera;
+
+      /// \brief Image the camera is copied into.
+      rendering::Image image;
+
+      /// \brief Encoder streaming the frames.
+      std::unique_ptr<AsyncVideoEncoder> encoder;
+    };
+
+    /// \brief Streams by URL.
+    private: std::unordered_map<std::string, Stream> streams;
+
+    /// \brief Protects streams.
+    private: mutable std::mutex mutex;
+
+    /// \brief Transport node.
+    private: transport::Node node;
+
+    /// \brief Maximum number of streams.
+    private: std::size_t maxStreams{4};
+
+    /// \brief Frame width in pixels.
+    private: unsigned int width{1280};
+
+    /// \brief Frame height in pixels.
+    private: unsigned int height{720};
+
+    /// \brief Frames per second.
+    private: unsigned int fps{25};
+
+    /// \brief Bit rate of each stream.
+    private: unsigned int bitRate{2070000};
+
+    /// \brief Horizontal field of view in radians.
+    private: double hfov{1.047};
+
+    /// \brief Viewpoint of new streams.
+    private: math::Pose3d initialPose{-6, 0, 6, 0, 0.5, 0};
+
+    /// \brief Hardware encoders, see AsyncVideoEncoder::SetHardwareEncoders.
+    private: std::string hwEncoders;
+
+    /// \brief Number of cameras created, used to name them.
+    private: unsigned int cameraCount{0};
+  };
+}
+}
+}
+
+#endif
@@ -17,7 +17,9 @@
 
 #include "Sensors.hh"
 
+#include <algorithm>
 #include <map>
+#include <memory>
 #include <set>
 #include <unordered_map>
 #include <utility>
@@ -30,8 +32,12 @@
 
 #include <ignition/math/Helpers.hh>
 
+#include <ignition/msgs/image.pb.h>
+
 #include <ignition/rendering/Scene.hh>
 #include <ignition/sensors/CameraSensor.hh>
+#include <ignition/sensors/DepthCameraSensor.hh>
+#include <ignition/sensors/GpuLidarSensor.hh>
 #include <ignition/sensors/RenderingSensor.hh>
 #include <ignition/sensors/ThermalCameraSensor.hh>
 #include <ignition/sensors/Manager.hh>
@@ -40,16 +46,22 @@
 #include "ignition/gazebo/components/Camera.hh"
 #include "ignition/gazebo/components/DepthCamera.hh"
 #include "ignition/gazebo/components/GpuLidar.hh"
+#include "ignition/gazebo/components/RenderCpus.hh"
 #include "ignition/gazebo/components/RenderEngineServerPlugin.hh"
 #include "ignition/gazebo/components/RgbdCamera.hh"
+#include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/components/ThermalCamera.hh"
 #include "ignition/gazebo/components/World.hh"
 #include "ignition/gazebo/Events.hh"
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SharedMemoryChannel.hh"
+#include "ignition/gazebo/Util.hh"
 
 #include "ignition/gazebo/rendering/Events.hh"
 #include "ignition/gazebo/rendering/RenderUtil.hh"
 
+#include "RenderStreams.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
@@ -103,9 +115,20 @@ class ignition::gazebo::systems::SensorsPrivate
   /// \brief Flag to signal if rendering update is needed
   public: bool updateAvailable { false };
 
+  /// \brief True to never make the simulation wait for the rendering of
+  /// previous iterations, see the pipelined parameter.
+  public: bool pipelined { false };
+
+  /// \brief Flag to signal that the render thread has applied the scene
+  /// state of the pending rendering update, used in pipelined mode.
+  public: bool sceneUpdated { false };
+
   /// \brief Thread that rendering will occur in
   public: std::thread renderThread;
 
+  /// \brief CPUs the rendering thread is pinned to, empty to not pin it.
+  public: std::vector<unsigned int> renderCpus;
+
   /// \brief Mutex to protect rendering data
   public: std::mutex renderMutex;
 
@@ -125,6 +148,10 @@ class ignition::gazebo::systems::SensorsPrivate
   /// \brief Sensors to include in the next rendering iteration
   public: std::vector<sensors::RenderingSensor *> activeSensors;
 
+  /// \brief Sensors which are due within this window of a rendering
+  /// iteration are rendered with it, see the batch_window parameter.
+  public: std::chrono::steady_clock::duration batchWindow{0};
+
   /// \brief Mutex to protect sensorMask
   public: std::mutex sensorMaskMutex;
 
@@ -135,6 +162,50 @@ class ignition::gazebo::systems::SensorsPrivate
   /// \brief Pointer to the event manager
   public: EventManager *eventManager{nullptr};
 
+  /// \brief True to also write camera images into shared memory.
+  public: bool imageSharedMemory{false};
+
+  /// \brief Number of images kept in each image channel.
+  public: int imageSharedMemorySlots{4};
+
+  /// \brief Shared memory channel of a camera's images.
+  public: struct ImageChannel
+  {
+    /// \brief Channel name, see topicChannelName.
+    std::string name;
+
+    /// \brief Writer, created with the first image, once its size is
+    /// known.
+    std::unique_ptr<SharedMemoryWriter> writer;
+
+    /// \brief Connection to the sensor's images.
+    common::ConnectionPtr connection;
+  };
+
+  /// \brief Image channels of the camera sensors. Only used by the render
+  /// thread, which creates, updates and removes sensors.
+  public: std::unordered_map<sensors::SensorId, ImageChannel> imageChannels;
+
+  /// \brief Write an image into a camera's shared memory channel.
+  /// \param[in] _channel Channel of the camera.
+  /// \param[in] _msg Image.
+  public: void WriteImage(ImageChannel &_channel, const msgs::Image &_msg);
+
+  /// \brief Viewpoints streamed to remote clients, see the render_streams
+  /// parameter.
+  public: sensors_system::RenderStreams renderStreams;
+
+  /// \brief True if render streams were enabled.
+  public: bool renderStreamsEnabled{false};
+
+  /// \brief Check if a rendering sensor's data is consumed, either by a
+  /// subscriber to one of its topics or by an internal consumer, such as an
+  /// image shared memory channel. Sensors without consumers aren't rendered.
+  /// \param[in] _sensor The sensor.
+  /// \return True if the sensor's data is consumed, or if that can't be
+  /// known for the sensor's type.
+  public: bool HasConnections(sensors::RenderingSensor *_sensor) const;
+
   /// \brief Wait for initialization to happen
   private: void WaitForInit();
 
@@ -167,6 +238,11 @@ class ignition::gazebo::systems::SensorsPrivate
   //
   /// The caller of PostUpdate will be blocked if there is a rendering
   /// operation currently ongoing, until that completes.
+  ///
+  /// In pipelined mode, the caller of PostUpdate is instead never blocked
+  /// by an ongoing rendering operation, and after triggering a new one, it's
+  /// only blocked until the scene has been updated, which is signaled by
+  /// sceneUpdated.
   private: void RenderThread();
 
   /// \brief Launch the rendering thread
@@ -226,8 +302,16 @@ void SensorsPrivate::RunOnce()
     this->renderUtil.Update();
   }
 
+  // The scene now holds the state at updateTime, so the simulation can move
+  // on while it's rendered. PostUpdate doesn't touch the update until
+  // updateAvailable is cleared.
+  this->sceneUpdated = true;
+  lock.unlock();
+  this->renderCv.notify_all();
 
-  if (!this->activeSensors.empty())
+  const bool streamsDue = this->renderStreamsEnabled &&
+      this->renderStreams.Due();
+  if (!this->activeSensors.empty() || streamsDue)
   {
     this->sensorMaskMutex.lock();
     // Check the active sensors against masked sensors.
@@ -248,6 +332,11 @@ void SensorsPrivate::RunOnce()
     }
     this->sensorMaskMutex.unlock();
 
+    {
+      IGN_PROFILE("UpdateCulling");
+      this->renderUtil.SceneManager().UpdateCulling();
+    }
+
     {
       IGN_PROFILE("PreRender");
       this->eventManager->Emit<events::PreRender>();
@@ -261,16 +350,36 @@ void SensorsPrivate::RunOnce()
     {
       // publish data
       IGN_PROFILE("RunOnce");
-      this->sensorManager.RunOnce(this->updateTime);
+      if (!this->activeSensors.empty() &&
+          this->batchWindow > std::chrono::steady_clock::duration::zero())
+      {
+        // Sensors which are due a little later are updated with their own
+        // time, so that their schedule and stamps don't change, but see the
+        // scene as it is now
+        for (auto sensor : this->activeSensors)
+        {
+          sensor->Update(
+              std::max(this->updateTime, sensor->NextDataUpdateTime()),
+              false);
+        }
+      }
+      else if (!this->activeSensors.empty())
+      {
+        this->sensorManager.RunOnce(this->updateTime);
+      }
+      if (streamsDue)
+        this->renderStreams.Render(this->scene);
       this->eventManager->Emit<events::PostRender>();
     }
 
     this->activeSensors.clear();
   }
 
+  lock.lock();
   this->updateAvailable = false;
+  this->sceneUpdated = false;
   lock.unlock();
-  this->renderCv.notify_one();
+  this->renderCv.notify_all();
 }
 
 //////////////////////////////////////////////////
@@ -278,6 +387,8 @@ void SensorsPrivate::RenderThread()
 {
   IGN_PROFILE_THREAD_NAME("RenderThread");
 
+  setThreadAffinity(this->renderCpus);
+
   igndbg << "SensorsPrivate::RenderThread started" << std::endl;
 
   // We have to wait for rendering sensors to be available
@@ -289,6 +400,7 @@ void SensorsPrivate::RenderThread()
   }
 
   // clean up before exiting
+  this->renderStreams.Clear();
   for (const auto id : this->sensorIds)
     this->sensorManager.Remove(id);
 
@@ -345,6 +457,7 @@ void Sensors::RemoveSensor(const Entity &_entity)
         this->dataPtr->activeSensors.erase(activeSensorIt);
       }
     }
+    this->dataPtr->imageChannels.erase(idIter->second);
     this->dataPtr->sensorIds.erase(idIter->second);
     this->dataPtr->sensorManager.Remove(idIter->second);
     this->dataPtr->entityToIdMap.erase(idIter);
@@ -374,6 +487,30 @@ void Sensors::Configure(const Entity &/*_id*/,
       _sdf->Get<std::string>("render_engine", "ogre2").first;
 
   this->dataPtr->renderUtil.SetEngineName(engineName);
+
+  // Sensors don't modify materials, so visuals which look the same can be
+  // batched by the rendering engine
+  this->dataPtr->renderUtil.SceneManager().SetShareMaterials(
+      _sdf->Get<bool>("share_materials", true).first);
+  this->dataPtr->renderUtil.SceneManager().SetCullingSize(
+      _sdf->Get<double>("culling_size", 0.0).first);
+  this->dataPtr->renderUtil.SetActorSkinningEnabled(
+      _sdf->Get<bool>("actor_skinning", true).first);
+
+  this->dataPtr->pipelined = _sdf->Get<bool>("pipelined", false).first;
+
+  this->dataPtr->imageSharedMemory =
+      _sdf->Get<bool>("image_shared_memory", false).first;
+  this->dataPtr->imageSharedMemorySlots = std::max(1,
+      _sdf->Get<int>("image_shared_memory_slots", 4).first);
+
+  auto batchWindow = _sdf->Get<double>("batch_window", 0.0).first;
+  if (batchWindow > 0.0)
+  {
+    this->dataPtr->batchWindow =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(batchWindow));
+  }
   this->dataPtr->renderUtil.SetEnableSensors(true,
       std::bind(&Sensors::CreateSensor, this,
       std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
@@ -401,6 +538,25 @@ void Sensors::Configure(const Entity &/*_id*/,
     {
       this->dataPtr->renderUtil.SetEngineName(renderEngineServerComp->Data());
     }
+
+    // Viewpoints of remote clients are rendered with the sensors
+    if (_sdf->HasElement("render_streams"))
+    {
+      auto nameComp = _ecm.Component<components::Name>(worldEntity);
+      this->dataPtr->renderStreamsEnabled =
+          this->dataPtr->renderStreams.Load(
+          _sdf->Clone()->GetElement("render_streams"),
+          nameComp ? nameComp->Data() : "default");
+    }
+
+    // Pin the render thread if requested from the server config
+    auto renderCpusComp = _ecm.Component<components::RenderCpus>(worldEntity);
+    if (renderCpusComp)
+    {
+      this->dataPtr->renderCpus =
+          parseCpuList(renderCpusComp->Data()).value_or(
+          std::vector<unsigned int>());
+    }
   }
 
   this->dataPtr->eventManager = &_eventMgr;
@@ -442,7 +598,9 @@ void Sensors::PostUpdate(const UpdateInfo &_info,
        _ecm.HasComponentType(components::DepthCamera::typeId) ||
        _ecm.HasComponentType(components::GpuLidar::typeId) ||
        _ecm.HasComponentType(components::RgbdCamera::typeId) ||
-       _ecm.HasComponentType(components::ThermalCamera::typeId)))
+       _ecm.HasComponentType(components::ThermalCamera::typeId) ||
+       (this->dataPtr->renderStreamsEnabled &&
+       this->dataPtr->renderStreams.Active())))
   {
     igndbg << "Initialization needed" << std::endl;
     std::unique_lock<std::mutex> lock(this->dataPtr->renderMutex);
@@ -458,6 +616,7 @@ void Sensors::PostUpdate(const UpdateInfo &_info,
     auto t = math::secNsecToDuration(time.first, time.second);
 
     std::vector<sensors::RenderingSensor *> activeSensors;
+    std::vector<sensors::RenderingSensor *> upcomingSensors;
 
     this->dataPtr->sensorMaskMutex.lock();
     for (auto id : this->dataPtr->sensorIds)
@@ -478,17 +637,44 @@ void Sensors::PostUpdate(const UpdateInfo &_info,
         }
       }
 
-      if (rs && rs->NextDataUpdateTime() <= t)
+      // Sensors nobody listens to are skipped. They are due as soon as
+      // they get a subscriber, since their update time didn't advance.
+      if (!rs || !this->dataPtr->HasConnections(rs))
+        continue;
+
+      if (rs->NextDataUpdateTime() <= t)
       {
         activeSensors.push_back(rs);
       }
+      else if (rs->NextDataUpdateTime() <= t + this->dataPtr->batchWindow)
+      {
+        upcomingSensors.push_back(rs);
+      }
     }
     this->dataPtr->sensorMaskMutex.unlock();
 
+    // Render sensors which are due soon together with the ones which are due
+    // now, so the scene is updated and prepared for rendering once for all
+    // of them
+    if (!activeSensors.empty())
+    {
+      activeSensors.insert(activeSensors.end(), upcomingSensors.begin(),
+          upcomingSensors.end());
+    }
+
     if (!activeSensors.empty() ||
-        this->dataPtr->renderUtil.PendingSensors() > 0)
+        this->dataPtr->renderUtil.PendingSensors() > 0 ||
+        (this->dataPtr->renderStreamsEnabled &&
+        this->dataPtr->renderStreams.Due()))
     {
       std::unique_lock<std::mutex> lock(this->dataPtr->renderMutex);
+
+      // In pipelined mode, sensors which are due while the previous
+      // iteration is still being rendered are kept for a following
+      // iteration instead of waiting for it
+      if (this->dataPtr->pipelined && this->dataPtr->updateAvailable)
+        return;
+
       this->dataPtr->renderCv.wait(lock, [this] {
         return !this->dataPtr->running || !this->dataPtr->updateAvailable; });
 
@@ -500,7 +686,17 @@ void Sensors::PostUpdate(const UpdateInfo &_info,
       this->dataPtr->activeSensors = std::move(activeSensors);
       this->dataPtr->updateTime = t;
       this->dataPtr->updateAvailable = true;
-      this->dataPtr->renderCv.notify_one();
+      this->dataPtr->renderCv.notify_all();
+
+      // Wait for the scene to be updated with this iteration's state, so
+      // sensor data matches its stamp, but not for it to be rendered
+      if (this->dataPtr->pipelined)
+      {
+        IGN_PROFILE("Wait scene update");
+        this->dataPtr->renderCv.wait(lock, [this] {
+          return !this->dataPtr->running || this->dataPtr->sceneUpdated ||
+              !this->dataPtr->updateAvailable; });
+      }
     }
   }
 }
@@ -604,9 +800,85 @@ std::string Sensors::CreateSensor(const Entity &_entity,
            << " Kelvin." << std::endl;
   }
 
+  // Images written in place into shared memory, for local consumers which
+  // don't want to go through transport
+  if (this->dataPtr->imageSharedMemory)
+  {
+    auto &channel = this->dataPtr->imageChannels[sensorId];
+    channel.name = topicChannelName(sensor->Topic());
+    auto callback = [this, sensorId](const msgs::Image &_msg)
+    {
+      auto it = this->dataPtr->imageChannels.find(sensorId);
+      if (it != this->dataPtr->imageChannels.end())
+        this->dataPtr->WriteImage(it->second, _msg);
+    };
+
+    // Depth and thermal cameras have their own image events
+    if (auto depth = dynamic_cast<sensors::DepthCameraSensor *>(sensor))
+      channel.connection = depth->ConnectImageCallback(callback);
+    else if (thermalSensor)
+      channel.connection = thermalSensor->ConnectImageCallback(callback);
+    else if (cameraSensor)
+      channel.connection = cameraSensor->ConnectImageCallback(callback);
+    else
+      this->dataPtr->imageChannels.erase(sensorId);
+  }
+
   return sensor->Name();
 }
 
+//////////////////////////////////////////////////
+void SensorsPrivate::WriteImage(ImageChannel &_channel,
+    const msgs::Image &_msg)
+{
+  IGN_PROFILE("SensorsPrivate::WriteImage");
+  auto size = _msg.ByteSizeLong();
+  if (nullptr == _channel.writer || _channel.writer->SlotSize() < size)
+  {
+    // Images only change size if the sensor is reconfigured, so leave some
+    // room for the header to grow
+    _channel.writer = std::make_unique<SharedMemoryWriter>(_channel.name,
+        this->imageSharedMemorySlots, size + 1024);
+    if (!_channel.writer->Valid())
+      return;
+    ignmsg << "Writing images into shared memory channel ["
+           << _channel.name << "]" << std::endl;
+  }
+
+  // Serialize straight into the ring
+  auto slot = _channel.writer->Reserve(size);
+  if (nullptr != slot &&
+      _msg.SerializeToArray(slot, static_cast<int>(size)))
+  {
+    _channel.writer->Commit();
+  }
+}
+
+//////////////////////////////////////////////////
+bool SensorsPrivate::HasConnections(sensors::RenderingSensor *_sensor) const
+{
+  // Cameras write their images into shared memory, whose readers can't be
+  // known
+  if (this->imageSharedMemory &&
+      dynamic_cast<sensors::CameraSensor *>(_sensor))
+  {
+    return true;
+  }
+
+  // Depth and thermal cameras are also camera sensors, so check them first
+  if (auto depth = dynamic_cast<sensors::DepthCameraSensor *>(_sensor))
+    return depth->HasConnections();
+  if (auto lidar = dynamic_cast<sensors::GpuLidarSensor *>(_sensor))
+    return lidar->HasConnections();
+  if (auto thermal = dynamic_cast<sensors::ThermalCameraSensor *>(_sensor))
+    return thermal->HasConnections();
+  if (auto camera = dynamic_cast<sensors::CameraSensor *>(_sensor))
+    return camera->HasConnections();
+
+  // Keep rendering sensors whose consumers can't be checked
+  return true;
+}
+
 IGNITION_ADD_PLUGIN(Sensors, System,
   Sensors::ISystemConfigure,
   Sensors::ISystemUpdate,
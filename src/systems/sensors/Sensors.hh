@@ -38,6 +38,69 @@ namespace systems
   /// \class Sensors Sensors.hh ignition/gazebo/systems/Sensors.hh
   /// \brief TODO(louise) Have one system for all sensors, or one per
   /// sensor / sensor type?
+  ///
+  /// Rendering sensors are only rendered while their data is consumed,
+  /// that is, while one of their topics has subscribers or their images
+  /// are connected to, like by the image shared memory channels. They
+  /// resume as soon as they get a subscriber.
+  ///
+  /// ## System Parameters
+  ///
+  /// - `<render_engine>`: Rendering engine, defaults to ogre2.
+  /// - `<share_materials>`: True to let visuals with the same material
+  /// share it, so the rendering engine can batch repeated objects, see
+  /// SceneManager::SetShareMaterials. Defaults to true.
+  /// - `<culling_size>`: Visuals smaller than this, as the ratio of their
+  /// radius to their distance from the closest sensor, aren't rendered,
+  /// see SceneManager::SetCullingSize. Defaults to 0, which disables
+  /// culling.
+  /// - `<actor_skinning>`: False so actors only follow their trajectories,
+  /// without their skeletons being animated, for sensors which don't need
+  /// to see limbs move. Skeletons of culled actors are never animated.
+  /// Defaults to true.
+  /// - `<batch_window>`: Sensors which are due within this many seconds of
+  /// a rendering iteration are rendered with it, so sensors with different
+  /// rates or phases share scene updates. Their data is stamped with their
+  /// usual update time, but shows the scene up to this much earlier.
+  /// Defaults to 0, where each sensor is only rendered when it's due.
+  /// - `<pipelined>`: True so that the simulation never waits for sensors
+  /// to be rendered. It only waits for the scene to be updated with the
+  /// state of the iteration being rendered, so sensor data still matches
+  /// its stamp, and sensors which are due while the previous iteration is
+  /// being rendered are rendered on the first iteration after it's done.
+  /// The throughput is then bound by the slowest of physics and rendering,
+  /// at the cost of sensor updates being late when rendering is slower.
+  /// Defaults to false, where the simulation waits for the previous
+  /// rendering to finish when new sensor data is due.
+  /// - `<image_shared_memory>`: True to also write the images of camera,
+  /// depth camera and thermal camera sensors into shared memory rings, see
+  /// SharedMemoryWriter. Each ring is named by gazebo::topicChannelName
+  /// from the sensor's topic and holds serialized ignition::msgs::Image
+  /// messages. Local consumers can read them with a SharedMemoryReader
+  /// without copies through transport sockets. Cameras then render even
+  /// without transport subscribers. Only on POSIX systems, defaults to
+  /// false.
+  /// - `<image_shared_memory_slots>`: Number of images kept in each ring,
+  /// defaults to 4.
+  /// - `<render_streams>`: Optional. Renders viewpoints for remote clients
+  /// with the sensors' scene and streams them as encoded video, so thin
+  /// clients don't need the simulation state nor a GUI. Clients start and
+  /// stop streams through a service taking an ignition::msgs::VideoRecord,
+  /// with the stream's URL, such as `udp://host:port`, as `save_filename`,
+  /// and move their viewpoint by publishing an ignition::msgs::Pose named
+  /// by the URL on the service name followed by `/pose`. Frames are
+  /// rendered at wall clock rate, also while paused. Culling only considers
+  /// sensors. It contains:
+  ///   * `<service>`: Service name, defaults to
+  ///     `/world/<world_name>/render_stream`.
+  ///   * `<max_streams>`: Number of concurrent streams, defaults to 4.
+  ///   * `<width>`, `<height>`: Frame size, defaults to 1280x720.
+  ///   * `<fps>`: Frames per second, defaults to 25.
+  ///   * `<bit_rate>`: Bit rate of each stream, defaults to 2070000.
+  ///   * `<horizontal_fov>`: Field of view in radians, defaults to 1.047.
+  ///   * `<pose>`: Initial viewpoint, defaults to `-6 0 6 0 0.5 0`.
+  ///   * `<hw_encoders>`: Hardware encoders which may be used, see
+  ///     AsyncVideoEncoder::SetHardwareEncoders. Defaults to none.
   class Sensors:
     public System,
     public ISystemConfigure,
@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_TERRAIN_TILES_TERRAINGRID_HH_
+#define IGNITION_GAZEBO_SYSTEMS_TERRAIN_TILES_TERRAINGRID_HH_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ignition/math/Vector2.hh>
+
+#include "ignition/gazebo/config.hh"
+
+namespace ignition::gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems::terrain_tiles
+{
+  /// \brief Format of the samples of a height file.
+  enum class SampleFormat
+  {
+    /// \brief Little endian 32 bit floats.
+    FLOAT32,
+
+    /// \brief Little endian unsigned 16 bit integers.
+    UINT16
+  };
+
+  /// \brief A grid of heights stored row by row in a raw file, which is
+  /// read a tile at a time so only the tiles in use are in memory. Row 0
+  /// is the edge of the grid with the largest Y.
+  class HeightFile
+  {
+    /// \brief Open a file.
+    /// \param[in] _path Path to the file.
+    /// \param[in] _columns Number of samples per row.
+    /// \param[in] _rows Number of rows.
+    /// \param[in] _format Format of the samples.
+    /// \return False if the file can't be opened or is too small.
+    public: bool Open(const std::string &_path, unsigned int _columns,
+                      unsigned int _rows, SampleFormat _format)
+    {
+      this->file.close();
+      this->file.clear();
+      this->columns = _columns;
+      this->rows = _rows;
+      this->format = _format;
+      if (_columns == 0 || _rows == 0)
+        return false;
+
+      this->file.open(_path, std::ios::binary | std::ios::ate);
+      if (!this->file)
+        return false;
+
+      const auto size = static_cast<uint64_t>(this->file.tellg());
+      return size >= static_cast<uint64_t>(_columns) * _rows *
+          this->SampleSize();
+    }
+
+    /// \brief Get the number of samples per row.
+    /// \return Number of columns.
+    public: unsigned int Columns() const
+    {
+      return this->columns;
+    }
+
+    /// \brief Get the number of rows.
+    /// \return Number of rows.
+    public: unsigned int Rows() const
+    {
+      return this->rows;
+    }
+
+    /// \brief Read a square block of raw samples. Samples outside the grid
+    /// take the value of the nearest sample on its edge.
+    /// \param[in] _column First column.
+    /// \param[in] _row First row.
+    /// \param[in] _samples Number of samples along each side of the block.
+    /// \param[in] _step Distance in samples between the samples read.
+    /// \param[out] _heights Samples read, row by row.
+    /// \return False if reading failed.
+    public: bool Read(unsigned int _column, unsigned int _row,
+                      unsigned int _samples, unsigned int _step,
+                      std::vector<double> &_heights)
+    {
+      _heights.resize(static_cast<std::size_t>(_samples) * _samples);
+      if (!this->file.is_open() || _samples == 0 || _step == 0)
+        return false;
+
+      // Read the span of columns of each row at once
+      const unsigned int last = std::min(this->columns - 1,
+          _column + (_samples - 1) * _step);
+      const unsigned int first = std::min(_column, last);
+      const std::size_t sampleSize = this->SampleSize();
+      std::vector<char> span((last - first + 1) * sampleSize);
+      for (unsigned int i = 0; i < _samples; ++i)
+      {
+        const unsigned int row = std::min(this->rows - 1, _row + i * _step);
+        this->file.seekg(static_cast<std::streamoff>(
+            (static_cast<uint64_t>(row) * this->columns + first) *
+            sampleSize));
+        this->file.read(span.data(), static_cast<std::streamsize>(
+            span.size()));
+        if (!this->file)
+        {
+          this->file.clear();
+          return false;
+        }
+
+        for (unsigned int j = 0; j < _samples; ++j)
+        {
+          const unsigned int column =
+              std::min(last, _column + j * _step) - first;
+          _heights[static_cast<std::size_t>(i) * _samples + j] =
+              this->Decode(span.data() + column * sampleSize);
+        }
+      }
+      return true;
+    }
+
+    /// \brief Get the size of a sample in bytes.
+    /// \return Sample size.
+    private: std::size_t SampleSize() const
+    {
+      return this->format == SampleFormat::FLOAT32 ? 4 : 2;
+    }
+
+    /// \brief Decode a little endian sample.
+    /// \param[in] _data Bytes of the sample.
+    /// \return Sample value.
+    private: double Decode(const char *_data) const
+    {
+      const auto *bytes = reinterpret_cast<const unsigned char *>(_data);
+      if (this->format == SampleFormat::UINT16)
+        return static_cast<double>(bytes[0] | (bytes[1] << 8));
+
+      const uint32_t bits = static_cast<uint32_t>(bytes[0]) |
+          (static_cast<uint32_t>(bytes[1]) << 8) |
+          (static_cast<uint32_t>(bytes[2]) << 16) |
+          (static_cast<uint32_t>(bytes[3]) << 24);
+      float value;
+      std::memcpy(&value, &bits, sizeof(value));
+      return static_cast<double>(value);
+    }
+
+    /// \brief File stream.
+    private: std::ifstream file;
+
+    /// \brief Number of samples per row.
+    private: unsigned int columns{0};
+
+    /// \brief Number of rows.
+    private: unsigned int rows{0};
+
+    /// \brief Format of the samples.
+    private: SampleFormat format{SampleFormat::FLOAT32};
+  };
+
+  /// \brief Splits a height grid into square tiles which share their edge
+  /// samples, and picks the tiles and resolutions in use around a set of
+  /// positions.
+  class TileLayout
+  {
+    /// \brief Constructor
+    /// \param[in] _columns Number of samples per row of the grid.
+    /// \param[in] _rows Number of rows of the grid.
+    /// \param[in] _tileSamples Samples along each side of a tile, a power
+    /// of two plus one.
+    /// \param[in] _cellSize Distance between samples.
+    /// \param[in] _center Position of the center of the grid.
+    public: TileLayout(unsigned int _columns, unsigned int _rows,
+                       unsigned int _tileSamples, double _cellSize,
+                       const math::Vector2d &_center)
+      : tileSamples(std::max(2u, _tileSamples)), cellSize(_cellSize)
+    {
+      const unsigned int span = this->tileSamples - 1;
+      this->tileColumns = std::max(1u, (std::max(1u, _columns) - 1 + span - 1)
+          / span);
+      this->tileRows = std::max(1u, (std::max(1u, _rows) - 1 + span - 1)
+          / span);
+      this->min.Set(_center.X() - (_columns - 1) * _cellSize * 0.5,
+          _center.Y() + (_rows - 1) * _cellSize * 0.5);
+    }
+
+    /// \brief Get the samples along each side of a tile at full resolution.
+    /// \return Tile samples.
+    public: unsigned int TileSamples() const
+    {
+      return this->tileSamples;
+    }
+
+    /// \brief Get the number of tiles along X.
+    /// \return Tile columns.
+    public: unsigned int TileColumns() const
+    {
+      return this->tileColumns;
+    }
+
+    /// \brief Get the number of tiles along Y.
+    /// \return Tile rows.
+    public: unsigned int TileRows() const
+    {
+      return this->tileRows;
+    }
+
+    /// \brief Get the size of a tile along X and Y.
+    /// \return Size in meters.
+    public: double TileExtent() const
+    {
+      return (this->tileSamples - 1) * this->cellSize;
+    }
+
+    /// \brief Get the first sample of a tile.
+    /// \param[in] _tile Tile column and row.
+    /// \return Sample column and row.
+    public: std::pair<unsigned int, unsigned int> FirstSample(
+                const std::pair<unsigned int, unsigned int> &_tile) const
+    {
+      return {_tile.first * (this->tileSamples - 1),
+              _tile.second * (this->tileSamples - 1)};
+    }
+
+    /// \brief Get the center of a tile.
+    /// \param[in] _tile Tile column and row.
+    /// \return Center in the XY plane.
+    public: math::Vector2d Center(
+                const std::pair<unsigned int, unsigned int> &_tile) const
+    {
+      const double half = this->TileExtent() * 0.5;
+      return {this->min.X() + _tile.first * this->TileExtent() + half,
+              this->min.Y() - _tile.second * this->TileExtent() - half};
+    }
+
+    /// \brief Get the largest level of detail, at which a tile has 3
+    /// samples along each side.
+    /// \return Coarsest level.
+    public: unsigned int MaxLevel() const
+    {
+      unsigned int level = 0;
+      while (((this->tileSamples - 1) >> (level + 1)) >= 2)
+        ++level;
+      return level;
+    }
+
+    /// \brief Pick the tiles in use around positions. Tiles within the
+    /// load distance of a position use level 0, the full resolution. Each
+    /// further level halves the resolution and doubles the distance, up to
+    /// the maximum distance.
+    /// \param[in] _positions Positions in the XY plane.
+    /// \param[in] _loadDistance Distance of the full resolution tiles.
+    /// \param[in] _maxDistance Distance beyond which tiles aren't used.
+    /// \return Level of each tile in use, by tile column and row.
+    public: std::map<std::pair<unsigned int, unsigned int>, unsigned int>
+                Tiles(const std::vector<math::Vector2d> &_positions,
+                      double _loadDistance, double _maxDistance) const
+    {
+      std::map<std::pair<unsigned int, unsigned int>, unsigned int> tiles;
+      if (!(_loadDistance > 0))
+        return tiles;
+
+      const double half = this->TileExtent() * 0.5;
+      const unsigned int maxLevel = this->MaxLevel();
+      for (const auto &position : _positions)
+      {
+        // Only visit tiles which may be within the maximum distance
+        const double reach = _maxDistance + half;
+        auto range = [&](double _value, double _origin, double _sign,
+            unsigned int _count)
+        {
+          const double lo = _sign * (_value - _origin) - reach;
+          const double hi = _sign * (_value - _origin) + reach;
+          const double extent = this->TileExtent();
+          const int first = std::max(0, static_cast<int>(
+              std::floor(lo / extent)));
+          const int last = std::min(static_cast<int>(_count) - 1,
+              static_cast<int>(std::floor(hi / extent)));
+          return std::make_pair(first, last);
+        };
+        const auto columns = range(position.X(), this->min.X(), 1.0,
+            this->tileColumns);
+        const auto rows = range(position.Y(), this->min.Y(), -1.0,
+            this->tileRows);
+
+        for (int row = rows.first; row <= rows.second; ++row)
+        {
+          for (int column = columns.first; column <= columns.second;
+              ++column)
+          {
+            const std::pair<unsigned int, unsigned int> tile(
+                static_cast<unsigned int>(column),
+                static_cast<unsigned int>(row));
+
+            // Distance from the position to the tile's square
+            const math::Vector2d center = this->Center(tile);
+            const double dx =
+                std::max(0.0, std::abs(position.X() - center.X()) - half);
+            const double dy =
+                std::max(0.0, std::abs(position.Y() - center.Y()) - half);
+            const double dist = std::sqrt(dx * dx + dy * dy);
+            if (dist > _maxDistance)
+              continue;
+
+            unsigned int level = 0;
+            while (level < maxLevel &&
+                dist > _loadDistance * std::pow(2.0, level))
+            {
+              ++level;
+            }
+
+            auto iter = tiles.find(tile);
+            if (iter == tiles.end())
+              tiles[tile] = level;
+            else
+              iter->second = std::min(iter->second, level);
+          }
+        }
+      }
+      return tiles;
+    }
+
+    /// \brief Samples along each side of a tile at full resolution.
+    private: unsigned int tileSamples;
+
+    /// \brief Distance between samples.
+    private: double cellSize;
+
+    /// \brief Number of tiles along X.
+    private: unsigned int tileColumns{1};
+
+    /// \brief Number of tiles along Y.
+    private: unsigned int tileRows{1};
+
+    /// \brief Corner of the grid with the smallest X and largest Y.
+    private: math::Vector2d min;
+  };
+}
+}
+}
+
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "TerrainGrid.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems::terrain_tiles;
+
+/////////////////////////////////////////////////
+/// \brief Write a grid of 16 bit samples whose value is 10 * row + column.
+std::string writeGrid(unsigned int _columns, unsigned int _rows)
+{
+  const std::string path = testing::TempDir() + "terrain_grid_TEST.raw";
+  std::ofstream out(path, std::ios::binary);
+  for (unsigned int row = 0; row < _rows; ++row)
+  {
+    for (unsigned int column = 0; column < _columns; ++column)
+    {
+      const uint16_t value = static_cast<uint16_t>(10 * row + column);
+      const char bytes[2] = {static_cast<char>(value & 0xff),
+          static_cast<char>(value >> 8)};
+      out.write(bytes, 2);
+    }
+  }
+  return path;
+}
+
+/////////////////////////////////////////////////
+TEST(TerrainGridTest, ReadBlocks)
+{
+  const std::string path = writeGrid(5, 4);
+
+  HeightFile file;
+  EXPECT_FALSE(file.Open(path, 6, 4, SampleFormat::UINT16));
+  EXPECT_FALSE(file.Open(path, 5, 4, SampleFormat::FLOAT32));
+  ASSERT_TRUE(file.Open(path, 5, 4, SampleFormat::UINT16));
+
+  std::vector<double> heights;
+  ASSERT_TRUE(file.Read(1, 1, 2, 1, heights));
+  EXPECT_EQ((std::vector<double>{11, 12, 21, 22}), heights);
+
+  // Every other sample
+  ASSERT_TRUE(file.Read(0, 0, 2, 2, heights));
+  EXPECT_EQ((std::vector<double>{0, 2, 20, 22}), heights);
+
+  // Samples past the edges are clamped
+  ASSERT_TRUE(file.Read(3, 2, 3, 1, heights));
+  EXPECT_EQ((std::vector<double>{23, 24, 24, 33, 34, 34, 33, 34, 34}),
+      heights);
+}
+
+/////////////////////////////////////////////////
+TEST(TerrainGridTest, Layout)
+{
+  // 9x5 samples, tiles of 5 samples, 1m cells, centered at the origin
+  TileLayout layout(9, 5, 5, 1.0, math::Vector2d(0, 0));
+  EXPECT_EQ(2u, layout.TileColumns());
+  EXPECT_EQ(1u, layout.TileRows());
+  EXPECT_DOUBLE_EQ(4.0, layout.TileExtent());
+  EXPECT_EQ(1u, layout.MaxLevel());
+
+  auto first = layout.FirstSample({1, 0});
+  EXPECT_EQ(4u, first.first);
+  EXPECT_EQ(0u, first.second);
+
+  auto center = layout.Center({0, 0});
+  EXPECT_DOUBLE_EQ(-2.0, center.X());
+  EXPECT_DOUBLE_EQ(0.0, center.Y());
+  center = layout.Center({1, 0});
+  EXPECT_DOUBLE_EQ(2.0, center.X());
+}
+
+/////////////////////////////////////////////////
+TEST(TerrainGridTest, Tiles)
+{
+  // 4x4 tiles of 10m, centered at the origin
+  TileLayout layout(41, 41, 11, 1.0, math::Vector2d(0, 0));
+  EXPECT_EQ(4u, layout.TileColumns());
+  EXPECT_EQ(4u, layout.TileRows());
+
+  // Position in tile (0, 0), the corner with smallest X and largest Y
+  auto tiles = layout.Tiles({math::Vector2d(-15, 15)}, 1.0, 12.0);
+  ASSERT_EQ(4u, tiles.size());
+  EXPECT_EQ(0u, tiles.at({0, 0}));
+  EXPECT_EQ(2u, tiles.at({1, 0}));
+  EXPECT_EQ(2u, tiles.at({0, 1}));
+  EXPECT_EQ(2u, tiles.at({1, 1}));
+
+  // The finest level of overlapping positions wins
+  tiles = layout.Tiles({math::Vector2d(-15, 15), math::Vector2d(-9.5, 15)},
+      1.0, 12.0);
+  EXPECT_EQ(0u, tiles.at({0, 0}));
+  EXPECT_EQ(0u, tiles.at({1, 0}));
+  EXPECT_FALSE(tiles.count({3, 0}));
+
+  // Positions far from the grid use no tiles
+  EXPECT_TRUE(layout.Tiles({math::Vector2d(100, 100)}, 1.0, 12.0).empty());
+  EXPECT_TRUE(layout.Tiles({math::Vector2d(0, 0)}, 0.0, 12.0).empty());
+}
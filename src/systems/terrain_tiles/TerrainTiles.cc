@@ -0,0 +1,392 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "TerrainTiles.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Image.hh>
+#include <ignition/common/Profiler.hh>
+#include <ignition/common/Util.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Vector2.hh>
+#include <ignition/plugin/Register.hh>
+
+#include <sdf/Root.hh>
+
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
+#include "ignition/gazebo/components/Performer.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/SdfEntityCreator.hh"
+#include "ignition/gazebo/Util.hh"
+
+#include "TerrainGrid.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace systems;
+
+/// \brief A loaded tile.
+struct LoadedTile
+{
+  /// \brief Model of the tile.
+  Entity entity{kNullEntity};
+
+  /// \brief Level of detail of the tile.
+  unsigned int level{0};
+};
+
+/// \brief Private data class for TerrainTiles
+class ignition::gazebo::systems::TerrainTilesPrivate
+{
+  /// \brief Load the tiles in use and remove those not in use anymore.
+  /// \param[in] _ecm Entity component manager.
+  public: void UpdateTiles(EntityComponentManager &_ecm);
+
+  /// \brief Write the image of a tile and create its model.
+  /// \param[in] _tile Tile column and row.
+  /// \param[in] _level Level of detail.
+  /// \return Model of the tile, or kNullEntity on failure.
+  public: Entity LoadTile(const std::pair<unsigned int, unsigned int> &_tile,
+                          unsigned int _level);
+
+  /// \brief Source of the heights.
+  public: terrain_tiles::HeightFile file;
+
+  /// \brief Layout of the tiles.
+  public: std::unique_ptr<terrain_tiles::TileLayout> layout;
+
+  /// \brief Creates and removes tile models.
+  public: std::unique_ptr<SdfEntityCreator> creator;
+
+  /// \brief World entity.
+  public: Entity world{kNullEntity};
+
+  /// \brief Transform from sample values to heights.
+  public: double heightScale{1.0};
+
+  /// \brief Offset of heights.
+  public: double heightOffset{0.0};
+
+  /// \brief Distance within which tiles use full resolution.
+  public: double loadDistance{500.0};
+
+  /// \brief Distance beyond which tiles aren't loaded.
+  public: double lodDistance{2000.0};
+
+  /// \brief Sim time between updates.
+  public: std::chrono::steady_clock::duration updatePeriod{
+      std::chrono::seconds(1)};
+
+  /// \brief Sim time of the next update.
+  public: std::chrono::steady_clock::duration nextUpdate{0};
+
+  /// \brief `<texture>` and `<blend>` elements of the visuals.
+  public: std::string materialSdf;
+
+  /// \brief Directory of the tile images.
+  public: std::string cacheDir;
+
+  /// \brief Loaded tiles, by column and row.
+  public: std::map<std::pair<unsigned int, unsigned int>, LoadedTile> tiles;
+
+  /// \brief Heights of the tile being loaded, kept to avoid reallocations.
+  public: std::vector<double> heights;
+};
+
+//////////////////////////////////////////////////
+TerrainTiles::TerrainTiles()
+  : dataPtr(std::make_unique<TerrainTilesPrivate>())
+{
+}
+
+//////////////////////////////////////////////////
+TerrainTiles::~TerrainTiles() = default;
+
+//////////////////////////////////////////////////
+void TerrainTiles::Configure(const Entity &_entity,
+    const std::shared_ptr<const sdf::Element> &_sdf,
+    EntityComponentManager &_ecm, EventManager &_eventMgr)
+{
+  auto sdfClone = _sdf->Clone();
+
+  std::string source = sdfClone->Get<std::string>("source", "").first;
+  if (source.empty())
+  {
+    ignerr << "TerrainTiles requires a <source>." << std::endl;
+    return;
+  }
+  source = common::findFile(asFullPath(source, _sdf->FilePath()));
+
+  auto columns = sdfClone->Get<unsigned int>("columns", 0).first;
+  auto rows = sdfClone->Get<unsigned int>("rows", 0).first;
+
+  auto formatName = sdfClone->Get<std::string>("format", "float32").first;
+  terrain_tiles::SampleFormat format;
+  if (formatName == "float32")
+    format = terrain_tiles::SampleFormat::FLOAT32;
+  else if (formatName == "uint16")
+    format = terrain_tiles::SampleFormat::UINT16;
+  else
+  {
+    ignerr << "Unknown terrain <format> [" << formatName
+           << "], it must be float32 or uint16." << std::endl;
+    return;
+  }
+
+  if (!this->dataPtr->file.Open(source, columns, rows, format))
+  {
+    ignerr << "Failed to open terrain [" << source << "] with [" << columns
+           << "] columns and [" << rows << "] rows of [" << formatName
+           << "] samples." << std::endl;
+    return;
+  }
+
+  auto tileSamples = sdfClone->Get<unsigned int>("tile_samples", 129).first;
+  if (tileSamples < 3 || !math::isPowerOfTwo(tileSamples - 1))
+  {
+    ignerr << "Terrain <tile_samples> [" << tileSamples
+           << "] must be a power of two plus one." << std::endl;
+    return;
+  }
+
+  auto cellSize = sdfClone->Get<double>("cell_size", 1.0).first;
+  if (cellSize <= 0)
+  {
+    ignerr << "Terrain <cell_size> must be positive." << std::endl;
+    return;
+  }
+
+  auto position = sdfClone->Get<math::Vector3d>("position",
+      math::Vector3d::Zero).first;
+  this->dataPtr->heightScale =
+      sdfClone->Get<double>("height_scale", 1.0).first;
+  this->dataPtr->heightOffset = position.Z() +
+      sdfClone->Get<double>("height_offset", 0.0).first;
+  this->dataPtr->loadDistance =
+      sdfClone->Get<double>("load_distance", 500.0).first;
+  this->dataPtr->lodDistance = sdfClone->Get<double>("lod_distance",
+      4 * this->dataPtr->loadDistance).first;
+  this->dataPtr->updatePeriod =
+      std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(
+      sdfClone->Get<double>("update_period", 1.0).first));
+
+  this->dataPtr->layout = std::make_unique<terrain_tiles::TileLayout>(
+      columns, rows, tileSamples, cellSize,
+      math::Vector2d(position.X(), position.Y()));
+
+  for (const std::string name : {"texture", "blend"})
+  {
+    for (auto elem = sdfClone->GetElementImpl(name); elem;
+        elem = elem->GetNextElement(name))
+    {
+      this->dataPtr->materialSdf += elem->ToString("");
+    }
+  }
+
+  auto worldName = _ecm.Component<components::Name>(_entity);
+  this->dataPtr->cacheDir = sdfClone->Get<std::string>("cache_dir", "").first;
+  if (this->dataPtr->cacheDir.empty())
+  {
+    std::string home;
+    common::env(IGN_HOMEDIR, home);
+    this->dataPtr->cacheDir = common::joinPaths(home, ".ignition", "gazebo",
+        "terrain_tiles", worldName ? worldName->Data() : "default");
+  }
+  if (!common::createDirectories(this->dataPtr->cacheDir))
+  {
+    ignerr << "Failed to create terrain cache directory ["
+           << this->dataPtr->cacheDir << "]." << std::endl;
+    return;
+  }
+
+  this->dataPtr->world = _entity;
+  this->dataPtr->creator = std::make_unique<SdfEntityCreator>(_ecm, _eventMgr);
+
+  igndbg << "Streaming terrain [" << source << "] in ["
+         << this->dataPtr->layout->TileColumns() << "x"
+         << this->dataPtr->layout->TileRows() << "] tiles." << std::endl;
+}
+
+//////////////////////////////////////////////////
+void TerrainTiles::PreUpdate(const UpdateInfo &_info,
+    EntityComponentManager &_ecm)
+{
+  IGN_PROFILE("TerrainTiles::PreUpdate");
+
+  if (!this->dataPtr->creator || _info.simTime < this->dataPtr->nextUpdate)
+    return;
+
+  this->dataPtr->nextUpdate = _info.simTime + this->dataPtr->updatePeriod;
+  this->dataPtr->UpdateTiles(_ecm);
+}
+
+//////////////////////////////////////////////////
+void TerrainTilesPrivate::UpdateTiles(EntityComponentManager &_ecm)
+{
+  std::vector<math::Vector2d> positions;
+  _ecm.Each<components::Performer, components::ParentEntity>(
+      [&](const Entity &, const components::Performer *,
+          const components::ParentEntity *_parent) -> bool
+      {
+        auto pose = worldPose(_parent->Data(), _ecm);
+        positions.emplace_back(pose.Pos().X(), pose.Pos().Y());
+        return true;
+      });
+  if (positions.empty())
+    positions.emplace_back(0, 0);
+
+  auto wanted = this->layout->Tiles(positions, this->loadDistance,
+      this->lodDistance);
+
+  // Remove tiles not in use, or in use at another level
+  for (auto iter = this->tiles.begin(); iter != this->tiles.end();)
+  {
+    auto wantedIter = wanted.find(iter->first);
+    if (wantedIter == wanted.end() || wantedIter->second != iter->second.level)
+    {
+      this->creator->RequestRemoveEntity(iter->second.entity);
+      iter = this->tiles.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+
+  for (const auto &[tile, level] : wanted)
+  {
+    if (this->tiles.find(tile) != this->tiles.end())
+      continue;
+
+    auto entity = this->LoadTile(tile, level);
+    if (entity != kNullEntity)
+      this->tiles[tile] = {entity, level};
+  }
+}
+
+//////////////////////////////////////////////////
+Entity TerrainTilesPrivate::LoadTile(
+    const std::pair<unsigned int, unsigned int> &_tile, unsigned int _level)
+{
+  IGN_PROFILE("TerrainTiles::LoadTile");
+
+  // Each level halves the samples along each side of the tile
+  const unsigned int step = 1u << _level;
+  const unsigned int samples = (this->layout->TileSamples() - 1) / step + 1;
+  const auto first = this->layout->FirstSample(_tile);
+  if (!this->file.Read(first.first, first.second, samples, step,
+      this->heights))
+  {
+    ignerr << "Failed to read terrain tile [" << _tile.first << ", "
+           << _tile.second << "]." << std::endl;
+    return kNullEntity;
+  }
+
+  double minHeight = std::numeric_limits<double>::max();
+  double maxHeight = std::numeric_limits<double>::lowest();
+  for (auto &height : this->heights)
+  {
+    height = height * this->heightScale + this->heightOffset;
+    minHeight = std::min(minHeight, height);
+    maxHeight = std::max(maxHeight, height);
+  }
+  // Heightmaps need a positive height
+  const double range = std::max(maxHeight - minHeight, 1e-3);
+
+  // Heightmaps are loaded from 8 bit images, spread the tile's heights
+  // over the whole range of the image
+  std::vector<unsigned char> pixels(this->heights.size() * 3);
+  for (std::size_t i = 0; i < this->heights.size(); ++i)
+  {
+    auto value = static_cast<unsigned char>(std::lround(
+        (this->heights[i] - minHeight) / range * 255.0));
+    pixels[i * 3] = pixels[i * 3 + 1] = pixels[i * 3 + 2] = value;
+  }
+
+  const std::string name = "terrain_tile_" + std::to_string(_tile.first) +
+      "_" + std::to_string(_tile.second);
+  const std::string path = common::joinPaths(this->cacheDir,
+      name + "_" + std::to_string(_level) + ".png");
+  common::Image image;
+  image.SetFromData(pixels.data(), samples, samples,
+      common::Image::RGB_INT8);
+  image.SavePNG(path);
+
+  const double extent = this->layout->TileExtent();
+  const auto center = this->layout->Center(_tile);
+
+  std::ostringstream heightmap;
+  heightmap << "<uri>" << path << "</uri>"
+            << "<size>" << extent << " " << extent << " " << range
+            << "</size>";
+
+  std::ostringstream sdfStr;
+  sdfStr << "<?xml version='1.0'?>"
+         << "<sdf version='1.6'>"
+         << "<model name='" << name << "'>"
+         << "<static>true</static>"
+         << "<pose>" << center.X() << " " << center.Y() << " " << minHeight
+         << " 0 0 0</pose>"
+         << "<link name='link'>";
+  // Only full resolution tiles collide, coarser tiles are too far to be
+  // touched
+  if (_level == 0)
+  {
+    sdfStr << "<collision name='collision'><geometry><heightmap>"
+           << heightmap.str()
+           << "</heightmap></geometry></collision>";
+  }
+  sdfStr << "<visual name='visual'><geometry><heightmap>"
+         << heightmap.str() << this->materialSdf
+         << "</heightmap></geometry></visual>"
+         << "</link></model></sdf>";
+
+  sdf::Root root;
+  auto errors = root.LoadSdfString(sdfStr.str());
+  if (!errors.empty() || !root.Model())
+  {
+    ignerr << "Failed to load terrain tile [" << name << "]:" << std::endl;
+    for (const auto &error : errors)
+      ignerr << error << std::endl;
+    return kNullEntity;
+  }
+
+  auto entity = this->creator->CreateEntities(root.Model());
+  this->creator->SetParent(entity, this->world);
+  return entity;
+}
+
+IGNITION_ADD_PLUGIN(TerrainTiles, System,
+  TerrainTiles::ISystemConfigure,
+  TerrainTiles::ISystemPreUpdate
+)
+
+IGNITION_ADD_PLUGIN_ALIAS(TerrainTiles,
+    "ignition::gazebo::systems::TerrainTiles")
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IGNITION_GAZEBO_SYSTEMS_TERRAINTILES_HH_
+#define IGNITION_GAZEBO_SYSTEMS_TERRAINTILES_HH_
+
+#include <memory>
+#include <ignition/gazebo/config.hh>
+#include <ignition/gazebo/System.hh>
+
+namespace ignition
+{
+namespace gazebo
+{
+// Inline bracket to help doxygen filtering.
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems
+{
+  // Forward declarations.
+  class TerrainTilesPrivate;
+
+  /// \class TerrainTiles TerrainTiles.hh
+  /// ignition/gazebo/systems/TerrainTiles.hh
+  /// \brief World plugin which streams a large terrain as a grid of
+  /// heightmap tiles. Only the tiles around the performers, or around the
+  /// world origin if there are no performers, are loaded. Nearby tiles use
+  /// the full resolution, and the resolution of further tiles halves each
+  /// time the distance doubles. The heights are read a tile at a time from
+  /// a raw file, so the whole terrain is never in memory.
+  ///
+  /// Each tile is a static model named `terrain_tile_<column>_<row>`, with
+  /// a heightmap visual. Only full resolution tiles have a heightmap
+  /// collision.
+  ///
+  /// ## System Parameters
+  ///
+  /// - `<source>`: Path to a file with the heights, row by row, starting
+  /// with the row with the largest Y. Required.
+  /// - `<format>`: Format of the samples, `float32` (default) or `uint16`,
+  /// both little endian.
+  /// - `<columns>`, `<rows>`: Size of the grid in samples. Required.
+  /// - `<cell_size>`: Distance between samples in meters. Defaults to 1.
+  /// - `<height_scale>`, `<height_offset>`: Transform from sample values to
+  /// heights in meters. Default to 1 and 0.
+  /// - `<position>`: Position of the center of the grid. Defaults to the
+  /// origin.
+  /// - `<tile_samples>`: Samples along each side of a tile, a power of two
+  /// plus one. Defaults to 129.
+  /// - `<load_distance>`: Distance within which tiles use the full
+  /// resolution. Defaults to 500.
+  /// - `<lod_distance>`: Distance beyond which tiles aren't loaded.
+  /// Defaults to 4 times `<load_distance>`.
+  /// - `<update_period>`: Sim time in seconds between updates of the
+  /// loaded tiles. Defaults to 1.
+  /// - `<texture>`, `<blend>`: Copied to every heightmap visual, see
+  /// the `<heightmap>` SDF element.
+  /// - `<cache_dir>`: Directory where tile images are written. Defaults to
+  /// `~/.ignition/gazebo/terrain_tiles/<world name>`.
+  class TerrainTiles:
+    public System,
+    public ISystemConfigure,
+    public ISystemPreUpdate
+  {
+    /// \brief Constructor
+    public: explicit TerrainTiles();
+
+    /// \brief Destructor
+    public: ~TerrainTiles() override;
+
+    // Documentation inherited
+    public: void Configure(const Entity &_entity,
+                           const std::shared_ptr<const sdf::Element> &_sdf,
+                           EntityComponentManager &_ecm,
+                           EventManager &_eventMgr) final;
+
+    /// Documentation inherited
+    public: void PreUpdate(const UpdateInfo &_info,
+                           EntityComponentManager &_ecm) final;
+
+    /// \brief Private data pointer.
+    private: std::unique_ptr<TerrainTilesPrivate> dataPtr;
+  };
+  }
+}
+}
+}
+#endif
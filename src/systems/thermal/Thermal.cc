@@ -73,7 +73,7 @@ void Thermal::Configure(const Entity &_entity,
     auto modelEntity = topLevelModel(_entity, _ecm);
     auto modelPath =
       _ecm.ComponentData<components::SourceFilePath>(modelEntity);
-    auto path = common::findFile(asFullPath(heatSignature, modelPath.value()));
+    auto path = findResource(heatSignature, modelPath.value());
 
     // make sure the specified heat signature can be found
     if (path.empty())
@@ -18,8 +18,12 @@
 #include "TouchPlugin.hh"
 
 #include <algorithm>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <ignition/common/Profiler.hh>
@@ -42,8 +46,244 @@ using namespace ignition;
 using namespace gazebo;
 using namespace systems;
 
+namespace
+{
+/// \brief Routes the contacts of all touch plugins sharing an ECM.
+///
+/// Collision names are resolved once and shared by all plugins, so each
+/// plugin only matches its target against them. Every iteration, the first
+/// plugin to ask walks the ContactSensorData of the registered collisions
+/// once and flags the plugins whose targets are being touched, so the cost
+/// scales with the number of contacts instead of plugins times contacts.
+class TouchDispatcher
+{
+  /// \brief Get the dispatcher of an ECM, creating it if needed.
+  /// \param[in] _ecm Entity component manager of the plugins
+  /// \return The shared dispatcher.
+  public: static std::shared_ptr<TouchDispatcher> Get(
+      const EntityComponentManager &_ecm)
+  {
+    return _ecm.SharedObject<TouchDispatcher>(
+        "ignition::gazebo::systems::TouchDispatcher");
+  }
+
+  /// \brief Get the scoped names of all collisions.
+  /// \param[in] _ecm Entity component manager
+  /// \return Scoped name of each collision entity.
+  public: const std::unordered_map<Entity, std::string> &Names(
+      const EntityComponentManager &_ecm)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (!this->namesLoaded)
+    {
+      _ecm.Each<components::Collision>(
+          [&](const Entity &_entity, const components::Collision *) -> bool
+          {
+            this->names[_entity] = scopedName(_entity, _ecm);
+            return true;
+          });
+      this->namesLoaded = true;
+    }
+    return this->names;
+  }
+
+  /// \brief Get the scoped names of the collisions created in this
+  /// iteration. Only the first call of each iteration looks them up, except
+  /// while paused, when the iteration count doesn't advance.
+  /// \param[in] _info Simulation update info
+  /// \param[in] _ecm Entity component manager
+  /// \return New collision entities and their scoped names.
+  public: const std::vector<std::pair<Entity, std::string>> &NewNames(
+      const UpdateInfo &_info, const EntityComponentManager &_ecm)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (_info.paused || this->namesIteration != _info.iterations ||
+        !this->namesIterationValid)
+    {
+      this->namesIteration = _info.iterations;
+      this->namesIterationValid = true;
+      this->newNames.clear();
+      _ecm.EachNew<components::Collision>(
+          [&](const Entity &_entity, const components::Collision *) -> bool
+          {
+            auto name = scopedName(_entity, _ecm);
+            if (this->namesLoaded)
+              this->names[_entity] = name;
+            this->newNames.emplace_back(_entity, std::move(name));
+            return true;
+          });
+      _ecm.EachRemoved<components::Collision>(
+          [&](const Entity &_entity, const components::Collision *) -> bool
+          {
+            this->names.erase(_entity);
+            return true;
+          });
+    }
+    return this->newNames;
+  }
+
+  /// \brief Register a plugin.
+  /// \param[in] _collisions Contact sensor collisions of the plugin's model
+  /// \param[in] _targets Sorted target collisions of the plugin
+  /// \return Slot to pass to the other functions.
+  public: std::size_t Add(const std::vector<Entity> &_collisions,
+      const std::vector<Entity> &_targets)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    std::size_t slot;
+    if (this->freeSlots.empty())
+    {
+      slot = this->targets.size();
+      this->targets.emplace_back();
+      this->collisions.emplace_back();
+      this->touching.push_back(0);
+    }
+    else
+    {
+      slot = this->freeSlots.back();
+      this->freeSlots.pop_back();
+    }
+    this->targets[slot] = _targets;
+    this->collisions[slot] = _collisions;
+    this->touching[slot] = 0;
+    for (const auto &collision : _collisions)
+      this->collisionSlots[collision].push_back(slot);
+    return slot;
+  }
+
+  /// \brief Unregister a plugin.
+  /// \param[in] _slot Slot returned by Add
+  public: void Remove(std::size_t _slot)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (const auto &collision : this->collisions[_slot])
+    {
+      auto it = this->collisionSlots.find(collision);
+      if (it == this->collisionSlots.end())
+        continue;
+      auto &slots = it->second;
+      slots.erase(std::remove(slots.begin(), slots.end(), _slot),
+          slots.end());
+      if (slots.empty())
+        this->collisionSlots.erase(it);
+    }
+    this->collisions[_slot].clear();
+    this->targets[_slot].clear();
+    this->touching[_slot] = 0;
+    this->freeSlots.push_back(_slot);
+  }
+
+  /// \brief Update the targets of a plugin.
+  /// \param[in] _slot Slot returned by Add
+  /// \param[in] _targets Sorted target collisions
+  public: void SetTargets(std::size_t _slot,
+      const std::vector<Entity> &_targets)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->targets[_slot] = _targets;
+  }
+
+  /// \brief Whether a plugin's model is touching one of its targets. The
+  /// first call of each iteration dispatches the contacts of all plugins.
+  /// \param[in] _info Simulation update info
+  /// \param[in] _ecm Entity component manager
+  /// \param[in] _slot Slot returned by Add
+  /// \return True if touching.
+  public: bool Touching(const UpdateInfo &_info,
+      const EntityComponentManager &_ecm, std::size_t _slot)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->dispatchIteration != _info.iterations ||
+        !this->dispatchIterationValid)
+    {
+      this->dispatchIteration = _info.iterations;
+      this->dispatchIterationValid = true;
+      this->Dispatch(_ecm);
+    }
+    return this->touching[_slot];
+  }
+
+  /// \brief Flag the plugins touching their targets.
+  /// \param[in] _ecm Entity component manager
+  private: void Dispatch(const EntityComponentManager &_ecm)
+  {
+    IGN_PROFILE("TouchDispatcher::Dispatch");
+    std::fill(this->touching.begin(), this->touching.end(), 0);
+
+    for (const auto &[collision, slots] : this->collisionSlots)
+    {
+      auto *contacts = _ecm.Component<components::ContactSensorData>(
+          collision);
+      if (!contacts)
+        continue;
+
+      for (const auto &contact : contacts->Data().contact())
+      {
+        for (auto slot : slots)
+        {
+          if (this->touching[slot])
+            continue;
+
+          const auto &slotTargets = this->targets[slot];
+          if (std::binary_search(slotTargets.begin(), slotTargets.end(),
+              contact.collision1().id()) ||
+              std::binary_search(slotTargets.begin(), slotTargets.end(),
+              contact.collision2().id()))
+          {
+            this->touching[slot] = 1;
+          }
+        }
+      }
+    }
+  }
+
+  /// \brief Protects all members, plugins update in parallel.
+  private: std::mutex mutex;
+
+  /// \brief Scoped name of each collision.
+  private: std::unordered_map<Entity, std::string> names;
+
+  /// \brief Whether the names of the existing collisions have been loaded.
+  private: bool namesLoaded{false};
+
+  /// \brief Collisions created in the last iteration and their names.
+  private: std::vector<std::pair<Entity, std::string>> newNames;
+
+  /// \brief Iteration newNames was looked up in.
+  private: uint64_t namesIteration{0};
+
+  /// \brief Whether namesIteration has been set.
+  private: bool namesIterationValid{false};
+
+  /// \brief Iteration contacts were last dispatched in.
+  private: uint64_t dispatchIteration{0};
+
+  /// \brief Whether dispatchIteration has been set.
+  private: bool dispatchIterationValid{false};
+
+  /// \brief Slots of the plugins that have each collision as a sensor.
+  private: std::unordered_map<Entity, std::vector<std::size_t>>
+      collisionSlots;
+
+  /// \brief Sorted targets of each slot.
+  private: std::vector<std::vector<Entity>> targets;
+
+  /// \brief Sensor collisions of each slot.
+  private: std::vector<std::vector<Entity>> collisions;
+
+  /// \brief Whether each slot is touching a target in this iteration.
+  private: std::vector<char> touching;
+
+  /// \brief Slots left by removed plugins.
+  private: std::vector<std::size_t> freeSlots;
+};
+}
+
 class ignition::gazebo::systems::TouchPluginPrivate
 {
+  /// \brief Destructor
+  public: ~TouchPluginPrivate();
+
   // Initialize the plugin
   public: void Load(const EntityComponentManager &_ecm,
                     const sdf::ElementPtr &_sdf);
@@ -59,14 +299,21 @@ class ignition::gazebo::systems::TouchPluginPrivate
                       const EntityComponentManager &_ecm);
 
   /// \brief Add target entities. Called when new collisions are found
-  /// \param[in] _ecm Immutable reference to the EntityComponentManager
-  /// \param[in] _entities List of potential entities to add to targetEntities.
-  public: void AddTargetEntities(const EntityComponentManager &_ecm,
-                                 const std::vector<Entity> &_entities);
+  /// \param[in] _entities Potential entities to add to targetEntities and
+  /// their scoped names.
+  /// \return True if targets were added.
+  public: template<typename Names>
+          bool AddTargetEntities(const Names &_entities);
 
   /// \brief Model interface
   public: Model model{kNullEntity};
 
+  /// \brief Dispatcher shared with the other touch plugins.
+  public: std::shared_ptr<TouchDispatcher> dispatcher;
+
+  /// \brief Slot in the dispatcher, valid once the configuration is.
+  public: std::size_t dispatcherSlot{0};
+
   /// \brief Transport node to keep services alive
   transport::Node node;
 
@@ -127,15 +374,8 @@ void TouchPluginPrivate::Load(const EntityComponentManager &_ecm,
 
   this->targetName = _sdf->GetElement("target")->Get<std::string>();
 
-  std::vector<Entity> potentialEntities;
-  _ecm.Each<components::Collision>(
-      [&](const Entity &_entity, const components::Collision *) -> bool
-      {
-        potentialEntities.push_back(_entity);
-        return true;
-      });
-
-  this->AddTargetEntities(_ecm, potentialEntities);
+  this->dispatcher = TouchDispatcher::Get(_ecm);
+  this->AddTargetEntities(this->dispatcher->Names(_ecm));
 
   // Create a list of collision entities that have been marked as contact
   // sensors in this model. These are collisions that have a ContactSensorData
@@ -190,6 +430,8 @@ void TouchPluginPrivate::Load(const EntityComponentManager &_ecm,
       };
   this->node.Advertise(enableService, enableCb);
 
+  this->dispatcherSlot = this->dispatcher->Add(this->collisionEntities,
+      this->targetEntities);
   this->validConfig = true;
 
   // Start enabled or not
@@ -199,6 +441,13 @@ void TouchPluginPrivate::Load(const EntityComponentManager &_ecm,
   }
 }
 
+//////////////////////////////////////////////////
+TouchPluginPrivate::~TouchPluginPrivate()
+{
+  if (this->dispatcher && this->validConfig)
+    this->dispatcher->Remove(this->dispatcherSlot);
+}
+
 //////////////////////////////////////////////////
 void TouchPluginPrivate::Enable(const bool _value)
 {
@@ -253,30 +502,9 @@ void TouchPluginPrivate::Update(const UpdateInfo &_info,
   if (_info.paused)
     return;
 
-  bool touching{false};
-  // Iterate through all the target entities and check if there is a contact
-  // between the target entity and this model
-  for (const Entity colEntity : this->collisionEntities)
-  {
-    auto *contacts = _ecm.Component<components::ContactSensorData>(colEntity);
-    if (contacts)
-    {
-      // Check if the contacts include one of the target entities.
-      for (const auto &contact : contacts->Data().contact())
-      {
-        bool col1Target = std::binary_search(this->targetEntities.begin(),
-            this->targetEntities.end(),
-            contact.collision1().id());
-        bool col2Target = std::binary_search(this->targetEntities.begin(),
-            this->targetEntities.end(),
-            contact.collision2().id());
-        if (col1Target || col2Target)
-        {
-          touching = true;
-        }
-      }
-    }
-  }
+  // Check if there is a contact between a target entity and this model
+  bool touching = this->dispatcher->Touching(_info, _ecm,
+      this->dispatcherSlot);
 
   if (!touching)
   {
@@ -332,26 +560,27 @@ void TouchPluginPrivate::Update(const UpdateInfo &_info,
 }
 
 //////////////////////////////////////////////////
-void TouchPluginPrivate::AddTargetEntities(const EntityComponentManager &_ecm,
-                                           const std::vector<Entity> &_entities)
+template<typename Names>
+bool TouchPluginPrivate::AddTargetEntities(const Names &_entities)
 {
-  if (_entities.empty())
-    return;
-
-  for (Entity entity : _entities)
+  bool added{false};
+  for (const auto &[entity, name] : _entities)
   {
     // The target name can be a substring of the desired collision name so we
     // have to iterate through all collisions and check if their scoped name has
     // this substring
-    std::string name = scopedName(entity, _ecm);
     if (name.find(this->targetName) != std::string::npos)
     {
       this->targetEntities.push_back(entity);
+      added = true;
     }
   }
 
   // Sort so that we can do binary search later on.
-  std::sort(this->targetEntities.begin(), this->targetEntities.end());
+  if (added)
+    std::sort(this->targetEntities.begin(), this->targetEntities.end());
+
+  return added;
 }
 
 //////////////////////////////////////////////////
@@ -370,7 +599,8 @@ void TouchPlugin::Configure(const Entity &_entity,
 }
 
 //////////////////////////////////////////////////
-void TouchPlugin::PreUpdate(const UpdateInfo &, EntityComponentManager &_ecm)
+void TouchPlugin::PreUpdate(const UpdateInfo &_info,
+                            EntityComponentManager &_ecm)
 {
   IGN_PROFILE("TouchPlugin::PreUpdate");
   if (!this->dataPtr->initialized)
@@ -383,17 +613,16 @@ void TouchPlugin::PreUpdate(const UpdateInfo &, EntityComponentManager &_ecm)
 
   // This is not an "else" because "initialized" can be set in the if block
   // above
-  if (this->dataPtr->initialized)
+  if (this->dataPtr->initialized && this->dataPtr->dispatcher)
   {
     // Update target entities when new collisions are added
-    std::vector<Entity> potentialEntities;
-    _ecm.EachNew<components::Collision>(
-        [&](const Entity &_entity, const components::Collision *) -> bool
-        {
-          potentialEntities.push_back(_entity);
-          return true;
-        });
-    this->dataPtr->AddTargetEntities(_ecm, potentialEntities);
+    const auto &newNames = this->dataPtr->dispatcher->NewNames(_info, _ecm);
+    if (this->dataPtr->AddTargetEntities(newNames) &&
+        this->dataPtr->validConfig)
+    {
+      this->dataPtr->dispatcher->SetTargets(this->dataPtr->dispatcherSlot,
+          this->dataPtr->targetEntities);
+    }
   }
 }
 
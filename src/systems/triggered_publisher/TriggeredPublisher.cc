@@ -21,7 +21,13 @@
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/message_differencer.h>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <utility>
 
 #include <ignition/common/Profiler.hh>
@@ -88,6 +94,9 @@ class systems::InputMatcher
   /// \brief State of the matcher
   protected: bool valid{false};
 
+  /// \brief Tolerance for float comparisons
+  protected: double tol{1e-8};
+
   /// \brief Field comparator used by MessageDifferencer. This is where
   /// tolerance for float comparisons is set
   protected: google::protobuf::util::DefaultFieldComparator comparator;
@@ -172,6 +181,17 @@ class FieldMatcher : public InputMatcher
                      &_fieldDesc,
                  transport::ProtoMsg **_subMsg);
 
+  /// \brief Compile the comparison of a singular scalar field into a
+  /// direct accessor of the input message, so that matching doesn't go
+  /// through MessageDifferencer.
+  protected: void Compile();
+
+  /// \brief Get the message that contains the compared field.
+  /// \param[in] _msg Input or matcher message
+  /// \return The submessage at the end of the field path.
+  protected: const transport::ProtoMsg &FieldParent(
+                 const transport::ProtoMsg &_msg) const;
+
   /// \brief Logic type of this matcher
   protected: const bool logicType;
 
@@ -181,6 +201,10 @@ class FieldMatcher : public InputMatcher
   /// \brief Field descriptor of the field compared by this matcher
   protected: std::vector<const google::protobuf::FieldDescriptor *>
                  fieldDescMatcher;
+
+  /// \brief Compiled comparison of the field, empty if the field can't be
+  /// compiled, e.g. messages and repeated fields.
+  protected: std::function<bool(const transport::ProtoMsg &)> compiledMatch;
 };
 
 //////////////////////////////////////////////////
@@ -207,6 +231,7 @@ void InputMatcher::SetTolerance(double _tol)
 {
   this->comparator.SetDefaultFractionAndMargin(
       std::numeric_limits<double>::min(), _tol);
+  this->tol = _tol;
 }
 
 //////////////////////////////////////////////////
@@ -298,6 +323,144 @@ FieldMatcher::FieldMatcher(const std::string &_msgType, bool _logicType,
   }
 
   this->valid = true;
+  this->Compile();
+}
+
+//////////////////////////////////////////////////
+const transport::ProtoMsg &FieldMatcher::FieldParent(
+    const transport::ProtoMsg &_msg) const
+{
+  const transport::ProtoMsg *subMsg = &_msg;
+  for (std::size_t i = 0; i + 1 < this->fieldDescMatcher.size(); ++i)
+  {
+    subMsg = &subMsg->GetReflection()->GetMessage(*subMsg,
+        this->fieldDescMatcher[i]);
+  }
+  return *subMsg;
+}
+
+//////////////////////////////////////////////////
+void FieldMatcher::Compile()
+{
+  using FieldDescriptor = google::protobuf::FieldDescriptor;
+  const FieldDescriptor *field = this->fieldDescMatcher.back();
+  if (field->is_repeated())
+    return;
+
+  // The expected value is read once from the matcher message. At match time,
+  // only the field of the input is read.
+  const transport::ProtoMsg &matcherParent = this->FieldParent(*this->matchMsg);
+  const auto *refl = matcherParent.GetReflection();
+
+  // Floats use the same absolute tolerance as the comparator
+  auto floatEqual = [this](double _a, double _b)
+  {
+    return _a == _b || std::abs(_a - _b) <= this->tol;
+  };
+
+  switch (field->cpp_type())
+  {
+    case FieldDescriptor::CPPTYPE_BOOL:
+    {
+      bool expected = refl->GetBool(matcherParent, field);
+      this->compiledMatch = [this, field, expected](const auto &_input)
+      {
+        const auto &parent = this->FieldParent(_input);
+        return parent.GetReflection()->GetBool(parent, field) == expected;
+      };
+      break;
+    }
+    case FieldDescriptor::CPPTYPE_INT32:
+    {
+      auto expected = refl->GetInt32(matcherParent, field);
+      this->compiledMatch = [this, field, expected](const auto &_input)
+      {
+        const auto &parent = this->FieldParent(_input);
+        return parent.GetReflection()->GetInt32(parent, field) == expected;
+      };
+      break;
+    }
+    case FieldDescriptor::CPPTYPE_INT64:
+    {
+      auto expected = refl->GetInt64(matcherParent, field);
+      this->compiledMatch = [this, field, expected](const auto &_input)
+      {
+        const auto &parent = this->FieldParent(_input);
+        return parent.GetReflection()->GetInt64(parent, field) == expected;
+      };
+      break;
+    }
+    case FieldDescriptor::CPPTYPE_UINT32:
+    {
+      auto expected = refl->GetUInt32(matcherParent, field);
+      this->compiledMatch = [this, field, expected](const auto &_input)
+      {
+        const auto &parent = this->FieldParent(_input);
+        return parent.GetReflection()->GetUInt32(parent, field) == expected;
+      };
+      break;
+    }
+    case FieldDescriptor::CPPTYPE_UINT64:
+    {
+      auto expected = refl->GetUInt64(matcherParent, field);
+      this->compiledMatch = [this, field, expected](const auto &_input)
+      {
+        const auto &parent = this->FieldParent(_input);
+        return parent.GetReflection()->GetUInt64(parent, field) == expected;
+      };
+      break;
+    }
+    case FieldDescriptor::CPPTYPE_FLOAT:
+    {
+      float expected = refl->GetFloat(matcherParent, field);
+      this->compiledMatch =
+          [this, field, expected, floatEqual](const auto &_input)
+      {
+        const auto &parent = this->FieldParent(_input);
+        return floatEqual(parent.GetReflection()->GetFloat(parent, field),
+            expected);
+      };
+      break;
+    }
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+    {
+      double expected = refl->GetDouble(matcherParent, field);
+      this->compiledMatch =
+          [this, field, expected, floatEqual](const auto &_input)
+      {
+        const auto &parent = this->FieldParent(_input);
+        return floatEqual(parent.GetReflection()->GetDouble(parent, field),
+            expected);
+      };
+      break;
+    }
+    case FieldDescriptor::CPPTYPE_ENUM:
+    {
+      int expected = refl->GetEnumValue(matcherParent, field);
+      this->compiledMatch = [this, field, expected](const auto &_input)
+      {
+        const auto &parent = this->FieldParent(_input);
+        return parent.GetReflection()->GetEnumValue(parent, field) ==
+            expected;
+      };
+      break;
+    }
+    case FieldDescriptor::CPPTYPE_STRING:
+    {
+      std::string expected = refl->GetString(matcherParent, field);
+      this->compiledMatch = [this, field, expected](const auto &_input)
+      {
+        const auto &parent = this->FieldParent(_input);
+        std::string scratch;
+        return parent.GetReflection()->GetStringReference(parent, field,
+            &scratch) == expected;
+      };
+      break;
+    }
+    default:
+      // Messages are still compared with MessageDifferencer
+      break;
+  }
 }
 
 //////////////////////////////////////////////////
@@ -380,7 +543,8 @@ bool FieldMatcher::FindFieldSubMessage(
 bool FieldMatcher::DoMatch(
     const transport::ProtoMsg &_input) const
 {
-  google::protobuf::util::DefaultFieldComparator comp;
+  if (this->compiledMatch)
+    return this->logicType == this->compiledMatch(_input);
 
   auto *matcherRefl = this->matchMsg->GetReflection();
   auto *inputRefl = _input.GetReflection();
@@ -464,9 +628,142 @@ std::unique_ptr<InputMatcher> InputMatcher::Create(
   return matcher;
 }
 
+//////////////////////////////////////////////////
+/// \brief Shares one subscription per input topic among all the
+/// TriggeredPublisher instances of a process, so each input message is
+/// received once and dispatched to every interested trigger. The fan-in and
+/// its node are shared by the triggers, created by the first one and
+/// destroyed with the last one, see Acquire.
+class InputTopicFanIn
+{
+  /// \brief Callback of a trigger
+  public: using Callback = std::function<void(const transport::ProtoMsg &)>;
+
+  /// \brief Get the fan-in of the process, creating it if no trigger holds
+  /// it.
+  /// \return The fan-in, which the trigger keeps until it's destroyed.
+  public: static std::shared_ptr<InputTopicFanIn> Acquire();
+
+  /// \brief Add a trigger to a topic, subscribing to the topic if it's the
+  /// first one.
+  /// \param[in] _topic Input topic
+  /// \param[in] _owner Key used to remove the trigger
+  /// \param[in] _cb Callback for every message received on the topic
+  /// \return True if the topic is subscribed.
+  public: bool Add(const std::string &_topic, const void *_owner,
+                   Callback _cb);
+
+  /// \brief Remove a trigger from a topic, unsubscribing from the topic if
+  /// it was the last one. Once this returns, the trigger's callback isn't
+  /// running and won't be called again.
+  /// \param[in] _topic Input topic
+  /// \param[in] _owner Key the trigger was added with
+  public: void Remove(const std::string &_topic, const void *_owner);
+
+  /// \brief Triggers of one topic
+  private: struct Topic
+  {
+    /// \brief Protects callbacks, held while dispatching
+    std::mutex mutex;
+
+    /// \brief Callbacks keyed by owner
+    std::vector<std::pair<const void *, Callback>> callbacks;
+  };
+
+  /// \brief Topics by name, protected by mutex.
+  private: std::unordered_map<std::string, std::shared_ptr<Topic>> topics;
+
+  /// \brief Mutex that protects the topic map and subscriptions
+  private: std::mutex mutex;
+
+  /// \brief Node holding all the input subscriptions
+  private: transport::Node node;
+};
+
+//////////////////////////////////////////////////
+std::shared_ptr<InputTopicFanIn> InputTopicFanIn::Acquire()
+{
+  static std::mutex instanceMutex;
+  static std::weak_ptr<InputTopicFanIn> instance;
+
+  std::lock_guard<std::mutex> lock(instanceMutex);
+  auto fanIn = instance.lock();
+  if (!fanIn)
+  {
+    fanIn = std::make_shared<InputTopicFanIn>();
+    instance = fanIn;
+  }
+  return fanIn;
+}
+
+//////////////////////////////////////////////////
+bool InputTopicFanIn::Add(const std::string &_topic, const void *_owner,
+    Callback _cb)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto &topic = this->topics[_topic];
+  if (!topic)
+  {
+    topic = std::make_shared<Topic>();
+
+    // The subscription holds the topic, so dispatching never races with
+    // erasing it from the map
+    auto dispatch = std::function<void(const transport::ProtoMsg &)>(
+        [topic](const transport::ProtoMsg &_msg)
+        {
+          std::lock_guard<std::mutex> topicLock(topic->mutex);
+          for (const auto &cb : topic->callbacks)
+            cb.second(_msg);
+        });
+    if (!this->node.Subscribe(_topic, dispatch))
+    {
+      this->topics.erase(_topic);
+      return false;
+    }
+  }
+
+  std::lock_guard<std::mutex> topicLock(topic->mutex);
+  topic->callbacks.emplace_back(_owner, std::move(_cb));
+  return true;
+}
+
+//////////////////////////////////////////////////
+void InputTopicFanIn::Remove(const std::string &_topic, const void *_owner)
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto it = this->topics.find(_topic);
+  if (it == this->topics.end())
+    return;
+
+  bool empty{false};
+  {
+    std::lock_guard<std::mutex> topicLock(it->second->mutex);
+    auto &callbacks = it->second->callbacks;
+    callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(),
+        [_owner](const auto &_cb)
+        {
+          return _cb.first == _owner;
+        }), callbacks.end());
+    empty = callbacks.empty();
+  }
+
+  // Unsubscribe without holding the topic mutex, a message may be waiting
+  // on it
+  if (empty)
+  {
+    this->node.Unsubscribe(_topic);
+    this->topics.erase(it);
+  }
+}
+
 //////////////////////////////////////////////////
 TriggeredPublisher::~TriggeredPublisher()
 {
+  if (this->subscribed)
+    this->fanIn->Remove(this->inputTopic, this);
+  this->fanIn.reset();
+  this->inputConnection.reset();
+
   this->done = true;
   this->newMatchSignal.notify_one();
   if (this->workerThread.joinable())
@@ -479,9 +776,10 @@ TriggeredPublisher::~TriggeredPublisher()
 void TriggeredPublisher::Configure(const Entity &,
     const std::shared_ptr<const sdf::Element> &_sdf,
     EntityComponentManager &,
-    EventManager &)
+    EventManager &_eventMgr)
 {
   sdf::ElementPtr sdfClone = _sdf->Clone();
+  bool inProcess{false};
   if (sdfClone->HasElement("input"))
   {
     auto inputElem = sdfClone->GetElement("input");
@@ -499,6 +797,7 @@ void TriggeredPublisher::Configure(const Entity &,
       ignerr << "Invalid input topic [" << inTopic << "]" << std::endl;
       return;
     }
+    inProcess = inputElem->Get<bool>("in_process", false).first;
 
     if (inputElem->HasElement("match"))
     {
@@ -558,6 +857,7 @@ void TriggeredPublisher::Configure(const Entity &,
       {
         info.pub =
             this->node.Advertise(info.topic, info.msgData->GetTypeName());
+        info.channel = _eventMgr.Channel<transport::ProtoMsg>(info.topic);
         if (info.pub.Valid())
         {
           this->outputInfo.push_back(std::move(info));
@@ -595,7 +895,18 @@ void TriggeredPublisher::Configure(const Entity &,
           this->newMatchSignal.notify_one();
         }
       });
-  if (!this->node.Subscribe(this->inputTopic, msgCb))
+  if (inProcess)
+  {
+    auto channel = _eventMgr.Channel<transport::ProtoMsg>(this->inputTopic);
+    if (channel)
+      this->inputConnection = channel->Connect(msgCb);
+  }
+  else
+  {
+    this->fanIn = InputTopicFanIn::Acquire();
+    this->subscribed = this->fanIn->Add(this->inputTopic, this, msgCb);
+  }
+  if (!this->subscribed && !this->inputConnection)
   {
     ignerr << "Input subscriber could not be created for topic ["
            << this->inputTopic << "] with message type [" << this->inputMsgType
@@ -642,6 +953,8 @@ void TriggeredPublisher::DoWork()
     {
       for (std::size_t i = 0; i < pending; ++i)
       {
+        if (info.channel)
+          info.channel->Publish(*info.msgData);
         info.pub.Publish(*info.msgData);
       }
     }
@@ -34,6 +34,7 @@ namespace systems
 {
   // Forward declaration
   class InputMatcher;
+  class InputTopicFanIn;
 
   /// \brief The triggered publisher system publishes a user specified message
   /// on an output topic in response to an input message that matches user
@@ -46,6 +47,12 @@ namespace systems
   ///   * Attributes:
   ///     * `type`: Input message type (eg. `ignition.msgs.Boolean`)
   ///     * `topic`: Input message topic name
+  ///     * `in_process`: If true, input messages are received from the
+  ///         in-process channel of the topic instead of from transport, so
+  ///         outputs of other triggered publishers of the simulation arrive
+  ///         without being serialized. Messages published on the topic
+  ///         through transport, such as by external clients, are then
+  ///         ignored. The default value is false.
   ///
   /// `<input><match>`: Contains configuration for matchers. Multiple <match>
   /// tags are possible. An output message is triggered if all Matchers match.
@@ -68,7 +75,9 @@ namespace systems
   /// each input that matches.
   ///   * Attributes:
   ///     * `type`: Output message type (eg. `ignition.msgs.Boolean`)
-  ///     * `topic`: Output message topic name
+  ///     * `topic`: Output message topic name. Outputs are published on
+  ///         transport, and on the `transport::ProtoMsg` in-process channel
+  ///         of the topic, see EventManager::Channel.
   ///   * Value: String used to construct the output protobuf message . This is
   ///     the human-readable representation of a protobuf message as used by
   ///     `ign topic` for publishing messages
@@ -198,6 +207,9 @@ namespace systems
 
       /// \brief Transport publisher
       transport::Node::Publisher pub;
+
+      /// \brief In-process channel of the topic
+      std::shared_ptr<InProcessChannel<transport::ProtoMsg>> channel;
     };
 
     /// \brief List of InputMatchers
@@ -206,9 +218,21 @@ namespace systems
     /// \brief List of outputs
     private: std::vector<OutputInfo> outputInfo;
 
-    /// \brief Ignition communication node.
+    /// \brief Ignition communication node used for the outputs. Inputs
+    /// share one subscription per topic among all instances, see fanIn.
     private: transport::Node node;
 
+    /// \brief Whether this instance receives messages from the input topic
+    private: bool subscribed{false};
+
+    /// \brief Fan-in of the input topics of the process, held while this
+    /// instance is subscribed through it.
+    private: std::shared_ptr<InputTopicFanIn> fanIn;
+
+    /// \brief Connection to the in-process channel of the input topic, if
+    /// the input is in process.
+    private: common::ConnectionPtr inputConnection;
+
     /// \brief Counter that tells the publisher how many times to publish
     private: std::size_t publishCount{0};
 
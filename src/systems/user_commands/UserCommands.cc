@@ -22,9 +22,14 @@
 #include <ignition/msgs/entity_factory.pb.h>
 #include <ignition/msgs/light.pb.h>
 #include <ignition/msgs/pose.pb.h>
+#include <ignition/msgs/pose_v.pb.h>
 #include <ignition/msgs/physics.pb.h>
 
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -78,6 +83,57 @@ class UserCommandsInterface
 
   /// \brief World entity.
   public: Entity worldEntity{kNullEntity};
+
+  /// \brief Find a top level entity, which is a direct child of the world,
+  /// by name. The names are indexed the first time this is called during
+  /// an update, so a batch of commands doesn't search the ECM for each of
+  /// them.
+  /// \param[in] _name Entity name.
+  /// \return The entity, or kNullEntity if there's none with that name.
+  public: Entity TopLevelEntity(const std::string &_name)
+  {
+    if (!this->topLevelNamesValid)
+    {
+      this->topLevelNames.clear();
+      const EntityComponentManager &constEcm = *this->ecm;
+      constEcm.Each<components::Name, components::ParentEntity>(
+          [&](const Entity &_entity, const components::Name *_nameComp,
+              const components::ParentEntity *_parent) -> bool
+          {
+            if (_parent->Data() == this->worldEntity)
+              this->topLevelNames.emplace(_nameComp->Data(), _entity);
+            return true;
+          });
+      this->topLevelNamesValid = true;
+    }
+
+    auto it = this->topLevelNames.find(_name);
+    return it == this->topLevelNames.end() ? kNullEntity : it->second;
+  }
+
+  /// \brief Add a top level entity created by a command to the names
+  /// indexed by TopLevelEntity.
+  /// \param[in] _name Entity name.
+  /// \param[in] _entity Entity.
+  public: void AddTopLevelEntity(const std::string &_name,
+      const Entity _entity)
+  {
+    if (this->topLevelNamesValid)
+      this->topLevelNames.emplace(_name, _entity);
+  }
+
+  /// \brief Forget the indexed names, because other systems may have
+  /// created, removed or renamed entities since they were indexed.
+  public: void ResetTopLevelEntities()
+  {
+    this->topLevelNamesValid = false;
+  }
+
+  /// \brief Top level entities by name, see TopLevelEntity.
+  private: std::unordered_map<std::string, Entity> topLevelNames;
+
+  /// \brief Whether topLevelNames is up to date for this update.
+  private: bool topLevelNamesValid{false};
 };
 
 /// \brief All user commands should inherit from this class so they can be
@@ -116,6 +172,12 @@ class CreateCommand : public UserCommandBase
 
   // Documentation inherited
   public: bool Execute() final;
+
+  /// \brief Spawn a copy of an existing top level entity, copying its
+  /// components instead of loading it from SDF again.
+  /// \param[in] _msg Factory message with the name of the entity to copy.
+  /// \return True if the copy was created.
+  private: bool Clone(const msgs::EntityFactory &_msg);
 };
 
 /// \brief Command to remove an entity from simulation.
@@ -223,6 +285,19 @@ class PoseCommand : public UserCommandBase
                      }};
 };
 
+/// \brief Command to update the pose transforms of several entities.
+class PoseVectorCommand : public UserCommandBase
+{
+  /// \brief Constructor
+  /// \param[in] _msg Message containing the poses.
+  /// \param[in] _iface Pointer to user commands interface.
+  public: PoseVectorCommand(msgs::Pose_V *_msg,
+      std::shared_ptr<UserCommandsInterface> &_iface);
+
+  // Documentation inherited
+  public: bool Execute() final;
+};
+
 /// \brief Command to modify the physics parameters of a simulation.
 class PhysicsCommand : public UserCommandBase
 {
@@ -281,6 +356,14 @@ class ignition::gazebo::systems::UserCommandsPrivate
   /// \return True if successful.
   public: bool PoseService(const msgs::Pose &_req, msgs::Boolean &_res);
 
+  /// \brief Callback for pose vector service
+  /// \param[in] _req Request containing pose updates of several entities.
+  /// \param[in] _res True if message successfully received and queued.
+  /// It does not mean that the entities will be successfully moved.
+  /// \return True if successful.
+  public: bool PoseVectorService(const msgs::Pose_V &_req,
+      msgs::Boolean &_res);
+
   /// \brief Callback for physics service
   /// \param[in] _req Request containing updates to the physics parameters.
   /// \param[in] _res True if message successfully received and queued.
@@ -362,6 +445,15 @@ void UserCommands::Configure(const Entity &_entity,
 
   ignmsg << "Pose service on [" << poseService << "]" << std::endl;
 
+  // Pose vector service
+  std::string poseVectorService{"/world/" + validWorldName +
+      "/set_pose_vector"};
+  this->dataPtr->node.Advertise(poseVectorService,
+      &UserCommandsPrivate::PoseVectorService, this->dataPtr.get());
+
+  ignmsg << "Pose vector service on [" << poseVectorService << "]"
+         << std::endl;
+
   // Light service
   std::string lightService{"/world/" + validWorldName + "/light_config"};
   this->dataPtr->node.Advertise(lightService,
@@ -394,6 +486,8 @@ void UserCommands::PreUpdate(const UpdateInfo &/*_info*/,
     this->dataPtr->pendingCmds.clear();
   }
 
+  this->dataPtr->iface->ResetTopLevelEntities();
+
   // TODO(louise) Record current world state for undo
 
   // Execute pending commands
@@ -506,6 +600,25 @@ bool UserCommandsPrivate::PoseService(const msgs::Pose &_req,
   return true;
 }
 
+//////////////////////////////////////////////////
+bool UserCommandsPrivate::PoseVectorService(const msgs::Pose_V &_req,
+    msgs::Boolean &_res)
+{
+  // Create command and push it to queue
+  auto msg = _req.New();
+  msg->CopyFrom(_req);
+  auto cmd = std::make_unique<PoseVectorCommand>(msg, this->iface);
+
+  // Push to pending
+  {
+    std::lock_guard<std::mutex> lock(this->pendingMutex);
+    this->pendingCmds.push_back(std::move(cmd));
+  }
+
+  _res.set_data(true);
+  return true;
+}
+
 //////////////////////////////////////////////////
 bool UserCommandsPrivate::PhysicsService(const msgs::Physics &_req,
     msgs::Boolean &_res)
@@ -585,9 +698,7 @@ bool CreateCommand::Execute()
     }
     case msgs::EntityFactory::kCloneName:
     {
-      // TODO(louise) Implement clone
-      ignerr << "Cloning an entity is not yet supported." << std::endl;
-      return false;
+      return this->Clone(*createMsg);
     }
     default:
     {
@@ -663,9 +774,7 @@ bool CreateCommand::Execute()
   }
 
   // Check if there's already a top-level entity with the given name
-  if (kNullEntity != this->iface->ecm->EntityByComponents(
-      components::Name(desiredName),
-      components::ParentEntity(this->iface->worldEntity)))
+  if (kNullEntity != this->iface->TopLevelEntity(desiredName))
   {
     if (!createMsg->allow_renaming())
     {
@@ -678,9 +787,7 @@ bool CreateCommand::Execute()
     // Generate unique name
     std::string newName = desiredName;
     int i = 0;
-    while (kNullEntity != this->iface->ecm->EntityByComponents(
-      components::Name(newName),
-      components::ParentEntity(this->iface->worldEntity)))
+    while (kNullEntity != this->iface->TopLevelEntity(newName))
     {
       newName = desiredName + "_" + std::to_string(i++);
     }
@@ -714,6 +821,7 @@ bool CreateCommand::Execute()
   }
 
   this->iface->creator->SetParent(entity, this->iface->worldEntity);
+  this->iface->AddTopLevelEntity(desiredName, entity);
 
   // Pose
   if (createMsg->has_pose())
@@ -728,6 +836,60 @@ bool CreateCommand::Execute()
   return true;
 }
 
+//////////////////////////////////////////////////
+bool CreateCommand::Clone(const msgs::EntityFactory &_msg)
+{
+  Entity source = this->iface->TopLevelEntity(_msg.clone_name());
+  if (kNullEntity == source)
+  {
+    ignerr << "Can't clone entity [" << _msg.clone_name() << "], there's no "
+           << "top level entity with that name." << std::endl;
+    return false;
+  }
+
+  // Copies without a given name are always renamed, since the name of the
+  // original is taken
+  std::string desiredName = _msg.name().empty() ? _msg.clone_name() :
+      _msg.name();
+  if (kNullEntity != this->iface->TopLevelEntity(desiredName))
+  {
+    if (!_msg.name().empty() && !_msg.allow_renaming())
+    {
+      ignwarn << "Entity named [" << desiredName << "] already exists and "
+              << "[allow_renaming] is false. Entity not spawned."
+              << std::endl;
+      return false;
+    }
+
+    std::string newName = desiredName;
+    int i = 0;
+    while (kNullEntity != this->iface->TopLevelEntity(newName))
+    {
+      newName = desiredName + "_" + std::to_string(i++);
+    }
+    desiredName = newName;
+  }
+
+  Entity entity = this->iface->ecm->CloneSubtree(source,
+      this->iface->worldEntity, "");
+  if (kNullEntity == entity)
+    return false;
+
+  this->iface->ecm->SetComponentData<components::Name>(entity, desiredName);
+  this->iface->AddTopLevelEntity(desiredName, entity);
+
+  if (_msg.has_pose())
+  {
+    this->iface->ecm->SetComponentData<components::Pose>(entity,
+        msgs::Convert(_msg.pose()));
+  }
+
+  igndbg << "Cloned entity [" << source << "] as [" << entity << "] named ["
+         << desiredName << "]" << std::endl;
+
+  return true;
+}
+
 //////////////////////////////////////////////////
 RemoveCommand::RemoveCommand(msgs::Entity *_msg,
     std::shared_ptr<UserCommandsInterface> &_iface)
@@ -900,63 +1062,113 @@ bool LightCommand::Execute()
 }
 
 //////////////////////////////////////////////////
-PoseCommand::PoseCommand(msgs::Pose *_msg,
-    std::shared_ptr<UserCommandsInterface> &_iface)
-    : UserCommandBase(_msg, _iface)
-{
-}
-
-//////////////////////////////////////////////////
-bool PoseCommand::Execute()
+/// \brief Find the entity a pose message refers to, by id or by the name of
+/// a top level entity, and set its world pose command.
+/// \param[in] _poseMsg Pose message.
+/// \param[in] _iface User commands interface.
+/// \param[in] _eql Pose equality function.
+/// \return False if the entity wasn't found.
+static bool setWorldPoseCmd(const msgs::Pose &_poseMsg,
+    const std::shared_ptr<UserCommandsInterface> &_iface,
+    const std::function<bool(const math::Pose3d &, const math::Pose3d &)>
+    &_eql)
 {
-  auto poseMsg = dynamic_cast<const msgs::Pose *>(this->msg);
-  if (nullptr == poseMsg)
-  {
-    ignerr << "Internal error, null create message" << std::endl;
-    return false;
-  }
-
   // Check the name of the entity being spawned
-  std::string entityName = poseMsg->name();
+  std::string entityName = _poseMsg.name();
   Entity entity = kNullEntity;
   // TODO(anyone) Update pose message to use Entity, with default ID null
-  if (poseMsg->id() != kNullEntity && poseMsg->id() != 0)
+  if (_poseMsg.id() != kNullEntity && _poseMsg.id() != 0)
   {
-    entity = poseMsg->id();
+    entity = _poseMsg.id();
   }
   else if (!entityName.empty())
   {
-    entity = this->iface->ecm->EntityByComponents(components::Name(entityName),
-      components::ParentEntity(this->iface->worldEntity));
+    entity = _iface->TopLevelEntity(entityName);
   }
 
-  if (!this->iface->ecm->HasEntity(entity))
+  if (!_iface->ecm->HasEntity(entity))
   {
-    ignerr << "Unable to update the pose for entity id:[" << poseMsg->id()
+    ignerr << "Unable to update the pose for entity id:[" << _poseMsg.id()
            << "], name[" << entityName << "]" << std::endl;
     return false;
   }
 
   auto poseCmdComp =
-    this->iface->ecm->Component<components::WorldPoseCmd>(entity);
+    _iface->ecm->Component<components::WorldPoseCmd>(entity);
   if (!poseCmdComp)
   {
-    this->iface->ecm->CreateComponent(
-        entity, components::WorldPoseCmd(msgs::Convert(*poseMsg)));
+    _iface->ecm->CreateComponent(
+        entity, components::WorldPoseCmd(msgs::Convert(_poseMsg)));
   }
   else
   {
     /// \todo(anyone) Moving an object is not captured in a log file.
-    auto state = poseCmdComp->SetData(msgs::Convert(*poseMsg), this->pose3Eql) ?
+    auto state = poseCmdComp->SetData(msgs::Convert(_poseMsg), _eql) ?
         ComponentState::OneTimeChange :
         ComponentState::NoChange;
-    this->iface->ecm->SetChanged(entity, components::WorldPoseCmd::typeId,
+    _iface->ecm->SetChanged(entity, components::WorldPoseCmd::typeId,
         state);
   }
 
   return true;
 }
 
+//////////////////////////////////////////////////
+PoseCommand::PoseCommand(msgs::Pose *_msg,
+    std::shared_ptr<UserCommandsInterface> &_iface)
+    : UserCommandBase(_msg, _iface)
+{
+}
+
+//////////////////////////////////////////////////
+bool PoseCommand::Execute()
+{
+  auto poseMsg = dynamic_cast<const msgs::Pose *>(this->msg);
+  if (nullptr == poseMsg)
+  {
+    ignerr << "Internal error, null create message" << std::endl;
+    return false;
+  }
+
+  return setWorldPoseCmd(*poseMsg, this->iface, this->pose3Eql);
+}
+
+//////////////////////////////////////////////////
+PoseVectorCommand::PoseVectorCommand(msgs::Pose_V *_msg,
+    std::shared_ptr<UserCommandsInterface> &_iface)
+    : UserCommandBase(_msg, _iface)
+{
+}
+
+//////////////////////////////////////////////////
+bool PoseVectorCommand::Execute()
+{
+  auto poseVMsg = dynamic_cast<const msgs::Pose_V *>(this->msg);
+  if (nullptr == poseVMsg)
+  {
+    ignerr << "Internal error, null pose vector message" << std::endl;
+    return false;
+  }
+
+  auto pose3Eql = [](const math::Pose3d &_a, const math::Pose3d &_b)
+  {
+    return _a.Pos().Equal(_b.Pos(), 1e-6) &&
+      math::equal(_a.Rot().X(), _b.Rot().X(), 1e-6) &&
+      math::equal(_a.Rot().Y(), _b.Rot().Y(), 1e-6) &&
+      math::equal(_a.Rot().Z(), _b.Rot().Z(), 1e-6) &&
+      math::equal(_a.Rot().W(), _b.Rot().W(), 1e-6);
+  };
+
+  // Set the poses that can be set, even if some entities aren't found
+  bool result{true};
+  for (int i = 0; i < poseVMsg->pose_size(); ++i)
+  {
+    result = setWorldPoseCmd(poseVMsg->pose(i), this->iface, pose3Eql) &&
+        result;
+  }
+  return result;
+}
+
 //////////////////////////////////////////////////
 PhysicsCommand::PhysicsCommand(msgs::Physics *_msg,
     std::shared_ptr<UserCommandsInterface> &_iface)
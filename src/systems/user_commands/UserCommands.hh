@@ -44,6 +44,12 @@ namespace systems
   /// * **Request type*: ignition.msgs.EntityFactory
   /// * **Response type*: ignition.msgs.Boolean
   ///
+  /// Setting `clone_name` to the name of a top level entity spawns a copy
+  /// of it, copying its components instead of loading the SDF again, which
+  /// is much faster for spawning many copies of the same model. Copies are
+  /// renamed unless they're given a free name. Plugins of the original
+  /// aren't loaded for the copy.
+  ///
   /// # Spawn multiple entities
   ///
   /// This service can spawn multiple entities in the same iteration,
@@ -53,6 +59,22 @@ namespace systems
   /// * **Request type*: ignition.msgs.EntityFactory_V
   /// * **Response type*: ignition.msgs.Boolean
   ///
+  /// # Set entity pose
+  ///
+  /// * **Service**: `/world/<world name>/set_pose`
+  /// * **Request type*: ignition.msgs.Pose
+  /// * **Response type*: ignition.msgs.Boolean
+  ///
+  /// # Set multiple entity poses
+  ///
+  /// This service sets the poses of multiple entities in the same
+  /// iteration. Entities are given by id, or by name if they're direct
+  /// children of the world.
+  ///
+  /// * **Service**: `/world/<world name>/set_pose_vector`
+  /// * **Request type*: ignition.msgs.Pose_V
+  /// * **Response type*: ignition.msgs.Boolean
+  ///
   /// Try some examples described on examples/worlds/empty.sdf
   class UserCommands:
     public System,
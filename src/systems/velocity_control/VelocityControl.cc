@@ -15,12 +15,12 @@
  *
  */
 
-#include <mutex>
 #include <string>
 #include <vector>
 
 #include <ignition/common/Profiler.hh>
 #include <ignition/math/Vector3.hh>
+#include <ignition/msgs/Utility.hh>
 #include <ignition/plugin/Register.hh>
 #include <ignition/transport/Node.hh>
 
@@ -29,6 +29,8 @@
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/Util.hh"
 
+#include "../../CommandMailbox.hh"
+
 #include "VelocityControl.hh"
 
 using namespace ignition;
@@ -60,11 +62,19 @@ class ignition::gazebo::systems::VelocityControlPrivate
   /// \brief Model interface
   public: Model model{kNullEntity};
 
-  /// \brief Last target velocity requested.
-  public: msgs::Twist targetVel;
+  /// \brief Linear and angular target velocities of a command.
+  public: struct Command
+  {
+    /// \brief Linear velocity.
+    math::Vector3d linear{0, 0, 0};
+
+    /// \brief Angular velocity.
+    math::Vector3d angular{0, 0, 0};
+  };
 
-  /// \brief A mutex to protect the target velocity command.
-  public: std::mutex mutex;
+  /// \brief Last target velocity requested, posted by the transport thread
+  /// without waiting for the simulation thread.
+  public: CommandMailbox<Command> targetVel;
 };
 
 //////////////////////////////////////////////////
@@ -91,8 +101,6 @@ void VelocityControl::Configure(const Entity &_entity,
   if (_sdf->HasElement("initial_linear"))
   {
     this->dataPtr->linearVelocity = _sdf->Get<math::Vector3d>("initial_linear");
-    msgs::Set(this->dataPtr->targetVel.mutable_linear(),
-        this->dataPtr->linearVelocity);
     ignmsg << "Linear velocity initialized to ["
            << this->dataPtr->linearVelocity << "]" << std::endl;
   }
@@ -101,12 +109,13 @@ void VelocityControl::Configure(const Entity &_entity,
   {
     this->dataPtr->angularVelocity =
         _sdf->Get<math::Vector3d>("initial_angular");
-    msgs::Set(this->dataPtr->targetVel.mutable_angular(),
-        this->dataPtr->angularVelocity);
     ignmsg << "Angular velocity initialized to ["
            << this->dataPtr->angularVelocity << "]" << std::endl;
   }
 
+  this->dataPtr->targetVel.Post({this->dataPtr->linearVelocity,
+      this->dataPtr->angularVelocity});
+
   // Subscribe to commands
   std::vector<std::string> topics;
   if (_sdf->HasElement("topic"))
@@ -195,25 +204,18 @@ void VelocityControlPrivate::UpdateVelocity(
 {
   IGN_PROFILE("VeocityControl::UpdateVelocity");
 
-  double linVel;
-  double angVel;
-  {
-    std::lock_guard<std::mutex> lock(this->mutex);
-    linVel = this->targetVel.linear().x();
-    angVel = this->targetVel.angular().z();
-  }
+  if (!this->targetVel.Receive())
+    return;
 
-  this->linearVelocity = math::Vector3d(
-    linVel, this->targetVel.linear().y(), this->targetVel.linear().z());
-  this->angularVelocity = math::Vector3d(
-    this->targetVel.angular().x(), this->targetVel.angular().y(), angVel);
+  this->linearVelocity = this->targetVel.Latest().linear;
+  this->angularVelocity = this->targetVel.Latest().angular;
 }
 
 //////////////////////////////////////////////////
 void VelocityControlPrivate::OnCmdVel(const msgs::Twist &_msg)
 {
-  std::lock_guard<std::mutex> lock(this->mutex);
-  this->targetVel = _msg;
+  this->targetVel.Post({msgs::Convert(_msg.linear()),
+      msgs::Convert(_msg.angular())});
 }
 
 IGNITION_ADD_PLUGIN(VelocityControl,
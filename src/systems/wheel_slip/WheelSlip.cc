@@ -17,6 +17,9 @@
 
 #include "WheelSlip.hh"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
@@ -94,6 +97,10 @@ class ignition::gazebo::systems::WheelSlipPrivate
       /// \brief Wheel radius extracted from collision shape if not
       /// specified as xml parameter.
       public: double wheelRadius = 0;
+
+      /// \brief Spin speed the last slip command was computed from, negative
+      /// if no command was sent yet.
+      public: double commandedSpinSpeed = -1;
     };
 
   /// \brief The map relating links to their respective surface parameters.
@@ -117,6 +124,10 @@ class ignition::gazebo::systems::WheelSlipPrivate
                       return true;
                     }};
 
+  /// \brief Change of wheel spin speed, in rad/s, below which the last
+  /// slip command is kept instead of being recomputed.
+  public: double velocityTolerance{1e-3};
+
   public: bool validConfig{false};
   public: bool initialized{false};
 };
@@ -133,6 +144,12 @@ bool WheelSlipPrivate::Load(const EntityComponentManager &_ecm,
     return false;
   }
 
+  if (_sdf->HasElement("velocity_tolerance"))
+  {
+    this->velocityTolerance =
+        std::max(0.0, _sdf->Get<double>("velocity_tolerance"));
+  }
+
   // Read each wheel element
   for (auto wheelElem = _sdf->GetElement("wheel"); wheelElem;
       wheelElem = wheelElem->GetNextElement("wheel"))
@@ -242,9 +259,9 @@ bool WheelSlipPrivate::Load(const EntityComponentManager &_ecm,
 /////////////////////////////////////////////////
 void WheelSlipPrivate::Update(EntityComponentManager &_ecm)
 {
-  for (const auto &linkSurface : this->mapLinkSurfaceParams)
+  for (auto &linkSurface : this->mapLinkSurfaceParams)
   {
-    const auto &params = linkSurface.second;
+    auto &params = linkSurface.second;
 
     // get user-defined normal force constant
     double force = params.wheelNormalForce;
@@ -258,6 +275,17 @@ void WheelSlipPrivate::Update(EntityComponentManager &_ecm)
       continue;
     double spinAngularVelocity = spinAngularVelocityComp->Data()[0];
 
+    // Physics keeps the last command, so only send a new one when the
+    // resulting slip changes noticeably
+    const double spinSpeed = std::abs(spinAngularVelocity);
+    if (params.commandedSpinSpeed >= 0 &&
+        std::abs(spinSpeed - params.commandedSpinSpeed) <=
+        this->velocityTolerance)
+    {
+      continue;
+    }
+    params.commandedSpinSpeed = spinSpeed;
+
     // As discussed in WheelSlip.hh, the slip1 and slip2
     // parameters have units of inverse viscous damping:
     // [linear velocity / force] or [m / s / N].
@@ -275,23 +303,27 @@ void WheelSlipPrivate::Update(EntityComponentManager &_ecm)
     // The acceleration form is more well-behaved numerically at low-speed
     // and when the vehicle is at rest than the braking form,
     // so it is used for both slip directions.
-    double speed = params.wheelRadius * std::abs(spinAngularVelocity);
+    double speed = params.wheelRadius * spinSpeed;
     double slip1 = speed / force * params.slipComplianceLateral;
     double slip2 = speed / force * params.slipComplianceLongitudinal;
 
-    components::SlipComplianceCmd newSlipCmdComp({slip1, slip2});
+    std::vector<double> newSlipCmd{slip1, slip2};
 
     auto currSlipCmdComp =
         _ecm.Component<components::SlipComplianceCmd>(params.collision);
     if (currSlipCmdComp)
     {
-      *currSlipCmdComp = newSlipCmdComp;
-      _ecm.SetChanged(params.collision, components::SlipComplianceCmd::typeId,
-                      ComponentState::PeriodicChange);
+      if (currSlipCmdComp->SetData(newSlipCmd, this->vecEql))
+      {
+        _ecm.SetChanged(params.collision,
+            components::SlipComplianceCmd::typeId,
+            ComponentState::OneTimeChange);
+      }
     }
     else
     {
-      _ecm.CreateComponent(params.collision, newSlipCmdComp);
+      _ecm.CreateComponent(params.collision,
+          components::SlipComplianceCmd(newSlipCmd));
     }
   }
 }
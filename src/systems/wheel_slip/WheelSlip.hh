@@ -49,6 +49,9 @@ namespace systems
   /// the linear wheel spin velocity and divided by the wheel_normal_force
   /// parameter specified below in order to match the units of the
   /// slip parameters.
+  /// The slip parameters are only recomputed and sent to physics when the
+  /// wheel spin speed changed by more than the optional
+  /// `<velocity_tolerance>` (rad/s, default 1e-3) since they were last sent.
   ///
   /// A graphical interpretation of these parameters is provided below
   /// for a positive value of slip compliance.
@@ -21,6 +21,8 @@
 #include <ignition/msgs/boolean.pb.h>
 #include <ignition/msgs/entity_factory.pb.h>
 
+#include <chrono>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -34,6 +36,7 @@
 #include <ignition/sensors/Noise.hh>
 
 #include "ignition/gazebo/EntityComponentManager.hh"
+#include "ignition/gazebo/LevelOfDetail.hh"
 #include "ignition/gazebo/SdfEntityCreator.hh"
 
 #include "ignition/gazebo/components/Inertial.hh"
@@ -49,6 +52,8 @@
 
 #include "ignition/gazebo/Link.hh"
 
+#include "WindField.hh"
+
 using namespace ignition;
 using namespace gazebo;
 using namespace systems;
@@ -73,6 +78,13 @@ class ignition::gazebo::systems::WindEffectsPrivate
   public: void UpdateWindVelocity(const UpdateInfo &_info,
                                   EntityComponentManager &_ecm);
 
+  /// \brief Recompute the wind field grid from the current wind velocity,
+  /// if its update period elapsed.
+  /// \param[in] _info Simulation update info.
+  /// \param[in] _ecm Mutable reference to the EntityComponentManager.
+  public: void UpdateWindField(const UpdateInfo &_info,
+                               EntityComponentManager &_ecm);
+
   /// \brief Calculate and apply forces on links affected by wind.
   /// \param[in] _info Simulation update info.
   /// \param[in] _ecm Mutable reference to the EntityComponentManager.
@@ -145,6 +157,29 @@ class ignition::gazebo::systems::WindEffectsPrivate
   /// \brief Noise added to Z axis.
   public: sensors::NoisePtr noiseVertical;
 
+  /// \brief Wind velocities on a grid, sampled by links when <field> is
+  /// set.
+  public: wind_effects::WindField windField;
+
+  /// \brief Sim time between updates of the wind field.
+  public: std::chrono::steady_clock::duration fieldUpdatePeriod{
+      std::chrono::milliseconds(100)};
+
+  /// \brief Sim time of the last wind field update, unset until the first
+  /// one.
+  public: std::optional<std::chrono::steady_clock::duration>
+      lastFieldUpdate;
+
+  /// \brief Fraction of the wind velocity used as the amplitude of the
+  /// gusts travelling through the field.
+  public: double gustAmplitudePercent{0.0};
+
+  /// \brief Skips links which are far from performers.
+  public: LevelOfDetail levelOfDetail;
+
+  /// \brief Distance between gusts in the field.
+  public: double gustWavelength{10.0};
+
   /// \brief Ignition communication node.
   public: transport::Node node;
 
@@ -281,6 +316,52 @@ void WindEffectsPrivate::Load(EntityComponentManager &_ecm,
     }
   }
 
+  if (_sdf->HasElement("field"))
+  {
+    auto sdfField = _sdf->GetElementImpl("field");
+
+    if (!sdfField->HasElement("min") || !sdfField->HasElement("max"))
+    {
+      ignerr << "Please set <field><min> and <field><max>" << std::endl;
+      return;
+    }
+
+    double cellSize = sdfField->Get<double>("cell_size", 1.0).first;
+    if (!this->windField.Init(sdfField->Get<math::Vector3d>("min"),
+          sdfField->Get<math::Vector3d>("max"), cellSize))
+    {
+      ignerr << "Invalid <field>, <cell_size> must be greater than 0 and "
+             << "<max> must not be below <min>" << std::endl;
+      return;
+    }
+
+    double updateRate = sdfField->Get<double>("update_rate", 10.0).first;
+    if (updateRate > 0)
+    {
+      this->fieldUpdatePeriod =
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<double>(1.0 / updateRate));
+    }
+    else
+    {
+      this->fieldUpdatePeriod = std::chrono::steady_clock::duration::zero();
+    }
+
+    if (sdfField->HasElement("gust"))
+    {
+      auto sdfGust = sdfField->GetElementImpl("gust");
+      this->gustAmplitudePercent =
+          sdfGust->Get<double>("amplitude_percent", 0.0).first;
+      this->gustWavelength = sdfGust->Get<double>("wavelength", 10.0).first;
+      if (this->gustWavelength < 1e-6)
+      {
+        ignerr << "Please set <field><gust><wavelength> to a value greater "
+               << "than 0" << std::endl;
+        return;
+      }
+    }
+  }
+
   if (_sdf->HasElement("force_approximation_scaling_factor"))
   {
     sdf::ElementPtr sdfForceApprox =
@@ -404,7 +485,51 @@ void WindEffectsPrivate::UpdateWindVelocity(const UpdateInfo &_info,
 }
 
 //////////////////////////////////////////////////
-void WindEffectsPrivate::ApplyWindForce(const UpdateInfo &,
+void WindEffectsPrivate::UpdateWindField(const UpdateInfo &_info,
+                                         EntityComponentManager &_ecm)
+{
+  if (!this->windField.Valid())
+    return;
+
+  if (this->lastFieldUpdate &&
+      _info.simTime - *this->lastFieldUpdate < this->fieldUpdatePeriod &&
+      _info.simTime >= *this->lastFieldUpdate)
+  {
+    return;
+  }
+
+  IGN_PROFILE("WindEffectsPrivate::UpdateWindField");
+  auto windVel =
+      _ecm.Component<components::WorldLinearVelocity>(this->windEntity);
+  if (!windVel)
+    return;
+
+  this->lastFieldUpdate = _info.simTime;
+
+  // The gusts are a sinusoid along the horizontal wind direction which
+  // travels with the wind, so neighbouring links see the same gust shortly
+  // after each other.
+  const math::Vector3d vel = windVel->Data();
+  math::Vector3d dir(vel.X(), vel.Y(), 0);
+  const double speed = dir.Length();
+  if (speed > 1e-6)
+    dir /= speed;
+
+  const double simTime = std::chrono::duration<double>(_info.simTime).count();
+  const double k = 2 * IGN_PI / this->gustWavelength;
+  const double amplitude = this->gustAmplitudePercent;
+
+  this->windField.Update([&](const math::Vector3d &_pos)
+  {
+    if (std::abs(amplitude) < 1e-9)
+      return vel;
+    return vel * (1.0 + amplitude * std::sin(k * (dir.Dot(_pos) -
+        speed * simTime)));
+  });
+}
+
+//////////////////////////////////////////////////
+void WindEffectsPrivate::ApplyWindForce(const UpdateInfo &_info,
                                         EntityComponentManager &_ecm)
 {
   IGN_PROFILE("WindEffectsPrivate::ApplyWindForce");
@@ -413,6 +538,9 @@ void WindEffectsPrivate::ApplyWindForce(const UpdateInfo &,
   if (!windVel)
     return;
 
+  const bool useField = this->windField.Valid();
+  this->levelOfDetail.Update(_info, _ecm);
+
   Link link;
 
   _ecm.Each<components::Link, components::Inertial, components::WindMode,
@@ -429,11 +557,29 @@ void WindEffectsPrivate::ApplyWindForce(const UpdateInfo &,
           return true;
         }
 
+        // Skip links far from performers
+        if (!this->levelOfDetail.Near(_ecm, _entity))
+        {
+          return true;
+        }
+
         link.ResetEntity(_entity);
 
+        // Sample the wind field at the link, the world pose is populated by
+        // physics because it's created along with the link velocity.
+        math::Vector3d linkWindVel = windVel->Data();
+        if (useField)
+        {
+          auto state = _ecm.CachedLinkState(_entity);
+          std::optional<math::Pose3d> worldPose = state ? state->worldPose :
+              _ecm.ComponentData<components::WorldPose>(_entity);
+          if (worldPose)
+            linkWindVel = this->windField.Sample(worldPose->Pos());
+        }
+
         math::Vector3d windForce = _inertial->Data().MassMatrix().Mass() *
                                    this->forceApproximationScalingFactor *
-                                   (windVel->Data() - _linkVel->Data());
+                                   (linkWindVel - _linkVel->Data());
 
         // Apply force at center of mass
         link.AddWorldForce(_ecm, windForce);
@@ -504,6 +650,7 @@ void WindEffects::Configure(const Entity &_entity,
   this->dataPtr->worldEntity = _entity;
 
   this->dataPtr->Load(_ecm, _sdf);
+  this->dataPtr->levelOfDetail.Load(_sdf->GetElementImpl("level_of_detail"));
 
   if (this->dataPtr->validConfig)
   {
@@ -571,6 +718,7 @@ void WindEffects::PreUpdate(const UpdateInfo &_info,
               {
                 _ecm.CreateComponent(_entity, components::WorldPose());
               }
+              _ecm.TrackLinkState(_entity);
             }
             return true;
           });
@@ -586,6 +734,7 @@ void WindEffects::PreUpdate(const UpdateInfo &_info,
         return;
 
       this->dataPtr->UpdateWindVelocity(_info, _ecm);
+      this->dataPtr->UpdateWindField(_info, _ecm);
       this->dataPtr->ApplyWindForce(_info, _ecm);
     }
   }
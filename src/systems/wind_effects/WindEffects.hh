@@ -86,6 +86,32 @@ namespace systems
   /// <vertical><noise>
   /// Parameters for the noise that is added to the vertical wind velocity
   /// magnitude.
+  ///
+  /// <field><min>, <field><max>
+  /// Optional. Corners of a box in the world frame on which the wind is
+  /// stored as a grid of velocities. The grid is recomputed at a low rate,
+  /// and each link samples it at its position by trilinear interpolation.
+  /// Links outside the box use the value on its boundary. Without <field>
+  /// all links use the same wind velocity.
+  ///
+  /// <field><cell_size>
+  /// Distance between grid nodes, defaults to 1m.
+  ///
+  /// <field><update_rate>
+  /// Rate in Hz of sim time at which the grid is recomputed, defaults to 10.
+  /// Zero recomputes it every iteration.
+  ///
+  /// <field><gust><amplitude_percent>
+  /// Fraction of the wind velocity that is set to be the amplitude of gusts
+  /// travelling through the grid along the horizontal wind direction.
+  ///
+  /// <field><gust><wavelength>
+  /// Distance between gusts, defaults to 10m.
+  ///
+  /// <level_of_detail><distance>
+  /// Optional. Links further than this distance from all performers, and
+  /// outside the levels performers are in, are not affected by the wind.
+  /// Defaults to 0, which affects all links.
   class WindEffects:
     public System,
     public ISystemConfigure,
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef IGNITION_GAZEBO_SYSTEMS_WIND_EFFECTS_WINDFIELD_HH_
+#define IGNITION_GAZEBO_SYSTEMS_WIND_EFFECTS_WINDFIELD_HH_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <ignition/math/Vector3.hh>
+
+#include "ignition/gazebo/config.hh"
+
+namespace ignition::gazebo
+{
+inline namespace IGNITION_GAZEBO_VERSION_NAMESPACE {
+namespace systems::wind_effects
+{
+  /// \brief Wind velocities stored on the nodes of a regular 3D grid.
+  /// The node values are recomputed at a low rate through Update, and
+  /// sampled at any position by trilinear interpolation, so the cost per
+  /// sample doesn't depend on the wind model. Positions outside the grid
+  /// are clamped to its boundary.
+  class WindField
+  {
+    /// \brief Set the extent of the grid. The node values are reset to
+    /// zero.
+    /// \param[in] _min Minimum corner of the grid in the world frame.
+    /// \param[in] _max Maximum corner of the grid in the world frame.
+    /// \param[in] _cellSize Distance between nodes along each axis. The
+    /// grid is extended so that it covers _max.
+    /// \return True if the grid is valid, false if _cellSize isn't positive
+    /// or _max is below _min along an axis.
+    public: bool Init(const math::Vector3d &_min, const math::Vector3d &_max,
+                      double _cellSize)
+    {
+      this->values.clear();
+      if (!(_cellSize > 0) || _max.X() < _min.X() || _max.Y() < _min.Y() ||
+          _max.Z() < _min.Z())
+      {
+        return false;
+      }
+
+      this->min = _min;
+      this->cellSize = _cellSize;
+      auto nodes = [_cellSize](double _low, double _high)
+      {
+        return static_cast<std::size_t>(
+            std::ceil((_high - _low) / _cellSize - 1e-9)) + 1;
+      };
+      this->nx = nodes(_min.X(), _max.X());
+      this->ny = nodes(_min.Y(), _max.Y());
+      this->nz = nodes(_min.Z(), _max.Z());
+      this->values.resize(this->nx * this->ny * this->nz);
+      return true;
+    }
+
+    /// \brief Whether Init succeeded.
+    /// \return True if the grid has nodes.
+    public: bool Valid() const
+    {
+      return !this->values.empty();
+    }
+
+    /// \brief Number of nodes in the grid.
+    /// \return Number of nodes.
+    public: std::size_t NodeCount() const
+    {
+      return this->values.size();
+    }
+
+    /// \brief Recompute the value of every node.
+    /// \param[in] _fn Function that takes the world position of a node and
+    /// returns the wind velocity there.
+    public: template <typename Fn>
+            void Update(Fn &&_fn)
+    {
+      std::size_t index = 0;
+      for (std::size_t k = 0; k < this->nz; ++k)
+      {
+        for (std::size_t j = 0; j < this->ny; ++j)
+        {
+          for (std::size_t i = 0; i < this->nx; ++i)
+          {
+            this->values[index++] = _fn(this->min + math::Vector3d(
+                i * this->cellSize, j * this->cellSize, k * this->cellSize));
+          }
+        }
+      }
+    }
+
+    /// \brief Interpolate the wind velocity at a position.
+    /// \param[in] _pos Position in the world frame.
+    /// \return Wind velocity, or zero if the grid isn't valid.
+    public: math::Vector3d Sample(const math::Vector3d &_pos) const
+    {
+      if (this->values.empty())
+        return math::Vector3d::Zero;
+
+      // Cell containing the position along one axis, and the normalized
+      // offset inside that cell.
+      auto locate = [this](double _p, double _low, std::size_t _n,
+                           std::size_t &_cell, double &_t)
+      {
+        double g = std::clamp((_p - _low) / this->cellSize, 0.0,
+            static_cast<double>(_n - 1));
+        _cell = std::min(static_cast<std::size_t>(g), _n > 1 ? _n - 2 : 0);
+        _t = _n > 1 ? g - _cell : 0.0;
+      };
+
+      std::size_t i, j, k;
+      double tx, ty, tz;
+      locate(_pos.X(), this->min.X(), this->nx, i, tx);
+      locate(_pos.Y(), this->min.Y(), this->ny, j, ty);
+      locate(_pos.Z(), this->min.Z(), this->nz, k, tz);
+
+      // Offsets to the next node along each axis, zero on degenerate axes
+      const std::size_t di = this->nx > 1 ? 1 : 0;
+      const std::size_t dj = this->ny > 1 ? this->nx : 0;
+      const std::size_t dk = this->nz > 1 ? this->nx * this->ny : 0;
+      const std::size_t base = i + this->nx * (j + this->ny * k);
+
+      auto lerp = [](const math::Vector3d &_a, const math::Vector3d &_b,
+                     double _t)
+      {
+        return _a + (_b - _a) * _t;
+      };
+
+      const auto &v = this->values;
+      math::Vector3d c00 = lerp(v[base], v[base + di], tx);
+      math::Vector3d c10 = lerp(v[base + dj], v[base + dj + di], tx);
+      math::Vector3d c01 = lerp(v[base + dk], v[base + dk + di], tx);
+      math::Vector3d c11 =
+          lerp(v[base + dk + dj], v[base + dk + dj + di], tx);
+      return lerp(lerp(c00, c10, ty), lerp(c01, c11, ty), tz);
+    }
+
+    /// \brief Minimum corner of the grid.
+    private: math::Vector3d min;
+
+    /// \brief Distance between nodes.
+    private: double cellSize{1.0};
+
+    /// \brief Number of nodes along each axis.
+    private: std::size_t nx{0}, ny{0}, nz{0};
+
+    /// \brief Node values, with x varying fastest.
+    private: std::vector<math::Vector3d> values;
+  };
+}
+}
+}
+#endif
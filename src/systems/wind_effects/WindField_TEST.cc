@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include "WindField.hh"
+
+using namespace ignition;
+using namespace gazebo::systems::wind_effects;
+
+/////////////////////////////////////////////////
+TEST(WindFieldTest, Init)
+{
+  WindField field;
+  EXPECT_FALSE(field.Valid());
+  EXPECT_EQ(math::Vector3d::Zero, field.Sample({1, 2, 3}));
+
+  EXPECT_FALSE(field.Init({0, 0, 0}, {1, 1, 1}, 0.0));
+  EXPECT_FALSE(field.Init({0, 0, 0}, {1, -1, 1}, 1.0));
+  EXPECT_FALSE(field.Valid());
+
+  EXPECT_TRUE(field.Init({0, 0, 0}, {2, 1, 0}, 1.0));
+  EXPECT_TRUE(field.Valid());
+  EXPECT_EQ(3u * 2u * 1u, field.NodeCount());
+
+  // The grid is extended to cover the maximum corner
+  EXPECT_TRUE(field.Init({0, 0, 0}, {2.5, 1, 1}, 1.0));
+  EXPECT_EQ(4u * 2u * 2u, field.NodeCount());
+}
+
+/////////////////////////////////////////////////
+TEST(WindFieldTest, TrilinearSample)
+{
+  WindField field;
+  ASSERT_TRUE(field.Init({-1, -1, 0}, {1, 1, 2}, 0.5));
+
+  // A linear field is reproduced exactly by trilinear interpolation
+  auto linear = [](const math::Vector3d &_p)
+  {
+    return math::Vector3d(2 * _p.X() + 1, _p.Y() - _p.Z(), 3 * _p.Z());
+  };
+  field.Update(linear);
+
+  for (const auto &p : {math::Vector3d(0, 0, 0), math::Vector3d(0.3, -0.7, 1.1),
+       math::Vector3d(-1, 1, 2), math::Vector3d(0.99, 0.01, 0.26)})
+  {
+    auto sample = field.Sample(p);
+    auto expected = linear(p);
+    EXPECT_NEAR(expected.X(), sample.X(), 1e-9) << p;
+    EXPECT_NEAR(expected.Y(), sample.Y(), 1e-9) << p;
+    EXPECT_NEAR(expected.Z(), sample.Z(), 1e-9) << p;
+  }
+
+  // Positions outside the grid are clamped to its boundary
+  EXPECT_EQ(field.Sample({1, 1, 2}), field.Sample({5, 3, 10}));
+  EXPECT_EQ(field.Sample({-1, 0, 0}), field.Sample({-4, 0, -1}));
+}
+
+/////////////////////////////////////////////////
+TEST(WindFieldTest, FlatGrid)
+{
+  // A grid with a single node along z still interpolates in x and y
+  WindField field;
+  ASSERT_TRUE(field.Init({0, 0, 5}, {1, 1, 5}, 1.0));
+  EXPECT_EQ(4u, field.NodeCount());
+  field.Update([](const math::Vector3d &_p)
+  {
+    return math::Vector3d(_p.X() + _p.Y(), 0, _p.Z());
+  });
+  auto sample = field.Sample({0.25, 0.5, 0});
+  EXPECT_NEAR(0.75, sample.X(), 1e-9);
+  EXPECT_NEAR(5.0, sample.Z(), 1e-9);
+}
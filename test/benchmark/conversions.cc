@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <ignition/msgs/light.pb.h>
+#include <ignition/msgs/visual.pb.h>
+#include <ignition/msgs/Utility.hh>
+#include <sdf/Box.hh>
+#include <sdf/Geometry.hh>
+#include <sdf/Light.hh>
+#include <sdf/Material.hh>
+#include <sdf/Mesh.hh>
+
+#include "ignition/gazebo/Conversions.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+constexpr const int kConversions {1000};
+
+/// \brief Conversions of the message types sent for every visual and light.
+class ConversionsFixture: public benchmark::Fixture
+{
+  protected: void SetUp(const ::benchmark::State &) override
+  {
+    sdf::Box box;
+    box.SetSize(math::Vector3d(1, 2, 3));
+    this->boxGeometry.SetType(sdf::GeometryType::BOX);
+    this->boxGeometry.SetBoxShape(box);
+
+    sdf::Mesh mesh;
+    mesh.SetUri("file:///path/to/some/mesh/with/a/long/name.dae");
+    mesh.SetSubmesh("submesh");
+    this->meshGeometry.SetType(sdf::GeometryType::MESH);
+    this->meshGeometry.SetMeshShape(mesh);
+
+    this->material.SetAmbient(math::Color(0.1f, 0.2f, 0.3f, 1.0f));
+    this->material.SetDiffuse(math::Color(0.4f, 0.5f, 0.6f, 1.0f));
+
+    this->light.SetName("a_light_with_a_long_enough_name");
+    this->light.SetType(sdf::LightType::SPOT);
+    this->light.SetRawPose(math::Pose3d(1, 2, 3, 0, 0, 1));
+  }
+
+  protected: sdf::Geometry boxGeometry;
+  protected: sdf::Geometry meshGeometry;
+  protected: sdf::Material material;
+  protected: sdf::Light light;
+};
+
+BENCHMARK_DEFINE_F(ConversionsFixture, GeometryConvert)
+(benchmark::State &_st)
+{
+  const auto &geometry = _st.range(0) ? this->meshGeometry : this->boxGeometry;
+  msgs::Visual visual;
+  for (auto _ : _st)
+  {
+    for (int i = 0; i < kConversions; ++i)
+    {
+      visual.mutable_geometry()->CopyFrom(convert<msgs::Geometry>(geometry));
+      benchmark::DoNotOptimize(visual);
+    }
+  }
+}
+
+BENCHMARK_DEFINE_F(ConversionsFixture, GeometrySet)
+(benchmark::State &_st)
+{
+  const auto &geometry = _st.range(0) ? this->meshGeometry : this->boxGeometry;
+  msgs::Visual visual;
+  for (auto _ : _st)
+  {
+    for (int i = 0; i < kConversions; ++i)
+    {
+      set(visual.mutable_geometry(), geometry);
+      benchmark::DoNotOptimize(visual);
+    }
+  }
+}
+
+BENCHMARK_DEFINE_F(ConversionsFixture, MaterialConvert)
+(benchmark::State &_st)
+{
+  msgs::Visual visual;
+  for (auto _ : _st)
+  {
+    for (int i = 0; i < kConversions; ++i)
+    {
+      visual.mutable_material()->CopyFrom(
+          convert<msgs::Material>(this->material));
+      benchmark::DoNotOptimize(visual);
+    }
+  }
+}
+
+BENCHMARK_DEFINE_F(ConversionsFixture, MaterialSet)
+(benchmark::State &_st)
+{
+  msgs::Visual visual;
+  for (auto _ : _st)
+  {
+    for (int i = 0; i < kConversions; ++i)
+    {
+      set(visual.mutable_material(), this->material);
+      benchmark::DoNotOptimize(visual);
+    }
+  }
+}
+
+BENCHMARK_DEFINE_F(ConversionsFixture, LightConvert)
+(benchmark::State &_st)
+{
+  msgs::Light lightMsg;
+  for (auto _ : _st)
+  {
+    for (int i = 0; i < kConversions; ++i)
+    {
+      lightMsg.CopyFrom(convert<msgs::Light>(this->light));
+      benchmark::DoNotOptimize(lightMsg);
+    }
+  }
+}
+
+BENCHMARK_DEFINE_F(ConversionsFixture, LightSet)
+(benchmark::State &_st)
+{
+  msgs::Light lightMsg;
+  for (auto _ : _st)
+  {
+    for (int i = 0; i < kConversions; ++i)
+    {
+      set(&lightMsg, this->light);
+      benchmark::DoNotOptimize(lightMsg);
+    }
+  }
+}
+
+BENCHMARK_DEFINE_F(ConversionsFixture, PoseConvert)
+(benchmark::State &_st)
+{
+  const math::Pose3d pose(1, 2, 3, 0.1, 0.2, 0.3);
+  msgs::Visual visual;
+  for (auto _ : _st)
+  {
+    for (int i = 0; i < kConversions; ++i)
+    {
+      visual.mutable_pose()->CopyFrom(msgs::Convert(pose));
+      benchmark::DoNotOptimize(visual);
+    }
+  }
+}
+
+BENCHMARK_DEFINE_F(ConversionsFixture, PoseSet)
+(benchmark::State &_st)
+{
+  const math::Pose3d pose(1, 2, 3, 0.1, 0.2, 0.3);
+  msgs::Visual visual;
+  for (auto _ : _st)
+  {
+    for (int i = 0; i < kConversions; ++i)
+    {
+      msgs::Set(visual.mutable_pose(), pose);
+      benchmark::DoNotOptimize(visual);
+    }
+  }
+}
+
+// Argument 0 converts a box, 1 a mesh, which has strings
+BENCHMARK_REGISTER_F(ConversionsFixture, GeometryConvert)
+  ->Arg(0)
+  ->Arg(1)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ConversionsFixture, GeometrySet)
+  ->Arg(0)
+  ->Arg(1)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ConversionsFixture, MaterialConvert)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ConversionsFixture, MaterialSet)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ConversionsFixture, LightConvert)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ConversionsFixture, LightSet)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ConversionsFixture, PoseConvert)
+  ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(ConversionsFixture, PoseSet)
+  ->Unit(benchmark::kMicrosecond);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
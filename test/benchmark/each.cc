@@ -359,6 +359,79 @@ BENCHMARK_DEFINE_F(ManyComponentFixture, Each10ComponentNoCache)
   }
 }
 
+BENCHMARK_DEFINE_F(ManyComponentFixture, Each5ComponentStdFunction)
+(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    auto entityCount = _st.range(0);
+
+    for (int eachIter = 0; eachIter < kEachIterations; eachIter++)
+    {
+      int entitiesMatched = 0;
+
+      // Same as Each5ComponentCache, but through the type-erased overload
+      std::function<bool(const Entity &,
+                         const Name *,
+                         const AngularVelocity *,
+                         const Inertial *,
+                         const LinearAcceleration *,
+                         const LinearVelocity *)> f =
+          [&](const Entity &,
+              const Name *,
+              const AngularVelocity *,
+              const Inertial *,
+              const LinearAcceleration *,
+              const LinearVelocity *)->bool
+          {
+            entitiesMatched++;
+            return true;
+          };
+
+      mgr->Each<Name,
+                AngularVelocity,
+                Inertial,
+                LinearAcceleration,
+                LinearVelocity>(f);
+
+      if (entitiesMatched != entityCount)
+      {
+        _st.SkipWithError("Failed to match correct number of entities");
+      }
+    }
+  }
+}
+
+BENCHMARK_DEFINE_F(ManyComponentFixture, Each5ComponentView)
+(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    auto entityCount = _st.range(0);
+
+    for (int eachIter = 0; eachIter < kEachIterations; eachIter++)
+    {
+      int entitiesMatched = 0;
+
+      for (auto [entity, name, angVel, inertial, linAcc, linVel] :
+          static_cast<const EntityComponentManager *>(mgr.get())->View<Name,
+              AngularVelocity,
+              Inertial,
+              LinearAcceleration,
+              LinearVelocity>())
+      {
+        if (nullptr != name && nullptr != linVel)
+          entitiesMatched++;
+      }
+
+      if (entitiesMatched != entityCount)
+      {
+        _st.SkipWithError("Failed to match correct number of entities");
+      }
+    }
+  }
+}
+
 /// Method to generate test argument combinations.  google/benchmark does
 /// powers of 2 by default, which looks kind of ugly.
 static void EachTestArgs(benchmark::internal::Benchmark *_b)
@@ -410,6 +483,18 @@ BENCHMARK_REGISTER_F(ManyComponentFixture, Each5ComponentCache)
   ->Arg(1000)
   ->Unit(benchmark::kMillisecond);
 
+BENCHMARK_REGISTER_F(ManyComponentFixture, Each5ComponentStdFunction)
+  ->Arg(10)
+  ->Arg(100)
+  ->Arg(1000)
+  ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_REGISTER_F(ManyComponentFixture, Each5ComponentView)
+  ->Arg(10)
+  ->Arg(100)
+  ->Arg(1000)
+  ->Unit(benchmark::kMillisecond);
+
 BENCHMARK_REGISTER_F(ManyComponentFixture, Each10ComponentNoCache)
   ->Arg(10)
   ->Arg(100)
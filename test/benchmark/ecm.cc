@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ignition/msgs/serialized_map.pb.h>
+
+#include "ignition/gazebo/Entity.hh"
+#include "ignition/gazebo/EntityComponentManager.hh"
+
+#include "ignition/gazebo/components/AngularVelocity.hh"
+#include "ignition/gazebo/components/Inertial.hh"
+#include "ignition/gazebo/components/LinearVelocity.hh"
+#include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/Pose.hh"
+
+using namespace ignition;
+using namespace gazebo;
+using namespace components;
+
+/// \brief Entities per model, the model itself and its children.
+constexpr const int kModelSize {10};
+
+/// \brief Lookups per EntityByComponents iteration.
+constexpr const int kLookupIterations {100};
+
+/// \brief Exposes the steps the simulation runner takes between iterations.
+class BenchmarkEcm : public EntityComponentManager
+{
+  public: using EntityComponentManager::ClearNewlyCreatedEntities;
+  public: using EntityComponentManager::ProcessRemoveEntityRequests;
+  public: using EntityComponentManager::SetAllComponentsUnchanged;
+};
+
+/// \brief Create entities grouped into models. Each entity has the same 5
+/// components and a unique name.
+/// \param[in] _ecm Manager to populate.
+/// \param[in] _entityCount Number of entities to create.
+/// \return The model entities.
+std::vector<Entity> Populate(BenchmarkEcm &_ecm, int _entityCount)
+{
+  std::vector<Entity> models;
+  Entity model{kNullEntity};
+  for (int i = 0; i < _entityCount; ++i)
+  {
+    Entity entity = _ecm.CreateEntity();
+    _ecm.CreateComponent(entity, Name("entity_" + std::to_string(i)));
+    _ecm.CreateComponent(entity, Pose());
+    _ecm.CreateComponent(entity, LinearVelocity());
+    _ecm.CreateComponent(entity, AngularVelocity());
+    _ecm.CreateComponent(entity, Inertial());
+
+    if (i % kModelSize == 0)
+    {
+      _ecm.CreateComponent(entity, Model());
+      model = entity;
+      models.push_back(model);
+    }
+    else
+    {
+      _ecm.SetParentEntity(entity, model);
+    }
+  }
+  _ecm.ClearNewlyCreatedEntities();
+  _ecm.SetAllComponentsUnchanged();
+  return models;
+}
+
+class EcmFixture: public benchmark::Fixture
+{
+  protected: void SetUp(const ::benchmark::State &_state) override
+  {
+    this->mgr = std::make_unique<BenchmarkEcm>();
+    this->entityCount = static_cast<int>(_state.range(0));
+    this->models = Populate(*this->mgr, this->entityCount);
+  }
+
+  protected: void TearDown(const ::benchmark::State &) override
+  {
+    this->mgr.reset();
+  }
+
+  /// \brief Count the entities matched by Each.
+  /// \param[in] _st Benchmark state, to report a wrong count.
+  protected: template<typename ...ComponentTypeTs>
+             void EachCount(benchmark::State &_st)
+  {
+    int entitiesMatched = 0;
+    this->mgr->Each<ComponentTypeTs...>(
+        [&](const Entity &, const ComponentTypeTs *...)->bool
+        {
+          entitiesMatched++;
+          return true;
+        });
+
+    if (entitiesMatched != this->entityCount)
+      _st.SkipWithError("Failed to match correct number of entities");
+  }
+
+  protected: std::unique_ptr<BenchmarkEcm> mgr;
+
+  protected: std::vector<Entity> models;
+
+  protected: int entityCount{0};
+};
+
+BENCHMARK_DEFINE_F(EcmFixture, CreateEntities)(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    _st.PauseTiming();
+    this->mgr = std::make_unique<BenchmarkEcm>();
+    _st.ResumeTiming();
+
+    Populate(*this->mgr, this->entityCount);
+
+    // Destruction isn't part of the measurement
+    _st.PauseTiming();
+    this->mgr.reset();
+    _st.ResumeTiming();
+  }
+  _st.SetItemsProcessed(_st.iterations() * this->entityCount);
+}
+
+BENCHMARK_DEFINE_F(EcmFixture, RemoveEntitiesRecursive)(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    _st.PauseTiming();
+    this->mgr = std::make_unique<BenchmarkEcm>();
+    this->models = Populate(*this->mgr, this->entityCount);
+    _st.ResumeTiming();
+
+    // Removing a model removes its children too
+    for (const Entity model : this->models)
+      this->mgr->RequestRemoveEntity(model, true);
+    this->mgr->ProcessRemoveEntityRequests();
+
+    if (this->mgr->EntityCount() != 0u)
+      _st.SkipWithError("Failed to remove all entities");
+  }
+  _st.SetItemsProcessed(_st.iterations() * this->entityCount);
+}
+
+BENCHMARK_DEFINE_F(EcmFixture, Each1Component)(benchmark::State &_st)
+{
+  for (auto _ : _st)
+    this->EachCount<Name>(_st);
+  _st.SetItemsProcessed(_st.iterations() * this->entityCount);
+}
+
+BENCHMARK_DEFINE_F(EcmFixture, Each2Components)(benchmark::State &_st)
+{
+  for (auto _ : _st)
+    this->EachCount<Name, Pose>(_st);
+  _st.SetItemsProcessed(_st.iterations() * this->entityCount);
+}
+
+BENCHMARK_DEFINE_F(EcmFixture, Each3Components)(benchmark::State &_st)
+{
+  for (auto _ : _st)
+    this->EachCount<Name, Pose, LinearVelocity>(_st);
+  _st.SetItemsProcessed(_st.iterations() * this->entityCount);
+}
+
+BENCHMARK_DEFINE_F(EcmFixture, Each4Components)(benchmark::State &_st)
+{
+  for (auto _ : _st)
+    this->EachCount<Name, Pose, LinearVelocity, AngularVelocity>(_st);
+  _st.SetItemsProcessed(_st.iterations() * this->entityCount);
+}
+
+BENCHMARK_DEFINE_F(EcmFixture, Each5Components)(benchmark::State &_st)
+{
+  for (auto _ : _st)
+  {
+    this->EachCount<Name, Pose, LinearVelocity, AngularVelocity, Inertial>(
+        _st);
+  }
+  _st.SetItemsProcessed(_st.iterations() * this->entityCount);
+}
+
+BENCHMARK_DEFINE_F(EcmFixture, EntityByComponents)(benchmark::State &_st)
+{
+  // Look up names spread over the whole world
+  std::vector<std::string> names;
+  for (int i = 0; i < kLookupIterations; ++i)
+  {
+    names.push_back("entity_" +
+        std::to_string(i * this->entityCount / kLookupIterations));
+  }
+
+  for (auto _ : _st)
+  {
+    for (const auto &name : names)
+    {
+      Entity entity = this->mgr->EntityByComponents(Name(name));
+      if (entity == kNullEntity)
+        _st.SkipWithError("Failed to find entity");
+      benchmark::DoNotOptimize(entity);
+    }
+  }
+  _st.SetItemsProcessed(_st.iterations() * kLookupIterations);
+}
+
+BENCHMARK_DEFINE_F(EcmFixture, SetChanged)(benchmark::State &_st)
+{
+  std::vector<Entity> entities;
+  this->mgr->Each<Pose>([&](const Entity &_entity, const Pose *)->bool
+      {
+        entities.push_back(_entity);
+        return true;
+      });
+
+  for (auto _ : _st)
+  {
+    for (const Entity entity : entities)
+    {
+      this->mgr->SetChanged(entity, Pose::typeId,
+          ComponentState::PeriodicChange);
+    }
+    _st.PauseTiming();
+    this->mgr->SetAllComponentsUnchanged();
+    _st.ResumeTiming();
+  }
+  _st.SetItemsProcessed(_st.iterations() * this->entityCount);
+}
+
+BENCHMARK_DEFINE_F(EcmFixture, ChangedState)(benchmark::State &_st)
+{
+  // One in ten poses changed, as when a few models move
+  int index = 0;
+  this->mgr->Each<Pose>([&](const Entity &_entity, const Pose *)->bool
+      {
+        if (index++ % 10 == 0)
+        {
+          this->mgr->SetChanged(_entity, Pose::typeId,
+              ComponentState::PeriodicChange);
+        }
+        return true;
+      });
+
+  for (auto _ : _st)
+  {
+    msgs::SerializedStateMap state;
+    this->mgr->ChangedState(state);
+    benchmark::DoNotOptimize(state);
+  }
+  _st.SetItemsProcessed(_st.iterations() * this->entityCount);
+}
+
+BENCHMARK_DEFINE_F(EcmFixture, SetState)(benchmark::State &_st)
+{
+  msgs::SerializedStateMap state;
+  this->mgr->State(state, {}, {}, true);
+
+  for (auto _ : _st)
+  {
+    this->mgr->SetState(state);
+    _st.PauseTiming();
+    this->mgr->SetAllComponentsUnchanged();
+    _st.ResumeTiming();
+  }
+  _st.SetItemsProcessed(_st.iterations() * this->entityCount);
+}
+
+BENCHMARK_DEFINE_F(EcmFixture, RebuildViews)(benchmark::State &_st)
+{
+  // Create the views used by the Each benchmarks
+  this->EachCount<Name>(_st);
+  this->EachCount<Name, Pose>(_st);
+  this->EachCount<Name, Pose, LinearVelocity>(_st);
+  this->EachCount<Name, Pose, LinearVelocity, AngularVelocity>(_st);
+  this->EachCount<Name, Pose, LinearVelocity, AngularVelocity, Inertial>(
+      _st);
+
+  for (auto _ : _st)
+    this->mgr->RebuildViews();
+  _st.SetItemsProcessed(_st.iterations() * this->entityCount);
+}
+
+/// Method to generate the world sizes.
+static void WorldSizes(benchmark::internal::Benchmark *_b)
+{
+  _b->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_REGISTER_F(EcmFixture, CreateEntities)->Apply(WorldSizes);
+BENCHMARK_REGISTER_F(EcmFixture, RemoveEntitiesRecursive)->Apply(WorldSizes);
+BENCHMARK_REGISTER_F(EcmFixture, Each1Component)->Apply(WorldSizes);
+BENCHMARK_REGISTER_F(EcmFixture, Each2Components)->Apply(WorldSizes);
+BENCHMARK_REGISTER_F(EcmFixture, Each3Components)->Apply(WorldSizes);
+BENCHMARK_REGISTER_F(EcmFixture, Each4Components)->Apply(WorldSizes);
+BENCHMARK_REGISTER_F(EcmFixture, Each5Components)->Apply(WorldSizes);
+BENCHMARK_REGISTER_F(EcmFixture, EntityByComponents)->Apply(WorldSizes);
+BENCHMARK_REGISTER_F(EcmFixture, SetChanged)->Apply(WorldSizes);
+BENCHMARK_REGISTER_F(EcmFixture, ChangedState)->Apply(WorldSizes);
+BENCHMARK_REGISTER_F(EcmFixture, SetState)->Apply(WorldSizes);
+BENCHMARK_REGISTER_F(EcmFixture, RebuildViews)->Apply(WorldSizes);
+
+// OSX needs the semicolon, Ubuntu complains that there's an extra ';'
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+BENCHMARK_MAIN();
+#pragma GCC diagnostic pop
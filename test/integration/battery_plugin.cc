@@ -17,6 +17,7 @@
 
 #include <gtest/gtest.h>
 
+#include <map>
 #include <string>
 
 #include <ignition/common/Battery.hh>
@@ -34,9 +35,12 @@
 #include "ignition/gazebo/test_config.hh"
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/components/BatterySoC.hh"
+#include "ignition/gazebo/components/Joint.hh"
+#include "ignition/gazebo/components/JointVelocityCmd.hh"
 #include "ignition/gazebo/components/Link.hh"
 #include "ignition/gazebo/components/Model.hh"
 #include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
 
 #include "plugins/MockSystem.hh"
 
@@ -152,3 +156,67 @@ TEST_F(BatteryPluginTest, SingleBattery)
       });
   EXPECT_EQ(batCount, 1);
 }
+
+/////////////////////////////////////////////////
+// A battery updated at a rate drains like one updated every step, while
+// only writing its state of charge a few times
+TEST_F(BatteryPluginTest, SocUpdateRate)
+{
+  const auto sdfPath = common::joinPaths(std::string(PROJECT_SOURCE_PATH),
+    "test", "worlds", "battery_soc_update_rate.sdf");
+
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(sdfPath);
+
+  auto battery = [](const EntityComponentManager &_ecm,
+      const std::string &_model)
+  {
+    Entity model = _ecm.EntityByComponents(components::Model(),
+        components::Name(_model));
+    return _ecm.EntityByComponents(components::Name("linear_battery"),
+        components::ParentEntity(model));
+  };
+
+  // Spin the wheels so the batteries drain
+  this->mockSystem->preUpdateCallback =
+    [](const gazebo::UpdateInfo &, gazebo::EntityComponentManager &_ecm)
+    {
+      _ecm.Each<components::Joint>(
+          [&](const Entity &_entity, const components::Joint *) -> bool
+          {
+            _ecm.SetComponentData<components::JointVelocityCmd>(_entity,
+                {1.0});
+            return true;
+          });
+    };
+
+  std::map<std::string, double> lastSoc;
+  std::map<std::string, int> socChanges;
+  this->mockSystem->postUpdateCallback =
+    [&](const gazebo::UpdateInfo &, const gazebo::EntityComponentManager &_ecm)
+    {
+      for (const std::string name : {"stepped", "interval"})
+      {
+        auto soc = _ecm.Component<components::BatterySoC>(
+            battery(_ecm, name));
+        ASSERT_NE(nullptr, soc);
+        if (lastSoc.count(name) && soc->Data() != lastSoc[name])
+          socChanges[name]++;
+        lastSoc[name] = soc->Data();
+      }
+    };
+
+  Server server(serverConfig);
+  server.AddSystem(this->systemPtr);
+  server.Run(true, 3000, false);
+
+  // Both drained by roughly the same amount
+  EXPECT_LT(lastSoc["stepped"], 0.965);
+  EXPECT_NEAR(lastSoc["stepped"], lastSoc["interval"], 0.012);
+
+  // The stepped battery is written every step, the other one only once per
+  // second or per percent of charge
+  EXPECT_GT(socChanges["stepped"], 2000);
+  EXPECT_GE(socChanges["interval"], 2);
+  EXPECT_LE(socChanges["interval"], 6);
+}
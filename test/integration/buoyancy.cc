@@ -200,3 +200,56 @@ TEST_F(BuoyancyTest, Movement)
   server.Run(true, iterations, false);
   EXPECT_TRUE(finished);
 }
+
+/////////////////////////////////////////////////
+TEST_F(BuoyancyTest, GradedPartialSubmersion)
+{
+  // Start server
+  ServerConfig serverConfig;
+  const auto sdfFile = common::joinPaths(std::string(PROJECT_SOURCE_PATH),
+    "test", "worlds", "graded_buoyancy.sdf");
+  serverConfig.SetSdfFile(sdfFile);
+
+  Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+  EXPECT_FALSE(*server.Running(0));
+
+  using namespace std::chrono_literals;
+  server.SetUpdatePeriod(1ns);
+
+  std::size_t iterations = 1000;
+
+  bool finished = false;
+  test::Relay testSystem;
+  testSystem.OnPostUpdate([&](const gazebo::UpdateInfo &_info,
+                             const gazebo::EntityComponentManager &_ecm)
+  {
+    Entity floatingBox = _ecm.EntityByComponents(
+        components::Model(), components::Name("floating_box"));
+    Entity sinkingBox = _ecm.EntityByComponents(
+        components::Model(), components::Name("sinking_box"));
+    ASSERT_NE(floatingBox, kNullEntity);
+    ASSERT_NE(sinkingBox, kNullEntity);
+
+    auto floatingPose = _ecm.Component<components::Pose>(floatingBox);
+    auto sinkingPose = _ecm.Component<components::Pose>(sinkingBox);
+    ASSERT_NE(floatingPose, nullptr);
+    ASSERT_NE(sinkingPose, nullptr);
+
+    // The floating box is half as dense as water and starts half
+    // submerged, so it should stay at the surface. With full volume
+    // buoyancy it would shoot up out of the water.
+    EXPECT_NEAR(0, floatingPose->Data().Pos().Z(), 0.05);
+
+    if (_info.iterations == iterations)
+    {
+      // The sinking box is denser than water
+      EXPECT_LT(sinkingPose->Data().Pos().Z(), -1.5);
+      finished = true;
+    }
+  });
+
+  server.AddSystem(testSystem.systemPtr);
+  server.Run(true, iterations, false);
+  EXPECT_TRUE(finished);
+}
@@ -62,8 +62,11 @@ TEST_F(ColladaWorldExporterFixture, ExportWorld)
   // The export directory shouldn't exist.
   EXPECT_FALSE(common::exists("./collada_world_exporter_box_test"));
 
-  // Run one iteration which should export the world.
+  // Run one iteration which should start exporting the world. The export
+  // is written in the background, and is complete once the server is
+  // destroyed.
   server->Run(true, 1, false);
+  server.reset();
 
   // The export directory should now exist.
   EXPECT_TRUE(common::exists("./collada_world_exporter_box_test"));
@@ -167,3 +167,54 @@ TEST_F(ContactSystemTest, RemoveContactSensor)
     EXPECT_EQ(0u, contactMsgs.size());
   }
 }
+
+/////////////////////////////////////////////////
+// The test checks that the contact system publishes one summarized contact
+// per pair of collisions when <summary> is set
+TEST_F(ContactSystemTest, ContactSummary)
+{
+  // Start server
+  ServerConfig serverConfig;
+  const auto sdfFile = std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/contact_summary.sdf";
+  serverConfig.SetSdfFile(sdfFile);
+
+  Server server(serverConfig);
+
+  std::mutex contactMutex;
+  std::vector<msgs::Contacts> contactMsgs;
+
+  auto contactCb = [&](const msgs::Contacts &_msg) -> void
+  {
+    std::lock_guard<std::mutex> lock(contactMutex);
+    contactMsgs.push_back(_msg);
+  };
+
+  // subscribe to contacts topic
+  transport::Node node;
+  // Have to create an lvalue here for Node::Subscribe to work.
+  auto callbackFunc = std::function<void(const msgs::Contacts &)>(contactCb);
+  node.Subscribe("/test_multiple_collisions", callbackFunc);
+
+  server.Run(true, 1000, false);
+
+  std::lock_guard<std::mutex> lock(contactMutex);
+  ASSERT_GE(contactMsgs.size(), 1u);
+
+  // Each sphere rests on the edges of both boxes, so there's one summary for
+  // each of the 4 pairs of collisions
+  const auto &lastContacts = contactMsgs.back();
+  EXPECT_EQ(4, lastContacts.contact_size());
+  for (const auto &contact : lastContacts.contact())
+  {
+    ASSERT_EQ(1, contact.position_size());
+    EXPECT_NEAR(0.25, std::abs(contact.position(0).x()), 5e-2);
+    EXPECT_NEAR(1, std::abs(contact.position(0).y()), 5e-2);
+    EXPECT_NEAR(1, contact.position(0).z(), 5e-2);
+
+    ASSERT_EQ(1, contact.header().data_size());
+    EXPECT_EQ("count", contact.header().data(0).key());
+    ASSERT_EQ(1, contact.header().data(0).value_size());
+    EXPECT_LE(1, std::stoi(contact.header().data(0).value(0)));
+  }
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ignition/msgs/laserscan.pb.h>
+#include <ignition/msgs/pointcloud_packed.pb.h>
+
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+#include <ignition/common/Console.hh>
+#include <ignition/common/Util.hh>
+#include <ignition/transport/Node.hh>
+
+#include "ignition/gazebo/components/Lidar.hh"
+#include "ignition/gazebo/components/Sensor.hh"
+#include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/test_config.hh"
+
+#include "../helpers/Relay.hh"
+
+using namespace ignition;
+using namespace gazebo;
+
+/// \brief Test CpuLidar system
+class CpuLidarTest : public ::testing::Test
+{
+  // Documentation inherited
+  protected: void SetUp() override
+  {
+    ignition::common::Console::SetVerbosity(4);
+    ignition::common::setenv("IGN_GAZEBO_SYSTEM_PLUGIN_PATH",
+           (std::string(PROJECT_BINARY_PATH) + "/lib").c_str());
+  }
+};
+
+std::mutex mutex;
+std::vector<msgs::LaserScan> scanMsgs;
+std::vector<msgs::PointCloudPacked> pointMsgs;
+
+/////////////////////////////////////////////////
+void scanCb(const msgs::LaserScan &_msg)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  scanMsgs.push_back(_msg);
+}
+
+/////////////////////////////////////////////////
+void pointsCb(const msgs::PointCloudPacked &_msg)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  pointMsgs.push_back(_msg);
+}
+
+/////////////////////////////////////////////////
+// The lidar sees the ground with its lower row and a box in front with its
+// upper row.
+TEST_F(CpuLidarTest, GroundAndBox)
+{
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/cpu_lidar_sensor.sdf");
+
+  Server server(serverConfig);
+
+  bool topicChecked{false};
+  test::Relay testSystem;
+  testSystem.OnPostUpdate([&](const gazebo::UpdateInfo &,
+                              const gazebo::EntityComponentManager &_ecm)
+      {
+        _ecm.Each<components::Lidar, components::SensorTopic>(
+            [&](const Entity &, const components::Lidar *,
+                const components::SensorTopic *_topic) -> bool
+            {
+              EXPECT_EQ("lidar", _topic->Data());
+              topicChecked = true;
+              return true;
+            });
+      });
+  server.AddSystem(testSystem.systemPtr);
+
+  transport::Node node;
+  node.Subscribe("/lidar", &scanCb);
+  node.Subscribe("/lidar/points", &pointsCb);
+
+  server.Run(true, 100, false);
+
+  // Wait for the messages
+  for (int sleep = 0; sleep < 30; ++sleep)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!scanMsgs.empty() && !pointMsgs.empty())
+        break;
+    }
+    IGN_SLEEP_MS(100);
+  }
+
+  EXPECT_TRUE(topicChecked);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_FALSE(scanMsgs.empty());
+  const auto &scan = scanMsgs.back();
+  EXPECT_EQ(3u, scan.count());
+  EXPECT_EQ(2u, scan.vertical_count());
+  ASSERT_EQ(6, scan.ranges_size());
+
+  // Lower row hits the ground
+  for (int i = 0; i < 3; ++i)
+    EXPECT_NEAR(std::sqrt(0.5), scan.ranges(i), 1e-3);
+
+  // Upper row only hits the box in front
+  EXPECT_TRUE(std::isinf(scan.ranges(3)));
+  EXPECT_NEAR(1.5, scan.ranges(4), 1e-3);
+  EXPECT_TRUE(std::isinf(scan.ranges(5)));
+
+  ASSERT_FALSE(pointMsgs.empty());
+  const auto &points = pointMsgs.back();
+  EXPECT_EQ(3u, points.width());
+  EXPECT_EQ(2u, points.height());
+  EXPECT_EQ(points.row_step() * points.height(), points.data().size());
+}
@@ -218,3 +218,55 @@ TEST_F(DetachableJointTest, LinksInSameModel)
   // the expected distance.
   EXPECT_GT(b2Poses.front().Pos().Z() - b2Poses.back().Pos().Z(), expDist);
 }
+
+/////////////////////////////////////////////////
+TEST_F(DetachableJointTest, AttachAgain)
+{
+  using namespace std::chrono_literals;
+
+  this->StartServer("/test/worlds/detachable_joint.sdf");
+
+  std::vector<math::Pose3d> m2Poses;
+  test::Relay testSystem;
+  testSystem.OnPostUpdate(
+      [&](const gazebo::UpdateInfo &,
+          const gazebo::EntityComponentManager &_ecm)
+      {
+        _ecm.Each<components::Model, components::Name, components::Pose>(
+            [&](const Entity &, const components::Model *,
+                const components::Name *_name,
+                const components::Pose *_pose) -> bool
+            {
+              if (_name->Data() == "M2")
+                m2Poses.push_back(_pose->Data());
+              return true;
+            });
+      });
+  this->server->AddSystem(testSystem.systemPtr);
+
+  this->server->Run(true, 20, false);
+
+  transport::Node node;
+  auto detachPub =
+      node.Advertise<msgs::Empty>("/model/M1/detachable_joint/detach");
+  auto attachPub =
+      node.Advertise<msgs::Empty>("/model/M1/detachable_joint/attach");
+
+  // Detach and let Model2 fall for a while
+  detachPub.Publish(msgs::Empty());
+  std::this_thread::sleep_for(250ms);
+  m2Poses.clear();
+  this->server->Run(true, 100, false);
+  ASSERT_EQ(100u, m2Poses.size());
+  EXPECT_GT(m2Poses.front().Pos().Z() - m2Poses.back().Pos().Z(), 0.01);
+
+  // Attach it again, it should stop falling once the joint settles
+  attachPub.Publish(msgs::Empty());
+  std::this_thread::sleep_for(250ms);
+  this->server->Run(true, 10, false);
+
+  m2Poses.clear();
+  this->server->Run(true, 100, false);
+  ASSERT_EQ(100u, m2Poses.size());
+  EXPECT_NEAR(m2Poses.front().Pos().Z(), m2Poses.back().Pos().Z(), 1e-3);
+}
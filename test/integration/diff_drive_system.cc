@@ -16,6 +16,11 @@
 */
 
 #include <gtest/gtest.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/math/Pose3.hh>
@@ -604,6 +609,163 @@ TEST_P(DiffDriveTest, Pose_VCustomTfTopic)
   EXPECT_EQ(5u, odomPosesCount);
 }
 
+/////////////////////////////////////////////////
+TEST_P(DiffDriveTest, AggregatedOdometry)
+{
+  // Start server
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/diff_drive_aggregate_odometry.sdf");
+
+  Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+  EXPECT_FALSE(*server.Running(0));
+
+  server.SetUpdatePeriod(0ns);
+
+  std::mutex mutex;
+  unsigned int aggregateCount = 0;
+  std::map<std::string, math::Pose3d> lastPoses;
+  std::function<void(const msgs::Pose_V &)> aggregateCb =
+    [&](const msgs::Pose_V &_msg)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      ASSERT_TRUE(_msg.has_header());
+      ASSERT_TRUE(_msg.header().has_stamp());
+      ASSERT_EQ(2, _msg.pose_size());
+
+      for (const auto &pose : _msg.pose())
+      {
+        ASSERT_EQ(2, pose.header().data_size());
+        EXPECT_EQ("frame_id", pose.header().data(0).key());
+        EXPECT_EQ("child_frame_id", pose.header().data(1).key());
+
+        const auto &frameId = pose.header().data(0).value(0);
+        const auto &childFrameId = pose.header().data(1).value(0);
+        EXPECT_EQ(frameId.substr(0, frameId.find('/')) + "/chassis",
+            childFrameId);
+        lastPoses[frameId] = msgs::Convert(pose);
+      }
+      aggregateCount++;
+    };
+
+  unsigned int odomCount = 0;
+  std::function<void(const msgs::Odometry &)> odomCb =
+    [&](const msgs::Odometry &)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      odomCount++;
+    };
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Twist>("/model/vehicle_a/cmd_vel");
+  node.Subscribe("/world/diff_drive_aggregate_odometry/odometry_aggregate",
+      aggregateCb);
+  node.Subscribe("/model/vehicle_a/odometry", odomCb);
+  node.Subscribe("/model/vehicle_b/odometry", odomCb);
+
+  msgs::Twist msg;
+  msgs::Set(msg.mutable_linear(), math::Vector3d(0.5, 0, 0));
+  pub.Publish(msg);
+
+  server.Run(true, 1000, false);
+
+  // The packed message lags one iteration behind, so the snapshot of the
+  // last iteration is never published
+  int sleep = 0;
+  int maxSleep = 30;
+  for (; sleep < maxSleep; ++sleep)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (aggregateCount >= 49u)
+        break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  ASSERT_NE(maxSleep, sleep);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(49u, aggregateCount);
+  EXPECT_EQ(0u, odomCount);
+
+  ASSERT_EQ(2u, lastPoses.size());
+  ASSERT_EQ(1u, lastPoses.count("vehicle_a/odom"));
+  ASSERT_EQ(1u, lastPoses.count("vehicle_b/odom"));
+
+  // Only the commanded vehicle moved
+  EXPECT_GT(lastPoses["vehicle_a/odom"].Pos().X(), 0.1);
+  EXPECT_NEAR(0.0, lastPoses["vehicle_b/odom"].Pos().X(), 1e-2);
+  EXPECT_NEAR(0.0, lastPoses["vehicle_b/odom"].Pos().Y(), 1e-2);
+}
+
+/////////////////////////////////////////////////
+TEST_P(DiffDriveTest, AggregatedOdometryWithAckermann)
+{
+  // Start server
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/wheeled_aggregate_odometry.sdf");
+
+  Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+  EXPECT_FALSE(*server.Running(0));
+
+  server.SetUpdatePeriod(0ns);
+
+  std::mutex mutex;
+  unsigned int aggregateCount = 0;
+  std::map<std::string, math::Pose3d> lastPoses;
+  std::function<void(const msgs::Pose_V &)> aggregateCb =
+    [&](const msgs::Pose_V &_msg)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      // Both systems publish in the same message
+      ASSERT_EQ(2, _msg.pose_size());
+      for (const auto &pose : _msg.pose())
+      {
+        ASSERT_LT(0, pose.header().data_size());
+        lastPoses[pose.header().data(0).value(0)] = msgs::Convert(pose);
+      }
+      aggregateCount++;
+    };
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::Twist>("/model/vehicle_b/cmd_vel");
+  node.Subscribe("/world/wheeled_aggregate_odometry/odometry_aggregate",
+      aggregateCb);
+
+  msgs::Twist msg;
+  msgs::Set(msg.mutable_linear(), math::Vector3d(0.5, 0, 0));
+  pub.Publish(msg);
+
+  server.Run(true, 1000, false);
+
+  int sleep = 0;
+  int maxSleep = 30;
+  for (; sleep < maxSleep; ++sleep)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (aggregateCount >= 49u)
+        break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  ASSERT_NE(maxSleep, sleep);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(49u, aggregateCount);
+
+  ASSERT_EQ(2u, lastPoses.size());
+  ASSERT_EQ(1u, lastPoses.count("vehicle_a/odom"));
+  ASSERT_EQ(1u, lastPoses.count("vehicle_b/odom"));
+
+  // Only the Ackermann vehicle was commanded
+  EXPECT_NEAR(0.0, lastPoses["vehicle_a/odom"].Pos().X(), 1e-2);
+  EXPECT_GT(lastPoses["vehicle_b/odom"].Pos().X(), 0.1);
+}
+
 // Run multiple times
 INSTANTIATE_TEST_SUITE_P(ServerRepeat, DiffDriveTest,
     ::testing::Range(1, 2));
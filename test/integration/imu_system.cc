@@ -212,3 +212,56 @@ TEST_F(ImuTest, ModelFalling)
   EXPECT_EQ(imuMsgs.back().entity_name(), scopedName);
   mutex.unlock();
 }
+
+/////////////////////////////////////////////////
+// The test checks that the readings of an imu settle once it lands, even
+// though its link stops reporting changes
+TEST_F(ImuTest, AccelerationSettles)
+{
+  // Start server
+  ServerConfig serverConfig;
+  const auto sdfFile = std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/imu.sdf";
+  serverConfig.SetSdfFile(sdfFile);
+
+  Server server(serverConfig);
+
+  test::Relay testSystem;
+  std::vector<math::Vector3d> accelerations;
+  std::vector<math::Vector3d> angularVelocities;
+  testSystem.OnPostUpdate([&](const gazebo::UpdateInfo &,
+                              const gazebo::EntityComponentManager &_ecm)
+      {
+        _ecm.Each<components::Imu,
+                  components::AngularVelocity,
+                  components::LinearAcceleration>(
+            [&](const ignition::gazebo::Entity &,
+                const components::Imu *,
+                const components::AngularVelocity *_angularVel,
+                const components::LinearAcceleration *_linearAcc) -> bool
+            {
+              accelerations.push_back(_linearAcc->Data());
+              angularVelocities.push_back(_angularVel->Data());
+              return true;
+            });
+      });
+  server.AddSystem(testSystem.systemPtr);
+
+  // The box falls 2.5 m with a gravity of 5 m/s^2, landing after 1 s. Give
+  // it 1 s to come to rest.
+  const std::size_t steps{2000u};
+  server.Run(true, steps, false);
+  ASSERT_EQ(steps, accelerations.size());
+
+  // It was accelerating while falling
+  EXPECT_NEAR(-5.0, accelerations[200].Z(), TOL);
+
+  // Readings stay at rest
+  server.Run(true, 500u, false);
+  ASSERT_EQ(steps + 500u, accelerations.size());
+  for (std::size_t i = steps; i < accelerations.size(); ++i)
+  {
+    EXPECT_NEAR(0.0, accelerations[i].Length(), TOL) << i;
+    EXPECT_NEAR(0.0, angularVelocities[i].Length(), TOL) << i;
+  }
+}
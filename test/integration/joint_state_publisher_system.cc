@@ -16,6 +16,9 @@
 */
 
 #include <gtest/gtest.h>
+
+#include <atomic>
+
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/transport/Node.hh>
@@ -145,3 +148,38 @@ TEST_F(JointStatePublisherTest, LimitedPublisher)
   // Make sure the callback was triggered at least once.
   EXPECT_GT(count, 0);
 }
+
+/////////////////////////////////////////////////
+TEST_F(JointStatePublisherTest, PublishThreshold)
+{
+  // Start server
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/joint_state_publisher_threshold.sdf");
+
+  Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+  EXPECT_FALSE(*server.Running(0));
+
+  server.SetUpdatePeriod(0ns);
+
+  std::atomic<int> count{0};
+  std::function<void(const msgs::Model &)> jointStateCb =
+    [&](const msgs::Model &_msg)
+    {
+      ASSERT_EQ(1, _msg.joint_size());
+      EXPECT_EQ("arm_joint", _msg.joint(0).name());
+      EXPECT_NEAR(0.0, _msg.joint(0).axis1().position(), 1e-6);
+      count++;
+    };
+
+  transport::Node node;
+  node.Subscribe("/world/joint_state_threshold/model/idle_arm/joint_state",
+      jointStateCb);
+
+  server.Run(true, 100, false);
+  IGN_SLEEP_MS(100);
+
+  // The arm doesn't move, so only the first state is published
+  EXPECT_EQ(1, count);
+}
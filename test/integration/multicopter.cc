@@ -26,6 +26,7 @@
 #include <ignition/common/Util.hh>
 #include <ignition/transport/Node.hh>
 
+#include "ignition/gazebo/components/Actuators.hh"
 #include "ignition/gazebo/components/AngularVelocity.hh"
 #include "ignition/gazebo/components/Joint.hh"
 #include "ignition/gazebo/components/JointVelocity.hh"
@@ -33,6 +34,7 @@
 #include "ignition/gazebo/components/Link.hh"
 #include "ignition/gazebo/components/Name.hh"
 #include "ignition/gazebo/components/Model.hh"
+#include "ignition/gazebo/components/Pose.hh"
 
 #include "ignition/gazebo/Model.hh"
 #include "ignition/gazebo/Server.hh"
@@ -138,6 +140,64 @@ TEST_F(MulticopterTest, CommandedMotorSpeed)
   server->Run(true, iterTestStart + nIters, false);
 }
 
+/////////////////////////////////////////////////
+// Test that batched rotors fly the vehicle like rotors evaluated on their own
+TEST_F(MulticopterTest, BatchedRotors)
+{
+  auto fly = [&](const std::string &_world)
+  {
+    auto server = this->StartServer(_world);
+
+    // Command the motors through the component so both runs see the same
+    // commands on the same iterations. Uneven speeds make the vehicle climb
+    // and yaw.
+    test::Relay testSystem;
+    math::Pose3d pose;
+    testSystem.OnPreUpdate(
+        [&](const gazebo::UpdateInfo &_info,
+            gazebo::EntityComponentManager &_ecm)
+        {
+          if (_info.iterations != 1)
+            return;
+
+          Entity model = _ecm.EntityByComponents(components::Model(),
+              components::Name("X3"));
+          EXPECT_NE(kNullEntity, model);
+          msgs::Actuators msg;
+          msg.mutable_velocity()->Resize(4, 700);
+          msg.set_velocity(2, 650);
+          msg.set_velocity(3, 650);
+          _ecm.CreateComponent(model, components::Actuators(msg));
+        });
+    testSystem.OnPostUpdate(
+        [&](const gazebo::UpdateInfo &,
+            const gazebo::EntityComponentManager &_ecm)
+        {
+          Entity model = _ecm.EntityByComponents(components::Model(),
+              components::Name("X3"));
+          pose = _ecm.Component<components::Pose>(model)->Data();
+        });
+
+    server->AddSystem(testSystem.systemPtr);
+    server->Run(true, 1000, false);
+    return pose;
+  };
+
+  auto single = fly("/test/worlds/quadcopter.sdf");
+  auto batched = fly("/test/worlds/quadcopter_batched.sdf");
+
+  // The vehicle moved
+  EXPECT_GT(single.Pos().Z(), 0.1);
+  EXPECT_GT(std::abs(single.Rot().Yaw()), 1e-3);
+
+  EXPECT_NEAR(single.Pos().X(), batched.Pos().X(), 1e-6);
+  EXPECT_NEAR(single.Pos().Y(), batched.Pos().Y(), 1e-6);
+  EXPECT_NEAR(single.Pos().Z(), batched.Pos().Z(), 1e-6);
+  EXPECT_NEAR(single.Rot().Roll(), batched.Rot().Roll(), 1e-6);
+  EXPECT_NEAR(single.Rot().Pitch(), batched.Rot().Pitch(), 1e-6);
+  EXPECT_NEAR(single.Rot().Yaw(), batched.Rot().Yaw(), 1e-6);
+}
+
 /////////////////////////////////////////////////
 TEST_F(MulticopterTest, MulticopterVelocityControl)
 {
@@ -17,12 +17,15 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <string>
+#include <thread>
 
 #include <ignition/common/Util.hh>
 
 #include <ignition/math/Color.hh>
 #include <ignition/msgs/Utility.hh>
+#include <ignition/transport/Node.hh>
 
 #include "ignition/gazebo/Entity.hh"
 #include "ignition/gazebo/Server.hh"
@@ -164,3 +167,59 @@ TEST_F(ParticleEmitterTest, SDFLoad)
   EXPECT_TRUE(updateCustomChecked);
   EXPECT_TRUE(updateDefaultChecked);
 }
+
+/////////////////////////////////////////////////
+// Send a command to a particle emitter and verify that only the changed
+// parameters are forwarded.
+TEST_F(ParticleEmitterTest, ChangedParametersOnly)
+{
+  this->LoadWorld("test/worlds/particle_emitter.sdf");
+
+  bool cmdChecked{false};
+  test::Relay testSystem;
+  testSystem.OnPostUpdate([&](const gazebo::UpdateInfo &,
+                              const gazebo::EntityComponentManager &_ecm)
+      {
+        _ecm.Each<components::ParticleEmitter,
+                  components::ParticleEmitterCmd,
+                  components::Name>(
+            [&](const ignition::gazebo::Entity &,
+                const components::ParticleEmitter *_emitter,
+                const components::ParticleEmitterCmd *_cmd,
+                const components::Name *_name) -> bool
+            {
+              EXPECT_EQ("smoke_emitter", _name->Data());
+
+              // The rate didn't change, so only emitting is sent
+              EXPECT_FALSE(_cmd->Data().has_rate());
+              EXPECT_TRUE(_cmd->Data().has_emitting());
+              EXPECT_FALSE(_cmd->Data().emitting().data());
+
+              // The emitter state holds the latest parameters
+              EXPECT_FALSE(_emitter->Data().emitting().data());
+              EXPECT_DOUBLE_EQ(5.0, _emitter->Data().rate().data());
+              EXPECT_DOUBLE_EQ(2.0, _emitter->Data().lifetime().data());
+
+              cmdChecked = true;
+              return true;
+            });
+      });
+  this->server->AddSystem(testSystem.systemPtr);
+
+  transport::Node node;
+  auto pub = node.Advertise<msgs::ParticleEmitter>(
+      "/model/smoke_generator_demo_model/particle_emitter/smoke_emitter");
+
+  msgs::ParticleEmitter msg;
+  msg.mutable_rate()->set_data(5.0);
+  msg.mutable_emitting()->set_data(false);
+
+  for (int i = 0; i < 100 && !cmdChecked; ++i)
+  {
+    pub.Publish(msg);
+    this->server->Run(true, 10, false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  EXPECT_TRUE(cmdChecked);
+}
@@ -18,9 +18,12 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <map>
+#include <string>
 #include <vector>
 
 #include <ignition/common/Console.hh>
+#include <ignition/msgs/Utility.hh>
 #include <ignition/common/Util.hh>
 #include <sdf/Collision.hh>
 #include <sdf/Cylinder.hh>
@@ -38,6 +41,7 @@
 #include "ignition/gazebo/components/AxisAlignedBox.hh"
 #include "ignition/gazebo/components/CanonicalLink.hh"
 #include "ignition/gazebo/components/Collision.hh"
+#include "ignition/gazebo/components/ExternalWorldWrenchCmd.hh"
 #include "ignition/gazebo/components/Geometry.hh"
 #include "ignition/gazebo/components/Inertial.hh"
 #include "ignition/gazebo/components/Joint.hh"
@@ -882,6 +886,67 @@ TEST_F(PhysicsSystemFixture, GetBoundingBox)
       bbox.begin()->second);
 }
 
+/////////////////////////////////////////////////
+// Check that bounding boxes follow models that move after they're computed
+TEST_F(PhysicsSystemFixture, BoundingBoxFollowsModel)
+{
+  ignition::gazebo::ServerConfig serverConfig;
+
+  const auto sdfFile = std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/falling.sdf";
+  serverConfig.SetSdfFile(sdfFile);
+
+  gazebo::Server server(serverConfig);
+
+  server.SetUpdatePeriod(1ns);
+
+  // Box and world pose of the falling sphere's model at every iteration
+  std::vector<ignition::math::AxisAlignedBox> boxes;
+  std::vector<ignition::math::Pose3d> poses;
+
+  test::Relay testSystem;
+
+  testSystem.OnPreUpdate(
+    [&](const gazebo::UpdateInfo &,
+    gazebo::EntityComponentManager &_ecm)
+    {
+      auto sphere = _ecm.EntityByComponents(components::Model(),
+          components::Name("sphere"));
+      ASSERT_NE(kNullEntity, sphere);
+      if (nullptr == _ecm.Component<components::AxisAlignedBox>(sphere))
+        _ecm.CreateComponent(sphere, components::AxisAlignedBox());
+    });
+
+  testSystem.OnPostUpdate(
+    [&](const gazebo::UpdateInfo &,
+    const gazebo::EntityComponentManager &_ecm)
+    {
+      auto sphere = _ecm.EntityByComponents(components::Model(),
+          components::Name("sphere"));
+      auto bboxComp = _ecm.Component<components::AxisAlignedBox>(sphere);
+      ASSERT_NE(nullptr, bboxComp);
+      boxes.push_back(bboxComp->Data());
+      poses.push_back(_ecm.Component<components::Pose>(sphere)->Data());
+    });
+
+  server.AddSystem(testSystem.systemPtr);
+  const size_t iters = 500;
+  server.Run(true, iters, false);
+
+  ASSERT_EQ(iters, boxes.size());
+  ASSERT_EQ(iters, poses.size());
+
+  // The box is computed before each step, so it lags the model's pose by one
+  // iteration. The link is 5 m above the model and has a 1 m radius.
+  EXPECT_NEAR(7.0, boxes.front().Center().Z(), 1e-6);
+  for (size_t i = 1; i < iters; ++i)
+  {
+    EXPECT_NEAR(poses[i - 1].Pos().Z() + 5.0, boxes[i].Center().Z(), 1e-6);
+    EXPECT_NEAR(2.0, boxes[i].ZLength(), 1e-6);
+  }
+  EXPECT_LT(boxes.back().Center().Z(), 6.0);
+}
+
 
 /////////////////////////////////////////////////
 // This tests whether nested models can be loaded correctly
@@ -1335,3 +1400,138 @@ TEST_F(PhysicsSystemFixture, NestedModelIndividualCanonicalLinks)
   EXPECT_NE(postUpModelPoses.end(), modelIt);
   EXPECT_NEAR(zExpected, modelIt->second.Z(), 1e-2);
 }
+
+/////////////////////////////////////////////////
+// Models in different partitions are simulated by different engine
+// instances, while models of the same partition still interact, and static
+// models are part of all partitions.
+TEST_F(PhysicsSystemFixture, Partitions)
+{
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/physics_partitions.sdf");
+
+  gazebo::Server server(serverConfig);
+  server.SetUpdatePeriod(1us);
+
+  std::map<std::string, math::Pose3d> poses;
+  test::Relay testSystem;
+  testSystem.OnPostUpdate(
+    [&poses](const gazebo::UpdateInfo &,
+    const gazebo::EntityComponentManager &_ecm)
+    {
+      _ecm.Each<components::Model, components::Name, components::Pose>(
+        [&](const ignition::gazebo::Entity &, const components::Model *,
+        const components::Name *_name, const components::Pose *_pose)->bool
+        {
+          poses[_name->Data()] = _pose->Data();
+          return true;
+        });
+    });
+  server.AddSystem(testSystem.systemPtr);
+
+  server.Run(true, 2000, false);
+  ASSERT_EQ(4u, poses.size());
+
+  // The far sphere rests on the ground, and the top sphere is stacked on the
+  // bottom one
+  EXPECT_NEAR(0.5, poses["far"].Pos().Z(), 5e-2);
+  EXPECT_NEAR(0.5, poses["bottom"].Pos().Z(), 5e-2);
+  EXPECT_NEAR(1.5, poses["top"].Pos().Z(), 5e-2);
+  EXPECT_NEAR(45.0, poses["far"].Pos().X(), 1e-3);
+}
+
+/////////////////////////////////////////////////
+// Wrenches are cleared by the engine after each step, so they must be applied
+// again on every substep to hold the sphere up against gravity
+TEST_F(PhysicsSystemFixture, SubstepsKeepCommands)
+{
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/physics_substeps.sdf");
+
+  gazebo::Server server(serverConfig);
+  server.SetUpdatePeriod(1us);
+
+  std::vector<math::Pose3d> poses;
+  test::Relay testSystem;
+  testSystem.OnPreUpdate(
+    [](const gazebo::UpdateInfo &, gazebo::EntityComponentManager &_ecm)
+    {
+      auto link = _ecm.EntityByComponents(components::Link(),
+          components::Name("link"));
+      ASSERT_NE(kNullEntity, link);
+
+      msgs::Wrench wrench;
+      msgs::Set(wrench.mutable_force(), math::Vector3d(0, 0, 9.8));
+      auto wrenchComp = _ecm.Component<components::ExternalWorldWrenchCmd>(
+          link);
+      if (nullptr == wrenchComp)
+        _ecm.CreateComponent(link, components::ExternalWorldWrenchCmd(wrench));
+      else
+        wrenchComp->Data() = wrench;
+    });
+  testSystem.OnPostUpdate(
+    [&poses](const gazebo::UpdateInfo &,
+    const gazebo::EntityComponentManager &_ecm)
+    {
+      auto sphere = _ecm.EntityByComponents(components::Model(),
+          components::Name("sphere"));
+      poses.push_back(_ecm.Component<components::Pose>(sphere)->Data());
+    });
+  server.AddSystem(testSystem.systemPtr);
+
+  const size_t iters = 500;
+  server.Run(true, iters, false);
+  ASSERT_EQ(iters, poses.size());
+
+  // The sphere would have fallen by almost 1 m if the wrench was only applied
+  // on the first substep of each iteration
+  EXPECT_NEAR(2.0, poses.back().Pos().Z(), 1e-3);
+}
+
+/////////////////////////////////////////////////
+TEST_F(PhysicsSystemFixture, CreationBudget)
+{
+  ignition::gazebo::ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/physics_creation_budget.sdf");
+
+  gazebo::Server server(serverConfig);
+  server.SetUpdatePeriod(1us);
+
+  std::map<std::string, std::vector<double>> heights;
+  test::Relay testSystem;
+  testSystem.OnPostUpdate(
+    [&heights](const gazebo::UpdateInfo &,
+    const gazebo::EntityComponentManager &_ecm)
+    {
+      _ecm.Each<components::Model, components::Name, components::Pose>(
+        [&](const ignition::gazebo::Entity &, const components::Model *,
+        const components::Name *_name, const components::Pose *_pose)->bool
+        {
+          heights[_name->Data()].push_back(_pose->Data().Pos().Z());
+          return true;
+        });
+    });
+  server.AddSystem(testSystem.systemPtr);
+
+  const size_t iters = 100;
+  server.Run(true, iters, false);
+  ASSERT_EQ(4u, heights.size());
+
+  // One model is created per step, starting with the plane, and spheres only
+  // fall once they've been created
+  const auto &first = heights["first"];
+  const auto &second = heights["second"];
+  const auto &third = heights["third"];
+  ASSERT_EQ(iters, first.size());
+  ASSERT_EQ(iters, second.size());
+  ASSERT_EQ(iters, third.size());
+  EXPECT_DOUBLE_EQ(10.0, second[1]);
+  EXPECT_DOUBLE_EQ(10.0, third[2]);
+  EXPECT_LT(first[2], 10.0);
+  EXPECT_LT(third[iters - 1], 10.0);
+  EXPECT_LT(first[iters - 1], second[iters - 1]);
+  EXPECT_LT(second[iters - 1], third[iters - 1]);
+}
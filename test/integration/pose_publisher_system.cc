@@ -17,6 +17,8 @@
 
 #include <gtest/gtest.h>
 #include <mutex>
+#include <set>
+#include <string>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
@@ -745,3 +747,69 @@ TEST_F(PosePublisherTest, NestedModelLoadPlugin)
 
   EXPECT_TRUE(!poseMsgs.empty());
 }
+
+/////////////////////////////////////////////////
+TEST_F(PosePublisherTest, AggregatedPublication)
+{
+  // Start server
+  ServerConfig serverConfig;
+  serverConfig.SetSdfFile(std::string(PROJECT_SOURCE_PATH) +
+      "/test/worlds/pose_publisher.sdf");
+
+  Server server(serverConfig);
+  EXPECT_FALSE(server.Running());
+  EXPECT_FALSE(*server.Running(0));
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    poseVMsgs.clear();
+  }
+
+  // Both aggregated models publish together on the world topic
+  transport::Node node;
+  node.Subscribe(std::string("/world/pose_publisher/pose_aggregate"),
+      &poseVCb);
+
+  // Run server
+  server.Run(true, 100u, false);
+
+  std::size_t nExpMessages = 10;
+  bool received = false;
+  for (int sleep = 0; sleep < 300; ++sleep)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      received = (poseVMsgs.size() >= nExpMessages);
+    }
+
+    if (received)
+      break;
+  }
+
+  ASSERT_TRUE(received);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  // Published at 100 Hz, not once per instance
+  EXPECT_EQ(nExpMessages, poseVMsgs.size());
+  for (const auto &msg : poseVMsgs)
+  {
+    EXPECT_TRUE(msg.header().has_stamp());
+    ASSERT_EQ(2, msg.pose_size());
+
+    std::set<std::string> names;
+    for (const auto &pose : msg.pose())
+    {
+      names.insert(pose.name());
+      ASSERT_EQ(2, pose.header().data_size());
+      EXPECT_EQ("frame_id", pose.header().data(0).key());
+      EXPECT_EQ("child_frame_id", pose.header().data(1).key());
+      EXPECT_EQ(pose.name(), pose.header().data(1).value(0));
+
+      if (pose.header().data(0).value(0) == "test_aggregate_0")
+        EXPECT_EQ(math::Pose3d::Zero, msgs::Convert(pose));
+    }
+    EXPECT_EQ(2u, names.size());
+  }
+}
@@ -278,6 +278,16 @@ TEST_P(SceneBroadcasterTest, DeletedTopic)
       {
         return _val == cylinderModelId;
       }));
+
+  // The deleted model should also be gone from the scene info
+  msgs::Scene res;
+  bool result;
+  unsigned int timeout = 5000;
+  EXPECT_TRUE(node.Request("/world/default/scene/info", timeout, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_EQ(4, res.model_size());
+  for (const auto &model : res.model())
+    EXPECT_NE("cylinder", model.name());
 }
 
 /////////////////////////////////////////////////
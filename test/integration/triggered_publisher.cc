@@ -206,6 +206,37 @@ TEST_F(TriggeredPublisherTest, MultipleOutputsForOneInput)
   EXPECT_EQ(pubCount, std::count(recvMsgs1.begin(), recvMsgs1.end(), true));
 }
 
+/////////////////////////////////////////////////
+/// Check that outputs of a triggered publisher trigger an in-process input,
+/// which ignores messages published through transport
+TEST_F(TriggeredPublisherTest, InProcessChain)
+{
+  transport::Node node;
+  auto inputPub = node.Advertise<msgs::Empty>("/in_13");
+  auto chainPub = node.Advertise<msgs::Boolean>("/chain_13");
+  std::atomic<std::size_t> recvCount{0};
+  auto msgCb = std::function<void(const msgs::Empty &)>(
+      [&recvCount](const auto &)
+      {
+        ++recvCount;
+      });
+  node.Subscribe("/out_13", msgCb);
+
+  const std::size_t pubCount{10};
+  msgs::Boolean chainMsg;
+  chainMsg.set_data(true);
+  for (std::size_t i = 0; i < pubCount; ++i)
+  {
+    EXPECT_TRUE(inputPub.Publish(msgs::Empty()));
+    EXPECT_TRUE(chainPub.Publish(chainMsg));
+    IGN_SLEEP_MS(10);
+  }
+
+  waitUntil(5000, [&]{return pubCount == recvCount;});
+  IGN_SLEEP_MS(100);
+  EXPECT_EQ(pubCount, recvCount);
+}
+
 /////////////////////////////////////////////////
 TEST_F(TriggeredPublisherTest, ExactMatchBooleanInputs)
 {
@@ -20,16 +20,19 @@
 #include <ignition/msgs/entity_factory.pb.h>
 #include <ignition/msgs/light.pb.h>
 #include <ignition/msgs/physics.pb.h>
+#include <ignition/msgs/pose_v.pb.h>
 
 #include <ignition/common/Console.hh>
 #include <ignition/common/Util.hh>
 #include <ignition/math/Pose3.hh>
 #include <ignition/transport/Node.hh>
 
+#include "ignition/gazebo/components/CanonicalLink.hh"
 #include "ignition/gazebo/components/Light.hh"
 #include "ignition/gazebo/components/Link.hh"
 #include "ignition/gazebo/components/Model.hh"
 #include "ignition/gazebo/components/Name.hh"
+#include "ignition/gazebo/components/ParentEntity.hh"
 #include "ignition/gazebo/components/Physics.hh"
 #include "ignition/gazebo/components/Pose.hh"
 #include "ignition/gazebo/components/World.hh"
@@ -209,6 +212,45 @@ TEST_F(UserCommandsTest, Create)
       components::Name("banana"));
   EXPECT_NE(kNullEntity, model);
 
+  // Clone an existing model
+  req.Clear();
+  req.set_clone_name("banana");
+  req.set_name("cherry");
+  req.mutable_pose()->mutable_position()->set_x(5);
+
+  EXPECT_TRUE(node.Request(service, req, timeout, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_TRUE(res.data());
+
+  // Run an iteration and check the copy has its own link
+  server.Run(true, 1, false);
+
+  EXPECT_EQ(entityCount + 4, ecm->EntityCount());
+  entityCount = ecm->EntityCount();
+
+  auto clone = ecm->EntityByComponents(components::Model(),
+      components::Name("cherry"));
+  EXPECT_NE(kNullEntity, clone);
+  EXPECT_EQ(math::Pose3d(5, 0, 0, 0, 0, 0),
+      ecm->Component<components::Pose>(clone)->Data());
+
+  auto cloneLinks = ecm->ChildrenByComponents(clone, components::Link());
+  ASSERT_EQ(1u, cloneLinks.size());
+  EXPECT_EQ(clone, ecm->ParentEntity(cloneLinks[0]));
+  EXPECT_NE(kNullEntity, ecm->EntityByComponents(
+      components::ParentEntity(model), components::Link()));
+
+  // Cloning an entity which doesn't exist fails
+  req.Clear();
+  req.set_clone_name("grape");
+
+  EXPECT_TRUE(node.Request(service, req, timeout, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_TRUE(res.data());
+
+  server.Run(true, 1, false);
+  EXPECT_EQ(entityCount, ecm->EntityCount());
+
   // Spawn a light
   req.Clear();
   req.set_sdf(lightStr);
@@ -335,6 +377,92 @@ TEST_F(UserCommandsTest, Create)
       components::Name("test_model")));
 }
 
+/////////////////////////////////////////////////
+TEST_F(UserCommandsTest, CloneFollowsOwnLink)
+{
+  // Start server
+  ServerConfig serverConfig;
+  const auto sdfFile = std::string(PROJECT_SOURCE_PATH) +
+    "/examples/worlds/empty.sdf";
+  serverConfig.SetSdfFile(sdfFile);
+
+  Server server(serverConfig);
+
+  EntityComponentManager *ecm{nullptr};
+  test::Relay testSystem;
+  testSystem.OnPreUpdate([&](const gazebo::UpdateInfo &,
+                             gazebo::EntityComponentManager &_ecm)
+      {
+        ecm = &_ecm;
+      });
+  server.AddSystem(testSystem.systemPtr);
+  server.Run(true, 1, false);
+  ASSERT_NE(nullptr, ecm);
+
+  // A falling sphere
+  auto modelStr = std::string("<?xml version=\"1.0\" ?>") +
+      "<sdf version='1.6'>" +
+      "<model name='falling'>" +
+      "<pose>0 0 10 0 0 0</pose>" +
+      "<link name='link'>" +
+      "<collision name='collision'>" +
+      "<geometry><sphere><radius>0.5</radius></sphere></geometry>" +
+      "</collision>" +
+      "</link>" +
+      "</model>" +
+      "</sdf>";
+
+  msgs::EntityFactory req;
+  req.set_sdf(modelStr);
+
+  msgs::Boolean res;
+  bool result;
+  unsigned int timeout = 5000;
+  std::string service{"/world/empty/create"};
+
+  transport::Node node;
+  EXPECT_TRUE(node.Request(service, req, timeout, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_TRUE(res.data());
+  server.Run(true, 1, false);
+
+  // Clone it to the side
+  req.Clear();
+  req.set_clone_name("falling");
+  req.set_name("falling_copy");
+  req.mutable_pose()->mutable_position()->set_x(5);
+  req.mutable_pose()->mutable_position()->set_z(10);
+
+  EXPECT_TRUE(node.Request(service, req, timeout, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_TRUE(res.data());
+  server.Run(true, 1, false);
+
+  auto model = ecm->EntityByComponents(components::Model(),
+      components::Name("falling"));
+  auto clone = ecm->EntityByComponents(components::Model(),
+      components::Name("falling_copy"));
+  ASSERT_NE(kNullEntity, model);
+  ASSERT_NE(kNullEntity, clone);
+
+  // The copy's canonical link is its own link
+  auto cloneLinks = ecm->ChildrenByComponents(clone, components::Link());
+  ASSERT_EQ(1u, cloneLinks.size());
+  EXPECT_EQ(cloneLinks[0],
+      ecm->ComponentData<components::ModelCanonicalLink>(clone));
+
+  // Both fall, and the copy's pose follows its own link, not the original's
+  server.Run(true, 500, false);
+
+  const auto modelPose = ecm->Component<components::Pose>(model)->Data();
+  const auto clonePose = ecm->Component<components::Pose>(clone)->Data();
+  EXPECT_NEAR(0.0, modelPose.Pos().X(), 1e-6);
+  EXPECT_NEAR(5.0, clonePose.Pos().X(), 1e-6);
+  EXPECT_GT(10.0, modelPose.Pos().Z());
+  EXPECT_GT(10.0, clonePose.Pos().Z());
+  EXPECT_NEAR(modelPose.Pos().Z(), clonePose.Pos().Z(), 0.1);
+}
+
 /////////////////////////////////////////////////
 TEST_F(UserCommandsTest, Remove)
 {
@@ -696,6 +824,68 @@ TEST_F(UserCommandsTest, Pose)
   EXPECT_NEAR(500.0, poseComp->Data().Pos().Y(), 0.2);
 }
 
+/////////////////////////////////////////////////
+TEST_F(UserCommandsTest, PoseVector)
+{
+  // Start server
+  ServerConfig serverConfig;
+  const auto sdfFile = std::string(PROJECT_SOURCE_PATH) +
+    "/test/worlds/shapes.sdf";
+  serverConfig.SetSdfFile(sdfFile);
+
+  Server server(serverConfig);
+
+  // Create a system just to get the ECM
+  EntityComponentManager *ecm{nullptr};
+  test::Relay testSystem;
+  testSystem.OnPreUpdate([&](const gazebo::UpdateInfo &,
+                             gazebo::EntityComponentManager &_ecm)
+      {
+        ecm = &_ecm;
+      });
+
+  server.AddSystem(testSystem.systemPtr);
+  server.Run(true, 1, false);
+  ASSERT_NE(nullptr, ecm);
+
+  auto boxEntity = ecm->EntityByComponents(components::Name("box"));
+  EXPECT_NE(kNullEntity, boxEntity);
+  auto sphereEntity = ecm->EntityByComponents(components::Name("sphere"));
+  EXPECT_NE(kNullEntity, sphereEntity);
+
+  // Move one entity by name and another by ID, and one that doesn't exist
+  msgs::Pose_V req;
+  auto poseMsg = req.add_pose();
+  poseMsg->set_name("box");
+  poseMsg->mutable_position()->set_y(123.0);
+  poseMsg = req.add_pose();
+  poseMsg->set_id(sphereEntity);
+  poseMsg->mutable_position()->set_y(321.0);
+  poseMsg = req.add_pose();
+  poseMsg->set_name("not_an_entity");
+
+  msgs::Boolean res;
+  bool result;
+  unsigned int timeout = 5000;
+  std::string service{"/world/default/set_pose_vector"};
+
+  transport::Node node;
+  EXPECT_TRUE(node.Request(service, req, timeout, res, result));
+  EXPECT_TRUE(result);
+  EXPECT_TRUE(res.data());
+
+  // Run an iteration and check both were moved
+  server.Run(true, 1, false);
+
+  auto poseComp = ecm->Component<components::Pose>(boxEntity);
+  ASSERT_NE(nullptr, poseComp);
+  EXPECT_NEAR(123.0, poseComp->Data().Pos().Y(), 0.2);
+
+  poseComp = ecm->Component<components::Pose>(sphereEntity);
+  ASSERT_NE(nullptr, poseComp);
+  EXPECT_NEAR(321.0, poseComp->Data().Pos().Y(), 0.2);
+}
+
 /////////////////////////////////////////////////
 TEST_F(UserCommandsTest, Light)
 {
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+
+# Compare the results of PERFORMANCE_scenarios against a baseline, and exit
+# with an error if any metric got worse by more than the threshold.
+
+import argparse
+import json
+import sys
+
+# Metrics which are better when higher, all others are better when lower
+HIGHER_IS_BETTER = {'real_time_factor'}
+
+# Keys which describe the run instead of measuring it
+IGNORED = {'scenario', 'iterations', 'samples', 'entities', 'count', 'steps'}
+
+
+def flatten(data, prefix=''):
+    values = {}
+    for key, value in data.items():
+        if key in IGNORED:
+            continue
+        name = prefix + key
+        if isinstance(value, dict):
+            values.update(flatten(value, name + '.'))
+        elif isinstance(value, (int, float)):
+            values[name] = float(value)
+    return values
+
+
+def compare(baseline, contender, threshold):
+    regressions = []
+    base = flatten(baseline)
+    cont = flatten(contender)
+    print(f'{"metric":<32} {"baseline":>14} {"contender":>14} {"change":>9}')
+    for name in sorted(base):
+        if name not in cont:
+            continue
+        old = base[name]
+        new = cont[name]
+        change = (new - old) / old if old != 0 else 0.0
+        if name.split('.')[0] in HIGHER_IS_BETTER:
+            change = -change
+        regressed = change > threshold
+        if regressed:
+            regressions.append(name)
+        mark = '  <<' if regressed else ''
+        print(f'{name:<32} {old:>14.3f} {new:>14.3f} {change:>+8.1%}{mark}')
+    return regressions
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument('baseline')
+    parser.add_argument('contender')
+    parser.add_argument('--threshold', type=float, default=0.1,
+                        help='Largest accepted relative regression')
+    args = parser.parse_args()
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    with open(args.contender) as f:
+        contender = json.load(f)
+
+    if baseline.get('scenario') != contender.get('scenario'):
+        print('Results are of different scenarios')
+        sys.exit(2)
+
+    regressions = compare(baseline, contender, args.threshold)
+    if regressions:
+        print(f'{len(regressions)} metrics regressed by more than '
+              f'{args.threshold:.0%}')
+        sys.exit(1)
@@ -0,0 +1,799 @@
+/*
+ * Copyright (C) 2021 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+extern char **environ;
+#endif
+
+#include <ignition/msgs.hh>
+#include <ignition/common/Console.hh>
+#include <ignition/common/Filesystem.hh>
+#include <ignition/common/Util.hh>
+#include <sdf/Element.hh>
+
+#include "ignition/transport/Node.hh"
+
+#include "ignition/gazebo/Server.hh"
+#include "ignition/gazebo/test_config.hh"  // NOLINT(build/include)
+
+using namespace ignition;
+using namespace gazebo;
+using namespace std::chrono_literals;
+
+/// \brief A world to run, and how to run it.
+struct Scenario
+{
+  /// \brief Name of the world in the SDF.
+  std::string worldName;
+
+  /// \brief Server configuration, holding the world.
+  ServerConfig config;
+
+  /// \brief Number of secondaries of a distributed simulation, each run in
+  /// its own process. Zero to run the world alone.
+  int secondaries{0};
+};
+
+/// \brief Phases reported by the step_metrics topic.
+static const std::vector<std::string> kPhases{
+    "preupdate", "update", "postupdate", "world_state", "messages"};
+
+//////////////////////////////////////////////////
+/// \brief Physics and systems shared by the generated worlds.
+/// \param[in] _name World name.
+/// \param[in] _physics False to leave out the physics system, which the
+/// secondaries of a distributed simulation add instead, see PhysicsPlugin.
+/// \return Start of a world, up to and including its plugins.
+static std::string WorldHeader(const std::string &_name,
+    bool _physics = true)
+{
+  const std::string physics{_physics ? R"(
+    <plugin
+      filename="ignition-gazebo-physics-system"
+      name="ignition::gazebo::systems::Physics">
+    </plugin>)" : ""};
+
+  return R"(<?xml version="1.0" ?>
+<sdf version="1.6">
+  <world name=")" + _name + R"(">
+    <physics name="1ms" type="ignored">
+      <max_step_size>0.001</max_step_size>
+    </physics>)" + physics + R"(
+    <plugin
+      filename="ignition-gazebo-user-commands-system"
+      name="ignition::gazebo::systems::UserCommands">
+    </plugin>
+    <plugin
+      filename="ignition-gazebo-scene-broadcaster-system"
+      name="ignition::gazebo::systems::SceneBroadcaster">
+    </plugin>
+)";
+}
+
+//////////////////////////////////////////////////
+/// \brief Static ground plane for the generated worlds.
+/// \return Ground plane model.
+static std::string GroundPlane()
+{
+  return R"(
+    <model name="ground_plane">
+      <static>true</static>
+      <link name="link">
+        <collision name="collision">
+          <geometry>
+            <plane><normal>0 0 1</normal><size>500 500</size></plane>
+          </geometry>
+        </collision>
+      </link>
+    </model>
+)";
+}
+
+//////////////////////////////////////////////////
+/// \brief A warehouse of box robots driven by velocity control.
+/// \param[in] _name World name.
+/// \param[in] _robotCount Number of robots.
+/// \return SDF world.
+static std::string WarehouseWorld(const std::string &_name, int _robotCount)
+{
+  std::stringstream sdf;
+  sdf << WorldHeader(_name) << GroundPlane();
+
+  const int columns = 40;
+  for (int i = 0; i < _robotCount; ++i)
+  {
+    sdf << R"(
+    <model name="robot_)" << i << R"(">
+      <pose>)" << (i % columns) * 1.5 << " " << (i / columns) * 1.5
+        << R"( 0.1 0 0 0</pose>
+      <link name="chassis">
+        <inertial><mass>10</mass></inertial>
+        <collision name="collision">
+          <geometry><box><size>0.6 0.4 0.2</size></box></geometry>
+        </collision>
+        <visual name="visual">
+          <geometry><box><size>0.6 0.4 0.2</size></box></geometry>
+        </visual>
+      </link>
+      <plugin
+        filename="ignition-gazebo-velocity-control-system"
+        name="ignition::gazebo::systems::VelocityControl">
+        <initial_linear>0.3 0 0</initial_linear>
+        <initial_angular>0 0 0.2</initial_angular>
+      </plugin>
+    </model>
+)";
+  }
+  sdf << "  </world>\n</sdf>\n";
+  return sdf.str();
+}
+
+//////////////////////////////////////////////////
+/// \brief A swarm of copies of the X3 quadcopter of quadcopter.sdf.
+/// \param[in] _name World name.
+/// \param[in] _droneCount Number of drones.
+/// \return SDF world, empty if the quadcopter couldn't be read.
+static std::string DroneSwarmWorld(const std::string &_name, int _droneCount)
+{
+  std::ifstream file(common::joinPaths(PROJECT_SOURCE_PATH, "test", "worlds",
+      "quadcopter.sdf"));
+  const std::string quadcopter{std::istreambuf_iterator<char>(file),
+      std::istreambuf_iterator<char>()};
+
+  const std::string modelStart{"    <model name=\"X3\">"};
+  const std::string modelEnd{"\n    </model>\n"};
+  const std::string pose{"<pose>0 0 0.053302 0 0 0</pose>"};
+  const std::string ns{"<robotNamespace>X3</robotNamespace>"};
+  const auto start = quadcopter.find(modelStart);
+  const auto end = quadcopter.find(modelEnd, start);
+  if (start == std::string::npos || end == std::string::npos)
+    return "";
+  const std::string model = quadcopter.substr(start,
+      end + modelEnd.size() - start);
+
+  std::stringstream sdf;
+  sdf << WorldHeader(_name) << GroundPlane();
+  const int columns = 10;
+  for (int i = 0; i < _droneCount; ++i)
+  {
+    const std::string name = "X3_" + std::to_string(i);
+    std::string drone = model;
+    drone.replace(drone.find("X3"), 2, name);
+
+    std::stringstream dronePose;
+    dronePose << "<pose>" << (i % columns) * 2.0 << " "
+              << (i / columns) * 2.0 << " 0.053302 0 0 0</pose>";
+    drone.replace(drone.find(pose), pose.size(), dronePose.str());
+
+    for (auto pos = drone.find(ns); pos != std::string::npos;
+         pos = drone.find(ns, pos))
+    {
+      drone.replace(pos, ns.size(),
+          "<robotNamespace>" + name + "</robotNamespace>");
+    }
+    sdf << drone;
+  }
+  sdf << "  </world>\n</sdf>\n";
+  return sdf.str();
+}
+
+//////////////////////////////////////////////////
+/// \brief A robot carrying many sensors updated on every step.
+/// \param[in] _name World name.
+/// \param[in] _sensorsPerType Number of sensors of each type.
+/// \return SDF world.
+static std::string SensorRobotWorld(const std::string &_name,
+    int _sensorsPerType)
+{
+  const std::vector<std::pair<std::string, std::string>> systems{
+      {"imu", "Imu"},
+      {"altimeter", "Altimeter"},
+      {"magnetometer", "Magnetometer"},
+      {"air-pressure", "AirPressure"}};
+  const std::vector<std::string> sensorTypes{
+      "imu", "altimeter", "magnetometer", "air_pressure"};
+
+  std::stringstream sdf;
+  sdf << WorldHeader(_name);
+  for (const auto &system : systems)
+  {
+    sdf << R"(
+    <plugin
+      filename="ignition-gazebo-)" << system.first << R"(-system"
+      name="ignition::gazebo::systems::)" << system.second << R"(">
+    </plugin>
+)";
+  }
+  sdf << GroundPlane() << R"(
+    <model name="robot">
+      <pose>0 0 0.5 0 0 0</pose>
+      <link name="body">
+        <inertial><mass>5</mass></inertial>
+        <collision name="collision">
+          <geometry><box><size>1 1 1</size></box></geometry>
+        </collision>
+)";
+  for (const auto &type : sensorTypes)
+  {
+    for (int i = 0; i < _sensorsPerType; ++i)
+    {
+      sdf << R"(
+        <sensor name=")" << type << "_" << i << R"(" type=")" << type
+          << R"(">
+          <always_on>1</always_on>
+          <update_rate>1000</update_rate>
+          <topic>)" << type << "_" << i << R"(</topic>
+        </sensor>
+)";
+    }
+  }
+  sdf << R"(
+      </link>
+      <plugin
+        filename="ignition-gazebo-velocity-control-system"
+        name="ignition::gazebo::systems::VelocityControl">
+        <initial_angular>0 0 0.5</initial_angular>
+      </plugin>
+    </model>
+  </world>
+</sdf>
+)";
+  return sdf.str();
+}
+
+//////////////////////////////////////////////////
+/// \brief A strip of levels crossed by performers driven by velocity
+/// control, at different speeds so they enter and leave levels on
+/// different iterations.
+/// \param[in] _name World name.
+/// \param[in] _performerCount Number of performers.
+/// \param[in] _levelCount Number of levels, each holding a tile of
+/// obstacles.
+/// \param[in] _physics False to leave out the physics system.
+/// \return SDF world.
+static std::string StreamingWorld(const std::string &_name,
+    int _performerCount, int _levelCount, bool _physics = true)
+{
+  const double levelLength{4.0};
+  const double laneWidth{2.0};
+  const int obstaclesPerTile{10};
+
+  std::stringstream sdf;
+  sdf << WorldHeader(_name, _physics) << GroundPlane();
+
+  for (int i = 0; i < _performerCount; ++i)
+  {
+    sdf << R"(
+    <model name="performer_)" << i << R"(">
+      <pose>0.5 )" << i * laneWidth << R"( 0.1 0 0 0</pose>
+      <link name="chassis">
+        <inertial><mass>10</mass></inertial>
+        <collision name="collision">
+          <geometry><box><size>0.6 0.4 0.2</size></box></geometry>
+        </collision>
+        <visual name="visual">
+          <geometry><box><size>0.6 0.4 0.2</size></box></geometry>
+        </visual>
+      </link>
+      <plugin
+        filename="ignition-gazebo-velocity-control-system"
+        name="ignition::gazebo::systems::VelocityControl">
+        <initial_linear>)" << 2.0 + 0.5 * (i % 4) << R"( 0 0</initial_linear>
+      </plugin>
+    </model>
+)";
+  }
+
+  // Obstacles sit beside the lanes, so they don't stop the performers
+  for (int j = 0; j < _levelCount; ++j)
+  {
+    sdf << R"(
+    <model name="tile_)" << j << R"(">
+      <static>true</static>
+      <pose>)" << (j + 0.5) * levelLength << R"( 0 0 0 0 0</pose>
+)";
+    for (int k = 0; k < obstaclesPerTile; ++k)
+    {
+      sdf << R"(
+      <link name="obstacle_)" << k << R"(">
+        <pose>0 )" << (k + 0.5) * laneWidth << R"( 0.5 0 0 0</pose>
+        <collision name="collision">
+          <geometry><box><size>0.2 0.2 1</size></box></geometry>
+        </collision>
+        <visual name="visual">
+          <geometry><box><size>0.2 0.2 1</size></box></geometry>
+        </visual>
+      </link>
+)";
+    }
+    sdf << "    </model>\n";
+  }
+
+  sdf << R"(
+    <plugin name="ignition::gazebo" filename="dummy">
+)";
+  for (int i = 0; i < _performerCount; ++i)
+  {
+    sdf << R"(
+      <performer name="perf_)" << i << R"(">
+        <ref>performer_)" << i << R"(</ref>
+        <geometry><box><size>0.6 0.4 0.2</size></box></geometry>
+      </performer>
+)";
+  }
+  const double width = std::max(_performerCount, obstaclesPerTile) *
+      laneWidth + 2.0;
+  for (int j = 0; j < _levelCount; ++j)
+  {
+    sdf << R"(
+      <level name="level_)" << j << R"(">
+        <pose>)" << (j + 0.5) * levelLength << " " << width / 2 - 1.0
+        << R"( 2.5 0 0 0</pose>
+        <geometry><box><size>)" << levelLength << " " << width
+        << R"( 10</size></box></geometry>
+        <buffer>1</buffer>
+        <ref>tile_)" << j << R"(</ref>
+      </level>
+)";
+  }
+  sdf << "    </plugin>\n  </world>\n</sdf>\n";
+  return sdf.str();
+}
+
+//////////////////////////////////////////////////
+/// \brief The physics system, which secondaries of a distributed
+/// simulation add to their world, since the primary doesn't run physics.
+/// \param[in] _worldName World name.
+/// \return Plugin to add to the server configuration.
+static ServerConfig::PluginInfo PhysicsPlugin(const std::string &_worldName)
+{
+  auto pluginElem = std::make_shared<sdf::Element>();
+  pluginElem->SetName("plugin");
+  pluginElem->AddAttribute("name", "string",
+      "ignition::gazebo::systems::Physics", true);
+  pluginElem->AddAttribute("filename", "string",
+      "ignition-gazebo-physics-system", true);
+
+  ServerConfig::PluginInfo plugin;
+  plugin.SetEntityName(_worldName);
+  plugin.SetEntityType("world");
+  plugin.SetFilename("ignition-gazebo-physics-system");
+  plugin.SetName("ignition::gazebo::systems::Physics");
+  plugin.SetSdf(pluginElem);
+  return plugin;
+}
+
+//////////////////////////////////////////////////
+/// \brief Create a scenario by name.
+/// \param[in] _name Scenario name.
+/// \param[out] _scenario The scenario.
+/// \return True if the scenario exists.
+static bool CreateScenario(const std::string &_name, Scenario &_scenario)
+{
+  _scenario.worldName = _name;
+  if (_name == "warehouse")
+    return _scenario.config.SetSdfString(WarehouseWorld(_name, 1000));
+
+  if (_name == "drone_swarm")
+  {
+    const auto world = DroneSwarmWorld(_name, 50);
+    return !world.empty() && _scenario.config.SetSdfString(world);
+  }
+
+  if (_name == "sensor_robot")
+    return _scenario.config.SetSdfString(SensorRobotWorld(_name, 10));
+
+  if (_name == "levels")
+  {
+    _scenario.worldName = "default";
+    _scenario.config.SetUseLevels(true);
+    return _scenario.config.SetSdfFile(common::joinPaths(PROJECT_SOURCE_PATH,
+        "test", "worlds", "level_performance.sdf"));
+  }
+
+  if (_name == "log_record")
+  {
+    const auto logPath = common::joinPaths(PROJECT_BINARY_PATH, "test",
+        "scenario_log");
+    common::removeAll(logPath);
+    _scenario.config.SetUseLogRecord(true);
+    _scenario.config.SetLogRecordPath(logPath);
+    return _scenario.config.SetSdfString(WarehouseWorld(_name, 100));
+  }
+
+  if (_name == "level_streaming")
+  {
+    _scenario.config.SetUseLevels(true);
+    return _scenario.config.SetSdfString(StreamingWorld(_name, 20, 30));
+  }
+
+  // Secondaries switch the role and add physics, see RunSecondary
+  if (_name == "distributed")
+  {
+    _scenario.secondaries = 2;
+    _scenario.config.SetUseLevels(true);
+    _scenario.config.SetNetworkRole("primary");
+    _scenario.config.SetNetworkSecondaries(_scenario.secondaries);
+    return _scenario.config.SetSdfString(
+        StreamingWorld(_name, 20, 30, false));
+  }
+
+  return false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Run a secondary of a distributed scenario until its primary
+/// is gone.
+/// \param[in] _name Scenario name.
+/// \return Exit code of the process.
+static int RunSecondary(const std::string &_name)
+{
+  Scenario scenario;
+  if (!CreateScenario(_name, scenario) || scenario.secondaries == 0)
+  {
+    ignerr << "Failed to create distributed scenario [" << _name << "]"
+           << std::endl;
+    return -1;
+  }
+  scenario.config.SetNetworkRole("secondary");
+  scenario.config.AddPlugin(PhysicsPlugin(scenario.worldName));
+
+  Server server(scenario.config);
+  server.Run(true, 0, false);
+  return 0;
+}
+
+//////////////////////////////////////////////////
+/// \brief Start the secondaries of a distributed scenario, each running
+/// this program in its own process, since physics can't run twice in a
+/// process.
+/// \param[in] _program Path of this program.
+/// \param[in] _scenario Scenario name.
+/// \param[in] _count Number of secondaries.
+/// \param[out] _pids Process ids of the started secondaries.
+/// \return True if all secondaries were started.
+static bool StartSecondaries(const std::string &_program,
+    const std::string &_scenario, int _count, std::vector<int> &_pids)
+{
+#ifndef _WIN32
+  for (int i = 0; i < _count; ++i)
+  {
+    std::string flag{"--secondary"};
+    std::string scenario{_scenario};
+    std::string program{_program};
+    char *args[] = {&program[0], &flag[0], &scenario[0], nullptr};
+
+    pid_t pid;
+    if (posix_spawn(&pid, program.c_str(), nullptr, nullptr, args,
+        environ) != 0)
+    {
+      ignerr << "Failed to start secondary [" << i << "]" << std::endl;
+      return false;
+    }
+    _pids.push_back(static_cast<int>(pid));
+  }
+  return true;
+#else
+  (void)_program;
+  (void)_scenario;
+  (void)_count;
+  (void)_pids;
+  ignerr << "Distributed scenarios aren't supported on Windows."
+         << std::endl;
+  return false;
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Stop the secondaries of a distributed scenario and wait for
+/// them to exit.
+/// \param[in] _pids Process ids of the secondaries.
+static void StopSecondaries(const std::vector<int> &_pids)
+{
+#ifndef _WIN32
+  for (const int pid : _pids)
+    kill(static_cast<pid_t>(pid), SIGINT);
+  for (const int pid : _pids)
+    waitpid(static_cast<pid_t>(pid), nullptr, 0);
+#else
+  (void)_pids;
+#endif
+}
+
+//////////////////////////////////////////////////
+/// \brief Get a percentile of sorted values.
+/// \param[in] _sorted Values in ascending order.
+/// \param[in] _fraction Fraction of values which are lower or equal.
+/// \return The percentile, zero if there are no values.
+static double Percentile(const std::vector<double> &_sorted, double _fraction)
+{
+  if (_sorted.empty())
+    return 0.0;
+  const auto index = static_cast<std::size_t>(_fraction *
+      static_cast<double>(_sorted.size() - 1));
+  return _sorted[index];
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the peak resident memory of the process.
+/// \return Peak resident memory in kilobytes, zero if unknown.
+static double PeakRssKb()
+{
+#ifndef _WIN32
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return static_cast<double>(usage.ru_maxrss);
+#endif
+  return 0.0;
+}
+
+//////////////////////////////////////////////////
+/// \brief Runs a scenario and writes its results as JSON.
+///
+/// Usage: PERFORMANCE_scenarios <scenario> <output.json> [iterations]
+///
+/// Scenarios are warehouse, drone_swarm, sensor_robot, levels,
+/// log_record, level_streaming and distributed. Run each scenario in its
+/// own process, so the peak memory is its own. The secondaries of the
+/// distributed scenario are this program started with `--secondary
+/// <scenario>`.
+int main(int _argc, char** _argv)
+{
+  common::Console::SetVerbosity(3);
+
+  if (_argc == 3 && std::string(_argv[1]) == "--secondary")
+  {
+    common::setenv("IGN_GAZEBO_SYSTEM_PLUGIN_PATH",
+        (std::string(PROJECT_BINARY_PATH) + "/lib").c_str());
+    return RunSecondary(_argv[2]);
+  }
+
+  if (_argc < 3)
+  {
+    ignerr << "Usage: " << _argv[0] << " <scenario> <output.json> "
+           << "[iterations]" << std::endl;
+    return -1;
+  }
+  const std::string scenarioName{_argv[1]};
+  const std::string outputFile{_argv[2]};
+
+  unsigned int iterations{5000};
+  if (_argc >= 4)
+    iterations = atoi(_argv[3]);
+
+  common::setenv("IGN_GAZEBO_SYSTEM_PLUGIN_PATH",
+      (std::string(PROJECT_BINARY_PATH) + "/lib").c_str());
+
+  Scenario scenario;
+  if (!CreateScenario(scenarioName, scenario))
+  {
+    ignerr << "Failed to create scenario [" << scenarioName << "]"
+           << std::endl;
+    return -1;
+  }
+
+  // Real and sim time of each iteration, and the step metrics published
+  // once per second.
+  std::mutex mutex;
+  std::vector<double> realTimes;
+  std::vector<double> simTimes;
+  realTimes.reserve(iterations + 1);
+  simTimes.reserve(iterations + 1);
+  std::vector<msgs::Param> metrics;
+
+  transport::Node node;
+  const std::string worldTopic = "/world/" + scenario.worldName;
+  std::function<void(const msgs::Clock &)> onClock =
+      [&](const msgs::Clock &_msg)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        realTimes.push_back(_msg.real().sec() + 1e-9 * _msg.real().nsec());
+        simTimes.push_back(_msg.sim().sec() + 1e-9 * _msg.sim().nsec());
+      };
+  std::function<void(const msgs::Param_V &)> onMetrics =
+      [&](const msgs::Param_V &_msg)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (_msg.param_size() > 0)
+          metrics.push_back(_msg.param(0));
+      };
+  node.Subscribe(worldTopic + "/clock", onClock);
+  node.Subscribe(worldTopic + "/step_metrics", onMetrics);
+
+  // Secondaries are started first, the primary waits for them on its
+  // first iteration
+  std::vector<int> secondaryPids;
+  if (!StartSecondaries(_argv[0], scenarioName, scenario.secondaries,
+      secondaryPids))
+  {
+    StopSecondaries(secondaryPids);
+    return -1;
+  }
+
+  // Startup covers loading the world and its first iteration, which
+  // creates the physics entities.
+  const auto loadStart = std::chrono::steady_clock::now();
+  Server server(scenario.config);
+  server.SetUpdatePeriod(1ns);
+  const auto loadEnd = std::chrono::steady_clock::now();
+  server.Run(true, 1, false);
+  const auto firstStepEnd = std::chrono::steady_clock::now();
+
+  server.Run(true, iterations, false);
+  StopSecondaries(secondaryPids);
+
+  // The ECM usage is measured once per second by the simulation thread
+  double ecmBytes{0.0};
+  {
+    msgs::Param_V res;
+    bool result{false};
+    if (node.Request(worldTopic + "/memory_usage", 5000u, res, result) &&
+        result)
+    {
+      for (const auto &param : res.param())
+      {
+        for (const std::string key : {"bytes", "overhead"})
+        {
+          auto it = param.params().find(key);
+          if (it != param.params().end())
+            ecmBytes += it->second.double_value();
+        }
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // The first clock message belongs to the first iteration
+  std::vector<double> stepUs;
+  for (std::size_t i = 2; i < realTimes.size(); ++i)
+    stepUs.push_back((realTimes[i] - realTimes[i - 1]) * 1e6);
+  std::sort(stepUs.begin(), stepUs.end());
+  double stepSumUs{0.0};
+  for (const double us : stepUs)
+    stepSumUs += us;
+
+  double realTimeFactor{0.0};
+  if (realTimes.size() > 2 && realTimes.back() > realTimes[1])
+  {
+    realTimeFactor = (simTimes.back() - simTimes[1]) /
+        (realTimes.back() - realTimes[1]);
+  }
+
+  auto ms = [](const std::chrono::steady_clock::duration &_duration)
+  {
+    return std::chrono::duration<double, std::milli>(_duration).count();
+  };
+  auto number = [](const msgs::Param &_param, const std::string &_key)
+  {
+    auto it = _param.params().find(_key);
+    return it == _param.params().end() ? 0.0 : it->second.double_value();
+  };
+
+  std::ofstream ofs(outputFile, std::ofstream::out);
+  ofs << "{\n"
+      << "  \"scenario\": \"" << scenarioName << "\",\n"
+      << "  \"iterations\": " << iterations << ",\n"
+      << "  \"startup_ms\": {\n"
+      << "    \"load\": " << ms(loadEnd - loadStart) << ",\n"
+      << "    \"first_step\": " << ms(firstStepEnd - loadEnd) << "\n"
+      << "  },\n"
+      << "  \"step_us\": {\n"
+      << "    \"samples\": " << stepUs.size() << ",\n"
+      << "    \"mean\": "
+      << (stepUs.empty() ? 0.0 : stepSumUs / stepUs.size()) << ",\n"
+      << "    \"p50\": " << Percentile(stepUs, 0.5) << ",\n"
+      << "    \"p90\": " << Percentile(stepUs, 0.9) << ",\n"
+      << "    \"p99\": " << Percentile(stepUs, 0.99) << ",\n"
+      << "    \"max\": " << (stepUs.empty() ? 0.0 : stepUs.back()) << "\n"
+      << "  },\n"
+      << "  \"real_time_factor\": " << realTimeFactor << ",\n";
+
+  // Phase means are weighted by the steps in each published second
+  ofs << "  \"phases_us\": {\n";
+  for (std::size_t p = 0; p < kPhases.size(); ++p)
+  {
+    const auto &phase = kPhases[p];
+    double count{0.0};
+    double sum{0.0};
+    double max{0.0};
+    for (const auto &param : metrics)
+    {
+      const double phaseCount = number(param, phase + "_count");
+      count += phaseCount;
+      sum += phaseCount * number(param, phase + "_mean_us");
+      max = std::max(max, number(param, phase + "_max_us"));
+    }
+    ofs << "    \"" << phase << "\": {\"mean\": "
+        << (count > 0 ? sum / count : 0.0) << ", \"max\": " << max << "}"
+        << (p + 1 < kPhases.size() ? "," : "") << "\n";
+  }
+  ofs << "  },\n";
+
+  // Hitches of the iterations which loaded or unloaded levels. The p99 is
+  // the worst of the p99 of each published second.
+  {
+    double count{0.0};
+    double sum{0.0};
+    double p99{0.0};
+    double max{0.0};
+    for (const auto &param : metrics)
+    {
+      const double transitionCount = number(param, "level_transition_count");
+      count += transitionCount;
+      sum += transitionCount * number(param, "level_transition_mean_us");
+      p99 = std::max(p99, number(param, "level_transition_p99_us"));
+      max = std::max(max, number(param, "level_transition_max_us"));
+    }
+    ofs << "  \"level_transition_us\": {\n"
+        << "    \"count\": " << count << ",\n"
+        << "    \"mean\": " << (count > 0 ? sum / count : 0.0) << ",\n"
+        << "    \"p99\": " << p99 << ",\n"
+        << "    \"max\": " << max << "\n"
+        << "  },\n";
+  }
+
+  // Network counters are totals since the start, so the last published
+  // ones cover the most steps
+  if (scenario.secondaries > 0)
+  {
+    const msgs::Param last = metrics.empty() ? msgs::Param() : metrics.back();
+    const double steps = std::max(number(last, "network_steps"), 1.0);
+    ofs << "  \"network\": {\n"
+        << "    \"steps\": " << number(last, "network_steps") << ",\n"
+        << "    \"step_bytes_per_step\": "
+        << number(last, "network_bytes_sent") / steps << ",\n"
+        << "    \"ack_bytes_per_step\": "
+        << number(last, "network_bytes_received") / steps << ",\n"
+        << "    \"ack_state_bytes_per_step\": "
+        << number(last, "network_state_bytes") / steps << ",\n"
+        << "    \"resyncs\": " << number(last, "network_resyncs") << ",\n"
+        << "    \"mean_latency_us\": "
+        << number(last, "network_mean_latency_us") << ",\n"
+        << "    \"max_latency_us\": "
+        << number(last, "network_max_latency_us") << "\n"
+        << "  },\n";
+  }
+
+  ofs << "  \"memory\": {\n"
+      << "    \"peak_rss_kb\": " << PeakRssKb() << ",\n"
+      << "    \"ecm_bytes\": " << ecmBytes << ",\n"
+      << "    \"entities\": "
+      << (metrics.empty() ? 0.0 : number(metrics.back(), "entity_count"))
+      << "\n"
+      << "  }\n"
+      << "}\n";
+
+  ignmsg << "Wrote results of scenario [" << scenarioName << "] to ["
+         << outputFile << "]" << std::endl;
+  return 0;
+}
@@ -7,3 +7,10 @@ IGNITION_ADD_PLUGIN(ignition::gazebo::MockSystem, ignition::gazebo::System,
     ignition::gazebo::MockSystem::ISystemUpdate,
     ignition::gazebo::MockSystem::ISystemPostUpdate)
 
+IGNITION_ADD_PLUGIN(ignition::gazebo::MockAccessSystem,
+    ignition::gazebo::System,
+    ignition::gazebo::MockAccessSystem::ISystemPreUpdate,
+    ignition::gazebo::MockAccessSystem::ISystemUpdate,
+    ignition::gazebo::MockAccessSystem::ISystemPostUpdate,
+    ignition::gazebo::MockAccessSystem::ISystemComponentAccess)
+
@@ -71,6 +71,19 @@ namespace ignition {
                   this->postUpdateCallback(_info, _manager);
               }
     };
+
+    class MockAccessSystem :
+      public MockSystem,
+      public gazebo::ISystemComponentAccess
+    {
+      public: ComponentAccess access;
+
+      public: ComponentAccess Access(
+                  const gazebo::EntityComponentManager &) override final
+              {
+                return this->access;
+              }
+    };
   }
 }
 